@@ -24,6 +24,12 @@
 
 #include <lsp-plug.in/dsp-units/version.h>
 #include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/dsp-units/3d/Arena3D.h>
+
+// Number of chunk pointers in one page of the concurrent allocator
+#define ALLOCATOR3D_PAGE_SIZE       0x400
+// Number of pages of the concurrent allocator
+#define ALLOCATOR3D_PAGES           0x40
 
 namespace lsp
 {
@@ -48,6 +54,7 @@ namespace lsp
                 uint8_t   **vChunks;        // List of all chunks
                 uint8_t    *pCurr;          // Current chunk
                 size_t      nLeft;          // Number of left items
+                Arena3D    *pArena;         // Arena used for chunk allocation, may be NULL
 
             protected:
                 uint8_t    *get_chunk(size_t id);
@@ -63,7 +70,15 @@ namespace lsp
 
             public:
                 explicit BasicAllocator3D(size_t sz_of, size_t c_size);
+                explicit BasicAllocator3D(size_t sz_of, size_t c_size, Arena3D *arena);
                 ~BasicAllocator3D();
+
+            public:
+                /**
+                 * Get the arena used for chunk allocation
+                 * @return arena or NULL if chunks are allocated from the heap
+                 */
+                inline Arena3D *arena()         { return pArena;    }
         };
 
         template <class T>
@@ -76,6 +91,13 @@ namespace lsp
                      */
                     explicit Allocator3D(size_t csize): BasicAllocator3D(sizeof(T), csize) {}
 
+                    /**
+                     * Constructor
+                     * @param csize chunk size, will be rounded to be power of 2
+                     * @param arena arena to allocate chunks from, may be NULL
+                     */
+                    explicit Allocator3D(size_t csize, Arena3D *arena): BasicAllocator3D(sizeof(T), csize, arena) {}
+
                 public:
                     /**
                      * Allocate single item
@@ -213,6 +235,154 @@ namespace lsp
                      */
                     inline bool validate(const void *ptr) const { return do_validate(ptr); };
 
+                    /**
+                     * Get index of the item in allocator
+                     * @param ptr pointer to the item
+                     * @return index of the item or negative value on error
+                     */
+                    inline ssize_t index_of(const void *ptr) const { return calc_index_of(ptr); }
+            };
+
+        /**
+         * Concurrent fixed-pointer allocator. Multiple threads may allocate items at the
+         * same time: indexes are reserved by atomic increment of the counter, chunks and
+         * pages of the chunk index are created on demand and published by CAS, so the
+         * allocation does not lock and never moves already allocated items. Allocated
+         * items stay contiguous in index space, but the items allocated by different
+         * threads are interleaved. The clear(), destroy() and swap() calls are not
+         * thread-safe and should be issued when no other thread uses the allocator.
+         */
+        class BasicConcurrentAllocator3D
+        {
+            private:
+                BasicConcurrentAllocator3D(const BasicConcurrentAllocator3D &);
+                BasicConcurrentAllocator3D & operator = (const BasicConcurrentAllocator3D &);
+
+            protected:
+                size_t      nShift;         // Chunk identifier shift
+                size_t      nMask;          // Chunk item mask
+                size_t      nSizeOf;        // Size of record (in bytes)
+                ssize_t     nReserved;      // Number of reserved items, modified atomically
+                uint8_t   **vPages[ALLOCATOR3D_PAGES];  // Pages of chunk pointers
+                Arena3D    *pArena;         // Arena used for chunk allocation, may be NULL
+
+            protected:
+                uint8_t    *get_chunk(size_t id);
+                void       *do_alloc();
+                ssize_t     do_ialloc(void **p);
+                ssize_t     do_alloc_n(void **ptr, size_t n);
+                void       *do_get(size_t idx);
+                void        do_clear();
+                void        do_destroy();
+                void        do_swap(BasicConcurrentAllocator3D *alloc);
+                ssize_t     calc_index_of(const void *ptr) const;
+
+            public:
+                explicit BasicConcurrentAllocator3D(size_t sz_of, size_t c_size, Arena3D *arena);
+                ~BasicConcurrentAllocator3D();
+
+            public:
+                /**
+                 * Get the arena used for chunk allocation
+                 * @return arena or NULL if chunks are allocated from the heap
+                 */
+                inline Arena3D *arena()         { return pArena;    }
+
+                /**
+                 * Get maximum number of items that can be allocated
+                 * @return maximum number of items
+                 */
+                inline size_t   capacity() const    { return size_t(ALLOCATOR3D_PAGES * ALLOCATOR3D_PAGE_SIZE) << nShift; }
+        };
+
+        template <class T>
+            class ConcurrentAllocator3D: public BasicConcurrentAllocator3D
+            {
+                public:
+                    /**
+                     * Constructor
+                     * @param csize chunk size, will be rounded to be power of 2
+                     * @param arena arena to allocate chunks from, may be NULL
+                     */
+                    explicit ConcurrentAllocator3D(size_t csize, Arena3D *arena = NULL):
+                        BasicConcurrentAllocator3D(sizeof(T), csize, arena) {}
+
+                public:
+                    /**
+                     * Allocate single item, thread-safe
+                     * @return pointer to allocated single item or NULL
+                     */
+                    inline T *alloc() { return reinterpret_cast<T *>(do_alloc()); }
+
+                    /**
+                     * Allocate single item and initialize with value, thread-safe
+                     * @param src value to initialize
+                     * @return pointer to allocated item or NULL
+                     */
+                    inline T *alloc(const T *src)
+                    {
+                        T *res = reinterpret_cast<T *>(do_alloc());
+                        if (res != NULL)
+                            *res = *src;
+                        return res;
+                    }
+
+                    /**
+                     * Allocate single item, thread-safe
+                     * @param dst pointer to store pointer to allocated item
+                     * @return index of allocated item or negative error status
+                     */
+                    inline ssize_t ialloc(T **dst) { return do_ialloc(reinterpret_cast<void **>(dst)); }
+
+                    /**
+                     * Allocate set of items with contiguous indexes, thread-safe
+                     * @param retval pointer to store pointers to allocated elements
+                     * @param n number of elements to allocate
+                     * @return index of the first allocated item or negative error status
+                     */
+                    inline ssize_t alloc_n(T **retval, size_t n) { return do_alloc_n(reinterpret_cast<void **>(retval), n); }
+
+                    /**
+                     * Get number of allocated items, items allocated concurrently
+                     * may be not initialized yet
+                     * @return number of allocated items
+                     */
+                    inline size_t size() const { return size_t(nReserved); }
+
+                    /**
+                     * Get number of elements per one chunk
+                     * @return number of elements per one chunk
+                     */
+                    inline size_t chunk_size() const { return 1 << nShift; }
+
+                    /**
+                     * Get element at specified index
+                     * @param idx element at specified index
+                     * @return element at specified index or NULL if index is invalid
+                     */
+                    inline T *get(size_t idx) { return reinterpret_cast<T *>(do_get(idx)); }
+
+                    /**
+                     * Swap internal contents with another allocator, not thread-safe
+                     * @param src allocator to perform swapping
+                     */
+                    inline void swap(ConcurrentAllocator3D<T> *src) { do_swap(src); };
+
+                    /** Drop all allocated data, not thread-safe
+                     *
+                     */
+                    inline void destroy() { do_destroy(); };
+
+                    /** Drop all allocated data (similar to destroy), not thread-safe
+                     *
+                     */
+                    inline void flush() { do_destroy(); };
+
+                    /** Drop all allocated items but keep chunks for reuse, not thread-safe
+                     *
+                     */
+                    inline void clear() { do_clear(); };
+
                     /**
                      * Get index of the item in allocator
                      * @param ptr pointer to the item
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_3D_ARENA3D_H_
+#define LSP_PLUG_IN_DSP_UNITS_3D_ARENA3D_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/ipc/Mutex.h>
+
+// Number of different chunk sizes cached by the arena
+#define ARENA3D_BINS                8
+// Default limit of memory cached by the arena
+#define ARENA3D_DEFAULT_LIMIT       0x4000000
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Arena of memory chunks for the Allocator3D objects. Chunks released by
+         * allocators are kept in the arena and are reused by other allocators,
+         * so short-living allocators do not call malloc()/free() every time.
+         * All cached chunks are released at once by the reset() call.
+         * The arena is thread-safe: chunks can be released by any thread.
+         */
+        class Arena3D
+        {
+            private:
+                Arena3D(const Arena3D &);
+                Arena3D & operator = (const Arena3D &);
+
+            protected:
+                typedef struct bin_t
+                {
+                    size_t      nSize;          // Size of chunk in bytes
+                    uint8_t    *pFree;          // List of free chunks
+                } bin_t;
+
+            protected:
+                bin_t       vBins[ARENA3D_BINS];
+                size_t      nCached;        // Number of bytes cached
+                size_t      nLimit;         // Maximum number of bytes to cache
+                size_t      nAllocs;        // Number of chunks allocated from the heap
+                size_t      nReuses;        // Number of chunks reused from the arena
+                size_t      nUsed;          // Number of bytes handed out and not returned yet
+                size_t      nPeak;          // Peak number of bytes handed out
+                ipc::Mutex  lkLock;         // Lock
+
+            protected:
+                static void free_list(uint8_t *list);
+
+            public:
+                explicit Arena3D();
+                explicit Arena3D(size_t limit);
+                ~Arena3D();
+
+            public:
+                /**
+                 * Allocate chunk of memory
+                 * @param size size of the chunk in bytes
+                 * @return pointer to allocated chunk or NULL
+                 */
+                uint8_t    *alloc(size_t size);
+
+                /**
+                 * Return chunk of memory to the arena
+                 * @param chunk pointer to the chunk, may be NULL
+                 * @param size size of the chunk in bytes
+                 */
+                void        free(uint8_t *chunk, size_t size);
+
+                /**
+                 * Release all chunks cached in the arena
+                 */
+                void        reset();
+
+                /**
+                 * Get number of bytes cached in the arena
+                 * @return number of bytes cached in the arena
+                 */
+                inline size_t   cached() const          { return nCached;       }
+
+                /**
+                 * Get number of chunks allocated from the heap
+                 * @return number of chunks allocated from the heap
+                 */
+                inline size_t   heap_allocs() const     { return nAllocs;       }
+
+                /**
+                 * Get number of chunks reused from the arena
+                 * @return number of chunks reused from the arena
+                 */
+                inline size_t   reuses() const          { return nReuses;       }
+
+                /**
+                 * Get number of bytes allocated by the arena and not returned yet
+                 * @return number of bytes in use
+                 */
+                inline size_t   used() const            { return nUsed;         }
+
+                /**
+                 * Get peak number of bytes allocated by the arena and not returned,
+                 * the value is not affected by reset()
+                 * @return peak number of bytes in use
+                 */
+                inline size_t   peak() const            { return nPeak;         }
+
+                /**
+                 * Get the limit of memory cached by the arena
+                 * @return the limit of memory cached by the arena in bytes
+                 */
+                inline size_t   limit() const           { return nLimit;        }
+
+                /**
+                 * Set the limit of memory cached by the arena
+                 * @param limit the limit of memory cached by the arena in bytes
+                 */
+                inline void     set_limit(size_t limit) { nLimit = limit;       }
+        };
+    } // namespace dspu
+} // namespace lsp
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_3D_ARENA3D_H_ */
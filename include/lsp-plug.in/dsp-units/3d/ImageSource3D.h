@@ -0,0 +1,267 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_3D_IMAGESOURCE3D_H_
+#define LSP_PLUG_IN_DSP_UNITS_3D_IMAGESOURCE3D_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/3d/Scene3D.h>
+#include <lsp-plug.in/dsp-units/3d/rt/types.h>
+#include <lsp-plug.in/dsp-units/3d/rt/bvh.h>
+#include <lsp-plug.in/dsp-units/util/MultiTapDelay.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/lltl/darray.h>
+
+// Maximum supported reflection order
+#define IS_ORDER_MAX            4
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Early reflection tap computed by the image-source method
+         */
+        typedef struct is_tap_t
+        {
+            float               delay;      // Delay of the tap [s]
+            float               gain;       // Gain of the tap, the sign is inverted by each reflection
+            dsp::vector3d_t     dir;        // Unit direction from the listener to the apparent source
+            size_t              order;      // Reflection order, 0 for the direct sound
+        } is_tap_t;
+
+        /**
+         * Image-source early reflection engine. Computes the direct sound and the
+         * first reflection orders between the source and the listener over the
+         * triangles of the scene. Coplanar triangles of the same material form
+         * one reflecting plane, images of the source are built once for each
+         * source position, the listener position is validated against the
+         * reflecting triangles and the bounding volume hierarchy of the scene,
+         * so the listener can be moved at interactive rate.
+         */
+        class ImageSource3D
+        {
+            private:
+                ImageSource3D & operator = (const ImageSource3D &);
+                ImageSource3D(const ImageSource3D &);
+
+            protected:
+                typedef struct plane_t
+                {
+                    dsp::vector3d_t     pl;         // Plane equation
+                    rt::material_t     *m;          // Material of the plane
+                    size_t              first;      // Index of the first triangle in the list of plane triangles
+                    size_t              count;      // Number of triangles of the plane
+                } plane_t;
+
+                typedef struct image_t
+                {
+                    dsp::point3d_t      pos;        // Position of the image
+                    ssize_t             parent;     // Index of the parent image, negative for the source
+                    size_t              plane;      // Index of the reflecting plane
+                    size_t              order;      // Reflection order
+                    float               gain;       // Product of reflection coefficients
+                } image_t;
+
+            protected:
+                Scene3D                        *pScene;
+                lltl::darray<rt::material_t>    vMaterials;     // Materials of scene objects
+                lltl::darray<rtx::triangle_t>   vMesh;          // Triangles of the scene in world coordinates
+                lltl::darray<size_t>            vTrianglePlane; // Index of the plane for each triangle
+                lltl::darray<plane_t>           vPlanes;        // Reflecting planes
+                lltl::darray<size_t>            vPlaneTriangles;// Triangles of planes
+                lltl::darray<image_t>           vImages;        // Images of the source
+                rt::bvh_t                       sBVH;           // Bounding volume hierarchy of the mesh
+                dsp::point3d_t                  sSource;        // Position of the source
+                float                           fAmplitude;     // Amplitude of the source
+                float                           fSoundSpeed;    // Sound speed [m/s]
+                float                           fMaxTime;       // Maximum delay of the tap [s]
+                float                           fThreshold;     // Minimum gain of the tap
+                size_t                          nMaxOrder;      // Maximum reflection order
+                size_t                          nMaxImages;     // Maximum number of images
+                bool                            bUpdateMesh;    // Mesh should be rebuilt
+                bool                            bUpdateImages;  // Images should be rebuilt
+
+            protected:
+                status_t        build_mesh();
+                status_t        build_planes();
+                status_t        build_images();
+                bool            find_hit(dsp::point3d_t *hit, const plane_t *p, const dsp::point3d_t *a, const dsp::point3d_t *b) const;
+                float           transmission(const dsp::point3d_t *a, const dsp::point3d_t *b, ssize_t pa, ssize_t pb) const;
+                static bool     intersect(const rtx::triangle_t *t, const dsp::point3d_t *a, const dsp::vector3d_t *d);
+                static bool     check_box(const dsp::bound_box3d_t *bbox, const dsp::point3d_t *a, const dsp::vector3d_t *d);
+                static void     init_material(rt::material_t *m);
+
+            public:
+                explicit ImageSource3D();
+                ~ImageSource3D();
+
+                /**
+                 * Construct the object
+                 */
+                void            construct();
+
+                /**
+                 * Destroy the object
+                 */
+                void            destroy();
+
+            public:
+                /**
+                 * Set the scene, the scene is not owned by the engine
+                 * @param scene scene object
+                 * @return status of operation
+                 */
+                status_t        set_scene(Scene3D *scene);
+
+                /**
+                 * Get the scene
+                 * @return scene object
+                 */
+                inline Scene3D *scene()                     { return pScene;        }
+
+                /**
+                 * Mark the scene changed: should be called after objects of the scene
+                 * were moved, added or hidden
+                 */
+                void            update_scene();
+
+                /**
+                 * Set the material for the corresponding object
+                 * @param idx the index of the object
+                 * @param material material
+                 * @return status of operation
+                 */
+                status_t        set_material(size_t idx, const rt::material_t *material);
+
+                /**
+                 * Get the material for the corresponding object
+                 * @param material pointer to store the material
+                 * @param idx the index of the object
+                 * @return status of operation
+                 */
+                status_t        get_material(rt::material_t *material, size_t idx) const;
+
+                /**
+                 * Set the position and the amplitude of the source, images of the source
+                 * are rebuilt on the next process() call if the position changes
+                 * @param pos position of the source
+                 * @param amplitude amplitude of the source at the distance of 1 m
+                 */
+                void            set_source(const dsp::point3d_t *pos, float amplitude = 1.0f);
+
+                /**
+                 * Set maximum reflection order
+                 * @param order maximum reflection order, limited by IS_ORDER_MAX
+                 */
+                void            set_max_order(size_t order);
+
+                /**
+                 * Get maximum reflection order
+                 * @return maximum reflection order
+                 */
+                inline size_t   max_order() const           { return nMaxOrder;     }
+
+                /**
+                 * Set maximum number of images, the images of lower orders are built first
+                 * @param images maximum number of images
+                 */
+                void            set_max_images(size_t images);
+
+                /**
+                 * Get maximum number of images
+                 * @return maximum number of images
+                 */
+                inline size_t   max_images() const          { return nMaxImages;    }
+
+                /**
+                 * Set sound speed
+                 * @param speed sound speed [m/s]
+                 */
+                void            set_sound_speed(float speed);
+
+                /**
+                 * Get sound speed
+                 * @return sound speed [m/s]
+                 */
+                inline float    sound_speed() const         { return fSoundSpeed;   }
+
+                /**
+                 * Set maximum delay of the tap
+                 * @param time maximum delay of the tap [s], zero or negative for unlimited
+                 */
+                void            set_max_time(float time);
+
+                /**
+                 * Get maximum delay of the tap
+                 * @return maximum delay of the tap [s]
+                 */
+                inline float    max_time() const            { return fMaxTime;      }
+
+                /**
+                 * Set minimum absolute gain of the tap, weaker taps are dropped
+                 * @param thresh minimum absolute gain of the tap
+                 */
+                void            set_threshold(float thresh);
+
+                /**
+                 * Get minimum absolute gain of the tap
+                 * @return minimum absolute gain of the tap
+                 */
+                inline float    threshold() const           { return fThreshold;    }
+
+                /**
+                 * Get number of images of the source
+                 * @return number of images of the source
+                 */
+                inline size_t   num_images() const          { return vImages.size(); }
+
+                /**
+                 * Get number of reflecting planes of the scene
+                 * @return number of reflecting planes
+                 */
+                inline size_t   num_planes() const          { return vPlanes.size(); }
+
+                /**
+                 * Compute early reflection taps for the listener. The triangles crossed
+                 * by the path attenuate the tap according to the transparency of the material
+                 * @param taps list to store taps, taps are not sorted
+                 * @param listener position of the listener
+                 * @return status of operation
+                 */
+                status_t        process(lltl::darray<is_tap_t> *taps, const dsp::point3d_t *listener);
+
+                /**
+                 * Configure the multi-tap delay with the strongest taps
+                 * @param dly multi-tap delay
+                 * @param taps array of taps
+                 * @param n number of taps
+                 * @param sample_rate sample rate
+                 * @return number of configured taps of the delay
+                 */
+                static size_t   apply(MultiTapDelay *dly, const is_tap_t *taps, size_t n, size_t sample_rate);
+        };
+    } // namespace dspu
+} // namespace lsp
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_3D_IMAGESOURCE3D_H_ */
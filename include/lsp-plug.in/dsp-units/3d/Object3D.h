@@ -30,6 +30,7 @@
 #include <lsp-plug.in/common/status.h>
 #include <lsp-plug.in/runtime/LSPString.h>
 #include <lsp-plug.in/lltl/parray.h>
+#include <lsp-plug.in/lltl/darray.h>
 
 namespace lsp
 {
@@ -37,6 +38,23 @@ namespace lsp
     {
         class Scene3D;
 
+        /**
+         * Compact indexed representation of the object. Vertexes, normals and edges
+         * referenced by triangles are deduplicated and stored in packed arrays in the
+         * order of the first use, triangles refer to them by indexes stored in separate
+         * arrays, three indexes per triangle. Coordinates are in the object space.
+         */
+        typedef struct obj_packed_t
+        {
+            lltl::darray<dsp::point3d_t>    vertex;     // Packed vertexes
+            lltl::darray<dsp::vector3d_t>   normal;     // Packed normals
+            lltl::darray<uint32_t>          edge;       // Packed edges, two vertex indexes per edge
+            lltl::darray<uint32_t>          vindex;     // Vertex indexes, three per triangle
+            lltl::darray<uint32_t>          nindex;     // Normal indexes, three per triangle
+            lltl::darray<uint32_t>          eindex;     // Edge indexes, three per triangle, edge i connects vertexes i and i+1
+            lltl::darray<ssize_t>           face;       // Face identifier of each triangle
+        } obj_packed_t;
+
         /** One scene object in the 3D space
          *
          */
@@ -55,6 +73,13 @@ namespace lsp
                 Scene3D                        *pScene;
                 obj_boundbox_t                  sBoundBox;
                 dsp::point3d_t                  sCenter;
+                dsp::matrix3d_t                 sWorldMatrix;   // The matrix the cached world-space bounds were computed for
+                obj_boundbox_t                  sWorldBox;      // Cached bounding box transformed by the matrix
+                dsp::point3d_t                  sWorldCenter;   // Cached center of the world-space bounding sphere
+                float                           fWorldRadius;   // Cached radius of the world-space bounding sphere
+                bool                            bWorldValid;    // Cached world-space bounds match the bounding box
+                obj_packed_t                    sPacked;        // Packed indexed representation of triangles
+                bool                            bPackedValid;   // Packed representation matches the triangles
 
                 friend class Scene3D;
 
@@ -71,7 +96,10 @@ namespace lsp
 
             protected:
                 void calc_bound_box(const obj_vertex_t *v);
+                void update_world_bounds();
+                void validate_world_bounds();
                 obj_edge_t *register_edge(obj_vertex_t *v0, obj_vertex_t *v1);
+                status_t build_packed();
 
             public:
                 /** Destroy object's contents
@@ -196,10 +224,50 @@ namespace lsp
                  */
                 inline dsp::matrix3d_t *matrix() { return &sMatrix; }
 
+                /** Get object transformation matrix (const version)
+                 *
+                 * @return object transformation matrix
+                 */
+                inline const dsp::matrix3d_t *matrix() const { return &sMatrix; }
+
+                /** Set object transformation matrix
+                 *
+                 * @param m transformation matrix
+                 */
+                inline void set_matrix(const dsp::matrix3d_t *m) { sMatrix = *m; }
+
+                /**
+                 * Get bounding box transformed by the object's matrix, the box
+                 * is computed once and cached until the matrix or the bounding box changes
+                 * @return pointer to world-space bounding box
+                 */
+                const obj_boundbox_t *world_bound_box();
+
+                /**
+                 * Get center of the world-space bounding sphere
+                 * @return pointer to center of the world-space bounding sphere
+                 */
+                const dsp::point3d_t *world_center();
+
+                /**
+                 * Get radius of the world-space bounding sphere
+                 * @return radius of the world-space bounding sphere
+                 */
+                float world_radius();
+
                 /**
                  * Compute bounding box
                  */
                 void calc_bound_box();
+
+                /**
+                 * Get packed indexed representation of the object, the representation
+                 * is built once and cached until triangles change. The call is not
+                 * thread-safe: the representation should be built before the object
+                 * is shared between threads
+                 * @return pointer to packed representation or NULL on error
+                 */
+                const obj_packed_t *packed();
         };
     }
 }
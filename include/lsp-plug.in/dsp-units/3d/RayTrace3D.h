@@ -23,14 +23,23 @@
 #define LSP_PLUG_IN_DSP_UNITS_3D_RAYTRACE3D_H_
 
 #include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/misc/memory.h>
 #include <lsp-plug.in/dsp-units/sampling/Sample.h>
 #include <lsp-plug.in/dsp-units/3d/rt/types.h>
 #include <lsp-plug.in/dsp-units/3d/rt/context.h>
+#include <lsp-plug.in/dsp-units/3d/rt/queue.h>
+#include <lsp-plug.in/dsp-units/3d/rt/bvh.h>
+#include <lsp-plug.in/dsp-units/3d/rt/lod.h>
+#include <lsp-plug.in/dsp-units/3d/Arena3D.h>
 #include <lsp-plug.in/dsp-units/3d/raytrace.h>
 #include <lsp-plug.in/dsp/dsp.h>
 #include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/common/atomic.h>
 #include <lsp-plug.in/ipc/Thread.h>
 #include <lsp-plug.in/ipc/Mutex.h>
+#include <lsp-plug.in/io/Path.h>
+#include <lsp-plug.in/io/IInStream.h>
+#include <lsp-plug.in/io/IOutStream.h>
 #include <lsp-plug.in/lltl/parray.h>
 #include <lsp-plug.in/lltl/darray.h>
 
@@ -48,13 +57,24 @@ namespace lsp
                 {
                     Sample             *sample;
                     size_t              channel;
+                    ssize_t             band;
                     ssize_t             r_min;
                     ssize_t             r_max;
                 } sample_t;
 
+                typedef struct rt_accum_t
+                {
+                    size_t                          channel;        // Channel of the target sample
+                    ssize_t                         band;           // Frequency band, negative for the broadband signal
+                    ssize_t                         r_min;          // Minimum reflection index
+                    ssize_t                         r_max;          // Maximum reflection index
+                    size_t                          length;         // Number of captured samples
+                    lltl::darray<float *>           chunks;         // Fixed-size chunks of data, NULL if not allocated
+                } rt_accum_t;
+
                 typedef struct rt_binding_t
                 {
-                    lltl::darray<sample_t>          bindings;       // Capture bindings
+                    lltl::parray<rt_accum_t>        bindings;       // Per-thread capture accumulators
                 } rt_binding_t;
 
                 typedef struct capture_t: public rt_capture_settings_t
@@ -63,15 +83,26 @@ namespace lsp
                     dsp::bound_box3d_t              bbox;           // Bounding box
                     lltl::darray<rt::triangle_t>    mesh;           // Mesh associated with capture
                     lltl::darray<sample_t>          bindings;       // Capture bindings
+                    float                           prune;          // Pruning threshold relative to the direct sound, 0 if disabled
                 } capture_t;
 
+                typedef struct rt_bands_t
+                {
+                    rt::band_material_t             material[RT_BANDS_MAX];     // Band materials
+                    float                           reflect[2][RT_BANDS_MAX];   // Gain of the reflected signal for each side
+                    float                           refract[2][RT_BANDS_MAX];   // Gain of the refracted signal for each side
+                } rt_bands_t;
+
                 typedef struct rt_object_t
                 {
                     dsp::bound_box3d_t              bbox;
                     lltl::darray<rtx::triangle_t>   mesh;
                     lltl::darray<rtx::edge_t>       plan;
+                    rt::bvh_t                       bvh;            // Bounding volume hierarchy of the mesh
+                    size_t                          index;          // Index of the object in the scene
                 } rt_object_t;
 
+            public:
                 typedef struct stats_t
                 {
                     uint64_t            root_tasks;
@@ -82,6 +113,20 @@ namespace lsp
                     uint64_t            calls_cullback;
                     uint64_t            calls_reflect;
                     uint64_t            calls_capture;
+                    uint64_t            stolen_tasks;       // Number of tasks stolen from other threads
+                    uint64_t            steal_attempts;     // Number of attempts to steal a task
+                    uint64_t            overflow_tasks;     // Number of tasks that did not fit into the work-stealing queue
+                    uint64_t            idle_loops;         // Number of idle loops while waiting for new tasks
+                    uint64_t            pruned_tasks;       // Number of contexts dropped by the pruning threshold
+                    uint64_t            time_scan;          // Time spent in scan_objects [ns]
+                    uint64_t            time_split;         // Time spent in split_view [ns]
+                    uint64_t            time_cullback;      // Time spent in cullback_view [ns]
+                    uint64_t            time_reflect;       // Time spent in reflect_view including capture [ns]
+                    uint64_t            time_capture;       // Time spent in capture [ns]
+                    uint64_t            time_idle;          // Time spent waiting for new tasks [ns]
+                    uint64_t            time_lock;          // Time spent waiting for the lock of the global task queue [ns]
+                    uint64_t            queue_peak;         // Peak number of tasks in the local queues of the thread
+                    uint64_t            memory_peak;        // Peak memory allocated by contexts [bytes]
                 } stats_t;
 
             protected:
@@ -89,64 +134,125 @@ namespace lsp
                 {
                     private:
                         RayTrace3D                     *trace;
+                        size_t                          index;          // Index of the thread
                         stats_t                         stats;
-                        lltl::parray<rt::context_t>     tasks;
+                        rt::task_queue_t                queue;          // Work-stealing queue
+                        lltl::parray<rt::context_t>     tasks;          // Private tasks, can not be stolen
+                        lltl::parray<rt::context_t>     deferred;       // Tasks deferred to the next pass
                         lltl::parray<rt_binding_t>      bindings;       // Bindings
-                        lltl::parray<rt_object_t>       objects;
-                        ssize_t                         heavy_state;
+                        lltl::parray<rt_object_t>       objects;        // Objects owned by the thread
+                        lltl::parray<rt_object_t>      *scene;          // Read-only objects used for scanning, shared between threads
+                        lltl::darray<ssize_t>           tags;           // Per-thread edge stamps indexed by the edge's itag
+                        bool                            shared;         // Submit tasks to the work-stealing queue
+                        ssize_t                         stamp;          // Edge stamp for object scanning
+                        Arena3D                        *arena;          // Memory arena for contexts
 
                     protected:
                         status_t    main_loop();
                         status_t    process_context(rt::context_t *ctx);
 
                         status_t    copy_objects(lltl::parray<rt_object_t> *src);
+                        status_t    index_edges();
                         status_t    scan_objects(rt::context_t *ctx);
+                        status_t    scan_captures(rt::context_t *ctx);
                         status_t    cull_view(rt::context_t *ctx);
                         status_t    split_view(rt::context_t *ctx);
                         status_t    cullback_view(rt::context_t *ctx);
                         status_t    reflect_view(rt::context_t *ctx);
-                        status_t    capture(capture_t *capture, lltl::darray<sample_t> *bindings, const rt::view_t *v);
+                        status_t    capture(capture_t *capture, rt_binding_t *binding, const rt::view_t *v);
 
                         status_t    generate_root_mesh();
+                        status_t    generate_scene_objects(rt::mesh_t *root, size_t obj_id);
+                        status_t    add_scene_object(rt::mesh_t *root, Object3D *obj, ssize_t oid, size_t idx, rt::material_t *m);
+                        status_t    use_prepared_scene(size_t obj_id);
                         status_t    generate_capture_mesh(size_t id, capture_t *c);
-                        status_t    generate_object_mesh(ssize_t id, rt_object_t *o, rt::mesh_t *src, Object3D *obj, const dsp::matrix3d_t *m);
+                        status_t    generate_object_mesh(ssize_t id, rt_object_t *o, rt::mesh_t *src, Object3D *obj);
                         status_t    generate_tasks(lltl::parray<rt::context_t> *tasks, float initial);
-                        status_t    check_object(rt::context_t *ctx, Object3D *obj, const dsp::matrix3d_t *m);
+                        status_t    check_object(rt::context_t *ctx, Object3D *obj);
 
                         status_t    submit_task(rt::context_t *ctx);
+                        rt::context_t  *fetch_task(bool *report);
+                        rt::context_t  *steal_task();
+                        void        drop_tasks();
 
                     public:
-                        explicit TaskThread(RayTrace3D *trace);
+                        explicit TaskThread(RayTrace3D *trace, size_t index);
                         virtual ~TaskThread();
 
                     public:
                         status_t    prepare_main_loop(float initial);
                         status_t    prepare_captures();
                         status_t    prepare_supplementary_loop(TaskThread *t);
+                        status_t    generate_prepared_scene();
 
                         virtual status_t run();
 
-                        status_t    merge_result();
+                        status_t    merge_result(Sample *dst);
+                        void        clear_captures();
 
                         inline stats_t *get_stats() { return &stats; }
+                        inline lltl::parray<rt_object_t> *get_objects() { return &objects; }
+                        inline lltl::parray<rt::context_t> *deferred_tasks() { return &deferred; }
+                };
+
+                class MergeThread: public ipc::Thread
+                {
+                    private:
+                        RayTrace3D                     *trace;
+
+                    public:
+                        explicit MergeThread(RayTrace3D *trace);
+                        virtual ~MergeThread();
+
+                    public:
+                        virtual status_t run();
                 };
 
             private:
                 lltl::darray<rt::material_t>        vMaterials;
+                lltl::darray<rt_bands_t>            vBands;         // Band materials of objects
+                lltl::darray<float>                 vLodError;      // Geometric error of the mesh simplification for objects
+                size_t                              nBands;         // Number of traced frequency bands
                 lltl::darray<rt_source_settings_t>  vSources;
                 lltl::parray<capture_t>             vCaptures;
                 Scene3D                            *pScene;
                 rt::progress_func_t                 pProgress;
                 void                               *pProgressData;
+                rt::checkpoint_func_t               pCheckpoint;
+                void                               *pCheckpointData;
+                lltl::darray<size_t>                vCheckpoints;   // Reflection limits for progressive rendering
+                lltl::darray<rt::bvh_node_t>        vCaptureTree;   // Bounding volume hierarchy of captures
+                lltl::darray<size_t>                vCaptureIndex;  // Capture identifiers ordered by the hierarchy
+                stats_t                             sStats;         // Overall statistics of completed passes
+                lltl::darray<stats_t>               vThreadStats;   // Statistics of each thread for completed passes
+                lltl::darray<size_t>                vQueueHistory;  // Size of the global task queue at each progress report
                 size_t                              nSampleRate;
                 float                               fEnergyThresh;
                 float                               fTolerance;
                 float                               fDetalization;
+                float                               fPruneThresh;   // Amplitude threshold for pruning contexts, computed before processing
                 bool                                bNormalize;
                 volatile bool                       bCancelled;
                 volatile bool                       bFailed;
 
+                lltl::parray<rt_object_t>           vPrepared;      // Prepared scene objects
+                size_t                              nPreparedObjects; // Number of scene objects the prepared scene was built for
+                bool                                bPrepared;      // Prepared scene is present
+
+                lltl::darray<rt::view_t>            vShardTasks;    // Root tasks loaded from the shard
+                size_t                              nShard;         // Index of the shard to process
+                size_t                              nShards;        // Overall number of shards
+                bool                                bShardTasks;    // Root tasks are loaded from the shard
+
                 lltl::parray<rt::context_t>         vTasks;
+                lltl::parray<TaskThread>            vThreads;       // List of all running threads
+                atomic_t                            nActive;        // Number of threads that are processing or searching tasks
+                lltl::parray<Arena3D>               vArenas;        // Per-thread memory arenas for contexts
+                lltl::parray<Sample>                vMerge;         // List of samples to merge results
+                atomic_t                            nMergeJob;      // Index of the next sample to merge
+                ssize_t                             nPassLimit;     // Maximum reflection number for current pass, negative if not limited
+                size_t                              nPass;          // Current pass
+                size_t                              nPasses;        // Overall number of passes
                 size_t                              nQueueSize;
                 size_t                              nProgressPoints;
                 size_t                              nProgressMax;
@@ -158,18 +264,35 @@ namespace lsp
                 static void clear_stats(stats_t *stats);
                 static void dump_stats(const char *label, const stats_t *stats);
                 static void merge_stats(stats_t *dst, const stats_t *src);
+                static void destroy_accum(rt_accum_t *accum);
+                static float *accum_chunk(rt_accum_t *accum, size_t offset);
 
                 static bool check_bound_box(const dsp::bound_box3d_t *bbox, const rt::view_t *view);
+                static void init_bands(rt_bands_t *bands, const rt::material_t *m);
+                static void update_bands(rt_bands_t *bands, size_t band);
 
+                status_t    create_arenas(size_t threads);
+                void        destroy_arenas();
                 void        remove_scene(bool destroy);
                 status_t    resize_materials(size_t objects);
 
                 status_t    report_progress(float progress);
+                status_t    generate_root_views(lltl::darray<rt::view_t> *views);
+                float       estimate_prune_threshold();
+                status_t    build_capture_tree();
+                ssize_t     build_capture_node(size_t first, size_t count, size_t depth);
 
                 // Main ray-tracing routines
-                void        normalize_output();
+                float       normalize_output();
+                void        scale_output(float gain);
                 bool        is_already_passed(const sample_t *bind);
 
+                status_t    prepare_merge();
+                status_t    merge_results(size_t threads);
+                status_t    merge_jobs();
+
+                status_t    run_pass(TaskThread *root, size_t threads, stats_t *overall);
+                status_t    publish_checkpoint(size_t checkpoint);
                 status_t    do_process(size_t threads, float initial);
 
             public:
@@ -202,6 +325,117 @@ namespace lsp
                  */
                 status_t set_scene(Scene3D *scene, bool destroy=true);
 
+                /**
+                 * Build the conflict-resolved mesh of the scene once and use it for all
+                 * subsequent process() calls. Positions of sources and captures can be changed
+                 * between calls, but any change of the scene objects (transformation, visibility)
+                 * requires the scene to be prepared again. Setting new scene drops the prepared scene.
+                 * Captures are not conflict-resolved with the prepared scene, so they should
+                 * not intersect scene objects.
+                 * @return status of operation
+                 */
+                status_t prepare_scene();
+
+                /**
+                 * Drop the prepared scene, the mesh will be generated on each process() call
+                 */
+                void clear_prepared_scene();
+
+                /**
+                 * Check that scene is prepared
+                 * @return true if scene is prepared
+                 */
+                inline bool is_scene_prepared() const { return bPrepared; }
+
+                /**
+                 * Save the prepared scene to the binary file
+                 * @param path path to the file
+                 * @return status of operation
+                 */
+                status_t save_prepared_scene(const char *path);
+                status_t save_prepared_scene(const LSPString *path);
+                status_t save_prepared_scene(const io::Path *path);
+                status_t save_prepared_scene(io::IOutStream *os);
+
+                /**
+                 * Load the prepared scene from the binary file, the scene should be set
+                 * and should contain the same number of objects as at the preparation time
+                 * @param path path to the file
+                 * @return status of operation
+                 */
+                status_t load_prepared_scene(const char *path);
+                status_t load_prepared_scene(const LSPString *path);
+                status_t load_prepared_scene(const io::Path *path);
+                status_t load_prepared_scene(io::IInStream *is);
+
+                /**
+                 * Select the shard of root tasks to process. Root tasks are enumerated in
+                 * the same order on each node, the task is processed if its index modulo
+                 * the number of shards is equal to the index of the shard. The output of the
+                 * sharded trace is not normalized, see merge_shard() and normalize_captures().
+                 * @param index index of the shard
+                 * @param count overall number of shards
+                 * @return status of operation
+                 */
+                status_t set_shard(size_t index, size_t count);
+
+                /**
+                 * Process all root tasks and drop the root tasks loaded by load_shard()
+                 */
+                void clear_shard();
+
+                inline size_t shard_index() const { return nShard; }
+                inline size_t shard_count() const { return nShards; }
+
+                /**
+                 * Check that the trace processes only the part of root tasks
+                 * @return true if the trace is sharded
+                 */
+                inline bool is_sharded() const { return (nShards > 1) || (bShardTasks); }
+
+                /**
+                 * Save the prepared scene and the root tasks of the shard for processing
+                 * by the remote worker. The sources are not required by the worker anymore
+                 * but materials and captures should be configured in the same way.
+                 * @param path path to the file
+                 * @param index index of the shard
+                 * @param count overall number of shards
+                 * @return status of operation
+                 */
+                status_t save_shard(const char *path, size_t index, size_t count);
+                status_t save_shard(const LSPString *path, size_t index, size_t count);
+                status_t save_shard(const io::Path *path, size_t index, size_t count);
+                status_t save_shard(io::IOutStream *os, size_t index, size_t count);
+
+                /**
+                 * Load the prepared scene and the root tasks of the shard, the scene
+                 * should be set and should contain the same number of objects as
+                 * at the preparation time
+                 * @param path path to the file
+                 * @return status of operation
+                 */
+                status_t load_shard(const char *path);
+                status_t load_shard(const LSPString *path);
+                status_t load_shard(const io::Path *path);
+                status_t load_shard(io::IInStream *is);
+
+                /**
+                 * Merge the partial capture result of the shard into the target sample.
+                 * Results are summed, so merging the shards in the same order gives the
+                 * same output on each run
+                 * @param dst target sample
+                 * @param src partial result of the shard
+                 * @return status of operation
+                 */
+                static status_t merge_shard(Sample *dst, const Sample *src);
+
+                /**
+                 * Normalize the samples bound to captures, should be called after
+                 * merging the results of all shards
+                 * @return the applied norming factor
+                 */
+                float normalize_captures();
+
                 /**
                  * Set/clear progress callback
                  * @param callback callback routine to report progress
@@ -216,6 +450,42 @@ namespace lsp
                  */
                 status_t clear_progress_callback();
 
+                /**
+                 * Set/clear checkpoint callback for progressive rendering
+                 * @param callback callback routine to publish partial result
+                 * @param data data that will be passed to callback routine
+                 * @return status of operation
+                 */
+                status_t set_checkpoint_callback(rt::checkpoint_func_t callback, void *data);
+
+                /**
+                 * Clear checkpoint callback
+                 * @return status of operation
+                 */
+                status_t clear_checkpoint_callback();
+
+                /**
+                 * Enable progressive rendering. The trace is performed in several passes,
+                 * each pass traces reflections up to the specified limit and then publishes
+                 * the partial (normalized if normalization is enabled) impulse response
+                 * to the captures through the checkpoint callback. The last pass is not limited.
+                 * @param reflections strictly ascending list of reflection limits for checkpoints
+                 * @param count number of elements in the list, zero disables progressive mode
+                 * @return status of operation
+                 */
+                status_t set_progressive(const size_t *reflections, size_t count);
+
+                /**
+                 * Disable progressive rendering
+                 */
+                inline void clear_progressive() { vCheckpoints.flush(); }
+
+                /**
+                 * Get number of checkpoints for progressive rendering
+                 * @return number of checkpoints
+                 */
+                inline size_t checkpoints() const { return vCheckpoints.size(); }
+
                 /**
                  * Set the material for the corresponding object
                  * @param idx the index of the material
@@ -231,6 +501,59 @@ namespace lsp
                  */
                 status_t    get_material(rt::material_t *material, size_t idx);
 
+                /**
+                 * Set the number of frequency bands traced in one pass. Each view carries the
+                 * amplitude for each band, the geometry is traced only once for all bands
+                 * @param bands number of bands, zero disables the band processing
+                 * @return status of operation
+                 */
+                status_t    set_bands(size_t bands);
+
+                /**
+                 * Get the number of frequency bands traced in one pass
+                 * @return number of bands
+                 */
+                inline size_t get_bands() const { return nBands; }
+
+                /**
+                 * Set the band material for the corresponding object. Only absorption
+                 * and transparency depend on the band because diffusion, dispersion and
+                 * permeability change the geometry of the trace. The set_material() call
+                 * resets band materials of the object to the broadband material
+                 * @param idx the index of the corresponding object
+                 * @param band the index of the band
+                 * @param material band material
+                 * @return status of operation
+                 */
+                status_t    set_band_material(size_t idx, size_t band, const rt::band_material_t *material);
+
+                /**
+                 * Get the band material for the corresponding object
+                 * @param material pointer to store the band material
+                 * @param idx the index of the corresponding object
+                 * @param band the index of the band
+                 * @return status of operation
+                 */
+                status_t    get_band_material(rt::band_material_t *material, size_t idx, size_t band);
+
+                /**
+                 * Set the maximum geometric error of the mesh simplification for the corresponding
+                 * object. Details of the object which deviate from the surface less than the error
+                 * are removed by collapsing edges before the object is added to the trace. The
+                 * prepared scene keeps the geometry simplified at the moment of preparation
+                 * @param idx the index of the corresponding object
+                 * @param error maximum geometric error in units of the scene, zero disables simplification
+                 * @return status of operation
+                 */
+                status_t    set_lod_error(size_t idx, float error);
+
+                /**
+                 * Get the maximum geometric error of the mesh simplification for the corresponding object
+                 * @param idx the index of the corresponding object
+                 * @return maximum geometric error, zero if simplification is disabled or the object does not exist
+                 */
+                float       get_lod_error(size_t idx) const;
+
                 /**
                  * Get the scene object
                  * @param idx scene object
@@ -275,6 +598,18 @@ namespace lsp
                  */
                 status_t    bind_capture(size_t id, Sample *sample, size_t channel, ssize_t r_min, ssize_t r_max);
 
+                /**
+                 * Bind audio sample to the frequency band of the capture
+                 * @param id capture identifier
+                 * @param band the index of the frequency band, see set_bands()
+                 * @param sample audio sample to bind
+                 * @param channel number of channel of the sample that will be modified by capture
+                 * @param r_min the minimum reflection index, negative value for any
+                 * @param r_max the maximum reflection index, negative value for any
+                 * @return status of operation
+                 */
+                status_t    bind_capture_band(size_t id, size_t band, Sample *sample, size_t channel, ssize_t r_min, ssize_t r_max);
+
                 /** Remove all audio sources
                  *
                  */
@@ -285,6 +620,25 @@ namespace lsp
                  */
                 inline void         clear_captures()    {   vCaptures.flush();      };
 
+                /**
+                 * Set the adaptive pruning threshold of the capture. The context is dropped when
+                 * its amplitude is below the threshold of each capture. The threshold is relative
+                 * to the level of the direct sound at the capture which is estimated from the sources,
+                 * so workers of the sharded trace should have the same sources to produce the same output.
+                 * Pruning is disabled if at least one capture has no threshold.
+                 * @param id capture identifier
+                 * @param db threshold relative to the direct sound [dB], -INFINITY disables pruning
+                 * @return status of operation
+                 */
+                status_t            set_prune_threshold(size_t id, float db);
+
+                /**
+                 * Get the adaptive pruning threshold of the capture
+                 * @param id capture identifier
+                 * @return threshold relative to the direct sound [dB], -INFINITY if disabled
+                 */
+                float               get_prune_threshold(size_t id) const;
+
                 inline float        get_energy_threshold() const { return fEnergyThresh; }
 
                 void                set_energy_threshold(float thresh) { fEnergyThresh = thresh; }
@@ -305,6 +659,49 @@ namespace lsp
                  */
                 inline bool         cancelled() const { return bCancelled; }
 
+                /**
+                 * Get the overall statistics of the last process() call. When called from the
+                 * progress callback, the statistics include the counters of running threads
+                 * which are read without synchronization and thus are approximate
+                 * @param dst pointer to store the statistics
+                 */
+                void                get_stats(stats_t *dst);
+
+                /**
+                 * Add the memory footprint of the ray tracing processor to the report.
+                 * Only persistent structures are accounted: materials, captures, prepared
+                 * scene and context arenas, the scene object is owned by the caller
+                 * @param r report to update
+                 */
+                void                memory_usage(memory_report_t *r) const;
+
+                /**
+                 * Get the statistics of the thread for the last process() call
+                 * @param dst pointer to store the statistics
+                 * @param index index of the thread
+                 * @return status of operation
+                 */
+                status_t            get_thread_stats(stats_t *dst, size_t index);
+
+                /**
+                 * Get number of threads which have the statistics
+                 * @return number of threads
+                 */
+                inline size_t       stats_threads() const { return vThreadStats.size(); }
+
+                /**
+                 * Get the history of the global task queue size, the size is stored
+                 * each time the progress is reported
+                 * @return pointer to the history, valid until the next process() call
+                 */
+                inline const size_t *queue_history() { return vQueueHistory.array(); }
+
+                /**
+                 * Get the number of entries in the history of the global task queue size
+                 * @return number of entries
+                 */
+                inline size_t       queue_history_size() const { return vQueueHistory.size(); }
+
                 /**
                  * This method allows to cancel the execution of process() method by
                  * another thread, RT-safe method
@@ -32,6 +32,7 @@
 #include <lsp-plug.in/io/Path.h>
 #include <lsp-plug.in/io/IInStream.h>
 #include <lsp-plug.in/io/IInSequence.h>
+#include <lsp-plug.in/io/IOutStream.h>
 
 namespace lsp
 {
@@ -63,6 +64,7 @@ namespace lsp
 
                 status_t    load_internal(io::IInStream *is, size_t flags, const char *charset);
                 status_t    load_internal(io::IInSequence *is, size_t flags);
+                status_t    load_binary_internal(const uint8_t *data, size_t size);
 
             public:
                 /** Default constructor
@@ -141,6 +143,101 @@ namespace lsp
                  */
                 status_t    load(io::IInSequence *is, size_t flags = WRAP_NONE);
 
+                /**
+                 * Load scene from the UTF-8 encoded OBJ file using multiple threads. The file
+                 * is mapped into the memory and split into line-aligned chunks that are parsed
+                 * concurrently, then the parsed data is merged into the scene. Files that use
+                 * statements not supported by the chunk parser are loaded sequentially
+                 * @param path path to the file (UTF-8 string)
+                 * @param threads number of threads including the calling thread
+                 * @return status of operation
+                 */
+                status_t    load_parallel(const char *path, size_t threads);
+
+                /**
+                 * Load scene from the UTF-8 encoded OBJ file using multiple threads
+                 * @param path path to the file
+                 * @param threads number of threads including the calling thread
+                 * @return status of operation
+                 */
+                status_t    load_parallel(const LSPString *path, size_t threads);
+
+                /**
+                 * Load scene from the UTF-8 encoded OBJ file using multiple threads
+                 * @param path path to the file
+                 * @param threads number of threads including the calling thread
+                 * @return status of operation
+                 */
+                status_t    load_parallel(const io::Path *path, size_t threads);
+
+                /**
+                 * Load scene from the memory buffer that contains UTF-8 encoded OBJ data
+                 * using multiple threads
+                 * @param data pointer to the data
+                 * @param size size of the data in bytes
+                 * @param threads number of threads including the calling thread
+                 * @return status of operation
+                 */
+                status_t    load_parallel(const void *data, size_t size, size_t threads);
+
+                /**
+                 * Load scene from the binary file, the file is mapped into the memory
+                 * and data is adopted by the scene in bulk without any parsing
+                 * @param path path to the file (UTF-8 string)
+                 * @return status of operation
+                 */
+                status_t    load_binary(const char *path);
+
+                /**
+                 * Load scene from the binary file
+                 * @param path path to the file
+                 * @return status of operation
+                 */
+                status_t    load_binary(const LSPString *path);
+
+                /**
+                 * Load scene from the binary file
+                 * @param path path to the file
+                 * @return status of operation
+                 */
+                status_t    load_binary(const io::Path *path);
+
+                /**
+                 * Load scene from the memory buffer that contains binary scene data
+                 * @param data pointer to the data
+                 * @param size size of the data in bytes
+                 * @return status of operation
+                 */
+                status_t    load_binary(const void *data, size_t size);
+
+                /**
+                 * Save scene to the binary file
+                 * @param path path to the file (UTF-8 string)
+                 * @return status of operation
+                 */
+                status_t    save_binary(const char *path);
+
+                /**
+                 * Save scene to the binary file
+                 * @param path path to the file
+                 * @return status of operation
+                 */
+                status_t    save_binary(const LSPString *path);
+
+                /**
+                 * Save scene to the binary file
+                 * @param path path to the file
+                 * @return status of operation
+                 */
+                status_t    save_binary(const io::Path *path);
+
+                /**
+                 * Save scene to the output stream in binary format
+                 * @param os output stream
+                 * @return status of operation
+                 */
+                status_t    save_binary(io::IOutStream *os);
+
             public:
                 /**
                  * Do some post-processing after loading scene from file
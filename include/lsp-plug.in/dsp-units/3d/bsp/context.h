@@ -32,18 +32,71 @@
 #include <lsp-plug.in/lltl/parray.h>
 #include <lsp-plug.in/lltl/darray.h>
 
+/**
+ * Minimum number of independent subtrees per thread to start the parallel build
+ */
+#define BSP_SUBTREES_PER_THREAD         4
+
 namespace lsp
 {
     namespace dspu
     {
         namespace bsp
         {
+            struct context_t;
+
+            /**
+             * Persistent interleaved vertex buffer updated incrementally by the
+             * context_t::build_mesh() call. After each update the list of dirty
+             * ranges contains the vertices that have changed since the previous
+             * update, so only these ranges need to be uploaded to the GPU
+             */
+            typedef struct vbuffer_t
+            {
+                private:
+                    vbuffer_t (const vbuffer_t &);
+                    vbuffer_t & operator = (const vbuffer_t &);
+
+                public:
+                    lltl::darray<view::vertex3d_t>  vertex;         // Vertices in the back-to-front order
+                    lltl::darray<bsp::range_t>      dirty;          // Ranges of vertices changed by the last update
+                    const context_t                *owner;          // The context the buffer has been built for
+                    size_t                          version;        // The version of the owner's tree
+
+                public:
+                    explicit vbuffer_t()
+                    {
+                        owner       = NULL;
+                        version     = 0;
+                    }
+
+                    ~vbuffer_t()
+                    {
+                        flush();
+                    }
+
+                public:
+                    /**
+                     * Forget the contents, the next update will emit all vertices
+                     */
+                    inline void flush()
+                    {
+                        vertex.flush();
+                        dirty.flush();
+                        owner       = NULL;
+                        version     = 0;
+                    }
+            } vbuffer_t;
+
             typedef struct context_t
             {
                 private:
                     context_t (const context_t &);
                     context_t & operator = (const context_t &);
 
+                protected:
+                    class BuildThread;
+
                 public:
                     Allocator3D<bsp::node_t>        node;
                     Allocator3D<bsp::triangle_t>    triangle;
@@ -53,8 +106,25 @@ namespace lsp
                     explicit context_t();
                     ~context_t();
 
+                protected:
+                    lltl::parray<bsp::context_t>    subtrees;       // Contexts that hold subtrees built in parallel
+                    lltl::darray<dsp::raw_triangle_t> source;       // Source triangles of objects
+                    lltl::darray<bsp::triangle_t>   cache;          // Transformed triangles of objects
+                    lltl::darray<bsp::object_t>     objects;        // Added objects
+                    lltl::darray<dsp::vector3d_t>   cull;           // Planes of the culling volume
+                    bool                            dirty;          // The tree does not match the transformed triangles
+                    size_t                          version;        // The version of the tree, changes on each rebuild
+                    const bsp::vbuffer_t           *mesh;           // The persistent mesh that matches the state of nodes
+
                 protected:
                     status_t split(lltl::parray<bsp::node_t> &queue, bsp::node_t *task);
+                    status_t build_subtrees(lltl::parray<bsp::node_t> *queue);
+                    status_t build_parallel(lltl::parray<bsp::node_t> *queue, size_t threads);
+                    status_t add_source(size_t count, const dsp::matrix3d_t *transform, const dsp::color3d_t *color);
+                    void transform_object(const bsp::object_t *obj);
+                    bool is_culled(const dsp::point3d_t *c, float r) const;
+                    bool count_vertices();
+                    void destroy_subtrees();
 
                 public:
                     void clear();
@@ -63,21 +133,49 @@ namespace lsp
                     inline void swap(context_t *dst)
                     {
                         lsp::swap(root, dst->root);
+                        lsp::swap(dirty, dst->dirty);
+                        ++version;
+                        ++dst->version;
+                        lsp::swap(mesh, dst->mesh);
                         node.swap(&dst->node);
                         triangle.swap(&dst->triangle);
+                        subtrees.swap(&dst->subtrees);
+                        source.swap(&dst->source);
+                        cache.swap(&dst->cache);
+                        objects.swap(&dst->objects);
+                        cull.swap(&dst->cull);
                     }
 
                     /**
-                     * Add object to context
+                     * Get number of objects added to the context
+                     * @return number of objects
+                     */
+                    inline size_t num_objects() const { return objects.size(); }
+
+                    /**
+                     * Set the culling volume. Objects added with their own transformation
+                     * matrix are rejected as a whole if the cached world-space bounding
+                     * sphere of the object lies entirely outside of the volume
+                     * @param pl array of planes, the normal of each plane is directed inside the volume
+                     * @param n number of planes
+                     * @return status of operation
+                     */
+                    status_t set_cull_planes(const dsp::vector3d_t *pl, size_t n);
+
+                    /**
+                     * Remove the culling volume
+                     */
+                    void clear_cull_planes();
+
+                    /**
+                     * Add object to context using the object's transformation matrix.
+                     * The object outside of the culling volume is registered without triangles
+                     * to keep the indexes of objects
                      * @param obj object to add
-                     * @param oid unique id to identify the object
                      * @param col object color
                      * @return status of operation
                      */
-                    inline status_t add_object(Object3D *obj, const dsp::color3d_t *col)
-                    {
-                        return add_object(obj, obj->matrix(), col);
-                    }
+                    status_t add_object(Object3D *obj, const dsp::color3d_t *col);
 
                     /**
                      * Add object to context
@@ -111,6 +209,34 @@ namespace lsp
                      */
                     status_t build_tree();
 
+                    /**
+                     * Build the BSP tree using multiple threads. The top levels of the tree
+                     * are split by the caller's thread until there are enough independent
+                     * subtrees, then the subtrees are split in parallel
+                     * @param threads number of threads to use, values less than 2 mean serial build
+                     * @return status of operation
+                     */
+                    status_t build_tree(size_t threads);
+
+                    /**
+                     * Update the transformation matrix of the previously added object.
+                     * Only triangles of this object are transformed again, the tree
+                     * becomes outdated until rebuild_tree() is called
+                     * @param id the index of the object in the order of adding
+                     * @param transform new transformation matrix
+                     * @return status of operation
+                     */
+                    status_t set_transform(size_t id, const dsp::matrix3d_t *transform);
+
+                    /**
+                     * Rebuild the BSP tree from the cached transformed triangles without
+                     * adding objects again. Does nothing if the transforms were not changed
+                     * since the last build
+                     * @param threads number of threads to use, values less than 2 mean serial build
+                     * @return status of operation
+                     */
+                    status_t rebuild_tree(size_t threads = 1);
+
                     /**
                      * Build the final mesh according to the viewer's plane
                      * @param dst collection to store the mesh
@@ -119,6 +245,20 @@ namespace lsp
                      */
                     status_t build_mesh(lltl::darray<view::vertex3d_t> *dst, const dsp::point3d_t *pov);
 
+                    /**
+                     * Update the persistent mesh according to the viewer's plane. The vertices
+                     * of subtrees which keep their back-to-front order for the new point of view
+                     * are not written again. All vertices are emitted if the buffer has been
+                     * built for another context, the context has updated another buffer or the
+                     * tree has been rebuilt since the last update.
+                     * The dirty ranges of the buffer are replaced by the ranges changed by this call
+                     * and are sorted in the ascending order
+                     * @param dst persistent vertex buffer to update
+                     * @param pov the viewer's point-of-view location
+                     * @return status of operation
+                     */
+                    status_t build_mesh(bsp::vbuffer_t *dst, const dsp::point3d_t *pov);
+
             } context_t;
         } // namespace bsp
     } // namespace dspu
@@ -47,8 +47,24 @@ namespace lsp
                 bsp::node_t            *in;
                 bsp::node_t            *out;
                 bsp::triangle_t        *on;
+                size_t                  vcount;     // Number of vertices emitted by the subtree
+                ssize_t                 side;       // Side of the point of view at the last incremental build
                 bool                    emit;
             } node_t;
+
+            typedef struct range_t
+            {
+                size_t                  first;      // Index of the first vertex
+                size_t                  count;      // Number of vertices
+            } range_t;
+
+            typedef struct object_t
+            {
+                size_t                  first;      // Index of the first source triangle
+                size_t                  count;      // Number of source triangles
+                dsp::matrix3d_t         matrix;     // Transformation matrix
+                dsp::color3d_t          color;      // Color of triangles
+            } object_t;
         } // namespace bsp
     } // namespace dspu
 } // namespace lsp
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_3D_RT_BVH_H_
+#define LSP_PLUG_IN_DSP_UNITS_3D_RT_BVH_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/3d/rt/types.h>
+#include <lsp-plug.in/lltl/darray.h>
+
+// Maximum number of triangles stored in the leaf node
+#define RT_BVH_LEAF_SIZE        16
+// Maximum depth of the tree, the tree is balanced so it is more than enough
+#define RT_BVH_MAX_DEPTH        48
+
+namespace lsp
+{
+    namespace dspu
+    {
+        namespace rt
+        {
+            /**
+             * Node of the bounding volume hierarchy
+             */
+            typedef struct bvh_node_t
+            {
+                dsp::bound_box3d_t  bbox;       // Bounding box of all triangles of the node
+                size_t              first;      // Index of the first triangle of the node
+                size_t              count;      // Number of triangles covered by the node
+                size_t              left;       // Index of the left child, 0 for leaf nodes
+                size_t              right;      // Index of the right child, 0 for leaf nodes
+            } bvh_node_t;
+
+            /**
+             * Bounding volume hierarchy built over the triangles of the object.
+             * The node with index 0 is always the root node.
+             */
+            typedef struct bvh_t
+            {
+                private:
+                    bvh_t(const bvh_t &);
+                    bvh_t & operator = (const bvh_t &);
+
+                public:
+                    lltl::darray<bvh_node_t>    nodes;      // List of nodes
+
+                protected:
+                    ssize_t         build_node(rtx::triangle_t *vt, size_t first, size_t count, size_t depth);
+                    static void     calc_bound_box(dsp::bound_box3d_t *bbox, const rtx::triangle_t *vt, size_t count);
+                    static void     select(rtx::triangle_t *vt, size_t count, size_t k, size_t axis);
+
+                public:
+                    explicit bvh_t();
+                    ~bvh_t();
+
+                public:
+                    /**
+                     * Check that hierarchy is empty
+                     * @return true if hierarchy is empty
+                     */
+                    inline bool     is_empty() const    { return nodes.size() <= 0; }
+
+                    /**
+                     * Flush hierarchy and release memory
+                     */
+                    inline void     flush()             { nodes.flush();            }
+
+                    /**
+                     * Build the hierarchy, the order of triangles will be changed
+                     * so that each node covers the contiguous range of triangles
+                     * @param vt array of triangles
+                     * @param n number of triangles
+                     * @return status of operation
+                     */
+                    status_t        build(rtx::triangle_t *vt, size_t n);
+
+                    /**
+                     * Copy the hierarchy from another one
+                     * @param src source hierarchy
+                     * @return status of operation
+                     */
+                    status_t        copy(const bvh_t *src);
+            } bvh_t;
+
+            /**
+             * Check that bounding box is potentially visible from the view
+             * @param bbox bounding box
+             * @param view view
+             * @return true if the bounding box is potentially visible
+             */
+            bool check_bound_box(const dsp::bound_box3d_t *bbox, const rt::view_t *view);
+
+        } // namespace rt
+    } // namespace dspu
+} // namespace lsp
+
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_3D_RT_BVH_H_ */
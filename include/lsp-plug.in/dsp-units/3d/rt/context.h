@@ -26,9 +26,13 @@
 #include <lsp-plug.in/dsp-units/3d/rt/types.h>
 #include <lsp-plug.in/dsp-units/3d/rt/mesh.h>
 #include <lsp-plug.in/dsp-units/3d/rt/plan.h>
+#include <lsp-plug.in/dsp-units/3d/rt/bvh.h>
 #include <lsp-plug.in/dsp-units/3d/Allocator3D.h>
 #include <lsp-plug.in/dsp-units/3d/Object3D.h>
 
+// Number of triangles classified against the plane in one batch
+#define RT_CONTEXT_BATCH_SIZE       8
+
 namespace lsp
 {
     namespace dspu
@@ -59,6 +63,18 @@ namespace lsp
                         float               w;          // Weight of edge
                     } rt_triangle_sort_t;
 
+                    /**
+                     * Structure-of-arrays layout of the triangle batch,
+                     * coordinates of the same vertex of all triangles are stored
+                     * contiguously so the plane classification can be vectorized
+                     */
+                    typedef struct rt_triangle_batch_t
+                    {
+                        float               x[3][RT_CONTEXT_BATCH_SIZE];
+                        float               y[3][RT_CONTEXT_BATCH_SIZE];
+                        float               z[3][RT_CONTEXT_BATCH_SIZE];
+                    } rt_triangle_batch_t;
+
                 public:
                     rt::view_t                  view;       // Ray tracing point of view
                     rt::context_state_t         state;      // Context state
@@ -68,6 +84,7 @@ namespace lsp
 
                 protected:
                     static int      compare_triangles(const void *p1, const void *p2);
+                    static void     classify_triangles(uint8_t *tags, const rt::triangle_t *vt, size_t n, const dsp::vector3d_t *pl);
                     status_t        add_triangle(const rtm::triangle_t *t);
                     status_t        add_triangle(const rt::triangle_t *t);
                     status_t        add_edge(const rtm::edge_t *e);
@@ -78,6 +95,8 @@ namespace lsp
                     explicit context_t();
                     explicit context_t(const rt::view_t *view);
                     explicit context_t(const rt::view_t *view, rt::context_state_t state);
+                    explicit context_t(Arena3D *arena);
+                    explicit context_t(const rt::view_t *view, rt::context_state_t state, Arena3D *arena);
 
                     ~context_t();
 
@@ -137,14 +156,30 @@ namespace lsp
                     status_t        add_opaque_object(const rt::triangle_t *vt, size_t n);
 
                     /**
-                     * Add object for capturing data.
+                     * Add object for capturing data. The object data is not modified, edges
+                     * are marked in the external array of tags, so the same object can be
+                     * shared between several threads.
+                     *
                      * @param vt array of raw triangles
-                     * @param ve array of edges that should be added to plan
                      * @param nt number of raw triangles
-                     * @param ne number of edges that should be added to plan
+                     * @param tags array of edge tags indexed by the itag field of the edge
+                     * @param stamp unique positive stamp of the call, used for marking edges
+                     * @return status of operation
+                     */
+                    status_t        add_object(const rtx::triangle_t *vt, size_t nt, ssize_t *tags, ssize_t stamp);
+
+                    /**
+                     * Add object for capturing data using the bounding volume hierarchy.
+                     * Only triangles of the nodes that are potentially visible from the view
+                     * are added to the context.
+                     *
+                     * @param vt array of raw triangles the hierarchy was built for
+                     * @param bvh bounding volume hierarchy
+                     * @param tags array of edge tags indexed by the itag field of the edge
+                     * @param stamp unique positive stamp of the call, used for marking edges
                      * @return status of operation
                      */
-                    status_t        add_object(rtx::triangle_t *vt, rtx::edge_t *ve, size_t nt, size_t ne);
+                    status_t        add_object(const rtx::triangle_t *vt, const rt::bvh_t *bvh, ssize_t *tags, ssize_t stamp);
 
                     /**
                      * Cull view with the view planes
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_3D_RT_LOD_H_
+#define LSP_PLUG_IN_DSP_UNITS_3D_RT_LOD_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/3d/rt/types.h>
+#include <lsp-plug.in/dsp-units/3d/Object3D.h>
+#include <lsp-plug.in/lltl/darray.h>
+
+// Maximum number of simplification passes
+#define RT_LOD_MAX_PASSES       32
+
+namespace lsp
+{
+    namespace dspu
+    {
+        namespace rt
+        {
+            /**
+             * Triangle of the simplified mesh
+             */
+            typedef struct lod_triangle_t
+            {
+                size_t              v[3];       // Indexes of vertexes
+                ssize_t             face;       // Face identifier
+            } lod_triangle_t;
+
+            /**
+             * Level-of-detail mesh of the object: indexed triangle list in world
+             * coordinates which can be simplified by collapsing edges
+             */
+            typedef struct lod_t
+            {
+                private:
+                    lod_t(const lod_t &);
+                    lod_t & operator = (const lod_t &);
+
+                public:
+                    lltl::darray<dsp::point3d_t>    vertex;     // List of vertexes
+                    lltl::darray<lod_triangle_t>    triangle;   // List of triangles
+
+                protected:
+                    typedef struct quadric_t
+                    {
+                        double              k[10];      // Symmetric 4x4 matrix of the quadric
+                    } quadric_t;
+
+                protected:
+                    static void     add_plane(quadric_t *q, const dsp::point3d_t *p0, const dsp::point3d_t *p1, const dsp::point3d_t *p2);
+                    static double   eval(const quadric_t *a, const quadric_t *b, const dsp::point3d_t *p);
+                    static bool     check_flip(const dsp::point3d_t *p0, const dsp::point3d_t *p1, const dsp::point3d_t *p2, const dsp::point3d_t *np);
+                    status_t        simplify_pass(lltl::darray<quadric_t> *q, double thresh, size_t *collapsed);
+                    status_t        compact();
+
+                public:
+                    explicit lod_t();
+                    ~lod_t();
+
+                public:
+                    /**
+                     * Flush contents and release memory
+                     */
+                    void            flush();
+
+                    /**
+                     * Initialize mesh with the triangles of the object
+                     * @param obj object
+                     * @param transform transformation matrix to apply to the object
+                     * @return status of operation
+                     */
+                    status_t        init(Object3D *obj, const dsp::matrix3d_t *transform);
+
+                    /**
+                     * Simplify the mesh by collapsing edges. The vertex is moved to the
+                     * adjacent vertex only if the sum of squared distances to the planes of
+                     * the original triangles does not exceed the square of the error, the
+                     * open boundaries of the mesh are kept intact
+                     * @param error maximum geometric error
+                     * @return status of operation
+                     */
+                    status_t        simplify(float error);
+            } lod_t;
+
+        } // namespace rt
+    } // namespace dspu
+} // namespace lsp
+
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_3D_RT_LOD_H_ */
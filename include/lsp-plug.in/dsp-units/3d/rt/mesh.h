@@ -24,8 +24,10 @@
 
 #include <lsp-plug.in/dsp-units/version.h>
 #include <lsp-plug.in/dsp-units/3d/rt/types.h>
+#include <lsp-plug.in/dsp-units/3d/rt/lod.h>
 #include <lsp-plug.in/dsp-units/3d/Allocator3D.h>
 #include <lsp-plug.in/dsp-units/3d/Object3D.h>
+#include <lsp-plug.in/lltl/darray.h>
 
 namespace lsp
 {
@@ -48,6 +50,27 @@ namespace lsp
                     explicit mesh_t();
                     ~mesh_t();
 
+                protected:
+                    typedef struct conflict_link_t
+                    {
+                        size_t                      edge;       // Index of the edge
+                        ssize_t                     next;       // Index of the next link in the cell, negative for the last one
+                    } conflict_link_t;
+
+                    typedef struct conflict_grid_t
+                    {
+                        float                       min[3];     // Minimum coordinates of the grid
+                        float                       max[3];     // Maximum coordinates of the grid
+                        float                       k[3];       // Number of cells per unit of length
+                        size_t                      dim[3];     // Number of cells for each axis
+                        size_t                      count;      // Number of edges linked to the grid
+                        size_t                      stamp;      // Stamp of the last lookup
+                        lltl::darray<ssize_t>       head;       // First link of each cell
+                        lltl::darray<conflict_link_t> links;    // Links between cells and edges
+                        lltl::darray<size_t>        mark;       // Stamp of the last lookup for each edge
+                        lltl::darray<size_t>        cand;       // Candidate edges of the last lookup
+                    } conflict_grid_t;
+
                 protected:
                     bool            validate_list(rtm::edge_t *e);
                     static ssize_t  linked_count(rtm::triangle_t *t, rtm::edge_t *e);
@@ -57,6 +80,11 @@ namespace lsp
                     static bool     unlink_triangle(rtm::triangle_t *t, rtm::edge_t *e);
                     static status_t arrange_triangle(rtm::triangle_t *ct, rtm::edge_t *e);
 
+                    static void     grid_range(const conflict_grid_t *g, size_t *first, size_t *last, const dsp::point3d_t * const *p, size_t n);
+                    status_t        grid_init(conflict_grid_t *g);
+                    status_t        grid_update(conflict_grid_t *g);
+                    static status_t grid_lookup(conflict_grid_t *g, const rtm::triangle_t *t);
+
                 public:
                     /**
                      * Clear mesh: clear underlying structures
@@ -111,9 +139,20 @@ namespace lsp
                      */
                     status_t        add_object(Object3D *obj, ssize_t oid, const dsp::matrix3d_t *transform, rt::material_t *material);
 
+                    /**
+                     * Add object to context using the level-of-detail mesh
+                     * @param lod level-of-detail mesh of the object in world coordinates
+                     * @param oid unique id to identify the object
+                     * @param material material that describes behaviour of reflected rays
+                     * @return status of operation
+                     */
+                    status_t        add_object(const rt::lod_t *lod, ssize_t oid, rt::material_t *material);
+
                     /**
                      * Remove conflicts between triangles, does not modify the 'itag' field of
-                     * triangle, so it can be used to identify objects of the scene
+                     * triangle, so it can be used to identify objects of the scene. Only
+                     * the edges which are located near the triangle in the uniform grid
+                     * are tested for intersection with the triangle
                      *
                      * @return status of operation
                      */
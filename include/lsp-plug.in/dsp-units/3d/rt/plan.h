@@ -47,6 +47,7 @@ namespace lsp
 
                 public:
                     explicit plan_t();
+                    explicit plan_t(Arena3D *arena);
                     ~plan_t();
 
                 public:
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_3D_RT_QUEUE_H_
+#define LSP_PLUG_IN_DSP_UNITS_3D_RT_QUEUE_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/common/status.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        namespace rt
+        {
+            struct context_t;
+
+            /**
+             * Lock-free bounded work-stealing deque (Chase-Lev) of ray tracing contexts.
+             * The owner thread pushes and pops tasks at the bottom of the deque,
+             * any other thread may steal tasks from the top of the deque.
+             */
+            typedef struct task_queue_t
+            {
+                private:
+                    task_queue_t(const task_queue_t &);
+                    task_queue_t & operator = (const task_queue_t &);
+
+                private:
+                    rt::context_t     **vItems;     // Circular buffer of tasks
+                    size_t              nMask;      // Capacity mask
+                    ssize_t             nTop;       // Top index, modified by thieves and the owner
+                    ssize_t             nBottom;    // Bottom index, modified only by the owner
+
+                public:
+                    explicit task_queue_t();
+                    ~task_queue_t();
+
+                public:
+                    /**
+                     * Initialize the queue, not thread safe
+                     * @param capacity the maximum number of elements, will be rounded up to the power of 2
+                     * @return status of operation
+                     */
+                    status_t            init(size_t capacity);
+
+                    /**
+                     * Destroy the queue, not thread safe. Does not destroy contexts
+                     */
+                    void                destroy();
+
+                    /**
+                     * Get approximate number of elements stored in the queue
+                     * @return approximate number of elements
+                     */
+                    size_t              size() const;
+
+                    /**
+                     * Get the capacity of the queue
+                     * @return capacity of the queue
+                     */
+                    inline size_t       capacity() const { return (vItems != NULL) ? nMask + 1 : 0; }
+
+                    /**
+                     * Push task to the bottom of the queue, should be called by the owner thread only
+                     * @param ctx context to push
+                     * @return true if the task has been pushed, false if the queue is full
+                     */
+                    bool                push(rt::context_t *ctx);
+
+                    /**
+                     * Pop task from the bottom of the queue, should be called by the owner thread only
+                     * @return the task or NULL if queue is empty
+                     */
+                    rt::context_t      *pop();
+
+                    /**
+                     * Steal task from the top of the queue, can be called by any thread
+                     * @return the stolen task or NULL if queue is empty or there was a concurrent access
+                     */
+                    rt::context_t      *steal();
+            } task_queue_t;
+
+        } // namespace rt
+    } // namespace dspu
+} // namespace lsp
+
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_3D_RT_QUEUE_H_ */
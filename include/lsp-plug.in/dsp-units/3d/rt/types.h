@@ -26,6 +26,8 @@
 #include <lsp-plug.in/common/status.h>
 #include <lsp-plug.in/dsp/dsp.h>
 
+#define RT_BANDS_MAX            8       /* Maximum number of frequency bands traced in one pass */
+
 namespace lsp
 {
     namespace dspu
@@ -56,6 +58,16 @@ namespace lsp
              */
             typedef status_t    (*progress_func_t)(float progress, void *data);
 
+            /**
+             * Checkpoint function, called by progressive rendering when partial result is available.
+             * The contents of bound samples are valid only while the function is executing.
+             * @param checkpoint the number of checkpoint starting with 0
+             * @param reflections the maximum number of reflections traced at this checkpoint
+             * @param data user data
+             * @return status of operation
+             */
+            typedef status_t    (*checkpoint_func_t)(size_t checkpoint, size_t reflections, void *data);
+
         #pragma pack(push, 1)
             typedef struct split_t
             {
@@ -84,6 +96,12 @@ namespace lsp
                 float               __pad[3];           // Padding
             } material_t;
 
+            typedef struct band_material_t
+            {
+                float               absorption[2];      // The amount of energy that will be absorpted in the band
+                float               transparency[2];    // The amount of energy that will be passed-through the material in the band
+            } band_material_t;
+
             typedef struct group_t
             {
                 dsp::point3d_t      s;          // Source point
@@ -95,6 +113,7 @@ namespace lsp
                 dsp::vector3d_t     pl[4];      // Culling planes
                 float               time[3];    // The corresponding start time for each source point
                 float               amplitude;  // The amplitude of the signal
+                float               bands[RT_BANDS_MAX]; // The amplitude of the signal in each frequency band
                 float               speed;      // This value indicates the current sound speed [m/s]
                 float               location;   // The expected co-location to the next surface
                 ssize_t             oid;        // Last interacted object identifier
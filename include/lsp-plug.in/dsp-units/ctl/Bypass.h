@@ -24,6 +24,7 @@
 
 #include <lsp-plug.in/dsp-units/version.h>
 #include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/dsp-units/ctl/Crossfade.h>
 
 namespace lsp
 {
@@ -49,6 +50,7 @@ namespace lsp
                 state_t nState;
                 float   fDelta;
                 float   fGain;
+                crossfade_curve_t enCurve;
 
             public:
                 explicit Bypass();
@@ -85,6 +87,31 @@ namespace lsp
                  */
                 void        process(float *dst, const float *dry, const float *wet, size_t count);
 
+                /**
+                 * Process multiple channels that bypass together, the transition ramp is
+                 * computed once per block and applied to all channels
+                 *
+                 * @param dst array of output buffers
+                 * @param dry array of dry signal buffers, may be NULL, elements may be NULL
+                 * @param wet array of wet signal buffers, elements may be NULL
+                 * @param channels number of channels
+                 * @param count number of samples to process
+                 */
+                void        process(float * const *dst, const float * const *dry, const float * const *wet,
+                                    size_t channels, size_t count);
+
+                /**
+                 * Set the shape of the transition gain curves
+                 * @param curve shape of the gain curves
+                 */
+                inline void set_curve(crossfade_curve_t curve) { enCurve = curve; }
+
+                /**
+                 * Get the shape of the transition gain curves
+                 * @return shape of the gain curves
+                 */
+                inline crossfade_curve_t curve() const { return enCurve; }
+
                 /**
                  * Enable/disable bypass
                  * @param bypass bypass value
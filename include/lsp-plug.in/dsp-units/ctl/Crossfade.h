@@ -29,6 +29,15 @@ namespace lsp
 {
     namespace dspu
     {
+        /**
+         * Shape of the gain curves applied to the signals during the transition
+         */
+        enum crossfade_curve_t
+        {
+            XFADE_LINEAR,           //!< XFADE_LINEAR linear gain ramps, constant sum of amplitudes
+            XFADE_EQUAL_POWER       //!< XFADE_EQUAL_POWER sine/cosine gain ramps, constant sum of powers
+        };
+
         class Crossfade
         {
             private:
@@ -40,6 +49,7 @@ namespace lsp
                 size_t      nCounter;
                 float       fDelta;
                 float       fGain;
+                crossfade_curve_t   enCurve;
 
             public:
                 explicit Crossfade();
@@ -71,7 +81,31 @@ namespace lsp
                  * @param count number of samples to process
                  */
                 void            process(float *dst, const float *fade_out, const float *fade_in, size_t count);
-    
+
+                /**
+                 * Crossfade multiple channels sharing the same transition, the gain ramp
+                 * is computed once per block and applied to all channels
+                 * @param dst array of destination buffers
+                 * @param fade_out array of signals that will fade out, may be NULL, elements may be NULL
+                 * @param fade_in array of signals that will fade in, may be NULL, elements may be NULL
+                 * @param channels number of channels
+                 * @param count number of samples to process
+                 */
+                void            process(float * const *dst, const float * const *fade_out, const float * const *fade_in,
+                                        size_t channels, size_t count);
+
+                /**
+                 * Set the shape of the gain curves
+                 * @param curve shape of the gain curves
+                 */
+                inline void     set_curve(crossfade_curve_t curve) { enCurve = curve; }
+
+                /**
+                 * Get the shape of the gain curves
+                 * @return shape of the gain curves
+                 */
+                inline crossfade_curve_t curve() const { return enCurve; }
+
                 /**
                  * Return the remaining number of samples to process
                  * @return the remaining number of samples to process before crossfade becomes inactive
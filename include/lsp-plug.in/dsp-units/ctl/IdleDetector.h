@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_CTL_IDLEDETECTOR_H_
+#define LSP_PLUG_IN_DSP_UNITS_CTL_IDLEDETECTOR_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+
+#define IDLE_TAIL_INFINITE          (~size_t(0))    /* Tail of the system which does not decay */
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /** Detector of the idle state of the unit. The unit is idle when the input has been
+         * silent for at least the tail length of the unit: the tail is the number of samples
+         * the output of the unit needs to decay below the threshold after the input became
+         * silent (IIR decay, impulse response length, delay size). The idle unit does not need
+         * to process the block and outputs silence, the first non-silent input block wakes up
+         * the unit immediately. The detector is disabled until the positive threshold is set.
+         */
+        class IdleDetector
+        {
+            private:
+                IdleDetector & operator = (const IdleDetector &);
+                IdleDetector(const IdleDetector &);
+
+            protected:
+                float           fThreshold;     // Threshold of silence, non-positive disables the detector
+                size_t          nTail;          // Tail length in samples
+                size_t          nLeft;          // Number of tail samples to process
+                bool            bIdle;          // Idle state
+
+            public:
+                explicit IdleDetector();
+                ~IdleDetector();
+
+                /**
+                 * Construct object
+                 */
+                void            construct();
+
+                /**
+                 * Destroy object
+                 */
+                void            destroy();
+
+            public:
+                /** Set threshold of silence
+                 *
+                 * @param threshold absolute threshold of silence, non-positive value disables the detector
+                 */
+                void            set_threshold(float threshold);
+
+                /** Get threshold of silence
+                 *
+                 * @return threshold of silence
+                 */
+                inline float    threshold() const           { return fThreshold;            }
+
+                /** Check that the detector is enabled
+                 *
+                 * @return true if the detector is enabled
+                 */
+                inline bool     enabled() const             { return fThreshold > 0.0f;     }
+
+                /** Set tail length of the unit
+                 *
+                 * @param samples tail length in samples
+                 */
+                void            set_tail(size_t samples);
+
+                /** Get tail length of the unit
+                 *
+                 * @return tail length in samples
+                 */
+                inline size_t   tail() const                { return nTail;                 }
+
+                /** Check that the unit is idle
+                 *
+                 * @return true if the unit is idle
+                 */
+                inline bool     idle() const                { return bIdle;                 }
+
+                /** Wake up the unit, the whole tail is processed again even if the input is silent,
+                 * should be called when the state of the unit has changed
+                 */
+                inline void     wake()
+                {
+                    nLeft           = nTail;
+                    bIdle           = false;
+                }
+
+                /** Analyze the input block
+                 *
+                 * @param src input signal, NULL means silence
+                 * @param samples number of samples in the block
+                 * @return true if the unit is idle and processing of the block can be skipped
+                 */
+                bool            process(const float *src, size_t samples);
+
+                /** Analyze the input block of multiple channels
+                 *
+                 * @param src list of input channels, NULL element means silence
+                 * @param channels number of channels
+                 * @param samples number of samples in the block
+                 * @return true if the unit is idle and processing of the block can be skipped
+                 */
+                bool            process(const float * const *src, size_t channels, size_t samples);
+
+                /** Compute the tail length of the exponential decay
+                 *
+                 * @param radius the radius of the dominant pole, the output decays as radius^n
+                 * @param threshold the level of decay relative to the initial level
+                 * @return tail length in samples, IDLE_TAIL_INFINITE for not decaying systems
+                 */
+                static size_t   decay_tail(float radius, float threshold);
+
+                /** Compute the tail length of the cascade of two systems
+                 *
+                 * @param a tail length of the first system
+                 * @param b tail length of the second system
+                 * @return summary tail length, IDLE_TAIL_INFINITE if any of tails is infinite
+                 */
+                static inline size_t add_tail(size_t a, size_t b)
+                {
+                    return (a > IDLE_TAIL_INFINITE - b) ? IDLE_TAIL_INFINITE : a + b;
+                }
+
+                /**
+                 * Dump the state
+                 * @param dumper dumper
+                 */
+                void            dump(IStateDumper *v) const;
+        };
+    } /* namespace dspu */
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_CTL_IDLEDETECTOR_H_ */
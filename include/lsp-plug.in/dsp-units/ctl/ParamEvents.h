@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_CTL_PARAMEVENTS_H_
+#define LSP_PLUG_IN_DSP_UNITS_CTL_PARAMEVENTS_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/lltl/darray.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /** Parameter change event
+         *
+         */
+        typedef struct param_event_t
+        {
+            size_t      offset;         // Offset of the event in the block
+            size_t      id;             // Identifier of the parameter, specific for the unit
+            float       value;          // New value of the parameter
+        } param_event_t;
+
+        /** Setter of the parameter called when the event is applied
+         *
+         * @param object the unit
+         * @param id identifier of the parameter
+         * @param value new value of the parameter
+         */
+        typedef void (* param_setter_t)(void *object, size_t id, float value);
+
+        /** Timestamped list of parameter changes for the sample-accurate automation.
+         * The host fills the list once per block and passes it to process() of the unit,
+         * the unit splits the block only at offsets where events occur instead of being
+         * called for tiny slices of the block by the host. Events are kept sorted by offset,
+         * events with the same offset are applied in the order of addition.
+         */
+        class ParamEvents
+        {
+            private:
+                ParamEvents & operator = (const ParamEvents &);
+                ParamEvents(const ParamEvents &);
+
+            protected:
+                lltl::darray<param_event_t> vEvents;
+
+            public:
+                explicit ParamEvents();
+                ~ParamEvents();
+
+                /**
+                 * Construct object
+                 */
+                void            construct();
+
+                /**
+                 * Destroy object
+                 */
+                void            destroy();
+
+            public:
+                /** Add event to the list
+                 *
+                 * @param offset offset of the event in the block
+                 * @param id identifier of the parameter
+                 * @param value new value of the parameter
+                 * @return true on success
+                 */
+                bool            add(size_t offset, size_t id, float value);
+
+                /** Remove all events, should be called after the block has been processed
+                 *
+                 */
+                inline void     clear()                     { vEvents.clear();              }
+
+                /** Get number of events
+                 *
+                 * @return number of events
+                 */
+                inline size_t   size() const                { return vEvents.size();        }
+
+                /** Get event
+                 *
+                 * @param index index of the event
+                 * @return pointer to the event or NULL
+                 */
+                inline const param_event_t *get(size_t index) const { return vEvents.get(index); }
+
+                /** Apply all events at the current offset of the block and compute the length
+                 * of the sub-block which can be processed with constant parameters
+                 *
+                 * @param index index of the first event not applied yet, updated by the call,
+                 *        should be zero at the start of the block
+                 * @param offset current offset in the block
+                 * @param samples number of samples left in the block
+                 * @param setter the setter of parameters
+                 * @param object the unit passed to the setter
+                 * @return number of samples until the next event or the end of the block
+                 */
+                size_t          apply(size_t *index, size_t offset, size_t samples, param_setter_t setter, void *object) const;
+
+                /** Apply all events not applied yet, should be called at the end of the block
+                 * to not lose events with offsets beyond the block
+                 *
+                 * @param index index of the first event not applied yet, updated by the call
+                 * @param setter the setter of parameters
+                 * @param object the unit passed to the setter
+                 */
+                void            apply_tail(size_t *index, param_setter_t setter, void *object) const;
+
+                /**
+                 * Dump the state
+                 * @param dumper dumper
+                 */
+                void            dump(IStateDumper *v) const;
+        };
+    } /* namespace dspu */
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_CTL_PARAMEVENTS_H_ */
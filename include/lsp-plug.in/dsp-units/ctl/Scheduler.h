@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_CTL_SCHEDULER_H_
+#define LSP_PLUG_IN_DSP_UNITS_CTL_SCHEDULER_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/lltl/darray.h>
+
+#define SCHEDULER_SLOT_SHIFT        6           /* Each slot of the wheel covers 64 samples */
+#define SCHEDULER_SLOTS             0x100       /* Number of slots of the wheel */
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /** Control-rate event scheduler shared by many units: replaces per-unit polling of
+         * counters and blinks. Timers are stored in the hashed timer wheel indexed by
+         * the deadline, so the processing of a block visits only the slots covered by
+         * the block and the cost does not depend on the number of registered timers
+         * which do not fire. Fired timers are reported with the sample offset inside
+         * of the block, in the ascending order of offsets. The periodic timer fires
+         * each period samples like the Counter, possibly several times per block.
+         *
+         * Timers should be added before processing: add() may allocate memory while
+         * process() allocates memory only if the number of events exceeds any
+         * number reached before.
+         */
+        class Scheduler
+        {
+            private:
+                Scheduler & operator = (const Scheduler &);
+                Scheduler(const Scheduler &);
+
+            public:
+                typedef struct event_t
+                {
+                    size_t      id;             // Identifier of the timer
+                    size_t      offset;         // Offset of the event in the block
+                    void       *tag;            // User data bound to the timer
+                } event_t;
+
+            protected:
+                typedef struct timer_t
+                {
+                    uint64_t    nDeadline;      // Time of the next event
+                    size_t      nPeriod;        // Period, 0 for one-shot timers
+                    ssize_t     nNext;          // Next timer in the slot or the free list
+                    ssize_t     nPrev;          // Previous timer in the slot
+                    ssize_t     nSlot;          // The slot of the timer, negative if timer is not active
+                    bool        bUsed;          // The timer is allocated
+                    void       *pTag;           // User data
+                } timer_t;
+
+            protected:
+                lltl::darray<timer_t>   vTimers;                // All timers
+                lltl::darray<event_t>   vEvents;                // Events of the last processed block
+                ssize_t                 vSlots[SCHEDULER_SLOTS];// Heads of the timer lists of slots
+                ssize_t                 nFree;                  // Head of the free list
+                uint64_t                nTime;                  // Current time in samples
+                size_t                  nActive;                // Number of active timers
+
+            protected:
+                static int              cmp_events(const void *a, const void *b);
+                void                    link(size_t id, timer_t *t);
+                void                    unlink(timer_t *t);
+
+            public:
+                explicit Scheduler();
+                ~Scheduler();
+
+                /**
+                 * Construct object
+                 */
+                void            construct();
+
+                /**
+                 * Destroy object
+                 */
+                void            destroy();
+
+            public:
+                /** Add the timer
+                 *
+                 * @param delay number of samples since the current time until the first event
+                 * @param period period of the timer in samples, 0 means one-shot timer
+                 * @param tag user data reported with events of the timer
+                 * @return identifier of the timer or negative error code
+                 */
+                ssize_t         add(size_t delay, size_t period = 0, void *tag = NULL);
+
+                /** Restart the timer
+                 *
+                 * @param id identifier of the timer
+                 * @param delay number of samples since the current time until the first event
+                 * @param period period of the timer in samples, 0 means one-shot timer
+                 * @return true on success
+                 */
+                bool            set(size_t id, size_t delay, size_t period = 0);
+
+                /** Stop the timer, the identifier remains valid
+                 *
+                 * @param id identifier of the timer
+                 * @return true on success
+                 */
+                bool            cancel(size_t id);
+
+                /** Remove the timer, the identifier can be reused by the next add()
+                 *
+                 * @param id identifier of the timer
+                 * @return true on success
+                 */
+                bool            remove(size_t id);
+
+                /** Remove all timers and reset the time
+                 *
+                 */
+                void            clear();
+
+                /** Check that the timer is active
+                 *
+                 * @param id identifier of the timer
+                 * @return true if the timer is active
+                 */
+                bool            active(size_t id) const;
+
+                /** Get number of samples until the next event of the timer
+                 *
+                 * @param id identifier of the timer
+                 * @return number of samples or negative value if timer is not active
+                 */
+                ssize_t         pending(size_t id) const;
+
+                /** Process the block of samples and compute the events fired in the block
+                 *
+                 * @param samples number of samples in the block
+                 * @return number of fired events
+                 */
+                size_t          process(size_t samples);
+
+                /** Get number of events fired in the last processed block
+                 *
+                 * @return number of events
+                 */
+                inline size_t   events() const              { return vEvents.size();        }
+
+                /** Get the event fired in the last processed block
+                 *
+                 * @param index index of the event
+                 * @return pointer to the event or NULL
+                 */
+                inline const event_t *event(size_t index) const { return vEvents.get(index);  }
+
+                /** Get number of active timers
+                 *
+                 * @return number of active timers
+                 */
+                inline size_t   timers() const              { return nActive;               }
+
+                /** Get the current time
+                 *
+                 * @return number of samples processed since the last clear()
+                 */
+                inline uint64_t time() const                { return nTime;                 }
+
+                /**
+                 * Dump the state
+                 * @param dumper dumper
+                 */
+                void            dump(IStateDumper *v) const;
+        };
+    } /* namespace dspu */
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_CTL_SCHEDULER_H_ */
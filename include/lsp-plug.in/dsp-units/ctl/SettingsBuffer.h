@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_CTL_SETTINGSBUFFER_H_
+#define LSP_PLUG_IN_DSP_UNITS_CTL_SETTINGSBUFFER_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/common/atomic.h>
+#include <lsp-plug.in/common/types.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /** Index exchange of the triple-buffered settings, the single writer thread
+         * publishes its back buffer by swapping it with the middle one, the single reader
+         * thread fetches the middle buffer by swapping it with the front one. Both sides
+         * never block and never wait for each other.
+         */
+        class BasicSettingsBuffer
+        {
+            private:
+                BasicSettingsBuffer & operator = (const BasicSettingsBuffer &);
+                BasicSettingsBuffer(const BasicSettingsBuffer &);
+
+            protected:
+                enum state_t
+                {
+                    S_INDEX     = 0x03,         // Mask of buffer index
+                    S_FRESH     = 0x04          // The buffer contains fresh data
+                };
+
+            protected:
+                size_t              nBack;          // Buffer written by the writer thread
+                size_t              nFront;         // Buffer read by the reader thread
+                atomic_t            nState;         // Exchange state: middle buffer index and freshness flag
+
+            protected:
+                size_t              commit();
+
+            public:
+                explicit BasicSettingsBuffer();
+                ~BasicSettingsBuffer();
+
+            public:
+                /**
+                 * Drop the published settings that have not been fetched yet,
+                 * should not be called concurrently with other methods
+                 */
+                void                reset();
+
+                /**
+                 * Check that the writer has published settings that have not been fetched yet
+                 * @return true if there are fresh settings
+                 */
+                bool                pending() const;
+
+                /**
+                 * Fetch the latest published settings, should be called from the reader thread
+                 * @return true if the new settings have been fetched
+                 */
+                bool                fetch();
+        };
+
+        /** Lock-free exchange of the settings structure between the UI (writer) thread
+         * and the audio (reader) thread. The writer modifies the settings returned by
+         * edit() and publishes them, the audio thread fetches the latest published
+         * settings before processing and applies them to the unit. Intermediate settings
+         * published between two fetches are skipped. The structure should be copyable.
+         */
+        template <class T>
+            class SettingsBuffer: public BasicSettingsBuffer
+            {
+                protected:
+                    T                   vSettings[3];   // Triple-buffered settings
+
+                public:
+                    /**
+                     * Initialize all buffers with the same settings, should not be called
+                     * concurrently with other methods
+                     * @param settings initial settings
+                     */
+                    inline void init(const T *settings)
+                    {
+                        reset();
+                        for (size_t i=0; i<3; ++i)
+                            vSettings[i]    = *settings;
+                    }
+
+                    /**
+                     * Get the settings to modify, should be called from the writer thread.
+                     * The buffer always contains the settings published last by the writer
+                     * @return settings to modify
+                     */
+                    inline T *edit()                    { return &vSettings[nBack];     }
+
+                    /**
+                     * Publish the modified settings, should be called from the writer thread
+                     */
+                    inline void publish()
+                    {
+                        // The middle buffer is not written by the reader, so the writer
+                        // may safely continue from the settings just published
+                        size_t prev     = commit();
+                        vSettings[nBack]    = vSettings[prev];
+                    }
+
+                    /**
+                     * Get the settings fetched by the reader thread
+                     * @return settings fetched by the reader thread
+                     */
+                    inline const T *current() const     { return &vSettings[nFront];    }
+            };
+    } /* namespace dspu */
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_CTL_SETTINGSBUFFER_H_ */
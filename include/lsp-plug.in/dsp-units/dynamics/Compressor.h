@@ -24,6 +24,12 @@
 
 #include <lsp-plug.in/dsp-units/version.h>
 #include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/dsp-units/dynamics/GainTable.h>
+#include <lsp-plug.in/dsp-units/util/SharedDelay.h>
+#include <lsp-plug.in/dsp-units/ctl/ParamEvents.h>
+#include <lsp-plug.in/dsp-units/ctl/SettingsBuffer.h>
+
+#define COMPRESSOR_LANES            8
 
 namespace lsp
 {
@@ -36,6 +42,37 @@ namespace lsp
             CM_BOOSTING
         };
 
+        /** Identifiers of compressor parameters for the parameter events
+         *
+         */
+        enum compressor_param_t
+        {
+            CP_ATTACK_THRESH,       // Attack threshold
+            CP_RELEASE_THRESH,      // Release threshold
+            CP_BOOST_THRESH,        // Boost threshold
+            CP_ATTACK,              // Attack time (ms)
+            CP_RELEASE,             // Release time (ms)
+            CP_KNEE,                // Knee (in gain units)
+            CP_RATIO,               // Compression ratio
+            CP_MODE                 // Compression mode
+        };
+
+        /** Settings of the compressor that can be published by the UI thread
+         * with dspu::SettingsBuffer
+         */
+        typedef struct compressor_settings_t
+        {
+            float       fAttackThresh;      // Attack threshold
+            float       fReleaseThresh;     // Release threshold
+            float       fBoostThresh;       // Boost threshold
+            float       fAttack;            // Attack time (ms)
+            float       fRelease;           // Release time (ms)
+            float       fKnee;              // Knee (in gain units)
+            float       fRatio;             // Compression ratio
+            float       fLookahead;         // Lookahead time (ms)
+            size_t      nMode;              // Compression mode
+        } compressor_settings_t;
+
         /** Compressor class implementation
          *
          */
@@ -72,11 +109,24 @@ namespace lsp
                 float       vBHermite[3];   // Boost hermite interpolation
                 float       fBoost;         // Overall gain boost
 
+                // Gain table
+                GainTable   sTable;         // Table-driven gain computer
+                size_t      nTable;         // Gain table mode
+                float       fTableError;    // Maximum relative error of the gain table
+
+                // Lookahead
+                SharedDelay sDelay;         // Delay line shared by all channels
+                float       fLookahead;     // Lookahead time (ms)
+
                 // Additional parameters
                 size_t      nSampleRate;
                 size_t      nMode;
+                size_t      nVersion;       // Version of settings
                 bool        bUpdate;
 
+            protected:
+                static void set_param(void *object, size_t id, float value);
+
             public:
                 explicit Compressor();
                 ~Compressor();
@@ -92,6 +142,35 @@ namespace lsp
                 void        destroy();
 
             public:
+                /** Initialize the built-in lookahead delay line, should be called
+                 * before process() with lookahead
+                 *
+                 * @param channels number of audio channels, all channels share the delay line
+                 * @param max_sr maximum sample rate
+                 * @param max_lookahead maximum lookahead time (ms)
+                 * @return true on success
+                 */
+                bool init(size_t channels, size_t max_sr, float max_lookahead);
+
+                /** Set lookahead time, the audio signal passed to process() with lookahead
+                 * is delayed against the gain computed from the sidechain signal
+                 *
+                 * @param lookahead lookahead time (ms)
+                 */
+                void set_lookahead(float lookahead);
+
+                /** Get lookahead time
+                 *
+                 * @return lookahead time (ms)
+                 */
+                inline float get_lookahead() const { return fLookahead; }
+
+                /** Get latency introduced by the lookahead, valid after update_settings()
+                 *
+                 * @return latency in samples
+                 */
+                inline size_t latency() const { return sDelay.delay(); }
+
                 /** Check that some of compressor's parameters have been modified
                  * and we need to call update_settings();
                  *
@@ -102,11 +181,39 @@ namespace lsp
                     return bUpdate;
                 }
 
+                /** Get version of settings, it is incremented by each update_settings() call,
+                 * so the cached curve and gain charts need to be recomputed only if the version
+                 * has changed since the last computation
+                 *
+                 * @return version of settings
+                 */
+                inline size_t version() const { return nVersion; }
+
                 /** Update compressor's settings
                  *
                  */
                 void update_settings();
 
+                /** Fetch the latest settings published by the writer thread, apply them
+                 * and update compressor's settings if they have been modified
+                 *
+                 * @param settings settings buffer
+                 * @return true if new settings have been fetched
+                 */
+                bool update_settings(SettingsBuffer<compressor_settings_t> *settings);
+
+                /** Get current compressor settings
+                 *
+                 * @param settings pointer to store settings
+                 */
+                void get_settings(compressor_settings_t *settings) const;
+
+                /** Set all compressor settings at once, update_settings() should be called then
+                 *
+                 * @param settings settings to apply
+                 */
+                void set_settings(const compressor_settings_t *settings);
+
                 /** Set compressor threshold
                  *
                  * @param attack the attack threshold
@@ -163,6 +270,27 @@ namespace lsp
                  */
                 void set_mode(size_t mode);
 
+                /** Set table-driven gain computation, the table is built by update_settings()
+                 * and replaces logarithm and exponent computation in process() calls
+                 *
+                 * @param mode the gain table mode, GT_OFF for direct gain computation
+                 * @param error maximum relative error of the gain, lower error
+                 *        gives larger table and longer update_settings() call
+                 */
+                void set_gain_table(gain_table_mode_t mode, float error = GAIN_TABLE_DFL_ERROR);
+
+                /** Get gain table mode
+                 *
+                 * @return gain table mode
+                 */
+                inline gain_table_mode_t get_gain_table() const { return gain_table_mode_t(nTable); }
+
+                /** Get maximum relative error of the gain table
+                 *
+                 * @return maximum relative error of the gain table
+                 */
+                inline float get_gain_table_error() const { return fTableError; }
+
                 /** Process sidechain signal
                  *
                  * @param out output signal gain to VCA
@@ -172,6 +300,46 @@ namespace lsp
                  */
                 void process(float *out, float *env, const float *in, size_t samples);
 
+                /** Process sidechain signal with sample-accurate parameter changes. The block
+                 * is split only at offsets of events, settings are updated at each split,
+                 * the envelope follower keeps smoothing over the split points
+                 *
+                 * @param out output signal gain to VCA
+                 * @param env envelope signal of compressor, may be NULL
+                 * @param in sidechain signal
+                 * @param samples number of samples to process
+                 * @param events list of parameter changes with identifiers from compressor_param_t,
+                 *        may be NULL
+                 */
+                void process(float *out, float *env, const float *in, size_t samples, const ParamEvents *events);
+
+                /** Process audio signal with lookahead. The gain is computed from the sidechain
+                 * signal and applied to the audio signal delayed by latency() samples directly
+                 * at the output of the shared delay line
+                 *
+                 * @param dst list of channels destination buffers, may be the same as source buffers
+                 * @param gain output signal gain to VCA
+                 * @param env envelope signal, may be NULL
+                 * @param src list of channels source buffers
+                 * @param sc sidechain signal
+                 * @param samples number of samples to process
+                 */
+                void process(float * const *dst, float *gain, float *env, const float * const *src, const float *sc, size_t samples);
+
+                /** Process audio signal with lookahead and sample-accurate parameter changes
+                 *
+                 * @param dst list of channels destination buffers, may be the same as source buffers
+                 * @param gain output signal gain to VCA
+                 * @param env envelope signal, may be NULL
+                 * @param src list of channels source buffers
+                 * @param sc sidechain signal
+                 * @param samples number of samples to process
+                 * @param events list of parameter changes with identifiers from compressor_param_t,
+                 *        may be NULL
+                 */
+                void process(float * const *dst, float *gain, float *env, const float * const *src, const float *sc,
+                    size_t samples, const ParamEvents *events);
+
                 /** Process one sample of sidechain signal
                  *
                  * @param in sidechain signal
@@ -180,6 +348,21 @@ namespace lsp
                  */
                 float process(float *env, float in);
 
+                /** Process sidechain signals of multiple independent compressors at once,
+                 * envelopes of up to COMPRESSOR_LANES compressors are computed in parallel lanes,
+                 * update_settings() should be called for each compressor before
+                 *
+                 * @param list list of compressors
+                 * @param out list of output signal gains to VCA, one per compressor
+                 * @param env list of envelope signals, one per compressor, may be NULL,
+                 *        any element of the list may be NULL
+                 * @param in list of sidechain signals, one per compressor
+                 * @param count number of compressors
+                 * @param samples number of samples to process
+                 */
+                static void process(Compressor * const *list, float * const *out, float * const *env,
+                    const float * const *in, size_t count, size_t samples);
+
                 /** Get compression curve
                  *
                  * @param out output compression value
@@ -32,6 +32,15 @@ namespace lsp
 {
     namespace dspu
     {
+        /**
+         * Link mode of sidechain channels for the multi-channel processing
+         */
+        enum dynamic_link_t
+        {
+            DL_MAX,             //!< DL_MAX maximum absolute value of all channels
+            DL_AVERAGE          //!< DL_AVERAGE average absolute value of all channels
+        };
+
         typedef struct dyndot_t
         {
             float   fInput;         // Negative value means off
@@ -93,6 +102,7 @@ namespace lsp
 
                 // Additional parameters
                 size_t      nSampleRate;
+                size_t      nLink;
                 bool        bUpdate;
 
             protected:
@@ -101,6 +111,7 @@ namespace lsp
                 void                    sort_reactions(reaction_t *s, size_t count);
                 void                    sort_splines(spline_t *s, size_t count);
                 static inline float     solve_reaction(const reaction_t *s, float x, size_t count);
+                void                    link(float *dst, const float * const *in, size_t offset, size_t channels, size_t samples);
 
             public:
                 explicit DynamicProcessor();
@@ -327,6 +338,35 @@ namespace lsp
                  */
                 float process(float *env, float in);
 
+                /**
+                 * Get link mode of sidechain channels
+                 * @return link mode of sidechain channels
+                 */
+                inline dynamic_link_t get_link() const
+                {
+                    return dynamic_link_t(nLink);
+                }
+
+                /**
+                 * Set link mode of sidechain channels for the multi-channel processing
+                 * @param link link mode
+                 */
+                inline void set_link(dynamic_link_t link)
+                {
+                    nLink       = link;
+                }
+
+                /** Process multiple sidechain signals, the envelope is computed once
+                 * from the linked sidechain signal, the gain is common for all channels
+                 *
+                 * @param out output signal gain to VCA
+                 * @param env envelope signal of processor, may be NULL
+                 * @param in list of sidechain signals
+                 * @param channels number of sidechain signals
+                 * @param samples number of samples to process
+                 */
+                void process(float *out, float *env, const float * const *in, size_t channels, size_t samples);
+
                 /** Get dynamic curve
                  *
                  * @param out output compression value
@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_DYNAMICS_GAINTABLE_H_
+#define LSP_PLUG_IN_DSP_UNITS_DYNAMICS_GAINTABLE_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+
+#define GAIN_TABLE_MAX_BITS             8           /* Maximum 256 cells per octave */
+#define GAIN_TABLE_OCTAVES              32          /* Range -144 dB .. +48 dB */
+#define GAIN_TABLE_DFL_ERROR            1e-3f       /* Default relative error */
+
+namespace lsp
+{
+    namespace dspu
+    {
+        enum gain_table_mode_t
+        {
+            GT_OFF,             //!< GT_OFF gain is computed directly
+            GT_LINEAR,          //!< GT_LINEAR gain is looked up from the table with linear interpolation
+            GT_CUBIC            //!< GT_CUBIC gain is looked up from the table with cubic interpolation
+        };
+
+        /**
+         * Function that computes the exact gain for the specified input level
+         * @param object bound object
+         * @param x the input level
+         * @return the gain value
+         */
+        typedef float (* gain_func_t)(void *object, float x);
+
+        /**
+         * Table-driven gain computer. The gain curve is sampled over the logarithmic grid
+         * from -144 dB to +48 dB: the cell index is taken from the exponent and the upper
+         * bits of the mantissa of the input level, so neither logarithm nor exponent is
+         * computed for a sample. Each cell is interpolated linearly or by the cubic
+         * Hermite polynomial. The number of cells per octave is chosen at build time
+         * to meet the required error bound. Levels above the grid are computed exactly.
+         */
+        class GainTable
+        {
+            private:
+                GainTable & operator = (const GainTable &);
+                GainTable(const GainTable &);
+
+            protected:
+                float          *vTable;         // Table of gain values or cubic polynomials
+                size_t          nMode;          // Interpolation mode
+                size_t          nBits;          // Number of mantissa bits used as cell index
+                float           fError;         // Achieved maximum relative error
+                gain_func_t     pFunc;          // Exact gain function
+                void           *pObject;        // Bound object
+                uint8_t        *pData;          // Allocated data
+
+            protected:
+                inline float    slope(float x, float h) const;
+                void            fill(size_t bits);
+                float           estimate(size_t bits) const;
+                inline float    lookup(float x) const;
+
+            public:
+                explicit GainTable();
+                ~GainTable();
+
+                /**
+                 * Construct object
+                 */
+                void            construct();
+
+                /**
+                 * Destroy object
+                 */
+                void            destroy();
+
+            public:
+                /**
+                 * Build the table. Allocates memory on the first call only
+                 *
+                 * @param func exact gain function
+                 * @param object object bound to the function
+                 * @param mode interpolation mode, GT_OFF disables the table
+                 * @param error maximum relative error of the interpolated gain
+                 * @return false if there was not enough memory
+                 */
+                bool            build(gain_func_t func, void *object, gain_table_mode_t mode, float error);
+
+                /**
+                 * Check that the table is built and can be used
+                 * @return true if the table can be used
+                 */
+                inline bool     enabled() const         { return (vTable != NULL) && (nMode != GT_OFF); }
+
+                /**
+                 * Get the number of cells per octave
+                 * @return number of cells per octave
+                 */
+                inline size_t   resolution() const      { return 1 << nBits; }
+
+                /**
+                 * Get the maximum relative error of the table estimated at build time
+                 * @return maximum relative error
+                 */
+                inline float    error() const           { return fError; }
+
+                /**
+                 * Compute gain for the block of input levels
+                 * @param dst destination buffer to store gain
+                 * @param src input levels
+                 * @param count number of samples to process
+                 */
+                void            process(float *dst, const float *src, size_t count) const;
+
+                /**
+                 * Compute gain for the single input level
+                 * @param x input level
+                 * @return the gain value
+                 */
+                float           process(float x) const;
+
+                /**
+                 * Dump internal state
+                 * @param v state dumper
+                 */
+                void            dump(IStateDumper *v) const;
+        };
+    }
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_DYNAMICS_GAINTABLE_H_ */
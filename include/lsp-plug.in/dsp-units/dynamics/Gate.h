@@ -24,6 +24,10 @@
 
 #include <lsp-plug.in/dsp-units/version.h>
 #include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/dsp-units/dynamics/GainTable.h>
+#include <lsp-plug.in/dsp-units/util/SharedDelay.h>
+
+#define GATE_LANES                  8
 
 namespace lsp
 {
@@ -57,11 +61,24 @@ namespace lsp
                 float       fReduction;
                 float       fEnvelope;
 
+                // Gain tables
+                GainTable   sTable[2];      // Table-driven gain computers for both curves
+                size_t      nTable;         // Gain table mode
+                float       fTableError;    // Maximum relative error of the gain table
+
+                // Lookahead
+                SharedDelay sDelay;         // Delay line shared by all channels
+                float       fLookahead;     // Lookahead time (ms)
+
                 // Additional parameters
                 size_t      nSampleRate;
                 size_t      nCurve;
+                size_t      nVersion;       // Version of settings
                 bool        bUpdate;
 
+            protected:
+                void        process_curve(float *out, size_t samples);
+
             public:
                 explicit Gate();
                 ~Gate();
@@ -77,6 +94,41 @@ namespace lsp
                 void        destroy();
 
             public:
+                /** Initialize the built-in lookahead delay line, should be called
+                 * before process() with lookahead
+                 *
+                 * @param channels number of audio channels, all channels share the delay line
+                 * @param max_sr maximum sample rate
+                 * @param max_lookahead maximum lookahead time (ms)
+                 * @return true on success
+                 */
+                bool init(size_t channels, size_t max_sr, float max_lookahead);
+
+                /** Set lookahead time, the audio signal passed to process() with lookahead
+                 * is delayed against the gain computed from the sidechain signal
+                 *
+                 * @param lookahead lookahead time (ms)
+                 */
+                inline void set_lookahead(float lookahead)
+                {
+                    if (fLookahead == lookahead)
+                        return;
+                    fLookahead  = lookahead;
+                    bUpdate     = true;
+                }
+
+                /** Get lookahead time
+                 *
+                 * @return lookahead time (ms)
+                 */
+                inline float get_lookahead() const { return fLookahead; }
+
+                /** Get latency introduced by the lookahead, valid after update_settings()
+                 *
+                 * @return latency in samples
+                 */
+                inline size_t latency() const { return sDelay.delay(); }
+
                 /** Check that some of parameters have been modified
                  * and we need to call update_settings();
                  *
@@ -87,6 +139,14 @@ namespace lsp
                     return bUpdate;
                 }
 
+                /** Get version of settings, it is incremented by each update_settings() call,
+                 * so the cached curve and gain charts need to be recomputed only if the version
+                 * has changed since the last computation
+                 *
+                 * @return version of settings
+                 */
+                inline size_t version() const { return nVersion; }
+
                 /** Update gate settings
                  *
                  */
@@ -119,6 +179,34 @@ namespace lsp
                     bUpdate             = true;
                 }
 
+                /** Set table-driven gain computation, the tables are built by update_settings()
+                 * and replace logarithm and exponent computation in process() calls
+                 *
+                 * @param mode the gain table mode, GT_OFF for direct gain computation
+                 * @param error maximum relative error of the gain, lower error
+                 *        gives larger table and longer update_settings() call
+                 */
+                inline void set_gain_table(gain_table_mode_t mode, float error = GAIN_TABLE_DFL_ERROR)
+                {
+                    if ((nTable == size_t(mode)) && (fTableError == error))
+                        return;
+                    nTable              = mode;
+                    fTableError         = error;
+                    bUpdate             = true;
+                }
+
+                /** Get gain table mode
+                 *
+                 * @return gain table mode
+                 */
+                inline gain_table_mode_t get_gain_table() const { return gain_table_mode_t(nTable); }
+
+                /** Get maximum relative error of the gain table
+                 *
+                 * @return maximum relative error of the gain table
+                 */
+                inline float get_gain_table_error() const { return fTableError; }
+
                 /** Set timings
                  *
                  * @param attack attack time (ms)
@@ -192,6 +280,19 @@ namespace lsp
                  */
                 void process(float *out, float *env, const float *in, size_t samples);
 
+                /** Process audio signal with lookahead. The gain is computed from the sidechain
+                 * signal and applied to the audio signal delayed by latency() samples directly
+                 * at the output of the shared delay line
+                 *
+                 * @param dst list of channels destination buffers, may be the same as source buffers
+                 * @param gain output signal gain to VCA
+                 * @param env envelope signal, may be NULL
+                 * @param src list of channels source buffers
+                 * @param sc sidechain signal
+                 * @param samples number of samples to process
+                 */
+                void process(float * const *dst, float *gain, float *env, const float * const *src, const float *sc, size_t samples);
+
                 /** Process one sample of sidechain signal
                  *
                  * @param s sidechain signal
@@ -200,6 +301,21 @@ namespace lsp
                  */
                 float process(float *env, float s);
 
+                /** Process sidechain signals of multiple independent gates at once,
+                 * envelopes of up to GATE_LANES gates are computed in parallel lanes,
+                 * update_settings() should be called for each gate before
+                 *
+                 * @param list list of gates
+                 * @param out list of output signal gains to VCA, one per gate
+                 * @param env list of envelope signals, one per gate, may be NULL,
+                 *        any element of the list may be NULL
+                 * @param in list of sidechain signals, one per gate
+                 * @param count number of gates
+                 * @param samples number of samples to process
+                 */
+                static void process(Gate * const *list, float * const *out, float * const *env,
+                    const float * const *in, size_t count, size_t samples);
+
                 /** Get curve
                  *
                  * @param out output expansion value
@@ -24,16 +24,27 @@
 
 #include <lsp-plug.in/dsp-units/version.h>
 #include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/dsp-units/misc/memory.h>
+#include <lsp-plug.in/dsp-units/util/PerfCounter.h>
 #include <lsp-plug.in/dsp-units/util/Delay.h>
+#include <lsp-plug.in/dsp-units/ctl/ParamEvents.h>
+#include <lsp-plug.in/dsp-units/ctl/SettingsBuffer.h>
+#include <lsp-plug.in/common/status.h>
 
 #define LIMITER_PATCHES_MAX         256
 #define LIMITER_PEAKS_MAX           32
 #define LIMITER_LOG_PATCHES_MAX     128
+#define LIMITER_TP_PHASES           4       /* Oversampling factor of the true peak detector */
+#define LIMITER_TP_TAPS             12      /* Number of taps per phase of the true peak detector */
+#define LIMITER_TP_DELAY            6       /* Latency of the true peak detector */
+#define LIMITER_TP_HISTORY          16      /* Size of the true peak detector history per channel */
 
 namespace lsp
 {
     namespace dspu
     {
+        class Sample;
+
         enum limiter_mode_t
         {
             LM_HERM_THIN,
@@ -52,6 +63,37 @@ namespace lsp
             LM_LINE_DUCK
         };
 
+        /** Identifiers of limiter parameters for the parameter events
+         *
+         */
+        enum limiter_param_t
+        {
+            LP_THRESHOLD,           // Threshold, smoothly changes to the new value
+            LP_THRESHOLD_IMMEDIATE, // Threshold, changes immediately
+            LP_ATTACK,              // Attack time (ms)
+            LP_RELEASE,             // Release time (ms)
+            LP_KNEE,                // Knee
+            LP_MODE                 // Limiter mode
+        };
+
+        /** Settings of the limiter that can be published by the UI thread
+         * with dspu::SettingsBuffer
+         */
+        typedef struct limiter_settings_t
+        {
+            float       fThreshold;         // Threshold, smoothly changes to the new value
+            float       fAttack;            // Attack time (ms)
+            float       fRelease;           // Release time (ms)
+            float       fLookahead;         // Lookahead time (ms)
+            float       fKnee;              // Knee
+            size_t      nMode;              // Limiter mode
+            float       fALRAttack;         // Automatic level regulation attack time (ms)
+            float       fALRRelease;        // Automatic level regulation release time (ms)
+            bool        bALR;               // Automatic level regulation
+            bool        bTruePeak;          // True peak detection
+            bool        bMergePeaks;        // Merging of close peaks
+        } limiter_settings_t;
+
         class Limiter
         {
             private:
@@ -134,14 +176,26 @@ namespace lsp
                 size_t      nSampleRate;
                 size_t      nUpdate;
                 size_t      nMode;
+                size_t      nChannels;
+                bool        bTruePeak;
+                bool        bMergePeaks;
+                size_t      nMergeAttack;           // Attack ramp of the merged envelope
+                size_t      nMergeHold;             // Hold time of the merged envelope
                 alr_t       sALR;
 
                 // Pre-calculated parameters
                 float      *vGainBuf;
                 float      *vTmpBuf;                // Temporary buffer to store the actual sidechain value
+                float      *vScBuf;                 // Linked sidechain signal of all channels
+                float      *vDelayBuf;              // Lookahead delay lines of all channels
+                float      *vTpBuf;                 // True peak detector buffer
+                float      *vTpHist;                // True peak detector history of all channels
+                float      *vEnvBuf;                // Buffers for the merged envelope computation
+                float       vTpFir[LIMITER_TP_PHASES-1][LIMITER_TP_TAPS];   // Fractional phases of the interpolator
                 uint8_t    *vData;
 
                 Delay       sDelay;
+                PerfCounter sPerf;                  // Performance counters
                 union
                 {
                     sat_t       sSat;               // Hermite mode
@@ -166,10 +220,16 @@ namespace lsp
                 void            init_line(line_t *line);
 
                 void            process_alr(float *gbuf, const float *sc, size_t samples);
+                void            process_gain(float *gain, const float *sc, size_t samples);
+                void            merge_peaks(float *gbuf, size_t samples);
+                void            true_peak(float *dst, const float *sc, size_t channel, size_t samples);
+                void            init_true_peak();
 
                 static void     dump(IStateDumper *v, const char *name, const sat_t *sat);
                 static void     dump(IStateDumper *v, const char *name, const exp_t *exp);
                 static void     dump(IStateDumper *v, const char *name, const line_t *line);
+                static void     set_param(void *object, size_t id, float value);
+                static size_t   data_size(size_t lookahead, size_t channels);
 
             public:
                 explicit Limiter();
@@ -194,6 +254,22 @@ namespace lsp
                  */
                 bool init(size_t max_sr, float max_lookahead);
 
+                /** Initialize multi-channel limiter with linked gain computation
+                 *
+                 * @param max_sr maximum sample rate that can be passed to limiter
+                 * @param max_lookahead maximum look-ahead time that can be passed to limiter [ms]
+                 * @param channels number of channels processed by the limiter, zero means
+                 *        that the limiter has no delay lines and only computes the gain
+                 * @return true on success
+                 */
+                bool init(size_t max_sr, float max_lookahead, size_t channels);
+
+                /**
+                 * Get number of channels processed by the multi-channel process() call
+                 * @return number of channels
+                 */
+                inline size_t channels() const                          { return nChannels;             }
+
                 /** Check if limiter is modifier
                  *
                  * @return true if limiter settings need to be updated
@@ -205,6 +281,26 @@ namespace lsp
                  */
                 void update_settings();
 
+                /** Fetch the latest settings published by the writer thread, apply them
+                 * and update settings for limiter
+                 *
+                 * @param settings settings buffer
+                 * @return true if new settings have been fetched
+                 */
+                bool update_settings(SettingsBuffer<limiter_settings_t> *settings);
+
+                /** Get current limiter settings
+                 *
+                 * @param settings pointer to store settings
+                 */
+                void get_settings(limiter_settings_t *settings) const;
+
+                /** Set all limiter settings at once
+                 *
+                 * @param settings settings to apply
+                 */
+                void set_settings(const limiter_settings_t *settings);
+
                 /**
                  * Get limiter mode
                  * @return limiter mode
@@ -309,7 +405,7 @@ namespace lsp
                  *
                  * @return limiter's latency
                  */
-                inline size_t       get_latency() const                 { return nLookahead;        }
+                inline size_t       get_latency() const                 { return nLookahead + ((bTruePeak) ? LIMITER_TP_DELAY : 0); }
 
                 /**
                  * Get automatic level regulation attack
@@ -350,6 +446,38 @@ namespace lsp
                  */
                 bool                set_alr(bool enable);
 
+                /**
+                 * Check that the true peak detection is turned on
+                 * @return true if the true peak detection is turned on
+                 */
+                inline bool         get_true_peak() const               { return bTruePeak;         }
+
+                /** Enable true peak detection. The sidechain signal is 4x interpolated by
+                 * the polyphase filter in the peak detector only, the gain is still computed and
+                 * applied at the base sample rate. Adds LIMITER_TP_DELAY samples of latency.
+                 *
+                 * @param enable enable flag
+                 * @return previous value
+                 */
+                bool                set_true_peak(bool enable);
+
+                /**
+                 * Check that peak merging is turned on
+                 * @return true if peak merging is turned on
+                 */
+                inline bool         get_merge_peaks() const             { return bMergePeaks;       }
+
+                /** Enable peak merging. Instead of applying patch for each peak, the gain
+                 * reduction envelope for all peaks of the block is computed at once by the
+                 * sliding minimum of the required gain followed by the moving average that forms
+                 * linear attack and release ramps. The cost does not depend on the number of peaks,
+                 * the shape of the envelope does not depend on the limiter mode.
+                 *
+                 * @param enable enable flag
+                 * @return previous value
+                 */
+                bool                set_merge_peaks(bool enable);
+
                 /** Process data by limiter
                  *
                  * @param dst destination buffer with applied delay
@@ -359,7 +487,84 @@ namespace lsp
                  * @param samples number of samples to process
                  */
                 void                process(float *dst, float *gain, const float *src, const float *sc, size_t samples);
-    
+
+                /** Process data of all channels by the limiter. The single gain curve is computed
+                 * from the maximum absolute value of all sidechain channels and is applied
+                 * to the delayed signal of each channel.
+                 *
+                 * @param dst list of channels() destination buffers with applied delay and gain,
+                 *        may be the same as source buffers
+                 * @param gain output linked gain
+                 * @param src list of channels() input signal buffers
+                 * @param sc list of channels() sidechain input signal buffers, NULL means
+                 *        that the input signal is used as sidechain
+                 * @param samples number of samples to process
+                 */
+                void                process(float * const *dst, float *gain, const float * const *src, const float * const *sc, size_t samples);
+
+                /** Compute the gain curve only. The gain is aligned with the signal delayed
+                 * by get_latency() samples, the delay is left to the caller. This is the only
+                 * processing method available for the limiter initialized with zero channels.
+                 *
+                 * @param gain output gain for VCA
+                 * @param sc sidechain input signal
+                 * @param samples number of samples to process
+                 */
+                void                process(float *gain, const float *sc, size_t samples);
+
+                /** Process data by limiter with sample-accurate parameter changes. The block
+                 * is split only at offsets of events, the LP_THRESHOLD event smoothly changes
+                 * the threshold like set_threshold(thresh, false) does
+                 *
+                 * @param dst destination buffer with applied delay
+                 * @param gain output gain for VCA
+                 * @param src input signal buffer
+                 * @param sc sidechain input signal
+                 * @param samples number of samples to process
+                 * @param events list of parameter changes with identifiers from limiter_param_t,
+                 *        may be NULL
+                 */
+                void                process(float *dst, float *gain, const float *src, const float *sc,
+                                        size_t samples, const ParamEvents *events);
+
+                /** Compute the gain curve only with sample-accurate parameter changes
+                 *
+                 * @param gain output gain for VCA
+                 * @param sc sidechain input signal
+                 * @param samples number of samples to process
+                 * @param events list of parameter changes with identifiers from limiter_param_t,
+                 *        may be NULL
+                 */
+                void                process(float *gain, const float *sc, size_t samples, const ParamEvents *events);
+
+                /** Process the whole sample offline. The signal is completely known, so the gain
+                 * envelope does not need the lookahead: the required gain is smoothed by the attack
+                 * in the reverse time and by the release in the forward time, both passes never
+                 * raise the gain above the required one. The output has no latency, the sample peak
+                 * of all channels does not exceed the threshold. The limiter mode, knee, automatic
+                 * level regulation and the true peak detection are not used, the internal state
+                 * of the limiter is not affected.
+                 *
+                 * @param dst destination sample, may be the same as source
+                 * @param src source sample
+                 * @param gain optional buffer of src->length() samples to store the gain envelope
+                 * @return status of operation
+                 */
+                status_t            process(Sample *dst, const Sample *src, float *gain = NULL);
+
+                /**
+                 * Get performance counters, they are updated only when the library
+                 * is built with LSP_DSP_UNITS_PERF_COUNTERS defined
+                 * @return performance counters
+                 */
+                inline const PerfCounter *perf() const             { return &sPerf; }
+
+                /**
+                 * Add the memory footprint of the limiter to the report
+                 * @param r report to update
+                 */
+                void                memory_usage(memory_report_t *r) const;
+
                 /**
                  * Dump internal state
                  * @param v state dumper
@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_DYNAMICS_MULTIBANDLIMITER_H_
+#define LSP_PLUG_IN_DSP_UNITS_DYNAMICS_MULTIBANDLIMITER_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/dsp-units/dynamics/Limiter.h>
+#include <lsp-plug.in/dsp-units/util/Crossover.h>
+#include <lsp-plug.in/dsp-units/util/ScratchArena.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Multiband limiter. The input signal is split into bands twice: the undelayed
+         * split is the sidechain for the gain curves of band limiters, the split of the
+         * delayed input gives band signals aligned with the gain curves. Since the
+         * crossover is linear, the delay of the input is equal to the delay of each band,
+         * so one lookahead delay line is shared by all bands, and the processed bands
+         * are summed directly into the output.
+         */
+        class MultibandLimiter
+        {
+            private:
+                MultibandLimiter & operator = (const MultibandLimiter &);
+                MultibandLimiter(const MultibandLimiter &);
+
+            protected:
+                typedef struct band_t
+                {
+                    Limiter             sLimiter;       // Limiter that computes the gain curve only
+                    float              *vGain;          // Gain curve of the current block
+                    bool                bEnabled;       // Band is enabled
+                } band_t;
+
+            protected:
+                Crossover           sScSplit;           // Crossover for the sidechain signal
+                Crossover           sSplit;             // Crossover for the delayed signal
+                ScratchArena        sArena;             // Temporary buffers shared by crossovers
+                band_t             *vBands;             // List of bands
+                size_t              nBands;             // Number of bands
+                float              *vDelay;             // Shared lookahead delay line
+                size_t              nMaxDelay;          // Maximum delay
+                float              *pOut;               // Output buffer of the current block
+                uint8_t            *pData;              // Allocated data
+
+            protected:
+                static void         process_sidechain(void *object, void *subject, size_t band, const float *data, size_t first, size_t count);
+                static void         process_band(void *object, void *subject, size_t band, const float *data, size_t first, size_t count);
+
+            public:
+                explicit MultibandLimiter();
+                ~MultibandLimiter();
+
+                /**
+                 * Construct the object
+                 */
+                void                construct();
+
+                /**
+                 * Destroy the object
+                 */
+                void                destroy();
+
+                /**
+                 * Initialize the multiband limiter
+                 * @param bands number of bands
+                 * @param max_sr maximum sample rate
+                 * @param max_lookahead maximum lookahead time [ms]
+                 * @return true on success
+                 */
+                bool                init(size_t bands, size_t max_sr, float max_lookahead);
+
+            public:
+                /**
+                 * Get number of bands
+                 * @return number of bands
+                 */
+                inline size_t       num_bands() const           { return nBands;        }
+
+                /**
+                 * Set sample rate
+                 * @param sr sample rate
+                 */
+                void                set_sample_rate(size_t sr);
+
+                /**
+                 * Set frequency of the split point
+                 * @param sp split point number
+                 * @param freq frequency
+                 */
+                void                set_frequency(size_t sp, float freq);
+
+                /**
+                 * Set slope of the split point
+                 * @param sp split point number
+                 * @param slope slope of crossover filters, 0 turns the split point off
+                 */
+                void                set_slope(size_t sp, size_t slope);
+
+                /**
+                 * Set mode of crossover filters of the split point
+                 * @param sp split point number
+                 * @param mode filter mode
+                 */
+                void                set_crossover_mode(size_t sp, crossover_mode_t mode);
+
+                /**
+                 * Set lookahead time of all bands
+                 * @param lookahead lookahead time [ms]
+                 */
+                void                set_lookahead(float lookahead);
+
+                /**
+                 * Set limiter mode of all bands
+                 * @param mode limiter mode
+                 */
+                void                set_mode(limiter_mode_t mode);
+
+                /**
+                 * Enable or disable the true peak detection for all bands
+                 * @param enable enable flag
+                 */
+                void                set_true_peak(bool enable);
+
+                /**
+                 * Set threshold of the band
+                 * @param band band number
+                 * @param thresh threshold
+                 * @param immediate apply the threshold immediately
+                 */
+                void                set_threshold(size_t band, float thresh, bool immediate);
+
+                /**
+                 * Set attack time of the band
+                 * @param band band number
+                 * @param attack attack time [ms]
+                 */
+                void                set_attack(size_t band, float attack);
+
+                /**
+                 * Set release time of the band
+                 * @param band band number
+                 * @param release release time [ms]
+                 */
+                void                set_release(size_t band, float release);
+
+                /**
+                 * Set knee of the band
+                 * @param band band number
+                 * @param knee knee
+                 */
+                void                set_knee(size_t band, float knee);
+
+                /**
+                 * Enable or disable the band, the disabled band is removed from the output
+                 * @param band band number
+                 * @param enable enable flag
+                 */
+                void                set_enabled(size_t band, bool enable);
+
+                /**
+                 * Get latency of the multiband limiter
+                 * @return latency in samples
+                 */
+                size_t              latency() const;
+
+                /**
+                 * Get the gain curve of the band computed by the last process() call
+                 * @param band band number
+                 * @return gain curve or NULL
+                 */
+                const float        *band_gain(size_t band) const;
+
+                /**
+                 * Process the signal
+                 * @param dst destination buffer, may be the same as source
+                 * @param src source buffer
+                 * @param samples number of samples to process
+                 */
+                void                process(float *dst, const float *src, size_t samples);
+
+                /**
+                 * Dump internal state
+                 * @param v state dumper
+                 */
+                void                dump(IStateDumper *v) const;
+        };
+    } /* namespace dspu */
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_DYNAMICS_MULTIBANDLIMITER_H_ */
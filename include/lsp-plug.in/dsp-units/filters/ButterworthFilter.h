@@ -26,6 +26,8 @@
 #include <lsp-plug.in/common/types.h>
 #include <lsp-plug.in/dsp-units/filters/FilterBank.h>
 
+#define BW_MAX_ORDER            100u    /* Maximum order of the filter */
+
 namespace lsp
 {
     namespace dspu
@@ -131,6 +133,24 @@ namespace lsp
                     bSync       = true;
                 }
 
+                /** Check that the filter is bypassed with current settings
+                 *
+                 * @return true if the filter is bypassed
+                 */
+                inline bool bypassed() const
+                {
+                    return bBypass;
+                }
+
+                /** Get the cascade of the filter, valid after update_settings()
+                 *
+                 * @return filter bank that holds the cascade
+                 */
+                inline const FilterBank *filter_bank() const
+                {
+                    return &sFilter;
+                }
+
                 /** Output sequence to the destination buffer in additive mode
                  *
                  * @param dst output wave destination
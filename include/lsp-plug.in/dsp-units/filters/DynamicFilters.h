@@ -65,13 +65,18 @@ namespace lsp
                 dsp::f_cascade_t   *vCascades;          // Analog filter cascade bank
                 float              *vMemory;            // Filter memory
                 biquad_bank_t       vBiquads;           // Biquad bank
+                dsp::f_cascade_t   *vDecCascades;       // Analog filter cascades at decimated points
+                float              *vDecGain;           // Gain curve at decimated points
+                size_t              nDecimation;        // Coefficient decimation, 1 means per-sample computation
                 size_t              nFilters;           // Number of filters
+                size_t              nChannels;          // Number of channels
                 size_t              nSampleRate;        // Sample rate
                 void               *pData;              // Aligned pointer data
                 bool                bClearMem;          // Clear memory
 
             protected:
                 size_t              quantify(size_t c, size_t nc);
+                size_t              build_cascades(dsp::f_cascade_t *dst, const filter_params_t *fp, size_t cj, const float *sfg, size_t samples);
                 size_t              build_filter_bank(dsp::f_cascade_t *dst, const filter_params_t *fp, size_t cj, const float *sfg, size_t samples);
                 size_t              build_lrx_ladder_filter_bank(dsp::f_cascade_t *dst, const filter_params_t *fp, size_t cj, const float *sfg, size_t samples, size_t ftype);
                 size_t              build_lrx_shelf_filter_bank(dsp::f_cascade_t *dst, const filter_params_t *fp, size_t cj, const float *sfg, size_t samples, size_t ftype);
@@ -98,6 +103,15 @@ namespace lsp
                  */
                 status_t            init(size_t filters);
 
+                /** Initialize the dynamic filters set that processes several channels
+                 * with the same gain curve
+                 *
+                 * @param filters number of filters
+                 * @param channels number of channels
+                 * @return status of operation
+                 */
+                status_t            init(size_t filters, size_t channels);
+
                 /** Destroy the dynamic filters set
                  *
                  */
@@ -110,6 +124,20 @@ namespace lsp
                  */
                 void                set_sample_rate(size_t sr);
 
+                /** Set decimation of filter coefficient computation: the cascades are computed
+                 * every decimation samples of the gain curve and linearly interpolated between
+                 * computed points
+                 *
+                 * @param decimation decimation factor, 1 means computation for each sample
+                 */
+                void                set_decimation(size_t decimation);
+
+                /** Get decimation of filter coefficient computation
+                 *
+                 * @return decimation of filter coefficient computation
+                 */
+                inline size_t       decimation() const { return nDecimation; }
+
                 /** Check that filter is active
                  *
                  * @param id ID of filter
@@ -162,6 +190,24 @@ namespace lsp
                  */
                 void                process(size_t id, float *out, const float *in, const float *gain, size_t samples);
 
+                /** Process multiple channels with filter varying by the shared gain parameter,
+                 * filter coefficients are computed once and applied to all channels
+                 *
+                 * @param id filer identifier
+                 * @param out output signals
+                 * @param in input signals
+                 * @param gain the gain level of the filter
+                 * @param channels number of channels, should not be greater than the number of channels passed to init()
+                 * @param samples number of samples to process
+                 */
+                void                process(size_t id, float * const *out, const float * const *in, const float *gain, size_t channels, size_t samples);
+
+                /** Get number of channels
+                 *
+                 * @return number of channels
+                 */
+                inline size_t       channels() const { return nChannels; }
+
                 /** Get frequency chart of the specific filter
                  *
                  * @param id ID of the filter
@@ -181,6 +227,20 @@ namespace lsp
                  */
                 bool                freq_chart(size_t id, float *dst, const float *f, float gain, size_t count);
 
+                /** Get frequency charts of the specific filter for several gain values at once.
+                 * The frequency-dependent terms are computed once and the cascades are built
+                 * for all gain values in one pass
+                 *
+                 * @param id ID of the filter
+                 * @param dst array of gains pointers to arrays of complex numbers to store data
+                 * @param f frequencies to calculate value
+                 * @param gain array of gain values
+                 * @param gains number of gain values
+                 * @param count number of dots for each chart
+                 * @return true on success
+                 */
+                bool                freq_chart(size_t id, float * const *dst, const float *f, const float *gain, size_t gains, size_t count);
+
             public:
                 void                dump(dspu::IStateDumper *v) const;
         };
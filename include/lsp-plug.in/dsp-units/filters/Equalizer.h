@@ -24,9 +24,13 @@
 
 #include <lsp-plug.in/dsp-units/version.h>
 #include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/dsp-units/misc/memory.h>
+#include <lsp-plug.in/dsp-units/util/PerfCounter.h>
 #include <lsp-plug.in/dsp-units/filters/common.h>
 #include <lsp-plug.in/dsp-units/filters/FilterBank.h>
 #include <lsp-plug.in/dsp-units/filters/Filter.h>
+#include <lsp-plug.in/dsp-units/util/Convolver.h>
+#include <lsp-plug.in/common/atomic.h>
 
 namespace lsp
 {
@@ -38,7 +42,9 @@ namespace lsp
             EQM_IIR,    // All filters are recursive filters with infinite impulse response filters
             EQM_FIR,    // All filters are non-recursive filters with finite impulse response filters
             EQM_FFT,    // Approximation of the frequency chart in the frequency range
-            EQM_SPM     // Equalizer acts as a Spectral Processing Module
+            EQM_SPM,    // Equalizer acts as a Spectral Processing Module
+            EQM_FIR_LL, // Same as EQM_FIR but uses partitioned convolution with low latency
+            EQM_FFT_LL  // Same as EQM_FFT but uses partitioned convolution with low latency
         };
 
         /**
@@ -50,7 +56,11 @@ namespace lsp
                 Equalizer & operator = (const Equalizer &);
                 Equalizer(const Equalizer &);
 
+                friend class MultiEqualizer;
+
             protected:
+                class RebuildThread;
+
                 enum eq_flags_t
                 {
                     EF_REBUILD = 1 << 0,
@@ -59,6 +69,7 @@ namespace lsp
 
             protected:
                 FilterBank          sBank;              // Filter bank
+                Convolver           sConv;              // Partitioned convolver for low-latency modes
                 Filter             *vFilters;           // List of filters
                 size_t              nFilters;           // Number of filters
                 size_t              nSampleRate;        // Sample rate
@@ -73,12 +84,40 @@ namespace lsp
                 float              *vConv;              // Convolution data
                 float              *vFft;               // FFT transform data buffer (real + imaginary)
                 float              *vTemp;              // Temporary buffer for miscellaneous calculations
+                const float        *vFftTable;          // Twiddle table of the real-input FFT
 
                 size_t              nFlags;             // Flag that identifies that equalizer has to be rebuilt
                 uint8_t            *pData;              // Allocation data
 
+                FilterBank          sJobBank;           // Filter bank of the background job
+                Filter             *vJobFilters;        // Filters of the background job
+                filter_params_t    *vJobParams;         // Snapshot of filter parameters for background job
+                size_t              nJobSampleRate;     // Sample rate of the background job
+                equalizer_mode_t    nJobMode;           // Equalizer mode of the background job
+                float              *vNextConv;          // Kernel built by the background job
+                float              *vJobFft;            // FFT buffer of the background job
+                float              *vJobTemp;           // Temporary buffer of the background job
+                float              *vXOutBuffer;        // Output buffer data for the new kernel
+                float              *vPrevIn;            // Previous block of input data
+                RebuildThread      *pRebuild;           // Background thread that builds the kernel
+                atomic_t            nJobReq;            // Number of submitted background jobs
+                atomic_t            nJobDone;           // Number of completed background jobs
+                bool                bJobSubmit;         // Parameters have changed, new job should be submitted
+                bool                bJobActive;         // Background job has been submitted and not applied yet
+                bool                bJobDiscard;        // Result of the background job should be discarded
+                bool                bJobSwapped;        // Kernel and output buffers are swapped with background ones
+                uint8_t            *pJobData;           // Allocation data of the background job
+                PerfCounter         sPerf;              // Performance counters
+                IdleDetector        sIdle;              // Idle state detector of FIR modes
+
             protected:
                 void                reconfigure();
+                void                build_kernel(float *conv, float *fft, float *temp, Filter *filters, FilterBank *bank, size_t sr, equalizer_mode_t mode);
+                void                process_job();
+                bool                sync_job();
+                void                switch_kernel();
+                void                swap_buffers();
+                void                stop_async();
 
             public:
                 explicit Equalizer();
@@ -143,6 +182,58 @@ namespace lsp
                  */
                 void                set_sample_rate(size_t sr);
 
+                /** Set the length of coefficient interpolation when filter parameters change
+                 * in EQM_IIR mode
+                 *
+                 * @param samples length of interpolation in samples, 0 disables smoothing
+                 */
+                inline void         set_smooth(size_t samples) { sBank.set_smooth(samples); }
+
+                /** Set threshold of silence for skipping the processing of the idle equalizer:
+                 * the equalizer stops computing once the input has been silent for the tail
+                 * length and outputs silence until the non-silent input arrives
+                 *
+                 * @param threshold absolute threshold of silence, non-positive value disables the skip
+                 */
+                void                set_idle_threshold(float threshold);
+
+                /** Get the tail length of the equalizer, valid after the first process() call
+                 * since the last change of settings
+                 *
+                 * @param threshold threshold of decay relative to the input level, used in EQM_IIR mode
+                 * @return tail length in samples, IDLE_TAIL_INFINITE if the equalizer does not decay
+                 */
+                size_t              tail(float threshold) const;
+
+                /** Check that the equalizer is idle and skips the processing
+                 *
+                 * @return true if the equalizer is idle
+                 */
+                inline bool         idle() const { return (nMode == EQM_IIR) ? sBank.idle() : sIdle.idle(); }
+
+                /** Enable or disable rebuilding of the FIR kernel in the background thread
+                 * for EQM_FIR and EQM_FFT modes. The equalizer keeps processing with the
+                 * previous kernel until the new one is ready, then crossfades to the new
+                 * kernel during one block of nFirSize samples. Should not be called from
+                 * the audio thread since it allocates memory and starts the thread
+                 *
+                 * @param async true to rebuild the kernel in background
+                 * @return true on success
+                 */
+                bool                set_async(bool async);
+
+                /** Check that the FIR kernel is rebuilt in the background thread
+                 *
+                 * @return true if the FIR kernel is rebuilt in the background thread
+                 */
+                inline bool         async() const { return pRebuild != NULL; }
+
+                /** Set cache of built filters for all filters of the equalizer
+                 *
+                 * @param cache cache of built filters or NULL to disable caching
+                 */
+                void                set_cache(FilterCache *cache);
+
                 /** Get equalizer mode
                  *
                  * @return equalizer mode
@@ -237,6 +328,19 @@ namespace lsp
                  */
                 size_t              ir_size() const;
 
+                /**
+                 * Get performance counters, they are updated only when the library
+                 * is built with LSP_DSP_UNITS_PERF_COUNTERS defined
+                 * @return performance counters
+                 */
+                inline const PerfCounter *perf() const             { return &sPerf; }
+
+                /**
+                 * Add the memory footprint of the equalizer to the report
+                 * @param r report to update
+                 */
+                void                memory_usage(memory_report_t *r) const;
+
                 /**
                  * Dump the state
                  * @param dumper dumper
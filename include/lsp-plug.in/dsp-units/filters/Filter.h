@@ -24,14 +24,37 @@
 
 #include <lsp-plug.in/dsp-units/version.h>
 #include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/dsp-units/misc/memory.h>
 #include <lsp-plug.in/dsp-units/filters/common.h>
 #include <lsp-plug.in/dsp-units/filters/FilterBank.h>
+#include <lsp-plug.in/dsp-units/filters/FilterCache.h>
 #include <lsp-plug.in/dsp/dsp.h>
 
+#define FILTER_CHART_BLOCK          0x100U
+
 namespace lsp
 {
     namespace dspu
     {
+        /**
+         * Frequency-dependent data shared between all filters with the same sample rate
+         * when computing the frequency chart of several filters at once
+         */
+        typedef struct filter_chart_t
+        {
+            size_t      nSampleRate;                            // Sample rate
+            size_t      nCount;                                 // Number of frequencies, not greater than FILTER_CHART_BLOCK
+            const float*vFreq;                                  // Frequencies
+            float       vTan[FILTER_CHART_BLOCK]    __lsp_aligned16;    // Pre-warped frequencies tan(pi * f / sr)
+            float       vCos[FILTER_CHART_BLOCK]    __lsp_aligned16;    // cos(w)
+            float       vSin[FILTER_CHART_BLOCK]    __lsp_aligned16;    // sin(w)
+            float       vCos2[FILTER_CHART_BLOCK]   __lsp_aligned16;    // cos(2*w)
+            float       vSin2[FILTER_CHART_BLOCK]   __lsp_aligned16;    // sin(2*w)
+            float       vScaled[FILTER_CHART_BLOCK] __lsp_aligned16;    // Normalized frequencies of the filter
+            float       vRe[FILTER_CHART_BLOCK]     __lsp_aligned16;    // Temporary real part
+            float       vIm[FILTER_CHART_BLOCK]     __lsp_aligned16;    // Temporary imaginary part
+        } filter_chart_t;
+
         /**
          * Single filter implementation
          */
@@ -59,6 +82,7 @@ namespace lsp
 
             protected:
                 FilterBank         *pBank;          // External bank of filters
+                FilterCache        *pCache;         // Cache of built filters
                 filter_params_t     sParams;        // Filter parameters
                 size_t              nSampleRate;    // Sample rate
                 filter_mode_t       nMode;          // Filter mode
@@ -70,7 +94,6 @@ namespace lsp
 
             protected:
 
-                void                apo_complex_transfer_calc(float *re, float *im, float f);
                 dsp::f_cascade_t   *add_cascade();
 
                 void                calc_rlc_filter(size_t type, const filter_params_t *fp);
@@ -78,6 +101,8 @@ namespace lsp
                 void                calc_lrx_filter(size_t type, const filter_params_t *fp);
                 void                calc_apo_filter(size_t type, const filter_params_t *fp);
                 float               bilinear_relative(float f1, float f2);
+                bool                load_cached();
+                void                store_cached(size_t first);
                 void                bilinear_transform();
                 void                matched_transform();
 
@@ -154,6 +179,79 @@ namespace lsp
                  */
                 void                freq_chart(float *c, const float *f, size_t count);
 
+                /** Prepare frequency-dependent data for the batched frequency chart computation
+                 *
+                 * @param chart chart data to prepare
+                 * @param sr sample rate
+                 * @param f frequencies to calculate value
+                 * @param count number of dots, should not be greater than FILTER_CHART_BLOCK
+                 */
+                static void         freq_chart_prepare(filter_chart_t *chart, size_t sr, const float *f, size_t count);
+
+                /** Multiply the frequency chart by the transfer function of the filter
+                 *
+                 * @param re real part of the frequency chart
+                 * @param im imaginary part of the frequency chart
+                 * @param chart prepared chart data
+                 */
+                void                freq_chart_apply(float *re, float *im, filter_chart_t *chart);
+
+                /** Multiply the frequency chart by the transfer function of the filter
+                 *
+                 * @param c packed complex frequency chart
+                 * @param chart prepared chart data
+                 */
+                void                freq_chart_apply(float *c, filter_chart_t *chart);
+
+                /** Set the length of coefficient interpolation when filter parameters change,
+                 * applicable only for filters that use their own filter bank
+                 *
+                 * @param samples length of interpolation in samples, 0 disables smoothing
+                 */
+                inline void         set_smooth(size_t samples)
+                {
+                    if (nFlags & FF_OWN_BANK)
+                        pBank->set_smooth(samples);
+                }
+
+                /** Set threshold of silence for skipping the processing of the idle filter,
+                 * applicable only for filters that use their own filter bank
+                 *
+                 * @param threshold absolute threshold of silence, non-positive value disables the skip
+                 */
+                inline void         set_idle_threshold(float threshold)
+                {
+                    if (nFlags & FF_OWN_BANK)
+                        pBank->set_idle_threshold(threshold);
+                }
+
+                /** Get the tail length of the filter, valid after rebuild(), the shared filter
+                 * bank reports the tail of all its filters
+                 *
+                 * @param threshold threshold of decay relative to the input level
+                 * @return tail length in samples, IDLE_TAIL_INFINITE if the filter does not decay
+                 */
+                inline size_t       tail(float threshold) const
+                {
+                    return (nMode == FM_BYPASS) ? 0 : pBank->tail(threshold);
+                }
+
+                /** Set cache of built filters, the cache can be shared between several
+                 * filters processed by the same thread
+                 *
+                 * @param cache cache of built filters or NULL to disable caching
+                 */
+                inline void         set_cache(FilterCache *cache)
+                {
+                    pCache      = cache;
+                }
+
+                /** Get cache of built filters
+                 *
+                 * @return cache of built filters
+                 */
+                inline FilterCache *cache()             { return pCache;                }
+
                 /** Mark filter to be cleared
                  *
                  */
@@ -182,6 +280,13 @@ namespace lsp
                  */
                 inline bool         active() const      { return nMode != FM_BYPASS; }
 
+                /**
+                 * Add the memory footprint of the filter to the report, the external
+                 * filter bank is not accounted
+                 * @param r report to update
+                 */
+                void                memory_usage(memory_report_t *r) const;
+
                 /**
                  * Dump the state
                  * @param dumper dumper
@@ -24,6 +24,8 @@
 
 #include <lsp-plug.in/dsp-units/version.h>
 #include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/dsp-units/misc/memory.h>
+#include <lsp-plug.in/dsp-units/ctl/IdleDetector.h>
 #include <lsp-plug.in/dsp-units/filters/common.h>
 #include <lsp-plug.in/dsp/dsp.h>
 
@@ -37,6 +39,9 @@ namespace lsp
                 FilterBank & operator = (const FilterBank &);
                 FilterBank(const FilterBank &);
 
+            protected:
+                typedef void (* cascade_t)(float *out, const float *in, size_t samples, dsp::biquad_t *f, size_t items);
+
             protected:
                 dsp::biquad_t      *vFilters;   // Optimized list of filters
                 dsp::biquad_x1_t   *vChains;    // List of biquad banks
@@ -44,10 +49,22 @@ namespace lsp
                 size_t              nMaxItems;  // Maximum number of biquad_x1 filters
                 size_t              nLastItems; // Previous number of biquad_x1 filters
                 float              *vBackup;    // Delay backup to take online impulse response
+                dsp::biquad_t      *vStart;     // Filter coefficients at the beginning of smoothing
+                dsp::biquad_t      *vTarget;    // Filter coefficients at the end of smoothing
+                size_t              nSmooth;    // Length of coefficient smoothing in samples
+                size_t              nSmoothPos; // Current position of coefficient smoothing
                 uint8_t            *vData;      // Unaligned data
+                IdleDetector        sIdle;      // Idle state detector
+                cascade_t           pCascade;   // Cascade kernel selected for the number of filters
 
             protected:
                 void                clear_delays();
+                size_t              num_banks() const;
+                void                interpolate_banks(float k);
+                void                process_banks(float *out, const float *in, size_t samples);
+                static float        pole_radius(const dsp::biquad_x1_t *f);
+                static cascade_t    select_cascade(size_t items);
+                static size_t       data_size(size_t filters);
 
             public:
                 explicit FilterBank();
@@ -86,11 +103,32 @@ namespace lsp
                  */
                 dsp::biquad_x1_t   *add_chain();
 
-                /** Optimize structure of filter bank
+                /** Optimize structure of filter bank. If smoothing is enabled and the
+                 * structure of the bank has not been changed, the coefficients are
+                 * interpolated from previous to new values while processing
+                 *
                  * @param clear force to clear delays
                  */
                 void                end(bool clear = false);
 
+                /** Set the length of linear coefficient interpolation applied after end()
+                 *
+                 * @param samples length of interpolation in samples, 0 disables smoothing
+                 */
+                void                set_smooth(size_t samples);
+
+                /** Get the length of coefficient interpolation
+                 *
+                 * @return length of coefficient interpolation in samples
+                 */
+                inline size_t       smooth() const { return nSmooth; }
+
+                /** Check that coefficient interpolation is in progress
+                 *
+                 * @return true if coefficient interpolation is in progress
+                 */
+                inline bool         smoothing() const { return nSmoothPos < nSmooth; }
+
                 /** Process samples
                  *
                  * @param out output buffer
@@ -99,6 +137,29 @@ namespace lsp
                  */
                 void                process(float *out, const float *in, size_t samples);
 
+                /** Estimate the tail length of the bank: the number of samples the impulse
+                 * response needs to decay below the threshold, computed from the radius
+                 * of the dominant pole of each cascade
+                 *
+                 * @param threshold threshold of decay relative to the input level
+                 * @return tail length in samples, IDLE_TAIL_INFINITE if the bank does not decay
+                 */
+                size_t              tail(float threshold) const;
+
+                /** Set threshold of silence for skipping the processing of the idle bank:
+                 * the bank stops computing once the input has been silent for the tail length
+                 * of the bank and outputs silence until the non-silent input arrives
+                 *
+                 * @param threshold absolute threshold of silence, non-positive value disables the skip
+                 */
+                void                set_idle_threshold(float threshold);
+
+                /** Check that the bank is idle and skips the processing
+                 *
+                 * @return true if the bank is idle
+                 */
+                inline bool         idle() const { return sIdle.idle(); }
+
                 /** Get impulse response of the bank
                  *
                  * @param out output buffer to store impulse response
@@ -112,11 +173,27 @@ namespace lsp
                  */
                 inline size_t       size() const { return nItems; }
 
+                /** Get biquad filter of the cascade
+                 *
+                 * @param index index of the filter
+                 * @return pointer to the filter or NULL if index is out of range
+                 */
+                inline const dsp::biquad_x1_t *chain(size_t index) const
+                {
+                    return (index < nItems) ? &vChains[index] : NULL;
+                }
+
                 /** Reset internal state of filters (clear filter memory)
                  *
                  */
                 void                reset();
 
+                /**
+                 * Add the memory footprint of the filter bank to the report
+                 * @param r report to update
+                 */
+                void                memory_usage(memory_report_t *r) const;
+
                 /**
                  * Dump the state
                  * @param dumper dumper
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_FILTERS_FILTERCACHE_H_
+#define LSP_PLUG_IN_DSP_UNITS_FILTERS_FILTERCACHE_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/dsp-units/filters/common.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Built filter stored in the cache
+         */
+        typedef struct filter_cache_entry_t
+        {
+            filter_params_t             sParams;                        // Filter parameters
+            size_t                      nSampleRate;                    // Sample rate
+            size_t                      nMode;                          // Filter mode
+            size_t                      nLatency;                       // Filter latency
+            size_t                      nCascades;                      // Number of analog cascades
+            size_t                      nChains;                        // Number of digital biquad filters
+            dsp::f_cascade_t            vCascades[FILTER_CHAINS_MAX];   // Analog cascades, used for frequency charts
+            dsp::biquad_x1_t            vChains[FILTER_CHAINS_MAX];     // Digital biquad filters
+            filter_cache_entry_t       *pPrev;                          // Previous entry in LRU list
+            filter_cache_entry_t       *pNext;                          // Next entry in LRU list
+        } filter_cache_entry_t;
+
+        /**
+         * LRU cache of built filter cascades keyed by filter parameters and sample rate.
+         * All memory is allocated by init(), so lookups and stores do not allocate memory.
+         * The cache is not thread safe and should be shared only between filters processed
+         * by the same thread
+         */
+        class FilterCache
+        {
+            private:
+                FilterCache & operator = (const FilterCache &);
+                FilterCache(const FilterCache &);
+
+            protected:
+                filter_cache_entry_t       *vEntries;   // All entries
+                filter_cache_entry_t       *pHead;      // Most recently used entry
+                filter_cache_entry_t       *pTail;      // Least recently used entry
+                size_t                      nCapacity;  // Maximum number of entries
+                size_t                      nSize;      // Current number of entries
+                size_t                      nHits;      // Number of cache hits
+                size_t                      nMisses;    // Number of cache misses
+                uint8_t                    *pData;      // Allocated data
+
+            protected:
+                void                        unlink(filter_cache_entry_t *e);
+                void                        link_first(filter_cache_entry_t *e);
+
+            public:
+                explicit FilterCache();
+                ~FilterCache();
+
+                /**
+                 * Construct the object being the chunk of memory
+                 */
+                void                        construct();
+
+                /**
+                 * Initialize cache
+                 * @param capacity maximum number of filters stored in the cache
+                 * @return true on success
+                 */
+                bool                        init(size_t capacity);
+
+                /**
+                 * Destroy cache
+                 */
+                void                        destroy();
+
+            public:
+                /**
+                 * Find built filter in the cache and mark it as recently used
+                 * @param params filter parameters
+                 * @param sr sample rate
+                 * @return pointer to the entry or NULL if there is no such entry
+                 */
+                const filter_cache_entry_t *find(const filter_params_t *params, size_t sr);
+
+                /**
+                 * Allocate entry for the built filter, the least recently used entry is
+                 * replaced if the cache is full. The caller should fill the entry data
+                 * @param params filter parameters
+                 * @param sr sample rate
+                 * @return pointer to the entry or NULL if cache is not initialized
+                 */
+                filter_cache_entry_t       *store(const filter_params_t *params, size_t sr);
+
+                /**
+                 * Remove all entries from the cache
+                 */
+                void                        clear();
+
+                /**
+                 * Get number of entries in the cache
+                 * @return number of entries in the cache
+                 */
+                inline size_t               size() const        { return nSize;         }
+
+                /**
+                 * Get capacity of the cache
+                 * @return capacity of the cache
+                 */
+                inline size_t               capacity() const    { return nCapacity;     }
+
+                /**
+                 * Get number of cache hits
+                 * @return number of cache hits
+                 */
+                inline size_t               hits() const        { return nHits;         }
+
+                /**
+                 * Get number of cache misses
+                 * @return number of cache misses
+                 */
+                inline size_t               misses() const      { return nMisses;       }
+
+                /**
+                 * Dump the state
+                 * @param dumper dumper
+                 */
+                void                        dump(IStateDumper *v) const;
+        };
+    }
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_FILTERS_FILTERCACHE_H_ */
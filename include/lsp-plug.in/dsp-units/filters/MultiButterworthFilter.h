@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_FILTERS_MULTIBUTTERWORTHFILTER_H_
+#define LSP_PLUG_IN_DSP_UNITS_FILTERS_MULTIBUTTERWORTHFILTER_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/filters/ButterworthFilter.h>
+#include <lsp-plug.in/dsp-units/filters/MultiFilterBank.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Multi-channel Butterworth filter: the cascade is computed once by
+         * ButterworthFilter and all channels are processed by the same cascade in
+         * interleaved lanes of MultiFilterBank
+         */
+        class MultiButterworthFilter
+        {
+            private:
+                MultiButterworthFilter & operator = (const MultiButterworthFilter &);
+                MultiButterworthFilter(const MultiButterworthFilter &);
+
+            protected:
+                ButterworthFilter   sFilter;    // Designer of the cascade
+                MultiFilterBank     sBank;      // Cascade applied to all channels
+                const float       **vInputs;    // List of input pointers for block processing
+                float             **vBuffers;   // Temporary buffers, one per channel
+                size_t              nChannels;  // Number of channels
+                bool                bBypass;    // Bypass flag
+                bool                bSync;      // Settings need update
+                uint8_t            *pData;      // Allocated data
+
+            public:
+                explicit MultiButterworthFilter();
+                ~MultiButterworthFilter();
+
+                /**
+                 * Construct the object
+                 */
+                void                construct();
+
+                /**
+                 * Destroy the object
+                 */
+                void                destroy();
+
+            public:
+                /** Initialize the filter
+                 *
+                 * @param channels number of channels
+                 * @return true on success
+                 */
+                bool                init(size_t channels);
+
+                /** Get number of channels
+                 *
+                 * @return number of channels
+                 */
+                inline size_t       channels() const        { return nChannels;         }
+
+                /** Check that filter needs settings update
+                 *
+                 * @return true if filter needs settings update
+                 */
+                inline bool         needs_update() const    { return bSync;             }
+
+                /** This method should be called if needs_update() returns true
+                 * before calling processing methods
+                 */
+                void                update_settings();
+
+                /** Check that the filter is bypassed with current settings
+                 *
+                 * @return true if the filter is bypassed
+                 */
+                inline bool         bypassed() const        { return bBypass;           }
+
+                /** Set the order of the filter
+                 *
+                 * @param order order of the filter
+                 */
+                inline void         set_order(size_t order)
+                {
+                    sFilter.set_order(order);
+                    bSync       = true;
+                }
+
+                /** Set the cutoff frequency of the filter
+                 *
+                 * @param frequency cutoff frequency
+                 */
+                inline void         set_cutoff_frequency(float frequency)
+                {
+                    sFilter.set_cutoff_frequency(frequency);
+                    bSync       = true;
+                }
+
+                /** Set filter type
+                 *
+                 * @param type filter type
+                 */
+                inline void         set_filter_type(bw_filt_type_t type)
+                {
+                    sFilter.set_filter_type(type);
+                    bSync       = true;
+                }
+
+                /** Set sample rate of the filter
+                 *
+                 * @param sr sample rate
+                 */
+                inline void         set_sample_rate(size_t sr)
+                {
+                    sFilter.set_sample_rate(sr);
+                    bSync       = true;
+                }
+
+                /** Clear the memory of the filter
+                 */
+                inline void         reset()                 { sBank.reset();            }
+
+                /** Output filtered channels to the destination buffers in additive mode
+                 *
+                 * @param dst list of output buffers
+                 * @param src list of input buffers, allowed to be NULL
+                 * @param count number of samples to process
+                 */
+                void                process_add(float * const *dst, const float * const *src, size_t count);
+
+                /** Output filtered channels to the destination buffers in multiplicative mode
+                 *
+                 * @param dst list of output buffers
+                 * @param src list of input buffers, allowed to be NULL
+                 * @param count number of samples to process
+                 */
+                void                process_mul(float * const *dst, const float * const *src, size_t count);
+
+                /** Output filtered channels to the destination buffers overwriting their content,
+                 * in-place processing is allowed
+                 *
+                 * @param dst list of output buffers
+                 * @param src list of input buffers, allowed to be NULL
+                 * @param count number of samples to process
+                 */
+                void                process_overwrite(float * const *dst, const float * const *src, size_t count);
+
+                /**
+                 * Dump internal state
+                 * @param v state dumper
+                 */
+                void                dump(IStateDumper *v) const;
+        };
+    }
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_FILTERS_MULTIBUTTERWORTHFILTER_H_ */
@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_FILTERS_MULTIEQUALIZER_H_
+#define LSP_PLUG_IN_DSP_UNITS_FILTERS_MULTIEQUALIZER_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/dsp-units/filters/Equalizer.h>
+#include <lsp-plug.in/dsp-units/filters/MultiFilterBank.h>
+#include <lsp-plug.in/dsp-units/util/Convolver.h>
+#include <lsp-plug.in/dsp-units/util/ConvolverCache.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Multi-channel equalizer: the filters and the FIR kernel are built once by
+         * the designer Equalizer and shared by all channels. In EQM_IIR mode the
+         * cascade is processed in interleaved lanes of MultiFilterBank, in FIR and
+         * FFT modes all channels use the same parsed kernel spectrum, in low-latency
+         * modes the partitioned spectrum is shared between convolvers of channels
+         */
+        class MultiEqualizer
+        {
+            private:
+                MultiEqualizer & operator = (const MultiEqualizer &);
+                MultiEqualizer(const MultiEqualizer &);
+
+            protected:
+                typedef struct channel_t
+                {
+                    float              *vInBuffer;          // Input buffer data
+                    float              *vOutBuffer;         // Output buffer data
+                } channel_t;
+
+            protected:
+                Equalizer           sEq;                // Designer of the filters and the kernel
+                MultiFilterBank     sBank;              // Cascade applied to all channels
+                ConvolverCache      sCache;             // Partitioned spectrum shared by convolvers
+                Convolver          *vConvolvers;        // Convolvers of channels for low-latency modes
+                channel_t          *vChannels;          // List of channels
+                size_t              nChannels;          // Number of channels
+                size_t              nBufSize;           // Buffer size, same for all channels
+                float              *vTemp;              // Temporary buffer for convolution
+                uint8_t            *pData;              // Allocation data
+
+            protected:
+                void                reconfigure();
+
+            public:
+                explicit MultiEqualizer();
+                ~MultiEqualizer();
+
+                /**
+                 * Construct the object being part of memory chunk
+                 */
+                void                construct();
+
+                /** Initialize equalizer
+                 *
+                 * @param channels number of channels
+                 * @param filters number of filters
+                 * @param fir_rank FIR filter rank (impulse response size)
+                 * @return true on success
+                 */
+                bool                init(size_t channels, size_t filters, size_t fir_rank);
+
+                /** Destroy equalizer
+                 *
+                 */
+                void                destroy();
+
+            public:
+                /** Update filter parameters
+                 * @param id ID of the filter
+                 * @param params  filter parameters
+                 * @return true on success
+                 */
+                inline bool         set_params(size_t id, const filter_params_t *params) { return sEq.set_params(id, params); }
+
+                /** Get filter parameters
+                 * @param id ID of the filter
+                 * @param params  filter parameters
+                 * @return true on success
+                 */
+                inline bool         get_params(size_t id, filter_params_t *params) { return sEq.get_params(id, params); }
+
+                /** Set equalizer mode
+                 *
+                 * @param mode equalizer mode
+                 */
+                inline void         set_mode(equalizer_mode_t mode) { sEq.set_mode(mode); }
+
+                /** Set sample rate
+                 *
+                 * @param sr sample rate
+                 */
+                void                set_sample_rate(size_t sr);
+
+                /** Set cache of built filters for all filters of the equalizer
+                 *
+                 * @param cache cache of built filters or NULL to disable caching
+                 */
+                inline void         set_cache(FilterCache *cache) { sEq.set_cache(cache); }
+
+                /** Get number of channels
+                 *
+                 * @return number of channels
+                 */
+                inline size_t       channels() const { return nChannels; }
+
+                /** Get equalizer mode
+                 *
+                 * @return equalizer mode
+                 */
+                inline equalizer_mode_t get_mode() const { return sEq.get_mode(); }
+
+                /** Get equalizer latency
+                 *
+                 * @return equalizer latency
+                 */
+                size_t              get_latency();
+
+                /**
+                 * Get maximum possible latency for the equalizer
+                 * @return maximum possible latency
+                 */
+                inline size_t       max_latency() const { return sEq.max_latency(); }
+
+                /**
+                 * Get frequency chart of the whole equalizer
+                 * @param re real part of the frequency chart
+                 * @param im imaginary part of the frequency chart
+                 * @param f frequencies to calculate value
+                 * @param count number of dots for the chart
+                 */
+                void                freq_chart(float *re, float *im, const float *f, size_t count);
+
+                /**
+                 * Get frequency chart of the whole equalizer
+                 * @param c complex numbers that contain the filter transfer function
+                 * @param f frequencies to calculate filter transfer function
+                 * @param count number of points
+                 */
+                void                freq_chart(float *c, const float *f, size_t count);
+
+                /** Process the signal of all channels
+                 *
+                 * @param out list of output buffers
+                 * @param in list of input buffers
+                 * @param samples number of samples to process
+                 */
+                void                process(float * const *out, const float * const *in, size_t samples);
+
+                /**
+                 * Reset the internal memory of filters
+                 */
+                void                reset();
+
+                /**
+                 * Dump the state
+                 * @param dumper dumper
+                 */
+                void                dump(IStateDumper *v) const;
+        };
+    }
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_FILTERS_MULTIEQUALIZER_H_ */
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_FILTERS_MULTIFILTERBANK_H_
+#define LSP_PLUG_IN_DSP_UNITS_FILTERS_MULTIFILTERBANK_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/dsp-units/filters/FilterBank.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#define MFB_LANES           8       /* Number of channels processed in parallel */
+#define MFB_BLOCK           64      /* Number of samples processed per one pass */
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Multi-channel filter bank: applies the same cascade of biquad filters
+         * to several channels. Channels are packed into groups of MFB_LANES
+         * interleaved lanes, so one pass of the cascade processes all channels
+         * of the group at once
+         */
+        class MultiFilterBank
+        {
+            private:
+                MultiFilterBank & operator = (const MultiFilterBank &);
+                MultiFilterBank(const MultiFilterBank &);
+
+            protected:
+                dsp::biquad_x1_t   *vChains;    // List of biquad filters
+                size_t              nChannels;  // Number of channels
+                size_t              nGroups;    // Number of lane groups
+                size_t              nItems;     // Current number of biquad_x1 filters
+                size_t              nMaxItems;  // Maximum number of biquad_x1 filters
+                size_t              nLastItems; // Previous number of biquad_x1 filters
+                float              *vDelays;    // Delays of filters: group x filter x (d0[lanes], d1[lanes])
+                float              *vBuffer;    // Interleaved buffer of MFB_BLOCK x MFB_LANES samples
+                uint8_t            *vData;      // Unaligned data
+
+            public:
+                explicit MultiFilterBank();
+                ~MultiFilterBank();
+
+                /**
+                 * Construct the filter bank being a chunk of memory
+                 */
+                void                construct();
+
+                /** Initialize filter bank
+                 *
+                 * @param channels number of channels
+                 * @param filters number of biquad filters
+                 * @return true on success
+                 */
+                bool                init(size_t channels, size_t filters);
+
+                /** Destroy filter bank
+                 *
+                 */
+                void                destroy();
+
+            public:
+                /** Start filter bank, clears number of cascades
+                 *
+                 */
+                inline void         begin()
+                {
+                    nLastItems      = nItems;
+                    nItems          = 0;
+                }
+
+                /** Add cascade to biquad filter
+                 *
+                 * @return added cascade
+                 */
+                dsp::biquad_x1_t   *add_chain();
+
+                /** Commit structure of filter bank
+                 * @param clear force to clear delays
+                 */
+                void                end(bool clear = false);
+
+                /** Copy the cascade from the single-channel filter bank,
+                 * performs begin() and end() calls
+                 *
+                 * @param bank filter bank to copy cascade from
+                 * @param clear force to clear delays
+                 */
+                void                load(const FilterBank *bank, bool clear = false);
+
+                /** Process samples of all channels
+                 *
+                 * @param out list of output buffers
+                 * @param in list of input buffers
+                 * @param samples number of samples to process
+                 */
+                void                process(float * const *out, const float * const *in, size_t samples);
+
+                /** Get number of biquad filters
+                 *
+                 * @return number of biquad filters
+                 */
+                inline size_t       size() const { return nItems; }
+
+                /** Get number of channels
+                 *
+                 * @return number of channels
+                 */
+                inline size_t       channels() const { return nChannels; }
+
+                /** Reset internal state of filters (clear filter memory)
+                 *
+                 */
+                void                reset();
+
+                /**
+                 * Dump the state
+                 * @param dumper dumper
+                 */
+                void                dump(IStateDumper *v) const;
+        };
+    }
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_FILTERS_MULTIFILTERBANK_H_ */
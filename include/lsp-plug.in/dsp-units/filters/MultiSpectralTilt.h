@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_FILTERS_MULTISPECTRALTILT_H_
+#define LSP_PLUG_IN_DSP_UNITS_FILTERS_MULTISPECTRALTILT_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/filters/SpectralTilt.h>
+#include <lsp-plug.in/dsp-units/filters/MultiFilterBank.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Multi-channel spectral tilt filter: the cascade is computed once by
+         * SpectralTilt and all channels are processed by the same cascade in
+         * interleaved lanes of MultiFilterBank
+         */
+        class MultiSpectralTilt
+        {
+            private:
+                MultiSpectralTilt & operator = (const MultiSpectralTilt &);
+                MultiSpectralTilt(const MultiSpectralTilt &);
+
+            protected:
+                SpectralTilt        sTilt;      // Designer of the cascade
+                MultiFilterBank     sBank;      // Cascade applied to all channels
+                const float       **vInputs;    // List of input pointers for block processing
+                float             **vBuffers;   // Temporary buffers, one per channel
+                size_t              nChannels;  // Number of channels
+                bool                bBypass;    // Bypass flag
+                bool                bSync;      // Settings need update
+                uint8_t            *pData;      // Allocated data
+
+            public:
+                explicit MultiSpectralTilt();
+                ~MultiSpectralTilt();
+
+                /**
+                 * Construct the object
+                 */
+                void                construct();
+
+                /**
+                 * Destroy the object
+                 */
+                void                destroy();
+
+            public:
+                /** Initialize the filter
+                 *
+                 * @param channels number of channels
+                 * @return true on success
+                 */
+                bool                init(size_t channels);
+
+                /** Get number of channels
+                 *
+                 * @return number of channels
+                 */
+                inline size_t       channels() const        { return nChannels;         }
+
+                /** Check that filter needs settings update
+                 *
+                 * @return true if filter needs settings update
+                 */
+                inline bool         needs_update() const    { return bSync;             }
+
+                /** This method should be called if needs_update() returns true
+                 * before calling processing methods
+                 */
+                void                update_settings();
+
+                /** Check that the filter is bypassed with current settings
+                 *
+                 * @return true if the filter is bypassed
+                 */
+                inline bool         bypassed() const        { return bBypass;           }
+
+                /** Set the order of the filter
+                 *
+                 * @param order order of the filter
+                 */
+                inline void         set_order(size_t order)
+                {
+                    sTilt.set_order(order);
+                    bSync       = true;
+                }
+
+                /** Set the slope of the filter
+                 *
+                 * @param slope value
+                 * @param unit units of the slope value
+                 */
+                inline void         set_slope(float slope, stlt_slope_unit_t unit)
+                {
+                    sTilt.set_slope(slope, unit);
+                    bSync       = true;
+                }
+
+                /** Set the normalisation policy of the filter
+                 *
+                 * @param norm normalization policy
+                 */
+                inline void         set_norm(stlt_norm_t norm)
+                {
+                    sTilt.set_norm(norm);
+                    bSync       = true;
+                }
+
+                /** Set the lower frequency of the coverage bandwidth
+                 *
+                 * @param frequency lower frequency
+                 */
+                inline void         set_lower_frequency(float frequency)
+                {
+                    sTilt.set_lower_frequency(frequency);
+                    bSync       = true;
+                }
+
+                /** Set the upper frequency of the coverage bandwidth
+                 *
+                 * @param frequency upper frequency
+                 */
+                inline void         set_upper_frequency(float frequency)
+                {
+                    sTilt.set_upper_frequency(frequency);
+                    bSync       = true;
+                }
+
+                /** Set sample rate of the filter
+                 *
+                 * @param sr sample rate
+                 */
+                inline void         set_sample_rate(size_t sr)
+                {
+                    sTilt.set_sample_rate(sr);
+                    bSync       = true;
+                }
+
+                /** Clear the memory of the filter
+                 */
+                inline void         reset()                 { sBank.reset();            }
+
+                /** Output filtered channels to the destination buffers in additive mode
+                 *
+                 * @param dst list of output buffers
+                 * @param src list of input buffers, allowed to be NULL
+                 * @param count number of samples to process
+                 */
+                void                process_add(float * const *dst, const float * const *src, size_t count);
+
+                /** Output filtered channels to the destination buffers in multiplicative mode
+                 *
+                 * @param dst list of output buffers
+                 * @param src list of input buffers, allowed to be NULL
+                 * @param count number of samples to process
+                 */
+                void                process_mul(float * const *dst, const float * const *src, size_t count);
+
+                /** Output filtered channels to the destination buffers overwriting their content,
+                 * in-place processing is allowed
+                 *
+                 * @param dst list of output buffers
+                 * @param src list of input buffers, allowed to be NULL
+                 * @param count number of samples to process
+                 */
+                void                process_overwrite(float * const *dst, const float * const *src, size_t count);
+
+                /**
+                 * Dump internal state
+                 * @param v state dumper
+                 */
+                void                dump(IStateDumper *v) const;
+        };
+    }
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_FILTERS_MULTISPECTRALTILT_H_ */
@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_FILTERS_SVFILTER_H_
+#define LSP_PLUG_IN_DSP_UNITS_FILTERS_SVFILTER_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        enum svf_type_t
+        {
+            SVF_NONE,                       // Bypass
+            SVF_LOPASS,                     // Low-pass
+            SVF_HIPASS,                     // High-pass
+            SVF_BANDPASS,                   // Band-pass with unity gain at the center frequency
+            SVF_NOTCH,                      // Notch
+            SVF_PEAK,                       // Difference of low-pass and high-pass outputs
+            SVF_ALLPASS,                    // All-pass
+            SVF_BELL,                       // Bell with the gain at the center frequency
+            SVF_LOSHELF,                    // Low shelf with the gain below the frequency
+            SVF_HISHELF                     // High shelf with the gain above the frequency
+        };
+
+        /**
+         * Second-order state-variable filter of the topology-preserving transform (TPT).
+         * Unlike the direct-form biquad, the coefficients are computed from the frequency
+         * and the quality factor by a single tangent evaluation, and the filter stays
+         * stable under per-sample modulation of the frequency.
+         */
+        class SVFilter
+        {
+            private:
+                SVFilter & operator = (const SVFilter &);
+                SVFilter(const SVFilter &);
+
+            protected:
+                typedef struct coeffs_t
+                {
+                    float       a1;         // 1 / (1 + g*(g + k))
+                    float       a2;         // g * a1
+                    float       a3;         // g * a2
+                    float       m0;         // Weight of the input
+                    float       m1;         // Weight of the band-pass output
+                    float       m2;         // Weight of the low-pass output
+                } coeffs_t;
+
+            protected:
+                svf_type_t      enType;             // Filter type
+                size_t          nSampleRate;        // Sample rate
+                float           fFrequency;         // Frequency
+                float           fQuality;           // Quality factor
+                float           fGain;              // Gain for bell and shelving filters
+                float           fK;                 // Damping, 1/Q, corrected for the bell filter
+                float           fGScale;            // Scale of the integrator gain for shelving filters
+                coeffs_t        sCoeffs;            // Current coefficients
+                float           fS1;                // State of the first integrator
+                float           fS2;                // State of the second integrator
+                bool            bUpdate;            // Settings need update
+
+            public:
+                explicit SVFilter();
+                ~SVFilter();
+
+                void            construct();
+
+            public:
+                /**
+                 * Set filter type
+                 * @param type filter type
+                 */
+                void            set_type(svf_type_t type);
+
+                /**
+                 * Set sample rate
+                 * @param sr sample rate
+                 */
+                void            set_sample_rate(size_t sr);
+
+                /**
+                 * Set frequency of the filter
+                 * @param f frequency in Hz
+                 */
+                void            set_frequency(float f);
+
+                /**
+                 * Set quality factor of the filter
+                 * @param q quality factor, 0.7071 for maximally flat response
+                 */
+                void            set_quality(float q);
+
+                /**
+                 * Set gain of bell and shelving filters
+                 * @param gain linear gain
+                 */
+                void            set_gain(float gain);
+
+                inline svf_type_t   type() const            { return enType;        }
+                inline size_t       sample_rate() const     { return nSampleRate;   }
+                inline float        frequency() const       { return fFrequency;    }
+                inline float        quality() const         { return fQuality;      }
+                inline float        gain() const            { return fGain;         }
+
+                /**
+                 * Check that filter needs settings update
+                 * @return true if filter needs settings update
+                 */
+                inline bool         needs_update() const    { return bUpdate;       }
+
+                /**
+                 * Update settings of the filter
+                 */
+                void            update_settings();
+
+                /**
+                 * Clear the internal state of the filter
+                 */
+                void            clear();
+
+                /**
+                 * Process the signal with the current settings
+                 * @param dst destination buffer
+                 * @param src source buffer
+                 * @param count number of samples to process
+                 */
+                void            process(float *dst, const float *src, size_t count);
+
+                /**
+                 * Process the signal with the frequency modulated for each sample,
+                 * other settings remain the same
+                 * @param dst destination buffer
+                 * @param src source buffer
+                 * @param freq frequency in Hz for each sample
+                 * @param count number of samples to process
+                 */
+                void            process(float *dst, const float *src, const float *freq, size_t count);
+
+                /**
+                 * Dump the state
+                 * @param dumper dumper
+                 */
+                void            dump(IStateDumper *v) const;
+        };
+    } /* namespace dspu */
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_FILTERS_SVFILTER_H_ */
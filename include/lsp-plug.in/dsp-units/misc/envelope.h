@@ -51,6 +51,27 @@ namespace lsp
 
             void reverse_noise(float *dst, size_t n, envelope_t type);
 
+            /**
+             * Acquire the shared read-only envelope table from the process-wide
+             * cache, the table is computed on the first request and is shared by
+             * all callers that request the same type, size and direction.
+             * Thread safe.
+             *
+             * @param type envelope type
+             * @param n number of samples
+             * @param reverse compute the reverse envelope as reverse_noise() does
+             * @return pointer to the table or NULL if there is no memory
+             */
+            const float *acquire(envelope_t type, size_t n, bool reverse);
+
+            /**
+             * Release the table obtained by acquire(), the table is destroyed
+             * when there are no more references. Thread safe.
+             *
+             * @param table table to release, may be NULL
+             */
+            void release(const float *table);
+
             void white_noise(float *dst, size_t n);
 
             void pink_noise(float *dst, size_t n);
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_MISC_FFT_H_
+#define LSP_PLUG_IN_DSP_UNITS_MISC_FFT_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/common/types.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Transforms of real signals computed with the packed complex FFT of half size
+         * and the post-processing twiddle pass. The half-complex spectrum contains
+         * N/2 + 1 packed complex bins from DC to Nyquist frequency, the remaining
+         * bins of the real signal are complex conjugates of them.
+         */
+        namespace fft
+        {
+            /**
+             * Acquire the shared read-only twiddle table from the process-wide cache.
+             * The table for the rank R can be used for transforms of any rank not
+             * greater than R. Thread safe.
+             *
+             * @param rank maximum rank of transforms, at least 2
+             * @return pointer to the table or NULL on error
+             */
+            const float *acquire(size_t rank);
+
+            /**
+             * Release the table obtained by acquire(), the table is destroyed
+             * when there are no more references. Thread safe.
+             *
+             * @param table table to release, may be NULL
+             */
+            void release(const float *table);
+
+            /**
+             * Compute the half-complex spectrum of the real signal, the result is
+             * equal to the first N/2 + 1 bins of pcomplex_r2c() and packed_direct_fft()
+             *
+             * @param dst destination buffer of N + 2 floats, may be equal to src
+             * @param src source real signal of N samples
+             * @param rank rank of the transform, N = 2^rank, at least 2
+             * @param table twiddle table
+             * @param table_rank rank passed to acquire() for the table
+             */
+            void real_direct(float *dst, const float *src, size_t rank, const float *table, size_t table_rank);
+
+            /**
+             * Compute the real signal from the half-complex spectrum, the result is equal
+             * to packed_reverse_fft() and pcomplex_c2r() of the conjugate-symmetric spectrum
+             *
+             * @param dst destination buffer of N samples, may be equal to src
+             * @param src source half-complex spectrum of N + 2 floats
+             * @param rank rank of the transform, N = 2^rank, at least 2
+             * @param table twiddle table
+             * @param table_rank rank passed to acquire() for the table
+             */
+            void real_reverse(float *dst, const float *src, size_t rank, const float *table, size_t table_rank);
+
+            /**
+             * Restore the full packed complex spectrum of N bins from the half-complex
+             * spectrum in place
+             *
+             * @param buf buffer of 2 * N floats containing the half-complex spectrum
+             * @param rank rank of the transform
+             */
+            void real_expand(float *buf, size_t rank);
+
+            /**
+             * Replace the first N/2 + 1 bins of the full packed complex spectrum with
+             * its conjugate-symmetric part in place, so real_reverse() gives the same
+             * result as the real part of the complex reverse transform
+             *
+             * @param buf buffer of 2 * N floats containing the full spectrum
+             * @param rank rank of the transform
+             */
+            void real_fold(float *buf, size_t rank);
+        } /* namespace fft */
+    } /* namespace dspu */
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_MISC_FFT_H_ */
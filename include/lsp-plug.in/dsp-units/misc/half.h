@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_MISC_HALF_H_
+#define LSP_PLUG_IN_DSP_UNITS_MISC_HALF_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/common/types.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Conversion of floating-point data to the 16-bit storage formats and back.
+         * All encoders use rounding to the nearest even value.
+         */
+        namespace half
+        {
+            enum format_t
+            {
+                FLOAT16,            // IEEE 754 binary16: 11 significant bits, range 6.0e-8 .. 65504
+                BFLOAT16,           // Brain float: 8 significant bits, the range of float
+
+                // Special variables
+                TOTAL,
+                FIRST = FLOAT16,
+                LAST = TOTAL - 1
+            };
+
+            /**
+             * Encode floating-point values to IEEE 754 binary16, values out of range
+             * are saturated to the maximum finite value
+             *
+             * @param dst destination buffer
+             * @param src source buffer
+             * @param count number of values
+             */
+            void encode_fp16(uint16_t *dst, const float *src, size_t count);
+
+            /**
+             * Decode IEEE 754 binary16 values to floating-point values
+             *
+             * @param dst destination buffer
+             * @param src source buffer
+             * @param count number of values
+             */
+            void decode_fp16(float *dst, const uint16_t *src, size_t count);
+
+            /**
+             * Encode floating-point values to brain float
+             *
+             * @param dst destination buffer
+             * @param src source buffer
+             * @param count number of values
+             */
+            void encode_bf16(uint16_t *dst, const float *src, size_t count);
+
+            /**
+             * Decode brain float values to floating-point values
+             *
+             * @param dst destination buffer
+             * @param src source buffer
+             * @param count number of values
+             */
+            void decode_bf16(float *dst, const uint16_t *src, size_t count);
+
+            /**
+             * Encode floating-point values to the specified format
+             *
+             * @param dst destination buffer
+             * @param src source buffer
+             * @param count number of values
+             * @param format storage format
+             */
+            void encode(uint16_t *dst, const float *src, size_t count, format_t format);
+
+            /**
+             * Decode values of the specified format to floating-point values
+             *
+             * @param dst destination buffer
+             * @param src source buffer
+             * @param count number of values
+             * @param format storage format
+             */
+            void decode(float *dst, const uint16_t *src, size_t count, format_t format);
+        }
+    }
+}
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_MISC_HALF_H_ */
@@ -74,6 +74,75 @@ namespace lsp
              * @param y1 y-coordinate of second point used for interpolation
              */
             void linear(float *p, float x0, float y0, float x1, float y1);
+
+            /** Evaluate the linear formula computed by linear() for the array of arguments
+             *
+             * @param dst destination buffer, can be the same as source buffer
+             * @param src arguments
+             * @param p 2 coefficients of the formula
+             * @param count number of elements to process
+             */
+            void apply_linear(float *dst, const float *src, const float *p, size_t count);
+
+            /** Evaluate the quadratic polynom computed by hermite_quadratic() for the array of arguments
+             *
+             * @param dst destination buffer, can be the same as source buffer
+             * @param src arguments
+             * @param p 3 coefficients of the polynom
+             * @param count number of elements to process
+             */
+            void apply_quadratic(float *dst, const float *src, const float *p, size_t count);
+
+            /** Evaluate the cubic polynom computed by hermite_cubic() for the array of arguments
+             *
+             * @param dst destination buffer, can be the same as source buffer
+             * @param src arguments
+             * @param p 4 coefficients of the polynom
+             * @param count number of elements to process
+             */
+            void apply_cubic(float *dst, const float *src, const float *p, size_t count);
+
+            /** Evaluate the exponent formula computed by exponent() for the array of arguments
+             *
+             * @param dst destination buffer, can be the same as source buffer
+             * @param src arguments
+             * @param p 3 coefficients of the formula
+             * @param count number of elements to process
+             */
+            void apply_exponent(float *dst, const float *src, const float *p, size_t count);
+
+            /** Evaluate the knee: the cubic polynom inside of the knee and
+             * the linear formulas outside of the knee:
+             *   y(x) = l0(x) for x <= x0, p(x) for x0 < x < x1, l1(x) for x >= x1
+             * The quadratic knee is passed as the cubic polynom with p[0] = 0
+             *
+             * @param dst destination buffer, can be the same as source buffer
+             * @param src arguments
+             * @param x0 start of the knee
+             * @param x1 end of the knee
+             * @param l0 2 coefficients of the linear formula before the knee
+             * @param p 4 coefficients of the cubic polynom of the knee
+             * @param l1 2 coefficients of the linear formula after the knee
+             * @param count number of elements to process
+             */
+            void apply_knee(float *dst, const float *src, float x0, float x1,
+                const float *l0, const float *p, const float *l1, size_t count);
+
+            /** Evaluate the knee in logarithmic domain: dst = exp(y(ln(|src|))), where y is
+             * the knee formula of apply_knee(). Allows to compute the gain curves of dynamic
+             * processors which are defined for the logarithm of the level
+             *
+             * @param dst destination buffer, can be the same as source buffer
+             * @param src arguments
+             * @param x0 logarithm of the start of the knee
+             * @param x1 logarithm of the end of the knee
+             * @param l0 2 coefficients of the linear formula before the knee
+             * @param p 4 coefficients of the cubic polynom of the knee
+             * @param l1 2 coefficients of the linear formula after the knee
+             * @param count number of elements to process
+             */
+            void apply_log_knee(float *dst, const float *src, float x0, float x1,
+                const float *l0, const float *p, const float *l1, size_t count);
         }
     }
 }
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_MISC_IR_H_
+#define LSP_PLUG_IN_DSP_UNITS_MISC_IR_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/common/types.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Preparation of impulse responses before loading them into the convolver
+         */
+        namespace ir
+        {
+            /**
+             * Detect the length of the impulse response above the noise floor. The noise
+             * floor is estimated as the mean energy of the last 10% of the impulse response,
+             * the impulse response ends at the last window which energy exceeds the noise
+             * floor by the margin.
+             *
+             * @param ir impulse response
+             * @param count length of the impulse response
+             * @param window size of the analysis window in samples
+             * @param margin margin above the noise floor in decibels
+             * @return length of the impulse response above the noise floor
+             */
+            size_t noise_floor_length(const float *ir, size_t count, size_t window, float margin);
+
+            /**
+             * Truncate the impulse response at the noise floor and apply the fade-out
+             * of the window size to the end of the truncated impulse response
+             *
+             * @param ir impulse response to truncate
+             * @param count length of the impulse response
+             * @param window size of the analysis window and the fade-out in samples
+             * @param margin margin above the noise floor in decibels
+             * @return length of the truncated impulse response
+             */
+            size_t trim(float *ir, size_t count, size_t window, float margin);
+
+            /**
+             * Convert the impulse response to the minimum phase one with the same magnitude
+             * response using the real cepstrum. The energy of the result is concentrated at
+             * the beginning, so it can be truncated shorter than the original one.
+             *
+             * @param dst destination buffer of count samples, may be the same as src
+             * @param src source impulse response
+             * @param count length of the impulse response
+             * @return false if there is not enough memory
+             */
+            bool minimum_phase(float *dst, const float *src, size_t count);
+        }
+    }
+}
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_MISC_IR_H_ */
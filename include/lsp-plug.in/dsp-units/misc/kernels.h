@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_MISC_KERNELS_H_
+#define LSP_PLUG_IN_DSP_UNITS_MISC_KERNELS_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/common/types.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Inner loops of units which are not covered by lsp-dsp-lib. Each kernel is called
+         * through the pointer to the implementation selected for the CPU by init(), the same
+         * way as dsp::init() does for lsp-dsp-lib. Before init() is called, the pointers refer
+         * to the scalar reference implementations from the generic namespace. All
+         * implementations of the kernel produce bit-identical results.
+         */
+        namespace kernels
+        {
+            /** Convert random words to floating-point numbers in range [0, 1]:
+             * dst[i] = src[i] / 2^32
+             *
+             * @param dst destination buffer
+             * @param src source random words
+             * @param count number of words
+             */
+            typedef void (* words_to_float_t)(float *dst, const uint32_t *src, size_t count);
+
+            /** Run four independent congruential generators of the Randomizer, each next
+             * word of the generator j is state[j] = mul1[j]*state[j] + ((mul2[j]*state[j]) >> 16) + add[j],
+             * the words of generators are interleaved in the output
+             *
+             * @param dst destination buffer of count*4 words
+             * @param state state of four generators, updated by the call
+             * @param mul1 first multipliers of four generators
+             * @param mul2 second multipliers of four generators
+             * @param add adders of four generators
+             * @param count number of words to generate by each generator
+             */
+            typedef void (* lcg_words_t)(uint32_t *dst, uint32_t *state, const uint32_t *mul1,
+                const uint32_t *mul2, const uint32_t *add, size_t count);
+
+            LSP_DSP_UNITS_CPPIMPORT words_to_float_t    words_to_float;
+            LSP_DSP_UNITS_CPPIMPORT lcg_words_t         lcg_words;
+
+            /**
+             * Scalar reference implementations of kernels
+             */
+            namespace generic
+            {
+                void    words_to_float(float *dst, const uint32_t *src, size_t count);
+                void    lcg_words(uint32_t *dst, uint32_t *state, const uint32_t *mul1,
+                            const uint32_t *mul2, const uint32_t *add, size_t count);
+            } /* namespace generic */
+
+            /** Select the fastest implementations of kernels supported by the CPU,
+             * should be called once at startup before any processing
+             */
+            void            init();
+
+            /** Select the scalar reference implementations of kernels
+             *
+             */
+            void            init_generic();
+
+            /** Get the name of the most advanced instruction set used by selected kernels
+             *
+             * @return name of the instruction set
+             */
+            const char     *isa();
+        } /* namespace kernels */
+    } /* namespace dspu */
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_MISC_KERNELS_H_ */
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_MISC_MEMORY_H_
+#define LSP_PLUG_IN_DSP_UNITS_MISC_MEMORY_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/common/types.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Memory footprint of the unit. The padding is a part of allocated memory,
+         * the rest of allocated memory not used by current settings is reserved
+         * for the maximum settings passed to the unit at initialization
+         */
+        typedef struct memory_report_t
+        {
+            size_t      nAllocated;     // Number of bytes allocated, including the padding
+            size_t      nUsed;          // Number of bytes used by current settings
+            size_t      nPadding;       // Number of bytes spent for alignment, allocation headers and page rounding
+            size_t      nBlocks;        // Number of allocated blocks
+        } memory_report_t;
+
+        namespace memory
+        {
+            /**
+             * Clear the report
+             * @param r report to clear
+             */
+            void        clear(memory_report_t *r);
+
+            /**
+             * Account the allocated block, does nothing if the block is empty
+             * @param r report to update
+             * @param allocated number of bytes allocated
+             * @param used number of bytes used by current settings
+             * @param padding number of bytes spent for alignment
+             */
+            void        add(memory_report_t *r, size_t allocated, size_t used, size_t padding = 0);
+
+            /**
+             * Account the block allocated by pages::alloc()
+             * @param r report to update
+             * @param ptr pointer to the block, may be NULL
+             * @param used number of bytes used by current settings
+             */
+            void        add_pages(memory_report_t *r, const void *ptr, size_t used);
+
+            /**
+             * Account the block allocated by lsp::alloc_aligned()
+             * @param r report to update
+             * @param ptr pointer to the block, may be NULL
+             * @param bytes number of bytes requested at allocation
+             * @param used number of bytes used by current settings
+             * @param align alignment requested at allocation
+             */
+            void        add_aligned(memory_report_t *r, const void *ptr, size_t bytes, size_t used, size_t align = DEFAULT_ALIGN);
+
+            /**
+             * Add one report to another
+             * @param dst destination report
+             * @param src source report
+             */
+            void        merge(memory_report_t *dst, const memory_report_t *src);
+        } /* namespace memory */
+    } /* namespace dspu */
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_MISC_MEMORY_H_ */
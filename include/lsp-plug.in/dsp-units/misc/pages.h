@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_MISC_PAGES_H_
+#define LSP_PLUG_IN_DSP_UNITS_MISC_PAGES_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/common/types.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Allocation of large buffers which are walked by units at each block. Depending on
+         * the policy, the buffers are backed by huge pages to reduce TLB misses. If huge pages
+         * are not available, the allocation silently falls back to the weaker method and
+         * finally to the regular heap. Each buffer remembers how it has been allocated, so
+         * it should be freed only by free() regardless of the policy changes.
+         */
+        namespace pages
+        {
+            enum policy_t
+            {
+                DEFAULT,            // Regular heap allocation
+                TRANSPARENT,        // Buffer aligned to the huge page and advised to be backed by transparent huge pages
+                EXPLICIT            // Buffer mapped from the pool of explicit huge pages, falls back to TRANSPARENT
+            };
+
+            enum method_t
+            {
+                M_HEAP,             // Allocated from the regular heap
+                M_TRANSPARENT,      // Allocated from the heap and advised for transparent huge pages
+                M_EXPLICIT          // Mapped from the pool of explicit huge pages
+            };
+
+            /**
+             * Process-wide allocation statistics, only the buffers allocated while
+             * the tracking is enabled are accounted
+             */
+            typedef struct stats_t
+            {
+                size_t      nBlocks;        // Number of buffers currently allocated
+                size_t      nBytes;         // Number of bytes requested by the buffers currently allocated
+                size_t      nReserved;      // Number of bytes reserved including headers, alignment and page rounding
+                size_t      nPeak;          // Peak number of reserved bytes
+                size_t      nAllocs;        // Overall number of allocations
+                size_t      nFrees;         // Overall number of releases
+            } stats_t;
+
+            /**
+             * Set process-wide allocation policy, should be called at startup or
+             * at least not concurrently with allocations
+             * @param policy allocation policy
+             */
+            void        set_policy(policy_t policy);
+
+            /**
+             * Get process-wide allocation policy
+             * @return allocation policy
+             */
+            policy_t    policy();
+
+            /**
+             * Set the minimum size of the buffer to be backed by huge pages,
+             * the smaller buffers are always allocated from the regular heap
+             * @param bytes minimum size of the buffer in bytes
+             */
+            void        set_threshold(size_t bytes);
+
+            /**
+             * Get the minimum size of the buffer to be backed by huge pages
+             * @return minimum size of the buffer in bytes
+             */
+            size_t      threshold();
+
+            /**
+             * Get the size of the huge page
+             * @return size of the huge page in bytes
+             */
+            size_t      huge_page_size();
+
+            /**
+             * Allocate buffer according to the current policy
+             * @param bytes size of the buffer in bytes
+             * @param align alignment of the buffer, should be the power of two
+             * @return pointer to the aligned buffer or NULL if there is no memory
+             */
+            void       *alloc(size_t bytes, size_t align = DEFAULT_ALIGN);
+
+            /**
+             * Free buffer allocated by alloc()
+             * @param ptr pointer to the buffer, may be NULL
+             */
+            void        free(void *ptr);
+
+            /**
+             * Get the method used to allocate the buffer
+             * @param ptr pointer to the buffer allocated by alloc()
+             * @return allocation method
+             */
+            method_t    method(const void *ptr);
+
+            /**
+             * Get the size of the buffer
+             * @param ptr pointer to the buffer allocated by alloc()
+             * @return number of bytes requested at allocation
+             */
+            size_t      size(const void *ptr);
+
+            /**
+             * Get the overall number of bytes reserved for the buffer
+             * @param ptr pointer to the buffer allocated by alloc()
+             * @return number of bytes including the header, alignment and page rounding
+             */
+            size_t      reserved(const void *ptr);
+
+            /**
+             * Enable or disable the process-wide allocation counter. The counter
+             * takes the lock at each allocation, so it is disabled by default
+             * @param enable enable flag
+             */
+            void        set_tracking(bool enable);
+
+            /**
+             * Check that the process-wide allocation counter is enabled
+             * @return true if the allocation counter is enabled
+             */
+            bool        tracking();
+
+            /**
+             * Get the process-wide allocation statistics
+             * @param stats pointer to store the statistics
+             */
+            void        get_stats(stats_t *stats);
+
+            /**
+             * Reset the peak number of reserved bytes to the current value
+             */
+            void        reset_peak();
+
+            /**
+             * Allocate the array of elements, the same as lsp::alloc_aligned() but
+             * with respect to the allocation policy
+             * @param ptr variable to store the pointer for free_aligned()
+             * @param count number of elements
+             * @param align alignment of the array, should be the power of two
+             * @return pointer to the aligned array or NULL if there is no memory
+             */
+            template <class T, class P>
+                inline T *alloc_aligned(P * &ptr, size_t count, size_t align = DEFAULT_ALIGN)
+                {
+                    void *res   = alloc(count * sizeof(T), align);
+                    ptr         = static_cast<P *>(res);
+                    return static_cast<T *>(res);
+                }
+
+            /**
+             * Free the array allocated by alloc_aligned() and reset the pointer
+             * @param ptr pointer to the array, may be NULL
+             */
+            template <class T>
+                inline void free_aligned(T * &ptr)
+                {
+                    free(ptr);
+                    ptr         = NULL;
+                }
+        } /* namespace pages */
+    } /* namespace dspu */
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_MISC_PAGES_H_ */
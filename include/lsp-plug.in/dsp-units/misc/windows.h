@@ -63,6 +63,26 @@ namespace lsp
 
             void window(float *dst, size_t n, window_t type);
 
+            /**
+             * Acquire the shared read-only table of the window function from the
+             * process-wide cache, the table is computed on the first request and
+             * is shared by all callers that request the same type and size.
+             * Thread safe.
+             *
+             * @param type window type
+             * @param n number of samples
+             * @return pointer to the table or NULL if there is no memory
+             */
+            const float *acquire(window_t type, size_t n);
+
+            /**
+             * Release the table obtained by acquire(), the table is destroyed
+             * when there are no more references. Thread safe.
+             *
+             * @param table table to release, may be NULL
+             */
+            void release(const float *table);
+
             void rectangular(float *dst, size_t n);
 
             void triangular_general(float *dst, size_t n, int dn);
@@ -59,6 +59,9 @@ namespace lsp
 
                 Randomizer  sRand;
 
+            protected:
+                void generate(float *dst, size_t count);
+
             public:
                 explicit LCG();
                 ~LCG();
@@ -51,6 +51,10 @@ namespace lsp
          *
          * This class supports MLS generation with registers up to 128 bits depending on platform.
          *
+         * The register always holds the next N output bits, so the block processing outputs
+         * the whole register at once and jumps N steps forward with the precomputed table of
+         * the images of each register byte.
+         *
          * Basic MLS Theory at:
          *
          * http://www.kempacoustics.com/thesis/node83.html
@@ -75,6 +79,10 @@ namespace lsp
                 mls_t       nOutputMask;
                 mls_t       nState;
 
+                mls_t      *vJumpTable;     // Images of state bytes after nBits steps, 256 entries per byte
+                size_t      nJumpBytes;     // Number of bytes in the state
+                uint8_t    *pData;          // Allocated data
+
                 float       fAmplitude;
                 float       fOffset;
 
@@ -90,6 +98,8 @@ namespace lsp
             protected:
                 mls_t xor_gate(mls_t value);
                 mls_t progress();
+                void build_jump_table();
+                void generate(float *dst, size_t count);
 
             public:
 
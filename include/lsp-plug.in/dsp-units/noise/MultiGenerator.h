@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_NOISE_MULTIGENERATOR_H_
+#define LSP_PLUG_IN_DSP_UNITS_NOISE_MULTIGENERATOR_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/noise/Generator.h>
+#include <lsp-plug.in/dsp-units/filters/MultiSpectralTilt.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Multi-channel noise generator: each channel emits an independent
+         * white noise stream seeded differently, the coloring filter is computed
+         * once and applied to all channels by the lane-parallel filter bank.
+         * Each channel produces the same noise as NoiseGenerator with the same
+         * seeds and settings.
+         */
+        class MultiNoiseGenerator
+        {
+            private:
+                MultiNoiseGenerator & operator = (const MultiNoiseGenerator &);
+                MultiNoiseGenerator(const MultiNoiseGenerator &);
+
+            protected:
+                NoiseGenerator     *vGenerators;    // White noise generators, one per channel
+                float             **vBuffers;       // Temporary buffers, one per channel
+                size_t              nChannels;      // Number of channels
+                size_t              nSampleRate;    // Sample rate
+
+                MultiSpectralTilt   sColorFilter;   // Coloring filter applied to all channels
+
+                ng_color_t          enColor;        // Noise color
+                size_t              nOrder;         // Order of the coloring filter
+                float               fSlope;         // Slope for the arbitrary color
+                stlt_slope_unit_t   enSlopeUnit;    // Unit of the slope for the arbitrary color
+
+                bool                bSync;          // Settings need update
+                uint8_t            *pData;          // Allocated data
+
+            protected:
+                void                do_process(float * const *dst, size_t count);
+
+            public:
+                explicit MultiNoiseGenerator();
+                ~MultiNoiseGenerator();
+
+                /**
+                 * Construct the object
+                 */
+                void                construct();
+
+                /**
+                 * Destroy the object
+                 */
+                void                destroy();
+
+            public:
+                /** Initialize the generator, the seeds of the channels are derived
+                 * from the single seed, so the channels are decorrelated
+                 *
+                 * @param channels number of channels
+                 * @param seed base seed
+                 * @return true on success
+                 */
+                bool                init(size_t channels, uint32_t seed);
+
+                /** Get number of channels
+                 *
+                 * @return number of channels
+                 */
+                inline size_t       channels() const        { return nChannels;         }
+
+                /** Get the generator of the specific channel, allows to override
+                 * the per-channel seeds
+                 *
+                 * @param channel channel number
+                 * @return generator of the channel or NULL
+                 */
+                inline NoiseGenerator  *channel(size_t channel)
+                {
+                    return (channel < nChannels) ? &vGenerators[channel] : NULL;
+                }
+
+                /** Check that generator needs settings update
+                 *
+                 * @return true if generator needs settings update
+                 */
+                inline bool         needs_update() const    { return bSync;             }
+
+                /** This method should be called if needs_update() returns true
+                 * before calling processing methods
+                 */
+                void                update_settings();
+
+                /** Set sample rate
+                 *
+                 * @param sr sample rate
+                 */
+                void                set_sample_rate(size_t sr);
+
+                /** Set the number of bits of the MLS sequence generator
+                 *
+                 * @param nbits number of bits
+                 */
+                void                set_mls_n_bits(uint8_t nbits);
+
+                /** Set LCG distribution
+                 *
+                 * @param dist LCG distribution
+                 */
+                void                set_lcg_distribution(lcg_dist_t dist);
+
+                /** Set the Velvet noise type
+                 *
+                 * @param type velvet type
+                 */
+                void                set_velvet_type(vn_velvet_type_t type);
+
+                /** Set the Velvet noise window width
+                 *
+                 * @param width velvet noise width
+                 */
+                void                set_velvet_window_width(float width);
+
+                /** Set delta parameter for Velvet ARN noise
+                 *
+                 * @param delta value
+                 */
+                void                set_velvet_arn_delta(float delta);
+
+                /** Set whether to crush the velvet generator
+                 *
+                 * @param crush true to crush
+                 */
+                void                set_velvet_crush(bool crush);
+
+                /** Set the crushing probability for the velvet generator
+                 *
+                 * @param prob crushing probability
+                 */
+                void                set_velvet_crushing_probability(float prob);
+
+                /** Set which core generator to use
+                 *
+                 * @param core core generator specification
+                 */
+                void                set_generator(ng_generator_t core);
+
+                /** Set the noise color
+                 *
+                 * @param color noise color specification
+                 */
+                void                set_noise_color(ng_color_t color);
+
+                /** Set the coloring filter order
+                 *
+                 * @param order order
+                 */
+                void                set_coloring_order(size_t order);
+
+                /** Set the color slope
+                 *
+                 * @param slope slope
+                 * @param unit slope unit
+                 */
+                void                set_color_slope(float slope, stlt_slope_unit_t unit);
+
+                /** Set the noise amplitude
+                 *
+                 * @param amplitude noise amplitude
+                 */
+                void                set_amplitude(float amplitude);
+
+                /** Set the noise offset
+                 *
+                 * @param offset noise offset
+                 */
+                void                set_offset(float offset);
+
+                /** Output noise to the destination buffers in additive mode
+                 *
+                 * @param dst list of output buffers
+                 * @param src list of input buffers, allowed to be NULL
+                 * @param count number of samples to synthesise
+                 */
+                void                process_add(float * const *dst, const float * const *src, size_t count);
+
+                /** Output noise to the destination buffers in multiplicative mode
+                 *
+                 * @param dst list of output buffers
+                 * @param src list of input buffers, allowed to be NULL
+                 * @param count number of samples to process
+                 */
+                void                process_mul(float * const *dst, const float * const *src, size_t count);
+
+                /** Output noise to the destination buffers overwriting their content
+                 *
+                 * @param dst list of output buffers
+                 * @param count number of samples to process
+                 */
+                void                process_overwrite(float * const *dst, size_t count);
+
+                /**
+                 * Dump internal state
+                 * @param v state dumper
+                 */
+                void                dump(IStateDumper *v) const;
+        };
+    }
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_NOISE_MULTIGENERATOR_H_ */
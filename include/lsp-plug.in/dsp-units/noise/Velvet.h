@@ -81,6 +81,11 @@ namespace lsp
                 float               fAmplitude;
                 float               fOffset;
 
+                float               fGrid;          // Start of the next window (OVN, OVNA) or position of the last impulse (ARN) relative to the block
+                float               fNextValue;     // Value of the pending impulse
+                size_t              nNextPos;       // Position of the pending impulse relative to the block
+                bool                bPending;       // The pending impulse is drawn
+
             public:
                 explicit Velvet();
                 ~Velvet();
@@ -104,6 +109,22 @@ namespace lsp
                  */
                 float get_crushed_spike();
 
+                /** Reset the position of the impulse stream
+                 *
+                 */
+                void reset_stream();
+
+                /** Draw the next impulse of the OVN, OVNA or ARN stream
+                 *
+                 */
+                void draw_impulse();
+
+                /** Generate impulses of the block, values are not scaled
+                 *
+                 */
+                size_t generate(uint32_t *pos, float *value, size_t count);
+                size_t generate_ternary(uint32_t *pos, float *value, size_t count);
+
                 void do_process(float *dst, size_t count);
 
             public:
@@ -148,6 +169,7 @@ namespace lsp
                         return;
 
                     enVelvetType = type;
+                    reset_stream();
                 }
 
                 /** Set velvet noise window width in samples.
@@ -243,6 +265,33 @@ namespace lsp
                  */
                 void process_overwrite(float *dst, size_t count);
 
+                /** Generate the velvet noise of the next count samples in sparse form: positions
+                 * of the non-zero samples relative to the start of the block and their values
+                 * scaled by the amplitude, the offset is not applied. The impulse stream is the
+                 * same as for the process_*() methods and continues over the calls.
+                 *
+                 * @param pos positions of the impulses, should hold at least count elements
+                 * @param value values of the impulses, should hold at least count elements
+                 * @param count number of samples in the block
+                 * @return number of impulses in the block
+                 */
+                size_t generate_sparse(uint32_t *pos, float *value, size_t count);
+
+                /** Add the convolution of the source signal with the sparse kernel to the
+                 * destination buffer: dst[i + pos[k]] += src[i] * value[k], like dsp::convolve()
+                 * does for the dense kernel. The cost is proportional to the number of impulses
+                 * instead of the length of the kernel.
+                 *
+                 * @param dst destination buffer, should hold count + pos[impulses-1] samples
+                 * @param src source buffer
+                 * @param pos positions of the kernel impulses
+                 * @param value values of the kernel impulses
+                 * @param impulses number of the kernel impulses
+                 * @param count number of source samples
+                 */
+                static void convolve(float *dst, const float *src, const uint32_t *pos, const float *value,
+                    size_t impulses, size_t count);
+
                 /**
                  * Dump the state
                  * @param dumper dumper
@@ -24,6 +24,8 @@
 
 #include <lsp-plug.in/dsp-units/version.h>
 #include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/dsp-units/misc/memory.h>
+#include <lsp-plug.in/dsp-units/sampling/SamplePeaks.h>
 #include <lsp-plug.in/io/Path.h>
 #include <lsp-plug.in/runtime/LSPString.h>
 #include <lsp-plug.in/mm/IOutAudioStream.h>
@@ -31,6 +33,16 @@
 
 #define AUDIO_SAMPLE_CONTENT_TYPE       "application/x-lsp-audio-sample"
 
+// Version of the sample cache format
+#define SAMPLE_CACHE_VERSION            1
+// Byte order marker of the sample cache
+#define SAMPLE_CACHE_BYTE_ORDER         0x01020304
+
+// Binary logarithm of the number of samples in the block of the compact storage
+#define SAMPLE_COMPACT_BLOCK_RANK       8
+// Number of samples in the block of the compact storage
+#define SAMPLE_COMPACT_BLOCK_SIZE       (1 << SAMPLE_COMPACT_BLOCK_RANK)
+
 namespace lsp
 {
     namespace dspu
@@ -43,6 +55,25 @@ namespace lsp
             uint32_t    sample_rate;
             uint32_t    samples;
         } sample_header_t;
+
+        /*
+         * Sample cache file format. All data is stored in the native byte order,
+         * the header is followed by the channel-planar sample data with the stride
+         * of max_length samples, so the data can be mapped directly into memory
+         */
+        typedef struct sample_cache_header_t
+        {
+            char        signature[8];   // Signature "LSPSMPLC"
+            uint32_t    version;        // Format version
+            uint32_t    byte_order;     // Byte order marker
+            uint32_t    channels;       // Number of channels
+            uint32_t    sample_rate;    // Sample rate
+            uint64_t    length;         // Length of the sample
+            uint64_t    max_length;     // Stride between channels in samples
+            uint64_t    src_size;       // Size of the source file
+            uint64_t    src_mtime;      // Modification time of the source file
+            uint64_t    src_hash;       // Hash of the source file path
+        } sample_cache_header_t;
     #pragma pack(pop)
 
         enum sample_normalize_t
@@ -68,6 +99,25 @@ namespace lsp
             SAMPLE_NORM_ALWAYS
         };
 
+        enum sample_measure_t
+        {
+            /**
+             * Maximum peak of all channels
+             */
+            SAMPLE_MEASURE_PEAK,
+
+            /**
+             * RMS value of all channels
+             */
+            SAMPLE_MEASURE_RMS,
+
+            /**
+             * Gated integrated loudness according to ITU-R BS.1770-4,
+             * expressed as the gain relative to 0 LUFS
+             */
+            SAMPLE_MEASURE_LUFS
+        };
+
         class Sample
         {
             private:
@@ -80,12 +130,18 @@ namespace lsp
                 size_t      nLength;
                 size_t      nMaxLength;
                 size_t      nChannels;
+                uint8_t    *pMapped;        // Memory mapping the buffer belongs to
+                size_t      nMapped;        // Size of the memory mapping
+                SamplePeaks *pPeaks;        // Waveform overview
+                size_t      nPeaksThreads;  // Number of threads to rebuild the waveform overview
+                int16_t    *vCompact;       // Block-float mantissas of the compact storage
+                float      *vScale;         // Scale of each block of the compact storage
+                size_t      nBlocks;        // Number of blocks of one channel of the compact storage
+                uint8_t    *pCompact;       // Allocated data of the compact storage
 
             protected:
-                status_t            fast_downsample(Sample *s, size_t new_sample_rate);
-                status_t            fast_upsample(Sample *s, size_t new_sample_rate);
-                status_t            complex_downsample(Sample *s, size_t new_sample_rate);
-                status_t            complex_upsample(Sample *s, size_t new_sample_rate);
+                void                release_buffer();
+                void                sync_peaks();
 
             public:
                 explicit Sample();
@@ -102,9 +158,11 @@ namespace lsp
                 void        destroy();
 
             public:
-                inline bool         valid() const                   { return (vBuffer != NULL) && (nChannels > 0) && (nLength > 0) && (nMaxLength > 0); }
+                inline bool         valid() const                   { return ((vBuffer != NULL) || (pCompact != NULL)) && (nChannels > 0) && (nLength > 0) && (nMaxLength > 0); }
                 inline size_t       length() const                  { return nLength; }
                 inline size_t       max_length() const              { return nMaxLength; }
+                inline bool         mapped() const                  { return pMapped != NULL; }
+                inline bool         compacted() const               { return pCompact != NULL; }
 
                 inline float       *getBuffer(size_t channel)       { return &vBuffer[nMaxLength * channel]; }
                 inline const float *getBuffer(size_t channel) const { return &vBuffer[nMaxLength * channel]; }
@@ -133,7 +191,11 @@ namespace lsp
                 {
                     if (length > nMaxLength)
                         length = nMaxLength;
-                    return nLength = length;
+                    size_t first    = lsp_min(nLength, length);
+                    nLength         = length;
+                    if (pPeaks != NULL)
+                        update_peaks(first);
+                    return nLength;
                 }
 
                 /** Extend length of sample
@@ -146,7 +208,12 @@ namespace lsp
                     if (length > nMaxLength)
                         length = nMaxLength;
                     if (nLength < length)
-                        nLength = length;
+                    {
+                        size_t first    = nLength;
+                        nLength         = length;
+                        if (pPeaks != NULL)
+                            update_peaks(first);
+                    }
                     return nLength;
                 }
 
@@ -156,6 +223,8 @@ namespace lsp
                 inline void clear()
                 {
                     nLength     = 0;
+                    if (pPeaks != NULL)
+                        update_peaks(0);
                 }
 
                 /** Initialize sample, all previously allocated data will be lost
@@ -179,9 +248,22 @@ namespace lsp
                 /** Resample sample
                  *
                  * @param new_sample_rate new sample rate
+                 * @param threads number of threads to use, channels and time ranges
+                 *   of the sample are processed in parallel
                  * @return status of operation
                  */
-                status_t resample(size_t new_sample_rate);
+                status_t resample(size_t new_sample_rate, size_t threads = 1);
+
+                /** Resample multiple samples concurrently
+                 *
+                 * @param samples list of samples to resample
+                 * @param count number of samples in the list
+                 * @param new_sample_rate new sample rate
+                 * @param threads number of threads to use
+                 * @return status of operation, samples that could not be resampled
+                 *   keep their original contents
+                 */
+                static status_t resample(Sample * const *samples, size_t count, size_t new_sample_rate, size_t threads);
 
                 /** Reverse track
                  *
@@ -204,7 +286,102 @@ namespace lsp
                 void normalize(float gain, sample_normalize_t mode);
 
                 /**
-                 * Swap contents with another sample
+                 * Normalize the sample by the measured level
+                 * @param gain the target level: peak gain, RMS gain or the loudness
+                 *   relative to 0 LUFS depending on the measure
+                 * @param mode the normalization mode
+                 * @param measure the level measure
+                 * @param threads number of threads to use, channels and time ranges
+                 *   of the sample are measured in parallel
+                 * @return status of operation
+                 */
+                status_t normalize(float gain, sample_normalize_t mode, sample_measure_t measure, size_t threads = 1);
+
+                /**
+                 * Measure the level of the sample
+                 * @param level pointer to store the level: peak gain, RMS gain or the loudness
+                 *   relative to 0 LUFS depending on the measure
+                 * @param measure the level measure
+                 * @param threads number of threads to use, channels and time ranges
+                 *   of the sample are measured in parallel
+                 * @return status of operation
+                 */
+                status_t measure(float *level, sample_measure_t measure, size_t threads = 1) const;
+
+                /**
+                 * Convert the sample to the compact storage: each block of SAMPLE_COMPACT_BLOCK_SIZE
+                 * samples is stored as 16-bit mantissas with the power of 2 scale of the block,
+                 * which takes about a half of the memory of the floating-point data. The sample
+                 * data is not accessible via channel() and getBuffer() in this mode, the data
+                 * can be read by the read() method only. Methods that modify the sample data
+                 * fail until the sample is expanded back. The waveform overview is dropped
+                 * @return status of operation
+                 */
+                status_t compact();
+
+                /**
+                 * Convert the sample from the compact storage back to the floating-point data
+                 * @return status of operation
+                 */
+                status_t expand();
+
+                /**
+                 * Read the data of the channel, works both for the floating-point and compact
+                 * storage, is real-time safe. The data after the end of the sample is returned
+                 * as zeros
+                 * @param channel the channel to read
+                 * @param dst destination buffer
+                 * @param offset offset of the first sample
+                 * @param count number of samples to read
+                 * @return number of samples taken from the sample
+                 */
+                size_t read(size_t channel, float *dst, size_t offset, size_t count) const;
+
+                /**
+                 * Build the waveform overview of the sample. Once built, the overview is kept
+                 * up to date by set_length(), extend(), loading, resampling and other methods
+                 * that modify the sample. Direct modification of the sample data should be
+                 * followed by the call of update_peaks()
+                 * @param threads number of threads to use, channels are processed in parallel.
+                 *   The same number of threads is used to rebuild the overview after loading
+                 * @return status of operation
+                 */
+                status_t build_peaks(size_t threads = 1);
+
+                /**
+                 * Update the waveform overview after direct modification of the sample data
+                 * @param first index of the first modified sample
+                 */
+                void update_peaks(size_t first);
+
+                /**
+                 * Drop the waveform overview of the sample
+                 */
+                void drop_peaks();
+
+                /**
+                 * Get the waveform overview of the sample
+                 * @return waveform overview or NULL if it has not been built
+                 */
+                inline const SamplePeaks *peaks() const         { return pPeaks;                        }
+
+                /**
+                 * Render the overview of the range of samples of the channel: the range is split
+                 * into width columns, the minimum and maximum are computed for each column.
+                 * With the built waveform overview the cost is O(width) at any zoom, otherwise
+                 * all samples of the range are scanned
+                 * @param channel channel number
+                 * @param min buffer to store minimums of width columns
+                 * @param max buffer to store maximums of width columns
+                 * @param first index of the first sample
+                 * @param count number of samples
+                 * @param width number of columns
+                 * @return status of operation
+                 */
+                status_t overview(size_t channel, float *min, float *max, size_t first, size_t count, size_t width) const;
+
+                /**
+                 * Swap contents with another sample, the waveform overview is swapped too
                  * @param dst sample to perform swap
                  */
                 void swap(Sample *dst);
@@ -254,6 +431,47 @@ namespace lsp
                 status_t loads(const io::Path *path, ssize_t max_samples = -1);
                 status_t loads(mm::IInAudioStream *in, ssize_t max_samples = -1);
 
+                /**
+                 * Compute the path of the cache file for the source file resampled to the specified
+                 * sample rate. The file name depends on the path, size and modification time of the
+                 * source file, so modification of the source file invalidates the cache entry
+                 * @param dst path to store the result
+                 * @param dir cache directory
+                 * @param source path to the source audio file
+                 * @param sample_rate target sample rate
+                 * @return status of operation
+                 */
+                static status_t cache_path(io::Path *dst, const io::Path *dir, const io::Path *source, size_t sample_rate);
+
+                /**
+                 * Save sample contents to the cache file
+                 * @param path path to the cache file
+                 * @param source path to the source audio file the sample has been loaded from
+                 * @return status of operation
+                 */
+                status_t save_cache(const char *path, const char *source) const;
+                status_t save_cache(const LSPString *path, const LSPString *source) const;
+                status_t save_cache(const io::Path *path, const io::Path *source) const;
+
+                /**
+                 * Map the contents of the cache file to the sample without decoding and resampling.
+                 * The mapping is private: modifications of the sample data are not written back
+                 * @param path path to the cache file
+                 * @param source path to the source audio file
+                 * @param sample_rate the expected sample rate of the sample
+                 * @return status of operation, STATUS_NOT_FOUND if there is no valid cache entry
+                 *   for the current state of the source file and the sample rate
+                 */
+                status_t load_cache(const char *path, const char *source, size_t sample_rate);
+                status_t load_cache(const LSPString *path, const LSPString *source, size_t sample_rate);
+                status_t load_cache(const io::Path *path, const io::Path *source, size_t sample_rate);
+
+                /**
+                 * Add the memory footprint of the sample to the report
+                 * @param r report to update
+                 */
+                void memory_usage(memory_report_t *r) const;
+
                 /**
                  * Dump the state
                  * @param dumper dumper
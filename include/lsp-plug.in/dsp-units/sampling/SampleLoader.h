@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_SAMPLING_SAMPLELOADER_H_
+#define LSP_PLUG_IN_DSP_UNITS_SAMPLING_SAMPLELOADER_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/sampling/Sample.h>
+#include <lsp-plug.in/common/atomic.h>
+#include <lsp-plug.in/io/Path.h>
+#include <lsp-plug.in/lltl/parray.h>
+#include <lsp-plug.in/runtime/LSPString.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Callback called when the file has been loaded
+         * @param index index of the file in the list of the loader
+         * @param sample the sample the file has been loaded to
+         * @param status status of the loading, the sample keeps it's previous
+         *   contents on error
+         * @param arg the argument passed to the loader
+         */
+        typedef void (* sample_loaded_t)(size_t index, Sample *sample, status_t status, void *arg);
+
+        /**
+         * Batch loader of samples: loads the list of files on the pool of threads,
+         * each thread decodes the file, deinterleaves it directly into the sample
+         * and resamples it to the requested sample rate
+         */
+        class SampleLoader
+        {
+            private:
+                SampleLoader & operator = (const SampleLoader &);
+                SampleLoader(const SampleLoader &);
+
+            protected:
+                typedef struct item_t
+                {
+                    Sample             *pSample;        // Sample to load
+                    io::Path            sPath;          // Path to the file
+                    ssize_t             nMaxSamples;    // Maximum number of samples
+                    status_t            nStatus;        // Status of the loading
+                } item_t;
+
+            protected:
+                lltl::parray<item_t>    vItems;         // List of files to load
+                size_t                  nSampleRate;    // Target sample rate
+                size_t                  nThreads;       // Number of threads
+                sample_loaded_t         pCallback;      // Completion callback
+                void                   *pArg;           // Argument of the callback
+                atomic_t                nNext;          // Index of the next file to load
+
+            protected:
+                static void             load_jobs(void *arg);
+                void                    load_item(size_t index);
+
+            public:
+                explicit SampleLoader();
+                ~SampleLoader();
+
+                /**
+                 * Construct the object
+                 */
+                void                    construct();
+
+                /**
+                 * Destroy the object
+                 */
+                void                    destroy();
+
+            public:
+                /**
+                 * Add the file to the list of files to load
+                 * @param dst the sample to load the file to, should stay valid until load() returns
+                 * @param path path to the file
+                 * @param max_samples maximum number of samples to load, all if negative
+                 * @return status of operation
+                 */
+                status_t                add(Sample *dst, const char *path, ssize_t max_samples = -1);
+                status_t                add(Sample *dst, const LSPString *path, ssize_t max_samples = -1);
+                status_t                add(Sample *dst, const io::Path *path, ssize_t max_samples = -1);
+
+                /**
+                 * Clear the list of files
+                 */
+                void                    clear();
+
+                /**
+                 * Get number of files in the list
+                 * @return number of files in the list
+                 */
+                inline size_t           size() const                { return vItems.size();     }
+
+                /**
+                 * Get status of the file after load()
+                 * @param index index of the file
+                 * @return status of the loading
+                 */
+                status_t                status(size_t index) const;
+
+                /**
+                 * Set the sample rate to resample the loaded files to
+                 * @param srate sample rate, zero keeps the original sample rate of the files
+                 */
+                inline void             set_sample_rate(size_t srate)   { nSampleRate = srate;      }
+                inline size_t           sample_rate() const             { return nSampleRate;       }
+
+                /**
+                 * Set number of threads to load files
+                 * @param threads number of threads, the caller thread of load() is one of them
+                 */
+                inline void             set_threads(size_t threads)     { nThreads = lsp_max(threads, size_t(1)); }
+                inline size_t           threads() const                 { return nThreads;          }
+
+                /**
+                 * Set the callback called after each file has been loaded. The callback is
+                 * called from the loading threads, so the playback of the loaded samples can
+                 * be started before all files are loaded
+                 * @param callback callback, NULL to disable
+                 * @param arg argument of the callback
+                 */
+                void                    set_callback(sample_loaded_t callback, void *arg);
+
+                /**
+                 * Load all files of the list, the files are picked in the order of adding
+                 * @return status of operation, the first error of the files if some of them
+                 *   have not been loaded
+                 */
+                status_t                load();
+        };
+    }
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_SAMPLING_SAMPLELOADER_H_ */
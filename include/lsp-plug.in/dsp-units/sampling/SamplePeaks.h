@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_SAMPLING_SAMPLEPEAKS_H_
+#define LSP_PLUG_IN_DSP_UNITS_SAMPLING_SAMPLEPEAKS_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/dsp-units/misc/memory.h>
+
+// Binary logarithm of the number of samples in the block of the first level
+#define SAMPLE_PEAKS_BLOCK_RANK         6
+// Number of samples in the block of the first level
+#define SAMPLE_PEAKS_BLOCK_SIZE         (1 << SAMPLE_PEAKS_BLOCK_RANK)
+// Maximum number of levels
+#define SAMPLE_PEAKS_MAX_LEVELS         32
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Waveform overview of the sample: the pyramid of minimum and maximum values
+         * for blocks of SAMPLE_PEAKS_BLOCK_SIZE * 2^k samples. The first level is computed
+         * from the sample data, each next level combines pairs of blocks of the previous
+         * level. The minimum and maximum of any range of samples is computed from at most
+         * two blocks of each level and two partial blocks of raw sample data at the edges,
+         * so rendering of the overview of any zoom costs O(width) operations.
+         *
+         * The object does not keep the pointer to the sample data, the data is passed
+         * to the update and query methods.
+         */
+        class SamplePeaks
+        {
+            private:
+                SamplePeaks & operator = (const SamplePeaks &);
+                SamplePeaks(const SamplePeaks &);
+
+            protected:
+                float      *vMin;                               // Minimums of all channels
+                float      *vMax;                               // Maximums of all channels
+                size_t      nChannels;                          // Number of channels
+                size_t      nMaxLength;                         // Maximum length of the sample
+                size_t      nLength;                            // Actual length of the sample
+                size_t      nLevels;                            // Number of levels
+                size_t      nStride;                            // Stride between channels
+                size_t      vOffset[SAMPLE_PEAKS_MAX_LEVELS];   // Offset of each level
+                uint8_t    *pData;                              // Allocated data
+
+            protected:
+                void        find(size_t channel, const float *src, size_t first, size_t last, float *min, float *max) const;
+
+            public:
+                explicit SamplePeaks();
+                ~SamplePeaks();
+
+                /**
+                 * Construct the object
+                 */
+                void        construct();
+
+                /**
+                 * Destroy the object
+                 */
+                void        destroy();
+
+            public:
+                /**
+                 * Initialize the overview, the overview becomes empty
+                 * @param channels number of channels
+                 * @param max_length maximum length of the sample
+                 * @return true on success
+                 */
+                bool        init(size_t channels, size_t max_length);
+
+                /**
+                 * Get number of channels
+                 * @return number of channels
+                 */
+                inline size_t   channels() const        { return nChannels;     }
+
+                /**
+                 * Get maximum length of the sample
+                 * @return maximum length of the sample
+                 */
+                inline size_t   max_length() const      { return nMaxLength;    }
+
+                /**
+                 * Get actual length of the sample
+                 * @return actual length of the sample
+                 */
+                inline size_t   length() const          { return nLength;       }
+
+                /**
+                 * Get number of levels
+                 * @return number of levels
+                 */
+                inline size_t   levels() const          { return nLevels;       }
+
+                /**
+                 * Update the overview of the channel after modification of the sample data.
+                 * Only blocks that contain samples starting with the specified one are recomputed,
+                 * so appending the data to the sample costs O(appended samples) operations
+                 * @param channel channel number
+                 * @param src the sample data of the channel
+                 * @param first index of the first modified sample
+                 * @param length new length of the sample, limited by the maximum length
+                 */
+                void        update(size_t channel, const float *src, size_t first, size_t length);
+
+                /**
+                 * Get the minimum and maximum of the range of samples
+                 * @param channel channel number
+                 * @param src the sample data of the channel
+                 * @param first index of the first sample
+                 * @param count number of samples, limited by the length of the sample
+                 * @param min pointer to store the minimum, zero for the empty range
+                 * @param max pointer to store the maximum, zero for the empty range
+                 */
+                void        get(size_t channel, const float *src, size_t first, size_t count, float *min, float *max) const;
+
+                /**
+                 * Render the overview of the range of samples: the range is split into
+                 * width columns of equal size, the minimum and maximum are computed for
+                 * each column. Columns of the range shorter than width contain at least
+                 * one sample
+                 * @param channel channel number
+                 * @param src the sample data of the channel
+                 * @param min buffer to store minimums of width columns
+                 * @param max buffer to store maximums of width columns
+                 * @param first index of the first sample
+                 * @param count number of samples, limited by the length of the sample
+                 * @param width number of columns
+                 */
+                void        render(size_t channel, const float *src, float *min, float *max, size_t first, size_t count, size_t width) const;
+
+                /**
+                 * Add the memory footprint of the waveform overview to the report
+                 * @param r report to update
+                 */
+                void        memory_usage(memory_report_t *r) const;
+
+                /**
+                 * Dump internal state
+                 * @param v state dumper
+                 */
+                void        dump(IStateDumper *v) const;
+        };
+    }
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_SAMPLING_SAMPLEPEAKS_H_ */
@@ -24,11 +24,50 @@
 
 #include <lsp-plug.in/dsp-units/version.h>
 #include <lsp-plug.in/dsp-units/sampling/Sample.h>
+#include <lsp-plug.in/dsp-units/sampling/SampleStream.h>
+
+#define SAMPLE_PLAYER_PRIORITIES        8       /* Number of voice stealing priorities */
+#define SAMPLE_PLAYER_MAX_RATE          16.0f   /* Maximum playback rate */
+#define SAMPLE_PLAYER_SINC_TAPS         8       /* Number of taps of the band-limited interpolation kernel */
+#define SAMPLE_PLAYER_SINC_PHASES       0x100   /* Number of phases of the band-limited interpolation kernel */
+#define SAMPLE_PLAYER_COMMANDS          0x100   /* Default capacity of the command queue */
+#define SAMPLE_PLAYER_CHANNELS          8       /* Maximum number of channels rendered by one playback */
 
 namespace lsp
 {
     namespace dspu
     {
+        /**
+         * Interpolation of the sample data for playbacks with non-native rate
+         */
+        enum sp_interpolation_t
+        {
+            SPI_LINEAR,         // Linear interpolation, fastest
+            SPI_CUBIC,          // Catmull-Rom cubic interpolation
+            SPI_SINC            // Band-limited interpolation with precomputed windowed sinc table
+        };
+
+        /**
+         * Loop region of the playback
+         */
+        typedef struct sp_loop_t
+        {
+            size_t      nStart;     // The first sample of the loop
+            size_t      nEnd;       // The sample after the last sample of the loop
+            size_t      nFade;      // Length of the crossfade before the end of the loop
+        } sp_loop_t;
+
+        /**
+         * Mapping of the sample channels to the outputs of the player for one playback
+         */
+        typedef struct sp_channel_map_t
+        {
+            size_t      nChannels;                          // Number of rendered channels
+            size_t      vChannel[SAMPLE_PLAYER_CHANNELS];   // Channel of the sample
+            size_t      vOutput[SAMPLE_PLAYER_CHANNELS];    // Output to mix the channel to
+            float       vGain[SAMPLE_PLAYER_CHANNELS];      // Gain of the channel
+        } sp_channel_map_t;
+
         class SamplePlayer
         {
             private:
@@ -39,12 +78,21 @@ namespace lsp
                 typedef struct playback_t
                 {
                     Sample     *pSample;    // Pointer to the sample
+                    SampleStream *pStream;  // Pointer to the stream if the sample is streamed
                     ssize_t     nID;        // ID of playback
-                    size_t      nChannel;   // Channel to play
+                    size_t      nChannel;   // Channel currently rendered
+                    sp_channel_map_t sMap;  // Channels to render
                     ssize_t     nOffset;    // Current offset
                     ssize_t     nFadeout;   // Fadeout (cancelling)
                     ssize_t     nFadeOffset;// Fadeout offset
                     float       nVolume;    // The volume of the sample
+                    float       fRate;      // Playback rate, 1.0 is the native rate of the sample
+                    double      fPosition;  // Current source position for the non-native rate
+                    ssize_t     nLoopStart; // The first sample of the loop
+                    ssize_t     nLoopEnd;   // The sample after the last sample of the loop, not greater than start if not looped
+                    ssize_t     nLoopFade;  // Length of the crossfade before the end of the loop
+                    size_t      nIndex;     // Index in the list of active playbacks
+                    size_t      nPriority;  // Voice stealing priority, lower is stolen first
                     playback_t *pNext;      // Pointer to the next playback in the list
                     playback_t *pPrev;      // Pointer to the previous playback in the list
                 } playback_t;
@@ -55,22 +103,85 @@ namespace lsp
                     playback_t *pTail;      // The tail of the list
                 } list_t;
 
+                enum command_type_t
+                {
+                    CMD_PLAY,               // Trigger the playback
+                    CMD_CANCEL,             // Softly cancel playbacks
+                    CMD_BIND,               // Bind the sample
+                    CMD_STOP                // Stop all playbacks
+                };
+
+                typedef struct command_t
+                {
+                    command_type_t  enType;     // Type of command
+                    size_t          nID;        // ID of the sample
+                    size_t          nChannel;   // Channel of the sample
+                    float           fVolume;    // The volume of the sample
+                    float           fRate;      // Playback rate
+                    size_t          nFadeout;   // Fadeout length
+                    sp_loop_t       sLoop;      // Loop region
+                    sp_channel_map_t sMap;      // Channels to render, all channels if empty
+                    wsize_t         nTimestamp; // Timestamp of the command in samples
+                    Sample         *pSample;    // Sample to bind
+                } command_t;
+
+                typedef struct cell_t
+                {
+                    ssize_t         nSequence;  // Sequence number of the cell
+                    command_t       sCommand;   // Command stored in the cell
+                } cell_t;
+
             private:
                 Sample        **vSamples;
+                SampleStream  **vStreams;
                 size_t          nSamples;
                 playback_t     *vPlayback;
                 size_t          nPlayback;
-                list_t          sActive;
+                playback_t    **vActive;        // Dense list of active playbacks
+                size_t          nActive;        // Number of active playbacks
+                list_t          vSteal[SAMPLE_PLAYER_PRIORITIES];   // Active playbacks in order of stealing
                 list_t          sInactive;
                 float           fGain;
+                sp_interpolation_t  enInterpolation;    // Interpolation for the non-native rate
+                float           vSinc[(SAMPLE_PLAYER_SINC_PHASES + 1) * SAMPLE_PLAYER_SINC_TAPS]; // Interpolation kernel
+                wsize_t         nTimestamp;     // Number of samples processed since initialization
+                cell_t         *vCommands;      // Bounded lock-free command queue
+                size_t          nCmdMask;       // Capacity mask of the command queue
+                ssize_t         nCmdHead;       // Head of the command queue, modified only by the audio thread
+                ssize_t         nCmdTail;       // Tail of the command queue, modified by posting threads
+                Sample        **vGarbage;       // Unbound samples to be destroyed outside of the audio thread
+                ssize_t         nGcHead;        // Head of the garbage queue, modified only by gc()
+                ssize_t         nGcTail;        // Tail of the garbage queue, modified only by the audio thread
+                ssize_t         nGcReserved;    // Number of reserved slots in the garbage queue
 
             protected:
                 static inline void cleanup(playback_t *pb);
                 static inline void list_remove(list_t *list, playback_t *pb);
                 static inline playback_t *list_remove_first(list_t *list);
                 static inline void list_add_first(list_t *list, playback_t *pb);
-                static inline void list_insert_from_tail(list_t *list, playback_t *pb);
-                void do_process(float *dst, size_t samples);
+                static inline void list_add_last(list_t *list, playback_t *pb);
+                static inline size_t volume_priority(float volume);
+                inline void activate(playback_t *pb);
+                inline void deactivate(playback_t *pb);
+                inline playback_t *acquire();
+                static inline void mix(playback_t *pb, float *dst, const float *src, float gain, ssize_t count);
+                static void fetch(const playback_t *pb, float *dst, ssize_t offset, ssize_t count);
+                static inline bool direct(const playback_t *pb);
+                static inline bool looped(const playback_t *pb);
+                static inline ssize_t loop_segment(const playback_t *pb, ssize_t offset, ssize_t *pos, bool *fade);
+                static void fetch_loop(const playback_t *pb, float *dst, ssize_t offset, ssize_t count);
+                static void mix_loop(playback_t *pb, float *dst, ssize_t offset, float gain, ssize_t count);
+                void render(playback_t *pb, float *dst, ssize_t offset, ssize_t count, ssize_t length, float gain);
+                static void interpolate_linear(float *dst, const float *src, double x, float step, size_t count);
+                static void interpolate_cubic(float *dst, const float *src, double x, float step, size_t count);
+                void interpolate_sinc(float *dst, const float *src, double x, float step, size_t count) const;
+                size_t resample(playback_t *pb, float *dst, size_t count, ssize_t length);
+                void init_sinc();
+                void cancel_playbacks(const Sample *sample, const SampleStream *stream);
+                bool post(const command_t *cmd);
+                void execute(const command_t *cmd);
+                void drain();
+                void do_process(float * const *dst, size_t outputs, size_t samples);
 
                 static void dump_list(IStateDumper *v, const char *name, const list_t *list);
 
@@ -87,9 +198,10 @@ namespace lsp
                  *
                  * @param max_samples maximum available samples
                  * @param max_playbacks maximum number of simultaneous played samples
+                 * @param max_commands capacity of the command queue, will be rounded up to the power of 2
                  * @return true on success
                  */
-                bool init(size_t max_samples, size_t max_playbacks);
+                bool init(size_t max_samples, size_t max_playbacks, size_t max_commands = SAMPLE_PLAYER_COMMANDS);
 
                 /** Destroy player
                  * @param cascade destroy the bound samples
@@ -103,6 +215,24 @@ namespace lsp
                  */
                 inline void set_gain(float gain) { fGain = gain; }
 
+                /** Set interpolation of the sample data for playbacks with non-native rate
+                 *
+                 * @param mode interpolation mode
+                 */
+                inline void set_interpolation(sp_interpolation_t mode) { enInterpolation = mode; }
+
+                /** Get interpolation of the sample data for playbacks with non-native rate
+                 *
+                 * @return interpolation mode
+                 */
+                inline sp_interpolation_t interpolation() const { return enInterpolation; }
+
+                /** Get number of active playbacks
+                 *
+                 * @return number of active playbacks
+                 */
+                inline size_t playbacks() const { return nActive; }
+
                 /** Bind sample to specified ID, cancel all active playbacks previously associated
                  * with this sample
                  *
@@ -138,6 +268,23 @@ namespace lsp
                  */
                 bool unbind(size_t id, bool destroy = false);
 
+                /** Bind disk-backed stream to specified ID, cancel all active playbacks previously
+                 * associated with this stream. The stream is not owned by the player and is not
+                 * destroyed by it. Samples take precedence over streams bound to the same ID
+                 *
+                 * @param id id of the sample
+                 * @param stream pointer to the stream, NULL to unbind
+                 * @return true on success
+                 */
+                bool bind_stream(size_t id, SampleStream *stream);
+
+                /** Unbind disk-backed stream
+                 *
+                 * @param id id of the sample
+                 * @return true on success
+                 */
+                inline bool unbind_stream(size_t id) { return bind_stream(id, NULL); }
+
                 /** Process the audio data
                  *
                  * @param dst destination buffer to store data
@@ -153,15 +300,70 @@ namespace lsp
                  */
                 void process(float *dst, size_t samples);
 
-                /** Trigger the playback of the sample
+                /** Process the audio data of several outputs, the outputs referenced by the
+                 * channel maps of playbacks are wrapped around the number of outputs
+                 *
+                 * @param dst list of destination buffers to store data
+                 * @param src list of source buffers to read data, NULL list or NULL element means silence
+                 * @param outputs number of outputs
+                 * @param samples amount of audio samples to process
+                 */
+                void process(float * const *dst, const float * const *src, size_t outputs, size_t samples);
+
+                /** Process the audio data of several outputs, the outputs referenced by the
+                 * channel maps of playbacks are wrapped around the number of outputs
+                 *
+                 * @param dst list of destination buffers to store data
+                 * @param outputs number of outputs
+                 * @param samples amount of audio samples to process
+                 */
+                void process(float * const *dst, size_t outputs, size_t samples);
+
+                /** Trigger the playback of the sample. If there are no free playbacks,
+                 * the playback is stolen from the active ones: the oldest cancelled playback
+                 * first, then the oldest playback of the lowest volume
+                 *
+                 * @param id ID of the sample
+                 * @param channel ID of the sample's channel
+                 * @param volume the volume of the sample
+                 * @param delay the delay (in samples) of the sample relatively to the next process() call
+                 * @param rate the playback rate, 2.0 plays the sample one octave higher, 0.5 one octave lower,
+                 *   should be positive and not greater than SAMPLE_PLAYER_MAX_RATE
+                 * @return true if parameters are valid
+                 */
+                bool play(size_t id, size_t channel, float volume, ssize_t delay = 0, float rate = 1.0f);
+
+                /** Trigger the looped playback of the sample. After reaching the end of the loop
+                 * the playback continues from the start of the loop until it is cancelled. The last
+                 * samples of the loop are crossfaded with the samples before the start of the loop,
+                 * so the crossfade length is limited by the start position and the loop length
                  *
                  * @param id ID of the sample
                  * @param channel ID of the sample's channel
                  * @param volume the volume of the sample
+                 * @param loop the loop region, should not exceed the length of the sample,
+                 *   the empty region or NULL means no loop
                  * @param delay the delay (in samples) of the sample relatively to the next process() call
+                 * @param rate the playback rate, should be positive and not greater than SAMPLE_PLAYER_MAX_RATE
                  * @return true if parameters are valid
                  */
-                bool play(size_t id, size_t channel, float volume, ssize_t delay = 0);
+                bool play_loop(size_t id, size_t channel, float volume, const sp_loop_t *loop, ssize_t delay = 0, float rate = 1.0f);
+
+                /** Trigger the playback of several channels of the sample by one voice. All channels
+                 * share the playback state and are stolen and cancelled together
+                 *
+                 * @param id ID of the sample
+                 * @param map mapping of the sample channels to the outputs with per-channel gains,
+                 *   NULL means all channels of the sample (up to SAMPLE_PLAYER_CHANNELS) mapped to the
+                 *   outputs with the same index
+                 * @param volume the volume of the sample
+                 * @param loop the loop region, the empty region or NULL means no loop
+                 * @param delay the delay (in samples) of the sample relatively to the next process() call
+                 * @param rate the playback rate, should be positive and not greater than SAMPLE_PLAYER_MAX_RATE
+                 * @return true if parameters are valid
+                 */
+                bool play_mapped(size_t id, const sp_channel_map_t *map, float volume,
+                        const sp_loop_t *loop = NULL, ssize_t delay = 0, float rate = 1.0f);
 
                 /** Softly cancel playback of the sample
                  *
@@ -178,6 +380,93 @@ namespace lsp
                  */
                 void stop();
 
+            public:
+                /** Get the timestamp of the next process() call, can be used by other threads
+                 * to compute timestamps for the posted commands
+                 *
+                 * @return number of samples processed since initialization
+                 */
+                inline wsize_t timestamp() const { return *(reinterpret_cast<const volatile wsize_t *>(&nTimestamp)); }
+
+                /** Post the play() command from any thread, the command is executed
+                 * at the beginning of the process() call, lock-free
+                 *
+                 * @param id ID of the sample
+                 * @param channel ID of the sample's channel
+                 * @param volume the volume of the sample
+                 * @param timestamp the timestamp of the playback start, commands with the
+                 *   timestamp that already has passed are executed with no delay
+                 * @param rate the playback rate
+                 * @return true if the command has been posted, false if the queue is full
+                 */
+                bool post_play(size_t id, size_t channel, float volume, wsize_t timestamp = 0, float rate = 1.0f);
+
+                /** Post the play_loop() command from any thread, lock-free
+                 *
+                 * @param id ID of the sample
+                 * @param channel ID of the sample's channel
+                 * @param volume the volume of the sample
+                 * @param loop the loop region, the empty region or NULL means no loop
+                 * @param timestamp the timestamp of the playback start
+                 * @param rate the playback rate
+                 * @return true if the command has been posted, false if the queue is full
+                 */
+                bool post_play_loop(size_t id, size_t channel, float volume, const sp_loop_t *loop, wsize_t timestamp = 0, float rate = 1.0f);
+
+                /** Post the play_mapped() command from any thread, lock-free
+                 *
+                 * @param id ID of the sample
+                 * @param map mapping of the sample channels to the outputs, NULL means all channels
+                 * @param volume the volume of the sample
+                 * @param loop the loop region, the empty region or NULL means no loop
+                 * @param timestamp the timestamp of the playback start
+                 * @param rate the playback rate
+                 * @return true if the command has been posted, false if the queue is full
+                 */
+                bool post_play_mapped(size_t id, const sp_channel_map_t *map, float volume,
+                        const sp_loop_t *loop = NULL, wsize_t timestamp = 0, float rate = 1.0f);
+
+                /** Post the cancel_all() command from any thread, lock-free
+                 *
+                 * @param id ID of the sample
+                 * @param channel ID of the sample's channel
+                 * @param fadeout the fadeout length in samples for sample gain fadeout
+                 * @param timestamp the timestamp of the fadeout start
+                 * @return true if the command has been posted, false if the queue is full
+                 */
+                bool post_cancel_all(size_t id, size_t channel, size_t fadeout = 0, wsize_t timestamp = 0);
+
+                /** Post the bind() command from any thread, lock-free. The replaced sample
+                 * is passed to the garbage queue and should be destroyed by calling gc()
+                 *
+                 * @param id ID of the sample
+                 * @param sample the sample to bind, NULL to unbind
+                 * @return true if the command has been posted, false if the command queue
+                 *   or the garbage queue is full
+                 */
+                bool post_bind(size_t id, Sample *sample);
+
+                /** Post the unbind() command from any thread, lock-free. The unbound sample
+                 * is passed to the garbage queue and should be destroyed by calling gc()
+                 *
+                 * @param id ID of the sample
+                 * @return true if the command has been posted
+                 */
+                inline bool post_unbind(size_t id) { return post_bind(id, NULL); }
+
+                /** Post the stop() command from any thread, lock-free
+                 *
+                 * @return true if the command has been posted, false if the queue is full
+                 */
+                bool post_stop();
+
+                /** Destroy the samples unbound by the posted commands, should not be called
+                 * from the audio thread and from more than one thread at a time
+                 *
+                 * @return number of destroyed samples
+                 */
+                size_t gc();
+
                 /**
                  * Dump the state
                  * @param dumper dumper
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_SAMPLING_SAMPLERECORDER_H_
+#define LSP_PLUG_IN_DSP_UNITS_SAMPLING_SAMPLERECORDER_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/common/atomic.h>
+#include <lsp-plug.in/io/Path.h>
+#include <lsp-plug.in/runtime/LSPString.h>
+#include <lsp-plug.in/mm/IOutAudioStream.h>
+
+#define SAMPLE_RECORDER_BUFFER_SIZE     0x20000     /* Default number of frames in the ring buffer */
+#define SAMPLE_RECORDER_CHUNK_SIZE      0x4000      /* Default number of frames written by one call */
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Disk recorder: the audio thread puts the data into the lock-free ring buffer
+         * and the background thread writes it to the audio stream by large chunks.
+         * The memory usage does not depend on the duration of the recording.
+         * The write() method is real-time safe: it never blocks and drops the frames
+         * that do not fit into the ring buffer.
+         */
+        class SampleRecorder
+        {
+            private:
+                SampleRecorder & operator = (const SampleRecorder &);
+                SampleRecorder(const SampleRecorder &);
+
+            protected:
+                class Writer;
+
+            private:
+                mm::IOutAudioStream    *pStream;        // Output stream
+                mm::IOutAudioStream    *pFile;          // Output stream owned by the object
+                Writer                 *pWriter;        // Background writer
+                float                  *vBuffer;        // Ring buffer of interleaved frames
+                size_t                  nChannels;      // Number of channels
+                size_t                  nCapacity;      // Capacity of the ring buffer in frames
+                size_t                  nChunk;         // Number of frames written by one call
+                atomic_t                nHead;          // Write position of the audio thread
+                atomic_t                nTail;          // Read position of the writer
+                atomic_t                nDropped;       // Number of frames dropped on overflow
+                wsize_t                 nWritten;       // Number of frames written to the stream
+                atomic_t                nStatus;        // The first error of the stream
+                uint8_t                *pData;          // Allocated data
+
+            protected:
+                bool                    drain(bool flush);
+                void                    release();
+
+            public:
+                explicit SampleRecorder();
+                ~SampleRecorder();
+
+                /**
+                 * Construct the object
+                 */
+                void                    construct();
+
+                /**
+                 * Stop recording and destroy the object
+                 */
+                void                    destroy();
+
+            public:
+                /**
+                 * Create the WAV file and start recording
+                 * @param path path to the file
+                 * @param channels number of channels
+                 * @param sample_rate sample rate
+                 * @param capacity capacity of the ring buffer in frames, rounded up to the power of 2
+                 * @param chunk number of frames written to the file by one call
+                 * @return status of operation
+                 */
+                status_t                open(const char *path, size_t channels, size_t sample_rate,
+                                            size_t capacity = SAMPLE_RECORDER_BUFFER_SIZE, size_t chunk = SAMPLE_RECORDER_CHUNK_SIZE);
+                status_t                open(const LSPString *path, size_t channels, size_t sample_rate,
+                                            size_t capacity = SAMPLE_RECORDER_BUFFER_SIZE, size_t chunk = SAMPLE_RECORDER_CHUNK_SIZE);
+                status_t                open(const io::Path *path, size_t channels, size_t sample_rate,
+                                            size_t capacity = SAMPLE_RECORDER_BUFFER_SIZE, size_t chunk = SAMPLE_RECORDER_CHUNK_SIZE);
+
+                /**
+                 * Start recording to the audio stream. The stream should stay valid until
+                 * the close() is called
+                 * @param out audio stream
+                 * @param channels number of channels of the stream
+                 * @param capacity capacity of the ring buffer in frames, rounded up to the power of 2
+                 * @param chunk number of frames written to the stream by one call
+                 * @return status of operation
+                 */
+                status_t                open(mm::IOutAudioStream *out, size_t channels,
+                                            size_t capacity = SAMPLE_RECORDER_BUFFER_SIZE, size_t chunk = SAMPLE_RECORDER_CHUNK_SIZE);
+
+                /**
+                 * Write the remaining data, stop recording and close the file if it was
+                 * created by the object
+                 * @return status of operation, the first error of the stream if writes have failed
+                 */
+                status_t                close();
+
+            public:
+                inline bool             valid() const               { return pWriter != NULL;   }
+                inline size_t           channels() const            { return nChannels;         }
+                inline size_t           capacity() const            { return nCapacity;         }
+                inline size_t           chunk() const               { return nChunk;            }
+
+                /**
+                 * Get number of frames dropped because the ring buffer was full
+                 * @return number of dropped frames
+                 */
+                inline size_t           dropped() const             { return nDropped;          }
+
+                /**
+                 * Get number of frames written to the stream
+                 * @return number of frames written to the stream
+                 */
+                inline wsize_t          written() const             { return nWritten;          }
+
+                /**
+                 * Put the data to the ring buffer, is real-time safe
+                 * @param src list of channels() source buffers, NULL element means silence
+                 * @param count number of frames
+                 * @return number of frames put to the ring buffer, the remaining frames are dropped
+                 */
+                size_t                  write(const float * const *src, size_t count);
+
+                /**
+                 * Dump the state
+                 * @param dumper dumper
+                 */
+                void                    dump(IStateDumper *v) const;
+        };
+    }
+}
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_SAMPLING_SAMPLERECORDER_H_ */
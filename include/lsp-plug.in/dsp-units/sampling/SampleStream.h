@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_SAMPLING_SAMPLESTREAM_H_
+#define LSP_PLUG_IN_DSP_UNITS_SAMPLING_SAMPLESTREAM_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/common/atomic.h>
+#include <lsp-plug.in/io/Path.h>
+#include <lsp-plug.in/runtime/LSPString.h>
+#include <lsp-plug.in/mm/IInAudioStream.h>
+
+#define SAMPLE_STREAM_PAGE_SIZE     0x4000      /* Default number of frames per page */
+#define SAMPLE_STREAM_PAGES         0x10        /* Default number of pages in the cache */
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Disk-backed sample: the audio stream is not loaded into memory but is read
+         * by a background thread into a small cache of pages located ahead of the
+         * current read position. The read() method is real-time safe: it never blocks
+         * and returns silence for the data that has not been loaded yet.
+         * The cache is optimized for a single sequential playhead.
+         */
+        class SampleStream
+        {
+            private:
+                SampleStream & operator = (const SampleStream &);
+                SampleStream(const SampleStream &);
+
+            protected:
+                class Reader;
+
+                typedef struct page_t
+                {
+                    float              *vData;          // Deinterleaved page data, channels * nPageSize
+                    atomic_t            nIndex;         // Index of the loaded page, -1 if none
+                    atomic_t            nSerial;        // Update counter, odd while the page is being loaded
+                } page_t;
+
+            private:
+                mm::IInAudioStream *pStream;        // Input stream
+                mm::IInAudioStream *pFile;          // Input stream owned by the object
+                Reader             *pReader;        // Background reader
+                page_t             *vPages;         // Cache pages
+                float              *vBuffer;        // Interleaved buffer for reads
+                size_t              nChannels;      // Number of channels
+                size_t              nSampleRate;    // Sample rate
+                wsize_t             nLength;        // Length of the stream in frames
+                wssize_t            nPosition;      // Current position of the stream, negative if unknown
+                size_t              nPageSize;      // Page size in frames
+                size_t              nPageShift;     // Page size as shift
+                size_t              nPages;         // Number of pages in the cache
+                atomic_t            nHint;          // Index of the first page the reader should load
+                atomic_t            nUnderruns;     // Number of read() calls with missing data
+                uint8_t            *pData;          // Allocated data
+
+            protected:
+                bool                fill();
+                void                load_page(page_t *pg, atomic_t index);
+                void                release();
+
+            public:
+                explicit SampleStream();
+                ~SampleStream();
+
+                /**
+                 * Construct the object
+                 */
+                void                construct();
+
+                /**
+                 * Close the stream and destroy the object
+                 */
+                void                destroy();
+
+            public:
+                /**
+                 * Open the audio file and start streaming
+                 * @param path path to the audio file
+                 * @param pages number of pages in the cache, rounded up to the power of 2
+                 * @param page_size page size in frames, rounded up to the power of 2
+                 * @return status of operation
+                 */
+                status_t            open(const char *path, size_t pages = SAMPLE_STREAM_PAGES, size_t page_size = SAMPLE_STREAM_PAGE_SIZE);
+                status_t            open(const LSPString *path, size_t pages = SAMPLE_STREAM_PAGES, size_t page_size = SAMPLE_STREAM_PAGE_SIZE);
+                status_t            open(const io::Path *path, size_t pages = SAMPLE_STREAM_PAGES, size_t page_size = SAMPLE_STREAM_PAGE_SIZE);
+
+                /**
+                 * Start streaming of the audio stream. The stream should support seek
+                 * operations and stay valid until the close() is called
+                 * @param in audio stream
+                 * @param pages number of pages in the cache, rounded up to the power of 2
+                 * @param page_size page size in frames, rounded up to the power of 2
+                 * @return status of operation
+                 */
+                status_t            open(mm::IInAudioStream *in, size_t pages = SAMPLE_STREAM_PAGES, size_t page_size = SAMPLE_STREAM_PAGE_SIZE);
+
+                /**
+                 * Stop streaming and close the audio file if it was opened by the object
+                 * @return status of operation
+                 */
+                status_t            close();
+
+            public:
+                inline bool         valid() const                   { return pReader != NULL;   }
+                inline size_t       channels() const                { return nChannels;         }
+                inline size_t       sample_rate() const             { return nSampleRate;       }
+                inline wsize_t      length() const                  { return nLength;           }
+                inline size_t       page_size() const               { return nPageSize;         }
+                inline size_t       pages() const                   { return nPages;            }
+
+                /**
+                 * Get number of read() calls that did not find the requested data in the cache
+                 * @return number of underruns
+                 */
+                inline size_t       underruns() const               { return nUnderruns;        }
+
+                /**
+                 * Ask the reader to load data starting at the specified position,
+                 * is real-time safe
+                 * @param offset offset in frames
+                 */
+                void                prefetch(wsize_t offset);
+
+                /**
+                 * Check that the data at the specified position is present in the cache
+                 * @param offset offset in frames
+                 * @return true if data is present in the cache
+                 */
+                bool                ready(wsize_t offset);
+
+                /**
+                 * Read the data of the channel, is real-time safe. The data which is not present
+                 * in the cache and the data after the end of the stream is returned as zeros.
+                 * Moves the read position of the cache to the offset.
+                 * @param channel the channel to read
+                 * @param dst destination buffer
+                 * @param offset offset in frames
+                 * @param count number of frames to read
+                 * @return number of frames taken from the cache
+                 */
+                size_t              read(size_t channel, float *dst, wsize_t offset, size_t count);
+
+                /**
+                 * Dump the state
+                 * @param dumper dumper
+                 */
+                void                dump(IStateDumper *v) const;
+        };
+    }
+}
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_SAMPLING_SAMPLESTREAM_H_ */
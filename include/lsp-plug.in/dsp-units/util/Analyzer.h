@@ -24,6 +24,9 @@
 
 #include <lsp-plug.in/dsp-units/version.h>
 #include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/dsp-units/misc/memory.h>
+#include <lsp-plug.in/dsp-units/util/PerfCounter.h>
+#include <lsp-plug.in/common/atomic.h>
 
 namespace lsp
 {
@@ -50,6 +53,12 @@ namespace lsp
             FRQA_INT_MASK           = 0x0300
         };
 
+        enum spectrogram_format_t
+        {
+            SPECTROGRAM_U8,                 // Levels are quantized to 8 bits
+            SPECTROGRAM_U16                 // Levels are quantized to 16 bits
+        };
+
         class Analyzer
          {
              private:
@@ -57,6 +66,12 @@ namespace lsp
                  Analyzer(const Analyzer &);
 
              protected:
+                 enum snapshot_flags
+                 {
+                     S_INDEX     = 0x03,         // Mask of buffer index
+                     S_FRESH     = 0x04          // The buffer contains fresh data
+                 };
+
                  enum reconfigure_flags
                  {
                      R_ENVELOPE  = 1<<0,
@@ -72,7 +87,7 @@ namespace lsp
                  {
                      float      *vBuffer;        // FFT delay buffer
                      float      *vAmp;           // FFT amplitude
-                     float      *vData;          // FFT data
+                     float      *vData[2];       // FFT data, double-buffered
                      size_t      nDelay;         // Delay in the delay buffer
                      bool        bFreeze;        // Freeze analysis
                      bool        bActive;        // Enable analysis
@@ -81,6 +96,7 @@ namespace lsp
              protected:
                  size_t      nChannels;          // Overall number of channels
                  size_t      nMaxRank;           // Maximum FFT rank
+                 size_t      nCapRank;           // FFT rank of the allocated buffers
                  size_t      nRank;              // Current FFT rank
                  size_t      nSampleRate;        // Sample rate
                  size_t      nMaxSampleRate;     // Maximum possible sample rate
@@ -98,13 +114,59 @@ namespace lsp
                  size_t      nEnvelope;          // Type of spectral envelope
                  size_t      nWindow;            // Type of FFT window
                  bool        bActive;            // Activity flag
+                 bool        bBatch;             // Batch processing of all channels at each strobe
+                 bool        bLazy;              // Buffers are allocated for the current settings only
+                 atomic_t    nFront;             // Index of the published FFT data buffer
 
                  channel_t  *vChannels;          // List of channels
                  void       *vData;              // Allocated floating-point data
                  float      *vSigRe;             // Real part of signal
                  float      *vFftReIm;           // Buffer for FFT transform (real part)
-                 float      *vWindow;            // FFT window
+                 const float *vWindow;           // FFT window, shared table
                  float      *vEnvelope;          // FFT envelope
+                 const float *vEnvTable;         // Unscaled FFT envelope, shared table
+
+                 uint32_t   *vSnapIdx;           // Frequency index map of the snapshot
+                 float      *vSnapshot[3];       // Triple-buffered snapshot data
+                 size_t      nSnapSize;          // Number of frequencies in the snapshot
+                 size_t      nSnapBack;          // Snapshot buffer written by the processing thread
+                 size_t      nSnapFront;         // Snapshot buffer read by the consumer thread
+                 atomic_t    nSnapState;         // Exchange state: middle buffer index and freshness flag
+                 void       *vSnapData;          // Allocated snapshot data
+
+                 uint32_t   *vSpgIdx;            // Frequency index map of the spectrogram
+                 float      *vSpgBuf;            // Buffer for quantization of the spectrogram row
+                 uint8_t    *vSpgRing;           // Spectrogram history rings of all channels, each row is stored twice
+                 size_t      nSpgSize;           // Number of frequencies in the spectrogram row
+                 size_t      nSpgRows;           // Number of rows in the spectrogram history
+                 size_t      nSpgFormat;         // Format of the spectrogram storage
+                 float       fSpgMin;            // Level mapped to the minimum quantized value, dB
+                 float       fSpgMax;            // Level mapped to the maximum quantized value, dB
+                 atomic_t    nSpgPosition;       // Overall number of rows appended to the spectrogram
+                 void       *vSpgData;           // Allocated spectrogram data
+
+                 float      *vTwiddle;           // Twiddle factors for the allocated FFT rank, packed complex
+                 size_t      nJobChannel;        // Current channel of the amortized transform
+                 size_t      nJobEnd;            // Last channel of the amortized transform (exclusive)
+                 size_t      nJobHead;           // Head of the delay buffers at the strobe
+                 size_t      nJobStage;          // Current stage of the channel transform
+                 size_t      nJobPos;            // Position inside of the stage
+                 size_t      nJobDone;           // Number of work units done since the strobe
+                 size_t      nJobTotal;          // Number of work units to do until the next strobe
+                 bool        bAmortize;          // Amortize FFT transforms over the strobe period
+                 PerfCounter sPerf;              // Performance counters
+
+             protected:
+                 void        process_channel(channel_t *c, size_t fft_size);
+                 void        publish();
+                 void        destroy_snapshot();
+                 void        destroy_spectrogram();
+                 void        append_spectrogram(size_t back);
+                 void        start_transform(size_t first, size_t count);
+                 void        run_transform(size_t limit);
+                 bool        allocate(size_t rank, size_t buf_size);
+
+                 static size_t delay_size(size_t rank, size_t sr, float rate);
 
              public:
                  explicit Analyzer();
@@ -131,6 +193,46 @@ namespace lsp
                   */
                  bool init(size_t channels, size_t max_rank, size_t max_sr, float min_rate);
 
+                 /** Initialize analyzer
+                  *
+                  * @param channels number of channels for analysis
+                  * @param max_rank maximum FFT rank
+                  * @param max_sr maximum sample rate
+                  * @param min_rate minimum refresh rate
+                  * @param lazy do not allocate buffers for the worst case, allocate them
+                  *   for the current settings by the prepare() call instead
+                  * @return status of operation
+                  */
+                 bool init(size_t channels, size_t max_rank, size_t max_sr, float min_rate, bool lazy);
+
+                 /**
+                  * Grow the buffers of the lazily initialized analyzer to match the current
+                  * rank, sample rate and refresh rate. The call allocates memory, so it should
+                  * be performed outside of the real-time thread and never concurrently with
+                  * processing or reading of the spectrum. Until the buffers match the settings,
+                  * the analysis is suspended
+                  * @return false if there is not enough memory
+                  */
+                 bool prepare();
+
+                 /**
+                  * Check that the allocated buffers match the current settings
+                  * @return true if the analysis can be performed
+                  */
+                 bool prepared() const;
+
+                 /**
+                  * Get FFT rank of the allocated buffers
+                  * @return FFT rank of the allocated buffers
+                  */
+                 inline size_t get_allocated_rank() const { return nCapRank; }
+
+                 /**
+                  * Check that the analyzer allocates buffers lazily
+                  * @return true if the analyzer allocates buffers lazily
+                  */
+                 inline bool get_lazy() const            { return bLazy; }
+
                  /**
                   * Get overall number of channels
                   * @return overall number of channels
@@ -234,6 +336,37 @@ namespace lsp
                   */
                  inline size_t get_rank() const          { return nRank; }
 
+                 /**
+                  * Set batch mode of analysis. In batch mode FFT transforms of all channels are
+                  * performed at each strobe, so the refresh rate of the analysis does not depend
+                  * on the number of channels. Otherwise the FFT transforms of channels are
+                  * distributed evenly over the refresh period
+                  * @param batch batch mode flag
+                  */
+                 void set_batch(bool batch);
+
+                 /**
+                  * Check that batch mode of analysis is enabled
+                  * @return true if batch mode of analysis is enabled
+                  */
+                 inline bool get_batch() const           { return bBatch; }
+
+                 /**
+                  * Set amortized mode of analysis. In amortized mode the FFT transform is split
+                  * into stages of bounded cost which are performed evenly over the samples
+                  * between strobes instead of the single transform at the strobe, so the CPU load
+                  * does not have periodic spikes for the large FFT ranks and small block sizes.
+                  * In batch mode the spectrum is published one strobe later
+                  * @param amortize amortized mode flag
+                  */
+                 void set_amortized(bool amortize);
+
+                 /**
+                  * Check that amortized mode of analysis is enabled
+                  * @return true if amortized mode of analysis is enabled
+                  */
+                 inline bool get_amortized() const       { return bAmortize; }
+
                  /** Set analyzer activity
                   *
                   * @param active activity flag
@@ -276,7 +409,9 @@ namespace lsp
                   */
                  void process(const float * const *in, size_t samples);
 
-                 /** Read spectrum data
+                 /** Read spectrum data. The spectrum data is double-buffered and
+                  * published once per refresh period, so it can be safely read by
+                  * another thread
                   *
                   * @param channel channel
                   * @param out output buffer
@@ -285,6 +420,21 @@ namespace lsp
                   */
                  bool get_spectrum(size_t channel, float *out, const uint32_t *idx, size_t count);
 
+                 /** Read spectrum data reduced over ranges of frequency bins. Unlike get_spectrum(),
+                  * each output point covers the whole range of bins, so narrow peaks are not lost
+                  * when many bins fall into one point of the display
+                  *
+                  * @param channel channel
+                  * @param out output buffer of count elements
+                  * @param bounds array of count + 1 bin numbers, the point i covers bins from
+                  *   bounds[i] inclusive to bounds[i+1] exclusive, empty range takes the bin bounds[i]
+                  * @param count number of output points
+                  * @param func reduction function: FRQA_FUNC_MAX, FRQA_FUNC_MIN, FRQA_FUNC_AVG
+                  *   for power average or FRQA_FUNC_NEAREST for the first bin of the range
+                  * @return true on success
+                  */
+                 bool get_spectrum(size_t channel, float *out, const uint32_t *bounds, size_t count, size_t func);
+
                  /**
                   * Get level of one frequency
                   * @param channel channel number
@@ -303,6 +453,17 @@ namespace lsp
                   */
                  void get_frequencies(float *frq, uint32_t *idx, float start, float stop, size_t count);
 
+                 /** Get list of logarithmically spaced frequency ranges for get_spectrum() call
+                  * with reduction
+                  *
+                  * @param frq list of count center frequencies of ranges
+                  * @param bounds list of count + 1 bin numbers of range boundaries
+                  * @param start start frequency
+                  * @param stop stop frequency
+                  * @param count number of ranges
+                  */
+                 void get_frequency_ranges(float *frq, uint32_t *bounds, float start, float stop, size_t count);
+
                  /** Read the frequencies of the analyzer
                   *
                   * @param frq target array to store frequency value
@@ -315,6 +476,105 @@ namespace lsp
                   */
                  bool read_frequencies(float *frq, float start, float stop, size_t count, size_t flags = FRQA_SCALE_LOGARITHMIC);
 
+                 /**
+                  * Initialize the snapshot of spectrum. The snapshot contains the spectrum of
+                  * each channel resampled to the frequency index map (for example, returned by
+                  * get_frequencies()) with applied envelope. It is updated by the processing thread
+                  * once per refresh period and can be read by one consumer thread without locks.
+                  * The method allocates memory and should not be called concurrently with process()
+                  *
+                  * @param idx array of frequency numbers, NULL to disable snapshot
+                  * @param count size of the array
+                  * @return true on success
+                  */
+                 bool init_snapshot(const uint32_t *idx, size_t count);
+
+                 /**
+                  * Get number of frequencies in the snapshot
+                  * @return number of frequencies in the snapshot
+                  */
+                 inline size_t snapshot_size() const     { return nSnapSize; }
+
+                 /**
+                  * Fetch the latest snapshot published by processing thread, should be called
+                  * by the consumer thread
+                  * @return true if the new snapshot has been fetched
+                  */
+                 bool fetch_snapshot();
+
+                 /**
+                  * Get the spectrum of the channel from the snapshot fetched by the last
+                  * fetch_snapshot() call, should be called by the consumer thread. The data
+                  * remains consistent until the next fetch_snapshot() call
+                  * @param channel channel number
+                  * @return pointer to snapshot_size() values or NULL
+                  */
+                 const float *snapshot(size_t channel) const;
+
+                 /**
+                  * Initialize the spectrogram history. At each refresh period the spectrum of
+                  * each channel is resampled to the frequency index map, converted to decibels,
+                  * quantized to the [min, max] range and appended to the preallocated ring.
+                  * Each row is written to the ring twice, so the whole history is always
+                  * available as one contiguous block without copying.
+                  * The method allocates memory and should not be called concurrently with process()
+                  *
+                  * @param idx array of frequency numbers, NULL to disable spectrogram
+                  * @param count size of the array
+                  * @param rows number of rows in the history
+                  * @param format format of quantized values
+                  * @param min level mapped to the minimum quantized value, dB
+                  * @param max level mapped to the maximum quantized value, dB
+                  * @return true on success
+                  */
+                 bool init_spectrogram(const uint32_t *idx, size_t count, size_t rows,
+                         spectrogram_format_t format, float min = -120.0f, float max = 24.0f);
+
+                 /**
+                  * Get number of frequencies in the spectrogram row
+                  * @return number of frequencies in the spectrogram row
+                  */
+                 inline size_t spectrogram_size() const      { return nSpgSize; }
+
+                 /**
+                  * Get number of rows in the spectrogram history
+                  * @return number of rows in the spectrogram history
+                  */
+                 inline size_t spectrogram_rows() const      { return nSpgRows; }
+
+                 /**
+                  * Get format of the spectrogram storage
+                  * @return format of the spectrogram storage
+                  */
+                 inline spectrogram_format_t spectrogram_format() const  { return spectrogram_format_t(nSpgFormat); }
+
+                 /**
+                  * Get overall number of rows appended to the spectrogram, can be called
+                  * by the consumer thread
+                  * @return overall number of rows appended to the spectrogram
+                  */
+                 size_t spectrogram_position() const;
+
+                 /**
+                  * Get the contiguous view of the spectrogram history of the channel. The view
+                  * contains spectrogram_rows() rows of spectrogram_size() values of uint8_t or
+                  * uint16_t type depending on the format, ordered from the oldest to the latest
+                  * row at the specified position. The processing thread overwrites the oldest rows
+                  * of the view when appending new rows: the consumer should read the position
+                  * again after reading the view and discard as many first rows as appended
+                  * @param channel channel number
+                  * @param position position returned by spectrogram_position()
+                  * @return pointer to the view or NULL
+                  */
+                 const void *spectrogram(size_t channel, size_t position) const;
+
+                 /**
+                  * Convert quantized value of the spectrogram to the level
+                  * @param value quantized value
+                  * @return level, dB
+                  */
+                 float spectrogram_level(size_t value) const;
+
                  /** Reconfigure analyzer
                   *
                   */
@@ -326,6 +586,19 @@ namespace lsp
                   */
                  inline bool     needs_reconfiguration() const   { return nReconfigure; }
 
+                 /**
+                  * Get performance counters, they are updated only when the library
+                  * is built with LSP_DSP_UNITS_PERF_COUNTERS defined
+                  * @return performance counters
+                  */
+                 inline const PerfCounter *perf() const             { return &sPerf; }
+
+                 /**
+                  * Add the memory footprint of the analyzer to the report
+                  * @param r report to update
+                  */
+                 void            memory_usage(memory_report_t *r) const;
+
                  /**
                   * Dump the state
                   * @param dumper dumper
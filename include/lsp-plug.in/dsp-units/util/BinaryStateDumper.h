@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_UTIL_BINARYSTATEDUMPER_H_
+#define LSP_PLUG_IN_DSP_UNITS_UTIL_BINARYSTATEDUMPER_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/common/status.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * State dumper that stores the state into the preallocated buffer in the compact
+         * binary form: each field is a record of 8-byte header (type, field name identifier,
+         * number of elements) followed by the raw value padded to 8 bytes. Field names are
+         * expected to be string literals, they are identified by the pointer and stored once
+         * in the schema cache. Dumping does not allocate memory and does not format values,
+         * so it is suitable for the real-time thread. The stored state can be decoded later
+         * by replaying it into any other IStateDumper.
+         *
+         * If the buffer or the schema capacity is exceeded, the rest of the state is dropped
+         * and the overflow flag is set.
+         */
+        class BinaryStateDumper: public IStateDumper
+        {
+            private:
+                BinaryStateDumper & operator = (const BinaryStateDumper &);
+                BinaryStateDumper(const BinaryStateDumper &);
+
+            protected:
+                enum record_type_t
+                {
+                    T_BEGIN_OBJECT,
+                    T_END_OBJECT,
+                    T_BEGIN_ARRAY,
+                    T_END_ARRAY,
+                    T_PTR,
+                    T_STR,
+                    T_BOOL,
+                    T_U8,
+                    T_I8,
+                    T_U16,
+                    T_I16,
+                    T_U32,
+                    T_I32,
+                    T_U64,
+                    T_I64,
+                    T_F32,
+                    T_F64,
+
+                    T_VECTOR        = 0x80,         // Flag: the record holds array of values
+                    T_NULL          = 0x40,         // Flag: the vector or string is NULL
+                    T_TYPE_MASK     = 0x3f
+                };
+
+                enum name_id_t
+                {
+                    N_UNNAMED       = 0xffff,       // The field has no name
+                    N_UNKNOWN       = 0xfffe        // The schema cache is full
+                };
+
+                typedef struct record_t
+                {
+                    uint8_t     nType;              // Record type
+                    uint8_t     nReserved;          // Reserved, zero
+                    uint16_t    nName;              // Identifier of the field name
+                    uint32_t    nCount;             // Number of elements, string length, size of object
+                } record_t;
+
+            protected:
+                uint8_t        *vBuffer;            // Record buffer
+                size_t          nCapacity;          // Capacity of the record buffer in bytes
+                size_t          nSize;              // Number of bytes used
+                const char    **vNames;             // Schema: field names indexed by identifier
+                uint16_t       *vHash;              // Hash of field names: identifier + 1, zero if empty
+                size_t          nNames;             // Number of field names in the schema
+                size_t          nMaxNames;          // Capacity of the schema
+                size_t          nHashMask;          // Mask of the hash index
+                bool            bOverflow;          // The state has been truncated
+                uint8_t        *pData;              // Allocated data
+
+            protected:
+                uint16_t        name_id(const char *name);
+                void           *append(uint8_t type, const char *name, size_t count, size_t bytes);
+                void            emit(uint8_t type, const char *name, const void *value, size_t bytes);
+                void            emitv(uint8_t type, const char *name, const void *value, size_t count, size_t szof);
+                const char     *name(uint16_t id) const;
+
+            public:
+                explicit BinaryStateDumper();
+                virtual ~BinaryStateDumper();
+
+                /**
+                 * Construct object
+                 */
+                void            construct();
+
+                /**
+                 * Destroy object
+                 */
+                void            destroy();
+
+            public:
+                /**
+                 * Initialize the dumper
+                 * @param size size of the record buffer in bytes
+                 * @param names maximum number of distinct field names
+                 * @return true on success
+                 */
+                bool            init(size_t size, size_t names = 0x400);
+
+                /**
+                 * Drop the stored state, the schema cache is kept
+                 */
+                inline void     clear()                     { nSize = 0; bOverflow = false; }
+
+                /**
+                 * Get number of bytes used by the stored state
+                 * @return number of bytes used by the stored state
+                 */
+                inline size_t   size() const                { return nSize;         }
+
+                /**
+                 * Get capacity of the record buffer
+                 * @return capacity of the record buffer in bytes
+                 */
+                inline size_t   capacity() const            { return nCapacity;     }
+
+                /**
+                 * Get number of distinct field names stored in the schema
+                 * @return number of distinct field names
+                 */
+                inline size_t   names() const               { return nNames;        }
+
+                /**
+                 * Check that the stored state has been truncated
+                 * @return true if the stored state has been truncated
+                 */
+                inline bool     overflow() const            { return bOverflow;     }
+
+                /**
+                 * Decode the stored state by replaying it into another dumper
+                 * @param dst destination dumper
+                 * @return status of operation, STATUS_CORRUPTED if the data is invalid
+                 */
+                status_t        replay(IStateDumper *dst) const;
+
+            public:
+                virtual void begin_object(const char *name, const void *ptr, size_t szof);
+                virtual void begin_object(const void *ptr, size_t szof);
+                virtual void end_object();
+
+                virtual void begin_array(const char *name, const void *ptr, size_t count);
+                virtual void begin_array(const void *ptr, size_t count);
+                virtual void end_array();
+
+                virtual void write(const void *value);
+                virtual void write(const char *value);
+                virtual void write(bool value);
+                virtual void write(uint8_t value);
+                virtual void write(int8_t value);
+                virtual void write(uint16_t value);
+                virtual void write(int16_t value);
+                virtual void write(uint32_t value);
+                virtual void write(int32_t value);
+                virtual void write(uint64_t value);
+                virtual void write(int64_t value);
+                virtual void write(float value);
+                virtual void write(double value);
+
+                virtual void write(const char *name, const void *value);
+                virtual void write(const char *name, const char *value);
+                virtual void write(const char *name, bool value);
+                virtual void write(const char *name, uint8_t value);
+                virtual void write(const char *name, int8_t value);
+                virtual void write(const char *name, uint16_t value);
+                virtual void write(const char *name, int16_t value);
+                virtual void write(const char *name, uint32_t value);
+                virtual void write(const char *name, int32_t value);
+                virtual void write(const char *name, uint64_t value);
+                virtual void write(const char *name, int64_t value);
+                virtual void write(const char *name, float value);
+                virtual void write(const char *name, double value);
+
+                virtual void writev(const void * const *value, size_t count);
+                virtual void writev(const bool *value, size_t count);
+                virtual void writev(const uint8_t *value, size_t count);
+                virtual void writev(const int8_t *value, size_t count);
+                virtual void writev(const uint16_t *value, size_t count);
+                virtual void writev(const int16_t *value, size_t count);
+                virtual void writev(const uint32_t *value, size_t count);
+                virtual void writev(const int32_t *value, size_t count);
+                virtual void writev(const uint64_t *value, size_t count);
+                virtual void writev(const int64_t *value, size_t count);
+                virtual void writev(const float *value, size_t count);
+                virtual void writev(const double *value, size_t count);
+
+                virtual void writev(const char *name, const void * const *value, size_t count);
+                virtual void writev(const char *name, const bool *value, size_t count);
+                virtual void writev(const char *name, const uint8_t *value, size_t count);
+                virtual void writev(const char *name, const int8_t *value, size_t count);
+                virtual void writev(const char *name, const uint16_t *value, size_t count);
+                virtual void writev(const char *name, const int16_t *value, size_t count);
+                virtual void writev(const char *name, const uint32_t *value, size_t count);
+                virtual void writev(const char *name, const int32_t *value, size_t count);
+                virtual void writev(const char *name, const uint64_t *value, size_t count);
+                virtual void writev(const char *name, const int64_t *value, size_t count);
+                virtual void writev(const char *name, const float *value, size_t count);
+                virtual void writev(const char *name, const double *value, size_t count);
+        };
+    } /* namespace dspu */
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_UTIL_BINARYSTATEDUMPER_H_ */
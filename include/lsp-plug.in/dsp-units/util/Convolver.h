@@ -24,9 +24,14 @@
 
 #include <lsp-plug.in/dsp-units/version.h>
 #include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/dsp-units/misc/memory.h>
+#include <lsp-plug.in/dsp-units/util/PerfCounter.h>
+#include <lsp-plug.in/dsp-units/util/ConvolverCache.h>
+#include <lsp-plug.in/common/atomic.h>
 
 #define CONVOLVER_RANK_MIN          8                               /* buffer of 256 samples (128 effective)    */
 #define CONVOLVER_RANK_MAX          16                              /* buffer of 8192 samples (4096 effective)  */
+#define CONVOLVER_SYNC_BLOCKS       2                               /* number of tail blocks processed by the caller in background mode */
 
 namespace lsp
 {
@@ -38,13 +43,18 @@ namespace lsp
                 Convolver & operator = (const Convolver &);
                 Convolver(const Convolver &);
 
+            protected:
+                class TailThread;
+
             private:
                 float          *vDataBuffer;            // Buffer for storing convolution tail data
                 float          *vFrame;                 // Pointer to the beginning of the input data frame
                 float          *vConvBuffer;            // Convolution buffer to perform convolution
                 float          *vTaskData;              // Task data for tail convolution
+                float          *vBlockData;             // Decoded spectrum of the block stored in reduced precision
                 float          *vConvData;              // FFT convolution data
                 float          *vDirectData;            // Direct convolution data
+                const uint32_t *vActive;                // Indices of non-silent constant-size blocks
 
                 size_t          nDataBufferSize;        // Size of data buffer
                 size_t          nDirectSize;            // Size of direct convolution data
@@ -53,13 +63,35 @@ namespace lsp
                 size_t          nConvSize;              // The actual convolution size in samples
                 size_t          nLevels;                // Number of raising convolution levels
                 size_t          nBlocks;                // Number of constant-size blocks
-                size_t          nBlocksDone;            // Number of applied constant-size blocks
+                size_t          nBlocksDone;            // Number of applied non-silent constant-size blocks
+                size_t          nActive;                // Number of non-silent constant-size blocks
+                size_t          nSyncActive;            // Number of non-silent constant-size blocks processed by the caller
+                size_t          nLevelMask;             // Bit mask of non-silent raising levels
+                bool            bDirect;                // Direct convolution data is non-silent
                 size_t          nRank;                  // The actual rank of the convolution
                 size_t          nBlkInit;               // Initial number of blocks to apply at step # 0
                 float           fBlkCoef;               // The actual coefficient to compute proper block number per formula
+                size_t          nSyncBlocks;            // Number of constant-size blocks processed by the caller
+
+                convolver_spectrum_t *pSpectrum;        // Spectrum of impulse response
+                ConvolverCache *pCache;                 // Cache that holds the spectrum, NULL if the spectrum is owned
+                TailThread     *pTail;                  // Background thread for tail processing
+                float          *vTailTask[2];           // Task data of background jobs
+                float          *vTailData[2];           // Results of background jobs
+                float          *vTailBuffer;            // Convolution buffer of the background thread
+                float          *vTailBlock;             // Decoded spectrum of the block for the background thread
+                atomic_t        nTailReq;               // Number of submitted background jobs
+                atomic_t        nTailDone;              // Number of completed background jobs
+                PerfCounter     sPerf;                  // Performance counters
 
                 uint8_t        *vData;                  // Non-aligned pointer to the whole allocated data
 
+            protected:
+                void            reset_state();
+                void            process_tail(size_t job);
+                void            stop_tail();
+                static void     release_spectrum(ConvolverCache *cache, convolver_spectrum_t *spectrum);
+
             public:
                 explicit Convolver();
                 ~Convolver();
@@ -85,6 +117,46 @@ namespace lsp
                  */
                 bool init(const float *data, size_t count, size_t rank, float phase);
 
+                /** Initialize convolver
+                 *
+                 * @param data convolution data
+                 * @param count number of samples in convolution
+                 * @param rank convolution rank
+                 * @param background process the constant-size tail blocks except first
+                 *   CONVOLVER_SYNC_BLOCKS ones in the background thread, so the cost of
+                 *   process() call does not depend on the length of convolution
+                 * @return true on success
+                 */
+                bool init(const float *data, size_t count, size_t rank, float phase, bool background);
+
+                /** Initialize convolver
+                 *
+                 * @param data convolution data
+                 * @param count number of samples in convolution
+                 * @param rank convolution rank
+                 * @param background process the tail of convolution in the background thread
+                 * @param cache the cache to share the spectrum of impulse response with other
+                 *   convolvers, for example ConvolverCache::global(), NULL for private spectrum
+                 * @return true on success
+                 */
+                bool init(const float *data, size_t count, size_t rank, float phase, bool background, ConvolverCache *cache);
+
+                /** Initialize convolver
+                 *
+                 * @param data convolution data
+                 * @param count number of samples in convolution
+                 * @param rank convolution rank
+                 * @param background process the tail of convolution in the background thread
+                 * @param cache the cache to share the spectrum of impulse response with other
+                 *   convolvers, NULL for private spectrum
+                 * @param precision storage precision of the constant-size tail blocks, the reduced
+                 *   precision halves the memory used by the tail and adds the error to the tail
+                 *   of convolution, see convolver_precision_t
+                 * @return true on success
+                 */
+                bool init(const float *data, size_t count, size_t rank, float phase, bool background,
+                    ConvolverCache *cache, convolver_precision_t precision);
+
                 /** Process samples
                  *
                  * @param dst destination buffer
@@ -105,6 +177,35 @@ namespace lsp
                  */
                 inline size_t rank() const                  { return nRank;         }
 
+                /**
+                 * Get the latency of the convolver. The first CONVOLVER_RANK_MIN/2 taps
+                 * are applied in the time domain (or as part of the whole block of the same
+                 * size), each next partition of the impulse response starts not earlier than
+                 * its size, so the output is never delayed relative to the input
+                 * @return latency of the convolver in samples, always zero
+                 */
+                inline size_t latency() const               { return 0;             }
+
+                /**
+                 * Check that the tail of convolution is processed in the background thread
+                 * @return true if the tail of convolution is processed in the background thread
+                 */
+                inline bool background() const              { return pTail != NULL; }
+
+                /**
+                 * Get performance counters, they are updated only when the library
+                 * is built with LSP_DSP_UNITS_PERF_COUNTERS defined
+                 * @return performance counters
+                 */
+                inline const PerfCounter *perf() const             { return &sPerf; }
+
+                /**
+                 * Add the memory footprint of the convolver to the report, the spectrum
+                 * shared by the cache is not accounted
+                 * @param r report to update
+                 */
+                void memory_usage(memory_report_t *r) const;
+
                 /**
                  * Dump internal state
                  * @param v state dumper
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_UTIL_CONVOLVERCACHE_H_
+#define LSP_PLUG_IN_DSP_UNITS_UTIL_CONVOLVERCACHE_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/ipc/Mutex.h>
+#include <lsp-plug.in/lltl/parray.h>
+
+#define CONVOLVER_SILENCE_LEVEL     1e-14f      /* energy of silent partition relative to the whole impulse response (-140 dB) */
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Storage precision of the constant-size tail blocks of the spectrum. The direct part
+         * and the raising levels are always stored in full precision. Reduced precision halves
+         * the memory footprint and the memory bandwidth of the tail at the cost of the error
+         * added to the tail of the convolution:
+         *   - CONVOLVER_FLOAT16 keeps 11 significant bits, each block is normalized before
+         *     conversion, the error of the tail is below -66 dB;
+         *   - CONVOLVER_BFLOAT16 keeps 8 significant bits, the error of the tail is below -48 dB.
+         */
+        enum convolver_precision_t
+        {
+            CONVOLVER_FLOAT32,
+            CONVOLVER_FLOAT16,
+            CONVOLVER_BFLOAT16
+        };
+
+        /**
+         * Partitioned spectrum of the impulse response, is read-only after creation
+         */
+        typedef struct convolver_spectrum_t
+        {
+            uint64_t        nHash;                  // Hash of the impulse response
+            size_t          nCount;                 // Size of the impulse response in samples
+            size_t          nRank;                  // Rank of the convolution
+            size_t          nDirectSize;            // Size of direct convolution data
+            size_t          nLevels;                // Number of raising convolution levels
+            size_t          nBlocks;                // Number of constant-size blocks
+            size_t          nBins;                  // Number of bins of the maximum FFT size
+            size_t          nPrecision;             // Storage precision of constant-size blocks
+            size_t          nActive;                // Number of non-silent constant-size blocks
+            size_t          nLevelMask;             // Bit mask of non-silent raising levels
+            bool            bDirect;                // Direct convolution data is non-silent
+            ssize_t         nRefs;                  // Number of references, protected by the cache lock
+            size_t          nBytes;                 // Number of bytes allocated for the data
+            float          *vConvData;              // FFT convolution data, only direct part and raising levels for reduced precision
+            uint16_t       *vHalfData;              // FFT data of constant-size blocks in reduced precision, NULL for full precision
+            float          *vScale;                 // Scale of each constant-size block in reduced precision
+            float          *vDirectData;            // Direct convolution data
+            uint32_t       *vActive;                // Indices of non-silent constant-size blocks in ascending order
+            uint8_t        *vData;                  // Non-aligned pointer to the allocated data
+        } convolver_spectrum_t;
+
+        /**
+         * Cache of partitioned impulse response spectra keyed by the content of impulse
+         * response and convolution rank. Allows multiple convolvers to share the same
+         * spectrum data read-only. The phase of convolution does not affect the spectrum,
+         * so convolvers with different phases share the same data. All methods are thread safe.
+         */
+        class ConvolverCache
+        {
+            private:
+                ConvolverCache & operator = (const ConvolverCache &);
+                ConvolverCache(const ConvolverCache &);
+
+            private:
+                ipc::Mutex                              sLock;
+                lltl::parray<convolver_spectrum_t>      vItems;
+
+            protected:
+                convolver_spectrum_t   *find(uint64_t hash, size_t count, size_t rank, convolver_precision_t precision);
+
+            public:
+                explicit ConvolverCache();
+                ~ConvolverCache();
+
+            public:
+                /**
+                 * Get the process-wide cache
+                 * @return the process-wide cache
+                 */
+                static ConvolverCache  *global();
+
+                /**
+                 * Create the spectrum that is not bound to any cache
+                 * @param data convolution data
+                 * @param count number of samples in convolution, should be positive
+                 * @param rank convolution rank
+                 * @param precision storage precision of constant-size blocks
+                 * @return pointer to spectrum or NULL if there is no memory
+                 */
+                static convolver_spectrum_t *create(const float *data, size_t count, size_t rank,
+                    convolver_precision_t precision = CONVOLVER_FLOAT32);
+
+                /**
+                 * Get the spectrum of the constant-size block
+                 * @param s spectrum
+                 * @param index index of the constant-size block
+                 * @param buf buffer of 2^(rank+1) samples to decode the reduced precision data
+                 * @return pointer to the spectrum of the block
+                 */
+                static const float     *block(const convolver_spectrum_t *s, size_t index, float *buf);
+
+                /**
+                 * Destroy the spectrum that is not bound to any cache
+                 * @param s spectrum to destroy
+                 */
+                static void             destroy(convolver_spectrum_t *s);
+
+            public:
+                /**
+                 * Acquire the spectrum of impulse response, create it if it is not present in the cache
+                 * @param data convolution data
+                 * @param count number of samples in convolution, should be positive
+                 * @param rank convolution rank
+                 * @param precision storage precision of constant-size blocks
+                 * @return pointer to spectrum or NULL if there is no memory
+                 */
+                convolver_spectrum_t   *acquire(const float *data, size_t count, size_t rank,
+                    convolver_precision_t precision = CONVOLVER_FLOAT32);
+
+                /**
+                 * Release the spectrum, destroy it if there are no more references
+                 * @param s spectrum to release
+                 */
+                void                    release(convolver_spectrum_t *s);
+
+                /**
+                 * Get number of spectra stored in the cache
+                 * @return number of spectra stored in the cache
+                 */
+                size_t                  size();
+        };
+    }
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_UTIL_CONVOLVERCACHE_H_ */
@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_UTIL_CONVOLVERPLANNER_H_
+#define LSP_PLUG_IN_DSP_UNITS_UTIL_CONVOLVERPLANNER_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/dsp-units/util/Convolver.h>
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/runtime/LSPString.h>
+#include <lsp-plug.in/io/Path.h>
+#include <lsp-plug.in/io/IInStream.h>
+#include <lsp-plug.in/io/IOutStream.h>
+
+#define CONVOLVER_PLANNER_RANKS         (CONVOLVER_RANK_MAX - CONVOLVER_RANK_MIN + 1)
+#define CONVOLVER_PLANNER_REPEATS       8       /* number of timing runs per operation, the fastest one is taken */
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Planner of the partition scheme for the Convolver. The schedule of the Convolver
+         * is fully defined by its rank: the direct part, the raising levels up to rank-1
+         * and the constant-size tail blocks of rank. The planner estimates the worst-case
+         * cost of one host block for each rank and selects the cheapest one. The cost of
+         * FFT operations is taken either from the analytic N*log(N) model or from the
+         * timing calibration which can be stored to the file and loaded later to avoid
+         * calibration at each start.
+         */
+        class ConvolverPlanner
+        {
+            private:
+                ConvolverPlanner & operator = (const ConvolverPlanner &);
+                ConvolverPlanner(const ConvolverPlanner &);
+
+            protected:
+                typedef struct cost_t
+                {
+                    float       fParse;                 // Cost of fastconv_parse()
+                    float       fApply;                 // Cost of fastconv_apply()
+                    float       fParseApply;            // Cost of fastconv_parse_apply()
+                } cost_t;
+
+            protected:
+                cost_t          vCost[CONVOLVER_PLANNER_RANKS];
+                bool            bCalibrated;            // Costs are measured
+
+            protected:
+                status_t        save_internal(io::IOutStream *os) const;
+                status_t        load_internal(io::IInStream *is);
+
+            public:
+                explicit ConvolverPlanner();
+                ~ConvolverPlanner();
+
+                /**
+                 * Construct object
+                 */
+                void            construct();
+
+                /**
+                 * Destroy object
+                 */
+                void            destroy();
+
+            public:
+                /**
+                 * Reset costs to the analytic model
+                 */
+                void            reset();
+
+                /**
+                 * Measure the actual cost of FFT operations for each rank on this machine.
+                 * The call takes some time and should not be issued from the audio thread.
+                 *
+                 * @param repeats number of timing runs per operation
+                 * @return status of operation
+                 */
+                status_t        calibrate(size_t repeats = CONVOLVER_PLANNER_REPEATS);
+
+                /**
+                 * Check that the costs were measured or loaded from the file
+                 * @return true if the costs were measured
+                 */
+                inline bool     calibrated() const      { return bCalibrated; }
+
+                /**
+                 * Save calibration data to the file
+                 * @param path path to the file
+                 * @return status of operation
+                 */
+                status_t        save(const char *path) const;
+                status_t        save(const LSPString *path) const;
+                status_t        save(const io::Path *path) const;
+
+                /**
+                 * Load calibration data from the file, on error the current costs are kept
+                 * @param path path to the file
+                 * @return status of operation
+                 */
+                status_t        load(const char *path);
+                status_t        load(const LSPString *path);
+                status_t        load(const io::Path *path);
+
+            public:
+                /**
+                 * Estimate the worst-case cost of one host block for the convolver
+                 *
+                 * @param count number of samples in the impulse response
+                 * @param rank rank of the convolver
+                 * @param block_size size of the host block in samples
+                 * @param background the tail is processed in the background thread
+                 * @return estimated cost, nanoseconds if calibrated, relative units otherwise
+                 */
+                float           estimate(size_t count, size_t rank, size_t block_size, bool background = false) const;
+
+                /**
+                 * Select the rank of convolver with the lowest worst-case cost of one host block
+                 *
+                 * @param count number of samples in the impulse response
+                 * @param block_size size of the host block in samples
+                 * @param background the tail is processed in the background thread
+                 * @return rank of the convolver to pass to Convolver::init()
+                 */
+                size_t          plan(size_t count, size_t block_size, bool background = false) const;
+
+                /**
+                 * Dump internal state
+                 * @param v state dumper
+                 */
+                void            dump(IStateDumper *v) const;
+        };
+    }
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_UTIL_CONVOLVERPLANNER_H_ */
@@ -24,8 +24,16 @@
 
 #include <lsp-plug.in/dsp-units/version.h>
 #include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/dsp-units/util/PerfCounter.h>
 #include <lsp-plug.in/dsp-units/filters/Filter.h>
 #include <lsp-plug.in/dsp-units/filters/Equalizer.h>
+#include <lsp-plug.in/dsp-units/util/ScratchArena.h>
+#include <lsp-plug.in/dsp-units/util/Oversampler.h>
+#include <lsp-plug.in/dsp-units/util/Delay.h>
+
+#define XOVER_DECIM_MAX             8       /* Maximum decimation ratio of the band in multirate mode */
+#define XOVER_DECIM_MARGIN          4.0f    /* Minimum ratio between the Nyquist frequency of the decimated band and its end frequency */
+#define XOVER_DECIM_LATENCY_MAX     ((XOVER_DECIM_MAX - 1) * OS_HALFBAND_TAPS_DFL)
 
 namespace lsp
 {
@@ -74,6 +82,21 @@ namespace lsp
          */
         typedef void (* crossover_func_t)(void *object, void *subject, size_t band, const float *data, size_t first, size_t count);
 
+        /**
+         * Crossover callback function for in-place processing of the band signal before
+         * it is passed to the crossover_func_t handler or written to the output. In the
+         * multirate mode the signal is passed at the decimated sample rate of the band
+         *
+         * @param object the object that handles callback
+         * @param subject the subject that is used to handle callback
+         * @param band number of the band
+         * @param data the band signal to process in place
+         * @param first index of the first sample at the sample rate of the band,
+         *        counted from the start of the processing call
+         * @param count number of samples in the data buffer
+         */
+        typedef void (* crossover_proc_t)(void *object, void *subject, size_t band, float *data, size_t first, size_t count);
+
         /**
          * Crossover filter type
          */
@@ -125,14 +148,28 @@ namespace lsp
                     void               *pObject;        // Bound object
                     void               *pSubject;       // Bound subject
                     size_t              nId;            // Number of the band
+
+                    crossover_proc_t    pProc;          // In-place processor
+                    void               *pProcObject;    // Bound object of the processor
+                    void               *pProcSubject;   // Bound subject of the processor
+
+                    Oversampler        *pOver;          // Decimation and interpolation of the band, NULL if not supported
+                    Delay               sDelay;         // Latency compensation of the band
+                    size_t              nDecim;         // Decimation ratio
+                    size_t              nPending;       // Number of input samples waiting for decimation
+                    size_t              nReady;         // Number of interpolated samples waiting for output
+                    size_t              nFirst;         // Index of the next decimated sample in the processing call
+                    float               vPending[XOVER_DECIM_MAX];  // Input samples waiting for decimation
+                    float               vReady[XOVER_DECIM_MAX];    // Interpolated samples waiting for output
                 } band_t;
 
                 enum reconfigure_t
                 {
                     R_GAIN          = 1 << 0,           // We can reconfigure band gain in softer mode
                     R_SPLIT         = 1 << 1,           // Need to reconfigure filter order
+                    R_RATE          = 1 << 2,           // Need to reconfigure decimation of bands
 
-                    R_ALL           = R_GAIN | R_SPLIT
+                    R_ALL           = R_GAIN | R_SPLIT | R_RATE
                 } reconfigure_t;
 
             protected:
@@ -145,13 +182,25 @@ namespace lsp
                 split_t        *vSplit;         // List of split points
                 split_t       **vPlan;          // Split plan
                 size_t          nPlanSize;      // Size of plan
+                PerfCounter     sPerf;          // Performance counters
 
                 float          *vLpfBuf;        // Buffer for LPF
                 float          *vHpfBuf;        // Buffer for HPF
+                float          *vRateBuf;       // Buffer for decimation and interpolation, NULL if multirate is not supported
+                float          *vDecimBuf;      // Buffer for the decimated band signal
+                Oversampler    *vOver;          // Resamplers of bands, NULL if multirate is not supported
+                size_t          nLatency;       // Latency of the crossover
+                bool            bMultirate;     // Multirate mode
                 uint8_t        *pData;          // Unaligned data
+                ScratchArena   *pArena;         // Arena to borrow LPF and HPF buffers from, NULL for private buffers
 
             protected:
                 inline filter_type_t    select_filter(xover_type_t type, crossover_mode_t mode);
+                size_t                  borrow_buffers();
+                void                    return_buffers(size_t mark);
+                static size_t           band_latency(const band_t *b);
+                void                    configure_rate(band_t *b, size_t decim);
+                void                    process_band(band_t *b, float *buf, size_t first, size_t count);
 
             public:
                 explicit Crossover();
@@ -175,6 +224,27 @@ namespace lsp
                  */
                 bool            init(size_t bands, size_t buf_size);
 
+                /** Initialize crossover
+                 *
+                 * @param bands number of bands
+                 * @param buf_size maximum signal processing buffer size
+                 * @param arena arena to borrow temporary buffers from during the process() call,
+                 *        should be used by the same thread that calls process(), NULL for private buffers
+                 * @return status of operation
+                 */
+                bool            init(size_t bands, size_t buf_size, ScratchArena *arena);
+
+                /** Initialize crossover
+                 *
+                 * @param bands number of bands
+                 * @param buf_size maximum signal processing buffer size
+                 * @param arena arena to borrow temporary buffers from during the process() call,
+                 *        should be used by the same thread that calls process(), NULL for private buffers
+                 * @param multirate allocate resamplers of bands to support the multirate mode
+                 * @return status of operation
+                 */
+                bool            init(size_t bands, size_t buf_size, ScratchArena *arena, bool multirate);
+
             public:
                 /**
                  * Get number of bands
@@ -197,6 +267,51 @@ namespace lsp
                  */
                 inline size_t   max_buffer_size() const                 { return nBufSize;      }
 
+                /**
+                 * Get the arena used for temporary buffers
+                 * @return arena or NULL if buffers are private
+                 */
+                inline ScratchArena    *arena()                         { return pArena;        }
+
+                /**
+                 * Get latency of the crossover, IIR filters do not introduce any latency,
+                 * the latency is introduced by the multirate mode only, may call reconfigure()
+                 * @return latency in samples
+                 */
+                size_t          latency();
+
+                /**
+                 * Enable the multirate mode: the bands that have in-place processors set by
+                 * set_processor() are decimated with the half-band filters of the oversampler
+                 * while the end frequency of the band stays at least XOVER_DECIM_MARGIN times
+                 * below the Nyquist frequency of the decimated signal, the processed signal
+                 * is interpolated back. All bands are delayed to the same latency. Has no
+                 * effect if the crossover was initialized without multirate support
+                 *
+                 * @param enable enable the multirate mode
+                 */
+                void            set_multirate(bool enable);
+
+                /**
+                 * Check that the multirate mode is enabled
+                 * @return true if the multirate mode is enabled
+                 */
+                inline bool     multirate() const                       { return bMultirate;    }
+
+                /**
+                 * Check that the crossover was initialized with multirate support
+                 * @return true if the multirate mode is supported
+                 */
+                inline bool     multirate_supported() const             { return vRateBuf != NULL; }
+
+                /**
+                 * Get decimation ratio of the band, may call reconfigure()
+                 * @param band band number
+                 * @return decimation ratio of the band, 1 means full sample rate,
+                 *         0 means invalid index
+                 */
+                size_t          band_decimation(size_t band);
+
                 /** Set slope of crossover
                  *
                  * @param sp split point number
@@ -293,6 +408,24 @@ namespace lsp
                  */
                 bool            unset_handler(size_t band);
 
+                /**
+                 * Set in-place band signal processor, it is called before the handler
+                 * or before the band signal is written to the output
+                 * @param band band number
+                 * @param func processor function
+                 * @param object object to pass to function
+                 * @param subject subject to pass to function
+                 * @return false if invalid band number has been specified
+                 */
+                bool            set_processor(size_t band, crossover_proc_t func, void *object, void *subject);
+
+                /**
+                 * Unset in-place band signal processor
+                 * @param band band number
+                 * @return false if invalid band number has been specified
+                 */
+                bool            unset_processor(size_t band);
+
                 /** Set sample rate, needs reconfiguration
                  *
                  * @param sr sample rate to set
@@ -347,6 +480,24 @@ namespace lsp
                  */
                 void            process(const float *in, size_t samples);
 
+                /** Process data and write band signals directly to the destination buffers
+                 * without issuing callbacks, automatically calls reconfigure() if the
+                 * reconfiguration is required. Signals of inactive bands are not written.
+                 *
+                 * @param out array of num_bands() destination buffers of at least samples
+                 *        length each, NULL buffer means that the band signal is not needed
+                 * @param in input buffer to process data
+                 * @param samples number of samples to process
+                 */
+                void            process(float * const *out, const float *in, size_t samples);
+
+                /**
+                 * Get performance counters, they are updated only when the library
+                 * is built with LSP_DSP_UNITS_PERF_COUNTERS defined
+                 * @return performance counters
+                 */
+                inline const PerfCounter *perf() const             { return &sPerf; }
+
                 /**
                  * Dump the state
                  * @param dumper dumper
@@ -24,6 +24,8 @@
 
 #include <lsp-plug.in/dsp-units/version.h>
 #include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/dsp-units/misc/memory.h>
+#include <lsp-plug.in/dsp-units/ctl/IdleDetector.h>
 
 namespace lsp
 {
@@ -44,6 +46,7 @@ namespace lsp
                 size_t      nTail;
                 size_t      nDelay;
                 size_t      nSize;
+                IdleDetector    sIdle;
 
             public:
                 explicit Delay();
@@ -152,6 +155,32 @@ namespace lsp
                  */
                 inline size_t delay() const { return nDelay; };
 
+                /** Get the tail length of the delay
+                 *
+                 * @return tail length in samples
+                 */
+                inline size_t tail() const { return nDelay; };
+
+                /** Set threshold of silence for skipping the processing of the idle delay:
+                 * the block process() calls stop moving data once the input has been silent
+                 * for the delay length and output silence until the non-silent input arrives
+                 *
+                 * @param threshold absolute threshold of silence, non-positive value disables the skip
+                 */
+                inline void set_idle_threshold(float threshold) { sIdle.set_threshold(threshold); }
+
+                /** Check that the delay is idle and skips the processing
+                 *
+                 * @return true if the delay is idle
+                 */
+                inline bool idle() const { return sIdle.idle(); }
+
+                /**
+                 * Add the memory footprint of the delay to the report
+                 * @param r report to update
+                 */
+                void memory_usage(memory_report_t *r) const;
+
                 /**
                  * Dump internal state
                  * @param v state dumper
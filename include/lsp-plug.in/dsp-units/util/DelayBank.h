@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_UTIL_DELAYBANK_H_
+#define LSP_PLUG_IN_DSP_UNITS_UTIL_DELAYBANK_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Bank of delay lines for the latency compensation: ring buffers of all channels
+         * are stored in one allocation one after another and share the write position,
+         * each channel has it's own delay. Changes of the delay are ramped over the next
+         * process() call the same way as Delay::process_ramping() does.
+         */
+        class DelayBank
+        {
+            private:
+                DelayBank & operator = (const DelayBank &);
+                DelayBank(const DelayBank &);
+
+            protected:
+                typedef struct channel_t
+                {
+                    size_t      nDelay;         // Current delay
+                    size_t      nNewDelay;      // Delay to ramp to
+                } channel_t;
+
+            protected:
+                float      *vBuffer;        // Ring buffers of all channels
+                channel_t  *vChannels;      // List of channels
+                size_t      nChannels;      // Number of channels
+                size_t      nHead;          // Write position
+                size_t      nSize;          // Size of the ring buffer of one channel
+                size_t      nMaxDelay;      // Maximum delay
+                uint8_t    *pData;          // Allocated data
+
+            public:
+                explicit DelayBank();
+                ~DelayBank();
+
+                /**
+                 * Construct the object
+                 */
+                void        construct();
+
+                /**
+                 * Destroy the object
+                 */
+                void        destroy();
+
+            public:
+                /** Initialize delay bank
+                 *
+                 * @param channels number of channels
+                 * @param max_delay maximum delay of the channel in samples
+                 * @return status of operation
+                 */
+                bool        init(size_t channels, size_t max_delay);
+
+                /**
+                 * Get number of channels
+                 * @return number of channels
+                 */
+                inline size_t   channels() const        { return nChannels;     }
+
+                /**
+                 * Get maximum delay of the channel
+                 * @return maximum delay of the channel in samples
+                 */
+                inline size_t   max_delay() const       { return nMaxDelay;     }
+
+                /** Set delay of the channel
+                 *
+                 * @param channel channel number
+                 * @param delay delay in samples, limited by the maximum delay
+                 * @param ramp ramp the delay from the previous value during the next
+                 *   process() call, otherwise apply the delay immediately
+                 */
+                void        set_delay(size_t channel, size_t delay, bool ramp = true);
+
+                /** Get delay of the channel
+                 *
+                 * @param channel channel number
+                 * @return delay of the channel in samples
+                 */
+                size_t      get_delay(size_t channel) const;
+
+                /** Process all channels
+                 *
+                 * @param dst list of channels() destination buffers, may be the same as source buffers,
+                 *   any element may be NULL
+                 * @param src list of channels() source buffers, NULL element means silence
+                 * @param count number of samples to process
+                 */
+                void        process(float * const *dst, const float * const *src, size_t count);
+
+                /** Clear internal delay buffers
+                 *
+                 */
+                void        clear();
+
+                /**
+                 * Dump internal state
+                 * @param v state dumper
+                 */
+                void        dump(IStateDumper *v) const;
+        };
+    }
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_UTIL_DELAYBANK_H_ */
@@ -67,6 +67,8 @@ namespace lsp
                     ssize_t         nSamples;       // Fade length in samples
                     ssize_t         nDelay;         // Protection delay
                     float           fPoly[4];       // Fade polynom
+                    float          *vCurve;         // Precomputed fade curve
+                    ssize_t         nCurve;         // Number of precomputed samples of the fade curve
                 } fade_t;
 
             protected:
@@ -74,17 +76,16 @@ namespace lsp
                 state_t         nState;             // Fade state
 
                 float           fLookMax;           // Maximum lookahead value
-                ssize_t         nLookMin;           // Minimum lookahead offset
-                ssize_t         nLookMax;           // Maximum lookahead offset
-                ssize_t         nLookOff;           // Current lookahead offset
+                ssize_t         nLookMax;           // Size of the gain ring buffer
+                ssize_t         nLookOff;           // Current write position in the gain ring buffer
                 ssize_t         nLookCount;         // Number of lookahead samples
+                ssize_t         nCurveMax;          // Maximum number of precomputed fade curve samples
 
                 // Signal envelope computing
                 float           fRmsMax;            // Maximum permitted RMS period
                 float           fRmsLength;         // RMS estimation period
-                ssize_t         nRmsMin;            // Minimum rms offset
-                ssize_t         nRmsMax;            // Maximum rms offset
-                ssize_t         nRmsOff;            // Current rms offset
+                ssize_t         nRmsMax;            // Size of the rms ring buffer
+                ssize_t         nRmsOff;            // Current write position in the rms ring buffer
                 ssize_t         nRmsLen;            // Number of rms samples
                 float           fRmsNorm;           // Norming coefficient
 
@@ -98,18 +99,21 @@ namespace lsp
                 fade_t          sFadeOut;
 
                 // Buffers
-                float          *pGainBuf;           // Gain buffer
-                float          *pRmsBuf;            // Rms estimation buffer
+                float          *pGainBuf;           // Gain ring buffer
+                float          *pRmsBuf;            // Rms estimation ring buffer of squared samples
                 uint8_t        *pData;
 
                 // Reconfiguration
                 bool            bReconfigure;       // Reconfiguration flag
 
             protected:
-                float           calc_rms(float s);
-                float           crossfade(fade_t *fade, float x);
+                void            calc_rms(float *env, const float *src, size_t count);
+                float           rms_sum() const;
+                float           crossfade(const fade_t *fade, float x);
+                void            fade_curve(float *dst, const fade_t *fade, ssize_t x, size_t count);
                 void            calc_fade(fade_t *fade, bool in);
-                void            apply_fadeout(float *dst, ssize_t samples);
+                void            apply_fadeout(size_t pos, ssize_t samples);
+                size_t          process_state(size_t pos, const float *env, size_t count);
 
                 static void     dump_fade(IStateDumper *v, const char *name, const fade_t *fade);
 
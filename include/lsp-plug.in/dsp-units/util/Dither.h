@@ -26,10 +26,28 @@
 #include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
 #include <lsp-plug.in/dsp-units/util/Randomizer.h>
 
+#define DITHER_SHAPE_ORDER      3   /* Maximum order of the noise-shaping filter */
+
 namespace lsp
 {
     namespace dspu
     {
+        /**
+         * Noise-shaping curve of the dither. Noise shaping is implemented with
+         * the error-feedback filter: the signal is quantized to the specified number
+         * of bits and the quantization error is fed back through the filter, so the
+         * noise transfer function is 1 - h1*z^-1 - h2*z^-2 - h3*z^-3
+         */
+        enum dither_shape_t
+        {
+            DITHER_FLAT,                // No noise shaping, TPDF noise is added to the signal
+            DITHER_FIRST_ORDER,         // (1 - z^-1), +6 dB/octave
+            DITHER_SECOND_ORDER,        // (1 - z^-1)^2, +12 dB/octave
+            DITHER_F_WEIGHTED,          // Three-tap F-weighted curve by Wannamaker
+
+            DITHER_SHAPE_TOTAL
+        };
+
         /**
          * Dither class: generates dither noise with specified characteristics
          */
@@ -43,6 +61,8 @@ namespace lsp
                 size_t      nBits;
                 float       fGain;
                 float       fDelta;
+                dither_shape_t  enShape;
+                float       vError[DITHER_SHAPE_ORDER];     // History of the quantization error
                 Randomizer  sRandom;
 
             public:
@@ -60,12 +80,40 @@ namespace lsp
                  */
                 inline void init() { sRandom.init(); };
 
+                /** Initialize dither with the counter-based random generator,
+                 * dithers with different stream identifiers produce uncorrelated noise
+                 *
+                 * @param seed seed
+                 * @param stream stream identifier
+                 */
+                inline void init(uint32_t seed, uint32_t stream) { sRandom.init_counter(seed, stream); };
+
+                /** Get coefficients of the error-feedback filter
+                 *
+                 * @param shape noise-shaping curve
+                 * @return pointer to DITHER_SHAPE_ORDER coefficients h1, h2, h3
+                 */
+                static const float *shape_filter(dither_shape_t shape);
+
                 /** Set number of bits per sample
                  *
                  * @param bits number of bits per sample
                  */
                 void set_bits(size_t bits);
 
+                /** Set noise-shaping curve, the history of the quantization error is reset.
+                 * Any curve except DITHER_FLAT quantizes the output to the number of bits
+                 *
+                 * @param shape noise-shaping curve
+                 */
+                void set_shape(dither_shape_t shape);
+
+                /** Get noise-shaping curve
+                 *
+                 * @return noise-shaping curve
+                 */
+                inline dither_shape_t shape() const { return enShape; }
+
                 /** Process signal
                  *
                  * @param out output signal
@@ -26,10 +26,23 @@
 #include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
 #include <lsp-plug.in/common/status.h>
 
+#define DYNAMIC_DELAY_GUARD         4   /* Number of samples mirrored after the end of the buffer */
+
 namespace lsp
 {
     namespace dspu
     {
+        /**
+         * Interpolation of fractional delay values
+         */
+        enum dynamic_delay_interp_t
+        {
+            DDI_NONE,           //!< DDI_NONE delay is truncated to integer number of samples
+            DDI_LINEAR,         //!< DDI_LINEAR linear interpolation between two samples
+            DDI_HERMITE,        //!< DDI_HERMITE cubic Hermite interpolation over four samples
+            DDI_ALLPASS         //!< DDI_ALLPASS first-order Thiran allpass interpolation
+        };
+
         /**
          * Dynamic Delay: Delay with varying in time delay, gain and feedback gain
          */
@@ -40,12 +53,28 @@ namespace lsp
                 DynamicDelay(const DynamicDelay &);
 
             protected:
-                float      *vDelay;
+                float      *vDelay;         // Delay buffers of all channels, first DYNAMIC_DELAY_GUARD samples are mirrored after the end
+                float      *vApState;       // State of the allpass interpolator for each channel
+                size_t      nChannels;      // Number of channels
+                size_t      nStride;        // Distance between delay buffers of channels
                 size_t      nHead;
                 size_t      nCapacity;
                 ssize_t     nMaxDelay;
+                size_t      nInterp;        // Interpolation mode
                 uint8_t    *pData;
 
+            protected:
+                inline void write(float *buf, size_t idx, float value);
+                void        process_modulated(float *buf, float *ap, size_t head, float *out, const float *in,
+                                    const float *delay, const float *fgain, const float *fdelay,
+                                    size_t samples);
+                void        process_fractional(float *buf, float *ap, size_t head, float *out, const float *in,
+                                    const float *delay, const float *fgain, const float *fdelay,
+                                    size_t samples);
+                void        process_constant(float *buf, float *ap, size_t head, float *out, const float *in,
+                                    float delay, float fgain, float fdelay,
+                                    size_t samples);
+
             public:
                 explicit DynamicDelay();
                 ~DynamicDelay();
@@ -66,18 +95,38 @@ namespace lsp
                  */
                 inline size_t capacity() const      { return nCapacity;     }
 
+                /**
+                 * Obtain the number of channels
+                 * @return number of channels
+                 */
+                inline size_t channels() const      { return nChannels;     }
+
                 /**
                  * Initialize delay
                  * @param max_size maximum delay size
+                 * @param channels number of channels sharing the write position
                  * @return status of operation
                  */
-                status_t    init(size_t max_size);
+                status_t    init(size_t max_size, size_t channels = 1);
+
+                /**
+                 * Set interpolation mode of fractional delay values
+                 * @param mode interpolation mode
+                 */
+                void        set_interpolation(dynamic_delay_interp_t mode);
+
+                /**
+                 * Get interpolation mode of fractional delay values
+                 * @return interpolation mode
+                 */
+                inline dynamic_delay_interp_t get_interpolation() const { return dynamic_delay_interp_t(nInterp); }
 
                 /**
                  * Process the signal using dynamic settings of delay and feedback
                  * @param out output buffer
                  * @param in input buffer
-                 * @param delay the delay values
+                 * @param delay the delay values, fractional part is used
+                 *        if the interpolation mode is other than DDI_NONE
                  * @param fback feedback gain values
                  * @param fdelay feedback delay values
                  * @param samples number of samples to process
@@ -86,6 +135,49 @@ namespace lsp
                                     const float *delay, const float *fgain, const float *fdelay,
                                     size_t samples);
 
+                /**
+                 * Process the signal using constant settings of delay and feedback,
+                 * for the integer delay the data is processed by blocks
+                 * @param out output buffer
+                 * @param in input buffer
+                 * @param delay the delay value, fractional part is used
+                 *        if the interpolation mode is other than DDI_NONE
+                 * @param fgain feedback gain
+                 * @param fdelay feedback delay
+                 * @param samples number of samples to process
+                 */
+                void        process(float *out, const float *in,
+                                    float delay, float fgain, float fdelay,
+                                    size_t samples);
+
+                /**
+                 * Process all channels using dynamic settings of delay and feedback
+                 * @param out list of channels() output buffers
+                 * @param in list of channels() input buffers
+                 * @param delay the delay values, fractional part is used
+                 *        if the interpolation mode is other than DDI_NONE
+                 * @param fgain feedback gain values
+                 * @param fdelay feedback delay values
+                 * @param samples number of samples to process
+                 */
+                void        process(float * const *out, const float * const *in,
+                                    const float *delay, const float *fgain, const float *fdelay,
+                                    size_t samples);
+
+                /**
+                 * Process all channels using constant settings of delay and feedback
+                 * @param out list of channels() output buffers
+                 * @param in list of channels() input buffers
+                 * @param delay the delay value, fractional part is used
+                 *        if the interpolation mode is other than DDI_NONE
+                 * @param fgain feedback gain
+                 * @param fdelay feedback delay
+                 * @param samples number of samples to process
+                 */
+                void        process(float * const *out, const float * const *in,
+                                    float delay, float fgain, float fdelay,
+                                    size_t samples);
+
                 /**
                  * Clear delay state
                  */
@@ -0,0 +1,266 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_UTIL_FDNREVERB_H_
+#define LSP_PLUG_IN_DSP_UNITS_UTIL_FDNREVERB_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/dsp-units/noise/Velvet.h>
+#include <lsp-plug.in/dsp-units/util/DynamicDelay.h>
+#include <lsp-plug.in/common/status.h>
+
+#define FDN_LINES_MIN           8       /* Minimum number of delay lines */
+#define FDN_LINES_MAX           16      /* Maximum number of delay lines */
+#define FDN_BLOCK               64      /* Maximum number of frames processed per one pass */
+#define FDN_DIFFUSION_MAX       0x1000  /* Maximum length of the velvet diffusion kernel in samples */
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Feedback matrix of the delay network
+         */
+        enum fdn_matrix_t
+        {
+            FDN_HADAMARD,       //!< FDN_HADAMARD normalized Hadamard matrix, computed by butterflies
+            FDN_HOUSEHOLDER     //!< FDN_HOUSEHOLDER Householder reflection I - 2/N * 1*1^T
+        };
+
+        /**
+         * Feedback delay network reverb. All delay lines share one interleaved buffer: each
+         * frame holds one sample of every line, so the mixed frame is written at once and the
+         * per-line operations (interpolated read, absorption biquad, feedback matrix) are
+         * done over the contiguous lanes of the frame. The frames are processed by blocks not
+         * longer than the shortest delay, so all reads of the block refer to frames written
+         * before and each stage runs over the whole block.
+         *
+         * Each line has its own biquad absorption filter with the gain matched to its length
+         * and the decay time, the lines can be modulated by sine LFOs with the fractional read
+         * interpolated the same way as DynamicDelay does. The input can be diffused by the
+         * sparse velvet noise kernel before it enters the network. The output is wet only.
+         */
+        class FDNReverb
+        {
+            private:
+                FDNReverb & operator = (const FDNReverb &);
+                FDNReverb(const FDNReverb &);
+
+            protected:
+                Velvet          sVelvet;                        // Generator of the diffusion kernel
+
+                float          *vBuffer;                        // Interleaved delay lines: nCapacity frames of nLines samples
+                float          *vTaps;                          // Interleaved taps of the block: FDN_BLOCK frames of nLines samples
+                float          *vInput;                         // Diffused input of the block
+                float          *vDiffBuf;                       // Overlap-add buffer of the diffusion
+                float          *vDiffValue;                     // Amplitudes of the diffusion impulses
+                uint32_t       *vDiffPos;                       // Positions of the diffusion impulses
+                size_t          nDiffImpulses;                  // Number of diffusion impulses, 0 disables diffusion
+                size_t          nDiffLength;                    // Length of the diffusion kernel in samples
+
+                size_t          nLines;                         // Number of delay lines
+                size_t          nCapacity;                      // Capacity of the buffer in frames, power of 2
+                size_t          nMaxDelay;                      // Maximum delay in samples
+                size_t          nHead;                          // Position of the next frame to write
+                size_t          nBlock;                         // Number of frames processed per one pass
+                size_t          nSampleRate;                    // Sample rate
+                fdn_matrix_t    enMatrix;                       // Feedback matrix
+                dynamic_delay_interp_t  enInterp;               // Interpolation of modulated reads
+
+                float           fSize;                          // Length of the longest line [ms]
+                float           fDecay;                         // Decay time RT60 at low frequencies [s]
+                float           fDamping;                       // Ratio of the high-frequency decay time to the low-frequency one
+                float           fModDepth;                      // Modulation depth [ms]
+                float           fModRate;                       // Modulation rate [Hz]
+                float           fDiffusion;                     // Length of the diffusion kernel [ms]
+                float           fDepth;                         // Modulation depth [samples]
+                float           fLfoCos;                        // Rotation of the LFO phasor per sample, cosine
+                float           fLfoSin;                        // Rotation of the LFO phasor per sample, sine
+
+                float           vDelay[FDN_LINES_MAX];          // Nominal delay of lines [samples]
+                float           vInGain[FDN_LINES_MAX];         // Gain of the input signal for each line
+                float           vOutGain[2][FDN_LINES_MAX];     // Gain of each line for the left and right outputs
+                float           vB0[FDN_LINES_MAX];             // Absorption biquads, lane-parallel coefficients
+                float           vB1[FDN_LINES_MAX];
+                float           vB2[FDN_LINES_MAX];
+                float           vA1[FDN_LINES_MAX];
+                float           vA2[FDN_LINES_MAX];
+                float           vD0[FDN_LINES_MAX];             // Absorption biquads, lane-parallel state
+                float           vD1[FDN_LINES_MAX];
+                float           vApState[FDN_LINES_MAX];        // State of the allpass interpolator of each line
+                float           vLfoRe[FDN_LINES_MAX];          // LFO phasor of each line, real part
+                float           vLfoIm[FDN_LINES_MAX];          // LFO phasor of each line, imaginary part
+
+                uint8_t        *pData;                          // Allocated data
+                bool            bSync;                          // Settings need update
+
+            protected:
+                void            read_taps(size_t frames);
+                void            absorb(size_t frames);
+                void            emit(float *left, float *right, size_t frames);
+                void            mix(size_t frames);
+                void            write_frames(const float *in, size_t frames);
+                void            diffuse(const float *in, size_t samples);
+                void            reset_lfo();
+                static bool     is_prime(size_t n);
+
+            public:
+                explicit FDNReverb();
+                ~FDNReverb();
+
+                /**
+                 * Construct the object
+                 */
+                void            construct();
+
+                /**
+                 * Destroy the object
+                 */
+                void            destroy();
+
+                /**
+                 * Initialize reverb
+                 * @param lines number of delay lines, rounded up to FDN_LINES_MIN or FDN_LINES_MAX
+                 * @param max_delay maximum delay of one line in samples
+                 * @return status of operation
+                 */
+                status_t        init(size_t lines, size_t max_delay);
+
+            public:
+                /** Check that reverb needs settings update
+                 *
+                 * @return true if reverb needs settings update
+                 */
+                inline bool     needs_update() const                { return bSync;         }
+
+                /** Update settings, computes delays, absorption filters and the diffusion kernel,
+                 * does not allocate memory
+                 *
+                 */
+                void            update_settings();
+
+                /** Set sample rate
+                 *
+                 * @param sr sample rate
+                 */
+                void            set_sample_rate(size_t sr);
+
+                /** Set the length of the longest delay line, other lines are distributed
+                 * logarithmically down to half of this length and have mutually prime lengths
+                 *
+                 * @param size length of the longest delay line in milliseconds
+                 */
+                void            set_size(float size);
+
+                /** Set the decay time
+                 *
+                 * @param decay time of decay by 60 dB at low frequencies in seconds
+                 */
+                void            set_decay(float decay);
+
+                /** Set the damping of high frequencies
+                 *
+                 * @param damping ratio of the decay time at the Nyquist frequency to the decay
+                 *   time at low frequencies, 1 disables damping
+                 */
+                void            set_damping(float damping);
+
+                /** Set the modulation of delay lines
+                 *
+                 * @param depth modulation depth in milliseconds, 0 disables modulation
+                 * @param rate modulation rate in Hz
+                 */
+                void            set_modulation(float depth, float rate);
+
+                /** Set the length of velvet noise diffusion of the input
+                 *
+                 * @param length length of the diffusion kernel in milliseconds, 0 disables diffusion
+                 */
+                void            set_diffusion(float length);
+
+                /** Set feedback matrix
+                 *
+                 * @param matrix feedback matrix
+                 */
+                void            set_matrix(fdn_matrix_t matrix);
+
+                /** Set interpolation of the modulated reads
+                 *
+                 * @param interp interpolation mode
+                 */
+                void            set_interpolation(dynamic_delay_interp_t interp);
+
+                /** Get number of delay lines
+                 *
+                 * @return number of delay lines
+                 */
+                inline size_t   lines() const                       { return nLines;        }
+
+                /** Get the nominal delay of the line
+                 *
+                 * @param line index of the line
+                 * @return delay of the line in samples, valid after update_settings()
+                 */
+                inline float    line_delay(size_t line) const       { return (line < nLines) ? vDelay[line] : 0.0f; }
+
+                /** Get the absorption gain of the line at zero frequency
+                 *
+                 * @param line index of the line
+                 * @return gain of the absorption filter at zero frequency
+                 */
+                float           line_gain(size_t line) const;
+
+                /** Process the signal, the output is wet only
+                 *
+                 * @param left left output
+                 * @param right right output, may be NULL for mono output
+                 * @param in input signal, may be NULL for silence
+                 * @param samples number of samples to process
+                 */
+                void            process(float *left, float *right, const float *in, size_t samples);
+
+                /** Process the signal to mono output, the output is wet only
+                 *
+                 * @param out output signal
+                 * @param in input signal, may be NULL for silence
+                 * @param samples number of samples to process
+                 */
+                inline void     process(float *out, const float *in, size_t samples)
+                {
+                    process(out, NULL, in, samples);
+                }
+
+                /** Clear the state of the reverb
+                 *
+                 */
+                void            clear();
+
+                /**
+                 * Dump internal state
+                 * @param v state dumper
+                 */
+                void            dump(IStateDumper *v) const;
+        };
+    }
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_UTIL_FDNREVERB_H_ */
@@ -0,0 +1,295 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_UTIL_FFTCROSSOVER_H_
+#define LSP_PLUG_IN_DSP_UNITS_UTIL_FFTCROSSOVER_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/dsp-units/util/Crossover.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /** Linear-phase crossover, splits signal into bands in frequency domain.
+         * The input signal is processed by blocks of the half FFT size: each block
+         * is transformed by one direct FFT, multiplied by the spectrum of the linear-phase
+         * kernel of each band and transformed back by one reverse FFT per band.
+         * The kernels are computed from complementary magnitude responses, so the sum
+         * of all unprocessed bands is the input signal delayed by latency() samples.
+         */
+        class FFTCrossover
+        {
+            private:
+                FFTCrossover & operator = (const FFTCrossover &);
+                FFTCrossover(const FFTCrossover &);
+
+            protected:
+                typedef struct split_t
+                {
+                    size_t              nBandId;        // Number of split point
+                    size_t              nSlope;         // Filter slope (0 = off)
+                    float               fFreq;          // Frequency
+                } split_t;
+
+                typedef struct band_t
+                {
+                    float               fGain;          // Output gain of the band
+                    float               fStart;         // Start frequency of the band
+                    float               fEnd;           // End frequency of the band
+                    bool                bEnabled;       // Enabled flag
+                    split_t            *pStart;         // Pointer to starting split point
+                    split_t            *pEnd;           // Pointer to ending split point
+
+                    float              *vKernel;        // Spectrum of the band kernel (packed complex)
+                    float              *vOut;           // Overlap-add output buffer
+
+                    crossover_func_t    pFunc;          // Function
+                    void               *pObject;        // Bound object
+                    void               *pSubject;       // Bound subject
+                    size_t              nId;            // Number of the band
+                } band_t;
+
+            protected:
+                bool            bReconfigure;   // Change flag
+                size_t          nSplits;        // Number of splits
+                size_t          nRank;          // FFT rank
+                size_t          nSampleRate;    // Sample rate
+                size_t          nOffset;        // Offset in the input block
+
+                band_t         *vBands;         // List of bands
+                split_t        *vSplit;         // List of split points
+                split_t       **vPlan;          // Split plan
+                size_t          nPlanSize;      // Size of plan
+
+                float          *vInBuf;         // Input block buffer
+                float          *vFft;           // Spectrum of the input block
+                float          *vTemp;          // Temporary buffer for processing
+                float          *vWnd;           // Kernel window
+                uint8_t        *pData;          // Unaligned data
+
+            protected:
+                static float    lpf_response(const split_t *sp, float f);
+                float           band_response(const band_t *b, float f);
+                void            build_kernel(band_t *b);
+                void            process_block();
+
+            public:
+                explicit FFTCrossover();
+                ~FFTCrossover();
+
+                /** Construct crossover
+                 *
+                 */
+                void            construct();
+
+                /** Destroy crossover
+                 *
+                 */
+                void            destroy();
+
+                /** Initialize crossover
+                 *
+                 * @param bands number of bands
+                 * @param rank FFT rank, the processing block is half of the FFT size
+                 * @return status of operation
+                 */
+                bool            init(size_t bands, size_t rank);
+
+            public:
+                /**
+                 * Get number of bands
+                 * @return number of bands
+                 */
+                inline size_t   num_bands() const                       { return nSplits+1;     }
+
+                /**
+                 * Get number of split points
+                 * @return number of split points
+                 */
+                inline size_t   num_splits() const                      { return nSplits;       }
+
+                /**
+                 * Get FFT rank of the crossover
+                 * @return FFT rank
+                 */
+                inline size_t   rank() const                            { return nRank;         }
+
+                /**
+                 * Get latency of the crossover: the delay of the input signal in
+                 * the output band signals
+                 * @return latency in samples
+                 */
+                inline size_t   latency() const                         { return (3 << nRank) >> 2; }
+
+                /** Set slope of crossover
+                 *
+                 * @param sp split point number
+                 * @param slope slope of crossover filters, the magnitude response matches
+                 *        the magnitude response of the Linkwitz-Riley filter of the same slope
+                 */
+                void            set_slope(size_t sp, size_t slope);
+
+                /**
+                 * Get slope of the split point
+                 * @param sp split point number
+                 * @return slope of the split point, 0 means split point is off,
+                 *         negative value means invalid index
+                 */
+                ssize_t         get_slope(size_t sp) const;
+
+                /** Set frequency of split point
+                 *
+                 * @param sp split point number
+                 * @param freq split frequency of the split point
+                 */
+                void            set_frequency(size_t sp, float freq);
+
+                /**
+                 * Get split frequency of the split point
+                 * @param sp split point number
+                 * @return split frequency of the split point, negative value
+                 *         means invalid index
+                 */
+                float           get_frequency(size_t sp) const;
+
+                /**
+                 * Set gain of the specific output band
+                 * @param band band number
+                 * @param gain gain of the band
+                 */
+                void            set_gain(size_t band, float gain);
+
+                /**
+                 * Get gain of the specific output band
+                 * @param band band number
+                 * @return gain of the band, negative value on invalid index
+                 */
+                float           get_gain(size_t band) const;
+
+                /**
+                 * Get start frequency of the band, may call reconfigure()
+                 * @param band band number
+                 * @return start frequency of the band or negative value on invalid index
+                 */
+                float           get_band_start(size_t band);
+
+                /**
+                 * Get end frequency of the band, may call reconfigure()
+                 * @param band band number
+                 * @return end frequency of the band or negative value on invalid index
+                 */
+                float           get_band_end(size_t band);
+
+                /**
+                 * Check that the band is active (always true for band 0), may call reconfigure()
+                 * @param band band number
+                 * @return true if band is active
+                 */
+                bool            band_active(size_t band);
+
+                /**
+                 * Set band signal handler
+                 * @param band band number
+                 * @param func handler function
+                 * @param object object to pass to function
+                 * @param subject subject to pass to function
+                 * @return false if invalid band number has been specified
+                 */
+                bool            set_handler(size_t band, crossover_func_t func, void *object, void *subject);
+
+                /**
+                 * Unset band signal handler
+                 * @param band band number
+                 * @return false if invalid band number has been specified
+                 */
+                bool            unset_handler(size_t band);
+
+                /** Set sample rate, needs reconfiguration
+                 *
+                 * @param sr sample rate to set
+                 */
+                void            set_sample_rate(size_t sr);
+
+                /**
+                 * Get sample rate of the crossover
+                 * @return sample rate
+                 */
+                inline size_t   get_sample_rate()                   { return nSampleRate;           }
+
+                /** Get frequency chart of the crossover band. The chart does not
+                 * include the linear phase shift caused by the latency
+                 *
+                 * @param band number of the band
+                 * @param re real part of the frequency chart
+                 * @param im imaginary part of the frequency chart
+                 * @param f frequencies to calculate value
+                 * @param count number of points for the chart
+                 * @return false if invalid band index is specified
+                 */
+                bool            freq_chart(size_t band,  float *re, float *im, const float *f, size_t count);
+
+                /** Get frequency chart of the crossover band. The chart does not
+                 * include the linear phase shift caused by the latency
+                 *
+                 * @param band number of the band
+                 * @param c transfer function (packed complex numbers)
+                 * @param f frequencies to calculate value
+                 * @param count number of points for the chart
+                 * @return false if invalid band index is specified
+                 */
+                bool            freq_chart(size_t band, float *c, const float *f, size_t count);
+
+                /**
+                 * Check that we need to call reconfigure()
+                 * @return true if we need to call reconfigure()
+                 */
+                inline bool     needs_reconfiguration() const       { return bReconfigure;          }
+
+                /** Reconfigure crossover after parameter update
+                 *
+                 */
+                void            reconfigure();
+
+                /**
+                 * Clear the internal state of the crossover
+                 */
+                void            clear();
+
+                /** Process data and issue callbacks, automatically calls reconfigure()
+                 * if the reconfiguration is required
+                 *
+                 * @param in input buffer to process data
+                 * @param samples number of samples to process
+                 */
+                void            process(const float *in, size_t samples);
+
+                /**
+                 * Dump the state
+                 * @param dumper dumper
+                 */
+                void            dump(IStateDumper *v) const;
+        };
+    }
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_UTIL_FFTCROSSOVER_H_ */
@@ -32,6 +32,12 @@ namespace lsp
 {
     namespace dspu
     {
+        /**
+         * Latency detector: emits the chirp to the output and detects the delay of the chirp
+         * in the inputs by the cross-correlation with the chirp. All input channels are
+         * captured and correlated simultaneously, so latencies of all inputs of a multichannel
+         * interface are measured by one capture.
+         */
         class LatencyDetector
         {
             private:
@@ -88,6 +94,8 @@ namespace lsp
                     float       fDetect;                // Detection duration
                     size_t      nDetect;                // Detection length
                     size_t      nDetectCounter;         // Count samples in input when in IP_DETECT state
+                    size_t      nCapture;               // Number of samples to capture for the deferred correlation
+                    size_t      nCorrRank;              // Rank of the deferred correlation FFT
                 } ip_t;
 
                 // Output Processor parameters
@@ -115,12 +123,21 @@ namespace lsp
                 {
                     float       fAbsThreshold;          // Absolute detection threshold
                     float       fPeakThreshold;         // Relative threshold between peaks (higher delta between recorded peaks will trigger early detection)
-                    float       fValue;                 // Value of the detected peak (absolute)
-                    size_t      nPosition;              // Position of the detected peak (referenced to sample counters)
                     size_t      nTimeOrigin;            // This should be the sample at which the convolution peak as in case 0 delay.
-                    bool        bDetected;              // True if the peak was detected.
                 } peak_t;
 
+                // Input channel state
+                typedef struct channel_t
+                {
+                    float      *vCapture;               // Hold samples captured from audio input
+                    float      *vBuffer;                // Temporary buffer to apply convolution
+                    float       fValue;                 // Value of the detected peak (absolute)
+                    size_t      nPosition;              // Position of the detected peak (referenced to sample counters)
+                    ssize_t     nLatency;               // Value of latency in samples. Signed so that -1 is meaningful
+                    float       fFraction;              // Sub-sample offset of the peak from the parabolic interpolation [samples]
+                    bool        bDetected;              // True if the latency was detected
+                } channel_t;
+
             private:
                 size_t          nSampleRate;            // Sample Rate [Hz]
 
@@ -131,22 +148,30 @@ namespace lsp
 
                 peak_t          sPeakDetector;          // Object tracking the peak of convolution.
 
+                size_t          nChannels;              // Number of input channels
+                channel_t      *vChannels;              // Input channels
+
                 float          *vChirp;                 // Samples of the chirp system impulse response
                 float          *vAntiChirp;             // Samples of the anti-chirp system impulse response
-                float          *vCapture;               // Hold samples captured from audio input
-                float          *vBuffer;                // Temporary buffer to apply convolution
                 float          *vChirpConv;             // Chirp fast convolution image
                 float          *vConvBuf;               // Temporary convolution buffer
+                float          *vCorrConv;              // Anti-chirp image for the deferred correlation
+                float          *vCorrBuf;               // Temporary buffer for the deferred correlation
+                float          *vCorrOut;               // Output of the deferred correlation
                 uint8_t        *pData;
 
+                bool            bDeferred;              // Correlate the whole capture at once after the capture
+
                 bool            bCycleComplete;         // True if the machine operated a whole measurement cycle
-                bool            bLatencyDetected;       // True if latency was detected
-                ssize_t         nLatency;               // Value of latency in samples. Signed so that -1 is meaningful
+                bool            bLatencyDetected;       // True if latency was detected for all channels
 
                 bool            bSync;
 
             protected:
-                void detect_peak(float *buf, size_t count);
+                void detect_peak(channel_t *c, float *buf, size_t count);
+                void reset_channels();
+                void complete_cycle();
+                void correlate_capture();
 
             public:
                 explicit LatencyDetector();
@@ -157,11 +182,30 @@ namespace lsp
                  */
                 void construct();
 
-                /** Initialise LatencyDetector
+                /** Initialise LatencyDetector with one input channel
                  *
                  */
                 void init();
 
+                /** Initialise LatencyDetector
+                 *
+                 * @param channels number of input channels captured simultaneously
+                 * @param deferred compute the cross-correlation of the whole capture by one large FFT
+                 *   after the capture instead of the block-by-block correlation with early detection,
+                 *   the capture is limited to about 131k samples then
+                 * @return true on success
+                 */
+                bool init(size_t channels, bool deferred = false);
+
+                /** Check that the cross-correlation is computed after the capture
+                 *
+                 * @return true if the cross-correlation is computed after the capture
+                 */
+                inline bool deferred() const
+                {
+                    return bDeferred;
+                }
+
                 /** Destroy LatencyDetector
                  *
                  */
@@ -300,7 +344,16 @@ namespace lsp
                     return bCycleComplete;
                 }
 
-                /** Return true if the latency was detected
+                /** Get number of input channels
+                 *
+                 * @return number of input channels
+                 */
+                inline size_t channels() const
+                {
+                    return nChannels;
+                }
+
+                /** Return true if the latency was detected for all input channels
                  *
                  * @return bLatencyDetected value
                  */
@@ -309,20 +362,61 @@ namespace lsp
                     return bLatencyDetected;
                 }
 
-                /** Get latency in samples
+                /** Return true if the latency was detected for the input channel
+                 *
+                 * @param channel input channel
+                 * @return true if the latency was detected
+                 */
+                inline bool latency_detected(size_t channel) const
+                {
+                    return (channel < nChannels) ? vChannels[channel].bDetected : false;
+                }
+
+                /** Get latency of the first input channel in samples
                  *
                  * @return latency in samples
                  */
                 inline ssize_t get_latency_samples() const
                 {
-                    return (bCycleComplete) ? nLatency : -1;
+                    return get_latency_samples(0);
                 }
 
-                /** Get latency in seconds
+                /** Get latency of the input channel in samples
+                 *
+                 * @param channel input channel
+                 * @return latency in samples
+                 */
+                inline ssize_t get_latency_samples(size_t channel) const
+                {
+                    return ((bCycleComplete) && (channel < nChannels)) ? vChannels[channel].nLatency : -1;
+                }
+
+                /** Get latency of the first input channel in seconds
                  *
                  * @return latency in seconds
                  */
-                float get_latency_seconds() const;
+                inline float get_latency_seconds() const
+                {
+                    return get_latency_seconds(0);
+                }
+
+                /** Get latency of the input channel in seconds, including the sub-sample correction
+                 *
+                 * @param channel input channel
+                 * @return latency in seconds
+                 */
+                float get_latency_seconds(size_t channel) const;
+
+                /** Get latency of the input channel in samples with the sub-sample correction
+                 * obtained by the parabolic interpolation of the cross-correlation peak
+                 *
+                 * @param channel input channel
+                 * @return latency in samples
+                 */
+                inline float get_fractional_latency_samples(size_t channel = 0) const
+                {
+                    return ((bCycleComplete) && (channel < nChannels)) ? vChannels[channel].nLatency + vChannels[channel].fFraction : -1.0f;
+                }
 
             public:
                 /** Stream direct chirp while recording response
@@ -333,7 +427,8 @@ namespace lsp
                  */
                 void process(float *dst, const float *src, size_t count);
 
-                /** Collect input samples:
+                /** Collect input samples of the first input channel, other input
+                 * channels receive silence
                  *
                  * @param dst samples destination
                  * @param src input source, allowed to be NULL
@@ -341,6 +436,14 @@ namespace lsp
                  */
                 void process_in(float *dst, const float *src, size_t count);
 
+                /** Collect input samples of all input channels at once
+                 *
+                 * @param dst array of channels() samples destinations, allowed to contain NULL
+                 * @param src array of channels() input sources, allowed to contain NULL
+                 * @param count number of samples to process
+                 */
+                void process_in(float * const *dst, const float * const *src, size_t count);
+
                 /** Stream output samples:
                  *
                  * @param dst samples destination
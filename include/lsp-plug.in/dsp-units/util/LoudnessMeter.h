@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_UTIL_LOUDNESSMETER_H_
+#define LSP_PLUG_IN_DSP_UNITS_UTIL_LOUDNESSMETER_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/dsp-units/filters/MultiFilterBank.h>
+
+#define LOUDNESS_MIN                -70.0f      /* Absolute gate and the value reported for silence, LUFS */
+#define LOUDNESS_MAX                10.0f       /* Upper limit of gating histograms, LUFS */
+#define LOUDNESS_HIST_STEP          0.1f        /* Resolution of gating histograms, LU */
+#define LOUDNESS_HIST_BINS          800         /* Number of bins in gating histograms */
+#define LOUDNESS_MOMENTARY_BLOCKS   4           /* Number of 100 ms sub-blocks in momentary window */
+#define LOUDNESS_SHORT_TERM_BLOCKS  30          /* Number of 100 ms sub-blocks in short-term window */
+#define LOUDNESS_K_FILTERS          2           /* Number of biquad filters in K-weighting filter */
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Loudness meter according to ITU-R BS.1770-4 and EBU R128 / EBU Tech 3342.
+         * The input is K-weighted by the lane-parallel filter bank and accumulated
+         * into 100 ms sub-blocks, momentary (400 ms) and short-term (3 s) loudness
+         * are kept as running sums over the sub-blocks. Integrated loudness and
+         * loudness range are computed from fixed-size histograms of gating blocks
+         * with 0.1 LU resolution, so the memory and the update cost do not depend
+         * on the duration of the measurement.
+         */
+        class LoudnessMeter
+        {
+            private:
+                LoudnessMeter & operator = (const LoudnessMeter &);
+                LoudnessMeter(const LoudnessMeter &);
+
+            protected:
+                typedef struct histogram_t
+                {
+                    double         *vEnergy;            // Sum of block energies per bin
+                    uint32_t       *vCount;             // Number of blocks per bin
+                    double          fEnergy;            // Overall energy of blocks
+                    size_t          nCount;             // Overall number of blocks
+                } histogram_t;
+
+            protected:
+                MultiFilterBank     sBank;              // K-weighting filters
+                histogram_t         sIntegrated;        // Histogram of momentary blocks
+                histogram_t         sRange;             // Histogram of short-term blocks
+
+                size_t              nChannels;          // Number of channels
+                size_t              nSampleRate;        // Sample rate
+                size_t              nBlockSize;         // Size of 100 ms sub-block in samples
+                size_t              nBlockOffset;       // Current offset in sub-block
+                size_t              nBlocks;            // Number of processed sub-blocks
+                size_t              nHead;              // Head of the sub-block ring
+                double              fBlockEnergy;       // Energy accumulated for current sub-block
+                double              fMomentarySum;      // Running sum of momentary sub-blocks
+                double              fShortTermSum;      // Running sum of short-term sub-blocks
+                float               fMomentary;         // Momentary loudness, LUFS
+                float               fShortTerm;         // Short-term loudness, LUFS
+                float               fIntegrated;        // Integrated loudness, LUFS
+                float               fRange;             // Loudness range, LU
+                bool                bUpdate;            // Filters need update
+
+                double             *vRing;              // Ring of sub-block energies
+                float              *vWeights;           // Channel weights
+                float             **vOut;               // Output pointers for the filter bank
+                const float       **vIn;                // Input pointers for the filter bank
+                float              *vBuffer;            // Buffers of weighted signal
+                uint8_t            *pData;              // Allocated data
+
+            protected:
+                void                update_settings();
+                void                complete_block();
+                static void         hist_add(histogram_t *h, double energy, float loudness);
+                static void         hist_clear(histogram_t *h);
+                static double       hist_gate(const histogram_t *h, float gate, size_t *first, size_t *count);
+                static void         dump_hist(IStateDumper *v, const char *name, const histogram_t *h);
+
+            public:
+                explicit LoudnessMeter();
+                ~LoudnessMeter();
+
+                /**
+                 * Construct object
+                 */
+                void                construct();
+
+                /**
+                 * Initialize loudness meter
+                 * @param channels number of channels
+                 * @return true on success
+                 */
+                bool                init(size_t channels);
+
+                /**
+                 * Destroy loudness meter
+                 */
+                void                destroy();
+
+            public:
+                /**
+                 * Set sample rate, resets the measurement
+                 * @param sr sample rate
+                 */
+                void                set_sample_rate(size_t sr);
+
+                /**
+                 * Set weight of the channel: 1.0 for front channels, 1.41 for surround
+                 * channels, 0.0 excludes the channel (LFE) from the measurement
+                 * @param channel channel index
+                 * @param weight channel weight
+                 */
+                void                set_weight(size_t channel, float weight);
+
+                /**
+                 * Get weight of the channel
+                 * @param channel channel index
+                 * @return channel weight
+                 */
+                inline float        weight(size_t channel) const    { return (channel < nChannels) ? vWeights[channel] : 0.0f; }
+
+                /**
+                 * Get number of channels
+                 * @return number of channels
+                 */
+                inline size_t       channels() const                { return nChannels; }
+
+                /**
+                 * Get sample rate
+                 * @return sample rate
+                 */
+                inline size_t       sample_rate() const             { return nSampleRate; }
+
+                /**
+                 * Get size of the 100 ms sub-block used for measurement
+                 * @return size of the sub-block in samples
+                 */
+                inline size_t       block_size() const              { return nBlockSize; }
+
+                /**
+                 * Reset the measurement: windows, integrated loudness and loudness range
+                 */
+                void                reset();
+
+                /**
+                 * Process the input signal
+                 * @param in list of input buffers, one per channel
+                 * @param samples number of samples to process
+                 */
+                void                process(const float * const *in, size_t samples);
+
+                /**
+                 * Append sub-blocks measured outside of the meter, for example by parallel
+                 * processing of the time ranges of the signal. Each value is the sum of
+                 * mean squares of K-weighted channels over the sub-block multiplied by the
+                 * channel weights. The partially accumulated sub-block is discarded.
+                 * @param energy list of sub-block energies
+                 * @param count number of sub-blocks
+                 */
+                void                append(const float *energy, size_t count);
+
+                /**
+                 * Compute coefficients of the K-weighting filter
+                 * @param f array of LOUDNESS_K_FILTERS filters to store the coefficients
+                 * @param sr sample rate
+                 */
+                static void         k_weighting(dsp::biquad_x1_t *f, size_t sr);
+
+                /**
+                 * Get momentary loudness (400 ms window)
+                 * @return momentary loudness, LUFS
+                 */
+                inline float        momentary() const               { return fMomentary;    }
+
+                /**
+                 * Get short-term loudness (3 s window)
+                 * @return short-term loudness, LUFS
+                 */
+                inline float        short_term() const              { return fShortTerm;    }
+
+                /**
+                 * Get gated integrated loudness since the last reset
+                 * @return integrated loudness, LUFS
+                 */
+                inline float        integrated() const              { return fIntegrated;   }
+
+                /**
+                 * Get loudness range since the last reset
+                 * @return loudness range, LU
+                 */
+                inline float        range() const                   { return fRange;        }
+
+                /**
+                 * Dump the state
+                 * @param dumper dumper
+                 */
+                void                dump(IStateDumper *v) const;
+        };
+    } /* namespace dspu */
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_UTIL_LOUDNESSMETER_H_ */
@@ -0,0 +1,291 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_UTIL_MLSRESPONSETAKER_H_
+#define LSP_PLUG_IN_DSP_UNITS_UTIL_MLSRESPONSETAKER_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/dsp-units/noise/MLS.h>
+#include <lsp-plug.in/common/status.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /** Impulse response measurement with the Maximum Length Sequence.
+         *
+         * The output emits one warm-up period of the MLS followed by the requested number
+         * of periods. The input skips the latency and the warm-up period and then sums the
+         * captured periods sample by sample (synchronous averaging), so the averaging buffer
+         * holds the circular convolution of the response with one MLS period.
+         *
+         * The circular cross-correlation with the MLS is computed by the Fast Hadamard
+         * Transform: the samples are permuted into the Hadamard order by the tags built from
+         * the sequence itself, transformed with additions and subtractions only in
+         * O(L*log(L)) and permuted back. The response should be shorter than the period
+         * length L = 2^N - 1, otherwise it wraps around.
+         */
+        class MLSResponseTaker
+        {
+            private:
+                MLSResponseTaker & operator = (const MLSResponseTaker &);
+                MLSResponseTaker(const MLSResponseTaker &);
+
+            protected:
+                // Input processor state enumerator
+                enum ip_state_t
+                {
+                    IP_BYPASS,                  // Bypassing the signal
+                    IP_WAIT,                    // Bypassing while the latency and the warm-up period pass
+                    IP_ACQUIRE                  // Receiving input samples and averaging periods
+                };
+
+                // Output processor state enumerator
+                enum op_state_t
+                {
+                    OP_BYPASS,                  // Bypassing the signal
+                    OP_EMIT                     // Emitting the periods of the sequence
+                };
+
+            private:
+                MLS         sMLS;               // Sequence generator
+
+                size_t      nMaxBits;           // Maximum number of bits
+                size_t      nBits;              // Number of bits
+                size_t      nLength;            // Period length: 2^N - 1
+                size_t      nPeriods;           // Number of averaged periods
+                size_t      nLatency;           // Latency of the transmission line under test [samples]
+                float       fAmplitude;         // Amplitude of the emitted sequence
+
+                ip_state_t  nInState;           // Input processor state
+                size_t      nInSkip;            // Number of samples to skip before acquisition
+                size_t      nInTime;            // Number of acquired samples
+                size_t      nInPos;             // Position in the averaging buffer
+
+                op_state_t  nOutState;          // Output processor state
+                size_t      nOutTime;           // Number of emitted samples
+                size_t      nOutPos;            // Position in the sequence
+
+                float      *vSequence;          // One period of the sequence, +1/-1
+                uint32_t   *vInTag;             // Hadamard index of each sample of the period
+                uint32_t   *vOutTag;            // Hadamard index of each sample of the response
+                float      *vAverage;           // Sum of the captured periods
+                float      *vTransform;         // Hadamard transform buffer, 2^N samples
+                uint8_t    *pData;              // Allocated data
+
+                bool        bCycleComplete;     // True if the machine operated a whole measurement cycle
+                bool        bSync;
+
+            protected:
+                void        build_tags();
+                static void hadamard(float *x, size_t bits);
+
+            public:
+                explicit MLSResponseTaker();
+                ~MLSResponseTaker();
+
+                /** Construct the MLSResponseTaker
+                 *
+                 */
+                void construct();
+
+                /** Initialise MLSResponseTaker
+                 *
+                 * @param max_bits maximum number of bits of the sequence
+                 * @return true on success
+                 */
+                bool init(size_t max_bits);
+
+                /** Destroy MLSResponseTaker
+                 *
+                 */
+                void destroy();
+
+            public:
+                /** Check that MLSResponseTaker needs settings update
+                 *
+                 * @return true if MLSResponseTaker needs setting update
+                 */
+                inline bool needs_update() const
+                {
+                    return bSync;
+                }
+
+                /** Update MLSResponseTaker stateful settings, resets the capture
+                 *
+                 */
+                void update_settings();
+
+                /** Set the number of bits of the sequence, the period is 2^N - 1 samples
+                 *
+                 * @param bits number of bits
+                 */
+                inline void set_n_bits(size_t bits)
+                {
+                    if (nBits == bits)
+                        return;
+
+                    nBits                           = bits;
+                    bSync                           = true;
+                }
+
+                /** Set the number of periods averaged during the capture
+                 *
+                 * @param periods number of periods
+                 */
+                inline void set_periods(size_t periods)
+                {
+                    periods                         = (periods > 0) ? periods : 1;
+                    if (nPeriods == periods)
+                        return;
+
+                    nPeriods                        = periods;
+                    bSync                           = true;
+                }
+
+                /** Set the amplitude of the emitted sequence
+                 *
+                 * @param amplitude amplitude
+                 */
+                inline void set_amplitude(float amplitude)
+                {
+                    if (fAmplitude == amplitude)
+                        return;
+
+                    fAmplitude                      = amplitude;
+                    bSync                           = true;
+                }
+
+                /** Set the latency of the transmission line
+                 *
+                 * @param latency latency in samples
+                 */
+                inline void set_latency_samples(ssize_t latency)
+                {
+                    if (nLatency == size_t(latency))
+                        return;
+
+                    nLatency                        = (latency > 0) ? size_t(latency) : 0;
+                    bSync                           = true;
+                }
+
+                /** Get the number of bits of the sequence
+                 *
+                 * @return number of bits
+                 */
+                inline size_t get_n_bits() const
+                {
+                    return nBits;
+                }
+
+                /** Get the period of the sequence, the maximum length of the measured response
+                 *
+                 * @return period length in samples
+                 */
+                inline size_t get_length() const
+                {
+                    return nLength;
+                }
+
+                /** Get the number of averaged periods
+                 *
+                 * @return number of periods
+                 */
+                inline size_t get_periods() const
+                {
+                    return nPeriods;
+                }
+
+                /** Get the duration of the emission including the warm-up period
+                 *
+                 * @return duration in samples
+                 */
+                inline size_t get_duration() const
+                {
+                    return nLength * (nPeriods + 1);
+                }
+
+                /** Get number of samples captured in the current measurement cycle
+                 *
+                 * @return number of samples captured in the current measurement cycle
+                 */
+                inline size_t get_captured() const
+                {
+                    return nInTime;
+                }
+
+                /** Start the measurement
+                 *
+                 */
+                void start_capture();
+
+                /** Force the measurement to reset it's state
+                 *
+                 */
+                void reset_capture();
+
+                /** Return true if the measurement cycle was completed
+                 *
+                 * @return bCycleComplete value
+                 */
+                inline bool cycle_complete() const
+                {
+                    return bCycleComplete;
+                }
+
+                /** Compute the impulse response from the averaged periods, should be
+                 * called outside of the realtime thread after the cycle is complete.
+                 * The samples beyond the period length are zeroed
+                 *
+                 * @param dst destination buffer to store the impulse response
+                 * @param count number of samples to store
+                 * @return status of operation
+                 */
+                status_t deconvolve(float *dst, size_t count);
+
+            public:
+                /** Collect input samples, the input is passed to the output unchanged
+                 *
+                 * @param dst samples destination
+                 * @param src input source, allowed to be NULL
+                 * @param count number of samples to process
+                 */
+                void process_in(float *dst, const float *src, size_t count);
+
+                /** Stream output samples, the sequence replaces the source while emitted
+                 *
+                 * @param dst samples destination
+                 * @param src input source, allowed to be NULL
+                 * @param count number of samples to process
+                 */
+                void process_out(float *dst, const float *src, size_t count);
+
+                /**
+                 * Dump the state
+                 * @param dumper dumper
+                 */
+                void dump(IStateDumper *v) const;
+        };
+    }
+}
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_UTIL_MLSRESPONSETAKER_H_ */
@@ -33,7 +33,8 @@ namespace lsp
         enum meter_method_t
         {
             MM_MAXIMUM,
-            MM_MINIMUM
+            MM_MINIMUM,
+            MM_RMS
         };
 
         class MeterGraph
@@ -42,12 +43,26 @@ namespace lsp
                 MeterGraph & operator = (const MeterGraph &);
                 MeterGraph(const MeterGraph &);
 
+            protected:
+                typedef struct level_t
+                {
+                    ShiftBuffer         sBuffer;        // Decimated frames
+                    float               fPending;       // First frame of the pair from the finer level
+                    bool                bPending;       // Pending frame is present
+                } level_t;
+
             protected:
                 ShiftBuffer         sBuffer;
                 float               fCurrent;
                 size_t              nCount;
                 size_t              nPeriod;
-                bool                bMinimize;
+                meter_method_t      enMethod;
+                level_t            *vLevels;            // Decimated levels of the history, starting with level 1
+                size_t              nLevels;            // Overall number of levels including the finest one
+
+            protected:
+                void        commit();
+                float       combine(float a, float b) const;
 
             public:
                 explicit MeterGraph();
@@ -62,9 +77,11 @@ namespace lsp
                  *
                  * @param frames number of frames used for graph and needed to be stored in internal buffer
                  * @param period strobe period
+                 * @param levels number of levels of the history, each next level decimates
+                 *   the previous one by 2 and stores half of its frames over the same time span
                  * @return true on success
                  */
-                bool        init(size_t frames, size_t period);
+                bool        init(size_t frames, size_t period, size_t levels = 1);
 
                 /** Destroy meter graph
                  *
@@ -82,7 +99,7 @@ namespace lsp
                  *
                  * @param m metering method
                  */
-                inline void set_method(meter_method_t m) { bMinimize = (m == MM_MINIMUM); }
+                inline void set_method(meter_method_t m) { enMethod = m; }
 
                 /** Get data stored in buffer
                  *
@@ -90,6 +107,36 @@ namespace lsp
                  */
                 inline float *data()    { return sBuffer.head();   }
 
+                /**
+                 * Get number of levels of the history
+                 * @return number of levels
+                 */
+                inline size_t levels() const            { return nLevels; }
+
+                /**
+                 * Get number of frames stored at the level of the history
+                 * @param level level number, 0 is the finest level
+                 * @return number of frames
+                 */
+                size_t      get_frames(size_t level) const;
+
+                /** Get data stored at the level of the history, the frame of the level
+                 * covers (period << level) samples
+                 *
+                 * @param level level number, 0 is the finest level
+                 * @return pointer to the first (oldest) frame of the level or NULL
+                 */
+                float      *data(size_t level);
+
+                /** Select the coarsest level that displays the specified amount of the latest
+                 * samples with at least the specified number of frames
+                 *
+                 * @param samples number of samples to display
+                 * @param width minimum number of frames to display
+                 * @return level number
+                 */
+                size_t      select_level(size_t samples, size_t width) const;
+
                 /** Set strobe period
                  *
                  * @param period strobe period
@@ -122,7 +169,7 @@ namespace lsp
                  *
                  * @param level level
                  */
-                inline void fill(float level)   { sBuffer.fill(level); }
+                void        fill(float level);
 
                 /**
                  * Dump internal state
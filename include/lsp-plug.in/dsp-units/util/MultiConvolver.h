@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_UTIL_MULTICONVOLVER_H_
+#define LSP_PLUG_IN_DSP_UNITS_UTIL_MULTICONVOLVER_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/dsp-units/util/Convolver.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Multi-channel convolver: applies the matrix of N inputs x M outputs impulse
+         * responses (for example, 2x2 for true stereo). Each output is the sum of all
+         * inputs convolved with corresponding impulse responses. The forward FFT of each
+         * input block is computed once and shared between all impulse responses of the
+         * input, the spectra of all impulse responses for the same partition are stored
+         * next to each other.
+         */
+        class MultiConvolver
+        {
+            private:
+                MultiConvolver & operator = (const MultiConvolver &);
+                MultiConvolver(const MultiConvolver &);
+
+            private:
+                float          *vDataBuffer;            // Buffers for storing convolution tail data of each output
+                float          *vFrames;                // Input data frames of each input
+                float          *vConvBuffer;            // Convolution buffer to perform convolution
+                float          *vInputData;             // FFT data of the input block shared between impulse responses
+                float          *vTaskData;              // Task data for tail convolution of each input
+                float          *vConvData;              // FFT convolution data, partition x input x output
+                float          *vDirectData;            // Direct convolution data, input x output
+
+                size_t          nInputs;                // Number of inputs
+                size_t          nOutputs;               // Number of outputs
+                size_t          nDataBufferSize;        // Size of data buffer of one output
+                size_t          nDirectSize;            // Size of direct convolution data
+                size_t          nDirectStride;          // Stride between direct convolution data of impulse responses
+                size_t          nFrameSize;             // Size of input data frame
+                size_t          nFrameOff;              // Offset from the beginning of the input data frame
+                size_t          nConvSize;              // The actual convolution size in samples
+                size_t          nLevels;                // Number of raising convolution levels
+                size_t          nBlocks;                // Number of constant-size blocks
+                size_t          nBlocksDone;            // Number of applied constant-size blocks
+                size_t          nRank;                  // The actual rank of the convolution
+                size_t          nBlkInit;               // Initial number of blocks to apply at step # 0
+                float           fBlkCoef;               // The actual coefficient to compute proper block number per formula
+
+                uint8_t        *vData;                  // Non-aligned pointer to the whole allocated data
+
+            protected:
+                void            parse_partition(float *dst, const float *src, size_t count, size_t rank);
+                inline float   *frame(size_t input)     { return &vFrames[(input * 2 + 1) * nFrameSize];    }
+                inline float   *output(size_t output)   { return &vDataBuffer[output * nDataBufferSize];   }
+
+            public:
+                explicit MultiConvolver();
+                ~MultiConvolver();
+
+                /** Construct the convolver
+                 *
+                 */
+                void construct();
+
+                /** Destroy convolver
+                 *
+                 */
+                void destroy();
+
+            public:
+
+                /** Initialize convolver
+                 *
+                 * @param data array of inputs * outputs impulse responses, the impulse response
+                 *   for input i and output o is stored at index i * outputs + o, NULL means silence
+                 * @param count array of sizes of impulse responses in samples
+                 * @param inputs number of inputs
+                 * @param outputs number of outputs
+                 * @param rank convolution rank
+                 * @param phase the phase of the convolution tail scheduling
+                 * @return true on success
+                 */
+                bool init(const float * const *data, const size_t *count,
+                        size_t inputs, size_t outputs, size_t rank, float phase);
+
+                /** Process samples
+                 *
+                 * @param dst array of destination buffers for each output
+                 * @param src array of source buffers for each input
+                 * @param count number of samples to process
+                 */
+                void process(float * const *dst, const float * const *src, size_t count);
+
+                /** Get the actual convolution size in samples
+                 *
+                 * @return actual convolution size in samples
+                 */
+                inline size_t data_size() const             { return nConvSize;     }
+
+                /**
+                 * Get actual convolution rank of the convolver
+                 * @return convolution rank
+                 */
+                inline size_t rank() const                  { return nRank;         }
+
+                /**
+                 * Get the latency of the convolver. The first CONVOLVER_RANK_MIN/2 taps
+                 * are applied in the time domain (or as part of the whole block of the same
+                 * size), each next partition of the impulse response starts not earlier than
+                 * its size, so the output is never delayed relative to the input
+                 * @return latency of the convolver in samples, always zero
+                 */
+                inline size_t latency() const               { return 0;             }
+
+                /**
+                 * Get number of inputs
+                 * @return number of inputs
+                 */
+                inline size_t inputs() const                { return nInputs;       }
+
+                /**
+                 * Get number of outputs
+                 * @return number of outputs
+                 */
+                inline size_t outputs() const               { return nOutputs;      }
+
+                /**
+                 * Dump internal state
+                 * @param v state dumper
+                 */
+                void dump(IStateDumper *v) const;
+        };
+    }
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_UTIL_MULTICONVOLVER_H_ */
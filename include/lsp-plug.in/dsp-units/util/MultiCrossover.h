@@ -0,0 +1,310 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_UTIL_MULTICROSSOVER_H_
+#define LSP_PLUG_IN_DSP_UNITS_UTIL_MULTICROSSOVER_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/dsp-units/filters/Filter.h>
+#include <lsp-plug.in/dsp-units/filters/FilterBank.h>
+#include <lsp-plug.in/dsp-units/filters/MultiFilterBank.h>
+#include <lsp-plug.in/dsp-units/util/Crossover.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Multi-channel crossover callback function for processing band signals
+         *
+         * @param object the object that handles callback
+         * @param subject the subject that is used to handle callback
+         * @param band number of the band
+         * @param data the output band signals of all channels produced by crossover,
+         *        are valid only until the function returns
+         * @param channels number of channels
+         * @param first index of the first sample in input buffers
+         * @param count number of processed samples in the data buffers
+         */
+        typedef void (* multi_crossover_func_t)(void *object, void *subject, size_t band, const float * const *data, size_t channels, size_t first, size_t count);
+
+        /** Multi-channel crossover, splits signals of all channels into bands with the same
+         * split filters processing all channels in parallel lanes and calls one processing
+         * handler for all channels of the band. Has the same processing schema as Crossover
+         */
+        class MultiCrossover
+        {
+            private:
+                MultiCrossover & operator = (const MultiCrossover &);
+                MultiCrossover(const MultiCrossover &);
+
+            protected:
+                enum xover_type_t
+                {
+                    FILTER_LPF,                         // Low-pass filter
+                    FILTER_HPF,                         // High-pass filter
+                    FILTER_APF                          // All-pass filter
+                };
+
+                typedef struct split_t
+                {
+                    MultiFilterBank     sLPF;           // Lo-pass filter with all-pass filters
+                    MultiFilterBank     sHPF;           // Hi-pass filter
+
+                    size_t              nBandId;        // Number of split point
+                    size_t              nSlope;         // Filter slope (0 = off)
+                    float               fFreq;          // Frequency
+                    crossover_mode_t    nMode;          // Filter type
+                } split_t;
+
+                typedef struct band_t
+                {
+                    float               fGain;          // Output gain of the band
+                    float               fStart;         // Start frequency of the band
+                    float               fEnd;           // End frequency of the band
+                    bool                bEnabled;       // Enabled flag
+                    split_t            *pStart;         // Pointer to starting split point
+                    split_t            *pEnd;           // Pointer to ending split point
+
+                    multi_crossover_func_t  pFunc;      // Function
+                    void               *pObject;        // Bound object
+                    void               *pSubject;       // Bound subject
+                    size_t              nId;            // Number of the band
+                } band_t;
+
+                enum reconfigure_t
+                {
+                    R_GAIN          = 1 << 0,           // We can reconfigure band gain in softer mode
+                    R_SPLIT         = 1 << 1,           // Need to reconfigure filter order
+
+                    R_ALL           = R_GAIN | R_SPLIT
+                } reconfigure_t;
+
+            protected:
+                size_t          nReconfigure;   // Change flag
+                size_t          nSplits;        // Number of splits
+                size_t          nChannels;      // Number of channels
+                size_t          nBufSize;       // Buffer size
+                size_t          nSampleRate;    // Sample rate
+
+                band_t         *vBands;         // List of bands
+                split_t        *vSplit;         // List of split points
+                split_t       **vPlan;          // Split plan
+                size_t          nPlanSize;      // Size of plan
+
+                FilterBank      sBank;          // Filter bank used to build filter chains
+                Filter          sFilter;        // Filter used to build filter chains
+
+                float         **vLpfBuf;        // Buffers for LPF
+                float         **vHpfBuf;        // Buffers for HPF
+                const float   **vIn;            // Pointers to the input data
+                uint8_t        *pData;          // Unaligned data
+
+            protected:
+                inline filter_type_t    select_filter(xover_type_t type, crossover_mode_t mode);
+                void                    add_filter(xover_type_t type, const split_t *sp, float gain);
+
+            public:
+                explicit MultiCrossover();
+                ~MultiCrossover();
+
+                /** Construct crossover
+                 *
+                 */
+                void            construct();
+
+                /** Destroy crossover
+                 *
+                 */
+                void            destroy();
+
+                /** Initialize crossover
+                 *
+                 * @param channels number of channels
+                 * @param bands number of bands
+                 * @param buf_size maximum signal processing buffer size
+                 * @return status of operation
+                 */
+                bool            init(size_t channels, size_t bands, size_t buf_size);
+
+            public:
+                /**
+                 * Get number of channels
+                 * @return number of channels
+                 */
+                inline size_t   channels() const                        { return nChannels;     }
+
+                /**
+                 * Get number of bands
+                 * @return number of bands
+                 */
+                inline size_t   num_bands() const                       { return nSplits+1;     }
+
+                /**
+                 * Get number of split points
+                 * @return number of split points
+                 */
+                inline size_t   num_splits() const                      { return nSplits;       }
+
+                /**
+                 * Get maximum buffer size for one iteration
+                 * @return maximum buffer size
+                 */
+                inline size_t   max_buffer_size() const                 { return nBufSize;      }
+
+                /** Set slope of crossover
+                 *
+                 * @param sp split point number
+                 * @param slope slope of crossover filters
+                 */
+                void            set_slope(size_t sp, size_t slope);
+
+                /**
+                 * Get slope of the split point
+                 * @param sp split point number
+                 * @return slope of the split point, 0 means split point is off,
+                 *         negative value means invalid index
+                 */
+                ssize_t         get_slope(size_t sp) const;
+
+                /** Set frequency of split point
+                 *
+                 * @param sp split point number
+                 * @param freq split frequency of the split point
+                 */
+                void            set_frequency(size_t sp, float freq);
+
+                /**
+                 * Get split frequency of the split point
+                 * @param sp split point number
+                 * @return split frequency of the split point, negative value
+                 *         means invalid index
+                 */
+                float           get_frequency(size_t sp) const;
+
+                /**
+                 * Set filter mode for the split point
+                 * @param sp split point
+                 * @param mode mode for the split point
+                 */
+                void            set_mode(size_t sp, crossover_mode_t mode);
+
+                /**
+                 * Get filter mode of the split point
+                 * @param sp split point
+                 * @return mode for the split point or negative value on invalid index
+                 */
+                ssize_t         get_mode(size_t sp) const;
+
+                /**
+                 * Set gain of the specific output band
+                 * @param band band number
+                 * @param gain gain of the band
+                 */
+                void            set_gain(size_t band, float gain);
+
+                /**
+                 * Get gain of the specific output band
+                 * @param band band number
+                 * @return gain of the band, negative value on invalid index
+                 */
+                float           get_gain(size_t band) const;
+
+                /**
+                 * Get start frequency of the band, may call reconfigure()
+                 * @param band band number
+                 * @return start frequency of the band or negative value on invalid index
+                 */
+                float           get_band_start(size_t band);
+
+                /**
+                 * Get end frequency of the band, may call reconfigure()
+                 * @param band band number
+                 * @return end frequency of the band or negative value on invalid index
+                 */
+                float           get_band_end(size_t band);
+
+                /**
+                 * Check that the band is active (always true for band 0), may call reconfigure()
+                 * @param band band number
+                 * @return true if band is active
+                 */
+                bool            band_active(size_t band);
+
+                /**
+                 * Set band signal handler
+                 * @param band band number
+                 * @param func handler function
+                 * @param object object to pass to function
+                 * @param subject subject to pass to function
+                 * @return false if invalid band number has been specified
+                 */
+                bool            set_handler(size_t band, multi_crossover_func_t func, void *object, void *subject);
+
+                /**
+                 * Unset band signal handler
+                 * @param band band number
+                 * @return false if invalid band number has been specified
+                 */
+                bool            unset_handler(size_t band);
+
+                /** Set sample rate, needs reconfiguration
+                 *
+                 * @param sr sample rate to set
+                 */
+                void            set_sample_rate(size_t sr);
+
+                /**
+                 * Get sample rate of the crossover
+                 * @return sample rate
+                 */
+                inline size_t   get_sample_rate()                   { return nSampleRate;           }
+
+                /**
+                 * Check that we need to call reconfigure()
+                 * @return true if we need to call reconfigure()
+                 */
+                inline bool     needs_reconfiguration() const       { return nReconfigure != 0;     }
+
+                /** Reconfigure crossover after parameter update
+                 *
+                 */
+                void            reconfigure();
+
+                /** Process data of all channels and issue callbacks, automatically calls
+                 * reconfigure() if the reconfiguration is required
+                 *
+                 * @param in input buffers to process data
+                 * @param samples number of samples to process
+                 */
+                void            process(const float * const *in, size_t samples);
+
+                /**
+                 * Dump the state
+                 * @param dumper dumper
+                 */
+                void            dump(IStateDumper *v) const;
+        };
+    }
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_UTIL_MULTICROSSOVER_H_ */
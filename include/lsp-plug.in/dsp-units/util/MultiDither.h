@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_UTIL_MULTIDITHER_H_
+#define LSP_PLUG_IN_DSP_UNITS_UTIL_MULTIDITHER_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/dsp-units/util/Dither.h>
+#include <lsp-plug.in/dsp-units/util/Randomizer.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Multi-channel dither: each channel has its own counter-based random
+         * stream, so the noise of channels is not correlated and does not depend
+         * on the number of channels. The TPDF noise is generated by blocks, the
+         * error-feedback filters of all channels are stored as structure of arrays
+         * and are processed in lockstep, one lane per channel
+         */
+        class MultiDither
+        {
+            private:
+                MultiDither & operator = (const MultiDither &);
+                MultiDither(const MultiDither &);
+
+            protected:
+                Randomizer     *vRandom;        // Random generators of channels
+                float          *vError[DITHER_SHAPE_ORDER]; // History of the quantization error of channels
+                float          *vSignal;        // Interleaved signal of the block
+                float          *vNoise;         // Interleaved dither noise of the block
+                size_t          nChannels;      // Number of channels
+                size_t          nCapacity;      // Number of channels aligned to the number of lanes
+                size_t          nBits;          // Number of bits per sample
+                float           fGain;          // Gain of the signal
+                float           fDelta;         // Amplitude of the noise
+                dither_shape_t  enShape;        // Noise-shaping curve
+                uint8_t        *pData;          // Allocated data
+
+            protected:
+                void            process_flat(float * const *out, const float * const *in, size_t count);
+                void            process_shaped(float * const *out, const float * const *in, size_t count);
+
+            public:
+                explicit MultiDither();
+                ~MultiDither();
+
+                /**
+                 * Construct the object
+                 */
+                void            construct();
+
+                /**
+                 * Destroy the object
+                 */
+                void            destroy();
+
+            public:
+                /** Initialize dither
+                 *
+                 * @param channels number of channels
+                 * @param seed seed of random generators, channel index is used as the stream identifier
+                 * @return true on success
+                 */
+                bool            init(size_t channels, uint32_t seed);
+
+                /** Initialize dither, take current time as seed
+                 *
+                 * @param channels number of channels
+                 * @return true on success
+                 */
+                bool            init(size_t channels);
+
+                /** Get number of channels
+                 *
+                 * @return number of channels
+                 */
+                inline size_t   channels() const    { return nChannels;     }
+
+                /** Set number of bits per sample
+                 *
+                 * @param bits number of bits per sample
+                 */
+                void            set_bits(size_t bits);
+
+                /** Set noise-shaping curve, the history of the quantization error is reset.
+                 * Any curve except DITHER_FLAT quantizes the output to the number of bits
+                 *
+                 * @param shape noise-shaping curve
+                 */
+                void            set_shape(dither_shape_t shape);
+
+                /** Get noise-shaping curve
+                 *
+                 * @return noise-shaping curve
+                 */
+                inline dither_shape_t shape() const { return enShape;       }
+
+                /** Process signal of all channels
+                 *
+                 * @param out list of channels() output buffers, can be the same as input buffers
+                 * @param in list of channels() input buffers
+                 * @param count number of samples to process
+                 */
+                void            process(float * const *out, const float * const *in, size_t count);
+
+                /**
+                 * Dump the state
+                 * @param v state dumper
+                 */
+                void            dump(IStateDumper *v) const;
+        };
+    }
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_UTIL_MULTIDITHER_H_ */
@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_UTIL_MULTIMETERGRAPH_H_
+#define LSP_PLUG_IN_DSP_UNITS_UTIL_MULTIMETERGRAPH_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/dsp-units/util/MeterGraph.h>
+#include <lsp-plug.in/common/atomic.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Multi-channel meter graph: reduces all channels with the same period
+         * and metering method at once and publishes the frames to the ring buffer.
+         * The ring buffer has one writer (the processing thread) and may be read
+         * without locks by any number of readers (for example, the UI thread)
+         */
+        class MultiMeterGraph
+        {
+            private:
+                MultiMeterGraph & operator = (const MultiMeterGraph &);
+                MultiMeterGraph(const MultiMeterGraph &);
+
+            protected:
+                float             **vRing;      // Ring buffers of frames, one per channel
+                float              *vCurrent;   // Current value of the frame, one per channel
+                size_t              nChannels;  // Number of channels
+                size_t              nFrames;    // Number of frames available for reading
+                size_t              nCapacity;  // Capacity of the ring buffer, power of 2
+                size_t              nCount;     // Number of samples processed for current frame
+                size_t              nPeriod;    // Strobe period
+                meter_method_t      enMethod;   // Metering method
+                atomic_t            nHead;      // Number of published frames
+                uint8_t            *pData;      // Allocated data
+
+            protected:
+                void                commit();
+
+            public:
+                explicit MultiMeterGraph();
+                ~MultiMeterGraph();
+
+                /**
+                 * Construct object
+                 */
+                void                construct();
+
+                /** Initialize meter graph
+                 *
+                 * @param channels number of channels
+                 * @param frames number of frames available for reading
+                 * @param period strobe period
+                 * @return true on success
+                 */
+                bool                init(size_t channels, size_t frames, size_t period);
+
+                /** Destroy meter graph
+                 *
+                 */
+                void                destroy();
+
+            public:
+                /**
+                 * Get number of channels
+                 * @return number of channels
+                 */
+                inline size_t       channels() const                { return nChannels;         }
+
+                /**
+                 * Get number of frames available for reading
+                 * @return number of frames
+                 */
+                inline size_t       get_frames() const              { return nFrames;           }
+
+                /** Set metering method
+                 *
+                 * @param m metering method
+                 */
+                inline void         set_method(meter_method_t m)    { enMethod = m;             }
+
+                /** Set strobe period
+                 *
+                 * @param period strobe period
+                 */
+                inline void         set_period(size_t period)       { nPeriod = period;         }
+
+                /** Process samples of all channels, should be called from the single thread
+                 *
+                 * @param s list of channel buffers
+                 * @param n number of samples to process
+                 */
+                void                process(const float * const *s, size_t n);
+
+                /** Fill the history of all channels with specific level and publish it,
+                 * should be called from the same thread as process()
+                 *
+                 * @param level level
+                 */
+                void                fill(float level);
+
+                /** Get number of frames published since initialization, the value changes
+                 * when new frames become available, may be called from any thread
+                 *
+                 * @return number of published frames
+                 */
+                size_t              published();
+
+                /** Read the latest frames of the channel, may be called from any thread
+                 * concurrently with process()
+                 *
+                 * @param dst destination buffer to store frames, the oldest frame goes first
+                 * @param channel channel number
+                 * @param count number of frames to read, should not exceed get_frames()
+                 * @return number of published frames at the moment of reading
+                 */
+                size_t              read(float *dst, size_t channel, size_t count);
+
+                /**
+                 * Dump internal state
+                 * @param v state dumper
+                 */
+                void                dump(IStateDumper *v) const;
+        };
+    }
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_UTIL_MULTIMETERGRAPH_H_ */
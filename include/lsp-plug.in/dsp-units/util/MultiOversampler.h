@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_UTIL_MULTIOVERSAMPLER_H_
+#define LSP_PLUG_IN_DSP_UNITS_UTIL_MULTIOVERSAMPLER_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/dsp-units/util/Oversampler.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /** Callback to perform processing of oversampled signal of multiple channels
+         *
+         */
+        class IMultiOversamplerCallback
+        {
+            public:
+                /** Virtual destructor
+                 *
+                 */
+                virtual ~IMultiOversamplerCallback();
+
+                /** Processing routine
+                 *
+                 * @param out list of output buffers of samples size
+                 * @param in list of input buffers of samples size
+                 * @param channels number of channels
+                 * @param samples number of samples to process
+                 */
+                virtual void process(float * const *out, const float * const *in, size_t channels, size_t samples);
+        };
+
+        /** Multi-channel oversampler class, performs oversampling of all channels
+         * with the same settings and calls the callback once for all channels
+         *
+         */
+        class MultiOversampler
+        {
+            private:
+                MultiOversampler & operator = (const MultiOversampler &);
+                MultiOversampler(const MultiOversampler &);
+
+            protected:
+                IMultiOversamplerCallback  *pCallback;
+                size_t                      nChannels;
+                Oversampler                *vChannels;      // Oversamplers that hold filter state of each channel
+                float                     **vBuffers;       // Oversampled data of each channel
+                uint8_t                    *bData;
+
+            public:
+                explicit MultiOversampler();
+                ~MultiOversampler();
+
+                void construct();
+
+            public:
+                /** Initialize oversampler
+                 *
+                 * @param channels number of channels
+                 * @return true on success
+                 */
+                bool init(size_t channels);
+
+                /** Destroy oversampler
+                 *
+                 */
+                void destroy();
+
+                /** Get number of channels
+                 *
+                 * @return number of channels
+                 */
+                inline size_t channels() const          { return nChannels;         }
+
+                /** Set sample rate
+                 *
+                 * @param sr sample rate
+                 */
+                void set_sample_rate(size_t sr);
+
+                /** Set oversampling callback
+                 *
+                 * @param callback calback to call on process()
+                 */
+                inline void set_callback(IMultiOversamplerCallback *callback)
+                {
+                    pCallback       = callback;
+                }
+
+                /** Set oversampling ratio
+                 *
+                 * @param mode oversampling mode
+                 */
+                void set_mode(over_mode_t mode);
+
+                /** Enable/disable low-pass filter when performing downsampling
+                 *
+                 * @param filter enables/diables low-pass filter
+                 */
+                void set_filtering(bool filter);
+
+                /** Set the length of the half-band filter used by OM_HALFBAND_* modes
+                 *
+                 * @param taps number of filter taps
+                 */
+                void set_halfband_taps(size_t taps);
+
+                /** Check that module needs re-configuration
+                 *
+                 * @return true if needs reconfiguration
+                 */
+                bool modified() const;
+
+                /** Get current oversampling multiplier
+                 *
+                 * @return current oversampling multiplier
+                 */
+                size_t get_oversampling() const;
+
+                /** Update settings
+                 *
+                 */
+                void update_settings();
+
+                /** Perform processing of the signal
+                 *
+                 * @param dst list of destination buffers of samples size
+                 * @param src list of source buffers of samples size
+                 * @param samples number of samples to process
+                 * @param callback callback to handle buffers
+                 */
+                void process(float * const *dst, const float * const *src, size_t samples, IMultiOversamplerCallback *callback);
+
+                /** Perform processing of the signal
+                 *
+                 * @param dst list of destination buffers of samples size
+                 * @param src list of source buffers of samples size
+                 * @param samples number of samples to process
+                 */
+                inline void process(float * const *dst, const float * const *src, size_t samples)
+                {
+                    process(dst, src, samples, pCallback);
+                }
+
+                /**
+                 * Get oversampler latency
+                 * @return oversampler latency in normal (non-oversampled) samples
+                 */
+                size_t latency() const;
+
+                /**
+                 * Get maximum possible latency
+                 * @return maximum possible latency
+                 */
+                size_t max_latency() const;
+
+                /**
+                 * Dump the state
+                 * @param dumper dumper
+                 */
+                void dump(IStateDumper *v) const;
+        };
+    }
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_UTIL_MULTIOVERSAMPLER_H_ */
@@ -0,0 +1,259 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_UTIL_MULTIRESANALYZER_H_
+#define LSP_PLUG_IN_DSP_UNITS_UTIL_MULTIRESANALYZER_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/common/atomic.h>
+
+#define MRA_LEVELS_MAX              12          /* Maximum number of decimation levels  */
+#define MRA_LEVEL_SHIFT             24          /* Shift of the level number in the frequency index */
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Multi-resolution spectrum analyzer. The signal is split into several levels,
+         * each next level is the previous level decimated by 2 with the half-band filter.
+         * The FFT of the same rank is performed for each level, so each next level has
+         * twice better frequency resolution for the lower half of the spectrum. The
+         * spectrum is then composed of the levels according to the requested frequencies
+         * which gives approximately constant-Q log-frequency spectrum at the cost of
+         * several small FFTs instead of one large FFT.
+         */
+        class MultiResAnalyzer
+        {
+            private:
+                MultiResAnalyzer & operator = (const MultiResAnalyzer &);
+                MultiResAnalyzer(const MultiResAnalyzer &);
+
+            protected:
+                enum reconfigure_flags
+                {
+                    R_ENVELOPE  = 1<<0,
+                    R_WINDOW    = 1<<1,
+                    R_ANALYSIS  = 1<<2,
+                    R_TAU       = 1<<3,
+                    R_COUNTERS  = 1<<4,
+
+                    R_ALL       = R_ENVELOPE | R_WINDOW | R_ANALYSIS | R_TAU | R_COUNTERS
+                };
+
+                typedef struct level_t
+                {
+                    float      *vBuffer;        // Ring buffer of the level signal
+                    float      *vHistory;       // History of the decimation filter
+                    float      *vAmp;           // FFT amplitude
+                    float      *vData[2];       // FFT data, double-buffered
+                    size_t      nHead;          // Head of the ring buffer
+                    size_t      nHistory;       // Position in the history of the decimation filter
+                    size_t      nPhase;         // Decimation phase
+                } level_t;
+
+                typedef struct channel_t
+                {
+                    level_t     vLevels[MRA_LEVELS_MAX];    // Levels
+                    bool        bFreeze;        // Freeze analysis
+                    bool        bActive;        // Enable analysis
+                } channel_t;
+
+            protected:
+                size_t      nChannels;          // Overall number of channels
+                size_t      nLevels;            // Number of levels
+                size_t      nRank;              // FFT rank
+                size_t      nSampleRate;        // Sample rate
+                size_t      nCounter;           // Current counter
+                size_t      nPeriod;            // FFT transform period
+                float       fReactivity;        // FFT reactivity
+                float       fTau;               // Smooth coefficient
+                float       fRate;              // FFT refresh rate
+                float       fShift;             // Gain shift
+                size_t      nReconfigure;       // Reconfiguration flags
+                size_t      nEnvelope;          // Type of spectral envelope
+                size_t      nWindow;            // Type of FFT window
+                atomic_t    nFront;             // Index of the published FFT data buffer
+
+                channel_t  *vChannels;          // List of channels
+                void       *vData;              // Allocated floating-point data
+                float      *vSigRe;             // Real part of signal
+                float      *vFftReIm;           // Buffer for FFT transform
+                const float *vWindow;           // FFT window, shared table
+                float      *vEnvelope;          // FFT envelope for each level
+                float      *vTemp;              // Temporary buffer for decimation
+                float      *vFir;               // Coefficients of the half-band decimation filter
+
+            protected:
+                size_t      decimate(level_t *l, float *dst, const float *src, size_t count);
+                void        push(level_t *l, const float *src, size_t count);
+                void        transform(level_t *l);
+                void        publish();
+
+            public:
+                explicit MultiResAnalyzer();
+                ~MultiResAnalyzer();
+
+                /**
+                 * Construct analyzer
+                 */
+                void        construct();
+
+                /**
+                 * Destroy analyzer
+                 */
+                void        destroy();
+
+            public:
+                /**
+                 * Initialize analyzer
+                 * @param channels number of channels for analysis
+                 * @param rank FFT rank of each level
+                 * @param levels number of levels, limited by MRA_LEVELS_MAX
+                 * @return true on success
+                 */
+                bool        init(size_t channels, size_t rank, size_t levels);
+
+                /**
+                 * Get overall number of channels
+                 * @return overall number of channels
+                 */
+                inline size_t get_channels() const      { return nChannels;     }
+
+                /**
+                 * Get number of levels
+                 * @return number of levels
+                 */
+                inline size_t get_levels() const        { return nLevels;       }
+
+                /**
+                 * Get FFT rank of each level
+                 * @return FFT rank of each level
+                 */
+                inline size_t get_rank() const          { return nRank;         }
+
+                /**
+                 * Set window for analysis
+                 * @param window window
+                 */
+                void        set_window(size_t window);
+
+                /**
+                 * Set envelope for analysis
+                 * @param envelope envelope type
+                 */
+                void        set_envelope(size_t envelope);
+
+                /**
+                 * Set shift gain for analysis
+                 * @param shift shift gain
+                 */
+                void        set_shift(float shift);
+
+                /**
+                 * Set sample rate for analysis
+                 * @param sr sample rate
+                 */
+                void        set_sample_rate(size_t sr);
+
+                /**
+                 * Set-up FFT analysis rate
+                 * @param rate FFT rate
+                 */
+                void        set_rate(float rate);
+
+                /**
+                 * Set-up FFT analysis reactivity
+                 * @param reactivity reactivity (msec)
+                 */
+                void        set_reactivity(float reactivity);
+
+                /**
+                 * Freeze channel
+                 * @param channel channel to freeze
+                 * @param freeze freeze flag
+                 * @return status of operation
+                 */
+                bool        freeze_channel(size_t channel, bool freeze);
+
+                /**
+                 * Enable channel
+                 * @param channel channel to enable
+                 * @param enable enable flag
+                 * @return status of operation
+                 */
+                bool        enable_channel(size_t channel, bool enable);
+
+                /**
+                 * Reset the FFT data of analyzer
+                 */
+                inline void reset()                     { nReconfigure       |= R_ANALYSIS; }
+
+                /**
+                 * Process input signal
+                 * @param in array of pointers to buffers for all channels
+                 *        if pointer is NULL or the pointer to buffer is NULL, it is considered to be zero-filled
+                 * @param samples number of samples to process
+                 */
+                void        process(const float * const *in, size_t samples);
+
+                /**
+                 * Get list of logarithmically spaced frequencies
+                 * @param frq frequency list
+                 * @param idx frequency indexes containing level and frequency numbers for future get_spectrum() call
+                 * @param start start frequency
+                 * @param stop stop frequency
+                 * @param count number of elements
+                 */
+                void        get_frequencies(float *frq, uint32_t *idx, float start, float stop, size_t count);
+
+                /**
+                 * Read spectrum data, can be called by another thread
+                 * @param channel channel
+                 * @param out output buffer
+                 * @param idx array of frequency indexes returned by get_frequencies()
+                 * @param count size of input and output arrays
+                 * @return true on success
+                 */
+                bool        get_spectrum(size_t channel, float *out, const uint32_t *idx, size_t count);
+
+                /**
+                 * Reconfigure analyzer
+                 */
+                void        reconfigure();
+
+                /**
+                 * Check that analyzer needs reconfiguration
+                 * @return true if needs reconfiguration
+                 */
+                inline bool needs_reconfiguration() const   { return nReconfigure; }
+
+                /**
+                 * Dump the state
+                 * @param dumper dumper
+                 */
+                void        dump(IStateDumper *v) const;
+        };
+    }
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_UTIL_MULTIRESANALYZER_H_ */
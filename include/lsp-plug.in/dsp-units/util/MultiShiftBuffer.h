@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_UTIL_MULTISHIFTBUFFER_H_
+#define LSP_PLUG_IN_DSP_UNITS_UTIL_MULTISHIFTBUFFER_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /** Multi-channel shift buffer
+         *    Keeps the data of several channels that are appended and shifted in lockstep.
+         *    Channels are stored one after another in one aligned allocation and share
+         *    the head and tail positions.
+         *
+         *    Each channel operates as the ShiftBuffer in the ring mode: the capacity
+         *    is a power of two and the data is mirrored after the end of the channel,
+         *    so the contents of any channel are always available as contiguous data
+         *    between head() and tail() and no data is moved by shift() and append()
+         */
+        class MultiShiftBuffer
+        {
+            private:
+                MultiShiftBuffer & operator = (const MultiShiftBuffer &);
+                MultiShiftBuffer(const MultiShiftBuffer &);
+
+            protected:
+                float      *vData;          // Data of all channels
+                size_t      nChannels;      // Number of channels
+                size_t      nCapacity;      // Capacity of each channel
+                size_t      nStride;        // Distance between channels
+                size_t      nHead;          // Head position
+                size_t      nTail;          // Tail position
+                uint8_t    *pData;          // Allocated data
+
+            protected:
+                void        ring_write(float *buf, size_t pos, const float *data, size_t count);
+                inline void ring_shift();
+
+            public:
+                explicit MultiShiftBuffer();
+                ~MultiShiftBuffer();
+
+                /**
+                 * Construct the buffer
+                 */
+                void        construct();
+
+                /** Init buffer, all previously stored data will be lost
+                 *
+                 * @param channels number of channels
+                 * @param size the requested size of each channel, rounded up to the power of two
+                 * @param gap number of zero samples initially stored in buffer, can not be greater than size
+                 * @return status of operation
+                 */
+                bool        init(size_t channels, size_t size, size_t gap = 0);
+
+                /** Destroy buffer
+                 *
+                 */
+                void        destroy();
+
+            public:
+                /** Add data to the end of all channels
+                 *
+                 * @param data list of channels() buffers to append, NULL list or NULL element means zeros
+                 * @param count number of samples to append to each channel
+                 * @return number of samples appended
+                 */
+                size_t      append(const float * const *data, size_t count);
+
+                /** Remove data from the beginning of all channels
+                 *
+                 * @param data list of channels() buffers to store the removed samples, NULL list or
+                 *   NULL element means skipping
+                 * @param count number of samples to remove
+                 * @return number of samples removed
+                 */
+                size_t      shift(float * const *data, size_t count);
+
+                /** Remove data from the beginning of all channels
+                 *
+                 * @param count number of samples to remove
+                 * @return number of samples removed
+                 */
+                size_t      shift(size_t count);
+
+                /** Return the number of items in each channel
+                 *
+                 * @return number of items in each channel
+                 */
+                inline size_t size() const          { return nTail - nHead;     }
+
+                /** Get maximum size of each channel
+                 *
+                 * @return maximum size of each channel
+                 */
+                inline size_t capacity() const      { return nCapacity;         }
+
+                /** Get number of channels
+                 *
+                 * @return number of channels
+                 */
+                inline size_t channels() const      { return nChannels;         }
+
+                /** Clear buffer
+                 *
+                 */
+                inline void clear()                 { nHead = nTail = 0;        }
+
+                /** Get the data pointer at the head of the channel
+                 *
+                 * @param channel channel number
+                 * @return data pointer at the head of the channel or NULL
+                 */
+                float      *head(size_t channel);
+
+                /** Get the data pointer at the tail of the channel
+                 *
+                 * @param channel channel number
+                 * @return data pointer at the tail of the channel or NULL
+                 */
+                float      *tail(size_t channel);
+
+                /** Get the data pointer of the channel at the offset from the head
+                 *
+                 * @param channel channel number
+                 * @param offset offset from the head
+                 * @return data pointer or NULL if offset is out of the stored data
+                 */
+                float      *head(size_t channel, size_t offset);
+
+                /** Get the data pointer of the channel at the offset from the tail
+                 *
+                 * @param channel channel number
+                 * @param offset offset from the tail
+                 * @return data pointer or NULL if offset is out of the stored data
+                 */
+                float      *tail(size_t channel, size_t offset);
+
+                /** Get the sample of the channel at the offset from the tail
+                 *
+                 * @param channel channel number
+                 * @param offset offset from the tail, 1 means the last sample
+                 * @return sample or 0 if offset is out of the stored data
+                 */
+                float       last(size_t channel, size_t offset) const;
+
+                /**
+                 * Dump the state
+                 * @param v state dumper
+                 */
+                void        dump(IStateDumper *v) const;
+        };
+    }
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_UTIL_MULTISHIFTBUFFER_H_ */
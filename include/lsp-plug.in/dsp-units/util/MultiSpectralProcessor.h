@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_UTIL_MULTISPECTRALPROCESSOR_H_
+#define LSP_PLUG_IN_DSP_UNITS_UTIL_MULTISPECTRALPROCESSOR_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Multi-channel spectral processor callback function
+         * @param object the object that handles callback
+         * @param subject the subject that is used to handle callback
+         * @param spectrum array of spectral data for each channel (packed complex numbers)
+         * @param rank the overall rank of the FFT transform (log2(size))
+         */
+        typedef void (* multi_spectral_processor_func_t)(void *object, void *subject, float * const *spectrum, size_t rank);
+
+        /**
+         * Multi-channel spectral processor class, performs spectral transform of all
+         * input channels synchronously and launches callback function to process
+         * spectra of all channels at once
+         */
+        class MultiSpectralProcessor
+        {
+            private:
+                MultiSpectralProcessor & operator = (const MultiSpectralProcessor &);
+                MultiSpectralProcessor(const MultiSpectralProcessor &);
+
+            protected:
+                typedef struct channel_t
+                {
+                    float                      *pOutBuf;    // Output buffer
+                    float                      *pInBuf;     // Input buffer
+                    float                      *pFftBuf;    // FFT buffer
+                } channel_t;
+
+            protected:
+                size_t                      nChannels;  // Number of channels
+                size_t                      nRank;      // Current FFT rank
+                size_t                      nMaxRank;   // Maximum FFT rank
+                float                       fPhase;     // Phase
+                float                       fOverlap;   // Overlap of frames
+                size_t                      nHop;       // Distance between frames
+                float                      *pWnd;       // Window function
+                const float                *pFftTable;  // Twiddle table of the real-input FFT
+                channel_t                  *vChannels;  // List of channels
+                float                     **vSpectra;   // List of spectra passed to the callback
+                size_t                      nOffset;    // Read/Write offset
+                uint8_t                    *pData;      // Data buffer
+                bool                        bUpdate;    // Update flag
+
+                // Bindings
+                multi_spectral_processor_func_t pFunc;  // Function
+                void                       *pObject;    // Object to operate
+                void                       *pSubject;   // Subject to operate
+
+            public:
+                explicit MultiSpectralProcessor();
+                ~MultiSpectralProcessor();
+
+                /**
+                 * Construct object
+                 */
+                void            construct();
+
+                /**
+                 * Initialize spectral processor
+                 * @param channels number of channels
+                 * @param max_rank maximum FFT rank
+                 * @return status of operation
+                 */
+                bool            init(size_t channels, size_t max_rank);
+
+                /**
+                 * Destroy spectral processor
+                 */
+                void            destroy();
+
+            public:
+                /**
+                 * Bind spectral processor to the handler
+                 * @param func function to call
+                 * @param object the target object to pass to the function
+                 * @param subject the target subject to pass to the function
+                 */
+                void            bind(multi_spectral_processor_func_t func, void *object, void *subject);
+
+                /**
+                 * Unbind spectral processor
+                 */
+                void            unbind();
+
+                /**
+                 * Check that spectral processor needs update
+                 * @return true if spectral processor needs update
+                 */
+                inline bool     needs_update() const        { return bUpdate;           }
+
+                /**
+                 * Update settings of the spectral processor
+                 */
+                void            update_settings();
+
+                /**
+                 * Get number of channels
+                 * @return number of channels
+                 */
+                inline size_t   channels() const            { return nChannels;         }
+
+                /**
+                 * Get the FFT rank
+                 * @return FFT rank
+                 */
+                inline size_t   get_rank() const            { return nRank;             }
+
+                /**
+                 * Get processing phase
+                 * @return processing phase
+                 */
+                inline float    phase() const               { return fPhase;            }
+
+                /**
+                 * Set processing phase
+                 * @param phase the phase value between 0 and 1
+                 */
+                void            set_phase(float phase);
+
+                /**
+                 * Set the FFT rank
+                 */
+                void            set_rank(size_t rank);
+
+                /**
+                 * Get the overlap of frames
+                 * @return overlap of frames
+                 */
+                inline float    overlap() const             { return fOverlap;          }
+
+                /**
+                 * Set the overlap of frames, see SpectralProcessor::set_overlap()
+                 * @param overlap overlap of frames, between 0 and 1 (exclusive), default is 0.5
+                 */
+                void            set_overlap(float overlap);
+
+                /**
+                 * Get the distance between frames (hop size) applied by the last settings update
+                 * @return hop size in samples
+                 */
+                inline size_t   hop() const                 { return nHop;              }
+
+                /**
+                 * Get latency of the spectral processor
+                 * @return latency of the spectral processor
+                 */
+                inline size_t   latency() const             { return 1 << nRank;        }
+
+                /**
+                 * Perform audio processing
+                 * @param dst list of destination buffers, one per channel
+                 * @param src list of source buffers, one per channel
+                 * @param count number of samples to process
+                 */
+                void            process(float * const *dst, const float * const *src, size_t count);
+
+                /**
+                 * Dump the state
+                 * @param dumper dumper
+                 */
+                void            dump(IStateDumper *v) const;
+        };
+    }
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_UTIL_MULTISPECTRALPROCESSOR_H_ */
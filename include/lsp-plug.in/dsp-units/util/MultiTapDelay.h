@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_UTIL_MULTITAPDELAY_H_
+#define LSP_PLUG_IN_DSP_UNITS_UTIL_MULTITAPDELAY_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Multi-tap delay: the input signal is written once into the ring buffer
+         * and read by multiple taps, each tap has it's own delay and gain.
+         * Changes of the delay and the gain of the tap are ramped over the
+         * next process() call.
+         */
+        class MultiTapDelay
+        {
+            private:
+                MultiTapDelay & operator = (const MultiTapDelay &);
+                MultiTapDelay(const MultiTapDelay &);
+
+            protected:
+                typedef struct tap_t
+                {
+                    size_t      nDelay;         // Current delay
+                    size_t      nNewDelay;      // Delay to ramp to
+                    float       fGain;          // Current gain
+                    float       fNewGain;       // Gain to ramp to
+                } tap_t;
+
+            protected:
+                float      *vBuffer;        // Ring buffer
+                tap_t      *vTaps;          // List of taps
+                size_t      nHead;          // Write position
+                size_t      nSize;          // Size of the ring buffer
+                size_t      nMaxDelay;      // Maximum delay
+                size_t      nTaps;          // Number of taps
+                uint8_t    *pData;          // Allocated data
+
+            protected:
+                void        process_taps(float *sum, float * const *out, const float *src, size_t count);
+
+            public:
+                explicit MultiTapDelay();
+                ~MultiTapDelay();
+
+                /**
+                 * Construct the object
+                 */
+                void        construct();
+
+                /**
+                 * Destroy the object
+                 */
+                void        destroy();
+
+            public:
+                /** Initialize delay
+                 *
+                 * @param max_delay maximum delay of the tap in samples
+                 * @param taps number of taps
+                 * @return status of operation
+                 */
+                bool        init(size_t max_delay, size_t taps);
+
+                /**
+                 * Get number of taps
+                 * @return number of taps
+                 */
+                inline size_t   taps() const            { return nTaps;         }
+
+                /**
+                 * Get maximum delay of the tap
+                 * @return maximum delay of the tap in samples
+                 */
+                inline size_t   max_delay() const       { return nMaxDelay;     }
+
+                /** Set delay of the tap, the delay is ramped from the previous
+                 * value during the next process() call
+                 *
+                 * @param tap tap number
+                 * @param delay delay in samples
+                 */
+                void        set_delay(size_t tap, size_t delay);
+
+                /** Get delay of the tap
+                 *
+                 * @param tap tap number
+                 * @return delay of the tap in samples
+                 */
+                size_t      get_delay(size_t tap) const;
+
+                /** Set gain of the tap, the gain is ramped from the previous
+                 * value during the next process() call
+                 *
+                 * @param tap tap number
+                 * @param gain gain of the tap
+                 */
+                void        set_gain(size_t tap, float gain);
+
+                /** Get gain of the tap
+                 *
+                 * @param tap tap number
+                 * @return gain of the tap
+                 */
+                float       get_gain(size_t tap) const;
+
+                /** Process data, outputs of all taps are summed
+                 *
+                 * @param dst destination buffer, may be the same as source buffer
+                 * @param src source buffer
+                 * @param count number of samples to process
+                 */
+                void        process(float *dst, const float *src, size_t count);
+
+                /** Process data, each tap is written to the separate buffer
+                 *
+                 * @param dst list of destination buffers, one per tap, any element may be NULL
+                 * @param src source buffer
+                 * @param count number of samples to process
+                 */
+                void        process(float * const *dst, const float *src, size_t count);
+
+                /** Clear internal delay buffer
+                 *
+                 */
+                void        clear();
+
+                /**
+                 * Dump internal state
+                 * @param v state dumper
+                 */
+                void        dump(IStateDumper *v) const;
+        };
+    }
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_UTIL_MULTITAPDELAY_H_ */
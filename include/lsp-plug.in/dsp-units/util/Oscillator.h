@@ -26,6 +26,8 @@
 #include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
 #include <lsp-plug.in/dsp-units/util/Oversampler.h>
 
+#define OSCILLATOR_BLEP_POINTS          4       /* Maximum number of wave discontinuities corrected in BL_POLYBLEP mode */
+
 namespace lsp
 {
     namespace dspu
@@ -56,6 +58,13 @@ namespace lsp
             DC_MAX
         };
 
+        enum bl_mode_t
+        {
+            BL_OVERSAMPLING,                                // Synthesize the naive wave at oversampled rate and downsample it
+            BL_POLYBLEP,                                    // Synthesize the naive wave at 1x rate and correct its discontinuities with polynomial residuals
+            BL_MAX
+        };
+
         class Oscillator
         {
             private:
@@ -118,6 +127,13 @@ namespace lsp
                     float           fBLPeakAtten;           // Value of attenuation to bring peak of band limited wave to 1.0f.
                 } parabolic_t;
 
+                typedef struct blep_t
+                {
+                    phacc_t         nPhase;                 // Phase of the discontinuity, as phase accumulator word scaled to 32 bits.
+                    float           fStep;                  // Jump of the wave value at the discontinuity.
+                    float           fSlope;                 // Jump of the wave derivative at the discontinuity, per sample.
+                } blep_t;
+
             private:
                 fg_function_t       enFunction;             // Function for the oscillator.
                 float               fAmplitude;             // Amplitude of the oscillator. [ Gain ]
@@ -154,9 +170,50 @@ namespace lsp
                 over_mode_t         enOverMode;             // Oversampler mode.
                 phacc_t             nFreqCtrlWord_Over;     // Frequency control word for the oversampled phase accumulator.
 
+                bl_mode_t           enBLMode;               // Band limiting mode.
+                blep_t              vBlep[OSCILLATOR_BLEP_POINTS]; // Discontinuities of the wave corrected in BL_POLYBLEP mode.
+                size_t              nBlepPoints;            // Number of discontinuities to correct.
+
                 bool                bSync;                  // Flag that indicates that generator needs update
 
             protected:
+                /** Get the attenuation of the band limited wave
+                 *
+                 * @return attenuation to bring the peak of the band limited wave to 1.0f
+                 */
+                float bl_peak_atten() const;
+
+                /** Render the naive wave for the block of phase accumulator values
+                 *
+                 * @param dst destination buffer
+                 * @param ph phase accumulator values
+                 * @param k the gain applied to the wave
+                 * @param count number of samples to render, multiple of 8
+                 */
+                void render(float *dst, const phacc_t *ph, float k, size_t count);
+
+                /** Synthesize the naive wave with block kernels and advance the phase accumulator
+                 *
+                 * @param dst destination buffer
+                 * @param step the frequency control word to advance the phase accumulator
+                 * @param k the gain applied to the wave
+                 * @param count number of samples to synthesize
+                 */
+                void synthesize(float *dst, phacc_t step, float k, size_t count);
+
+                /** Compute the discontinuities of the band limited wave for
+                 * the BL_POLYBLEP mode
+                 */
+                void update_blep();
+
+                /** Add the discontinuity to the list of corrected ones
+                 *
+                 * @param phase phase of the discontinuity scaled to 32 bits
+                 * @param step jump of the wave value
+                 * @param slope jump of the wave derivative per sample
+                 */
+                void add_blep(phacc_t phase, float step, float slope);
+
                 /** Synthesize the required wave and write its sample to internal
                  * buffer.
                  *
@@ -337,6 +394,16 @@ namespace lsp
                  */
                 void set_oversampler_mode(over_mode_t mode);
 
+                /** Set the band limiting mode for the FG_BL_* waves. BL_OVERSAMPLING
+                 * synthesizes the wave at the oversampled rate of the mode set by
+                 * set_oversampler_mode(), BL_POLYBLEP synthesizes the wave at 1x rate
+                 * and smooths out the discontinuities with polynomial residuals, which
+                 * is much cheaper at the cost of weaker alias rejection near Nyquist
+                 *
+                 * @param mode band limiting mode
+                 */
+                void set_band_limit_mode(bl_mode_t mode);
+
                 /** Set the amplitude of the oscillator:
                  *
                  * @param amplitude amplitude of the oscillator.
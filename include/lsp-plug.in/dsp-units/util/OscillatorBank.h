@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_UTIL_OSCILLATORBANK_H_
+#define LSP_PLUG_IN_DSP_UNITS_UTIL_OSCILLATORBANK_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Bank of sinusoidal oscillators for additive synthesis: the phase
+         * accumulators and parameters of all oscillators are stored as
+         * structure of arrays and all oscillators are rendered by one pass
+         * into the single output buffer. Changes of the amplitude are ramped
+         * over the next process call, oscillators with negative frequency or
+         * frequency at or above the Nyquist frequency are muted.
+         */
+        class OscillatorBank
+        {
+            private:
+                OscillatorBank & operator = (const OscillatorBank &);
+                OscillatorBank(const OscillatorBank &);
+
+            protected:
+                uint32_t       *vPhase;         // Phase accumulators, 32 bits
+                uint32_t       *vInitPhase;     // Initial phase words
+                uint32_t       *vStep;          // Frequency control words
+                float          *vGain;          // Current amplitude
+                float          *vNewGain;       // Amplitude to ramp to
+                float          *vDelta;         // Amplitude increment per sample during the ramp
+                float          *vFrequency;     // Frequency of the oscillator
+                float          *vAmplitude;     // Amplitude of the oscillator
+                float          *vPhaseShift;    // Initial phase of the oscillator [rad]
+                size_t          nOscillators;   // Number of oscillators
+                size_t          nCapacity;      // Number of oscillators aligned to the number of lanes
+                size_t          nSampleRate;    // Sample rate
+                float           fDCOffset;      // DC offset of the output
+                bool            bSync;          // Settings need update
+                bool            bReset;         // Apply the amplitude without ramping on the next update
+                uint8_t        *pData;          // Allocated data
+
+            protected:
+                void            synthesize(float *dst, size_t count);
+                void            start_ramp(size_t count);
+                void            finish_ramp();
+
+            public:
+                explicit OscillatorBank();
+                ~OscillatorBank();
+
+                /**
+                 * Construct the object
+                 */
+                void            construct();
+
+                /**
+                 * Destroy the object
+                 */
+                void            destroy();
+
+            public:
+                /** Initialize the bank, all oscillators have zero frequency,
+                 * zero phase and unit amplitude
+                 *
+                 * @param oscillators number of oscillators
+                 * @return status of operation
+                 */
+                bool            init(size_t oscillators);
+
+                /** Check that the bank needs settings update
+                 *
+                 * @return true if the bank needs settings update
+                 */
+                inline bool     needs_update() const        { return bSync;             }
+
+                /** This method should be called if needs_update() returns true
+                 * before calling process() methods
+                 */
+                void            update_settings();
+
+                /**
+                 * Get number of oscillators
+                 * @return number of oscillators
+                 */
+                inline size_t   oscillators() const         { return nOscillators;      }
+
+                /** Set sample rate, resets the phase of all oscillators, the
+                 * amplitude is applied without ramping
+                 *
+                 * @param sr sample rate
+                 */
+                void            set_sample_rate(size_t sr);
+
+                /** Set frequency of the oscillator
+                 *
+                 * @param id oscillator number
+                 * @param frequency frequency [Hz]
+                 */
+                void            set_frequency(size_t id, float frequency);
+
+                /** Get frequency of the oscillator
+                 *
+                 * @param id oscillator number
+                 * @return frequency [Hz]
+                 */
+                float           get_frequency(size_t id) const;
+
+                /** Set amplitude of the oscillator, the amplitude is ramped from
+                 * the previous value during the next process call
+                 *
+                 * @param id oscillator number
+                 * @param amplitude amplitude of the oscillator
+                 */
+                void            set_amplitude(size_t id, float amplitude);
+
+                /** Get amplitude of the oscillator
+                 *
+                 * @param id oscillator number
+                 * @return amplitude of the oscillator
+                 */
+                float           get_amplitude(size_t id) const;
+
+                /** Set initial phase of the oscillator, the running phase of
+                 * the oscillator is shifted by the change of the initial phase
+                 *
+                 * @param id oscillator number
+                 * @param phase initial phase [rad]
+                 */
+                void            set_phase(size_t id, float phase);
+
+                /** Get initial phase of the oscillator
+                 *
+                 * @param id oscillator number
+                 * @return initial phase [rad]
+                 */
+                float           get_phase(size_t id) const;
+
+                /** Set DC offset of the output
+                 *
+                 * @param dc DC offset
+                 */
+                inline void     set_dc_offset(float dc)     { fDCOffset = dc;           }
+
+                /** Get DC offset of the output
+                 *
+                 * @return DC offset
+                 */
+                inline float    get_dc_offset() const       { return fDCOffset;         }
+
+                /** Reset the phase of all oscillators to their initial phase
+                 */
+                void            reset_phase();
+
+                /** Output the sum of oscillators to the destination buffer in
+                 * additive mode
+                 *
+                 * @param dst output wave destination
+                 * @param src input source, allowed to be NULL
+                 * @param count number of samples to synthesise
+                 */
+                void            process_add(float *dst, const float *src, size_t count);
+
+                /** Output the sum of oscillators to the destination buffer in
+                 * multiplicative mode
+                 *
+                 * @param dst output wave destination
+                 * @param src input source, allowed to be NULL
+                 * @param count number of samples to process
+                 */
+                void            process_mul(float *dst, const float *src, size_t count);
+
+                /** Output the sum of oscillators to the destination buffer
+                 * overwriting its content
+                 *
+                 * @param dst output wave destination
+                 * @param count number of samples to process
+                 */
+                void            process_overwrite(float *dst, size_t count);
+
+                /**
+                 * Dump internal state
+                 * @param v state dumper
+                 */
+                void            dump(IStateDumper *v) const;
+        };
+    }
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_UTIL_OSCILLATORBANK_H_ */
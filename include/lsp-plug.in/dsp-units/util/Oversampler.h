@@ -24,8 +24,18 @@
 
 #include <lsp-plug.in/dsp-units/version.h>
 #include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/dsp-units/misc/memory.h>
 #include <lsp-plug.in/dsp-units/filters/Filter.h>
 
+#define OS_HALFBAND_STAGES_MAX      3       /* Maximum number of half-band stages (8x) */
+#define OS_HALFBAND_TAPS_MIN        7       /* Minimum number of taps of the half-band filter */
+#define OS_HALFBAND_TAPS_MAX        127     /* Maximum number of taps of the half-band filter */
+#define OS_HALFBAND_TAPS_DFL        31      /* Default number of taps of the half-band filter */
+#define OS_IIR_COEFFS               8       /* Number of allpass coefficients of the half-band IIR filter */
+#define OS_CALLBACK_CHAIN_MAX       8       /* Maximum number of chained callbacks */
+#define OS_TRANSITION_DFL           0x200   /* Default length of the mode transition in samples */
+#define OS_TRANSITION_MAX           0x2000  /* Maximum length of the mode transition in samples */
+
 namespace lsp
 {
     namespace dspu
@@ -72,7 +82,15 @@ namespace lsp
 
             OM_LANCZOS_8X2,
             OM_LANCZOS_8X3,
-            OM_LANCZOS_8X4
+            OM_LANCZOS_8X4,
+
+            OM_HALFBAND_2X,
+            OM_HALFBAND_4X,
+            OM_HALFBAND_8X,
+
+            OM_IIR_2X,
+            OM_IIR_4X,
+            OM_IIR_8X
         };
 
         /** Oversampler class
@@ -94,8 +112,40 @@ namespace lsp
                     UP_ALL          = UP_MODE | UP_OTHER | UP_SAMPLE_RATE
                 };
 
+                typedef struct allpass_t
+                {
+                    float                   vX[OS_IIR_COEFFS];  // Input memory of allpass sections
+                    float                   vY[OS_IIR_COEFFS];  // Output memory of allpass sections
+                } allpass_t;
+
+                typedef struct halfband_t
+                {
+                    float                  *vUp;            // History of the interpolation filter
+                    float                  *vDown;          // History of the decimation filter
+                    size_t                  nUpHead;        // Head of the interpolation history
+                    size_t                  nDownHead;      // Head of the decimation history
+                    size_t                  nDownPhase;     // Decimation phase
+                    allpass_t               sUpIIR;         // State of the IIR interpolation filter
+                    allpass_t               sDownIIR;       // State of the IIR decimation filter
+                } halfband_t;
+
+                typedef struct fade_t
+                {
+                    float                  *vUpBuffer;      // Oversampling buffer
+                    float                  *vHBFir;         // Coefficients of the half-band filter
+                    Filter                 *pFilter;        // Anti-aliasing filter
+                    size_t                  nUpHead;        // Head of the oversampling buffer
+                    size_t                  nMode;          // Oversampling mode
+                    size_t                  nHBCoeffs;      // Number of coefficients of the half-band filter
+                    size_t                  nLatency;       // Latency
+                    bool                    bFilter;        // Anti-aliasing filter is enabled
+                    halfband_t              vHalfBand[OS_HALFBAND_STAGES_MAX];
+                } fade_t;
+
             protected:
                 IOversamplerCallback   *pCallback;
+                IOversamplerCallback   *vChain[OS_CALLBACK_CHAIN_MAX];  // Chained callbacks called after the main callback
+                size_t                  nChain;         // Number of chained callbacks
                 float                  *fUpBuffer;
                 float                  *fDownBuffer;
                 size_t                  nUpHead;
@@ -103,8 +153,38 @@ namespace lsp
                 size_t                  nSampleRate;
                 size_t                  nUpdate;
                 Filter                  sFilter;
+                Filter                  sFadeFilter;    // Second anti-aliasing filter used by mode transitions
+                Filter                 *pFilter;        // Anti-aliasing filter of the current mode
+                fade_t                  sFade;          // State of the mode that fades out
+                float                  *vFadeBuf;       // Output of the mode that fades out
+                size_t                  nFadeLength;    // Length of the mode transition
+                size_t                  nFadeLeft;      // Number of samples left till the end of transition
+                size_t                  nActMode;       // Mode the current state has been configured for
+                size_t                  nActHBCoeffs;   // Half-band filter the current state has been configured for
+                bool                    bActFilter;     // Filtering the current state has been configured for
                 uint8_t                *bData;
                 bool                    bFilter;
+                size_t                  nHBCoeffs;      // Number of non-zero odd coefficients of the half-band filter
+                float                  *vHBFir;         // Odd coefficients of the half-band filter
+                halfband_t              vHalfBand[OS_HALFBAND_STAGES_MAX];
+                float                   vIIRCoeffs[OS_IIR_COEFFS];  // Coefficients of the half-band IIR filter
+                float                   fIIRDelay;      // Group delay of the IIR stage at DC
+
+            protected:
+                size_t                  halfband_stages() const;
+                void                    design_halfband();
+                void                    clear_halfband();
+                void                    halfband_upsample(halfband_t *hb, float *dst, const float *src, size_t count);
+                size_t                  halfband_downsample(halfband_t *hb, float *dst, const float *src, size_t count);
+                void                    design_iir();
+                void                    iir_upsample(halfband_t *hb, float *dst, const float *src, size_t count);
+                size_t                  iir_downsample(halfband_t *hb, float *dst, const float *src, size_t count);
+                void                    cascade_upsample(float *dst, const float *src, size_t count);
+                void                    cascade_downsample(float *dst, const float *src, size_t count);
+                void                    run_callbacks(IOversamplerCallback *callback, float *dst, const float *src, size_t count);
+                void                    swap_state();
+                void                    reset_state();
+                void                    process_mode(float *dst, const float *src, size_t samples, IOversamplerCallback *callback);
 
             public:
                 explicit Oversampler();
@@ -138,6 +218,40 @@ namespace lsp
                     pCallback       = callback;
                 }
 
+                /** Add the callback to the end of the chain. All callbacks of the chain are called
+                 * one after another at the oversampled rate after the main callback, the signal
+                 * is processed in place in the oversampling buffer, so the chain costs one
+                 * upsampling and one downsampling for all stages
+                 *
+                 * @param callback callback to add
+                 * @return true if the callback has been added, false if the chain is full
+                 */
+                bool add_callback(IOversamplerCallback *callback);
+
+                /** Remove the callback from the chain, the order of other callbacks is kept
+                 *
+                 * @param callback callback to remove
+                 * @return true if the callback has been removed
+                 */
+                bool remove_callback(IOversamplerCallback *callback);
+
+                /** Remove all callbacks from the chain
+                 *
+                 */
+                inline void clear_callbacks()
+                {
+                    nChain          = 0;
+                }
+
+                /** Get number of callbacks in the chain
+                 *
+                 * @return number of callbacks in the chain
+                 */
+                inline size_t callbacks() const
+                {
+                    return nChain;
+                }
+
                 /** Set oversampling ratio
                  *
                  * @param mode oversampling mode
@@ -146,8 +260,8 @@ namespace lsp
                 {
                     if (mode < OM_NONE)
                         mode = OM_NONE;
-                    else if (mode > OM_LANCZOS_8X3)
-                        mode = OM_LANCZOS_8X3;
+                    else if (mode > OM_IIR_8X)
+                        mode = OM_IIR_8X;
                     if (nMode == mode)
                         return;
                     nMode      = mode;
@@ -166,6 +280,61 @@ namespace lsp
                     nUpdate   |= UP_MODE;
                 }
 
+                /** Set the length of the half-band filter used by OM_HALFBAND_* modes.
+                 * The half-band polyphase filter is applied at each 2x stage of
+                 * upsampling and downsampling, longer filter gives better stopband
+                 * attenuation at the cost of CPU and latency
+                 *
+                 * @param taps number of filter taps, rounded to the nearest 4*k - 1 value
+                 */
+                void set_halfband_taps(size_t taps);
+
+                /** Set the length of the transition between modes. When the mode or the
+                 * half-band filter is changed, the previous mode keeps running and process()
+                 * crossfades its output to the output of the new mode, zero length switches
+                 * the mode immediately with the full reset of the oversampling buffers
+                 *
+                 * @param samples length of the transition in samples
+                 */
+                void set_transition(size_t samples);
+
+                /** Get the length of the transition between modes
+                 *
+                 * @return length of the transition in samples
+                 */
+                inline size_t get_transition() const
+                {
+                    return nFadeLength;
+                }
+
+                /** Check that the transition between modes is in progress
+                 *
+                 * @return true if the transition is in progress
+                 */
+                inline bool in_transition() const
+                {
+                    return nFadeLeft > 0;
+                }
+
+                /** Get latency of the previous mode that fades out during the transition,
+                 * the host can compare it with latency() to compensate the latency change
+                 *
+                 * @return latency of the previous mode or latency() if there is no transition
+                 */
+                inline size_t transition_latency() const
+                {
+                    return (nFadeLeft > 0) ? sFade.nLatency : latency();
+                }
+
+                /** Get the actual length of the half-band filter
+                 *
+                 * @return number of filter taps
+                 */
+                inline size_t get_halfband_taps() const
+                {
+                    return nHBCoeffs * 4 - 1;
+                }
+
                 /** Check that module needs re-configuration
                  *
                  * @return true if needs reconfiguration
@@ -186,7 +355,7 @@ namespace lsp
                  */
                 void update_settings();
 
-                /** Perform upsampling of the signal
+                /** Perform upsampling of the signal, cancels the transition between modes
                  *
                  * @param dst destination buffer of samples*ratio size
                  * @param src source buffer of samples size
@@ -194,7 +363,7 @@ namespace lsp
                  */
                 void upsample(float *dst, const float *src, size_t samples);
 
-                /** Perform downsampling of the signal
+                /** Perform downsampling of the signal, cancels the transition between modes
                  *
                  * @param dst destination buffer of samples size
                  * @param src source buffer of samples*ratio size
@@ -232,8 +401,14 @@ namespace lsp
                  * Get maximum possible latency
                  * @return maximum possible latency
                  */
-                inline size_t max_latency() const       { return 8; }
+                size_t max_latency() const;
     
+                /**
+                 * Add the memory footprint of the oversampler to the report
+                 * @param r report to update
+                 */
+                void memory_usage(memory_report_t *r) const;
+
                 /**
                  * Dump the state
                  * @param dumper dumper
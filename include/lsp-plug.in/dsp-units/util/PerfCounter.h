@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_UTIL_PERFCOUNTER_H_
+#define LSP_PLUG_IN_DSP_UNITS_UTIL_PERFCOUNTER_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/common/atomic.h>
+#include <lsp-plug.in/common/types.h>
+
+/**
+ * The instrumentation of units is compiled in only when LSP_DSP_UNITS_PERF_COUNTERS is defined,
+ * otherwise the counters of units stay zero and the instrumentation has no runtime cost
+ */
+#ifdef LSP_DSP_UNITS_PERF_COUNTERS
+    #define LSP_DSP_UNITS_PERF_SCOPE(counter, samples) \
+        ::lsp::dspu::PerfScope perf_scope__(&(counter), samples)
+    #define LSP_DSP_UNITS_PERF_RECONFIGURE(counter) \
+        (counter).reconfigured()
+#else
+    #define LSP_DSP_UNITS_PERF_SCOPE(counter, samples)
+    #define LSP_DSP_UNITS_PERF_RECONFIGURE(counter)
+#endif /* LSP_DSP_UNITS_PERF_COUNTERS */
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Consistent copy of the performance counters
+         */
+        typedef struct perf_counters_t
+        {
+            uint64_t    nCalls;             // Number of process() calls
+            uint64_t    nSamples;           // Number of processed samples
+            uint64_t    nTime;              // Total time spent in process() calls [ns]
+            uint64_t    nReconfigs;         // Number of reconfigurations
+        } perf_counters_t;
+
+        /**
+         * Performance counters of the unit. The counters are updated by the processing
+         * thread only and can be read lock-free from any other thread: the writer marks
+         * the update by the sequence number and the reader retries if the sequence
+         * number has changed during the read.
+         */
+        class PerfCounter
+        {
+            private:
+                PerfCounter & operator = (const PerfCounter &);
+                PerfCounter(const PerfCounter &);
+
+            protected:
+                atomic_t            nSeq;           // Sequence number, odd while the update is in progress
+                perf_counters_t     sData;          // Counters
+
+            protected:
+                inline void         begin_update()  { atomic_add(&nSeq, 1); }
+                inline void         end_update()    { atomic_add(&nSeq, 1); }
+
+            public:
+                explicit PerfCounter();
+                ~PerfCounter();
+
+                /**
+                 * Construct object
+                 */
+                void                construct();
+
+            public:
+                /**
+                 * Get current timestamp
+                 * @return timestamp in nanoseconds
+                 */
+                static uint64_t     timestamp();
+
+                /**
+                 * Account the process() call, should be called by the processing thread
+                 * @param samples number of processed samples
+                 * @param time time spent in the call [ns]
+                 */
+                void                processed(size_t samples, uint64_t time);
+
+                /**
+                 * Account the reconfiguration, should be called by the processing thread
+                 */
+                void                reconfigured();
+
+                /**
+                 * Reset all counters, should be called by the processing thread
+                 */
+                void                reset();
+
+                /**
+                 * Read the consistent copy of counters, can be called from any thread
+                 * @param dst destination to store the counters
+                 */
+                void                read(perf_counters_t *dst) const;
+
+                /**
+                 * Dump the state
+                 * @param v state dumper
+                 */
+                void                dump(IStateDumper *v) const;
+        };
+
+        /**
+         * Scope that accounts the time spent between the construction and destruction
+         */
+        class PerfScope
+        {
+            private:
+                PerfScope & operator = (const PerfScope &);
+                PerfScope(const PerfScope &);
+
+            protected:
+                PerfCounter        *pCounter;
+                size_t              nSamples;
+                uint64_t            nStart;
+
+            public:
+                inline explicit PerfScope(PerfCounter *counter, size_t samples)
+                {
+                    pCounter    = counter;
+                    nSamples    = samples;
+                    nStart      = PerfCounter::timestamp();
+                }
+
+                inline ~PerfScope()
+                {
+                    pCounter->processed(nSamples, PerfCounter::timestamp() - nStart);
+                }
+        };
+    } /* namespace dspu */
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_UTIL_PERFCOUNTER_H_ */
@@ -0,0 +1,313 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_UTIL_PROCESSGRAPH_H_
+#define LSP_PLUG_IN_DSP_UNITS_UTIL_PROCESSGRAPH_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/dsp-units/util/Delay.h>
+#include <lsp-plug.in/dsp-units/util/WorkerPool.h>
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/lltl/darray.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Processing function of the graph node
+         *
+         * @param object the object that handles callback
+         * @param subject the subject that is used to handle callback
+         * @param out list of output buffers of the node
+         * @param in list of input buffers of the node, should not be modified
+         * @param samples number of samples to process
+         */
+        typedef void (* graph_process_t)(void *object, void *subject, float * const *out, const float * const *in, size_t samples);
+
+        /**
+         * Processing graph, connects processing units into the network and processes
+         * the signal through the whole network. The graph computes the order of
+         * processing, shares the minimal pool of temporary buffers between the
+         * connections that do not live at the same time, and compensates the
+         * latency of units with delays, so all the signals that meet at the input
+         * of the node or at the output of the graph are aligned in time.
+         *
+         * The nodes that do not depend on each other are grouped into levels, the nodes
+         * of the same level can be processed in parallel by the WorkerPool.
+         *
+         * The structure of the graph can be changed only outside of the processing
+         * thread, the compile() should be called after any change of the structure
+         * or latency of nodes.
+         */
+        class ProcessGraph
+        {
+            private:
+                ProcessGraph & operator = (const ProcessGraph &);
+                ProcessGraph(const ProcessGraph &);
+
+            protected:
+                enum src_t
+                {
+                    SRC_INPUT   = -1,                   // Source is the input of the graph
+                    SRC_NONE    = -2                    // Not connected
+                };
+
+                enum ref_t
+                {
+                    REF_ZERO    = -1,                   // Shared buffer filled with zeros
+                    REF_SINK    = -2,                   // Shared buffer for discarded outputs
+                    REF_INPUT   = -3                    // First input of the graph, REF_INPUT - i for i'th input
+                };
+
+                typedef struct link_t
+                {
+                    ssize_t             nNode;          // Source node, SRC_INPUT or SRC_NONE
+                    size_t              nPort;          // Output port of the source node or index of graph input
+                } link_t;
+
+                typedef struct node_t
+                {
+                    graph_process_t     pFunc;          // Processing function
+                    void               *pObject;        // Object passed to the function
+                    void               *pSubject;       // Subject passed to the function
+                    size_t              nInputs;        // Number of inputs
+                    size_t              nOutputs;       // Number of outputs
+                    size_t              nLatency;       // Latency introduced by the node
+                    size_t              nLink;          // Index of the first input link
+                    size_t              nFirstOut;      // Index of the first output in the list of all outputs
+                    size_t              nPending;       // Number of unresolved dependencies while sorting
+                    size_t              nArrival;       // Latency of the signal at the inputs of the node
+                    size_t              nLevel;         // Level of the node in the dependency graph
+                } node_t;
+
+                typedef struct delay_t
+                {
+                    Delay              *pDelay;         // Delay line
+                    ssize_t             nSrc;           // Source buffer reference
+                    ssize_t             nDst;           // Destination buffer reference or index of graph output
+                } delay_t;
+
+                typedef struct step_t
+                {
+                    size_t              nNode;          // Index of the node to process
+                    size_t              nRef;           // Index of the first buffer reference: inputs, then outputs
+                    size_t              nDelay;         // Index of the first delay applied to inputs
+                    size_t              nDelays;        // Number of delays applied to inputs
+                } step_t;
+
+                typedef struct level_t
+                {
+                    size_t              nFirst;         // Index of the first step
+                    size_t              nSteps;         // Number of independent steps
+                } level_t;
+
+                typedef struct output_t
+                {
+                    ssize_t             nRef;           // Buffer reference
+                    Delay              *pDelay;         // Delay that aligns the output, NULL if not needed
+                } output_t;
+
+            protected:
+                lltl::darray<node_t>    vNodes;         // List of nodes
+                lltl::darray<link_t>    vLinks;         // Sources of all node inputs
+                lltl::darray<link_t>    vOutLinks;      // Sources of graph outputs
+                size_t                  nInputs;        // Number of graph inputs
+
+                lltl::darray<step_t>    vSteps;         // Processing plan
+                lltl::darray<level_t>   vLevels;        // Groups of independent steps
+                lltl::darray<ssize_t>   vRefs;          // Buffer references of the plan
+                lltl::darray<delay_t>   vDelays;        // Latency compensation of node inputs
+                lltl::darray<output_t>  vOutputs;       // Graph outputs
+                size_t                  nBuffers;       // Number of temporary buffers
+                size_t                  nBufSize;       // Size of each temporary buffer
+                size_t                  nLatency;       // Overall latency of the graph
+                bool                    bCompiled;      // Plan is up to date
+                WorkerPool             *pWorkers;       // Worker pool for parallel processing
+
+                const float * const    *pIn;            // Inputs of the currently processed chunk
+                size_t                  nOffset;        // Offset of the currently processed chunk
+                size_t                  nToDo;          // Size of the currently processed chunk
+                size_t                  nLevelFirst;    // First step of the currently processed level
+
+                float                  *vBuffers;       // Temporary buffers
+                float                  *vZero;          // Buffer filled with zeros
+                float                  *vSink;          // Buffer for discarded outputs
+                float                 **vPtrs;          // Pointers to buffers passed to nodes, one per buffer reference
+                uint8_t                *pData;          // Allocated data
+
+            protected:
+                void                    destroy_plan();
+                inline float           *resolve(ssize_t ref, const float * const *in, size_t offset);
+                static size_t           alloc_buffer(lltl::darray<size_t> *pool, size_t *count);
+                void                    run_step(size_t step);
+                static void             run_task(void *object, size_t task);
+
+                template <class T>
+                static void             process_unit(void *object, void *subject, float * const *out, const float * const *in, size_t samples)
+                {
+                    static_cast<T *>(object)->process(out[0], in[0], samples);
+                }
+
+            public:
+                explicit ProcessGraph();
+                ~ProcessGraph();
+
+                /**
+                 * Destroy graph and the processing plan
+                 */
+                void                    destroy();
+
+            public:
+                /**
+                 * Add input to the graph
+                 * @return index of the input or negative error code
+                 */
+                ssize_t                 add_input();
+
+                /**
+                 * Add output to the graph
+                 * @return index of the output or negative error code
+                 */
+                ssize_t                 add_output();
+
+                /**
+                 * Add node to the graph
+                 * @param inputs number of node inputs
+                 * @param outputs number of node outputs
+                 * @param func processing function
+                 * @param object object passed to the processing function
+                 * @param subject subject passed to the processing function
+                 * @param latency latency introduced by the node in samples
+                 * @return index of the node or negative error code
+                 */
+                ssize_t                 add_node(size_t inputs, size_t outputs, graph_process_t func, void *object, void *subject, size_t latency = 0);
+
+                /**
+                 * Add the unit which has the single-channel process(float *dst, const float *src, size_t count)
+                 * method as a node with one input and one output, like Filter, Equalizer, Delay or Convolver
+                 * @param unit unit to add
+                 * @param latency latency introduced by the unit in samples
+                 * @return index of the node or negative error code
+                 */
+                template <class T>
+                inline ssize_t          add_unit(T *unit, size_t latency = 0)
+                {
+                    return add_node(1, 1, process_unit<T>, unit, NULL, latency);
+                }
+
+                /**
+                 * Update the latency of the node, requires compile() to be called
+                 * @param node index of the node
+                 * @param latency latency introduced by the node in samples
+                 * @return status of operation
+                 */
+                status_t                set_latency(size_t node, size_t latency);
+
+                /**
+                 * Connect the output of the node to the input of another node
+                 * @param src source node
+                 * @param src_port output of the source node
+                 * @param dst destination node
+                 * @param dst_port input of the destination node
+                 * @return status of operation
+                 */
+                status_t                connect(size_t src, size_t src_port, size_t dst, size_t dst_port);
+
+                /**
+                 * Connect the input of the graph to the input of the node
+                 * @param input input of the graph
+                 * @param dst destination node
+                 * @param dst_port input of the destination node
+                 * @return status of operation
+                 */
+                status_t                connect_input(size_t input, size_t dst, size_t dst_port);
+
+                /**
+                 * Connect the output of the node to the output of the graph
+                 * @param src source node
+                 * @param src_port output of the source node
+                 * @param output output of the graph
+                 * @return status of operation
+                 */
+                status_t                connect_output(size_t src, size_t src_port, size_t output);
+
+                /**
+                 * Build the processing plan: sort nodes, assign temporary buffers and
+                 * set up the latency compensation. Should be called outside of the
+                 * processing thread since it allocates memory
+                 * @param buf_size maximum number of samples processed at once
+                 * @return status of operation, STATUS_BAD_STATE if the graph contains cycles
+                 */
+                status_t                compile(size_t buf_size);
+
+                /**
+                 * Process the signal through the graph
+                 * @param out list of outputs() output buffers, NULL buffer means that the output is not needed
+                 * @param in list of inputs() input buffers, NULL buffer means silence
+                 * @param samples number of samples to process
+                 */
+                void                    process(float * const *out, const float * const *in, size_t samples);
+
+            public:
+                inline size_t           inputs() const          { return nInputs;               }
+                inline size_t           outputs() const         { return vOutLinks.size();      }
+                inline size_t           nodes() const           { return vNodes.size();         }
+                inline bool             compiled() const        { return bCompiled;             }
+                inline size_t           levels() const          { return vLevels.size();        }
+
+                /**
+                 * Set the worker pool to process independent nodes in parallel,
+                 * the nodes should not share state with each other
+                 * @param pool worker pool, NULL to process all nodes in the calling thread
+                 */
+                inline void             set_workers(WorkerPool *pool)   { pWorkers = pool;      }
+
+                /**
+                 * Get the worker pool
+                 * @return worker pool or NULL
+                 */
+                inline WorkerPool      *workers()               { return pWorkers;              }
+
+                /**
+                 * Get overall latency of the graph, valid after compile()
+                 * @return latency in samples
+                 */
+                inline size_t           latency() const         { return nLatency;              }
+
+                /**
+                 * Get number of temporary buffers used by the plan, valid after compile()
+                 * @return number of temporary buffers
+                 */
+                inline size_t           buffers() const         { return nBuffers;              }
+
+                /**
+                 * Dump the state
+                 * @param v state dumper
+                 */
+                void                    dump(IStateDumper *v) const;
+        };
+    } /* namespace dspu */
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_UTIL_PROCESSGRAPH_H_ */
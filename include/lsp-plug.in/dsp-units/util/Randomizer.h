@@ -59,9 +59,20 @@ namespace lsp
 
                 randgen_t   vRandom[4];
                 size_t      nBufID;
-                
+
+                bool        bCounter;       // Counter-based mode
+                uint32_t    vKey[2];        // Key of the counter-based generator
+                uint64_t    nCounter;       // Index of the next word in counter-based mode
+                uint64_t    nBlock;         // Index of the cached block in counter-based mode
+                uint32_t    vBlock[4];      // Cached block of words in counter-based mode
+
 			protected:
+                static inline void philox(uint32_t *dst, uint64_t block, const uint32_t *key);
+
+                inline uint32_t next_word();
                 float generate_linear();
+                void generate_words(uint32_t *dst, size_t count);
+                void generate_counter_words(uint32_t *dst, size_t count);
 
             public:
                 explicit Randomizer();
@@ -81,6 +92,33 @@ namespace lsp
                  */
                 void init();
 
+                /** Initialize the counter-based random generator (Philox4x32-10). Each word of
+                 * the sequence is computed directly from its index, so the sequence can be
+                 * partitioned between threads with seek() and the output does not depend on
+                 * the number of threads. Generators with different stream identifiers
+                 * produce independent sequences for the same seed.
+                 *
+                 * @param seed seed
+                 * @param stream stream identifier
+                 */
+                void init_counter(uint32_t seed, uint32_t stream = 0);
+
+                /** Move to the specified random number of the sequence, valid only for
+                 * the counter-based generator. The RND_GAUSSIAN function consumes two words
+                 * of the sequence for each number, other functions consume one word.
+                 *
+                 * @param index index of the random number
+                 * @param func function that will be used to generate numbers
+                 * @return true if the generator is counter-based and the position has been changed
+                 */
+                bool seek(uint64_t index, random_function_t func = RND_LINEAR);
+
+                /** Check that the generator is counter-based
+                 *
+                 * @return true if the generator is counter-based
+                 */
+                inline bool counter_based() const   { return bCounter; }
+
             public:
                 /** Generate float random number in range of [0..1) - excluding 1.0f
                  * The guaranteed tolerance is 1e-6 or 0.000001
@@ -90,6 +128,17 @@ namespace lsp
                  */
                 float random(random_function_t func = RND_LINEAR);
 
+                /** Generate block of float random numbers. The sequence is the same as for
+                 * the consecutive calls of random() with the same function, within the
+                 * precision of vectorized math used for the RND_EXP and RND_GAUSSIAN functions.
+                 * The four internal generators are advanced in parallel.
+                 *
+                 * @param dst destination buffer
+                 * @param count number of random numbers to generate
+                 * @param func function
+                 */
+                void random(float *dst, size_t count, random_function_t func = RND_LINEAR);
+
                 /**
                  * Dump the state
                  * @param dumper dumper
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_UTIL_RESAMPLER_H_
+#define LSP_PLUG_IN_DSP_UNITS_UTIL_RESAMPLER_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+
+#define RESAMPLER_QUALITY_MIN       2       /* Minimum number of kernel periods at each side */
+#define RESAMPLER_QUALITY_MAX       32      /* Maximum number of kernel periods at each side */
+#define RESAMPLER_QUALITY_DFL       8       /* Default number of kernel periods at each side */
+#define RESAMPLER_RATIO_MAX         16      /* Maximum ratio between the sample rates */
+#define RESAMPLER_DRIFT_MAX         0.05f   /* Maximum relative deviation of the ratio */
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Streaming sample rate converter for arbitrary ratios. The output sample is computed
+         * by the polyphase Lanczos kernel with linear interpolation between the phases,
+         * the kernel is scaled to remove frequencies above the Nyquist frequency of the
+         * output when downsampling. All memory is allocated by init(), processing does not
+         * allocate memory, and the ratio can be slowly adjusted at run time to compensate
+         * the clock drift between the source and the destination.
+         */
+        class Resampler
+        {
+            private:
+                Resampler & operator = (const Resampler &);
+                Resampler(const Resampler &);
+
+            protected:
+                float      *vKernel;        // Kernel table, one row of nTaps taps per phase
+                float      *vBuffer;        // Buffer of input samples
+                size_t      nInRate;        // Input sample rate
+                size_t      nOutRate;       // Output sample rate
+                size_t      nQuality;       // Number of kernel periods at each side
+                size_t      nHalf;          // Half of the kernel length
+                size_t      nTaps;          // Length of the kernel
+                size_t      nFill;          // Number of samples in the buffer
+                size_t      nCapacity;      // Capacity of the buffer
+                double      fPosition;      // Position of the next output sample in the buffer
+                double      fStep;          // Nominal step of the position per output sample
+                float       fDrift;         // Relative adjustment of the ratio
+                uint8_t    *pData;          // Allocated data
+
+            protected:
+                void        build_kernel(float cutoff);
+
+            public:
+                explicit Resampler();
+                ~Resampler();
+
+                /**
+                 * Construct the object
+                 */
+                void        construct();
+
+                /**
+                 * Destroy the object
+                 */
+                void        destroy();
+
+            public:
+                /**
+                 * Initialize the converter, is not real-time safe
+                 * @param in_rate input sample rate
+                 * @param out_rate output sample rate
+                 * @param quality number of kernel periods at each side of the kernel,
+                 *   higher values give better stop band attenuation and higher latency
+                 * @return true on success
+                 */
+                bool        init(size_t in_rate, size_t out_rate, size_t quality = RESAMPLER_QUALITY_DFL);
+
+                /**
+                 * Set the relative adjustment of the ratio to compensate the clock drift,
+                 * the adjustment applies to the next process() call
+                 * @param drift the multiplier of the output-to-input ratio, limited to
+                 *   1 +/- RESAMPLER_DRIFT_MAX
+                 */
+                void        set_drift(float drift);
+
+                inline float    drift() const           { return fDrift;        }
+                inline size_t   in_rate() const         { return nInRate;       }
+                inline size_t   out_rate() const        { return nOutRate;      }
+                inline size_t   quality() const         { return nQuality;      }
+
+                /**
+                 * Get the latency of the converter
+                 * @return latency in input samples
+                 */
+                inline size_t   latency() const         { return nHalf;         }
+
+                /**
+                 * Get the maximum number of output samples produced for the input block
+                 * @param count number of input samples
+                 * @return maximum number of output samples
+                 */
+                size_t      max_output(size_t count) const;
+
+                /**
+                 * Process the block of input samples
+                 * @param dst destination buffer of at least max_output(count) samples
+                 * @param src source buffer
+                 * @param count number of input samples
+                 * @return number of output samples
+                 */
+                size_t      process(float *dst, const float *src, size_t count);
+
+                /**
+                 * Clear the internal state
+                 */
+                void        clear();
+
+                /**
+                 * Dump internal state
+                 * @param v state dumper
+                 */
+                void        dump(IStateDumper *v) const;
+        };
+    }
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_UTIL_RESAMPLER_H_ */
@@ -108,11 +108,18 @@ namespace lsp
                 size_t      nLatency;           // Latency of the transmission line under test [samples]. LatencyDetector will supply this.
                 size_t      nTimeWarp;          // Entity of the warp between processors at OP_CHIRP_EMIT trigger
                 size_t      nCaptureStart;      // Sample in capture buffer at which the recorded chirp actually starts
+                size_t      nInputs;            // Number of captured inputs
+                size_t      nOutputs;           // Number of outputs emitting the test signal
+                float       fStagger;           // Delay between test signals of consecutive outputs [s]
+                size_t      nStagger;           // Delay between test signals of consecutive outputs [samples]
 
                 bool        bCycleComplete;     // True if the machine operated a whole measurement cycle
 
                 bool        bSync;
 
+            protected:
+                void        emit_test_signal(float * const *dst, size_t offset, size_t count);
+
             public:
 
                 explicit ResponseTaker();
@@ -134,8 +141,29 @@ namespace lsp
                 void destroy();
 
             public:
+                /** Configure single-output measurement, the capture has as many channels
+                 * as the test signal, only the first one is recorded by the single-channel
+                 * process_in() call
+                 *
+                 * @param testsig test signal
+                 * @return status of operation
+                 */
                 status_t reconfigure(Sample *testsig);
 
+                /** Configure multichannel measurement: each output emits the channel of the
+                 * test signal with the same index modulo the number of test signal channels,
+                 * delayed by the stagger from the previous output, and all inputs are
+                 * streamed into the capture allocated here. The capture holds the whole
+                 * staggered emission, the tail and the latency. Should be called again
+                 * after the change of stagger, tail or latency
+                 *
+                 * @param testsig bank of test signals
+                 * @param inputs number of captured inputs
+                 * @param outputs number of outputs
+                 * @return status of operation
+                 */
+                status_t reconfigure(Sample *testsig, size_t inputs, size_t outputs);
+
                 /** Check that ResponseTaker needs settings update
                  *
                  * @return true if ResponseTaker needs setting update
@@ -215,6 +243,48 @@ namespace lsp
                     bSync                           = true;
                 }
 
+                /** Set the delay between the test signals of consecutive outputs, for
+                 * the exponential sweeps the delay longer than the response of the system
+                 * allows to separate responses of different outputs after deconvolution
+                 *
+                 * @param stagger delay in seconds
+                 */
+                inline void set_stagger(float stagger)
+                {
+                    if (fStagger == stagger)
+                        return;
+
+                    fStagger                        = stagger;
+                    bSync                           = true;
+                }
+
+                /** Get the delay between the test signals of consecutive outputs
+                 *
+                 * @return delay in seconds
+                 */
+                inline float get_stagger() const
+                {
+                    return fStagger;
+                }
+
+                /** Get number of captured inputs
+                 *
+                 * @return number of captured inputs
+                 */
+                inline size_t inputs() const
+                {
+                    return nInputs;
+                }
+
+                /** Get number of outputs
+                 *
+                 * @return number of outputs
+                 */
+                inline size_t outputs() const
+                {
+                    return nOutputs;
+                }
+
                 /** Start latency detection process
                  *
                  */
@@ -252,6 +322,27 @@ namespace lsp
                     return nCaptureStart;
                 }
 
+                /** Get sample at which the capture buffer contains the response to the
+                 * test signal of the specified output
+                 *
+                 * @param output output number
+                 * @return capture start sample
+                 */
+                inline size_t get_capture_start(size_t output)
+                {
+                    return nCaptureStart + output * nStagger;
+                }
+
+                /** Get number of samples captured in the current measurement cycle, the
+                 * captured samples can be fed to the streaming convolution as they arrive
+                 *
+                 * @return number of samples captured in the current measurement cycle
+                 */
+                inline size_t get_captured() const
+                {
+                    return sInputProcessor.nAcquireTime;
+                }
+
             public:
 
                 /** Collect input samples:
@@ -262,6 +353,14 @@ namespace lsp
                  */
                 void process_in(float *dst, const float *src, size_t count);
 
+                /** Collect input samples of all inputs:
+                 *
+                 * @param dst array of samples destinations, elements allowed to be NULL
+                 * @param src array of input sources, elements allowed to be NULL
+                 * @param count number of samples to process
+                 */
+                void process_in(float * const *dst, const float * const *src, size_t count);
+
                 /** Stream output samples:
                  *
                  * @param dst samples destination
@@ -270,6 +369,14 @@ namespace lsp
                  */
                 void process_out(float *dst, const float *src, size_t count);
 
+                /** Stream output samples of all outputs:
+                 *
+                 * @param dst array of samples destinations, elements allowed to be NULL
+                 * @param src array of input sources, elements allowed to be NULL
+                 * @param count number of samples to process
+                 */
+                void process_out(float * const *dst, const float * const *src, size_t count);
+
                 /** Stream direct chirp while recording response
                  *
                  * @param dst samples destination
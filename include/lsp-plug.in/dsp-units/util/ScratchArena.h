@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_UTIL_SCRATCHARENA_H_
+#define LSP_PLUG_IN_DSP_UNITS_UTIL_SCRATCHARENA_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Arena of aligned temporary buffers shared by units processed in the same thread.
+         * Units reserve the size of temporaries they need at initialization and borrow
+         * them from the arena during the process() call only, so the arena holds the
+         * maximum of the requirements instead of the sum. Buffers are borrowed and
+         * returned in the stack order. The arena is not thread-safe: each processing
+         * thread should have its own arena.
+         */
+        class ScratchArena
+        {
+            private:
+                ScratchArena & operator = (const ScratchArena &);
+                ScratchArena(const ScratchArena &);
+
+            protected:
+                float              *vData;          // Aligned data
+                size_t              nCapacity;      // Capacity in floats
+                size_t              nUsed;          // Number of borrowed floats
+                size_t              nPeak;          // Peak number of borrowed floats
+                uint8_t            *pData;          // Allocated data
+
+            public:
+                explicit ScratchArena();
+                ~ScratchArena();
+
+                /**
+                 * Construct object
+                 */
+                void                construct();
+
+                /**
+                 * Destroy arena
+                 */
+                void                destroy();
+
+            public:
+                /**
+                 * Get the size of the borrowed buffer after alignment
+                 * @param count number of floats
+                 * @return number of floats occupied in the arena
+                 */
+                static size_t       aligned(size_t count);
+
+                /**
+                 * Ensure that the arena can hold the specified number of floats at once,
+                 * should not be called while buffers are borrowed, not real-time safe
+                 * @param count number of floats, the alignment of each borrowed buffer
+                 *        should be taken into account with aligned()
+                 * @return true on success
+                 */
+                bool                reserve(size_t count);
+
+                /**
+                 * Borrow the buffer, real-time safe
+                 * @param count number of floats
+                 * @return pointer to the buffer or NULL if there is not enough space
+                 */
+                float              *alloc(size_t count);
+
+                /**
+                 * Get the current position of the arena to return the buffers later
+                 * @return current position
+                 */
+                inline size_t       mark() const        { return nUsed;     }
+
+                /**
+                 * Return all buffers borrowed after the mark
+                 * @param mark position obtained with mark()
+                 */
+                inline void         release(size_t mark) { nUsed = mark;    }
+
+                inline size_t       capacity() const    { return nCapacity; }
+                inline size_t       used() const        { return nUsed;     }
+                inline size_t       peak() const        { return nPeak;     }
+
+                /**
+                 * Dump the state
+                 * @param v state dumper
+                 */
+                void                dump(IStateDumper *v) const;
+        };
+    } /* namespace dspu */
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_UTIL_SCRATCHARENA_H_ */
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_UTIL_SHAREDDELAY_H_
+#define LSP_PLUG_IN_DSP_UNITS_UTIL_SHAREDDELAY_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Multichannel delay with the same delay for all channels. Channels are stored in one
+         * allocated ring buffer and share the read and write positions, the delayed signal is
+         * read directly from the ring buffer and can be multiplied by the gain on the fly.
+         */
+        class SharedDelay
+        {
+            private:
+                SharedDelay & operator = (const SharedDelay &);
+                SharedDelay(const SharedDelay &);
+
+            protected:
+                float      *vBuffer;        // Ring buffers of all channels
+                size_t      nChannels;      // Number of channels
+                size_t      nHead;          // Write position
+                size_t      nTail;          // Read position
+                size_t      nDelay;         // Current delay
+                size_t      nMaxDelay;      // Maximum delay
+                size_t      nSize;          // Size of the ring buffer of one channel
+                uint8_t    *pData;          // Allocated data
+
+            public:
+                explicit SharedDelay();
+                ~SharedDelay();
+
+                /**
+                 * Construct the object
+                 */
+                void        construct();
+
+                /**
+                 * Destroy the object
+                 */
+                void        destroy();
+
+            public:
+                /**
+                 * Initialize the delay
+                 * @param channels number of channels
+                 * @param max_delay maximum delay in samples
+                 * @return true on success
+                 */
+                bool        init(size_t channels, size_t max_delay);
+
+                /**
+                 * Get number of channels
+                 * @return number of channels
+                 */
+                inline size_t channels() const          { return nChannels;     }
+
+                /**
+                 * Get current delay
+                 * @return delay in samples
+                 */
+                inline size_t delay() const             { return nDelay;        }
+
+                /**
+                 * Get maximum delay
+                 * @return maximum delay in samples
+                 */
+                inline size_t max_delay() const         { return nMaxDelay;     }
+
+                /**
+                 * Set delay, the value is limited by the maximum delay
+                 * @param delay delay in samples
+                 */
+                void        set_delay(size_t delay);
+
+                /**
+                 * Clear the delay line
+                 */
+                void        clear();
+
+                /**
+                 * Process signals of all channels
+                 * @param dst list of channels() destination buffers, may be the same as source buffers
+                 * @param src list of channels() source buffers
+                 * @param gain gain to apply to the delayed signal, may be NULL
+                 * @param samples number of samples to process
+                 */
+                void        process(float * const *dst, const float * const *src, const float *gain, size_t samples);
+
+                /**
+                 * Dump internal state
+                 * @param v state dumper
+                 */
+                void        dump(IStateDumper *v) const;
+        };
+    } /* namespace dspu */
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_UTIL_SHAREDDELAY_H_ */
@@ -34,6 +34,10 @@ namespace lsp
          *    New data is added to buffer at the tail position with append() methods
          *    Old data is removed from buffer from the head position with shift() methods
          *
+         *    In the ring mode the capacity is a power of two and the data is mirrored after
+         *    the end of the buffer, so the contents are always available as contiguous
+         *    data between head() and tail() and no data is moved by shift() and append()
+         *
          */
         class ShiftBuffer
         {
@@ -46,6 +50,11 @@ namespace lsp
                 size_t      nCapacity;
                 size_t      nHead;
                 size_t      nTail;
+                bool        bRing;
+
+            protected:
+                void        ring_write(size_t pos, const float *data, size_t count);
+                inline void ring_shift();
 
             public:
                 explicit ShiftBuffer();
@@ -60,9 +69,10 @@ namespace lsp
                  *
                  * @param size the requested size of buffer, in terms of optimization may be allocated a bit more data
                  * @param gap number of zero samples initially stored in buffer, can not be greater than size
+                 * @param ring use ring mode, the buffer will take twice more memory
                  * @return status of operation
                  */
-                bool        init(size_t size, size_t gap = 0);
+                bool        init(size_t size, size_t gap = 0, bool ring = false);
 
                 /** Destroy buffer
                  *
@@ -126,6 +136,12 @@ namespace lsp
                  */
                 inline size_t capacity() const { return nCapacity; };
 
+                /** Check that buffer operates in ring mode
+                 *
+                 * @return true if buffer operates in ring mode
+                 */
+                inline bool ring() const { return bRing; };
+
                 /** Clear buffer
                  *
                  */
@@ -82,6 +82,8 @@ namespace lsp
                 void            refresh_processing();
                 bool            preprocess(float *out, const float **in, size_t samples);
                 bool            preprocess(float *out, const float *in);
+                void            process_uniform(float *out, const float *tail, size_t samples);
+                void            process_rms(float *out, const float *tail, size_t samples);
 
             public:
                 explicit Sidechain();
@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_UTIL_SIDECHAINBUS_H_
+#define LSP_PLUG_IN_DSP_UNITS_UTIL_SIDECHAINBUS_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/dsp-units/util/Sidechain.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Sidechain bus: computes the sidechain signal once per block and lets several
+         * dynamics processors (Compressor, Gate, Expander, DynamicProcessor) fed by the
+         * same source, mode and reactivity consume it by reference instead of running
+         * their own Sidechain with its own history buffer
+         */
+        class SidechainBus
+        {
+            private:
+                SidechainBus & operator = (const SidechainBus &);
+                SidechainBus(const SidechainBus &);
+
+            protected:
+                Sidechain       sSC;                    // Sidechain shared by all consumers
+                float          *vBuffer;                // Sidechain signal of the current block
+                size_t          nCapacity;              // Maximum number of samples per block
+                size_t          nSamples;               // Number of samples of the current block
+                size_t          nBlock;                 // Serial number of the current block
+                uint8_t        *pData;                  // Allocated data
+
+            public:
+                explicit SidechainBus();
+                ~SidechainBus();
+
+                /**
+                 * Construct the object
+                 */
+                void            construct();
+
+                /** Initialize sidechain bus
+                 *
+                 * @param channels number of input channels, possible 1 or 2
+                 * @param max_reactivity maximum reactivity
+                 * @param block_size maximum number of samples processed per one block
+                 * @return true on success
+                 */
+                bool            init(size_t channels, float max_reactivity, size_t block_size);
+
+                /** Destroy sidechain bus
+                 *
+                 */
+                void            destroy();
+
+            public:
+                /** Set pre-processing equalizer
+                 *
+                 * @param eq equalizer
+                 */
+                inline void     set_pre_equalizer(Equalizer *eq)            { sSC.set_pre_equalizer(eq);    }
+
+                /** Set sample rate
+                 *
+                 * @param sr sample rate
+                 */
+                inline void     set_sample_rate(size_t sr)                  { sSC.set_sample_rate(sr);      }
+
+                /** Set sidechain reactivity
+                 *
+                 * @param reactivity sidechain reactivity
+                 */
+                inline void     set_reactivity(float reactivity)            { sSC.set_reactivity(reactivity); }
+
+                /** Set stereo mode
+                 *
+                 * @param mode stereo mode
+                 */
+                inline void     set_stereo_mode(sidechain_stereo_mode_t mode) { sSC.set_stereo_mode(mode); }
+
+                /** Set sidechain source
+                 *
+                 * @param source sidechain source
+                 */
+                inline void     set_source(size_t source)                   { sSC.set_source(source);       }
+
+                /** Set sidechain mode
+                 *
+                 * @param mode sidechain mode
+                 */
+                inline void     set_mode(size_t mode)                       { sSC.set_mode(mode);           }
+
+                /** Set-up pre-amplification gain
+                 *
+                 * @param gain sidechain pre-amplification gain
+                 */
+                inline void     set_gain(float gain)                        { sSC.set_gain(gain);           }
+
+                /** Get pre-amplification gain
+                 *
+                 * @return pre-amplification gain
+                 */
+                inline float    get_gain() const                            { return sSC.get_gain();        }
+
+                /** Get maximum number of samples per block
+                 *
+                 * @return maximum number of samples per block
+                 */
+                inline size_t   capacity() const                            { return nCapacity;             }
+
+                /** Process the sidechain signal of the next block, the block is limited
+                 * by the capacity of the bus
+                 *
+                 * @param in input buffers
+                 * @param samples number of samples to process
+                 * @return number of processed samples, consumers should process the same number
+                 */
+                size_t          process(const float **in, size_t samples);
+
+                /** Get the sidechain signal of the current block
+                 *
+                 * @return sidechain signal, samples() samples
+                 */
+                inline const float *signal() const                          { return vBuffer;               }
+
+                /** Get number of samples of the current block
+                 *
+                 * @return number of samples of the current block
+                 */
+                inline size_t   samples() const                             { return nSamples;              }
+
+                /** Get serial number of the current block, consumers may use it to check
+                 * that the block has been processed already
+                 *
+                 * @return serial number of the current block
+                 */
+                inline size_t   block() const                               { return nBlock;                }
+
+                /** Feed the sidechain signal of the current block to the dynamics processor
+                 * that has the process(out, env, in, samples) method
+                 *
+                 * @param proc dynamics processor
+                 * @param gain buffer to store the gain, samples() samples
+                 * @param env buffer to store the envelope, samples() samples, may be NULL
+                 */
+                template <class P>
+                    inline void apply(P *proc, float *gain, float *env) const
+                    {
+                        proc->process(gain, env, vBuffer, nSamples);
+                    }
+
+                /**
+                 * Dump the state
+                 * @param dumper dumper
+                 */
+                void            dump(IStateDumper *v) const;
+        };
+    }
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_UTIL_SIDECHAINBUS_H_ */
@@ -25,6 +25,8 @@
 #include <lsp-plug.in/dsp-units/version.h>
 #include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
 
+#define SPECTRAL_PROCESSOR_CHAIN_MAX        8       /* Maximum number of handlers in the chain */
+
 namespace lsp
 {
     namespace dspu
@@ -52,18 +54,27 @@ namespace lsp
                 size_t                      nRank;      // Current FFT rank
                 size_t                      nMaxRank;   // Maximum FFT rank
                 float                       fPhase;     // Phase
+                float                       fOverlap;   // Overlap of frames
+                size_t                      nHop;       // Distance between frames
                 float                      *pWnd;       // Window function
                 float                      *pOutBuf;    // Output buffer
                 float                      *pInBuf;     // Input buffer
                 float                      *pFftBuf;    // FFT buffer
+                const float                *pFftTable;  // Twiddle table of the real-input FFT
                 size_t                      nOffset;    // Read/Write offset
                 uint8_t                    *pData;      // Data buffer
                 bool                        bUpdate;    // Update flag
 
+                typedef struct binding_t
+                {
+                    spectral_processor_func_t   pFunc;      // Function
+                    void                       *pObject;    // Object to operate
+                    void                       *pSubject;   // Subject to operate
+                } binding_t;
+
                 // Bindings
-                spectral_processor_func_t   pFunc;      // Function
-                void                       *pObject;    // Object to operate
-                void                       *pSubject;   // Subject to operate
+                binding_t                   vChain[SPECTRAL_PROCESSOR_CHAIN_MAX];   // Chain of handlers
+                size_t                      nChain;     // Number of handlers in the chain
 
             public:
                 explicit SpectralProcessor();
@@ -88,7 +99,7 @@ namespace lsp
 
             public:
                 /**
-                 * Bind spectral processor to the handler
+                 * Bind spectral processor to the handler, all previously bound handlers are removed
                  * @param func function to call
                  * @param object the target object to pass to the function
                  * @param subject the target subject to pass to the function
@@ -96,10 +107,36 @@ namespace lsp
                 void            bind(spectral_processor_func_t func, void *object, void *subject);
 
                 /**
-                 * Unbind spectral processor
+                 * Append the handler to the end of the chain. All handlers of the chain
+                 * process the same spectrum in the order of binding between one direct
+                 * and one reverse FFT, so the chain adds no extra latency
+                 * @param func function to call
+                 * @param object the target object to pass to the function
+                 * @param subject the target subject to pass to the function
+                 * @return false if the chain is full or the function is NULL
+                 */
+                bool            add(spectral_processor_func_t func, void *object, void *subject);
+
+                /**
+                 * Remove the handler from the chain
+                 * @param func function to remove
+                 * @param object the target object passed to the function
+                 * @param subject the target subject passed to the function
+                 * @return false if there is no such handler in the chain
+                 */
+                bool            remove(spectral_processor_func_t func, void *object, void *subject);
+
+                /**
+                 * Unbind spectral processor from all handlers
                  */
                 void            unbind();
 
+                /**
+                 * Get number of handlers bound to the spectral processor
+                 * @return number of handlers
+                 */
+                inline size_t   handlers() const            { return nChain;            }
+
                 /**
                  * Check that spectral processor needs update
                  * @return true if spectral processor needs update
@@ -134,6 +171,26 @@ namespace lsp
                  */
                 void            set_rank(size_t rank);
 
+                /**
+                 * Get the overlap of frames
+                 * @return overlap of frames
+                 */
+                inline float    overlap() const             { return fOverlap;          }
+
+                /**
+                 * Set the overlap of frames, the callback function is called each
+                 * (1 - overlap) * (1 << rank) samples. The synthesis window is normalized
+                 * to keep the unity gain for any overlap.
+                 * @param overlap overlap of frames, between 0 and 1 (exclusive), default is 0.5
+                 */
+                void            set_overlap(float overlap);
+
+                /**
+                 * Get the distance between frames (hop size) applied by the last settings update
+                 * @return hop size in samples
+                 */
+                inline size_t   hop() const                 { return nHop;              }
+
                 /**
                  * Get latency of the spectral processor
                  * @return latency of the spectral processor
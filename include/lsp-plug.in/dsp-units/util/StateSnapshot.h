@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_UTIL_STATESNAPSHOT_H_
+#define LSP_PLUG_IN_DSP_UNITS_UTIL_STATESNAPSHOT_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/util/BinaryStateDumper.h>
+#include <lsp-plug.in/common/atomic.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Rate-limited capture of the unit state: the audio thread periodically dumps
+         * the state of the unit into the preallocated binary buffer, the worker thread
+         * fetches the latest captured state and decodes it into any other dumper.
+         * The buffers are exchanged without locks by the triple buffering, so the
+         * capture never blocks and the worker always gets the complete state.
+         */
+        class StateSnapshot
+        {
+            private:
+                StateSnapshot & operator = (const StateSnapshot &);
+                StateSnapshot(const StateSnapshot &);
+
+            protected:
+                enum state_t
+                {
+                    S_INDEX     = 0x03,         // Mask of buffer index
+                    S_FRESH     = 0x04          // The buffer contains fresh data
+                };
+
+            protected:
+                BinaryStateDumper   vBuffers[3];    // Triple-buffered state
+                size_t              nBack;          // Buffer written by the audio thread
+                size_t              nFront;         // Buffer read by the worker thread
+                atomic_t            nState;         // Exchange state: middle buffer index and freshness flag
+                size_t              nPeriod;        // Capture period [samples]
+                size_t              nCounter;       // Samples elapsed since the last capture
+
+            protected:
+                BinaryStateDumper  *begin_capture(size_t samples);
+                void                commit_capture();
+
+            public:
+                explicit StateSnapshot();
+                ~StateSnapshot();
+
+                /**
+                 * Construct object
+                 */
+                void            construct();
+
+                /**
+                 * Destroy object
+                 */
+                void            destroy();
+
+            public:
+                /**
+                 * Initialize the snapshot
+                 * @param size size of each buffer in bytes
+                 * @param names maximum number of distinct field names
+                 * @return true on success
+                 */
+                bool            init(size_t size, size_t names = 0x400);
+
+                /**
+                 * Set the minimum period between two captures
+                 * @param samples period in samples, zero captures the state on each call
+                 */
+                inline void     set_period(size_t samples)  { nPeriod = samples;    }
+
+                /**
+                 * Get the minimum period between two captures
+                 * @return period in samples
+                 */
+                inline size_t   period() const              { return nPeriod;       }
+
+                /**
+                 * Capture the state of the object if the period has elapsed, should be called
+                 * from the audio thread after processing the block of samples
+                 * @param obj object that implements dump(IStateDumper *) method
+                 * @param samples number of samples processed since the last call
+                 * @return true if the state has been captured
+                 */
+                template <class T>
+                    inline bool capture(const T *obj, size_t samples)
+                    {
+                        BinaryStateDumper *v = begin_capture(samples);
+                        if (v == NULL)
+                            return false;
+                        v->write_object(obj);
+                        commit_capture();
+                        return true;
+                    }
+
+                /**
+                 * Fetch the latest captured state, should be called from the worker thread
+                 * @return true if the new state has been fetched
+                 */
+                bool            fetch();
+
+                /**
+                 * Get the state fetched by the worker thread
+                 * @return the state fetched by the worker thread
+                 */
+                inline const BinaryStateDumper *state() const   { return &vBuffers[nFront]; }
+
+                /**
+                 * Decode the state fetched by the worker thread
+                 * @param dst destination dumper
+                 * @return status of operation
+                 */
+                inline status_t replay(IStateDumper *dst) const { return vBuffers[nFront].replay(dst); }
+        };
+    } /* namespace dspu */
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_UTIL_STATESNAPSHOT_H_ */
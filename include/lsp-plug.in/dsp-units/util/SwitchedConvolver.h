@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_UTIL_SWITCHEDCONVOLVER_H_
+#define LSP_PLUG_IN_DSP_UNITS_UTIL_SWITCHEDCONVOLVER_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/dsp-units/util/Convolver.h>
+#include <lsp-plug.in/dsp-units/ctl/Crossfade.h>
+#include <lsp-plug.in/common/atomic.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Convolver that allows to replace the impulse response while processing.
+         * The new impulse response is prepared by the non-realtime thread with the
+         * prepare() call, then the processing thread switches to it with the commit()
+         * call that does not allocate memory. Outputs of the old and new convolvers
+         * are crossfaded to avoid clicks.
+         */
+        class SwitchedConvolver
+        {
+            private:
+                SwitchedConvolver & operator = (const SwitchedConvolver &);
+                SwitchedConvolver(const SwitchedConvolver &);
+
+            protected:
+                enum state_t
+                {
+                    S_IDLE,                             // The spare convolver can be prepared
+                    S_PREPARING,                        // The spare convolver is being prepared
+                    S_PREPARED                          // The spare convolver is ready to be committed
+                };
+
+            private:
+                Convolver       vConv[3];               // Convolvers
+                Convolver      *pActive;                // Active convolver
+                Convolver      *pFade;                  // The convolver that fades out
+                Convolver      *pSpare;                 // The spare convolver for preparing
+                Crossfade       sCrossfade;             // Crossfade between old and new convolvers
+                atomic_t        nState;                 // State of the spare convolver
+                float          *vFadeOut;               // Buffer for the output of old convolver
+                float          *vFadeIn;                // Buffer for the output of new convolver
+                uint8_t        *vData;                  // Non-aligned pointer to the whole allocated data
+
+            public:
+                explicit SwitchedConvolver();
+                ~SwitchedConvolver();
+
+                /** Construct the convolver
+                 *
+                 */
+                void construct();
+
+                /** Destroy convolver
+                 *
+                 */
+                void destroy();
+
+            public:
+                /**
+                 * Initialize the convolver
+                 * @param sample_rate sample rate
+                 * @param time crossfade time, by default 5 msec
+                 * @return true on success
+                 */
+                bool init(int sample_rate, float time = 0.005f);
+
+                /**
+                 * Prepare the new impulse response, should be called by the non-realtime thread.
+                 * Fails if the previously prepared impulse response was not committed yet
+                 * @param data convolution data
+                 * @param count number of samples in convolution
+                 * @param rank convolution rank
+                 * @param phase the phase of the convolution tail scheduling
+                 * @param background process the tail of the convolution in the background thread
+                 * @param cache the cache to share the spectrum of impulse response, NULL for private spectrum
+                 * @return true on success
+                 */
+                bool prepare(const float *data, size_t count, size_t rank, float phase,
+                        bool background = false, ConvolverCache *cache = NULL);
+
+                /**
+                 * Check that the prepared impulse response is waiting for commit
+                 * @return true if the prepared impulse response is waiting for commit
+                 */
+                inline bool prepared() const                { return nState == S_PREPARED;          }
+
+                /**
+                 * Check that the new impulse response can be prepared
+                 * @return true if the new impulse response can be prepared
+                 */
+                inline bool idle() const                    { return nState == S_IDLE;              }
+
+                /**
+                 * Switch to the prepared impulse response, should be called by the processing
+                 * thread. Does not allocate memory
+                 * @return true if the switch has been performed, false if there is no prepared
+                 *   impulse response or the previous crossfade is still active
+                 */
+                bool commit();
+
+                /**
+                 * Check that the crossfade between impulse responses is active
+                 * @return true if the crossfade between impulse responses is active
+                 */
+                inline bool crossfading() const             { return sCrossfade.active();           }
+
+                /**
+                 * Get the actual convolution size of the active impulse response
+                 * @return actual convolution size in samples
+                 */
+                inline size_t data_size() const             { return pActive->data_size();          }
+
+                /**
+                 * Get the latency of the convolver
+                 * @return latency of the convolver in samples, always zero
+                 */
+                inline size_t latency() const               { return pActive->latency();            }
+
+                /** Process samples
+                 *
+                 * @param dst destination buffer
+                 * @param src source buffer
+                 * @param count number of samples to process
+                 */
+                void process(float *dst, const float *src, size_t count);
+
+                /**
+                 * Dump internal state
+                 * @param v state dumper
+                 */
+                void dump(IStateDumper *v) const;
+        };
+    }
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_UTIL_SWITCHEDCONVOLVER_H_ */
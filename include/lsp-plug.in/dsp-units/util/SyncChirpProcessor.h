@@ -28,11 +28,18 @@
 #include <lsp-plug.in/dsp-units/sampling/Sample.h>
 #include <lsp-plug.in/dsp-units/misc/windows.h>
 #include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/common/atomic.h>
 #include <lsp-plug.in/runtime/LSPString.h>
 #include <lsp-plug.in/io/Path.h>
 
 namespace lsp
 {
+    namespace lspc
+    {
+        class File;
+        class AudioWriter;
+    }
+
     namespace dspu
     {
         enum scp_method_t
@@ -62,6 +69,16 @@ namespace lsp
             SCP_RT_DEFAULT          = SCP_RT_EDT_0
         };
 
+        // Reverberation time of a single band of a single channel
+        typedef struct scp_rt_t
+        {
+            float           fRT;                        // Reverberation time [s]
+            float           fCorrelation;               // Reverberation regression line correlation coefficient
+            float           fIrLimit;                   // Backwards integration limit [s]
+            float           fNoiseLevel;                // Background noise level, normalised by the band energy [dB]
+            bool            bLowNoise;                  // The noise was low enough for the requested RT calculation
+        } scp_rt_t;
+
         class SyncChirpProcessor
         {
             private:
@@ -69,6 +86,15 @@ namespace lsp
                 SyncChirpProcessor(const SyncChirpProcessor &);
 
             protected:
+                class ConvThread;
+                class IdentThread;
+
+                // Stages of the nonlinear identification performed by worker threads
+                enum ident_stage_t
+                {
+                    IDENT_WINDOW,                       // Window the higher order responses, one job per order
+                    IDENT_SOLVE                         // Solve the identification problem, one job per range of frequency bins
+                };
 
                 // Chirp parameters:
                 typedef struct chirp_t
@@ -127,15 +153,42 @@ namespace lsp
                     size_t         *vAlignOffsets;      // For each channel in the convolution result, the offset with which the result has to be stored so that all the origins of times are aligned [samples]
                     uint8_t        *pData;
 
-                    float 		   *vInPart; 			// Holds a single input time series partition
+                    size_t          nWorkers;           // Number of workers that own temporary buffers
+                    size_t          nInvImages;         // Number of non-zero inverse filter partitions
+                    float 		   *vInPart; 			// Holds a single input time series partition, one per worker
                     float          *vInvPart; 			// Holds a single inverse filter partition
-                    float          *vInImage; 			// Holds a single input time series FFT image
-                    float 	       *vInvImage; 			// Holds a single inverse filter FFT image
-                    float 		   *vTemp; 				// Holds temporary data
+                    float          *vInImage; 			// Holds a single input time series FFT image, one per worker
+                    float 	       *vInvImages; 		// Holds FFT images of all non-zero inverse filter partitions
+                    float 		   *vTemp; 				// Holds temporary data, one per worker
                     uint8_t 	   *pTempData;
+                    uint8_t        *pInvData;
+                    Sample        **vJobData;           // Input time series of the current convolution jobs
+                    size_t         *vJobOffsets;        // 0 time indices of the current convolution jobs
                     bool 			bReallocateTemp;
                 } conv_t;
 
+                // Streaming convolution state
+                typedef struct stream_t
+                {
+                    size_t          nLength;            // Length of each input time series, including the offset [samples]
+                    size_t         *vOffsets;           // 0 time index of the input time series for each channel
+                    size_t         *vHead;              // Number of input samples received for each channel
+                    float          *vInPart;            // Pending input partition for each channel
+                    uint8_t        *pData;
+                    bool            bActive;            // Streaming convolution is in progress
+                } stream_t;
+
+                // Chunked LSPC export state
+                typedef struct export_t
+                {
+                    lspc::File     *pFile;              // Output file
+                    lspc::AudioWriter *pWriter;         // Writer of the audio chunk
+                    size_t          nFrames;            // Number of frames to write
+                    size_t          nWritten;           // Number of frames written
+                    size_t          nSkip;              // Number of frames to skip stored in the profile chunk
+                    uint32_t        nChunkId;           // Identifier of the audio chunk
+                } export_t;
+
                 // Convolution Result Post-processing values:
                 typedef struct crpostproc_t
                 {
@@ -175,7 +228,21 @@ namespace lsp
                     float          *vTemprow1Im;
                     float          *vTemprow2Re;
                     float          *vTemprow2Im;
+                    size_t          nWorkers;           // Number of workers, each worker owns its own set of temporary rows
+                    float          *vWindow;            // Cached smoothing window
+                    windows::window_t enWindowType;     // Type of the cached smoothing window
+                    float           fCoeffsAlpha;       // Chirp amplitude the coefficients matrices are computed for
+                    bool            bCoeffsValid;       // Coefficients matrices hold valid values
+                    bool            bWindowValid;       // Cached smoothing window holds valid values
                     uint8_t        *pData;
+
+                    // Parameters of the current identification jobs
+                    ident_stage_t   enStage;            // Current stage
+                    size_t          nJobs;              // Number of jobs
+                    size_t          nJobChannel;        // Channel in the convolution result
+                    bool            bJobSmoothing;      // Apply inner fade in and fade out
+                    size_t          nJobFadeIn;         // Number of samples for the inner fade in
+                    size_t          nJobFadeOut;        // Number of samples for the inner fade out
                 } crpostproc_t;
 
             private:
@@ -185,7 +252,11 @@ namespace lsp
                 chirp_t             sChirpParams;
                 fader_t             sFader;
                 conv_t 				sConvParams;
+                stream_t            sStream;
+                export_t            sExport;
                 crpostproc_t        sCRPostProc;
+                atomic_t            nConvJob;           // Index of the next channel to convolve
+                atomic_t            nIdentJob;          // Index of the next identification job
 
                 Sample             *pChirp;
                 Sample             *pInverseFilter;
@@ -247,10 +318,25 @@ namespace lsp
                  */
                 void calculateConvolutionParameters(Sample **data, size_t *offset);
 
+                /** Calculate convolution parameters from the lengths of the input time series.
+                 *
+                 * @param lengths length of the input time series after the 0 time index for each channel
+                 */
+                void calculateConvolutionParameters(const size_t *lengths);
+
                 /** Allocate temporary arrays for convolution.
                  *
+                 * @param workers number of workers that perform convolutions concurrently
+                 */
+                status_t allocateConvolutionTempArrays(size_t workers);
+
+                /** Compute FFT images of the inverse filter partitions, the images are shared
+                 * by all channels as the inverse filter prepend differs by the whole number
+                 * of partitions between channels
+                 *
+                 * @return status
                  */
-                status_t allocateConvolutionTempArrays();
+                status_t prepareInverseFilterImages();
 
                 /** Destroy temporary arrays for convolution.
                  *
@@ -271,17 +357,45 @@ namespace lsp
                  * @param data pointer to Sample object containing the time series
                  * @param offset 0 time index for the time series
                  * @param channel channel destination in the multichannel convolution result
+                 * @param worker index of the worker which temporary buffers are used
                  * @return status
                  */
-                status_t do_linear_convolution(Sample *data, size_t offset, size_t channel);
+                status_t do_linear_convolution(Sample *data, size_t offset, size_t channel, size_t worker);
+
+                /** Convolve channels until all submitted channels are processed
+                 *
+                 * @param worker index of the worker which temporary buffers are used
+                 * @return status
+                 */
+                status_t convolution_jobs(size_t worker);
+
+                /** Destroy the buffers of the streaming convolution
+                 *
+                 */
+                void destroyStreamBuffers();
+
+                /** Convolve the pending input partition of the channel with the inverse filter
+                 * and add the result to the convolution result
+                 *
+                 * @param channel channel to process
+                 * @param index index of the input partition
+                 */
+                void stream_partition(size_t channel, size_t index);
+
+                /** Close the LSPC export and release its objects without writing the profile chunk
+                 *
+                 */
+                void destroyExport();
 
-                /** Allocate memory for the nonlinear identification matrices
+                /** Allocate memory for the nonlinear identification matrices, the matrices
+                 * are kept (with the cached coefficients and window) if the sizes do not change
                  *
                  * @param size_t order order of the Hammerstein model
                  * @param size_t windowSize size of the window to isolate the higher order responses
+                 * @param size_t workers number of workers performing the identification concurrently
                  * @return status
                  */
-                status_t allocateIdentificationMatrices(size_t order, size_t windowSize);
+                status_t allocateIdentificationMatrices(size_t order, size_t windowSize, size_t workers);
 
                 /** Destroy the nonlinear identification matrices
                  *
@@ -302,7 +416,8 @@ namespace lsp
                  */
                 inline size_t sub2ind_Data(size_t r, size_t c);
 
-                /** Fill matrices of coefficients with their values
+                /** Fill matrices of coefficients with their values, does nothing if the matrices
+                 * are already computed for the same order and chirp amplitude
                  *
                  */
                 void fillCoefficientsMatrices();
@@ -312,6 +427,14 @@ namespace lsp
                  */
                 void solve();
 
+                /** Solve identification problem for the range of frequency bins
+                 *
+                 * @param first first frequency bin
+                 * @param count number of frequency bins
+                 * @param worker index of the worker which temporary rows are used
+                 */
+                void solve_bins(size_t first, size_t count, size_t worker);
+
                 /** Force DC Blocking in identified Hammerstein Kernels.
                  *
                  */
@@ -327,6 +450,28 @@ namespace lsp
                  */
                 void windowHigherOrderResponses(size_t channel, bool doInnerSmoothing, size_t nFadeIn, size_t nFadeOut, windows::window_t windowType);
 
+                /** Window the Higher Order Response of the specified order with the parameters
+                 * of the current identification jobs
+                 *
+                 * @param order order of the response, starting from 1
+                 * @param worker index of the worker which temporary rows are used
+                 */
+                void windowHigherOrderResponse(size_t order, size_t worker);
+
+                /** Run the identification jobs of the stage concurrently
+                 *
+                 * @param stage stage of the identification
+                 * @param jobs number of jobs
+                 */
+                void run_identification_jobs(ident_stage_t stage, size_t jobs);
+
+                /** Perform identification jobs until all submitted jobs are processed
+                 *
+                 * @param worker index of the worker which temporary rows are used
+                 * @return status
+                 */
+                status_t identification_jobs(size_t worker);
+
                 /** Calculate a sample of a synchronized chirp wave
                  *
                  * @param size_t sampleRate sample rate of the chirp wave
@@ -393,6 +538,15 @@ namespace lsp
                  */
                 status_t calculate_reverberation_time(size_t channel, size_t head, scp_rtcalc_t rtCalc, size_t limit);
 
+                /** Locate the ranges of the convolution result used for the postprocessing
+                 *
+                 * @param offset samples offset from the middle of the convolution result [samples]
+                 * @param bgHead sample at which the background noise profiling starts
+                 * @param bgCount number of samples for the background noise profiling
+                 * @param irHead sample at which the impulse response processing starts
+                 */
+                void locate_postprocessing_ranges(ssize_t offset, size_t *bgHead, size_t *bgCount, size_t *irHead);
+
                 /** Calculate the binomial coefficient n over k (n choose k)
                  *
                  * @param n top integer or set size
@@ -415,8 +569,49 @@ namespace lsp
                  * @param offset 0 time index for the time series
                  * @param nchannels number of channels in the convolution result
                  * @param partSizeLimit maximum size for convolution partision size
+                 * @param threads maximum number of threads that convolve channels concurrently
                  */
-                status_t do_linear_convolutions(Sample **data, size_t *offset, size_t nchannels, size_t partSizeLimit);
+                status_t do_linear_convolutions(Sample **data, size_t *offset, size_t nchannels, size_t partSizeLimit, size_t threads = 1);
+
+                /** Start the streaming convolution: the input time series are fed block by block
+                 * while being captured (for example, by ResponseTaker) and each complete partition
+                 * is immediately convolved with the inverse filter. The result is laid out exactly
+                 * as the one of do_linear_convolutions().
+                 *
+                 * @param nchannels number of channels in the convolution result
+                 * @param length length of each input time series, including the offset [samples]
+                 * @param offset 0 time index for the time series of each channel, may be NULL
+                 * @param partSizeLimit maximum size for convolution partition size
+                 * @return status
+                 */
+                status_t begin_streaming(size_t nchannels, size_t length, const size_t *offset, size_t partSizeLimit);
+
+                /** Feed the next block of the input time series of the channel. The samples preceding
+                 * the 0 time index and exceeding the length passed to begin_streaming() are ignored.
+                 * Does not allocate memory.
+                 *
+                 * @param channel channel in the convolution result
+                 * @param src input samples
+                 * @param count number of input samples
+                 * @return status
+                 */
+                status_t stream_convolution(size_t channel, const float *src, size_t count);
+
+                /** Complete the streaming convolution: the pending partial partitions are convolved
+                 * as zero-padded, after that the convolution result is complete
+                 *
+                 * @return status
+                 */
+                status_t end_streaming();
+
+                /** Check that the streaming convolution is in progress
+                 *
+                 * @return true if the streaming convolution is in progress
+                 */
+                inline bool streaming() const
+                {
+                    return sStream.bActive;
+                }
 
                 /** Postprocess the Linear Convolution result
                  *
@@ -429,6 +624,25 @@ namespace lsp
                  */
                 status_t postprocess_linear_convolution(size_t channel, ssize_t offset, scp_rtcalc_t rtCalc, float windowSize, double tolerance);
 
+                /** Calculate reverberation times of all channels of the convolution result in frequency bands:
+                 * each channel is split into bands by the crossover in one pass, then the background noise,
+                 * the backwards integration limit and the reverberation time are estimated for each band
+                 * in the same way as by postprocess_linear_convolution(). Does not modify the results
+                 * of postprocess_linear_convolution().
+                 *
+                 * @param dst array of channels * (nsplits + 1) results, the results of channel i start at index i * (nsplits + 1)
+                 * @param splits split frequencies of the bands in ascending order (for example, octave band edges) [Hz]
+                 * @param nsplits number of split frequencies, 0 means the full band only
+                 * @param slope slope of the crossover filters
+                 * @param offset samples offset from the middle of the convolution result [samples]
+                 * @param rtCalc reverberation time calculation method
+                 * @param windowSize size of the window used for the envelope follower [s]
+                 * @param tolerance level above background noise below which, even if convolution result peaks are found, the convolution result is considered faded into noise [dB]
+                 * @return status
+                 */
+                status_t calculate_reverberation_times(scp_rt_t *dst, const float *splits, size_t nsplits, size_t slope,
+                        ssize_t offset, scp_rtcalc_t rtCalc, float windowSize, double tolerance);
+
                 /** Postprocess the Nonlinear Convolution result
                  *
                  * @param channel channel in the convolution result
@@ -437,9 +651,10 @@ namespace lsp
                  * @param nFadeOut number of samples for the inner fade out
                  * @param windowType type of smoothing window to be applied to the whole of the higher order response vector
                  * @param nWindowRank rank of resulting FIR responses kernels (exponent of 2 defining their length: 2^nWindowRank)
+                 * @param threads maximum number of threads that window the orders and solve the frequency bins concurrently
                  * @return status
                  */
-                status_t postprocess_nonlinear_convolution(size_t channel, size_t order, bool doInnerSmoothing, size_t nFadeIn, size_t nFadeOut, windows::window_t windowType, size_t nWindowRank);
+                status_t postprocess_nonlinear_convolution(size_t channel, size_t order, bool doInnerSmoothing, size_t nFadeIn, size_t nFadeOut, windows::window_t windowType, size_t nWindowRank, size_t threads = 1);
 
                 /** Save linear convolution result to file, any wanted interval
                  *
@@ -493,6 +708,65 @@ namespace lsp
                 status_t load_from_lspc(const LSPString *path);
                 status_t load_from_lspc(const io::Path *path);
 
+                /** Load a range of frames of the convolution result and chirp parameters from lspc file,
+                 * the frames are read directly into the convolution result which is sized to the range.
+                 * Note that the offsets passed to the postprocessing methods refer to the middle of the
+                 * loaded range then.
+                 *
+                 * @path path to file
+                 * @param head number of the first frame to be loaded
+                 * @param count maximum number of frames to be loaded
+                 * @return status
+                 */
+                status_t load_from_lspc(const char *path, size_t head, size_t count);
+                status_t load_from_lspc(const LSPString *path, size_t head, size_t count);
+                status_t load_from_lspc(const io::Path *path, size_t head, size_t count);
+
+                /** Start chunked export of the convolution result to lspc file: the audio chunk
+                 * is written by export_lspc() calls directly from the convolution result, so the
+                 * write can be spread over several calls of the measurement thread. The convolution
+                 * result should not be modified until end_lspc_export() is called.
+                 *
+                 * @path path to file
+                 * @param offset frames offset from the middle frame (stored as a value only)
+                 * @return status
+                 */
+                status_t begin_lspc_export(const char *path, ssize_t offset = 0);
+                status_t begin_lspc_export(const LSPString *path, ssize_t offset = 0);
+                status_t begin_lspc_export(const io::Path *path, ssize_t offset = 0);
+
+                /** Write the next frames of the convolution result to the lspc file
+                 *
+                 * @param frames maximum number of frames to write
+                 * @return number of frames written, 0 if all frames have been written, or negative status code on error
+                 */
+                ssize_t export_lspc(size_t frames);
+
+                /** Finish the lspc export: write the profile chunk and close the file. If not all frames
+                 * have been written, the export is cancelled and the file is left incomplete.
+                 *
+                 * @return status, STATUS_BAD_STATE if the export was not complete
+                 */
+                status_t end_lspc_export();
+
+                /** Check that the lspc export is in progress
+                 *
+                 * @return true if the lspc export is in progress
+                 */
+                inline bool lspc_exporting() const
+                {
+                    return sExport.pFile != NULL;
+                }
+
+                /** Get progress of the lspc export
+                 *
+                 * @return number of frames written so far
+                 */
+                inline size_t lspc_exported() const
+                {
+                    return sExport.nWritten;
+                }
+
             public:
 
                 /** Check that SynchronizedChirp needs settings update
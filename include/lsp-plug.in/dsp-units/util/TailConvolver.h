@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_UTIL_TAILCONVOLVER_H_
+#define LSP_PLUG_IN_DSP_UNITS_UTIL_TAILCONVOLVER_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/dsp-units/util/Convolver.h>
+#include <lsp-plug.in/dsp-units/util/Oversampler.h>
+
+#define TAIL_CONVOLVER_BUF_SIZE         0x400   /* size of the buffer of the decimated tail in samples */
+#define TAIL_CONVOLVER_LANCZOS          8       /* number of lobes of the Lanczos kernel used to decimate the tail */
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Convolver that processes the head of the impulse response at the full sample rate
+         * and the late tail at the sample rate decimated by the half-band filters of the
+         * Oversampler. The late tail of the room response mostly contains low frequencies,
+         * so the cost of the tail is reduced in factor^2 times (shorter impulse response and
+         * less samples per second) while the content of the tail above the Nyquist frequency
+         * of the decimated rate is dropped. The latency of the decimation is compensated by
+         * the head, so the convolver has no latency.
+         */
+        class TailConvolver
+        {
+            private:
+                TailConvolver & operator = (const TailConvolver &);
+                TailConvolver(const TailConvolver &);
+
+            protected:
+                Convolver       sHead;                  // Head of the impulse response at full sample rate
+                Convolver       sTail;                  // Tail of the impulse response at decimated sample rate
+                Oversampler     sDown;                  // Decimator of the input signal
+                Oversampler     sUp;                    // Interpolator of the output signal
+
+                float          *vIn;                    // Input signal not decimated yet
+                float          *vDec;                   // Decimated input signal
+                float          *vDecOut;                // Decimated output signal
+                float          *vOut;                   // Interpolated output signal
+                size_t          nFactor;                // Decimation factor, 0 if there is no decimated tail
+                size_t          nSplit;                 // Length of the head of the impulse response
+                size_t          nDelay;                 // Delay of the tail processing chain
+                size_t          nInFill;                // Number of samples in the input buffer
+                size_t          nOutFill;               // Number of samples in the output buffer
+                size_t          nConvSize;              // Length of the impulse response
+
+                uint8_t        *pData;                  // Allocated data
+
+            protected:
+                static ssize_t  measure_delay(over_mode_t mode);
+                static void     decimate(float *dst, size_t dst_count, const float *src, size_t src_count, size_t factor);
+
+            public:
+                explicit TailConvolver();
+                ~TailConvolver();
+
+                /**
+                 * Construct object
+                 */
+                void            construct();
+
+                /**
+                 * Destroy object
+                 */
+                void            destroy();
+
+            public:
+                /**
+                 * Initialize convolver
+                 *
+                 * @param data impulse response
+                 * @param count length of impulse response
+                 * @param split length of the head processed at the full sample rate, is extended
+                 *   to the delay of the decimation if necessary
+                 * @param factor decimation factor of the tail: 2, 4 or 8, values less than 2
+                 *   disable the decimated tail
+                 * @param rank rank of the head convolver, the rank of the tail convolver is reduced
+                 *   proportionally to the decimation factor
+                 * @param background process the tails of both convolvers in the background thread
+                 * @return true on success
+                 */
+                bool            init(const float *data, size_t count, size_t split, size_t factor, size_t rank, bool background = false);
+
+                /**
+                 * Process samples
+                 *
+                 * @param dst destination buffer, may be the same as source buffer
+                 * @param src source buffer
+                 * @param count number of samples to process
+                 */
+                void            process(float *dst, const float *src, size_t count);
+
+                /**
+                 * Get the length of the impulse response
+                 * @return length of the impulse response
+                 */
+                inline size_t   data_size() const       { return nConvSize;     }
+
+                /**
+                 * Get the length of the head processed at the full sample rate
+                 * @return length of the head
+                 */
+                inline size_t   split() const           { return nSplit;        }
+
+                /**
+                 * Get the actual decimation factor of the tail
+                 * @return decimation factor, 0 if the tail is not decimated
+                 */
+                inline size_t   factor() const          { return nFactor;       }
+
+                /**
+                 * Get the latency of the convolver
+                 * @return latency of the convolver, always zero
+                 */
+                inline size_t   latency() const         { return 0;             }
+
+                /**
+                 * Dump internal state
+                 * @param v state dumper
+                 */
+                void            dump(IStateDumper *v) const;
+        };
+    }
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_UTIL_TAILCONVOLVER_H_ */
@@ -137,6 +137,17 @@ namespace lsp
                     update_advanced_trg();
                 }
 
+                inline bool locked() const
+                {
+                    if (enTriggerMode == TRG_MODE_SINGLE)
+                        return sLocks.bSingleLock;
+                    if (enTriggerMode == TRG_MODE_MANUAL)
+                        return (!sLocks.bManualAllow) || (sLocks.bManualLock);
+                    return false;
+                }
+
+                bool skip_block(const float *src, size_t count);
+
             public:
 
                 /** Check that trigger needs settings update.
@@ -247,6 +258,20 @@ namespace lsp
                  */
                 void single_sample_processor(float value);
 
+                /** Feed a block of samples to the trigger. The block is scanned by the
+                 * minimum and maximum values of sub-blocks, the sub-blocks where the
+                 * trigger can not change its state are skipped and the remaining samples
+                 * are passed to single_sample_processor(). The result is the same as of
+                 * calling single_sample_processor() for each sample, the trigger state
+                 * corresponds to the last sample of the block.
+                 *
+                 * @param events array to store the indices of samples the trigger fired at, may be NULL
+                 * @param src source buffer
+                 * @param count number of samples to process
+                 * @return number of times the trigger fired
+                 */
+                size_t process(uint32_t *events, const float *src, size_t count);
+
                 /**
                  * Dump the state
                  * @param dumper dumper
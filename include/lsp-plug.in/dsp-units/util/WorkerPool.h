@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LSP_PLUG_IN_DSP_UNITS_UTIL_WORKERPOOL_H_
+#define LSP_PLUG_IN_DSP_UNITS_UTIL_WORKERPOOL_H_
+
+#include <lsp-plug.in/dsp-units/version.h>
+#include <lsp-plug.in/dsp-units/iface/IStateDumper.h>
+#include <lsp-plug.in/common/atomic.h>
+#include <lsp-plug.in/common/status.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Task executed by the worker pool
+         *
+         * @param object the object passed to the WorkerPool::execute()
+         * @param task index of the task
+         */
+        typedef void (* worker_task_t)(void *object, size_t task);
+
+        /**
+         * Pool of worker threads that execute independent tasks in parallel within one
+         * processing block. The calling thread takes part in the execution and picks the
+         * tasks which have not been taken by workers, so the call never waits for the
+         * worker to wake up. The workers spin for the configured time after the last job
+         * and then fall asleep, no memory allocations or system locks are performed
+         * by the execute() call.
+         */
+        class WorkerPool
+        {
+            private:
+                WorkerPool & operator = (const WorkerPool &);
+                WorkerPool(const WorkerPool &);
+
+            protected:
+                class Worker;
+
+            protected:
+                Worker            **vWorkers;       // Worker threads
+                size_t              nWorkers;       // Number of worker threads
+                size_t              nSpinTime;      // Spin time of idle worker [us]
+
+                worker_task_t       pFunc;          // Task function of the current job
+                void               *pObject;        // Object of the current job
+                size_t              nTasks;         // Number of tasks of the current job
+                atomic_t            nGeneration;    // Job counter, changes when the new job is published
+                atomic_t            nNext;          // Index of the next task to pick
+                atomic_t            nDone;          // Number of completed tasks
+                atomic_t            nActive;        // Number of workers that are picking tasks of the job
+
+            protected:
+                void                run_tasks();
+                bool                work(atomic_t generation);
+
+            public:
+                explicit WorkerPool();
+                ~WorkerPool();
+
+                /**
+                 * Construct object
+                 */
+                void                construct();
+
+                /**
+                 * Start worker threads, should not be called from the processing thread
+                 * @param workers number of worker threads, the calling thread is not counted
+                 * @param spin_time time in microseconds the idle worker waits for the next job
+                 *        before falling asleep
+                 * @return status of operation
+                 */
+                status_t            init(size_t workers, size_t spin_time = 2000);
+
+                /**
+                 * Stop worker threads and destroy the pool
+                 */
+                void                destroy();
+
+            public:
+                /**
+                 * Get number of worker threads
+                 * @return number of worker threads
+                 */
+                inline size_t       workers() const     { return nWorkers; }
+
+                /**
+                 * Execute tasks in parallel and wait for their completion. Real-time safe,
+                 * should be called by one thread at a time
+                 * @param func task function
+                 * @param object object passed to the task function
+                 * @param tasks number of tasks, each task is executed exactly once
+                 */
+                void                execute(worker_task_t func, void *object, size_t tasks);
+
+                /**
+                 * Dump the state
+                 * @param v state dumper
+                 */
+                void                dump(IStateDumper *v) const;
+        };
+    } /* namespace dspu */
+} /* namespace lsp */
+
+#endif /* LSP_PLUG_IN_DSP_UNITS_UTIL_WORKERPOOL_H_ */
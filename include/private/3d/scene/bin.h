@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_3D_SCENE_BIN_H_
+#define PRIVATE_3D_SCENE_BIN_H_
+
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/io/Path.h>
+
+#include <private/io/mapped_file.h>
+
+// Version of the binary scene format
+#define BIN_SCENE_VERSION           1
+// Byte order marker
+#define BIN_SCENE_BYTE_ORDER        0x01020304
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /*
+         * Binary scene file format. All data is stored in the native byte order
+         * and aligned to 4 bytes, so arrays can be read directly from the mapped file:
+         *   header
+         *   vertex[header.vertexes]
+         *   normal[header.normals]
+         *   edge[header.edges]
+         *   for each object:
+         *     object header
+         *     name[object header.name_bytes], padded to 4 bytes
+         *     triangle[object header.triangles]
+         */
+    #pragma pack(push, 1)
+        typedef struct bin_scene_header_t
+        {
+            char        signature[8];   // Signature "LSPSCN3D"
+            uint32_t    version;        // Format version
+            uint32_t    byte_order;     // Byte order marker
+            uint32_t    vertexes;       // Number of vertexes
+            uint32_t    normals;        // Number of normals
+            uint32_t    edges;          // Number of edges
+            uint32_t    triangles;      // Overall number of triangles
+            uint32_t    objects;        // Number of objects
+            uint32_t    reserved;       // Reserved, should be zero
+        } bin_scene_header_t;
+
+        typedef struct bin_scene_vector_t
+        {
+            float       v[4];           // Coordinates of vertex or normal
+        } bin_scene_vector_t;
+
+        typedef struct bin_scene_edge_t
+        {
+            uint32_t    v[2];           // Vertex indexes
+        } bin_scene_edge_t;
+
+        typedef struct bin_scene_object_t
+        {
+            uint32_t    name_bytes;     // Length of name in bytes (UTF-8)
+            uint32_t    triangles;      // Number of triangles
+            uint32_t    visible;        // Visibility flag
+            uint32_t    reserved;       // Reserved, should be zero
+            float       matrix[16];     // Transformation matrix
+        } bin_scene_object_t;
+
+        typedef struct bin_scene_triangle_t
+        {
+            uint32_t    face;           // Face identifier
+            uint32_t    v[3];           // Vertex indexes
+            uint32_t    e[3];           // Edge indexes
+            uint32_t    n[3];           // Normal indexes
+        } bin_scene_triangle_t;
+    #pragma pack(pop)
+
+        static const char bin_scene_signature[8] = { 'L', 'S', 'P', 'S', 'C', 'N', '3', 'D' };
+    }
+}
+
+#endif /* PRIVATE_3D_SCENE_BIN_H_ */
@@ -0,0 +1,523 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef PRIVATE_3D_SCENE_OBJ_CHUNKS_H_
+#define PRIVATE_3D_SCENE_OBJ_CHUNKS_H_
+
+#include <lsp-plug.in/dsp-units/3d/Scene3D.h>
+#include <lsp-plug.in/dsp-units/util/WorkerPool.h>
+#include <lsp-plug.in/lltl/darray.h>
+#include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/stdlib/string.h>
+
+#include <private/3d/scene/obj.h>
+
+// Minimum size of the chunk of the OBJ file parsed by one task
+#define OBJ_CHUNK_MIN_SIZE          0x100000
+// Number of chunks per thread for load balancing
+#define OBJ_CHUNKS_PER_THREAD       4
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Parallel loader of the Wavefront OBJ file. The file is split into line-aligned
+         * chunks which are parsed concurrently into the chunk-local arrays, then the
+         * arrays are merged into the scene in the file order with the fix-up of relative
+         * indexes. Only the commonly used subset of the format is parsed in chunks, the
+         * STATUS_UNSUPPORTED_FORMAT is returned for any other statement so the caller
+         * may fall back to the sequential parser.
+         */
+        namespace obj_chunks
+        {
+            enum index_flags_t
+            {
+                IF_REL_VERTEX   = 1 << 0,       // Vertex index is relative to the chunk
+                IF_REL_NORMAL   = 1 << 1,       // Normal index is relative to the chunk
+            };
+
+            typedef struct index_t
+            {
+                ssize_t             v;          // Vertex index
+                ssize_t             n;          // Normal index, negative if not set
+                size_t              flags;      // Index flags
+            } index_t;
+
+            typedef struct face_t
+            {
+                size_t              first;      // First index of the face
+                size_t              count;      // Number of indexes
+            } face_t;
+
+            typedef struct object_t
+            {
+                const char         *name;       // Object name, points to the file data
+                size_t              len;        // Length of the name in bytes
+                size_t              face;       // Index of the first face of the object
+            } object_t;
+
+            typedef struct chunk_t
+            {
+                const char                     *head;       // First byte of the chunk
+                const char                     *tail;       // Byte after the chunk
+                lltl::darray<dsp::point3d_t>    vertex;     // Vertexes
+                lltl::darray<dsp::vector3d_t>   normal;     // Normals
+                lltl::darray<face_t>            face;       // Faces
+                lltl::darray<index_t>           index;      // Indexes of faces
+                lltl::darray<object_t>          object;     // Objects
+                status_t                        res;        // Parsing result
+            } chunk_t;
+
+            static inline bool is_space(char c)
+            {
+                return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\f') || (c == '\v');
+            }
+
+            static inline bool is_digit(char c)
+            {
+                return (c >= '0') && (c <= '9');
+            }
+
+            static inline const char *skip_spaces(const char *p, const char *end)
+            {
+                while ((p < end) && (is_space(*p)))
+                    ++p;
+                return p;
+            }
+
+            static inline bool is_eol(const char *p, const char *end)
+            {
+                return (p >= end) || (*p == '#');
+            }
+
+            static bool parse_float(float *dst, const char **pp, const char *end)
+            {
+                static const double pow10[] =
+                {
+                    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+                };
+
+                const char *p   = *pp;
+                bool neg        = false;
+                if ((p < end) && ((*p == '+') || (*p == '-')))
+                    neg             = *(p++) == '-';
+
+                // Mantissa, digits that do not fit into 64 bits only shift the exponent
+                uint64_t mant   = 0;
+                ssize_t exp     = 0;
+                bool digits     = false;
+                for ( ; (p < end) && (is_digit(*p)); ++p)
+                {
+                    digits          = true;
+                    if (mant < 100000000000000000ULL)
+                        mant            = mant * 10 + (*p - '0');
+                    else
+                        ++exp;
+                }
+                if ((p < end) && (*p == '.'))
+                {
+                    for (++p; (p < end) && (is_digit(*p)); ++p)
+                    {
+                        digits          = true;
+                        if (mant < 100000000000000000ULL)
+                        {
+                            mant            = mant * 10 + (*p - '0');
+                            --exp;
+                        }
+                    }
+                }
+                if (!digits)
+                    return false;
+
+                // Exponent
+                if ((p < end) && ((*p == 'e') || (*p == 'E')))
+                {
+                    ++p;
+                    bool eneg       = false;
+                    if ((p < end) && ((*p == '+') || (*p == '-')))
+                        eneg            = *(p++) == '-';
+                    if ((p >= end) || (!is_digit(*p)))
+                        return false;
+
+                    ssize_t e       = 0;
+                    for ( ; (p < end) && (is_digit(*p)); ++p)
+                        if (e < 10000)
+                            e               = e * 10 + (*p - '0');
+                    exp            += (eneg) ? -e : e;
+                }
+
+                // The number should be followed by space or the end of line
+                if ((p < end) && (!is_space(*p)) && (*p != '#'))
+                    return false;
+
+                double v        = double(mant);
+                if (exp < 0)
+                    v              /= (exp >= -22) ? pow10[-exp] : ::pow(10.0, double(-exp));
+                else if (exp > 0)
+                    v              *= (exp <= 22) ? pow10[exp] : ::pow(10.0, double(exp));
+
+                *dst            = float((neg) ? -v : v);
+                *pp             = p;
+                return true;
+            }
+
+            static bool parse_index(ssize_t *dst, const char **pp, const char *end)
+            {
+                const char *p   = *pp;
+                bool neg        = false;
+                if ((p < end) && ((*p == '+') || (*p == '-')))
+                    neg             = *(p++) == '-';
+                if ((p >= end) || (!is_digit(*p)))
+                    return false;
+
+                ssize_t v       = 0;
+                for ( ; (p < end) && (is_digit(*p)); ++p)
+                {
+                    v               = v * 10 + (*p - '0');
+                    if (v > 0x7fffffff)
+                        return false;
+                }
+                if (v == 0)
+                    return false;
+
+                *dst            = (neg) ? -v : v;
+                *pp             = p;
+                return true;
+            }
+
+            static status_t parse_face(chunk_t *c, const char *p, const char *end)
+            {
+                face_t *f       = c->face.add();
+                if (f == NULL)
+                    return STATUS_NO_MEM;
+                f->first        = c->index.size();
+                f->count        = 0;
+
+                while (true)
+                {
+                    p               = skip_spaces(p, end);
+                    if (is_eol(p, end))
+                        break;
+
+                    ssize_t v, t, n = 0;
+                    if (!parse_index(&v, &p, end))
+                        return STATUS_UNSUPPORTED_FORMAT;
+                    if ((p < end) && (*p == '/'))
+                    {
+                        // Texture coordinate index is not used by the scene
+                        ++p;
+                        if ((p < end) && (*p != '/') && (!parse_index(&t, &p, end)))
+                            return STATUS_UNSUPPORTED_FORMAT;
+                        if ((p < end) && (*p == '/'))
+                        {
+                            ++p;
+                            if (!parse_index(&n, &p, end))
+                                return STATUS_UNSUPPORTED_FORMAT;
+                        }
+                    }
+                    if ((p < end) && (!is_space(*p)) && (*p != '#'))
+                        return STATUS_UNSUPPORTED_FORMAT;
+
+                    index_t *idx    = c->index.add();
+                    if (idx == NULL)
+                        return STATUS_NO_MEM;
+
+                    // Relative indexes are resolved against the chunk-local counters
+                    idx->flags      = 0;
+                    if (v < 0)
+                    {
+                        idx->v          = c->vertex.size() + v;
+                        idx->flags     |= IF_REL_VERTEX;
+                    }
+                    else
+                        idx->v          = v - 1;
+
+                    if (n < 0)
+                    {
+                        idx->n          = c->normal.size() + n;
+                        idx->flags     |= IF_REL_NORMAL;
+                    }
+                    else
+                        idx->n          = n - 1;
+
+                    ++f->count;
+                }
+
+                return (f->count >= 3) ? STATUS_OK : STATUS_UNSUPPORTED_FORMAT;
+            }
+
+            static status_t parse_line(chunk_t *c, const char *p, const char *end)
+            {
+                // Trim the line and skip empty lines and comments
+                while ((end > p) && (is_space(end[-1])))
+                    --end;
+                p               = skip_spaces(p, end);
+                if (is_eol(p, end))
+                    return STATUS_OK;
+                if (end[-1] == '\\')
+                    return STATUS_UNSUPPORTED_FORMAT;
+
+                const char *kw  = p;
+                while ((p < end) && (!is_space(*p)))
+                    ++p;
+                size_t kwlen    = p - kw;
+
+                if ((kwlen == 1) && (kw[0] == 'v'))
+                {
+                    float v[4];
+                    v[3]            = 1.0f;
+                    size_t n        = 0;
+                    for ( ; n < 4; ++n)
+                    {
+                        p               = skip_spaces(p, end);
+                        if (is_eol(p, end))
+                            break;
+                        if (!parse_float(&v[n], &p, end))
+                            return STATUS_UNSUPPORTED_FORMAT;
+                    }
+                    if ((n < 3) || (!is_eol(skip_spaces(p, end), end)))
+                        return STATUS_UNSUPPORTED_FORMAT;
+
+                    dsp::point3d_t *dp  = c->vertex.add();
+                    if (dp == NULL)
+                        return STATUS_NO_MEM;
+                    dp->x           = v[0];
+                    dp->y           = v[1];
+                    dp->z           = v[2];
+                    dp->w           = v[3];
+                    return STATUS_OK;
+                }
+                else if ((kwlen == 2) && (kw[0] == 'v') && (kw[1] == 'n'))
+                {
+                    float v[3];
+                    for (size_t i=0; i<3; ++i)
+                    {
+                        p               = skip_spaces(p, end);
+                        if (!parse_float(&v[i], &p, end))
+                            return STATUS_UNSUPPORTED_FORMAT;
+                    }
+                    if (!is_eol(skip_spaces(p, end), end))
+                        return STATUS_UNSUPPORTED_FORMAT;
+
+                    dsp::vector3d_t *dv = c->normal.add();
+                    if (dv == NULL)
+                        return STATUS_NO_MEM;
+                    dv->dx          = v[0];
+                    dv->dy          = v[1];
+                    dv->dz          = v[2];
+                    dv->dw          = 0.0f;
+                    return STATUS_OK;
+                }
+                else if ((kwlen == 1) && (kw[0] == 'f'))
+                    return parse_face(c, p, end);
+                else if ((kwlen == 1) && (kw[0] == 'o'))
+                {
+                    p               = skip_spaces(p, end);
+                    if (p >= end)
+                        return STATUS_UNSUPPORTED_FORMAT;
+
+                    object_t *o     = c->object.add();
+                    if (o == NULL)
+                        return STATUS_NO_MEM;
+                    o->name         = p;
+                    o->len          = end - p;
+                    o->face         = c->face.size();
+                    return STATUS_OK;
+                }
+
+                // Statements that do not affect the scene
+                if (((kwlen == 2) && (!strncmp(kw, "vt", kwlen))) ||
+                    ((kwlen == 1) && (kw[0] == 's')) ||
+                    ((kwlen == 6) && (!strncmp(kw, "usemtl", kwlen))) ||
+                    ((kwlen == 6) && (!strncmp(kw, "mtllib", kwlen))))
+                    return STATUS_OK;
+
+                return STATUS_UNSUPPORTED_FORMAT;
+            }
+
+            static void parse_chunk(void *object, size_t task)
+            {
+                chunk_t *c      = &static_cast<chunk_t *>(object)[task];
+
+                for (const char *p = c->head; p < c->tail; )
+                {
+                    const char *eol = static_cast<const char *>(::memchr(p, '\n', c->tail - p));
+                    if (eol == NULL)
+                        eol             = c->tail;
+                    if ((c->res = parse_line(c, p, eol)) != STATUS_OK)
+                        return;
+                    p               = eol + 1;
+                }
+            }
+
+            static status_t open_object(ObjSceneHandler *h, const object_t *o, bool *opened)
+            {
+                status_t res;
+                if ((*opened) && ((res = h->end_object()) != STATUS_OK))
+                    return res;
+
+                LSPString name;
+                if (!name.set_utf8(o->name, o->len))
+                    return STATUS_NO_MEM;
+                *opened         = true;
+                return h->begin_object(&name);
+            }
+
+            static status_t merge(Scene3D *scene, chunk_t *chunks, size_t count)
+            {
+                status_t res;
+                ObjSceneHandler h(scene);
+                lltl::darray<obj::index_t> vv, vn, vt;
+                bool opened     = false;
+                ssize_t vbase   = 0, nbase = 0;
+
+                for (size_t i=0; i<count; ++i)
+                {
+                    chunk_t *c      = &chunks[i];
+
+                    for (size_t j=0, n=c->vertex.size(); j<n; ++j)
+                    {
+                        const dsp::point3d_t *p = c->vertex.uget(j);
+                        if (h.add_vertex(p->x, p->y, p->z, p->w) < 0)
+                            return STATUS_NO_MEM;
+                    }
+                    for (size_t j=0, n=c->normal.size(); j<n; ++j)
+                    {
+                        const dsp::vector3d_t *v = c->normal.uget(j);
+                        if (h.add_normal(v->dx, v->dy, v->dz, v->dw) < 0)
+                            return STATUS_NO_MEM;
+                    }
+
+                    size_t oi = 0, no = c->object.size();
+                    for (size_t j=0, n=c->face.size(); j<n; ++j)
+                    {
+                        for ( ; (oi < no) && (c->object.uget(oi)->face <= j); ++oi)
+                            if ((res = open_object(&h, c->object.uget(oi), &opened)) != STATUS_OK)
+                                return res;
+
+                        // Faces outside of objects are handled by the sequential parser
+                        if (!opened)
+                            return STATUS_UNSUPPORTED_FORMAT;
+
+                        const face_t *f         = c->face.uget(j);
+                        const index_t *idx      = c->index.uget(f->first);
+                        vv.clear();
+                        vn.clear();
+                        vt.clear();
+                        obj::index_t *pv        = vv.append_n(f->count);
+                        obj::index_t *pn        = vn.append_n(f->count);
+                        obj::index_t *pt        = vt.append_n(f->count);
+                        if ((pv == NULL) || (pn == NULL) || (pt == NULL))
+                            return STATUS_NO_MEM;
+
+                        for (size_t k=0; k<f->count; ++k, ++idx)
+                        {
+                            pv[k]       = (idx->flags & IF_REL_VERTEX) ? vbase + idx->v : idx->v;
+                            pn[k]       = (idx->flags & IF_REL_NORMAL) ? nbase + idx->n : idx->n;
+                            pt[k]       = -1;
+                            if ((pv[k] < 0) || (size_t(pv[k]) >= scene->num_vertexes()))
+                                return STATUS_BAD_FORMAT;
+                            if (size_t(pn[k] + 1) > scene->num_normals())
+                                return STATUS_BAD_FORMAT;
+                        }
+
+                        if ((res = h.add_face(pv, pn, pt, f->count)) != STATUS_OK)
+                            return res;
+                    }
+
+                    // Objects after the last face of the chunk
+                    for ( ; oi < no; ++oi)
+                        if ((res = open_object(&h, c->object.uget(oi), &opened)) != STATUS_OK)
+                            return res;
+
+                    vbase          += c->vertex.size();
+                    nbase          += c->normal.size();
+                }
+
+                if ((opened) && ((res = h.end_object()) != STATUS_OK))
+                    return res;
+
+                return h.end_of_data();
+            }
+        } /* namespace obj_chunks */
+
+        status_t load_scene_from_obj_chunks(dspu::Scene3D *scene, const char *data, size_t size, size_t threads)
+        {
+            using namespace obj_chunks;
+
+            threads         = lsp_max(threads, size_t(1));
+            size_t count    = lsp_max(lsp_min(threads * OBJ_CHUNKS_PER_THREAD, size / OBJ_CHUNK_MIN_SIZE), size_t(1));
+
+            chunk_t *chunks = new chunk_t[count];
+            if (chunks == NULL)
+                return STATUS_NO_MEM;
+
+            // Split data into line-aligned chunks
+            const char *tail    = &data[size];
+            const char *head    = data;
+            for (size_t i=0; i<count; ++i)
+            {
+                const char *split   = (i < count - 1) ? &data[(size * (i + 1)) / count] : tail;
+                if (split < head)
+                    split               = head;
+                const char *eol     = static_cast<const char *>(::memchr(split, '\n', tail - split));
+                split               = (eol != NULL) ? eol + 1 : tail;
+
+                chunks[i].head      = head;
+                chunks[i].tail      = split;
+                chunks[i].res       = STATUS_OK;
+                head                = split;
+            }
+
+            // Parse chunks
+            status_t res        = STATUS_OK;
+            if ((threads > 1) && (count > 1))
+            {
+                WorkerPool pool;
+                if ((res = pool.init(lsp_min(threads, count) - 1, 0)) == STATUS_OK)
+                {
+                    pool.execute(parse_chunk, chunks, count);
+                    pool.destroy();
+                }
+            }
+            else
+            {
+                for (size_t i=0; i<count; ++i)
+                    parse_chunk(chunks, i);
+            }
+
+            for (size_t i=0; (res == STATUS_OK) && (i<count); ++i)
+                res                 = chunks[i].res;
+
+            // Merge chunks into the scene
+            if (res == STATUS_OK)
+                res                 = merge(scene, chunks, count);
+
+            delete [] chunks;
+            return res;
+        }
+    } /* namespace dspu */
+} /* namespace lsp */
+
+#endif /* PRIVATE_3D_SCENE_OBJ_CHUNKS_H_ */
@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_IO_MAPPED_FILE_H_
+#define PRIVATE_IO_MAPPED_FILE_H_
+
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/io/Path.h>
+
+#ifdef PLATFORM_WINDOWS
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Memory-mapped file. The view of the file stays valid after all file handles
+         * are closed, so only the pointer and the size are required to unmap it
+         */
+        typedef struct mapped_file_t
+        {
+            uint8_t        *data;
+            size_t          size;
+        } mapped_file_t;
+
+        /**
+         * Identity of the file: size and modification time
+         */
+        typedef struct file_identity_t
+        {
+            wsize_t         size;
+            wsize_t         mtime;
+        } file_identity_t;
+
+        static inline void unmap_file(mapped_file_t *f)
+        {
+            if (f->data != NULL)
+            {
+            #ifdef PLATFORM_WINDOWS
+                UnmapViewOfFile(f->data);
+            #else
+                ::munmap(f->data, f->size);
+            #endif
+            }
+            f->data         = NULL;
+            f->size         = 0;
+        }
+
+        /**
+         * Map file into memory
+         * @param f mapped file descriptor
+         * @param path path to the file
+         * @param writable make the mapping writable, the modifications are private
+         *   and are not written back to the file
+         * @return status of operation
+         */
+        static inline status_t map_file(mapped_file_t *f, const io::Path *path, bool writable = false)
+        {
+            f->data         = NULL;
+            f->size         = 0;
+
+        #ifdef PLATFORM_WINDOWS
+            HANDLE hFile    = CreateFileW(
+                reinterpret_cast<LPCWSTR>(path->as_string()->get_utf16()),
+                GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+            if (hFile == INVALID_HANDLE_VALUE)
+                return STATUS_IO_ERROR;
+
+            LARGE_INTEGER size;
+            if ((!GetFileSizeEx(hFile, &size)) || (size.QuadPart <= 0))
+            {
+                CloseHandle(hFile);
+                return STATUS_BAD_FORMAT;
+            }
+
+            HANDLE hMapping = CreateFileMappingW(hFile, NULL, (writable) ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, NULL);
+            CloseHandle(hFile);
+            if (hMapping == NULL)
+                return STATUS_IO_ERROR;
+
+            void *ptr       = MapViewOfFile(hMapping, (writable) ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(hMapping);
+            if (ptr == NULL)
+                return STATUS_IO_ERROR;
+
+            f->data         = reinterpret_cast<uint8_t *>(ptr);
+            f->size         = size.QuadPart;
+        #else
+            int fd          = ::open(path->as_native(), O_RDONLY);
+            if (fd < 0)
+                return STATUS_IO_ERROR;
+
+            struct stat st;
+            if ((::fstat(fd, &st) != 0) || (st.st_size <= 0))
+            {
+                ::close(fd);
+                return STATUS_BAD_FORMAT;
+            }
+
+            int prot        = (writable) ? PROT_READ | PROT_WRITE : PROT_READ;
+            void *ptr       = ::mmap(NULL, st.st_size, prot, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (ptr == MAP_FAILED)
+                return STATUS_IO_ERROR;
+
+            f->data         = reinterpret_cast<uint8_t *>(ptr);
+            f->size         = st.st_size;
+        #endif
+
+            return STATUS_OK;
+        }
+
+        /**
+         * Get identity of the file
+         * @param id pointer to store the identity
+         * @param path path to the file
+         * @return status of operation
+         */
+        static inline status_t file_identity(file_identity_t *id, const io::Path *path)
+        {
+        #ifdef PLATFORM_WINDOWS
+            WIN32_FILE_ATTRIBUTE_DATA attr;
+            if (!GetFileAttributesExW(reinterpret_cast<LPCWSTR>(path->as_string()->get_utf16()), GetFileExInfoStandard, &attr))
+                return STATUS_NOT_FOUND;
+
+            id->size        = (wsize_t(attr.nFileSizeHigh) << 32) | attr.nFileSizeLow;
+            id->mtime       = (wsize_t(attr.ftLastWriteTime.dwHighDateTime) << 32) | attr.ftLastWriteTime.dwLowDateTime;
+        #else
+            struct stat st;
+            if (::stat(path->as_native(), &st) != 0)
+                return STATUS_NOT_FOUND;
+
+            id->size        = st.st_size;
+            id->mtime       = wsize_t(st.st_mtime);
+        #endif
+
+            return STATUS_OK;
+        }
+    }
+}
+
+#endif /* PRIVATE_IO_MAPPED_FILE_H_ */
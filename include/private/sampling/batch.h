@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_SAMPLING_BATCH_H_
+#define PRIVATE_SAMPLING_BATCH_H_
+
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/ipc/Thread.h>
+#include <lsp-plug.in/lltl/parray.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        /**
+         * Function that performs jobs of the batch until there are no more jobs
+         */
+        typedef void (*batch_jobs_t)(void *batch);
+
+        class BatchThread: public ipc::Thread
+        {
+            private:
+                batch_jobs_t        pJobs;
+                void               *pBatch;
+
+            public:
+                explicit BatchThread(batch_jobs_t jobs, void *batch)
+                {
+                    pJobs       = jobs;
+                    pBatch      = batch;
+                }
+
+                virtual ~BatchThread()
+                {
+                }
+
+            public:
+                virtual status_t run()
+                {
+                    pJobs(pBatch);
+                    return STATUS_OK;
+                }
+        };
+
+        /**
+         * Perform jobs of the batch by the specified number of threads, the caller thread
+         * is one of them
+         * @param jobs function that performs jobs
+         * @param batch the batch of jobs
+         * @param count number of jobs in the batch
+         * @param threads number of threads
+         */
+        static inline void batch_run(batch_jobs_t jobs, void *batch, size_t count, size_t threads)
+        {
+            size_t workers      = lsp_min(threads, count);
+            lltl::parray<BatchThread> list;
+
+            for (size_t i=1; i<workers; ++i)
+            {
+                // Failing to start the thread is not critical, jobs
+                // will be performed by the remaining threads
+                BatchThread *t      = new BatchThread(jobs, batch);
+                if (t == NULL)
+                    break;
+                if (t->start() != STATUS_OK)
+                {
+                    delete t;
+                    break;
+                }
+                if (!list.add(t))
+                {
+                    t->join();
+                    delete t;
+                    break;
+                }
+            }
+
+            // Perform jobs in this thread too
+            jobs(batch);
+
+            // Wait for threads
+            for (size_t i=0, n=list.size(); i<n; ++i)
+            {
+                BatchThread *t      = list.uget(i);
+                t->join();
+                delete t;
+            }
+            list.flush();
+        }
+    }
+} /* namespace lsp */
+
+#endif /* PRIVATE_SAMPLING_BATCH_H_ */
@@ -21,6 +21,7 @@
 
 #include <lsp-plug.in/dsp-units/3d/Allocator3D.h>
 #include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/atomic.h>
 #include <lsp-plug.in/common/bits.h>
 #include <lsp-plug.in/common/status.h>
 
@@ -39,6 +40,21 @@ namespace lsp
             vChunks         = NULL;
             pCurr           = NULL;
             nLeft           = 0;
+            pArena          = NULL;
+        }
+
+        BasicAllocator3D::BasicAllocator3D(size_t sz_of, size_t c_size, Arena3D *arena)
+        {
+            nChunks         = 0;
+            nShift          = int_log2(c_size);
+            nMask           = (1 << nShift) - 1;
+
+            nSizeOf         = sz_of;
+            nAllocated      = 0;
+            vChunks         = NULL;
+            pCurr           = NULL;
+            nLeft           = 0;
+            pArena          = arena;
         }
 
         BasicAllocator3D::~BasicAllocator3D()
@@ -67,7 +83,9 @@ namespace lsp
                 return chunk;
 
             // Try to allocate
-            chunk = reinterpret_cast<uint8_t *>(::malloc(nSizeOf << nShift));
+            chunk = (pArena != NULL) ?
+                    pArena->alloc(nSizeOf << nShift) :
+                    reinterpret_cast<uint8_t *>(::malloc(nSizeOf << nShift));
             if (chunk == NULL)
                 return NULL;
 
@@ -162,7 +180,10 @@ namespace lsp
                     uint8_t *c = vChunks[i];
                     if (c != NULL)
                     {
-                        ::free(c);
+                        if (pArena != NULL)
+                            pArena->free(c, nSizeOf << nShift);
+                        else
+                            ::free(c);
                         vChunks[i] = NULL;
                     }
                 }
@@ -194,6 +215,7 @@ namespace lsp
             swap(vChunks, src->vChunks);
             swap(pCurr, src->pCurr);
             swap(nLeft, src->nLeft);
+            swap(pArena, src->pArena);
         }
 
         bool BasicAllocator3D::do_validate(const void *ptr) const
@@ -245,6 +267,189 @@ namespace lsp
 
             return -1;
         }
+
+        BasicConcurrentAllocator3D::BasicConcurrentAllocator3D(size_t sz_of, size_t c_size, Arena3D *arena)
+        {
+            nShift          = int_log2(c_size);
+            nMask           = (1 << nShift) - 1;
+            nSizeOf         = sz_of;
+            nReserved       = 0;
+            pArena          = arena;
+
+            for (size_t i=0; i<ALLOCATOR3D_PAGES; ++i)
+                vPages[i]       = NULL;
+        }
+
+        BasicConcurrentAllocator3D::~BasicConcurrentAllocator3D()
+        {
+            do_destroy();
+        }
+
+        uint8_t *BasicConcurrentAllocator3D::get_chunk(size_t id)
+        {
+            size_t page_id      = id / ALLOCATOR3D_PAGE_SIZE;
+            size_t chunk_id     = id % ALLOCATOR3D_PAGE_SIZE;
+            if (page_id >= ALLOCATOR3D_PAGES)
+                return NULL;
+
+            // Create the page of chunk pointers, the thread that loses the race drops its page
+            uint8_t **page      = vPages[page_id];
+            if (page == NULL)
+            {
+                uint8_t **np        = reinterpret_cast<uint8_t **>(::calloc(ALLOCATOR3D_PAGE_SIZE, sizeof(uint8_t *)));
+                if (np == NULL)
+                    return NULL;
+                if (atomic_cas(&vPages[page_id], page, np))
+                    page                = np;
+                else
+                {
+                    ::free(np);
+                    page                = vPages[page_id];
+                }
+            }
+
+            // Create the chunk in the same way
+            uint8_t *chunk      = page[chunk_id];
+            if (chunk != NULL)
+                return chunk;
+
+            uint8_t *nc         = (pArena != NULL) ?
+                    pArena->alloc(nSizeOf << nShift) :
+                    reinterpret_cast<uint8_t *>(::malloc(nSizeOf << nShift));
+            if (nc == NULL)
+                return NULL;
+
+            if (atomic_cas(&page[chunk_id], chunk, nc))
+                return nc;
+
+            if (pArena != NULL)
+                pArena->free(nc, nSizeOf << nShift);
+            else
+                ::free(nc);
+
+            return page[chunk_id];
+        }
+
+        ssize_t BasicConcurrentAllocator3D::do_alloc_n(void **ptr, size_t n)
+        {
+            // Reserve the range of indexes
+            size_t cap      = capacity();
+            ssize_t first;
+            while (true)
+            {
+                first           = nReserved;
+                if ((size_t(first) + n) > cap)
+                    return -STATUS_OVERFLOW;
+                if (atomic_cas(&nReserved, first, ssize_t(first + n)))
+                    break;
+            }
+
+            // Fetch pointers, chunks are created by the first thread that touches them
+            for (size_t i=first, last=size_t(first) + n; i < last; )
+            {
+                uint8_t *chunk  = get_chunk(i >> nShift);
+                if (chunk == NULL)
+                    return -STATUS_NO_MEM;
+
+                size_t to_do    = lsp_min(last - i, (1 << nShift) - (i & nMask));
+                uint8_t *p      = &chunk[nSizeOf * (i & nMask)];
+                for (i += to_do; to_do > 0; --to_do, p += nSizeOf)
+                    *(ptr++)        = p;
+            }
+
+            return first;
+        }
+
+        void *BasicConcurrentAllocator3D::do_alloc()
+        {
+            void *p         = NULL;
+            return (do_alloc_n(&p, 1) >= 0) ? p : NULL;
+        }
+
+        ssize_t BasicConcurrentAllocator3D::do_ialloc(void **p)
+        {
+            *p              = NULL;
+            return do_alloc_n(p, 1);
+        }
+
+        void *BasicConcurrentAllocator3D::do_get(size_t idx)
+        {
+            if (idx >= size_t(nReserved))
+                return NULL;
+
+            size_t id       = idx >> nShift;
+            uint8_t **page  = vPages[id / ALLOCATOR3D_PAGE_SIZE];
+            uint8_t *chunk  = (page != NULL) ? page[id % ALLOCATOR3D_PAGE_SIZE] : NULL;
+            return (chunk != NULL) ? &chunk[nSizeOf * (idx & nMask)] : NULL;
+        }
+
+        void BasicConcurrentAllocator3D::do_clear()
+        {
+            nReserved       = 0;
+        }
+
+        void BasicConcurrentAllocator3D::do_destroy()
+        {
+            for (size_t i=0; i<ALLOCATOR3D_PAGES; ++i)
+            {
+                uint8_t **page  = vPages[i];
+                if (page == NULL)
+                    continue;
+
+                for (size_t j=0; j<ALLOCATOR3D_PAGE_SIZE; ++j)
+                {
+                    uint8_t *c = page[j];
+                    if (c == NULL)
+                        continue;
+                    if (pArena != NULL)
+                        pArena->free(c, nSizeOf << nShift);
+                    else
+                        ::free(c);
+                }
+
+                ::free(page);
+                vPages[i]       = NULL;
+            }
+
+            nReserved       = 0;
+        }
+
+        void BasicConcurrentAllocator3D::do_swap(BasicConcurrentAllocator3D *src)
+        {
+            swap(nShift, src->nShift);
+            swap(nMask, src->nMask);
+            swap(nSizeOf, src->nSizeOf);
+            swap(nReserved, src->nReserved);
+            swap(pArena, src->pArena);
+            for (size_t i=0; i<ALLOCATOR3D_PAGES; ++i)
+                swap(vPages[i], src->vPages[i]);
+        }
+
+        ssize_t BasicConcurrentAllocator3D::calc_index_of(const void *ptr) const
+        {
+            if (ptr == NULL)
+                return -1;
+
+            const uint8_t *uptr     = reinterpret_cast<const uint8_t *>(ptr);
+            ssize_t csize           = nSizeOf << nShift;
+            size_t chunks           = (size_t(nReserved) + nMask) >> nShift;
+
+            for (size_t i=0; i<chunks; ++i)
+            {
+                const uint8_t * const *page = vPages[i / ALLOCATOR3D_PAGE_SIZE];
+                const uint8_t *chunk        = (page != NULL) ? page[i % ALLOCATOR3D_PAGE_SIZE] : NULL;
+                if (chunk == NULL)
+                    continue;
+                ssize_t delta           = uptr - chunk;
+                if ((delta < 0) || (delta >= csize))
+                    continue;
+                if ((delta % nSizeOf) != 0)
+                    return -1;
+                return (i << nShift) + delta / nSizeOf;
+            }
+
+            return -1;
+        }
     }
 }
 
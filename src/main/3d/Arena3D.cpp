@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/dsp-units/3d/Arena3D.h>
+#include <lsp-plug.in/stdlib/stdlib.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        Arena3D::Arena3D()
+        {
+            for (size_t i=0; i<ARENA3D_BINS; ++i)
+            {
+                vBins[i].nSize  = 0;
+                vBins[i].pFree  = NULL;
+            }
+            nCached         = 0;
+            nLimit          = ARENA3D_DEFAULT_LIMIT;
+            nAllocs         = 0;
+            nReuses         = 0;
+            nUsed           = 0;
+            nPeak           = 0;
+        }
+
+        Arena3D::Arena3D(size_t limit)
+        {
+            for (size_t i=0; i<ARENA3D_BINS; ++i)
+            {
+                vBins[i].nSize  = 0;
+                vBins[i].pFree  = NULL;
+            }
+            nCached         = 0;
+            nLimit          = limit;
+            nAllocs         = 0;
+            nReuses         = 0;
+            nUsed           = 0;
+            nPeak           = 0;
+        }
+
+        Arena3D::~Arena3D()
+        {
+            reset();
+        }
+
+        void Arena3D::free_list(uint8_t *list)
+        {
+            while (list != NULL)
+            {
+                uint8_t *next   = *(reinterpret_cast<uint8_t **>(list));
+                ::free(list);
+                list            = next;
+            }
+        }
+
+        uint8_t *Arena3D::alloc(size_t size)
+        {
+            if (size >= sizeof(uint8_t *))
+            {
+                lkLock.lock();
+                nUsed          += size;
+                nPeak           = lsp_max(nPeak, nUsed);
+                for (size_t i=0; i<ARENA3D_BINS; ++i)
+                {
+                    bin_t *b        = &vBins[i];
+                    if ((b->nSize != size) || (b->pFree == NULL))
+                        continue;
+
+                    // Fetch chunk from the list of free chunks
+                    uint8_t *chunk  = b->pFree;
+                    b->pFree        = *(reinterpret_cast<uint8_t **>(chunk));
+                    nCached        -= size;
+                    ++nReuses;
+                    lkLock.unlock();
+
+                    return chunk;
+                }
+                ++nAllocs;
+                lkLock.unlock();
+            }
+
+            return reinterpret_cast<uint8_t *>(::malloc(size));
+        }
+
+        void Arena3D::free(uint8_t *chunk, size_t size)
+        {
+            if (chunk == NULL)
+                return;
+
+            if (size >= sizeof(uint8_t *))
+            {
+                lkLock.lock();
+                nUsed          -= lsp_min(nUsed, size);
+                if ((nCached + size) <= nLimit)
+                {
+                    // Find the bin of the same size or the empty bin
+                    bin_t *bin      = NULL;
+                    for (size_t i=0; i<ARENA3D_BINS; ++i)
+                    {
+                        bin_t *b        = &vBins[i];
+                        if (b->nSize == size)
+                        {
+                            bin             = b;
+                            break;
+                        }
+                        else if ((bin == NULL) && (b->pFree == NULL))
+                            bin             = b;
+                    }
+
+                    // Store chunk to the list of free chunks
+                    if (bin != NULL)
+                    {
+                        bin->nSize      = size;
+                        *(reinterpret_cast<uint8_t **>(chunk)) = bin->pFree;
+                        bin->pFree      = chunk;
+                        nCached        += size;
+                        lkLock.unlock();
+                        return;
+                    }
+                }
+                lkLock.unlock();
+            }
+
+            ::free(chunk);
+        }
+
+        void Arena3D::reset()
+        {
+            lkLock.lock();
+            for (size_t i=0; i<ARENA3D_BINS; ++i)
+            {
+                bin_t *b        = &vBins[i];
+                free_list(b->pFree);
+                b->nSize        = 0;
+                b->pFree        = NULL;
+            }
+            nCached         = 0;
+            lkLock.unlock();
+        }
+    } // namespace dspu
+} // namespace lsp
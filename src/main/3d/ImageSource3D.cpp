@@ -0,0 +1,727 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/dsp-units/3d/ImageSource3D.h>
+#include <lsp-plug.in/dsp-units/const.h>
+#include <lsp-plug.in/common/debug.h>
+#include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/stdlib/stdlib.h>
+#include <lsp-plug.in/stdlib/string.h>
+
+// Tolerance of plane normals for grouping coplanar triangles
+#define IS_PLANE_NORMAL_TOL         1e-4f
+// Tolerance of plane distance for grouping coplanar triangles [m]
+#define IS_PLANE_DISTANCE_TOL       1e-3f
+// Minimum distance between the source and the listener [m]
+#define IS_DISTANCE_MIN             1e-3f
+// Default maximum number of images
+#define IS_IMAGES_DFL               0x4000
+
+namespace lsp
+{
+    namespace dspu
+    {
+        static inline float distance(const dsp::point3d_t *a, const dsp::point3d_t *b)
+        {
+            float dx    = b->x - a->x;
+            float dy    = b->y - a->y;
+            float dz    = b->z - a->z;
+            return sqrtf(dx*dx + dy*dy + dz*dz);
+        }
+
+        static int cmp_taps(const void *a, const void *b)
+        {
+            const is_tap_t *ta  = static_cast<const is_tap_t *>(a);
+            const is_tap_t *tb  = static_cast<const is_tap_t *>(b);
+            float ga            = fabsf(ta->gain);
+            float gb            = fabsf(tb->gain);
+
+            return (ga > gb) ? -1 : (ga < gb) ? 1 : 0;
+        }
+
+        ImageSource3D::ImageSource3D()
+        {
+            construct();
+        }
+
+        ImageSource3D::~ImageSource3D()
+        {
+            destroy();
+        }
+
+        void ImageSource3D::construct()
+        {
+            pScene          = NULL;
+            sSource.x       = 0.0f;
+            sSource.y       = 0.0f;
+            sSource.z       = 0.0f;
+            sSource.w       = 1.0f;
+            fAmplitude      = 1.0f;
+            fSoundSpeed     = LSP_DSP_UNITS_SOUND_SPEED_M_S;
+            fMaxTime        = 0.0f;
+            fThreshold      = 1e-4f;
+            nMaxOrder       = 2;
+            nMaxImages      = IS_IMAGES_DFL;
+            bUpdateMesh     = true;
+            bUpdateImages   = true;
+        }
+
+        void ImageSource3D::destroy()
+        {
+            pScene          = NULL;
+            vMaterials.flush();
+            vMesh.flush();
+            vTrianglePlane.flush();
+            vPlanes.flush();
+            vPlaneTriangles.flush();
+            vImages.flush();
+            sBVH.flush();
+            bUpdateMesh     = true;
+            bUpdateImages   = true;
+        }
+
+        void ImageSource3D::init_material(rt::material_t *m)
+        {
+            // By default, we set the material to 'Concrete'
+            m->absorption[0]    = 0.02f;
+            m->diffusion[0]     = 1.0f;
+            m->dispersion[0]    = 1.0f;
+            m->transparency[0]  = 0.48f;
+
+            m->absorption[1]    = 0.0f;
+            m->diffusion[1]     = 1.0f;
+            m->dispersion[1]    = 1.0f;
+            m->transparency[1]  = 0.52f;
+
+            m->permeability     = 12.88f;
+        }
+
+        status_t ImageSource3D::set_scene(Scene3D *scene)
+        {
+            size_t objects  = (scene != NULL) ? scene->num_objects() : 0;
+            size_t size     = vMaterials.size();
+
+            if (objects < size)
+            {
+                if (!vMaterials.remove_n(objects, size - objects))
+                    return STATUS_UNKNOWN_ERR;
+            }
+            else if (objects > size)
+            {
+                rt::material_t *m = vMaterials.append_n(objects - size);
+                if (m == NULL)
+                    return STATUS_NO_MEM;
+                for ( ; size < objects; ++size, ++m)
+                    init_material(m);
+            }
+
+            pScene          = scene;
+            bUpdateMesh     = true;
+            bUpdateImages   = true;
+
+            return STATUS_OK;
+        }
+
+        void ImageSource3D::update_scene()
+        {
+            bUpdateMesh     = true;
+            bUpdateImages   = true;
+        }
+
+        status_t ImageSource3D::set_material(size_t idx, const rt::material_t *material)
+        {
+            rt::material_t *m = vMaterials.get(idx);
+            if (m == NULL)
+                return STATUS_INVALID_VALUE;
+
+            *m              = *material;
+            bUpdateImages   = true;
+            return STATUS_OK;
+        }
+
+        status_t ImageSource3D::get_material(rt::material_t *material, size_t idx) const
+        {
+            const rt::material_t *m = vMaterials.get(idx);
+            if (m == NULL)
+                return STATUS_INVALID_VALUE;
+
+            *material       = *m;
+            return STATUS_OK;
+        }
+
+        void ImageSource3D::set_source(const dsp::point3d_t *pos, float amplitude)
+        {
+            if ((pos->x != sSource.x) || (pos->y != sSource.y) || (pos->z != sSource.z))
+                bUpdateImages   = true;
+
+            sSource.x       = pos->x;
+            sSource.y       = pos->y;
+            sSource.z       = pos->z;
+            sSource.w       = 1.0f;
+            fAmplitude      = amplitude;
+        }
+
+        void ImageSource3D::set_max_order(size_t order)
+        {
+            order           = lsp_min(order, size_t(IS_ORDER_MAX));
+            if (order == nMaxOrder)
+                return;
+
+            nMaxOrder       = order;
+            bUpdateImages   = true;
+        }
+
+        void ImageSource3D::set_max_images(size_t images)
+        {
+            if (images == nMaxImages)
+                return;
+
+            nMaxImages      = images;
+            bUpdateImages   = true;
+        }
+
+        void ImageSource3D::set_sound_speed(float speed)
+        {
+            if (speed == fSoundSpeed)
+                return;
+
+            fSoundSpeed     = speed;
+            bUpdateImages   = true;
+        }
+
+        void ImageSource3D::set_max_time(float time)
+        {
+            if (time == fMaxTime)
+                return;
+
+            fMaxTime        = time;
+            bUpdateImages   = true;
+        }
+
+        void ImageSource3D::set_threshold(float thresh)
+        {
+            if (thresh == fThreshold)
+                return;
+
+            fThreshold      = thresh;
+            bUpdateImages   = true;
+        }
+
+        status_t ImageSource3D::build_mesh()
+        {
+            vMesh.clear();
+            sBVH.flush();
+
+            if (pScene == NULL)
+                return build_planes();
+            if (pScene->num_objects() != vMaterials.size())
+                return STATUS_BAD_STATE;
+
+            for (size_t i=0, n=pScene->num_objects(); i<n; ++i)
+            {
+                Object3D *obj   = pScene->object(i);
+                if (obj == NULL)
+                    return STATUS_BAD_STATE;
+                if (!obj->is_visible())
+                    continue;
+
+                const dsp::matrix3d_t *mx   = obj->matrix();
+                rt::material_t *m           = vMaterials.uget(i);
+
+                for (size_t j=0, nt=obj->num_triangles(); j<nt; ++j)
+                {
+                    obj_triangle_t *st  = obj->triangle(j);
+                    rtx::triangle_t t;
+
+                    dsp::apply_matrix3d_mp2(&t.v[0], st->v[0], mx);
+                    dsp::apply_matrix3d_mp2(&t.v[1], st->v[1], mx);
+                    dsp::apply_matrix3d_mp2(&t.v[2], st->v[2], mx);
+
+                    // Skip degenerate triangles, they do not reflect anything
+                    dsp::vector3d_t d1, d2, n;
+                    dsp::init_vector_p2(&d1, &t.v[0], &t.v[1]);
+                    dsp::init_vector_p2(&d2, &t.v[0], &t.v[2]);
+                    dsp::calc_cross3d(&n, &d1, &d2);
+                    if ((n.dx*n.dx + n.dy*n.dy + n.dz*n.dz) <= DSP_3D_TOLERANCE * DSP_3D_TOLERANCE)
+                        continue;
+
+                    dsp::calc_plane_p3(&t.n, &t.v[0], &t.v[1], &t.v[2]);
+                    t.oid       = i;
+                    t.face      = st->face;
+                    t.m         = m;
+                    t.e[0]      = NULL;
+                    t.e[1]      = NULL;
+                    t.e[2]      = NULL;
+
+                    if (!vMesh.add(&t))
+                        return STATUS_NO_MEM;
+                }
+            }
+
+            if (vMesh.size() > 0)
+            {
+                status_t res = sBVH.build(vMesh.array(), vMesh.size());
+                if (res != STATUS_OK)
+                    return res;
+            }
+
+            return build_planes();
+        }
+
+        status_t ImageSource3D::build_planes()
+        {
+            vTrianglePlane.clear();
+            vPlanes.clear();
+            vPlaneTriangles.clear();
+
+            size_t nt       = vMesh.size();
+            if (nt <= 0)
+                return STATUS_OK;
+
+            size_t *tp      = vTrianglePlane.append_n(nt);
+            size_t *pt      = vPlaneTriangles.append_n(nt);
+            if ((tp == NULL) || (pt == NULL))
+                return STATUS_NO_MEM;
+
+            // Assign each triangle to the plane with the same equation and material
+            for (size_t i=0; i<nt; ++i)
+            {
+                const rtx::triangle_t *t    = vMesh.uget(i);
+                size_t idx                  = vPlanes.size();
+
+                for (size_t j=0; j<idx; ++j)
+                {
+                    const plane_t *p    = vPlanes.uget(j);
+                    if (p->m != t->m)
+                        continue;
+                    float k = p->pl.dx * t->n.dx + p->pl.dy * t->n.dy + p->pl.dz * t->n.dz;
+                    if ((k >= 1.0f - IS_PLANE_NORMAL_TOL) && (fabsf(p->pl.dw - t->n.dw) <= IS_PLANE_DISTANCE_TOL))
+                    {
+                        idx     = j;
+                        break;
+                    }
+                }
+
+                if (idx >= vPlanes.size())
+                {
+                    plane_t *p  = vPlanes.add();
+                    if (p == NULL)
+                        return STATUS_NO_MEM;
+                    p->pl       = t->n;
+                    p->m        = t->m;
+                    p->first    = 0;
+                    p->count    = 0;
+                }
+
+                tp[i]       = idx;
+                ++vPlanes.uget(idx)->count;
+            }
+
+            // Lay out triangles of each plane contiguously
+            for (size_t i=0, first=0, n=vPlanes.size(); i<n; ++i)
+            {
+                plane_t *p  = vPlanes.uget(i);
+                p->first    = first;
+                first      += p->count;
+                p->count    = 0;
+            }
+            for (size_t i=0; i<nt; ++i)
+            {
+                plane_t *p  = vPlanes.uget(tp[i]);
+                pt[p->first + p->count++] = i;
+            }
+
+            lsp_trace("Built %d reflecting planes of %d triangles", int(vPlanes.size()), int(nt));
+
+            return STATUS_OK;
+        }
+
+        status_t ImageSource3D::build_images()
+        {
+            vImages.clear();
+            if ((nMaxOrder <= 0) || (vPlanes.size() <= 0))
+                return STATUS_OK;
+
+            // Images that are too far from the scene can not produce taps within the maximum time
+            float max_path  = (fMaxTime > 0.0f) ? fMaxTime * fSoundSpeed : -1.0f;
+            dsp::point3d_t c;
+            float radius    = 0.0f;
+            if (!sBVH.is_empty())
+            {
+                const dsp::bound_box3d_t *b = &sBVH.nodes.uget(0)->bbox;
+                c.x             = (b->p[3].x + b->p[5].x) * 0.5f;
+                c.y             = (b->p[3].y + b->p[5].y) * 0.5f;
+                c.z             = (b->p[3].z + b->p[5].z) * 0.5f;
+                c.w             = 1.0f;
+                radius          = distance(&c, &b->p[3]);
+            }
+            else
+                max_path        = -1.0f;
+
+            float thresh    = (fAmplitude != 0.0f) ? fThreshold / fabsf(fAmplitude) : 0.0f;
+            size_t first    = 0, last = 0;
+
+            for (size_t order=1; order<=nMaxOrder; ++order)
+            {
+                // The first order is built from the source itself
+                ssize_t pfirst  = (order > 1) ? ssize_t(first) : -1;
+                ssize_t plast   = (order > 1) ? ssize_t(last) : 0;
+                first           = vImages.size();
+
+                for (ssize_t i=pfirst; i<plast; ++i)
+                {
+                    // Copy the parent since adding images may relocate the storage
+                    image_t parent;
+                    if (i >= 0)
+                        parent          = *(vImages.uget(i));
+                    else
+                    {
+                        parent.pos      = sSource;
+                        parent.parent   = -1;
+                        parent.plane    = vPlanes.size();
+                        parent.order    = 0;
+                        parent.gain     = 1.0f;
+                    }
+
+                    for (size_t j=0, n=vPlanes.size(); j<n; ++j)
+                    {
+                        // Consecutive reflections from the same plane are not possible
+                        if (j == parent.plane)
+                            continue;
+
+                        const plane_t *p    = vPlanes.uget(j);
+                        const rt::material_t *m = p->m;
+                        float d         = p->pl.dx * parent.pos.x + p->pl.dy * parent.pos.y + p->pl.dz * parent.pos.z + p->pl.dw;
+                        if (fabsf(d) <= DSP_3D_TOLERANCE)
+                            continue;
+
+                        // Reflection coefficient for the side of the plane facing the parent, sign negated
+                        size_t side     = (d > 0.0f) ? 0 : 1;
+                        float gain      = parent.gain * (1.0f - m->absorption[side]) * (m->transparency[side] - 1.0f);
+                        if (fabsf(gain) <= thresh)
+                            continue;
+
+                        image_t img;
+                        img.pos.x       = parent.pos.x - 2.0f * d * p->pl.dx;
+                        img.pos.y       = parent.pos.y - 2.0f * d * p->pl.dy;
+                        img.pos.z       = parent.pos.z - 2.0f * d * p->pl.dz;
+                        img.pos.w       = 1.0f;
+                        img.parent      = i;
+                        img.plane       = j;
+                        img.order       = order;
+                        img.gain        = gain;
+
+                        if ((max_path >= 0.0f) && (distance(&img.pos, &c) - radius > max_path))
+                            continue;
+
+                        if (vImages.size() >= nMaxImages)
+                        {
+                            lsp_trace("Number of images limited to %d at order %d", int(nMaxImages), int(order));
+                            return STATUS_OK;
+                        }
+                        if (!vImages.add(&img))
+                            return STATUS_NO_MEM;
+                    }
+                }
+
+                last            = vImages.size();
+                if (first >= last)
+                    break;
+            }
+
+            lsp_trace("Built %d images of order up to %d", int(vImages.size()), int(nMaxOrder));
+
+            return STATUS_OK;
+        }
+
+        bool ImageSource3D::find_hit(dsp::point3d_t *hit, const plane_t *p, const dsp::point3d_t *a, const dsp::point3d_t *b) const
+        {
+            // The segment should cross the plane
+            float da    = p->pl.dx * a->x + p->pl.dy * a->y + p->pl.dz * a->z + p->pl.dw;
+            float db    = p->pl.dx * b->x + p->pl.dy * b->y + p->pl.dz * b->z + p->pl.dw;
+            if (da * db >= 0.0f)
+                return false;
+
+            float t     = da / (da - db);
+            hit->x      = a->x + (b->x - a->x) * t;
+            hit->y      = a->y + (b->y - a->y) * t;
+            hit->z      = a->z + (b->z - a->z) * t;
+            hit->w      = 1.0f;
+
+            // The crossing point should lie inside one of the triangles of the plane
+            const size_t *pt    = vPlaneTriangles.uget(p->first);
+            for (size_t i=0; i<p->count; ++i)
+            {
+                const rtx::triangle_t *tr   = vMesh.uget(pt[i]);
+                bool inside                 = true;
+
+                for (size_t k=0; (inside) && (k<3); ++k)
+                {
+                    const dsp::point3d_t *v0    = &tr->v[k];
+                    const dsp::point3d_t *v1    = &tr->v[(k+1) % 3];
+                    float ex    = v1->x - v0->x, ey = v1->y - v0->y, ez = v1->z - v0->z;
+                    float hx    = hit->x - v0->x, hy = hit->y - v0->y, hz = hit->z - v0->z;
+
+                    // (e x h) * n
+                    float s     = (ey*hz - ez*hy) * tr->n.dx + (ez*hx - ex*hz) * tr->n.dy + (ex*hy - ey*hx) * tr->n.dz;
+                    inside      = s >= -DSP_3D_TOLERANCE;
+                }
+
+                if (inside)
+                    return true;
+            }
+
+            return false;
+        }
+
+        bool ImageSource3D::check_box(const dsp::bound_box3d_t *bbox, const dsp::point3d_t *a, const dsp::vector3d_t *d)
+        {
+            // Slab test of the segment a + d*t, t in [0, 1]
+            const float *org    = &a->x;
+            const float *dir    = &d->dx;
+            const float *bmin   = &bbox->p[5].x;
+            const float *bmax   = &bbox->p[3].x;
+            float t0 = 0.0f, t1 = 1.0f;
+
+            for (size_t i=0; i<3; ++i)
+            {
+                if (fabsf(dir[i]) <= DSP_3D_TOLERANCE * DSP_3D_TOLERANCE)
+                {
+                    if ((org[i] < bmin[i] - DSP_3D_TOLERANCE) || (org[i] > bmax[i] + DSP_3D_TOLERANCE))
+                        return false;
+                    continue;
+                }
+
+                float k     = 1.0f / dir[i];
+                float tn    = (bmin[i] - DSP_3D_TOLERANCE - org[i]) * k;
+                float tf    = (bmax[i] + DSP_3D_TOLERANCE - org[i]) * k;
+                if (tn > tf)
+                {
+                    float tmp   = tn;
+                    tn          = tf;
+                    tf          = tmp;
+                }
+                t0          = lsp_max(t0, tn);
+                t1          = lsp_min(t1, tf);
+                if (t0 > t1)
+                    return false;
+            }
+
+            return true;
+        }
+
+        bool ImageSource3D::intersect(const rtx::triangle_t *t, const dsp::point3d_t *a, const dsp::vector3d_t *d)
+        {
+            // Moller-Trumbore intersection of the segment a + d*k, k in (0, 1)
+            dsp::vector3d_t e1, e2, p, s, q;
+            dsp::init_vector_p2(&e1, &t->v[0], &t->v[1]);
+            dsp::init_vector_p2(&e2, &t->v[0], &t->v[2]);
+            dsp::calc_cross3d(&p, d, &e2);
+
+            float det   = e1.dx * p.dx + e1.dy * p.dy + e1.dz * p.dz;
+            if (fabsf(det) <= DSP_3D_TOLERANCE * DSP_3D_TOLERANCE)
+                return false;
+
+            float idet  = 1.0f / det;
+            dsp::init_vector_p2(&s, &t->v[0], a);
+            float u     = (s.dx * p.dx + s.dy * p.dy + s.dz * p.dz) * idet;
+            if ((u < 0.0f) || (u > 1.0f))
+                return false;
+
+            dsp::calc_cross3d(&q, &s, &e1);
+            float v     = (d->dx * q.dx + d->dy * q.dy + d->dz * q.dz) * idet;
+            if ((v < 0.0f) || ((u + v) > 1.0f))
+                return false;
+
+            float k     = (e2.dx * q.dx + e2.dy * q.dy + e2.dz * q.dz) * idet;
+            return (k > DSP_3D_TOLERANCE) && (k < 1.0f - DSP_3D_TOLERANCE);
+        }
+
+        float ImageSource3D::transmission(const dsp::point3d_t *a, const dsp::point3d_t *b, ssize_t pa, ssize_t pb) const
+        {
+            if (sBVH.is_empty())
+                return 1.0f;
+
+            dsp::vector3d_t d;
+            dsp::init_vector_p2(&d, a, b);
+
+            float gain  = 1.0f;
+            size_t stack[RT_BVH_MAX_DEPTH + 1];
+            size_t top  = 0;
+            stack[top++]= 0;
+
+            while (top > 0)
+            {
+                const rt::bvh_node_t *node = sBVH.nodes.uget(stack[--top]);
+                if (!check_box(&node->bbox, a, &d))
+                    continue;
+
+                if (node->left > 0)
+                {
+                    stack[top++]    = node->left;
+                    stack[top++]    = node->right;
+                    continue;
+                }
+
+                for (size_t i=node->first, n=node->first + node->count; i<n; ++i)
+                {
+                    // The planes of reflection at the ends of the segment do not occlude it
+                    ssize_t plane   = *(vTrianglePlane.uget(i));
+                    if ((plane == pa) || (plane == pb))
+                        continue;
+
+                    const rtx::triangle_t *t    = vMesh.uget(i);
+                    if (!intersect(t, a, &d))
+                        continue;
+
+                    const rt::material_t *m     = t->m;
+                    float da    = t->n.dx * a->x + t->n.dy * a->y + t->n.dz * a->z + t->n.dw;
+                    size_t side = (da > 0.0f) ? 0 : 1;
+                    gain       *= (1.0f - m->absorption[side]) * m->transparency[side];
+                    if (gain <= 0.0f)
+                        return 0.0f;
+                }
+            }
+
+            return gain;
+        }
+
+        status_t ImageSource3D::process(lltl::darray<is_tap_t> *taps, const dsp::point3d_t *listener)
+        {
+            status_t res;
+
+            if (bUpdateMesh)
+            {
+                if ((res = build_mesh()) != STATUS_OK)
+                    return res;
+                bUpdateMesh     = false;
+                bUpdateImages   = true;
+            }
+            if (bUpdateImages)
+            {
+                if ((res = build_images()) != STATUS_OK)
+                    return res;
+                bUpdateImages   = false;
+            }
+
+            taps->clear();
+
+            float max_path  = (fMaxTime > 0.0f) ? fMaxTime * fSoundSpeed : -1.0f;
+            float thresh    = fabsf(fThreshold);
+
+            // Index -1 stands for the direct sound
+            for (ssize_t i=-1, n=vImages.size(); i<n; ++i)
+            {
+                const image_t *img      = (i >= 0) ? vImages.uget(i) : NULL;
+                const dsp::point3d_t *s = (img != NULL) ? &img->pos : &sSource;
+
+                float dist      = distance(listener, s);
+                if ((max_path >= 0.0f) && (dist > max_path))
+                    continue;
+
+                float gain      = fAmplitude / lsp_max(dist, IS_DISTANCE_MIN);
+                if (img != NULL)
+                    gain           *= img->gain;
+                if (fabsf(gain) <= thresh)
+                    continue;
+
+                // Walk the chain of images back from the listener to the source
+                dsp::point3d_t a = *listener, hit;
+                ssize_t pa      = -1;
+                bool valid      = true;
+
+                for (const image_t *im = img; im != NULL; )
+                {
+                    const plane_t *p    = vPlanes.uget(im->plane);
+                    if (!find_hit(&hit, p, &a, &im->pos))
+                    {
+                        valid           = false;
+                        break;
+                    }
+
+                    gain           *= transmission(&a, &hit, pa, im->plane);
+                    if (fabsf(gain) <= thresh)
+                    {
+                        valid           = false;
+                        break;
+                    }
+
+                    a               = hit;
+                    pa              = im->plane;
+                    im              = (im->parent >= 0) ? vImages.uget(im->parent) : NULL;
+                }
+                if (!valid)
+                    continue;
+
+                gain           *= transmission(&a, &sSource, pa, -1);
+                if (fabsf(gain) <= thresh)
+                    continue;
+
+                is_tap_t *tap   = taps->add();
+                if (tap == NULL)
+                    return STATUS_NO_MEM;
+
+                tap->delay      = dist / fSoundSpeed;
+                tap->gain       = gain;
+                dsp::init_vector_p2(&tap->dir, listener, s);
+                if (dist > 0.0f)
+                    dsp::normalize_vector(&tap->dir);
+                tap->order      = (img != NULL) ? img->order : 0;
+            }
+
+            return STATUS_OK;
+        }
+
+        size_t ImageSource3D::apply(MultiTapDelay *dly, const is_tap_t *taps, size_t n, size_t sample_rate)
+        {
+            size_t count    = dly->taps();
+            size_t max      = dly->max_delay();
+            size_t used     = 0;
+
+            // Select the strongest taps
+            lltl::darray<is_tap_t> list;
+            is_tap_t *sorted    = (n > count) ? list.append_n(n) : NULL;
+            if (sorted != NULL)
+            {
+                ::memcpy(sorted, taps, n * sizeof(is_tap_t));
+                ::qsort(sorted, n, sizeof(is_tap_t), cmp_taps);
+                taps                = sorted;
+            }
+
+            for (size_t i=0; i<count; ++i)
+            {
+                if (i >= n)
+                {
+                    dly->set_gain(i, 0.0f);
+                    continue;
+                }
+
+                size_t delay    = size_t(taps[i].delay * sample_rate + 0.5f);
+                dly->set_delay(i, lsp_min(delay, max));
+                dly->set_gain(i, taps[i].gain);
+                ++used;
+            }
+
+            return used;
+        }
+    } /* namespace dspu */
+} /* namespace lsp */
@@ -20,6 +20,9 @@
  */
 
 #include <lsp-plug.in/dsp-units/3d/Object3D.h>
+#include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/stdlib/stdlib.h>
+#include <lsp-plug.in/stdlib/string.h>
 
 namespace lsp
 {
@@ -43,6 +46,13 @@ namespace lsp
             dsp::init_point_xyz(&sBoundBox.p[7], 0.0f, 0.0f, 0.0f);
 
             dsp::init_point_xyz(&sCenter, 0.0f, 0.0f, 0.0f);
+
+            sWorldMatrix            = sMatrix;
+            sWorldBox               = sBoundBox;
+            sWorldCenter            = sCenter;
+            fWorldRadius            = 0.0f;
+            bWorldValid             = false;
+            bPackedValid            = false;
         }
 
         Object3D::~Object3D()
@@ -53,6 +63,15 @@ namespace lsp
         void Object3D::destroy()
         {
             vTriangles.flush();
+
+            sPacked.vertex.flush();
+            sPacked.normal.flush();
+            sPacked.edge.flush();
+            sPacked.vindex.flush();
+            sPacked.nindex.flush();
+            sPacked.eindex.flush();
+            sPacked.face.flush();
+            bPackedValid    = false;
         }
 
         void Object3D::post_load()
@@ -67,6 +86,9 @@ namespace lsp
             sCenter.x      *= 0.125f; // 1/8
             sCenter.y      *= 0.125f; // 1/8
             sCenter.z      *= 0.125f; // 1/8
+
+            bWorldValid     = false;
+            bPackedValid    = false;
         }
 
         status_t Object3D::add_triangle(
@@ -134,6 +156,8 @@ namespace lsp
             bool first = vTriangles.size() <= 0;
             if (!vTriangles.add(t))
                 return STATUS_NO_MEM;
+            bWorldValid = false;
+            bPackedValid = false;
 
             // Commit triangle edges
             if (first)
@@ -152,6 +176,8 @@ namespace lsp
 
         void Object3D::calc_bound_box()
         {
+            bWorldValid         = false;
+
             obj_triangle_t **vt = vTriangles.array();
             for (size_t i=0, n=vTriangles.size(); i<n; ++i)
             {
@@ -169,6 +195,202 @@ namespace lsp
             }
         }
 
+        void Object3D::update_world_bounds()
+        {
+            // Transform the corners of the box and compute the center
+            dsp::init_point_xyz(&sWorldCenter, 0.0f, 0.0f, 0.0f);
+            for (size_t i=0; i<8; ++i)
+            {
+                dsp::apply_matrix3d_mp2(&sWorldBox.p[i], &sBoundBox.p[i], &sMatrix);
+                sWorldCenter.x += sWorldBox.p[i].x;
+                sWorldCenter.y += sWorldBox.p[i].y;
+                sWorldCenter.z += sWorldBox.p[i].z;
+            }
+            sWorldCenter.x *= 0.125f; // 1/8
+            sWorldCenter.y *= 0.125f; // 1/8
+            sWorldCenter.z *= 0.125f; // 1/8
+
+            // The sphere encloses all corners of the box
+            float r2            = 0.0f;
+            for (size_t i=0; i<8; ++i)
+            {
+                float dx            = sWorldBox.p[i].x - sWorldCenter.x;
+                float dy            = sWorldBox.p[i].y - sWorldCenter.y;
+                float dz            = sWorldBox.p[i].z - sWorldCenter.z;
+                r2                  = lsp_max(r2, dx*dx + dy*dy + dz*dz);
+            }
+            fWorldRadius        = sqrtf(r2);
+            sWorldMatrix        = sMatrix;
+            bWorldValid         = true;
+        }
+
+        void Object3D::validate_world_bounds()
+        {
+            // The matrix is accessible by pointer, so compare it with the one used for caching
+            if ((!bWorldValid) || (memcmp(&sWorldMatrix, &sMatrix, sizeof(dsp::matrix3d_t)) != 0))
+                update_world_bounds();
+        }
+
+        const obj_boundbox_t *Object3D::world_bound_box()
+        {
+            validate_world_bounds();
+            return &sWorldBox;
+        }
+
+        const dsp::point3d_t *Object3D::world_center()
+        {
+            validate_world_bounds();
+            return &sWorldCenter;
+        }
+
+        float Object3D::world_radius()
+        {
+            validate_world_bounds();
+            return fWorldRadius;
+        }
+
+        static int cmp_packed_normals(const void *a, const void *b)
+        {
+            const obj_normal_t *na = *static_cast<obj_normal_t * const *>(a);
+            const obj_normal_t *nb = *static_cast<obj_normal_t * const *>(b);
+            return (na < nb) ? -1 : (na > nb) ? 1 : 0;
+        }
+
+        status_t Object3D::build_packed()
+        {
+            static const uint32_t NONE = uint32_t(-1);
+
+            obj_packed_t *p     = &sPacked;
+            p->vertex.clear();
+            p->normal.clear();
+            p->edge.clear();
+            p->vindex.clear();
+            p->nindex.clear();
+            p->eindex.clear();
+            p->face.clear();
+
+            size_t nt           = vTriangles.size();
+            if (nt <= 0)
+            {
+                bPackedValid        = true;
+                return STATUS_OK;
+            }
+
+            // Maps of scene-wide identifiers to packed indexes
+            size_t max_t = 0, max_v = 0, max_e = 0;
+            for (size_t i=0; i<nt; ++i)
+            {
+                const obj_triangle_t *t = vTriangles.uget(i);
+                max_t               = lsp_max(max_t, size_t(t->id));
+                for (size_t j=0; j<3; ++j)
+                {
+                    max_v               = lsp_max(max_v, size_t(t->v[j]->id));
+                    max_e               = lsp_max(max_e, size_t(t->e[j]->id));
+                }
+            }
+
+            lltl::darray<uint32_t> tmap, vmap, emap;
+            lltl::darray<obj_normal_t *> nlist;
+            uint32_t *tm        = tmap.append_n(max_t + 1);
+            uint32_t *vm        = vmap.append_n(max_v + 1);
+            uint32_t *em        = emap.append_n(max_e + 1);
+            obj_normal_t **nl   = nlist.append_n(nt * 3);
+            if ((tm == NULL) || (vm == NULL) || (em == NULL) || (nl == NULL))
+                return STATUS_NO_MEM;
+            memset(tm, 0xff, (max_t + 1) * sizeof(uint32_t));
+            memset(vm, 0xff, (max_v + 1) * sizeof(uint32_t));
+            memset(em, 0xff, (max_e + 1) * sizeof(uint32_t));
+
+            // Normals have no reliable identifiers, deduplicate them by address
+            size_t nn           = 0;
+            for (size_t i=0; i<nt; ++i)
+            {
+                const obj_triangle_t *t = vTriangles.uget(i);
+                for (size_t j=0; j<3; ++j)
+                    if (t->n[j] != NULL)
+                        nl[nn++]            = t->n[j];
+            }
+            ::qsort(nl, nn, sizeof(obj_normal_t *), cmp_packed_normals);
+
+            lltl::darray<uint32_t> nmap;
+            uint32_t *nm        = (nn > 0) ? nmap.append_n(nn) : NULL;
+            if ((nn > 0) && (nm == NULL))
+                return STATUS_NO_MEM;
+            if (nn > 0)
+                memset(nm, 0xff, nn * sizeof(uint32_t));
+
+            // Emit triangles
+            for (size_t i=0; i<nt; ++i)
+            {
+                const obj_triangle_t *t = vTriangles.uget(i);
+                if (tm[t->id] != NONE) // Skip already emitted triangle
+                    continue;
+                tm[t->id]           = p->face.size();
+
+                uint32_t *vi        = p->vindex.append_n(3);
+                uint32_t *ni        = p->nindex.append_n(3);
+                uint32_t *ei        = p->eindex.append_n(3);
+                ssize_t *fi         = p->face.add();
+                if ((vi == NULL) || (ni == NULL) || (ei == NULL) || (fi == NULL))
+                    return STATUS_NO_MEM;
+                *fi                 = t->face;
+
+                for (size_t j=0; j<3; ++j)
+                {
+                    const obj_vertex_t *sv  = t->v[j];
+                    if (vm[sv->id] == NONE)
+                    {
+                        vm[sv->id]          = p->vertex.size();
+                        if (!p->vertex.add(static_cast<const dsp::point3d_t *>(sv)))
+                            return STATUS_NO_MEM;
+                    }
+                    vi[j]               = vm[sv->id];
+                }
+
+                for (size_t j=0; j<3; ++j)
+                {
+                    // Normal
+                    ni[j]               = NONE;
+                    if (t->n[j] != NULL)
+                    {
+                        obj_normal_t **pn   = static_cast<obj_normal_t **>(
+                            ::bsearch(&t->n[j], nl, nn, sizeof(obj_normal_t *), cmp_packed_normals));
+                        size_t k            = pn - nl;
+                        if (nm[k] == NONE)
+                        {
+                            nm[k]               = p->normal.size();
+                            if (!p->normal.add(static_cast<const dsp::vector3d_t *>(t->n[j])))
+                                return STATUS_NO_MEM;
+                        }
+                        ni[j]               = nm[k];
+                    }
+
+                    // Edge
+                    const obj_edge_t *se    = t->e[j];
+                    if (em[se->id] == NONE)
+                    {
+                        uint32_t *de        = p->edge.append_n(2);
+                        if (de == NULL)
+                            return STATUS_NO_MEM;
+                        em[se->id]          = p->edge.size() / 2 - 1;
+                        de[0]               = vm[se->v[0]->id];
+                        de[1]               = vm[se->v[1]->id];
+                    }
+                    ei[j]               = em[se->id];
+                }
+            }
+
+            bPackedValid        = true;
+            return STATUS_OK;
+        }
+
+        const obj_packed_t *Object3D::packed()
+        {
+            if ((!bPackedValid) && (build_packed() != STATUS_OK))
+                return NULL;
+            return &sPacked;
+        }
+
         obj_edge_t *Object3D::register_edge(obj_vertex_t *v0, obj_vertex_t *v1)
         {
             // Lookup for already existing edge
@@ -21,39 +21,35 @@
 
 #include <lsp-plug.in/dsp-units/3d/RayTrace3D.h>
 #include <lsp-plug.in/dsp-units/const.h>
+#include <lsp-plug.in/dsp-units/units.h>
+#include <lsp-plug.in/dsp-units/util/PerfCounter.h>
 #include <lsp-plug.in/common/debug.h>
 #include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/stdlib/stdlib.h>
+#include <lsp-plug.in/stdlib/string.h>
+#include <lsp-plug.in/io/InFileStream.h>
+#include <lsp-plug.in/io/OutFileStream.h>
 
-#define SAMPLE_QUANTITY     512
 #define TASK_LO_THRESH      0x2000
 #define TASK_HI_THRESH      0x4000
+#define TASK_IDLE_SPINS     0x40
+#define CAPTURE_CHUNK_SIZE  0x1000
+#define CAPTURE_LEAF_SIZE   4
 
 
 namespace lsp
 {
     namespace dspu
     {
-        static const size_t bbox_map[] =
-        {
-            0, 1, 2,
-            0, 2, 3,
-            6, 5, 4,
-            6, 4, 7,
-            1, 0, 4,
-            1, 4, 5,
-            3, 2, 6,
-            3, 6, 7,
-            1, 5, 2,
-            2, 5, 6,
-            0, 3, 4,
-            3, 7, 4
-        };
-
 
-        RayTrace3D::TaskThread::TaskThread(RayTrace3D *trace)
+        RayTrace3D::TaskThread::TaskThread(RayTrace3D *trace, size_t index)
         {
             this->trace     = trace;
-            heavy_state     = rt::S_SCAN_OBJECTS;
+            this->index     = index;
+            scene           = &objects;
+            shared          = true;
+            stamp           = 0;
+            arena           = trace->vArenas.get(index);
         }
 
         RayTrace3D::TaskThread::~TaskThread()
@@ -66,20 +62,24 @@ namespace lsp
                     continue;
                 for (size_t j=0; j<b->bindings.size(); ++j)
                 {
-                    // Cleanup sample
-                    sample_t *samp  = b->bindings.uget(j);
-                    if (samp->sample != NULL)
+                    // Cleanup accumulator
+                    rt_accum_t *acc = b->bindings.uget(j);
+                    if (acc != NULL)
                     {
-                        samp->sample->destroy();
-                        delete samp->sample;
-                        samp->sample = NULL;
+                        destroy_accum(acc);
+                        delete acc;
                     }
                 }
+                b->bindings.flush();
                 delete b;
             }
 
             destroy_objects(&objects);
+            tags.flush();
             bindings.flush();
+            drop_tasks();
+            destroy_tasks(&deferred);
+            queue.destroy();
         }
 
         status_t RayTrace3D::TaskThread::run()
@@ -90,19 +90,74 @@ namespace lsp
 
             // Enter the main loop
             status_t res = main_loop();
-            destroy_tasks(&tasks);
-            destroy_objects(&objects);
+            drop_tasks();
 
             // Finalize DSP context and return result
             dsp::finish(&ctx);
             return res;
         }
 
+        void RayTrace3D::TaskThread::drop_tasks()
+        {
+            // Only the owner thread may pop tasks from the queue, other
+            // threads still may steal tasks, so the queue itself is kept alive
+            rt::context_t *ctx;
+            while ((ctx = queue.pop()) != NULL)
+                delete ctx;
+            destroy_tasks(&tasks);
+        }
+
+        rt::context_t *RayTrace3D::TaskThread::fetch_task(bool *report)
+        {
+            rt::context_t *ctx  = NULL;
+
+            uint64_t start      = PerfCounter::timestamp();
+            trace->lkTasks.lock();
+            stats.time_lock    += PerfCounter::timestamp() - start;
+            if (trace->vTasks.pop(&ctx))
+            {
+                // Update statistics
+                if (trace->nQueueSize > trace->vTasks.size())
+                {
+                    *report             = true;
+                    trace->nQueueSize   = trace->vTasks.size();
+                }
+                ++stats.root_tasks;
+            }
+            trace->lkTasks.unlock();
+
+            return ctx;
+        }
+
+        rt::context_t *RayTrace3D::TaskThread::steal_task()
+        {
+            size_t n            = trace->vThreads.size();
+
+            // Walk peers in round-robin order starting from the next thread
+            for (size_t i=1; i<n; ++i)
+            {
+                TaskThread *t       = trace->vThreads.uget((index + i) % n);
+                if ((t == NULL) || (t == this))
+                    continue;
+
+                ++stats.steal_attempts;
+                rt::context_t *ctx  = t->queue.steal();
+                if (ctx != NULL)
+                {
+                    ++stats.stolen_tasks;
+                    return ctx;
+                }
+            }
+
+            return NULL;
+        }
+
         status_t RayTrace3D::TaskThread::main_loop()
         {
             rt::context_t *ctx   = NULL;
             bool report         = false;
             status_t res        = STATUS_OK;
+            size_t spins        = 0;
 
             // Perform main loop of raytracing
             while (true)
@@ -114,31 +169,49 @@ namespace lsp
                     break;
                 }
 
-                // Try to fetch new task from internal queue
-                if (!tasks.pop(&ctx))
+                // Try to fetch new task from internal queue, then from global queue, then steal from peers
+                if ((ctx = queue.pop()) != NULL)
+                    ++stats.local_tasks;
+                else if (tasks.pop(&ctx))
+                    ++stats.local_tasks;
+                else if ((ctx = fetch_task(&report)) == NULL)
+                    ctx         = steal_task();
+
+                if (ctx == NULL)
                 {
-                    // Are there any tasks left in global space?
-                    trace->lkTasks.lock();
-                    if (!trace->vTasks.pop(&ctx))
-                    {
-                        trace->lkTasks.unlock();
-                        break;
-                    }
+                    // There is no job for this thread, mark the thread as idle
+                    atomic_add(&trace->nActive, -1);
+                    bool found      = false;
+                    uint64_t start  = PerfCounter::timestamp();
 
-                    // Update statistics
-                    if (trace->nQueueSize > trace->vTasks.size())
+                    while (!((trace->bCancelled) || (trace->bFailed)))
                     {
-                        report      = true;
-                        trace->nQueueSize  = trace->vTasks.size();
+                        // Nobody is processing tasks and all queues are empty?
+                        if (atomic_add(&trace->nActive, 0) <= 0)
+                            break;
+
+                        ++stats.idle_loops;
+                        if ((++spins) >= TASK_IDLE_SPINS)
+                        {
+                            ipc::Thread::sleep(1);
+                            spins       = 0;
+                        }
+
+                        // Try to steal task again, mark thread as active before doing it
+                        atomic_add(&trace->nActive, 1);
+                        if ((ctx = steal_task()) != NULL)
+                        {
+                            found       = true;
+                            break;
+                        }
+                        atomic_add(&trace->nActive, -1);
                     }
-                    ++stats.root_tasks;
-                    trace->lkTasks.unlock();
-                }
-                else
-                    ++stats.local_tasks;
 
-                if (ctx == NULL)
-                    break;
+                    stats.time_idle+= PerfCounter::timestamp() - start;
+                    if (!found)
+                        break;
+                }
+                spins       = 0;
 
                 // Process context state
                 res     = process_context(ctx);
@@ -148,7 +221,9 @@ namespace lsp
                 {
                     report      = false;
 
+                    uint64_t start  = PerfCounter::timestamp();
                     trace->lkTasks.lock();
+                    stats.time_lock+= PerfCounter::timestamp() - start;
                     float prg   = float(trace->nProgressPoints) / float(trace->nProgressMax);
                     lsp_trace("Reporting progress %d/%d = %.2f%%", int(trace->nProgressPoints), int(trace->nProgressMax), prg * 100.0f);
                     ++trace->nProgressPoints;
@@ -168,43 +243,48 @@ namespace lsp
 
         status_t RayTrace3D::TaskThread::submit_task(rt::context_t *ctx)
         {
-            // 'Heavy' state and pretty high number of pending tasks - submit task to global queue
-            if (ctx->state == heavy_state)
+            // Submit task to the work-stealing queue so other threads can pick it up
+            if ((shared) && (queue.push(ctx)))
             {
-                if (trace->vTasks.size() < TASK_LO_THRESH)
-                {
-                    trace->lkTasks.lock();
-                    status_t res = (trace->vTasks.push(ctx)) ? STATUS_OK : STATUS_NO_MEM;
-                    trace->lkTasks.unlock();
-                    return res;
-                }
+                stats.queue_peak    = lsp_max(stats.queue_peak, uint64_t(queue.size() + tasks.size()));
+                return STATUS_OK;
             }
 
-            // Otherwise, submit to local task queue
-            return (tasks.push(ctx)) ? STATUS_OK : STATUS_NO_MEM;
+            // Otherwise, submit to private task queue
+            if (shared)
+                ++stats.overflow_tasks;
+            if (!tasks.push(ctx))
+                return STATUS_NO_MEM;
+            stats.queue_peak    = lsp_max(stats.queue_peak, uint64_t(queue.size() + tasks.size()));
+            return STATUS_OK;
         }
 
         status_t RayTrace3D::TaskThread::process_context(rt::context_t *ctx)
         {
             status_t res;
+            uint64_t start  = PerfCounter::timestamp();
 
             switch (ctx->state)
             {
                 case rt::S_SCAN_OBJECTS:
                     ++stats.calls_scan;
                     res     = scan_objects(ctx);
+                    stats.time_scan    += PerfCounter::timestamp() - start;
                     break;
                 case rt::S_SPLIT:
                     ++stats.calls_split;
                     res     = split_view(ctx);
+                    stats.time_split   += PerfCounter::timestamp() - start;
                     break;
                 case rt::S_CULL_BACK:
                     ++stats.calls_cullback;
                     res     = cullback_view(ctx);
+                    stats.time_cullback+= PerfCounter::timestamp() - start;
                     break;
                 case rt::S_REFLECT:
                     ++stats.calls_reflect;
                     res     = reflect_view(ctx);
+                    stats.time_reflect += PerfCounter::timestamp() - start;
                     break;
                 default:
                     res = STATUS_BAD_STATE;
@@ -220,73 +300,48 @@ namespace lsp
 
         status_t RayTrace3D::TaskThread::generate_tasks(lltl::parray<rt::context_t> *tasks, float initial)
         {
-            status_t res;
-
-            for (size_t i=0,n=trace->vSources.size(); i<n; ++i)
+            // Use root tasks of the loaded shard or generate them from sources
+            lltl::darray<rt::view_t> views;
+            lltl::darray<rt::view_t> *list = &trace->vShardTasks;
+            if (!trace->bShardTasks)
             {
-                rt_source_settings_t *src = trace->vSources.get(i);
-                if (src == NULL)
-                    return STATUS_CORRUPTED;
-
-                // Generate source mesh
-                lltl::darray<rt::group_t> groups;
-                res = rt_gen_source_mesh(groups, src);
+                status_t res = trace->generate_root_views(&views);
                 if (res != STATUS_OK)
                     return res;
+                list        = &views;
+            }
 
-                // Generate sources
-                dsp::matrix3d_t tm = src->pos;
-
-                for (size_t ti=0, n=groups.size(); ti<n; ++ti)
-                {
-                    rt::group_t *grp = groups.uget(ti);
-                    if (grp == NULL)
-                        continue;
-
-                    rt::context_t *ctx   = new rt::context_t();
-                    if (ctx == NULL)
-                        return STATUS_NO_MEM;
-
-                    dsp::apply_matrix3d_mp2(&ctx->view.s, &grp->s, &tm);
-                    dsp::apply_matrix3d_mp2(&ctx->view.p[0], &grp->p[0], &tm);
-                    dsp::apply_matrix3d_mp2(&ctx->view.p[1], &grp->p[1], &tm);
-                    dsp::apply_matrix3d_mp2(&ctx->view.p[2], &grp->p[2], &tm);
+            for (size_t i=0, n=list->size(); i<n; ++i)
+            {
+                // Skip tasks of other shards
+                if ((i % trace->nShards) != trace->nShard)
+                    continue;
 
-                    ctx->state          = rt::S_SCAN_OBJECTS;
-                    ctx->view.location  = 1.0f;
-                    ctx->view.oid       = -1;
-                    ctx->view.face      = -1;
-                    ctx->view.speed     = LSP_DSP_UNITS_SOUND_SPEED_M_S;
+                rt::context_t *ctx   = new rt::context_t(arena);
+                if (ctx == NULL)
+                    return STATUS_NO_MEM;
 
-                    ctx->view.amplitude = src->amplitude;
-                    ctx->view.time[0]   = 0.0f;
-                    ctx->view.time[1]   = 0.0f;
-                    ctx->view.time[2]   = 0.0f;
+                ctx->view           = *(list->uget(i));
+                ctx->state          = rt::S_SCAN_OBJECTS;
 
-                    if (!tasks->add(ctx))
-                    {
-                        delete ctx;
-                        return STATUS_NO_MEM;
-                    }
+                if (!tasks->add(ctx))
+                {
+                    delete ctx;
+                    return STATUS_NO_MEM;
                 }
             }
 
             return STATUS_OK;
         }
 
-        status_t RayTrace3D::TaskThread::check_object(rt::context_t *ctx, Object3D *obj, const dsp::matrix3d_t *m)
+        status_t RayTrace3D::TaskThread::check_object(rt::context_t *ctx, Object3D *obj)
         {
             // Ensure that we need to perform additional checks
             if (obj->num_triangles() < 16)
                 return STATUS_OK;
 
-            // Prepare bounding-box check
-            dsp::bound_box3d_t box = *(obj->bound_box());
-            for (size_t j=0; j<8; ++j)
-                dsp::apply_matrix3d_mp1(&box.p[j], m);
-
-            // Perform simple bounding-box check
-            bool res    = check_bound_box(&box, &ctx->view);
+            // Perform simple bounding-box check with the cached world-space box
+            bool res    = check_bound_box(obj->world_bound_box(), &ctx->view);
 
             return (res) ? STATUS_OK : STATUS_SKIP;
         }
@@ -309,6 +364,10 @@ namespace lsp
                     return res;
             }
 
+            // Use the prepared scene if it is present
+            if (trace->bPrepared)
+                return use_prepared_scene(obj_id);
+
             // Add scene objects
             for (size_t i=0, oid=obj_id, n=trace->pScene->num_objects(); i<n; ++i, ++oid)
             {
@@ -325,7 +384,7 @@ namespace lsp
                     return STATUS_BAD_STATE;
 
                 // Add object to context
-                res         = root.add_object(obj, oid, obj->matrix(), m);
+                res         = add_scene_object(&root, obj, oid, i, m);
                 if (res != STATUS_OK)
                     return res;
             }
@@ -339,6 +398,33 @@ namespace lsp
                     int(root.vertex.size()), int(root.edge.size()), int(root.triangle.size()));
 
             // Generate object meshes
+            return generate_scene_objects(&root, obj_id);
+        }
+
+        status_t RayTrace3D::TaskThread::add_scene_object(rt::mesh_t *root, Object3D *obj, ssize_t oid, size_t idx, rt::material_t *m)
+        {
+            float error         = trace->get_lod_error(idx);
+            if (error <= 0.0f)
+                return root->add_object(obj, oid, obj->matrix(), m);
+
+            // Simplify the mesh of the object before adding
+            rt::lod_t lod;
+            status_t res        = lod.init(obj, obj->matrix());
+            if (res == STATUS_OK)
+                res                 = lod.simplify(error);
+            if (res != STATUS_OK)
+                return res;
+
+            lsp_trace("Simplified object %d: %d -> %d triangles",
+                    int(idx), int(obj->num_triangles()), int(lod.triangle.size()));
+
+            return root->add_object(&lod, oid, m);
+        }
+
+        status_t RayTrace3D::TaskThread::generate_scene_objects(rt::mesh_t *root, size_t obj_id)
+        {
+            status_t res;
+
             destroy_objects(&objects);
             for (size_t i=0, n=trace->pScene->num_objects(); i<n; ++i, ++obj_id)
             {
@@ -357,14 +443,168 @@ namespace lsp
                     delete rt;
                     return STATUS_NO_MEM;
                 }
+                rt->index       = i;
 
                 // Compute object's bounding box
                 obj->calc_bound_box();
-                if ((res = generate_object_mesh(obj_id, rt, &root, obj, obj->matrix())) != STATUS_OK)
+                if ((res = generate_object_mesh(obj_id, rt, root, obj)) != STATUS_OK)
                     return res;
             }
 
-            return res;
+            return STATUS_OK;
+        }
+
+        status_t RayTrace3D::TaskThread::generate_prepared_scene()
+        {
+            status_t res;
+            rt::mesh_t root;
+
+            // Add scene objects, the identifier of object is the index of the object in the scene
+            for (size_t i=0, n=trace->pScene->num_objects(); i<n; ++i)
+            {
+                Object3D *obj       = trace->pScene->object(i);
+                if (obj == NULL)
+                    return STATUS_BAD_STATE;
+                else if (!obj->is_visible()) // Skip invisible objects
+                    continue;
+
+                rt::material_t *m   = trace->vMaterials.get(i);
+                if (m == NULL)
+                    return STATUS_BAD_STATE;
+
+                res         = add_scene_object(&root, obj, i, i, m);
+                if (res != STATUS_OK)
+                    return res;
+            }
+
+            // Solve conflicts between all objects
+            res = root.solve_conflicts();
+            if (res != STATUS_OK)
+                return res;
+
+            lsp_trace("Prepared mesh statistics: %d vertexes, %d edges, %d triangles",
+                    int(root.vertex.size()), int(root.edge.size()), int(root.triangle.size()));
+
+            return generate_scene_objects(&root, 0);
+        }
+
+        status_t RayTrace3D::TaskThread::use_prepared_scene(size_t obj_id)
+        {
+            // Copy prepared objects
+            destroy_objects(&objects);
+            status_t res = copy_objects(&trace->vPrepared);
+            if (res != STATUS_OK)
+                return res;
+
+            // Shift object identifiers by the number of captures and bind materials
+            for (size_t i=0, n=objects.size(); i<n; ++i)
+            {
+                rt_object_t *o      = objects.uget(i);
+                rt::material_t *m   = trace->vMaterials.get(o->index);
+                if (m == NULL)
+                    return STATUS_BAD_STATE;
+
+                rtx::triangle_t *t  = o->mesh.array();
+                for (size_t j=0, nt=o->mesh.size(); j<nt; ++j, ++t)
+                {
+                    t->oid         += obj_id;
+                    t->m            = m;
+                }
+            }
+
+            return STATUS_OK;
+        }
+
+        /**
+         * Prepared scene binary file format, all fields are stored in the native byte order
+         */
+        #pragma pack(push, 1)
+        typedef struct rt_scene_header_t
+        {
+            char        signature[8];   // Signature
+            uint32_t    version;        // Format version
+            uint32_t    byte_order;     // Byte order marker
+            uint32_t    objects;        // Number of prepared objects
+            uint32_t    scene_objects;  // Number of objects in the scene
+        } rt_scene_header_t;
+
+        typedef struct rt_scene_object_t
+        {
+            uint32_t    index;          // Index of the object in the scene
+            uint32_t    triangles;      // Number of triangles
+            uint32_t    edges;          // Number of edges
+            float       bbox[8][3];     // Bounding box
+        } rt_scene_object_t;
+
+        typedef struct rt_scene_edge_t
+        {
+            float       v[2][3];        // Edge points
+        } rt_scene_edge_t;
+
+        typedef struct rt_scene_triangle_t
+        {
+            float       v[3][3];        // Triangle points
+            float       n[4];           // Normal
+            uint32_t    face;           // Face identifier
+            uint32_t    e[3];           // Edge indexes
+        } rt_scene_triangle_t;
+
+        typedef struct rt_shard_header_t
+        {
+            char        signature[8];   // Signature
+            uint32_t    version;        // Format version
+            uint32_t    byte_order;     // Byte order marker
+            uint32_t    tasks;          // Number of root tasks
+            uint32_t    shard;          // Index of the shard
+            uint32_t    shards;         // Overall number of shards
+        } rt_shard_header_t;
+
+        typedef struct rt_shard_task_t
+        {
+            float       s[3];           // Source point
+            float       p[3][3];        // View points
+            float       time[3];        // Start time for each source point
+            float       amplitude;      // Amplitude of the signal
+            float       speed;          // Sound speed
+            float       location;       // Co-location to the next surface
+            int32_t     oid;            // Last interacted object identifier
+            int32_t     face;           // Last interacted object's face identifier
+            int32_t     rnum;           // Reflection number
+        } rt_shard_task_t;
+        #pragma pack(pop)
+
+        static const char       RT_SCENE_SIGNATURE[8]  = { 'L', 'S', 'P', 'R', 'T', 'S', 'C', '\0' };
+        static const uint32_t   RT_SCENE_VERSION       = 1;
+        static const uint32_t   RT_SCENE_BYTE_ORDER    = 0x01020304;
+        static const char       RT_SHARD_SIGNATURE[8]  = { 'L', 'S', 'P', 'R', 'T', 'S', 'H', '\0' };
+        static const uint32_t   RT_SHARD_VERSION       = 1;
+
+        static inline void rt_store_point(float *dst, const dsp::point3d_t *p)
+        {
+            dst[0]  = p->x;
+            dst[1]  = p->y;
+            dst[2]  = p->z;
+        }
+
+        static inline void rt_load_point(dsp::point3d_t *p, const float *src)
+        {
+            dsp::init_point_xyz(p, src[0], src[1], src[2]);
+        }
+
+        static status_t rt_write(io::IOutStream *os, const void *buf, size_t count)
+        {
+            ssize_t n = os->write(buf, count);
+            if (n < 0)
+                return status_t(-n);
+            return (size_t(n) == count) ? STATUS_OK : STATUS_IO_ERROR;
+        }
+
+        static status_t rt_read(io::IInStream *is, void *buf, size_t count)
+        {
+            ssize_t n = is->read_fully(buf, count);
+            if (n < 0)
+                return status_t(-n);
+            return (size_t(n) == count) ? STATUS_OK : STATUS_CORRUPTED;
         }
 
         status_t RayTrace3D::TaskThread::generate_capture_mesh(size_t id, capture_t *c)
@@ -415,7 +655,7 @@ namespace lsp
             return res;
         }
 
-        status_t RayTrace3D::TaskThread::generate_object_mesh(ssize_t id, rt_object_t *o, rt::mesh_t *src, Object3D *obj, const dsp::matrix3d_t *m)
+        status_t RayTrace3D::TaskThread::generate_object_mesh(ssize_t id, rt_object_t *o, rt::mesh_t *src, Object3D *obj)
         {
             rtx::edge_t *e;
 
@@ -457,6 +697,7 @@ namespace lsp
                             return STATUS_NO_MEM;
                         e->v[0]         = *(se->v[0]);
                         e->v[1]         = *(se->v[1]);
+                        e->itag         = 0;
                         se->itag        = itag++;
                     }
                 }
@@ -473,10 +714,18 @@ namespace lsp
                 }
             }
 
-            // Apply changes to bound box
-            const obj_boundbox_t *bbox = obj->bound_box();
+            // Build bounding volume hierarchy for large objects
+            if (o->mesh.size() > RT_BVH_LEAF_SIZE)
+            {
+                status_t res = o->bvh.build(o->mesh.array(), o->mesh.size());
+                if (res != STATUS_OK)
+                    return res;
+            }
+
+            // Use the cached world-space bound box
+            const obj_boundbox_t *bbox = obj->world_bound_box();
             for (size_t i=0; i<8; ++i)
-                dsp::apply_matrix3d_mp2(&o->bbox.p[i], &bbox->p[i], m);
+                o->bbox.p[i]    = bbox->p[i];
 
             return STATUS_OK;
         }
@@ -496,44 +745,27 @@ namespace lsp
                 objs[i]             = 0;
 
             size_t n_objs       = 0;
-            size_t obj_id       = 0;
 
             // Add captures as opaque objects
-            obj_id = 0;
-            for (size_t i=0, n=trace->vCaptures.size(); i<n; ++i, ++obj_id)
-            {
-                capture_t *cap      = trace->vCaptures.uget(i);
-                if (cap == NULL)
-                    return STATUS_BAD_STATE;
-
-                if (!check_bound_box(&cap->bbox, &ctx->view))
-                    continue;
-
-                // Add capture as opaque object
-                if ((res = ctx->add_opaque_object(cap->mesh.array(), cap->mesh.size())) != STATUS_OK)
-                    return res;
-            }
+            if ((res = scan_captures(ctx)) != STATUS_OK)
+                return res;
 
             // Iterate all object and add to the context if the object is potentially participating the ray tracing algorithm
-            for (size_t i=0, n=objects.size(); i<n; ++i)
+            for (size_t i=0, n=scene->size(); i<n; ++i)
             {
-                rt_object_t *rt = objects.uget(i);
+                const rt_object_t *rt = scene->uget(i);
                 if (rt == NULL)
                     return STATUS_BAD_STATE;
 
-                // Check bound box
-                bool check = rt->mesh.size() > 16;
-                if (check)
+                // Large objects have the hierarchy, use it to add only potentially visible triangles
+                if (!rt->bvh.is_empty())
                 {
-
-                    // Perform simple bounding-box check
-                    check = !check_bound_box(&rt->bbox, &ctx->view);
+                    if (!check_bound_box(&rt->bbox, &ctx->view))
+                        continue;
+                    res = ctx->add_object(rt->mesh.array(), &rt->bvh, tags.array(), ++stamp);
                 }
-                if (check)
-                    continue;
-
-                // Add object to context
-                res = ctx->add_object(rt->mesh.array(), rt->plan.array(), rt->mesh.size(), rt->plan.size());
+                else
+                    res = ctx->add_object(rt->mesh.array(), rt->mesh.size(), tags.array(), ++stamp);
                 if (res != STATUS_OK)
                     return res;
                 ++n_objs;
@@ -553,6 +785,50 @@ namespace lsp
             return submit_task(ctx);
         }
 
+        status_t RayTrace3D::TaskThread::scan_captures(rt::context_t *ctx)
+        {
+            status_t res;
+            lltl::darray<rt::bvh_node_t> &tree = trace->vCaptureTree;
+            if (tree.size() <= 0)
+                return STATUS_OK;
+
+            // Walk the hierarchy, skip the branches that are not visible from the view
+            size_t stack[RT_BVH_MAX_DEPTH + 2];
+            size_t top          = 0;
+            stack[top++]        = 0;
+
+            while (top > 0)
+            {
+                const rt::bvh_node_t *node  = tree.uget(stack[--top]);
+                if (!check_bound_box(&node->bbox, &ctx->view))
+                    continue;
+
+                if (node->left > 0)
+                {
+                    stack[top++]        = node->right;
+                    stack[top++]        = node->left;
+                    continue;
+                }
+
+                for (size_t i=node->first, n=node->first + node->count; i<n; ++i)
+                {
+                    capture_t *cap      = trace->vCaptures.get(*(trace->vCaptureIndex.uget(i)));
+                    if (cap == NULL)
+                        return STATUS_BAD_STATE;
+
+                    // Single capture in the leaf has the same bounding box as the node
+                    if ((node->count > 1) && (!check_bound_box(&cap->bbox, &ctx->view)))
+                        continue;
+
+                    // Add capture as opaque object
+                    if ((res = ctx->add_opaque_object(cap->mesh.array(), cap->mesh.size())) != STATUS_OK)
+                        return res;
+                }
+            }
+
+            return STATUS_OK;
+        }
+
         status_t RayTrace3D::TaskThread::cull_view(rt::context_t *ctx)
         {
             status_t res = ctx->cull_view();
@@ -574,7 +850,7 @@ namespace lsp
 
         status_t RayTrace3D::TaskThread::split_view(rt::context_t *ctx)
         {
-            rt::context_t out;
+            rt::context_t out(arena);
 
             // Perform binary split
             status_t res = ctx->edge_split(&out);
@@ -593,7 +869,7 @@ namespace lsp
                 if (out.triangle.size() > 0)
                 {
                     // Allocate additional context and add to task list
-                    rt::context_t *nctx = new rt::context_t(&ctx->view, (out.triangle.size() > 1) ? rt::S_SPLIT : rt::S_REFLECT);
+                    rt::context_t *nctx = new rt::context_t(&ctx->view, (out.triangle.size() > 1) ? rt::S_SPLIT : rt::S_REFLECT, arena);
                     if (nctx == NULL)
                         return STATUS_NO_MEM;
 
@@ -649,6 +925,9 @@ namespace lsp
             dsp::point3d_t p[3];            // Projection points
             float d[3], t[3];               // distance, time
             float a[3], A, kd;              // particular area, area, dispersion coefficient
+            const float thresh  = lsp_max(trace->fEnergyThresh, trace->fPruneThresh); // Energy threshold with pruning
+            const size_t nb     = trace->nBands;
+            float ra, ta;                   // Levels of reflected and refracted views
 
             sv      = ctx->view;
             A       = dsp::calc_area_pv(sv.p);
@@ -724,7 +1003,10 @@ namespace lsp
                 v.oid       = ct->oid;
                 v.face      = ct->face;
                 v.s         = sv.s;
-                v.amplitude = sv.amplitude * sqrtf(area * revA);
+                float ka    = sqrtf(area * revA);
+                v.amplitude = sv.amplitude * ka;
+                if (nb > 0)
+                    dsp::mul_k3(v.bands, sv.bands, ka, nb);
                 v.location  = sv.location;
                 v.speed     = sv.speed;
                 v.rnum      = sv.rnum;
@@ -741,7 +1023,9 @@ namespace lsp
                     {
                         // Perform synchronized capturing
                         ++stats.calls_capture;
-                        res = capture(cap, &b->bindings, &v);
+                        uint64_t start      = PerfCounter::timestamp();
+                        res = capture(cap, b, &v);
+                        stats.time_capture += PerfCounter::timestamp() - start;
                     }
                     else
                         res = STATUS_CORRUPTED;
@@ -750,6 +1034,7 @@ namespace lsp
                 {
                     // Get material
                     rt::material_t *m    = ct->m;
+                    size_t side;
 
                     // Compute reflected and refracted views
                     rv          = v;
@@ -773,6 +1058,7 @@ namespace lsp
                         tv.s.y         += kd * ct->n.dy;
                         tv.s.z         += kd * ct->n.dz;
                         tv.location     = - v.location;     // Invert location of transparent trace
+                        side            = 0;
                     }
                     else
                     {
@@ -792,28 +1078,48 @@ namespace lsp
                         tv.s.y         += kd * ct->n.dy;
                         tv.s.z         += kd * ct->n.dz;
                         tv.location     = - v.location;     // Invert location of transparent trace
+                        side            = 1;
+                    }
+
+                    // Apply band materials, the view is alive while at least one band is audible
+                    ra              = fabsf(rv.amplitude);
+                    ta              = fabsf(tv.amplitude);
+                    if (nb > 0)
+                    {
+                        const rt_bands_t *bm = trace->vBands.uget(ct->m - trace->vMaterials.array());
+                        dsp::mul3(rv.bands, v.bands, bm->reflect[side], nb);
+                        dsp::mul3(tv.bands, v.bands, bm->refract[side], nb);
+                        ra              = lsp_max(ra, dsp::abs_max(rv.bands, nb));
+                        ta              = lsp_max(ta, dsp::abs_max(tv.bands, nb));
                     }
 
                     // Create reflection context
-                    if ((rv.amplitude <= -trace->fEnergyThresh) || (rv.amplitude >= trace->fEnergyThresh))
+                    if (ra >= thresh)
                     {
                         // Revert the order of triangle because direction has changed to opposite
                         rv.p[1]     = v.p[2];
                         rv.p[2]     = v.p[1];
 
-                        if ((rc = new rt::context_t(&rv, rt::S_SCAN_OBJECTS)) != NULL)
+                        if ((rc = new rt::context_t(&rv, rt::S_SCAN_OBJECTS, arena)) != NULL)
                         {
-                            if ((res = submit_task(rc)) != STATUS_OK)
+                            // Defer the context to the next pass in progressive mode
+                            if ((trace->nPassLimit >= 0) && (rv.rnum > trace->nPassLimit))
+                                res = (deferred.push(rc)) ? STATUS_OK : STATUS_NO_MEM;
+                            else
+                                res = submit_task(rc);
+                            if (res != STATUS_OK)
                                 delete rc;
                         }
                         else
                             res = STATUS_NO_MEM;
                     }
+                    else if (ra >= trace->fEnergyThresh)
+                        ++stats.pruned_tasks;
 
                     // Create refraction context
-                    if ((tv.amplitude <= -trace->fEnergyThresh) || (tv.amplitude >= trace->fEnergyThresh))
+                    if (ta >= thresh)
                     {
-                        if ((rc = new rt::context_t(&tv, rt::S_SCAN_OBJECTS)) != NULL)
+                        if ((rc = new rt::context_t(&tv, rt::S_SCAN_OBJECTS, arena)) != NULL)
                         {
                             if ((res = submit_task(rc)) != STATUS_OK)
                                 delete rc;
@@ -821,6 +1127,8 @@ namespace lsp
                         else
                             res = STATUS_NO_MEM;
                     }
+                    else if (ta >= trace->fEnergyThresh)
+                        ++stats.pruned_tasks;
                 }
 
                 // Analyze result
@@ -834,7 +1142,7 @@ namespace lsp
             return res;
         }
 
-        status_t RayTrace3D::TaskThread::capture(capture_t *capture, lltl::darray<sample_t> *bindings, const rt::view_t *v)
+        status_t RayTrace3D::TaskThread::capture(capture_t *capture, rt_binding_t *binding, const rt::view_t *v)
         {
             // Compute the area of triangle
             float v_area = dsp::calc_area_pv(v->p);
@@ -842,7 +1150,7 @@ namespace lsp
                 return STATUS_OK;
 
             dsp::vector3d_t cv, pv;
-            float afactor       = v->amplitude / sqrtf(v_area); // The norming energy factor
+            float kfactor       = 1.0f / sqrtf(v_area);         // The norming energy factor
             dsp::unit_vector_p1pv(&cv, &v->s, v->p);
             pv                  = capture->direction;
             float kcos          = cv.dx*pv.dx + cv.dy*pv.dy + cv.dz * pv.dz; // cos(a)
@@ -851,23 +1159,23 @@ namespace lsp
             switch (capture->type)
             {
                 case RT_AC_CARDIO:
-                    afactor    *= 0.5f * (1.0f - kcos); // 0.5 * (1 + cos(a))
+                    kfactor    *= 0.5f * (1.0f - kcos); // 0.5 * (1 + cos(a))
                     break;
 
                 case RT_AC_SCARDIO:
-                    afactor    *= 2*fabs(0.5 - kcos)/3.0f; // 2*(0.5 + cos(a)) / 3
+                    kfactor    *= 2*fabs(0.5 - kcos)/3.0f; // 2*(0.5 + cos(a)) / 3
                     break;
 
                 case RT_AC_HCARDIO:
-                    afactor    *= 0.8*fabs(0.25 - kcos); // 4*(0.25 + cos(a)) / 5
+                    kfactor    *= 0.8*fabs(0.25 - kcos); // 4*(0.25 + cos(a)) / 5
                     break;
 
                 case RT_AC_BIDIR:
-                    afactor    *= kcos;    // factor = factor * cos(a)
+                    kfactor    *= kcos;    // factor = factor * cos(a)
                     break;
 
                 case RT_AC_EIGHT:
-                    afactor    *= kcos*kcos;  // factor = factor * cos(a)^2
+                    kfactor    *= kcos*kcos;  // factor = factor * cos(a)^2
                     break;
 
                 case RT_AC_OMNI: // factor = factor * 1
@@ -875,6 +1183,8 @@ namespace lsp
                     break;
             }
 
+            const float afactor = v->amplitude * kfactor;
+
             // Estimate distance and time parameters for source point
             dsp::vector3d_t ds[3];
             dsp::raw_triangle_t src;
@@ -930,56 +1240,36 @@ namespace lsp
                 if (in_area > prev_area)
                 {
                     // Compute the amplitude
-                    float amplitude = sqrtf(in_area - prev_area) * afactor;
+                    float karea     = sqrtf(in_area - prev_area);
+                    float amplitude = karea * afactor;
                     prev_area       = in_area;
 
                     // Deploy energy value to the sample
                     if (csn > 0)
                     {
                         // Append sample to each matching capture
-                        for (size_t ci=0, cn=bindings->size(); ci<cn; ++ci)
+                        for (size_t ci=0, cn=binding->bindings.size(); ci<cn; ++ci)
                         {
-                            sample_t *s = bindings->uget(ci);
+                            rt_accum_t *s = binding->bindings.uget(ci);
 
-                            // Skip reflection not in range
+                            // Skip reflection not in range and bands that are not traced
                             if ((s->r_min >= 0) && (v->rnum < s->r_min))
                                 continue;
                             else if ((s->r_max >= 0) && (v->rnum > s->r_max))
                                 continue;
+                            else if (s->band >= ssize_t(trace->nBands))
+                                continue;
 
-                            // Ensure that we need to resize sample
-                            size_t len = s->sample->length();
-                            if (len <= size_t(csn))
-                            {
-                                // Need to resize sample?
-                                if (s->sample->max_length() <= size_t(csn))
-                                {
-                                    len     = (csn + 1 + SAMPLE_QUANTITY) / SAMPLE_QUANTITY;
-                                    len    *= SAMPLE_QUANTITY;
-
-                                    lsp_trace("v->time = {%e, %e, %e}", v->time[0], v->time[1], v->time[2]);
-                                    lsp_trace("ctime = %e, tsn = {%e, %e, %e}", ctime, tsn[0], tsn[1], tsn[2]);
-                                    lsp_trace("spl = {%e, %e, %e, %e}",
-                                        spl.dx, spl.dy, spl.dz, spl.dw);
-                                    lsp_trace("Requesting sample resize: csn=0x%llx, len=0x%llx, channels=%d",
-                                        (long long)csn, (long long)len, int(s->sample->channels())
-                                        );
-
-                                    if (!s->sample->resize(s->sample->channels(), len, len))
-                                        return STATUS_NO_MEM;
-                                }
-
-                                // Update sample length
-                                s->sample->set_length(csn + 1);
-                            }
+                            // Obtain the chunk, chunks are never reallocated
+                            float *buf  = accum_chunk(s, csn-1);
+                            if (buf == NULL)
+                                return STATUS_NO_MEM;
 
                             // Deploy sample to curent channel
-                            float *buf  = s->sample->getBuffer(s->channel);
-                            buf[csn-1] += amplitude;
+                            *buf       += (s->band >= 0) ? karea * kfactor * v->bands[s->band] : amplitude;
+                            if (s->length <= size_t(csn))
+                                s->length   = csn + 1;
                         }
-
-                        // Unlock capture data
-    //                    trace->lkCapture.unlock();
                     }
                 }
 
@@ -997,8 +1287,13 @@ namespace lsp
             // Cleanup stats
             clear_stats(&stats);
 
+            // Initialize work-stealing queue
+            status_t res    = queue.init(TASK_HI_THRESH);
+            if (res != STATUS_OK)
+                return res;
+
             // Report progress as 0%
-            status_t res    = trace->report_progress(0.0f);
+            res             = trace->report_progress(0.0f);
             if (res != STATUS_OK)
                 return res;
             else if (trace->bCancelled)
@@ -1006,6 +1301,10 @@ namespace lsp
 
             // Prepare root context and captures
             res         = generate_root_mesh();
+            if (res == STATUS_OK)
+                res         = index_edges();
+            if (res == STATUS_OK)
+                res         = trace->build_capture_tree();
             if (res == STATUS_OK)
                 res         = prepare_captures();
 
@@ -1030,7 +1329,7 @@ namespace lsp
             }
 
             // Estimate the progress by doing set of steps
-            heavy_state = -1; // This guarantees that all tasks will be submitted to local task queue
+            shared      = false; // This guarantees that all tasks will be submitted to local task queue
             do
             {
                 while (estimate.size() > 0)
@@ -1066,7 +1365,7 @@ namespace lsp
                 estimate.swap(&tasks);
             } while ((estimate.size() > 0) && (estimate.size() < TASK_LO_THRESH));
 
-            heavy_state         = rt::S_SCAN_OBJECTS; // Enable global task queue for this thread
+            shared              = true; // Enable work-stealing queue for this thread
             trace->vTasks.swap(&estimate); // Now all generated tasks are global
 
             // Values to report progress
@@ -1106,32 +1405,24 @@ namespace lsp
                     return STATUS_NO_MEM;
                 }
 
-                // Copy bindings
+                // Create accumulators for bindings
                 for (size_t j=0; j<scap->bindings.size(); ++j)
                 {
-                    // Allocate binding
                     sample_t *ssamp = scap->bindings.get(j);
-                    sample_t *dsamp = b->bindings.add();
-                    if (dsamp == NULL)
+                    rt_accum_t *acc = new rt_accum_t();
+                    if (acc == NULL)
                         return STATUS_NO_MEM;
-
-                    dsamp->sample   = NULL;
-                    dsamp->channel  = ssamp->channel;
-                    dsamp->r_min    = ssamp->r_min;
-                    dsamp->r_max    = ssamp->r_max;
-
-                    // Allocate sample and link
-                    Sample *xsamp   = ssamp->sample;
-                    Sample *tsamp   = new Sample();
-                    if (tsamp == NULL)
-                        return STATUS_NO_MEM;
-                    else if (!tsamp->init(xsamp->channels(), xsamp->max_length(), xsamp->length()))
+                    else if (!b->bindings.add(acc))
                     {
-                        tsamp->destroy();
-                        delete tsamp;
+                        delete acc;
                         return STATUS_NO_MEM;
                     }
-                    dsamp->sample   = tsamp;
+
+                    acc->channel    = ssamp->channel;
+                    acc->band       = ssamp->band;
+                    acc->r_min      = ssamp->r_min;
+                    acc->r_max      = ssamp->r_max;
+                    acc->length     = 0;
                 }
             }
 
@@ -1143,12 +1434,50 @@ namespace lsp
             // Cleanup statistics
             clear_stats(&stats);
 
-            // Prepare captures and data context
-            status_t res = prepare_captures();
+            // Prepare work-stealing queue, captures and data context
+            status_t res = queue.init(TASK_HI_THRESH);
             if (res == STATUS_OK)
-                res = copy_objects(&t->objects);
+                res = prepare_captures();
+            if (res != STATUS_OK)
+                return res;
 
-            return res;
+            // Share read-only objects of the root thread, allocate private edge stamps only
+            scene           = t->scene;
+            stamp           = 0;
+            tags.clear();
+            ssize_t *v      = tags.append_n(t->tags.size());
+            if ((v == NULL) && (t->tags.size() > 0))
+                return STATUS_NO_MEM;
+            for (size_t i=0, n=tags.size(); i<n; ++i)
+                v[i]            = 0;
+
+            return STATUS_OK;
+        }
+
+        status_t RayTrace3D::TaskThread::index_edges()
+        {
+            // Assign the global index to each edge of the scene, it is used to
+            // address per-thread edge stamps so the objects are never modified
+            // while scanning
+            ssize_t itag    = 0;
+            for (size_t i=0, n=objects.size(); i<n; ++i)
+            {
+                rt_object_t *o  = objects.uget(i);
+                rtx::edge_t *e  = o->plan.array();
+                for (size_t j=0, m=o->plan.size(); j<m; ++j, ++itag)
+                    e[j].itag       = itag;
+            }
+
+            // Allocate stamps
+            stamp           = 0;
+            tags.clear();
+            ssize_t *v      = tags.append_n(itag);
+            if ((v == NULL) && (itag > 0))
+                return STATUS_NO_MEM;
+            for (ssize_t i=0; i<itag; ++i)
+                v[i]            = 0;
+
+            return STATUS_OK;
         }
 
         status_t RayTrace3D::TaskThread::copy_objects(lltl::parray<rt_object_t> *src)
@@ -1190,78 +1519,92 @@ namespace lsp
                     dt->e[2] = &de[dt->e[2] - se];
                 }
 
-                // Copy bound box
+                // Copy bound box and index
                 d->bbox     = s->bbox;
+                d->index    = s->index;
+
+                // Copy hierarchy
+                status_t res = d->bvh.copy(&s->bvh);
+                if (res != STATUS_OK)
+                    return res;
             }
 
             return STATUS_OK;
         }
 
-        status_t RayTrace3D::TaskThread::merge_result()
+        status_t RayTrace3D::TaskThread::merge_result(Sample *dst)
         {
-            lltl::parray<capture_t> &dst = trace->vCaptures;
-            if (dst.size() != bindings.size())
+            lltl::parray<capture_t> &caps = trace->vCaptures;
+            if (caps.size() != bindings.size())
                 return STATUS_CORRUPTED;
 
-            for (size_t i=0; i<dst.size(); ++i)
+            for (size_t i=0; i<caps.size(); ++i)
             {
                 rt_binding_t   *csrc    = bindings.uget(i);
-                capture_t      *cdst    = dst.uget(i);
+                capture_t      *cdst    = caps.uget(i);
 
                 if (csrc->bindings.size() != cdst->bindings.size())
                     return STATUS_CORRUPTED;
 
                 for (size_t j=0; j<csrc->bindings.size(); ++j)
                 {
-                    sample_t *ssrc  = csrc->bindings.uget(j);
                     sample_t *sdst  = cdst->bindings.uget(j);
+                    if (sdst->sample != dst)
+                        continue;
 
-                    if ((ssrc->sample == NULL) || (sdst->sample == NULL))
+                    rt_accum_t *acc = csrc->bindings.uget(j);
+                    if ((acc->length > dst->length()) || (acc->channel >= dst->channels()))
                         return STATUS_CORRUPTED;
 
-                    // Compute new sample size
-                    size_t nc = ssrc->sample->channels();
-                    if (nc != sdst->sample->channels())
-                        return STATUS_CORRUPTED;
-
-                    bool resize = false;
-                    size_t maxlen = sdst->sample->max_length();
-                    if (maxlen < ssrc->sample->max_length())
+                    // Apply changes to the target sample, skip chunks that were not allocated
+                    float *buf      = dst->getBuffer(acc->channel);
+                    for (size_t k=0, n=acc->chunks.size(); k<n; ++k)
                     {
-                        maxlen  = ssrc->sample->max_length();
-                        resize  = true;
+                        float *chunk    = *(acc->chunks.uget(k));
+                        if (chunk == NULL)
+                            continue;
+
+                        size_t off      = k * CAPTURE_CHUNK_SIZE;
+                        if (off >= acc->length)
+                            break;
+                        size_t count    = lsp_min(acc->length - off, size_t(CAPTURE_CHUNK_SIZE));
+                        dsp::add2(&buf[off], chunk, count);
                     }
+                }
+            }
 
-                    size_t len = sdst->sample->length();
-                    if (len < ssrc->sample->length())
-                    {
-                        len     = ssrc->sample->length();
-                        resize  = true;
-                    }
+            return STATUS_OK;
+        }
 
-                    if (maxlen < len)
-                        maxlen  = len;
+        void RayTrace3D::TaskThread::clear_captures()
+        {
+            for (size_t i=0, n=bindings.size(); i<n; ++i)
+            {
+                rt_binding_t *b = bindings.uget(i);
+                for (size_t j=0, m=b->bindings.size(); j<m; ++j)
+                    destroy_accum(b->bindings.uget(j));
+            }
+        }
 
-                    // Check that we need resize
-                    if (resize)
-                    {
-                        if (!sdst->sample->resize(nc, maxlen, len))
-                            return STATUS_NO_MEM;
-                    }
+        RayTrace3D::MergeThread::MergeThread(RayTrace3D *trace)
+        {
+            this->trace     = trace;
+        }
 
-                    // Apply changes to the target sample
-                    for (size_t k=0; k<nc; ++k)
-                    {
-                        dsp::add2(
-                                sdst->sample->getBuffer(k),
-                                ssrc->sample->getBuffer(k),
-                                ssrc->sample->length()
-                            );
-                    }
-                }
-            }
+        RayTrace3D::MergeThread::~MergeThread()
+        {
+            trace           = NULL;
+        }
 
-            return STATUS_OK;
+        status_t RayTrace3D::MergeThread::run()
+        {
+            dsp::context_t ctx;
+            dsp::start(&ctx);
+
+            status_t res = trace->merge_jobs();
+
+            dsp::finish(&ctx);
+            return res;
         }
 
         RayTrace3D::RayTrace3D()
@@ -1269,15 +1612,32 @@ namespace lsp
             pScene          = NULL;
             pProgress       = NULL;
             pProgressData   = NULL;
+            pCheckpoint     = NULL;
+            pCheckpointData = NULL;
             nSampleRate     = LSP_DSP_UNITS_DEFAULT_SAMPLE_RATE;
             fEnergyThresh   = 1e-6f;
             fTolerance      = 1e-5f;
             fDetalization   = 1e-10f;
+            fPruneThresh    = 0.0f;
+            nBands          = 0;
             bNormalize      = true;
             bCancelled      = false;
+            bFailed         = false;
+            bPrepared       = false;
+            nPreparedObjects= 0;
+            nShard          = 0;
+            nShards         = 1;
+            bShardTasks     = false;
+            nActive         = 0;
+            nMergeJob       = 0;
+            nPassLimit      = -1;
+            nPass           = 0;
+            nPasses         = 1;
             nQueueSize      = 0;
             nProgressPoints = 0;
             nProgressMax    = 0;
+
+            clear_stats(&sStats);
         }
 
         RayTrace3D::~RayTrace3D()
@@ -1295,6 +1655,20 @@ namespace lsp
             stats->calls_cullback   = 0;
             stats->calls_reflect    = 0;
             stats->calls_capture    = 0;
+            stats->stolen_tasks     = 0;
+            stats->steal_attempts   = 0;
+            stats->overflow_tasks   = 0;
+            stats->idle_loops       = 0;
+            stats->pruned_tasks     = 0;
+            stats->time_scan        = 0;
+            stats->time_split       = 0;
+            stats->time_cullback    = 0;
+            stats->time_reflect     = 0;
+            stats->time_capture     = 0;
+            stats->time_idle        = 0;
+            stats->time_lock        = 0;
+            stats->queue_peak       = 0;
+            stats->memory_peak      = 0;
         }
 
         void RayTrace3D::dump_stats(const char *label, const stats_t *stats)
@@ -1307,7 +1681,21 @@ namespace lsp
                     "  split_view               : %lld\n"
                     "  cullback_view            : %lld\n"
                     "  reflect_view             : %lld\n"
-                    "  capture                  : %lld\n",
+                    "  capture                  : %lld\n"
+                    "  stolen tasks             : %lld\n"
+                    "  steal attempts           : %lld\n"
+                    "  overflow tasks           : %lld\n"
+                    "  idle loops               : %lld\n"
+                    "  pruned tasks             : %lld\n"
+                    "  scan time                : %.3f ms\n"
+                    "  split time               : %.3f ms\n"
+                    "  cullback time            : %.3f ms\n"
+                    "  reflect time             : %.3f ms\n"
+                    "  capture time             : %.3f ms\n"
+                    "  idle time                : %.3f ms\n"
+                    "  lock wait time           : %.3f ms\n"
+                    "  queue peak               : %lld\n"
+                    "  memory peak              : %lld\n",
                 label,
                 (long long)stats->root_tasks,
                 (long long)stats->local_tasks,
@@ -1316,7 +1704,21 @@ namespace lsp
                 (long long)stats->calls_split,
                 (long long)stats->calls_cullback,
                 (long long)stats->calls_reflect,
-                (long long)stats->calls_capture
+                (long long)stats->calls_capture,
+                (long long)stats->stolen_tasks,
+                (long long)stats->steal_attempts,
+                (long long)stats->overflow_tasks,
+                (long long)stats->idle_loops,
+                (long long)stats->pruned_tasks,
+                stats->time_scan * 1e-6,
+                stats->time_split * 1e-6,
+                stats->time_cullback * 1e-6,
+                stats->time_reflect * 1e-6,
+                stats->time_capture * 1e-6,
+                stats->time_idle * 1e-6,
+                stats->time_lock * 1e-6,
+                (long long)stats->queue_peak,
+                (long long)stats->memory_peak
             );
         }
 
@@ -1330,6 +1732,188 @@ namespace lsp
             dst->calls_cullback    += src->calls_cullback;
             dst->calls_reflect     += src->calls_reflect;
             dst->calls_capture     += src->calls_capture;
+            dst->stolen_tasks      += src->stolen_tasks;
+            dst->steal_attempts    += src->steal_attempts;
+            dst->overflow_tasks    += src->overflow_tasks;
+            dst->idle_loops        += src->idle_loops;
+            dst->pruned_tasks      += src->pruned_tasks;
+            dst->time_scan         += src->time_scan;
+            dst->time_split        += src->time_split;
+            dst->time_cullback     += src->time_cullback;
+            dst->time_reflect      += src->time_reflect;
+            dst->time_capture      += src->time_capture;
+            dst->time_idle         += src->time_idle;
+            dst->time_lock         += src->time_lock;
+            dst->queue_peak         = lsp_max(dst->queue_peak, src->queue_peak);
+            dst->memory_peak        = lsp_max(dst->memory_peak, src->memory_peak);
+        }
+
+        void RayTrace3D::destroy_accum(rt_accum_t *accum)
+        {
+            for (size_t i=0, n=accum->chunks.size(); i<n; ++i)
+            {
+                float *chunk = *(accum->chunks.uget(i));
+                if (chunk != NULL)
+                    ::free(chunk);
+            }
+            accum->chunks.flush();
+            accum->length   = 0;
+        }
+
+        float *RayTrace3D::accum_chunk(rt_accum_t *accum, size_t offset)
+        {
+            size_t idx      = offset / CAPTURE_CHUNK_SIZE;
+
+            // Extend the list of chunks, this affects only the list of pointers
+            size_t count    = accum->chunks.size();
+            if (count <= idx)
+            {
+                float **vp      = accum->chunks.append_n(idx + 1 - count);
+                if (vp == NULL)
+                    return NULL;
+                for ( ; count <= idx; ++count)
+                    *(vp++)         = NULL;
+            }
+
+            // Allocate chunk if required
+            float **pchunk  = accum->chunks.uget(idx);
+            if (*pchunk == NULL)
+            {
+                float *chunk    = static_cast<float *>(::malloc(CAPTURE_CHUNK_SIZE * sizeof(float)));
+                if (chunk == NULL)
+                    return NULL;
+                dsp::fill_zero(chunk, CAPTURE_CHUNK_SIZE);
+                *pchunk         = chunk;
+            }
+
+            return &(*pchunk)[offset % CAPTURE_CHUNK_SIZE];
+        }
+
+        status_t RayTrace3D::prepare_merge()
+        {
+            vMerge.flush();
+
+            // Build the list of unique target samples
+            for (size_t i=0, n=vCaptures.size(); i<n; ++i)
+            {
+                capture_t *cap = vCaptures.uget(i);
+                for (size_t j=0, m=cap->bindings.size(); j<m; ++j)
+                {
+                    Sample *s = cap->bindings.uget(j)->sample;
+                    if ((s == NULL) || (vMerge.index_of(s) >= 0))
+                        continue;
+                    if (!vMerge.add(s))
+                        return STATUS_NO_MEM;
+                }
+            }
+
+            // Now resize each target sample only once
+            for (size_t k=0, nk=vMerge.size(); k<nk; ++k)
+            {
+                Sample *dst     = vMerge.uget(k);
+                size_t len      = dst->length();
+
+                for (size_t t=0, nt=vThreads.size(); t<nt; ++t)
+                {
+                    TaskThread *th  = vThreads.uget(t);
+                    for (size_t i=0, n=vCaptures.size(); i<n; ++i)
+                    {
+                        capture_t *cap      = vCaptures.uget(i);
+                        rt_binding_t *b     = th->bindings.get(i);
+                        if ((b == NULL) || (b->bindings.size() != cap->bindings.size()))
+                            return STATUS_CORRUPTED;
+
+                        for (size_t j=0, m=cap->bindings.size(); j<m; ++j)
+                        {
+                            if (cap->bindings.uget(j)->sample != dst)
+                                continue;
+                            rt_accum_t *acc     = b->bindings.uget(j);
+                            if (len < acc->length)
+                                len                 = acc->length;
+                        }
+                    }
+                }
+
+                if (len > dst->length())
+                {
+                    size_t maxlen   = lsp_max(dst->max_length(), len);
+                    if (!dst->resize(dst->channels(), maxlen, len))
+                        return STATUS_NO_MEM;
+                }
+            }
+
+            return STATUS_OK;
+        }
+
+        status_t RayTrace3D::merge_jobs()
+        {
+            while (true)
+            {
+                size_t idx      = atomic_add(&nMergeJob, 1);
+                if (idx >= vMerge.size())
+                    break;
+
+                // Merge data of all threads related to the sample
+                Sample *dst     = vMerge.uget(idx);
+                for (size_t i=0, n=vThreads.size(); i<n; ++i)
+                {
+                    status_t res    = vThreads.uget(i)->merge_result(dst);
+                    if (res != STATUS_OK)
+                        return res;
+                }
+            }
+
+            return STATUS_OK;
+        }
+
+        status_t RayTrace3D::merge_results(size_t threads)
+        {
+            // Prepare the samples, this is done in a single thread
+            status_t res    = prepare_merge();
+            if (res != STATUS_OK)
+                return res;
+
+            // Each target sample is merged by exactly one thread
+            nMergeJob       = 0;
+            size_t jobs     = lsp_min(threads, vMerge.size());
+            lltl::parray<MergeThread> workers;
+
+            for (size_t i=1; i<jobs; ++i)
+            {
+                // Failing to start merge thread is not critical, the merge
+                // will be performed by the remaining threads
+                MergeThread *t  = new MergeThread(this);
+                if (t == NULL)
+                    break;
+                if (t->start() != STATUS_OK)
+                {
+                    delete t;
+                    break;
+                }
+                if (!workers.add(t))
+                {
+                    t->join();
+                    delete t;
+                    break;
+                }
+            }
+
+            // Perform merge in this thread too
+            res             = merge_jobs();
+
+            // Wait for merge threads
+            for (size_t i=0, n=workers.size(); i<n; ++i)
+            {
+                MergeThread *t  = workers.uget(i);
+                t->join();
+                if (res == STATUS_OK)
+                    res             = t->get_result();
+                delete t;
+            }
+            workers.flush();
+            vMerge.flush();
+
+            return res;
         }
 
         void RayTrace3D::destroy_tasks(lltl::parray<rt::context_t> *tasks)
@@ -1353,6 +1937,7 @@ namespace lsp
                 {
                     obj->mesh.flush();
                     obj->plan.flush();
+                    obj->bvh.flush();
                     delete obj;
                 }
             }
@@ -1381,11 +1966,22 @@ namespace lsp
             {
                 if (!vMaterials.remove_n(objects, size - objects))
                     return STATUS_UNKNOWN_ERR;
+                if (!vBands.remove_n(objects, size - objects))
+                    return STATUS_UNKNOWN_ERR;
+                if (!vLodError.remove_n(objects, size - objects))
+                    return STATUS_UNKNOWN_ERR;
             }
             else if (objects > size)
             {
                 if (!vMaterials.append_n(objects - size))
                     return STATUS_NO_MEM;
+                if (!vBands.append_n(objects - size))
+                    return STATUS_NO_MEM;
+                float *lod  = vLodError.append_n(objects - size);
+                if (lod == NULL)
+                    return STATUS_NO_MEM;
+                for (size_t i=size; i<objects; ++i)
+                    *(lod++)    = 0.0f;
 
                 while (size < objects)
                 {
@@ -1405,6 +2001,8 @@ namespace lsp
                     m->transparency[1]  = 0.52f;
 
                     m->permeability     = 12.88f;
+
+                    init_bands(vBands.uget(size - 1), m);
                 }
             }
 
@@ -1420,6 +2018,8 @@ namespace lsp
         {
             destroy_tasks(&vTasks);
             clear_progress_callback();
+            clear_prepared_scene();
+            clear_shard();
             remove_scene(recursive);
 
             for (size_t i=0, n=vCaptures.size(); i<n; ++i)
@@ -1434,8 +2034,16 @@ namespace lsp
             vCaptures.flush();
 
             vMaterials.flush();
+            vBands.flush();
+            vLodError.flush();
             vSources.flush();
             vCaptures.flush();
+            vCheckpoints.flush();
+            vCaptureTree.flush();
+            vCaptureIndex.flush();
+            vThreadStats.flush();
+            vQueueHistory.flush();
+            clear_checkpoint_callback();
         }
 
         status_t RayTrace3D::add_source(const rt_source_settings_t *settings)
@@ -1472,6 +2080,7 @@ namespace lsp
             dsp::init_vector_dxyz(&cap->direction, 1.0f, 0.0f, 0.0f);
             cap->radius         = settings->radius;
             cap->type           = settings->type;
+            cap->prune          = 0.0f;
 
             dsp::apply_matrix3d_mv1(&cap->direction, &cap->pos);
             dsp::normalize_vector(&cap->direction);
@@ -1479,6 +2088,174 @@ namespace lsp
             return idx;
         }
 
+        status_t RayTrace3D::set_prune_threshold(size_t id, float db)
+        {
+            capture_t *cap = vCaptures.get(id);
+            if (cap == NULL)
+                return STATUS_INVALID_VALUE;
+
+            cap->prune      = db_to_gain(db);
+            return STATUS_OK;
+        }
+
+        float RayTrace3D::get_prune_threshold(size_t id) const
+        {
+            const capture_t *cap = vCaptures.get(id);
+            if ((cap == NULL) || (cap->prune <= 0.0f))
+                return -INFINITY;
+            return gain_to_db(cap->prune);
+        }
+
+        float RayTrace3D::estimate_prune_threshold()
+        {
+            float thresh    = 0.0f;
+            dsp::point3d_t o, cp, sp;
+            dsp::init_point_xyz(&o, 0.0f, 0.0f, 0.0f);
+
+            for (size_t i=0, n=vCaptures.size(); i<n; ++i)
+            {
+                // The capture without threshold requires all contexts
+                capture_t *cap  = vCaptures.uget(i);
+                if (cap->prune <= 0.0f)
+                    return 0.0f;
+
+                // Estimate the level of the direct sound as the fraction of the
+                // wave front of each source that falls into the capture
+                dsp::apply_matrix3d_mp2(&cp, &o, &cap->pos);
+                float direct    = 0.0f;
+                for (size_t j=0, m=vSources.size(); j<m; ++j)
+                {
+                    rt_source_settings_t *src = vSources.uget(j);
+                    dsp::apply_matrix3d_mp2(&sp, &o, &src->pos);
+
+                    float d         = dsp::calc_distance_p2(&sp, &cp);
+                    float k         = (d > cap->radius * 0.5f) ? cap->radius / (2.0f * d) : 1.0f;
+                    direct          = lsp_max(direct, fabsf(src->amplitude) * k);
+                }
+                if (direct <= 0.0f)
+                    return 0.0f;
+
+                float level     = direct * cap->prune;
+                thresh          = (i > 0) ? lsp_min(thresh, level) : level;
+            }
+
+            return thresh;
+        }
+
+        static inline float rt_capture_center(const dsp::bound_box3d_t *b, size_t axis)
+        {
+            // The points 0 and 6 are the opposite corners of the box
+            switch (axis)
+            {
+                case 0:     return b->p[0].x + b->p[6].x;
+                case 1:     return b->p[0].y + b->p[6].y;
+                default:    break;
+            }
+            return b->p[0].z + b->p[6].z;
+        }
+
+        status_t RayTrace3D::build_capture_tree()
+        {
+            vCaptureTree.clear();
+            vCaptureIndex.clear();
+
+            size_t n        = vCaptures.size();
+            if (n <= 0)
+                return STATUS_OK;
+
+            size_t *idx     = vCaptureIndex.append_n(n);
+            if (idx == NULL)
+                return STATUS_NO_MEM;
+            for (size_t i=0; i<n; ++i)
+                idx[i]          = i;
+
+            ssize_t res     = build_capture_node(0, n, 0);
+            if (res < 0)
+            {
+                vCaptureTree.flush();
+                vCaptureIndex.flush();
+                return -res;
+            }
+
+            return STATUS_OK;
+        }
+
+        ssize_t RayTrace3D::build_capture_node(size_t first, size_t count, size_t depth)
+        {
+            size_t id           = vCaptureTree.size();
+            rt::bvh_node_t *node= vCaptureTree.add();
+            if (node == NULL)
+                return -STATUS_NO_MEM;
+
+            // Compute the axis-aligned box over the boxes of all captures
+            size_t *idx         = vCaptureIndex.array();
+            const dsp::bound_box3d_t *cb = &vCaptures.uget(idx[first])->bbox;
+            float x0 = cb->p[0].x, y0 = cb->p[0].y, z0 = cb->p[0].z;
+            float x1 = x0, y1 = y0, z1 = z0;
+
+            for (size_t i=first; i<first+count; ++i)
+            {
+                cb                  = &vCaptures.uget(idx[i])->bbox;
+                for (size_t j=0; j<8; ++j)
+                {
+                    const dsp::point3d_t *p = &cb->p[j];
+                    x0  = lsp_min(x0, p->x);
+                    y0  = lsp_min(y0, p->y);
+                    z0  = lsp_min(z0, p->z);
+                    x1  = lsp_max(x1, p->x);
+                    y1  = lsp_max(y1, p->y);
+                    z1  = lsp_max(z1, p->z);
+                }
+            }
+
+            dsp::init_point_xyz(&node->bbox.p[0], x0, y1, z1);
+            dsp::init_point_xyz(&node->bbox.p[1], x0, y0, z1);
+            dsp::init_point_xyz(&node->bbox.p[2], x1, y0, z1);
+            dsp::init_point_xyz(&node->bbox.p[3], x1, y1, z1);
+            dsp::init_point_xyz(&node->bbox.p[4], x0, y1, z0);
+            dsp::init_point_xyz(&node->bbox.p[5], x0, y0, z0);
+            dsp::init_point_xyz(&node->bbox.p[6], x1, y0, z0);
+            dsp::init_point_xyz(&node->bbox.p[7], x1, y1, z0);
+            node->first         = first;
+            node->count         = count;
+            node->left          = 0;
+            node->right         = 0;
+
+            if ((count <= CAPTURE_LEAF_SIZE) || (depth >= RT_BVH_MAX_DEPTH))
+                return id;
+
+            // Sort captures by the center along the longest axis and split at median
+            float dx            = x1 - x0;
+            float dy            = y1 - y0;
+            float dz            = z1 - z0;
+            size_t axis         = ((dx >= dy) && (dx >= dz)) ? 0 : (dy >= dz) ? 1 : 2;
+
+            for (size_t i=first+1; i<first+count; ++i)
+            {
+                size_t v            = idx[i];
+                float c             = rt_capture_center(&vCaptures.uget(v)->bbox, axis);
+                size_t j            = i;
+                for ( ; (j > first) && (rt_capture_center(&vCaptures.uget(idx[j-1])->bbox, axis) > c); --j)
+                    idx[j]              = idx[j-1];
+                idx[j]              = v;
+            }
+
+            size_t half         = count >> 1;
+            ssize_t left        = build_capture_node(first, half, depth + 1);
+            if (left < 0)
+                return left;
+            ssize_t right       = build_capture_node(first + half, count - half, depth + 1);
+            if (right < 0)
+                return right;
+
+            // Node pointer may be invalid after array growth
+            node                = vCaptureTree.uget(id);
+            node->left          = left;
+            node->right         = right;
+
+            return id;
+        }
+
         status_t RayTrace3D::bind_capture(size_t id, Sample *sample, size_t channel, ssize_t r_min, ssize_t r_max)
         {
             capture_t *cap = vCaptures.get(id);
@@ -1491,102 +2268,754 @@ namespace lsp
 
             s->sample       = sample;
             s->channel      = channel;
+            s->band         = -1;
             s->r_min        = r_min;
             s->r_max        = r_max;
 
             return STATUS_OK;
         }
 
+        status_t RayTrace3D::bind_capture_band(size_t id, size_t band, Sample *sample, size_t channel, ssize_t r_min, ssize_t r_max)
+        {
+            if (band >= RT_BANDS_MAX)
+                return STATUS_BAD_ARGUMENTS;
+
+            status_t res    = bind_capture(id, sample, channel, r_min, r_max);
+            if (res != STATUS_OK)
+                return res;
+
+            capture_t *cap  = vCaptures.uget(id);
+            cap->bindings.uget(cap->bindings.size() - 1)->band = band;
+
+            return STATUS_OK;
+        }
+
         status_t RayTrace3D::set_scene(Scene3D *scene, bool destroy)
         {
             status_t res = resize_materials(scene->num_objects());
             if (res != STATUS_OK)
                 return res;
 
-            // Destroy scene
+            // Destroy scene, the prepared scene becomes invalid
+            clear_prepared_scene();
             remove_scene(destroy);
             pScene      = scene;
             return STATUS_OK;
         }
 
-        status_t RayTrace3D::set_material(size_t idx, const rt::material_t *material)
+        status_t RayTrace3D::prepare_scene()
         {
-            rt::material_t *m = vMaterials.get(idx);
-            if (m == NULL)
-                return STATUS_INVALID_VALUE;
-            *m = *material;
-            return STATUS_OK;
-        }
+            if (pScene == NULL)
+                return STATUS_BAD_STATE;
 
-        status_t RayTrace3D::get_material(rt::material_t *material, size_t idx)
-        {
-            if (material == NULL)
-                return STATUS_BAD_ARGUMENTS;
-            rt::material_t *m = vMaterials.get(idx);
-            if (m == NULL)
-                return STATUS_INVALID_VALUE;
+            // Generate prepared objects using temporary thread object
+            clear_prepared_scene();
+            TaskThread *t = new TaskThread(this, 0);
+            if (t == NULL)
+                return STATUS_NO_MEM;
+
+            status_t res = t->generate_prepared_scene();
+            if (res == STATUS_OK)
+                vPrepared.swap(t->get_objects());
+            delete t;
+
+            if (res != STATUS_OK)
+            {
+                clear_prepared_scene();
+                return res;
+            }
+
+            nPreparedObjects    = pScene->num_objects();
+            bPrepared           = true;
 
-            *material = *m;
             return STATUS_OK;
         }
 
-        status_t RayTrace3D::set_progress_callback(rt::progress_func_t callback, void *data)
+        void RayTrace3D::clear_prepared_scene()
         {
-            if (callback == NULL)
-                return clear_progress_callback();
-
-            pProgress       = callback;
-            pProgressData   = data;
-            return STATUS_OK;
+            destroy_objects(&vPrepared);
+            nPreparedObjects    = 0;
+            bPrepared           = false;
         }
 
-        status_t RayTrace3D::clear_progress_callback()
+        status_t RayTrace3D::save_prepared_scene(const char *path)
         {
-            pProgress       = NULL;
-            pProgressData   = NULL;
-            return STATUS_OK;
+            io::Path tmp;
+            status_t res = tmp.set(path);
+            return (res == STATUS_OK) ? save_prepared_scene(&tmp) : res;
         }
 
-        status_t RayTrace3D::report_progress(float progress)
+        status_t RayTrace3D::save_prepared_scene(const LSPString *path)
         {
-            if (pProgress == NULL)
-                return STATUS_OK;
-            return pProgress(progress, pProgressData);
+            io::Path tmp;
+            status_t res = tmp.set(path);
+            return (res == STATUS_OK) ? save_prepared_scene(&tmp) : res;
         }
 
-        status_t RayTrace3D::do_process(size_t threads, float initial)
+        status_t RayTrace3D::save_prepared_scene(const io::Path *path)
         {
-            status_t res = STATUS_OK;
-            bCancelled   = false;
-            bFailed      = false;
+            status_t res;
+            io::OutFileStream ofs;
+            if ((res = ofs.open(path, io::File::FM_WRITE_NEW)) != STATUS_OK)
+                return res;
 
-            // Get time of execution start
-    #ifdef LSP_TRACE
-            struct timespec tstart;
-            clock_gettime(CLOCK_REALTIME, &tstart);
-    #endif
+            res = save_prepared_scene(&ofs);
+            status_t res2 = ofs.close();
 
-            // Create main thread
-            TaskThread *root = new TaskThread(this);
-            if (root == NULL)
-                return STATUS_NO_MEM;
+            return (res == STATUS_OK) ? res2 : res;
+        }
 
-            // Launch prepare_main_loop in root thread's context
-            res    = root->prepare_main_loop(initial);
-            if (res != STATUS_OK)
-            {
-                delete root;
+        status_t RayTrace3D::save_prepared_scene(io::IOutStream *os)
+        {
+            if (!bPrepared)
+                return STATUS_BAD_STATE;
+
+            status_t res;
+            rt_scene_header_t hdr;
+            memcpy(hdr.signature, RT_SCENE_SIGNATURE, sizeof(hdr.signature));
+            hdr.version         = RT_SCENE_VERSION;
+            hdr.byte_order      = RT_SCENE_BYTE_ORDER;
+            hdr.objects         = vPrepared.size();
+            hdr.scene_objects   = nPreparedObjects;
+            if ((res = rt_write(os, &hdr, sizeof(hdr))) != STATUS_OK)
                 return res;
-            }
 
-            // Launch supplementary threads
-            lltl::parray<TaskThread> workers;
-            if (vTasks.size() > 0)
+            for (size_t i=0, n=vPrepared.size(); i<n; ++i)
             {
-                for (size_t i=1; i<threads; ++i)
-                {
+                rt_object_t *o      = vPrepared.uget(i);
+
+                // Write object header
+                rt_scene_object_t so;
+                so.index            = o->index;
+                so.triangles        = o->mesh.size();
+                so.edges            = o->plan.size();
+                for (size_t j=0; j<8; ++j)
+                    rt_store_point(so.bbox[j], &o->bbox.p[j]);
+                if ((res = rt_write(os, &so, sizeof(so))) != STATUS_OK)
+                    return res;
+
+                // Write list of edges
+                const rtx::edge_t *se   = o->plan.array();
+                for (size_t j=0; j<so.edges; ++j)
+                {
+                    rt_scene_edge_t e;
+                    rt_store_point(e.v[0], &se[j].v[0]);
+                    rt_store_point(e.v[1], &se[j].v[1]);
+                    if ((res = rt_write(os, &e, sizeof(e))) != STATUS_OK)
+                        return res;
+                }
+
+                // Write list of triangles
+                const rtx::triangle_t *st = o->mesh.array();
+                for (size_t j=0; j<so.triangles; ++j, ++st)
+                {
+                    rt_scene_triangle_t t;
+                    rt_store_point(t.v[0], &st->v[0]);
+                    rt_store_point(t.v[1], &st->v[1]);
+                    rt_store_point(t.v[2], &st->v[2]);
+                    t.n[0]              = st->n.dx;
+                    t.n[1]              = st->n.dy;
+                    t.n[2]              = st->n.dz;
+                    t.n[3]              = st->n.dw;
+                    t.face              = st->face;
+                    t.e[0]              = st->e[0] - se;
+                    t.e[1]              = st->e[1] - se;
+                    t.e[2]              = st->e[2] - se;
+                    if ((res = rt_write(os, &t, sizeof(t))) != STATUS_OK)
+                        return res;
+                }
+            }
+
+            return STATUS_OK;
+        }
+
+        status_t RayTrace3D::load_prepared_scene(const char *path)
+        {
+            io::Path tmp;
+            status_t res = tmp.set(path);
+            return (res == STATUS_OK) ? load_prepared_scene(&tmp) : res;
+        }
+
+        status_t RayTrace3D::load_prepared_scene(const LSPString *path)
+        {
+            io::Path tmp;
+            status_t res = tmp.set(path);
+            return (res == STATUS_OK) ? load_prepared_scene(&tmp) : res;
+        }
+
+        status_t RayTrace3D::load_prepared_scene(const io::Path *path)
+        {
+            status_t res;
+            io::InFileStream ifs;
+            if ((res = ifs.open(path)) != STATUS_OK)
+                return res;
+
+            res = load_prepared_scene(&ifs);
+            status_t res2 = ifs.close();
+
+            return (res == STATUS_OK) ? res2 : res;
+        }
+
+        status_t RayTrace3D::load_prepared_scene(io::IInStream *is)
+        {
+            if (pScene == NULL)
+                return STATUS_BAD_STATE;
+
+            status_t res;
+            rt_scene_header_t hdr;
+            if ((res = rt_read(is, &hdr, sizeof(hdr))) != STATUS_OK)
+                return res;
+            if ((memcmp(hdr.signature, RT_SCENE_SIGNATURE, sizeof(hdr.signature)) != 0) ||
+                (hdr.version != RT_SCENE_VERSION) ||
+                (hdr.byte_order != RT_SCENE_BYTE_ORDER))
+                return STATUS_BAD_FORMAT;
+            if (hdr.scene_objects != pScene->num_objects())
+                return STATUS_INVALID_VALUE;
+
+            lltl::parray<rt_object_t> objects;
+            for (size_t i=0; i<hdr.objects; ++i)
+            {
+                rt_object_t *o = new rt_object_t();
+                if (o == NULL)
+                    res = STATUS_NO_MEM;
+                else if (!objects.add(o))
+                {
+                    delete o;
+                    res = STATUS_NO_MEM;
+                }
+                if (res != STATUS_OK)
+                    break;
+
+                // Read object header
+                rt_scene_object_t so;
+                if ((res = rt_read(is, &so, sizeof(so))) != STATUS_OK)
+                    break;
+                if (so.index >= hdr.scene_objects)
+                {
+                    res = STATUS_CORRUPTED;
+                    break;
+                }
+
+                o->index    = so.index;
+                for (size_t j=0; j<8; ++j)
+                    rt_load_point(&o->bbox.p[j], so.bbox[j]);
+
+                // Read list of edges
+                rtx::edge_t *de = o->plan.append_n(so.edges);
+                rtx::triangle_t *dt = o->mesh.append_n(so.triangles);
+                if (((de == NULL) && (so.edges > 0)) || ((dt == NULL) && (so.triangles > 0)))
+                {
+                    res = STATUS_NO_MEM;
+                    break;
+                }
+
+                for (size_t j=0; j<so.edges; ++j)
+                {
+                    rt_scene_edge_t e;
+                    if ((res = rt_read(is, &e, sizeof(e))) != STATUS_OK)
+                        break;
+                    rt_load_point(&de[j].v[0], e.v[0]);
+                    rt_load_point(&de[j].v[1], e.v[1]);
+                    de[j].itag          = 0;
+                }
+                if (res != STATUS_OK)
+                    break;
+
+                // Read list of triangles
+                for (size_t j=0; j<so.triangles; ++j, ++dt)
+                {
+                    rt_scene_triangle_t t;
+                    if ((res = rt_read(is, &t, sizeof(t))) != STATUS_OK)
+                        break;
+                    if ((t.e[0] >= so.edges) || (t.e[1] >= so.edges) || (t.e[2] >= so.edges))
+                    {
+                        res = STATUS_CORRUPTED;
+                        break;
+                    }
+
+                    rt_load_point(&dt->v[0], t.v[0]);
+                    rt_load_point(&dt->v[1], t.v[1]);
+                    rt_load_point(&dt->v[2], t.v[2]);
+                    dsp::init_vector_dxyz(&dt->n, t.n[0], t.n[1], t.n[2]);
+                    dt->n.dw            = t.n[3];
+                    dt->oid             = so.index;
+                    dt->face            = t.face;
+                    dt->m               = NULL;
+                    dt->e[0]            = &de[t.e[0]];
+                    dt->e[1]            = &de[t.e[1]];
+                    dt->e[2]            = &de[t.e[2]];
+                }
+                if (res != STATUS_OK)
+                    break;
+
+                // Rebuild hierarchy
+                if (o->mesh.size() > RT_BVH_LEAF_SIZE)
+                {
+                    if ((res = o->bvh.build(o->mesh.array(), o->mesh.size())) != STATUS_OK)
+                        break;
+                }
+            }
+
+            if (res != STATUS_OK)
+            {
+                destroy_objects(&objects);
+                return res;
+            }
+
+            // Commit the loaded scene
+            clear_prepared_scene();
+            vPrepared.swap(&objects);
+            nPreparedObjects    = hdr.scene_objects;
+            bPrepared           = true;
+
+            return STATUS_OK;
+        }
+
+        status_t RayTrace3D::set_shard(size_t index, size_t count)
+        {
+            if ((count == 0) || (index >= count))
+                return STATUS_BAD_ARGUMENTS;
+
+            nShard              = index;
+            nShards             = count;
+            return STATUS_OK;
+        }
+
+        void RayTrace3D::clear_shard()
+        {
+            vShardTasks.flush();
+            nShard              = 0;
+            nShards             = 1;
+            bShardTasks         = false;
+        }
+
+        status_t RayTrace3D::save_shard(const char *path, size_t index, size_t count)
+        {
+            io::Path tmp;
+            status_t res = tmp.set(path);
+            return (res == STATUS_OK) ? save_shard(&tmp, index, count) : res;
+        }
+
+        status_t RayTrace3D::save_shard(const LSPString *path, size_t index, size_t count)
+        {
+            io::Path tmp;
+            status_t res = tmp.set(path);
+            return (res == STATUS_OK) ? save_shard(&tmp, index, count) : res;
+        }
+
+        status_t RayTrace3D::save_shard(const io::Path *path, size_t index, size_t count)
+        {
+            status_t res;
+            io::OutFileStream ofs;
+            if ((res = ofs.open(path, io::File::FM_WRITE_NEW)) != STATUS_OK)
+                return res;
+
+            res = save_shard(&ofs, index, count);
+            status_t res2 = ofs.close();
+
+            return (res == STATUS_OK) ? res2 : res;
+        }
+
+        status_t RayTrace3D::save_shard(io::IOutStream *os, size_t index, size_t count)
+        {
+            if ((count == 0) || (index >= count))
+                return STATUS_BAD_ARGUMENTS;
+
+            // Enumerate root tasks in the same order as the processing does
+            status_t res;
+            lltl::darray<rt::view_t> views;
+            lltl::darray<rt::view_t> *list = &vShardTasks;
+            if (!bShardTasks)
+            {
+                if ((res = generate_root_views(&views)) != STATUS_OK)
+                    return res;
+                list                = &views;
+            }
+
+            // Write the prepared scene
+            if ((res = save_prepared_scene(os)) != STATUS_OK)
+                return res;
+
+            // Write the root tasks of the shard
+            rt_shard_header_t hdr;
+            memcpy(hdr.signature, RT_SHARD_SIGNATURE, sizeof(hdr.signature));
+            hdr.version         = RT_SHARD_VERSION;
+            hdr.byte_order      = RT_SCENE_BYTE_ORDER;
+            hdr.tasks           = (list->size() + count - index - 1) / count;
+            hdr.shard           = index;
+            hdr.shards          = count;
+            if ((res = rt_write(os, &hdr, sizeof(hdr))) != STATUS_OK)
+                return res;
+
+            for (size_t i=index, n=list->size(); i<n; i += count)
+            {
+                const rt::view_t *v = list->uget(i);
+
+                rt_shard_task_t t;
+                rt_store_point(t.s, &v->s);
+                rt_store_point(t.p[0], &v->p[0]);
+                rt_store_point(t.p[1], &v->p[1]);
+                rt_store_point(t.p[2], &v->p[2]);
+                t.time[0]           = v->time[0];
+                t.time[1]           = v->time[1];
+                t.time[2]           = v->time[2];
+                t.amplitude         = v->amplitude;
+                t.speed             = v->speed;
+                t.location          = v->location;
+                t.oid               = v->oid;
+                t.face              = v->face;
+                t.rnum              = v->rnum;
+                if ((res = rt_write(os, &t, sizeof(t))) != STATUS_OK)
+                    return res;
+            }
+
+            return STATUS_OK;
+        }
+
+        status_t RayTrace3D::load_shard(const char *path)
+        {
+            io::Path tmp;
+            status_t res = tmp.set(path);
+            return (res == STATUS_OK) ? load_shard(&tmp) : res;
+        }
+
+        status_t RayTrace3D::load_shard(const LSPString *path)
+        {
+            io::Path tmp;
+            status_t res = tmp.set(path);
+            return (res == STATUS_OK) ? load_shard(&tmp) : res;
+        }
+
+        status_t RayTrace3D::load_shard(const io::Path *path)
+        {
+            status_t res;
+            io::InFileStream ifs;
+            if ((res = ifs.open(path)) != STATUS_OK)
+                return res;
+
+            res = load_shard(&ifs);
+            status_t res2 = ifs.close();
+
+            return (res == STATUS_OK) ? res2 : res;
+        }
+
+        status_t RayTrace3D::load_shard(io::IInStream *is)
+        {
+            status_t res;
+            if ((res = load_prepared_scene(is)) != STATUS_OK)
+                return res;
+
+            rt_shard_header_t hdr;
+            if ((res = rt_read(is, &hdr, sizeof(hdr))) != STATUS_OK)
+                return res;
+            if ((memcmp(hdr.signature, RT_SHARD_SIGNATURE, sizeof(hdr.signature)) != 0) ||
+                (hdr.version != RT_SHARD_VERSION) ||
+                (hdr.byte_order != RT_SCENE_BYTE_ORDER))
+                return STATUS_BAD_FORMAT;
+            if (hdr.shard >= hdr.shards)
+                return STATUS_CORRUPTED;
+
+            lltl::darray<rt::view_t> views;
+            rt::view_t *v       = views.append_n(hdr.tasks);
+            if ((v == NULL) && (hdr.tasks > 0))
+                return STATUS_NO_MEM;
+
+            for (size_t i=0; i<hdr.tasks; ++i, ++v)
+            {
+                rt_shard_task_t t;
+                if ((res = rt_read(is, &t, sizeof(t))) != STATUS_OK)
+                    return res;
+
+                rt_load_point(&v->s, t.s);
+                rt_load_point(&v->p[0], t.p[0]);
+                rt_load_point(&v->p[1], t.p[1]);
+                rt_load_point(&v->p[2], t.p[2]);
+                v->time[0]          = t.time[0];
+                v->time[1]          = t.time[1];
+                v->time[2]          = t.time[2];
+                v->amplitude        = t.amplitude;
+                dsp::fill(v->bands, t.amplitude, RT_BANDS_MAX);
+                v->speed            = t.speed;
+                v->location         = t.location;
+                v->oid              = t.oid;
+                v->face             = t.face;
+                v->rnum             = t.rnum;
+            }
+
+            // Commit the loaded tasks, all of them should be processed
+            vShardTasks.swap(&views);
+            nShard              = 0;
+            nShards             = 1;
+            bShardTasks         = true;
+
+            return STATUS_OK;
+        }
+
+        status_t RayTrace3D::merge_shard(Sample *dst, const Sample *src)
+        {
+            if ((dst == NULL) || (src == NULL))
+                return STATUS_BAD_ARGUMENTS;
+            if (dst->channels() != src->channels())
+                return STATUS_BAD_ARGUMENTS;
+            if ((dst->compacted()) || (src->compacted()))
+                return STATUS_BAD_STATE;
+
+            // Extend the target sample to fit the partial result
+            size_t len          = src->length();
+            if (len > dst->length())
+            {
+                size_t maxlen       = lsp_max(dst->max_length(), len);
+                if (!dst->resize(dst->channels(), maxlen, len))
+                    return STATUS_NO_MEM;
+            }
+
+            for (size_t i=0, n=src->channels(); i<n; ++i)
+                dsp::add2(dst->getBuffer(i), src->getBuffer(i), len);
+
+            return STATUS_OK;
+        }
+
+        float RayTrace3D::normalize_captures()
+        {
+            return normalize_output();
+        }
+
+        status_t RayTrace3D::set_material(size_t idx, const rt::material_t *material)
+        {
+            rt::material_t *m = vMaterials.get(idx);
+            if (m == NULL)
+                return STATUS_INVALID_VALUE;
+            *m = *material;
+            init_bands(vBands.uget(idx), m);
+            return STATUS_OK;
+        }
+
+        status_t RayTrace3D::set_lod_error(size_t idx, float error)
+        {
+            float *e = vLodError.get(idx);
+            if (e == NULL)
+                return STATUS_INVALID_VALUE;
+            *e = lsp_max(error, 0.0f);
+            return STATUS_OK;
+        }
+
+        float RayTrace3D::get_lod_error(size_t idx) const
+        {
+            const float *e = vLodError.get(idx);
+            return (e != NULL) ? *e : 0.0f;
+        }
+
+        status_t RayTrace3D::get_material(rt::material_t *material, size_t idx)
+        {
+            if (material == NULL)
+                return STATUS_BAD_ARGUMENTS;
+            rt::material_t *m = vMaterials.get(idx);
+            if (m == NULL)
+                return STATUS_INVALID_VALUE;
+
+            *material = *m;
+            return STATUS_OK;
+        }
+
+        status_t RayTrace3D::set_bands(size_t bands)
+        {
+            if (bands > RT_BANDS_MAX)
+                return STATUS_BAD_ARGUMENTS;
+            nBands      = bands;
+            return STATUS_OK;
+        }
+
+        status_t RayTrace3D::set_band_material(size_t idx, size_t band, const rt::band_material_t *material)
+        {
+            if ((material == NULL) || (band >= RT_BANDS_MAX))
+                return STATUS_BAD_ARGUMENTS;
+            rt_bands_t *b = vBands.get(idx);
+            if (b == NULL)
+                return STATUS_INVALID_VALUE;
+
+            b->material[band]   = *material;
+            update_bands(b, band);
+            return STATUS_OK;
+        }
+
+        status_t RayTrace3D::get_band_material(rt::band_material_t *material, size_t idx, size_t band)
+        {
+            if ((material == NULL) || (band >= RT_BANDS_MAX))
+                return STATUS_BAD_ARGUMENTS;
+            rt_bands_t *b = vBands.get(idx);
+            if (b == NULL)
+                return STATUS_INVALID_VALUE;
+
+            *material = b->material[band];
+            return STATUS_OK;
+        }
+
+        void RayTrace3D::init_bands(rt_bands_t *bands, const rt::material_t *m)
+        {
+            for (size_t i=0; i<RT_BANDS_MAX; ++i)
+            {
+                rt::band_material_t *bm = &bands->material[i];
+                bm->absorption[0]       = m->absorption[0];
+                bm->absorption[1]       = m->absorption[1];
+                bm->transparency[0]     = m->transparency[0];
+                bm->transparency[1]     = m->transparency[1];
+                update_bands(bands, i);
+            }
+        }
+
+        void RayTrace3D::update_bands(rt_bands_t *bands, size_t band)
+        {
+            // The same gains as reflect_view() applies to the broadband amplitude
+            const rt::band_material_t *bm = &bands->material[band];
+            for (size_t i=0; i<2; ++i)
+            {
+                float k                 = 1.0f - bm->absorption[i];
+                bands->reflect[i][band] = k * (bm->transparency[i] - 1.0f); // Sign negated
+                bands->refract[i][band] = k * bm->transparency[i];
+            }
+        }
+
+        status_t RayTrace3D::set_progress_callback(rt::progress_func_t callback, void *data)
+        {
+            if (callback == NULL)
+                return clear_progress_callback();
+
+            pProgress       = callback;
+            pProgressData   = data;
+            return STATUS_OK;
+        }
+
+        status_t RayTrace3D::clear_progress_callback()
+        {
+            pProgress       = NULL;
+            pProgressData   = NULL;
+            return STATUS_OK;
+        }
+
+        status_t RayTrace3D::set_checkpoint_callback(rt::checkpoint_func_t callback, void *data)
+        {
+            if (callback == NULL)
+                return clear_checkpoint_callback();
+
+            pCheckpoint     = callback;
+            pCheckpointData = data;
+            return STATUS_OK;
+        }
+
+        status_t RayTrace3D::clear_checkpoint_callback()
+        {
+            pCheckpoint     = NULL;
+            pCheckpointData = NULL;
+            return STATUS_OK;
+        }
+
+        status_t RayTrace3D::set_progressive(const size_t *reflections, size_t count)
+        {
+            if ((count > 0) && (reflections == NULL))
+                return STATUS_BAD_ARGUMENTS;
+
+            // Checkpoints should be strictly ascending
+            for (size_t i=1; i<count; ++i)
+                if (reflections[i] <= reflections[i-1])
+                    return STATUS_INVALID_VALUE;
+
+            lltl::darray<size_t> tmp;
+            if (count > 0)
+            {
+                size_t *dst = tmp.append_n(count);
+                if (dst == NULL)
+                    return STATUS_NO_MEM;
+                for (size_t i=0; i<count; ++i)
+                    dst[i]      = reflections[i];
+            }
+
+            vCheckpoints.swap(&tmp);
+            return STATUS_OK;
+        }
+
+        status_t RayTrace3D::generate_root_views(lltl::darray<rt::view_t> *views)
+        {
+            status_t res;
+
+            for (size_t i=0,n=vSources.size(); i<n; ++i)
+            {
+                rt_source_settings_t *src = vSources.get(i);
+                if (src == NULL)
+                    return STATUS_CORRUPTED;
+
+                // Generate source mesh
+                lltl::darray<rt::group_t> groups;
+                res = rt_gen_source_mesh(groups, src);
+                if (res != STATUS_OK)
+                    return res;
+
+                // Generate root views
+                dsp::matrix3d_t tm = src->pos;
+
+                for (size_t ti=0, n=groups.size(); ti<n; ++ti)
+                {
+                    rt::group_t *grp = groups.uget(ti);
+                    if (grp == NULL)
+                        continue;
+
+                    rt::view_t *v       = views->add();
+                    if (v == NULL)
+                        return STATUS_NO_MEM;
+
+                    dsp::apply_matrix3d_mp2(&v->s, &grp->s, &tm);
+                    dsp::apply_matrix3d_mp2(&v->p[0], &grp->p[0], &tm);
+                    dsp::apply_matrix3d_mp2(&v->p[1], &grp->p[1], &tm);
+                    dsp::apply_matrix3d_mp2(&v->p[2], &grp->p[2], &tm);
+
+                    v->location         = 1.0f;
+                    v->oid              = -1;
+                    v->face             = -1;
+                    v->speed            = LSP_DSP_UNITS_SOUND_SPEED_M_S;
+
+                    v->amplitude        = src->amplitude;
+                    dsp::fill(v->bands, src->amplitude, RT_BANDS_MAX);
+                    v->time[0]          = 0.0f;
+                    v->time[1]          = 0.0f;
+                    v->time[2]          = 0.0f;
+                    v->rnum             = 0;
+                }
+            }
+
+            return STATUS_OK;
+        }
+
+        status_t RayTrace3D::report_progress(float progress)
+        {
+            // Record the size of the global queue, the call is serialized by lkTasks
+            size_t size = vTasks.size();
+            if (!vQueueHistory.add(&size))
+                return STATUS_NO_MEM;
+            if (pProgress == NULL)
+                return STATUS_OK;
+
+            // Map progress of current pass to the overall progress
+            if (nPasses > 1)
+                progress    = (float(nPass) + progress) / float(nPasses);
+            return pProgress(progress, pProgressData);
+        }
+
+        status_t RayTrace3D::run_pass(TaskThread *root, size_t threads, stats_t *overall)
+        {
+            status_t res = STATUS_OK;
+
+            // Create supplementary threads, all threads should be registered
+            // before launch because they steal tasks from each other
+            lltl::parray<TaskThread> workers;
+            vThreads.flush();
+            if (!vThreads.add(root))
+                res = STATUS_NO_MEM;
+
+            if ((res == STATUS_OK) && (vTasks.size() > 0))
+            {
+                for (size_t i=1; i<threads; ++i)
+                {
                     // Create thread object
-                    TaskThread *t   = new TaskThread(this);
+                    TaskThread *t   = new TaskThread(this, i);
                     if ((t == NULL) || (!workers.add(t)))
                     {
                         if (t != NULL)
@@ -1599,9 +3028,22 @@ namespace lsp
                     res = t->prepare_supplementary_loop(root);
                     if (res != STATUS_OK)
                         break;
+                    if (!vThreads.add(t))
+                    {
+                        res = STATUS_NO_MEM;
+                        break;
+                    }
+                }
+            }
 
-                    // Launch thread
-                    res = t->start();
+            // Launch supplementary threads
+            nActive         = vThreads.size();
+            size_t started  = 0;
+            if (res == STATUS_OK)
+            {
+                for (size_t n=workers.size(); started<n; ++started)
+                {
+                    res = workers.uget(started)->start();
                     if (res != STATUS_OK)
                         break;
                 }
@@ -1614,7 +3056,7 @@ namespace lsp
                 bFailed = true;
 
             // Wait for supplementary threads
-            for (size_t i=0,n=workers.size(); i<n; ++i)
+            for (size_t i=0; i<started; ++i)
             {
                 // Wait for thread completion
                 TaskThread *t = workers.get(i);
@@ -1623,34 +3065,197 @@ namespace lsp
                     res     = t->get_result(); // Update execution status
             }
 
+            // Merge results of all threads into the target samples
+            status_t mres = merge_results(threads);
+            if (res == STATUS_OK)
+                res     = mres;
+            root->clear_captures();
+            vThreads.flush();
+
+            // Collect tasks deferred to the next pass
+            destroy_tasks(&vTasks);
+            if (res == STATUS_OK)
+            {
+                if (!vTasks.add(root->deferred_tasks()))
+                    res     = STATUS_NO_MEM;
+                root->deferred_tasks()->flush();
+            }
+
             // Get root thread statistics
-            stats_t overall;
-            clear_stats(&overall);
-            merge_stats(&overall, root->get_stats());
-            root->merge_result();
             if (res != STATUS_BREAK_POINT)
                 dump_stats("Main thread statistics", root->get_stats());
+            merge_stats(overall, root->get_stats());
+            merge_stats(vThreadStats.uget(0), root->get_stats());
+            clear_stats(root->get_stats());
 
             // Output thread stats and destroy threads
             for (size_t i=0,n=workers.size(); i<n; ++i)
             {
-                // Post-process each thread
                 TaskThread *t = workers.get(i);
-                t->merge_result();
+                if (res == STATUS_OK)
+                {
+                    if (!vTasks.add(t->deferred_tasks()))
+                        res     = STATUS_NO_MEM;
+                    else
+                        t->deferred_tasks()->flush();
+                }
 
                 // Merge and output statistics
                 LSPString s;
                 s.fmt_utf8("Supplementary thread %d statistics", int(i));
-                merge_stats(&overall, t->get_stats());
+                merge_stats(overall, t->get_stats());
+                merge_stats(vThreadStats.uget(i + 1), t->get_stats());
                 if (res != STATUS_BREAK_POINT)
                     dump_stats(s.get_utf8(), t->get_stats());
 
                 // Detroy thread object
                 delete t;
             }
-            delete root;
             workers.flush();
 
+            // Release memory cached by the arenas at the end of the pass
+            for (size_t i=0, n=vArenas.size(); i<n; ++i)
+                vArenas.uget(i)->reset();
+
+            // Values to report progress of the next pass
+            nProgressPoints = 1;
+            nQueueSize      = vTasks.size();
+            nProgressMax    = nQueueSize + 2;
+
+            return res;
+        }
+
+        status_t RayTrace3D::create_arenas(size_t threads)
+        {
+            destroy_arenas();
+
+            for (size_t i=0; i<threads; ++i)
+            {
+                Arena3D *a = new Arena3D();
+                if (a == NULL)
+                    return STATUS_NO_MEM;
+                else if (!vArenas.add(a))
+                {
+                    delete a;
+                    return STATUS_NO_MEM;
+                }
+            }
+
+            return STATUS_OK;
+        }
+
+        void RayTrace3D::destroy_arenas()
+        {
+            for (size_t i=0, n=vArenas.size(); i<n; ++i)
+            {
+                Arena3D *a = vArenas.uget(i);
+                if (a != NULL)
+                    delete a;
+            }
+            vArenas.flush();
+        }
+
+        status_t RayTrace3D::publish_checkpoint(size_t checkpoint)
+        {
+            if (pCheckpoint == NULL)
+                return STATUS_OK;
+
+            // Publish partial normalized response and then restore the
+            // original energy levels to continue accumulation
+            float gain      = ((bNormalize) && (!is_sharded())) ? normalize_output() : 1.0f;
+            status_t res    = pCheckpoint(checkpoint, nPassLimit, pCheckpointData);
+            if (gain != 1.0f)
+                scale_output(1.0f / gain);
+
+            return res;
+        }
+
+        status_t RayTrace3D::do_process(size_t threads, float initial)
+        {
+            status_t res = STATUS_OK;
+            bCancelled   = false;
+            bFailed      = false;
+
+            // Get time of execution start
+    #ifdef LSP_TRACE
+            struct timespec tstart;
+            clock_gettime(CLOCK_REALTIME, &tstart);
+    #endif
+
+            // Setup passes for progressive mode, the last pass is not limited
+            nPass           = 0;
+            nPasses         = vCheckpoints.size() + 1;
+            nPassLimit      = (nPasses > 1) ? *(vCheckpoints.uget(0)) : -1;
+            fPruneThresh    = estimate_prune_threshold();
+
+            // Reset statistics
+            clear_stats(&sStats);
+            vQueueHistory.clear();
+            vThreadStats.clear();
+            size_t nstats   = lsp_max(threads, size_t(1));
+            stats_t *ts     = vThreadStats.append_n(nstats);
+            if (ts == NULL)
+                return STATUS_NO_MEM;
+            for (size_t i=0; i<nstats; ++i)
+                clear_stats(&ts[i]);
+
+            // Create memory arenas for all threads
+            res = create_arenas(threads);
+            if (res != STATUS_OK)
+                return res;
+
+            // Create main thread
+            TaskThread *root = new TaskThread(this, 0);
+            if (root == NULL)
+            {
+                destroy_arenas();
+                return STATUS_NO_MEM;
+            }
+
+            // Launch prepare_main_loop in root thread's context
+            res    = root->prepare_main_loop(initial);
+            if (res != STATUS_OK)
+            {
+                delete root;
+                destroy_tasks(&vTasks);
+                destroy_arenas();
+                return res;
+            }
+
+            // Perform all passes
+            while (true)
+            {
+                res     = run_pass(root, threads, &sStats);
+                if (res != STATUS_OK)
+                    break;
+                if ((++nPass) >= nPasses)
+                    break;
+
+                // Publish the checkpoint and switch to the next pass
+                res     = publish_checkpoint(nPass - 1);
+                if (res != STATUS_OK)
+                    break;
+                else if (bCancelled)
+                {
+                    res     = STATUS_CANCELLED;
+                    break;
+                }
+
+                nPassLimit  = (nPass < vCheckpoints.size()) ? *(vCheckpoints.uget(nPass)) : -1;
+            }
+
+            nPass           = nPasses - 1;
+            nPassLimit      = -1;
+            delete root;
+
+            // Collect peak memory usage of contexts
+            for (size_t i=0, n=lsp_min(vArenas.size(), vThreadStats.size()); i<n; ++i)
+            {
+                size_t peak                         = vArenas.uget(i)->peak();
+                vThreadStats.uget(i)->memory_peak   = peak;
+                sStats.memory_peak                 += peak;
+            }
+
             // Dump overall statistics
             if (res != STATUS_BREAK_POINT)
             {
@@ -1661,17 +3266,18 @@ namespace lsp
                 double etime = double(tend.tv_sec - tstart.tv_sec) + double(tend.tv_nsec - tend.tv_nsec) * 1e-6;
     #endif
 
-                dump_stats("Overall statistics", &overall);
+                dump_stats("Overall statistics", &sStats);
                 lsp_trace("Overall execution time:      %f s", etime);
             }
 
-            // Destroy all tasks
+            // Destroy all tasks, after that no chunks are owned by contexts
             destroy_tasks(&vTasks);
+            destroy_arenas();
             if (res != STATUS_OK)
                 return res;
 
-            // Normalize output
-            if (bNormalize)
+            // Normalize output, the output of the shard is normalized after the merge
+            if ((bNormalize) && (!is_sharded()))
                 normalize_output();
 
             float prg   = float(nProgressPoints) / float(nProgressMax);
@@ -1681,6 +3287,89 @@ namespace lsp
             return report_progress(prg);
         }
 
+        void RayTrace3D::get_stats(stats_t *dst)
+        {
+            *dst    = sStats;
+
+            // Add statistics of running threads
+            for (size_t i=0, n=vThreads.size(); i<n; ++i)
+            {
+                TaskThread *t = vThreads.uget(i);
+                if (t != NULL)
+                    merge_stats(dst, t->get_stats());
+            }
+        }
+
+        template <class T>
+            static inline void add_array(memory_report_t *r, const lltl::darray<T> *list)
+            {
+                memory::add(r, list->capacity() * sizeof(T), list->size() * sizeof(T));
+            }
+
+        template <class T>
+            static inline void add_array(memory_report_t *r, const lltl::parray<T> *list)
+            {
+                memory::add(r, list->capacity() * sizeof(T *), list->size() * sizeof(T *));
+            }
+
+        void RayTrace3D::memory_usage(memory_report_t *r) const
+        {
+            add_array(r, &vMaterials);
+            add_array(r, &vBands);
+            add_array(r, &vLodError);
+            add_array(r, &vSources);
+            add_array(r, &vCheckpoints);
+            add_array(r, &vCaptureTree);
+            add_array(r, &vCaptureIndex);
+            add_array(r, &vThreadStats);
+            add_array(r, &vQueueHistory);
+            add_array(r, &vShardTasks);
+
+            add_array(r, &vCaptures);
+            for (size_t i=0, n=vCaptures.size(); i<n; ++i)
+            {
+                const capture_t *cap = vCaptures.uget(i);
+                if (cap == NULL)
+                    continue;
+                memory::add(r, sizeof(capture_t), sizeof(capture_t));
+                add_array(r, &cap->mesh);
+                add_array(r, &cap->bindings);
+            }
+
+            // The prepared scene is kept between process() calls
+            add_array(r, &vPrepared);
+            for (size_t i=0, n=vPrepared.size(); i<n; ++i)
+            {
+                const rt_object_t *obj = vPrepared.uget(i);
+                if (obj == NULL)
+                    continue;
+                memory::add(r, sizeof(rt_object_t), sizeof(rt_object_t));
+                add_array(r, &obj->mesh);
+                add_array(r, &obj->plan);
+                add_array(r, &obj->bvh.nodes);
+            }
+
+            // The chunks cached by arenas are reserved for contexts of further passes
+            for (size_t i=0, n=vArenas.size(); i<n; ++i)
+            {
+                const Arena3D *arena = vArenas.uget(i);
+                if (arena != NULL)
+                    memory::add(r, arena->used() + arena->cached(), arena->used());
+            }
+        }
+
+        status_t RayTrace3D::get_thread_stats(stats_t *dst, size_t index)
+        {
+            if (dst == NULL)
+                return STATUS_BAD_ARGUMENTS;
+            stats_t *ts = vThreadStats.get(index);
+            if (ts == NULL)
+                return STATUS_INVALID_VALUE;
+
+            *dst    = *ts;
+            return STATUS_OK;
+        }
+
         status_t RayTrace3D::process(size_t threads, float initial)
         {
             // We need to initialize DSP context for processing
@@ -1714,10 +3403,9 @@ namespace lsp
             return false;
         }
 
-        void RayTrace3D::normalize_output()
+        float RayTrace3D::normalize_output()
         {
             float max_gain = 0.0f;
-            lltl::darray<sample_t> plan;
 
             // Estimate the maximum output gain for each capture's binding
             for (size_t i=0; i<vCaptures.size(); ++i)
@@ -1738,10 +3426,16 @@ namespace lsp
 
             // Now we know the maximum gain
             if (max_gain == 0.0f)
-                return;
+                return 1.0f;
             max_gain = 1.0f / max_gain; // Now it's a norming factor
 
             // Perform the gain adjustment
+            scale_output(max_gain);
+            return max_gain;
+        }
+
+        void RayTrace3D::scale_output(float gain)
+        {
             for (size_t i=0; i<vCaptures.size(); ++i)
             {
                 capture_t *cap = vCaptures.uget(i);
@@ -1752,55 +3446,14 @@ namespace lsp
                         continue;
 
                     // Apply the norming factor
-                    dsp::mul_k2(s->sample->getBuffer(s->channel), max_gain, s->sample->length());
+                    dsp::mul_k2(s->sample->getBuffer(s->channel), gain, s->sample->length());
                 }
             }
         }
 
         bool RayTrace3D::check_bound_box(const dsp::bound_box3d_t *bbox, const rt::view_t *view)
         {
-            const dsp::vector3d_t *pl;
-            dsp::raw_triangle_t buf1[16], buf2[16], *in, *out;
-            size_t nin, nout;
-
-            // Cull each triangle of bounding box with four scissor planes
-            for (size_t i=0, m = sizeof(bbox_map)/sizeof(size_t); i < m; )
-            {
-                // Initialize input
-                in          = buf1;
-                out         = buf2;
-                nin         = 1;
-
-                in->v[0]    = bbox->p[bbox_map[i++]];
-                in->v[1]    = bbox->p[bbox_map[i++]];
-                in->v[2]    = bbox->p[bbox_map[i++]];
-                pl          = view->pl;
-
-                // Cull triangle with planes
-                for (size_t j=0; j<4; ++j, ++pl)
-                {
-                    // Reset counters
-                    nout    = 0;
-                    for (size_t k=0; k < nin; ++k, ++in)
-                        dsp::cull_triangle_raw(out, &nout, pl, in);
-
-                    // Interrupt cycle if there is no data to process
-                    if (!nout)
-                        break;
-
-                    // Update state
-                    nin     = nout;
-                    if (j & 1)
-                        in = buf1, out = buf2;
-                    else
-                        in = buf2, out = buf1;
-                }
-
-                if (nout)
-                    break;
-            }
-
-            return nout;
+            return rt::check_bound_box(bbox, view);
         }
 
     } // namespace dspu
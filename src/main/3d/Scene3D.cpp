@@ -21,9 +21,14 @@
 
 #include <lsp-plug.in/dsp-units/3d/Scene3D.h>
 #include <lsp-plug.in/io/InFileStream.h>
+#include <lsp-plug.in/io/InMemoryStream.h>
 #include <lsp-plug.in/io/InSequence.h>
+#include <lsp-plug.in/io/OutFileStream.h>
+#include <lsp-plug.in/stdlib/string.h>
 
 #include <private/3d/scene/obj.h>
+#include <private/3d/scene/obj_chunks.h>
+#include <private/3d/scene/bin.h>
 
 namespace lsp
 {
@@ -504,6 +509,364 @@ namespace lsp
             return res;
         }
 
+        status_t Scene3D::load_parallel(const char *path, size_t threads)
+        {
+            io::Path tmp;
+            status_t res = tmp.set(path);
+            return (res == STATUS_OK) ? load_parallel(&tmp, threads) : res;
+        }
+
+        status_t Scene3D::load_parallel(const LSPString *path, size_t threads)
+        {
+            io::Path tmp;
+            status_t res = tmp.set(path);
+            return (res == STATUS_OK) ? load_parallel(&tmp, threads) : res;
+        }
+
+        status_t Scene3D::load_parallel(const io::Path *path, size_t threads)
+        {
+            mapped_file_t f;
+            status_t res = map_file(&f, path);
+            if (res != STATUS_OK)
+                return res;
+
+            res = load_parallel(f.data, f.size, threads);
+            unmap_file(&f);
+            return res;
+        }
+
+        status_t Scene3D::load_parallel(const void *data, size_t size, size_t threads)
+        {
+            if (data == NULL)
+                return STATUS_BAD_ARGUMENTS;
+
+            Scene3D tmp;
+            status_t res = load_scene_from_obj_chunks(&tmp, reinterpret_cast<const char *>(data), size, threads);
+            if (res == STATUS_UNSUPPORTED_FORMAT)
+            {
+                // Fall back to the sequential parser
+                tmp.destroy();
+                io::InMemoryStream is(data, size);
+                res = load_scene_from_obj(&tmp, &is, "UTF-8");
+            }
+
+            if (res == STATUS_OK)
+                tmp.swap(this);
+            return res;
+        }
+
+        status_t Scene3D::load_binary(const char *path)
+        {
+            io::Path tmp;
+            status_t res = tmp.set(path);
+            return (res == STATUS_OK) ? load_binary(&tmp) : res;
+        }
+
+        status_t Scene3D::load_binary(const LSPString *path)
+        {
+            io::Path tmp;
+            status_t res = tmp.set(path);
+            return (res == STATUS_OK) ? load_binary(&tmp) : res;
+        }
+
+        status_t Scene3D::load_binary(const io::Path *path)
+        {
+            mapped_file_t f;
+            status_t res = map_file(&f, path);
+            if (res != STATUS_OK)
+                return res;
+
+            res = load_binary(f.data, f.size);
+            unmap_file(&f);
+            return res;
+        }
+
+        status_t Scene3D::load_binary(const void *data, size_t size)
+        {
+            if (data == NULL)
+                return STATUS_BAD_ARGUMENTS;
+
+            Scene3D tmp;
+            status_t res = tmp.load_binary_internal(reinterpret_cast<const uint8_t *>(data), size);
+            if (res == STATUS_OK)
+                tmp.swap(this);
+            return res;
+        }
+
+        status_t Scene3D::load_binary_internal(const uint8_t *data, size_t size)
+        {
+            const uint8_t *tail = &data[size];
+
+            // Validate header
+            if (size < sizeof(bin_scene_header_t))
+                return STATUS_BAD_FORMAT;
+            const bin_scene_header_t *hdr = reinterpret_cast<const bin_scene_header_t *>(data);
+            if ((memcmp(hdr->signature, bin_scene_signature, sizeof(hdr->signature)) != 0) ||
+                (hdr->version != BIN_SCENE_VERSION) ||
+                (hdr->byte_order != BIN_SCENE_BYTE_ORDER))
+                return STATUS_BAD_FORMAT;
+            data       += sizeof(bin_scene_header_t);
+
+            // Check the size of arrays
+            size_t bytes    = hdr->vertexes * sizeof(bin_scene_vector_t) +
+                              hdr->normals * sizeof(bin_scene_vector_t) +
+                              hdr->edges * sizeof(bin_scene_edge_t);
+            if (size_t(tail - data) < bytes)
+                return STATUS_CORRUPTED;
+
+            // Adopt vertexes
+            const bin_scene_vector_t *sv = reinterpret_cast<const bin_scene_vector_t *>(data);
+            for (size_t i=0; i<hdr->vertexes; ++i, ++sv)
+            {
+                obj_vertex_t *v = vVertexes.alloc();
+                if (v == NULL)
+                    return STATUS_NO_MEM;
+                v->x        = sv->v[0];
+                v->y        = sv->v[1];
+                v->z        = sv->v[2];
+                v->w        = sv->v[3];
+                v->id       = i;
+                v->ve       = NULL;
+                v->ptag     = NULL;
+                v->itag     = -1;
+            }
+
+            // Adopt normals
+            for (size_t i=0; i<hdr->normals; ++i, ++sv)
+            {
+                obj_normal_t *n = vNormals.alloc();
+                if (n == NULL)
+                    return STATUS_NO_MEM;
+                n->dx       = sv->v[0];
+                n->dy       = sv->v[1];
+                n->dz       = sv->v[2];
+                n->dw       = sv->v[3];
+                n->id       = i;
+                n->ptag     = NULL;
+                n->itag     = -1;
+            }
+
+            // Adopt edges and link them to vertexes
+            const bin_scene_edge_t *se = reinterpret_cast<const bin_scene_edge_t *>(sv);
+            for (size_t i=0; i<hdr->edges; ++i, ++se)
+            {
+                if ((se->v[0] >= hdr->vertexes) || (se->v[1] >= hdr->vertexes))
+                    return STATUS_CORRUPTED;
+
+                obj_edge_t *e   = vEdges.alloc();
+                if (e == NULL)
+                    return STATUS_NO_MEM;
+
+                obj_vertex_t *v0    = vVertexes.get(se->v[0]);
+                obj_vertex_t *v1    = vVertexes.get(se->v[1]);
+
+                e->id       = i;
+                e->v[0]     = v0;
+                e->v[1]     = v1;
+                e->vlnk[0]  = v0->ve;
+                e->vlnk[1]  = v1->ve;
+                e->ptag     = NULL;
+                e->itag     = -1;
+
+                v0->ve      = e;
+                v1->ve      = e;
+            }
+            data        = reinterpret_cast<const uint8_t *>(se);
+
+            // Adopt objects
+            for (size_t i=0; i<hdr->objects; ++i)
+            {
+                if (size_t(tail - data) < sizeof(bin_scene_object_t))
+                    return STATUS_CORRUPTED;
+                const bin_scene_object_t *so = reinterpret_cast<const bin_scene_object_t *>(data);
+                data       += sizeof(bin_scene_object_t);
+
+                size_t name_bytes   = (so->name_bytes + 3) & (~size_t(3));
+                if (size_t(tail - data) < (name_bytes + so->triangles * sizeof(bin_scene_triangle_t)))
+                    return STATUS_CORRUPTED;
+
+                // Create object
+                LSPString name;
+                if (!name.set_utf8(reinterpret_cast<const char *>(data), so->name_bytes))
+                    return STATUS_NO_MEM;
+                data       += name_bytes;
+
+                Object3D *obj   = add_object(&name);
+                if (obj == NULL)
+                    return STATUS_NO_MEM;
+                obj->set_visible(so->visible);
+                memcpy(obj->matrix()->m, so->matrix, sizeof(so->matrix));
+
+                // Adopt triangles
+                const bin_scene_triangle_t *st = reinterpret_cast<const bin_scene_triangle_t *>(data);
+                for (size_t j=0; j<so->triangles; ++j, ++st)
+                {
+                    obj_triangle_t *t   = vTriangles.alloc();
+                    if (t == NULL)
+                        return STATUS_NO_MEM;
+
+                    t->id       = vTriangles.size() - 1;
+                    t->face     = st->face;
+                    t->ptag     = NULL;
+                    t->itag     = -1;
+                    for (size_t k=0; k<3; ++k)
+                    {
+                        if ((st->v[k] >= hdr->vertexes) || (st->e[k] >= hdr->edges) || (st->n[k] >= hdr->normals))
+                            return STATUS_CORRUPTED;
+                        t->v[k]     = vVertexes.get(st->v[k]);
+                        t->e[k]     = vEdges.get(st->e[k]);
+                        t->n[k]     = vNormals.get(st->n[k]);
+                    }
+
+                    if (!obj->vTriangles.add(t))
+                        return STATUS_NO_MEM;
+                }
+                data        = reinterpret_cast<const uint8_t *>(st);
+
+                obj->calc_bound_box();
+                obj->post_load();
+            }
+
+            return STATUS_OK;
+        }
+
+        status_t Scene3D::save_binary(const char *path)
+        {
+            io::Path tmp;
+            status_t res = tmp.set(path);
+            return (res == STATUS_OK) ? save_binary(&tmp) : res;
+        }
+
+        status_t Scene3D::save_binary(const LSPString *path)
+        {
+            io::Path tmp;
+            status_t res = tmp.set(path);
+            return (res == STATUS_OK) ? save_binary(&tmp) : res;
+        }
+
+        status_t Scene3D::save_binary(const io::Path *path)
+        {
+            status_t res;
+            io::OutFileStream ofs;
+            if ((res = ofs.open(path, io::File::FM_WRITE_NEW)) != STATUS_OK)
+                return res;
+
+            res = save_binary(&ofs);
+            status_t res2 = ofs.close();
+
+            return (res == STATUS_OK) ? res2 : res;
+        }
+
+        static status_t bin_write(io::IOutStream *os, const void *buf, size_t count)
+        {
+            ssize_t n = os->write(buf, count);
+            if (n < 0)
+                return status_t(-n);
+            return (size_t(n) == count) ? STATUS_OK : STATUS_IO_ERROR;
+        }
+
+        status_t Scene3D::save_binary(io::IOutStream *os)
+        {
+            status_t res;
+            size_t normals = vNormals.size() + vXNormals.size();
+
+            // Emit header
+            bin_scene_header_t hdr;
+            memcpy(hdr.signature, bin_scene_signature, sizeof(hdr.signature));
+            hdr.version     = BIN_SCENE_VERSION;
+            hdr.byte_order  = BIN_SCENE_BYTE_ORDER;
+            hdr.vertexes    = vVertexes.size();
+            hdr.normals     = normals;
+            hdr.edges       = vEdges.size();
+            hdr.triangles   = vTriangles.size();
+            hdr.objects     = vObjects.size();
+            hdr.reserved    = 0;
+            if ((res = bin_write(os, &hdr, sizeof(hdr))) != STATUS_OK)
+                return res;
+
+            // Emit vertexes
+            for (size_t i=0, n=vVertexes.size(); i<n; ++i)
+            {
+                const obj_vertex_t *v   = vVertexes.get(i);
+                bin_scene_vector_t bv;
+                bv.v[0]     = v->x;
+                bv.v[1]     = v->y;
+                bv.v[2]     = v->z;
+                bv.v[3]     = v->w;
+                if ((res = bin_write(os, &bv, sizeof(bv))) != STATUS_OK)
+                    return res;
+            }
+
+            // Emit normals, extra normals follow regular normals,
+            // use integer tags to store the index of normal in the output file
+            for (size_t i=0; i<normals; ++i)
+            {
+                obj_normal_t *v         = normal(i);
+                v->itag     = i;
+                bin_scene_vector_t bv;
+                bv.v[0]     = v->dx;
+                bv.v[1]     = v->dy;
+                bv.v[2]     = v->dz;
+                bv.v[3]     = v->dw;
+                if ((res = bin_write(os, &bv, sizeof(bv))) != STATUS_OK)
+                    return res;
+            }
+
+            // Emit edges
+            for (size_t i=0, n=vEdges.size(); i<n; ++i)
+            {
+                const obj_edge_t *e     = vEdges.get(i);
+                bin_scene_edge_t be;
+                be.v[0]     = e->v[0]->id;
+                be.v[1]     = e->v[1]->id;
+                if ((res = bin_write(os, &be, sizeof(be))) != STATUS_OK)
+                    return res;
+            }
+
+            // Emit objects
+            for (size_t i=0, n=vObjects.size(); i<n; ++i)
+            {
+                Object3D *obj       = vObjects.uget(i);
+                const char *name    = obj->get_name();
+                if (name == NULL)
+                    return STATUS_NO_MEM;
+
+                bin_scene_object_t bo;
+                bo.name_bytes   = strlen(name);
+                bo.triangles    = obj->num_triangles();
+                bo.visible      = (obj->is_visible()) ? 1 : 0;
+                bo.reserved     = 0;
+                memcpy(bo.matrix, obj->matrix()->m, sizeof(bo.matrix));
+                if ((res = bin_write(os, &bo, sizeof(bo))) != STATUS_OK)
+                    return res;
+
+                // Emit name padded to 4 bytes
+                static const char pad[4] = { 0, 0, 0, 0 };
+                if ((res = bin_write(os, name, bo.name_bytes)) != STATUS_OK)
+                    return res;
+                if ((res = bin_write(os, pad, (4 - (bo.name_bytes & 3)) & 3)) != STATUS_OK)
+                    return res;
+
+                // Emit triangles
+                for (size_t j=0; j<bo.triangles; ++j)
+                {
+                    const obj_triangle_t *t = obj->triangle(j);
+                    bin_scene_triangle_t bt;
+                    bt.face     = t->face;
+                    for (size_t k=0; k<3; ++k)
+                    {
+                        bt.v[k]     = t->v[k]->id;
+                        bt.e[k]     = t->e[k]->id;
+                        bt.n[k]     = t->n[k]->itag;
+                    }
+                    if ((res = bin_write(os, &bt, sizeof(bt))) != STATUS_OK)
+                        return res;
+                }
+            }
+
+            return STATUS_OK;
+        }
+
         status_t Scene3D::load_internal(io::IInStream *is, size_t flags, const char *charset)
         {
             status_t res, res2;
@@ -20,6 +20,7 @@
  */
 
 #include <lsp-plug.in/dsp-units/3d/bsp/context.h>
+#include <lsp-plug.in/ipc/Thread.h>
 
 #define RT_FOREACH(type, var, collection) \
     for (size_t __ci=0,__ne=collection.size(), __nc=collection.chunks(); (__ci<__nc) && (__ne>0); ++__ci) \
@@ -41,11 +42,52 @@ namespace lsp
     {
         namespace bsp
         {
+            class context_t::BuildThread: public ipc::Thread
+            {
+                private:
+                    bsp::context_t                 *ctx;
+                    lltl::parray<bsp::node_t>       queue;
+                    size_t                          load;
+                    status_t                        res;
+
+                public:
+                    explicit BuildThread(bsp::context_t *ctx)
+                    {
+                        this->ctx       = ctx;
+                        load            = 0;
+                        res             = STATUS_OK;
+                    }
+
+                    virtual ~BuildThread()
+                    {
+                        queue.flush();
+                    }
+
+                public:
+                    inline size_t       weight() const  { return load; }
+                    inline status_t     result() const  { return res; }
+
+                    bool add(bsp::node_t *task, size_t weight)
+                    {
+                        load           += weight;
+                        return queue.add(task);
+                    }
+
+                    virtual status_t run()
+                    {
+                        res             = ctx->build_subtrees(&queue);
+                        return res;
+                    }
+            };
+
             context_t::context_t():
                 node(256),
                 triangle(1024)
             {
                 root    = NULL;
+                dirty   = false;
+                version = 0;
+                mesh    = NULL;
             }
 
             context_t::~context_t()
@@ -53,42 +95,165 @@ namespace lsp
                 flush();
             }
 
+            void context_t::destroy_subtrees()
+            {
+                for (size_t i=0, n=subtrees.size(); i<n; ++i)
+                {
+                    bsp::context_t *st  = subtrees.uget(i);
+                    if (st != NULL)
+                        delete st;
+                }
+                subtrees.flush();
+            }
+
             void context_t::clear()
             {
                 root    = NULL;
+                dirty   = false;
+                ++version;
+                destroy_subtrees();
                 node.clear();
                 triangle.clear();
+                source.clear();
+                cache.clear();
+                objects.clear();
+                cull.clear();
             }
 
             void context_t::flush()
             {
                 root    = NULL;
+                dirty   = false;
+                ++version;
+                destroy_subtrees();
                 node.flush();
                 triangle.flush();
+                source.flush();
+                cache.flush();
+                objects.flush();
+                cull.flush();
             }
 
-            status_t context_t::add_object(Object3D *obj, const dsp::matrix3d_t *transform, const dsp::color3d_t *col)
+            void context_t::transform_object(const bsp::object_t *obj)
             {
-                for (size_t i=0, n=obj->num_triangles(); i<n; ++i)
-                {
-                    obj_triangle_t *st  = obj->triangle(i);
-                    bsp::triangle_t *dt = triangle.alloc();
-                    if (dt == NULL)
-                        return STATUS_NO_MEM;
+                const dsp::raw_triangle_t *st   = source.uget(obj->first);
+                bsp::triangle_t *dt             = cache.uget(obj->first);
 
-                    dsp::apply_matrix3d_mp2(&dt->v[0], st->v[0], transform);
-                    dsp::apply_matrix3d_mp2(&dt->v[1], st->v[1], transform);
-                    dsp::apply_matrix3d_mp2(&dt->v[2], st->v[2], transform);
+                for (size_t i=0; i<obj->count; ++i, ++st, ++dt)
+                {
+                    dsp::apply_matrix3d_mp2(&dt->v[0], &st->v[0], &obj->matrix);
+                    dsp::apply_matrix3d_mp2(&dt->v[1], &st->v[1], &obj->matrix);
+                    dsp::apply_matrix3d_mp2(&dt->v[2], &st->v[2], &obj->matrix);
                     dsp::calc_normal3d_pv(&dt->n[0], dt->v);
                     dt->n[1]            = dt->n[0];
                     dt->n[2]            = dt->n[0];
+                    dt->c               = obj->color;
+                    dt->next            = NULL;
+                }
+            }
+
+            status_t context_t::add_source(size_t count, const dsp::matrix3d_t *transform, const dsp::color3d_t *color)
+            {
+                // The last 'count' source triangles belong to the new object
+                bsp::object_t *obj  = objects.add();
+                if (obj == NULL)
+                    return STATUS_NO_MEM;
+                obj->first          = source.size() - count;
+                obj->count          = count;
+                obj->matrix         = *transform;
+                obj->color          = *color;
+
+                if (cache.append_n(count) == NULL)
+                    return STATUS_NO_MEM;
+                transform_object(obj);
 
-                    dt->c               = *col;
+                // Emit transformed triangles for the build
+                const bsp::triangle_t *st   = cache.uget(obj->first);
+                for (size_t i=0; i<count; ++i, ++st)
+                {
+                    bsp::triangle_t *dt = triangle.alloc(st);
+                    if (dt == NULL)
+                        return STATUS_NO_MEM;
                 }
+                dirty               = true;
+
+                return STATUS_OK;
+            }
+
+            bool context_t::is_culled(const dsp::point3d_t *c, float r) const
+            {
+                for (size_t i=0, n=cull.size(); i<n; ++i)
+                {
+                    const dsp::vector3d_t *pl = cull.uget(i);
+                    float d = pl->dx * c->x + pl->dy * c->y + pl->dz * c->z + pl->dw;
+                    if (d < -r)
+                        return true;
+                }
+
+                return false;
+            }
+
+            status_t context_t::set_cull_planes(const dsp::vector3d_t *pl, size_t n)
+            {
+                cull.clear();
+                if (n <= 0)
+                    return STATUS_OK;
+
+                dsp::vector3d_t *dp = cull.append_n(n);
+                if (dp == NULL)
+                    return STATUS_NO_MEM;
+                for (size_t i=0; i<n; ++i)
+                    dp[i]               = pl[i];
 
                 return STATUS_OK;
             }
 
+            void context_t::clear_cull_planes()
+            {
+                cull.clear();
+            }
+
+            status_t context_t::add_object(Object3D *obj, const dsp::color3d_t *col)
+            {
+                // Reject the whole object by the cached world-space bounding sphere
+                if ((cull.size() > 0) && (is_culled(obj->world_center(), obj->world_radius())))
+                {
+                    bsp::object_t *bo   = objects.add();
+                    if (bo == NULL)
+                        return STATUS_NO_MEM;
+                    bo->first           = source.size();
+                    bo->count           = 0;
+                    bo->matrix          = *(obj->matrix());
+                    bo->color           = *col;
+                    return STATUS_OK;
+                }
+
+                return add_object(obj, obj->matrix(), col);
+            }
+
+            status_t context_t::add_object(Object3D *obj, const dsp::matrix3d_t *transform, const dsp::color3d_t *col)
+            {
+                const obj_packed_t *pk  = obj->packed();
+                if (pk == NULL)
+                    return STATUS_NO_MEM;
+
+                size_t n                = pk->face.size();
+                dsp::raw_triangle_t *dt = source.append_n(n);
+                if ((dt == NULL) && (n > 0))
+                    return STATUS_NO_MEM;
+
+                const dsp::point3d_t *sv = pk->vertex.array();
+                const uint32_t *vi      = pk->vindex.array();
+                for (size_t i=0; i<n; ++i, ++dt, vi += 3)
+                {
+                    dt->v[0]            = sv[vi[0]];
+                    dt->v[1]            = sv[vi[1]];
+                    dt->v[2]            = sv[vi[2]];
+                }
+
+                return add_source(n, transform, col);
+            }
+
             status_t context_t::add_triangles
             (
                 const dsp::point3d_t *v_vertices,
@@ -97,25 +262,61 @@ namespace lsp
                 const dsp::color3d_t *color
             )
             {
-                for (size_t i=0; i<n_triangles; ++i, v_vertices += 3)
+                dsp::raw_triangle_t *dt = source.append_n(n_triangles);
+                if (dt == NULL)
+                    return STATUS_NO_MEM;
+
+                for (size_t i=0; i<n_triangles; ++i, ++dt, v_vertices += 3)
                 {
-                    bsp::triangle_t *dt = triangle.alloc();
+                    dt->v[0]            = v_vertices[0];
+                    dt->v[1]            = v_vertices[1];
+                    dt->v[2]            = v_vertices[2];
+                }
+
+                return add_source(n_triangles, transform, color);
+            }
+
+            status_t context_t::set_transform(size_t id, const dsp::matrix3d_t *transform)
+            {
+                bsp::object_t *obj  = objects.get(id);
+                if (obj == NULL)
+                    return STATUS_INVALID_VALUE;
+
+                obj->matrix         = *transform;
+                transform_object(obj);
+                dirty               = true;
+
+                return STATUS_OK;
+            }
+
+            status_t context_t::rebuild_tree(size_t threads)
+            {
+                if ((!dirty) && (root != NULL))
+                    return STATUS_OK;
+
+                // Drop the previous tree and restore triangles from cache
+                root    = NULL;
+                ++version;
+                destroy_subtrees();
+                node.clear();
+                triangle.clear();
+
+                for (size_t i=0, n=cache.size(); i<n; ++i)
+                {
+                    bsp::triangle_t *dt = triangle.alloc(cache.uget(i));
                     if (dt == NULL)
                         return STATUS_NO_MEM;
-
-                    dsp::apply_matrix3d_mp2(&dt->v[0], &v_vertices[0], transform);
-                    dsp::apply_matrix3d_mp2(&dt->v[1], &v_vertices[1], transform);
-                    dsp::apply_matrix3d_mp2(&dt->v[2], &v_vertices[2], transform);
-                    dsp::calc_normal3d_pv(&dt->n[0], dt->v);
-                    dt->n[1]            = dt->n[0];
-                    dt->n[2]            = dt->n[0];
-                    dt->c               = *color;
                 }
 
-                return STATUS_OK;
+                return build_tree(threads);
             }
 
             status_t context_t::build_tree()
+            {
+                return build_tree(1);
+            }
+
+            status_t context_t::build_tree(size_t threads)
             {
                 // Build list of triangles for processing
                 bsp::triangle_t *list = NULL;
@@ -129,6 +330,7 @@ namespace lsp
 
                 // Create initial task
                 lltl::parray<bsp::node_t> queue;
+                ++version;
                 if (!(root = node.alloc()))
                     return STATUS_NO_MEM;
                 root->in    = NULL;
@@ -139,23 +341,147 @@ namespace lsp
                     return STATUS_NO_MEM;
 
                 // Do main iteration
+                status_t res = (threads > 1) ? build_parallel(&queue, threads) : build_subtrees(&queue);
+                queue.flush();
+                if (res == STATUS_OK)
+                    dirty       = false;
+
+                return res;
+            }
+
+            status_t context_t::build_subtrees(lltl::parray<bsp::node_t> *queue)
+            {
                 status_t res = STATUS_OK;
                 bsp::node_t *task;
-                while (queue.size() > 0)
+                while (queue->size() > 0)
                 {
                     // Get the task
-                    if (!queue.pop(&task))
+                    if (!queue->pop(&task))
                     {
                         res     = STATUS_CORRUPTED;
                         break;
                     }
 
                     // Process the task
-                    if ((res = split(queue, task)) != STATUS_OK)
+                    if ((res = split(*queue, task)) != STATUS_OK)
                         break;
                 }
 
-                queue.flush();
+                return res;
+            }
+
+            status_t context_t::build_parallel(lltl::parray<bsp::node_t> *queue, size_t threads)
+            {
+                // Split the top levels of the tree until there are enough independent subtrees
+                lltl::parray<bsp::node_t> next;
+                bsp::node_t *task;
+                status_t res;
+                const size_t limit = threads * BSP_SUBTREES_PER_THREAD;
+
+                while ((queue->size() > 0) && (queue->size() < limit))
+                {
+                    for (size_t i=0, n=queue->size(); i<n; ++i)
+                    {
+                        task        = queue->uget(i);
+                        if ((res = split(next, task)) != STATUS_OK)
+                            return res;
+                    }
+                    queue->swap(&next);
+                    next.clear();
+                }
+
+                if (queue->size() <= 0)
+                    return STATUS_OK;
+
+                // Create workers, each worker allocates data in it's own context
+                lltl::parray<BuildThread> workers;
+                res     = STATUS_OK;
+
+                for (size_t i=0; i<threads; ++i)
+                {
+                    bsp::context_t *st  = new bsp::context_t();
+                    if (st == NULL)
+                    {
+                        res     = STATUS_NO_MEM;
+                        break;
+                    }
+                    if (!subtrees.add(st))
+                    {
+                        delete st;
+                        res     = STATUS_NO_MEM;
+                        break;
+                    }
+
+                    BuildThread *t      = new BuildThread(st);
+                    if (t == NULL)
+                    {
+                        res     = STATUS_NO_MEM;
+                        break;
+                    }
+                    if (!workers.add(t))
+                    {
+                        delete t;
+                        res     = STATUS_NO_MEM;
+                        break;
+                    }
+                }
+
+                // Distribute subtrees between workers by the number of triangles
+                for (size_t i=0, n=queue->size(); (res == STATUS_OK) && (i<n); ++i)
+                {
+                    task                = queue->uget(i);
+                    size_t weight       = 0;
+                    for (bsp::triangle_t *ct = task->on; ct != NULL; ct = ct->next)
+                        ++weight;
+
+                    BuildThread *w      = workers.uget(0);
+                    for (size_t j=1, m=workers.size(); j<m; ++j)
+                    {
+                        BuildThread *t      = workers.uget(j);
+                        if (t->weight() < w->weight())
+                            w                   = t;
+                    }
+
+                    if (!w->add(task, weight))
+                        res                 = STATUS_NO_MEM;
+                }
+
+                // Launch workers, the first one is processed by the current thread.
+                // If the thread can not be started, the worker is processed in place
+                if (res == STATUS_OK)
+                {
+                    for (size_t i=1, n=workers.size(); i<n; ++i)
+                    {
+                        BuildThread *t      = workers.uget(i);
+                        if (t->start() != STATUS_OK)
+                            t->run();
+                    }
+                    workers.uget(0)->run();
+
+                    for (size_t i=1, n=workers.size(); i<n; ++i)
+                        workers.uget(i)->join();
+
+                    for (size_t i=0, n=workers.size(); i<n; ++i)
+                    {
+                        status_t xres       = workers.uget(i)->result();
+                        if (xres != STATUS_OK)
+                        {
+                            res                 = xres;
+                            break;
+                        }
+                    }
+                }
+
+                // Destroy workers, the memory of subtrees stays in the subtree contexts
+                for (size_t i=0, n=workers.size(); i<n; ++i)
+                {
+                    BuildThread *t      = workers.uget(i);
+                    if (t != NULL)
+                        delete t;
+                }
+                workers.flush();
+                queue->clear();
+
                 return res;
             }
 
@@ -546,6 +872,200 @@ namespace lsp
 
                 return STATUS_OK;
             }
+
+            bool context_t::count_vertices()
+            {
+                // Build the list of nodes in pre-order, children always follow the parent
+                lltl::parray<bsp::node_t> queue, list;
+                bsp::node_t *curr;
+                if (!queue.push(root))
+                    return false;
+
+                while (queue.pop(&curr))
+                {
+                    if (!list.add(curr))
+                        return false;
+                    if ((curr->in != NULL) && (!queue.push(curr->in)))
+                        return false;
+                    if ((curr->out != NULL) && (!queue.push(curr->out)))
+                        return false;
+                }
+
+                // Compute the number of vertices bottom-up
+                for (size_t i=list.size(); i > 0; )
+                {
+                    curr            = list.uget(--i);
+                    size_t n        = 0;
+                    for (bsp::triangle_t *ct=curr->on; ct != NULL; ct = ct->next)
+                        n              += 3;
+                    if (curr->in != NULL)
+                        n              += curr->in->vcount;
+                    if (curr->out != NULL)
+                        n              += curr->out->vcount;
+
+                    curr->vcount    = n;
+                    curr->side      = -1;
+                }
+
+                return true;
+            }
+
+            typedef struct mesh_task_t
+            {
+                bsp::node_t    *node;
+                size_t          offset;     // Offset of the first vertex of the subtree
+                bool            forced;     // The subtree is already marked as dirty
+            } mesh_task_t;
+
+            status_t context_t::build_mesh(bsp::vbuffer_t *dst, const dsp::point3d_t *pov)
+            {
+                dst->dirty.clear();
+
+                // Check that the buffer matches the tree, the buffer is marked as valid
+                // only if the update succeeds
+                bool forced         = (dst->owner != this) || (dst->version != version) || (mesh != dst);
+                mesh                = dst;
+                dst->owner          = NULL;
+                if (forced)
+                {
+                    dst->vertex.clear();
+                    if (root == NULL)
+                    {
+                        dst->owner          = this;
+                        dst->version        = version;
+                        return STATUS_OK;
+                    }
+
+                    if (!count_vertices())
+                        return STATUS_NO_MEM;
+                    if ((dst->vertex.append_n(root->vcount) == NULL) && (root->vcount > 0))
+                        return STATUS_NO_MEM;
+
+                    bsp::range_t *r     = dst->dirty.add();
+                    if (r == NULL)
+                        return STATUS_NO_MEM;
+                    r->first            = 0;
+                    r->count            = root->vcount;
+                }
+                else if (root == NULL)
+                {
+                    dst->owner          = this;
+                    return STATUS_OK;
+                }
+
+                // Create queue
+                lltl::darray<mesh_task_t> queue;
+                mesh_task_t *t      = queue.push();
+                if (t == NULL)
+                    return STATUS_NO_MEM;
+                t->node             = root;
+                t->offset           = 0;
+                t->forced           = forced;
+
+                mesh_task_t task;
+                view::vertex3d_t *vv = dst->vertex.array();
+                dsp::vector3d_t pl;
+
+                while (queue.pop(&task))
+                {
+                    bsp::node_t *curr   = task.node;
+                    pl                  = curr->pl;
+                    float d             = pov->x*pl.dx + pov->y*pl.dy + pov->z*pl.dz + pl.dw;
+                    ssize_t side        = (d < 0.0f) ? 1 : 0;
+                    bsp::node_t *first  = (side) ? curr->out : curr->in;
+                    bsp::node_t *last   = (side) ? curr->in : curr->out;
+                    size_t offset       = task.offset + ((first != NULL) ? first->vcount : 0);
+
+                    // The order of the subtree changes only if the viewer crosses the plane
+                    // of the node. Triangles of the node lie in the same plane, so they
+                    // change the orientation at the same time
+                    if ((!task.forced) && (curr->side != side))
+                    {
+                        // Mark the subtree as dirty, merge with the previous range if possible
+                        bsp::range_t *r     = dst->dirty.last();
+                        if ((r != NULL) && (r->first + r->count == task.offset))
+                            r->count           += curr->vcount;
+                        else
+                        {
+                            if ((r = dst->dirty.add()) == NULL)
+                                return STATUS_NO_MEM;
+                            r->first            = task.offset;
+                            r->count            = curr->vcount;
+                        }
+                        task.forced         = true;
+                    }
+
+                    if (task.forced)
+                    {
+                        curr->side          = side;
+                        view::vertex3d_t *v = &vv[offset];
+
+                        for (bsp::triangle_t *ct=curr->on; ct != NULL; ct = ct->next, v += 3)
+                        {
+                            dsp::calc_plane_pv(&pl, ct->v);
+                            d               = pov->x*pl.dx + pov->y*pl.dy + pov->z*pl.dz + pl.dw;
+
+                            if (d < 0.0f)
+                            {
+                                // Reverse order of vertex and flip normals
+                                v[0].p      = ct->v[0];
+                                v[0].c      = ct->c;
+                                dsp::flip_vector_v2(&v[0].n, &ct->n[0]);
+
+                                v[1].p      = ct->v[2];
+                                v[1].c      = ct->c;
+                                dsp::flip_vector_v2(&v[1].n, &ct->n[2]);
+
+                                v[2].p      = ct->v[1];
+                                v[2].c      = ct->c;
+                                dsp::flip_vector_v2(&v[2].n, &ct->n[1]);
+                            }
+                            else
+                            {
+                                // Emit as usual
+                                v[0].p      = ct->v[0];
+                                v[0].c      = ct->c;
+                                v[0].n      = ct->n[0];
+
+                                v[1].p      = ct->v[1];
+                                v[1].c      = ct->c;
+                                v[1].n      = ct->n[1];
+
+                                v[2].p      = ct->v[2];
+                                v[2].c      = ct->c;
+                                v[2].n      = ct->n[2];
+                            }
+                        }
+
+                        offset              = size_t(v - vv);
+                    }
+                    else
+                        offset              = task.offset + curr->vcount - ((last != NULL) ? last->vcount : 0);
+
+                    // Push the last subtree first to process subtrees in the ascending order of offsets
+                    if (last != NULL)
+                    {
+                        if ((t = queue.push()) == NULL)
+                            return STATUS_NO_MEM;
+                        t->node             = last;
+                        t->offset           = offset;
+                        t->forced           = task.forced;
+                    }
+                    if (first != NULL)
+                    {
+                        if ((t = queue.push()) == NULL)
+                            return STATUS_NO_MEM;
+                        t->node             = first;
+                        t->offset           = task.offset;
+                        t->forced           = task.forced;
+                    }
+                }
+
+                dst->owner          = this;
+                dst->version        = version;
+
+                return STATUS_OK;
+            }
         } // namespace bsp
     } // namespace dspu
 } // namespace lsp
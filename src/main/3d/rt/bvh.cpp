@@ -0,0 +1,250 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/dsp-units/3d/rt/bvh.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        namespace rt
+        {
+            static const size_t bbox_map[] =
+            {
+                0, 1, 2,
+                0, 2, 3,
+                6, 5, 4,
+                6, 4, 7,
+                1, 0, 4,
+                1, 4, 5,
+                3, 2, 6,
+                3, 6, 7,
+                1, 5, 2,
+                2, 5, 6,
+                0, 3, 4,
+                3, 7, 4
+            };
+
+            static inline float centroid(const rtx::triangle_t *t, size_t axis)
+            {
+                switch (axis)
+                {
+                    case 0:     return t->v[0].x + t->v[1].x + t->v[2].x;
+                    case 1:     return t->v[0].y + t->v[1].y + t->v[2].y;
+                    default:    break;
+                }
+                return t->v[0].z + t->v[1].z + t->v[2].z;
+            }
+
+            static inline void swap_triangles(rtx::triangle_t *a, rtx::triangle_t *b)
+            {
+                rtx::triangle_t tmp  = *a;
+                *a                  = *b;
+                *b                  = tmp;
+            }
+
+            bool check_bound_box(const dsp::bound_box3d_t *bbox, const rt::view_t *view)
+            {
+                const dsp::vector3d_t *pl;
+                dsp::raw_triangle_t buf1[16], buf2[16], *in, *out;
+                size_t nin, nout;
+
+                // Cull each triangle of bounding box with four scissor planes
+                for (size_t i=0, m = sizeof(bbox_map)/sizeof(size_t); i < m; )
+                {
+                    // Initialize input
+                    in          = buf1;
+                    out         = buf2;
+                    nin         = 1;
+
+                    in->v[0]    = bbox->p[bbox_map[i++]];
+                    in->v[1]    = bbox->p[bbox_map[i++]];
+                    in->v[2]    = bbox->p[bbox_map[i++]];
+                    pl          = view->pl;
+
+                    // Cull triangle with planes
+                    for (size_t j=0; j<4; ++j, ++pl)
+                    {
+                        // Reset counters
+                        nout    = 0;
+                        for (size_t k=0; k < nin; ++k, ++in)
+                            dsp::cull_triangle_raw(out, &nout, pl, in);
+
+                        // Interrupt cycle if there is no data to process
+                        if (!nout)
+                            break;
+
+                        // Update state
+                        nin     = nout;
+                        if (j & 1)
+                            in = buf1, out = buf2;
+                        else
+                            in = buf2, out = buf1;
+                    }
+
+                    if (nout)
+                        break;
+                }
+
+                return nout;
+            }
+
+            bvh_t::bvh_t()
+            {
+            }
+
+            bvh_t::~bvh_t()
+            {
+                nodes.flush();
+            }
+
+            void bvh_t::calc_bound_box(dsp::bound_box3d_t *bbox, const rtx::triangle_t *vt, size_t count)
+            {
+                float x0 = vt->v[0].x, y0 = vt->v[0].y, z0 = vt->v[0].z;
+                float x1 = x0, y1 = y0, z1 = z0;
+
+                for (size_t i=0; i<count; ++i, ++vt)
+                {
+                    for (size_t j=0; j<3; ++j)
+                    {
+                        const dsp::point3d_t *p = &vt->v[j];
+                        x0  = lsp_min(x0, p->x);
+                        y0  = lsp_min(y0, p->y);
+                        z0  = lsp_min(z0, p->z);
+                        x1  = lsp_max(x1, p->x);
+                        y1  = lsp_max(y1, p->y);
+                        z1  = lsp_max(z1, p->z);
+                    }
+                }
+
+                // Use the same layout of points as Object3D does
+                dsp::init_point_xyz(&bbox->p[0], x0, y1, z1);
+                dsp::init_point_xyz(&bbox->p[1], x0, y0, z1);
+                dsp::init_point_xyz(&bbox->p[2], x1, y0, z1);
+                dsp::init_point_xyz(&bbox->p[3], x1, y1, z1);
+                dsp::init_point_xyz(&bbox->p[4], x0, y1, z0);
+                dsp::init_point_xyz(&bbox->p[5], x0, y0, z0);
+                dsp::init_point_xyz(&bbox->p[6], x1, y0, z0);
+                dsp::init_point_xyz(&bbox->p[7], x1, y1, z0);
+            }
+
+            void bvh_t::select(rtx::triangle_t *vt, size_t count, size_t k, size_t axis)
+            {
+                // Quick select: place k-th element by centroid order at position k
+                size_t lo = 0, hi = count - 1;
+                while (lo < hi)
+                {
+                    float pivot = centroid(&vt[(lo + hi) >> 1], axis);
+                    size_t i = lo, j = hi;
+
+                    while (i <= j)
+                    {
+                        while (centroid(&vt[i], axis) < pivot)
+                            ++i;
+                        while (centroid(&vt[j], axis) > pivot)
+                            --j;
+                        if (i <= j)
+                        {
+                            if (i != j)
+                                swap_triangles(&vt[i], &vt[j]);
+                            ++i;
+                            if (j == 0)
+                                break;
+                            --j;
+                        }
+                    }
+
+                    if (k <= j)
+                        hi = j;
+                    else if (k >= i)
+                        lo = i;
+                    else
+                        break;
+                }
+            }
+
+            ssize_t bvh_t::build_node(rtx::triangle_t *vt, size_t first, size_t count, size_t depth)
+            {
+                size_t idx          = nodes.size();
+                bvh_node_t *node    = nodes.add();
+                if (node == NULL)
+                    return -STATUS_NO_MEM;
+
+                calc_bound_box(&node->bbox, &vt[first], count);
+                node->first         = first;
+                node->count         = count;
+                node->left          = 0;
+                node->right         = 0;
+
+                if ((count <= RT_BVH_LEAF_SIZE) || (depth >= RT_BVH_MAX_DEPTH))
+                    return idx;
+
+                // Split along the longest axis of the bounding box
+                const dsp::bound_box3d_t *b = &node->bbox;
+                float dx            = b->p[2].x - b->p[1].x;
+                float dy            = b->p[0].y - b->p[1].y;
+                float dz            = b->p[1].z - b->p[5].z;
+                size_t axis         = ((dx >= dy) && (dx >= dz)) ? 0 : (dy >= dz) ? 1 : 2;
+
+                // Split at median, this keeps the tree balanced
+                size_t half         = count >> 1;
+                select(&vt[first], count, half, axis);
+
+                ssize_t left        = build_node(vt, first, half, depth + 1);
+                if (left < 0)
+                    return left;
+                ssize_t right       = build_node(vt, first + half, count - half, depth + 1);
+                if (right < 0)
+                    return right;
+
+                // Node pointer may be invalid after array growth
+                node                = nodes.uget(idx);
+                node->left          = left;
+                node->right         = right;
+
+                return idx;
+            }
+
+            status_t bvh_t::build(rtx::triangle_t *vt, size_t n)
+            {
+                nodes.clear();
+                if (n <= 0)
+                    return STATUS_OK;
+
+                ssize_t res = build_node(vt, 0, n, 0);
+                if (res < 0)
+                {
+                    nodes.flush();
+                    return -res;
+                }
+
+                return STATUS_OK;
+            }
+
+            status_t bvh_t::copy(const bvh_t *src)
+            {
+                nodes.clear();
+                return (nodes.add(&src->nodes)) ? STATUS_OK : STATUS_NO_MEM;
+            }
+
+        } // namespace rt
+    } // namespace dspu
+} // namespace lsp
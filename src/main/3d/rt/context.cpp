@@ -36,6 +36,24 @@
 
 #define RT_FOREACH_END      } }
 
+#define RT_FOREACH_CLASSIFIED(var, tag, collection, pl) \
+    for (size_t __ci=0,__ne=collection.size(), __nc=collection.chunks(); (__ci<__nc) && (__ne>0); ++__ci) \
+    { \
+        rt::triangle_t *var = collection.chunk(__ci); \
+        size_t __loops  = collection.chunk_size(); \
+        if (__loops > __ne) __loops = __ne; \
+        __ne -= __loops; \
+        for (size_t __bn; __loops > 0; __loops -= __bn) \
+        { \
+            uint8_t __tags[RT_CONTEXT_BATCH_SIZE]; \
+            __bn = lsp_min(__loops, size_t(RT_CONTEXT_BATCH_SIZE)); \
+            classify_triangles(__tags, var, __bn, pl); \
+            for (size_t __bi=0; __bi < __bn; ++__bi, ++var) \
+            { \
+                size_t tag = __tags[__bi];
+
+#define RT_FOREACH_CLASSIFIED_END   } } }
+
 namespace lsp
 {
     namespace dspu
@@ -49,6 +67,7 @@ namespace lsp
 
                 // Initialize point of view
                 view.amplitude  = 0.0f;
+                dsp::fill_zero(view.bands, RT_BANDS_MAX);
                 view.location   = 0.0f; // Undefined
                 view.face       = -1;
                 view.oid        = -1;
@@ -75,6 +94,35 @@ namespace lsp
                 this->view      = *view;
             }
 
+            context_t::context_t(Arena3D *arena):
+                plan(arena),
+                triangle(1024, arena)
+            {
+                this->state     = S_SCAN_OBJECTS;
+
+                // Initialize point of view
+                view.amplitude  = 0.0f;
+                dsp::fill_zero(view.bands, RT_BANDS_MAX);
+                view.location   = 0.0f; // Undefined
+                view.face       = -1;
+                view.oid        = -1;
+                view.speed      = LSP_DSP_UNITS_SOUND_SPEED_M_S;
+                view.rnum       = 0;
+
+                dsp::init_point_xyz(&view.s, 0.0f, 0.0f, 0.0f);
+                dsp::init_point_xyz(&view.p[0], 0.0f, 0.0f, 0.0f);
+                dsp::init_point_xyz(&view.p[1], 0.0f, 0.0f, 0.0f);
+                dsp::init_point_xyz(&view.p[2], 0.0f, 0.0f, 0.0f);
+            }
+
+            context_t::context_t(const rt::view_t *view, rt::context_state_t state, Arena3D *arena):
+                plan(arena),
+                triangle(1024, arena)
+            {
+                this->state     = state;
+                this->view      = *view;
+            }
+
             context_t::~context_t()
             {
                 plan.flush();
@@ -92,6 +140,42 @@ namespace lsp
                 return (x > DSP_3D_TOLERANCE) ? 1 : 0;
             }
 
+            void context_t::classify_triangles(uint8_t *tags, const rt::triangle_t *vt, size_t n, const dsp::vector3d_t *pl)
+            {
+                rt_triangle_batch_t b;
+                const float dx = pl->dx, dy = pl->dy, dz = pl->dz, dw = pl->dw;
+
+                // Transpose triangles into the batch, pad unused lanes with the last triangle
+                for (size_t i=0; i<RT_CONTEXT_BATCH_SIZE; ++i)
+                {
+                    const rt::triangle_t *t = &vt[(i < n) ? i : n - 1];
+                    for (size_t j=0; j<3; ++j)
+                    {
+                        b.x[j][i]   = t->v[j].x;
+                        b.y[j][i]   = t->v[j].y;
+                        b.z[j][i]   = t->v[j].z;
+                    }
+                }
+
+                // Branch-free classification of all lanes, the same as dsp::colocation_x3_v1pv():
+                // 0 - point is above the plane, 1 - point lays on the plane, 2 - point is below the plane
+                uint8_t x[RT_CONTEXT_BATCH_SIZE];
+                for (size_t i=0; i<RT_CONTEXT_BATCH_SIZE; ++i)
+                    x[i]        = 0;
+
+                for (size_t j=0; j<3; ++j)
+                {
+                    for (size_t i=0; i<RT_CONTEXT_BATCH_SIZE; ++i)
+                    {
+                        float k     = dx * b.x[j][i] + dy * b.y[j][i] + dz * b.z[j][i] + dw;
+                        x[i]       |= uint8_t((k <= DSP_3D_TOLERANCE) + (k < -DSP_3D_TOLERANCE)) << (j << 1);
+                    }
+                }
+
+                for (size_t i=0; i<n; ++i)
+                    tags[i]     = x[i];
+            }
+
             status_t context_t::add_triangle(const rt::triangle_t *t)
             {
                 size_t tag;
@@ -915,14 +999,10 @@ namespace lsp
                 return STATUS_OK;
             }
 
-            status_t context_t::add_object(rtx::triangle_t *vt, rtx::edge_t *ve, size_t nt, size_t ne)
+            status_t context_t::add_object(const rtx::triangle_t *vt, size_t nt, ssize_t *tags, ssize_t stamp)
             {
                 status_t res;
 
-                // Set-up tag for the edge
-                for (size_t i=0; i<ne; ++i)
-                    ve[i].itag      = 1;
-
                 // Add all triangles
                 for (size_t i=0; i<nt; ++i)
                 {
@@ -932,30 +1012,77 @@ namespace lsp
                         continue;
 
                     // Add triangle
-                    res = add_triangle(reinterpret_cast<const rt::triangle_t *>(&vt[i]));
+                    res = add_triangle(reinterpret_cast<const rt::triangle_t *>(t));
                     if (res == STATUS_SKIP)
                         continue;
                     else if (res != STATUS_OK)
                         return res;
 
-                    // Add edges to plan
-                    if (t->e[0]->itag)
+                    // Add edges to plan if they were not added by this call
+                    for (size_t j=0; j<3; ++j)
                     {
-                        if ((res = add_edge(t->e[0])) != STATUS_OK)
+                        const rtx::edge_t *e = t->e[j];
+                        if (tags[e->itag] == stamp)
+                            continue;
+                        if ((res = add_edge(e)) != STATUS_OK)
                             return res;
-                        t->e[0]->itag   = 0;
+                        tags[e->itag]   = stamp;
                     }
-                    if (t->e[1]->itag)
+                }
+
+                return STATUS_OK;
+            }
+
+            status_t context_t::add_object(const rtx::triangle_t *vt, const rt::bvh_t *bvh, ssize_t *tags, ssize_t stamp)
+            {
+                status_t res;
+                size_t stack[RT_BVH_MAX_DEPTH * 2];
+                size_t top = 0;
+
+                if (bvh->is_empty())
+                    return STATUS_OK;
+
+                // Traverse the hierarchy starting from the root node
+                stack[top++]    = 0;
+                while (top > 0)
+                {
+                    const rt::bvh_node_t *node = bvh->nodes.uget(stack[--top]);
+                    if (!rt::check_bound_box(&node->bbox, &view))
+                        continue;
+
+                    // Non-leaf node? Descend to children
+                    if (node->left > 0)
                     {
-                        if ((res = add_edge(t->e[1])) != STATUS_OK)
-                            return res;
-                        t->e[1]->itag   = 0;
+                        stack[top++]    = node->right;
+                        stack[top++]    = node->left;
+                        continue;
                     }
-                    if (t->e[2]->itag)
+
+                    // Add all triangles of the leaf
+                    for (size_t i=node->first, n=node->first + node->count; i<n; ++i)
                     {
-                        if ((res = add_edge(t->e[2])) != STATUS_OK)
+                        const rtx::triangle_t *t = &vt[i];
+                        // Skip ignored triangles
+                        if ((t->oid == view.oid) && (t->face == view.face))
+                            continue;
+
+                        // Add triangle
+                        res = add_triangle(reinterpret_cast<const rt::triangle_t *>(t));
+                        if (res == STATUS_SKIP)
+                            continue;
+                        else if (res != STATUS_OK)
                             return res;
-                        t->e[2]->itag   = 0;
+
+                        // Add edges to plan if they were not added by this call
+                        for (size_t j=0; j<3; ++j)
+                        {
+                            const rtx::edge_t *e = t->e[j];
+                            if (tags[e->itag] == stamp)
+                                continue;
+                            if ((res = add_edge(e)) != STATUS_OK)
+                                return res;
+                            tags[e->itag]   = stamp;
+                        }
                     }
                 }
 
@@ -989,11 +1116,10 @@ namespace lsp
 
             status_t context_t::cut(const dsp::vector3d_t *pl)
             {
-                Allocator3D<rt::triangle_t> in(triangle.chunk_size());
+                Allocator3D<rt::triangle_t> in(triangle.chunk_size(), triangle.arena());
                 rt::triangle_t *nt1, *nt2;
 
-                RT_FOREACH(rt::triangle_t, t, triangle)
-                    size_t tag  = dsp::colocation_x3_v1pv(pl, t->v);
+                RT_FOREACH_CLASSIFIED(t, tag, triangle, pl)
 
                     switch (tag)
                     {
@@ -1102,7 +1228,7 @@ namespace lsp
                         default:
                             return STATUS_UNKNOWN_ERR;
                     }
-                RT_FOREACH_END
+                RT_FOREACH_CLASSIFIED_END
 
                 // Swap data and proceed
                 in.swap(&this->triangle);
@@ -1112,11 +1238,10 @@ namespace lsp
 
             status_t context_t::cullback(const dsp::vector3d_t *pl)
             {
-                Allocator3D<rt::triangle_t> in(triangle.chunk_size());
+                Allocator3D<rt::triangle_t> in(triangle.chunk_size(), triangle.arena());
                 rt::triangle_t *nt1, *nt2;
 
-                RT_FOREACH(rt::triangle_t, t, triangle)
-                    size_t tag  = dsp::colocation_x3_v1pv(pl, t->v);
+                RT_FOREACH_CLASSIFIED(t, tag, triangle, pl)
 
                     switch (tag)
                     {
@@ -1227,7 +1352,7 @@ namespace lsp
                         default:
                             return STATUS_UNKNOWN_ERR;
                     }
-                RT_FOREACH_END
+                RT_FOREACH_CLASSIFIED_END
 
                 // Swap data and proceed
                 in.swap(&this->triangle);
@@ -1237,11 +1362,10 @@ namespace lsp
 
             status_t context_t::split(context_t *out, const dsp::vector3d_t *pl)
             {
-                Allocator3D<rt::triangle_t> xin(triangle.chunk_size()), xout(triangle.chunk_size());
+                Allocator3D<rt::triangle_t> xin(triangle.chunk_size(), triangle.arena()), xout(triangle.chunk_size(), triangle.arena());
                 rt::triangle_t *nt1, *nt2, *nt3;
 
-                RT_FOREACH(rt::triangle_t, t, triangle)
-                    size_t tag  = dsp::colocation_x3_v1pv(pl, t->v);
+                RT_FOREACH_CLASSIFIED(t, tag, triangle, pl)
 
                     switch (tag)
                     {
@@ -1377,7 +1501,7 @@ namespace lsp
                         default:
                             return STATUS_UNKNOWN_ERR;
                     }
-                RT_FOREACH_END
+                RT_FOREACH_CLASSIFIED_END
 
                 // Swap data and proceed
                 xin.swap(&this->triangle);
@@ -0,0 +1,488 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/dsp-units/3d/rt/lod.h>
+#include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/stdlib/stdlib.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        namespace rt
+        {
+            typedef struct lod_edge_t
+            {
+                size_t              v[2];       // Indexes of vertexes, v[0] < v[1]
+            } lod_edge_t;
+
+            typedef struct lod_collapse_t
+            {
+                size_t              src;        // Vertex to remove
+                size_t              dst;        // Vertex to keep
+                double              cost;       // Error of the collapse
+            } lod_collapse_t;
+
+            static int cmp_lod_edge(const void *a, const void *b)
+            {
+                const lod_edge_t *ea = static_cast<const lod_edge_t *>(a);
+                const lod_edge_t *eb = static_cast<const lod_edge_t *>(b);
+                if (ea->v[0] != eb->v[0])
+                    return (ea->v[0] < eb->v[0]) ? -1 : 1;
+                if (ea->v[1] != eb->v[1])
+                    return (ea->v[1] < eb->v[1]) ? -1 : 1;
+                return 0;
+            }
+
+            static int cmp_lod_collapse(const void *a, const void *b)
+            {
+                const lod_collapse_t *ca = static_cast<const lod_collapse_t *>(a);
+                const lod_collapse_t *cb = static_cast<const lod_collapse_t *>(b);
+                return (ca->cost < cb->cost) ? -1 : (ca->cost > cb->cost) ? 1 : 0;
+            }
+
+            static inline bool has_vertex(const lod_triangle_t *t, size_t v)
+            {
+                return (t->v[0] == v) || (t->v[1] == v) || (t->v[2] == v);
+            }
+
+            lod_t::lod_t()
+            {
+            }
+
+            lod_t::~lod_t()
+            {
+                flush();
+            }
+
+            void lod_t::flush()
+            {
+                vertex.flush();
+                triangle.flush();
+            }
+
+            status_t lod_t::init(Object3D *obj, const dsp::matrix3d_t *transform)
+            {
+                vertex.clear();
+                triangle.clear();
+
+                const obj_packed_t *pk  = obj->packed();
+                if (pk == NULL)
+                    return STATUS_NO_MEM;
+
+                size_t nv       = pk->vertex.size();
+                size_t nt       = pk->face.size();
+                if (nt <= 0)
+                    return STATUS_OK;
+
+                dsp::point3d_t *dv      = vertex.append_n(nv);
+                lod_triangle_t *dt      = triangle.append_n(nt);
+                if ((dv == NULL) || (dt == NULL))
+                    return STATUS_NO_MEM;
+
+                const dsp::point3d_t *sv = pk->vertex.array();
+                for (size_t i=0; i<nv; ++i)
+                    dsp::apply_matrix3d_mp2(&dv[i], &sv[i], transform);
+
+                const uint32_t *vi      = pk->vindex.array();
+                const ssize_t *fi       = pk->face.array();
+                for (size_t i=0; i<nt; ++i, vi += 3, ++dt)
+                {
+                    dt->v[0]            = vi[0];
+                    dt->v[1]            = vi[1];
+                    dt->v[2]            = vi[2];
+                    dt->face            = fi[i];
+                }
+
+                return STATUS_OK;
+            }
+
+            void lod_t::add_plane(quadric_t *q, const dsp::point3d_t *p0, const dsp::point3d_t *p1, const dsp::point3d_t *p2)
+            {
+                double ax   = p1->x - p0->x, ay = p1->y - p0->y, az = p1->z - p0->z;
+                double bx   = p2->x - p0->x, by = p2->y - p0->y, bz = p2->z - p0->z;
+                double a    = ay*bz - az*by;
+                double b    = az*bx - ax*bz;
+                double c    = ax*by - ay*bx;
+                double len  = sqrt(a*a + b*b + c*c);
+                if (len <= 0.0) // Degenerate triangle has no plane
+                    return;
+
+                a          /= len;
+                b          /= len;
+                c          /= len;
+                double d    = -(a*p0->x + b*p0->y + c*p0->z);
+
+                double *k   = q->k;
+                k[0]       += a*a;
+                k[1]       += a*b;
+                k[2]       += a*c;
+                k[3]       += a*d;
+                k[4]       += b*b;
+                k[5]       += b*c;
+                k[6]       += b*d;
+                k[7]       += c*c;
+                k[8]       += c*d;
+                k[9]       += d*d;
+            }
+
+            double lod_t::eval(const quadric_t *a, const quadric_t *b, const dsp::point3d_t *p)
+            {
+                double k[10];
+                for (size_t i=0; i<10; ++i)
+                    k[i]        = a->k[i] + b->k[i];
+
+                double x    = p->x, y = p->y, z = p->z;
+                return  k[0]*x*x + 2.0*k[1]*x*y + 2.0*k[2]*x*z + 2.0*k[3]*x +
+                        k[4]*y*y + 2.0*k[5]*y*z + 2.0*k[6]*y +
+                        k[7]*z*z + 2.0*k[8]*z +
+                        k[9];
+            }
+
+            bool lod_t::check_flip(const dsp::point3d_t *p0, const dsp::point3d_t *p1, const dsp::point3d_t *p2, const dsp::point3d_t *np)
+            {
+                // Normal before the collapse
+                double ax   = p1->x - p0->x, ay = p1->y - p0->y, az = p1->z - p0->z;
+                double bx   = p2->x - p0->x, by = p2->y - p0->y, bz = p2->z - p0->z;
+                double n0x  = ay*bz - az*by;
+                double n0y  = az*bx - ax*bz;
+                double n0z  = ax*by - ay*bx;
+
+                // Normal after the collapse
+                ax          = p1->x - np->x; ay = p1->y - np->y; az = p1->z - np->z;
+                bx          = p2->x - np->x; by = p2->y - np->y; bz = p2->z - np->z;
+                double n1x  = ay*bz - az*by;
+                double n1y  = az*bx - ax*bz;
+                double n1z  = ax*by - ay*bx;
+
+                // The triangle should keep the orientation and should not become degenerate
+                double dot  = n0x*n1x + n0y*n1y + n0z*n1z;
+                double l0   = n0x*n0x + n0y*n0y + n0z*n0z;
+                double l1   = n1x*n1x + n1y*n1y + n1z*n1z;
+
+                return (dot > 0.0) && (dot*dot > 0.25 * l0 * l1);
+            }
+
+            status_t lod_t::simplify_pass(lltl::darray<quadric_t> *q, double thresh, size_t *collapsed)
+            {
+                size_t nv = vertex.size(), nt = triangle.size();
+                *collapsed  = 0;
+                if (nt <= 0)
+                    return STATUS_OK;
+
+                // Build the sorted list of edges
+                lltl::darray<lod_edge_t> edges;
+                lod_edge_t *e       = edges.append_n(nt * 3);
+                if (e == NULL)
+                    return STATUS_NO_MEM;
+                for (size_t i=0; i<nt; ++i)
+                {
+                    const lod_triangle_t *t = triangle.uget(i);
+                    for (size_t j=0; j<3; ++j, ++e)
+                    {
+                        size_t a            = t->v[j];
+                        size_t b            = t->v[(j+1) % 3];
+                        e->v[0]             = lsp_min(a, b);
+                        e->v[1]             = lsp_max(a, b);
+                    }
+                }
+                size_t ne           = edges.size();
+                e                   = edges.array();
+                ::qsort(e, ne, sizeof(lod_edge_t), cmp_lod_edge);
+
+                // Vertexes of the open or non-manifold edges are boundary vertexes
+                lltl::darray<uint8_t> vflags;
+                uint8_t *boundary   = vflags.append_n(nv * 2);
+                if (boundary == NULL)
+                    return STATUS_NO_MEM;
+                uint8_t *lock       = &boundary[nv];
+                for (size_t i=0; i<nv*2; ++i)
+                    boundary[i]         = 0;
+
+                for (size_t i=0; i<ne; )
+                {
+                    size_t j            = i + 1;
+                    while ((j < ne) && (cmp_lod_edge(&e[i], &e[j]) == 0))
+                        ++j;
+                    if ((j - i) != 2)
+                    {
+                        boundary[e[i].v[0]] = 1;
+                        boundary[e[i].v[1]] = 1;
+                    }
+                    i                   = j;
+                }
+
+                // Estimate the cost of collapse for each interior edge
+                lltl::darray<lod_collapse_t> cand;
+                for (size_t i=0; i<ne; )
+                {
+                    size_t j            = i + 1;
+                    while ((j < ne) && (cmp_lod_edge(&e[i], &e[j]) == 0))
+                        ++j;
+                    size_t a            = e[i].v[0];
+                    size_t b            = e[i].v[1];
+                    i                   = j;
+
+                    const quadric_t *qa = q->uget(a);
+                    const quadric_t *qb = q->uget(b);
+                    double ca           = (boundary[a]) ? thresh + 1.0 : eval(qa, qb, vertex.uget(b));
+                    double cb           = (boundary[b]) ? thresh + 1.0 : eval(qa, qb, vertex.uget(a));
+                    if ((ca > thresh) && (cb > thresh))
+                        continue;
+
+                    lod_collapse_t *c   = cand.add();
+                    if (c == NULL)
+                        return STATUS_NO_MEM;
+                    c->src              = (ca <= cb) ? a : b;
+                    c->dst              = (ca <= cb) ? b : a;
+                    c->cost             = lsp_min(ca, cb);
+                }
+                if (cand.size() <= 0)
+                    return STATUS_OK;
+                ::qsort(cand.array(), cand.size(), sizeof(lod_collapse_t), cmp_lod_collapse);
+
+                // Build the list of triangles for each vertex
+                lltl::darray<size_t> adj;
+                size_t *offset      = adj.append_n(nv + 1 + nv + nt * 3);
+                if (offset == NULL)
+                    return STATUS_NO_MEM;
+                size_t *mark        = &offset[nv + 1];
+                size_t *list        = &mark[nv];
+                for (size_t i=0; i<=nv; ++i)
+                    offset[i]           = 0;
+                for (size_t i=0; i<nv; ++i)
+                    mark[i]             = 0;
+                for (size_t i=0; i<nt; ++i)
+                {
+                    const lod_triangle_t *t = triangle.uget(i);
+                    ++offset[t->v[0] + 1];
+                    ++offset[t->v[1] + 1];
+                    ++offset[t->v[2] + 1];
+                }
+                for (size_t i=0; i<nv; ++i)
+                    offset[i+1]        += offset[i];
+                for (size_t i=0; i<nt; ++i)
+                {
+                    const lod_triangle_t *t = triangle.uget(i);
+                    for (size_t j=0; j<3; ++j)
+                        list[offset[t->v[j]]++] = i;
+                }
+                for (size_t i=nv; i>0; --i)
+                    offset[i]           = offset[i-1];
+                offset[0]           = 0;
+
+                // Perform collapses, vertexes around the collapsed edge are locked
+                // until the next pass because their lists of triangles become outdated
+                lltl::darray<uint8_t> tflags;
+                uint8_t *dead       = tflags.append_n(nt);
+                if (dead == NULL)
+                    return STATUS_NO_MEM;
+                for (size_t i=0; i<nt; ++i)
+                    dead[i]             = 0;
+
+                size_t stamp        = 1;
+                for (size_t i=0, n=cand.size(); i<n; ++i)
+                {
+                    const lod_collapse_t *c = cand.uget(i);
+                    size_t u            = c->src;
+                    size_t v            = c->dst;
+                    if ((lock[u]) || (lock[v]))
+                        continue;
+
+                    // Link condition: only two vertexes opposite to the edge are common neighbours
+                    for (size_t k=offset[v]; k<offset[v+1]; ++k)
+                    {
+                        const lod_triangle_t *t = triangle.uget(list[k]);
+                        for (size_t j=0; j<3; ++j)
+                            mark[t->v[j]]       = stamp;
+                    }
+                    size_t common       = 0;
+                    for (size_t k=offset[u]; k<offset[u+1]; ++k)
+                    {
+                        const lod_triangle_t *t = triangle.uget(list[k]);
+                        for (size_t j=0; j<3; ++j)
+                        {
+                            size_t w            = t->v[j];
+                            if ((w == u) || (w == v) || (mark[w] != stamp))
+                                continue;
+                            mark[w]             = stamp + 1;
+                            ++common;
+                        }
+                    }
+                    stamp              += 2;
+                    if (common != 2)
+                        continue;
+
+                    // The remaining triangles should not flip or degenerate
+                    bool valid          = true;
+                    for (size_t k=offset[u]; (valid) && (k<offset[u+1]); ++k)
+                    {
+                        const lod_triangle_t *t = triangle.uget(list[k]);
+                        if (has_vertex(t, v))
+                            continue;
+                        size_t j            = (t->v[0] == u) ? 0 : (t->v[1] == u) ? 1 : 2;
+                        valid               = check_flip(
+                            vertex.uget(u), vertex.uget(t->v[(j+1) % 3]), vertex.uget(t->v[(j+2) % 3]),
+                            vertex.uget(v));
+                    }
+                    if (!valid)
+                        continue;
+
+                    // Collapse the edge
+                    for (size_t k=offset[u]; k<offset[u+1]; ++k)
+                    {
+                        size_t ti           = list[k];
+                        lod_triangle_t *t   = triangle.uget(ti);
+                        if (has_vertex(t, v))
+                        {
+                            dead[ti]            = 1;
+                            continue;
+                        }
+                        for (size_t j=0; j<3; ++j)
+                            if (t->v[j] == u)
+                                t->v[j]             = v;
+                    }
+
+                    quadric_t *qu       = q->uget(u);
+                    quadric_t *qv       = q->uget(v);
+                    for (size_t j=0; j<10; ++j)
+                        qv->k[j]           += qu->k[j];
+
+                    // Lock the neighbourhood
+                    for (size_t k=offset[u]; k<offset[u+1]; ++k)
+                    {
+                        const lod_triangle_t *t = triangle.uget(list[k]);
+                        lock[t->v[0]]       = 1;
+                        lock[t->v[1]]       = 1;
+                        lock[t->v[2]]       = 1;
+                    }
+                    for (size_t k=offset[v]; k<offset[v+1]; ++k)
+                    {
+                        const lod_triangle_t *t = triangle.uget(list[k]);
+                        lock[t->v[0]]       = 1;
+                        lock[t->v[1]]       = 1;
+                        lock[t->v[2]]       = 1;
+                    }
+                    lock[u]             = 1;
+
+                    ++(*collapsed);
+                }
+
+                // Remove triangles of collapsed edges
+                if (*collapsed <= 0)
+                    return STATUS_OK;
+
+                size_t j            = 0;
+                for (size_t i=0; i<nt; ++i)
+                {
+                    if (dead[i])
+                        continue;
+                    if (i != j)
+                        *(triangle.uget(j)) = *(triangle.uget(i));
+                    ++j;
+                }
+                if (!triangle.remove_n(j, nt - j))
+                    return STATUS_UNKNOWN_ERR;
+
+                return STATUS_OK;
+            }
+
+            status_t lod_t::compact()
+            {
+                size_t nv = vertex.size(), nt = triangle.size();
+                lltl::darray<ssize_t> remap;
+                ssize_t *idx        = remap.append_n(nv);
+                if (idx == NULL)
+                    return STATUS_NO_MEM;
+                for (size_t i=0; i<nv; ++i)
+                    idx[i]              = -1;
+
+                // Enumerate used vertexes and move them to the beginning
+                size_t used         = 0;
+                for (size_t i=0; i<nt; ++i)
+                {
+                    lod_triangle_t *t   = triangle.uget(i);
+                    for (size_t j=0; j<3; ++j)
+                    {
+                        size_t v            = t->v[j];
+                        if (idx[v] < 0)
+                            idx[v]              = used++;
+                        t->v[j]             = idx[v];
+                    }
+                }
+
+                lltl::darray<dsp::point3d_t> dst;
+                dsp::point3d_t *dp  = dst.append_n(used);
+                if ((dp == NULL) && (used > 0))
+                    return STATUS_NO_MEM;
+                for (size_t i=0; i<nv; ++i)
+                    if (idx[i] >= 0)
+                        dp[idx[i]]          = *(vertex.uget(i));
+
+                vertex.swap(&dst);
+
+                return STATUS_OK;
+            }
+
+            status_t lod_t::simplify(float error)
+            {
+                size_t nv = vertex.size(), nt = triangle.size();
+                if ((error <= 0.0f) || (nt <= 0))
+                    return STATUS_OK;
+
+                // Each vertex accumulates planes of the adjacent triangles of the original mesh
+                lltl::darray<quadric_t> q;
+                quadric_t *vq       = q.append_n(nv);
+                if (vq == NULL)
+                    return STATUS_NO_MEM;
+                for (size_t i=0; i<nv; ++i)
+                    for (size_t j=0; j<10; ++j)
+                        vq[i].k[j]          = 0.0;
+                for (size_t i=0; i<nt; ++i)
+                {
+                    const lod_triangle_t *t = triangle.uget(i);
+                    const dsp::point3d_t *p0 = vertex.uget(t->v[0]);
+                    const dsp::point3d_t *p1 = vertex.uget(t->v[1]);
+                    const dsp::point3d_t *p2 = vertex.uget(t->v[2]);
+                    add_plane(&vq[t->v[0]], p0, p1, p2);
+                    add_plane(&vq[t->v[1]], p0, p1, p2);
+                    add_plane(&vq[t->v[2]], p0, p1, p2);
+                }
+
+                // Perform passes until there is nothing to collapse
+                double thresh       = double(error) * double(error);
+                for (size_t pass=0; pass < RT_LOD_MAX_PASSES; ++pass)
+                {
+                    size_t collapsed    = 0;
+                    status_t res        = simplify_pass(&q, thresh, &collapsed);
+                    if (res != STATUS_OK)
+                        return res;
+                    if (collapsed <= 0)
+                        break;
+                }
+
+                return compact();
+            }
+
+        } // namespace rt
+    } // namespace dspu
+} // namespace lsp
@@ -20,6 +20,8 @@
  */
 
 #include <lsp-plug.in/dsp-units/3d/rt/mesh.h>
+#include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/stdlib/stdlib.h>
 
 #define RT_FOREACH(type, var, collection) \
     for (size_t __ci=0,__ne=collection.size(), __nc=collection.chunks(); (__ci<__nc) && (__ne>0); ++__ci) \
@@ -35,6 +37,9 @@
 
 #define RT_FOREACH_END      } }
 
+#define RT_GRID_DIM_MAX     64                              /* Maximum number of grid cells for each axis */
+#define RT_GRID_MARGIN      (DSP_3D_TOLERANCE * 16.0f)      /* Margin of bounding boxes for the grid lookup */
+
 namespace lsp
 {
     namespace dspu
@@ -57,111 +62,189 @@ namespace lsp
 
             status_t mesh_t::add_object(Object3D *obj, ssize_t oid, const dsp::matrix3d_t *transform, rt::material_t *material)
             {
-                // Reset tags
-                obj->scene()->init_tags(NULL, 0);
+                // Use packed representation of the object, the scene is not modified
+                const obj_packed_t *pk  = obj->packed();
+                if (pk == NULL)
+                    return STATUS_NO_MEM;
 
-                size_t start_t  = triangle.size();
-                size_t start_e  = edge.size();
+                size_t nv       = pk->vertex.size();
+                size_t ne       = pk->edge.size() / 2;
+                size_t nt       = pk->face.size();
+                if (nt <= 0)
+                    return STATUS_OK;
 
-                // Clone triangles and apply object matrix to vertexes
-                for (size_t i=0, n=obj->num_triangles(); i<n; ++i)
+                lltl::darray<rtm::vertex_t *> vv;
+                lltl::darray<rtm::edge_t *> ve;
+                rtm::vertex_t **dv  = vv.append_n(nv);
+                rtm::edge_t **de    = ve.append_n(ne);
+                if ((dv == NULL) || (de == NULL))
+                    return STATUS_NO_MEM;
+
+                // Allocate vertexes and apply object matrix
+                const dsp::point3d_t *sv = pk->vertex.array();
+                for (size_t i=0; i<nv; ++i)
                 {
-                    obj_triangle_t *st = obj->triangle(i);
-                    if (st == NULL)
-                        return STATUS_BAD_STATE;
-                    else if (st->ptag != NULL) // Skip already emitted triangle
-                        continue;
+                    rtm::vertex_t *vx   = vertex.alloc();
+                    if (vx == NULL)
+                        return STATUS_NO_MEM;
+
+                    dsp::apply_matrix3d_mp2(vx, &sv[i], transform);
+                    vx->ptag            = NULL;
+                    vx->itag            = 0;
+                    dv[i]               = vx;
+                }
+
+                // Allocate edges
+                const uint32_t *se  = pk->edge.array();
+                for (size_t i=0; i<ne; ++i, se += 2)
+                {
+                    rtm::edge_t *ex     = edge.alloc();
+                    if (ex == NULL)
+                        return STATUS_NO_MEM;
 
-                    // Allocate triangle and store pointer
+                    ex->v[0]            = dv[se[0]];
+                    ex->v[1]            = dv[se[1]];
+                    ex->vt              = NULL;
+                    ex->ptag            = NULL;
+                    ex->itag            = 0;
+                    de[i]               = ex;
+                }
+
+                // Allocate triangles and link them to edges
+                const uint32_t *vi  = pk->vindex.array();
+                const uint32_t *ei  = pk->eindex.array();
+                const ssize_t *fi   = pk->face.array();
+                for (size_t i=0; i<nt; ++i, vi += 3, ei += 3)
+                {
                     rtm::triangle_t *dt = triangle.alloc();
                     if (dt == NULL)
                         return STATUS_NO_MEM;
 
-                    dt->elnk[0] = NULL;
-                    dt->elnk[1] = NULL;
-                    dt->elnk[2] = NULL;
-                    dt->ptag    = st;
+                    dt->ptag    = NULL;
                     dt->itag    = 0;
                     dt->oid     = oid;
-                    dt->face    = st->face;
-                    st->ptag    = dt;
+                    dt->face    = fi[i];
                     dt->m       = material;
 
-                    // Copy data
                     for (size_t j=0; j<3; ++j)
                     {
-                        // Allocate vertex
-                        rtm::vertex_t *vx   = reinterpret_cast<rtm::vertex_t *>(st->v[j]->ptag);
-                        if (st->v[j]->ptag == NULL)
-                        {
-                            vx              = vertex.alloc();
-                            if (vx == NULL)
-                                return STATUS_NO_MEM;
+                        rtm::edge_t *ex     = de[ei[j]];
+                        dt->v[j]            = dv[vi[j]];
+                        dt->e[j]            = ex;
+                        dt->elnk[j]         = ex->vt;
+                        ex->vt              = dt;
+                    }
 
-                            dsp::apply_matrix3d_mp2(vx, st->v[j], transform);
-                            vx->ptag        = st->v[j];
-                            vx->itag        = 0;
+                    // Compute plane equation and store as normal
+                    dsp::calc_plane_p3(&dt->n, dt->v[0], dt->v[1], dt->v[2]);
+                }
 
-                            st->v[j]->ptag  = vx;
-                        }
+                return STATUS_OK;
+            }
 
-                        // Allocate edge
-                        rtm::edge_t *ex     = reinterpret_cast<rtm::edge_t *>(st->e[j]->ptag);
-                        if (ex == NULL)
-                        {
-                            ex              = edge.alloc();
-                            if (ex == NULL)
-                                return STATUS_NO_MEM;
+            static int cmp_lod_link(const void *a, const void *b)
+            {
+                const size_t *la = static_cast<const size_t *>(a);
+                const size_t *lb = static_cast<const size_t *>(b);
+                if (la[0] != lb[0])
+                    return (la[0] < lb[0]) ? -1 : 1;
+                if (la[1] != lb[1])
+                    return (la[1] < lb[1]) ? -1 : 1;
+                return 0;
+            }
 
-                            ex->v[0]        = NULL;
-                            ex->v[1]        = NULL;
-                            ex->vt          = NULL;
-                            ex->ptag        = st->e[j];
-                            ex->itag        = 0;
+            status_t mesh_t::add_object(const rt::lod_t *lod, ssize_t oid, rt::material_t *material)
+            {
+                size_t nv       = lod->vertex.size();
+                size_t nt       = lod->triangle.size();
+                if (nt <= 0)
+                    return STATUS_OK;
 
-                            st->e[j]->ptag  = ex;
-                        }
+                // Allocate vertexes
+                lltl::darray<rtm::vertex_t *> vv;
+                rtm::vertex_t **dv = vv.append_n(nv);
+                if (dv == NULL)
+                    return STATUS_NO_MEM;
+                for (size_t i=0; i<nv; ++i)
+                {
+                    rtm::vertex_t *vx   = vertex.alloc();
+                    if (vx == NULL)
+                        return STATUS_NO_MEM;
+                    *static_cast<dsp::point3d_t *>(vx)  = *(lod->vertex.uget(i));
+                    vx->ptag            = NULL;
+                    vx->itag            = 0;
+                    dv[i]               = vx;
+                }
 
-                        dt->v[j]        = vx;
-                        dt->e[j]        = ex;
-                    }
+                // Allocate triangles
+                size_t start_t  = triangle.size();
+                for (size_t i=0; i<nt; ++i)
+                {
+                    const rt::lod_triangle_t *st = lod->triangle.uget(i);
+                    rtm::triangle_t *dt = triangle.alloc();
+                    if (dt == NULL)
+                        return STATUS_NO_MEM;
+
+                    dt->v[0]    = dv[st->v[0]];
+                    dt->v[1]    = dv[st->v[1]];
+                    dt->v[2]    = dv[st->v[2]];
+                    dt->elnk[0] = NULL;
+                    dt->elnk[1] = NULL;
+                    dt->elnk[2] = NULL;
+                    dt->ptag    = NULL;
+                    dt->itag    = 0;
+                    dt->oid     = oid;
+                    dt->face    = st->face;
+                    dt->m       = material;
 
                     // Compute plane equation and store as normal
                     dsp::calc_plane_p3(&dt->n, dt->v[0], dt->v[1], dt->v[2]);
                 }
 
-                // Patch edge structures and link to vertexes
-                for (size_t i=start_e, n=edge.size(); i<n; ++i)
+                // Sort links of triangles to edges: { min vertex, max vertex, triangle, edge slot }
+                lltl::darray<size_t> links;
+                size_t *lk      = links.append_n(nt * 3 * 4);
+                if (lk == NULL)
+                    return STATUS_NO_MEM;
+                for (size_t i=0; i<nt; ++i)
                 {
-                    rtm::edge_t *de      = edge.get(i);
-                    obj_edge_t *se      = reinterpret_cast<obj_edge_t *>(de->ptag);
-
-                    de->v[0]            = reinterpret_cast<rtm::vertex_t *>(se->v[0]->ptag);
-                    de->v[1]            = reinterpret_cast<rtm::vertex_t *>(se->v[1]->ptag);
+                    const rt::lod_triangle_t *st = lod->triangle.uget(i);
+                    for (size_t j=0; j<3; ++j, lk += 4)
+                    {
+                        size_t a    = st->v[j];
+                        size_t b    = st->v[(j+1) % 3];
+                        lk[0]       = lsp_min(a, b);
+                        lk[1]       = lsp_max(a, b);
+                        lk[2]       = i;
+                        lk[3]       = j;
+                    }
                 }
+                lk              = links.array();
+                ::qsort(lk, nt * 3, sizeof(size_t) * 4, cmp_lod_link);
 
-                // Patch triangle structures and link to edges
-                for (size_t i=start_t, n=triangle.size(); i<n; ++i)
+                // Allocate one edge for each unique pair of vertexes
+                rtm::edge_t *ex = NULL;
+                for (size_t i=0, n=nt*3; i<n; ++i, lk += 4)
                 {
-                    rtm::triangle_t *dt = triangle.get(i);
-                    obj_triangle_t *st  = reinterpret_cast<obj_triangle_t *>(dt->ptag);
-
-                    dt->v[0]            = reinterpret_cast<rtm::vertex_t *>(st->v[0]->ptag);
-                    dt->v[1]            = reinterpret_cast<rtm::vertex_t *>(st->v[1]->ptag);
-                    dt->v[2]            = reinterpret_cast<rtm::vertex_t *>(st->v[2]->ptag);
+                    if ((ex == NULL) || (cmp_lod_link(lk, lk - 4) != 0))
+                    {
+                        ex              = edge.alloc();
+                        if (ex == NULL)
+                            return STATUS_NO_MEM;
 
-                    dt->e[0]            = reinterpret_cast<rtm::edge_t *>(st->e[0]->ptag);
-                    dt->e[1]            = reinterpret_cast<rtm::edge_t *>(st->e[1]->ptag);
-                    dt->e[2]            = reinterpret_cast<rtm::edge_t *>(st->e[2]->ptag);
+                        ex->v[0]        = dv[lk[0]];
+                        ex->v[1]        = dv[lk[1]];
+                        ex->vt          = NULL;
+                        ex->ptag        = NULL;
+                        ex->itag        = 0;
+                    }
 
                     // Link triangle to the edge
-                    dt->elnk[0]         = dt->e[0]->vt;
-                    dt->elnk[1]         = dt->e[1]->vt;
-                    dt->elnk[2]         = dt->e[2]->vt;
-
-                    dt->e[0]->vt        = dt;
-                    dt->e[1]->vt        = dt;
-                    dt->e[2]->vt        = dt;
+                    rtm::triangle_t *dt = triangle.get(start_t + lk[2]);
+                    size_t j            = lk[3];
+                    dt->e[j]            = ex;
+                    dt->elnk[j]         = ex->vt;
+                    ex->vt              = dt;
                 }
 
                 return STATUS_OK;
@@ -460,6 +543,165 @@ namespace lsp
                 return STATUS_OK;
             }
 
+            static int cmp_edge_index(const void *a, const void *b)
+            {
+                size_t ia = *static_cast<const size_t *>(a);
+                size_t ib = *static_cast<const size_t *>(b);
+                return (ia < ib) ? -1 : (ia > ib) ? 1 : 0;
+            }
+
+            void mesh_t::grid_range(const conflict_grid_t *g, size_t *first, size_t *last, const dsp::point3d_t * const *p, size_t n)
+            {
+                float min[3], max[3];
+                min[0]  = max[0]    = p[0]->x;
+                min[1]  = max[1]    = p[0]->y;
+                min[2]  = max[2]    = p[0]->z;
+                for (size_t i=1; i<n; ++i)
+                {
+                    min[0]  = lsp_min(min[0], p[i]->x);
+                    min[1]  = lsp_min(min[1], p[i]->y);
+                    min[2]  = lsp_min(min[2], p[i]->z);
+                    max[0]  = lsp_max(max[0], p[i]->x);
+                    max[1]  = lsp_max(max[1], p[i]->y);
+                    max[2]  = lsp_max(max[2], p[i]->z);
+                }
+
+                for (size_t j=0; j<3; ++j)
+                {
+                    ssize_t lo  = (min[j] - RT_GRID_MARGIN - g->min[j]) * g->k[j];
+                    ssize_t hi  = (max[j] + RT_GRID_MARGIN - g->min[j]) * g->k[j];
+                    first[j]    = lsp_limit(lo, ssize_t(0), ssize_t(g->dim[j] - 1));
+                    last[j]     = lsp_limit(hi, ssize_t(0), ssize_t(g->dim[j] - 1));
+                }
+            }
+
+            status_t mesh_t::grid_init(conflict_grid_t *g)
+            {
+                // Compute bounding box of the whole mesh
+                bool first  = true;
+                for (size_t j=0; j<3; ++j)
+                    g->min[j]   = g->max[j] = 0.0f;
+                RT_FOREACH(rtm::vertex_t, v, vertex)
+                    if (first)
+                    {
+                        g->min[0]   = g->max[0] = v->x;
+                        g->min[1]   = g->max[1] = v->y;
+                        g->min[2]   = g->max[2] = v->z;
+                        first       = false;
+                        continue;
+                    }
+                    g->min[0]   = lsp_min(g->min[0], v->x);
+                    g->min[1]   = lsp_min(g->min[1], v->y);
+                    g->min[2]   = lsp_min(g->min[2], v->z);
+                    g->max[0]   = lsp_max(g->max[0], v->x);
+                    g->max[1]   = lsp_max(g->max[1], v->y);
+                    g->max[2]   = lsp_max(g->max[2], v->z);
+                RT_FOREACH_END;
+
+                // Make the number of cells comparable to the number of edges
+                size_t dim  = cbrtf(float(edge.size()));
+                dim         = lsp_limit(dim, size_t(1), size_t(RT_GRID_DIM_MAX));
+                size_t n    = 1;
+                for (size_t j=0; j<3; ++j)
+                {
+                    float d     = g->max[j] - g->min[j];
+                    g->dim[j]   = (d > RT_GRID_MARGIN) ? dim : 1;
+                    g->k[j]     = (d > RT_GRID_MARGIN) ? g->dim[j] / d : 0.0f;
+                    n          *= g->dim[j];
+                }
+
+                // Initialize cells
+                ssize_t *head   = g->head.append_n(n);
+                if (head == NULL)
+                    return STATUS_NO_MEM;
+                for (size_t i=0; i<n; ++i)
+                    head[i]         = -1;
+                g->count        = 0;
+                g->stamp        = 0;
+
+                return STATUS_OK;
+            }
+
+            status_t mesh_t::grid_update(conflict_grid_t *g)
+            {
+                size_t first[3], last[3];
+                const dsp::point3d_t *p[2];
+
+                // Allocate marks for new edges
+                size_t n    = edge.size();
+                if (n <= g->count)
+                    return STATUS_OK;
+                size_t *mark = g->mark.append_n(n - g->count);
+                if (mark == NULL)
+                    return STATUS_NO_MEM;
+                for (size_t i=g->count; i<n; ++i)
+                    *(mark++)   = 0;
+
+                // Link new edges to all cells covered by their bounding boxes
+                for ( ; g->count < n; ++g->count)
+                {
+                    rtm::edge_t *e  = edge.get(g->count);
+                    p[0]            = e->v[0];
+                    p[1]            = e->v[1];
+                    grid_range(g, first, last, p, 2);
+
+                    for (size_t z=first[2]; z<=last[2]; ++z)
+                        for (size_t y=first[1]; y<=last[1]; ++y)
+                            for (size_t x=first[0]; x<=last[0]; ++x)
+                            {
+                                size_t cell         = (z * g->dim[1] + y) * g->dim[0] + x;
+                                ssize_t *head       = g->head.uget(cell);
+                                conflict_link_t *l  = g->links.add();
+                                if (l == NULL)
+                                    return STATUS_NO_MEM;
+                                l->edge             = g->count;
+                                l->next             = *head;
+                                *head               = g->links.size() - 1;
+                            }
+                }
+
+                return STATUS_OK;
+            }
+
+            status_t mesh_t::grid_lookup(conflict_grid_t *g, const rtm::triangle_t *t)
+            {
+                size_t first[3], last[3];
+                const dsp::point3d_t *p[3];
+
+                p[0]        = t->v[0];
+                p[1]        = t->v[1];
+                p[2]        = t->v[2];
+                grid_range(g, first, last, p, 3);
+
+                // Collect unique edges of all covered cells
+                g->cand.clear();
+                ++g->stamp;
+                for (size_t z=first[2]; z<=last[2]; ++z)
+                    for (size_t y=first[1]; y<=last[1]; ++y)
+                        for (size_t x=first[0]; x<=last[0]; ++x)
+                        {
+                            size_t cell         = (z * g->dim[1] + y) * g->dim[0] + x;
+                            for (ssize_t i = *(g->head.uget(cell)); i >= 0; )
+                            {
+                                const conflict_link_t *l = g->links.uget(i);
+                                size_t *mark    = g->mark.uget(l->edge);
+                                if (*mark != g->stamp)
+                                {
+                                    *mark           = g->stamp;
+                                    if (!g->cand.add(&l->edge))
+                                        return STATUS_NO_MEM;
+                                }
+                                i               = l->next;
+                            }
+                        }
+
+                // Keep the order of edges the same as for the full scan
+                if (g->cand.size() > 1)
+                    ::qsort(g->cand.array(), g->cand.size(), sizeof(size_t), cmp_edge_index);
+
+                return STATUS_OK;
+            }
+
             status_t mesh_t::solve_conflicts()
             {
                 status_t res;
@@ -478,6 +720,12 @@ namespace lsp
                     ct->itag            = i;
                 }
 
+                // The uniform grid of edges is used as a broad phase: the edge can
+                // interact with the triangle only if their bounding boxes overlap
+                conflict_grid_t grid;
+                if ((res = grid_init(&grid)) != STATUS_OK)
+                    return res;
+
                 for (size_t i=0; i<triangle.size(); ++i)
                 {
                     rtm::triangle_t *ct   = triangle.get(i);
@@ -486,8 +734,16 @@ namespace lsp
                     dsp::calc_plane_v1p2(&spl[1], &pl, ct->v[1], ct->v[2]);
                     dsp::calc_plane_v1p2(&spl[2], &pl, ct->v[2], ct->v[0]);
 
-                    // Split each edge with triangle, do not process new edges
-                    RT_FOREACH(rtm::edge_t, ce, edge)
+                    // Fetch edges located near the triangle, do not process new edges
+                    if ((res = grid_update(&grid)) != STATUS_OK)
+                        return res;
+                    if ((res = grid_lookup(&grid, ct)) != STATUS_OK)
+                        return res;
+
+                    for (size_t k=0, nc=grid.cand.size(); k<nc; ++k)
+                    {
+                        rtm::edge_t *ce = edge.get(*(grid.cand.uget(k)));
+
                         // Interact only ONCE with a specific triangle
                         if (ce->itag >= ct->itag)
                             continue;
@@ -633,7 +889,7 @@ namespace lsp
                         dsp::calc_plane_v1p2(&spl[0], &pl, ct->v[0], ct->v[1]);
                         dsp::calc_plane_v1p2(&spl[1], &pl, ct->v[1], ct->v[2]);
                         dsp::calc_plane_v1p2(&spl[2], &pl, ct->v[2], ct->v[0]);
-                    RT_FOREACH_END
+                    }
                 }
 
                 return STATUS_OK;
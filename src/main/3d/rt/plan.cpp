@@ -47,6 +47,11 @@ namespace lsp
             {
             }
 
+            plan_t::plan_t(Arena3D *arena):
+                items(1024, arena)
+            {
+            }
+
             plan_t::~plan_t()
             {
                 items.flush();
@@ -54,7 +59,7 @@ namespace lsp
 
             status_t plan_t::cut_out(const dsp::vector3d_t *pl)
             {
-                plan_t tmp;
+                plan_t tmp(items.arena());
                 rt::split_t *sp;
 
                 RT_FOREACH(rt::split_t, s, items)
@@ -95,7 +100,7 @@ namespace lsp
 
             status_t plan_t::cut_in(const dsp::vector3d_t *pl)
             {
-                plan_t tmp;
+                plan_t tmp(items.arena());
                 rt::split_t *sp;
 
                 RT_FOREACH(rt::split_t, s, items)
@@ -136,7 +141,7 @@ namespace lsp
 
             status_t plan_t::split(plan_t *out, const dsp::vector3d_t *pl)
             {
-                plan_t xin, xout;
+                plan_t xin(items.arena()), xout(items.arena());
 
                 dsp::point3d_t sp;
                 rt::split_t *si, *so;
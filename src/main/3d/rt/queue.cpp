@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/dsp-units/3d/rt/queue.h>
+#include <lsp-plug.in/common/atomic.h>
+#include <lsp-plug.in/stdlib/stdlib.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        namespace rt
+        {
+            static inline ssize_t load_index(const ssize_t *ptr)
+            {
+                return *(reinterpret_cast<const volatile ssize_t *>(ptr));
+            }
+
+            task_queue_t::task_queue_t()
+            {
+                vItems      = NULL;
+                nMask       = 0;
+                nTop        = 0;
+                nBottom     = 0;
+            }
+
+            task_queue_t::~task_queue_t()
+            {
+                destroy();
+            }
+
+            status_t task_queue_t::init(size_t capacity)
+            {
+                size_t cap      = 1;
+                while (cap < capacity)
+                    cap           <<= 1;
+
+                rt::context_t **items = reinterpret_cast<rt::context_t **>(::malloc(sizeof(rt::context_t *) * cap));
+                if (items == NULL)
+                    return STATUS_NO_MEM;
+
+                destroy();
+
+                vItems      = items;
+                nMask       = cap - 1;
+                nTop        = 0;
+                nBottom     = 0;
+
+                return STATUS_OK;
+            }
+
+            void task_queue_t::destroy()
+            {
+                if (vItems != NULL)
+                {
+                    ::free(vItems);
+                    vItems      = NULL;
+                }
+                nMask       = 0;
+                nTop        = 0;
+                nBottom     = 0;
+            }
+
+            size_t task_queue_t::size() const
+            {
+                ssize_t size    = load_index(&nBottom) - load_index(&nTop);
+                return (size > 0) ? size : 0;
+            }
+
+            bool task_queue_t::push(rt::context_t *ctx)
+            {
+                if (vItems == NULL)
+                    return false;
+
+                ssize_t b       = load_index(&nBottom);
+                ssize_t t       = load_index(&nTop);
+                if (size_t(b - t) > nMask)
+                    return false;
+
+                // Store the item and then publish it by updating the bottom index
+                vItems[b & nMask]   = ctx;
+                atomic_swap(&nBottom, b + 1);
+
+                return true;
+            }
+
+            rt::context_t *task_queue_t::pop()
+            {
+                if (vItems == NULL)
+                    return NULL;
+
+                // Reserve the bottom item, atomic_swap acts as a full memory barrier here
+                ssize_t b       = load_index(&nBottom) - 1;
+                atomic_swap(&nBottom, b);
+                ssize_t t       = load_index(&nTop);
+
+                // Queue is empty?
+                if (t > b)
+                {
+                    atomic_swap(&nBottom, b + 1);
+                    return NULL;
+                }
+
+                rt::context_t *ctx  = vItems[b & nMask];
+                if (t < b)
+                    return ctx;
+
+                // This is the last item, we're racing with thieves
+                if (!atomic_cas(&nTop, t, t + 1))
+                    ctx             = NULL;
+                atomic_swap(&nBottom, b + 1);
+
+                return ctx;
+            }
+
+            rt::context_t *task_queue_t::steal()
+            {
+                if (vItems == NULL)
+                    return NULL;
+
+                // atomic_add() guarantees that top is read before bottom
+                ssize_t t       = atomic_add(&nTop, ssize_t(0));
+                ssize_t b       = load_index(&nBottom);
+                if (t >= b)
+                    return NULL;
+
+                rt::context_t *ctx  = vItems[t & nMask];
+                return (atomic_cas(&nTop, t, t + 1)) ? ctx : NULL;
+            }
+
+        } // namespace rt
+    } // namespace dspu
+} // namespace lsp
@@ -21,6 +21,9 @@
 
 #include <lsp-plug.in/dsp-units/ctl/Bypass.h>
 #include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define BYPASS_BLOCK_SIZE       0x100
 
 namespace lsp
 {
@@ -41,6 +44,7 @@ namespace lsp
             nState      = S_OFF;
             fDelta      = 0;
             fGain       = 0;
+            enCurve     = XFADE_LINEAR;
         }
 
         void Bypass::destroy()
@@ -105,103 +109,101 @@ namespace lsp
 
         void Bypass::process(float *dst, const float *dry, const float *wet, size_t count)
         {
-            // Skip empty buffers
-            if (count == 0)
-                return;
+            process(&dst, &dry, &wet, 1, count);
+        }
 
+        static void bypass_mix(float *dst, const float *dry, const float *wet,
+                const float *g_dry, const float *g_wet, float *buf, size_t count)
+        {
+            if (wet != NULL)
+                dsp::mul3(buf, wet, g_wet, count);
+            else
+                dsp::fill_zero(buf, count);
             if (dry != NULL)
+                dsp::fmadd3(buf, dry, g_dry, count);
+            dsp::copy(dst, buf, count);
+        }
+
+        void Bypass::process(float * const *dst, const float * const *dry, const float * const *wet,
+                size_t channels, size_t count)
+        {
+            float g_dry[BYPASS_BLOCK_SIZE], g_wet[BYPASS_BLOCK_SIZE], buf[BYPASS_BLOCK_SIZE];
+
+            for (size_t offset=0; offset < count; )
             {
-                // Analyze direction
+                // Compute the transition ramp shared by all channels
+                size_t to_do    = lsp_min(count - offset, size_t(BYPASS_BLOCK_SIZE));
+                size_t n        = 0;
                 if (fDelta > 0.0f)
                 {
-                    // Process transition
-                    while (fGain < 1.0)
+                    for ( ; (n < to_do) && (fGain < 1.0f); ++n)
                     {
-                        *dst    =   *dry + (*wet - *dry) * fGain;
-
-                        fGain   +=  fDelta;
-                        dry     ++;
-                        wet     ++;
-                        dst     ++;
-
-                        if ((--count) <= 0) // Last sample?
-                            return;
+                        g_wet[n]        = fGain;
+                        fGain          += fDelta;
                     }
-
-                    // Copy wet data
-                    fGain   = 1.0;
-                    nState  = S_OFF;
-                    if (count > 0)
-                        dsp::copy(dst, wet, count);
                 }
                 else
                 {
-                    // Process transition
-                    while (fGain > 0.0)
+                    for ( ; (n < to_do) && (fGain > 0.0f); ++n)
                     {
-                        *dst    =   *dry + (*wet - *dry) * fGain;
-
-                        fGain   +=  fDelta;
-                        dry     ++;
-                        wet     ++;
-                        dst     ++;
-
-                        if ((--count) <= 0) // Last sample?
-                            return;
+                        g_wet[n]        = fGain;
+                        fGain          += fDelta;
                     }
-
-                    // Copy dry data
-                    fGain   = 0.0;
-                    nState  = S_ON;
-                    if (count > 0)
-                        dsp::copy(dst, dry, count);
                 }
-            }
-            else
-            {
-                // Analyze direction
-                if (fDelta > 0.0f)
+
+                if (n > 0)
                 {
-                    // Process transition
-                    while (fGain < 1.0)
+                    if (enCurve == XFADE_EQUAL_POWER)
                     {
-                        *dst    =   (*wet) * fGain;
-
-                        fGain   +=  fDelta;
-                        wet     ++;
-                        dst     ++;
-
-                        if ((--count) <= 0) // Last sample?
-                            return;
+                        for (size_t j=0; j<n; ++j)
+                        {
+                            float x         = lsp_limit(g_wet[j], 0.0f, 1.0f) * M_PI_2;
+                            g_wet[j]        = sinf(x);
+                            g_dry[j]        = cosf(x);
+                        }
+                    }
+                    else
+                    {
+                        for (size_t j=0; j<n; ++j)
+                            g_dry[j]        = 1.0f - g_wet[j];
                     }
 
-                    // Copy wet data
-                    fGain   = 1.0;
-                    nState  = S_OFF;
-                    if (count > 0)
-                        dsp::copy(dst, wet, count);
-                }
-                else
-                {
                     // Process transition
-                    while (fGain > 0.0)
+                    for (size_t i=0; i<channels; ++i)
                     {
-                        *dst    =   (*wet) * fGain;
+                        const float *d  = ((dry != NULL) && (dry[i] != NULL)) ? &dry[i][offset] : NULL;
+                        const float *w  = (wet[i] != NULL) ? &wet[i][offset] : NULL;
+                        bypass_mix(&dst[i][offset], d, w, g_dry, g_wet, buf, n);
+                    }
 
-                        fGain   +=  fDelta;
-                        wet     ++;
-                        dst     ++;
+                    offset         += n;
+                    if (n >= to_do)
+                        continue;
+                }
 
-                        if ((--count) <= 0) // Last sample?
-                            return;
-                    }
+                // The transition is complete, pass wet or dry data
+                const float * const *src;
+                if (fDelta > 0.0f)
+                {
+                    fGain       = 1.0f;
+                    nState      = S_OFF;
+                    src         = wet;
+                }
+                else
+                {
+                    fGain       = 0.0f;
+                    nState      = S_ON;
+                    src         = dry;
+                }
 
-                    // Copy dry data
-                    fGain   = 0.0;
-                    nState  = S_ON;
-                    if (count > 0)
-                        dsp::fill_zero(dst, count);
+                for (size_t i=0; i<channels; ++i)
+                {
+                    if ((src != NULL) && (src[i] != NULL))
+                        dsp::copy(&dst[i][offset], &src[i][offset], count - offset);
+                    else
+                        dsp::fill_zero(&dst[i][offset], count - offset);
                 }
+                break;
             }
         }
 
@@ -210,6 +212,7 @@ namespace lsp
             v->write("nState", nState);
             v->write("fDelta", fDelta);
             v->write("fGain", fGain);
+            v->write("enCurve", enCurve);
         }
     }
 } /* namespace lsp */
@@ -21,6 +21,9 @@
 
 #include <lsp-plug.in/dsp-units/ctl/Crossfade.h>
 #include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define XFADE_BLOCK_SIZE        0x100
 
 namespace lsp
 {
@@ -42,6 +45,7 @@ namespace lsp
             nCounter    = 0;
             fDelta      = 0.0f;
             fGain       = 1.0f;
+            enCurve     = XFADE_LINEAR;
         }
 
         void Crossfade::destroy()
@@ -75,83 +79,79 @@ namespace lsp
 
         void Crossfade::process(float *dst, const float *fade_out, const float *fade_in, size_t count)
         {
-            // Skip empty buffers
-            if (count == 0)
-                return;
+            process(&dst, &fade_out, &fade_in, 1, count);
+        }
 
-            if (fade_out == NULL)
+        static void crossfade_gains(float *g_out, float *g_in, crossfade_curve_t curve, float gain, float delta, size_t count)
+        {
+            if (curve == XFADE_EQUAL_POWER)
             {
-                if (fade_in == NULL)
+                for (size_t i=0; i<count; ++i)
                 {
-                    size_t delta    = (nCounter < count) ? nCounter : count;
-                    nCounter       -= delta;
-                    fGain          += fDelta * delta;
-
-                    dsp::fill_zero(dst, count);
-                    return;
+                    float x         = lsp_limit(gain, 0.0f, 1.0f) * M_PI_2;
+                    g_in[i]         = sinf(x);
+                    g_out[i]        = cosf(x);
+                    gain           += delta;
                 }
-
-                // Perform crossfade
-                while (nCounter > 0)
+            }
+            else
+            {
+                for (size_t i=0; i<count; ++i)
                 {
-                    *dst            = *fade_in * fGain;
-                    fGain          += fDelta;
-
-                    --nCounter;
-                    ++fade_in;
-                    ++dst;
-                    if ((--count) <= 0)
-                        return;
+                    g_in[i]         = gain;
+                    g_out[i]        = 1.0f - gain;
+                    gain           += delta;
                 }
-
-                // Just bypass fade_in to output
-                if (fGain > 0.0f)
-                    dsp::copy(dst, fade_in, count);
-                else
-                    dsp::fill_zero(dst, count);
             }
+        }
+
+        static void crossfade_mix(float *dst, const float *fade_out, const float *fade_in,
+                const float *g_out, const float *g_in, float *buf, size_t count)
+        {
+            if (fade_in != NULL)
+                dsp::mul3(buf, fade_in, g_in, count);
             else
+                dsp::fill_zero(buf, count);
+            if (fade_out != NULL)
+                dsp::fmadd3(buf, fade_out, g_out, count);
+            dsp::copy(dst, buf, count);
+        }
+
+        void Crossfade::process(float * const *dst, const float * const *fade_out, const float * const *fade_in,
+                size_t channels, size_t count)
+        {
+            float g_out[XFADE_BLOCK_SIZE], g_in[XFADE_BLOCK_SIZE], buf[XFADE_BLOCK_SIZE];
+
+            // Perform crossfade, the gain curves are shared between channels
+            size_t offset   = 0;
+            while ((nCounter > 0) && (offset < count))
             {
-                if (fade_in == NULL)
+                size_t to_do    = lsp_min(lsp_min(nCounter, count - offset), size_t(XFADE_BLOCK_SIZE));
+                crossfade_gains(g_out, g_in, enCurve, fGain, fDelta, to_do);
+
+                for (size_t i=0; i<channels; ++i)
                 {
-                    // Perform crossfade
-                    while (nCounter > 0)
-                    {
-                        *dst            = *fade_out * (1.0f - fGain);
-                        fGain          += fDelta;
-
-                        --nCounter;
-                        ++fade_out;
-                        ++dst;
-                        if ((--count) <= 0)
-                            return;
-                    }
-
-                    // Fill output
-                    if (fGain > 0.0f)
-                        dsp::fill_zero(dst, count);
-                    else
-                        dsp::copy(dst, fade_out, count);
+                    const float *out    = ((fade_out != NULL) && (fade_out[i] != NULL)) ? &fade_out[i][offset] : NULL;
+                    const float *in     = ((fade_in != NULL) && (fade_in[i] != NULL)) ? &fade_in[i][offset] : NULL;
+                    crossfade_mix(&dst[i][offset], out, in, g_out, g_in, buf, to_do);
                 }
+
+                fGain          += fDelta * to_do;
+                nCounter       -= to_do;
+                offset         += to_do;
+            }
+
+            if (offset >= count)
+                return;
+
+            // Just bypass the active signal to output
+            const float * const *src = (fGain > 0.0f) ? fade_in : fade_out;
+            for (size_t i=0; i<channels; ++i)
+            {
+                if ((src != NULL) && (src[i] != NULL))
+                    dsp::copy(&dst[i][offset], &src[i][offset], count - offset);
                 else
-                {
-                    // Perform crossfade
-                    while (nCounter > 0)
-                    {
-                        *dst            = *fade_out + (*fade_in - *fade_out) * fGain;
-                        fGain          += fDelta;
-
-                        --nCounter;
-                        ++fade_in;
-                        ++fade_out;
-                        ++dst;
-                        if ((--count) <= 0)
-                            return;
-                    }
-
-                    // Just bypass fade_in to output
-                    dsp::copy(dst, (fGain > 0.0f) ? fade_in : fade_out, count);
-                }
+                    dsp::fill_zero(&dst[i][offset], count - offset);
             }
         }
 
@@ -161,6 +161,7 @@ namespace lsp
             v->write("nCounter", nCounter);
             v->write("fDelta", fDelta);
             v->write("fGain", fGain);
+            v->write("enCurve", enCurve);
         }
     } /* namespace dspu */
 } /* namespace lsp */
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <lsp-plug.in/dsp-units/ctl/IdleDetector.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        IdleDetector::IdleDetector()
+        {
+            construct();
+        }
+
+        IdleDetector::~IdleDetector()
+        {
+            destroy();
+        }
+
+        void IdleDetector::construct()
+        {
+            fThreshold      = 0.0f;
+            nTail           = 0;
+            nLeft           = 0;
+            bIdle           = false;
+        }
+
+        void IdleDetector::destroy()
+        {
+        }
+
+        void IdleDetector::set_threshold(float threshold)
+        {
+            if (fThreshold == threshold)
+                return;
+            fThreshold      = threshold;
+            wake();
+        }
+
+        void IdleDetector::set_tail(size_t samples)
+        {
+            // The idle unit has no tail to process, the active unit processes the longest tail
+            nTail           = samples;
+            if (!bIdle)
+                nLeft           = lsp_max(nLeft, samples);
+        }
+
+        bool IdleDetector::process(const float *src, size_t samples)
+        {
+            if (fThreshold <= 0.0f)
+                return false;
+
+            // Non-silent input wakes up the unit immediately
+            if ((src != NULL) && (dsp::abs_max(src, samples) > fThreshold))
+            {
+                nLeft           = nTail;
+                bIdle           = false;
+                return false;
+            }
+
+            // Process the rest of the tail
+            if (nLeft > 0)
+            {
+                nLeft          -= lsp_min(nLeft, samples);
+                return false;
+            }
+
+            bIdle           = true;
+            return true;
+        }
+
+        bool IdleDetector::process(const float * const *src, size_t channels, size_t samples)
+        {
+            if (fThreshold <= 0.0f)
+                return false;
+
+            for (size_t i=0; i<channels; ++i)
+            {
+                if ((src[i] != NULL) && (dsp::abs_max(src[i], samples) > fThreshold))
+                {
+                    nLeft           = nTail;
+                    bIdle           = false;
+                    return false;
+                }
+            }
+
+            return process(static_cast<const float *>(NULL), samples);
+        }
+
+        size_t IdleDetector::decay_tail(float radius, float threshold)
+        {
+            radius          = fabsf(radius);
+            if (radius <= 0.0f)
+                return 0;
+            if (radius >= 1.0f)
+                return IDLE_TAIL_INFINITE;
+
+            float n         = logf(threshold) / logf(radius);
+            return (n >= float(IDLE_TAIL_INFINITE >> 1)) ? IDLE_TAIL_INFINITE : size_t(n) + 1;
+        }
+
+        void IdleDetector::dump(IStateDumper *v) const
+        {
+            v->write("fThreshold", fThreshold);
+            v->write("nTail", nTail);
+            v->write("nLeft", nLeft);
+            v->write("bIdle", bIdle);
+        }
+    } /* namespace dspu */
+} /* namespace lsp */
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/dsp-units/ctl/ParamEvents.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        ParamEvents::ParamEvents()
+        {
+            construct();
+        }
+
+        ParamEvents::~ParamEvents()
+        {
+            destroy();
+        }
+
+        void ParamEvents::construct()
+        {
+        }
+
+        void ParamEvents::destroy()
+        {
+            vEvents.flush();
+        }
+
+        bool ParamEvents::add(size_t offset, size_t id, float value)
+        {
+            if (vEvents.add() == NULL)
+                return false;
+
+            // Events usually come in order, so the position is found from the end
+            size_t pos      = vEvents.size() - 1;
+            for ( ; pos > 0; --pos)
+            {
+                param_event_t *prev = vEvents.uget(pos - 1);
+                if (prev->offset <= offset)
+                    break;
+                *(vEvents.uget(pos))    = *prev;
+            }
+
+            param_event_t *ev   = vEvents.uget(pos);
+            ev->offset      = offset;
+            ev->id          = id;
+            ev->value       = value;
+
+            return true;
+        }
+
+        size_t ParamEvents::apply(size_t *index, size_t offset, size_t samples, param_setter_t setter, void *object) const
+        {
+            size_t i        = *index;
+            size_t n        = vEvents.size();
+
+            // Apply all events up to the current offset, late events are applied immediately
+            for ( ; i < n; ++i)
+            {
+                const param_event_t *ev = vEvents.uget(i);
+                if (ev->offset > offset)
+                    break;
+                setter(object, ev->id, ev->value);
+            }
+            *index          = i;
+
+            // Compute the length of the sub-block
+            if (i >= n)
+                return samples;
+            return lsp_min(vEvents.uget(i)->offset - offset, samples);
+        }
+
+        void ParamEvents::apply_tail(size_t *index, param_setter_t setter, void *object) const
+        {
+            for (size_t i=*index, n=vEvents.size(); i < n; ++i)
+            {
+                const param_event_t *ev = vEvents.uget(i);
+                setter(object, ev->id, ev->value);
+            }
+            *index          = vEvents.size();
+        }
+
+        void ParamEvents::dump(IStateDumper *v) const
+        {
+            size_t n = vEvents.size();
+            v->begin_array("vEvents", vEvents.array(), n);
+            for (size_t i=0; i<n; ++i)
+            {
+                const param_event_t *ev = vEvents.uget(i);
+                v->begin_object(ev, sizeof(param_event_t));
+                {
+                    v->write("offset", ev->offset);
+                    v->write("id", ev->id);
+                    v->write("value", ev->value);
+                }
+                v->end_object();
+            }
+            v->end_array();
+        }
+    } /* namespace dspu */
+} /* namespace lsp */
@@ -0,0 +1,289 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/dsp-units/ctl/Scheduler.h>
+#include <lsp-plug.in/stdlib/stdlib.h>
+
+#define SCHEDULER_SLOT_MASK     (SCHEDULER_SLOTS - 1)
+
+namespace lsp
+{
+    namespace dspu
+    {
+        Scheduler::Scheduler()
+        {
+            construct();
+        }
+
+        Scheduler::~Scheduler()
+        {
+            destroy();
+        }
+
+        void Scheduler::construct()
+        {
+            for (size_t i=0; i<SCHEDULER_SLOTS; ++i)
+                vSlots[i]       = -1;
+            nFree           = -1;
+            nTime           = 0;
+            nActive         = 0;
+        }
+
+        void Scheduler::destroy()
+        {
+            vTimers.flush();
+            vEvents.flush();
+            construct();
+        }
+
+        void Scheduler::clear()
+        {
+            vTimers.clear();
+            vEvents.clear();
+            construct();
+        }
+
+        void Scheduler::link(size_t id, timer_t *t)
+        {
+            ssize_t slot    = (t->nDeadline >> SCHEDULER_SLOT_SHIFT) & SCHEDULER_SLOT_MASK;
+            ssize_t head    = vSlots[slot];
+
+            t->nSlot        = slot;
+            t->nPrev        = -1;
+            t->nNext        = head;
+            if (head >= 0)
+                vTimers.uget(head)->nPrev   = id;
+            vSlots[slot]    = id;
+        }
+
+        void Scheduler::unlink(timer_t *t)
+        {
+            if (t->nSlot < 0)
+                return;
+
+            if (t->nPrev >= 0)
+                vTimers.uget(t->nPrev)->nNext   = t->nNext;
+            else
+                vSlots[t->nSlot]    = t->nNext;
+            if (t->nNext >= 0)
+                vTimers.uget(t->nNext)->nPrev   = t->nPrev;
+
+            t->nSlot        = -1;
+            t->nPrev        = -1;
+            t->nNext        = -1;
+        }
+
+        ssize_t Scheduler::add(size_t delay, size_t period, void *tag)
+        {
+            // Reuse the removed timer or allocate new one
+            ssize_t id;
+            timer_t *t;
+            if (nFree >= 0)
+            {
+                id              = nFree;
+                t               = vTimers.uget(id);
+                nFree           = t->nNext;
+            }
+            else
+            {
+                id              = vTimers.size();
+                if ((t = vTimers.add()) == NULL)
+                    return -STATUS_NO_MEM;
+            }
+
+            t->nDeadline    = nTime + delay;
+            t->nPeriod      = period;
+            t->bUsed        = true;
+            t->pTag         = tag;
+            link(id, t);
+            ++nActive;
+
+            return id;
+        }
+
+        bool Scheduler::set(size_t id, size_t delay, size_t period)
+        {
+            timer_t *t      = vTimers.get(id);
+            if ((t == NULL) || (!t->bUsed))
+                return false;
+
+            if (t->nSlot < 0)
+                ++nActive;
+            else
+                unlink(t);
+
+            t->nDeadline    = nTime + delay;
+            t->nPeriod      = period;
+            link(id, t);
+
+            return true;
+        }
+
+        bool Scheduler::cancel(size_t id)
+        {
+            timer_t *t      = vTimers.get(id);
+            if ((t == NULL) || (!t->bUsed))
+                return false;
+
+            if (t->nSlot >= 0)
+            {
+                unlink(t);
+                --nActive;
+            }
+
+            return true;
+        }
+
+        bool Scheduler::remove(size_t id)
+        {
+            if (!cancel(id))
+                return false;
+
+            timer_t *t      = vTimers.uget(id);
+            t->bUsed        = false;
+            t->pTag         = NULL;
+            t->nNext        = nFree;
+            nFree           = id;
+
+            return true;
+        }
+
+        bool Scheduler::active(size_t id) const
+        {
+            const timer_t *t    = vTimers.get(id);
+            return (t != NULL) && (t->bUsed) && (t->nSlot >= 0);
+        }
+
+        ssize_t Scheduler::pending(size_t id) const
+        {
+            const timer_t *t    = vTimers.get(id);
+            if ((t == NULL) || (!t->bUsed) || (t->nSlot < 0))
+                return -1;
+            return t->nDeadline - nTime;
+        }
+
+        int Scheduler::cmp_events(const void *a, const void *b)
+        {
+            const event_t *ea   = static_cast<const event_t *>(a);
+            const event_t *eb   = static_cast<const event_t *>(b);
+            if (ea->offset != eb->offset)
+                return (ea->offset < eb->offset) ? -1 : 1;
+            return (ea->id < eb->id) ? -1 : (ea->id > eb->id) ? 1 : 0;
+        }
+
+        size_t Scheduler::process(size_t samples)
+        {
+            vEvents.clear();
+            if (samples <= 0)
+                return 0;
+
+            // Visit only the slots covered by the block, each slot not more than once
+            uint64_t end        = nTime + samples;
+            uint64_t first      = nTime >> SCHEDULER_SLOT_SHIFT;
+            uint64_t last       = (end - 1) >> SCHEDULER_SLOT_SHIFT;
+            size_t nslots       = lsp_min(last - first + 1, uint64_t(SCHEDULER_SLOTS));
+
+            for (size_t i=0; i<nslots; ++i)
+            {
+                size_t slot         = (first + i) & SCHEDULER_SLOT_MASK;
+
+                // Detach the list of the slot, timers that do not fire are linked back
+                ssize_t id          = vSlots[slot];
+                vSlots[slot]        = -1;
+
+                while (id >= 0)
+                {
+                    timer_t *t          = vTimers.uget(id);
+                    ssize_t next        = t->nNext;
+
+                    if (t->nDeadline < end)
+                    {
+                        // Emit all events of the timer that fall into the block
+                        do
+                        {
+                            event_t *ev         = vEvents.add();
+                            if (ev != NULL)
+                            {
+                                ev->id              = id;
+                                ev->offset          = t->nDeadline - nTime;
+                                ev->tag             = t->pTag;
+                            }
+                            if (t->nPeriod <= 0)
+                                break;
+                            t->nDeadline       += t->nPeriod;
+                        } while (t->nDeadline < end);
+
+                        if (t->nPeriod > 0)
+                            link(id, t);
+                        else
+                        {
+                            t->nSlot            = -1;
+                            t->nPrev            = -1;
+                            t->nNext            = -1;
+                            --nActive;
+                        }
+                    }
+                    else
+                        link(id, t);
+
+                    id                  = next;
+                }
+            }
+
+            nTime               = end;
+
+            // Timers of the same slot are not ordered, sort events by offset
+            size_t n            = vEvents.size();
+            if (n > 1)
+                ::qsort(vEvents.array(), n, sizeof(event_t), cmp_events);
+
+            return n;
+        }
+
+        void Scheduler::dump(IStateDumper *v) const
+        {
+            v->begin_array("vTimers", vTimers.array(), vTimers.size());
+            for (size_t i=0, n=vTimers.size(); i<n; ++i)
+            {
+                const timer_t *t    = vTimers.uget(i);
+                v->begin_object(t, sizeof(timer_t));
+                {
+                    v->write("nDeadline", t->nDeadline);
+                    v->write("nPeriod", t->nPeriod);
+                    v->write("nNext", t->nNext);
+                    v->write("nPrev", t->nPrev);
+                    v->write("nSlot", t->nSlot);
+                    v->write("bUsed", t->bUsed);
+                    v->write("pTag", t->pTag);
+                }
+                v->end_object();
+            }
+            v->end_array();
+
+            v->write("nEvents", vEvents.size());
+            v->writev("vSlots", vSlots, SCHEDULER_SLOTS);
+            v->write("nFree", nFree);
+            v->write("nTime", nTime);
+            v->write("nActive", nActive);
+        }
+    }
+} /* namespace lsp */
@@ -28,11 +28,17 @@
 #include <lsp-plug.in/dsp-units/dynamics/Compressor.h>
 
 #define RATIO_PREC              1e-5f
+#define BATCH_SIZE              0x100
 
 namespace lsp
 {
     namespace dspu
     {
+        static float compressor_gain(void *object, float x)
+        {
+            return static_cast<Compressor *>(object)->reduction(x);
+        }
+
         Compressor::Compressor()
         {
             construct();
@@ -75,14 +81,42 @@ namespace lsp
             fBKE            = 0.0f;
             fBoost          = 1.0f;
 
+            // Gain table
+            sTable.construct();
+            nTable          = GT_OFF;
+            fTableError     = GAIN_TABLE_DFL_ERROR;
+
+            // Lookahead
+            sDelay.construct();
+            fLookahead      = 0.0f;
+
             // Additional parameters
             nSampleRate     = 0;
             nMode           = CM_DOWNWARD;
+            nVersion        = 0;
             bUpdate         = true;
         }
 
         void Compressor::destroy()
         {
+            sTable.destroy();
+            sDelay.destroy();
+        }
+
+        bool Compressor::init(size_t channels, size_t max_sr, float max_lookahead)
+        {
+            if (!sDelay.init(channels, millis_to_samples(max_sr, max_lookahead)))
+                return false;
+            bUpdate         = true;
+            return true;
+        }
+
+        void Compressor::set_lookahead(float lookahead)
+        {
+            if (lookahead == fLookahead)
+                return;
+            fLookahead  = lookahead;
+            bUpdate     = true;
         }
 
         void Compressor::update_settings()
@@ -152,7 +186,14 @@ namespace lsp
                     break;
             }
 
+            // Build the gain table
+            sTable.build(compressor_gain, this, gain_table_mode_t(nTable), fTableError);
+
+            // Update lookahead
+            sDelay.set_delay(millis_to_samples(nSampleRate, fLookahead));
+
             // Reset update flag
+            ++nVersion;
             bUpdate         = false;
         }
 
@@ -176,7 +217,98 @@ namespace lsp
                 dsp::copy(env, out, samples);
 
             // Now calculate compressor's curve
-            reduction(out, out, samples);
+            if (sTable.enabled())
+                sTable.process(out, out, samples);
+            else
+                reduction(out, out, samples);
+        }
+
+        void Compressor::process(float * const *dst, float *gain, float *env, const float * const *src, const float *sc, size_t samples)
+        {
+            process(gain, env, sc, samples);
+            sDelay.process(dst, src, gain, samples);
+        }
+
+        bool Compressor::update_settings(SettingsBuffer<compressor_settings_t> *settings)
+        {
+            bool fetched = settings->fetch();
+            if (fetched)
+                set_settings(settings->current());
+            if (bUpdate)
+                update_settings();
+            return fetched;
+        }
+
+        void Compressor::get_settings(compressor_settings_t *settings) const
+        {
+            settings->fAttackThresh     = fAttackThresh;
+            settings->fReleaseThresh    = fReleaseThresh;
+            settings->fBoostThresh      = fBoostThresh;
+            settings->fAttack           = fAttack;
+            settings->fRelease          = fRelease;
+            settings->fKnee             = fKnee;
+            settings->fRatio            = fRatio;
+            settings->fLookahead        = fLookahead;
+            settings->nMode             = nMode;
+        }
+
+        void Compressor::set_settings(const compressor_settings_t *settings)
+        {
+            set_threshold(settings->fAttackThresh, settings->fReleaseThresh);
+            set_boost_threshold(settings->fBoostThresh);
+            set_timings(settings->fAttack, settings->fRelease);
+            set_knee(settings->fKnee);
+            set_ratio(settings->fRatio);
+            set_lookahead(settings->fLookahead);
+            set_mode(settings->nMode);
+        }
+
+        void Compressor::set_param(void *object, size_t id, float value)
+        {
+            Compressor *self    = static_cast<Compressor *>(object);
+
+            switch (id)
+            {
+                case CP_ATTACK_THRESH:  self->set_threshold(value, self->fReleaseThresh); break;
+                case CP_RELEASE_THRESH: self->set_threshold(self->fAttackThresh, value); break;
+                case CP_BOOST_THRESH:   self->set_boost_threshold(value); break;
+                case CP_ATTACK:         self->set_attack(value); break;
+                case CP_RELEASE:        self->set_release(value); break;
+                case CP_KNEE:           self->set_knee(value); break;
+                case CP_RATIO:          self->set_ratio(value); break;
+                case CP_MODE:           self->set_mode(size_t(value)); break;
+                default: break;
+            }
+        }
+
+        void Compressor::process(float *out, float *env, const float *in, size_t samples, const ParamEvents *events)
+        {
+            if ((events == NULL) || (events->size() <= 0))
+            {
+                process(out, env, in, samples);
+                return;
+            }
+
+            size_t index    = 0;
+            for (size_t offset=0; offset < samples; )
+            {
+                size_t to_do    = events->apply(&index, offset, samples - offset, set_param, this);
+                if (modified())
+                    update_settings();
+
+                process(&out[offset], (env != NULL) ? &env[offset] : NULL, &in[offset], to_do);
+                offset         += to_do;
+            }
+
+            // Events beyond the block take effect for the next block
+            events->apply_tail(&index, set_param, this);
+        }
+
+        void Compressor::process(float * const *dst, float *gain, float *env, const float * const *src, const float *sc,
+            size_t samples, const ParamEvents *events)
+        {
+            process(gain, env, sc, samples, events);
+            sDelay.process(dst, src, gain, samples);
         }
 
         float Compressor::process(float *env, float s)
@@ -189,51 +321,21 @@ namespace lsp
             if (env != NULL)
                 *env    = fEnvelope;
 
-            return reduction(fEnvelope);
+            return (sTable.enabled()) ? sTable.process(fEnvelope) : reduction(fEnvelope);
         }
 
         void Compressor::curve(float *out, const float *in, size_t dots)
         {
-            if (nMode == CM_DOWNWARD)
-            {
-                for (size_t i=0; i<dots; ++i)
-                {
-                    float x     = fabs(in[i]);
+            // The curve is the input level multiplied by the vectorized gain reduction
+            float vx[BATCH_SIZE];
 
-                    if (x > fKS)
-                    {
-                        float lx    = logf(x);
-                        out[i]      = (x >= fKE) ?
-                            expf(fXRatio*(lx - fLogTH) + fLogTH) :
-                            expf((vHermite[0]*lx + vHermite[1])*lx + vHermite[2]);
-                    }
-                    else
-                        out[i]      = x;
-                }
-            }
-            else
+            for (size_t offset=0; offset < dots; )
             {
-                for (size_t i=0; i<dots; ++i)
-                {
-                    float x     = fabs(in[i]);
-                    float lx    = logf(x);
-                    float g1    = 1.0f, g2 = 1.0f;
-                    if (x > fBKS)
-                    {
-                        g1  = (x >= fBKE) ?
-                            expf((fXRatio - 1.0f)*(lx-fBLogTH)) :
-                            expf((vBHermite[0]*lx + vBHermite[1] - 1.0f)*lx + vBHermite[2]);
-                    }
-
-                    if (x > fKS)
-                    {
-                        g2  = (x >= fKE) ?
-                            expf((1.0f - fXRatio)*(lx-fLogTH)) :
-                            expf((vHermite[0]*lx + vHermite[1] - 1.0f)*lx + vHermite[2]);
-                    }
-
-                    out[i]      = x * g1 * g2 * fBoost;
-                }
+                size_t to_do    = lsp_min(dots - offset, size_t(BATCH_SIZE));
+                dsp::abs2(vx, &in[offset], to_do);
+                reduction(&out[offset], vx, to_do);
+                dsp::mul2(&out[offset], vx, to_do);
+                offset         += to_do;
             }
         }
 
@@ -277,44 +379,105 @@ namespace lsp
 
         void Compressor::reduction(float *out, const float *in, size_t dots)
         {
+            // The gain is computed in logarithmic domain by blocks: one vectorized
+            // logarithm, branch-free knee curves and one vectorized exponent per block
+            static const float zero[2] = { 0.0f, 0.0f };
+
+            float log_ks    = logf(fKS);
+            float log_ke    = logf(fKE);
+            float k[4], l[2];
+
+            k[0]            = 0.0f;
+            k[1]            = vHermite[0];
+            k[2]            = vHermite[1] - 1.0f;
+            k[3]            = vHermite[2];
+
             if (nMode == CM_DOWNWARD)
             {
-                for (size_t i=0; i<dots; ++i)
-                {
-                    float x     = fabs(in[i]);
-                    if (x > fKS)
-                    {
-                        float lx    = logf(x);
-                        out[i]  = (x >= fKE) ?
-                            expf((fXRatio-1.0f)*(lx-fLogTH)) :
-                            expf((vHermite[0]*lx + vHermite[1] - 1.0f)*lx + vHermite[2]);
-                    }
-                    else
-                        out[i]      = 1.0f;
-                }
+                l[0]            = fXRatio - 1.0f;
+                l[1]            = -l[0] * fLogTH;
+                interpolation::apply_log_knee(out, in, log_ks, log_ke, zero, k, l, dots);
+                return;
             }
-            else
+
+            float vlx[BATCH_SIZE], vg[BATCH_SIZE];
+            float log_bks   = logf(fBKS);
+            float log_bke   = logf(fBKE);
+            float log_boost = logf(fBoost);
+            float bk[4], bl[2];
+
+            l[0]            = 1.0f - fXRatio;
+            l[1]            = -l[0] * fLogTH;
+            bk[0]           = 0.0f;
+            bk[1]           = vBHermite[0];
+            bk[2]           = vBHermite[1] - 1.0f;
+            bk[3]           = vBHermite[2];
+            bl[0]           = fXRatio - 1.0f;
+            bl[1]           = -bl[0] * fBLogTH;
+
+            for (size_t offset=0; offset < dots; )
             {
-                for (size_t i=0; i<dots; ++i)
+                size_t to_do    = lsp_min(dots - offset, size_t(BATCH_SIZE));
+                dsp::abs2(vlx, &in[offset], to_do);
+                dsp::loge1(vlx, to_do);
+
+                // Sum of the boost knee and the compression knee
+                interpolation::apply_knee(vg, vlx, log_bks, log_bke, zero, bk, bl, to_do);
+                interpolation::apply_knee(vlx, vlx, log_ks, log_ke, zero, k, l, to_do);
+                dsp::add2(vlx, vg, to_do);
+                dsp::add_k2(vlx, log_boost, to_do);
+
+                dsp::exp2(&out[offset], vlx, to_do);
+                offset         += to_do;
+            }
+        }
+
+        void Compressor::process(Compressor * const *list, float * const *out, float * const *env,
+            const float * const *in, size_t count, size_t samples)
+        {
+            float e[COMPRESSOR_LANES], ta[COMPRESSOR_LANES], tr[COMPRESSOR_LANES], rt[COMPRESSOR_LANES];
+            const float *src[COMPRESSOR_LANES];
+            float *dst[COMPRESSOR_LANES];
+
+            for (size_t first=0; first < count; first += COMPRESSOR_LANES)
+            {
+                size_t lanes    = lsp_min(count - first, size_t(COMPRESSOR_LANES));
+
+                // Load the state of the instances into lanes
+                for (size_t j=0; j<lanes; ++j)
                 {
-                    float x     = fabs(in[i]);
-                    float lx    = logf(x);
-                    float g1    = 1.0f, g2 = 1.0f;
-                    if (x > fBKS)
-                    {
-                        g1  = (x >= fBKE) ?
-                            expf((fXRatio - 1.0f)*(lx-fBLogTH)) :
-                            expf((vBHermite[0]*lx + vBHermite[1] - 1.0f)*lx + vBHermite[2]);
-                    }
+                    Compressor *c   = list[first + j];
+                    e[j]            = c->fEnvelope;
+                    ta[j]           = c->fTauAttack;
+                    tr[j]           = c->fTauRelease;
+                    rt[j]           = c->fReleaseThresh;
+                    src[j]          = in[first + j];
+                    dst[j]          = out[first + j];
+                }
 
-                    if (x > fKS)
+                // Compute envelopes of all lanes at once
+                for (size_t i=0; i<samples; ++i)
+                {
+                    for (size_t j=0; j<lanes; ++j)
                     {
-                        g2  = (x >= fKE) ?
-                            expf((1.0f - fXRatio)*(lx-fLogTH)) :
-                            expf((vHermite[0]*lx + vHermite[1] - 1.0f)*lx + vHermite[2]);
+                        float s         = src[j][i];
+                        float tau       = ((e[j] > rt[j]) && (s <= e[j])) ? tr[j] : ta[j];
+                        e[j]           += tau * (s - e[j]);
+                        dst[j][i]       = e[j];
                     }
+                }
 
-                    out[i]      = g1 * g2 * fBoost;
+                // Store the state and compute the gain of each instance
+                for (size_t j=0; j<lanes; ++j)
+                {
+                    Compressor *c   = list[first + j];
+                    c->fEnvelope    = e[j];
+                    if ((env != NULL) && (env[first + j] != NULL))
+                        dsp::copy(env[first + j], dst[j], samples);
+                    if (c->sTable.enabled())
+                        c->sTable.process(dst[j], dst[j], samples);
+                    else
+                        c->reduction(dst[j], dst[j], samples);
                 }
             }
         }
@@ -432,6 +595,16 @@ namespace lsp
             bUpdate     = true;
         }
 
+        void Compressor::set_gain_table(gain_table_mode_t mode, float error)
+        {
+            if ((nTable == size_t(mode)) && (fTableError == error))
+                return;
+
+            nTable      = mode;
+            fTableError = error;
+            bUpdate     = true;
+        }
+
         void Compressor::dump(IStateDumper *v) const
         {
             v->write("fAttackThresh", fAttackThresh);
@@ -454,8 +627,14 @@ namespace lsp
             v->write("fBKE", fBKE);
             v->writev("vBHermite", vBHermite, 3);
             v->write("fBoost", fBoost);
+            v->write_object("sTable", &sTable);
+            v->write("nTable", nTable);
+            v->write("fTableError", fTableError);
+            v->write_object("sDelay", &sDelay);
+            v->write("fLookahead", fLookahead);
             v->write("nSampleRate", nSampleRate);
             v->write("nMode", nMode);
+            v->write("nVersion", nVersion);
             v->write("bUpdate", bUpdate);
         }
     }
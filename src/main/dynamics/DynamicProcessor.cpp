@@ -26,6 +26,8 @@
 #include <lsp-plug.in/dsp/dsp.h>
 #include <lsp-plug.in/dsp-units/units.h>
 
+#define BATCH_SIZE              0x100
+
 namespace lsp
 {
     namespace dspu
@@ -46,6 +48,7 @@ namespace lsp
             fOutRatio       = 1.0f;
             fEnvelope       = 0.0f;
             nSampleRate     = 0.0f;
+            nLink           = DL_MAX;
             bUpdate         = true;
 
             for (size_t i=0; i<DYNAMIC_PROCESSOR_DOTS; ++i)
@@ -291,6 +294,8 @@ namespace lsp
             sort_reactions(vAttack, fCount[CT_ATTACK]);
             sort_reactions(vRelease, fCount[CT_RELEASE]);
             sort_splines(vSplines, fCount[CT_SPLINES]);
+
+            bUpdate             = false;
         }
 
         void DynamicProcessor::process(float *out, float *env, const float *in, size_t samples)
@@ -315,6 +320,45 @@ namespace lsp
             reduction(out, out, samples);
         }
 
+        void DynamicProcessor::link(float *dst, const float * const *in, size_t offset, size_t channels, size_t samples)
+        {
+            dsp::abs2(dst, &in[0][offset], samples);
+
+            if (nLink == DL_AVERAGE)
+            {
+                for (size_t i=1; i<channels; ++i)
+                    dsp::abs_add2(dst, &in[i][offset], samples);
+                dsp::mul_k2(dst, 1.0f / channels, samples);
+            }
+            else
+            {
+                for (size_t i=1; i<channels; ++i)
+                    dsp::pamax2(dst, &in[i][offset], samples);
+            }
+        }
+
+        void DynamicProcessor::process(float *out, float *env, const float * const *in, size_t channels, size_t samples)
+        {
+            if (channels <= 1)
+            {
+                if (channels > 0)
+                    process(out, env, in[0], samples);
+                return;
+            }
+
+            for (size_t offset=0; offset < samples; )
+            {
+                size_t to_do    = lsp_min(samples - offset, size_t(BATCH_SIZE));
+                float *dst      = &out[offset];
+
+                // Link the sidechain signals in the output buffer and compute the common gain
+                link(dst, in, offset, channels, to_do);
+                process(dst, (env != NULL) ? &env[offset] : NULL, dst, to_do);
+
+                offset         += to_do;
+            }
+        }
+
         float DynamicProcessor::process(float *env, float in)
         {
             fEnvelope  += (in > fEnvelope) ?
@@ -417,25 +461,38 @@ namespace lsp
 
         void DynamicProcessor::reduction(float *out, const float *in, size_t dots)
         {
+            // The gain is computed by blocks: one vectorized logarithm, the sum
+            // of all splines evaluated for the whole block and one vectorized exponent
             size_t splines  = fCount[CT_SPLINES];
+            float vlx[BATCH_SIZE], vg[BATCH_SIZE], vk[BATCH_SIZE];
+            float k[4], l0[2], l1[2];
 
-            for (size_t i=0; i<dots; ++i)
+            for (size_t offset=0; offset < dots; )
             {
-                float x     = *(in++);
-                if (x < 0.0f)
-                    x       = -x;
-                if (x < GAIN_AMP_MIN)
-                    x       = GAIN_AMP_MIN;
-                else if (x > FLOAT_SAT_P_INF)
-                    x       = FLOAT_SAT_P_INF;
-
-                float lx    = logf(x);
-                float gain  = 0.0f;
+                size_t to_do    = lsp_min(dots - offset, size_t(BATCH_SIZE));
+                dsp::abs2(vlx, &in[offset], to_do);
+                dsp::limit1(vlx, GAIN_AMP_MIN, FLOAT_SAT_P_INF, to_do);
+                dsp::loge1(vlx, to_do);
+                dsp::fill_zero(vg, to_do);
 
                 for (size_t j=0; j<splines; ++j)
-                    gain       += spline_amp(&vSplines[j], lx);
+                {
+                    const spline_t *sp  = &vSplines[j];
+                    k[0]            = 0.0f;
+                    k[1]            = sp->vHermite[0];
+                    k[2]            = sp->vHermite[1];
+                    k[3]            = sp->vHermite[2];
+                    l0[0]           = sp->fPreRatio;
+                    l0[1]           = sp->fMakeup - sp->fPreRatio * sp->fThresh;
+                    l1[0]           = sp->fPostRatio;
+                    l1[1]           = sp->fMakeup - sp->fPostRatio * sp->fThresh;
+
+                    interpolation::apply_knee(vk, vlx, sp->fKneeStart, sp->fKneeStop, l0, k, l1, to_do);
+                    dsp::add2(vg, vk, to_do);
+                }
 
-                *(out++)    = expf(gain);
+                dsp::exp2(&out[offset], vg, to_do);
+                offset         += to_do;
             }
         }
 
@@ -529,6 +586,7 @@ namespace lsp
 
             v->write("fEnvelope", fEnvelope);
             v->write("nSampleRate", nSampleRate);
+            v->write("nLink", nLink);
             v->write("bUpdate", bUpdate);
         }
     }
@@ -25,10 +25,17 @@
 #include <lsp-plug.in/dsp/dsp.h>
 #include <lsp-plug.in/dsp-units/units.h>
 
+#define BATCH_SIZE              0x100
+
 namespace lsp
 {
     namespace dspu
     {
+        static float expander_gain(void *object, float x)
+        {
+            return static_cast<Expander *>(object)->amplification(x);
+        }
+
         Expander::Expander()
         {
             construct();
@@ -60,14 +67,34 @@ namespace lsp
             fLogKE          = 0.0f;
             fLogTH          = 0.0f;
 
+            // Gain table
+            sTable.construct();
+            nTable          = GT_OFF;
+            fTableError     = GAIN_TABLE_DFL_ERROR;
+
+            // Lookahead
+            sDelay.construct();
+            fLookahead      = 0.0f;
+
             // Additional parameters
             nSampleRate     = 0;
+            nVersion        = 0;
             bUpdate         = true;
             bUpward         = true;
         }
 
         void Expander::destroy()
         {
+            sTable.destroy();
+            sDelay.destroy();
+        }
+
+        bool Expander::init(size_t channels, size_t max_sr, float max_lookahead)
+        {
+            if (!sDelay.init(channels, millis_to_samples(max_sr, max_lookahead)))
+                return false;
+            bUpdate         = true;
+            return true;
         }
 
         void Expander::update_settings()
@@ -86,7 +113,14 @@ namespace lsp
             else
                 interpolation::hermite_quadratic(vHermite, fLogKE, fLogKE, 1.0f, fLogKS, fRatio);
 
+            // Build the gain table
+            sTable.build(expander_gain, this, gain_table_mode_t(nTable), fTableError);
+
+            // Update lookahead
+            sDelay.set_delay(millis_to_samples(nSampleRate, fLookahead));
+
             // Reset update flag
+            ++nVersion;
             bUpdate         = false;
         }
 
@@ -110,7 +144,16 @@ namespace lsp
                 dsp::copy(env, out, samples);
     
             // Now calculate expander curve
-            amplification(out, out, samples);
+            if (sTable.enabled())
+                sTable.process(out, out, samples);
+            else
+                amplification(out, out, samples);
+        }
+
+        void Expander::process(float * const *dst, float *gain, float *env, const float * const *src, const float *sc, size_t samples)
+        {
+            process(gain, env, sc, samples);
+            sDelay.process(dst, src, gain, samples);
         }
     
         float Expander::process(float *env, float s)
@@ -123,54 +166,23 @@ namespace lsp
             if (env != NULL)
                 *env    = fEnvelope;
 
-            return amplification(fEnvelope);
+            return (sTable.enabled()) ? sTable.process(fEnvelope) : amplification(fEnvelope);
         }
 
         void Expander::curve(float *out, const float *in, size_t dots)
         {
-            if (bUpward)
-            {
-                for (size_t i=0; i<dots; ++i)
-                {
-                    float x     = *(in++);
-                    if (x < 0.0f)
-                        x       = -x;
-                    if (x > FLOAT_SAT_P_INF)
-                        x       = FLOAT_SAT_P_INF;
-
-                    float lx    = logf(x);
-                    if (lx > fLogKS)
-                    {
-                        x   = (lx >= fLogKE) ?
-                            expf(fRatio*(lx - fLogTH) + fLogTH) :
-                            expf((vHermite[0]*lx + vHermite[1])*lx + vHermite[2]);
-                        *out        = x;
-                    }
-                    else
-                        *out        = x;
-                    out++;
-                }
-            }
-            else
-            {
-                for (size_t i=0; i<dots; ++i)
-                {
-                    float x     = *(in++);
-                    if (x < 0.0f)
-                        x       = -x;
+            // The curve is the input level multiplied by the vectorized amplification
+            float vx[BATCH_SIZE];
 
-                    float lx    = logf(x);
-                    if (lx < fLogKE)
-                    {
-                        x   = (lx <= fLogKS) ?
-                            expf(fRatio*(lx - fLogTH) + fLogTH) :
-                            expf((vHermite[0]*lx + vHermite[1])*lx + vHermite[2]);
-                        *out        = x;
-                    }
-                    else
-                        *out        = x;
-                    out++;
-                }
+            for (size_t offset=0; offset < dots; )
+            {
+                size_t to_do    = lsp_min(dots - offset, size_t(BATCH_SIZE));
+                dsp::abs2(vx, &in[offset], to_do);
+                if (bUpward)
+                    dsp::limit1(vx, 0.0f, FLOAT_SAT_P_INF, to_do);
+                amplification(&out[offset], vx, to_do);
+                dsp::mul2(&out[offset], vx, to_do);
+                offset         += to_do;
             }
         }
 
@@ -204,46 +216,81 @@ namespace lsp
 
         void Expander::amplification(float *out, const float *in, size_t dots)
         {
-            if (bUpward)
+            // The gain is computed in logarithmic domain by blocks: one vectorized
+            // logarithm, branch-free knee curve and one vectorized exponent per block
+            static const float zero[2] = { 0.0f, 0.0f };
+
+            float k[4], l[2];
+            k[0]            = 0.0f;
+            k[1]            = vHermite[0];
+            k[2]            = vHermite[1] - 1.0f;
+            k[3]            = vHermite[2];
+            l[0]            = fRatio - 1.0f;
+            l[1]            = -l[0] * fLogTH;
+
+            if (!bUpward)
             {
-                for (size_t i=0; i<dots; ++i)
-                {
-                    float x     = *(in++);
-                    if (x < 0.0f)
-                        x       = -x;
-                    if (x > FLOAT_SAT_P_INF)
-                        x       = FLOAT_SAT_P_INF;
-
-                    float lx    = logf(x);
-                    if (lx > fLogKS)
-                    {
-                        *out    = (lx >= fLogKE) ?
-                            expf((fRatio - 1.0f)*(lx - fLogTH)) :
-                            expf((vHermite[0]*lx + vHermite[1] - 1.0f)*lx + vHermite[2]);
-                    }
-                    else
-                        *out        = 1.0f;
-                    out++;
-                }
+                interpolation::apply_log_knee(out, in, fLogKS, fLogKE, l, k, zero, dots);
+                return;
             }
-            else
+
+            float vx[BATCH_SIZE];
+            for (size_t offset=0; offset < dots; )
+            {
+                size_t to_do    = lsp_min(dots - offset, size_t(BATCH_SIZE));
+                dsp::abs2(vx, &in[offset], to_do);
+                dsp::limit1(vx, 0.0f, FLOAT_SAT_P_INF, to_do);
+                interpolation::apply_log_knee(&out[offset], vx, fLogKS, fLogKE, zero, k, l, to_do);
+                offset         += to_do;
+            }
+        }
+
+        void Expander::process(Expander * const *list, float * const *out, float * const *env,
+            const float * const *in, size_t count, size_t samples)
+        {
+            float e[EXPANDER_LANES], ta[EXPANDER_LANES], tr[EXPANDER_LANES], rt[EXPANDER_LANES];
+            const float *src[EXPANDER_LANES];
+            float *dst[EXPANDER_LANES];
+
+            for (size_t first=0; first < count; first += EXPANDER_LANES)
             {
-                for (size_t i=0; i<dots; ++i)
+                size_t lanes    = lsp_min(count - first, size_t(EXPANDER_LANES));
+
+                // Load the state of the instances into lanes
+                for (size_t j=0; j<lanes; ++j)
                 {
-                    float x     = *(in++);
-                    if (x < 0.0f)
-                        x       = -x;
+                    Expander *x     = list[first + j];
+                    e[j]            = x->fEnvelope;
+                    ta[j]           = x->fTauAttack;
+                    tr[j]           = x->fTauRelease;
+                    rt[j]           = x->fReleaseThresh;
+                    src[j]          = in[first + j];
+                    dst[j]          = out[first + j];
+                }
 
-                    float lx    = logf(x);
-                    if (lx < fLogKE)
+                // Compute envelopes of all lanes at once
+                for (size_t i=0; i<samples; ++i)
+                {
+                    for (size_t j=0; j<lanes; ++j)
                     {
-                        *out    = (lx <= fLogKS) ?
-                            expf((fRatio - 1.0f)*(lx - fLogTH)) :
-                            expf((vHermite[0]*lx + vHermite[1] - 1.0f)*lx + vHermite[2]);
+                        float s         = src[j][i];
+                        float tau       = ((e[j] > rt[j]) && (s <= e[j])) ? tr[j] : ta[j];
+                        e[j]           += tau * (s - e[j]);
+                        dst[j][i]       = e[j];
                     }
+                }
+
+                // Store the state and compute the gain of each instance
+                for (size_t j=0; j<lanes; ++j)
+                {
+                    Expander *x     = list[first + j];
+                    x->fEnvelope    = e[j];
+                    if ((env != NULL) && (env[first + j] != NULL))
+                        dsp::copy(env[first + j], dst[j], samples);
+                    if (x->sTable.enabled())
+                        x->sTable.process(dst[j], dst[j], samples);
                     else
-                        *out        = 1.0f;
-                    out++;
+                        x->amplification(dst[j], dst[j], samples);
                 }
             }
         }
@@ -292,7 +339,13 @@ namespace lsp
             v->write("fLogKS", fLogKS);
             v->write("fLogKE", fLogKE);
             v->write("fLogTH", fLogTH);
+            v->write_object("sTable", &sTable);
+            v->write("nTable", nTable);
+            v->write("fTableError", fTableError);
+            v->write_object("sDelay", &sDelay);
+            v->write("fLookahead", fLookahead);
             v->write("nSampleRate", nSampleRate);
+            v->write("nVersion", nVersion);
             v->write("bUpdate", bUpdate);
             v->write("bUpward", bUpward);
         }
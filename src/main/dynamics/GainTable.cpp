@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp-units/dynamics/GainTable.h>
+#include <lsp-plug.in/dsp-units/const.h>
+#include <lsp-plug.in/dsp-units/misc/interpolation.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define TABLE_MIN_EXP           (127 - 24)      /* The start of the table is 2^-24 (about -144 dB) */
+#define TABLE_MIN_BITS          (uint32_t(TABLE_MIN_EXP) << 23)
+#define TABLE_MAX_BITS          (uint32_t(TABLE_MIN_EXP + GAIN_TABLE_OCTAVES) << 23)
+#define TABLE_CELLS(bits)       (GAIN_TABLE_OCTAVES << (bits))
+
+namespace lsp
+{
+    namespace dspu
+    {
+        typedef union fbits_t
+        {
+            float       f;
+            uint32_t    i;
+        } fbits_t;
+
+        GainTable::GainTable()
+        {
+            construct();
+        }
+
+        GainTable::~GainTable()
+        {
+            destroy();
+        }
+
+        void GainTable::construct()
+        {
+            vTable          = NULL;
+            nMode           = GT_OFF;
+            nBits           = 0;
+            fError          = 0.0f;
+            pFunc           = NULL;
+            pObject         = NULL;
+            pData           = NULL;
+        }
+
+        void GainTable::destroy()
+        {
+            free_aligned(pData);
+            vTable          = NULL;
+            nMode           = GT_OFF;
+        }
+
+        inline float GainTable::slope(float x, float h) const
+        {
+            // One-sided second-order difference, h is negative for the left-side derivative
+            float f0        = pFunc(pObject, x);
+            float f1        = pFunc(pObject, x + h);
+            float f2        = pFunc(pObject, x + 2.0f * h);
+            return (4.0f * f1 - 3.0f * f0 - f2) / (2.0f * h);
+        }
+
+        void GainTable::fill(size_t bits)
+        {
+            size_t shift    = 23 - bits;
+            size_t cells    = TABLE_CELLS(bits);
+            fbits_t x0, x1;
+
+            if (nMode == GT_CUBIC)
+            {
+                // Each cell keeps the cubic Hermite polynomial over t = [0..1], the slopes
+                // are taken inside the cell, so the kinks of the curve at the boundaries
+                // of the cells and the change of the cell width between octaves are kept
+                float *p        = vTable;
+                for (size_t k=0; k<cells; ++k, p += 4)
+                {
+                    x0.i            = TABLE_MIN_BITS + (uint32_t(k) << shift);
+                    x1.i            = x0.i + (uint32_t(1) << shift);
+                    float w         = x1.f - x0.f;
+                    float h         = w * 0.125f;
+
+                    interpolation::hermite_cubic(p,
+                        0.0f, pFunc(pObject, x0.f), slope(x0.f, h) * w,
+                        1.0f, pFunc(pObject, x1.f), slope(x1.f, -h) * w);
+                }
+            }
+            else
+            {
+                for (size_t k=0; k<=cells; ++k)
+                {
+                    x0.i            = TABLE_MIN_BITS + (uint32_t(k) << shift);
+                    vTable[k]       = pFunc(pObject, x0.f);
+                }
+            }
+
+            nBits           = bits;
+        }
+
+        float GainTable::estimate(size_t bits) const
+        {
+            // Check the middle and quarter points of each cell
+            size_t shift    = 23 - bits;
+            size_t cells    = GAIN_TABLE_OCTAVES << bits;
+            float error     = 0.0f;
+            fbits_t x;
+
+            for (size_t k=0; k<cells; ++k)
+            {
+                for (size_t j=1; j<4; ++j)
+                {
+                    x.i             = TABLE_MIN_BITS + (uint32_t(k) << shift) + ((uint32_t(j) << shift) >> 2);
+                    float g         = pFunc(pObject, x.f);
+                    float d         = fabsf(lookup(x.f) - g) / lsp_max(fabsf(g), float(GAIN_AMP_MIN));
+                    error           = lsp_max(error, d);
+                }
+            }
+
+            return error;
+        }
+
+        bool GainTable::build(gain_func_t func, void *object, gain_table_mode_t mode, float error)
+        {
+            pFunc           = func;
+            pObject         = object;
+            nMode           = (func != NULL) ? mode : GT_OFF;
+            if (nMode == GT_OFF)
+                return true;
+
+            // Allocate the table for the maximum resolution
+            if (vTable == NULL)
+            {
+                float *ptr      = alloc_aligned<float>(pData, TABLE_CELLS(GAIN_TABLE_MAX_BITS) * 4);
+                if (ptr == NULL)
+                {
+                    nMode           = GT_OFF;
+                    return false;
+                }
+                vTable          = ptr;
+            }
+
+            // Find the lowest resolution that meets the error bound
+            for (size_t bits=0; bits <= GAIN_TABLE_MAX_BITS; ++bits)
+            {
+                fill(bits);
+                fError          = estimate(bits);
+                if (fError <= error)
+                    break;
+            }
+
+            return true;
+        }
+
+        inline float GainTable::lookup(float x) const
+        {
+            fbits_t v;
+            v.f             = fabsf(x);
+            if (v.i >= TABLE_MAX_BITS)
+                return pFunc(pObject, v.f);
+
+            uint32_t off    = (v.i > TABLE_MIN_BITS) ? v.i - TABLE_MIN_BITS : 0;
+            size_t shift    = 23 - nBits;
+            size_t k        = off >> shift;
+            float t         = float(off & ((uint32_t(1) << shift) - 1)) / float(uint32_t(1) << shift);
+
+            if (nMode == GT_CUBIC)
+            {
+                const float *p  = &vTable[k * 4];
+                return ((p[0]*t + p[1])*t + p[2])*t + p[3];
+            }
+
+            const float *p  = &vTable[k];
+            return p[0] + (p[1] - p[0]) * t;
+        }
+
+        void GainTable::process(float *dst, const float *src, size_t count) const
+        {
+            for (size_t i=0; i<count; ++i)
+                dst[i]          = lookup(src[i]);
+        }
+
+        float GainTable::process(float x) const
+        {
+            return lookup(x);
+        }
+
+        void GainTable::dump(IStateDumper *v) const
+        {
+            v->write("vTable", vTable);
+            v->write("nMode", nMode);
+            v->write("nBits", nBits);
+            v->write("fError", fError);
+            v->write("pFunc", pFunc);
+            v->write("pObject", pObject);
+            v->write("pData", pData);
+        }
+    }
+} /* namespace lsp */
@@ -23,11 +23,24 @@
 #include <lsp-plug.in/dsp-units/misc/interpolation.h>
 #include <lsp-plug.in/dsp-units/units.h>
 #include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#define BATCH_SIZE              0x100
 
 namespace lsp
 {
     namespace dspu
     {
+        static float gate_open_gain(void *object, float x)
+        {
+            return static_cast<Gate *>(object)->amplification(x, false);
+        }
+
+        static float gate_close_gain(void *object, float x)
+        {
+            return static_cast<Gate *>(object)->amplification(x, true);
+        }
+
         Gate::Gate()
         {
             construct();
@@ -63,16 +76,38 @@ namespace lsp
             fReduction      = 0.0f;
             fEnvelope       = 0.0f;
 
+            // Gain tables
+            sTable[0].construct();
+            sTable[1].construct();
+            nTable          = GT_OFF;
+            fTableError     = GAIN_TABLE_DFL_ERROR;
+
+            // Lookahead
+            sDelay.construct();
+            fLookahead      = 0.0f;
+
             // Additional parameters
             nSampleRate     = 0;
             nCurve          = 0;
+            nVersion        = 0;
             bUpdate         = true;
         }
 
         void Gate::destroy()
         {
+            sTable[0].destroy();
+            sTable[1].destroy();
+            sDelay.destroy();
         }
-    
+
+        bool Gate::init(size_t channels, size_t max_sr, float max_lookahead)
+        {
+            if (!sDelay.init(channels, millis_to_samples(max_sr, max_lookahead)))
+                return false;
+            bUpdate         = true;
+            return true;
+        }
+
         void Gate::update_settings()
         {
             // Update settings if necessary
@@ -96,32 +131,30 @@ namespace lsp
                     );
             }
 
+            // Build the gain tables
+            sTable[0].build(gate_open_gain, this, gain_table_mode_t(nTable), fTableError);
+            sTable[1].build(gate_close_gain, this, gain_table_mode_t(nTable), fTableError);
+
+            // Update lookahead
+            sDelay.set_delay(millis_to_samples(nSampleRate, fLookahead));
+
             // Reset update flag
+            ++nVersion;
             bUpdate         = false;
         }
 
         void Gate::curve(float *out, const float *in, size_t dots, bool hyst)
         {
-            curve_t *c      = &sCurves[(hyst) ? 1 : 0];
+            // The curve is the input level multiplied by the vectorized amplification
+            float vx[BATCH_SIZE];
 
-            for (size_t i=0; i<dots; ++i)
+            for (size_t offset=0; offset < dots; )
             {
-                float x     = *(in++);
-                if (x < 0.0f)
-                    x       = -x;
-
-                if (x > c->fZS)
-                {
-                    if (x < c->fZE)
-                    {
-                        float lx    = logf(x);
-                        x           = expf(((c->vHermite[0]*lx + c->vHermite[1])*lx + c->vHermite[2])*lx + c->vHermite[3]);
-                    }
-                    *out    = x;
-                }
-                else
-                    *out    = fReduction * x;
-                out++;
+                size_t to_do    = lsp_min(dots - offset, size_t(BATCH_SIZE));
+                dsp::abs2(vx, &in[offset], to_do);
+                amplification(&out[offset], vx, to_do, hyst);
+                dsp::mul2(&out[offset], vx, to_do);
+                offset         += to_do;
             }
         }
 
@@ -149,23 +182,45 @@ namespace lsp
             // Calculate envelope of gate
             for (size_t i=0; i<samples; ++i)
             {
-                float s         = *(in++);
+                float s         = in[i];
+                fEnvelope      += (s > fEnvelope) ? fTauAttack * (s - fEnvelope) : fTauRelease * (s - fEnvelope);
+                out[i]          = fEnvelope;
+            }
 
-                fEnvelope       += (s > fEnvelope) ? fTauAttack * (s - fEnvelope) : fTauRelease * (s - fEnvelope);
+            // Copy envelope to array if specified
+            if (env != NULL)
+                dsp::copy(env, out, samples);
 
-                // Update result
-                if (env != NULL)
-                    env[i]          = fEnvelope;
-                out[i]          = amplification(fEnvelope);
+            // Now calculate gate curve
+            process_curve(out, samples);
+        }
 
-                // Change state
+        void Gate::process(float * const *dst, float *gain, float *env, const float * const *src, const float *sc, size_t samples)
+        {
+            process(gain, env, sc, samples);
+            sDelay.process(dst, src, gain, samples);
+        }
+
+        void Gate::process_curve(float *out, size_t samples)
+        {
+            for (size_t i=0; i<samples; ++i)
+            {
+                // Change state, the transition zone is computed only for
+                // samples that are within the zone
+                float e         = out[i];
                 curve_t *c      = &sCurves[nCurve];
-                if (fEnvelope > c->fZS)
+                if (e > c->fZS)
                 {
-                    if (fEnvelope < c->fZE)
+                    if (e < c->fZE)
                     {
-                        float lx    = logf(fEnvelope);
-                        out[i]      = expf(((c->vHermite[0]*lx + c->vHermite[1])*lx + c->vHermite[2] - 1.0f)*lx + c->vHermite[3]);
+                        const GainTable *t = &sTable[nCurve];
+                        if (t->enabled())
+                            out[i]      = t->process(e);
+                        else
+                        {
+                            float lx    = logf(e);
+                            out[i]      = expf(((c->vHermite[0]*lx + c->vHermite[1])*lx + c->vHermite[2] - 1.0f)*lx + c->vHermite[3]);
+                        }
                     }
                     else
                     {
@@ -181,12 +236,58 @@ namespace lsp
             }
         }
 
+        void Gate::process(Gate * const *list, float * const *out, float * const *env,
+            const float * const *in, size_t count, size_t samples)
+        {
+            float e[GATE_LANES], ta[GATE_LANES], tr[GATE_LANES];
+            const float *src[GATE_LANES];
+            float *dst[GATE_LANES];
+
+            for (size_t first=0; first < count; first += GATE_LANES)
+            {
+                size_t lanes    = lsp_min(count - first, size_t(GATE_LANES));
+
+                // Load the state of the instances into lanes
+                for (size_t j=0; j<lanes; ++j)
+                {
+                    Gate *g         = list[first + j];
+                    e[j]            = g->fEnvelope;
+                    ta[j]           = g->fTauAttack;
+                    tr[j]           = g->fTauRelease;
+                    src[j]          = in[first + j];
+                    dst[j]          = out[first + j];
+                }
+
+                // Compute envelopes of all lanes at once
+                for (size_t i=0; i<samples; ++i)
+                {
+                    for (size_t j=0; j<lanes; ++j)
+                    {
+                        float s         = src[j][i];
+                        float tau       = (s > e[j]) ? ta[j] : tr[j];
+                        e[j]           += tau * (s - e[j]);
+                        dst[j][i]       = e[j];
+                    }
+                }
+
+                // Store the state and compute the gain of each instance
+                for (size_t j=0; j<lanes; ++j)
+                {
+                    Gate *g         = list[first + j];
+                    g->fEnvelope    = e[j];
+                    if ((env != NULL) && (env[first + j] != NULL))
+                        dsp::copy(env[first + j], dst[j], samples);
+                    g->process_curve(dst[j], samples);
+                }
+            }
+        }
+
         float Gate::process(float *env, float s)
         {
             curve_t *c      = &sCurves[nCurve];
 
             fEnvelope      += (s > fEnvelope) ? fTauAttack * (s - fEnvelope) : fTauRelease * (s - fEnvelope);
-            s               = amplification(fEnvelope);
+            s               = (sTable[nCurve].enabled()) ? sTable[nCurve].process(fEnvelope) : amplification(fEnvelope);
 
             if (fEnvelope > c->fZE)
                 nCurve          = 1;
@@ -201,28 +302,20 @@ namespace lsp
 
         void Gate::amplification(float *out, const float *in, size_t dots, bool hyst)
         {
-            curve_t *c      = &sCurves[(hyst) ? 1 : 0];
-
-            for (size_t i=0; i<dots; ++i)
-            {
-                float x     = *(in++);
-                if (x < 0.0f)
-                    x       = -x;
-
-                if (x > c->fZS)
-                {
-                    if (x < c->fZE)
-                    {
-                        float lx    = logf(x);
-                        *out        = expf(((c->vHermite[0]*lx + c->vHermite[1])*lx + c->vHermite[2] - 1.0f)*lx + c->vHermite[3]);
-                    }
-                    else
-                        *out    = 1.0f;
-                }
-                else
-                    *out    = fReduction;
-                out++;
-            }
+            // The gain is computed in logarithmic domain by blocks: one vectorized
+            // logarithm, branch-free gain curve and one vectorized exponent per block
+            const curve_t *c    = &sCurves[(hyst) ? 1 : 0];
+            float k[4], l0[2];
+            static const float l1[2] = { 0.0f, 0.0f };
+
+            k[0]            = c->vHermite[0];
+            k[1]            = c->vHermite[1];
+            k[2]            = c->vHermite[2] - 1.0f;
+            k[3]            = c->vHermite[3];
+            l0[0]           = 0.0f;
+            l0[1]           = logf(fReduction);
+
+            interpolation::apply_log_knee(out, in, c->fLogZS, c->fLogZE, l0, k, l1, dots);
         }
 
         float Gate::amplification(float in)
@@ -291,9 +384,15 @@ namespace lsp
             v->write("fTauRelease", fTauRelease);
             v->write("fReduction", fReduction);
             v->write("fEnvelope", fEnvelope);
+            v->write_object_array("sTable", sTable, 2);
+            v->write("nTable", nTable);
+            v->write("fTableError", fTableError);
 
+            v->write_object("sDelay", &sDelay);
+            v->write("fLookahead", fLookahead);
             v->write("nSampleRate", nSampleRate);
             v->write("nCurve", nCurve);
+            v->write("nVersion", nVersion);
             v->write("bUpdate", bUpdate);
         }
     }
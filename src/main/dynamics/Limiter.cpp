@@ -22,17 +22,72 @@
 #include <lsp-plug.in/dsp-units/dynamics/Limiter.h>
 #include <lsp-plug.in/dsp-units/units.h>
 #include <lsp-plug.in/dsp-units/misc/interpolation.h>
+#include <lsp-plug.in/dsp-units/sampling/Sample.h>
 #include <lsp-plug.in/dsp/dsp.h>
 #include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/stdlib/math.h>
 
 #define BUF_GRANULARITY         8192
 #define GAIN_LOWERING           0.9886 /*0.891250938134 */
 #define MIN_LIMITER_RELEASE     5.0f
+#define PATCH_BATCH_SIZE        0x100
 
 namespace lsp
 {
     namespace dspu
     {
+        typedef void (*patch_curve_t)(float *dst, const float *src, const float *p, size_t count);
+
+        /*
+         * Apply the part [first, last) of the patch: dst[t] *= 1 - amp * curve(t),
+         * the curve is evaluated for blocks of positions by the array evaluator
+         */
+        static void apply_patch_curve(float *dst, ssize_t first, ssize_t last, const float *p, float amp, patch_curve_t curve)
+        {
+            float buf[PATCH_BATCH_SIZE];
+
+            while (first < last)
+            {
+                size_t to_do    = lsp_min(size_t(last - first), size_t(PATCH_BATCH_SIZE));
+                for (size_t i=0; i<to_do; ++i)
+                    buf[i]          = float(first + ssize_t(i));
+
+                curve(buf, buf, p, to_do);
+                dsp::mul_k2(buf, -amp, to_do);
+                dsp::add_k2(buf, 1.0f, to_do);
+                dsp::mul2(dst, buf, to_do);
+
+                dst            += to_do;
+                first          += to_do;
+            }
+        }
+
+        static void apply_patch(float *dst, ssize_t attack, ssize_t plane, ssize_t release,
+            const float *pa, const float *pr, float amp, patch_curve_t curve)
+        {
+            ssize_t t = 0;
+
+            // Attack part
+            if (t < attack)
+            {
+                apply_patch_curve(dst, t, attack, pa, amp, curve);
+                dst            += attack - t;
+                t               = attack;
+            }
+
+            // Peak part
+            if (t < plane)
+            {
+                dsp::mul_k2(dst, 1.0f - amp, plane - t);
+                dst            += plane - t;
+                t               = plane;
+            }
+
+            // Release part
+            if (t < release)
+                apply_patch_curve(dst, t, release, pr, amp, curve);
+        }
+
         Limiter::Limiter()
         {
             construct();
@@ -46,6 +101,7 @@ namespace lsp
         void Limiter::construct()
         {
             sDelay.construct();
+            sPerf.construct();
 
             fThreshold      = GAIN_AMP_0_DB;
             fReqThreshold   = GAIN_AMP_0_DB;
@@ -60,6 +116,11 @@ namespace lsp
             nSampleRate     = 0;
             nUpdate         = UP_ALL;
             nMode           = LM_HERM_THIN;
+            nChannels       = 0;
+            bTruePeak       = false;
+            bMergePeaks     = false;
+            nMergeAttack    = 0;
+            nMergeHold      = 0;
 
             sALR.fAttack    = 10.0f;
             sALR.fRelease   = 50.0f;
@@ -68,7 +129,14 @@ namespace lsp
 
             vGainBuf        = NULL;
             vTmpBuf         = NULL;
+            vScBuf          = NULL;
+            vDelayBuf       = NULL;
+            vTpBuf          = NULL;
+            vTpHist         = NULL;
+            vEnvBuf         = NULL;
             vData           = NULL;
+
+            init_true_peak();
         }
 
         void Limiter::destroy()
@@ -83,12 +151,38 @@ namespace lsp
 
             vGainBuf    = NULL;
             vTmpBuf     = NULL;
+            vScBuf      = NULL;
+            vDelayBuf   = NULL;
+            vTpBuf      = NULL;
+            vTpHist     = NULL;
+            vEnvBuf     = NULL;
+            nChannels   = 0;
+        }
+
+        size_t Limiter::data_size(size_t lookahead, size_t channels)
+        {
+            // The gain-only limiter has no delay lines but still needs the true peak history
+            size_t tp_channels  = lsp_max(channels, size_t(1));
+            size_t delay_len    = lookahead + LIMITER_TP_DELAY + BUF_GRANULARITY;
+
+            return lookahead*4 + BUF_GRANULARITY*3 + delay_len * channels +
+                   LIMITER_TP_HISTORY + BUF_GRANULARITY*2 + LIMITER_TP_HISTORY * tp_channels +
+                   (lookahead*8 + BUF_GRANULARITY + 4) * 3;
         }
 
         bool Limiter::init(size_t max_sr, float max_lookahead)
         {
+            return init(max_sr, max_lookahead, 1);
+        }
+
+        bool Limiter::init(size_t max_sr, float max_lookahead, size_t channels)
+        {
+            // The gain-only limiter has no delay lines but still needs the true peak history
+            size_t tp_channels  = lsp_max(channels, size_t(1));
+
             nMaxLookahead       = millis_to_samples(max_sr, max_lookahead);
-            size_t alloc        = nMaxLookahead*4 + BUF_GRANULARITY*2;
+            size_t delay_len    = nMaxLookahead + LIMITER_TP_DELAY + BUF_GRANULARITY;
+            size_t alloc        = data_size(nMaxLookahead, channels);
             float *ptr          = alloc_aligned<float>(vData, alloc, DEFAULT_ALIGN);
             if (ptr == NULL)
                 return false;
@@ -97,11 +191,26 @@ namespace lsp
             ptr                += nMaxLookahead*4 + BUF_GRANULARITY;
             vTmpBuf             = ptr;
             ptr                += BUF_GRANULARITY;
+            vScBuf              = ptr;
+            ptr                += BUF_GRANULARITY;
+            vDelayBuf           = ptr;
+            ptr                += delay_len * channels;
+            vTpBuf              = ptr;
+            ptr                += LIMITER_TP_HISTORY + BUF_GRANULARITY*2;
+            vTpHist             = ptr;
+            ptr                += LIMITER_TP_HISTORY * tp_channels;
+            vEnvBuf             = ptr;
+            ptr                += (nMaxLookahead*8 + BUF_GRANULARITY + 4) * 3;
 
             dsp::fill_one(vGainBuf, nMaxLookahead*4 + BUF_GRANULARITY);
             dsp::fill_zero(vTmpBuf, BUF_GRANULARITY);
+            dsp::fill_zero(vScBuf, BUF_GRANULARITY);
+            dsp::fill_zero(vDelayBuf, delay_len * channels);
+            dsp::fill_zero(vTpBuf, LIMITER_TP_HISTORY + BUF_GRANULARITY*2);
+            dsp::fill_zero(vTpHist, LIMITER_TP_HISTORY * tp_channels);
+            nChannels           = channels;
 
-            if (!sDelay.init(nMaxLookahead + BUF_GRANULARITY))
+            if ((channels > 0) && (!sDelay.init(nMaxLookahead + LIMITER_TP_DELAY + BUF_GRANULARITY)))
                 return false;
 
             nMaxSampleRate      = max_sr;
@@ -200,6 +309,80 @@ namespace lsp
             return old;
         }
 
+        bool Limiter::set_true_peak(bool enable)
+        {
+            bool old        = bTruePeak;
+            if (old == enable)
+                return old;
+
+            bTruePeak       = enable;
+            nUpdate        |= UP_LK;
+            if ((enable) && (vTpHist != NULL))
+                dsp::fill_zero(vTpHist, LIMITER_TP_HISTORY * lsp_max(nChannels, size_t(1)));
+            return old;
+        }
+
+        bool Limiter::set_merge_peaks(bool enable)
+        {
+            bool old        = bMergePeaks;
+            bMergePeaks     = enable;
+            return old;
+        }
+
+        void Limiter::init_true_peak()
+        {
+            // Windowed sinc prototype of (LIMITER_TP_PHASES * LIMITER_TP_TAPS + 1) taps with the integer
+            // delay of LIMITER_TP_DELAY samples, the zero phase is the delayed input signal itself
+            const size_t len    = LIMITER_TP_PHASES * LIMITER_TP_TAPS;
+            const float center  = LIMITER_TP_PHASES * LIMITER_TP_DELAY;
+
+            for (size_t p=1; p<LIMITER_TP_PHASES; ++p)
+            {
+                float *fir          = vTpFir[p-1];
+                float sum           = 0.0f;
+
+                for (size_t k=0; k<LIMITER_TP_TAPS; ++k)
+                {
+                    float n             = p + k * LIMITER_TP_PHASES;
+                    float x             = M_PI * (n - center) / LIMITER_TP_PHASES;
+                    float w             = 0.5f - 0.5f * cosf(2.0f * M_PI * n / len);
+                    fir[k]              = w * sinf(x) / x;
+                    sum                += fir[k];
+                }
+
+                // Normalize the phase to have unity gain at DC
+                for (size_t k=0; k<LIMITER_TP_TAPS; ++k)
+                    fir[k]             /= sum;
+            }
+        }
+
+        void Limiter::true_peak(float *dst, const float *sc, size_t channel, size_t samples)
+        {
+            float *hist         = &vTpHist[channel * LIMITER_TP_HISTORY];
+            float *x            = &vTpBuf[LIMITER_TP_HISTORY];
+            float *sum          = &x[BUF_GRANULARITY];
+
+            // Prepend the history to the sidechain signal
+            dsp::copy(&x[-LIMITER_TP_HISTORY], hist, LIMITER_TP_HISTORY);
+            dsp::copy(x, sc, samples);
+
+            // Zero phase is the delayed sample itself
+            dsp::abs2(dst, &x[-LIMITER_TP_DELAY], samples);
+
+            // Compute fractional phases and take the maximum absolute value
+            for (size_t p=0; p<LIMITER_TP_PHASES-1; ++p)
+            {
+                const float *fir    = vTpFir[p];
+                dsp::mul_k3(sum, x, fir[0], samples);
+                for (size_t k=1; k<LIMITER_TP_TAPS; ++k)
+                    dsp::fmadd_k3(sum, &x[-ssize_t(k)], fir[k], samples);
+                dsp::pamax2(dst, sum, samples);
+            }
+
+            // Store the history
+            dsp::copy(hist, &x[samples - LIMITER_TP_HISTORY], LIMITER_TP_HISTORY);
+        }
+
         void Limiter::reset_sat(sat_t *sat)
         {
             sat->nAttack        = 0;
@@ -375,15 +558,24 @@ namespace lsp
             if (nUpdate == 0)
                 return;
 
+            LSP_DSP_UNITS_PERF_RECONFIGURE(sPerf);
+
             // Update delay settings
             if (nUpdate & UP_SR)
             {
                 sDelay.clear();
+                dsp::fill_zero(vDelayBuf, (nMaxLookahead + LIMITER_TP_DELAY + BUF_GRANULARITY) * nChannels);
+                dsp::fill_zero(vTpHist, LIMITER_TP_HISTORY * lsp_max(nChannels, size_t(1)));
                 dsp::fill_one(vGainBuf, nMaxLookahead*3 + BUF_GRANULARITY);
             }
 
             nLookahead          = millis_to_samples(nSampleRate, fLookahead);
-            sDelay.set_delay(nLookahead);
+            if (nChannels > 0)
+                sDelay.set_delay(get_latency());
+
+            // Update merged envelope settings
+            nMergeAttack        = lsp_min(size_t(millis_to_samples(nSampleRate, fAttack)), nLookahead) >> 1;
+            nMergeHold          = lsp_min(size_t(millis_to_samples(nSampleRate, fRelease)), nLookahead*2);
 
             // Update threshold
             if (nUpdate & UP_THRESH)
@@ -539,68 +731,17 @@ namespace lsp
 
         void Limiter::apply_sat_patch(sat_t *sat, float *dst, float amp)
         {
-            ssize_t t = 0;
-
-            // Attack part
-            while (t < sat->nAttack)
-            {
-                float x     = t++;
-                *(dst++)   *= 1.0f - amp * (((sat->vAttack[0]*x + sat->vAttack[1])*x + sat->vAttack[2])*x + sat->vAttack[3]);
-            }
-
-            // Peak part
-            while (t < sat->nPlane)
-            {
-                *(dst++)   *= 1.0f - amp;
-                t++;
-            }
-
-            // Release part
-            while (t < sat->nRelease)
-            {
-                float x     = t++;
-                *(dst++)   *= 1.0f - amp * (((sat->vRelease[0]*x + sat->vRelease[1])*x + sat->vRelease[2])*x + sat->vRelease[3]);
-            }
+            apply_patch(dst, sat->nAttack, sat->nPlane, sat->nRelease, sat->vAttack, sat->vRelease, amp, interpolation::apply_cubic);
         }
 
         void Limiter::apply_exp_patch(exp_t *exp, float *dst, float amp)
         {
-            ssize_t t = 0;
-
-            // Attack part
-            while (t < exp->nAttack)
-                *(dst++)   *= 1.0f - amp * (exp->vAttack[0] + exp->vAttack[1] * expf(exp->vAttack[2] * (t++)));
-
-            // Peak part
-            while (t < exp->nPlane)
-            {
-                *(dst++)   *= 1.0f - amp;
-                t++;
-            }
-
-            // Release part
-            while (t < exp->nRelease)
-                *(dst++)   *= 1.0f - amp * (exp->vRelease[0] + exp->vRelease[1] * expf(exp->vRelease[2] * (t++)));
+            apply_patch(dst, exp->nAttack, exp->nPlane, exp->nRelease, exp->vAttack, exp->vRelease, amp, interpolation::apply_exponent);
         }
 
         void Limiter::apply_line_patch(line_t *line, float *dst, float amp)
         {
-            ssize_t t = 0;
-
-            // Attack part
-            while (t < line->nAttack)
-                *(dst++)   *= 1.0f - amp * (line->vAttack[0] * (t++) + line->vAttack[1]);
-
-            // Peak part
-            while (t < line->nPlane)
-            {
-                *(dst++)   *= 1.0f - amp;
-                t++;
-            }
-
-            // Release part
-            while (t < line->nRelease)
-                *(dst++)   *= 1.0f - amp * (line->vRelease[0] * (t++) + line->vRelease[1]);
+            apply_patch(dst, line->nAttack, line->nPlane, line->nRelease, line->vAttack, line->vRelease, amp, interpolation::apply_linear);
         }
 
         void Limiter::process_alr(float *gbuf, const float *sc, size_t samples)
@@ -623,77 +764,164 @@ namespace lsp
             }
         }
 
-        void Limiter::process(float *dst, float *gain, const float *src, const float *sc, size_t samples)
+        void Limiter::merge_peaks(float *gbuf, size_t samples)
         {
-            // Force settings update if there are any
-            update_settings();
+            // The envelope of the single peak at position p is formed as:
+            //   - the hold: sliding minimum of the required gain over [p - b, p + b + h]
+            //   - the ramps: moving average of the hold over [p - b, p + b]
+            // The moving average at p covers only samples of hold not greater than the required
+            // gain, so the gain at p never exceeds the required gain. The envelope rises in 2b samples
+            // before the peak, holds for h samples and falls in 2b samples after the peak.
+            size_t b            = nMergeAttack;
+            size_t h            = nMergeHold;
+            size_t left         = b * 2;
+            size_t count        = left + samples + b*2 + h;     // Number of affected gain samples
+            size_t w            = b*2 + h + 1;                  // Size of the sliding window
+            size_t len          = count + w;
+            size_t cap          = nMaxLookahead*8 + BUF_GRANULARITY + 4;
+            float *req          = vEnvBuf;
+            float *pre          = &req[cap];
+            float *suf          = &pre[cap];
+
+            // Compute the required gain, shifted by the lag of the sliding window
+            float *vreq         = &req[left + b + h];
+            float thresh        = fThreshold - 0.000001f;
+            bool found          = false;
+
+            dsp::fill_one(req, len);
+            for (size_t i=0; i<samples; ++i)
+            {
+                float s             = vTmpBuf[i];
+                if (s > fThreshold)
+                {
+                    vreq[i]             = thresh / s;
+                    found               = true;
+                }
+            }
+            if (!found)
+                return;
+
+            // Sliding minimum (van Herk/Gil-Werman): prefix and suffix minimums of blocks of w samples
+            for (size_t first=0; first < len; first += w)
+            {
+                size_t last         = lsp_min(first + w, len);
+                pre[first]          = req[first];
+                for (size_t i=first+1; i<last; ++i)
+                    pre[i]              = lsp_min(pre[i-1], req[i]);
+                suf[last-1]         = req[last-1];
+                for (size_t i=last-1; i > first; --i)
+                    suf[i-1]            = lsp_min(suf[i], req[i-1]);
+            }
+            dsp::pmin3(req, suf, &pre[w-1], count);
+
+            // Moving average of the gain reduction over 2b+1 samples
+            float k             = 1.0f / (b*2 + 1);
+            float sum           = 0.0f;
+            for (size_t i=0; i<b; ++i)
+                sum                += 1.0f - req[i];
+            for (size_t i=0; i<count; ++i)
+            {
+                if ((i + b) < count)
+                    sum                += 1.0f - req[i + b];
+                pre[i]              = 1.0f - sum * k;
+                if (i >= b)
+                    sum                -= 1.0f - req[i - b];
+            }
+
+            // Apply the envelope to the gain buffer
+            dsp::mul2(&gbuf[-ssize_t(left)], pre, count);
+        }
 
+        void Limiter::process_gain(float *gain, const float *sc, size_t samples)
+        {
             float *gbuf     = &vGainBuf[nMaxLookahead];
 
-            while (samples > 0)
+            // Fill gain buffer
+            dsp::fill_one(&gbuf[nMaxLookahead*3], samples);
+            dsp::abs_mul3(vTmpBuf, gbuf, sc, samples);  // Apply current gain buffer to the side chain signal
+            if (sALR.bEnable) // Apply ALR if necessary
             {
-                size_t to_do    = (samples > BUF_GRANULARITY) ? BUF_GRANULARITY : samples;
+                process_alr(gbuf, vTmpBuf, samples);
+                dsp::abs_mul3(vTmpBuf, gbuf, sc, samples);  // Apply gain to sidechain
+            }
+            if (bMergePeaks) // Compute the envelope for all peaks at once
+            {
+                merge_peaks(gbuf, samples);
+                dsp::abs_mul3(vTmpBuf, gbuf, sc, samples);  // Apply gain to sidechain
+            }
 
-                // Fill gain buffer
-                dsp::fill_one(&gbuf[nMaxLookahead*3], to_do);
-                dsp::abs_mul3(vTmpBuf, gbuf, sc, to_do);    // Apply current gain buffer to the side chain signal
-                if (sALR.bEnable) // Apply ALR if necessary
-                {
-                    process_alr(gbuf, vTmpBuf, to_do);
-                    dsp::abs_mul3(vTmpBuf, gbuf, sc, to_do);    // Apply gain to sidechain
-                }
+            float knee          = 1.0f;
+            size_t iterations   = 0;
 
-                float knee          = 1.0f;
-                size_t iterations   = 0;
+            while (true)
+            {
+                // Find peak
+                ssize_t peak    = dsp::max_index(vTmpBuf, samples);
+                float s         = vTmpBuf[peak];
+                if (s <= fThreshold) // No more peaks are present
+                    break;
 
-                while (true)
+                // Apply patch to the gain buffer
+                s           = (s - (fThreshold * knee - 0.000001))/ s;
+                switch (nMode)
                 {
-                    // Find peak
-                    ssize_t peak    = dsp::max_index(vTmpBuf, to_do);
-                    float s         = vTmpBuf[peak];
-                    if (s <= fThreshold) // No more peaks are present
+                    case LM_HERM_THIN:
+                    case LM_HERM_WIDE:
+                    case LM_HERM_TAIL:
+                    case LM_HERM_DUCK:
+                        apply_sat_patch(&sSat, &gbuf[peak - sSat.nMiddle], s);
                         break;
 
-                    // Apply patch to the gain buffer
-                    s           = (s - (fThreshold * knee - 0.000001))/ s;
-                    switch (nMode)
-                    {
-                        case LM_HERM_THIN:
-                        case LM_HERM_WIDE:
-                        case LM_HERM_TAIL:
-                        case LM_HERM_DUCK:
-                            apply_sat_patch(&sSat, &gbuf[peak - sSat.nMiddle], s);
-                            break;
-
-                        case LM_EXP_THIN:
-                        case LM_EXP_WIDE:
-                        case LM_EXP_TAIL:
-                        case LM_EXP_DUCK:
-                            apply_exp_patch(&sExp, &gbuf[peak - sExp.nMiddle], s);
-                            break;
-
-                        case LM_LINE_THIN:
-                        case LM_LINE_WIDE:
-                        case LM_LINE_TAIL:
-                        case LM_LINE_DUCK:
-                            apply_line_patch(&sLine, &gbuf[peak - sLine.nMiddle], s);
-                            break;
-
-                        default:
-                            break;
-                    }
+                    case LM_EXP_THIN:
+                    case LM_EXP_WIDE:
+                    case LM_EXP_TAIL:
+                    case LM_EXP_DUCK:
+                        apply_exp_patch(&sExp, &gbuf[peak - sExp.nMiddle], s);
+                        break;
 
-                    // Apply new gain to sidechain
-                    dsp::abs_mul3(vTmpBuf, gbuf, sc, to_do);    // Apply gain to sidechain
+                    case LM_LINE_THIN:
+                    case LM_LINE_WIDE:
+                    case LM_LINE_TAIL:
+                    case LM_LINE_DUCK:
+                        apply_line_patch(&sLine, &gbuf[peak - sLine.nMiddle], s);
+                        break;
 
-                    // Lower the knee if necessary
-                    if (((++iterations) % LIMITER_PEAKS_MAX) == 0)
-                        knee     *=       GAIN_LOWERING;
+                    default:
+                        break;
                 }
 
-                // Copy gain value and shift gain buffer
-                dsp::copy(gain, &vGainBuf[nMaxLookahead - nLookahead], to_do);
-                dsp::move(vGainBuf, &vGainBuf[to_do], nMaxLookahead*4);
+                // Apply new gain to sidechain
+                dsp::abs_mul3(vTmpBuf, gbuf, sc, samples);  // Apply gain to sidechain
+
+                // Lower the knee if necessary
+                if (((++iterations) % LIMITER_PEAKS_MAX) == 0)
+                    knee     *=       GAIN_LOWERING;
+            }
+
+            // Copy gain value and shift gain buffer
+            dsp::copy(gain, &vGainBuf[nMaxLookahead - nLookahead], samples);
+            dsp::move(vGainBuf, &vGainBuf[samples], nMaxLookahead*4);
+        }
+
+        void Limiter::process(float *dst, float *gain, const float *src, const float *sc, size_t samples)
+        {
+            LSP_DSP_UNITS_PERF_SCOPE(sPerf, samples);
+
+            // Force settings update if there are any
+            update_settings();
+
+            while (samples > 0)
+            {
+                size_t to_do    = (samples > BUF_GRANULARITY) ? BUF_GRANULARITY : samples;
+
+                // Compute gain
+                if (bTruePeak)
+                {
+                    true_peak(vScBuf, sc, 0, to_do);
+                    process_gain(gain, vScBuf, to_do);
+                }
+                else
+                    process_gain(gain, sc, to_do);
 
                 // Gain will be applied to the delayed signal
                 sDelay.process(dst, src, to_do);
@@ -707,6 +935,226 @@ namespace lsp
             }
         }
 
+        void Limiter::process(float *gain, const float *sc, size_t samples)
+        {
+            LSP_DSP_UNITS_PERF_SCOPE(sPerf, samples);
+
+            // Force settings update if there are any
+            update_settings();
+
+            for (size_t offset=0; offset < samples; )
+            {
+                size_t to_do    = lsp_min(samples - offset, size_t(BUF_GRANULARITY));
+
+                if (bTruePeak)
+                {
+                    true_peak(vScBuf, &sc[offset], 0, to_do);
+                    process_gain(&gain[offset], vScBuf, to_do);
+                }
+                else
+                    process_gain(&gain[offset], &sc[offset], to_do);
+
+                offset         += to_do;
+            }
+        }
+
+        bool Limiter::update_settings(SettingsBuffer<limiter_settings_t> *settings)
+        {
+            bool fetched = settings->fetch();
+            if (fetched)
+                set_settings(settings->current());
+            update_settings();
+            return fetched;
+        }
+
+        void Limiter::get_settings(limiter_settings_t *settings) const
+        {
+            settings->fThreshold        = fReqThreshold;
+            settings->fAttack           = fAttack;
+            settings->fRelease          = fRelease;
+            settings->fLookahead        = fLookahead;
+            settings->fKnee             = fKnee;
+            settings->nMode             = nMode;
+            settings->fALRAttack        = sALR.fAttack;
+            settings->fALRRelease       = sALR.fRelease;
+            settings->bALR              = sALR.bEnable;
+            settings->bTruePeak         = bTruePeak;
+            settings->bMergePeaks       = bMergePeaks;
+        }
+
+        void Limiter::set_settings(const limiter_settings_t *settings)
+        {
+            set_threshold(settings->fThreshold, false);
+            set_attack(settings->fAttack);
+            set_release(settings->fRelease);
+            set_lookahead(settings->fLookahead);
+            set_knee(settings->fKnee);
+            set_mode(limiter_mode_t(settings->nMode));
+            set_alr_attack(settings->fALRAttack);
+            set_alr_release(settings->fALRRelease);
+            set_alr(settings->bALR);
+            set_true_peak(settings->bTruePeak);
+            set_merge_peaks(settings->bMergePeaks);
+        }
+
+        void Limiter::set_param(void *object, size_t id, float value)
+        {
+            Limiter *self       = static_cast<Limiter *>(object);
+
+            switch (id)
+            {
+                case LP_THRESHOLD:              self->set_threshold(value, false); break;
+                case LP_THRESHOLD_IMMEDIATE:    self->set_threshold(value, true); break;
+                case LP_ATTACK:                 self->set_attack(value); break;
+                case LP_RELEASE:                self->set_release(value); break;
+                case LP_KNEE:                   self->set_knee(value); break;
+                case LP_MODE:                   self->set_mode(limiter_mode_t(value)); break;
+                default: break;
+            }
+        }
+
+        void Limiter::process(float *dst, float *gain, const float *src, const float *sc, size_t samples, const ParamEvents *events)
+        {
+            if ((events == NULL) || (events->size() <= 0))
+            {
+                process(dst, gain, src, sc, samples);
+                return;
+            }
+
+            // Each sub-block updates settings
+            size_t index    = 0;
+            for (size_t offset=0; offset < samples; )
+            {
+                size_t to_do    = events->apply(&index, offset, samples - offset, set_param, this);
+                process(&dst[offset], &gain[offset], &src[offset], &sc[offset], to_do);
+                offset         += to_do;
+            }
+
+            events->apply_tail(&index, set_param, this);
+        }
+
+        void Limiter::process(float *gain, const float *sc, size_t samples, const ParamEvents *events)
+        {
+            if ((events == NULL) || (events->size() <= 0))
+            {
+                process(gain, sc, samples);
+                return;
+            }
+
+            size_t index    = 0;
+            for (size_t offset=0; offset < samples; )
+            {
+                size_t to_do    = events->apply(&index, offset, samples - offset, set_param, this);
+                process(&gain[offset], &sc[offset], to_do);
+                offset         += to_do;
+            }
+
+            events->apply_tail(&index, set_param, this);
+        }
+
+        void Limiter::process(float * const *dst, float *gain, const float * const *src, const float * const *sc, size_t samples)
+        {
+            LSP_DSP_UNITS_PERF_SCOPE(sPerf, samples);
+
+            // Force settings update if there are any
+            update_settings();
+
+            const float * const *vsc    = (sc != NULL) ? sc : src;
+            size_t delay_len            = nMaxLookahead + LIMITER_TP_DELAY + BUF_GRANULARITY;
+            size_t head                 = nMaxLookahead + LIMITER_TP_DELAY;
+            size_t latency              = get_latency();
+
+            for (size_t offset=0; offset < samples; )
+            {
+                size_t to_do    = lsp_min(samples - offset, size_t(BUF_GRANULARITY));
+
+                // Link sidechain signals and compute the shared gain curve
+                if (bTruePeak)
+                {
+                    true_peak(vScBuf, &vsc[0][offset], 0, to_do);
+                    for (size_t i=1; i<nChannels; ++i)
+                    {
+                        true_peak(vTmpBuf, &vsc[i][offset], i, to_do);
+                        dsp::pamax2(vScBuf, vTmpBuf, to_do);
+                    }
+                }
+                else
+                {
+                    dsp::abs2(vScBuf, &vsc[0][offset], to_do);
+                    for (size_t i=1; i<nChannels; ++i)
+                        dsp::pamax2(vScBuf, &vsc[i][offset], to_do);
+                }
+                process_gain(&gain[offset], vScBuf, to_do);
+
+                // Pass each channel through the delay line and apply the gain
+                for (size_t i=0; i<nChannels; ++i)
+                {
+                    float *line     = &vDelayBuf[i * delay_len];
+                    dsp::copy(&line[head], &src[i][offset], to_do);
+                    dsp::mul3(&dst[i][offset], &line[head - latency], &gain[offset], to_do);
+                    dsp::move(line, &line[to_do], head);
+                }
+
+                offset         += to_do;
+            }
+        }
+
+        status_t Limiter::process(Sample *dst, const Sample *src, float *gain)
+        {
+            if ((dst == NULL) || (src == NULL) || (!src->valid()))
+                return STATUS_BAD_ARGUMENTS;
+
+            update_settings();
+
+            size_t channels     = src->channels();
+            size_t length       = src->length();
+            if (dst != src)
+            {
+                status_t res        = dst->copy(src);
+                if (res != STATUS_OK)
+                    return res;
+            }
+
+            // Allocate the envelope buffer if the caller did not provide it
+            uint8_t *data       = NULL;
+            float *env          = gain;
+            if (env == NULL)
+            {
+                env                 = alloc_aligned<float>(data, length);
+                if (env == NULL)
+                    return STATUS_NO_MEM;
+            }
+
+            // Compute the linked peak envelope and the required gain
+            dsp::abs2(env, dst->channel(0), length);
+            for (size_t i=1; i<channels; ++i)
+                dsp::pamax2(env, dst->channel(i), length);
+
+            float thresh        = fThreshold;
+            for (size_t i=0; i<length; ++i)
+                env[i]              = (env[i] > thresh) ? thresh / env[i] : 1.0f;
+
+            // Smooth the gain: attack in the reverse time, release in the forward time
+            size_t srate        = (src->sample_rate() > 0) ? src->sample_rate() : nSampleRate;
+            float att           = millis_to_samples(srate, fAttack);
+            float rel           = millis_to_samples(srate, fRelease);
+            float tau_att       = (att < 1.0f) ? 1.0f : 1.0f - expf(logf(1.0f - M_SQRT1_2) / att);
+            float tau_rel       = (rel < 1.0f) ? 1.0f : 1.0f - expf(logf(1.0f - M_SQRT1_2) / rel);
+
+            for (ssize_t i=length-2; i >= 0; --i)
+                env[i]              = lsp_min(env[i], env[i+1] + (1.0f - env[i+1]) * tau_att);
+            for (size_t i=1; i<length; ++i)
+                env[i]              = lsp_min(env[i], env[i-1] + (1.0f - env[i-1]) * tau_rel);
+
+            // Apply the gain
+            for (size_t i=0; i<channels; ++i)
+                dsp::mul2(dst->channel(i), env, length);
+
+            free_aligned(data);
+
+            return STATUS_OK;
+        }
+
         void Limiter::dump(IStateDumper *v, const char *name, const sat_t *sat)
         {
             v->begin_object(name, sat, sizeof(sat_t));
@@ -749,6 +1197,18 @@ namespace lsp
             v->end_object();
         }
 
+        void Limiter::memory_usage(memory_report_t *r) const
+        {
+            // The buffers are allocated for the maximum lookahead
+            if (vData != NULL)
+            {
+                size_t allocated    = data_size(nMaxLookahead, nChannels) * sizeof(float);
+                size_t used         = data_size(lsp_min(nLookahead, nMaxLookahead), nChannels) * sizeof(float);
+                memory::add_aligned(r, vData, allocated, used);
+            }
+            sDelay.memory_usage(r);
+        }
+
         void Limiter::dump(IStateDumper *v) const
         {
             v->write("fThreshold", fThreshold);
@@ -764,6 +1224,11 @@ namespace lsp
             v->write("nSampleRate", nSampleRate);
             v->write("nUpdate", nUpdate);
             v->write("nMode", nMode);
+            v->write("nChannels", nChannels);
+            v->write("bTruePeak", bTruePeak);
+            v->write("bMergePeaks", bMergePeaks);
+            v->write("nMergeAttack", nMergeAttack);
+            v->write("nMergeHold", nMergeHold);
             v->begin_object("sALR", &sALR, sizeof(alr_t));
             {
                 v->write("fKS", sALR.fKS);
@@ -781,9 +1246,16 @@ namespace lsp
 
             v->write("vGainBuf", vGainBuf);
             v->write("vTmpBuf", vTmpBuf);
+            v->write("vScBuf", vScBuf);
+            v->write("vDelayBuf", vDelayBuf);
+            v->write("vTpBuf", vTpBuf);
+            v->write("vTpHist", vTpHist);
+            v->write("vEnvBuf", vEnvBuf);
+            v->writev("vTpFir", &vTpFir[0][0], (LIMITER_TP_PHASES-1) * LIMITER_TP_TAPS);
             v->write("vData", vData);
 
             v->write_object("sDelay", &sDelay);
+            v->write_object("sPerf", &sPerf);
 
             switch (nMode)
             {
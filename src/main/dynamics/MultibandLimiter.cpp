@@ -0,0 +1,296 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/dsp-units/dynamics/MultibandLimiter.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#define BUF_SIZE            0x400
+
+namespace lsp
+{
+    namespace dspu
+    {
+        MultibandLimiter::MultibandLimiter()
+        {
+            construct();
+        }
+
+        MultibandLimiter::~MultibandLimiter()
+        {
+            destroy();
+        }
+
+        void MultibandLimiter::construct()
+        {
+            sScSplit.construct();
+            sSplit.construct();
+            sArena.construct();
+
+            vBands      = NULL;
+            nBands      = 0;
+            vDelay      = NULL;
+            nMaxDelay   = 0;
+            pOut        = NULL;
+            pData       = NULL;
+        }
+
+        void MultibandLimiter::destroy()
+        {
+            sScSplit.destroy();
+            sSplit.destroy();
+
+            if (vBands != NULL)
+            {
+                for (size_t i=0; i<nBands; ++i)
+                    vBands[i].sLimiter.destroy();
+                vBands      = NULL;
+            }
+            nBands      = 0;
+
+            sArena.destroy();
+
+            free_aligned(pData);
+            vDelay      = NULL;
+            pOut        = NULL;
+        }
+
+        bool MultibandLimiter::init(size_t bands, size_t max_sr, float max_lookahead)
+        {
+            if (bands < 1)
+                return false;
+            destroy();
+
+            // Both crossovers borrow temporary buffers from the same arena
+            if (!sScSplit.init(bands, BUF_SIZE, &sArena))
+                return false;
+            if (!sSplit.init(bands, BUF_SIZE, &sArena))
+                return false;
+
+            for (size_t i=0; i<bands; ++i)
+            {
+                sScSplit.set_handler(i, process_sidechain, this, NULL);
+                sSplit.set_handler(i, process_band, this, NULL);
+            }
+
+            // Estimate the size of the delay line
+            Limiter tmp;
+            if (!tmp.init(max_sr, max_lookahead, 0))
+                return false;
+            size_t max_delay    = tmp.max_latency() + LIMITER_TP_DELAY;
+            tmp.destroy();
+
+            size_t band_size    = align_size(bands * sizeof(band_t), DEFAULT_ALIGN);
+            size_t gain_size    = align_size(BUF_SIZE * sizeof(float), DEFAULT_ALIGN);
+            size_t delay_size   = align_size((max_delay + BUF_SIZE) * sizeof(float), DEFAULT_ALIGN);
+            size_t to_alloc     = band_size + gain_size * bands + delay_size;
+
+            uint8_t *data       = NULL;
+            uint8_t *ptr        = alloc_aligned<uint8_t>(data, to_alloc);
+            if (ptr == NULL)
+                return false;
+
+            vBands              = reinterpret_cast<band_t *>(ptr);
+            ptr                += band_size;
+            vDelay              = reinterpret_cast<float *>(ptr);
+            ptr                += delay_size;
+
+            nBands              = 0;
+            nMaxDelay           = max_delay;
+            pData               = data;
+
+            for (size_t i=0; i<bands; ++i)
+            {
+                band_t *b           = &vBands[i];
+
+                b->sLimiter.construct();
+                b->vGain            = reinterpret_cast<float *>(ptr);
+                ptr                += gain_size;
+                b->bEnabled         = true;
+                ++nBands;
+
+                // The limiter only computes the gain, the delay line is shared
+                if (!b->sLimiter.init(max_sr, max_lookahead, 0))
+                {
+                    destroy();
+                    return false;
+                }
+                dsp::fill_one(b->vGain, BUF_SIZE);
+            }
+
+            dsp::fill_zero(vDelay, max_delay + BUF_SIZE);
+
+            return true;
+        }
+
+        void MultibandLimiter::set_sample_rate(size_t sr)
+        {
+            sScSplit.set_sample_rate(sr);
+            sSplit.set_sample_rate(sr);
+            for (size_t i=0; i<nBands; ++i)
+                vBands[i].sLimiter.set_sample_rate(sr);
+        }
+
+        void MultibandLimiter::set_frequency(size_t sp, float freq)
+        {
+            sScSplit.set_frequency(sp, freq);
+            sSplit.set_frequency(sp, freq);
+        }
+
+        void MultibandLimiter::set_slope(size_t sp, size_t slope)
+        {
+            sScSplit.set_slope(sp, slope);
+            sSplit.set_slope(sp, slope);
+        }
+
+        void MultibandLimiter::set_crossover_mode(size_t sp, crossover_mode_t mode)
+        {
+            sScSplit.set_mode(sp, mode);
+            sSplit.set_mode(sp, mode);
+        }
+
+        void MultibandLimiter::set_lookahead(float lookahead)
+        {
+            for (size_t i=0; i<nBands; ++i)
+                vBands[i].sLimiter.set_lookahead(lookahead);
+        }
+
+        void MultibandLimiter::set_mode(limiter_mode_t mode)
+        {
+            for (size_t i=0; i<nBands; ++i)
+                vBands[i].sLimiter.set_mode(mode);
+        }
+
+        void MultibandLimiter::set_true_peak(bool enable)
+        {
+            for (size_t i=0; i<nBands; ++i)
+                vBands[i].sLimiter.set_true_peak(enable);
+        }
+
+        void MultibandLimiter::set_threshold(size_t band, float thresh, bool immediate)
+        {
+            if (band < nBands)
+                vBands[band].sLimiter.set_threshold(thresh, immediate);
+        }
+
+        void MultibandLimiter::set_attack(size_t band, float attack)
+        {
+            if (band < nBands)
+                vBands[band].sLimiter.set_attack(attack);
+        }
+
+        void MultibandLimiter::set_release(size_t band, float release)
+        {
+            if (band < nBands)
+                vBands[band].sLimiter.set_release(release);
+        }
+
+        void MultibandLimiter::set_knee(size_t band, float knee)
+        {
+            if (band < nBands)
+                vBands[band].sLimiter.set_knee(knee);
+        }
+
+        void MultibandLimiter::set_enabled(size_t band, bool enable)
+        {
+            if (band < nBands)
+                vBands[band].bEnabled   = enable;
+        }
+
+        size_t MultibandLimiter::latency() const
+        {
+            return (nBands > 0) ? vBands[0].sLimiter.get_latency() : 0;
+        }
+
+        const float *MultibandLimiter::band_gain(size_t band) const
+        {
+            return (band < nBands) ? vBands[band].vGain : NULL;
+        }
+
+        void MultibandLimiter::process_sidechain(void *object, void *subject, size_t band, const float *data, size_t first, size_t count)
+        {
+            MultibandLimiter *self  = static_cast<MultibandLimiter *>(object);
+            band_t *b               = &self->vBands[band];
+            b->sLimiter.process(&b->vGain[first], data, count);
+        }
+
+        void MultibandLimiter::process_band(void *object, void *subject, size_t band, const float *data, size_t first, size_t count)
+        {
+            MultibandLimiter *self  = static_cast<MultibandLimiter *>(object);
+            band_t *b               = &self->vBands[band];
+            if (b->bEnabled)
+                dsp::fmadd3(&self->pOut[first], data, &b->vGain[first], count);
+        }
+
+        void MultibandLimiter::process(float *dst, const float *src, size_t samples)
+        {
+            size_t head     = nMaxDelay;
+            size_t latency  = this->latency();
+
+            for (size_t offset=0; offset < samples; )
+            {
+                size_t to_do    = lsp_min(samples - offset, size_t(BUF_SIZE));
+
+                // Compute gain curves of all bands from the undelayed signal
+                sScSplit.process(&src[offset], to_do);
+
+                // Split the delayed signal and sum the processed bands to the output
+                dsp::copy(&vDelay[head], &src[offset], to_do);
+                pOut            = &dst[offset];
+                dsp::fill_zero(pOut, to_do);
+                sSplit.process(&vDelay[head - latency], to_do);
+                dsp::move(vDelay, &vDelay[to_do], head);
+
+                offset         += to_do;
+            }
+
+            pOut            = NULL;
+        }
+
+        void MultibandLimiter::dump(IStateDumper *v) const
+        {
+            v->write_object("sScSplit", &sScSplit);
+            v->write_object("sSplit", &sSplit);
+            v->write_object("sArena", &sArena);
+            v->begin_array("vBands", vBands, nBands);
+            {
+                for (size_t i=0; i<nBands; ++i)
+                {
+                    const band_t *b = &vBands[i];
+                    v->begin_object(b, sizeof(band_t));
+                    {
+                        v->write_object("sLimiter", &b->sLimiter);
+                        v->write("vGain", b->vGain);
+                        v->write("bEnabled", b->bEnabled);
+                    }
+                    v->end_object();
+                }
+            }
+            v->end_array();
+            v->write("nBands", nBands);
+            v->write("vDelay", vDelay);
+            v->write("nMaxDelay", nMaxDelay);
+            v->write("pOut", pOut);
+            v->write("pData", pData);
+        }
+    } /* namespace dspu */
+} /* namespace lsp */
@@ -24,7 +24,6 @@
 #include <lsp-plug.in/dsp-units/filters/ButterworthFilter.h>
 #include <lsp-plug.in/stdlib/math.h>
 
-#define MAX_ORDER           100u
 #define BUF_LIM_SIZE        256u
 #define FREQUENCY_LIMIT     10.0f
 
@@ -51,7 +50,7 @@ namespace lsp
             bBypass         = false;
             bSync           = true;
 
-            sFilter.init(MAX_ORDER);
+            sFilter.init(BW_MAX_ORDER);
         }
 
         void ButterworthFilter::update_settings()
@@ -68,7 +67,7 @@ namespace lsp
             else
                 bBypass = false;
 
-            nOrder = lsp_min(nOrder, MAX_ORDER);
+            nOrder = lsp_min(nOrder, BW_MAX_ORDER);
             // We force even order (so all biquads have all coefficients, maximal efficiency).
             nOrder = (nOrder % 2 == 0) ? nOrder : nOrder + 1;
 
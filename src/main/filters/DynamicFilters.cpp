@@ -27,6 +27,7 @@
 #define BLD_BUF_SIZE    8
 #define BUF_SIZE        0x400       /* 1024 samples at one time */
 #define FBUF_SIZE       ((BLD_BUF_SIZE * (BUF_SIZE - BLD_BUF_SIZE) * sizeof(dsp::f_cascade_t)) / sizeof(float))
+#define DEC_BUF_SIZE    ((BUF_SIZE >> 1) + 2)   /* Maximum number of points for decimated mode */
 
 namespace lsp
 {
@@ -55,7 +56,11 @@ namespace lsp
             vMemory         = NULL;
             vCascades       = NULL;
             vBiquads.ptr    = NULL;
+            vDecCascades    = NULL;
+            vDecGain        = NULL;
+            nDecimation     = 1;
             nFilters        = 0;
+            nChannels       = 0;
             nSampleRate     = 0;
             pData           = NULL;
             bClearMem       = false;
@@ -63,13 +68,24 @@ namespace lsp
 
         status_t DynamicFilters::init(size_t filters)
         {
+            return init(filters, 1);
+        }
+
+        status_t DynamicFilters::init(size_t filters, size_t channels)
+        {
+            if (channels < 1)
+                channels                    = 1;
+
             // Determine how many bytes to allocate
             size_t b_per_filter_t       = align_size(sizeof(filter_t) * filters, 64);
-            size_t b_per_memory         = FILTER_CHAINS_MAX * 2 * filters * sizeof(float);
+            size_t b_per_memory         = FILTER_CHAINS_MAX * 2 * filters * channels * sizeof(float);
             size_t b_per_cascades       = align_size(BLD_BUF_SIZE * (BUF_SIZE + BLD_BUF_SIZE) * sizeof(dsp::f_cascade_t), 64);
             size_t b_per_biquad         = sizeof(dsp::biquad_x8_t) * (BUF_SIZE + BLD_BUF_SIZE);
+            size_t b_per_dec_cascades   = align_size(BLD_BUF_SIZE * (DEC_BUF_SIZE + BLD_BUF_SIZE) * sizeof(dsp::f_cascade_t), 64);
+            size_t b_per_dec_gain       = align_size(DEC_BUF_SIZE * sizeof(float), 64);
 
-            size_t to_alloc             = b_per_filter_t + b_per_memory + b_per_cascades + b_per_biquad;
+            size_t to_alloc             = b_per_filter_t + b_per_memory + b_per_cascades + b_per_biquad +
+                                          b_per_dec_cascades + b_per_dec_gain;
 
             // Allocate memory
             uint8_t *ptr                = alloc_aligned<uint8_t>(pData, to_alloc, 64);
@@ -84,7 +100,13 @@ namespace lsp
             vCascades       = reinterpret_cast<dsp::f_cascade_t *>(ptr);
             ptr            += b_per_cascades;
             vBiquads.ptr    = ptr;
+            ptr            += b_per_biquad;
+            vDecCascades    = reinterpret_cast<dsp::f_cascade_t *>(ptr);
+            ptr            += b_per_dec_cascades;
+            vDecGain        = reinterpret_cast<float *>(ptr);
+            ptr            += b_per_dec_gain;
             nFilters        = filters;
+            nChannels       = channels;
 
             // Initialize all filters with default values
             for (size_t i=0; i<filters; ++i)
@@ -102,7 +124,7 @@ namespace lsp
             }
 
             // Cleanup filter memory
-            dsp::fill_zero(vMemory, FILTER_CHAINS_MAX * 2 * filters);
+            dsp::fill_zero(vMemory, FILTER_CHAINS_MAX * 2 * filters * channels);
 
             return STATUS_OK;
         }
@@ -176,6 +198,11 @@ namespace lsp
             return true;
         }
 
+        void DynamicFilters::set_decimation(size_t decimation)
+        {
+            nDecimation         = lsp_limit(decimation, size_t(1), size_t(BUF_SIZE));
+        }
+
         bool DynamicFilters::get_params(size_t id, filter_params_t *params)
         {
             if (id >= nFilters)
@@ -198,19 +225,26 @@ namespace lsp
         }
 
         void DynamicFilters::process(size_t id, float *out, const float *in, const float *gain, size_t samples)
+        {
+            process(id, &out, &in, gain, 1, samples);
+        }
+
+        void DynamicFilters::process(size_t id, float * const *out, const float * const *in, const float *gain, size_t channels, size_t samples)
         {
             // Bypass inactive or non-existing filter
             filter_t *f     = (id < nFilters) ? &vFilters[id] : NULL;
             if ((f == NULL)  || (!f->bActive) || (f->sParams.nType == FLT_NONE) || (f->sParams.nSlope == 0) || (nSampleRate == 0))
             {
-                dsp::copy(out, in, samples);
+                for (size_t i=0; i<channels; ++i)
+                    dsp::copy(out[i], in[i], samples);
                 return;
             }
+            channels        = lsp_min(channels, nChannels);
 
             // Cleanup filter memory
             if (bClearMem)
             {
-                dsp::fill_zero(vMemory, FILTER_CHAINS_MAX * 2 * nFilters);
+                dsp::fill_zero(vMemory, FILTER_CHAINS_MAX * 2 * nFilters * nChannels);
                 bClearMem = false;
             }
 
@@ -222,19 +256,18 @@ namespace lsp
                     2.0*M_PI / nSampleRate; // Matched transfomr coefficient
 
             // Filter memory
-            while (samples > 0)
+            for (size_t off=0; off < samples; )
             {
                 // Initialize counter
-                size_t to_process       = (samples > BUF_SIZE) ? BUF_SIZE : samples;
-                float *fmem             = &vMemory[id * FILTER_CHAINS_MAX * 2];
-                const float *src        = in;
+                size_t to_process       = lsp_min(samples - off, size_t(BUF_SIZE));
+                float *fmem             = &vMemory[id * nChannels * FILTER_CHAINS_MAX * 2];
                 size_t cj               = 0;
 
                 // Process all cascades
                 while (true)
                 {
                     // Generate cascades
-                    size_t nj               = build_filter_bank(vCascades, &f->sParams, cj, gain, to_process);
+                    size_t nj               = build_cascades(vCascades, &f->sParams, cj, gain, to_process);
                     if (nj <= 0)
                         break;
 
@@ -261,7 +294,9 @@ namespace lsp
                             dsp::bilinear_transform_x8(vBiquads.x8, vCascades, kf, to_process + 7);
                         else
                             dsp::matched_transform_x8(vBiquads.x8, vCascades, f->sParams.fFreq, kf, to_process + 7);
-                        dsp::dyn_biquad_process_x8(out, src, fmem, to_process, vBiquads.x8);
+                        for (size_t i=0; i<channels; ++i)
+                            dsp::dyn_biquad_process_x8(&out[i][off], (cj > 0) ? &out[i][off] : &in[i][off],
+                                &fmem[i * FILTER_CHAINS_MAX * 2], to_process, vBiquads.x8);
                     }
                     else if (nj == 4)
                     {
@@ -278,7 +313,9 @@ namespace lsp
                             dsp::bilinear_transform_x4(vBiquads.x4, vCascades, kf, to_process + 3);
                         else
                             dsp::matched_transform_x4(vBiquads.x4, vCascades, f->sParams.fFreq, kf, to_process + 3);
-                        dsp::dyn_biquad_process_x4(out, src, fmem, to_process, vBiquads.x4);
+                        for (size_t i=0; i<channels; ++i)
+                            dsp::dyn_biquad_process_x4(&out[i][off], (cj > 0) ? &out[i][off] : &in[i][off],
+                                &fmem[i * FILTER_CHAINS_MAX * 2], to_process, vBiquads.x4);
                     }
                     else if (nj == 2)
                     {
@@ -288,7 +325,9 @@ namespace lsp
                             dsp::bilinear_transform_x2(vBiquads.x2, vCascades, kf, to_process + 1);
                         else
                             dsp::matched_transform_x2(vBiquads.x2, vCascades, f->sParams.fFreq, kf, to_process + 1);
-                        dsp::dyn_biquad_process_x2(out, src, fmem, to_process, vBiquads.x2);
+                        for (size_t i=0; i<channels; ++i)
+                            dsp::dyn_biquad_process_x2(&out[i][off], (cj > 0) ? &out[i][off] : &in[i][off],
+                                &fmem[i * FILTER_CHAINS_MAX * 2], to_process, vBiquads.x2);
                     }
                     else if (nj == 1)
                     {
@@ -296,23 +335,65 @@ namespace lsp
                             dsp::bilinear_transform_x1(vBiquads.x1, vCascades, kf, to_process);
                         else
                             dsp::matched_transform_x1(vBiquads.x1, vCascades, f->sParams.fFreq, kf, to_process);
-                        dsp::dyn_biquad_process_x1(out, src, fmem, to_process, vBiquads.x1);
+                        for (size_t i=0; i<channels; ++i)
+                            dsp::dyn_biquad_process_x1(&out[i][off], (cj > 0) ? &out[i][off] : &in[i][off],
+                                &fmem[i * FILTER_CHAINS_MAX * 2], to_process, vBiquads.x1);
                     }
 
                     // Update counters and pointers
                     cj                     += nj;
                     fmem                   += nj*2;
-                    src                     = out;
                 }
 
                 // Update samples and pointers
-                samples                -= to_process;
                 gain                   += to_process;
-                out                    += to_process;
-                in                     += to_process;
+                off                    += to_process;
             }
         }
 
+        size_t DynamicFilters::build_cascades(dsp::f_cascade_t *dst, const filter_params_t *fp, size_t cj, const float *sfg, size_t samples)
+        {
+            if ((nDecimation <= 1) || (samples <= 1))
+                return build_filter_bank(dst, fp, cj, sfg, samples);
+
+            // Sample the gain curve at the decimated points, the last point is
+            // always the last sample of the gain curve
+            size_t last             = samples - 1;
+            size_t points           = last / nDecimation + 2;
+            for (size_t p=0; p<points; ++p)
+                vDecGain[p]             = sfg[lsp_min(p * nDecimation, last)];
+
+            // Generate cascades for the decimated points only
+            size_t nc               = build_filter_bank(vDecCascades, fp, cj, vDecGain, points);
+            if (nc <= 0)
+                return nc;
+
+            // Restore cascades for each sample using linear interpolation of coefficients.
+            // The cascade j for the sample i is stored at position nc*(i + j) + j
+            float kd                = 1.0f / float(nDecimation);
+            for (size_t j=0; j<nc; ++j)
+            {
+                for (size_t i=0; i<samples; ++i)
+                {
+                    size_t p                = i / nDecimation;
+                    size_t start            = p * nDecimation;
+                    size_t span             = lsp_min(start + nDecimation, last) - start;
+                    float k                 = (span == nDecimation) ? (i - start) * kd :
+                                              (span > 0) ? float(i - start) / float(span) : 0.0f;
+
+                    const float *a          = vDecCascades[nc*(p + j) + j].t;
+                    const float *b          = vDecCascades[nc*(p + j + 1) + j].t;
+                    float *c                = dst[nc*(i + j) + j].t;
+
+                    // t[0..3] and b[0..3] are stored sequentially
+                    for (size_t k8=0; k8<8; ++k8)
+                        c[k8]                   = a[k8] + (b[k8] - a[k8]) * k;
+                }
+            }
+
+            return nc;
+        }
+
         size_t DynamicFilters::precalc_lrx_ladder_filter_bank(dsp::f_cascade_t *dst, const filter_params_t *fp, size_t cj, const float *sfg, size_t samples)
         {
             size_t slope            = fp->nSlope * 4;
@@ -1966,6 +2047,80 @@ namespace lsp
             return true;
         }
 
+        bool DynamicFilters::freq_chart(size_t id, float * const *dst, const float *f, const float *gain, size_t gains, size_t count)
+        {
+            if (id >= nFilters)
+                return false;
+
+            filter_params_t *fp = &vFilters[id].sParams;
+
+            // Initialize values
+            switch (fp->nType)
+            {
+                case FLT_NONE:
+                    for (size_t i=0; i<gains; ++i)
+                        dsp::pcomplex_fill_ri(dst[i], 1.0f, 0.0f, count);
+                    return true;
+
+                case FLT_BT_AMPLIFIER:
+                case FLT_MT_AMPLIFIER:
+                    for (size_t i=0; i<gains; ++i)
+                        dsp::pcomplex_fill_ri(dst[i], gain[i], 0.0f, count);
+                    return true;
+
+                default:
+                    break;
+            }
+
+            float *tf   = vCascades[BLD_BUF_SIZE * BLD_BUF_SIZE * 2].t;  // Use cascades as a temporary frequency buffer
+            float nf    = M_PI / float(nSampleRate);
+            float kf    = (fp->nType & 1) ? 1.0/tanf(fp->fFreq * nf) : 1.0 / fp->fFreq;
+            float lf    = nSampleRate * 0.499f;
+
+            // Process frequency chart
+            for (size_t off=0; off < count; )
+            {
+                size_t fcount   = lsp_min(count - off, size_t(FBUF_SIZE));
+
+                // Generate set of frequencies, they are shared by all gain values
+                if (fp->nType & 1) // Bilinear
+                {
+                    for (size_t i=0; i<fcount; ++i)
+                    {
+                        float w     = f[off + i];
+                        tf[i]       = tanf((w > lf ? lf : w) * nf) * kf;
+                    }
+                }
+                else
+                    dsp::mul_k3(tf, &f[off], kf, fcount);
+
+                // Build cascades for groups of gain values in the buffer for decimated cascades,
+                // the cascade j of the gain value i is stored at index (i + j) * nj + j
+                for (size_t gi=0; gi < gains; )
+                {
+                    size_t gcount   = lsp_min(gains - gi, size_t(DEC_BUF_SIZE));
+                    size_t cj       = 0;
+
+                    while (true)
+                    {
+                        size_t nj               = build_filter_bank(vDecCascades, fp, cj, &gain[gi], gcount);
+                        if (nj <= 0)
+                            break;
+
+                        for (size_t i=0; i<gcount; ++i)
+                            vcomplex_transfer_calc(&dst[gi + i][off << 1], &vDecCascades[i * nj], tf, cj, nj, fcount);
+                        cj                     += nj;
+                    }
+
+                    gi             += gcount;
+                }
+
+                off            += fcount;
+            }
+
+            return true;
+        }
+
         void DynamicFilters::dump(dspu::IStateDumper *v) const
         {
             v->begin_array("vFilters", vFilters, nFilters);
@@ -1987,7 +2142,11 @@ namespace lsp
             v->end_array();
             v->write("vCascades", vCascades);
             v->write("vBiquads", vBiquads.ptr);
+            v->write("vDecCascades", vDecCascades);
+            v->write("vDecGain", vDecGain);
+            v->write("nDecimation", nDecimation);
             v->write("nFilters", nFilters);
+            v->write("nChannels", nChannels);
             v->write("nSampleRate", nSampleRate);
             v->write("pData", pData);
             v->write("bClearMem", bClearMem);
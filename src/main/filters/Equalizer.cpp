@@ -20,9 +20,12 @@
  */
 
 #include <lsp-plug.in/dsp-units/filters/Equalizer.h>
+#include <lsp-plug.in/dsp-units/misc/fft.h>
+#include <lsp-plug.in/dsp-units/misc/pages.h>
 #include <lsp-plug.in/dsp-units/misc/windows.h>
 #include <lsp-plug.in/common/alloc.h>
 #include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/ipc/Thread.h>
 
 #define BUFFER_SIZE         0x400U
 
@@ -30,6 +33,49 @@ namespace lsp
 {
     namespace dspu
     {
+        class Equalizer::RebuildThread: public ipc::Thread
+        {
+            private:
+                Equalizer          *pEq;
+                volatile bool       bCancel;
+
+            public:
+                explicit RebuildThread(Equalizer *eq)
+                {
+                    pEq         = eq;
+                    bCancel     = false;
+                }
+
+                virtual ~RebuildThread()
+                {
+                }
+
+            public:
+                inline void         stop()      { bCancel = true; }
+
+                virtual status_t run()
+                {
+                    atomic_t job = 0;
+
+                    while (!bCancel)
+                    {
+                        // Wait for the next job
+                        if (atomic_add(&pEq->nJobReq, 0) <= job)
+                        {
+                            ipc::Thread::sleep(1);
+                            continue;
+                        }
+
+                        // Build the kernel and publish the result
+                        pEq->process_job();
+                        ++job;
+                        atomic_add(&pEq->nJobDone, 1);
+                    }
+
+                    return STATUS_OK;
+                }
+        };
+
         Equalizer::Equalizer()
         {
             construct();
@@ -43,6 +89,7 @@ namespace lsp
         void Equalizer::construct()
         {
             sBank.construct();
+            sConv.construct();
 
             vFilters        = NULL;
             nFilters        = 0;
@@ -57,8 +104,32 @@ namespace lsp
             vConv           = NULL;
             vFft            = NULL;
             vTemp           = NULL;
+            vFftTable       = NULL;
             pData           = NULL;
             nFlags          = EF_REBUILD | EF_CLEAR;
+
+            sIdle.construct();
+
+            sJobBank.construct();
+            vJobFilters     = NULL;
+            vJobParams      = NULL;
+            nJobSampleRate  = 0;
+            nJobMode        = EQM_BYPASS;
+            vNextConv       = NULL;
+            vJobFft         = NULL;
+            vJobTemp        = NULL;
+            vXOutBuffer     = NULL;
+            vPrevIn         = NULL;
+            pRebuild        = NULL;
+            nJobReq         = 0;
+            nJobDone        = 0;
+            bJobSubmit      = false;
+            bJobActive      = false;
+            bJobDiscard     = false;
+            bJobSwapped     = false;
+            pJobData        = NULL;
+
+            sPerf.construct();
         }
 
         bool Equalizer::init(size_t filters, size_t fir_rank)
@@ -88,7 +159,7 @@ namespace lsp
                 size_t tmp_size     = lsp_max(conv_size, BUFFER_SIZE);
                 size_t allocate     = fft_size*2 + conv_size*2 + tmp_size + nFirSize;
 
-                float *ptr          = alloc_aligned<float>(pData, allocate);
+                float *ptr          = pages::alloc_aligned<float>(pData, allocate);
                 if (ptr == NULL)
                 {
                     destroy();
@@ -108,10 +179,13 @@ namespace lsp
                 ptr                += conv_size;            // nFirSize * 4
                 vTemp               = ptr;
                 ptr                += tmp_size;             // nFirSize * 4
+
+                // The table is optional, complex transforms are used without it
+                vFftTable           = fft::acquire(fir_rank);
             }
             else
             {
-                float *ptr          = alloc_aligned<float>(pData, BUFFER_SIZE);
+                float *ptr          = pages::alloc_aligned<float>(pData, BUFFER_SIZE);
                 if (ptr == NULL)
                 {
                     destroy();
@@ -149,6 +223,8 @@ namespace lsp
 
         void Equalizer::destroy()
         {
+            stop_async();
+
             if (vFilters != NULL)
             {
                 for (size_t i=0; i<nFilters; ++i)
@@ -158,9 +234,12 @@ namespace lsp
                 nFilters        = 0;
             }
 
+            fft::release(vFftTable);
+            vFftTable       = NULL;
+
             if (pData != NULL)
             {
-                free_aligned(pData);
+                pages::free_aligned(pData);
                 vInBuffer       = NULL;
                 vOutBuffer      = NULL;
                 vConv           = NULL;
@@ -169,6 +248,7 @@ namespace lsp
                 pData           = NULL;
             }
 
+            sConv.destroy();
             sBank.destroy();
         }
 
@@ -187,6 +267,220 @@ namespace lsp
             }
         }
 
+        bool Equalizer::set_async(bool async)
+        {
+            if (async == (pRebuild != NULL))
+                return true;
+            if (!async)
+            {
+                stop_async();
+                return true;
+            }
+            if ((nFirSize <= 0) || (vFilters == NULL))
+                return false;
+
+            // Allocate data for the background job
+            size_t fft_size     = nFirSize << 1;
+            size_t conv_size    = nFirSize << 2;
+            size_t tmp_size     = lsp_max(conv_size, BUFFER_SIZE);
+            size_t allocate     = conv_size * 2 + tmp_size + fft_size + nFirSize;
+
+            float *ptr          = alloc_aligned<float>(pJobData, allocate);
+            if (ptr == NULL)
+                return false;
+            dsp::fill_zero(ptr, allocate);
+
+            vNextConv           = ptr;
+            ptr                += conv_size;
+            vJobFft             = ptr;
+            ptr                += conv_size;
+            vJobTemp            = ptr;
+            ptr                += tmp_size;
+            vXOutBuffer         = ptr;
+            ptr                += fft_size;
+            vPrevIn             = ptr;
+            ptr                += nFirSize;
+
+            // Create copy of filters used by the background thread
+            vJobParams          = new filter_params_t[nFilters];
+            vJobFilters         = new Filter[nFilters];
+            bool res            = (vJobParams != NULL) && (vJobFilters != NULL) &&
+                                  (sJobBank.init(nFilters * FILTER_CHAINS_MAX));
+            for (size_t i=0; (res) && (i<nFilters); ++i)
+                res                 = vJobFilters[i].init(&sJobBank);
+
+            // Launch the thread
+            if (res)
+            {
+                nJobReq             = 0;
+                nJobDone            = 0;
+                pRebuild            = new RebuildThread(this);
+                if (pRebuild != NULL)
+                {
+                    res                 = pRebuild->start() == STATUS_OK;
+                    if (!res)
+                    {
+                        delete pRebuild;
+                        pRebuild            = NULL;
+                    }
+                }
+                else
+                    res                 = false;
+            }
+
+            if (!res)
+            {
+                stop_async();
+                return false;
+            }
+
+            bJobSubmit          = false;
+            bJobActive          = false;
+            bJobDiscard         = false;
+
+            return true;
+        }
+
+        void Equalizer::stop_async()
+        {
+            if (pRebuild != NULL)
+            {
+                pRebuild->stop();
+                pRebuild->join();
+                delete pRebuild;
+                pRebuild        = NULL;
+            }
+
+            // Return the kernel and the output buffer to the main allocation
+            if (bJobSwapped)
+            {
+                dsp::copy(vNextConv, vConv, nFirSize << 2);
+                dsp::copy(vXOutBuffer, vOutBuffer, nFirSize << 1);
+                swap_buffers();
+            }
+
+            // Apply the result of the pending job synchronously
+            if ((bJobActive) || (bJobSubmit))
+                nFlags         |= EF_REBUILD;
+
+            if (vJobFilters != NULL)
+            {
+                for (size_t i=0; i<nFilters; ++i)
+                    vJobFilters[i].destroy();
+                delete [] vJobFilters;
+                vJobFilters     = NULL;
+            }
+            if (vJobParams != NULL)
+            {
+                delete [] vJobParams;
+                vJobParams      = NULL;
+            }
+            sJobBank.destroy();
+
+            if (pJobData != NULL)
+            {
+                free_aligned(pJobData);
+                pJobData        = NULL;
+            }
+
+            vNextConv       = NULL;
+            vJobFft         = NULL;
+            vJobTemp        = NULL;
+            vXOutBuffer     = NULL;
+            vPrevIn         = NULL;
+            bJobSubmit      = false;
+            bJobActive      = false;
+            bJobDiscard     = false;
+        }
+
+        void Equalizer::process_job()
+        {
+            // Build filters from the snapshot of parameters
+            sJobBank.begin();
+            for (size_t i=0; i<nFilters; ++i)
+            {
+                vJobFilters[i].update(nJobSampleRate, &vJobParams[i]);
+                vJobFilters[i].rebuild();
+            }
+            sJobBank.end(true);
+
+            // Build the kernel
+            build_kernel(vNextConv, vJobFft, vJobTemp, vJobFilters, &sJobBank, nJobSampleRate, nJobMode);
+            dsp::fastconv_parse(vNextConv, vJobTemp, nFirRank + 1);
+        }
+
+        bool Equalizer::sync_job()
+        {
+            if (bJobActive)
+            {
+                // Wait until the background job completes
+                if (atomic_add(&nJobDone, 0) < nJobReq)
+                    return false;
+
+                bJobActive          = false;
+                if (!bJobDiscard)
+                    return true;
+                bJobDiscard         = false;
+            }
+
+            // Submit the new job if there are pending changes
+            if (bJobSubmit)
+            {
+                for (size_t i=0; i<nFilters; ++i)
+                    vFilters[i].get_params(&vJobParams[i]);
+                nJobSampleRate      = nSampleRate;
+                nJobMode            = nMode;
+                bJobSubmit          = false;
+                bJobActive          = true;
+                atomic_add(&nJobReq, 1);
+            }
+
+            return false;
+        }
+
+        void Equalizer::switch_kernel()
+        {
+            size_t conv_rank    = nFirRank + 1;
+            float k             = 1.0f / float(nFirSize);
+
+            // Compute the output of the old kernel
+            dsp::move(vOutBuffer, &vOutBuffer[nFirSize], nFirSize);
+            dsp::fill_zero(&vOutBuffer[nFirSize], nFirSize);
+            dsp::fastconv_parse_apply(vOutBuffer, vTemp, vConv, vInBuffer, conv_rank);
+
+            // Compute the output of the new kernel, the impulse response is not longer than
+            // one block, so only the previous block of input data affects the current output
+            dsp::fill_zero(vXOutBuffer, nFirSize << 1);
+            dsp::fastconv_parse_apply(vXOutBuffer, vTemp, vNextConv, vPrevIn, conv_rank);
+            dsp::move(vXOutBuffer, &vXOutBuffer[nFirSize], nFirSize);
+            dsp::fill_zero(&vXOutBuffer[nFirSize], nFirSize);
+            dsp::fastconv_parse_apply(vXOutBuffer, vTemp, vNextConv, vInBuffer, conv_rank);
+
+            // Crossfade the old output into the new one
+            for (size_t i=0; i<nFirSize; ++i)
+                vXOutBuffer[i]      = vOutBuffer[i] + (vXOutBuffer[i] - vOutBuffer[i]) * (i * k);
+
+            // Commit the new kernel
+            swap_buffers();
+        }
+
+        void Equalizer::swap_buffers()
+        {
+            float *conv         = vConv;
+            float *out          = vOutBuffer;
+            vConv               = vNextConv;
+            vOutBuffer          = vXOutBuffer;
+            vNextConv           = conv;
+            vXOutBuffer         = out;
+            bJobSwapped         = !bJobSwapped;
+        }
+
+        void Equalizer::set_cache(FilterCache *cache)
+        {
+            for (size_t i=0; i<nFilters; ++i)
+                vFilters[i].set_cache(cache);
+        }
+
         bool Equalizer::set_params(size_t id, const filter_params_t *params)
         {
             if (id >= nFilters)
@@ -213,90 +507,137 @@ namespace lsp
             return nLatency;
         }
 
-        void Equalizer::reconfigure()
+        void Equalizer::build_kernel(float *conv, float *fft, float *temp, Filter *filters, FilterBank *bank, size_t sr, equalizer_mode_t mode)
         {
-            if (nMode == EQM_BYPASS)
-            {
-                nLatency        = 0;
-                return;
-            }
-
-            // Initialize bank
-            sBank.begin();
-            for (size_t i=0; i<nFilters; ++i)
-                vFilters[i].rebuild();
-            sBank.end(nFlags & EF_CLEAR);
-
-            // Quit if working in IIR mode
-            if (nMode == EQM_IIR)
-            {
-                nFlags          = 0;
-                nLatency        = 0;
-                return;
-            }
-
             size_t fft_size     = nFirSize << 1;
             size_t half_size    = nFirSize >> 1;
 
             // Build filter's magnitude characteristics
-            if (nMode == EQM_FIR)
+            if ((mode == EQM_FIR) || (mode == EQM_FIR_LL))
             {
-                windows::blackman_nuttall(vConv, fft_size);
-                sBank.impulse_response(vTemp, nFirSize);                        // Generate impulse response of the filter
-                dsp::mul2(vTemp, &vConv[nFirSize], nFirSize);                   // Apply window function to the impulse response
-                dsp::pcomplex_r2c(vFft, vTemp, nFirSize);                       // Prepare for FFT transform
-                dsp::packed_direct_fft(vFft, vFft, nFirRank);                   // Perform FFT
-                dsp::pcomplex_mod(vTemp, vFft, nFirSize);                       // Now we have FFT magnitude in vTemp
+                windows::blackman_nuttall(conv, fft_size);
+                bank->impulse_response(temp, nFirSize);                         // Generate impulse response of the filter
+                dsp::mul2(temp, &conv[nFirSize], nFirSize);                     // Apply window function to the impulse response
+                if (vFftTable != NULL)
+                {
+                    fft::real_direct(fft, temp, nFirRank, vFftTable, nFirRank); // Perform FFT of the real signal
+                    dsp::pcomplex_mod(temp, fft, half_size + 1);                // Now we have FFT magnitude in temp
+                }
+                else
+                {
+                    dsp::pcomplex_r2c(fft, temp, nFirSize);                     // Prepare for FFT transform
+                    dsp::packed_direct_fft(fft, fft, nFirRank);                 // Perform FFT
+                    dsp::pcomplex_mod(temp, fft, nFirSize);                     // Now we have FFT magnitude in temp
+                }
             }
-            else if ((nMode == EQM_FFT) || (nMode == EQM_SPM))
+            else if ((mode == EQM_FFT) || (mode == EQM_FFT_LL) || (mode == EQM_SPM))
             {
                 size_t num_filters  = 0;
                 size_t freq_size    = half_size + 1;
-                dsp::lin_inter_set(vConv, 0, 0.0f, half_size, 0.5f * nSampleRate, 0, freq_size); // Compute frequencies
+                dsp::lin_inter_set(conv, 0, 0.0f, half_size, 0.5f * sr, 0, freq_size); // Compute frequencies
 
                 // Build frequency chart for all filters
                 for (size_t i=0; i<nFilters; ++i)
                 {
                     // Skip inactive filters
-                    if (vFilters[i].inactive())
+                    if (filters[i].inactive())
                         continue;
 
                     // Get the frequency chart of the filter
                     if ((num_filters++) > 0)
                     {
-                        vFilters[i].freq_chart(vFft, vConv, freq_size);
-                        dsp::pcomplex_mod(vFft, vFft, freq_size);
-                        dsp::mul2(vTemp, vFft, freq_size);
+                        filters[i].freq_chart(fft, conv, freq_size);
+                        dsp::pcomplex_mod(fft, fft, freq_size);
+                        dsp::mul2(temp, fft, freq_size);
                     }
                     else
                     {
-                        vFilters[i].freq_chart(vFft, vConv, freq_size);
-                        dsp::pcomplex_mod(vTemp, vFft, freq_size);
+                        filters[i].freq_chart(fft, conv, freq_size);
+                        dsp::pcomplex_mod(temp, fft, freq_size);
                     }
                 }
 
                 // Finally, build the correct frequency chart for reverse FFT
                 if (num_filters > 0)
-                    dsp::reverse2(&vTemp[freq_size], &vTemp[1], half_size-1);
+                    dsp::reverse2(&temp[freq_size], &temp[1], half_size-1);
                 else
-                    dsp::fill_one(vTemp, nFirSize);
+                    dsp::fill_one(temp, nFirSize);
+            }
+            else
+                dsp::fill_one(temp, nFirSize);                                  // Flat response
+
+            if (mode == EQM_SPM)
+                return;
+
+            // Transform the magnitude into linear-phase filter
+            if (vFftTable != NULL)
+            {
+                dsp::pcomplex_r2c(fft, temp, half_size + 1);                    // Set phase to 0 for all frequencies
+                fft::real_reverse(&temp[half_size], fft, nFirRank, vFftTable, nFirRank); // Get the synthesized impulse response
             }
             else
-                dsp::fill_one(vTemp, nFirSize);                                 // Flat response
+            {
+                dsp::pcomplex_r2c(fft, temp, nFirSize);                         // Set phase to 0 for all frequencies
+                dsp::packed_reverse_fft(fft, fft, nFirRank);                    // Get the synthesized impulse response
+                dsp::pcomplex_c2r(&temp[half_size], fft, nFirSize);             // Get real part of the impulse response
+            }
+            dsp::copy(temp, &temp[nFirSize], half_size);                        // Make impulse response symmetric
+            windows::blackman_nuttall(conv, nFirSize);                          // Compute the window function
+            dsp::mul2(temp, conv, nFirSize);                                    // Apply the window function
+        }
+
+        void Equalizer::reconfigure()
+        {
+            LSP_DSP_UNITS_PERF_RECONFIGURE(sPerf);
+
+            if (nMode == EQM_BYPASS)
+            {
+                nLatency        = 0;
+                return;
+            }
+
+            // Initialize bank
+            sBank.begin();
+            for (size_t i=0; i<nFilters; ++i)
+                vFilters[i].rebuild();
+            sBank.end(nFlags & EF_CLEAR);
+
+            // Quit if working in IIR mode
+            if (nMode == EQM_IIR)
+            {
+                nFlags          = 0;
+                nLatency        = 0;
+                return;
+            }
 
-            if (nMode != EQM_SPM)
+            // Rebuild the FIR kernel in background if possible, the latency does not change
+            if ((pRebuild != NULL) && (!(nFlags & EF_CLEAR)) && ((nMode == EQM_FIR) || (nMode == EQM_FFT)))
             {
-                // Transform the magnitude into linear-phase filter
-                dsp::pcomplex_r2c(vFft, vTemp, nFirSize);                           // Set phase to 0 for all frequencies
-                dsp::packed_reverse_fft(vFft, vFft, nFirRank);                      // Get the synthesized impulse response
-                dsp::pcomplex_c2r(&vTemp[half_size], vFft, nFirSize);               // Get real part of the impulse response
-                dsp::copy(vTemp, &vTemp[nFirSize], half_size);                      // Make impulse response symmetric
-                windows::blackman_nuttall(vConv, nFirSize);                         // Compute the window function
-                dsp::mul2(vTemp, vConv, nFirSize);                                  // Apply the window function
+                bJobSubmit      = true;
+                nFlags          = 0;
+                return;
+            }
+
+            // The kernel is rebuilt synchronously, drop results of the background job
+            bJobSubmit      = false;
+            bJobDiscard     = bJobActive;
+
+            size_t fft_size     = nFirSize << 1;
+            size_t half_size    = nFirSize >> 1;
+
+            build_kernel(vConv, vFft, vTemp, vFilters, &sBank, nSampleRate, nMode);
 
+            if ((nMode == EQM_FIR_LL) || (nMode == EQM_FFT_LL))
+            {
+                // Pass the impulse response to the partitioned convolver, only the
+                // delay of the linear-phase impulse response remains
+                sConv.init(vTemp, nFirSize, nFirRank, 0.0f);
+                nLatency    = half_size;
+            }
+            else if (nMode != EQM_SPM)
+            {
                 // Get the final impulse response data
                 dsp::fastconv_parse(vConv, vTemp, nFirRank + 1);                    // Get the IR function
-
                 nLatency    = nFirSize + half_size;
             }
             else // EQM_SPM
@@ -312,12 +653,39 @@ namespace lsp
             {
                 dsp::fill_zero(vInBuffer,  fft_size);
                 dsp::fill_zero(vOutBuffer, fft_size);
+                if (vPrevIn != NULL)
+                    dsp::fill_zero(vPrevIn, nFirSize);
                 nBufSize    = 0;
             }
 
+            sIdle.set_tail(tail(sIdle.threshold()));
             nFlags      = 0;
         }
 
+        size_t Equalizer::tail(float threshold) const
+        {
+            switch (nMode)
+            {
+                case EQM_BYPASS:
+                    return 0;
+                case EQM_IIR:
+                    return sBank.tail(threshold);
+                default:
+                    break;
+            }
+
+            // The impulse response of nFirSize samples passes the input and the output
+            // buffers of the block convolution, each of them holds up to nFirSize samples
+            return nFirSize * 3;
+        }
+
+        void Equalizer::set_idle_threshold(float threshold)
+        {
+            sBank.set_idle_threshold(threshold);
+            sIdle.set_threshold(threshold);
+            sIdle.set_tail(tail(threshold));
+        }
+
         void Equalizer::set_mode(equalizer_mode_t mode)
         {
             if (mode == nMode)
@@ -353,8 +721,7 @@ namespace lsp
             if (nFlags != 0)
                 reconfigure();
 
-            float *xre      = vTemp;
-            float *xim      = &xre[BUFFER_SIZE/2];
+            filter_chart_t chart;
 
             // Fill initial values
             dsp::fill_one(re, count);
@@ -363,16 +730,15 @@ namespace lsp
             while (count > 0)
             {
                 // Estimate number of frequencies to process
-                size_t to_do    = lsp_min(count, size_t(BUFFER_SIZE/2));
+                size_t to_do    = lsp_min(count, FILTER_CHART_BLOCK);
 
+                // Compute frequency-dependent data once for all filters
+                Filter::freq_chart_prepare(&chart, nSampleRate, f, to_do);
                 for (size_t i=0; i<nFilters; ++i)
                 {
                     Filter *xf      = &vFilters[i];
-                    if (!xf->active())
-                        continue;
-
-                    xf->freq_chart(xre, xim, f, to_do);
-                    dsp::complex_mul2(re, im, xre, xim, to_do);
+                    if (xf->active())
+                        xf->freq_chart_apply(re, im, &chart);
                 }
 
                 // Update pointers
@@ -388,22 +754,23 @@ namespace lsp
             if (nFlags != 0)
                 reconfigure();
 
+            filter_chart_t chart;
+
             // Fill initial values
             dsp::pcomplex_fill_ri(c, 1.0f, 0.0f, count);
 
             while (count > 0)
             {
                 // Estimate number of frequencies to process
-                size_t to_do    = lsp_min(count, size_t(BUFFER_SIZE/2));
+                size_t to_do    = lsp_min(count, FILTER_CHART_BLOCK);
 
+                // Compute frequency-dependent data once for all filters
+                Filter::freq_chart_prepare(&chart, nSampleRate, f, to_do);
                 for (size_t i=0; i<nFilters; ++i)
                 {
                     Filter *xf      = &vFilters[i];
-                    if (!xf->active())
-                        continue;
-
-                    xf->freq_chart(vTemp, f, to_do);
-                    dsp::pcomplex_mul2(c, vTemp, to_do);
+                    if (xf->active())
+                        xf->freq_chart_apply(c, &chart);
                 }
 
                 // Update pointers
@@ -415,9 +782,19 @@ namespace lsp
 
         void Equalizer::process(float *out, const float *in, size_t samples)
         {
+            LSP_DSP_UNITS_PERF_SCOPE(sPerf, samples);
+
             if (nFlags != 0)
                 reconfigure();
 
+            // Skip the convolution while the equalizer is idle, the filter bank
+            // of EQM_IIR mode detects the idle state itself
+            if ((nMode != EQM_IIR) && (nMode != EQM_BYPASS) && (sIdle.process(in, samples)))
+            {
+                dsp::fill_zero(out, samples);
+                return;
+            }
+
             switch (nMode)
             {
                 case EQM_IIR:
@@ -435,10 +812,18 @@ namespace lsp
                     {
                         if (nBufSize >= nFirSize)
                         {
-                            // Apply FIR processing
-                            dsp::move(vOutBuffer, &vOutBuffer[nFirSize], nFirSize);     // Shift output buffer
-                            dsp::fill_zero(&vOutBuffer[nFirSize], nFirSize);            // Empty tail of output buffer
-                            dsp::fastconv_parse_apply(vOutBuffer, vTemp, vConv, vInBuffer, conv_rank); // Apply convolution
+                            if ((pRebuild != NULL) && (sync_job()))
+                                switch_kernel();                                            // Switch to the kernel built in background
+                            else
+                            {
+                                // Apply FIR processing
+                                dsp::move(vOutBuffer, &vOutBuffer[nFirSize], nFirSize);     // Shift output buffer
+                                dsp::fill_zero(&vOutBuffer[nFirSize], nFirSize);            // Empty tail of output buffer
+                                dsp::fastconv_parse_apply(vOutBuffer, vTemp, vConv, vInBuffer, conv_rank); // Apply convolution
+                            }
+
+                            if (vPrevIn != NULL)
+                                dsp::copy(vPrevIn, vInBuffer, nFirSize);                    // Keep input block for the kernel switch
                             nBufSize    = 0; // Reset buffer size
                         }
 
@@ -459,6 +844,13 @@ namespace lsp
                     break;
                 }
 
+                case EQM_FIR_LL:
+                case EQM_FFT_LL:
+                {
+                    sConv.process(out, in, samples);
+                    break;
+                }
+
                 case EQM_SPM:
                 {
                     size_t half_len     = nFirSize >> 1;
@@ -471,11 +863,21 @@ namespace lsp
                             dsp::move(vOutBuffer, &vOutBuffer[half_len], half_len);     // Shift output buffer
                             dsp::fill_zero(&vOutBuffer[half_len], half_len);            // Empty tail of destination buffer
 
-                            dsp::pcomplex_r2c(vTemp, vInBuffer, nFirSize);              // Convert source buffer to complex numbers
-                            dsp::packed_direct_fft(vTemp, vTemp, nFirRank);             // Perform FFT
-                            dsp::pcomplex_mul2(vTemp, vConv, nFirSize);                 // Apply magnitude
-                            dsp::packed_reverse_fft(vTemp, vTemp, nFirRank);            // Transform back
-                            dsp::pcomplex_c2r(vTemp, vTemp, nFirSize);                  // Add result of convolution to output
+                            if (vFftTable != NULL)
+                            {
+                                // The magnitude is symmetric, only the half of the spectrum is processed
+                                fft::real_direct(vTemp, vInBuffer, nFirRank, vFftTable, nFirRank);
+                                dsp::pcomplex_mul2(vTemp, vConv, half_len + 1);         // Apply magnitude
+                                fft::real_reverse(vTemp, vTemp, nFirRank, vFftTable, nFirRank);
+                            }
+                            else
+                            {
+                                dsp::pcomplex_r2c(vTemp, vInBuffer, nFirSize);          // Convert source buffer to complex numbers
+                                dsp::packed_direct_fft(vTemp, vTemp, nFirRank);         // Perform FFT
+                                dsp::pcomplex_mul2(vTemp, vConv, nFirSize);             // Apply magnitude
+                                dsp::packed_reverse_fft(vTemp, vTemp, nFirRank);        // Transform back
+                                dsp::pcomplex_c2r(vTemp, vTemp, nFirSize);              // Add result of convolution to output
+                            }
                             dsp::fmadd3(vOutBuffer, vTemp, vFft, nFirSize);             // Apply window to the signal and add to buffer
 
                             dsp::move(vInBuffer, &vInBuffer[half_len], half_len);       // Shift input buffer
@@ -528,9 +930,17 @@ namespace lsp
                 case EQM_SPM:
                     dsp::fill_zero(vInBuffer,  nFirSize << 1);
                     dsp::fill_zero(vOutBuffer, nFirSize << 1);
+                    if (vPrevIn != NULL)
+                        dsp::fill_zero(vPrevIn, nFirSize);
                     nBufSize    = 0;
                     break;
 
+                case EQM_FIR_LL:
+                case EQM_FFT_LL:
+                    // Convolver has no separate state reset, re-initialize it
+                    nFlags     |= EF_REBUILD | EF_CLEAR;
+                    break;
+
                 default:
                     break;
             }
@@ -550,14 +960,57 @@ namespace lsp
                 case EQM_SPM:
                     return nFirSize << 1;
 
+                case EQM_FIR_LL:
+                case EQM_FFT_LL:
+                    return nFirSize;
+
                 default:
                     return 0;
             }
         }
 
+        void Equalizer::memory_usage(memory_report_t *r) const
+        {
+            sBank.memory_usage(r);
+            if (vFilters != NULL)
+            {
+                memory::add(r, nFilters * sizeof(Filter), nFilters * sizeof(Filter));
+                for (size_t i=0; i<nFilters; ++i)
+                    vFilters[i].memory_usage(r);
+            }
+
+            // Recursive filters use only the temporary buffer
+            if (pData != NULL)
+            {
+                bool fir            = (nMode != EQM_BYPASS) && (nMode != EQM_IIR);
+                memory::add_pages(r, pData, (fir) ? pages::size(pData) : BUFFER_SIZE * sizeof(float));
+            }
+            sConv.memory_usage(r);
+
+            // Data of the background job
+            if (pJobData != NULL)
+            {
+                size_t fft_size     = nFirSize << 1;
+                size_t conv_size    = nFirSize << 2;
+                size_t tmp_size     = lsp_max(conv_size, BUFFER_SIZE);
+                size_t allocate     = (conv_size * 2 + tmp_size + fft_size + nFirSize) * sizeof(float);
+                memory::add_aligned(r, pJobData, allocate, allocate);
+            }
+            if (vJobParams != NULL)
+                memory::add(r, nFilters * sizeof(filter_params_t), nFilters * sizeof(filter_params_t));
+            if (vJobFilters != NULL)
+            {
+                memory::add(r, nFilters * sizeof(Filter), nFilters * sizeof(Filter));
+                for (size_t i=0; i<nFilters; ++i)
+                    vJobFilters[i].memory_usage(r);
+                sJobBank.memory_usage(r);
+            }
+        }
+
         void Equalizer::dump(IStateDumper *v) const
         {
             v->write_object("sBank", &sBank);
+            v->write_object("sConv", &sConv);
 
             v->begin_array("vFilters", vFilters, nFilters);
             for (size_t i=0; i<nFilters; ++i)
@@ -576,8 +1029,36 @@ namespace lsp
             v->write("vConv", vConv);
             v->write("vFft", vFft);
             v->write("vTemp", vTemp);
+            v->write("vFftTable", vFftTable);
             v->write("nFlags", nFlags);
             v->write("pData", pData);
+
+            v->write_object("sJobBank", &sJobBank);
+            v->begin_array("vJobFilters", vJobFilters, (vJobFilters != NULL) ? nFilters : 0);
+            if (vJobFilters != NULL)
+            {
+                for (size_t i=0; i<nFilters; ++i)
+                    v->write_object(&vJobFilters[i]);
+            }
+            v->end_array();
+            v->write("vJobParams", vJobParams);
+            v->write("nJobSampleRate", nJobSampleRate);
+            v->write("nJobMode", nJobMode);
+            v->write("vNextConv", vNextConv);
+            v->write("vJobFft", vJobFft);
+            v->write("vJobTemp", vJobTemp);
+            v->write("vXOutBuffer", vXOutBuffer);
+            v->write("vPrevIn", vPrevIn);
+            v->write("pRebuild", pRebuild);
+            v->write("nJobReq", int32_t(nJobReq));
+            v->write("nJobDone", int32_t(nJobDone));
+            v->write("bJobSubmit", bJobSubmit);
+            v->write("bJobActive", bJobActive);
+            v->write("bJobDiscard", bJobDiscard);
+            v->write("bJobSwapped", bJobSwapped);
+            v->write("pJobData", pJobData);
+            v->write_object("sPerf", &sPerf);
+            v->write_object("sIdle", &sIdle);
         }
     }
 } /* namespace lsp */
@@ -45,6 +45,7 @@ namespace lsp
         void Filter::construct()
         {
             pBank               = NULL;
+            pCache              = NULL;
             sParams.nType       = FLT_NONE;
             sParams.fFreq       = 0;
             sParams.fFreq2      = 0;
@@ -131,6 +132,7 @@ namespace lsp
                 pBank       = NULL;
             }
 
+            pCache      = NULL;
             nFlags      = 0;
         }
 
@@ -218,6 +220,17 @@ namespace lsp
             // Reset number of cascades
             nItems                  = 0;
 
+            // Try to obtain the built filter from the cache
+            if (load_cached())
+            {
+                if (nFlags & FF_OWN_BANK)
+                    pBank->end(nFlags & FF_CLEAR);
+
+                nFlags     &= FF_OWN_BANK; // Clear all flags except FF_OWN_BANK
+                return;
+            }
+
+            size_t first            = pBank->size();
             filter_params_t fp      = sParams;
 
             // Calculate filter
@@ -389,6 +402,9 @@ namespace lsp
             else if (nMode == FM_MATCHED)
                 matched_transform();
 
+            // Store the built filter to the cache
+            store_cached(first);
+
             // Complete bank if it is internal bank
             if (nFlags & FF_OWN_BANK)
                 pBank->end(nFlags & FF_CLEAR);
@@ -396,51 +412,50 @@ namespace lsp
             nFlags     &= FF_OWN_BANK; // Clear all flags except FF_OWN_BANK
         }
 
-        void Filter::apo_complex_transfer_calc(float *re, float *im, float f)
+        bool Filter::load_cached()
         {
-            // Calculating normalized frequency, wrapped for maximal accuracy:
-            float kf    = f / float(nSampleRate);
-            float w     = 2.0 * M_PI * (kf - floor(kf));
-
-            // Auxiliary variables:
-            float cw    = cosf(w);
-            float sw    = sinf(w);
-
-            // These equations are valid since sw has valid sign
-            float c2w   = cw * cw - sw * sw;    // cos(2 * w)
-            float s2w   = 2.0 * sw * cw;        // sin(2 * w)
+            if (pCache == NULL)
+                return false;
 
-            // Apo will be just one biquad, but let's write this to be able to calculate any digital biquads cascade.
-            float r_re  = 1.0f, r_im = 0.0f;    // The result complex number
-            float b_re, b_im;                   // Temporary values for computing complex multiplication
+            const filter_cache_entry_t *e = pCache->find(&sParams, nSampleRate);
+            if (e == NULL)
+                return false;
 
+            nMode                   = filter_mode_t(e->nMode);
+            nLatency                = e->nLatency;
+            nItems                  = e->nCascades;
             for (size_t i=0; i<nItems; ++i)
-            {
-                dsp::f_cascade_t *c  = &vItems[i];
+                vItems[i]               = e->vCascades[i];
 
-                float alpha     = c->t[0] + c->t[1] * cw + c->t[2] * c2w;
-                float beta      = c->t[1] * sw + c->t[2] * s2w;
-                float gamma     = c->b[0] + c->b[1] * cw + c->b[2] * c2w;
-                float delta     = c->b[1] * sw + c->b[2] * s2w;
-
-                float mag       = 1.0 / (gamma * gamma + delta * delta);
+            for (size_t i=0; i<e->nChains; ++i)
+            {
+                dsp::biquad_x1_t *f     = pBank->add_chain();
+                if (f == NULL)
+                    break;
+                *f                      = e->vChains[i];
+            }
 
-                // Compute current biquad's tranfer function
-                float w_re      = mag * (alpha * gamma - beta * delta);
-                float w_im      = mag * (alpha * delta + beta * gamma);
+            return true;
+        }
 
-                // Compute common transfer function as a product between current biquad's
-                // transfer function and previous value
-                b_re            = r_re*w_re - r_im*w_im;
-                b_im            = r_re*w_im + r_im*w_re;
+        void Filter::store_cached(size_t first)
+        {
+            if (pCache == NULL)
+                return;
 
-                // Commit changes to the result complex number
-                r_re            = b_re;
-                r_im            = b_im;
-            }
+            filter_cache_entry_t *e = pCache->store(&sParams, nSampleRate);
+            if (e == NULL)
+                return;
 
-            *re     = r_re;
-            *im     = r_im;
+            size_t last             = pBank->size();
+            e->nMode                = nMode;
+            e->nLatency             = nLatency;
+            e->nCascades            = nItems;
+            e->nChains              = (last > first) ? last - first : 0;
+            for (size_t i=0; i<nItems; ++i)
+                e->vCascades[i]         = vItems[i];
+            for (size_t i=0; i<e->nChains; ++i)
+                e->vChains[i]           = *(pBank->chain(first + i));
         }
 
         void Filter::freq_chart(float *re, float *im, const float *f, size_t count)
@@ -506,9 +521,23 @@ namespace lsp
 
                 case FM_APO:
                 {
-                    while (count--)
+                    filter_chart_t chart;
+
+                    while (count > 0)
                     {
-                        apo_complex_transfer_calc(re++, im++, *(f++));
+                        size_t to_do    = lsp_min(count, FILTER_CHART_BLOCK);
+
+                        // Compute transfer function
+                        freq_chart_prepare(&chart, nSampleRate, f, to_do);
+                        dsp::fill_one(re, to_do);
+                        dsp::fill_zero(im, to_do);
+                        freq_chart_apply(re, im, &chart);
+
+                        // Update pointers
+                        re         += to_do;
+                        im         += to_do;
+                        f          += to_do;
+                        count      -= to_do;
                     }
                     break;
                 }
@@ -584,10 +613,21 @@ namespace lsp
 
                 case FM_APO:
                 {
-                    while (count--)
+                    filter_chart_t chart;
+
+                    while (count > 0)
                     {
-                        apo_complex_transfer_calc(c, &c[1], *(f++));
-                        c += 2; // Don't forget to move the pointer
+                        size_t to_do    = lsp_min(count, FILTER_CHART_BLOCK);
+
+                        // Compute transfer function
+                        freq_chart_prepare(&chart, nSampleRate, f, to_do);
+                        dsp::pcomplex_fill_ri(c, 1.0f, 0.0f, to_do);
+                        freq_chart_apply(c, &chart);
+
+                        // Update pointers
+                        c          += to_do*2;
+                        f          += to_do;
+                        count      -= to_do;
                     }
                     break;
                 }
@@ -599,6 +639,188 @@ namespace lsp
             }
         }
 
+        void Filter::freq_chart_prepare(filter_chart_t *chart, size_t sr, const float *f, size_t count)
+        {
+            float nf            = M_PI / float(sr);
+            float lf            = sr * 0.499;
+            float kr            = 1.0f / float(sr);
+
+            chart->nSampleRate  = sr;
+            chart->nCount       = count;
+            chart->vFreq        = f;
+
+            for (size_t i=0; i<count; ++i)
+            {
+                // Pre-warped frequency for bilinear filters
+                float w             = f[i];
+                chart->vTan[i]      = tanf((w > lf ? lf : w) * nf);
+
+                // Normalized frequency for digital filters, wrapped for maximal accuracy
+                float kf            = f[i] * kr;
+                w                   = 2.0 * M_PI * (kf - floorf(kf));
+                float cw            = cosf(w);
+                float sw            = sinf(w);
+
+                chart->vCos[i]      = cw;
+                chart->vSin[i]      = sw;
+                chart->vCos2[i]     = cw * cw - sw * sw;
+                chart->vSin2[i]     = 2.0f * sw * cw;
+            }
+        }
+
+        void Filter::freq_chart_apply(float *re, float *im, filter_chart_t *chart)
+        {
+            size_t count        = chart->nCount;
+            filter_mode_t mode  = (nItems > 0) ? nMode : FM_BYPASS;
+            if (mode == FM_BYPASS)
+                return;
+
+            // Chart has been prepared for another sample rate?
+            if (chart->nSampleRate != nSampleRate)
+            {
+                freq_chart(chart->vRe, chart->vIm, chart->vFreq, count);
+                dsp::complex_mul2(re, im, chart->vRe, chart->vIm, count);
+                return;
+            }
+
+            switch (mode)
+            {
+                case FM_BILINEAR:
+                {
+                    float nf    = M_PI / float(nSampleRate);
+                    dsp::mul_k3(chart->vScaled, chart->vTan, 1.0f / tanf(sParams.fFreq * nf), count);
+                    for (size_t i=0; i<nItems; ++i)
+                        dsp::filter_transfer_apply_ri(re, im, &vItems[i], chart->vScaled, count);
+                    break;
+                }
+
+                case FM_MATCHED:
+                {
+                    dsp::mul_k3(chart->vScaled, chart->vFreq, 1.0f / sParams.fFreq, count);
+                    for (size_t i=0; i<nItems; ++i)
+                        dsp::filter_transfer_apply_ri(re, im, &vItems[i], chart->vScaled, count);
+                    break;
+                }
+
+                case FM_APO:
+                {
+                    const float *cw     = chart->vCos;
+                    const float *sw     = chart->vSin;
+                    const float *c2w    = chart->vCos2;
+                    const float *s2w    = chart->vSin2;
+
+                    for (size_t j=0; j<nItems; ++j)
+                    {
+                        const dsp::f_cascade_t *c  = &vItems[j];
+                        const float t0 = c->t[0], t1 = c->t[1], t2 = c->t[2];
+                        const float b0 = c->b[0], b1 = c->b[1], b2 = c->b[2];
+
+                        // No dependencies between iterations, the loop can be vectorized by the compiler
+                        for (size_t i=0; i<count; ++i)
+                        {
+                            float alpha     = t0 + t1 * cw[i] + t2 * c2w[i];
+                            float beta      = t1 * sw[i] + t2 * s2w[i];
+                            float gamma     = b0 + b1 * cw[i] + b2 * c2w[i];
+                            float delta     = b1 * sw[i] + b2 * s2w[i];
+                            float mag       = 1.0f / (gamma * gamma + delta * delta);
+
+                            float w_re      = mag * (alpha * gamma - beta * delta);
+                            float w_im      = mag * (alpha * delta + beta * gamma);
+                            float r_re      = re[i];
+                            float r_im      = im[i];
+
+                            re[i]           = r_re*w_re - r_im*w_im;
+                            im[i]           = r_re*w_im + r_im*w_re;
+                        }
+                    }
+                    break;
+                }
+
+                default:
+                    break;
+            }
+        }
+
+        void Filter::freq_chart_apply(float *c, filter_chart_t *chart)
+        {
+            size_t count        = chart->nCount;
+            filter_mode_t mode  = (nItems > 0) ? nMode : FM_BYPASS;
+            if (mode == FM_BYPASS)
+                return;
+
+            // Chart has been prepared for another sample rate?
+            if (chart->nSampleRate != nSampleRate)
+            {
+                freq_chart(chart->vRe, chart->vIm, chart->vFreq, count);
+                for (size_t i=0; i<count; ++i)
+                {
+                    float r_re      = c[i*2];
+                    float r_im      = c[i*2+1];
+                    float w_re      = chart->vRe[i];
+                    float w_im      = chart->vIm[i];
+                    c[i*2]          = r_re*w_re - r_im*w_im;
+                    c[i*2+1]        = r_re*w_im + r_im*w_re;
+                }
+                return;
+            }
+
+            switch (mode)
+            {
+                case FM_BILINEAR:
+                {
+                    float nf    = M_PI / float(nSampleRate);
+                    dsp::mul_k3(chart->vScaled, chart->vTan, 1.0f / tanf(sParams.fFreq * nf), count);
+                    for (size_t i=0; i<nItems; ++i)
+                        dsp::filter_transfer_apply_pc(c, &vItems[i], chart->vScaled, count);
+                    break;
+                }
+
+                case FM_MATCHED:
+                {
+                    dsp::mul_k3(chart->vScaled, chart->vFreq, 1.0f / sParams.fFreq, count);
+                    for (size_t i=0; i<nItems; ++i)
+                        dsp::filter_transfer_apply_pc(c, &vItems[i], chart->vScaled, count);
+                    break;
+                }
+
+                case FM_APO:
+                {
+                    const float *cw     = chart->vCos;
+                    const float *sw     = chart->vSin;
+                    const float *c2w    = chart->vCos2;
+                    const float *s2w    = chart->vSin2;
+
+                    for (size_t j=0; j<nItems; ++j)
+                    {
+                        const dsp::f_cascade_t *fc = &vItems[j];
+                        const float t0 = fc->t[0], t1 = fc->t[1], t2 = fc->t[2];
+                        const float b0 = fc->b[0], b1 = fc->b[1], b2 = fc->b[2];
+
+                        for (size_t i=0; i<count; ++i)
+                        {
+                            float alpha     = t0 + t1 * cw[i] + t2 * c2w[i];
+                            float beta      = t1 * sw[i] + t2 * s2w[i];
+                            float gamma     = b0 + b1 * cw[i] + b2 * c2w[i];
+                            float delta     = b1 * sw[i] + b2 * s2w[i];
+                            float mag       = 1.0f / (gamma * gamma + delta * delta);
+
+                            float w_re      = mag * (alpha * gamma - beta * delta);
+                            float w_im      = mag * (alpha * delta + beta * gamma);
+                            float r_re      = c[i*2];
+                            float r_im      = c[i*2+1];
+
+                            c[i*2]          = r_re*w_re - r_im*w_im;
+                            c[i*2+1]        = r_re*w_im + r_im*w_re;
+                        }
+                    }
+                    break;
+                }
+
+                default:
+                    break;
+            }
+        }
+
         void Filter::process(float *out, const float *in, size_t samples)
         {
             // Check whether we need to rebuild filter
@@ -1781,12 +2003,28 @@ namespace lsp
             return true;
         }
 
+        void Filter::memory_usage(memory_report_t *r) const
+        {
+            if (vData != NULL)
+            {
+                size_t cascade_size = align_size(sizeof(dsp::f_cascade_t) * FILTER_CHAINS_MAX, DEFAULT_ALIGN);
+                memory::add(r, cascade_size + DEFAULT_ALIGN, nItems * sizeof(dsp::f_cascade_t), DEFAULT_ALIGN);
+            }
+
+            if ((pBank != NULL) && (nFlags & FF_OWN_BANK))
+            {
+                memory::add(r, sizeof(FilterBank), sizeof(FilterBank));
+                pBank->memory_usage(r);
+            }
+        }
+
         void Filter::dump(IStateDumper *v) const
         {
             if (nFlags & FF_OWN_BANK)
                 v->write_object("pBank", pBank);
             else
                 v->write("pBank", pBank);
+            v->write("pCache", pCache);
 
             v->begin_object("sParams", &sParams, sizeof(filter_params_t));
             {
@@ -21,6 +21,9 @@
 
 #include <lsp-plug.in/dsp-units/filters/FilterBank.h>
 #include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define FILTERBANK_SMOOTH_STEP      32      /* Number of samples processed with the same coefficients while smoothing */
 
 namespace lsp
 {
@@ -45,6 +48,13 @@ namespace lsp
             nLastItems  = -1;
             vData       = NULL;
             vBackup     = NULL;
+            vStart      = NULL;
+            vTarget     = NULL;
+            nSmooth     = 0;
+            nSmoothPos  = 0;
+            pCascade    = select_cascade(0);
+
+            sIdle.construct();
         }
 
         void FilterBank::destroy()
@@ -58,6 +68,16 @@ namespace lsp
             construct();
         }
 
+        size_t FilterBank::data_size(size_t filters)
+        {
+            size_t n_banks      = (filters/8) + 3;
+            size_t bank_alloc   = align_size(sizeof(dsp::biquad_t), LSP_DSP_BIQUAD_ALIGN) * n_banks;
+            size_t chain_alloc  = sizeof(dsp::biquad_x1_t) * filters;
+            size_t backup_alloc = sizeof(float) * LSP_DSP_BIQUAD_D_ITEMS * n_banks;
+
+            return bank_alloc * 3 + chain_alloc + backup_alloc;
+        }
+
         bool FilterBank::init(size_t filters)
         {
             destroy();
@@ -69,7 +89,7 @@ namespace lsp
             size_t backup_alloc = sizeof(float) * LSP_DSP_BIQUAD_D_ITEMS * n_banks;
 
             // Allocate data
-            size_t allocate     = bank_alloc + chain_alloc + backup_alloc;
+            size_t allocate     = data_size(filters);
             uint8_t *ptr        = alloc_aligned<uint8_t>(vData, allocate, LSP_DSP_BIQUAD_ALIGN);
             if (ptr == NULL)
                 return false;
@@ -77,6 +97,10 @@ namespace lsp
             // Initialize pointers
             vFilters            = reinterpret_cast<dsp::biquad_t *>(ptr);
             ptr                += bank_alloc;
+            vStart              = reinterpret_cast<dsp::biquad_t *>(ptr);
+            ptr                += bank_alloc;
+            vTarget             = reinterpret_cast<dsp::biquad_t *>(ptr);
+            ptr                += bank_alloc;
             vChains             = reinterpret_cast<dsp::biquad_x1_t *>(ptr);
             ptr                += chain_alloc;
             vBackup             = reinterpret_cast<float *>(ptr);
@@ -97,12 +121,46 @@ namespace lsp
             return &vChains[nItems++];
         }
 
+        size_t FilterBank::num_banks() const
+        {
+            return (nItems >> 3) + ((nItems >> 2) & 1) + ((nItems >> 1) & 1) + (nItems & 1);
+        }
+
+        void FilterBank::set_smooth(size_t samples)
+        {
+            nSmooth             = samples;
+            nSmoothPos          = samples;
+        }
+
+        void FilterBank::interpolate_banks(float k)
+        {
+            // All filter types are stored in the union, so interpolate the area of the largest one
+            const size_t count  = sizeof(dsp::biquad_x8_t) / sizeof(float);
+
+            for (size_t i=0, n=num_banks(); i<n; ++i)
+            {
+                dsp::mix_copy2(
+                    reinterpret_cast<float *>(&vFilters[i].x8),
+                    reinterpret_cast<const float *>(&vStart[i].x8),
+                    reinterpret_cast<const float *>(&vTarget[i].x8),
+                    1.0f - k, k, count);
+            }
+        }
+
         void FilterBank::end(bool clear)
         {
             size_t items        = nItems;
             dsp::biquad_x1_t *c = vChains;
             dsp::biquad_t *b    = vFilters;
 
+            // Remember current coefficients if they can be smoothly changed
+            bool smooth         = (nSmooth > 0) && (!clear) && (nItems == nLastItems);
+            if (smooth)
+            {
+                for (size_t i=0, n=num_banks(); i<n; ++i)
+                    vStart[i]           = vFilters[i];
+            }
+
             // Add 8x filter bank
             while (items >= 8)
             {
@@ -223,10 +281,29 @@ namespace lsp
                 b          ++;
             }
 
-            // Clear delays if structure has changed
+            // Clear delays if structure has changed, the state of the cascade kernel
+            // depends on the number of filters, so the kernel is changed only after reset
             if ((clear) || (nItems != nLastItems))
+            {
                 reset();
+                pCascade        = select_cascade(nItems);
+            }
             nLastItems      = nItems;
+
+            // Update the tail of the bank
+            if (sIdle.enabled())
+                sIdle.set_tail(tail(sIdle.threshold()));
+
+            // Start smoothing from the previous coefficients to the new ones
+            if (smooth)
+            {
+                for (size_t i=0, n=num_banks(); i<n; ++i)
+                    vTarget[i]          = vFilters[i];
+                interpolate_banks(0.0f);
+                nSmoothPos      = 0;
+            }
+            else
+                nSmoothPos      = nSmooth;
         }
 
         void FilterBank::reset()
@@ -249,9 +326,46 @@ namespace lsp
 
         void FilterBank::process(float *out, const float *in, size_t samples)
         {
-            size_t items        = nItems;
-            dsp::biquad_t *f    = vFilters;
+            // Skip processing if the bank is idle
+            bool idle           = sIdle.idle();
+            if (sIdle.process(in, samples))
+            {
+                // The remaining state is below the threshold, drop it and complete smoothing
+                if (!idle)
+                {
+                    reset();
+                    if (nSmoothPos < nSmooth)
+                    {
+                        nSmoothPos          = nSmooth;
+                        interpolate_banks(1.0f);
+                    }
+                }
+                dsp::fill_zero(out, samples);
+                return;
+            }
+
+            // Process with interpolated coefficients
+            while ((nSmoothPos < nSmooth) && (samples > 0))
+            {
+                size_t to_do        = lsp_min(samples, lsp_min(size_t(FILTERBANK_SMOOTH_STEP), nSmooth - nSmoothPos));
+                nSmoothPos         += to_do;
+                interpolate_banks((nSmoothPos < nSmooth) ? float(nSmoothPos) / float(nSmooth) : 1.0f);
+
+                process_banks(out, in, to_do);
+                out                += to_do;
+                in                 += to_do;
+                samples            -= to_do;
+            }
+
+            if (samples > 0)
+                process_banks(out, in, samples);
+        }
 
+        /*
+         * Generic kernel: the banks of 8, 4, 2 and 1 filters are processed one after another
+         */
+        static void process_generic(float *out, const float *in, size_t samples, dsp::biquad_t *f, size_t items)
+        {
             if (items == 0)
             {
                 dsp::copy(out, in, samples);
@@ -284,6 +398,132 @@ namespace lsp
                 dsp::biquad_process_x1(out, in, samples, f);
         }
 
+        /*
+         * Fixed kernel for N <= 4 filters: all filters are applied to the sample in one pass,
+         * loops over filters are unrolled and the coefficients and the state are kept in
+         * registers. The layout of banks is x1 for N=1, x2 for N=2, x2+x1 for N=3 and x4 for N=4,
+         * the state of all filters is stored in the delay of the first bank.
+         */
+        template <size_t N>
+            static void process_cascade(float *out, const float *in, size_t samples, dsp::biquad_t *f, size_t /* items */)
+            {
+                float b0[N], b1[N], b2[N], a1[N], a2[N], d0[N], d1[N];
+
+                // Load coefficients
+                if (N == 1)
+                {
+                    b0[0]       = f->x1.b0;
+                    b1[0]       = f->x1.b1;
+                    b2[0]       = f->x1.b2;
+                    a1[0]       = f->x1.a1;
+                    a2[0]       = f->x1.a2;
+                }
+                else if (N == 4)
+                {
+                    for (size_t j=0; j<N; ++j)
+                    {
+                        b0[j]       = f->x4.b0[j];
+                        b1[j]       = f->x4.b1[j];
+                        b2[j]       = f->x4.b2[j];
+                        a1[j]       = f->x4.a1[j];
+                        a2[j]       = f->x4.a2[j];
+                    }
+                }
+                else
+                {
+                    for (size_t j=0; (j<2) && (j<N); ++j)
+                    {
+                        b0[j]       = f->x2.b0[j];
+                        b1[j]       = f->x2.b1[j];
+                        b2[j]       = f->x2.b2[j];
+                        a1[j]       = f->x2.a1[j];
+                        a2[j]       = f->x2.a2[j];
+                    }
+                    if (N == 3)
+                    {
+                        b0[N-1]     = f[1].x1.b0;
+                        b1[N-1]     = f[1].x1.b1;
+                        b2[N-1]     = f[1].x1.b2;
+                        a1[N-1]     = f[1].x1.a1;
+                        a2[N-1]     = f[1].x1.a2;
+                    }
+                }
+
+                // Load state
+                float *d    = f->d;
+                for (size_t j=0; j<N; ++j)
+                {
+                    d0[j]       = d[j*2];
+                    d1[j]       = d[j*2 + 1];
+                }
+
+                for (size_t i=0; i<samples; ++i)
+                {
+                    float s     = in[i];
+                    for (size_t j=0; j<N; ++j)
+                    {
+                        float r     = b0[j]*s + d0[j];
+                        d0[j]       = d1[j] + b1[j]*s + a1[j]*r;
+                        d1[j]       = b2[j]*s + a2[j]*r;
+                        s           = r;
+                    }
+                    out[i]      = s;
+                }
+
+                // Store state
+                for (size_t j=0; j<N; ++j)
+                {
+                    d[j*2]      = d0[j];
+                    d[j*2 + 1]  = d1[j];
+                }
+            }
+
+        FilterBank::cascade_t FilterBank::select_cascade(size_t items)
+        {
+            switch (items)
+            {
+                case 1: return process_cascade<1>;
+                case 2: return process_cascade<2>;
+                case 3: return process_cascade<3>;
+                case 4: return process_cascade<4>;
+                default: break;
+            }
+            return process_generic;
+        }
+
+        void FilterBank::process_banks(float *out, const float *in, size_t samples)
+        {
+            pCascade(out, in, samples, vFilters, nItems);
+        }
+
+        float FilterBank::pole_radius(const dsp::biquad_x1_t *f)
+        {
+            // The recursive part is y[n] = a1*y[n-1] + a2*y[n-2], poles are roots of z^2 - a1*z - a2
+            float d             = f->a1 * f->a1 + 4.0f * f->a2;
+            if (d < 0.0f)
+                return sqrtf(-f->a2);
+            return 0.5f * (fabsf(f->a1) + sqrtf(d));
+        }
+
+        size_t FilterBank::tail(float threshold) const
+        {
+            // Parallel banks delay the output of each next cascade by one sample
+            size_t res          = nItems;
+            for (size_t i=0; i<nItems; ++i)
+            {
+                size_t t            = IdleDetector::decay_tail(pole_radius(&vChains[i]), threshold);
+                res                 = IdleDetector::add_tail(res, t);
+            }
+
+            return res;
+        }
+
+        void FilterBank::set_idle_threshold(float threshold)
+        {
+            sIdle.set_threshold(threshold);
+            sIdle.set_tail(tail(threshold));
+        }
+
         void FilterBank::impulse_response(float *out, size_t samples)
         {
             // Backup and clean all delays
@@ -306,10 +546,14 @@ namespace lsp
                 f                  ++;
             }
 
-            // Generate impulse response
+            // Generate impulse response for the target coefficients if smoothing is in progress
+            if (nSmoothPos < nSmooth)
+                interpolate_banks(1.0f);
             dsp::fill_zero(out, samples);
             out[0]              = 1.0f;
-            process(out, out, samples);
+            process_banks(out, out, samples);
+            if (nSmoothPos < nSmooth)
+                interpolate_banks(float(nSmoothPos) / float(nSmooth));
 
             // Restore all delays
             dst                 = vBackup;
@@ -323,6 +567,12 @@ namespace lsp
             }
         }
 
+        void FilterBank::memory_usage(memory_report_t *r) const
+        {
+            if (vData != NULL)
+                memory::add_aligned(r, vData, data_size(nMaxItems), data_size(nItems), LSP_DSP_BIQUAD_ALIGN);
+        }
+
         void FilterBank::dump(IStateDumper *v) const
         {
             size_t ni       = nItems;
@@ -414,7 +664,12 @@ namespace lsp
             v->write("nMaxItems", nMaxItems);
             v->write("nLastItems", nLastItems);
             v->write("vBackup", vBackup);
+            v->write("vStart", vStart);
+            v->write("vTarget", vTarget);
+            v->write("nSmooth", nSmooth);
+            v->write("nSmoothPos", nSmoothPos);
             v->write("vData", vData);
+            v->write_object("sIdle", &sIdle);
         }
     }
 } /* namespace lsp */
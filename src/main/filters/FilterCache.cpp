@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/dsp-units/filters/FilterCache.h>
+#include <lsp-plug.in/common/alloc.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        static inline bool params_equal(const filter_params_t *a, const filter_params_t *b)
+        {
+            return (a->nType == b->nType) &&
+                   (a->fFreq == b->fFreq) &&
+                   (a->fFreq2 == b->fFreq2) &&
+                   (a->fGain == b->fGain) &&
+                   (a->nSlope == b->nSlope) &&
+                   (a->fQuality == b->fQuality);
+        }
+
+        FilterCache::FilterCache()
+        {
+            construct();
+        }
+
+        FilterCache::~FilterCache()
+        {
+            destroy();
+        }
+
+        void FilterCache::construct()
+        {
+            vEntries    = NULL;
+            pHead       = NULL;
+            pTail       = NULL;
+            nCapacity   = 0;
+            nSize       = 0;
+            nHits       = 0;
+            nMisses     = 0;
+            pData       = NULL;
+        }
+
+        bool FilterCache::init(size_t capacity)
+        {
+            destroy();
+
+            filter_cache_entry_t *ptr   = alloc_aligned<filter_cache_entry_t>(pData, capacity, DEFAULT_ALIGN);
+            if (ptr == NULL)
+                return false;
+
+            vEntries    = ptr;
+            nCapacity   = capacity;
+            clear();
+
+            return true;
+        }
+
+        void FilterCache::destroy()
+        {
+            if (pData != NULL)
+            {
+                free_aligned(pData);
+                pData       = NULL;
+            }
+
+            construct();
+        }
+
+        void FilterCache::clear()
+        {
+            pHead       = NULL;
+            pTail       = NULL;
+            nSize       = 0;
+            nHits       = 0;
+            nMisses     = 0;
+        }
+
+        void FilterCache::unlink(filter_cache_entry_t *e)
+        {
+            if (e->pPrev != NULL)
+                e->pPrev->pNext     = e->pNext;
+            else
+                pHead               = e->pNext;
+            if (e->pNext != NULL)
+                e->pNext->pPrev     = e->pPrev;
+            else
+                pTail               = e->pPrev;
+
+            e->pPrev            = NULL;
+            e->pNext            = NULL;
+        }
+
+        void FilterCache::link_first(filter_cache_entry_t *e)
+        {
+            e->pPrev            = NULL;
+            e->pNext            = pHead;
+            if (pHead != NULL)
+                pHead->pPrev        = e;
+            else
+                pTail               = e;
+            pHead               = e;
+        }
+
+        const filter_cache_entry_t *FilterCache::find(const filter_params_t *params, size_t sr)
+        {
+            for (filter_cache_entry_t *e = pHead; e != NULL; e = e->pNext)
+            {
+                if ((e->nSampleRate != sr) || (!params_equal(&e->sParams, params)))
+                    continue;
+
+                // Move entry to the head of the list
+                if (e != pHead)
+                {
+                    unlink(e);
+                    link_first(e);
+                }
+                ++nHits;
+                return e;
+            }
+
+            ++nMisses;
+            return NULL;
+        }
+
+        filter_cache_entry_t *FilterCache::store(const filter_params_t *params, size_t sr)
+        {
+            if (nCapacity <= 0)
+                return NULL;
+
+            // Use free entry or replace the least recently used one
+            filter_cache_entry_t *e;
+            if (nSize < nCapacity)
+                e                   = &vEntries[nSize++];
+            else
+            {
+                e                   = pTail;
+                unlink(e);
+            }
+
+            e->sParams          = *params;
+            e->nSampleRate      = sr;
+            e->nMode            = 0;
+            e->nLatency         = 0;
+            e->nCascades        = 0;
+            e->nChains          = 0;
+            link_first(e);
+
+            return e;
+        }
+
+        void FilterCache::dump(IStateDumper *v) const
+        {
+            v->write("vEntries", vEntries);
+            v->write("pHead", pHead);
+            v->write("pTail", pTail);
+            v->write("nCapacity", nCapacity);
+            v->write("nSize", nSize);
+            v->write("nHits", nHits);
+            v->write("nMisses", nMisses);
+            v->write("pData", pData);
+        }
+    }
+} /* namespace lsp */
@@ -0,0 +1,436 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/dsp-units/filters/MultiEqualizer.h>
+#include <lsp-plug.in/dsp-units/misc/fft.h>
+#include <lsp-plug.in/dsp-units/misc/pages.h>
+#include <lsp-plug.in/dsp-units/misc/windows.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        MultiEqualizer::MultiEqualizer()
+        {
+            construct();
+        }
+
+        MultiEqualizer::~MultiEqualizer()
+        {
+            destroy();
+        }
+
+        void MultiEqualizer::construct()
+        {
+            sEq.construct();
+            sBank.construct();
+
+            vConvolvers     = NULL;
+            vChannels       = NULL;
+            nChannels       = 0;
+            nBufSize        = 0;
+            vTemp           = NULL;
+            pData           = NULL;
+        }
+
+        bool MultiEqualizer::init(size_t channels, size_t filters, size_t fir_rank)
+        {
+            destroy();
+
+            // The designer holds the filters, the kernel and its buffers
+            if (!sEq.init(filters, fir_rank))
+                return false;
+            if (!sBank.init(channels, filters * FILTER_CHAINS_MAX))
+            {
+                destroy();
+                return false;
+            }
+
+            vChannels       = new channel_t[channels];
+            if (vChannels == NULL)
+            {
+                destroy();
+                return false;
+            }
+
+            // Allocate buffers of channels for convolution
+            if (fir_rank > 0)
+            {
+                size_t fir_size     = 1 << fir_rank;
+                size_t fft_size     = fir_size << 1;
+                size_t conv_size    = fir_size << 2;
+                size_t allocate     = fft_size * 2 * channels + conv_size;
+
+                float *ptr          = pages::alloc_aligned<float>(pData, allocate);
+                if (ptr == NULL)
+                {
+                    destroy();
+                    return false;
+                }
+                dsp::fill_zero(ptr, allocate);
+
+                vConvolvers         = new Convolver[channels];
+                if (vConvolvers == NULL)
+                {
+                    destroy();
+                    return false;
+                }
+
+                vTemp               = ptr;
+                ptr                += conv_size;
+                for (size_t i=0; i<channels; ++i)
+                {
+                    channel_t *c        = &vChannels[i];
+                    c->vInBuffer        = ptr;
+                    ptr                += fft_size;
+                    c->vOutBuffer       = ptr;
+                    ptr                += fft_size;
+                }
+            }
+            else
+            {
+                for (size_t i=0; i<channels; ++i)
+                {
+                    channel_t *c        = &vChannels[i];
+                    c->vInBuffer        = NULL;
+                    c->vOutBuffer       = NULL;
+                }
+            }
+
+            nChannels       = channels;
+            nBufSize        = 0;
+
+            return true;
+        }
+
+        void MultiEqualizer::destroy()
+        {
+            // Convolvers release the shared spectrum to the cache
+            if (vConvolvers != NULL)
+            {
+                for (size_t i=0; i<nChannels; ++i)
+                    vConvolvers[i].destroy();
+                delete [] vConvolvers;
+                vConvolvers     = NULL;
+            }
+
+            if (vChannels != NULL)
+            {
+                delete [] vChannels;
+                vChannels       = NULL;
+            }
+
+            if (pData != NULL)
+            {
+                pages::free_aligned(pData);
+                vTemp           = NULL;
+            }
+
+            nChannels       = 0;
+            nBufSize        = 0;
+
+            sBank.destroy();
+            sEq.destroy();
+        }
+
+        void MultiEqualizer::set_sample_rate(size_t sr)
+        {
+            if (sEq.nSampleRate == sr)
+                return;
+
+            sEq.set_sample_rate(sr);
+            sEq.nFlags     |= Equalizer::EF_REBUILD;
+        }
+
+        void MultiEqualizer::reconfigure()
+        {
+            equalizer_mode_t mode   = sEq.nMode;
+            bool clear              = sEq.nFlags & Equalizer::EF_CLEAR;
+
+            if (mode == EQM_BYPASS)
+            {
+                sEq.nLatency    = 0;
+                return;
+            }
+
+            // Rebuild the filters once for all channels
+            FilterBank *bank        = &sEq.sBank;
+            bank->begin();
+            for (size_t i=0; i<sEq.nFilters; ++i)
+                sEq.vFilters[i].rebuild();
+            bank->end(clear);
+
+            if (mode == EQM_IIR)
+            {
+                sBank.load(bank, clear);
+                sEq.nFlags      = 0;
+                sEq.nLatency    = 0;
+                return;
+            }
+
+            // Build the kernel once for all channels
+            size_t fir_size     = sEq.nFirSize;
+            size_t half_size    = fir_size >> 1;
+
+            sEq.build_kernel(sEq.vConv, sEq.vFft, sEq.vTemp, sEq.vFilters, bank, sEq.nSampleRate, mode);
+
+            if ((mode == EQM_FIR_LL) || (mode == EQM_FFT_LL))
+            {
+                // The first convolver partitions the spectrum, others take it from the cache
+                for (size_t i=0; i<nChannels; ++i)
+                    vConvolvers[i].init(sEq.vTemp, fir_size, sEq.nFirRank, 0.0f, false, &sCache);
+                sEq.nLatency    = half_size;
+            }
+            else if (mode != EQM_SPM)
+            {
+                dsp::fastconv_parse(sEq.vConv, sEq.vTemp, sEq.nFirRank + 1);      // Get the IR function
+                sEq.nLatency    = fir_size + half_size;
+            }
+            else // EQM_SPM
+            {
+                dsp::pcomplex_r2c(sEq.vConv, sEq.vTemp, fir_size);                  // Convert magnitude to complex value
+                windows::sqr_cosine(sEq.vFft, fir_size);                            // Also provide window
+                sEq.nLatency    = fir_size;
+            }
+
+            // Clear state of channels?
+            if (clear)
+            {
+                for (size_t i=0; i<nChannels; ++i)
+                {
+                    channel_t *c    = &vChannels[i];
+                    dsp::fill_zero(c->vInBuffer, fir_size << 1);
+                    dsp::fill_zero(c->vOutBuffer, fir_size << 1);
+                }
+                nBufSize        = 0;
+            }
+
+            sEq.nFlags      = 0;
+        }
+
+        size_t MultiEqualizer::get_latency()
+        {
+            if (sEq.nFlags != 0)
+                reconfigure();
+            return sEq.nLatency;
+        }
+
+        void MultiEqualizer::freq_chart(float *re, float *im, const float *f, size_t count)
+        {
+            // Rebuild here, otherwise the designer rebuilds only its own state
+            if (sEq.nFlags != 0)
+                reconfigure();
+            sEq.freq_chart(re, im, f, count);
+        }
+
+        void MultiEqualizer::freq_chart(float *c, const float *f, size_t count)
+        {
+            if (sEq.nFlags != 0)
+                reconfigure();
+            sEq.freq_chart(c, f, count);
+        }
+
+        void MultiEqualizer::process(float * const *out, const float * const *in, size_t samples)
+        {
+            if (sEq.nFlags != 0)
+                reconfigure();
+
+            size_t fir_size     = sEq.nFirSize;
+            const float *conv   = sEq.vConv;
+
+            switch (sEq.nMode)
+            {
+                case EQM_IIR:
+                {
+                    sBank.process(out, in, samples);
+                    break;
+                }
+
+                case EQM_FIR:
+                case EQM_FFT:
+                {
+                    size_t conv_rank    = sEq.nFirRank + 1;
+
+                    for (size_t offset=0; offset < samples; )
+                    {
+                        if (nBufSize >= fir_size)
+                        {
+                            // Apply the same kernel to all channels
+                            for (size_t i=0; i<nChannels; ++i)
+                            {
+                                channel_t *c    = &vChannels[i];
+                                dsp::move(c->vOutBuffer, &c->vOutBuffer[fir_size], fir_size);
+                                dsp::fill_zero(&c->vOutBuffer[fir_size], fir_size);
+                                dsp::fastconv_parse_apply(c->vOutBuffer, vTemp, conv, c->vInBuffer, conv_rank);
+                            }
+                            nBufSize    = 0;
+                        }
+
+                        size_t to_process = lsp_min(samples - offset, fir_size - nBufSize);
+                        for (size_t i=0; i<nChannels; ++i)
+                        {
+                            channel_t *c    = &vChannels[i];
+                            dsp::copy(&c->vInBuffer[nBufSize], &in[i][offset], to_process);
+                            dsp::copy(&out[i][offset], &c->vOutBuffer[nBufSize], to_process);
+                        }
+
+                        nBufSize       += to_process;
+                        offset         += to_process;
+                    }
+                    break;
+                }
+
+                case EQM_FIR_LL:
+                case EQM_FFT_LL:
+                {
+                    for (size_t i=0; i<nChannels; ++i)
+                        vConvolvers[i].process(out[i], in[i], samples);
+                    break;
+                }
+
+                case EQM_SPM:
+                {
+                    size_t half_len     = fir_size >> 1;
+                    size_t fir_rank     = sEq.nFirRank;
+                    const float *table  = sEq.vFftTable;
+                    const float *window = sEq.vFft;
+
+                    for (size_t offset=0; offset < samples; )
+                    {
+                        if (nBufSize >= half_len)
+                        {
+                            for (size_t i=0; i<nChannels; ++i)
+                            {
+                                channel_t *c    = &vChannels[i];
+                                dsp::move(c->vOutBuffer, &c->vOutBuffer[half_len], half_len);
+                                dsp::fill_zero(&c->vOutBuffer[half_len], half_len);
+
+                                if (table != NULL)
+                                {
+                                    fft::real_direct(vTemp, c->vInBuffer, fir_rank, table, fir_rank);
+                                    dsp::pcomplex_mul2(vTemp, conv, half_len + 1);
+                                    fft::real_reverse(vTemp, vTemp, fir_rank, table, fir_rank);
+                                }
+                                else
+                                {
+                                    dsp::pcomplex_r2c(vTemp, c->vInBuffer, fir_size);
+                                    dsp::packed_direct_fft(vTemp, vTemp, fir_rank);
+                                    dsp::pcomplex_mul2(vTemp, conv, fir_size);
+                                    dsp::packed_reverse_fft(vTemp, vTemp, fir_rank);
+                                    dsp::pcomplex_c2r(vTemp, vTemp, fir_size);
+                                }
+                                dsp::fmadd3(c->vOutBuffer, vTemp, window, fir_size);
+                                dsp::move(c->vInBuffer, &c->vInBuffer[half_len], half_len);
+                            }
+                            nBufSize    = 0;
+                        }
+
+                        size_t to_process = lsp_min(samples - offset, half_len - nBufSize);
+                        for (size_t i=0; i<nChannels; ++i)
+                        {
+                            channel_t *c    = &vChannels[i];
+                            dsp::copy(&c->vInBuffer[half_len + nBufSize], &in[i][offset], to_process);
+                            dsp::copy(&out[i][offset], &c->vOutBuffer[nBufSize], to_process);
+                        }
+
+                        nBufSize       += to_process;
+                        offset         += to_process;
+                    }
+                    break;
+                }
+
+                case EQM_BYPASS:
+                default:
+                {
+                    for (size_t i=0; i<nChannels; ++i)
+                        if (out[i] != in[i])
+                            dsp::copy(out[i], in[i], samples);
+                    break;
+                }
+            }
+        }
+
+        void MultiEqualizer::reset()
+        {
+            switch (sEq.nMode)
+            {
+                case EQM_BYPASS:
+                    return;
+
+                case EQM_IIR:
+                    sBank.reset();
+                    break;
+
+                case EQM_FIR:
+                case EQM_FFT:
+                case EQM_SPM:
+                    for (size_t i=0; i<nChannels; ++i)
+                    {
+                        channel_t *c    = &vChannels[i];
+                        dsp::fill_zero(c->vInBuffer, sEq.nFirSize << 1);
+                        dsp::fill_zero(c->vOutBuffer, sEq.nFirSize << 1);
+                    }
+                    nBufSize    = 0;
+                    break;
+
+                case EQM_FIR_LL:
+                case EQM_FFT_LL:
+                    // Convolvers have no separate state reset, re-initialize them
+                    sEq.nFlags     |= Equalizer::EF_REBUILD | Equalizer::EF_CLEAR;
+                    break;
+
+                default:
+                    break;
+            }
+        }
+
+        void MultiEqualizer::dump(IStateDumper *v) const
+        {
+            v->write_object("sEq", &sEq);
+            v->write_object("sBank", &sBank);
+            v->begin_array("vConvolvers", vConvolvers, (vConvolvers != NULL) ? nChannels : 0);
+            if (vConvolvers != NULL)
+            {
+                for (size_t i=0; i<nChannels; ++i)
+                    v->write_object(&vConvolvers[i]);
+            }
+            v->end_array();
+            v->begin_array("vChannels", vChannels, nChannels);
+            for (size_t i=0; i<nChannels; ++i)
+            {
+                const channel_t *c = &vChannels[i];
+                v->begin_object(c, sizeof(channel_t));
+                {
+                    v->write("vInBuffer", c->vInBuffer);
+                    v->write("vOutBuffer", c->vOutBuffer);
+                }
+                v->end_object();
+            }
+            v->end_array();
+            v->write("nChannels", nChannels);
+            v->write("nBufSize", nBufSize);
+            v->write("vTemp", vTemp);
+            v->write("pData", pData);
+        }
+    }
+} /* namespace lsp */
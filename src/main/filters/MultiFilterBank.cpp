@@ -0,0 +1,221 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/dsp-units/filters/MultiFilterBank.h>
+#include <lsp-plug.in/common/alloc.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        MultiFilterBank::MultiFilterBank()
+        {
+            construct();
+        }
+
+        MultiFilterBank::~MultiFilterBank()
+        {
+            destroy();
+        }
+
+        void MultiFilterBank::construct()
+        {
+            vChains     = NULL;
+            nChannels   = 0;
+            nGroups     = 0;
+            nItems      = 0;
+            nMaxItems   = 0;
+            nLastItems  = -1;
+            vDelays     = NULL;
+            vBuffer     = NULL;
+            vData       = NULL;
+        }
+
+        void MultiFilterBank::destroy()
+        {
+            if (vData != NULL)
+            {
+                free_aligned(vData);
+                vData       = NULL;
+            }
+
+            construct();
+        }
+
+        bool MultiFilterBank::init(size_t channels, size_t filters)
+        {
+            destroy();
+
+            // Calculate data size
+            size_t groups       = (channels + MFB_LANES - 1) / MFB_LANES;
+            size_t chain_alloc  = align_size(sizeof(dsp::biquad_x1_t) * filters, LSP_DSP_BIQUAD_ALIGN);
+            size_t delay_alloc  = sizeof(float) * groups * filters * MFB_LANES * 2;
+            size_t buf_alloc    = sizeof(float) * MFB_BLOCK * MFB_LANES;
+
+            // Allocate data
+            size_t allocate     = chain_alloc + delay_alloc + buf_alloc;
+            uint8_t *ptr        = alloc_aligned<uint8_t>(vData, allocate, LSP_DSP_BIQUAD_ALIGN);
+            if (ptr == NULL)
+                return false;
+
+            // Initialize pointers
+            vChains             = reinterpret_cast<dsp::biquad_x1_t *>(ptr);
+            ptr                += chain_alloc;
+            vDelays             = reinterpret_cast<float *>(ptr);
+            ptr                += delay_alloc;
+            vBuffer             = reinterpret_cast<float *>(ptr);
+            ptr                += buf_alloc;
+
+            // Update parameters
+            nChannels           = channels;
+            nGroups             = groups;
+            nItems              = 0;
+            nMaxItems           = filters;
+            nLastItems          = -1;
+
+            dsp::fill_zero(vDelays, groups * filters * MFB_LANES * 2);
+            dsp::fill_zero(vBuffer, MFB_BLOCK * MFB_LANES);
+
+            return true;
+        }
+
+        dsp::biquad_x1_t *MultiFilterBank::add_chain()
+        {
+            if (nItems >= nMaxItems)
+                return (nItems <= 0) ? NULL : &vChains[nItems-1];
+            return &vChains[nItems++];
+        }
+
+        void MultiFilterBank::end(bool clear)
+        {
+            // Clear delays if structure has changed
+            if ((clear) || (nItems != nLastItems))
+                reset();
+            nLastItems      = nItems;
+        }
+
+        void MultiFilterBank::load(const FilterBank *bank, bool clear)
+        {
+            begin();
+            for (size_t i=0, n=bank->size(); i<n; ++i)
+            {
+                dsp::biquad_x1_t *c = add_chain();
+                if (c == NULL)
+                    break;
+                *c                  = *(bank->chain(i));
+            }
+            end(clear);
+        }
+
+        void MultiFilterBank::reset()
+        {
+            dsp::fill_zero(vDelays, nGroups * nMaxItems * MFB_LANES * 2);
+        }
+
+        void MultiFilterBank::process(float * const *out, const float * const *in, size_t samples)
+        {
+            if (nItems == 0)
+            {
+                for (size_t i=0; i<nChannels; ++i)
+                    dsp::copy(out[i], in[i], samples);
+                return;
+            }
+
+            for (size_t g=0; g<nGroups; ++g)
+            {
+                size_t first        = g * MFB_LANES;
+                size_t lanes        = lsp_min(nChannels - first, size_t(MFB_LANES));
+                float *gd           = &vDelays[g * nMaxItems * MFB_LANES * 2];
+
+                for (size_t offset=0; offset < samples; )
+                {
+                    size_t to_do        = lsp_min(samples - offset, size_t(MFB_BLOCK));
+
+                    // Interleave input data, unused lanes are processed but never read
+                    for (size_t l=0; l<lanes; ++l)
+                    {
+                        const float *src    = &in[first + l][offset];
+                        for (size_t i=0; i<to_do; ++i)
+                            vBuffer[i * MFB_LANES + l] = src[i];
+                    }
+
+                    // Apply the cascade to all lanes, transposed direct form II
+                    for (size_t j=0; j<nItems; ++j)
+                    {
+                        const dsp::biquad_x1_t *f   = &vChains[j];
+                        float *d0           = &gd[j * MFB_LANES * 2];
+                        float *d1           = &d0[MFB_LANES];
+                        float *x            = vBuffer;
+
+                        for (size_t i=0; i<to_do; ++i, x += MFB_LANES)
+                        {
+                            for (size_t l=0; l<MFB_LANES; ++l)
+                            {
+                                float s         = x[l];
+                                float r         = f->b0 * s + d0[l];
+                                d0[l]           = f->b1 * s + f->a1 * r + d1[l];
+                                d1[l]           = f->b2 * s + f->a2 * r;
+                                x[l]            = r;
+                            }
+                        }
+                    }
+
+                    // De-interleave output data
+                    for (size_t l=0; l<lanes; ++l)
+                    {
+                        float *dst          = &out[first + l][offset];
+                        for (size_t i=0; i<to_do; ++i)
+                            dst[i]              = vBuffer[i * MFB_LANES + l];
+                    }
+
+                    offset             += to_do;
+                }
+            }
+        }
+
+        void MultiFilterBank::dump(IStateDumper *v) const
+        {
+            v->begin_array("vChains", vChains, nItems);
+            for (size_t i=0; i<nItems; ++i)
+            {
+                dsp::biquad_x1_t *bq = &vChains[i];
+                v->begin_object(bq, sizeof(dsp::biquad_x1_t));
+                {
+                    v->write("b0", bq->b0);
+                    v->write("b1", bq->b1);
+                    v->write("b2", bq->b2);
+                    v->write("a1", bq->a1);
+                    v->write("a2", bq->a2);
+                }
+                v->end_object();
+            }
+            v->end_array();
+            v->write("nChannels", nChannels);
+            v->write("nGroups", nGroups);
+            v->write("nItems", nItems);
+            v->write("nMaxItems", nMaxItems);
+            v->write("nLastItems", nLastItems);
+            v->write("vDelays", vDelays);
+            v->write("vBuffer", vBuffer);
+            v->write("vData", vData);
+        }
+    }
+} /* namespace lsp */
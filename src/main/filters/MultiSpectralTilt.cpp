@@ -0,0 +1,221 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/dsp-units/filters/MultiSpectralTilt.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#define BUF_LIM_SIZE            256u
+
+namespace lsp
+{
+    namespace dspu
+    {
+        MultiSpectralTilt::MultiSpectralTilt()
+        {
+            construct();
+        }
+
+        MultiSpectralTilt::~MultiSpectralTilt()
+        {
+            destroy();
+        }
+
+        void MultiSpectralTilt::construct()
+        {
+            vInputs         = NULL;
+            vBuffers        = NULL;
+            nChannels       = 0;
+            bBypass         = true;
+            bSync           = true;
+            pData           = NULL;
+        }
+
+        void MultiSpectralTilt::destroy()
+        {
+            if (vInputs != NULL)
+            {
+                delete [] vInputs;
+                vInputs         = NULL;
+            }
+
+            if (vBuffers != NULL)
+            {
+                delete [] vBuffers;
+                vBuffers        = NULL;
+            }
+
+            if (pData != NULL)
+            {
+                free_aligned(pData);
+                pData           = NULL;
+            }
+
+            sBank.destroy();
+            nChannels       = 0;
+        }
+
+        bool MultiSpectralTilt::init(size_t channels)
+        {
+            destroy();
+
+            float *ptr      = alloc_aligned<float>(pData, channels * BUF_LIM_SIZE, DEFAULT_ALIGN);
+            if (ptr == NULL)
+                return false;
+            vInputs         = new const float *[channels];
+            vBuffers        = new float *[channels];
+            if ((vInputs == NULL) || (vBuffers == NULL))
+            {
+                destroy();
+                return false;
+            }
+
+            // The cascade consists of biquads, each biquad covers two orders of the filter
+            if (!sBank.init(channels, STLT_MAX_ORDER / 2))
+            {
+                destroy();
+                return false;
+            }
+
+            for (size_t i=0; i<channels; ++i)
+            {
+                vInputs[i]      = NULL;
+                vBuffers[i]     = ptr;
+                ptr            += BUF_LIM_SIZE;
+            }
+
+            nChannels       = channels;
+            bBypass         = true;
+            bSync           = true;
+
+            return true;
+        }
+
+        void MultiSpectralTilt::update_settings()
+        {
+            if (!bSync)
+                return;
+
+            sTilt.update_settings();
+
+            // Clear the memory of the filter only when it leaves the bypass
+            bool bypass     = sTilt.bypassed();
+            if (!bypass)
+                sBank.load(sTilt.filter_bank(), bBypass);
+            bBypass         = bypass;
+
+            bSync           = false;
+        }
+
+        void MultiSpectralTilt::process_add(float * const *dst, const float * const *src, size_t count)
+        {
+            if (src == NULL)
+            {
+                // No inputs, interpret `src` as zeros: dst[i] = dst[i] + 0 = dst[i]
+                // => Nothing to do
+                return;
+            }
+            else if (bBypass)
+            {
+                // Bypass is set: dst[i] = dst[i] + src[i]
+                for (size_t i=0; i<nChannels; ++i)
+                    dsp::add2(dst[i], src[i], count);
+                return;
+            }
+
+            for (size_t offset=0; offset < count; )
+            {
+                size_t to_do = lsp_min(count - offset, BUF_LIM_SIZE);
+
+                // dst[i] = dst[i] + filter(src[i])
+                for (size_t i=0; i<nChannels; ++i)
+                    vInputs[i]      = &src[i][offset];
+                sBank.process(vBuffers, vInputs, to_do);
+                for (size_t i=0; i<nChannels; ++i)
+                    dsp::add2(&dst[i][offset], vBuffers[i], to_do);
+
+                offset += to_do;
+            }
+        }
+
+        void MultiSpectralTilt::process_mul(float * const *dst, const float * const *src, size_t count)
+        {
+            if (src == NULL)
+            {
+                // No inputs, interpret `src` as zeros: dst[i] = dst[i] * 0 = 0
+                for (size_t i=0; i<nChannels; ++i)
+                    dsp::fill_zero(dst[i], count);
+                return;
+            }
+            else if (bBypass)
+            {
+                // Bypass is set: dst[i] = dst[i] * src[i]
+                for (size_t i=0; i<nChannels; ++i)
+                    dsp::mul2(dst[i], src[i], count);
+                return;
+            }
+
+            for (size_t offset=0; offset < count; )
+            {
+                size_t to_do = lsp_min(count - offset, BUF_LIM_SIZE);
+
+                // dst[i] = dst[i] * filter(src[i])
+                for (size_t i=0; i<nChannels; ++i)
+                    vInputs[i]      = &src[i][offset];
+                sBank.process(vBuffers, vInputs, to_do);
+                for (size_t i=0; i<nChannels; ++i)
+                    dsp::mul2(&dst[i][offset], vBuffers[i], to_do);
+
+                offset += to_do;
+            }
+        }
+
+        void MultiSpectralTilt::process_overwrite(float * const *dst, const float * const *src, size_t count)
+        {
+            if (src == NULL)
+            {
+                for (size_t i=0; i<nChannels; ++i)
+                    dsp::fill_zero(dst[i], count);
+            }
+            else if (bBypass)
+            {
+                for (size_t i=0; i<nChannels; ++i)
+                    if (dst[i] != src[i])
+                        dsp::copy(dst[i], src[i], count);
+            }
+            else
+                sBank.process(dst, src, count);
+        }
+
+        void MultiSpectralTilt::dump(IStateDumper *v) const
+        {
+            v->write_object("sTilt", &sTilt);
+            v->write_object("sBank", &sBank);
+            v->write("vInputs", vInputs);
+            v->write("vBuffers", vBuffers);
+            v->write("nChannels", nChannels);
+            v->write("bBypass", bBypass);
+            v->write("bSync", bSync);
+            v->write("pData", pData);
+        }
+    }
+} /* namespace lsp */
@@ -0,0 +1,257 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/dsp-units/filters/SVFilter.h>
+#include <lsp-plug.in/dsp-units/const.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define SVF_FREQ_MIN        10.0f       /* Minimum frequency of the filter */
+#define SVF_FREQ_MAX        0.49f       /* Maximum frequency relative to the sample rate */
+
+namespace lsp
+{
+    namespace dspu
+    {
+        SVFilter::SVFilter()
+        {
+            construct();
+        }
+
+        SVFilter::~SVFilter()
+        {
+        }
+
+        void SVFilter::construct()
+        {
+            enType          = SVF_NONE;
+            nSampleRate     = LSP_DSP_UNITS_DEFAULT_SAMPLE_RATE;
+            fFrequency      = 1000.0f;
+            fQuality        = M_SQRT1_2;
+            fGain           = 1.0f;
+            fK              = M_SQRT2;
+            fGScale         = 1.0f;
+            sCoeffs.a1      = 1.0f;
+            sCoeffs.a2      = 0.0f;
+            sCoeffs.a3      = 0.0f;
+            sCoeffs.m0      = 1.0f;
+            sCoeffs.m1      = 0.0f;
+            sCoeffs.m2      = 0.0f;
+            fS1             = 0.0f;
+            fS2             = 0.0f;
+            bUpdate         = true;
+        }
+
+        void SVFilter::set_type(svf_type_t type)
+        {
+            if (enType == type)
+                return;
+            enType          = type;
+            bUpdate         = true;
+        }
+
+        void SVFilter::set_sample_rate(size_t sr)
+        {
+            if (nSampleRate == sr)
+                return;
+            nSampleRate     = sr;
+            bUpdate         = true;
+        }
+
+        void SVFilter::set_frequency(float f)
+        {
+            if (fFrequency == f)
+                return;
+            fFrequency      = f;
+            bUpdate         = true;
+        }
+
+        void SVFilter::set_quality(float q)
+        {
+            q               = lsp_max(q, 1e-3f);
+            if (fQuality == q)
+                return;
+            fQuality        = q;
+            bUpdate         = true;
+        }
+
+        void SVFilter::set_gain(float gain)
+        {
+            gain            = lsp_max(gain, 1e-6f);
+            if (fGain == gain)
+                return;
+            fGain           = gain;
+            bUpdate         = true;
+        }
+
+        void SVFilter::update_settings()
+        {
+            if (!bUpdate)
+                return;
+            bUpdate         = false;
+
+            // Mixing weights of the input, band-pass and low-pass outputs
+            coeffs_t *c     = &sCoeffs;
+            float a         = sqrtf(fGain);
+            fK              = 1.0f / fQuality;
+            fGScale         = 1.0f;
+
+            switch (enType)
+            {
+                case SVF_LOPASS:    c->m0 = 0.0f;   c->m1 = 0.0f;               c->m2 = 1.0f;   break;
+                case SVF_HIPASS:    c->m0 = 1.0f;   c->m1 = -fK;                c->m2 = -1.0f;  break;
+                case SVF_BANDPASS:  c->m0 = 0.0f;   c->m1 = fK;                 c->m2 = 0.0f;   break;
+                case SVF_NOTCH:     c->m0 = 1.0f;   c->m1 = -fK;                c->m2 = 0.0f;   break;
+                case SVF_PEAK:      c->m0 = 1.0f;   c->m1 = -fK;                c->m2 = -2.0f;  break;
+                case SVF_ALLPASS:   c->m0 = 1.0f;   c->m1 = -2.0f * fK;         c->m2 = 0.0f;   break;
+                case SVF_BELL:
+                    fK             /= a;
+                    c->m0           = 1.0f;
+                    c->m1           = fK * (fGain - 1.0f);
+                    c->m2           = 0.0f;
+                    break;
+                case SVF_LOSHELF:
+                    fGScale         = 1.0f / sqrtf(a);
+                    c->m0           = 1.0f;
+                    c->m1           = fK * (a - 1.0f);
+                    c->m2           = fGain - 1.0f;
+                    break;
+                case SVF_HISHELF:
+                    fGScale         = sqrtf(a);
+                    c->m0           = fGain;
+                    c->m1           = fK * (1.0f - a) * a;
+                    c->m2           = 1.0f - fGain;
+                    break;
+                case SVF_NONE:
+                default:
+                    c->m0           = 1.0f;
+                    c->m1           = 0.0f;
+                    c->m2           = 0.0f;
+                    break;
+            }
+
+            // Integrator gain from the pre-warped frequency
+            float f         = lsp_limit(fFrequency, SVF_FREQ_MIN, SVF_FREQ_MAX * nSampleRate);
+            float g         = tanf(M_PI * f / nSampleRate) * fGScale;
+            c->a1           = 1.0f / (1.0f + g * (g + fK));
+            c->a2           = g * c->a1;
+            c->a3           = g * c->a2;
+        }
+
+        void SVFilter::clear()
+        {
+            fS1             = 0.0f;
+            fS2             = 0.0f;
+        }
+
+        void SVFilter::process(float *dst, const float *src, size_t count)
+        {
+            if (bUpdate)
+                update_settings();
+            if (enType == SVF_NONE)
+            {
+                dsp::copy(dst, src, count);
+                return;
+            }
+
+            const coeffs_t c    = sCoeffs;
+            float s1            = fS1;
+            float s2            = fS2;
+
+            for (size_t i=0; i<count; ++i)
+            {
+                float x             = src[i];
+                float v3            = x - s2;
+                float v1            = c.a1 * s1 + c.a2 * v3;
+                float v2            = s2 + c.a2 * s1 + c.a3 * v3;
+                s1                  = 2.0f * v1 - s1;
+                s2                  = 2.0f * v2 - s2;
+                dst[i]              = c.m0 * x + c.m1 * v1 + c.m2 * v2;
+            }
+
+            fS1                 = s1;
+            fS2                 = s2;
+        }
+
+        void SVFilter::process(float *dst, const float *src, const float *freq, size_t count)
+        {
+            if (bUpdate)
+                update_settings();
+            if (enType == SVF_NONE)
+            {
+                dsp::copy(dst, src, count);
+                return;
+            }
+
+            // The mixing weights do not depend on the frequency, only the integrator gain is updated
+            const coeffs_t c    = sCoeffs;
+            float kf            = M_PI / nSampleRate;
+            float fmax          = SVF_FREQ_MAX * nSampleRate;
+            float s1            = fS1;
+            float s2            = fS2;
+
+            for (size_t i=0; i<count; ++i)
+            {
+                float f             = lsp_limit(freq[i], SVF_FREQ_MIN, fmax);
+                float g             = tanf(kf * f) * fGScale;
+                float a1            = 1.0f / (1.0f + g * (g + fK));
+                float a2            = g * a1;
+                float a3            = g * a2;
+
+                float x             = src[i];
+                float v3            = x - s2;
+                float v1            = a1 * s1 + a2 * v3;
+                float v2            = s2 + a2 * s1 + a3 * v3;
+                s1                  = 2.0f * v1 - s1;
+                s2                  = 2.0f * v2 - s2;
+                dst[i]              = c.m0 * x + c.m1 * v1 + c.m2 * v2;
+            }
+
+            fS1                 = s1;
+            fS2                 = s2;
+        }
+
+        void SVFilter::dump(IStateDumper *v) const
+        {
+            v->write("enType", enType);
+            v->write("nSampleRate", nSampleRate);
+            v->write("fFrequency", fFrequency);
+            v->write("fQuality", fQuality);
+            v->write("fGain", fGain);
+            v->write("fK", fK);
+            v->write("fGScale", fGScale);
+            v->begin_object("sCoeffs", &sCoeffs, sizeof(coeffs_t));
+            {
+                v->write("a1", sCoeffs.a1);
+                v->write("a2", sCoeffs.a2);
+                v->write("a3", sCoeffs.a3);
+                v->write("m0", sCoeffs.m0);
+                v->write("m1", sCoeffs.m1);
+                v->write("m2", sCoeffs.m2);
+            }
+            v->end_object();
+            v->write("fS1", fS1);
+            v->write("fS2", fS2);
+            v->write("bUpdate", bUpdate);
+        }
+    } /* namespace dspu */
+} /* namespace lsp */
@@ -26,7 +26,6 @@
 #include <lsp-plug.in/stdlib/math.h>
 #include <lsp-plug.in/dsp/common/filters/transform.h>
 
-#define MAX_ORDER               100u
 #define DFL_LOWER_FREQUENCY     0.1f
 #define DFL_UPPER_FREQUENCY     20.0e3f
 #define BUF_LIM_SIZE            256u
@@ -63,7 +62,7 @@ namespace lsp
 
             bSync           = true;
 
-            sFilter.init(MAX_ORDER);
+            sFilter.init(STLT_MAX_ORDER);
         }
 
         // Compute the coefficient for the bilinear transform warping equation.
@@ -134,7 +133,7 @@ namespace lsp
 
             // We force even order (so all biquads have all coefficients, maximal efficiency).
             nOrder = (nOrder % 2 == 0) ? nOrder : nOrder + 1;
-            nOrder = lsp_min(nOrder, MAX_ORDER);
+            nOrder = lsp_min(nOrder, STLT_MAX_ORDER);
 
             // Convert provided slope value to Neper-per-Neper.
             switch (enSlopeUnit)
@@ -22,6 +22,12 @@
 #include <lsp-plug.in/dsp-units/misc/envelope.h>
 #include <lsp-plug.in/dsp-units/const.h>
 #include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/ipc/Mutex.h>
+#include <lsp-plug.in/lltl/parray.h>
+
+#define ENVELOPE_BLOCK_SIZE     0x100
 
 namespace lsp
 {
@@ -34,10 +40,23 @@ namespace lsp
                 if (n == 0)
                     return;
 
-                dst[0]      = 1.0f;
+                // The power law (i * kd)^k is computed as exp(k * ln(i * kd)) by blocks
+                float buf[ENVELOPE_BLOCK_SIZE];
                 float kd    = (LSP_DSP_UNITS_SPEC_FREQ_MAX / LSP_DSP_UNITS_SPEC_FREQ_MIN) / n;
-                for (size_t i=1; i < n; ++i)
-                    dst[i]      = expf(k * logf(i * kd));
+
+                dst[0]      = 1.0f;
+                for (size_t i=1; i < n; )
+                {
+                    size_t to_do    = lsp_min(n - i, size_t(ENVELOPE_BLOCK_SIZE));
+                    for (size_t j=0; j<to_do; ++j)
+                        buf[j]          = (i + j) * kd;
+
+                    dsp::loge1(buf, to_do);
+                    dsp::mul_k2(buf, k, to_do);
+                    dsp::exp2(&dst[i], buf, to_do);
+
+                    i              += to_do;
+                }
             }
 
             void noise(float *dst, size_t n, envelope_t type)
@@ -74,8 +93,138 @@ namespace lsp
 
             void white_noise(float *dst, size_t n)
             {
-                while (n--)
-                    *(dst++)        = 1.0f;
+                dsp::fill_one(dst, n);
+            }
+
+            typedef struct table_t
+            {
+                envelope_t      enType;         // Envelope type
+                size_t          nSize;          // Number of samples
+                bool            bReverse;       // Reverse envelope
+                ssize_t         nRefs;          // Number of references, protected by the cache lock
+                float          *vTable;         // Envelope samples
+                uint8_t        *pData;          // Allocated data
+            } table_t;
+
+            /**
+             * Process-wide cache of envelope tables
+             */
+            class TableCache
+            {
+                private:
+                    TableCache & operator = (const TableCache &);
+                    TableCache(const TableCache &);
+
+                public:
+                    ipc::Mutex                  sLock;
+                    lltl::parray<table_t>       vItems;
+
+                public:
+                    explicit TableCache() {}
+                    ~TableCache()
+                    {
+                        for (size_t i=0, n=vItems.size(); i<n; ++i)
+                            destroy(vItems.uget(i));
+                        vItems.flush();
+                    }
+
+                public:
+                    static void destroy(table_t *t)
+                    {
+                        if (t == NULL)
+                            return;
+                        free_aligned(t->pData);
+                        delete t;
+                    }
+
+                    table_t *find(envelope_t type, size_t n, bool reverse)
+                    {
+                        for (size_t i=0, count=vItems.size(); i<count; ++i)
+                        {
+                            table_t *t = vItems.uget(i);
+                            if ((t->enType == type) && (t->nSize == n) && (t->bReverse == reverse))
+                            {
+                                ++t->nRefs;
+                                return t;
+                            }
+                        }
+                        return NULL;
+                    }
+            };
+
+            static TableCache table_cache;
+
+            const float *acquire(envelope_t type, size_t n, bool reverse)
+            {
+                // Lookup for existing table
+                table_cache.sLock.lock();
+                table_t *res    = table_cache.find(type, n, reverse);
+                table_cache.sLock.unlock();
+                if (res != NULL)
+                    return res->vTable;
+
+                // Compute the new table without holding the lock
+                res             = new table_t;
+                if (res == NULL)
+                    return NULL;
+                res->vTable     = alloc_aligned<float>(res->pData, lsp_max(n, size_t(1)));
+                if (res->vTable == NULL)
+                {
+                    delete res;
+                    return NULL;
+                }
+                res->enType     = type;
+                res->nSize      = n;
+                res->bReverse   = reverse;
+                res->nRefs      = 1;
+                if (reverse)
+                    reverse_noise(res->vTable, n, type);
+                else
+                    noise(res->vTable, n, type);
+
+                table_cache.sLock.lock();
+                // The same table could be added by another thread at this moment
+                table_t *t      = table_cache.find(type, n, reverse);
+                if (t != NULL)
+                {
+                    table_cache.sLock.unlock();
+                    TableCache::destroy(res);
+                    return t->vTable;
+                }
+
+                if (!table_cache.vItems.add(res))
+                {
+                    table_cache.sLock.unlock();
+                    TableCache::destroy(res);
+                    return NULL;
+                }
+                table_cache.sLock.unlock();
+
+                return res->vTable;
+            }
+
+            void release(const float *table)
+            {
+                if (table == NULL)
+                    return;
+
+                table_t *t      = NULL;
+                table_cache.sLock.lock();
+                for (size_t i=0, n=table_cache.vItems.size(); i<n; ++i)
+                {
+                    table_t *item   = table_cache.vItems.uget(i);
+                    if (item->vTable != table)
+                        continue;
+                    if ((--item->nRefs) <= 0)
+                    {
+                        table_cache.vItems.remove(i);
+                        t               = item;
+                    }
+                    break;
+                }
+                table_cache.sLock.unlock();
+
+                TableCache::destroy(t);
             }
 
             void pink_noise(float *dst, size_t n)
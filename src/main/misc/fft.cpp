@@ -0,0 +1,293 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/dsp-units/misc/fft.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/ipc/Mutex.h>
+#include <lsp-plug.in/lltl/parray.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        namespace fft
+        {
+            typedef struct table_t
+            {
+                size_t          nRank;          // Maximum rank of transforms
+                ssize_t         nRefs;          // Number of references, protected by the cache lock
+                float          *vTable;         // Twiddle factors W^k for k = 0..N/2, packed complex
+                uint8_t        *pData;          // Allocated data
+            } table_t;
+
+            /**
+             * Process-wide cache of twiddle tables
+             */
+            class TableCache
+            {
+                private:
+                    TableCache & operator = (const TableCache &);
+                    TableCache(const TableCache &);
+
+                public:
+                    ipc::Mutex                  sLock;
+                    lltl::parray<table_t>       vItems;
+
+                public:
+                    explicit TableCache() {}
+                    ~TableCache()
+                    {
+                        for (size_t i=0, n=vItems.size(); i<n; ++i)
+                            destroy(vItems.uget(i));
+                        vItems.flush();
+                    }
+
+                public:
+                    static void destroy(table_t *t)
+                    {
+                        if (t == NULL)
+                            return;
+                        free_aligned(t->pData);
+                        delete t;
+                    }
+
+                    table_t *find(size_t rank)
+                    {
+                        for (size_t i=0, count=vItems.size(); i<count; ++i)
+                        {
+                            table_t *t = vItems.uget(i);
+                            if (t->nRank == rank)
+                            {
+                                ++t->nRefs;
+                                return t;
+                            }
+                        }
+                        return NULL;
+                    }
+            };
+
+            static TableCache table_cache;
+
+            static table_t *create_table(size_t rank)
+            {
+                size_t n        = 1 << rank;
+
+                table_t *res    = new table_t;
+                if (res == NULL)
+                    return NULL;
+
+                // The temporary buffer for the full transform follows the table
+                res->vTable     = alloc_aligned<float>(res->pData, n * 3 + 2);
+                if (res->vTable == NULL)
+                {
+                    delete res;
+                    return NULL;
+                }
+                res->nRank      = rank;
+                res->nRefs      = 1;
+
+                // The twiddle factors are the transform of the unit impulse delayed by one
+                // sample, so they always match the convention of packed_direct_fft()
+                float *tmp      = &res->vTable[n + 2];
+                dsp::fill_zero(tmp, n * 2);
+                tmp[2]          = 1.0f;
+                dsp::packed_direct_fft(tmp, tmp, rank);
+                dsp::copy(res->vTable, tmp, n + 2);
+
+                return res;
+            }
+
+            const float *acquire(size_t rank)
+            {
+                if (rank < 2)
+                    return NULL;
+
+                // Lookup for existing table
+                table_cache.sLock.lock();
+                table_t *res    = table_cache.find(rank);
+                table_cache.sLock.unlock();
+                if (res != NULL)
+                    return res->vTable;
+
+                // Compute the new table without holding the lock
+                if ((res = create_table(rank)) == NULL)
+                    return NULL;
+
+                table_cache.sLock.lock();
+                // The same table could be added by another thread at this moment
+                table_t *t      = table_cache.find(rank);
+                if (t != NULL)
+                {
+                    table_cache.sLock.unlock();
+                    TableCache::destroy(res);
+                    return t->vTable;
+                }
+
+                if (!table_cache.vItems.add(res))
+                {
+                    table_cache.sLock.unlock();
+                    TableCache::destroy(res);
+                    return NULL;
+                }
+                table_cache.sLock.unlock();
+
+                return res->vTable;
+            }
+
+            void release(const float *table)
+            {
+                if (table == NULL)
+                    return;
+
+                table_t *t      = NULL;
+                table_cache.sLock.lock();
+                for (size_t i=0, n=table_cache.vItems.size(); i<n; ++i)
+                {
+                    table_t *item   = table_cache.vItems.uget(i);
+                    if (item->vTable != table)
+                        continue;
+                    if ((--item->nRefs) <= 0)
+                    {
+                        table_cache.vItems.remove(i);
+                        t               = item;
+                    }
+                    break;
+                }
+                table_cache.sLock.unlock();
+
+                TableCache::destroy(t);
+            }
+
+            void real_direct(float *dst, const float *src, size_t rank, const float *table, size_t table_rank)
+            {
+                size_t n        = 1 << rank;
+                size_t m        = n >> 1;
+                size_t stride   = size_t(1) << (table_rank - rank);
+
+                // Even samples form the real part and odd samples form the imaginary part
+                // of the packed complex signal of half size
+                dsp::packed_direct_fft(dst, src, rank - 1);
+
+                // Split Z[k] into spectra of even and odd samples E[k] and O[k]:
+                // X[k] = E[k] + W^k * O[k], X[M-k] = conj(E[k]) + W^(M-k) * conj(O[k])
+                float a         = dst[0];
+                float b         = dst[1];
+                dst[0]          = a + b;
+                dst[1]          = 0.0f;
+                dst[n]          = a - b;
+                dst[n+1]        = 0.0f;
+
+                for (size_t k=1, j=m-1; k<=j; ++k, --j)
+                {
+                    float *zk       = &dst[k*2];
+                    float *zj       = &dst[j*2];
+                    const float *wk = &table[k*stride*2];
+                    const float *wj = &table[j*stride*2];
+
+                    float er        = 0.5f * (zk[0] + zj[0]);
+                    float ei        = 0.5f * (zk[1] - zj[1]);
+                    float o_r       = 0.5f * (zk[1] + zj[1]);
+                    float o_i       = 0.5f * (zj[0] - zk[0]);
+
+                    zk[0]           = er + wk[0] * o_r - wk[1] * o_i;
+                    zk[1]           = ei + wk[0] * o_i + wk[1] * o_r;
+                    if (j != k)
+                    {
+                        zj[0]           = er + wj[0] * o_r + wj[1] * o_i;
+                        zj[1]           = wj[1] * o_r - wj[0] * o_i - ei;
+                    }
+                }
+            }
+
+            void real_reverse(float *dst, const float *src, size_t rank, const float *table, size_t table_rank)
+            {
+                size_t n        = 1 << rank;
+                size_t m        = n >> 1;
+                size_t stride   = size_t(1) << (table_rank - rank);
+
+                // Restore Z[k] = E[k] + i*O[k] from E[k] = (X[k] + conj(X[M-k]))/2
+                // and O[k] = (X[k] - conj(X[M-k])) * conj(W^k)/2
+                float er        = 0.5f * (src[0] + src[n]);
+                float ei        = 0.5f * (src[1] - src[n+1]);
+                float o_r       = 0.5f * (src[0] - src[n]);
+                float o_i       = 0.5f * (src[1] + src[n+1]);
+                dst[0]          = er - o_i;
+                dst[1]          = ei + o_r;
+
+                for (size_t k=1, j=m-1; k<=j; ++k, --j)
+                {
+                    const float *xk = &src[k*2];
+                    const float *xj = &src[j*2];
+                    const float *w  = &table[k*stride*2];
+
+                    er              = 0.5f * (xk[0] + xj[0]);
+                    ei              = 0.5f * (xk[1] - xj[1]);
+                    float dr        = 0.5f * (xk[0] - xj[0]);
+                    float di        = 0.5f * (xk[1] + xj[1]);
+                    o_r             = dr * w[0] + di * w[1];
+                    o_i             = di * w[0] - dr * w[1];
+
+                    float *zk       = &dst[k*2];
+                    float *zj       = &dst[j*2];
+                    zk[0]           = er - o_i;
+                    zk[1]           = ei + o_r;
+                    if (j != k)
+                    {
+                        zj[0]           = er + o_i;
+                        zj[1]           = o_r - ei;
+                    }
+                }
+
+                // The reverse transform gives even and odd samples as the packed complex signal
+                dsp::packed_reverse_fft(dst, dst, rank - 1);
+            }
+
+            void real_expand(float *buf, size_t rank)
+            {
+                size_t n        = 1 << rank;
+                for (size_t k=(n >> 1) + 1; k<n; ++k)
+                {
+                    const float *s  = &buf[(n - k)*2];
+                    buf[k*2]        = s[0];
+                    buf[k*2+1]      = -s[1];
+                }
+            }
+
+            void real_fold(float *buf, size_t rank)
+            {
+                size_t n        = 1 << rank;
+                size_t m        = n >> 1;
+
+                buf[1]          = 0.0f;
+                buf[m*2+1]      = 0.0f;
+                for (size_t k=1; k<m; ++k)
+                {
+                    float *x        = &buf[k*2];
+                    const float *s  = &buf[(n - k)*2];
+                    x[0]            = 0.5f * (x[0] + s[0]);
+                    x[1]            = 0.5f * (x[1] - s[1]);
+                }
+            }
+        } /* namespace fft */
+    } /* namespace dspu */
+} /* namespace lsp */
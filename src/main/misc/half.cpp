@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/dsp-units/misc/half.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        namespace half
+        {
+            typedef union fbits_t
+            {
+                float       f;
+                uint32_t    i;
+            } fbits_t;
+
+            static inline uint16_t round_shift(uint32_t value, uint32_t shift)
+            {
+                uint32_t res    = value >> shift;
+                uint32_t rem    = value & ((uint32_t(1) << shift) - 1);
+                uint32_t half   = uint32_t(1) << (shift - 1);
+                if ((rem > half) || ((rem == half) && (res & 1)))
+                    ++res;
+                return uint16_t(res);
+            }
+
+            static inline uint16_t fp16(float value)
+            {
+                fbits_t v;
+                v.f             = value;
+
+                uint16_t sign   = uint16_t(v.i >> 16) & 0x8000;
+                uint32_t fexp   = (v.i >> 23) & 0xff;
+                uint32_t man    = v.i & 0x7fffff;
+                int32_t exp     = int32_t(fexp) - 127 + 15;
+
+                if (fexp == 0xff)                           // Infinity and NaN
+                    return sign | 0x7c00 | ((man) ? 0x200 : 0);
+                if (exp >= 0x1f)                            // Saturate
+                    return sign | 0x7bff;
+                if (exp <= 0)                               // Denormalized value
+                    return (exp < -10) ? sign : sign | round_shift(man | 0x800000, 14 - exp);
+
+                uint16_t res    = round_shift((uint32_t(exp) << 23) | man, 13);
+                return sign | ((res >= 0x7c00) ? 0x7bff : res);
+            }
+
+            static inline float fp16(uint16_t value)
+            {
+                fbits_t v;
+                uint32_t sign   = uint32_t(value & 0x8000) << 16;
+                uint32_t exp    = (value >> 10) & 0x1f;
+                uint32_t man    = value & 0x3ff;
+
+                if (exp == 0)                               // Denormalized value
+                {
+                    v.f             = man * 5.9604644775390625e-8f; // 2^-24
+                    v.i            |= sign;
+                }
+                else if (exp == 0x1f)                       // Infinity and NaN
+                    v.i             = sign | 0x7f800000 | (man << 13);
+                else
+                    v.i             = sign | ((exp + 127 - 15) << 23) | (man << 13);
+
+                return v.f;
+            }
+
+            static inline uint16_t bf16(float value)
+            {
+                fbits_t v;
+                v.f             = value;
+
+                if ((v.i & 0x7fffffff) > 0x7f800000)        // NaN should remain NaN
+                    return uint16_t(v.i >> 16) | 0x40;
+                return uint16_t((v.i + 0x7fff + ((v.i >> 16) & 1)) >> 16);
+            }
+
+            void encode_fp16(uint16_t *dst, const float *src, size_t count)
+            {
+                for (size_t i=0; i<count; ++i)
+                    dst[i]      = fp16(src[i]);
+            }
+
+            void decode_fp16(float *dst, const uint16_t *src, size_t count)
+            {
+                for (size_t i=0; i<count; ++i)
+                    dst[i]      = fp16(src[i]);
+            }
+
+            void encode_bf16(uint16_t *dst, const float *src, size_t count)
+            {
+                for (size_t i=0; i<count; ++i)
+                    dst[i]      = bf16(src[i]);
+            }
+
+            void decode_bf16(float *dst, const uint16_t *src, size_t count)
+            {
+                fbits_t v;
+                for (size_t i=0; i<count; ++i)
+                {
+                    v.i         = uint32_t(src[i]) << 16;
+                    dst[i]      = v.f;
+                }
+            }
+
+            void encode(uint16_t *dst, const float *src, size_t count, format_t format)
+            {
+                if (format == BFLOAT16)
+                    encode_bf16(dst, src, count);
+                else
+                    encode_fp16(dst, src, count);
+            }
+
+            void decode(float *dst, const uint16_t *src, size_t count, format_t format)
+            {
+                if (format == BFLOAT16)
+                    decode_bf16(dst, src, count);
+                else
+                    decode_fp16(dst, src, count);
+            }
+        }
+    }
+}
@@ -20,8 +20,11 @@
  */
 
 #include <lsp-plug.in/dsp-units/misc/interpolation.h>
+#include <lsp-plug.in/dsp/dsp.h>
 #include <lsp-plug.in/stdlib/math.h>
 
+#define BATCH_SIZE          0x100
+
 namespace lsp
 {
     namespace dspu
@@ -70,6 +73,75 @@ namespace lsp
                 p[0]            = (y1 - y0) / (x1 - x0);
                 p[1]            = y0 - p[0]*x0;
             }
+
+            void apply_linear(float *dst, const float *src, const float *p, size_t count)
+            {
+                const float p0 = p[0], p1 = p[1];
+                for (size_t i=0; i<count; ++i)
+                    dst[i]          = p0*src[i] + p1;
+            }
+
+            void apply_quadratic(float *dst, const float *src, const float *p, size_t count)
+            {
+                const float p0 = p[0], p1 = p[1], p2 = p[2];
+                for (size_t i=0; i<count; ++i)
+                {
+                    float x         = src[i];
+                    dst[i]          = (p0*x + p1)*x + p2;
+                }
+            }
+
+            void apply_cubic(float *dst, const float *src, const float *p, size_t count)
+            {
+                const float p0 = p[0], p1 = p[1], p2 = p[2], p3 = p[3];
+                for (size_t i=0; i<count; ++i)
+                {
+                    float x         = src[i];
+                    dst[i]          = ((p0*x + p1)*x + p2)*x + p3;
+                }
+            }
+
+            void apply_exponent(float *dst, const float *src, const float *p, size_t count)
+            {
+                dsp::mul_k3(dst, src, p[2], count);
+                dsp::exp1(dst, count);
+                dsp::mul_k2(dst, p[1], count);
+                dsp::add_k2(dst, p[0], count);
+            }
+
+            void apply_knee(float *dst, const float *src, float x0, float x1,
+                const float *l0, const float *p, const float *l1, size_t count)
+            {
+                // All three formulas are computed and the result is selected without branches
+                const float a0 = l0[0], b0 = l0[1];
+                const float a1 = l1[0], b1 = l1[1];
+                const float p0 = p[0], p1 = p[1], p2 = p[2], p3 = p[3];
+
+                for (size_t i=0; i<count; ++i)
+                {
+                    float x         = src[i];
+                    float y0        = a0*x + b0;
+                    float y1        = a1*x + b1;
+                    float yk        = ((p0*x + p1)*x + p2)*x + p3;
+                    dst[i]          = (x <= x0) ? y0 : (x >= x1) ? y1 : yk;
+                }
+            }
+
+            void apply_log_knee(float *dst, const float *src, float x0, float x1,
+                const float *l0, const float *p, const float *l1, size_t count)
+            {
+                float buf[BATCH_SIZE];
+
+                for (size_t offset=0; offset < count; )
+                {
+                    size_t to_do    = lsp_min(count - offset, size_t(BATCH_SIZE));
+                    dsp::abs2(buf, &src[offset], to_do);
+                    dsp::loge1(buf, to_do);
+                    apply_knee(buf, buf, x0, x1, l0, p, l1, to_do);
+                    dsp::exp2(&dst[offset], buf, to_do);
+                    offset         += to_do;
+                }
+            }
         }
     }
 }
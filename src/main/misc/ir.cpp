@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/dsp-units/misc/ir.h>
+#include <lsp-plug.in/dsp-units/misc/fade.h>
+#include <lsp-plug.in/dsp-units/units.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/bits.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define IR_MIN_PHASE_RANK_MIN       8
+#define IR_MIN_PHASE_OVERSAMPLE     3       /* FFT size is 2^3 times larger than the impulse response */
+#define IR_MIN_PHASE_FLOOR          1e-10f  /* magnitude floor relative to the peak (-200 dB) */
+
+namespace lsp
+{
+    namespace dspu
+    {
+        namespace ir
+        {
+            size_t noise_floor_length(const float *ir, size_t count, size_t window, float margin)
+            {
+                if ((count <= 0) || (window <= 0))
+                    return count;
+
+                // Estimate the noise floor
+                size_t blocks   = (count + window - 1) / window;
+                size_t tail     = lsp_max(blocks / 10, size_t(1)) * window;
+                tail            = lsp_min(tail, count);
+                float noise     = dsp::h_sqr_sum(&ir[count - tail], tail) / tail;
+                float thresh    = noise * db_to_power(margin);
+
+                // Find the last window above the noise floor
+                for (size_t i=blocks; i > 0; )
+                {
+                    size_t off      = (--i) * window;
+                    size_t n        = lsp_min(window, count - off);
+                    if (dsp::h_sqr_sum(&ir[off], n) > thresh * n)
+                        return off + n;
+                }
+
+                // The whole impulse response is the noise
+                return count;
+            }
+
+            size_t trim(float *ir, size_t count, size_t window, float margin)
+            {
+                size_t length   = noise_floor_length(ir, count, window, margin);
+                if (length < count)
+                    fade_out(ir, ir, lsp_min(window, length), length);
+
+                return length;
+            }
+
+            bool minimum_phase(float *dst, const float *src, size_t count)
+            {
+                if (count <= 0)
+                    return true;
+
+                size_t rank     = lsp_max(size_t(int_log2(count) + IR_MIN_PHASE_OVERSAMPLE), size_t(IR_MIN_PHASE_RANK_MIN));
+                size_t len      = size_t(1) << rank;
+                size_t half     = len >> 1;
+
+                uint8_t *data   = NULL;
+                float *buf      = alloc_aligned<float>(data, len * 2);
+                if (buf == NULL)
+                    return false;
+
+                // Compute the spectrum of the impulse response
+                dsp::pcomplex_fill_ri(buf, 0.0f, 0.0f, len);
+                dsp::pcomplex_r2c(buf, src, count);
+                dsp::packed_direct_fft(buf, buf, rank);
+
+                // Compute the logarithm of magnitude
+                float peak      = 0.0f;
+                for (size_t i=0; i<len; ++i)
+                {
+                    float *c        = &buf[i*2];
+                    c[0]            = sqrtf(c[0]*c[0] + c[1]*c[1]);
+                    c[1]            = 0.0f;
+                    peak            = lsp_max(peak, c[0]);
+                }
+                float floor     = lsp_max(peak * IR_MIN_PHASE_FLOOR, 1e-30f);
+                for (size_t i=0; i<len; ++i)
+                    buf[i*2]        = logf(lsp_max(buf[i*2], floor));
+
+                // Compute the real cepstrum and fold it to make it causal
+                dsp::packed_reverse_fft(buf, buf, rank);
+                for (size_t i=1; i<half; ++i)
+                {
+                    buf[i*2]       *= 2.0f;
+                    buf[i*2 + 1]    = 0.0f;
+                }
+                buf[1]          = 0.0f;
+                buf[half*2 + 1] = 0.0f;
+                dsp::fill_zero(&buf[(half + 1) * 2], (half - 1) * 2);
+
+                // Compute the exponent of the spectrum and get the impulse response
+                dsp::packed_direct_fft(buf, buf, rank);
+                for (size_t i=0; i<len; ++i)
+                {
+                    float *c        = &buf[i*2];
+                    float mag       = expf(c[0]);
+                    float arg       = c[1];
+                    c[0]            = mag * cosf(arg);
+                    c[1]            = mag * sinf(arg);
+                }
+                dsp::packed_reverse_fft(buf, buf, rank);
+                dsp::pcomplex_c2r(dst, buf, count);
+
+                free_aligned(data);
+                return true;
+            }
+        }
+    }
+}
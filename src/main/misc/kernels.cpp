@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <lsp-plug.in/dsp-units/misc/kernels.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        namespace kernels
+        {
+        #ifdef ARCH_X86
+            namespace x86
+            {
+                const char     *init();
+            } /* namespace x86 */
+        #endif /* ARCH_X86 */
+
+        #ifdef ARCH_AARCH64
+            namespace aarch64
+            {
+                const char     *init();
+            } /* namespace aarch64 */
+        #endif /* ARCH_AARCH64 */
+
+            words_to_float_t    words_to_float  = generic::words_to_float;
+            lcg_words_t         lcg_words       = generic::lcg_words;
+
+            static const char  *isa_name        = "generic";
+
+            void init_generic()
+            {
+                words_to_float  = generic::words_to_float;
+                lcg_words       = generic::lcg_words;
+                isa_name        = "generic";
+            }
+
+            void init()
+            {
+                // Architecture-specific code overrides only the kernels it implements
+                init_generic();
+
+            #ifdef ARCH_X86
+                isa_name        = x86::init();
+            #endif /* ARCH_X86 */
+
+            #ifdef ARCH_AARCH64
+                isa_name        = aarch64::init();
+            #endif /* ARCH_AARCH64 */
+            }
+
+            const char *isa()
+            {
+                return isa_name;
+            }
+        } /* namespace kernels */
+    } /* namespace dspu */
+} /* namespace lsp */
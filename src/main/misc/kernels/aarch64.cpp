@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <lsp-plug.in/dsp-units/misc/kernels.h>
+
+#ifdef ARCH_AARCH64
+
+#include <arm_neon.h>
+
+#define WORD_RANGE          2.32830643654e-10f /* 1 / (1 << 32) */
+
+namespace lsp
+{
+    namespace dspu
+    {
+        namespace kernels
+        {
+            namespace aarch64
+            {
+                static void neon_words_to_float(float *dst, const uint32_t *src, size_t count)
+                {
+                    const uint32x4_t mask   = vdupq_n_u32(0xffff);
+                    const float32x4_t khi   = vdupq_n_f32(65536.0f);
+                    const float32x4_t k     = vdupq_n_f32(WORD_RANGE);
+
+                    size_t i = 0;
+                    for ( ; (i + 4) <= count; i += 4)
+                    {
+                        uint32x4_t x        = vld1q_u32(&src[i]);
+                        float32x4_t hi      = vcvtq_f32_u32(vshrq_n_u32(x, 16));
+                        float32x4_t lo      = vcvtq_f32_u32(vandq_u32(x, mask));
+                        vst1q_f32(&dst[i], vmulq_f32(vaddq_f32(vmulq_f32(hi, khi), lo), k));
+                    }
+
+                    generic::words_to_float(&dst[i], &src[i], count - i);
+                }
+
+                static void neon_lcg_words(uint32_t *dst, uint32_t *state, const uint32_t *mul1,
+                    const uint32_t *mul2, const uint32_t *add, size_t count)
+                {
+                    uint32x4_t s        = vld1q_u32(state);
+                    uint32x4_t m1       = vld1q_u32(mul1);
+                    uint32x4_t m2       = vld1q_u32(mul2);
+                    uint32x4_t a        = vld1q_u32(add);
+
+                    for ( ; count > 0; --count, dst += 4)
+                    {
+                        uint32x4_t h        = vshrq_n_u32(vmulq_u32(m2, s), 16);
+                        s                   = vaddq_u32(vaddq_u32(vmulq_u32(m1, s), h), a);
+                        vst1q_u32(dst, s);
+                    }
+
+                    vst1q_u32(state, s);
+                }
+
+                const char *init()
+                {
+                    // NEON is the part of the base instruction set of AArch64
+                    words_to_float      = neon_words_to_float;
+                    lcg_words           = neon_lcg_words;
+
+                    return "neon";
+                }
+            } /* namespace aarch64 */
+        } /* namespace kernels */
+    } /* namespace dspu */
+} /* namespace lsp */
+
+#endif /* ARCH_AARCH64 */
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <lsp-plug.in/dsp-units/misc/kernels.h>
+
+#define WORD_RANGE          2.32830643654e-10f /* 1 / (1 << 32) */
+
+namespace lsp
+{
+    namespace dspu
+    {
+        namespace kernels
+        {
+            namespace generic
+            {
+                void words_to_float(float *dst, const uint32_t *src, size_t count)
+                {
+                    // Both halves are converted exactly and the sum is rounded once
+                    for (size_t i=0; i<count; ++i)
+                    {
+                        uint32_t x      = src[i];
+                        dst[i]          = (float(int32_t(x >> 16)) * 65536.0f + float(int32_t(x & 0xffff))) * WORD_RANGE;
+                    }
+                }
+
+                void lcg_words(uint32_t *dst, uint32_t *state, const uint32_t *mul1,
+                    const uint32_t *mul2, const uint32_t *add, size_t count)
+                {
+                    uint32_t s0 = state[0], s1 = state[1], s2 = state[2], s3 = state[3];
+
+                    for ( ; count > 0; --count, dst += 4)
+                    {
+                        s0              = (mul1[0] * s0) + ((mul2[0] * s0) >> 16) + add[0];
+                        s1              = (mul1[1] * s1) + ((mul2[1] * s1) >> 16) + add[1];
+                        s2              = (mul1[2] * s2) + ((mul2[2] * s2) >> 16) + add[2];
+                        s3              = (mul1[3] * s3) + ((mul2[3] * s3) >> 16) + add[3];
+                        dst[0]          = s0;
+                        dst[1]          = s1;
+                        dst[2]          = s2;
+                        dst[3]          = s3;
+                    }
+
+                    state[0]        = s0;
+                    state[1]        = s1;
+                    state[2]        = s2;
+                    state[3]        = s3;
+                }
+            } /* namespace generic */
+        } /* namespace kernels */
+    } /* namespace dspu */
+} /* namespace lsp */
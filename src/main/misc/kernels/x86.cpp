@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <lsp-plug.in/dsp-units/misc/kernels.h>
+
+#ifdef ARCH_X86
+
+#include <immintrin.h>
+
+#define WORD_RANGE          2.32830643654e-10f /* 1 / (1 << 32) */
+
+/*
+ * The library is built for the base instruction set, so each function enables
+ * the instruction set it needs and is selected only if the CPU supports it
+ */
+#define KERNEL_TARGET(isa)  __attribute__((target(isa)))
+
+namespace lsp
+{
+    namespace dspu
+    {
+        namespace kernels
+        {
+            namespace x86
+            {
+                //-------------------------------------------------------------
+                // SSE2
+                KERNEL_TARGET("sse2")
+                static inline __m128i sse2_mullo(__m128i a, __m128i b)
+                {
+                    // SSE2 has no 32-bit multiplication with the low result, even and odd lanes
+                    // are multiplied separately by the 32x32->64 multiplication
+                    __m128i p02     = _mm_mul_epu32(a, b);
+                    __m128i p13     = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+                    return _mm_unpacklo_epi32(
+                        _mm_shuffle_epi32(p02, _MM_SHUFFLE(0, 0, 2, 0)),
+                        _mm_shuffle_epi32(p13, _MM_SHUFFLE(0, 0, 2, 0)));
+                }
+
+                KERNEL_TARGET("sse2")
+                static void sse2_words_to_float(float *dst, const uint32_t *src, size_t count)
+                {
+                    const __m128i mask  = _mm_set1_epi32(0xffff);
+                    const __m128 khi    = _mm_set1_ps(65536.0f);
+                    const __m128 k      = _mm_set1_ps(WORD_RANGE);
+
+                    size_t i = 0;
+                    for ( ; (i + 4) <= count; i += 4)
+                    {
+                        __m128i x       = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&src[i]));
+                        __m128 hi       = _mm_cvtepi32_ps(_mm_srli_epi32(x, 16));
+                        __m128 lo       = _mm_cvtepi32_ps(_mm_and_si128(x, mask));
+                        _mm_storeu_ps(&dst[i], _mm_mul_ps(_mm_add_ps(_mm_mul_ps(hi, khi), lo), k));
+                    }
+
+                    generic::words_to_float(&dst[i], &src[i], count - i);
+                }
+
+                KERNEL_TARGET("sse2")
+                static void sse2_lcg_words(uint32_t *dst, uint32_t *state, const uint32_t *mul1,
+                    const uint32_t *mul2, const uint32_t *add, size_t count)
+                {
+                    __m128i s       = _mm_loadu_si128(reinterpret_cast<const __m128i *>(state));
+                    __m128i m1      = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mul1));
+                    __m128i m2      = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mul2));
+                    __m128i a       = _mm_loadu_si128(reinterpret_cast<const __m128i *>(add));
+
+                    for ( ; count > 0; --count, dst += 4)
+                    {
+                        __m128i h       = _mm_srli_epi32(sse2_mullo(m2, s), 16);
+                        s               = _mm_add_epi32(_mm_add_epi32(sse2_mullo(m1, s), h), a);
+                        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), s);
+                    }
+
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(state), s);
+                }
+
+                //-------------------------------------------------------------
+                // SSE4.1
+                KERNEL_TARGET("sse4.1")
+                static void sse4_lcg_words(uint32_t *dst, uint32_t *state, const uint32_t *mul1,
+                    const uint32_t *mul2, const uint32_t *add, size_t count)
+                {
+                    __m128i s       = _mm_loadu_si128(reinterpret_cast<const __m128i *>(state));
+                    __m128i m1      = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mul1));
+                    __m128i m2      = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mul2));
+                    __m128i a       = _mm_loadu_si128(reinterpret_cast<const __m128i *>(add));
+
+                    for ( ; count > 0; --count, dst += 4)
+                    {
+                        __m128i h       = _mm_srli_epi32(_mm_mullo_epi32(m2, s), 16);
+                        s               = _mm_add_epi32(_mm_add_epi32(_mm_mullo_epi32(m1, s), h), a);
+                        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), s);
+                    }
+
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(state), s);
+                }
+
+                //-------------------------------------------------------------
+                // AVX2
+                KERNEL_TARGET("avx2")
+                static void avx2_words_to_float(float *dst, const uint32_t *src, size_t count)
+                {
+                    const __m256i mask  = _mm256_set1_epi32(0xffff);
+                    const __m256 khi    = _mm256_set1_ps(65536.0f);
+                    const __m256 k      = _mm256_set1_ps(WORD_RANGE);
+
+                    size_t i = 0;
+                    for ( ; (i + 8) <= count; i += 8)
+                    {
+                        __m256i x       = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&src[i]));
+                        __m256 hi       = _mm256_cvtepi32_ps(_mm256_srli_epi32(x, 16));
+                        __m256 lo       = _mm256_cvtepi32_ps(_mm256_and_si256(x, mask));
+                        _mm256_storeu_ps(&dst[i], _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(hi, khi), lo), k));
+                    }
+
+                    sse2_words_to_float(&dst[i], &src[i], count - i);
+                }
+
+                //-------------------------------------------------------------
+                // AVX-512
+                KERNEL_TARGET("avx512f")
+                static void avx512_words_to_float(float *dst, const uint32_t *src, size_t count)
+                {
+                    const __m512i mask  = _mm512_set1_epi32(0xffff);
+                    const __m512 khi    = _mm512_set1_ps(65536.0f);
+                    const __m512 k      = _mm512_set1_ps(WORD_RANGE);
+
+                    size_t i = 0;
+                    for ( ; (i + 16) <= count; i += 16)
+                    {
+                        __m512i x       = _mm512_loadu_si512(&src[i]);
+                        __m512 hi       = _mm512_cvtepi32_ps(_mm512_srli_epi32(x, 16));
+                        __m512 lo       = _mm512_cvtepi32_ps(_mm512_and_si512(x, mask));
+                        _mm512_storeu_ps(&dst[i], _mm512_mul_ps(_mm512_add_ps(_mm512_mul_ps(hi, khi), lo), k));
+                    }
+
+                    sse2_words_to_float(&dst[i], &src[i], count - i);
+                }
+
+                //-------------------------------------------------------------
+                // Dispatcher
+                const char *init()
+                {
+                    const char *isa     = "generic";
+
+                    __builtin_cpu_init();
+
+                    if (__builtin_cpu_supports("sse2"))
+                    {
+                        words_to_float      = sse2_words_to_float;
+                        lcg_words           = sse2_lcg_words;
+                        isa                 = "sse2";
+                    }
+                    if (__builtin_cpu_supports("sse4.1"))
+                    {
+                        lcg_words           = sse4_lcg_words;
+                        isa                 = "sse4.1";
+                    }
+                    if (__builtin_cpu_supports("avx2"))
+                    {
+                        words_to_float      = avx2_words_to_float;
+                        isa                 = "avx2";
+                    }
+                    if (__builtin_cpu_supports("avx512f"))
+                    {
+                        words_to_float      = avx512_words_to_float;
+                        isa                 = "avx512f";
+                    }
+
+                    return isa;
+                }
+            } /* namespace x86 */
+        } /* namespace kernels */
+    } /* namespace dspu */
+} /* namespace lsp */
+
+#endif /* ARCH_X86 */
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/dsp-units/misc/memory.h>
+#include <lsp-plug.in/dsp-units/misc/pages.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        namespace memory
+        {
+            void clear(memory_report_t *r)
+            {
+                r->nAllocated   = 0;
+                r->nUsed        = 0;
+                r->nPadding     = 0;
+                r->nBlocks      = 0;
+            }
+
+            void add(memory_report_t *r, size_t allocated, size_t used, size_t padding)
+            {
+                if (allocated <= 0)
+                    return;
+
+                padding         = lsp_min(padding, allocated);
+                r->nAllocated  += allocated;
+                r->nUsed       += lsp_min(used, allocated - padding);
+                r->nPadding    += padding;
+                ++r->nBlocks;
+            }
+
+            void add_pages(memory_report_t *r, const void *ptr, size_t used)
+            {
+                if (ptr == NULL)
+                    return;
+
+                size_t reserved = pages::reserved(ptr);
+                add(r, reserved, used, reserved - pages::size(ptr));
+            }
+
+            void add_aligned(memory_report_t *r, const void *ptr, size_t bytes, size_t used, size_t align)
+            {
+                // The alignment is achieved by over-allocating the block by the alignment size
+                if (ptr == NULL)
+                    return;
+                add(r, bytes + align, used, align);
+            }
+
+            void merge(memory_report_t *dst, const memory_report_t *src)
+            {
+                dst->nAllocated    += src->nAllocated;
+                dst->nUsed         += src->nUsed;
+                dst->nPadding      += src->nPadding;
+                dst->nBlocks       += src->nBlocks;
+            }
+        } /* namespace memory */
+    } /* namespace dspu */
+} /* namespace lsp */
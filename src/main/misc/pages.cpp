@@ -0,0 +1,279 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/dsp-units/misc/pages.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/ipc/Mutex.h>
+
+#include <stdlib.h>
+
+#ifdef PLATFORM_LINUX
+    #include <sys/mman.h>
+#endif
+
+#define HUGE_PAGE_SIZE          0x200000    /* Huge page size of x86_64 and aarch64 with 4 KiB base pages */
+
+namespace lsp
+{
+    namespace dspu
+    {
+        namespace pages
+        {
+            /**
+             * Header stored right before the aligned buffer
+             */
+            typedef struct header_t
+            {
+                void       *base;           // Base address of the allocation
+                size_t      size;           // Size of the allocation in bytes
+                size_t      bytes;          // Number of bytes requested by the caller
+                uint16_t    method;         // Allocation method
+                uint16_t    tracked;        // The allocation is accounted by the tracker
+            } header_t;
+
+            /**
+             * Process-wide allocation counter
+             */
+            class Tracker
+            {
+                public:
+                    ipc::Mutex      sLock;
+                    stats_t         sStats;
+                    volatile bool   bEnabled;
+
+                public:
+                    explicit Tracker()
+                    {
+                        bEnabled    = false;
+                        sStats.nBlocks      = 0;
+                        sStats.nBytes       = 0;
+                        sStats.nReserved    = 0;
+                        sStats.nPeak        = 0;
+                        sStats.nAllocs      = 0;
+                        sStats.nFrees       = 0;
+                    }
+            };
+
+            static policy_t alloc_policy    = DEFAULT;
+            static size_t   alloc_threshold = HUGE_PAGE_SIZE;
+            static Tracker  tracker;
+
+            void set_policy(policy_t policy)
+            {
+                alloc_policy    = policy;
+            }
+
+            policy_t policy()
+            {
+                return alloc_policy;
+            }
+
+            void set_threshold(size_t bytes)
+            {
+                alloc_threshold = bytes;
+            }
+
+            size_t threshold()
+            {
+                return alloc_threshold;
+            }
+
+            size_t huge_page_size()
+            {
+                return HUGE_PAGE_SIZE;
+            }
+
+            static inline header_t *header(const void *ptr)
+            {
+                return reinterpret_cast<header_t *>(const_cast<uint8_t *>(static_cast<const uint8_t *>(ptr))) - 1;
+            }
+
+            static void *place(void *base, size_t size, size_t align, method_t method)
+            {
+                // Put the header right before the first aligned address that leaves enough space for it
+                uintptr_t addr  = reinterpret_cast<uintptr_t>(base) + sizeof(header_t);
+                addr            = (addr + align - 1) & ~uintptr_t(align - 1);
+
+                void *ptr       = reinterpret_cast<void *>(addr);
+                header_t *hdr   = header(ptr);
+                hdr->base       = base;
+                hdr->size       = size;
+                hdr->bytes      = 0;
+                hdr->method     = method;
+                hdr->tracked    = 0;
+
+                return ptr;
+            }
+
+        #ifdef PLATFORM_LINUX
+            static void *alloc_explicit(size_t size, size_t align)
+            {
+            #ifdef MAP_HUGETLB
+                void *base      = ::mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+                if (base == MAP_FAILED)
+                    return NULL;
+                return place(base, size, align, M_EXPLICIT);
+            #else
+                return NULL;
+            #endif /* MAP_HUGETLB */
+            }
+
+            static void *alloc_transparent(size_t size, size_t align)
+            {
+            #ifdef MADV_HUGEPAGE
+                void *base      = NULL;
+                if (::posix_memalign(&base, HUGE_PAGE_SIZE, size) != 0)
+                    return NULL;
+
+                // The advice is only a hint, the buffer stays usable if the kernel rejects it
+                ::madvise(base, size, MADV_HUGEPAGE);
+                return place(base, size, align, M_TRANSPARENT);
+            #else
+                return NULL;
+            #endif /* MADV_HUGEPAGE */
+            }
+        #endif /* PLATFORM_LINUX */
+
+            static void *track(void *ptr, size_t bytes)
+            {
+                if (ptr == NULL)
+                    return NULL;
+
+                header_t *hdr   = header(ptr);
+                hdr->bytes      = bytes;
+                if (!tracker.bEnabled)
+                    return ptr;
+
+                tracker.sLock.lock();
+                {
+                    stats_t *st     = &tracker.sStats;
+                    ++st->nBlocks;
+                    ++st->nAllocs;
+                    st->nBytes     += bytes;
+                    st->nReserved  += hdr->size;
+                    st->nPeak       = lsp_max(st->nPeak, st->nReserved);
+                }
+                tracker.sLock.unlock();
+                hdr->tracked    = 1;
+
+                return ptr;
+            }
+
+            static void untrack(const header_t *hdr)
+            {
+                if (!hdr->tracked)
+                    return;
+
+                tracker.sLock.lock();
+                {
+                    stats_t *st     = &tracker.sStats;
+                    --st->nBlocks;
+                    ++st->nFrees;
+                    st->nBytes     -= hdr->bytes;
+                    st->nReserved  -= hdr->size;
+                }
+                tracker.sLock.unlock();
+            }
+
+            void *alloc(size_t bytes, size_t align)
+            {
+                align           = lsp_max(align, sizeof(void *));
+                size_t size     = bytes + sizeof(header_t) + align;
+
+            #ifdef PLATFORM_LINUX
+                if ((alloc_policy != DEFAULT) && (bytes >= alloc_threshold) && (align <= HUGE_PAGE_SIZE))
+                {
+                    // Huge pages are mapped by whole pages
+                    size_t hsize    = align_size(size, HUGE_PAGE_SIZE);
+                    void *ptr       = (alloc_policy == EXPLICIT) ? alloc_explicit(hsize, align) : NULL;
+                    if (ptr == NULL)
+                        ptr             = alloc_transparent(hsize, align);
+                    if (ptr != NULL)
+                        return track(ptr, bytes);
+                }
+            #endif /* PLATFORM_LINUX */
+
+                void *base      = ::malloc(size);
+                if (base == NULL)
+                    return NULL;
+                return track(place(base, size, align, M_HEAP), bytes);
+            }
+
+            void free(void *ptr)
+            {
+                if (ptr == NULL)
+                    return;
+
+                header_t *hdr   = header(ptr);
+                untrack(hdr);
+            #if defined(PLATFORM_LINUX) && defined(MAP_HUGETLB)
+                if (hdr->method == M_EXPLICIT)
+                {
+                    ::munmap(hdr->base, hdr->size);
+                    return;
+                }
+            #endif /* PLATFORM_LINUX */
+
+                ::free(hdr->base);
+            }
+
+            method_t method(const void *ptr)
+            {
+                return method_t(header(ptr)->method);
+            }
+
+            size_t size(const void *ptr)
+            {
+                return (ptr != NULL) ? header(ptr)->bytes : 0;
+            }
+
+            size_t reserved(const void *ptr)
+            {
+                return (ptr != NULL) ? header(ptr)->size : 0;
+            }
+
+            void set_tracking(bool enable)
+            {
+                tracker.bEnabled    = enable;
+            }
+
+            bool tracking()
+            {
+                return tracker.bEnabled;
+            }
+
+            void get_stats(stats_t *stats)
+            {
+                tracker.sLock.lock();
+                *stats      = tracker.sStats;
+                tracker.sLock.unlock();
+            }
+
+            void reset_peak()
+            {
+                tracker.sLock.lock();
+                tracker.sStats.nPeak    = tracker.sStats.nReserved;
+                tracker.sLock.unlock();
+            }
+        } /* namespace pages */
+    } /* namespace dspu */
+} /* namespace lsp */
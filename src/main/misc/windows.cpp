@@ -21,6 +21,9 @@
 
 #include <lsp-plug.in/dsp-units/misc/windows.h>
 #include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/ipc/Mutex.h>
+#include <lsp-plug.in/lltl/parray.h>
 
 namespace lsp
 {
@@ -58,6 +61,132 @@ namespace lsp
                 }
             }
 
+            typedef struct table_t
+            {
+                window_t        enType;         // Window type
+                size_t          nSize;          // Number of samples
+                ssize_t         nRefs;          // Number of references, protected by the cache lock
+                float          *vTable;         // Window function samples
+                uint8_t        *pData;          // Allocated data
+            } table_t;
+
+            /**
+             * Process-wide cache of window function tables
+             */
+            class TableCache
+            {
+                private:
+                    TableCache & operator = (const TableCache &);
+                    TableCache(const TableCache &);
+
+                public:
+                    ipc::Mutex                  sLock;
+                    lltl::parray<table_t>       vItems;
+
+                public:
+                    explicit TableCache() {}
+                    ~TableCache()
+                    {
+                        for (size_t i=0, n=vItems.size(); i<n; ++i)
+                            destroy(vItems.uget(i));
+                        vItems.flush();
+                    }
+
+                public:
+                    static void destroy(table_t *t)
+                    {
+                        if (t == NULL)
+                            return;
+                        free_aligned(t->pData);
+                        delete t;
+                    }
+
+                    table_t *find(window_t type, size_t n)
+                    {
+                        for (size_t i=0, count=vItems.size(); i<count; ++i)
+                        {
+                            table_t *t = vItems.uget(i);
+                            if ((t->enType == type) && (t->nSize == n))
+                            {
+                                ++t->nRefs;
+                                return t;
+                            }
+                        }
+                        return NULL;
+                    }
+            };
+
+            static TableCache table_cache;
+
+            const float *acquire(window_t type, size_t n)
+            {
+                // Lookup for existing table
+                table_cache.sLock.lock();
+                table_t *res    = table_cache.find(type, n);
+                table_cache.sLock.unlock();
+                if (res != NULL)
+                    return res->vTable;
+
+                // Compute the new table without holding the lock
+                res             = new table_t;
+                if (res == NULL)
+                    return NULL;
+                res->vTable     = alloc_aligned<float>(res->pData, lsp_max(n, size_t(1)));
+                if (res->vTable == NULL)
+                {
+                    delete res;
+                    return NULL;
+                }
+                res->enType     = type;
+                res->nSize      = n;
+                res->nRefs      = 1;
+                window(res->vTable, n, type);
+
+                table_cache.sLock.lock();
+                // The same table could be added by another thread at this moment
+                table_t *t      = table_cache.find(type, n);
+                if (t != NULL)
+                {
+                    table_cache.sLock.unlock();
+                    TableCache::destroy(res);
+                    return t->vTable;
+                }
+
+                if (!table_cache.vItems.add(res))
+                {
+                    table_cache.sLock.unlock();
+                    TableCache::destroy(res);
+                    return NULL;
+                }
+                table_cache.sLock.unlock();
+
+                return res->vTable;
+            }
+
+            void release(const float *table)
+            {
+                if (table == NULL)
+                    return;
+
+                table_t *t      = NULL;
+                table_cache.sLock.lock();
+                for (size_t i=0, n=table_cache.vItems.size(); i<n; ++i)
+                {
+                    table_t *item   = table_cache.vItems.uget(i);
+                    if (item->vTable != table)
+                        continue;
+                    if ((--item->nRefs) <= 0)
+                    {
+                        table_cache.vItems.remove(i);
+                        t               = item;
+                    }
+                    break;
+                }
+                table_cache.sLock.unlock();
+
+                TableCache::destroy(t);
+            }
+
             void rectangular(float *dst, size_t n)
             {
                 while (n--)
@@ -20,6 +20,9 @@
  */
 
 #include <lsp-plug.in/dsp-units/noise/LCG.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#define LCG_BLOCK_SIZE      0x100   /* Size of the block for block generation */
 
 namespace lsp
 {
@@ -84,22 +87,99 @@ namespace lsp
             }
         }
 
+        void LCG::generate(float *dst, size_t count)
+        {
+            switch (enDistribution)
+            {
+                case LCG_EXPONENTIAL:
+                {
+                    // The signs and the magnitudes are generated by separate blocks
+                    float sign[LCG_BLOCK_SIZE];
+                    sRand.random(sign, count, RND_LINEAR);
+                    sRand.random(dst, count, RND_EXP);
+
+                    for (size_t i=0; i<count; ++i)
+                    {
+                        float k     = (sign[i] >= 0.5f) ? fAmplitude : -fAmplitude;
+                        dst[i]      = k * dst[i] + fOffset;
+                    }
+                    break;
+                }
+
+                case LCG_TRIANGULAR:
+                    sRand.random(dst, count, RND_TRIANGLE);
+                    dsp::mul_k2(dst, 2.0f * fAmplitude, count);
+                    dsp::add_k2(dst, fOffset - 0.5f, count);
+                    break;
+
+                case LCG_GAUSSIAN:
+                    sRand.random(dst, count, RND_GAUSSIAN);
+                    dsp::mul_k2(dst, fAmplitude, count);
+                    dsp::add_k2(dst, fOffset, count);
+                    break;
+
+                default:
+                case LCG_UNIFORM:
+                    sRand.random(dst, count, RND_LINEAR);
+                    dsp::mul_k2(dst, 2.0f * fAmplitude, count);
+                    dsp::add_k2(dst, fOffset - fAmplitude, count);
+                    break;
+            }
+        }
+
         void LCG::process_add(float *dst, const float *src, size_t count)
         {
-            while (count--)
-                *(dst++) = *(src++) + process_single();
+            float buf[LCG_BLOCK_SIZE];
+
+            if (src != NULL)
+                dsp::copy(dst, src, count);
+            else
+                dsp::fill_zero(dst, count);
+
+            while (count > 0)
+            {
+                size_t to_do = lsp_min(count, size_t(LCG_BLOCK_SIZE));
+
+                generate(buf, to_do);
+                dsp::add2(dst, buf, to_do);
+
+                dst     += to_do;
+                count   -= to_do;
+            }
         }
 
         void LCG::process_mul(float *dst, const float *src, size_t count)
         {
-            while (count--)
-                *(dst++) = *(src++) * process_single();
+            float buf[LCG_BLOCK_SIZE];
+
+            if (src != NULL)
+                dsp::copy(dst, src, count);
+            else
+                dsp::fill_zero(dst, count);
+
+            while (count > 0)
+            {
+                size_t to_do = lsp_min(count, size_t(LCG_BLOCK_SIZE));
+
+                generate(buf, to_do);
+                dsp::mul2(dst, buf, to_do);
+
+                dst     += to_do;
+                count   -= to_do;
+            }
         }
 
         void LCG::process_overwrite(float *dst, size_t count)
         {
-            while (count--)
-                *(dst++) = process_single();
+            while (count > 0)
+            {
+                size_t to_do = lsp_min(count, size_t(LCG_BLOCK_SIZE));
+
+                generate(dst, to_do);
+
+                dst     += to_do;
+                count   -= to_do;
+            }
         }
 
         void LCG::dump(IStateDumper *v) const
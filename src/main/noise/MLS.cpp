@@ -20,6 +20,11 @@
  */
 
 #include <lsp-plug.in/dsp-units/noise/MLS.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/bits.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#define MLS_BLOCK_SIZE      0x100   /* Size of the temporary buffer */
 
 namespace lsp
 {
@@ -96,13 +101,21 @@ namespace lsp
             nOutputMask         = 1;
             nState              = 0;
 
+            vJumpTable          = NULL;
+            nJumpBytes          = 0;
+            pData               = NULL;
+
             fAmplitude          = 1.0f;
+            fOffset             = 0.0f;
 
             bSync               = true;
         }
 
         void MLS::destroy()
         {
+            free_aligned(pData);
+            vJumpTable          = NULL;
+            nJumpBytes          = 0;
         }
 
         size_t MLS::maximum_number_of_bits() const
@@ -132,9 +145,52 @@ namespace lsp
             if (nState == 0)
                 nState |= nActiveMask;
 
+            build_jump_table();
+
             bSync = false;
         }
 
+        void MLS::build_jump_table()
+        {
+            // The table is allocated once for the maximum number of bits
+            if (vJumpTable == NULL)
+            {
+                size_t to_alloc     = (nMaxBits / 8) * 0x100 * sizeof(mls_t);
+                vJumpTable          = alloc_aligned<mls_t>(pData, to_alloc);
+                if (vJumpTable == NULL)
+                {
+                    nJumpBytes          = 0;
+                    return;
+                }
+            }
+
+            // The feedback is linear, so the state after nBits steps is the xor of the
+            // images of the set bits, the images are computed with the regular steps
+            mls_t image[nMaxBits];
+            mls_t state         = nState;
+            for (size_t i=0; i<nBits; ++i)
+            {
+                nState              = mls_t(1) << i;
+                for (size_t j=0; j<nBits; ++j)
+                    progress();
+                image[i]            = nState;
+            }
+            nState              = state;
+
+            // Combine the images for each value of each byte of the state
+            nJumpBytes          = (nBits + 7) >> 3;
+            for (size_t i=0; i<nJumpBytes; ++i)
+            {
+                mls_t *t            = &vJumpTable[i << 8];
+                t[0]                = 0;
+                for (size_t v=1; v<0x100; ++v)
+                {
+                    size_t bit          = (i << 3) + int_log2(v & (~v + 1));
+                    t[v]                = t[v & (v - 1)] ^ ((bit < nBits) ? image[bit] : 0);
+                }
+            }
+        }
+
         // Compute the xor of all the bits in value
         MLS::mls_t MLS::xor_gate(mls_t value)
         {
@@ -179,22 +235,84 @@ namespace lsp
             return progress() ? fAmplitude + fOffset : -fAmplitude + fOffset;
         }
 
+        void MLS::generate(float *dst, size_t count)
+        {
+            const float hi  = fAmplitude + fOffset;
+            const float lo  = -fAmplitude + fOffset;
+
+            if (nJumpBytes > 0)
+            {
+                for ( ; count >= nBits; count -= nBits, dst += nBits)
+                {
+                    // Expand the register bits to samples
+                    for (size_t i=0; i<nBits; i += 32)
+                    {
+                        uint32_t word   = uint32_t(nState >> i);
+                        float *p        = &dst[i];
+                        size_t n        = lsp_min(nBits - i, size_t(32));
+                        for (size_t j=0; j<n; ++j)
+                            p[j]            = ((word >> j) & 1) ? hi : lo;
+                    }
+
+                    // Jump nBits steps forward
+                    mls_t state     = nState;
+                    mls_t next      = 0;
+                    for (size_t i=0; i<nJumpBytes; ++i, state >>= 8)
+                        next           ^= vJumpTable[(i << 8) + size_t(state & 0xff)];
+                    nState          = next;
+                }
+            }
+
+            // Process the tail
+            for ( ; count > 0; --count)
+                *(dst++)        = (progress()) ? hi : lo;
+        }
+
         void MLS::process_add(float *dst, const float *src, size_t count)
         {
-            while (count--)
-                *(dst++) = *(src++) + process_single();
+            float buf[MLS_BLOCK_SIZE];
+
+            if (src != NULL)
+                dsp::copy(dst, src, count);
+            else
+                dsp::fill_zero(dst, count);
+
+            while (count > 0)
+            {
+                size_t to_do = lsp_min(count, size_t(MLS_BLOCK_SIZE));
+
+                generate(buf, to_do);
+                dsp::add2(dst, buf, to_do);
+
+                dst     += to_do;
+                count   -= to_do;
+            }
         }
 
         void MLS::process_mul(float *dst, const float *src, size_t count)
         {
-            while (count--)
-                *(dst++) = *(src++) * process_single();
+            float buf[MLS_BLOCK_SIZE];
+
+            if (src != NULL)
+                dsp::copy(dst, src, count);
+            else
+                dsp::fill_zero(dst, count);
+
+            while (count > 0)
+            {
+                size_t to_do = lsp_min(count, size_t(MLS_BLOCK_SIZE));
+
+                generate(buf, to_do);
+                dsp::mul2(dst, buf, to_do);
+
+                dst     += to_do;
+                count   -= to_do;
+            }
         }
 
         void MLS::process_overwrite(float *dst, size_t count)
         {
-            while (count--)
-                *(dst++) = process_single();
+            generate(dst, count);
         }
 
         void MLS::dump(IStateDumper *v) const
@@ -209,6 +327,9 @@ namespace lsp
             v->write("nTapsMask", nTapsMask);
             v->write("nOutputMask", nOutputMask);
             v->write("nState", nState);
+            v->write("vJumpTable", vJumpTable);
+            v->write("nJumpBytes", nJumpBytes);
+            v->write("pData", pData);
 
             v->write("fAmplitude", fAmplitude);
             v->write("fOffset", fOffset);
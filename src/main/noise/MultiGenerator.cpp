@@ -0,0 +1,354 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/dsp-units/noise/MultiGenerator.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#define BUF_LIM_SIZE    256u
+#define SEED_STEP       0x9e3779b9u     /* Golden ratio step, spreads the seeds of channels */
+#define SEED_MIX        0x5bd1e995u     /* Decorrelates the seed of the Velvet randomizer */
+
+namespace lsp
+{
+    namespace dspu
+    {
+        MultiNoiseGenerator::MultiNoiseGenerator()
+        {
+            construct();
+        }
+
+        MultiNoiseGenerator::~MultiNoiseGenerator()
+        {
+            destroy();
+        }
+
+        void MultiNoiseGenerator::construct()
+        {
+            vGenerators     = NULL;
+            vBuffers        = NULL;
+            nChannels       = 0;
+            nSampleRate     = 0;
+
+            enColor         = NG_COLOR_WHITE;
+            nOrder          = 50;
+            fSlope          = 0.0f;
+            enSlopeUnit     = STLT_SLOPE_UNIT_NEPER_PER_NEPER;
+            bSync           = true;
+            pData           = NULL;
+        }
+
+        void MultiNoiseGenerator::destroy()
+        {
+            if (vGenerators != NULL)
+            {
+                for (size_t i=0; i<nChannels; ++i)
+                    vGenerators[i].destroy();
+                delete [] vGenerators;
+                vGenerators     = NULL;
+            }
+
+            if (vBuffers != NULL)
+            {
+                delete [] vBuffers;
+                vBuffers        = NULL;
+            }
+
+            if (pData != NULL)
+            {
+                free_aligned(pData);
+                pData           = NULL;
+            }
+
+            sColorFilter.destroy();
+
+            nChannels       = 0;
+        }
+
+        bool MultiNoiseGenerator::init(size_t channels, uint32_t seed)
+        {
+            destroy();
+
+            float *ptr      = alloc_aligned<float>(pData, channels * BUF_LIM_SIZE, DEFAULT_ALIGN);
+            if (ptr == NULL)
+                return false;
+            vGenerators     = new NoiseGenerator[channels];
+            vBuffers        = new float *[channels];
+            if ((vGenerators == NULL) || (vBuffers == NULL))
+            {
+                destroy();
+                return false;
+            }
+            nChannels       = channels;
+
+            if (!sColorFilter.init(channels))
+            {
+                destroy();
+                return false;
+            }
+
+            const uint8_t bits  = sizeof(MLS::mls_t) * 8;
+            for (size_t i=0; i<channels; ++i)
+            {
+                uint32_t s          = seed + uint32_t(i) * SEED_STEP;
+
+                NoiseGenerator *g   = &vGenerators[i];
+                g->init(bits, MLS::mls_t(s), s, s ^ SEED_MIX, bits, MLS::mls_t(s ^ SEED_MIX));
+                g->set_amplitude(1.0f);
+                g->set_offset(0.0f);
+
+                vBuffers[i]         = ptr;
+                ptr                += BUF_LIM_SIZE;
+            }
+
+            bSync           = true;
+
+            return true;
+        }
+
+        void MultiNoiseGenerator::update_settings()
+        {
+            if (!bSync)
+                return;
+
+            // Channels generate white noise only
+            for (size_t i=0; i<nChannels; ++i)
+            {
+                vGenerators[i].set_sample_rate(nSampleRate);
+                vGenerators[i].update_settings();
+            }
+
+            // Compute the coloring filter the same way as NoiseGenerator does,
+            // the colors not filtered by NoiseGenerator put the filter to bypass
+            float slope;
+            stlt_slope_unit_t unit      = STLT_SLOPE_UNIT_NEPER_PER_NEPER;
+
+            switch (enColor)
+            {
+                case NG_COLOR_PINK:         slope   = -0.5f;    break;
+                case NG_COLOR_RED:          slope   = -1.0f;    break;
+                case NG_COLOR_ARBITRARY:
+                    slope   = fSlope;
+                    unit    = enSlopeUnit;
+                    break;
+
+                default:
+                case NG_COLOR_WHITE:
+                case NG_COLOR_BLUE:
+                case NG_COLOR_VIOLET:
+                    slope   = 0.0f;
+                    break;
+            }
+
+            sColorFilter.set_sample_rate(nSampleRate);
+            sColorFilter.set_order(nOrder);
+            sColorFilter.set_slope(slope, unit);
+            sColorFilter.set_lower_frequency(10.0f);
+            sColorFilter.set_upper_frequency(0.9f * 0.5f * nSampleRate);
+            sColorFilter.update_settings();
+
+            bSync                       = false;
+        }
+
+        void MultiNoiseGenerator::set_sample_rate(size_t sr)
+        {
+            if (nSampleRate == sr)
+                return;
+
+            nSampleRate     = sr;
+            bSync           = true;
+        }
+
+        void MultiNoiseGenerator::set_mls_n_bits(uint8_t nbits)
+        {
+            for (size_t i=0; i<nChannels; ++i)
+                vGenerators[i].set_mls_n_bits(nbits);
+            bSync           = true;
+        }
+
+        void MultiNoiseGenerator::set_lcg_distribution(lcg_dist_t dist)
+        {
+            for (size_t i=0; i<nChannels; ++i)
+                vGenerators[i].set_lcg_distribution(dist);
+            bSync           = true;
+        }
+
+        void MultiNoiseGenerator::set_velvet_type(vn_velvet_type_t type)
+        {
+            for (size_t i=0; i<nChannels; ++i)
+                vGenerators[i].set_velvet_type(type);
+            bSync           = true;
+        }
+
+        void MultiNoiseGenerator::set_velvet_window_width(float width)
+        {
+            for (size_t i=0; i<nChannels; ++i)
+                vGenerators[i].set_velvet_window_width(width);
+            bSync           = true;
+        }
+
+        void MultiNoiseGenerator::set_velvet_arn_delta(float delta)
+        {
+            for (size_t i=0; i<nChannels; ++i)
+                vGenerators[i].set_velvet_arn_delta(delta);
+            bSync           = true;
+        }
+
+        void MultiNoiseGenerator::set_velvet_crush(bool crush)
+        {
+            for (size_t i=0; i<nChannels; ++i)
+                vGenerators[i].set_velvet_crush(crush);
+            bSync           = true;
+        }
+
+        void MultiNoiseGenerator::set_velvet_crushing_probability(float prob)
+        {
+            for (size_t i=0; i<nChannels; ++i)
+                vGenerators[i].set_velvet_crushing_probability(prob);
+            bSync           = true;
+        }
+
+        void MultiNoiseGenerator::set_generator(ng_generator_t core)
+        {
+            for (size_t i=0; i<nChannels; ++i)
+                vGenerators[i].set_generator(core);
+        }
+
+        void MultiNoiseGenerator::set_noise_color(ng_color_t color)
+        {
+            if ((color < NG_COLOR_WHITE) || (color >= NG_COLOR_MAX))
+                return;
+            if (color == enColor)
+                return;
+
+            enColor         = color;
+            bSync           = true;
+        }
+
+        void MultiNoiseGenerator::set_coloring_order(size_t order)
+        {
+            if (order == nOrder)
+                return;
+
+            nOrder          = order;
+            bSync           = true;
+        }
+
+        void MultiNoiseGenerator::set_color_slope(float slope, stlt_slope_unit_t unit)
+        {
+            if ((slope == fSlope) && (unit == enSlopeUnit))
+                return;
+
+            fSlope          = slope;
+            enSlopeUnit     = unit;
+            bSync           = true;
+        }
+
+        void MultiNoiseGenerator::set_amplitude(float amplitude)
+        {
+            for (size_t i=0; i<nChannels; ++i)
+                vGenerators[i].set_amplitude(amplitude);
+            bSync           = true;
+        }
+
+        void MultiNoiseGenerator::set_offset(float offset)
+        {
+            for (size_t i=0; i<nChannels; ++i)
+                vGenerators[i].set_offset(offset);
+            bSync           = true;
+        }
+
+        void MultiNoiseGenerator::do_process(float * const *dst, size_t count)
+        {
+            // Each generator emits the whole block by its own vectorized generator
+            for (size_t i=0; i<nChannels; ++i)
+                vGenerators[i].process_overwrite(dst[i], count);
+
+            // All channels pass the cascade of the coloring filter at once
+            sColorFilter.process_overwrite(dst, dst, count);
+        }
+
+        void MultiNoiseGenerator::process_add(float * const *dst, const float * const *src, size_t count)
+        {
+            if (src == NULL)
+            {
+                // No inputs, interpret `src` as zeros: dst[i] = noise[i] + 0 = noise[i]
+                do_process(dst, count);
+                return;
+            }
+
+            for (size_t offset=0; offset < count; )
+            {
+                size_t to_do = lsp_min(count - offset, BUF_LIM_SIZE);
+
+                // dst[i] = src[i] + do_process[i]
+                do_process(vBuffers, to_do);
+                for (size_t i=0; i<nChannels; ++i)
+                    dsp::add3(&dst[i][offset], vBuffers[i], &src[i][offset], to_do);
+
+                offset += to_do;
+            }
+        }
+
+        void MultiNoiseGenerator::process_mul(float * const *dst, const float * const *src, size_t count)
+        {
+            if (src == NULL)
+            {
+                // No inputs, interpret `src` as zeros: dst[i] = noise[i] * 0 = 0
+                for (size_t i=0; i<nChannels; ++i)
+                    dsp::fill_zero(dst[i], count);
+                return;
+            }
+
+            for (size_t offset=0; offset < count; )
+            {
+                size_t to_do = lsp_min(count - offset, BUF_LIM_SIZE);
+
+                // dst[i] = src[i] * noise[i]
+                do_process(vBuffers, to_do);
+                for (size_t i=0; i<nChannels; ++i)
+                    dsp::mul3(&dst[i][offset], vBuffers[i], &src[i][offset], to_do);
+
+                offset += to_do;
+            }
+        }
+
+        void MultiNoiseGenerator::process_overwrite(float * const *dst, size_t count)
+        {
+            do_process(dst, count);
+        }
+
+        void MultiNoiseGenerator::dump(IStateDumper *v) const
+        {
+            v->write_object_array("vGenerators", vGenerators, nChannels);
+            v->write("vBuffers", vBuffers);
+            v->write("nChannels", nChannels);
+            v->write("nSampleRate", nSampleRate);
+            v->write_object("sColorFilter", &sColorFilter);
+            v->write("enColor", enColor);
+            v->write("nOrder", nOrder);
+            v->write("fSlope", fSlope);
+            v->write("enSlopeUnit", enSlopeUnit);
+            v->write("bSync", bSync);
+            v->write("pData", pData);
+        }
+    }
+} /* namespace lsp */
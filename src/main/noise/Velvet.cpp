@@ -51,6 +51,8 @@ namespace lsp
             fARNdelta                   = 0.5f;
             fAmplitude                  = 1.0f;
             fOffset                     = 0.0f;
+
+            reset_stream();
         }
 
         Velvet::~Velvet()
@@ -68,6 +70,8 @@ namespace lsp
             sMLS.set_n_bits(mlsnbits);
             sMLS.set_state(mlsseed);
             sMLS.update_settings();
+
+            reset_stream();
         }
 
         void Velvet::init()
@@ -80,6 +84,8 @@ namespace lsp
 
             // Simply use defaults in the class.
             sMLS.update_settings();
+
+            reset_stream();
         }
 
         float Velvet::get_random_value()
@@ -105,107 +111,156 @@ namespace lsp
             return (get_random_value() > sCrushParams.fCrushProb) ? 1.0f : -1.0f;
         }
 
-        void Velvet::do_process(float *dst, size_t count)
+        void Velvet::reset_stream()
+        {
+            fGrid                       = 0.0f;
+            fNextValue                  = 0.0f;
+            nNextPos                    = 0;
+            bPending                    = false;
+        }
+
+        void Velvet::draw_impulse()
         {
+            float width     = lsp_max(fWindowWidth, MIN_WINDOW_WIDTH);
+            float pos;
+
             switch (enVelvetType)
             {
                 case VN_VELVET_OVN:
+                    pos             = fGrid + get_random_value() * (width - 1.0f);
+                    fGrid          += width;
+                    break;
+
+                case VN_VELVET_OVNA:
+                    pos             = fGrid + get_random_value() * width;
+                    fGrid          += width;
+                    break;
+
+                case VN_VELVET_ARN:
+                default:
                 {
-                    dsp::fill_zero(dst, count);
+                    float k         = 2.0f * fARNdelta * (width - 1.0f);
+                    float b         = (1.0f - fARNdelta) * (width - 1.0f);
+                    pos             = floorf(fGrid + 1.0f + b + k * get_random_value());
+                    fGrid           = pos;
+                    break;
+                }
+            }
+
+            nNextPos        = pos;
+            fNextValue      = (sCrushParams.bCrush) ? get_crushed_spike() : get_spike();
+            bPending        = true;
+        }
 
-                    size_t idx = 0;
-                    size_t scan = 0;
+        size_t Velvet::generate_ternary(uint32_t *pos, float *value, size_t count)
+        {
+            float vRand[BUF_LIM_SIZE], vCrush[BUF_LIM_SIZE];
+            size_t n        = 0;
+            float k         = fWindowWidth / (fWindowWidth - 1.0f);
 
-                    float k = fWindowWidth - 1.0f;
-                    while (idx < count)
-                    {
-                        idx = scan * fWindowWidth + get_random_value() * k;
+            for (size_t offset=0; offset < count; )
+            {
+                size_t to_do = lsp_min(count - offset, BUF_LIM_SIZE);
 
-                        if (sCrushParams.bCrush)
-                            dst[idx] = get_crushed_spike();
-                        else
-                            dst[idx] = get_spike();
+                // Compute the ternary values for the block of random numbers
+                sRandomizer.random(vRand, to_do, RND_LINEAR);
+                for (size_t i=0; i<to_do; ++i)
+                    vRand[i]        = roundf(k * (vRand[i] - 0.5f));
 
-                        ++scan;
+                if (sCrushParams.bCrush)
+                {
+                    sRandomizer.random(vCrush, to_do, RND_LINEAR);
+                    for (size_t i=0; i<to_do; ++i)
+                    {
+                        float v         = fabsf(vRand[i]);
+                        vRand[i]        = (vCrush[i] > sCrushParams.fCrushProb) ? -v : v;
                     }
                 }
-                break;
 
-                case VN_VELVET_OVNA:
+                // Keep non-zero samples only
+                for (size_t i=0; i<to_do; ++i)
                 {
-                    dsp::fill_zero(dst, count);
+                    if (vRand[i] == 0.0f)
+                        continue;
+                    pos[n]          = offset + i;
+                    value[n++]      = vRand[i];
+                }
 
-                    size_t idx = 0;
-                    size_t scan = 0;
+                offset += to_do;
+            }
 
-                    while (idx < count)
-                    {
-                        idx = scan * fWindowWidth + get_random_value() * fWindowWidth;
+            return n;
+        }
+
+        size_t Velvet::generate(uint32_t *pos, float *value, size_t count)
+        {
+            switch (enVelvetType)
+            {
+                case VN_VELVET_OVN:
+                case VN_VELVET_OVNA:
+                case VN_VELVET_ARN:
+                    break;
 
-                        if (sCrushParams.bCrush)
-                            dst[idx] = get_crushed_spike();
-                        else
-                            dst[idx] = get_spike();
+                case VN_VELVET_TRN:
+                    return generate_ternary(pos, value, count);
 
-                        ++scan;
-                    }
-                }
-                break;
+                default:
+                    return 0;
+            }
 
-                case VN_VELVET_ARN:
-                {
-                    dsp::fill_zero(dst, count);
+            // The impulse beyond the block stays pending for the next block
+            size_t n        = 0;
+            if (!bPending)
+                draw_impulse();
 
-                    size_t idx = 0;
+            while (nNextPos < count)
+            {
+                pos[n]          = nNextPos;
+                value[n++]      = fNextValue;
+                draw_impulse();
+            }
 
-                    float k = 2.0f * fARNdelta * (fWindowWidth - 1.0f);
-                    float b = (1.0f - fARNdelta) * (fWindowWidth - 1.0f);
-                    while (idx < count)
-                    {
-                        idx += 1.0f + b + k * get_random_value();
+            nNextPos       -= count;
+            fGrid          -= count;
 
-                        if (sCrushParams.bCrush)
-                            dst[idx] = get_crushed_spike();
-                        else
-                            dst[idx] = get_spike();
-                    }
-                }
-                break;
+            return n;
+        }
 
-                case VN_VELVET_TRN:
-                {
-                    size_t idx = 0;
-                    float k = fWindowWidth / (fWindowWidth - 1.0f);
-                    while (idx < count)
-                    {
-                        dst[idx] = roundf(k * (get_random_value() - 0.5f));
-                        ++idx;
-                    }
+        void Velvet::do_process(float *dst, size_t count)
+        {
+            uint32_t vPos[BUF_LIM_SIZE];
+            float vValue[BUF_LIM_SIZE];
 
-                    if (sCrushParams.bCrush)
-                    {
-                        idx = 0;
-                        while (idx < count)
-                        {
-                            float multiplier = 1.0f;
+            dsp::fill_zero(dst, count);
 
-                            if (get_random_value() > sCrushParams.fCrushProb)
-                                multiplier = -1.0f;
+            for (size_t offset=0; offset < count; )
+            {
+                size_t to_do = lsp_min(count - offset, BUF_LIM_SIZE);
 
-                            dst[idx] = multiplier * abs(dst[idx]);
-                            ++idx;
-                        }
-                    }
-                }
-                break;
+                // Scatter the impulses
+                float *ptr  = &dst[offset];
+                size_t n    = generate(vPos, vValue, to_do);
+                for (size_t i=0; i<n; ++i)
+                    ptr[vPos[i]]    = vValue[i];
 
-                default:
-                case VN_VELVET_MAX:
-                    dsp::fill_zero(dst, count);
-                    break;
+                offset += to_do;
             }
         }
 
+        size_t Velvet::generate_sparse(uint32_t *pos, float *value, size_t count)
+        {
+            size_t n        = generate(pos, value, count);
+            dsp::mul_k2(value, fAmplitude, n);
+            return n;
+        }
+
+        void Velvet::convolve(float *dst, const float *src, const uint32_t *pos, const float *value,
+            size_t impulses, size_t count)
+        {
+            for (size_t i=0; i<impulses; ++i)
+                dsp::fmadd_k3(&dst[pos[i]], src, value[i], count);
+        }
+
         void Velvet::process_add(float *dst, const float *src, size_t count)
         {
             if (src == NULL)
@@ -286,6 +341,11 @@ namespace lsp
             v->write("fARNdelta", fARNdelta);
             v->write("fAmplitude", fAmplitude);
             v->write("fOffset", fOffset);
+
+            v->write("fGrid", fGrid);
+            v->write("fNextValue", fNextValue);
+            v->write("nNextPos", nNextPos);
+            v->write("bPending", bPending);
         }
     }
 }
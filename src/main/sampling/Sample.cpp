@@ -21,14 +21,29 @@
 
 #include <lsp-plug.in/dsp-units/sampling/Sample.h>
 #include <lsp-plug.in/dsp-units/filters/Filter.h>
+#include <lsp-plug.in/dsp-units/filters/FilterBank.h>
+#include <lsp-plug.in/dsp-units/util/LoudnessMeter.h>
+#include <lsp-plug.in/dsp-units/misc/pages.h>
 #include <lsp-plug.in/common/alloc.h>
 #include <lsp-plug.in/dsp/dsp.h>
 #include <lsp-plug.in/mm/InAudioFileStream.h>
 #include <lsp-plug.in/mm/OutAudioFileStream.h>
+#include <lsp-plug.in/io/OutFileStream.h>
+#include <lsp-plug.in/common/atomic.h>
 #include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/stdlib/string.h>
+
+#include <private/io/mapped_file.h>
+#include <private/sampling/batch.h>
 
 #define BUFFER_FRAMES           4096
 #define RESAMPLING_PERIODS      8
+#define RESAMPLING_CHUNK        0x10000
+#define RESAMPLING_MAX_PHASES   0x1000
+#define RESAMPLING_CUTOFF       0.95f
+#define MEASURE_BUF_SIZE        0x400
+#define MEASURE_CHUNK           0x10000
+#define MEASURE_CHUNK_BLOCKS    50
 
 namespace lsp
 {
@@ -45,6 +60,49 @@ namespace lsp
             return a;
         }
 
+        static const char sample_cache_signature[8] = { 'L', 'S', 'P', 'S', 'M', 'P', 'L', 'C' };
+
+        static uint64_t source_hash(const io::Path *path)
+        {
+            // FNV-1a hash of the path
+            uint64_t hash   = 0xcbf29ce484222325ULL;
+            for (const char *p = path->as_utf8(); *p != '\0'; ++p)
+                hash            = (hash ^ uint8_t(*p)) * 0x100000001b3ULL;
+            return hash;
+        }
+
+        static void unpack_frames(float *dst, size_t stride, const float *src, size_t channels, size_t frames)
+        {
+            switch (channels)
+            {
+                case 1:
+                    dsp::copy(dst, src, frames);
+                    break;
+
+                case 2:
+                {
+                    float *l            = dst;
+                    float *r            = &dst[stride];
+                    for (size_t i=0; i<frames; ++i, src += 2)
+                    {
+                        l[i]                = src[0];
+                        r[i]                = src[1];
+                    }
+                    break;
+                }
+
+                default:
+                    // Read the interleaved data sequentially, one frame at a time
+                    for (size_t i=0; i<frames; ++i)
+                    {
+                        float *p            = &dst[i];
+                        for (size_t j=0; j<channels; ++j, ++src, p += stride)
+                            *p                  = *src;
+                    }
+                    break;
+            }
+        }
+
         Sample::Sample()
         {
             construct();
@@ -62,15 +120,41 @@ namespace lsp
             nLength     = 0;
             nMaxLength  = 0;
             nChannels   = 0;
+            pMapped     = NULL;
+            nMapped     = 0;
+            pPeaks      = NULL;
+            nPeaksThreads   = 1;
+            vCompact    = NULL;
+            vScale      = NULL;
+            nBlocks     = 0;
+            pCompact    = NULL;
         }
 
-        void Sample::destroy()
+        void Sample::release_buffer()
         {
-            if (vBuffer != NULL)
+            if (pMapped != NULL)
             {
-                free(vBuffer);
-                vBuffer     = NULL;
+                mapped_file_t f;
+                f.data      = pMapped;
+                f.size      = nMapped;
+                unmap_file(&f);
             }
+            else if (vBuffer != NULL)
+                pages::free(vBuffer);
+            free_aligned(pCompact);
+
+            vBuffer     = NULL;
+            pMapped     = NULL;
+            nMapped     = 0;
+            vCompact    = NULL;
+            vScale      = NULL;
+            nBlocks     = 0;
+        }
+
+        void Sample::destroy()
+        {
+            release_buffer();
+            drop_peaks();
             nMaxLength      = 0;
             nLength         = 0;
             nChannels       = 0;
@@ -84,19 +168,19 @@ namespace lsp
             // Allocate new data
             size_t len      = lsp_max(max_length, size_t(DEFAULT_ALIGN));
             size_t cap      = align_size(len, DEFAULT_ALIGN);       // Make multiple of 4
-            float *buf      = static_cast<float *>(::malloc(cap * channels * sizeof(float)));
+            float *buf      = static_cast<float *>(pages::alloc(cap * channels * sizeof(float)));
             if (buf == NULL)
                 return false;
             dsp::fill_zero(buf, cap * channels);
 
             // Destroy previous data
-            if (vBuffer != NULL)
-                free(vBuffer);
+            release_buffer();
 
             vBuffer         = buf;
             nLength         = length;
             nMaxLength      = cap;
             nChannels       = channels;
+            sync_peaks();
             return true;
         }
 
@@ -110,7 +194,7 @@ namespace lsp
             // Allocate new data
             size_t len      = lsp_max(s->nLength, size_t(DEFAULT_ALIGN));
             size_t cap      = align_size(len, DEFAULT_ALIGN);       // Make multiple of 4
-            float *buf      = static_cast<float *>(::malloc(cap * s->nChannels * sizeof(float)));
+            float *buf      = static_cast<float *>(pages::alloc(cap * s->nChannels * sizeof(float)));
             if (buf == NULL)
                 return STATUS_NO_MEM;
 
@@ -122,14 +206,14 @@ namespace lsp
             }
 
             // Destroy previous data
-            if (vBuffer != NULL)
-                free(vBuffer);
+            release_buffer();
 
             vBuffer         = buf;
             nSampleRate     = s->nSampleRate;
             nLength         = s->nLength;
             nMaxLength      = cap;
             nChannels       = s->nChannels;
+            sync_peaks();
 
             return STATUS_OK;
         }
@@ -141,7 +225,7 @@ namespace lsp
 
             // Allocate new data
             max_length      = align_size(max_length, DEFAULT_ALIGN);    // Make multiple of 4
-            float *buf      = reinterpret_cast<float *>(::malloc(max_length * channels * sizeof(float)));
+            float *buf      = static_cast<float *>(pages::alloc(max_length * channels * sizeof(float)));
             if (buf == NULL)
                 return false;
 
@@ -169,8 +253,7 @@ namespace lsp
                 }
 
                 // Destroy previously allocated data
-                if (vBuffer != NULL)
-                    free(vBuffer);
+                release_buffer();
             }
             else
                 dsp::fill_zero(buf, max_length * channels);
@@ -179,6 +262,7 @@ namespace lsp
             nLength         = length;
             nMaxLength      = max_length;
             nChannels       = channels;
+            sync_peaks();
             return true;
         }
 
@@ -189,6 +273,195 @@ namespace lsp
             lsp::swap(nMaxLength, dst->nMaxLength);
             lsp::swap(nLength, dst->nLength);
             lsp::swap(nChannels, dst->nChannels);
+            lsp::swap(pMapped, dst->pMapped);
+            lsp::swap(nMapped, dst->nMapped);
+            lsp::swap(pPeaks, dst->pPeaks);
+            lsp::swap(nPeaksThreads, dst->nPeaksThreads);
+            lsp::swap(vCompact, dst->vCompact);
+            lsp::swap(vScale, dst->vScale);
+            lsp::swap(nBlocks, dst->nBlocks);
+            lsp::swap(pCompact, dst->pCompact);
+        }
+
+        static void encode_block(int16_t *dst, float *scale, const float *src, size_t count)
+        {
+            // Choose the power of 2 scale that fits the peak of the block into 16 bits
+            int exp             = 0;
+            float peak          = dsp::abs_max(src, count);
+            if (peak > 0.0f)
+                frexpf(peak, &exp);
+            float k             = (peak > 0.0f) ? ldexpf(1.0f, exp - 15) : 0.0f;
+            if (!(k > 0.0f))
+            {
+                memset(dst, 0, count * sizeof(int16_t));
+                *scale              = 0.0f;
+                return;
+            }
+
+            float rk            = 1.0f / k;
+            for (size_t i=0; i<count; ++i)
+            {
+                long v              = lrintf(src[i] * rk);
+                dst[i]              = int16_t(lsp_limit(v, -0x8000L, 0x7fffL));
+            }
+            *scale              = k;
+        }
+
+        static void decode_blocks(float *dst, const int16_t *src, const float *scale, size_t offset, size_t count)
+        {
+            while (count > 0)
+            {
+                size_t block        = offset >> SAMPLE_COMPACT_BLOCK_RANK;
+                size_t to_do        = lsp_min(count, ((block + 1) << SAMPLE_COMPACT_BLOCK_RANK) - offset);
+                const int16_t *s    = &src[offset];
+                const float k       = scale[block];
+
+                for (size_t i=0; i<to_do; ++i)
+                    dst[i]              = s[i] * k;
+
+                dst                += to_do;
+                offset             += to_do;
+                count              -= to_do;
+            }
+        }
+
+        status_t Sample::compact()
+        {
+            if (pCompact != NULL)
+                return STATUS_OK;
+            if ((vBuffer == NULL) || (nChannels <= 0))
+                return STATUS_BAD_STATE;
+
+            // Allocate the compact storage
+            size_t blocks       = (nMaxLength + SAMPLE_COMPACT_BLOCK_SIZE - 1) >> SAMPLE_COMPACT_BLOCK_RANK;
+            size_t szof_data    = align_size(nMaxLength * nChannels * sizeof(int16_t), DEFAULT_ALIGN);
+            size_t szof_scale   = align_size(blocks * nChannels * sizeof(float), DEFAULT_ALIGN);
+
+            uint8_t *data       = NULL;
+            uint8_t *ptr        = alloc_aligned<uint8_t>(data, szof_data + szof_scale);
+            if (ptr == NULL)
+                return STATUS_NO_MEM;
+
+            int16_t *vc         = reinterpret_cast<int16_t *>(ptr);
+            ptr                += szof_data;
+            float *vs           = reinterpret_cast<float *>(ptr);
+
+            // Encode all blocks of all channels
+            for (size_t i=0; i<nChannels; ++i)
+            {
+                const float *src    = channel(i);
+                int16_t *dst        = &vc[i * nMaxLength];
+                float *scale        = &vs[i * blocks];
+
+                for (size_t j=0, off=0; j<blocks; ++j, off += SAMPLE_COMPACT_BLOCK_SIZE)
+                    encode_block(&dst[off], &scale[j], &src[off], lsp_min(size_t(SAMPLE_COMPACT_BLOCK_SIZE), nMaxLength - off));
+            }
+
+            // Replace the floating-point data, the waveform overview requires it
+            drop_peaks();
+            release_buffer();
+
+            vCompact            = vc;
+            vScale              = vs;
+            nBlocks             = blocks;
+            pCompact            = data;
+
+            return STATUS_OK;
+        }
+
+        status_t Sample::expand()
+        {
+            if (pCompact == NULL)
+                return (vBuffer != NULL) ? STATUS_OK : STATUS_BAD_STATE;
+
+            float *buf          = static_cast<float *>(pages::alloc(nMaxLength * nChannels * sizeof(float)));
+            if (buf == NULL)
+                return STATUS_NO_MEM;
+
+            for (size_t i=0; i<nChannels; ++i)
+                decode_blocks(&buf[i * nMaxLength], &vCompact[i * nMaxLength], &vScale[i * nBlocks], 0, nMaxLength);
+
+            release_buffer();
+            vBuffer             = buf;
+
+            return STATUS_OK;
+        }
+
+        size_t Sample::read(size_t channel, float *dst, size_t offset, size_t count) const
+        {
+            size_t avail        = ((channel < nChannels) && (offset < nLength)) ? lsp_min(count, nLength - offset) : 0;
+
+            if (avail > 0)
+            {
+                if (pCompact != NULL)
+                    decode_blocks(dst, &vCompact[channel * nMaxLength], &vScale[channel * nBlocks], offset, avail);
+                else
+                    dsp::copy(dst, &vBuffer[channel * nMaxLength + offset], avail);
+            }
+            if (count > avail)
+                dsp::fill_zero(&dst[avail], count - avail);
+
+            return avail;
+        }
+
+        void Sample::sync_peaks()
+        {
+            if (pPeaks == NULL)
+                return;
+            if (build_peaks(nPeaksThreads) != STATUS_OK)
+                drop_peaks();
+        }
+
+        void Sample::update_peaks(size_t first)
+        {
+            if (pPeaks == NULL)
+                return;
+            for (size_t i=0; i<nChannels; ++i)
+                pPeaks->update(i, channel(i), first, nLength);
+        }
+
+        void Sample::drop_peaks()
+        {
+            if (pPeaks == NULL)
+                return;
+            delete pPeaks;
+            pPeaks          = NULL;
+        }
+
+        status_t Sample::overview(size_t channel, float *min, float *max, size_t first, size_t count, size_t width) const
+        {
+            if ((min == NULL) || (max == NULL))
+                return STATUS_BAD_ARGUMENTS;
+            if (channel >= nChannels)
+                return STATUS_INVALID_VALUE;
+            if (vBuffer == NULL)
+                return STATUS_BAD_STATE;
+
+            const float *src    = this->channel(channel);
+            if (pPeaks != NULL)
+            {
+                pPeaks->render(channel, src, min, max, first, count, width);
+                return STATUS_OK;
+            }
+
+            // No waveform overview, scan the sample data
+            if ((first >= nLength) || (count <= 0))
+            {
+                dsp::fill_zero(min, width);
+                dsp::fill_zero(max, width);
+                return STATUS_OK;
+            }
+
+            count               = lsp_min(count, nLength - first);
+            for (size_t i=0; i<width; ++i)
+            {
+                size_t a            = first + (uint64_t(i) * count) / width;
+                size_t b            = first + (uint64_t(i + 1) * count) / width;
+                b                   = lsp_min(lsp_max(b, a + 1), first + count);
+                dsp::minmax(&src[a], b - a, &min[i], &max[i]);
+            }
+
+            return STATUS_OK;
         }
 
         ssize_t Sample::save_range(const char *path, size_t offset, ssize_t count)
@@ -241,7 +514,7 @@ namespace lsp
 
         ssize_t Sample::save_range(mm::IOutAudioStream *out, size_t offset, ssize_t count)
         {
-            if ((nSampleRate <= 0) || (nChannels < 0))
+            if ((nSampleRate <= 0) || (nChannels < 0) || (vBuffer == NULL))
                 return -STATUS_BAD_STATE;
 
             ssize_t avail   = lsp_max(ssize_t(nLength - offset), 0);
@@ -396,18 +669,15 @@ namespace lsp
                 // Read data from input stream
                 size_t to_do    = lsp_min(count, BUFFER_FRAMES);
                 ssize_t nframes = in->read(buf, to_do);
-                if (nframes < 0)
-                    return -nframes;
-
-                // Unpack buffer
-                for (size_t i=0; i<fmt.channels; ++i)
+                if (nframes <= 0)
                 {
-                    const float *src    = &buf[i];
-                    float *dst          = &tmp.vBuffer[i * tmp.nMaxLength + offset];
-                    for (size_t j=0; j<to_do; ++j, src += fmt.channels, ++dst)
-                        *dst    = *src;
+                    free_aligned(data);
+                    return (nframes < 0) ? -nframes : STATUS_EOF;
                 }
 
+                // Unpack buffer
+                unpack_frames(&tmp.vBuffer[offset], tmp.nMaxLength, buf, fmt.channels, nframes);
+
                 // Update position
                 offset         += nframes;
                 count          -= nframes;
@@ -418,366 +688,996 @@ namespace lsp
             tmp.set_sample_rate(fmt.srate);
             tmp.swap(this);
 
+            // Rebuild the waveform overview for the new data
+            lsp::swap(pPeaks, tmp.pPeaks);
+            lsp::swap(nPeaksThreads, tmp.nPeaksThreads);
+            sync_peaks();
+
             return STATUS_OK;
         }
 
         bool Sample::reverse(size_t channel)
         {
-            if (channel >= nChannels)
+            if ((channel >= nChannels) || (vBuffer == NULL))
                 return false;
 
             dsp::reverse1(&vBuffer[channel * nMaxLength], nLength);
+            if (pPeaks != NULL)
+                pPeaks->update(channel, &vBuffer[channel * nMaxLength], 0, nLength);
             return true;
         }
 
         void Sample::reverse()
         {
+            if (vBuffer == NULL)
+                return;
+
             float *dst = vBuffer;
             for (size_t i=0; i<nChannels; ++i)
             {
                 dsp::reverse1(dst, nLength);
                 dst     += nMaxLength;
             }
+            sync_peaks();
         }
 
         void Sample::normalize(float gain, sample_normalize_t mode)
         {
-            if (mode == SAMPLE_NORM_NONE)
-                return;
+            normalize(gain, mode, SAMPLE_MEASURE_PEAK, 1);
+        }
 
-            // Estimate the maximum peak value for each channel
-            float peak  = 0.0f;
-            for (size_t i=0; i<nChannels; ++i)
+        enum resample_job_type_t
+        {
+            RSJ_FILTER,         // Remove frequencies above the new Nyquist frequency
+            RSJ_POLYPHASE,      // Compute output samples using polyphase kernel table
+            RSJ_CONVOLVE        // Convolve source samples with Lanczos kernel
+        };
+
+        typedef struct resample_task_t
+        {
+            Sample         *pSample;        // The sample to resample
+            Sample          sFiltered;      // The sample with removed frequencies above the new Nyquist frequency
+            Sample          sResult;        // Resampled data
+            const Sample   *pSrc;           // Source data for the polyphase filter or convolution
+            bool            bPolyphase;     // Use polyphase filter instead of convolution
+            ssize_t         nSrcStep;       // Number of source samples in the period (M)
+            ssize_t         nDstStep;       // Number of destination samples in the period (L)
+            float           fKf;            // Resampling factor
+            float           fRkf;           // Reciprocal resampling factor
+            ssize_t         nPeriods;       // Number of periods of the kernel
+            ssize_t         nCenter;        // Center of the kernel
+            ssize_t         nLen;           // Length of the kernel
+            ssize_t         nSize;          // Size of the kernel buffer
+            float          *vTable;         // Polyphase kernel table, nDstStep rows of nSize taps
+            uint8_t        *pTableData;     // Allocated data for the kernel table
+            size_t          nChunk;         // Number of samples processed by one job
+            status_t        nStatus;        // Status of the task
+        } resample_task_t;
+
+        typedef struct resample_job_t
+        {
+            resample_task_t    *pTask;      // Task
+            size_t              nType;      // Type of the job
+            size_t              nChannel;   // Channel
+            size_t              nFirst;     // First sample
+            size_t              nLast;      // Last sample (exclusive)
+        } resample_job_t;
+
+        typedef struct resample_batch_t
+        {
+            resample_job_t     *vJobs;      // List of jobs
+            size_t              nJobs;      // Number of jobs
+            atomic_t            nNext;      // Index of the next job to process
+        } resample_batch_t;
+
+        static inline void resample_kernel(float *k, const resample_task_t *t, float dt)
+        {
+            for (ssize_t j=0; j<t->nSize; ++j)
             {
-                float cpeak = dsp::abs_max(channel(i), nLength);
-                peak        = lsp_max(peak, cpeak);
-            }
+                float x         = (j - t->nCenter - dt) * t->fRkf;
 
-            // No peak detected?
-            if (peak < 1e-8)
-                return;
+                if ((x > -t->nPeriods) && (x < t->nPeriods))
+                {
+                    float x2    = M_PI * x;
+                    k[j]        = (x != 0.0f) ? t->nPeriods * sinf(x2) * sinf(x2 / t->nPeriods) / (x2 * x2) : 1.0f;
+                }
+                else
+                    k[j]        = 0.0f;
+            }
+        }
 
-            switch (mode)
+        static void resample_filter(const resample_job_t *job)
+        {
+            resample_task_t *t  = job->pTask;
+            const Sample *s     = t->pSample;
+            Filter flt;
+            filter_params_t fp;
+
+            fp.nType    = FLT_BT_LRX_LOPASS;
+            fp.fFreq    = t->sResult.sample_rate() * 0.475f;
+            fp.fFreq2   = fp.fFreq;
+            fp.fGain    = 1.0f;
+            fp.nSlope   = 4;
+            fp.fQuality = 0.75f;
+
+            if (!flt.init(NULL))
             {
-                case SAMPLE_NORM_BELOW:
-                    if (peak >= gain)
-                        return;
-                    break;
-                case SAMPLE_NORM_ABOVE:
-                    if (peak <= gain)
-                        return;
-                    break;
-                default:
-                    break;
+                t->nStatus  = STATUS_NO_MEM;
+                return;
             }
+            flt.update(s->sample_rate(), &fp);
+            flt.process(t->sFiltered.channel(job->nChannel), s->channel(job->nChannel), s->length());
+            flt.destroy();
+        }
 
-            // Adjust gain
-            float k = gain / peak;
-            for (size_t i=0; i<nChannels; ++i)
-                dsp::mul_k2(channel(i), k, nLength);
+        static void resample_polyphase(const resample_job_t *job)
+        {
+            resample_task_t *t  = job->pTask;
+            const float *src    = t->pSrc->channel(job->nChannel);
+            float *dst          = t->sResult.channel(job->nChannel);
+            ssize_t length      = t->pSrc->length();
+            ssize_t taps        = t->nSize;
+            ssize_t step        = t->nSrcStep / t->nDstStep;
+            ssize_t ph_step     = t->nSrcStep % t->nDstStep;
+
+            // Compute the position of the first output sample in the source
+            wsize_t pos         = wsize_t(job->nFirst) * t->nSrcStep;
+            ssize_t first       = ssize_t(pos / t->nDstStep) - t->nCenter;
+            ssize_t phase       = pos % t->nDstStep;
+
+            for (size_t i=job->nFirst; i<job->nLast; ++i)
+            {
+                const float *k      = &t->vTable[phase * taps];
+                if ((first >= 0) && ((first + taps) <= length))
+                    dst[i]              = dsp::h_dotp(&src[first], k, taps);
+                else
+                {
+                    // The kernel crosses the boundary of the sample
+                    ssize_t head        = lsp_max(-first, ssize_t(0));
+                    ssize_t tail        = lsp_min(length - first, taps);
+                    dst[i]              = (head < tail) ? dsp::h_dotp(&src[first + head], &k[head], tail - head) : 0.0f;
+                }
 
+                // Move to the next output sample
+                first              += step;
+                phase              += ph_step;
+                if (phase >= t->nDstStep)
+                {
+                    phase              -= t->nDstStep;
+                    ++first;
+                }
+            }
         }
 
-        status_t Sample::fast_downsample(Sample *s, size_t new_sample_rate)
+        static void resample_convolve(const resample_job_t *job)
         {
-            size_t rkf          = nSampleRate / new_sample_rate;
-            size_t new_samples  = nLength / rkf;
+            resample_task_t *t  = job->pTask;
+            float *k            = static_cast<float *>(malloc(sizeof(float) * t->nSize));
+            if (k == NULL)
+            {
+                t->nStatus          = STATUS_NO_MEM;
+                return;
+            }
 
-            // Allocate sample
-            if (!s->init(nChannels, new_samples, new_samples))
-                return STATUS_NO_MEM;
-            s->set_sample_rate(new_sample_rate);
+            const float *src    = t->pSrc->channel(job->nChannel);
+            float *dst          = t->sResult.channel(job->nChannel);
+            ssize_t base        = (job->nFirst / t->nSrcStep) * t->nDstStep;
 
-            // Iterate each channel
-            for (size_t c=0; c<nChannels; ++c)
+            // The first sample of the job is always aligned to the period
+            for (ssize_t i=0; i<t->nSrcStep; ++i)
             {
-                const float *src    = &vBuffer[c * nMaxLength];
-                float *dst          = &s->vBuffer[c * new_samples];
+                size_t j        = job->nFirst + i;
+                if (j >= job->nLast)
+                    break;
+
+                // Calculate the offset between nearest samples and generate the kernel
+                ssize_t p       = t->fKf * i;
+                resample_kernel(k, t, i * t->fKf - p);
 
-                for (size_t i=0; i < new_samples; ++i, src += rkf, ++dst)
-                    *dst                = *src;
+                // Perform convolutions
+                for (p += base; j<job->nLast; j += t->nSrcStep, p += t->nDstStep)
+                    dsp::fmadd_k3(&dst[p], k, src[j], t->nSize);
             }
 
-            return STATUS_OK;
+            free(k);
         }
 
-        status_t Sample::fast_upsample(Sample *s, size_t new_sample_rate)
+        static void resample_jobs(void *arg)
         {
-            // Calculate parameters of transformation
-            ssize_t kf          = new_sample_rate / nSampleRate;
-            float rkf           = 1.0f / kf;
+            resample_batch_t *batch = static_cast<resample_batch_t *>(arg);
+            while (true)
+            {
+                size_t idx      = atomic_add(&batch->nNext, 1);
+                if (idx >= batch->nJobs)
+                    break;
 
-            // Prepare kernel for resampling
-            ssize_t k_periods   = RESAMPLING_PERIODS; // * (kf >> 1);
-            ssize_t k_base      = k_periods * kf;
-            ssize_t k_center    = k_base + 1;
-            ssize_t k_len       = (k_center << 1) + 1;
-            ssize_t k_size      = align_size(k_len + 1, 4); // Additional sample for time offset
-            float *k            = static_cast<float *>(malloc(sizeof(float) * k_size));
-            if (k == NULL)
-                return STATUS_NO_MEM;
+                const resample_job_t *job = &batch->vJobs[idx];
+                switch (job->nType)
+                {
+                    case RSJ_FILTER:    resample_filter(job);   break;
+                    case RSJ_POLYPHASE: resample_polyphase(job); break;
+                    case RSJ_CONVOLVE:  resample_convolve(job); break;
+                    default: break;
+                }
+            }
+        }
 
-            // Estimate resampled sample size
-            size_t new_samples  = kf * nLength;
-            size_t b_len        = new_samples + k_size;
+        static void resample_run(resample_batch_t *batch, size_t threads)
+        {
+            batch->nNext        = 0;
+            batch_run(resample_jobs, batch, batch->nJobs, threads);
+        }
 
-            // Prepare new data structure to store resampled data
-            if (!s->init(nChannels, b_len, b_len))
-            {
-                free(k);
-                return STATUS_NO_MEM;
-            }
-            s->set_sample_rate(new_sample_rate);
+        static status_t resample_prepare(resample_task_t *t, Sample *s, size_t new_sample_rate)
+        {
+            size_t src_rate     = s->sample_rate();
+            size_t channels     = s->channels();
+            size_t length       = s->length();
 
-            // Generate Lanczos kernel
-            for (ssize_t j=0; j<k_size; ++j)
+            t->pSample          = s;
+            t->pSrc             = s;
+            t->bPolyphase       = false;
+            t->vTable           = NULL;
+            t->pTableData       = NULL;
+            t->nStatus          = STATUS_OK;
+
+            // Calculate parameters of transformation
+            ssize_t gcd         = gcd_euclid(new_sample_rate, src_rate);
+            t->nSrcStep         = src_rate / gcd;
+            t->nDstStep         = new_sample_rate / gcd;
+            t->fKf              = float(t->nDstStep) / float(t->nSrcStep);
+            t->fRkf             = float(t->nSrcStep) / float(t->nDstStep);
+
+            if (t->nDstStep <= RESAMPLING_MAX_PHASES)
             {
-                float t         = (j - k_center) * rkf;
+                // Lanczos kernel for each of L phases, the cutoff frequency is lowered to the
+                // new Nyquist frequency when down-sampling, so no additional filtering is required
+                float fc            = (new_sample_rate < src_rate) ? RESAMPLING_CUTOFF * t->fKf : 1.0f;
+                ssize_t half        = ceilf(RESAMPLING_PERIODS / fc);
+                t->bPolyphase       = true;
+                t->nPeriods         = RESAMPLING_PERIODS;
+                t->nCenter          = half - 1;
+                t->nSize            = half * 2;
+                t->nLen             = 0;
+
+                t->vTable           = alloc_aligned<float>(t->pTableData, t->nDstStep * t->nSize);
+                if (t->vTable == NULL)
+                    return STATUS_NO_MEM;
 
-                if ((t > -k_periods) && (t < k_periods))
+                for (ssize_t i=0; i<t->nDstStep; ++i)
                 {
-                    float t2    = M_PI * t;
-                    k[j]        = (t != 0) ? k_periods * sinf(t2) * sinf(t2 / k_periods) / (t2 * t2) : 1.0f;
+                    float *k        = &t->vTable[i * t->nSize];
+                    float dt        = float(i) / float(t->nDstStep);
+                    float sum       = 0.0f;
+
+                    for (ssize_t j=0; j<t->nSize; ++j)
+                    {
+                        float x         = (j - t->nCenter - dt) * fc;
+
+                        if ((x > -t->nPeriods) && (x < t->nPeriods))
+                        {
+                            float x2    = M_PI * x;
+                            k[j]        = (x != 0.0f) ? t->nPeriods * sinf(x2) * sinf(x2 / t->nPeriods) / (x2 * x2) : 1.0f;
+                        }
+                        else
+                            k[j]        = 0.0f;
+                        sum        += k[j];
+                    }
+
+                    // Normalize the phase to unity gain
+                    if (sum != 0.0f)
+                        dsp::mul_k2(k, 1.0f / sum, t->nSize);
                 }
-                else
-                    k[j]        = 0.0f;
+
+                size_t new_samples  = (wsize_t(length) * t->nDstStep + t->nSrcStep - 1) / t->nSrcStep;
+                if (!t->sResult.init(channels, new_samples, new_samples))
+                    return STATUS_NO_MEM;
+                t->sResult.set_sample_rate(new_sample_rate);
+                t->nChunk           = RESAMPLING_CHUNK;
+
+                return STATUS_OK;
             }
 
-            // Iterate each channel
-            for (size_t c=0; c<nChannels; ++c)
+            // Too many phases, convolve each source sample with Lanczos kernel,
+            // remove all frequencies above new nyquist frequency before down-sampling
+            if (new_sample_rate < src_rate)
             {
-                const float *src    = &vBuffer[c * nMaxLength];
-                float *dst          = &s->vBuffer[c * s->nMaxLength];
-
-                // Perform convolutions
-                for (size_t i=0, p=0; i<nLength; i++, p += kf)
-                    dsp::fmadd_k3(&dst[p], k, src[i], k_size);
+                if (!t->sFiltered.init(channels, length, length))
+                    return STATUS_NO_MEM;
+                t->sFiltered.set_sample_rate(src_rate);
+                t->pSrc             = &t->sFiltered;
+            }
 
-                dsp::move(dst, &dst[k_center], s->nLength - k_center);
+            // Prepare kernel for resampling
+            if (new_sample_rate > src_rate)
+            {
+                t->nPeriods         = RESAMPLING_PERIODS; // Number of periods
+                ssize_t k_base      = t->nPeriods * t->fKf;
+                t->nCenter          = k_base + 1;
+                t->nLen             = (t->nCenter << 1) + 1; // Centered impulse response
             }
+            else
+            {
+                ssize_t k_base      = RESAMPLING_PERIODS;
+                t->nPeriods         = k_base * t->fRkf; // Number of periods
+                t->nCenter          = k_base + 1;
+                t->nLen             = (t->nCenter << 1) + t->fRkf + 1; // Centered impulse response
+            }
+            t->nSize            = align_size(t->nLen + 1, 4); // Additional sample for time offset
 
-            // Delete temporary buffer and decrease length of sample
-            free(k);
-            s->nLength -= k_len;
+            // Prepare new data structure to store resampled data
+            size_t new_samples  = t->fKf * length;
+            size_t b_len        = new_samples + t->nSize;
+            if (!t->sResult.init(channels, b_len, b_len))
+                return STATUS_NO_MEM;
+            t->sResult.set_sample_rate(new_sample_rate);
+
+            // The chunk should be aligned to the period. Jobs for even and odd chunks are
+            // performed in separate passes, so the output of each chunk should be long
+            // enough to prevent overlapping with the output of the next chunk of the same pass
+            size_t chunk        = align_size(RESAMPLING_CHUNK, t->nSrcStep);
+            while ((chunk * t->fKf) < (t->nSize * 2))
+                chunk              += t->nSrcStep;
+            t->nChunk           = chunk;
 
             return STATUS_OK;
         }
 
-        status_t Sample::complex_upsample(Sample *s, size_t new_sample_rate)
+        static void resample_complete(resample_task_t *t)
         {
-            // Calculate parameters of transformation
-            ssize_t gcd         = gcd_euclid(new_sample_rate, nSampleRate);
-            ssize_t src_step    = nSampleRate / gcd;
-            ssize_t dst_step    = new_sample_rate / gcd;
-            float kf            = float(dst_step) / float(src_step);
-            float rkf           = float(src_step) / float(dst_step);
+            if (!t->bPolyphase)
+            {
+                // Remove the head of the kernel and decrease length of sample
+                size_t length   = t->sResult.length();
+                for (size_t c=0, n=t->sResult.channels(); c<n; ++c)
+                {
+                    float *dst      = t->sResult.channel(c);
+                    dsp::move(dst, &dst[t->nCenter], length - t->nCenter);
+                }
+                t->sResult.set_length(length - t->nLen);
+            }
 
-            // Prepare kernel for resampling
-            ssize_t k_periods   = RESAMPLING_PERIODS; // Number of periods
-            ssize_t k_base      = k_periods * kf;
-            ssize_t k_center    = k_base + 1;
-            ssize_t k_len       = (k_center << 1) + 1; // Centered impulse response
-            ssize_t k_size      = align_size(k_len + 1, 4); // Additional sample for time offset
-            float *k            = static_cast<float *>(malloc(sizeof(float) * k_size));
-            if (k == NULL)
-                return STATUS_NO_MEM;
+            // Replace content
+            t->sResult.swap(t->pSample);
+        }
 
-            // Estimate resampled sample size
-            size_t new_samples  = kf * nLength;
-            size_t b_len        = new_samples + k_size;
+        static size_t resample_add_jobs(resample_job_t *jobs, resample_task_t *t, size_t type, size_t length, size_t chunk, size_t first, size_t step)
+        {
+            size_t n            = 0;
+            for (size_t c=0, channels=t->pSample->channels(); c<channels; ++c)
+            {
+                for (size_t off = first * chunk; off < length; off += step * chunk)
+                {
+                    resample_job_t *job = &jobs[n++];
+                    job->pTask          = t;
+                    job->nType          = type;
+                    job->nChannel       = c;
+                    job->nFirst         = off;
+                    job->nLast          = lsp_min(off + chunk, length);
+                }
+            }
+            return n;
+        }
 
-            // Prepare new data structure to store resampled data
-            if (!s->init(nChannels, b_len, b_len))
+        status_t Sample::resample(Sample * const *samples, size_t count, size_t new_sample_rate, size_t threads)
+        {
+            if ((samples == NULL) || (new_sample_rate <= 0))
+                return STATUS_BAD_ARGUMENTS;
+            for (size_t i=0; i<count; ++i)
             {
-                free(k);
+                if ((samples[i] == NULL) || (samples[i]->nChannels <= 0) || (samples[i]->vBuffer == NULL))
+                    return STATUS_BAD_STATE;
+            }
+            threads             = lsp_max(threads, size_t(1));
+
+            // Prepare tasks
+            resample_task_t *tasks  = new resample_task_t[count];
+            if (tasks == NULL)
                 return STATUS_NO_MEM;
+
+            status_t res        = STATUS_OK;
+            size_t n_tasks      = 0;
+            size_t n_jobs       = 0;
+            for (size_t i=0; i<count; ++i)
+            {
+                Sample *s           = samples[i];
+                if (s->nSampleRate == new_sample_rate)
+                    continue;
+
+                resample_task_t *t  = &tasks[n_tasks++];
+                if ((res = resample_prepare(t, s, new_sample_rate)) != STATUS_OK)
+                    break;
+
+                size_t length       = (t->bPolyphase) ? t->sResult.length() : s->nLength;
+                n_jobs             += s->nChannels * (((length + t->nChunk - 1) / t->nChunk) + 1);
             }
-            s->set_sample_rate(new_sample_rate);
 
-            // Iterate each channel
-            for (size_t c=0; c<nChannels; ++c)
+            resample_batch_t batch;
+            batch.vJobs         = NULL;
+            if ((res == STATUS_OK) && (n_tasks > 0))
             {
-                const float *src    = &vBuffer[c * nMaxLength];
-                float *dst          = &s->vBuffer[c * s->nMaxLength];
+                batch.vJobs         = static_cast<resample_job_t *>(malloc(sizeof(resample_job_t) * n_jobs));
+                if (batch.vJobs == NULL)
+                    res                 = STATUS_NO_MEM;
+            }
 
-                for (ssize_t i=0; i<src_step; ++i)
+            if ((res == STATUS_OK) && (n_tasks > 0))
+            {
+                // Pass 1: filter the channels of down-sampled samples
+                batch.nJobs         = 0;
+                for (size_t i=0; i<n_tasks; ++i)
                 {
-                    // calculate the offset between nearest samples
-                    ssize_t p       = kf * i;
-                    float dt        = i*kf - p;
+                    resample_task_t *t  = &tasks[i];
+                    if (t->pSrc == t->pSample)
+                        continue;
+                    batch.nJobs        += resample_add_jobs(&batch.vJobs[batch.nJobs], t, RSJ_FILTER,
+                            1, 1, 0, 1);
+                }
+                resample_run(&batch, threads);
 
-                    // Generate Lanczos kernel
-                    for (ssize_t j=0; j<k_size; ++j)
+                // Pass 2: apply polyphase filter and convolve even chunks,
+                // pass 3: convolve odd chunks
+                for (size_t pass=0; pass<2; ++pass)
+                {
+                    batch.nJobs         = 0;
+                    for (size_t i=0; i<n_tasks; ++i)
                     {
-                        float t         = (j - k_center - dt) * rkf;
+                        resample_task_t *t  = &tasks[i];
+                        if (t->nStatus != STATUS_OK)
+                            continue;
 
-                        if ((t > -k_periods) && (t < k_periods))
+                        if (t->bPolyphase)
                         {
-                            float t2    = M_PI * t;
-                            k[j]        = (t != 0.0f) ? k_periods * sinf(t2) * sinf(t2 / k_periods) / (t2 * t2) : 1.0f;
+                            if (pass == 0)
+                                batch.nJobs    += resample_add_jobs(&batch.vJobs[batch.nJobs], t, RSJ_POLYPHASE,
+                                        t->sResult.length(), t->nChunk, 0, 1);
                         }
                         else
-                            k[j]        = 0.0f;
+                            batch.nJobs    += resample_add_jobs(&batch.vJobs[batch.nJobs], t, RSJ_CONVOLVE,
+                                    t->pSample->nLength, t->nChunk, pass, 2);
                     }
+                    resample_run(&batch, threads);
+                }
 
-                    // Perform convolutions
-                    for (size_t j=i; j<nLength; j += src_step)
+                // Commit the results
+                for (size_t i=0; i<n_tasks; ++i)
+                {
+                    resample_task_t *t  = &tasks[i];
+                    if (t->nStatus != STATUS_OK)
                     {
-                        dsp::fmadd_k3(&dst[p], k, src[j], k_size);
-                        p   += dst_step;
+                        if (res == STATUS_OK)
+                            res                 = t->nStatus;
+                        continue;
                     }
+
+                    // Replace content, the waveform overview stays with the sample
+                    resample_complete(t);
+                    Sample *s           = t->pSample;
+                    lsp::swap(s->pPeaks, t->sResult.pPeaks);
+                    lsp::swap(s->nPeaksThreads, t->sResult.nPeaksThreads);
+                    s->sync_peaks();
                 }
+            }
+
+            if (batch.vJobs != NULL)
+                free(batch.vJobs);
+            for (size_t i=0; i<n_tasks; ++i)
+                free_aligned(tasks[i].pTableData);
+            delete [] tasks;
 
-                // Copy the data to the file content
-                dsp::move(dst, &dst[k_center], s->nLength - k_center);
+            return res;
+        }
+
+        status_t Sample::resample(size_t new_sample_rate, size_t threads)
+        {
+            Sample *s = this;
+            return resample(&s, 1, new_sample_rate, threads);
+        }
+
+        typedef struct measure_task_t
+        {
+            const Sample       *pSample;        // The sample to measure
+            sample_measure_t    enMeasure;      // Measure
+            size_t              nBlockSize;     // Size of loudness sub-block
+            size_t              nBlocks;        // Number of complete loudness sub-blocks
+            float              *vEnergy;        // Sub-block energies, nBlocks per channel
+            dsp::biquad_x1_t    vFilters[LOUDNESS_K_FILTERS];   // K-weighting filter
+        } measure_task_t;
+
+        typedef struct measure_job_t
+        {
+            measure_task_t     *pTask;          // Task
+            size_t              nChannel;       // Channel
+            size_t              nFirst;         // First sample
+            size_t              nLast;          // Last sample (exclusive)
+            double              fValue;         // Peak value or sum of squares
+            status_t            nStatus;        // Status of the job
+        } measure_job_t;
+
+        typedef struct measure_batch_t
+        {
+            measure_job_t      *vJobs;          // List of jobs
+            size_t              nJobs;          // Number of jobs
+            atomic_t            nNext;          // Index of the next job to process
+        } measure_batch_t;
+
+        static void measure_loudness(measure_job_t *job)
+        {
+            measure_task_t *t   = job->pTask;
+            const float *src    = t->pSample->channel(job->nChannel);
+            float *energy       = &t->vEnergy[job->nChannel * t->nBlocks];
+            float buf[MEASURE_BUF_SIZE];
+
+            FilterBank bank;
+            if (!bank.init(LOUDNESS_K_FILTERS))
+            {
+                job->nStatus        = STATUS_NO_MEM;
+                return;
             }
+            bank.begin();
+            for (size_t i=0; i<LOUDNESS_K_FILTERS; ++i)
+            {
+                dsp::biquad_x1_t *f = bank.add_chain();
+                if (f != NULL)
+                    *f                  = t->vFilters[i];
+            }
+            bank.end(true);
 
-            // Delete temporary buffer and decrease length of sample
-            free(k);
-            s->nLength -= k_len;
+            // Let the filter settle on the preceding sub-block, the error caused by
+            // the missing history is far below the resolution of the measurement
+            for (size_t off=(job->nFirst > t->nBlockSize) ? job->nFirst - t->nBlockSize : 0; off < job->nFirst; )
+            {
+                size_t to_do        = lsp_min(job->nFirst - off, size_t(MEASURE_BUF_SIZE));
+                bank.process(buf, &src[off], to_do);
+                off                += to_do;
+            }
 
-            return STATUS_OK;
+            // Measure the energy of sub-blocks, the tail after the last sub-block
+            // contributes to the overall energy only
+            size_t block        = job->nFirst / t->nBlockSize;
+            size_t count        = job->nFirst - block * t->nBlockSize;
+            double sum          = 0.0;
+            double total        = 0.0;
+            for (size_t off=job->nFirst; off < job->nLast; )
+            {
+                size_t to_do        = lsp_min(job->nLast - off, size_t(MEASURE_BUF_SIZE));
+                if (block < t->nBlocks)
+                    to_do               = lsp_min(to_do, t->nBlockSize - count);
+
+                bank.process(buf, &src[off], to_do);
+                float s             = dsp::h_sqr_sum(buf, to_do);
+                sum                += s;
+                total              += s;
+                count              += to_do;
+                off                += to_do;
+
+                if ((block < t->nBlocks) && (count >= t->nBlockSize))
+                {
+                    energy[block++]     = sum / t->nBlockSize;
+                    sum                 = 0.0;
+                    count               = 0;
+                }
+            }
+
+            job->fValue         = total;
         }
 
-        status_t Sample::complex_downsample(Sample *s, size_t new_sample_rate)
+        static void measure_jobs(void *arg)
         {
-            // Calculate parameters of transformation
-            ssize_t gcd         = gcd_euclid(new_sample_rate, nSampleRate);
-            ssize_t src_step    = nSampleRate / gcd;
-            ssize_t dst_step    = new_sample_rate / gcd;
-            float kf            = float(dst_step) / float(src_step);
-            float rkf           = float(src_step) / float(dst_step);
+            measure_batch_t *batch  = static_cast<measure_batch_t *>(arg);
+            while (true)
+            {
+                size_t idx      = atomic_add(&batch->nNext, 1);
+                if (idx >= batch->nJobs)
+                    break;
 
-            // Prepare kernel for resampling
-            ssize_t k_base      = RESAMPLING_PERIODS;
-            ssize_t k_periods   = k_base * rkf; // Number of periods
-            ssize_t k_center    = k_base + 1;
-            ssize_t k_len       = (k_center << 1) + rkf + 1; // Centered impulse response
-            ssize_t k_size      = align_size(k_len + 1, 4); // Additional sample for time offset
-            float *k            = static_cast<float *>(malloc(sizeof(float) * k_size));
-            if (k == NULL)
-                return STATUS_NO_MEM;
+                measure_job_t *job  = &batch->vJobs[idx];
+                const float *src    = &job->pTask->pSample->channel(job->nChannel)[job->nFirst];
+                size_t count        = job->nLast - job->nFirst;
 
-            // Estimate resampled sample size
-            size_t new_samples  = kf * nLength;
-            size_t b_len        = new_samples + k_size;
+                switch (job->pTask->enMeasure)
+                {
+                    case SAMPLE_MEASURE_PEAK:   job->fValue = dsp::abs_max(src, count); break;
+                    case SAMPLE_MEASURE_RMS:    job->fValue = dsp::h_sqr_sum(src, count); break;
+                    case SAMPLE_MEASURE_LUFS:   measure_loudness(job); break;
+                    default: break;
+                }
+            }
+        }
 
-            // Prepare new data structure to store resampled data
-            if (!s->init(nChannels, b_len, b_len))
+        status_t Sample::measure(float *level, sample_measure_t measure, size_t threads) const
+        {
+            if (level == NULL)
+                return STATUS_BAD_ARGUMENTS;
+            if ((nChannels <= 0) || (vBuffer == NULL))
+                return STATUS_BAD_STATE;
+            if ((measure == SAMPLE_MEASURE_LUFS) && (nSampleRate <= 0))
+                return STATUS_BAD_STATE;
+            threads             = lsp_max(threads, size_t(1));
+
+            *level              = 0.0f;
+            if (nLength <= 0)
+                return STATUS_OK;
+
+            // Prepare the task, loudness is measured by chunks aligned to the sub-blocks
+            LoudnessMeter meter;
+            measure_task_t task;
+            task.pSample        = this;
+            task.enMeasure      = measure;
+            task.nBlockSize     = 0;
+            task.nBlocks        = 0;
+            task.vEnergy        = NULL;
+
+            size_t chunk        = MEASURE_CHUNK;
+            if (measure == SAMPLE_MEASURE_LUFS)
+            {
+                if (!meter.init(1))
+                    return STATUS_NO_MEM;
+                meter.set_sample_rate(nSampleRate);
+                LoudnessMeter::k_weighting(task.vFilters, nSampleRate);
+
+                task.nBlockSize     = meter.block_size();
+                task.nBlocks        = nLength / task.nBlockSize;
+                chunk               = task.nBlockSize * MEASURE_CHUNK_BLOCKS;
+                if (task.nBlocks > 0)
+                {
+                    task.vEnergy        = static_cast<float *>(malloc(sizeof(float) * task.nBlocks * nChannels));
+                    if (task.vEnergy == NULL)
+                        return STATUS_NO_MEM;
+                }
+            }
+
+            // Prepare jobs
+            size_t chunks       = (nLength + chunk - 1) / chunk;
+            measure_batch_t batch;
+            batch.nJobs         = chunks * nChannels;
+            batch.nNext         = 0;
+            batch.vJobs         = static_cast<measure_job_t *>(malloc(sizeof(measure_job_t) * batch.nJobs));
+            if (batch.vJobs == NULL)
             {
-                free(k);
+                free(task.vEnergy);
                 return STATUS_NO_MEM;
             }
-            s->set_sample_rate(new_sample_rate);
 
-            // Iterate each channel
-            for (size_t c=0; c<nChannels; ++c)
+            for (size_t i=0; i<nChannels; ++i)
+            {
+                for (size_t j=0; j<chunks; ++j)
+                {
+                    measure_job_t *job  = &batch.vJobs[i * chunks + j];
+                    job->pTask          = &task;
+                    job->nChannel       = i;
+                    job->nFirst         = j * chunk;
+                    job->nLast          = lsp_min(job->nFirst + chunk, nLength);
+                    job->fValue         = 0.0;
+                    job->nStatus        = STATUS_OK;
+                }
+            }
+
+            batch_run(measure_jobs, &batch, batch.nJobs, threads);
+
+            // Combine the results
+            status_t res        = STATUS_OK;
+            double value        = 0.0;
+            for (size_t i=0; i<batch.nJobs; ++i)
             {
-                const float *src    = &vBuffer[c * nMaxLength];
-                float *dst          = &s->vBuffer[c * s->nMaxLength];
+                const measure_job_t *job = &batch.vJobs[i];
+                if (job->nStatus != STATUS_OK)
+                    res                 = job->nStatus;
+                else if (measure == SAMPLE_MEASURE_PEAK)
+                    value               = lsp_max(value, job->fValue);
+                else
+                    value              += job->fValue;
+            }
 
-                for (ssize_t i=0; i<src_step; ++i)
+            if (res == STATUS_OK)
+            {
+                switch (measure)
                 {
-                    // calculate the offset between nearest samples
-                    ssize_t p       = kf * i;
-                    float dt        = i*kf - p; // Always positive, in range of [0..1]
+                    case SAMPLE_MEASURE_PEAK:
+                        *level              = value;
+                        break;
 
-                    // Generate Lanczos kernel
-                    for (ssize_t j=0; j<k_size; ++j)
-                    {
-                        float t         = (j - k_center - dt) * rkf;
+                    case SAMPLE_MEASURE_RMS:
+                        *level              = sqrt(value / (nLength * nChannels));
+                        break;
 
-                        if ((t > -k_periods) && (t < k_periods))
+                    case SAMPLE_MEASURE_LUFS:
+                    {
+                        // Gate the sum of channel energies, samples shorter than the gating
+                        // block are measured as a single block without gating
+                        float lufs          = LOUDNESS_MIN;
+                        if (task.nBlocks >= LOUDNESS_MOMENTARY_BLOCKS)
                         {
-                            float t2    = M_PI * t;
-                            k[j]        = (t != 0.0f) ? k_periods * sinf(t2) * sinf(t2 / k_periods) / (t2 * t2) : 1.0f;
+                            for (size_t i=1; i<nChannels; ++i)
+                                dsp::add2(task.vEnergy, &task.vEnergy[i * task.nBlocks], task.nBlocks);
+                            meter.append(task.vEnergy, task.nBlocks);
+                            lufs                = meter.integrated();
                         }
-                        else
-                            k[j]        = 0.0f;
-                    }
+                        else if (value > 0.0)
+                            lufs                = -0.691 + 10.0 * log10(value / nLength);
 
-                    // Perform convolutions
-                    for (size_t j=i; j<nLength; j += src_step)
-                    {
-                        dsp::fmadd_k3(&dst[p], k, src[j], k_size);
-                        p   += dst_step;
+                        *level              = (lufs > LOUDNESS_MIN) ? expf(lufs * M_LN10 / 20.0f) : 0.0f;
+                        break;
                     }
-                }
 
-                // Copy the data to the file content
-                dsp::move(dst, &dst[k_center], s->nLength - k_center);
+                    default:
+                        res                 = STATUS_BAD_ARGUMENTS;
+                        break;
+                }
             }
 
-            // Delete temporary buffer and decrease length of sample
-            free(k);
-            s->nLength -= k_len;
+            free(batch.vJobs);
+            free(task.vEnergy);
 
-            return STATUS_OK;
+            return res;
         }
 
-        status_t Sample::resample(size_t new_sample_rate)
+        typedef struct peaks_batch_t
         {
-            if (nChannels <= 0)
-                return STATUS_BAD_STATE;
+            const Sample       *pSample;        // The sample to build the overview
+            SamplePeaks        *pPeaks;         // Waveform overview
+            size_t              nJobs;          // Number of jobs, one per channel
+            atomic_t            nNext;          // Index of the next job to process
+        } peaks_batch_t;
 
-            Sample tmp;
-            status_t res    = STATUS_OK;
-
-            // Check that resampling is actually needed
-            if (new_sample_rate > nSampleRate)
+        static void peaks_jobs(void *arg)
+        {
+            peaks_batch_t *batch    = static_cast<peaks_batch_t *>(arg);
+            while (true)
             {
-                // Need to up-sample data
-                res = ((new_sample_rate % nSampleRate) == 0) ?
-                        fast_upsample(&tmp, new_sample_rate) :
-                        complex_upsample(&tmp, new_sample_rate);
+                size_t idx      = atomic_add(&batch->nNext, 1);
+                if (idx >= batch->nJobs)
+                    break;
+
+                batch->pPeaks->update(idx, batch->pSample->channel(idx), 0, batch->pSample->length());
             }
-            else if (new_sample_rate < nSampleRate)
-            {
-                // Step 1: prepare temporary sample and filter
-                Sample ff;
-                Filter flt;
-                filter_params_t fp;
+        }
 
-                fp.nType    = FLT_BT_LRX_LOPASS;
-                fp.fFreq    = new_sample_rate * 0.475f;
-                fp.fFreq2   = fp.fFreq;
-                fp.fGain    = 1.0f;
-                fp.nSlope   = 4;
-                fp.fQuality = 0.75f;
+        status_t Sample::build_peaks(size_t threads)
+        {
+            if ((vBuffer == NULL) || (nChannels <= 0))
+                return STATUS_BAD_STATE;
+            threads             = lsp_max(threads, size_t(1));
 
-                if (!flt.init(NULL))
+            // Reuse the overview if it matches the layout of the sample
+            SamplePeaks *peaks  = pPeaks;
+            if ((peaks == NULL) || (peaks->channels() != nChannels) || (peaks->max_length() != nMaxLength))
+            {
+                peaks               = new SamplePeaks();
+                if (peaks == NULL)
                     return STATUS_NO_MEM;
-                if (!ff.init(nChannels, nLength, nLength))
+                if (!peaks->init(nChannels, nMaxLength))
+                {
+                    delete peaks;
                     return STATUS_NO_MEM;
+                }
+            }
 
-                ff.set_sample_rate(nSampleRate);
-                flt.update(nSampleRate, &fp);
+            // Channels are processed in parallel
+            peaks_batch_t batch;
+            batch.pSample       = this;
+            batch.pPeaks        = peaks;
+            batch.nJobs         = nChannels;
+            batch.nNext         = 0;
+            batch_run(peaks_jobs, &batch, batch.nJobs, threads);
 
-                // Step 2: remove all frequencies above new nyquist frequency
-                for (size_t c=0; c<nChannels; ++c)
-                {
-                    const float *src    = &vBuffer[c * nMaxLength];
-                    float *dst          = &ff.vBuffer[c * ff.nMaxLength];
-                    flt.clear();
-                    flt.process(dst, src, nLength);
-                }
+            if (peaks != pPeaks)
+            {
+                drop_peaks();
+                pPeaks              = peaks;
+            }
+            nPeaksThreads       = threads;
+
+            return STATUS_OK;
+        }
+
+        status_t Sample::normalize(float gain, sample_normalize_t mode, sample_measure_t measure, size_t threads)
+        {
+            if (mode == SAMPLE_NORM_NONE)
+                return STATUS_OK;
+
+            // Estimate the level of all channels
+            float level = 0.0f;
+            status_t res = this->measure(&level, measure, threads);
+            if (res != STATUS_OK)
+                return res;
 
-                // Need to down-sample data of the pre-filtered sample
-                res = ((nSampleRate % new_sample_rate) == 0) ?
-                        ff.fast_downsample(&tmp, new_sample_rate) :
-                        ff.complex_downsample(&tmp, new_sample_rate);
+            // No signal detected?
+            if (level < 1e-8)
+                return STATUS_OK;
+
+            switch (mode)
+            {
+                case SAMPLE_NORM_BELOW:
+                    if (level >= gain)
+                        return STATUS_OK;
+                    break;
+                case SAMPLE_NORM_ABOVE:
+                    if (level <= gain)
+                        return STATUS_OK;
+                    break;
+                default:
+                    break;
             }
-            else
-                return STATUS_OK; // Sample rate matches
 
-            // Replace content
+            // Adjust gain
+            float k = gain / level;
+            for (size_t i=0; i<nChannels; ++i)
+                dsp::mul_k2(channel(i), k, nLength);
+            sync_peaks();
+
+            return STATUS_OK;
+        }
+
+        status_t Sample::cache_path(io::Path *dst, const io::Path *dir, const io::Path *source, size_t sample_rate)
+        {
+            file_identity_t id;
+            status_t res = file_identity(&id, source);
+            if (res != STATUS_OK)
+                return res;
+
+            uint64_t key    = source_hash(source);
+            key             = (key ^ id.size) * 0x100000001b3ULL;
+            key             = (key ^ id.mtime) * 0x100000001b3ULL;
+
+            return (dst->fmt("%s/%08x%08x-%d.smpc", dir->as_utf8(),
+                    uint32_t(key >> 32), uint32_t(key), int(sample_rate)) > 0) ? STATUS_OK : STATUS_NO_MEM;
+        }
+
+        status_t Sample::save_cache(const char *path, const char *source) const
+        {
+            io::Path p, s;
+            status_t res = p.set(path);
+            if (res == STATUS_OK)
+                res = s.set(source);
+            return (res == STATUS_OK) ? save_cache(&p, &s) : res;
+        }
+
+        status_t Sample::save_cache(const LSPString *path, const LSPString *source) const
+        {
+            io::Path p, s;
+            status_t res = p.set(path);
+            if (res == STATUS_OK)
+                res = s.set(source);
+            return (res == STATUS_OK) ? save_cache(&p, &s) : res;
+        }
+
+        status_t Sample::save_cache(const io::Path *path, const io::Path *source) const
+        {
+            if ((vBuffer == NULL) || (nChannels <= 0) || (nSampleRate <= 0))
+                return STATUS_BAD_STATE;
+
+            file_identity_t id;
+            status_t res = file_identity(&id, source);
+            if (res != STATUS_OK)
+                return res;
+
+            sample_cache_header_t hdr;
+            memcpy(hdr.signature, sample_cache_signature, sizeof(hdr.signature));
+            hdr.version         = SAMPLE_CACHE_VERSION;
+            hdr.byte_order      = SAMPLE_CACHE_BYTE_ORDER;
+            hdr.channels        = nChannels;
+            hdr.sample_rate     = nSampleRate;
+            hdr.length          = nLength;
+            hdr.max_length      = nMaxLength;
+            hdr.src_size        = id.size;
+            hdr.src_mtime       = id.mtime;
+            hdr.src_hash        = source_hash(source);
+
+            io::OutFileStream ofs;
+            if ((res = ofs.open(path, io::File::FM_WRITE_NEW)) != STATUS_OK)
+                return res;
+
+            // Write the header and the whole buffer
+            size_t to_write     = nChannels * nMaxLength * sizeof(float);
+            ssize_t n           = ofs.write(&hdr, sizeof(hdr));
+            if (n == ssize_t(sizeof(hdr)))
+                n                   = ofs.write(vBuffer, to_write);
+            res                 = (n < 0) ? status_t(-n) :
+                                  (size_t(n) == to_write) ? STATUS_OK : STATUS_IO_ERROR;
+
+            status_t res2       = ofs.close();
+            return (res == STATUS_OK) ? res2 : res;
+        }
+
+        status_t Sample::load_cache(const char *path, const char *source, size_t sample_rate)
+        {
+            io::Path p, s;
+            status_t res = p.set(path);
+            if (res == STATUS_OK)
+                res = s.set(source);
+            return (res == STATUS_OK) ? load_cache(&p, &s, sample_rate) : res;
+        }
+
+        status_t Sample::load_cache(const LSPString *path, const LSPString *source, size_t sample_rate)
+        {
+            io::Path p, s;
+            status_t res = p.set(path);
             if (res == STATUS_OK)
-                tmp.swap(this);
+                res = s.set(source);
+            return (res == STATUS_OK) ? load_cache(&p, &s, sample_rate) : res;
+        }
+
+        status_t Sample::load_cache(const io::Path *path, const io::Path *source, size_t sample_rate)
+        {
+            file_identity_t id;
+            status_t res = file_identity(&id, source);
+            if (res != STATUS_OK)
+                return res;
+
+            mapped_file_t f;
+            if (map_file(&f, path, true) != STATUS_OK)
+                return STATUS_NOT_FOUND;
+
+            // Validate the header
+            const sample_cache_header_t *hdr = reinterpret_cast<const sample_cache_header_t *>(f.data);
+            if ((f.size < sizeof(sample_cache_header_t)) ||
+                (memcmp(hdr->signature, sample_cache_signature, sizeof(hdr->signature)) != 0) ||
+                (hdr->version != SAMPLE_CACHE_VERSION) ||
+                (hdr->byte_order != SAMPLE_CACHE_BYTE_ORDER))
+            {
+                unmap_file(&f);
+                return STATUS_BAD_FORMAT;
+            }
+            if ((hdr->channels <= 0) ||
+                (hdr->length > hdr->max_length) ||
+                (hdr->max_length % DEFAULT_ALIGN) ||
+                ((f.size - sizeof(sample_cache_header_t)) / (hdr->channels * sizeof(float)) < hdr->max_length))
+            {
+                unmap_file(&f);
+                return STATUS_CORRUPTED;
+            }
+
+            // Check that the cache entry matches the key
+            if ((hdr->sample_rate != sample_rate) ||
+                (hdr->src_size != id.size) ||
+                (hdr->src_mtime != id.mtime) ||
+                (hdr->src_hash != source_hash(source)))
+            {
+                unmap_file(&f);
+                return STATUS_NOT_FOUND;
+            }
+
+            // Replace the buffer with the mapped data
+            release_buffer();
+
+            vBuffer         = reinterpret_cast<float *>(&f.data[sizeof(sample_cache_header_t)]);
+            nSampleRate     = hdr->sample_rate;
+            nLength         = hdr->length;
+            nMaxLength      = hdr->max_length;
+            nChannels       = hdr->channels;
+            pMapped         = f.data;
+            nMapped         = f.size;
+            sync_peaks();
 
-            // Return OK status
             return STATUS_OK;
         }
 
+        void Sample::memory_usage(memory_report_t *r) const
+        {
+            size_t samples      = nLength * nChannels;
+
+            if (pMapped != NULL)
+                memory::add(r, nMapped, samples * sizeof(float), sizeof(sample_cache_header_t));
+            else if (vBuffer != NULL)
+                memory::add_pages(r, vBuffer, samples * sizeof(float));
+
+            if (pCompact != NULL)
+            {
+                size_t szof_data    = align_size(nMaxLength * nChannels * sizeof(int16_t), DEFAULT_ALIGN);
+                size_t szof_scale   = align_size(nBlocks * nChannels * sizeof(float), DEFAULT_ALIGN);
+                size_t blocks       = (nLength + SAMPLE_COMPACT_BLOCK_SIZE - 1) >> SAMPLE_COMPACT_BLOCK_RANK;
+                size_t used         = samples * sizeof(int16_t) + blocks * nChannels * sizeof(float);
+                memory::add_aligned(r, pCompact, szof_data + szof_scale, used);
+            }
+
+            if (pPeaks != NULL)
+            {
+                memory::add(r, sizeof(SamplePeaks), sizeof(SamplePeaks));
+                pPeaks->memory_usage(r);
+            }
+        }
+
         void Sample::dump(IStateDumper *v) const
         {
             v->write("vBuffer", vBuffer);
@@ -785,6 +1685,14 @@ namespace lsp
             v->write("nLength", nLength);
             v->write("nMaxLength", nMaxLength);
             v->write("nChannels", nChannels);
+            v->write("pMapped", pMapped);
+            v->write("nMapped", nMapped);
+            v->write_object("pPeaks", pPeaks);
+            v->write("nPeaksThreads", nPeaksThreads);
+            v->write("vCompact", vCompact);
+            v->write("vScale", vScale);
+            v->write("nBlocks", nBlocks);
+            v->write("pCompact", pCompact);
         }
     }
 } /* namespace lsp */
@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/dsp-units/sampling/SampleLoader.h>
+#include <lsp-plug.in/mm/InAudioFileStream.h>
+
+#include <private/sampling/batch.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        SampleLoader::SampleLoader()
+        {
+            construct();
+        }
+
+        SampleLoader::~SampleLoader()
+        {
+            destroy();
+        }
+
+        void SampleLoader::construct()
+        {
+            nSampleRate     = 0;
+            nThreads        = 1;
+            pCallback       = NULL;
+            pArg            = NULL;
+            nNext           = 0;
+        }
+
+        void SampleLoader::destroy()
+        {
+            clear();
+        }
+
+        void SampleLoader::clear()
+        {
+            for (size_t i=0, n=vItems.size(); i<n; ++i)
+            {
+                item_t *item    = vItems.uget(i);
+                if (item != NULL)
+                    delete item;
+            }
+            vItems.flush();
+        }
+
+        status_t SampleLoader::add(Sample *dst, const char *path, ssize_t max_samples)
+        {
+            io::Path p;
+            status_t res = p.set(path);
+            return (res == STATUS_OK) ? add(dst, &p, max_samples) : res;
+        }
+
+        status_t SampleLoader::add(Sample *dst, const LSPString *path, ssize_t max_samples)
+        {
+            io::Path p;
+            status_t res = p.set(path);
+            return (res == STATUS_OK) ? add(dst, &p, max_samples) : res;
+        }
+
+        status_t SampleLoader::add(Sample *dst, const io::Path *path, ssize_t max_samples)
+        {
+            if ((dst == NULL) || (path == NULL))
+                return STATUS_BAD_ARGUMENTS;
+
+            item_t *item        = new item_t;
+            if (item == NULL)
+                return STATUS_NO_MEM;
+
+            item->pSample       = dst;
+            item->nMaxSamples   = max_samples;
+            item->nStatus       = STATUS_OK;
+
+            status_t res        = item->sPath.set(path);
+            if ((res == STATUS_OK) && (!vItems.add(item)))
+                res                 = STATUS_NO_MEM;
+            if (res != STATUS_OK)
+                delete item;
+
+            return res;
+        }
+
+        status_t SampleLoader::status(size_t index) const
+        {
+            const item_t *item  = vItems.get(index);
+            return (item != NULL) ? item->nStatus : STATUS_INVALID_VALUE;
+        }
+
+        void SampleLoader::set_callback(sample_loaded_t callback, void *arg)
+        {
+            pCallback       = callback;
+            pArg            = arg;
+        }
+
+        void SampleLoader::load_item(size_t index)
+        {
+            item_t *item        = vItems.uget(index);
+
+            // Decode the file directly into the sample
+            mm::InAudioFileStream in;
+            status_t res        = in.open(&item->sPath);
+            if (res == STATUS_OK)
+                res                 = item->pSample->loads(&in, item->nMaxSamples);
+            status_t cres       = in.close();
+            if (res == STATUS_OK)
+                res                 = cres;
+
+            // Resample in the same thread, files are processed in parallel
+            if ((res == STATUS_OK) && (nSampleRate > 0))
+                res                 = item->pSample->resample(nSampleRate, 1);
+
+            item->nStatus       = res;
+            if (pCallback != NULL)
+                pCallback(index, item->pSample, res, pArg);
+        }
+
+        void SampleLoader::load_jobs(void *arg)
+        {
+            SampleLoader *self  = static_cast<SampleLoader *>(arg);
+            const size_t count  = self->vItems.size();
+
+            while (true)
+            {
+                size_t idx      = atomic_add(&self->nNext, 1);
+                if (idx >= count)
+                    break;
+
+                self->load_item(idx);
+            }
+        }
+
+        status_t SampleLoader::load()
+        {
+            const size_t count  = vItems.size();
+            if (count <= 0)
+                return STATUS_OK;
+
+            nNext               = 0;
+            batch_run(load_jobs, this, count, nThreads);
+
+            // Report the first error
+            for (size_t i=0; i<count; ++i)
+            {
+                status_t res        = vItems.uget(i)->nStatus;
+                if (res != STATUS_OK)
+                    return res;
+            }
+
+            return STATUS_OK;
+        }
+    }
+} /* namespace lsp */
@@ -0,0 +1,272 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/dsp-units/sampling/SamplePeaks.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        SamplePeaks::SamplePeaks()
+        {
+            construct();
+        }
+
+        SamplePeaks::~SamplePeaks()
+        {
+            destroy();
+        }
+
+        void SamplePeaks::construct()
+        {
+            vMin        = NULL;
+            vMax        = NULL;
+            nChannels   = 0;
+            nMaxLength  = 0;
+            nLength     = 0;
+            nLevels     = 0;
+            nStride     = 0;
+            pData       = NULL;
+
+            for (size_t i=0; i<SAMPLE_PEAKS_MAX_LEVELS; ++i)
+                vOffset[i]  = 0;
+        }
+
+        void SamplePeaks::destroy()
+        {
+            free_aligned(pData);
+            vMin        = NULL;
+            vMax        = NULL;
+            nChannels   = 0;
+            nMaxLength  = 0;
+            nLength     = 0;
+            nLevels     = 0;
+            nStride     = 0;
+        }
+
+        bool SamplePeaks::init(size_t channels, size_t max_length)
+        {
+            if (channels <= 0)
+                return false;
+
+            // Compute the layout of levels: each next level has half of blocks of the previous one
+            size_t blocks       = lsp_max((max_length + SAMPLE_PEAKS_BLOCK_SIZE - 1) >> SAMPLE_PEAKS_BLOCK_RANK, size_t(1));
+            size_t levels       = 0;
+            size_t stride       = 0;
+            size_t offset[SAMPLE_PEAKS_MAX_LEVELS];
+
+            while (levels < SAMPLE_PEAKS_MAX_LEVELS)
+            {
+                offset[levels++]    = stride;
+                stride             += blocks;
+                if (blocks <= 1)
+                    break;
+                blocks              = (blocks + 1) >> 1;
+            }
+            if (blocks > 1)
+                return false;
+
+            stride              = align_size(stride, DEFAULT_ALIGN);
+            size_t to_alloc     = stride * channels * 2;
+
+            uint8_t *data       = NULL;
+            float *ptr          = alloc_aligned<float>(data, to_alloc);
+            if (ptr == NULL)
+                return false;
+            dsp::fill_zero(ptr, to_alloc);
+
+            free_aligned(pData);
+
+            vMin                = ptr;
+            vMax                = &ptr[stride * channels];
+            nChannels           = channels;
+            nMaxLength          = max_length;
+            nLength             = 0;
+            nLevels             = levels;
+            nStride             = stride;
+            pData               = data;
+
+            for (size_t i=0; i<SAMPLE_PEAKS_MAX_LEVELS; ++i)
+                vOffset[i]          = (i < levels) ? offset[i] : 0;
+
+            return true;
+        }
+
+        void SamplePeaks::update(size_t channel, const float *src, size_t first, size_t length)
+        {
+            if (channel >= nChannels)
+                return;
+
+            // Only complete blocks are stored, the incomplete tail block is never
+            // used for queries, so shrinking of the sample does not require any work
+            nLength             = lsp_min(length, nMaxLength);
+
+            float *vmin         = &vMin[channel * nStride];
+            float *vmax         = &vMax[channel * nStride];
+            size_t b            = first >> SAMPLE_PEAKS_BLOCK_RANK;
+            size_t e            = nLength >> SAMPLE_PEAKS_BLOCK_RANK;
+
+            // First level is computed from the sample data
+            for (size_t i=b; i<e; ++i)
+                dsp::minmax(&src[i << SAMPLE_PEAKS_BLOCK_RANK], SAMPLE_PEAKS_BLOCK_SIZE, &vmin[i], &vmax[i]);
+
+            // Each next level combines pairs of blocks of the previous level
+            for (size_t k=1; k<nLevels; ++k)
+            {
+                b                 >>= 1;
+                e                 >>= 1;
+                if (b >= e)
+                    break;
+
+                const float *smin   = &vmin[vOffset[k-1]];
+                const float *smax   = &vmax[vOffset[k-1]];
+                float *dmin         = &vmin[vOffset[k]];
+                float *dmax         = &vmax[vOffset[k]];
+
+                for (size_t i=b; i<e; ++i)
+                {
+                    dmin[i]             = lsp_min(smin[i*2], smin[i*2 + 1]);
+                    dmax[i]             = lsp_max(smax[i*2], smax[i*2 + 1]);
+                }
+            }
+        }
+
+        void SamplePeaks::find(size_t channel, const float *src, size_t first, size_t last, float *min, float *max) const
+        {
+            float vmin, vmax;
+            float rmin          = src[first];
+            float rmax          = rmin;
+
+            // Edges of the range that do not cover complete blocks are scanned directly
+            size_t head         = lsp_min(align_size(first, SAMPLE_PEAKS_BLOCK_SIZE), last);
+            size_t tail         = lsp_max(last & ~size_t(SAMPLE_PEAKS_BLOCK_SIZE - 1), head);
+
+            if (head > first)
+            {
+                dsp::minmax(&src[first], head - first, &vmin, &vmax);
+                rmin                = lsp_min(rmin, vmin);
+                rmax                = lsp_max(rmax, vmax);
+            }
+            if (last > tail)
+            {
+                dsp::minmax(&src[tail], last - tail, &vmin, &vmax);
+                rmin                = lsp_min(rmin, vmin);
+                rmax                = lsp_max(rmax, vmax);
+            }
+
+            // Complete blocks are covered by at most two blocks of each level
+            const float *lmin   = &vMin[channel * nStride];
+            const float *lmax   = &vMax[channel * nStride];
+            size_t b            = head >> SAMPLE_PEAKS_BLOCK_RANK;
+            size_t e            = tail >> SAMPLE_PEAKS_BLOCK_RANK;
+
+            for (size_t k=0; b < e; ++k)
+            {
+                const float *smin   = &lmin[vOffset[k]];
+                const float *smax   = &lmax[vOffset[k]];
+
+                if (b & 1)
+                {
+                    rmin                = lsp_min(rmin, smin[b]);
+                    rmax                = lsp_max(rmax, smax[b]);
+                    ++b;
+                }
+                if (e & 1)
+                {
+                    --e;
+                    rmin                = lsp_min(rmin, smin[e]);
+                    rmax                = lsp_max(rmax, smax[e]);
+                }
+
+                b                 >>= 1;
+                e                 >>= 1;
+            }
+
+            *min                = rmin;
+            *max                = rmax;
+        }
+
+        void SamplePeaks::get(size_t channel, const float *src, size_t first, size_t count, float *min, float *max) const
+        {
+            if ((channel >= nChannels) || (first >= nLength) || (count <= 0))
+            {
+                *min                = 0.0f;
+                *max                = 0.0f;
+                return;
+            }
+
+            count               = lsp_min(count, nLength - first);
+            find(channel, src, first, first + count, min, max);
+        }
+
+        void SamplePeaks::render(size_t channel, const float *src, float *min, float *max, size_t first, size_t count, size_t width) const
+        {
+            if ((channel >= nChannels) || (first >= nLength) || (count <= 0))
+            {
+                dsp::fill_zero(min, width);
+                dsp::fill_zero(max, width);
+                return;
+            }
+
+            count               = lsp_min(count, nLength - first);
+            size_t end          = first + count;
+
+            for (size_t i=0; i<width; ++i)
+            {
+                size_t a            = first + (uint64_t(i) * count) / width;
+                size_t b            = first + (uint64_t(i + 1) * count) / width;
+                if (b <= a)
+                    b                   = a + 1;
+                find(channel, src, a, lsp_min(b, end), &min[i], &max[i]);
+            }
+        }
+
+        void SamplePeaks::memory_usage(memory_report_t *r) const
+        {
+            if (pData != NULL)
+            {
+                size_t bytes        = nStride * nChannels * 2 * sizeof(float);
+                memory::add_aligned(r, pData, bytes, bytes);
+            }
+        }
+
+        void SamplePeaks::dump(IStateDumper *v) const
+        {
+            v->write("vMin", vMin);
+            v->write("vMax", vMax);
+            v->write("nChannels", nChannels);
+            v->write("nMaxLength", nMaxLength);
+            v->write("nLength", nLength);
+            v->write("nLevels", nLevels);
+            v->write("nStride", nStride);
+            v->begin_array("vOffset", vOffset, nLevels);
+            {
+                for (size_t i=0; i<nLevels; ++i)
+                    v->write(vOffset[i]);
+            }
+            v->end_array();
+            v->write("pData", pData);
+        }
+    }
+} /* namespace lsp */
@@ -21,6 +21,15 @@
 
 #include <lsp-plug.in/dsp-units/sampling/SamplePlayer.h>
 #include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/common/atomic.h>
+
+#define STREAM_BUFFER_SIZE      0x200
+#define FADE_BUFFER_SIZE        0x200
+#define RATE_BUFFER_SIZE        0x200
+#define WINDOW_BUFFER_SIZE      0x400
+#define SINC_HEAD               (SAMPLE_PLAYER_SINC_TAPS/2 - 1)
+#define SINC_TAIL               (SAMPLE_PLAYER_SINC_TAPS/2)
 
 namespace lsp
 {
@@ -29,14 +38,35 @@ namespace lsp
         SamplePlayer::SamplePlayer()
         {
             vSamples        = NULL;
+            vStreams        = NULL;
             nSamples        = 0;
             vPlayback       = NULL;
             nPlayback       = 0;
-            sActive.pHead   = NULL;
-            sActive.pTail   = NULL;
+            vActive         = NULL;
+            nActive         = 0;
+            for (size_t i=0; i<SAMPLE_PLAYER_PRIORITIES; ++i)
+            {
+                vSteal[i].pHead = NULL;
+                vSteal[i].pTail = NULL;
+            }
             sInactive.pHead = NULL;
             sInactive.pTail = NULL;
             fGain           = 1.0f;
+            enInterpolation = SPI_CUBIC;
+            nTimestamp      = 0;
+            vCommands       = NULL;
+            nCmdMask        = 0;
+            nCmdHead        = 0;
+            nCmdTail        = 0;
+            vGarbage        = NULL;
+            nGcHead         = 0;
+            nGcTail         = 0;
+            nGcReserved     = 0;
+        }
+
+        static inline ssize_t load_index(const ssize_t *ptr)
+        {
+            return *(reinterpret_cast<const volatile ssize_t *>(ptr));
         }
 
         SamplePlayer::~SamplePlayer()
@@ -87,49 +117,122 @@ namespace lsp
             }
         }
 
-        inline void SamplePlayer::list_insert_from_tail(list_t *list, playback_t *pb)
+        inline void SamplePlayer::list_add_last(list_t *list, playback_t *pb)
         {
-            // Find the position to insert data
-            playback_t *prev    = list->pTail;
-            while (prev != NULL)
-            {
-                if (pb->nOffset <= prev->nOffset)
-                    break;
-                prev    = prev->pPrev;
-            }
+            pb->pNext           = NULL;
+            pb->pPrev           = list->pTail;
+            if (list->pTail == NULL)
+                list->pHead         = pb;
+            else
+                list->pTail->pNext  = pb;
+            list->pTail         = pb;
+        }
+
+        inline size_t SamplePlayer::volume_priority(float volume)
+        {
+            // Each priority level covers 6 dB range of the volume,
+            // the lowest priority is reserved for cancelled playbacks
+            size_t prio         = SAMPLE_PLAYER_PRIORITIES - 1;
+            for (float v = fabsf(volume); (prio > 1) && (v < 1.0f); v *= 2.0f)
+                --prio;
+            return prio;
+        }
+
+        inline void SamplePlayer::activate(playback_t *pb)
+        {
+            pb->nIndex          = nActive;
+            vActive[nActive++]  = pb;
+            list_add_last(&vSteal[pb->nPriority], pb);
+        }
+
+        inline void SamplePlayer::deactivate(playback_t *pb)
+        {
+            // Replace the playback with the last one in the dense list
+            playback_t *last    = vActive[--nActive];
+            vActive[pb->nIndex] = last;
+            last->nIndex        = pb->nIndex;
+
+            list_remove(&vSteal[pb->nPriority], pb);
+            cleanup(pb);
+            list_add_first(&sInactive, pb);
+        }
+
+        inline SamplePlayer::playback_t *SamplePlayer::acquire()
+        {
+            playback_t *pb      = list_remove_first(&sInactive);
+            if (pb != NULL)
+                return pb;
 
-            // Position is before the first element?
-            if (prev == NULL)
+            // Steal the oldest playback with the lowest priority
+            for (size_t i=0; i<SAMPLE_PLAYER_PRIORITIES; ++i)
             {
-                list_add_first(list, pb);
-                return;
+                if ((pb = vSteal[i].pHead) == NULL)
+                    continue;
+                deactivate(pb);
+                return list_remove_first(&sInactive);
             }
 
-            // Insert after the found element
-            if (prev->pNext == NULL)
-                list->pTail         = pb;
-            else
-                prev->pNext->pPrev  = pb;
-            pb->pPrev           = prev;
-            pb->pNext           = prev->pNext;
-            prev->pNext         = pb;
+            return NULL;
         }
 
         inline void SamplePlayer::cleanup(playback_t *pb)
         {
             pb->pSample         = NULL;
+            pb->pStream         = NULL;
             pb->nID             = -1;
             pb->nChannel        = 0;
             pb->nFadeout        = -1;
             pb->nFadeOffset     = 0;
             pb->nVolume         = 0.0f;
             pb->nOffset         = 0;
+            pb->nPriority       = 0;
+            pb->fRate           = 1.0f;
+            pb->fPosition       = 0.0;
+            pb->nLoopStart      = 0;
+            pb->nLoopEnd        = 0;
+            pb->nLoopFade       = 0;
+            pb->sMap.nChannels  = 0;
+        }
+
+        static inline void single_channel_map(sp_channel_map_t *map, size_t channel)
+        {
+            map->nChannels      = 1;
+            map->vChannel[0]    = channel;
+            map->vOutput[0]     = 0;
+            map->vGain[0]       = 1.0f;
+        }
+
+        void SamplePlayer::init_sinc()
+        {
+            // Lanczos-windowed sinc kernel, each row corresponds to the fractional
+            // position of the interpolated sample between the two middle taps
+            const float a       = SAMPLE_PLAYER_SINC_TAPS / 2;
+            for (size_t i=0; i<=SAMPLE_PLAYER_SINC_PHASES; ++i)
+            {
+                float *row          = &vSinc[i * SAMPLE_PLAYER_SINC_TAPS];
+                float frac          = float(i) / SAMPLE_PLAYER_SINC_PHASES;
+                float sum           = 0.0f;
+
+                for (size_t j=0; j<SAMPLE_PLAYER_SINC_TAPS; ++j)
+                {
+                    float t             = float(ssize_t(j) - SINC_HEAD) - frac;
+                    float x             = M_PI * t;
+                    row[j]              = (fabsf(t) < 1e-6f) ? 1.0f :
+                                          (fabsf(t) >= a) ? 0.0f :
+                                          a * sinf(x) * sinf(x / a) / (x * x);
+                    sum                += row[j];
+                }
+
+                // Normalize the row to have unit gain at DC
+                for (size_t j=0; j<SAMPLE_PLAYER_SINC_TAPS; ++j)
+                    row[j]             /= sum;
+            }
         }
 
-        bool SamplePlayer::init(size_t max_samples, size_t max_playbacks)
+        bool SamplePlayer::init(size_t max_samples, size_t max_playbacks, size_t max_commands)
         {
             // Check arguments
-            if ((max_samples <= 0) || (max_playbacks <= 0))
+            if ((max_samples <= 0) || (max_playbacks <= 0) || (max_commands <= 0))
                 return false;
 
             // Allocate array of samples
@@ -137,24 +240,75 @@ namespace lsp
             if (vSamples == NULL)
                 return false;
 
-            // Allocate playback array
+            // Allocate array of streams
+            vStreams            = new SampleStream *[max_samples];
+            if (vStreams == NULL)
+            {
+                delete [] vSamples;
+                vSamples            = NULL;
+                return false;
+            }
+
+            // Allocate playback array and the command queue
+            size_t cap          = 1;
+            while (cap < max_commands)
+                cap               <<= 1;
+
             vPlayback           = new playback_t[max_playbacks];
-            if (vPlayback == NULL)
+            vActive             = new playback_t *[max_playbacks];
+            vCommands           = new cell_t[cap];
+            vGarbage            = new Sample *[cap];
+            if ((vPlayback == NULL) || (vActive == NULL) || (vCommands == NULL) || (vGarbage == NULL))
             {
                 delete [] vSamples;
+                delete [] vStreams;
+                if (vPlayback != NULL)
+                    delete [] vPlayback;
+                if (vActive != NULL)
+                    delete [] vActive;
+                if (vCommands != NULL)
+                    delete [] vCommands;
+                if (vGarbage != NULL)
+                    delete [] vGarbage;
                 vSamples            = NULL;
+                vStreams            = NULL;
+                vPlayback           = NULL;
+                vActive             = NULL;
+                vCommands           = NULL;
+                vGarbage            = NULL;
                 return false;
             }
 
+            // Init command queue (empty)
+            for (size_t i=0; i<cap; ++i)
+            {
+                vCommands[i].nSequence  = i;
+                vGarbage[i]             = NULL;
+            }
+            nCmdMask            = cap - 1;
+            nCmdHead            = 0;
+            nCmdTail            = 0;
+            nGcHead             = 0;
+            nGcTail             = 0;
+            nGcReserved         = 0;
+            nTimestamp          = 0;
+
             // Update state
             nSamples            = max_samples;
             nPlayback           = max_playbacks;
             for (size_t i=0; i<max_samples; ++i)
+            {
                 vSamples[i]         = NULL;
+                vStreams[i]         = NULL;
+            }
 
-            // Init active list (empty)
-            sActive.pHead       = NULL;
-            sActive.pTail       = NULL;
+            // Init active lists (empty)
+            nActive             = 0;
+            for (size_t i=0; i<SAMPLE_PLAYER_PRIORITIES; ++i)
+            {
+                vSteal[i].pHead     = NULL;
+                vSteal[i].pTail     = NULL;
+            }
 
             // Init inactive list (full)
             playback_t *last    = NULL;
@@ -178,11 +332,48 @@ namespace lsp
             last->pNext         = NULL;
             sInactive.pTail     = last;
 
+            // Init interpolation kernel
+            init_sinc();
+
             return true;
         }
 
         void SamplePlayer::destroy(bool cascade)
         {
+            if (vCommands != NULL)
+            {
+                // Destroy samples of the pending bind commands and collect the garbage
+                for (ssize_t i=nCmdHead; i != nCmdTail; ++i)
+                {
+                    cell_t *c = &vCommands[i & nCmdMask];
+                    if ((c->sCommand.enType == CMD_BIND) && (c->sCommand.pSample != NULL))
+                    {
+                        if (cascade)
+                        {
+                            c->sCommand.pSample->destroy();
+                            delete c->sCommand.pSample;
+                        }
+                        c->sCommand.pSample = NULL;
+                    }
+                }
+                gc();
+
+                delete [] vCommands;
+                vCommands       = NULL;
+            }
+            if (vGarbage != NULL)
+            {
+                delete [] vGarbage;
+                vGarbage        = NULL;
+            }
+            nCmdMask        = 0;
+            nCmdHead        = 0;
+            nCmdTail        = 0;
+            nGcHead         = 0;
+            nGcTail         = 0;
+            nGcReserved     = 0;
+            nTimestamp      = 0;
+
             if (vSamples != NULL)
             {
                 // Delete all bound samples
@@ -203,6 +394,12 @@ namespace lsp
                 delete [] vSamples;
                 vSamples        = NULL;
             }
+            if (vStreams != NULL)
+            {
+                // Streams are not owned by the player
+                delete [] vStreams;
+                vStreams        = NULL;
+            }
             nSamples        = 0;
 
             if (vPlayback != NULL)
@@ -210,9 +407,18 @@ namespace lsp
                 delete [] vPlayback;
                 vPlayback       = NULL;
             }
+            if (vActive != NULL)
+            {
+                delete [] vActive;
+                vActive         = NULL;
+            }
             nPlayback       = 0;
-            sActive.pHead   = NULL;
-            sActive.pTail   = NULL;
+            nActive         = 0;
+            for (size_t i=0; i<SAMPLE_PLAYER_PRIORITIES; ++i)
+            {
+                vSteal[i].pHead = NULL;
+                vSteal[i].pTail = NULL;
+            }
             sInactive.pHead = NULL;
             sInactive.pTail = NULL;
         }
@@ -237,22 +443,40 @@ namespace lsp
             }
 
             // Cleanup all active playbacks associated with this sample
-            playback_t *pb = sActive.pHead;
-            while (pb != NULL)
-            {
-                playback_t *next    = pb->pNext;
-                if (pb->pSample == old)
-                {
-                    pb->pSample     = NULL;
-                    list_remove(&sActive, pb);
-                    list_add_first(&sInactive, pb);
-                }
-                pb          = next;
-            }
+            cancel_playbacks(old, NULL);
+
+            return true;
+        }
+
+        bool SamplePlayer::bind_stream(size_t id, SampleStream *stream)
+        {
+            if (id >= nSamples)
+                return false;
+
+            SampleStream *old   = vStreams[id];
+            if (old == stream)
+                return true;
+            vStreams[id]        = stream;
+
+            // Cleanup all active playbacks associated with this stream
+            cancel_playbacks(NULL, old);
 
             return true;
         }
 
+        void SamplePlayer::cancel_playbacks(const Sample *sample, const SampleStream *stream)
+        {
+            for (size_t i=0; i<nActive; )
+            {
+                playback_t *pb      = vActive[i];
+                if (((sample != NULL) && (pb->pSample == sample)) ||
+                    ((stream != NULL) && (pb->pStream == stream)))
+                    deactivate(pb);
+                else
+                    ++i;
+            }
+        }
+
         bool SamplePlayer::bind(size_t id, Sample *sample, bool destroy)
         {
             if (!bind(id, &sample))
@@ -280,34 +504,595 @@ namespace lsp
 
         void SamplePlayer::process(float *dst, const float *src, size_t samples)
         {
+            drain();
             if (src == NULL)
                 dsp::fill_zero(dst, samples);
             else
                 dsp::copy(dst, src, samples);
-            do_process(dst, samples);
+            do_process(&dst, 1, samples);
+            nTimestamp     += samples;
         }
 
         void SamplePlayer::process(float *dst, size_t samples)
         {
+            drain();
             dsp::fill_zero(dst, samples);
-            do_process(dst, samples);
+            do_process(&dst, 1, samples);
+            nTimestamp     += samples;
         }
 
-        void SamplePlayer::do_process(float *dst, size_t samples)
+        void SamplePlayer::process(float * const *dst, const float * const *src, size_t outputs, size_t samples)
         {
-            playback_t *pb      = sActive.pHead;
+            drain();
+            for (size_t i=0; i<outputs; ++i)
+            {
+                if ((src == NULL) || (src[i] == NULL))
+                    dsp::fill_zero(dst[i], samples);
+                else
+                    dsp::copy(dst[i], src[i], samples);
+            }
+            do_process(dst, outputs, samples);
+            nTimestamp     += samples;
+        }
+
+        void SamplePlayer::process(float * const *dst, size_t outputs, size_t samples)
+        {
+            drain();
+            for (size_t i=0; i<outputs; ++i)
+                dsp::fill_zero(dst[i], samples);
+            do_process(dst, outputs, samples);
+            nTimestamp     += samples;
+        }
+
+        bool SamplePlayer::post(const command_t *cmd)
+        {
+            if (vCommands == NULL)
+                return false;
+
+            // Reserve the cell at the tail of the queue
+            ssize_t pos     = load_index(&nCmdTail);
+            cell_t *c;
+            while (true)
+            {
+                c               = &vCommands[pos & nCmdMask];
+                ssize_t seq     = atomic_add(&c->nSequence, ssize_t(0));
+                ssize_t diff    = seq - pos;
+                if (diff == 0)
+                {
+                    if (atomic_cas(&nCmdTail, pos, pos + 1))
+                        break;
+                    pos             = load_index(&nCmdTail);
+                }
+                else if (diff < 0)
+                    return false; // The queue is full
+                else
+                    pos             = load_index(&nCmdTail);
+            }
+
+            // Store the command and publish it
+            c->sCommand     = *cmd;
+            atomic_swap(&c->nSequence, pos + 1);
+
+            return true;
+        }
+
+        void SamplePlayer::execute(const command_t *cmd)
+        {
+            // Commands with the timestamp that already has passed are executed immediately
+            ssize_t delay   = (cmd->nTimestamp > nTimestamp) ? ssize_t(cmd->nTimestamp - nTimestamp) : 0;
+
+            switch (cmd->enType)
+            {
+                case CMD_PLAY:
+                    play_mapped(cmd->nID, (cmd->sMap.nChannels > 0) ? &cmd->sMap : NULL,
+                        cmd->fVolume, &cmd->sLoop, delay, cmd->fRate);
+                    break;
+                case CMD_CANCEL:
+                    cancel_all(cmd->nID, cmd->nChannel, cmd->nFadeout, delay);
+                    break;
+                case CMD_BIND:
+                {
+                    Sample *s       = cmd->pSample;
+                    if (!bind(cmd->nID, &s))
+                        s               = cmd->pSample;
+
+                    // Pass the replaced sample to the garbage queue, the slot has been reserved
+                    if (s != NULL)
+                    {
+                        vGarbage[nGcTail & nCmdMask]    = s;
+                        atomic_swap(&nGcTail, nGcTail + 1);
+                    }
+                    else
+                        atomic_add(&nGcReserved, ssize_t(-1));
+                    break;
+                }
+                case CMD_STOP:
+                    stop();
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        void SamplePlayer::drain()
+        {
+            if (vCommands == NULL)
+                return;
+
+            while (true)
+            {
+                cell_t *c       = &vCommands[nCmdHead & nCmdMask];
+                ssize_t seq     = atomic_add(&c->nSequence, ssize_t(0));
+                if (seq != nCmdHead + 1)
+                    break; // The queue is empty or the command is not published yet
+
+                execute(&c->sCommand);
+
+                // Release the cell
+                atomic_swap(&c->nSequence, nCmdHead + ssize_t(nCmdMask) + 1);
+                ++nCmdHead;
+            }
+        }
 
+        bool SamplePlayer::post_play(size_t id, size_t channel, float volume, wsize_t timestamp, float rate)
+        {
+            return post_play_loop(id, channel, volume, NULL, timestamp, rate);
+        }
+
+        bool SamplePlayer::post_play_loop(size_t id, size_t channel, float volume, const sp_loop_t *loop, wsize_t timestamp, float rate)
+        {
+            sp_channel_map_t map;
+            single_channel_map(&map, channel);
+            return post_play_mapped(id, &map, volume, loop, timestamp, rate);
+        }
+
+        bool SamplePlayer::post_play_mapped(size_t id, const sp_channel_map_t *map, float volume, const sp_loop_t *loop, wsize_t timestamp, float rate)
+        {
+            command_t cmd;
+            cmd.enType      = CMD_PLAY;
+            cmd.nID         = id;
+            cmd.nChannel    = 0;
+            cmd.fVolume     = volume;
+            cmd.fRate       = rate;
+            cmd.nFadeout    = 0;
+            cmd.sLoop.nStart= (loop != NULL) ? loop->nStart : 0;
+            cmd.sLoop.nEnd  = (loop != NULL) ? loop->nEnd : 0;
+            cmd.sLoop.nFade = (loop != NULL) ? loop->nFade : 0;
+            if (map != NULL)
+            {
+                if ((map->nChannels <= 0) || (map->nChannels > SAMPLE_PLAYER_CHANNELS))
+                    return false;
+                cmd.sMap        = *map;
+            }
+            else
+                cmd.sMap.nChannels  = 0;
+            cmd.nTimestamp  = timestamp;
+            cmd.pSample     = NULL;
+
+            return post(&cmd);
+        }
+
+        bool SamplePlayer::post_cancel_all(size_t id, size_t channel, size_t fadeout, wsize_t timestamp)
+        {
+            command_t cmd;
+            cmd.enType      = CMD_CANCEL;
+            cmd.nID         = id;
+            cmd.nChannel    = channel;
+            cmd.fVolume     = 0.0f;
+            cmd.fRate       = 1.0f;
+            cmd.nFadeout    = fadeout;
+            cmd.nTimestamp  = timestamp;
+            cmd.pSample     = NULL;
+
+            return post(&cmd);
+        }
+
+        bool SamplePlayer::post_bind(size_t id, Sample *sample)
+        {
+            if (vGarbage == NULL)
+                return false;
+
+            // Reserve the slot in the garbage queue for the replaced sample
+            if (atomic_add(&nGcReserved, ssize_t(1)) > ssize_t(nCmdMask))
+            {
+                atomic_add(&nGcReserved, ssize_t(-1));
+                return false;
+            }
+
+            command_t cmd;
+            cmd.enType      = CMD_BIND;
+            cmd.nID         = id;
+            cmd.nChannel    = 0;
+            cmd.fVolume     = 0.0f;
+            cmd.fRate       = 1.0f;
+            cmd.nFadeout    = 0;
+            cmd.nTimestamp  = 0;
+            cmd.pSample     = sample;
+
+            if (post(&cmd))
+                return true;
+
+            atomic_add(&nGcReserved, ssize_t(-1));
+            return false;
+        }
+
+        bool SamplePlayer::post_stop()
+        {
+            command_t cmd;
+            cmd.enType      = CMD_STOP;
+            cmd.nID         = 0;
+            cmd.nChannel    = 0;
+            cmd.fVolume     = 0.0f;
+            cmd.fRate       = 1.0f;
+            cmd.nFadeout    = 0;
+            cmd.nTimestamp  = 0;
+            cmd.pSample     = NULL;
+
+            return post(&cmd);
+        }
+
+        size_t SamplePlayer::gc()
+        {
+            if (vGarbage == NULL)
+                return 0;
+
+            size_t count    = 0;
+            for (ssize_t tail = load_index(&nGcTail); nGcHead != tail; ++nGcHead)
+            {
+                Sample *s       = vGarbage[nGcHead & nCmdMask];
+                vGarbage[nGcHead & nCmdMask]    = NULL;
+                s->destroy();
+                delete s;
+
+                atomic_add(&nGcReserved, ssize_t(-1));
+                ++count;
+            }
+
+            return count;
+        }
+
+        inline void SamplePlayer::mix(playback_t *pb, float *dst, const float *src, float gain, ssize_t count)
+        {
+            if (pb->nFadeout < 0)
+            {
+                dsp::fmadd_k3(dst, src, gain, count);
+                return;
+            }
+
+            // Apply constant gain before the start of the fadeout
+            ssize_t fade_head   = pb->nFadeOffset;
+            if (fade_head < 0)
+            {
+                ssize_t to_do       = lsp_min(count, -fade_head);
+                dsp::fmadd_k3(dst, src, gain, to_do);
+                dst                += to_do;
+                src                += to_do;
+                count              -= to_do;
+                fade_head          += to_do;
+            }
+
+            // Apply linear gain ramp of the fadeout
+            float env[FADE_BUFFER_SIZE];
+            float fgain         = gain / (pb->nFadeout + 1);
+            count               = lsp_min(count, pb->nFadeout - fade_head);
+            while (count > 0)
+            {
+                ssize_t to_do       = lsp_min(count, ssize_t(FADE_BUFFER_SIZE));
+                float g             = fgain * (pb->nFadeout - fade_head);
+                for (ssize_t i=0; i<to_do; ++i)
+                    env[i]              = g - fgain * i;
+                dsp::fmadd3(dst, src, env, to_do);
+
+                dst                += to_do;
+                src                += to_do;
+                count              -= to_do;
+                fade_head          += to_do;
+            }
+
+            pb->nFadeOffset     = fade_head;
+        }
+
+        void SamplePlayer::fetch(const playback_t *pb, float *dst, ssize_t offset, ssize_t count)
+        {
+            // Data before the start of the sample is silence
+            if (offset < 0)
+            {
+                ssize_t to_do       = lsp_min(count, -offset);
+                dsp::fill_zero(dst, to_do);
+                dst                += to_do;
+                offset             += to_do;
+                count              -= to_do;
+            }
+            if (count <= 0)
+                return;
+
+            // The stream fills the tail after the end with silence by itself
+            if (pb->pStream != NULL)
+            {
+                pb->pStream->read(pb->nChannel, dst, offset, count);
+                return;
+            }
+
+            // The sample decodes the compact storage and fills the tail with silence
+            pb->pSample->read(pb->nChannel, dst, offset, count);
+        }
+
+        inline bool SamplePlayer::direct(const playback_t *pb)
+        {
+            return (pb->pStream == NULL) && (!pb->pSample->compacted());
+        }
+
+        inline bool SamplePlayer::looped(const playback_t *pb)
+        {
+            return pb->nLoopEnd > pb->nLoopStart;
+        }
+
+        inline ssize_t SamplePlayer::loop_segment(const playback_t *pb, ssize_t offset, ssize_t *pos, bool *fade)
+        {
+            // The data before the start of the loop is played as is
+            if (offset < pb->nLoopStart)
+            {
+                *pos                = offset;
+                *fade               = false;
+                return pb->nLoopStart - offset;
+            }
+
+            // Map the offset to the loop, the last samples of the loop are crossfaded
+            ssize_t w           = pb->nLoopStart + (offset - pb->nLoopStart) % (pb->nLoopEnd - pb->nLoopStart);
+            ssize_t xf          = pb->nLoopEnd - pb->nLoopFade;
+            *pos                = w;
+            *fade               = (w >= xf);
+
+            return (*fade) ? pb->nLoopEnd - w : xf - w;
+        }
+
+        void SamplePlayer::fetch_loop(const playback_t *pb, float *dst, ssize_t offset, ssize_t count)
+        {
+            if (!looped(pb))
+            {
+                fetch(pb, dst, offset, count);
+                return;
+            }
+
+            float tmp[FADE_BUFFER_SIZE], env[FADE_BUFFER_SIZE];
+            const ssize_t len   = pb->nLoopEnd - pb->nLoopStart;
+            const float k       = 1.0f / (pb->nLoopFade + 1);
+
+            while (count > 0)
+            {
+                ssize_t pos;
+                bool fade;
+                ssize_t to_do       = lsp_min(count, loop_segment(pb, offset, &pos, &fade));
+
+                if (fade)
+                {
+                    // Crossfade the end of the loop with the data preceding the start of the loop
+                    to_do               = lsp_min(to_do, ssize_t(FADE_BUFFER_SIZE));
+                    float g             = k * (pos - pb->nLoopEnd + pb->nLoopFade + 1);
+                    for (ssize_t i=0; i<to_do; ++i)
+                        env[i]              = g + k * i;
+
+                    fetch(pb, dst, pos, to_do);
+                    fetch(pb, tmp, pos - len, to_do);
+                    dsp::sub2(tmp, dst, to_do);
+                    dsp::fmadd3(dst, tmp, env, to_do);
+                }
+                else
+                    fetch(pb, dst, pos, to_do);
+
+                dst                += to_do;
+                offset             += to_do;
+                count              -= to_do;
+            }
+        }
+
+        void SamplePlayer::mix_loop(playback_t *pb, float *dst, ssize_t offset, float gain, ssize_t count)
+        {
+            float buf[STREAM_BUFFER_SIZE];
+
+            while (count > 0)
+            {
+                ssize_t pos;
+                bool fade;
+                ssize_t to_do       = lsp_min(count, loop_segment(pb, offset, &pos, &fade));
+
+                // Contiguous data of the sample is mixed directly
+                if ((!fade) && (direct(pb)))
+                    mix(pb, dst, pb->pSample->getBuffer(pb->nChannel, pos), gain, to_do);
+                else
+                {
+                    to_do               = lsp_min(to_do, ssize_t(STREAM_BUFFER_SIZE));
+                    fetch_loop(pb, buf, offset, to_do);
+                    mix(pb, dst, buf, gain, to_do);
+                }
+
+                dst                += to_do;
+                offset             += to_do;
+                count              -= to_do;
+            }
+        }
+
+        void SamplePlayer::interpolate_linear(float *dst, const float *src, double x, float step, size_t count)
+        {
+            for (size_t i=0; i<count; ++i)
+            {
+                double p            = x + i * step;
+                size_t k            = size_t(p);
+                float f             = p - k;
+                const float *s      = &src[k];
+
+                dst[i]              = s[0] + f * (s[1] - s[0]);
+            }
+        }
+
+        void SamplePlayer::interpolate_cubic(float *dst, const float *src, double x, float step, size_t count)
+        {
+            for (size_t i=0; i<count; ++i)
+            {
+                double p            = x + i * step;
+                size_t k            = size_t(p);
+                float f             = p - k;
+                const float *s      = &src[k - 1];
+
+                dst[i]              = s[1] + 0.5f * f * (
+                                        s[2] - s[0] + f * (
+                                            2.0f * s[0] - 5.0f * s[1] + 4.0f * s[2] - s[3] + f * (
+                                                3.0f * (s[1] - s[2]) + s[3] - s[0]
+                                            )
+                                        )
+                                      );
+            }
+        }
+
+        void SamplePlayer::interpolate_sinc(float *dst, const float *src, double x, float step, size_t count) const
+        {
+            for (size_t i=0; i<count; ++i)
+            {
+                double p            = x + i * step;
+                size_t k            = size_t(p);
+                float f             = (p - k) * SAMPLE_PLAYER_SINC_PHASES;
+                size_t phase        = lsp_min(size_t(f), size_t(SAMPLE_PLAYER_SINC_PHASES - 1));
+                f                  -= phase;
+
+                // Interpolate between two adjacent phases of the kernel
+                const float *s      = &src[k - SINC_HEAD];
+                const float *r0     = &vSinc[phase * SAMPLE_PLAYER_SINC_TAPS];
+                const float *r1     = &r0[SAMPLE_PLAYER_SINC_TAPS];
+                float v0            = 0.0f, v1 = 0.0f;
+                for (size_t j=0; j<SAMPLE_PLAYER_SINC_TAPS; ++j)
+                {
+                    v0                 += s[j] * r0[j];
+                    v1                 += s[j] * r1[j];
+                }
+
+                dst[i]              = v0 + f * (v1 - v0);
+            }
+        }
+
+        size_t SamplePlayer::resample(playback_t *pb, float *dst, size_t count, ssize_t length)
+        {
+            float buf[WINDOW_BUFFER_SIZE];
+            const float rate    = pb->fRate;
+            const size_t max_count  = lsp_max(size_t((WINDOW_BUFFER_SIZE - SAMPLE_PLAYER_SINC_TAPS - 1) / rate), size_t(1));
+            size_t done         = 0;
+
+            const bool loop     = looped(pb);
+            const ssize_t plain = (loop) ? pb->nLoopEnd - pb->nLoopFade : length; // End of data that is read as is
+
+            while (done < count)
+            {
+                double pos          = pb->fPosition;
+                if ((!loop) && (pos >= length))
+                    break;
+
+                // Estimate the number of samples to produce and the window of source data to interpolate
+                size_t to_do        = lsp_min(count - done, max_count);
+                if (!loop)
+                    to_do               = lsp_min(to_do, size_t(ceil((length - pos) / rate)));
+                to_do               = lsp_max(to_do, size_t(1));
+                ssize_t first       = ssize_t(pos) - SINC_HEAD;
+                ssize_t last        = ssize_t(pos + (to_do - 1) * rate) + SINC_TAIL + 1;
+
+                // Read the sample data directly if possible, copy the window otherwise
+                const float *src;
+                if ((direct(pb)) && (first >= 0) && (last <= plain))
+                    src                 = pb->pSample->getBuffer(pb->nChannel, first);
+                else
+                {
+                    fetch_loop(pb, buf, first, last - first);
+                    src                 = buf;
+                }
+
+                switch (enInterpolation)
+                {
+                    case SPI_LINEAR:
+                        interpolate_linear(&dst[done], src, pos - first, rate, to_do);
+                        break;
+                    case SPI_SINC:
+                        interpolate_sinc(&dst[done], src, pos - first, rate, to_do);
+                        break;
+                    case SPI_CUBIC:
+                    default:
+                        interpolate_cubic(&dst[done], src, pos - first, rate, to_do);
+                        break;
+                }
+
+                pos                += to_do * rate;
+                done               += to_do;
+
+                // Move the position back by the whole number of loops, the loop data is periodic
+                // after the start of the loop, so the interpolation window should stay after it
+                if (loop)
+                {
+                    ssize_t len         = pb->nLoopEnd - pb->nLoopStart;
+                    double n            = floor((pos - pb->nLoopStart - SINC_HEAD) / len);
+                    if (n > 0.0)
+                        pos                -= n * len;
+                }
+                pb->fPosition       = pos;
+            }
+
+            return done;
+        }
+
+        void SamplePlayer::render(playback_t *pb, float *dst, ssize_t offset, ssize_t count, ssize_t length, float gain)
+        {
+            if (pb->fRate != 1.0f)
+            {
+                // Interpolate the sample data at non-native rate
+                float buf[RATE_BUFFER_SIZE];
+                for (ssize_t off=0; off < count; )
+                {
+                    ssize_t to_do       = lsp_min(count - off, ssize_t(RATE_BUFFER_SIZE));
+                    to_do               = resample(pb, buf, to_do, length);
+                    if (to_do <= 0)
+                        break;
+                    mix(pb, &dst[off], buf, gain, to_do);
+                    off                += to_do;
+                }
+                return;
+            }
+
+            // Mix contiguous segments of the loop
+            if (looped(pb))
+            {
+                mix_loop(pb, dst, offset, gain, count);
+                return;
+            }
+
+            // Add sample data to the output buffer
+            count               = lsp_min(count, length - offset);
+            if (count <= 0)
+                return;
+
+            if (!direct(pb))
+            {
+                // Pull the window of the stream from the page cache or decode the compact sample
+                float buf[STREAM_BUFFER_SIZE];
+                for (ssize_t off=0; off < count; )
+                {
+                    ssize_t to_do       = lsp_min(count - off, ssize_t(STREAM_BUFFER_SIZE));
+                    fetch(pb, buf, offset + off, to_do);
+                    mix(pb, &dst[off], buf, gain, to_do);
+                    off                += to_do;
+                }
+            }
+            else
+                mix(pb, dst, pb->pSample->getBuffer(pb->nChannel, offset), gain, count);
+        }
+
+        void SamplePlayer::do_process(float * const *dst, size_t outputs, size_t samples)
+        {
             // Iterate playbacks
-            while (pb != NULL)
+            for (size_t i=0; i<nActive; )
             {
-                // Get next playback
-                playback_t *next    = pb->pNext;
+                playback_t *pb      = vActive[i];
 
                 // Check bounds
                 ssize_t src_head    = pb->nOffset;
                 pb->nOffset        += samples;
-                Sample *s           = pb->pSample;
-                ssize_t s_len       = s->length();
+                SampleStream *ss    = pb->pStream;
+                ssize_t s_len       = (ss != NULL) ? ssize_t(ss->length()) : ssize_t(pb->pSample->length());
 
                 // Handle sample if active
                 if (pb->nOffset > 0)
@@ -322,74 +1107,105 @@ namespace lsp
                         dst_off     = samples - pb->nOffset;
                         count       = pb->nOffset;
                     }
-                    if (pb->nOffset > s_len)
-                        count      += s_len - pb->nOffset;
 
-                    // Add sample data to the output buffer
-                    if (count > 0)
+                    // Render all channels of the playback, each channel advances the state equally
+                    const sp_channel_map_t *map = &pb->sMap;
+                    const ssize_t fade_offset   = pb->nFadeOffset;
+                    const double position       = pb->fPosition;
+                    for (size_t j=0; (outputs > 0) && (j<map->nChannels); ++j)
                     {
-    //                    lsp_trace("add_multiplied dst_off=%d, src_head=%d, volume=%f, count=%d", int(dst_off), int(src_head), pb->nVolume, int(count));
-                        if (pb->nFadeout < 0)
-                            dsp::fmadd_k3(&dst[dst_off], s->getBuffer(pb->nChannel, src_head), pb->nVolume * fGain, count);
-                        else
-                        {
-                            ssize_t fade_head   = pb->nFadeOffset;
-                            float gain          = pb->nVolume * fGain;
-                            float *sp           = s->getBuffer(pb->nChannel, src_head);
-                            float *dp           = &dst[dst_off];
-
-                            float fgain         = gain / (pb->nFadeout + 1);
-                            for (ssize_t i=0; (i<count) && (fade_head < pb->nFadeout); ++i, ++fade_head)
-                            {
-                                if (fade_head < 0)
-                                    *(dp++)        += *(sp++) * gain;
-                                else
-                                    *(dp++)        += *(sp++) * fgain * (pb->nFadeout - fade_head);
-                            }
-
-                            pb->nFadeOffset     = fade_head;
-                        }
+                        pb->nFadeOffset     = fade_offset;
+                        pb->fPosition       = position;
+                        pb->nChannel        = map->vChannel[j];
+                        float *out          = dst[map->vOutput[j] % outputs];
+                        render(pb, &out[dst_off], src_head, count, s_len, pb->nVolume * fGain * map->vGain[j]);
                     }
+
+                    // Move the offset back by the whole number of loops
+                    if ((looped(pb)) && (pb->fRate == 1.0f) && (pb->nOffset >= pb->nLoopEnd))
+                        pb->nOffset         = pb->nLoopStart + (pb->nOffset - pb->nLoopStart) % (pb->nLoopEnd - pb->nLoopStart);
                 }
 
                 // Check that there are no samples to process in the future
-                if ((pb->nOffset >= s_len) ||
+                bool done           = (looped(pb)) ? false :
+                                      (pb->fRate != 1.0f) ? (pb->fPosition >= s_len) : (pb->nOffset >= s_len);
+                if ((done) ||
                     ((pb->nFadeout >= 0) && (pb->nFadeOffset >= pb->nFadeout)))
                 {
-                    // Cleanup playback
-                    cleanup(pb);
-
-                    // Move to inactive
-                    list_remove(&sActive, pb);
-                    list_add_first(&sInactive, pb);
+                    // Move to inactive, the last active playback takes place of the current one
+                    deactivate(pb);
 
     //                lsp_trace("freed playback %p", pb);
                 }
-
-                // Iterate next playback
-                pb                  = next;
+                else
+                    ++i;
             }
         }
 
-        bool SamplePlayer::play(size_t id, size_t channel, float volume, ssize_t delay)
+        bool SamplePlayer::play(size_t id, size_t channel, float volume, ssize_t delay, float rate)
         {
-            // Check that ID of the sample is correct
+            return play_loop(id, channel, volume, NULL, delay, rate);
+        }
+
+        bool SamplePlayer::play_loop(size_t id, size_t channel, float volume, const sp_loop_t *loop, ssize_t delay, float rate)
+        {
+            sp_channel_map_t map;
+            single_channel_map(&map, channel);
+            return play_mapped(id, &map, volume, loop, delay, rate);
+        }
+
+        bool SamplePlayer::play_mapped(size_t id, const sp_channel_map_t *map, float volume, const sp_loop_t *loop, ssize_t delay, float rate)
+        {
+            // Check that ID of the sample and the playback rate are correct
             if (id >= nSamples)
                 return false;
+            if ((!(rate > 0.0f)) || (rate > SAMPLE_PLAYER_MAX_RATE))
+                return false;
 
             // Check that the sample is bound and valid
             Sample *s       = vSamples[id];
-            if ((s == NULL) || (!s->valid()))
-                return false;
+            SampleStream *ss= NULL;
+            size_t channels = 0;
+            wsize_t length  = 0;
+            if ((s != NULL) && (s->valid()))
+            {
+                channels        = s->channels();
+                length          = s->length();
+            }
+            else
+            {
+                // Try to use the stream bound to the same ID
+                s               = NULL;
+                ss              = vStreams[id];
+                if ((ss == NULL) || (!ss->valid()))
+                    return false;
+                channels        = ss->channels();
+                length          = ss->length();
+            }
 
-            // Check that ID of channel matches
-            if (channel >= s->channels())
-                return false;
+            // Check the channel map, all channels are rendered by default
+            if (map != NULL)
+            {
+                if ((map->nChannels <= 0) || (map->nChannels > SAMPLE_PLAYER_CHANNELS))
+                    return false;
+                for (size_t i=0; i<map->nChannels; ++i)
+                    if (map->vChannel[i] >= channels)
+                        return false;
+            }
+
+            // Check the loop region, the crossfade needs the data before the start of the loop
+            ssize_t loop_start = 0, loop_end = 0, loop_fade = 0;
+            if ((loop != NULL) && (loop->nEnd > loop->nStart))
+            {
+                if (loop->nEnd > length)
+                    return false;
+                loop_start      = loop->nStart;
+                loop_end        = loop->nEnd;
+                loop_fade       = lsp_min(loop->nFade, lsp_min(loop->nStart, loop->nEnd - loop->nStart));
+            }
 
             // Try to acquire playback
-            playback_t *pb  = list_remove_first(&sInactive);
-            if (pb == NULL)
-                pb              = list_remove_first(&sActive);
+            playback_t *pb  = acquire();
             if (pb == NULL)
                 return false;
 
@@ -397,15 +1213,38 @@ namespace lsp
 
             // Now we are ready to activate sample
             pb->pSample     = s;
+            pb->pStream     = ss;
             pb->nID         = id;
-            pb->nChannel    = channel;
+            if (map != NULL)
+                pb->sMap        = *map;
+            else
+            {
+                pb->sMap.nChannels  = lsp_min(channels, size_t(SAMPLE_PLAYER_CHANNELS));
+                for (size_t i=0; i<pb->sMap.nChannels; ++i)
+                {
+                    pb->sMap.vChannel[i]    = i;
+                    pb->sMap.vOutput[i]     = i;
+                    pb->sMap.vGain[i]       = 1.0f;
+                }
+            }
+            pb->nChannel    = pb->sMap.vChannel[0];
             pb->nVolume     = volume;
             pb->nOffset     = -delay;
             pb->nFadeout    = -1;  // No fadeout
             pb->nFadeOffset = -1; // No cancellation
+            pb->nPriority   = volume_priority(volume);
+            pb->fRate       = rate;
+            pb->fPosition   = 0.0;
+            pb->nLoopStart  = loop_start;
+            pb->nLoopEnd    = loop_end;
+            pb->nLoopFade   = loop_fade;
+
+            // Ask the stream to load the head of the sample
+            if (ss != NULL)
+                ss->prefetch(0);
 
             // Add the playback to the active list
-            list_insert_from_tail(&sActive, pb);
+            activate(pb);
 
             return true;
         }
@@ -418,65 +1257,36 @@ namespace lsp
 
             ssize_t result = 0;
 
-            // Get first playback
-            playback_t *pb      = sActive.pHead;
-            if (pb == NULL)
-                return result;
-
-            // Stop all playbacks
-            do
+            for (size_t i=0; i<nActive; ++i)
             {
-                // Remember next playback
-                playback_t *next        = pb->pNext;
+                playback_t *pb          = vActive[i];
 
                 // Cancel playback if not already cancelled
                 if ((pb->nID == ssize_t(id)) &&
-                    (pb->pSample != NULL) &&
+                    ((pb->pSample != NULL) || (pb->pStream != NULL)) &&
                     (pb->nFadeout < 0))
                 {
                     pb->nFadeout    = fadeout;
                     pb->nFadeOffset = -delay;
                     result          ++;
 
+                    // Cancelled playbacks are stolen first
+                    list_remove(&vSteal[pb->nPriority], pb);
+                    pb->nPriority   = 0;
+                    list_add_last(&vSteal[pb->nPriority], pb);
+
     //                lsp_trace("marked playback %p for cancelling", pb);
                 }
-
-                // Iterate to next playback
-                pb                      = next;
-            } while (pb != NULL);
+            }
 
             return result;
         }
 
         void SamplePlayer::stop()
         {
-            // Get first playback
-            playback_t *pb      = sActive.pHead;
-            if (pb == NULL)
-                return;
-
             // Stop all playbacks
-            do
-            {
-                // Cancel playback
-                cleanup(pb);
-
-                // Iterate next playback
-                pb                      = pb->pNext;
-            } while (pb != NULL);
-
-            // Move all data from active list to inactive
-            if (sInactive.pHead == NULL)
-                sInactive.pTail         = sActive.pTail;
-            else
-            {
-                sActive.pTail->pNext    = sInactive.pHead;
-                sInactive.pHead->pPrev  = sActive.pTail;
-            }
-
-            sInactive.pHead     = sActive.pHead;
-            sActive.pHead       = NULL;
-            sActive.pTail       = NULL;
+            while (nActive > 0)
+                deactivate(vActive[nActive - 1]);
         }
 
         void SamplePlayer::dump_list(IStateDumper *v, const char *name, const list_t *l)
@@ -497,6 +1307,7 @@ namespace lsp
                     v->write_object(vSamples[i]);
             }
             v->end_array();
+            v->writev("vStreams", vStreams, nSamples);
             v->write("nSamples", nSamples);
 
             v->begin_array("vPlayback", vPlayback, nPlayback);
@@ -507,12 +1318,34 @@ namespace lsp
                     v->begin_object(p, sizeof(playback_t));
                     {
                         v->write("pSample", p->pSample);
+                        v->write("pStream", p->pStream);
                         v->write("nID", p->nID);
                         v->write("nChannel", p->nChannel);
+                        v->begin_array("sMap", p->sMap.vChannel, p->sMap.nChannels);
+                        {
+                            for (size_t j=0; j<p->sMap.nChannels; ++j)
+                            {
+                                v->begin_object(&p->sMap.vChannel[j], sizeof(size_t));
+                                {
+                                    v->write("nChannel", p->sMap.vChannel[j]);
+                                    v->write("nOutput", p->sMap.vOutput[j]);
+                                    v->write("fGain", p->sMap.vGain[j]);
+                                }
+                                v->end_object();
+                            }
+                        }
+                        v->end_array();
                         v->write("nOffset", p->nOffset);
                         v->write("nFadeout", p->nFadeout);
                         v->write("nFadeOffset", p->nFadeOffset);
                         v->write("nVolume", p->nVolume);
+                        v->write("nIndex", p->nIndex);
+                        v->write("nPriority", p->nPriority);
+                        v->write("fRate", p->fRate);
+                        v->write("fPosition", p->fPosition);
+                        v->write("nLoopStart", p->nLoopStart);
+                        v->write("nLoopEnd", p->nLoopEnd);
+                        v->write("nLoopFade", p->nLoopFade);
                         v->write("pNext", p->pNext);
                         v->write("pPrev", p->pPrev);
                     }
@@ -522,10 +1355,36 @@ namespace lsp
             v->end_array();
             v->write("nPlayback", nPlayback);
 
-            dump_list(v, "sActive", &sActive);
+            v->writev("vActive", vActive, nPlayback);
+            v->write("nActive", nActive);
+            v->begin_array("vSteal", vSteal, SAMPLE_PLAYER_PRIORITIES);
+            {
+                for (size_t i=0; i<SAMPLE_PLAYER_PRIORITIES; ++i)
+                {
+                    const list_t *l = &vSteal[i];
+                    v->begin_object(l, sizeof(list_t));
+                    {
+                        v->write("pHead", l->pHead);
+                        v->write("pTail", l->pTail);
+                    }
+                    v->end_object();
+                }
+            }
+            v->end_array();
             dump_list(v, "sInactive", &sInactive);
 
             v->write("fGain", fGain);
+            v->write("enInterpolation", enInterpolation);
+            v->writev("vSinc", vSinc, (SAMPLE_PLAYER_SINC_PHASES + 1) * SAMPLE_PLAYER_SINC_TAPS);
+            v->write("nTimestamp", nTimestamp);
+            v->write("vCommands", vCommands);
+            v->write("nCmdMask", nCmdMask);
+            v->write("nCmdHead", nCmdHead);
+            v->write("nCmdTail", nCmdTail);
+            v->writev("vGarbage", vGarbage, (vGarbage != NULL) ? nCmdMask + 1 : 0);
+            v->write("nGcHead", nGcHead);
+            v->write("nGcTail", nGcTail);
+            v->write("nGcReserved", nGcReserved);
         }
     }
 } /* namespace lsp */
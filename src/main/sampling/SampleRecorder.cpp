@@ -0,0 +1,336 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/dsp-units/sampling/SampleRecorder.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/ipc/Thread.h>
+#include <lsp-plug.in/mm/OutAudioFileStream.h>
+
+#define CAPACITY_MIN            0x400
+#define CHUNK_MIN               0x100
+
+namespace lsp
+{
+    namespace dspu
+    {
+        class SampleRecorder::Writer: public ipc::Thread
+        {
+            private:
+                SampleRecorder     *pRecorder;
+                volatile bool       bCancel;
+
+            public:
+                explicit Writer(SampleRecorder *recorder)
+                {
+                    pRecorder   = recorder;
+                    bCancel     = false;
+                }
+
+                virtual ~Writer()
+                {
+                }
+
+            public:
+                inline void         stop()      { bCancel = true; }
+
+                virtual status_t run()
+                {
+                    while (!bCancel)
+                    {
+                        // Sleep if there is not enough data for the chunk
+                        if (!pRecorder->drain(false))
+                            ipc::Thread::sleep(1);
+                    }
+
+                    // Write the remaining data
+                    while (pRecorder->drain(true))
+                        /* nothing */ ;
+
+                    return STATUS_OK;
+                }
+        };
+
+        SampleRecorder::SampleRecorder()
+        {
+            construct();
+        }
+
+        SampleRecorder::~SampleRecorder()
+        {
+            destroy();
+        }
+
+        void SampleRecorder::construct()
+        {
+            pStream         = NULL;
+            pFile           = NULL;
+            pWriter         = NULL;
+            vBuffer         = NULL;
+            nChannels       = 0;
+            nCapacity       = 0;
+            nChunk          = 0;
+            nHead           = 0;
+            nTail           = 0;
+            nDropped        = 0;
+            nWritten        = 0;
+            nStatus         = STATUS_OK;
+            pData           = NULL;
+        }
+
+        void SampleRecorder::destroy()
+        {
+            close();
+        }
+
+        void SampleRecorder::release()
+        {
+            free_aligned(pData);
+
+            vBuffer         = NULL;
+            nChannels       = 0;
+            nCapacity       = 0;
+            nChunk          = 0;
+            nHead           = 0;
+            nTail           = 0;
+        }
+
+        status_t SampleRecorder::open(const char *path, size_t channels, size_t sample_rate, size_t capacity, size_t chunk)
+        {
+            io::Path p;
+            status_t res = p.set(path);
+            return (res == STATUS_OK) ? open(&p, channels, sample_rate, capacity, chunk) : res;
+        }
+
+        status_t SampleRecorder::open(const LSPString *path, size_t channels, size_t sample_rate, size_t capacity, size_t chunk)
+        {
+            io::Path p;
+            status_t res = p.set(path);
+            return (res == STATUS_OK) ? open(&p, channels, sample_rate, capacity, chunk) : res;
+        }
+
+        status_t SampleRecorder::open(const io::Path *path, size_t channels, size_t sample_rate, size_t capacity, size_t chunk)
+        {
+            if ((channels <= 0) || (sample_rate <= 0))
+                return STATUS_BAD_ARGUMENTS;
+
+            mm::OutAudioFileStream *out = new mm::OutAudioFileStream();
+            if (out == NULL)
+                return STATUS_NO_MEM;
+
+            mm::audio_stream_t fmt;
+            fmt.srate       = sample_rate;
+            fmt.channels    = channels;
+            fmt.frames      = 0;            // The length is not known in advance
+            fmt.format      = mm::SFMT_F32;
+
+            status_t res = out->open(path, &fmt, mm::AFMT_WAV | mm::CFMT_PCM);
+            if (res == STATUS_OK)
+                res = open(out, channels, capacity, chunk);
+            if (res != STATUS_OK)
+            {
+                out->close();
+                delete out;
+                return res;
+            }
+
+            // The stream is owned by the object now
+            pFile           = out;
+            return STATUS_OK;
+        }
+
+        status_t SampleRecorder::open(mm::IOutAudioStream *out, size_t channels, size_t capacity, size_t chunk)
+        {
+            if ((out == NULL) || (channels <= 0))
+                return STATUS_BAD_ARGUMENTS;
+
+            // Compute the geometry of the ring buffer, one frame of the ring is always kept free
+            size_t cap      = CAPACITY_MIN;
+            while (cap < capacity)
+                cap           <<= 1;
+            chunk           = lsp_limit(chunk, size_t(CHUNK_MIN), cap >> 1);
+
+            uint8_t *data   = NULL;
+            float *ptr      = alloc_aligned<float>(data, cap * channels);
+            if (ptr == NULL)
+                return STATUS_NO_MEM;
+
+            // Stop previous recording and commit the new state
+            close();
+
+            pData           = data;
+            vBuffer         = ptr;
+            pStream         = out;
+            nChannels       = channels;
+            nCapacity       = cap;
+            nChunk          = chunk;
+            nHead           = 0;
+            nTail           = 0;
+            nDropped        = 0;
+            nWritten        = 0;
+            nStatus         = STATUS_OK;
+
+            // Start the writer
+            status_t res    = STATUS_OK;
+            pWriter         = new Writer(this);
+            if (pWriter == NULL)
+                res             = STATUS_NO_MEM;
+            else if ((res = pWriter->start()) != STATUS_OK)
+            {
+                delete pWriter;
+                pWriter         = NULL;
+            }
+
+            if (res != STATUS_OK)
+            {
+                release();
+                pStream         = NULL;
+            }
+
+            return res;
+        }
+
+        status_t SampleRecorder::close()
+        {
+            // Stop the writer, it writes the remaining data before exit
+            if (pWriter != NULL)
+            {
+                pWriter->stop();
+                pWriter->join();
+                delete pWriter;
+                pWriter         = NULL;
+            }
+
+            release();
+
+            // Close the owned stream
+            status_t res    = nStatus;
+            if (pFile != NULL)
+            {
+                status_t cres   = pFile->close();
+                if (res == STATUS_OK)
+                    res             = cres;
+                delete pFile;
+                pFile           = NULL;
+            }
+            pStream         = NULL;
+            nStatus         = STATUS_OK;
+
+            return res;
+        }
+
+        bool SampleRecorder::drain(bool flush)
+        {
+            // Only the writer modifies the tail
+            const size_t mask   = nCapacity - 1;
+            size_t tail         = nTail;
+            size_t head         = atomic_add(&nHead, 0);
+            size_t avail        = (head - tail) & mask;
+            if ((avail <= 0) || ((!flush) && (avail < nChunk)))
+                return false;
+
+            // Write the contiguous part of the ring buffer
+            size_t to_do        = lsp_min(avail, nCapacity - tail);
+            to_do               = lsp_min(to_do, nChunk);
+            size_t done         = 0;
+            while ((done < to_do) && (nStatus == STATUS_OK))
+            {
+                ssize_t nframes     = pStream->write(&vBuffer[(tail + done) * nChannels], to_do - done);
+                if (nframes < 0)
+                    nStatus             = status_t(-nframes);
+                else if (nframes == 0)
+                    nStatus             = STATUS_EOF;
+                else
+                    done               += nframes;
+            }
+            nWritten           += done;
+
+            // The data that could not be written is discarded to keep the recording going
+            atomic_swap(&nTail, atomic_t((tail + to_do) & mask));
+
+            return true;
+        }
+
+        size_t SampleRecorder::write(const float * const *src, size_t count)
+        {
+            if (vBuffer == NULL)
+                return 0;
+
+            // Only the audio thread modifies the head
+            const size_t mask   = nCapacity - 1;
+            size_t head         = nHead;
+            size_t tail         = atomic_add(&nTail, 0);
+            size_t space        = (tail - head - 1) & mask;
+            size_t n            = lsp_min(count, space);
+            if (n < count)
+                atomic_add(&nDropped, atomic_t(count - n));
+
+            // Interleave the data into the ring buffer
+            for (size_t off=0; off < n; )
+            {
+                size_t to_do        = lsp_min(n - off, nCapacity - head);
+                float *dst          = &vBuffer[head * nChannels];
+
+                for (size_t i=0; i<nChannels; ++i)
+                {
+                    const float *s      = (src[i] != NULL) ? &src[i][off] : NULL;
+                    float *d            = &dst[i];
+                    if (s != NULL)
+                    {
+                        for (size_t j=0; j<to_do; ++j, d += nChannels)
+                            *d                  = s[j];
+                    }
+                    else
+                    {
+                        for (size_t j=0; j<to_do; ++j, d += nChannels)
+                            *d                  = 0.0f;
+                    }
+                }
+
+                head                = (head + to_do) & mask;
+                off                += to_do;
+            }
+
+            // Publish the data
+            atomic_swap(&nHead, atomic_t(head));
+
+            return n;
+        }
+
+        void SampleRecorder::dump(IStateDumper *v) const
+        {
+            v->write("pStream", pStream);
+            v->write("pFile", pFile);
+            v->write("pWriter", pWriter);
+            v->write("vBuffer", vBuffer);
+            v->write("nChannels", nChannels);
+            v->write("nCapacity", nCapacity);
+            v->write("nChunk", nChunk);
+            v->write("nHead", nHead);
+            v->write("nTail", nTail);
+            v->write("nDropped", nDropped);
+            v->write("nWritten", nWritten);
+            v->write("nStatus", nStatus);
+            v->write("pData", pData);
+        }
+    }
+} /* namespace lsp */
@@ -0,0 +1,435 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/dsp-units/sampling/SampleStream.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/ipc/Thread.h>
+#include <lsp-plug.in/mm/InAudioFileStream.h>
+
+#define PAGE_SIZE_MIN           0x100
+#define PAGES_MIN               2
+
+namespace lsp
+{
+    namespace dspu
+    {
+        class SampleStream::Reader: public ipc::Thread
+        {
+            private:
+                SampleStream       *pStream;
+                volatile bool       bCancel;
+
+            public:
+                explicit Reader(SampleStream *stream)
+                {
+                    pStream     = stream;
+                    bCancel     = false;
+                }
+
+                virtual ~Reader()
+                {
+                }
+
+            public:
+                inline void         stop()      { bCancel = true; }
+
+                virtual status_t run()
+                {
+                    while (!bCancel)
+                    {
+                        // Sleep if all pages ahead of the read position are loaded
+                        if (!pStream->fill())
+                            ipc::Thread::sleep(1);
+                    }
+
+                    return STATUS_OK;
+                }
+        };
+
+        SampleStream::SampleStream()
+        {
+            construct();
+        }
+
+        SampleStream::~SampleStream()
+        {
+            destroy();
+        }
+
+        void SampleStream::construct()
+        {
+            pStream         = NULL;
+            pFile           = NULL;
+            pReader         = NULL;
+            vPages          = NULL;
+            vBuffer         = NULL;
+            nChannels       = 0;
+            nSampleRate     = 0;
+            nLength         = 0;
+            nPosition       = -1;
+            nPageSize       = 0;
+            nPageShift      = 0;
+            nPages          = 0;
+            nHint           = 0;
+            nUnderruns      = 0;
+            pData           = NULL;
+        }
+
+        void SampleStream::destroy()
+        {
+            close();
+        }
+
+        void SampleStream::release()
+        {
+            free_aligned(pData);
+
+            vPages          = NULL;
+            vBuffer         = NULL;
+            nChannels       = 0;
+            nSampleRate     = 0;
+            nLength         = 0;
+            nPosition       = -1;
+            nPageSize       = 0;
+            nPageShift      = 0;
+            nPages          = 0;
+            nHint           = 0;
+            nUnderruns      = 0;
+        }
+
+        status_t SampleStream::open(const char *path, size_t pages, size_t page_size)
+        {
+            io::Path p;
+            status_t res = p.set(path);
+            return (res == STATUS_OK) ? open(&p, pages, page_size) : res;
+        }
+
+        status_t SampleStream::open(const LSPString *path, size_t pages, size_t page_size)
+        {
+            io::Path p;
+            status_t res = p.set(path);
+            return (res == STATUS_OK) ? open(&p, pages, page_size) : res;
+        }
+
+        status_t SampleStream::open(const io::Path *path, size_t pages, size_t page_size)
+        {
+            mm::InAudioFileStream *in = new mm::InAudioFileStream();
+            if (in == NULL)
+                return STATUS_NO_MEM;
+
+            status_t res = in->open(path);
+            if (res == STATUS_OK)
+                res = open(in, pages, page_size);
+            if (res != STATUS_OK)
+            {
+                in->close();
+                delete in;
+                return res;
+            }
+
+            // The stream is owned by the object now
+            pFile           = in;
+            return STATUS_OK;
+        }
+
+        status_t SampleStream::open(mm::IInAudioStream *in, size_t pages, size_t page_size)
+        {
+            if (in == NULL)
+                return STATUS_BAD_ARGUMENTS;
+
+            mm::audio_stream_t fmt;
+            status_t res = in->info(&fmt);
+            if (res != STATUS_OK)
+                return res;
+            if ((fmt.channels <= 0) || (fmt.frames < 0))
+                return STATUS_BAD_FORMAT;
+
+            // Compute the geometry of the cache
+            size_t shift    = 0;
+            while ((size_t(1) << shift) < lsp_max(page_size, size_t(PAGE_SIZE_MIN)))
+                ++shift;
+            size_t n_pages  = PAGES_MIN;
+            while (n_pages < pages)
+                n_pages       <<= 1;
+            if ((wsize_t(fmt.frames) >> shift) >= wsize_t(0x7fffffff))
+                return STATUS_OVERFLOW;
+
+            size_t pg_size  = size_t(1) << shift;
+            size_t szof_pages   = align_size(sizeof(page_t) * n_pages, DEFAULT_ALIGN);
+            size_t szof_page    = align_size(sizeof(float) * fmt.channels * pg_size, DEFAULT_ALIGN);
+            size_t to_alloc     = szof_pages + szof_page * (n_pages + 1);
+
+            uint8_t *data       = NULL;
+            uint8_t *ptr        = alloc_aligned<uint8_t>(data, to_alloc);
+            if (ptr == NULL)
+                return STATUS_NO_MEM;
+
+            // Close previously opened stream and commit the new state
+            close();
+
+            pData           = data;
+            vPages          = reinterpret_cast<page_t *>(ptr);
+            ptr            += szof_pages;
+            vBuffer         = reinterpret_cast<float *>(ptr);
+            ptr            += szof_page;
+
+            for (size_t i=0; i<n_pages; ++i)
+            {
+                page_t *pg      = &vPages[i];
+                pg->vData       = reinterpret_cast<float *>(ptr);
+                pg->nIndex      = -1;
+                pg->nSerial     = 0;
+                ptr            += szof_page;
+            }
+
+            pStream         = in;
+            nChannels       = fmt.channels;
+            nSampleRate     = fmt.srate;
+            nLength         = fmt.frames;
+            nPosition       = -1;
+            nPageSize       = pg_size;
+            nPageShift      = shift;
+            nPages          = n_pages;
+            nHint           = 0;
+            nUnderruns      = 0;
+
+            // Start the reader
+            pReader         = new Reader(this);
+            if (pReader == NULL)
+                res             = STATUS_NO_MEM;
+            else if ((res = pReader->start()) != STATUS_OK)
+            {
+                delete pReader;
+                pReader         = NULL;
+            }
+
+            if (res != STATUS_OK)
+            {
+                release();
+                pStream         = NULL;
+            }
+
+            return res;
+        }
+
+        status_t SampleStream::close()
+        {
+            // Stop the reader
+            if (pReader != NULL)
+            {
+                pReader->stop();
+                pReader->join();
+                delete pReader;
+                pReader         = NULL;
+            }
+
+            release();
+
+            // Close the owned stream
+            status_t res    = STATUS_OK;
+            if (pFile != NULL)
+            {
+                res             = pFile->close();
+                delete pFile;
+                pFile           = NULL;
+            }
+            pStream         = NULL;
+
+            return res;
+        }
+
+        bool SampleStream::fill()
+        {
+            atomic_t hint   = atomic_add(&nHint, 0);
+
+            for (size_t i=0; i<nPages; ++i)
+            {
+                atomic_t index  = hint + i;
+                if ((wsize_t(index) << nPageShift) >= nLength)
+                    break;
+
+                // Only the reader modifies pages, so the index can be checked without barrier
+                page_t *pg      = &vPages[index & (nPages - 1)];
+                if (pg->nIndex == index)
+                    continue;
+
+                load_page(pg, index);
+                return true;
+            }
+
+            return false;
+        }
+
+        void SampleStream::load_page(page_t *pg, atomic_t index)
+        {
+            // Mark the page as being updated
+            atomic_add(&pg->nSerial, 1);
+            atomic_swap(&pg->nIndex, index);
+
+            wsize_t offset  = wsize_t(index) << nPageShift;
+            size_t count    = lsp_min(nLength - offset, wsize_t(nPageSize));
+            size_t done     = 0;
+
+            // Position the stream and read the page
+            if (nPosition != wssize_t(offset))
+            {
+                wssize_t pos    = pStream->seek(offset);
+                nPosition       = (pos >= 0) ? pos : -1;
+            }
+            if (nPosition == wssize_t(offset))
+            {
+                while (done < count)
+                {
+                    ssize_t nframes = pStream->read(&vBuffer[done * nChannels], count - done);
+                    if (nframes <= 0)
+                        break;
+                    done           += nframes;
+                }
+                nPosition      += done;
+            }
+
+            // Unpack the buffer, the data that could not be read is replaced with silence
+            for (size_t i=0; i<nChannels; ++i)
+            {
+                const float *src    = &vBuffer[i];
+                float *dst          = &pg->vData[i * nPageSize];
+                for (size_t j=0; j<done; ++j, src += nChannels)
+                    dst[j]              = *src;
+                dsp::fill_zero(&dst[done], nPageSize - done);
+            }
+
+            // Publish the page
+            atomic_add(&pg->nSerial, 1);
+        }
+
+        void SampleStream::prefetch(wsize_t offset)
+        {
+            if (vPages == NULL)
+                return;
+
+            atomic_t index  = atomic_t(lsp_min(offset, nLength) >> nPageShift);
+            if (atomic_add(&nHint, 0) != index)
+                atomic_swap(&nHint, index);
+        }
+
+        bool SampleStream::ready(wsize_t offset)
+        {
+            if ((vPages == NULL) || (offset >= nLength))
+                return false;
+
+            atomic_t index  = atomic_t(offset >> nPageShift);
+            page_t *pg      = &vPages[index & (nPages - 1)];
+            atomic_t serial = atomic_add(&pg->nSerial, 0);
+
+            return (!(serial & 1)) && (atomic_add(&pg->nIndex, 0) == index);
+        }
+
+        size_t SampleStream::read(size_t channel, float *dst, wsize_t offset, size_t count)
+        {
+            if ((vPages == NULL) || (channel >= nChannels))
+            {
+                dsp::fill_zero(dst, count);
+                return 0;
+            }
+
+            prefetch(offset);
+
+            size_t done     = 0;
+            bool miss       = false;
+
+            while (count > 0)
+            {
+                // The tail after the end of the stream is silence
+                if (offset >= nLength)
+                {
+                    dsp::fill_zero(dst, count);
+                    break;
+                }
+
+                atomic_t index  = atomic_t(offset >> nPageShift);
+                size_t head     = offset & (nPageSize - 1);
+                size_t to_do    = lsp_min(count, nPageSize - head);
+                to_do           = lsp_min(wsize_t(to_do), nLength - offset);
+
+                // Copy the page data and then ensure that the page has not been modified while copying
+                page_t *pg      = &vPages[index & (nPages - 1)];
+                atomic_t serial = atomic_add(&pg->nSerial, 0);
+                bool hit        = (!(serial & 1)) && (atomic_add(&pg->nIndex, 0) == index);
+                if (hit)
+                {
+                    dsp::copy(dst, &pg->vData[channel * nPageSize + head], to_do);
+                    hit             = atomic_add(&pg->nSerial, 0) == serial;
+                }
+
+                if (hit)
+                    done           += to_do;
+                else
+                {
+                    dsp::fill_zero(dst, to_do);
+                    miss            = true;
+                }
+
+                dst            += to_do;
+                offset         += to_do;
+                count          -= to_do;
+            }
+
+            if (miss)
+                atomic_add(&nUnderruns, 1);
+
+            return done;
+        }
+
+        void SampleStream::dump(IStateDumper *v) const
+        {
+            v->write("pStream", pStream);
+            v->write("pFile", pFile);
+            v->write("pReader", pReader);
+            v->begin_array("vPages", vPages, nPages);
+            {
+                for (size_t i=0; i<nPages; ++i)
+                {
+                    const page_t *pg = &vPages[i];
+                    v->begin_object(pg, sizeof(page_t));
+                    {
+                        v->write("vData", pg->vData);
+                        v->write("nIndex", pg->nIndex);
+                        v->write("nSerial", pg->nSerial);
+                    }
+                    v->end_object();
+                }
+            }
+            v->end_array();
+            v->write("vBuffer", vBuffer);
+            v->write("nChannels", nChannels);
+            v->write("nSampleRate", nSampleRate);
+            v->write("nLength", nLength);
+            v->write("nPosition", nPosition);
+            v->write("nPageSize", nPageSize);
+            v->write("nPageShift", nPageShift);
+            v->write("nPages", nPages);
+            v->write("nHint", nHint);
+            v->write("nUnderruns", nUnderruns);
+            v->write("pData", pData);
+        }
+    }
+}
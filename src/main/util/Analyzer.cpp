@@ -21,16 +21,31 @@
 
 #include <lsp-plug.in/dsp-units/util/Analyzer.h>
 #include <lsp-plug.in/dsp-units/misc/envelope.h>
+#include <lsp-plug.in/dsp-units/misc/fft.h>
+#include <lsp-plug.in/dsp-units/misc/pages.h>
 #include <lsp-plug.in/dsp-units/misc/windows.h>
 #include <lsp-plug.in/dsp-units/units.h>
+#include <lsp-plug.in/dsp-units/const.h>
 #include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/stdlib/string.h>
 #include <lsp-plug.in/common/alloc.h>
 #include <lsp-plug.in/dsp/dsp.h>
 
+#define ANALYZER_LEAF_RANK      9       /* Rank of the smallest transform of the amortized FFT */
+#define ANALYZER_REDUCE_SIZE    0x100   /* Size of the stack buffer for reduction of bin ranges */
+
 namespace lsp
 {
     namespace dspu
     {
+        static inline size_t reverse_bits(size_t v, size_t bits)
+        {
+            size_t r = 0;
+            for (size_t i=0; i<bits; ++i, v >>= 1)
+                r   = (r << 1) | (v & 1);
+            return r;
+        }
+
         Analyzer::Analyzer()
         {
             construct();
@@ -43,8 +58,11 @@ namespace lsp
 
         void Analyzer::construct()
         {
+            sPerf.construct();
+
             nChannels       = 0;
             nMaxRank        = 0;
+            nCapRank        = 0;
             nRank           = 0;
             nSampleRate     = 0;
             nMaxSampleRate  = 0;
@@ -62,6 +80,9 @@ namespace lsp
             nEnvelope       = envelope::PINK_NOISE;
             nWindow         = windows::HANN;
             bActive         = true;
+            bBatch          = false;
+            bLazy           = false;
+            nFront          = 0;
 
             vChannels       = NULL;
             vData           = NULL;
@@ -69,6 +90,38 @@ namespace lsp
             vFftReIm        = NULL;
             vWindow         = NULL;
             vEnvelope       = NULL;
+            vEnvTable       = NULL;
+
+            vSnapIdx        = NULL;
+            vSnapshot[0]    = NULL;
+            vSnapshot[1]    = NULL;
+            vSnapshot[2]    = NULL;
+            nSnapSize       = 0;
+            nSnapBack       = 0;
+            nSnapFront      = 0;
+            nSnapState      = 0;
+            vSnapData       = NULL;
+
+            vSpgIdx         = NULL;
+            vSpgBuf         = NULL;
+            vSpgRing        = NULL;
+            nSpgSize        = 0;
+            nSpgRows        = 0;
+            nSpgFormat      = SPECTROGRAM_U8;
+            fSpgMin         = -120.0f;
+            fSpgMax         = 24.0f;
+            nSpgPosition    = 0;
+            vSpgData        = NULL;
+
+            vTwiddle        = NULL;
+            nJobChannel     = 0;
+            nJobEnd         = 0;
+            nJobHead        = 0;
+            nJobStage       = 0;
+            nJobPos         = 0;
+            nJobDone        = 0;
+            nJobTotal       = 0;
+            bAmortize       = false;
         }
 
         void Analyzer::destroy()
@@ -79,38 +132,239 @@ namespace lsp
                 vChannels   = NULL;
             }
 
-            free_aligned(vData);
+            pages::free_aligned(vData);
+            nCapRank    = 0;
+            nBufSize    = 0;
+            windows::release(vWindow);
+            vWindow     = NULL;
+            envelope::release(vEnvTable);
+            vEnvTable   = NULL;
+            destroy_snapshot();
+            destroy_spectrogram();
         }
 
-        bool Analyzer::init(size_t channels, size_t max_rank, size_t max_sr, float min_rate)
+        void Analyzer::destroy_snapshot()
         {
-            destroy();
+            free_aligned(vSnapData);
+            vSnapIdx        = NULL;
+            vSnapshot[0]    = NULL;
+            vSnapshot[1]    = NULL;
+            vSnapshot[2]    = NULL;
+            nSnapSize       = 0;
+        }
 
-            size_t fft_size         = 1 << max_rank;
-            nBufSize                = align_size(fft_size + size_t(float(max_sr * 2) / min_rate) + DEFAULT_ALIGN, DEFAULT_ALIGN);
-            size_t allocate         = 5 * fft_size +                // vSigRe, vFftReIm (re + im), vWindow, vEnvelope
-                                      channels * nBufSize +         // c->vBuffer
-                                      channels * fft_size +         // c->vAmp
-                                      channels * fft_size;          // c->vData
+        bool Analyzer::init_snapshot(const uint32_t *idx, size_t count)
+        {
+            if ((idx == NULL) || (count <= 0))
+            {
+                destroy_snapshot();
+                return true;
+            }
 
-            // Allocate data
-            float *abuf         = alloc_aligned<float>(vData, allocate);
-            if (abuf == NULL)
+            size_t szof_idx     = align_size(count * sizeof(uint32_t), DEFAULT_ALIGN);
+            size_t szof_snap    = align_size(nChannels * count * sizeof(float), DEFAULT_ALIGN);
+            void *data          = NULL;
+            uint8_t *ptr        = alloc_aligned<uint8_t>(data, szof_idx + szof_snap * 3);
+            if (ptr == NULL)
                 return false;
 
-            // Allocate channels
-            channel_t *clist    = new channel_t[channels];
-            if (clist == NULL)
+            destroy_snapshot();
+            vSnapData           = data;
+
+            // Initialize buffers
+            vSnapIdx            = reinterpret_cast<uint32_t *>(ptr);
+            ptr                += szof_idx;
+            for (size_t i=0; i<3; ++i)
             {
-                delete [] abuf;
+                vSnapshot[i]        = reinterpret_cast<float *>(ptr);
+                ptr                += szof_snap;
+                dsp::fill_zero(vSnapshot[i], nChannels * count);
+            }
+
+            // Copy index map, limit indexes to the maximum size of FFT data
+            size_t max_idx      = (1 << nMaxRank) - 1;
+            for (size_t i=0; i<count; ++i)
+                vSnapIdx[i]         = lsp_min(idx[i], uint32_t(max_idx));
+
+            nSnapSize           = count;
+            nSnapBack           = 0;
+            nSnapFront          = 1;
+            nSnapState          = 2;
+
+            return true;
+        }
+
+        bool Analyzer::fetch_snapshot()
+        {
+            if (nSnapSize <= 0)
+                return false;
+            if (!(atomic_add(&nSnapState, 0) & S_FRESH))
                 return false;
+
+            // Exchange the front buffer with the middle one
+            atomic_t state      = atomic_swap(&nSnapState, atomic_t(nSnapFront));
+            nSnapFront          = state & S_INDEX;
+            return true;
+        }
+
+        const float *Analyzer::snapshot(size_t channel) const
+        {
+            if ((nSnapSize <= 0) || (channel >= nChannels))
+                return NULL;
+            return &vSnapshot[nSnapFront][channel * nSnapSize];
+        }
+
+        void Analyzer::destroy_spectrogram()
+        {
+            free_aligned(vSpgData);
+            vSpgIdx         = NULL;
+            vSpgBuf         = NULL;
+            vSpgRing        = NULL;
+            nSpgSize        = 0;
+            nSpgRows        = 0;
+        }
+
+        bool Analyzer::init_spectrogram(const uint32_t *idx, size_t count, size_t rows,
+                spectrogram_format_t format, float min, float max)
+        {
+            if ((idx == NULL) || (count <= 0) || (rows <= 0))
+            {
+                destroy_spectrogram();
+                return true;
             }
+            if ((max <= min) || ((format != SPECTROGRAM_U8) && (format != SPECTROGRAM_U16)))
+                return false;
 
-            nChannels           = channels;
-            nMaxRank            = max_rank;
-            nRank               = max_rank;
-            nMaxSampleRate      = max_sr;
-            fMinRate            = min_rate;
+            size_t szof_elem    = (format == SPECTROGRAM_U16) ? sizeof(uint16_t) : sizeof(uint8_t);
+            size_t szof_idx     = align_size(count * sizeof(uint32_t), DEFAULT_ALIGN);
+            size_t szof_buf     = align_size(count * sizeof(float), DEFAULT_ALIGN);
+            size_t szof_ring    = align_size(count * rows * 2 * szof_elem, DEFAULT_ALIGN);
+            void *data          = NULL;
+            uint8_t *ptr        = alloc_aligned<uint8_t>(data, szof_idx + szof_buf + szof_ring * nChannels);
+            if (ptr == NULL)
+                return false;
+
+            destroy_spectrogram();
+            vSpgData            = data;
+
+            // Initialize buffers
+            vSpgIdx             = reinterpret_cast<uint32_t *>(ptr);
+            ptr                += szof_idx;
+            vSpgBuf             = reinterpret_cast<float *>(ptr);
+            ptr                += szof_buf;
+            vSpgRing            = ptr;
+            ptr                += szof_ring * nChannels;
+            memset(vSpgRing, 0, szof_ring * nChannels);
+
+            // Copy index map, limit indexes to the maximum size of FFT data
+            size_t max_idx      = (1 << nMaxRank) - 1;
+            for (size_t i=0; i<count; ++i)
+                vSpgIdx[i]          = lsp_min(idx[i], uint32_t(max_idx));
+
+            nSpgSize            = count;
+            nSpgRows            = rows;
+            nSpgFormat          = format;
+            fSpgMin             = min;
+            fSpgMax             = max;
+            nSpgPosition        = 0;
+
+            return true;
+        }
+
+        size_t Analyzer::spectrogram_position() const
+        {
+            return atomic_add(const_cast<atomic_t *>(&nSpgPosition), 0);
+        }
+
+        const void *Analyzer::spectrogram(size_t channel, size_t position) const
+        {
+            if ((nSpgSize <= 0) || (channel >= nChannels))
+                return NULL;
+
+            size_t szof_elem    = (nSpgFormat == SPECTROGRAM_U16) ? sizeof(uint16_t) : sizeof(uint8_t);
+            size_t szof_ring    = align_size(nSpgSize * nSpgRows * 2 * szof_elem, DEFAULT_ALIGN);
+            size_t first        = position % nSpgRows;
+            return &vSpgRing[channel * szof_ring + first * nSpgSize * szof_elem];
+        }
+
+        float Analyzer::spectrogram_level(size_t value) const
+        {
+            float range         = (nSpgFormat == SPECTROGRAM_U16) ? 65535.0f : 255.0f;
+            return fSpgMin + value * (fSpgMax - fSpgMin) / range;
+        }
+
+        void Analyzer::append_spectrogram(size_t back)
+        {
+            size_t szof_elem    = (nSpgFormat == SPECTROGRAM_U16) ? sizeof(uint16_t) : sizeof(uint8_t);
+            size_t szof_ring    = align_size(nSpgSize * nSpgRows * 2 * szof_elem, DEFAULT_ALIGN);
+            size_t head         = size_t(nSpgPosition) % nSpgRows;
+            float range         = (nSpgFormat == SPECTROGRAM_U16) ? 65535.0f : 255.0f;
+            float scale         = range / (fSpgMax - fSpgMin);
+            float thresh        = expf(fSpgMin * M_LN10 / 20.0f);
+            size_t max_idx      = (size_t(1) << nRank) - 1;
+
+            for (size_t i=0; i<nChannels; ++i)
+            {
+                // Convert the amplitude to the quantized level in one vectorized pass
+                const float *src    = vChannels[i].vData[back];
+                for (size_t j=0; j<nSpgSize; ++j)
+                {
+                    size_t k            = lsp_min(size_t(vSpgIdx[j]), max_idx);
+                    vSpgBuf[j]          = src[k] * vEnvelope[k];
+                }
+                dsp::limit1(vSpgBuf, thresh, FLOAT_SAT_P_INF, nSpgSize);
+                dsp::loge1(vSpgBuf, nSpgSize);
+                dsp::mul_k2(vSpgBuf, scale * 20.0f / M_LN10, nSpgSize);
+                dsp::add_k2(vSpgBuf, 0.5f - fSpgMin * scale, nSpgSize);
+                dsp::limit1(vSpgBuf, 0.0f, range, nSpgSize);
+
+                // Store the row twice to keep the history contiguous
+                uint8_t *ring       = &vSpgRing[i * szof_ring];
+                if (nSpgFormat == SPECTROGRAM_U16)
+                {
+                    uint16_t *r0        = reinterpret_cast<uint16_t *>(ring) + head * nSpgSize;
+                    uint16_t *r1        = r0 + nSpgRows * nSpgSize;
+                    for (size_t j=0; j<nSpgSize; ++j)
+                        r0[j]               = r1[j] = uint16_t(vSpgBuf[j]);
+                }
+                else
+                {
+                    uint8_t *r0         = ring + head * nSpgSize;
+                    uint8_t *r1         = r0 + nSpgRows * nSpgSize;
+                    for (size_t j=0; j<nSpgSize; ++j)
+                        r0[j]               = r1[j] = uint8_t(vSpgBuf[j]);
+                }
+            }
+
+            // Publish the row
+            atomic_add(&nSpgPosition, 1);
+        }
+
+        size_t Analyzer::delay_size(size_t rank, size_t sr, float rate)
+        {
+            return align_size((size_t(1) << rank) + size_t(float(sr * 2) / rate) + DEFAULT_ALIGN, DEFAULT_ALIGN);
+        }
+
+        bool Analyzer::allocate(size_t rank, size_t buf_size)
+        {
+            size_t fft_size         = 1 << rank;
+            size_t allocate         = 5 * fft_size +                // vSigRe, vFftReIm (re + im), vEnvelope, vTwiddle
+                                      nChannels * buf_size +        // c->vBuffer
+                                      nChannels * fft_size +        // c->vAmp
+                                      nChannels * fft_size * 2;     // c->vData
+
+            // Allocate data, keep the previous data on failure
+            void *data          = NULL;
+            float *abuf         = pages::alloc_aligned<float>(data, allocate);
+            if (abuf == NULL)
+                return false;
+
+            pages::free_aligned(vData);
+            vData               = data;
+            nCapRank            = rank;
+            nBufSize            = buf_size;
+            nCounter            = 0;
+            nHead               = 0;
 
             // Clear buffers
             dsp::fill_zero(abuf, allocate);
@@ -120,24 +374,71 @@ namespace lsp
             abuf               += fft_size;
             vFftReIm            = abuf;
             abuf               += fft_size * 2;
-            vWindow             = abuf;
-            abuf               += fft_size;
             vEnvelope           = abuf;
             abuf               += fft_size;
+            vTwiddle            = abuf;
+            abuf               += fft_size;
 
-            // Initialize channels
-            vChannels           = clist;
-            for (size_t i=0; i<channels; ++i)
+            // The twiddle factors are the transform of the unit impulse delayed by one sample,
+            // so they always match the convention of the FFT routines
+            vFftReIm[2]         = 1.0f;
+            dsp::packed_direct_fft(vFftReIm, vFftReIm, rank);
+            dsp::copy(vTwiddle, vFftReIm, fft_size);
+            dsp::fill_zero(vFftReIm, fft_size * 2);
+
+            // Initialize channel buffers
+            for (size_t i=0; i<nChannels; ++i)
             {
                 channel_t *c        = &vChannels[i];
 
-                // FFT buffers
                 c->vBuffer          = abuf;
-                abuf               += nBufSize;
+                abuf               += buf_size;
                 c->vAmp             = abuf;
                 abuf               += fft_size;
-                c->vData            = abuf;
+                c->vData[0]         = abuf;
                 abuf               += fft_size;
+                c->vData[1]         = abuf;
+                abuf               += fft_size;
+            }
+
+            // All the state depends on the buffers
+            nReconfigure        = R_ALL;
+
+            return true;
+        }
+
+        bool Analyzer::init(size_t channels, size_t max_rank, size_t max_sr, float min_rate)
+        {
+            return init(channels, max_rank, max_sr, min_rate, false);
+        }
+
+        bool Analyzer::init(size_t channels, size_t max_rank, size_t max_sr, float min_rate, bool lazy)
+        {
+            destroy();
+
+            // Allocate channels
+            channel_t *clist    = new channel_t[channels];
+            if (clist == NULL)
+                return false;
+
+            nChannels           = channels;
+            nMaxRank            = max_rank;
+            nRank               = max_rank;
+            nMaxSampleRate      = max_sr;
+            fMinRate            = min_rate;
+            bLazy               = lazy;
+
+            // Initialize channels
+            vChannels           = clist;
+            for (size_t i=0; i<channels; ++i)
+            {
+                channel_t *c        = &vChannels[i];
+
+                // FFT buffers
+                c->vBuffer          = NULL;
+                c->vAmp             = NULL;
+                c->vData[0]         = NULL;
+                c->vData[1]         = NULL;
 
                 // Counters
                 c->nDelay           = 0;
@@ -148,9 +449,43 @@ namespace lsp
             // Set reconfiguration flags
             nReconfigure        = R_ALL;
 
+            // Lazy analyzer allocates buffers at the first prepare() call
+            if (lazy)
+                return true;
+
+            if (!allocate(max_rank, delay_size(max_rank, max_sr, min_rate)))
+            {
+                destroy();
+                return false;
+            }
+
             return true;
         }
 
+        bool Analyzer::prepared() const
+        {
+            if (vData == NULL)
+                return false;
+            if (!bLazy)
+                return true;
+
+            return (nRank <= nCapRank) && (delay_size(nRank, nSampleRate, fRate) <= nBufSize);
+        }
+
+        bool Analyzer::prepare()
+        {
+            if (vChannels == NULL)
+                return false;
+            if (prepared())
+                return true;
+
+            // Buffers only grow to avoid reallocations when the settings are toggled back and forth
+            size_t rank         = lsp_max(nRank, nCapRank);
+            size_t buf_size     = lsp_max(delay_size(rank, nSampleRate, fRate), nBufSize);
+
+            return allocate(rank, buf_size);
+        }
+
         void Analyzer::set_sample_rate(size_t sr)
         {
             sr              = lsp_min(sr, nMaxSampleRate);
@@ -218,6 +553,24 @@ namespace lsp
             return true;
         }
 
+        void Analyzer::set_batch(bool batch)
+        {
+            if (bBatch == batch)
+                return;
+
+            bBatch          = batch;
+            nReconfigure   |= R_COUNTERS | R_TAU;
+        }
+
+        void Analyzer::set_amortized(bool amortize)
+        {
+            if (bAmortize == amortize)
+                return;
+
+            bAmortize       = amortize;
+            nReconfigure   |= R_COUNTERS;
+        }
+
         bool Analyzer::freeze_channel(size_t channel, bool freeze)
         {
             if (channel >= nChannels)
@@ -240,19 +593,31 @@ namespace lsp
 
         void Analyzer::reconfigure()
         {
-            if (!nReconfigure)
+            if ((!nReconfigure) || (!prepared()))
                 return;
 
+            LSP_DSP_UNITS_PERF_RECONFIGURE(sPerf);
+
             size_t fft_size     = 1 << nRank;
             size_t fft_period   = float(nSampleRate) / fRate;
-            nStep               = fft_period / nChannels;
-            nPeriod             = nStep * nChannels;
+            nStep               = (bBatch) ? fft_period : fft_period / nChannels;
+            nPeriod             = (bBatch) ? nStep : nStep * nChannels;
 
             // Update envelope
             if (nReconfigure & R_ENVELOPE)
             {
-                envelope::reverse_noise(vEnvelope, fft_size, envelope::envelope_t(nEnvelope));
-                dsp::mul_k2(vEnvelope, fShift / fft_size, fft_size);
+                // Keep the reference to the shared table so that other instances can reuse it
+                const float *env    = envelope::acquire(envelope::envelope_t(nEnvelope), fft_size, true);
+                envelope::release(vEnvTable);
+                vEnvTable           = env;
+
+                if (vEnvTable != NULL)
+                    dsp::mul_k3(vEnvelope, vEnvTable, fShift / fft_size, fft_size);
+                else
+                {
+                    envelope::reverse_noise(vEnvelope, fft_size, envelope::envelope_t(nEnvelope));
+                    dsp::mul_k2(vEnvelope, fShift / fft_size, fft_size);
+                }
             }
 
             // Clear analysis
@@ -261,12 +626,17 @@ namespace lsp
                 for (size_t i=0; i<nChannels; ++i)
                 {
                     dsp::fill_zero(vChannels[i].vAmp, fft_size);
-                    dsp::fill_zero(vChannels[i].vData, fft_size);
+                    dsp::fill_zero(vChannels[i].vData[0], fft_size);
+                    dsp::fill_zero(vChannels[i].vData[1], fft_size);
                 }
             }
             // Update window
             if (nReconfigure & R_WINDOW)
-                windows::window(vWindow, fft_size, windows::window_t(nWindow));
+            {
+                const float *wnd    = windows::acquire(windows::window_t(nWindow), fft_size);
+                windows::release(vWindow);
+                vWindow             = wnd;
+            }
             // Update reactivity
             if (nReconfigure & R_TAU)
                 fTau    = 1.0f - expf(logf(1.0f - M_SQRT1_2) / seconds_to_samples(float(nSampleRate) / float(nPeriod), fReactivity));
@@ -274,16 +644,211 @@ namespace lsp
             if (nReconfigure & R_COUNTERS)
             {
                 for (size_t i=0; i<nChannels; ++i)
-                    vChannels[i].nDelay     = i*nStep;
+                    vChannels[i].nDelay     = (bBatch) ? 0 : i*nStep;
             }
 
+            // Cancel the pending amortized transforms
+            nJobChannel     = 0;
+            nJobEnd         = 0;
+
             // Clear reconfiguration flag and update strobe signal
             nReconfigure    = 0;
         }
 
+        void Analyzer::start_transform(size_t first, size_t count)
+        {
+            // Estimate the work: leaf transforms, butterfly passes and the final mix
+            size_t fft_size     = 1 << nRank;
+            size_t levels       = nRank - lsp_min(nRank, size_t(ANALYZER_LEAF_RANK));
+            size_t cost         = fft_size + (levels + 1) * (fft_size >> 1);
+
+            nJobChannel         = first;
+            nJobEnd             = first + count;
+            nJobHead            = nHead;
+            nJobStage           = 0;
+            nJobPos             = 0;
+            nJobDone            = 0;
+            nJobTotal           = cost * count;
+        }
+
+        void Analyzer::run_transform(size_t limit)
+        {
+            size_t fft_size     = 1 << nRank;
+            size_t half         = fft_size >> 1;
+            size_t leaf_rank    = lsp_min(nRank, size_t(ANALYZER_LEAF_RANK));
+            size_t leaf_size    = 1 << leaf_rank;
+            size_t levels       = nRank - leaf_rank;
+            size_t leaves       = 1 << levels;
+
+            while ((nJobChannel < nJobEnd) && (nJobDone < limit))
+            {
+                channel_t *c        = &vChannels[nJobChannel];
+
+                if ((nJobStage == 0) && (nJobPos == 0) && ((c->bFreeze) || (!bActive) || (!c->bActive)))
+                {
+                    // Frozen channels keep the data, inactive channels are cleared
+                    if (!c->bFreeze)
+                        dsp::fill_zero(c->vAmp, fft_size);
+                    nJobDone           += fft_size + (levels + 1) * half;
+                    ++nJobChannel;
+                    continue;
+                }
+
+                if (nJobStage < leaves)
+                {
+                    // Leaf transform of the decimated windowed frame. The leaf b contains the
+                    // samples with indexes equal to bit-reversed b modulo number of leaves
+                    size_t start        = reverse_bits(nJobStage, levels);
+                    ssize_t doff        = nJobHead - (fft_size + c->nDelay);
+                    if (doff < 0)
+                        doff               += nBufSize;
+
+                    float *dst          = &vSigRe[nJobStage * leaf_size];
+                    float *fft          = &vFftReIm[nJobStage * leaf_size * 2];
+                    for (size_t i=0; i<leaf_size; ++i)
+                    {
+                        size_t idx          = start + (i << levels);
+                        size_t pos          = doff + idx;
+                        if (pos >= nBufSize)
+                            pos                -= nBufSize;
+                        dst[i]              = (vWindow != NULL) ? c->vBuffer[pos] * vWindow[idx] : c->vBuffer[pos];
+                    }
+
+                    dsp::pcomplex_r2c(fft, dst, leaf_size);
+                    dsp::packed_direct_fft(fft, fft, leaf_rank);
+
+                    nJobDone           += leaf_size;
+                    ++nJobStage;
+                }
+                else if (nJobStage < leaves + levels)
+                {
+                    // Butterfly pass merging pairs of transforms of size m, split into parts
+                    size_t m            = leaf_size << (nJobStage - leaves);
+                    size_t stride       = (size_t(1) << nCapRank) / (m << 1);
+                    size_t to_do        = lsp_min(half - nJobPos, limit - nJobDone);
+
+                    for (size_t i=nJobPos, n=nJobPos + to_do; i<n; ++i)
+                    {
+                        size_t k            = i % m;
+                        float *e            = &vFftReIm[((i - k) * 2 + k) * 2];
+                        float *o            = &e[m * 2];
+                        const float *w      = &vTwiddle[k * stride * 2];
+
+                        float re            = w[0] * o[0] - w[1] * o[1];
+                        float im            = w[0] * o[1] + w[1] * o[0];
+                        o[0]                = e[0] - re;
+                        o[1]                = e[1] - im;
+                        e[0]               += re;
+                        e[1]               += im;
+                    }
+
+                    nJobPos            += to_do;
+                    nJobDone           += to_do;
+                    if (nJobPos >= half)
+                    {
+                        nJobPos             = 0;
+                        ++nJobStage;
+                    }
+                }
+                else
+                {
+                    // Get complex argument and mix with the previous value
+                    dsp::pcomplex_mod(vFftReIm, vFftReIm, half + 1);
+                    dsp::mix2(c->vAmp, vFftReIm, 1.0 - fTau, fTau, half + 1);
+
+                    nJobDone           += half;
+                    nJobStage           = 0;
+                    ++nJobChannel;
+                }
+            }
+        }
+
+        void Analyzer::process_channel(channel_t *c, size_t fft_size)
+        {
+            // Perform FFT only for active channels
+            if (c->bFreeze)
+                return;
+
+            if ((!bActive) || (!c->bActive))
+            {
+                dsp::fill_zero(c->vAmp, fft_size);
+                return;
+            }
+
+            // Get the time mark to start from
+            ssize_t fft_csize   = (fft_size >> 1) + 1;
+            ssize_t doff        = nHead - (fft_size + c->nDelay);
+            if (doff < 0)
+                doff           += nBufSize;
+
+            // Prepare the real buffer
+            ssize_t count   = nBufSize - doff;
+            if (vWindow == NULL)
+            {
+                // The window table is not available, apply rectangular window
+                if (count < ssize_t(fft_size))
+                {
+                    dsp::copy(vSigRe, &c->vBuffer[doff], count);
+                    dsp::copy(&vSigRe[count], c->vBuffer, fft_size - count);
+                }
+                else
+                    dsp::copy(vSigRe, &c->vBuffer[doff], fft_size);
+            }
+            else if (count < ssize_t(fft_size))
+            {
+                dsp::mul3(vSigRe, &c->vBuffer[doff], vWindow, count);
+                dsp::mul3(&vSigRe[count], c->vBuffer, &vWindow[count], fft_size - count);
+            }
+            else
+                dsp::mul3(vSigRe, &c->vBuffer[doff], vWindow, fft_size);
+
+            // Do real FFT, only the half of the spectrum is computed
+            fft::real_direct(vFftReIm, vSigRe, nRank, vTwiddle, nCapRank);
+            // Get complex argument
+            dsp::pcomplex_mod(vFftReIm, vFftReIm, fft_csize);
+            // Mix with the previous value
+            dsp::mix2(c->vAmp, vFftReIm, 1.0 - fTau, fTau, fft_csize);
+        }
+
+        void Analyzer::publish()
+        {
+            // Copy the amplitude to the back buffer and swap buffers
+            size_t fft_size     = 1 << nRank;
+            size_t back         = nFront ^ 1;
+            for (size_t i=0; i<nChannels; ++i)
+                dsp::copy(vChannels[i].vData[back], vChannels[i].vAmp, fft_size);
+            atomic_swap(&nFront, back);
+
+            // Append the spectrogram row
+            if (nSpgSize > 0)
+                append_spectrogram(back);
+
+            // Update the snapshot and exchange the back buffer with the middle one
+            if (nSnapSize <= 0)
+                return;
+
+            float *dst          = vSnapshot[nSnapBack];
+            size_t max_idx      = fft_size - 1;
+            for (size_t i=0; i<nChannels; ++i, dst += nSnapSize)
+            {
+                const float *src    = vChannels[i].vData[back];
+                for (size_t j=0; j<nSnapSize; ++j)
+                {
+                    size_t k            = lsp_min(size_t(vSnapIdx[j]), max_idx);
+                    dst[j]              = src[k] * vEnvelope[k];
+                }
+            }
+
+            atomic_t state      = atomic_swap(&nSnapState, atomic_t(nSnapBack | S_FRESH));
+            nSnapBack           = state & S_INDEX;
+        }
+
         void Analyzer::process(const float * const *in, size_t samples)
         {
-            if (vChannels == NULL)
+            LSP_DSP_UNITS_PERF_SCOPE(sPerf, samples);
+
+            // The lazily allocated buffers may not match the settings yet
+            if ((vChannels == NULL) || (!prepared()))
                 return;
 
             // Auto-apply reconfiguration
@@ -292,7 +857,6 @@ namespace lsp
             // Do main processing
             channel_t *c;
             ssize_t fft_size    = 1 << nRank;
-            ssize_t fft_csize   = (fft_size >> 1) + 1;
 
             for (size_t offset = 0; offset < samples; )
             {
@@ -303,51 +867,34 @@ namespace lsp
                 // Need to do FFT transform/sync?
                 if (off == 0)
                 {
-                    if (nCounter == 0)
+                    if (bAmortize)
                     {
-                        // Strobe trigger, copy buffers
+                        // Complete the transforms started at the previous strobe and publish
+                        // the result, then start the transforms of new frames
+                        run_transform(size_t(-1));
+                        if ((bBatch) || (nCounter == 0))
+                            publish();
+                        if (bBatch)
+                            start_transform(0, nChannels);
+                        else
+                            start_transform(channel, 1);
+                    }
+                    else if (bBatch)
+                    {
+                        // Perform FFT for all channels and publish the result
                         for (size_t i=0; i<nChannels; ++i)
-                            dsp::copy(vChannels[i].vData, vChannels[i].vAmp, fft_size);
+                            process_channel(&vChannels[i], fft_size);
+                        publish();
                     }
-
-                    // Regular channel, need to perform FFT if
-                    c   = &vChannels[channel];
-
-                    // Perform FFT only for active channels
-                    if (!c->bFreeze)
+                    else
                     {
-                        if ((bActive) && (c->bActive))
-                        {
-                            // Get the time mark to start from
-                            ssize_t doff    = nHead - (fft_size + c->nDelay);
-
-    //                        lsp_trace("channel=%d, head=%d, delay=%d, offset=%d, buf_size=%d, samples=%d",
-    //                                int(channel), int(nHead), int(c->nDelay), int(doff), int(nBufSize), int(samples));
-
-                            if (doff < 0)
-                                doff           += nBufSize;
-
-                            // Prepare the real buffer
-                            ssize_t count   = nBufSize - doff;
-                            if (count < fft_size)
-                            {
-                                dsp::mul3(vSigRe, &c->vBuffer[doff], vWindow, count);
-                                dsp::mul3(&vSigRe[count], c->vBuffer, &vWindow[count], fft_size - count);
-                            }
-                            else
-                                dsp::mul3(vSigRe, &c->vBuffer[doff], vWindow, fft_size);
-
-                            // Do Real->complex conversion and FFT
-                            dsp::pcomplex_r2c(vFftReIm, vSigRe, fft_size);
-                            dsp::packed_direct_fft(vFftReIm, vFftReIm, nRank);
-                            // Get complex argument
-                            dsp::pcomplex_mod(vFftReIm, vFftReIm, fft_csize);
-                            // Mix with the previous value
-                            dsp::mix2(c->vAmp, vFftReIm, 1.0 - fTau, fTau, fft_csize);
-                        }
-                        else
-                            dsp::fill_zero(c->vAmp, fft_size);
-                    } // c->bFreeze
+                        // Strobe trigger, copy buffers
+                        if (nCounter == 0)
+                            publish();
+
+                        // Regular channel, need to perform FFT
+                        process_channel(&vChannels[channel], fft_size);
+                    }
                 } // off == 0
 
                 // How many samples to process?
@@ -382,6 +929,10 @@ namespace lsp
                     }
                 }
 
+                // Perform the part of amortized transforms proportional to the elapsed time
+                if (bAmortize)
+                    run_transform(size_t(uint64_t(nJobTotal) * (off + to_process) / nStep));
+
                 // Update positions
                 offset     += to_process;
                 nCounter   += to_process;
@@ -427,14 +978,55 @@ namespace lsp
 
         bool Analyzer::get_spectrum(size_t channel, float *out, const uint32_t *idx, size_t count)
         {
-            if ((vChannels == NULL) || (channel >= nChannels))
+            if ((vChannels == NULL) || (channel >= nChannels) || (!prepared()))
                 return false;
 
-            channel_t *c        = &vChannels[channel];
+            const float *data   = vChannels[channel].vData[atomic_add(&nFront, 0)];
             for (size_t i=0; i<count; ++i)
             {
                 size_t j            = idx[i];
-                out[i]              = c->vData[j] * vEnvelope[j];
+                out[i]              = data[j] * vEnvelope[j];
+            }
+
+            return true;
+        }
+
+        bool Analyzer::get_spectrum(size_t channel, float *out, const uint32_t *bounds, size_t count, size_t func)
+        {
+            if ((vChannels == NULL) || (channel >= nChannels) || (!prepared()))
+                return false;
+
+            const float *data   = vChannels[channel].vData[atomic_add(&nFront, 0)];
+            size_t fft_csize    = ((size_t(1) << nRank) >> 1) + 1;
+            float buf[ANALYZER_REDUCE_SIZE];
+
+            func               &= FRQA_FUNC_MASK;
+            for (size_t i=0; i<count; ++i)
+            {
+                size_t first        = lsp_min(size_t(bounds[i]), fft_csize - 1);
+                size_t last         = lsp_max(lsp_min(size_t(bounds[i+1]), fft_csize), first + 1);
+                if ((func == FRQA_FUNC_NEAREST) || (last <= first + 1))
+                {
+                    out[i]              = data[first] * vEnvelope[first];
+                    continue;
+                }
+
+                // Apply envelope to the range by chunks and reduce them
+                float v             = (func == FRQA_FUNC_MIN) ? FLOAT_SAT_P_INF : 0.0f;
+                for (size_t j=first; j<last; )
+                {
+                    size_t to_do        = lsp_min(last - j, size_t(ANALYZER_REDUCE_SIZE));
+                    dsp::mul3(buf, &data[j], &vEnvelope[j], to_do);
+                    if (func == FRQA_FUNC_MIN)
+                        v                   = lsp_min(v, dsp::min(buf, to_do));
+                    else if (func == FRQA_FUNC_AVG)
+                        v                  += dsp::h_sqr_sum(buf, to_do);
+                    else
+                        v                   = lsp_max(v, dsp::max(buf, to_do));
+                    j                  += to_do;
+                }
+
+                out[i]              = (func == FRQA_FUNC_AVG) ? sqrtf(v / float(last - first)) : v;
             }
 
             return true;
@@ -442,10 +1034,10 @@ namespace lsp
 
         float Analyzer::get_level(size_t channel, const uint32_t idx)
         {
-            if ((vChannels == NULL) || (channel >= nChannels))
+            if ((vChannels == NULL) || (channel >= nChannels) || (!prepared()))
                 return 0.0f;
 
-            return vChannels[channel].vData[idx] * vEnvelope[idx];
+            return vChannels[channel].vData[atomic_add(&nFront, 0)][idx] * vEnvelope[idx];
         }
 
         void Analyzer::get_frequencies(float *frq, uint32_t *idx, float start, float stop, size_t count)
@@ -469,10 +1061,63 @@ namespace lsp
             }
         }
 
+        void Analyzer::get_frequency_ranges(float *frq, uint32_t *bounds, float start, float stop, size_t count)
+        {
+            size_t fft_size     = 1 << nRank;
+            size_t fft_csize    = (fft_size >> 1) + 1;
+            float scale         = float(fft_size) / float(nSampleRate);
+            float norm          = logf(stop/start) / count;
+
+            // Boundaries are rounded to the nearest bin, the center is the geometric mean
+            for (size_t i=0; i<=count; ++i)
+            {
+                size_t ix       = start * expf(i * norm) * scale + 0.5f;
+                bounds[i]       = lsp_min(ix, fft_csize);
+            }
+            for (size_t i=0; i<count; ++i)
+                frq[i]          = start * expf((i + 0.5f) * norm);
+        }
+
+        void Analyzer::memory_usage(memory_report_t *r) const
+        {
+            if (vChannels != NULL)
+                memory::add(r, nChannels * sizeof(channel_t), nChannels * sizeof(channel_t));
+
+            // The buffers may be allocated for the rank and the delay greater than the current ones
+            if (vData != NULL)
+            {
+                size_t rank         = lsp_min(nRank, nCapRank);
+                size_t fft_size     = size_t(1) << rank;
+                size_t buf_size     = ((nSampleRate > 0) && (fRate > 0.0f)) ?
+                                      lsp_min(delay_size(rank, nSampleRate, fRate), nBufSize) : nBufSize;
+                size_t used         = 5 * fft_size + nChannels * (buf_size + fft_size * 3);
+                memory::add_pages(r, vData, used * sizeof(float));
+            }
+
+            if (vSnapData != NULL)
+            {
+                size_t szof_idx     = align_size(nSnapSize * sizeof(uint32_t), DEFAULT_ALIGN);
+                size_t szof_snap    = align_size(nChannels * nSnapSize * sizeof(float), DEFAULT_ALIGN);
+                size_t used         = nSnapSize * (sizeof(uint32_t) + nChannels * sizeof(float) * 3);
+                memory::add_aligned(r, vSnapData, szof_idx + szof_snap * 3, used);
+            }
+
+            if (vSpgData != NULL)
+            {
+                size_t szof_elem    = (nSpgFormat == SPECTROGRAM_U16) ? sizeof(uint16_t) : sizeof(uint8_t);
+                size_t szof_idx     = align_size(nSpgSize * sizeof(uint32_t), DEFAULT_ALIGN);
+                size_t szof_buf     = align_size(nSpgSize * sizeof(float), DEFAULT_ALIGN);
+                size_t szof_ring    = align_size(nSpgSize * nSpgRows * 2 * szof_elem, DEFAULT_ALIGN);
+                size_t used         = nSpgSize * (sizeof(uint32_t) + sizeof(float) + nSpgRows * 2 * szof_elem * nChannels);
+                memory::add_aligned(r, vSpgData, szof_idx + szof_buf + szof_ring * nChannels, used);
+            }
+        }
+
         void Analyzer::dump(IStateDumper *v) const
         {
             v->write("nChannels", nChannels);
             v->write("nMaxRank", nMaxRank);
+            v->write("nCapRank", nCapRank);
             v->write("nRank", nRank);
             v->write("nSampleRate", nSampleRate);
             v->write("nMaxSampleRate", nMaxSampleRate);
@@ -490,6 +1135,9 @@ namespace lsp
             v->write("nEnvelope", nEnvelope);
             v->write("nWindow", nWindow);
             v->write("bActive", bActive);
+            v->write("bBatch", bBatch);
+            v->write("bLazy", bLazy);
+            v->write("nFront", int32_t(nFront));
 
             v->begin_array("vChannels", vChannels, nChannels);
             for (size_t i=0; i<nChannels; ++i)
@@ -499,7 +1147,8 @@ namespace lsp
                 {
                     v->write("vBuffer", c->vBuffer);
                     v->write("vAmp", c->vAmp);
-                    v->write("vData", c->vData);
+                    v->write("vData[0]", c->vData[0]);
+                    v->write("vData[1]", c->vData[1]);
                     v->write("nDelay", c->nDelay);
                     v->write("bFreeze", c->bFreeze);
                     v->write("bActive", c->bActive);
@@ -513,6 +1162,39 @@ namespace lsp
             v->write("vFftReIm", vFftReIm);
             v->write("vWindow", vWindow);
             v->write("vEnvelope", vEnvelope);
+            v->write("vEnvTable", vEnvTable);
+
+            v->write("vSnapIdx", vSnapIdx);
+            v->write("vSnapshot[0]", vSnapshot[0]);
+            v->write("vSnapshot[1]", vSnapshot[1]);
+            v->write("vSnapshot[2]", vSnapshot[2]);
+            v->write("nSnapSize", nSnapSize);
+            v->write("nSnapBack", nSnapBack);
+            v->write("nSnapFront", nSnapFront);
+            v->write("nSnapState", int32_t(nSnapState));
+            v->write("vSnapData", vSnapData);
+
+            v->write("vSpgIdx", vSpgIdx);
+            v->write("vSpgBuf", vSpgBuf);
+            v->write("vSpgRing", vSpgRing);
+            v->write("nSpgSize", nSpgSize);
+            v->write("nSpgRows", nSpgRows);
+            v->write("nSpgFormat", nSpgFormat);
+            v->write("fSpgMin", fSpgMin);
+            v->write("fSpgMax", fSpgMax);
+            v->write("nSpgPosition", int32_t(nSpgPosition));
+            v->write("vSpgData", vSpgData);
+
+            v->write("vTwiddle", vTwiddle);
+            v->write("nJobChannel", nJobChannel);
+            v->write("nJobEnd", nJobEnd);
+            v->write("nJobHead", nJobHead);
+            v->write("nJobStage", nJobStage);
+            v->write("nJobPos", nJobPos);
+            v->write("nJobDone", nJobDone);
+            v->write("nJobTotal", nJobTotal);
+            v->write("bAmortize", bAmortize);
+            v->write_object("sPerf", &sPerf);
         }
     }
 } /* namespace lsp */
@@ -0,0 +1,640 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/dsp-units/util/BinaryStateDumper.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/stdlib/string.h>
+
+#define RECORD_ALIGN        8
+
+namespace lsp
+{
+    namespace dspu
+    {
+        BinaryStateDumper::BinaryStateDumper()
+        {
+            construct();
+        }
+
+        BinaryStateDumper::~BinaryStateDumper()
+        {
+            destroy();
+        }
+
+        void BinaryStateDumper::construct()
+        {
+            vBuffer         = NULL;
+            nCapacity       = 0;
+            nSize           = 0;
+            vNames          = NULL;
+            vHash           = NULL;
+            nNames          = 0;
+            nMaxNames       = 0;
+            nHashMask       = 0;
+            bOverflow       = false;
+            pData           = NULL;
+        }
+
+        void BinaryStateDumper::destroy()
+        {
+            free_aligned(pData);
+            construct();
+        }
+
+        bool BinaryStateDumper::init(size_t size, size_t names)
+        {
+            names               = lsp_min(lsp_max(names, size_t(1)), size_t(N_UNKNOWN));
+            size                = align_size(size, RECORD_ALIGN);
+
+            // The hash table has at least twice more cells than names for short probe sequences
+            size_t hash_size    = 1;
+            while (hash_size < names * 2)
+                hash_size         <<= 1;
+
+            size_t szof_names   = align_size(names * sizeof(const char *), DEFAULT_ALIGN);
+            size_t szof_hash    = align_size(hash_size * sizeof(uint16_t), DEFAULT_ALIGN);
+            size_t to_alloc     = size + szof_names + szof_hash;
+
+            uint8_t *data       = NULL;
+            uint8_t *ptr        = alloc_aligned<uint8_t>(data, to_alloc);
+            if (ptr == NULL)
+                return false;
+
+            free_aligned(pData);
+
+            vBuffer             = ptr;
+            ptr                += size;
+            vNames              = reinterpret_cast<const char **>(ptr);
+            ptr                += szof_names;
+            vHash               = reinterpret_cast<uint16_t *>(ptr);
+            ptr                += szof_hash;
+
+            for (size_t i=0; i<hash_size; ++i)
+                vHash[i]            = 0;
+
+            nCapacity           = size;
+            nSize               = 0;
+            nNames              = 0;
+            nMaxNames           = names;
+            nHashMask           = hash_size - 1;
+            bOverflow           = false;
+            pData               = data;
+
+            return true;
+        }
+
+        uint16_t BinaryStateDumper::name_id(const char *name)
+        {
+            if (name == NULL)
+                return N_UNNAMED;
+
+            // Names are string literals, so they are identified by the pointer
+            uintptr_t key       = reinterpret_cast<uintptr_t>(name);
+            size_t idx          = size_t((key >> 3) * 0x9e3779b1u) & nHashMask;
+            for ( ; vHash[idx] != 0; idx = (idx + 1) & nHashMask)
+            {
+                uint16_t id         = vHash[idx] - 1;
+                if (vNames[id] == name)
+                    return id;
+            }
+
+            if (nNames >= nMaxNames)
+            {
+                bOverflow           = true;
+                return N_UNKNOWN;
+            }
+
+            uint16_t id         = nNames++;
+            vNames[id]          = name;
+            vHash[idx]          = id + 1;
+            return id;
+        }
+
+        const char *BinaryStateDumper::name(uint16_t id) const
+        {
+            if (id == N_UNNAMED)
+                return NULL;
+            return (id < nNames) ? vNames[id] : "<unknown>";
+        }
+
+        void *BinaryStateDumper::append(uint8_t type, const char *name, size_t count, size_t bytes)
+        {
+            if (bOverflow)
+                return NULL;
+
+            size_t to_write     = sizeof(record_t) + align_size(bytes, RECORD_ALIGN);
+            if ((nSize + to_write) > nCapacity)
+            {
+                bOverflow           = true;
+                return NULL;
+            }
+
+            record_t *r         = reinterpret_cast<record_t *>(&vBuffer[nSize]);
+            r->nType            = type;
+            r->nReserved        = 0;
+            r->nName            = name_id(name);
+            r->nCount           = uint32_t(count);
+            nSize              += to_write;
+
+            return &r[1];
+        }
+
+        void BinaryStateDumper::emit(uint8_t type, const char *name, const void *value, size_t bytes)
+        {
+            void *dst           = append(type, name, 1, bytes);
+            if (dst != NULL)
+                memcpy(dst, value, bytes);
+        }
+
+        void BinaryStateDumper::emitv(uint8_t type, const char *name, const void *value, size_t count, size_t szof)
+        {
+            if (value == NULL)
+            {
+                append(type | T_VECTOR | T_NULL, name, count, 0);
+                return;
+            }
+
+            void *dst           = append(type | T_VECTOR, name, count, count * szof);
+            if (dst != NULL)
+                memcpy(dst, value, count * szof);
+        }
+
+        void BinaryStateDumper::begin_object(const char *name, const void *ptr, size_t szof)
+        {
+            void *dst           = append(T_BEGIN_OBJECT, name, szof, sizeof(ptr));
+            if (dst != NULL)
+                memcpy(dst, &ptr, sizeof(ptr));
+        }
+
+        void BinaryStateDumper::begin_object(const void *ptr, size_t szof)
+        {
+            begin_object(NULL, ptr, szof);
+        }
+
+        void BinaryStateDumper::end_object()
+        {
+            append(T_END_OBJECT, NULL, 0, 0);
+        }
+
+        void BinaryStateDumper::begin_array(const char *name, const void *ptr, size_t count)
+        {
+            void *dst           = append(T_BEGIN_ARRAY, name, count, sizeof(ptr));
+            if (dst != NULL)
+                memcpy(dst, &ptr, sizeof(ptr));
+        }
+
+        void BinaryStateDumper::begin_array(const void *ptr, size_t count)
+        {
+            begin_array(NULL, ptr, count);
+        }
+
+        void BinaryStateDumper::end_array()
+        {
+            append(T_END_ARRAY, NULL, 0, 0);
+        }
+
+        void BinaryStateDumper::write(const void *value)
+        {
+            emit(T_PTR, NULL, &value, sizeof(value));
+        }
+
+        void BinaryStateDumper::write(const char *value)
+        {
+            write(static_cast<const char *>(NULL), value);
+        }
+
+        void BinaryStateDumper::write(bool value)
+        {
+            emit(T_BOOL, NULL, &value, sizeof(value));
+        }
+
+        void BinaryStateDumper::write(uint8_t value)
+        {
+            emit(T_U8, NULL, &value, sizeof(value));
+        }
+
+        void BinaryStateDumper::write(int8_t value)
+        {
+            emit(T_I8, NULL, &value, sizeof(value));
+        }
+
+        void BinaryStateDumper::write(uint16_t value)
+        {
+            emit(T_U16, NULL, &value, sizeof(value));
+        }
+
+        void BinaryStateDumper::write(int16_t value)
+        {
+            emit(T_I16, NULL, &value, sizeof(value));
+        }
+
+        void BinaryStateDumper::write(uint32_t value)
+        {
+            emit(T_U32, NULL, &value, sizeof(value));
+        }
+
+        void BinaryStateDumper::write(int32_t value)
+        {
+            emit(T_I32, NULL, &value, sizeof(value));
+        }
+
+        void BinaryStateDumper::write(uint64_t value)
+        {
+            emit(T_U64, NULL, &value, sizeof(value));
+        }
+
+        void BinaryStateDumper::write(int64_t value)
+        {
+            emit(T_I64, NULL, &value, sizeof(value));
+        }
+
+        void BinaryStateDumper::write(float value)
+        {
+            emit(T_F32, NULL, &value, sizeof(value));
+        }
+
+        void BinaryStateDumper::write(double value)
+        {
+            emit(T_F64, NULL, &value, sizeof(value));
+        }
+
+        void BinaryStateDumper::write(const char *name, const void *value)
+        {
+            emit(T_PTR, name, &value, sizeof(value));
+        }
+
+        void BinaryStateDumper::write(const char *name, const char *value)
+        {
+            if (value == NULL)
+            {
+                append(T_STR | T_NULL, name, 0, 0);
+                return;
+            }
+
+            size_t len      = strlen(value);
+            void *dst       = append(T_STR, name, len, len + 1);
+            if (dst != NULL)
+                memcpy(dst, value, len + 1);
+        }
+
+        void BinaryStateDumper::write(const char *name, bool value)
+        {
+            emit(T_BOOL, name, &value, sizeof(value));
+        }
+
+        void BinaryStateDumper::write(const char *name, uint8_t value)
+        {
+            emit(T_U8, name, &value, sizeof(value));
+        }
+
+        void BinaryStateDumper::write(const char *name, int8_t value)
+        {
+            emit(T_I8, name, &value, sizeof(value));
+        }
+
+        void BinaryStateDumper::write(const char *name, uint16_t value)
+        {
+            emit(T_U16, name, &value, sizeof(value));
+        }
+
+        void BinaryStateDumper::write(const char *name, int16_t value)
+        {
+            emit(T_I16, name, &value, sizeof(value));
+        }
+
+        void BinaryStateDumper::write(const char *name, uint32_t value)
+        {
+            emit(T_U32, name, &value, sizeof(value));
+        }
+
+        void BinaryStateDumper::write(const char *name, int32_t value)
+        {
+            emit(T_I32, name, &value, sizeof(value));
+        }
+
+        void BinaryStateDumper::write(const char *name, uint64_t value)
+        {
+            emit(T_U64, name, &value, sizeof(value));
+        }
+
+        void BinaryStateDumper::write(const char *name, int64_t value)
+        {
+            emit(T_I64, name, &value, sizeof(value));
+        }
+
+        void BinaryStateDumper::write(const char *name, float value)
+        {
+            emit(T_F32, name, &value, sizeof(value));
+        }
+
+        void BinaryStateDumper::write(const char *name, double value)
+        {
+            emit(T_F64, name, &value, sizeof(value));
+        }
+
+        void BinaryStateDumper::writev(const void * const *value, size_t count)
+        {
+            emitv(T_PTR, NULL, value, count, sizeof(void *));
+        }
+
+        void BinaryStateDumper::writev(const bool *value, size_t count)
+        {
+            emitv(T_BOOL, NULL, value, count, sizeof(bool));
+        }
+
+        void BinaryStateDumper::writev(const uint8_t *value, size_t count)
+        {
+            emitv(T_U8, NULL, value, count, sizeof(uint8_t));
+        }
+
+        void BinaryStateDumper::writev(const int8_t *value, size_t count)
+        {
+            emitv(T_I8, NULL, value, count, sizeof(int8_t));
+        }
+
+        void BinaryStateDumper::writev(const uint16_t *value, size_t count)
+        {
+            emitv(T_U16, NULL, value, count, sizeof(uint16_t));
+        }
+
+        void BinaryStateDumper::writev(const int16_t *value, size_t count)
+        {
+            emitv(T_I16, NULL, value, count, sizeof(int16_t));
+        }
+
+        void BinaryStateDumper::writev(const uint32_t *value, size_t count)
+        {
+            emitv(T_U32, NULL, value, count, sizeof(uint32_t));
+        }
+
+        void BinaryStateDumper::writev(const int32_t *value, size_t count)
+        {
+            emitv(T_I32, NULL, value, count, sizeof(int32_t));
+        }
+
+        void BinaryStateDumper::writev(const uint64_t *value, size_t count)
+        {
+            emitv(T_U64, NULL, value, count, sizeof(uint64_t));
+        }
+
+        void BinaryStateDumper::writev(const int64_t *value, size_t count)
+        {
+            emitv(T_I64, NULL, value, count, sizeof(int64_t));
+        }
+
+        void BinaryStateDumper::writev(const float *value, size_t count)
+        {
+            emitv(T_F32, NULL, value, count, sizeof(float));
+        }
+
+        void BinaryStateDumper::writev(const double *value, size_t count)
+        {
+            emitv(T_F64, NULL, value, count, sizeof(double));
+        }
+
+        void BinaryStateDumper::writev(const char *name, const void * const *value, size_t count)
+        {
+            emitv(T_PTR, name, value, count, sizeof(void *));
+        }
+
+        void BinaryStateDumper::writev(const char *name, const bool *value, size_t count)
+        {
+            emitv(T_BOOL, name, value, count, sizeof(bool));
+        }
+
+        void BinaryStateDumper::writev(const char *name, const uint8_t *value, size_t count)
+        {
+            emitv(T_U8, name, value, count, sizeof(uint8_t));
+        }
+
+        void BinaryStateDumper::writev(const char *name, const int8_t *value, size_t count)
+        {
+            emitv(T_I8, name, value, count, sizeof(int8_t));
+        }
+
+        void BinaryStateDumper::writev(const char *name, const uint16_t *value, size_t count)
+        {
+            emitv(T_U16, name, value, count, sizeof(uint16_t));
+        }
+
+        void BinaryStateDumper::writev(const char *name, const int16_t *value, size_t count)
+        {
+            emitv(T_I16, name, value, count, sizeof(int16_t));
+        }
+
+        void BinaryStateDumper::writev(const char *name, const uint32_t *value, size_t count)
+        {
+            emitv(T_U32, name, value, count, sizeof(uint32_t));
+        }
+
+        void BinaryStateDumper::writev(const char *name, const int32_t *value, size_t count)
+        {
+            emitv(T_I32, name, value, count, sizeof(int32_t));
+        }
+
+        void BinaryStateDumper::writev(const char *name, const uint64_t *value, size_t count)
+        {
+            emitv(T_U64, name, value, count, sizeof(uint64_t));
+        }
+
+        void BinaryStateDumper::writev(const char *name, const int64_t *value, size_t count)
+        {
+            emitv(T_I64, name, value, count, sizeof(int64_t));
+        }
+
+        void BinaryStateDumper::writev(const char *name, const float *value, size_t count)
+        {
+            emitv(T_F32, name, value, count, sizeof(float));
+        }
+
+        void BinaryStateDumper::writev(const char *name, const double *value, size_t count)
+        {
+            emitv(T_F64, name, value, count, sizeof(double));
+        }
+
+        template <class T>
+            static inline void replay_value(IStateDumper *dst, const char *name, T value)
+            {
+                if (name != NULL)
+                    dst->write(name, value);
+                else
+                    dst->write(value);
+            }
+
+        template <class T>
+            static inline void replay_vector(IStateDumper *dst, const char *name, const T *value, size_t count)
+            {
+                if (name != NULL)
+                    dst->writev(name, value, count);
+                else
+                    dst->writev(value, count);
+            }
+
+        status_t BinaryStateDumper::replay(IStateDumper *dst) const
+        {
+            if (dst == NULL)
+                return STATUS_BAD_ARGUMENTS;
+
+            for (size_t offset=0; offset < nSize; )
+            {
+                if ((offset + sizeof(record_t)) > nSize)
+                    return STATUS_CORRUPTED;
+
+                const record_t *r       = reinterpret_cast<const record_t *>(&vBuffer[offset]);
+                const uint8_t *payload  = reinterpret_cast<const uint8_t *>(&r[1]);
+                const char *name        = this->name(r->nName);
+                size_t count            = r->nCount;
+                size_t type             = r->nType & T_TYPE_MASK;
+                bool vec                = r->nType & T_VECTOR;
+                bool is_null            = r->nType & T_NULL;
+
+                // Compute size of the payload
+                size_t bytes;
+                switch (type)
+                {
+                    case T_BEGIN_OBJECT:
+                    case T_BEGIN_ARRAY:     bytes = sizeof(void *);                     break;
+                    case T_END_OBJECT:
+                    case T_END_ARRAY:       bytes = 0;                                  break;
+                    case T_STR:             bytes = (is_null) ? 0 : count + 1;          break;
+                    case T_PTR:             bytes = sizeof(void *);                     break;
+                    case T_BOOL:            bytes = sizeof(bool);                       break;
+                    case T_U8: case T_I8:   bytes = sizeof(uint8_t);                    break;
+                    case T_U16: case T_I16: bytes = sizeof(uint16_t);                   break;
+                    case T_U32: case T_I32: bytes = sizeof(uint32_t);                   break;
+                    case T_U64: case T_I64: bytes = sizeof(uint64_t);                   break;
+                    case T_F32:             bytes = sizeof(float);                      break;
+                    case T_F64:             bytes = sizeof(double);                     break;
+                    default:
+                        return STATUS_CORRUPTED;
+                }
+                if (vec)
+                    bytes                   = (is_null) ? 0 : bytes * count;
+
+                offset                 += sizeof(record_t) + align_size(bytes, RECORD_ALIGN);
+                if (offset > nSize)
+                    return STATUS_CORRUPTED;
+
+                // Replay the record
+                switch (type)
+                {
+                    case T_BEGIN_OBJECT:
+                        if (name != NULL)
+                            dst->begin_object(name, *reinterpret_cast<const void * const *>(payload), count);
+                        else
+                            dst->begin_object(*reinterpret_cast<const void * const *>(payload), count);
+                        break;
+                    case T_END_OBJECT:
+                        dst->end_object();
+                        break;
+                    case T_BEGIN_ARRAY:
+                        if (name != NULL)
+                            dst->begin_array(name, *reinterpret_cast<const void * const *>(payload), count);
+                        else
+                            dst->begin_array(*reinterpret_cast<const void * const *>(payload), count);
+                        break;
+                    case T_END_ARRAY:
+                        dst->end_array();
+                        break;
+                    case T_STR:
+                        replay_value(dst, name, (is_null) ? static_cast<const char *>(NULL) : reinterpret_cast<const char *>(payload));
+                        break;
+                    case T_PTR:
+                        if (vec)
+                            replay_vector(dst, name, (is_null) ? NULL : reinterpret_cast<const void * const *>(payload), count);
+                        else
+                            replay_value(dst, name, *reinterpret_cast<const void * const *>(payload));
+                        break;
+                    case T_BOOL:
+                        if (vec)
+                            replay_vector(dst, name, (is_null) ? NULL : reinterpret_cast<const bool *>(payload), count);
+                        else
+                            replay_value(dst, name, *reinterpret_cast<const bool *>(payload));
+                        break;
+                    case T_U8:
+                        if (vec)
+                            replay_vector(dst, name, (is_null) ? NULL : reinterpret_cast<const uint8_t *>(payload), count);
+                        else
+                            replay_value(dst, name, *reinterpret_cast<const uint8_t *>(payload));
+                        break;
+                    case T_I8:
+                        if (vec)
+                            replay_vector(dst, name, (is_null) ? NULL : reinterpret_cast<const int8_t *>(payload), count);
+                        else
+                            replay_value(dst, name, *reinterpret_cast<const int8_t *>(payload));
+                        break;
+                    case T_U16:
+                        if (vec)
+                            replay_vector(dst, name, (is_null) ? NULL : reinterpret_cast<const uint16_t *>(payload), count);
+                        else
+                            replay_value(dst, name, *reinterpret_cast<const uint16_t *>(payload));
+                        break;
+                    case T_I16:
+                        if (vec)
+                            replay_vector(dst, name, (is_null) ? NULL : reinterpret_cast<const int16_t *>(payload), count);
+                        else
+                            replay_value(dst, name, *reinterpret_cast<const int16_t *>(payload));
+                        break;
+                    case T_U32:
+                        if (vec)
+                            replay_vector(dst, name, (is_null) ? NULL : reinterpret_cast<const uint32_t *>(payload), count);
+                        else
+                            replay_value(dst, name, *reinterpret_cast<const uint32_t *>(payload));
+                        break;
+                    case T_I32:
+                        if (vec)
+                            replay_vector(dst, name, (is_null) ? NULL : reinterpret_cast<const int32_t *>(payload), count);
+                        else
+                            replay_value(dst, name, *reinterpret_cast<const int32_t *>(payload));
+                        break;
+                    case T_U64:
+                        if (vec)
+                            replay_vector(dst, name, (is_null) ? NULL : reinterpret_cast<const uint64_t *>(payload), count);
+                        else
+                            replay_value(dst, name, *reinterpret_cast<const uint64_t *>(payload));
+                        break;
+                    case T_I64:
+                        if (vec)
+                            replay_vector(dst, name, (is_null) ? NULL : reinterpret_cast<const int64_t *>(payload), count);
+                        else
+                            replay_value(dst, name, *reinterpret_cast<const int64_t *>(payload));
+                        break;
+                    case T_F32:
+                        if (vec)
+                            replay_vector(dst, name, (is_null) ? NULL : reinterpret_cast<const float *>(payload), count);
+                        else
+                            replay_value(dst, name, *reinterpret_cast<const float *>(payload));
+                        break;
+                    case T_F64:
+                        if (vec)
+                            replay_vector(dst, name, (is_null) ? NULL : reinterpret_cast<const double *>(payload), count);
+                        else
+                            replay_value(dst, name, *reinterpret_cast<const double *>(payload));
+                        break;
+                    default:
+                        return STATUS_CORRUPTED;
+                }
+            }
+
+            return STATUS_OK;
+        }
+    } /* namespace dspu */
+} /* namespace lsp */
@@ -20,8 +20,10 @@
  */
 
 #include <lsp-plug.in/dsp-units/util/Convolver.h>
+#include <lsp-plug.in/dsp-units/misc/pages.h>
 #include <lsp-plug.in/common/alloc.h>
 #include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/ipc/Thread.h>
 
 #define CONVOLVER_MIN_CONV_BUF_SIZE         (1 << (CONVOLVER_RANK_MIN))
 #define CONVOLVER_MIN_DATA_BUF_SIZE         (1 << (CONVOLVER_RANK_MIN - 1))
@@ -33,6 +35,48 @@ namespace lsp
 {
     namespace dspu
     {
+        class Convolver::TailThread: public ipc::Thread
+        {
+            private:
+                Convolver          *pConv;
+                volatile bool       bCancel;
+
+            public:
+                explicit TailThread(Convolver *conv)
+                {
+                    pConv       = conv;
+                    bCancel     = false;
+                }
+
+                virtual ~TailThread()
+                {
+                }
+
+            public:
+                inline void         stop()      { bCancel = true; }
+
+                virtual status_t run()
+                {
+                    atomic_t job = 0;
+
+                    while (!bCancel)
+                    {
+                        // Wait for the next job
+                        if (atomic_add(&pConv->nTailReq, 0) <= job)
+                        {
+                            ipc::Thread::sleep(1);
+                            continue;
+                        }
+
+                        // Process the job and publish the result
+                        pConv->process_tail(job++);
+                        atomic_add(&pConv->nTailDone, 1);
+                    }
+
+                    return STATUS_OK;
+                }
+        };
+
         Convolver::Convolver()
         {
             construct();
@@ -44,13 +88,21 @@ namespace lsp
         }
 
         void Convolver::construct()
+        {
+            sPerf.construct();
+            reset_state();
+        }
+
+        void Convolver::reset_state()
         {
             vDataBuffer         = NULL;
             vFrame              = NULL;
             vConvBuffer         = NULL;
             vTaskData           = NULL;
+            vBlockData          = NULL;
             vDirectData         = NULL;
             vConvData           = NULL;
+            vActive             = NULL;
 
             nDataBufferSize     = 0;
             nDirectSize         = 0;
@@ -60,18 +112,97 @@ namespace lsp
             nLevels             = 0;
             nBlocks             = 0;
             nBlocksDone         = 0;
+            nActive             = 0;
+            nSyncActive         = 0;
+            nLevelMask          = 0;
+            bDirect             = false;
             nRank               = 0;
+            nBlkInit            = 0;
+            fBlkCoef            = 0.0f;
+            nSyncBlocks         = 0;
+
+            pSpectrum           = NULL;
+            pCache              = NULL;
+            pTail               = NULL;
+            vTailTask[0]        = NULL;
+            vTailTask[1]        = NULL;
+            vTailData[0]        = NULL;
+            vTailData[1]        = NULL;
+            vTailBuffer         = NULL;
+            vTailBlock          = NULL;
+            nTailReq            = 0;
+            nTailDone           = 0;
 
             vData               = NULL;
         }
 
         void Convolver::destroy()
         {
-            free_aligned(vData);
-            construct();
+            stop_tail();
+            release_spectrum(pCache, pSpectrum);
+            pages::free_aligned(vData);
+            reset_state();
+        }
+
+        void Convolver::release_spectrum(ConvolverCache *cache, convolver_spectrum_t *spectrum)
+        {
+            if (spectrum == NULL)
+                return;
+            if (cache != NULL)
+                cache->release(spectrum);
+            else
+                ConvolverCache::destroy(spectrum);
+        }
+
+        void Convolver::stop_tail()
+        {
+            if (pTail == NULL)
+                return;
+
+            pTail->stop();
+            pTail->join();
+            delete pTail;
+            pTail               = NULL;
+        }
+
+        void Convolver::process_tail(size_t job)
+        {
+            /*
+               The job is submitted at the beginning of the frame F, the constant-size block
+               with index k starts at offset k*nFrameSize in the frame F. Results are merged
+               at the beginning of frame F+2, so the block is stored at offset
+               (k - CONVOLVER_SYNC_BLOCKS)*nFrameSize.
+             */
+            size_t slot         = job & 1;
+            float *xdst         = vTailData[slot];
+
+            dsp::fill_zero(xdst, (nBlocks - CONVOLVER_SYNC_BLOCKS + 1) * nFrameSize);
+            for (size_t i=nSyncActive; i<nActive; ++i)
+            {
+                size_t blk          = vActive[i];
+                dsp::fastconv_apply(
+                    &xdst[(blk - CONVOLVER_SYNC_BLOCKS) * nFrameSize], vTailBuffer,
+                    ConvolverCache::block(pSpectrum, blk, vTailBlock), vTailTask[slot], nRank);
+            }
         }
 
         bool Convolver::init(const float *data, size_t count, size_t rank, float phase)
+        {
+            return init(data, count, rank, phase, false);
+        }
+
+        bool Convolver::init(const float *data, size_t count, size_t rank, float phase, bool background)
+        {
+            return init(data, count, rank, phase, background, NULL);
+        }
+
+        bool Convolver::init(const float *data, size_t count, size_t rank, float phase, bool background, ConvolverCache *cache)
+        {
+            return init(data, count, rank, phase, background, cache, CONVOLVER_FLOAT32);
+        }
+
+        bool Convolver::init(const float *data, size_t count, size_t rank, float phase, bool background,
+            ConvolverCache *cache, convolver_precision_t precision)
         {
             // Check arguments
             if (count <= 0)
@@ -80,30 +211,46 @@ namespace lsp
                 return true;
             }
 
-            // Determine number of buffers
-            rank                    = lsp_limit(ssize_t(rank), CONVOLVER_RANK_MIN, CONVOLVER_RANK_MAX);
+            // Obtain the spectrum of impulse response
+            convolver_spectrum_t *spectrum  = (cache != NULL) ?
+                cache->acquire(data, count, rank, precision) :
+                ConvolverCache::create(data, count, rank, precision);
+            if (spectrum == NULL)
+                return false;
+            rank                    = spectrum->nRank;
 
             // Determine size of buffer
             size_t data_buf_size    = 1 << (rank - 1);
             size_t fft_buf_size     = 1 << (rank + 1);
-            size_t direct_buf_size  = lsp_max(CONVOLVER_MIN_DATA_BUF_SIZE, int(CONVOLVER_DATA_ALIGN/sizeof(float)));
-            size_t bins             = (count + data_buf_size - 1) >> (rank - 1);
+            size_t bins             = spectrum->nBins;
 
             size_t allocate         = (bins + 1) * data_buf_size;       // Size of data buffer (convolutio tail)
             allocate               += data_buf_size * 2;                // Input data frame
             allocate               += fft_buf_size;                     // Convolution buffer
             allocate               += fft_buf_size;                     // Task data for tail convolution
-            allocate               += bins * fft_buf_size;              // FFT convolution data
-            allocate               += direct_buf_size;                  // Direct convolution data
+            if (background)
+            {
+                allocate               += fft_buf_size * 3;                 // Background task data and convolution buffer
+                allocate               += (bins + 1) * data_buf_size * 2;   // Background job results
+            }
+            if (spectrum->vHalfData != NULL)
+                allocate               += fft_buf_size * ((background) ? 2 : 1);   // Decoded spectrum of the block
 
             // Allocate buffer and clear
             uint8_t *pdata          = NULL;
-            float *fptr             = alloc_aligned<float>(pdata, allocate, CONVOLVER_DATA_ALIGN);
+            float *fptr             = pages::alloc_aligned<float>(pdata, allocate, CONVOLVER_DATA_ALIGN);
             if (fptr == NULL)
+            {
+                release_spectrum(cache, spectrum);
                 return false;
+            }
 
             destroy();
+            LSP_DSP_UNITS_PERF_RECONFIGURE(sPerf);
+
             vData                   = pdata;
+            pSpectrum               = spectrum;
+            pCache                  = cache;
             dsp::fill_zero(fptr, allocate);                             // Cleanup all buffer data
 
             // Perform initialization
@@ -123,96 +270,88 @@ namespace lsp
             vTaskData               = fptr;
             fptr                   += fft_buf_size;
 
-            // FFT convolution data
-            vConvData               = fptr;
-            fptr                   += bins * fft_buf_size;
+            // Background processing data
+            if (background)
+            {
+                for (size_t i=0; i<2; ++i)
+                {
+                    vTailTask[i]            = fptr;
+                    fptr                   += fft_buf_size;
+                    vTailData[i]            = fptr;
+                    fptr                   += (bins + 1) * data_buf_size;
+                }
+                vTailBuffer             = fptr;
+                fptr                   += fft_buf_size;
+            }
 
-            // Direct convolution data
-            vDirectData             = fptr;
-            fptr                   += direct_buf_size;
+            // Decoded spectrum of the block stored in reduced precision
+            if (spectrum->vHalfData != NULL)
+            {
+                vBlockData              = fptr;
+                fptr                   += fft_buf_size;
+                if (background)
+                {
+                    vTailBlock              = fptr;
+                    fptr                   += fft_buf_size;
+                }
+            }
 
             // Initialize simple values
+            vConvData               = spectrum->vConvData;
+            vDirectData             = spectrum->vDirectData;
             nDataBufferSize         = (bins + 1) * data_buf_size;
             nFrameSize              = data_buf_size;
             nFrameOff               = size_t(phase * nFrameSize) % nFrameSize;
-            nDirectSize             = lsp_min(count, size_t(CONVOLVER_MIN_DATA_BUF_SIZE));
-            nConvSize               = count;
-
-            /* Calculate convolutions
-
-                Conv buffer layout:
-                +---+---+------+------------+------------------------+
-                |FFT|FFT|FFT x2|   FFT x4   |       FFT x8           |  . . .
-                +---+---+------+------------+------------------------+
-             */
-
-            float *conv             = vConvData;
-            size_t brank            = CONVOLVER_RANK_MIN;
-
-            // Process direct convolution data
-            dsp::copy(vDirectData, data, nDirectSize);
-            dsp::fill_zero(vConvBuffer, fft_buf_size);
-            dsp::copy(vConvBuffer, data, nDirectSize);
-            dsp::fastconv_parse(conv, vConvBuffer, brank);
-
-            data                   += nDirectSize;
-            conv                   += (1 << (brank + 1));
-            count                  -= nDirectSize;
+            nDirectSize             = spectrum->nDirectSize;
+            nConvSize               = spectrum->nCount;
+            nLevels                 = spectrum->nLevels;
+            nBlocks                 = spectrum->nBlocks;
+            vActive                 = spectrum->vActive;
+            nActive                 = spectrum->nActive;
+            nLevelMask              = spectrum->nLevelMask;
+            bDirect                 = spectrum->bDirect;
+            nRank                   = rank;
 
-            // Prepare raising levels
-            nLevels                 = 0;
-            for (; (count > 0) && (brank < rank); ++brank)
+            // Start background processing of the tail if there is enough work for it
+            nSyncBlocks             = nBlocks;
+            if ((background) && (nActive > 0) && (vActive[nActive - 1] >= CONVOLVER_SYNC_BLOCKS))
             {
-                size_t n                = lsp_min(count, size_t(1 << (brank - 1)));
-
-                // Prepare raising convolution
-                dsp::fill_zero(vConvBuffer, fft_buf_size);
-                dsp::copy(vConvBuffer, data, n);
-                dsp::fastconv_parse(conv, vConvBuffer, brank);
-
-                data                   += n;
-                conv                   += (1 << (brank + 1));
-                count                  -= n;
-                nLevels                 ++;             // Increment number of raising levels
+                pTail                   = new TailThread(this);
+                if ((pTail != NULL) && (pTail->start() == STATUS_OK))
+                    nSyncBlocks             = CONVOLVER_SYNC_BLOCKS;
+                else if (pTail != NULL)
+                {
+                    // Fall back to processing of the tail in process() call
+                    delete pTail;
+                    pTail                   = NULL;
+                }
             }
 
-            // Prepare constant part
-            nBlocks                 = 0;
-            while (count > 0)
-            {
-                size_t n            = lsp_min(count, data_buf_size);
-
-                // Prepare raising convolution
-                dsp::fill_zero(vConvBuffer, fft_buf_size);
-                dsp::copy(vConvBuffer, data, n);
-                dsp::fastconv_parse(conv, vConvBuffer, rank);
-
-                data                   += n;
-                conv                   += fft_buf_size;
-                count                  -= n;
-                nBlocks                 ++;             // Increment number of constant-size blocks
-            }
+            // Only non-silent blocks are spread over the steps of the frame
+            nSyncActive             = 0;
+            while ((nSyncActive < nActive) && (vActive[nSyncActive] < nSyncBlocks))
+                ++nSyncActive;
 
-            nBlocksDone             = nBlocks;
+            nBlocksDone             = nSyncActive;
             ssize_t steps           = data_buf_size >> (CONVOLVER_RANK_MIN - 1);
             if (steps <= 1)
             {
-                nBlkInit                = nBlocks;
+                nBlkInit                = nSyncActive;
                 fBlkCoef                = 0.0f;
             }
             else
             {
                 nBlkInit                = 1;
-                fBlkCoef                = (float(nBlocks) + 1e-3f) / (float(steps) - 1.0f);
+                fBlkCoef                = (float(nSyncActive) + 1e-3f) / (float(steps) - 1.0f);
             }
 
-            nRank                   = rank;
-
             return true;
         }
 
         void Convolver::process(float *dst, const float *src, size_t count)
         {
+            LSP_DSP_UNITS_PERF_SCOPE(sPerf, count);
+
             if (vData == NULL)
             {
                 dsp::fill_zero(dst, count);
@@ -247,7 +386,7 @@ namespace lsp
                     // Apply convolution with raising level
                     for (size_t i=0; i<nLevels; ++i)
                     {
-                        if (mask & 1)
+                        if ((mask & 1) && (nLevelMask & (size_t(1) << i)))
                         {
                             const float *fptr   = vFrame + nFrameOff - (1 << (rank - 1));
                             dsp::fastconv_parse_apply(&vDataBuffer[nFrameOff], vConvBuffer, conv, fptr, rank);
@@ -258,27 +397,42 @@ namespace lsp
                         mask              >>= 1;
                     }
 
-                    // Need to apply long tail?
-                    if (nBlocks > 0)
+                    // Need to apply long tail? Silent blocks are skipped
+                    if (nActive > 0)
                     {
                         // Need to reset tasks?
+                        size_t fft_step     = 1 << (nRank + 1);
                         if (mask & 1)
                         {
                             dsp::fastconv_parse(vTaskData, vFrame - nFrameSize, nRank);
                             nBlocksDone         = 0;
+
+                            // Hand off the rest of the tail to the background thread
+                            if (pTail != NULL)
+                            {
+                                atomic_t req        = nTailReq;
+                                size_t slot         = req & 1;
+                                if (req >= 2)
+                                {
+                                    // Wait for the job submitted two frames ago (should not happen normally) and merge it
+                                    while (atomic_add(&nTailDone, 0) < (req - 1))
+                                        /* nothing */ ;
+                                    dsp::add2(vDataBuffer, vTailData[slot], (nBlocks - CONVOLVER_SYNC_BLOCKS + 1) * nFrameSize);
+                                }
+
+                                dsp::copy(vTailTask[slot], vTaskData, fft_step);
+                                atomic_add(&nTailReq, 1);
+                            }
                         }
 
                         // Need to execute tasks?
-                        size_t target_blk   = lsp_min(nBlocks, size_t(nBlkInit + fBlkCoef * sub_id));
-                        size_t fft_step     = 1 << (nRank + 1);
-                        conv                = &vConvData[(nBlocksDone + 1) * fft_step];     // Source convolution
-                        float *xdst         = &vDataBuffer[nBlocksDone << (nRank - 1)];     // Offset to store the block
-
+                        size_t target_blk   = lsp_min(nSyncActive, size_t(nBlkInit + fBlkCoef * sub_id));
                         for ( ; nBlocksDone < target_blk; ++nBlocksDone)
                         {
-                            dsp::fastconv_apply(xdst, vConvBuffer, conv, vTaskData, rank);
-                            xdst               += (fft_step >> 2);
-                            conv               += fft_step;
+                            size_t blk          = vActive[nBlocksDone];
+                            conv                = ConvolverCache::block(pSpectrum, blk, vBlockData); // Source convolution
+                            float *xdst         = &vDataBuffer[blk << (nRank - 1)];     // Offset to store the block
+                            dsp::fastconv_apply(xdst, vConvBuffer, conv, vTaskData, nRank);
                         }
                     }
                 }
@@ -286,10 +440,13 @@ namespace lsp
                 // Apply direct convolution
                 size_t to_do        = lsp_min(count, size_t(CONVOLVER_MIN_DATA_BUF_SIZE - sub_off));
                 dsp::copy(&vFrame[nFrameOff], src, to_do);      // Store data to frame
-                if (to_do == CONVOLVER_MIN_DATA_BUF_SIZE)
-                    dsp::fastconv_parse_apply(&vDataBuffer[nFrameOff], vConvBuffer, vConvData, src, CONVOLVER_RANK_MIN);
-                else
-                    dsp::convolve(&vDataBuffer[nFrameOff], src, vDirectData, nDirectSize, to_do);
+                if (bDirect)
+                {
+                    if (to_do == CONVOLVER_MIN_DATA_BUF_SIZE)
+                        dsp::fastconv_parse_apply(&vDataBuffer[nFrameOff], vConvBuffer, vConvData, src, CONVOLVER_RANK_MIN);
+                    else
+                        dsp::convolve(&vDataBuffer[nFrameOff], src, vDirectData, nDirectSize, to_do);
+                }
                 dsp::copy(dst, &vDataBuffer[nFrameOff], to_do); // Output result
 
                 // Update counters/pointers
@@ -309,12 +466,22 @@ namespace lsp
             }
         }
 
+        void Convolver::memory_usage(memory_report_t *r) const
+        {
+            memory::add_pages(r, vData, pages::size(vData));
+
+            // The spectrum shared by the cache is accounted by nobody of its users
+            if ((pSpectrum != NULL) && (pCache == NULL))
+                memory::add_aligned(r, pSpectrum->vData, pSpectrum->nBytes, pSpectrum->nBytes, CONVOLVER_DATA_ALIGN);
+        }
+
         void Convolver::dump(IStateDumper *v) const
         {
             v->write("pDataBuffer", vDataBuffer);
             v->write("vFrame", vFrame);
             v->write("vConvBuffer", vConvBuffer);
             v->write("vTaskData", vTaskData);
+            v->write("vBlockData", vBlockData);
             v->write("vConvData", vConvData);
             v->write("vDirectData", vDirectData);
 
@@ -326,11 +493,30 @@ namespace lsp
             v->write("nLevels", nLevels);
             v->write("nBlocks", nBlocks);
             v->write("nBlocksDone", nBlocksDone);
+            v->write("vActive", vActive);
+            v->write("nActive", nActive);
+            v->write("nSyncActive", nSyncActive);
+            v->write("nLevelMask", nLevelMask);
+            v->write("bDirect", bDirect);
             v->write("nRank", nRank);
             v->write("nBlkInit", nBlkInit);
             v->write("fBlkCoef", fBlkCoef);
+            v->write("nSyncBlocks", nSyncBlocks);
+
+            v->write("pSpectrum", pSpectrum);
+            v->write("pCache", pCache);
+            v->write("pTail", pTail);
+            v->write("vTailTask[0]", vTailTask[0]);
+            v->write("vTailTask[1]", vTailTask[1]);
+            v->write("vTailData[0]", vTailData[0]);
+            v->write("vTailData[1]", vTailData[1]);
+            v->write("vTailBuffer", vTailBuffer);
+            v->write("vTailBlock", vTailBlock);
+            v->write("nTailReq", int32_t(nTailReq));
+            v->write("nTailDone", int32_t(nTailDone));
 
             v->write("vData", vData);
+            v->write_object("sPerf", &sPerf);
         }
     }
 } /* namespace lsp */
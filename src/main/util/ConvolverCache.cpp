@@ -0,0 +1,333 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/dsp-units/util/ConvolverCache.h>
+#include <lsp-plug.in/dsp-units/util/Convolver.h>
+#include <lsp-plug.in/dsp-units/misc/half.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#define CONVOLVER_MIN_DATA_BUF_SIZE         (1 << (CONVOLVER_RANK_MIN - 1))
+#define CONVOLVER_DATA_ALIGN                0x40
+#define CONVOLVER_HALF_PEAK                 16384.0f        /* peak of the normalized block stored as binary16 */
+
+namespace lsp
+{
+    namespace dspu
+    {
+        static ConvolverCache global_cache;
+
+        static uint64_t hash_data(const float *data, size_t count)
+        {
+            // FNV-1a hash of the impulse response data
+            const uint8_t *ptr  = reinterpret_cast<const uint8_t *>(data);
+            uint64_t hash       = 0xcbf29ce484222325ULL;
+
+            for (size_t i=0, n=count * sizeof(float); i<n; ++i)
+            {
+                hash               ^= ptr[i];
+                hash               *= 0x100000001b3ULL;
+            }
+
+            return hash;
+        }
+
+        ConvolverCache::ConvolverCache()
+        {
+        }
+
+        ConvolverCache::~ConvolverCache()
+        {
+            for (size_t i=0, n=vItems.size(); i<n; ++i)
+                destroy(vItems.uget(i));
+            vItems.flush();
+        }
+
+        ConvolverCache *ConvolverCache::global()
+        {
+            return &global_cache;
+        }
+
+        static inline half::format_t half_format(size_t precision)
+        {
+            return (precision == CONVOLVER_BFLOAT16) ? half::BFLOAT16 : half::FLOAT16;
+        }
+
+        convolver_spectrum_t *ConvolverCache::create(const float *data, size_t count, size_t rank, convolver_precision_t precision)
+        {
+            rank                    = lsp_limit(ssize_t(rank), CONVOLVER_RANK_MIN, CONVOLVER_RANK_MAX);
+            bool reduced            = precision != CONVOLVER_FLOAT32;
+
+            // Determine size of buffer
+            size_t data_buf_size    = 1 << (rank - 1);
+            size_t fft_buf_size     = 1 << (rank + 1);
+            size_t direct_buf_size  = lsp_max(CONVOLVER_MIN_DATA_BUF_SIZE, int(CONVOLVER_DATA_ALIGN/sizeof(float)));
+            size_t bins             = (count + data_buf_size - 1) >> (rank - 1);
+            size_t conv_bins        = (reduced) ? 1 : bins;
+
+            size_t allocate         = conv_bins * fft_buf_size;         // FFT convolution data
+            allocate               += direct_buf_size;                  // Direct convolution data
+            allocate               += fft_buf_size;                     // Temporary convolution buffer
+            allocate               += bins;                             // Indices of non-silent blocks
+            if (reduced)
+            {
+                allocate               += fft_buf_size;                     // Temporary spectrum of the block
+                allocate               += bins;                             // Scale of each block
+                allocate               += ((bins - 1) * fft_buf_size) >> 1; // Reduced precision data of blocks
+            }
+
+            convolver_spectrum_t *s = new convolver_spectrum_t;
+            if (s == NULL)
+                return NULL;
+
+            // Allocate buffer and clear
+            float *fptr             = alloc_aligned<float>(s->vData, allocate, CONVOLVER_DATA_ALIGN);
+            if (fptr == NULL)
+            {
+                delete s;
+                return NULL;
+            }
+            dsp::fill_zero(fptr, allocate);
+
+            s->nBytes               = allocate * sizeof(float);
+            s->vConvData            = fptr;
+            fptr                   += conv_bins * fft_buf_size;
+            s->vDirectData          = fptr;
+            fptr                   += direct_buf_size;
+            float *buf              = fptr;
+            fptr                   += fft_buf_size;
+            s->vActive              = reinterpret_cast<uint32_t *>(fptr);
+            fptr                   += bins;
+            float *tmp              = NULL;
+            s->vScale               = NULL;
+            s->vHalfData            = NULL;
+            if (reduced)
+            {
+                tmp                     = fptr;
+                fptr                   += fft_buf_size;
+                s->vScale               = fptr;
+                fptr                   += bins;
+                s->vHalfData            = reinterpret_cast<uint16_t *>(fptr);
+            }
+
+            s->nHash                = hash_data(data, count);
+            s->nCount               = count;
+            s->nRank                = rank;
+            s->nDirectSize          = lsp_min(count, size_t(CONVOLVER_MIN_DATA_BUF_SIZE));
+            s->nBins                = bins;
+            s->nPrecision           = precision;
+            s->nRefs                = 1;
+            s->nActive              = 0;
+            s->nLevelMask           = 0;
+
+            // Partitions with the energy below the threshold are not applied by the convolver
+            float silence           = dsp::h_sqr_sum(data, count) * CONVOLVER_SILENCE_LEVEL;
+
+            /* Calculate convolutions
+
+                Conv buffer layout:
+                +---+---+------+------------+------------------------+
+                |FFT|FFT|FFT x2|   FFT x4   |       FFT x8           |  . . .
+                +---+---+------+------------+------------------------+
+             */
+
+            float *conv             = s->vConvData;
+            size_t brank            = CONVOLVER_RANK_MIN;
+
+            // Process direct convolution data
+            s->bDirect              = dsp::h_sqr_sum(data, s->nDirectSize) > silence;
+            dsp::copy(s->vDirectData, data, s->nDirectSize);
+            dsp::fill_zero(buf, fft_buf_size);
+            dsp::copy(buf, data, s->nDirectSize);
+            dsp::fastconv_parse(conv, buf, brank);
+
+            data                   += s->nDirectSize;
+            conv                   += (1 << (brank + 1));
+            count                  -= s->nDirectSize;
+
+            // Prepare raising levels
+            s->nLevels              = 0;
+            for (; (count > 0) && (brank < rank); ++brank)
+            {
+                size_t n                = lsp_min(count, size_t(1 << (brank - 1)));
+                if (dsp::h_sqr_sum(data, n) > silence)
+                    s->nLevelMask          |= size_t(1) << s->nLevels;
+
+                // Prepare raising convolution
+                dsp::fill_zero(buf, fft_buf_size);
+                dsp::copy(buf, data, n);
+                dsp::fastconv_parse(conv, buf, brank);
+
+                data                   += n;
+                conv                   += (1 << (brank + 1));
+                count                  -= n;
+                s->nLevels              ++;             // Increment number of raising levels
+            }
+
+            // Prepare constant part
+            s->nBlocks              = 0;
+            while (count > 0)
+            {
+                size_t n            = lsp_min(count, data_buf_size);
+                if (dsp::h_sqr_sum(data, n) > silence)
+                    s->vActive[s->nActive++]    = s->nBlocks;
+
+                // Prepare raising convolution
+                dsp::fill_zero(buf, fft_buf_size);
+                dsp::copy(buf, data, n);
+                if (reduced)
+                {
+                    // Normalize the block to keep the precision of binary16 and convert
+                    float scale         = 1.0f;
+                    dsp::fastconv_parse(tmp, buf, rank);
+                    if (precision == CONVOLVER_FLOAT16)
+                    {
+                        float peak          = dsp::abs_max(tmp, fft_buf_size);
+                        if (peak > 0.0f)
+                        {
+                            scale               = peak / CONVOLVER_HALF_PEAK;
+                            dsp::mul_k2(tmp, 1.0f / scale, fft_buf_size);
+                        }
+                    }
+                    half::encode(&s->vHalfData[s->nBlocks * fft_buf_size], tmp, fft_buf_size, half_format(precision));
+                    s->vScale[s->nBlocks]   = scale;
+                }
+                else
+                {
+                    dsp::fastconv_parse(conv, buf, rank);
+                    conv                   += fft_buf_size;
+                }
+
+                data                   += n;
+                count                  -= n;
+                s->nBlocks              ++;             // Increment number of constant-size blocks
+            }
+
+            return s;
+        }
+
+        const float *ConvolverCache::block(const convolver_spectrum_t *s, size_t index, float *buf)
+        {
+            size_t fft_buf_size     = 1 << (s->nRank + 1);
+            if (s->vHalfData == NULL)
+                return &s->vConvData[(index + 1) * fft_buf_size];
+
+            half::decode(buf, &s->vHalfData[index * fft_buf_size], fft_buf_size, half_format(s->nPrecision));
+            if (s->vScale[index] != 1.0f)
+                dsp::mul_k2(buf, s->vScale[index], fft_buf_size);
+            return buf;
+        }
+
+        void ConvolverCache::destroy(convolver_spectrum_t *s)
+        {
+            if (s == NULL)
+                return;
+
+            free_aligned(s->vData);
+            delete s;
+        }
+
+        convolver_spectrum_t *ConvolverCache::find(uint64_t hash, size_t count, size_t rank, convolver_precision_t precision)
+        {
+            for (size_t i=0, n=vItems.size(); i<n; ++i)
+            {
+                convolver_spectrum_t *s = vItems.uget(i);
+                if ((s->nHash == hash) && (s->nCount == count) && (s->nRank == rank) && (s->nPrecision == size_t(precision)))
+                {
+                    ++s->nRefs;
+                    return s;
+                }
+            }
+
+            return NULL;
+        }
+
+        convolver_spectrum_t *ConvolverCache::acquire(const float *data, size_t count, size_t rank, convolver_precision_t precision)
+        {
+            uint64_t hash           = hash_data(data, count);
+            rank                    = lsp_limit(ssize_t(rank), CONVOLVER_RANK_MIN, CONVOLVER_RANK_MAX);
+
+            // Lookup for existing spectrum
+            sLock.lock();
+            convolver_spectrum_t *res   = find(hash, count, rank, precision);
+            sLock.unlock();
+            if (res != NULL)
+                return res;
+
+            // Create the new spectrum without holding the lock
+            if ((res = create(data, count, rank, precision)) == NULL)
+                return NULL;
+
+            sLock.lock();
+            // The same spectrum could be added by another thread at this moment
+            convolver_spectrum_t *s     = find(hash, count, rank, precision);
+            if (s != NULL)
+            {
+                sLock.unlock();
+                destroy(res);
+                return s;
+            }
+
+            if (!vItems.add(res))
+            {
+                sLock.unlock();
+                destroy(res);
+                return NULL;
+            }
+            sLock.unlock();
+
+            return res;
+        }
+
+        void ConvolverCache::release(convolver_spectrum_t *s)
+        {
+            if (s == NULL)
+                return;
+
+            sLock.lock();
+            if ((--s->nRefs) > 0)
+            {
+                sLock.unlock();
+                return;
+            }
+
+            for (size_t i=0, n=vItems.size(); i<n; ++i)
+            {
+                if (vItems.uget(i) == s)
+                {
+                    vItems.remove(i);
+                    break;
+                }
+            }
+            sLock.unlock();
+
+            destroy(s);
+        }
+
+        size_t ConvolverCache::size()
+        {
+            sLock.lock();
+            size_t res  = vItems.size();
+            sLock.unlock();
+            return res;
+        }
+    }
+} /* namespace lsp */
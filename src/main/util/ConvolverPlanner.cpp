@@ -0,0 +1,366 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/dsp-units/util/ConvolverPlanner.h>
+#include <lsp-plug.in/dsp-units/util/PerfCounter.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/io/InFileStream.h>
+#include <lsp-plug.in/io/OutFileStream.h>
+#include <lsp-plug.in/stdlib/string.h>
+
+#define PLANNER_STEP_SIZE           (1 << (CONVOLVER_RANK_MIN - 1))
+#define PLANNER_BATCH_SIZE          (1 << (CONVOLVER_RANK_MAX + 1))     /* samples processed per timing run */
+#define PLANNER_FILE_VERSION        1
+
+namespace lsp
+{
+    namespace dspu
+    {
+        #pragma pack(push, 1)
+        typedef struct planner_header_t
+        {
+            char        signature[4];
+            uint32_t    version;
+            uint32_t    rank_min;
+            uint32_t    rank_max;
+        } planner_header_t;
+        #pragma pack(pop)
+
+        static const char planner_signature[] = { 'C', 'V', 'P', 'L' };
+
+        static status_t planner_write(io::IOutStream *os, const void *buf, size_t count)
+        {
+            ssize_t n = os->write(buf, count);
+            if (n < 0)
+                return status_t(-n);
+            return (size_t(n) == count) ? STATUS_OK : STATUS_IO_ERROR;
+        }
+
+        static status_t planner_read(io::IInStream *is, void *buf, size_t count)
+        {
+            uint8_t *dst = static_cast<uint8_t *>(buf);
+            while (count > 0)
+            {
+                ssize_t n = is->read(dst, count);
+                if (n < 0)
+                    return (n == -STATUS_EOF) ? STATUS_CORRUPTED : status_t(-n);
+                else if (n == 0)
+                    return STATUS_CORRUPTED;
+                dst        += n;
+                count      -= n;
+            }
+            return STATUS_OK;
+        }
+
+        ConvolverPlanner::ConvolverPlanner()
+        {
+            construct();
+        }
+
+        ConvolverPlanner::~ConvolverPlanner()
+        {
+            destroy();
+        }
+
+        void ConvolverPlanner::construct()
+        {
+            reset();
+        }
+
+        void ConvolverPlanner::destroy()
+        {
+        }
+
+        void ConvolverPlanner::reset()
+        {
+            // The cost of FFT is proportional to N*log(N), the apply() operation
+            // additionally performs complex multiplication and accumulation
+            for (size_t i=0; i<CONVOLVER_PLANNER_RANKS; ++i)
+            {
+                size_t rank         = CONVOLVER_RANK_MIN + i;
+                float fft           = float(1 << rank) * rank;
+                cost_t *c           = &vCost[i];
+
+                c->fParse           = fft;
+                c->fApply           = 1.25f * fft;
+                c->fParseApply      = c->fParse + c->fApply;
+            }
+
+            bCalibrated         = false;
+        }
+
+        status_t ConvolverPlanner::calibrate(size_t repeats)
+        {
+            repeats             = lsp_max(repeats, size_t(1));
+
+            // Allocate buffers for the maximum rank
+            size_t fft_size     = 1 << (CONVOLVER_RANK_MAX + 1);
+            uint8_t *data       = NULL;
+            float *ptr          = alloc_aligned<float>(data, fft_size * 5);
+            if (ptr == NULL)
+                return STATUS_NO_MEM;
+
+            float *conv         = ptr;
+            float *task         = &ptr[fft_size];
+            float *tmp          = &ptr[fft_size * 2];
+            float *dst          = &ptr[fft_size * 3];
+            float *src          = &ptr[fft_size * 4];
+
+            dsp::fill_zero(ptr, fft_size * 5);
+            for (size_t i=0; i<(fft_size >> 2); ++i)
+                src[i]              = ((i * 0x5bd1e995) & 0xffff) * (2.0f / 0xffff) - 1.0f;
+            dsp::fastconv_parse(conv, src, CONVOLVER_RANK_MAX);
+
+            cost_t cost[CONVOLVER_PLANNER_RANKS];
+            for (size_t i=0; i<CONVOLVER_PLANNER_RANKS; ++i)
+            {
+                size_t rank         = CONVOLVER_RANK_MIN + i;
+                size_t calls        = lsp_max(size_t(PLANNER_BATCH_SIZE >> rank), size_t(1));
+                uint64_t t_parse    = UINT64_MAX, t_apply = UINT64_MAX, t_pa = UINT64_MAX;
+
+                for (size_t j=0; j<repeats; ++j)
+                {
+                    uint64_t t0         = PerfCounter::timestamp();
+                    for (size_t k=0; k<calls; ++k)
+                        dsp::fastconv_parse(task, src, rank);
+                    uint64_t t1         = PerfCounter::timestamp();
+                    for (size_t k=0; k<calls; ++k)
+                        dsp::fastconv_apply(dst, tmp, conv, task, rank);
+                    uint64_t t2         = PerfCounter::timestamp();
+                    for (size_t k=0; k<calls; ++k)
+                        dsp::fastconv_parse_apply(dst, tmp, conv, src, rank);
+                    uint64_t t3         = PerfCounter::timestamp();
+
+                    t_parse             = lsp_min(t_parse, t1 - t0);
+                    t_apply             = lsp_min(t_apply, t2 - t1);
+                    t_pa                = lsp_min(t_pa, t3 - t2);
+                }
+
+                cost[i].fParse      = float(t_parse) / calls;
+                cost[i].fApply      = float(t_apply) / calls;
+                cost[i].fParseApply = float(t_pa) / calls;
+            }
+
+            free_aligned(data);
+
+            // Commit the result
+            for (size_t i=0; i<CONVOLVER_PLANNER_RANKS; ++i)
+                vCost[i]            = cost[i];
+            bCalibrated         = true;
+
+            return STATUS_OK;
+        }
+
+        status_t ConvolverPlanner::save(const char *path) const
+        {
+            io::Path tmp;
+            status_t res = tmp.set(path);
+            return (res == STATUS_OK) ? save(&tmp) : res;
+        }
+
+        status_t ConvolverPlanner::save(const LSPString *path) const
+        {
+            io::Path tmp;
+            status_t res = tmp.set(path);
+            return (res == STATUS_OK) ? save(&tmp) : res;
+        }
+
+        status_t ConvolverPlanner::save(const io::Path *path) const
+        {
+            if (!bCalibrated)
+                return STATUS_NO_DATA;
+
+            status_t res;
+            io::OutFileStream ofs;
+            if ((res = ofs.open(path, io::File::FM_WRITE_NEW)) != STATUS_OK)
+                return res;
+
+            res = save_internal(&ofs);
+            status_t res2 = ofs.close();
+
+            return (res == STATUS_OK) ? res2 : res;
+        }
+
+        status_t ConvolverPlanner::save_internal(io::IOutStream *os) const
+        {
+            status_t res;
+            planner_header_t hdr;
+            memcpy(hdr.signature, planner_signature, sizeof(hdr.signature));
+            hdr.version         = PLANNER_FILE_VERSION;
+            hdr.rank_min        = CONVOLVER_RANK_MIN;
+            hdr.rank_max        = CONVOLVER_RANK_MAX;
+
+            if ((res = planner_write(os, &hdr, sizeof(hdr))) != STATUS_OK)
+                return res;
+            return planner_write(os, vCost, sizeof(vCost));
+        }
+
+        status_t ConvolverPlanner::load(const char *path)
+        {
+            io::Path tmp;
+            status_t res = tmp.set(path);
+            return (res == STATUS_OK) ? load(&tmp) : res;
+        }
+
+        status_t ConvolverPlanner::load(const LSPString *path)
+        {
+            io::Path tmp;
+            status_t res = tmp.set(path);
+            return (res == STATUS_OK) ? load(&tmp) : res;
+        }
+
+        status_t ConvolverPlanner::load(const io::Path *path)
+        {
+            status_t res;
+            io::InFileStream ifs;
+            if ((res = ifs.open(path)) != STATUS_OK)
+                return res;
+
+            if ((res = load_internal(&ifs)) == STATUS_OK)
+                res = ifs.close();
+            else
+                ifs.close();
+
+            return res;
+        }
+
+        status_t ConvolverPlanner::load_internal(io::IInStream *is)
+        {
+            status_t res;
+            planner_header_t hdr;
+            cost_t cost[CONVOLVER_PLANNER_RANKS];
+
+            // Validate header, the profile is machine-specific and stored in native byte order
+            if ((res = planner_read(is, &hdr, sizeof(hdr))) != STATUS_OK)
+                return (res == STATUS_CORRUPTED) ? STATUS_BAD_FORMAT : res;
+            if ((memcmp(hdr.signature, planner_signature, sizeof(hdr.signature)) != 0) ||
+                (hdr.version != PLANNER_FILE_VERSION) ||
+                (hdr.rank_min != CONVOLVER_RANK_MIN) ||
+                (hdr.rank_max != CONVOLVER_RANK_MAX))
+                return STATUS_BAD_FORMAT;
+
+            if ((res = planner_read(is, cost, sizeof(cost))) != STATUS_OK)
+                return res;
+            for (size_t i=0; i<CONVOLVER_PLANNER_RANKS; ++i)
+            {
+                const cost_t *c     = &cost[i];
+                if ((!(c->fParse > 0.0f)) || (!(c->fApply > 0.0f)) || (!(c->fParseApply > 0.0f)))
+                    return STATUS_CORRUPTED;
+            }
+
+            // Commit the result
+            for (size_t i=0; i<CONVOLVER_PLANNER_RANKS; ++i)
+                vCost[i]            = cost[i];
+            bCalibrated         = true;
+
+            return STATUS_OK;
+        }
+
+        float ConvolverPlanner::estimate(size_t count, size_t rank, size_t block_size, bool background) const
+        {
+            rank                = lsp_limit(rank, size_t(CONVOLVER_RANK_MIN), size_t(CONVOLVER_RANK_MAX));
+
+            /*
+                The Convolver performs its work by steps of PLANNER_STEP_SIZE samples:
+                - the direct part is applied at each step;
+                - the raising level of rank k is applied each 2^(k - CONVOLVER_RANK_MIN) steps;
+                - the tail is parsed once per frame of 2^(rank-1) samples and its blocks
+                  are spread over the steps of the frame.
+                The average cost of the step and the cost of the step where all levels
+                trigger at once give the worst-case cost of the host block.
+             */
+            const cost_t *c     = vCost;
+            float avg           = c->fParseApply;
+            float peak          = c->fParseApply;
+            count               = (count > PLANNER_STEP_SIZE) ? count - PLANNER_STEP_SIZE : 0;
+
+            // Raising levels
+            size_t level        = CONVOLVER_RANK_MIN;
+            for ( ; (count > 0) && (level < rank); ++level)
+            {
+                size_t n            = lsp_min(count, size_t(1 << (level - 1)));
+                c                   = &vCost[level - CONVOLVER_RANK_MIN];
+                avg                += c->fParseApply / float(1 << (level - CONVOLVER_RANK_MIN));
+                peak               += c->fParseApply;
+                count              -= n;
+            }
+
+            // Constant-size tail blocks
+            if (count > 0)
+            {
+                size_t frame        = 1 << (rank - 1);
+                size_t blocks       = (count + frame - 1) / frame;
+                size_t sync         = ((background) && (blocks > CONVOLVER_SYNC_BLOCKS)) ? CONVOLVER_SYNC_BLOCKS : blocks;
+                size_t steps        = frame / PLANNER_STEP_SIZE;
+                size_t per_step     = (steps <= 1) ? sync : (sync + steps - 2) / (steps - 1);
+
+                c                   = &vCost[rank - CONVOLVER_RANK_MIN];
+                avg                += (c->fParse + sync * c->fApply) / float(steps);
+                peak               += c->fParse + per_step * c->fApply;
+            }
+
+            // Host block covers several steps, only one of them can be the peak one
+            size_t steps        = lsp_max(block_size / PLANNER_STEP_SIZE, size_t(1));
+            return peak + (steps - 1) * avg;
+        }
+
+        size_t ConvolverPlanner::plan(size_t count, size_t block_size, bool background) const
+        {
+            size_t rank         = CONVOLVER_RANK_MIN;
+            float cost          = estimate(count, rank, block_size, background);
+
+            // Prefer lower rank on equal cost since it requires less memory
+            for (size_t i=CONVOLVER_RANK_MIN+1; i<=CONVOLVER_RANK_MAX; ++i)
+            {
+                float c             = estimate(count, i, block_size, background);
+                if (c < cost)
+                {
+                    rank                = i;
+                    cost                = c;
+                }
+            }
+
+            return rank;
+        }
+
+        void ConvolverPlanner::dump(IStateDumper *v) const
+        {
+            v->begin_array("vCost", vCost, CONVOLVER_PLANNER_RANKS);
+            {
+                for (size_t i=0; i<CONVOLVER_PLANNER_RANKS; ++i)
+                {
+                    const cost_t *c = &vCost[i];
+                    v->begin_object(c, sizeof(cost_t));
+                    {
+                        v->write("fParse", c->fParse);
+                        v->write("fApply", c->fApply);
+                        v->write("fParseApply", c->fParseApply);
+                    }
+                    v->end_object();
+                }
+            }
+            v->end_array();
+            v->write("bCalibrated", bCalibrated);
+        }
+    } /* namespace dspu */
+} /* namespace lsp */
@@ -24,6 +24,8 @@
 #include <lsp-plug.in/dsp-units/util/Crossover.h>
 #include <lsp-plug.in/dsp-units/units.h>
 
+#define XOVER_CHART_CHUNK       0x40
+
 namespace lsp
 {
     namespace dspu
@@ -52,8 +54,16 @@ namespace lsp
 
             vLpfBuf         = NULL;
             vHpfBuf         = NULL;
+            vRateBuf        = NULL;
+            vDecimBuf       = NULL;
+            vOver           = NULL;
+            nLatency        = 0;
+            bMultirate      = false;
 
             pData           = NULL;
+            pArena          = NULL;
+
+            sPerf.construct();
         }
 
         void Crossover::destroy()
@@ -68,23 +78,58 @@ namespace lsp
                 }
             }
 
+            if (vBands != NULL)
+            {
+                for (size_t i=0; i<=nSplits; ++i)
+                    vBands[i].sDelay.destroy();
+            }
+
+            if (vOver != NULL)
+            {
+                for (size_t i=0; i<=nSplits; ++i)
+                    vOver[i].destroy();
+                delete [] vOver;
+                vOver           = NULL;
+            }
+
             free_aligned(pData);
             construct();
         }
 
         bool Crossover::init(size_t bands, size_t buf_size)
+        {
+            return init(bands, buf_size, NULL);
+        }
+
+        bool Crossover::init(size_t bands, size_t buf_size, ScratchArena *arena)
+        {
+            return init(bands, buf_size, arena, false);
+        }
+
+        bool Crossover::init(size_t bands, size_t buf_size, ScratchArena *arena, bool multirate)
         {
             if (bands < 1)
                 return false;
 
+            // Temporary buffers are borrowed from the arena if it is present
             size_t xbuf_size    = align_size(buf_size * sizeof(float), DEFAULT_ALIGN);
+            if (arena != NULL)
+            {
+                if (!arena->reserve(ScratchArena::aligned(buf_size) * 2))
+                    return false;
+                xbuf_size           = 0;
+            }
             size_t band_size    = align_size(bands * sizeof(band_t), DEFAULT_ALIGN);
             size_t split_size   = align_size((bands - 1) * sizeof(split_t), DEFAULT_ALIGN);
             size_t plan_size    = align_size((bands - 1) * sizeof(split_t *), DEFAULT_ALIGN);
+            size_t rate_size    = (multirate) ? align_size((buf_size + XOVER_DECIM_MAX * 2) * sizeof(float), DEFAULT_ALIGN) : 0;
+            size_t decim_size   = (multirate) ? align_size((buf_size / 2 + XOVER_DECIM_MAX) * sizeof(float), DEFAULT_ALIGN) : 0;
             size_t to_alloc     = band_size +
                                   split_size +
                                   plan_size +
-                                  xbuf_size * 2;
+                                  xbuf_size * 2 +
+                                  rate_size +
+                                  decim_size;
 
             // Allocate buffers
             uint8_t *data       = NULL;
@@ -99,10 +144,14 @@ namespace lsp
             ptr                += split_size;
             vPlan               = reinterpret_cast<split_t **>(ptr);
             ptr                += plan_size;
-            vLpfBuf             = reinterpret_cast<float *>(ptr);
+            vLpfBuf             = (arena != NULL) ? NULL : reinterpret_cast<float *>(ptr);
             ptr                += xbuf_size;
-            vHpfBuf             = reinterpret_cast<float *>(ptr);
+            vHpfBuf             = (arena != NULL) ? NULL : reinterpret_cast<float *>(ptr);
             ptr                += xbuf_size;
+            vRateBuf            = (multirate) ? reinterpret_cast<float *>(ptr) : NULL;
+            ptr                += rate_size;
+            vDecimBuf           = (multirate) ? reinterpret_cast<float *>(ptr) : NULL;
+            ptr                += decim_size;
 
             // Initialize fields, keep sample_rate unchanged
             nReconfigure        = R_ALL;
@@ -112,6 +161,40 @@ namespace lsp
 
             // Store allocated data pointer
             pData               = data;
+            pArena              = arena;
+
+            // Construct delays and resamplers of bands first, destroy() relies on them
+            for (size_t i=0; i<bands; ++i)
+            {
+                band_t *sb          = &vBands[i];
+                sb->sDelay.construct();
+                sb->pOver           = NULL;
+            }
+            if (multirate)
+            {
+                vOver               = new Oversampler[bands];
+                if (vOver == NULL)
+                {
+                    destroy();
+                    return false;
+                }
+
+                for (size_t i=0; i<bands; ++i)
+                {
+                    band_t *sb          = &vBands[i];
+                    sb->pOver           = &vOver[i];
+                    if ((!sb->pOver->init()) || (!sb->sDelay.init(XOVER_DECIM_LATENCY_MAX)))
+                    {
+                        destroy();
+                        return false;
+                    }
+
+                    // The mode is switched immediately, only half-band stages are used
+                    sb->pOver->set_transition(0);
+                    sb->pOver->set_filtering(false);
+                    sb->pOver->set_halfband_taps(OS_HALFBAND_TAPS_DFL);
+                }
+            }
 
             // Construct all splits
             float step          = logf(LSP_DSP_UNITS_SPEC_FREQ_MAX / LSP_DSP_UNITS_SPEC_FREQ_MIN) / bands;
@@ -164,6 +247,15 @@ namespace lsp
                 sb->pObject         = NULL;
                 sb->pSubject        = NULL;
                 sb->nId             = i;
+
+                sb->pProc           = NULL;
+                sb->pProcObject     = NULL;
+                sb->pProcSubject    = NULL;
+
+                sb->nDecim          = 0;
+                sb->nPending        = 0;
+                sb->nReady          = 0;
+                sb->nFirst          = 0;
             }
 
             return true;
@@ -282,6 +374,58 @@ namespace lsp
             return true;
         }
 
+        bool Crossover::set_processor(size_t band, crossover_proc_t func, void *object, void *subject)
+        {
+            if (band > nSplits)
+                return false;
+
+            band_t *b       = &vBands[band];
+            b->pProc        = func;
+            b->pProcObject  = object;
+            b->pProcSubject = subject;
+            nReconfigure   |= R_RATE;
+
+            return true;
+        }
+
+        bool Crossover::unset_processor(size_t band)
+        {
+            if (band > nSplits)
+                return false;
+
+            band_t *b       = &vBands[band];
+            b->pProc        = NULL;
+            b->pProcObject  = NULL;
+            b->pProcSubject = NULL;
+            nReconfigure   |= R_RATE;
+
+            return true;
+        }
+
+        void Crossover::set_multirate(bool enable)
+        {
+            if (bMultirate == enable)
+                return;
+
+            bMultirate      = enable;
+            nReconfigure   |= R_RATE;
+        }
+
+        size_t Crossover::latency()
+        {
+            reconfigure();
+            return nLatency;
+        }
+
+        size_t Crossover::band_decimation(size_t band)
+        {
+            if (band > nSplits)
+                return 0;
+
+            reconfigure();
+            return lsp_max(vBands[band].nDecim, size_t(1));
+        }
+
         bool Crossover::band_active(size_t band)
         {
             if (band > nSplits)
@@ -305,6 +449,10 @@ namespace lsp
                 vSplit[i].sHPF.set_sample_rate(sr);
             }
 
+            // Force the reconfiguration of resamplers
+            for (size_t i=0; i<=nSplits; ++i)
+                vBands[i].nDecim    = 0;
+
             nReconfigure   |= R_ALL;
         }
 
@@ -313,6 +461,8 @@ namespace lsp
             if (!nReconfigure)
                 return;
 
+            LSP_DSP_UNITS_PERF_RECONFIGURE(sPerf);
+
             // Form the plan and reset band state
             nPlanSize       = 0;
             for (size_t i=0; i<nSplits; ++i)
@@ -406,6 +556,32 @@ namespace lsp
             left->fEnd          = nSampleRate * 0.5f;
             left->pEnd          = NULL;
 
+            // Select decimation of bands and align all bands to the same latency
+            nLatency            = 0;
+            if (vRateBuf != NULL)
+            {
+                for (size_t i=0; i<=nSplits; ++i)
+                {
+                    band_t *b           = &vBands[i];
+                    size_t decim        = 1;
+                    if ((bMultirate) && (b->bEnabled) && (b->pProc != NULL) && (b->pEnd != NULL))
+                    {
+                        while ((decim < XOVER_DECIM_MAX) &&
+                               (b->fEnd * XOVER_DECIM_MARGIN * decim * 4 <= nSampleRate))
+                            decim             <<= 1;
+                    }
+
+                    configure_rate(b, decim);
+                    nLatency            = lsp_max(nLatency, band_latency(b));
+                }
+
+                for (size_t i=0; i<=nSplits; ++i)
+                {
+                    band_t *b           = &vBands[i];
+                    b->sDelay.set_delay(nLatency - band_latency(b));
+                }
+            }
+
             // DEBUG BEGIN
         #ifdef LSP_TRACE
             lsp_trace("Execution plan:");
@@ -432,9 +608,107 @@ namespace lsp
             nReconfigure        = 0;
         }
 
+        size_t Crossover::band_latency(const band_t *b)
+        {
+            // Decimation and interpolation delay the signal by (taps - 1) samples per each
+            // 2x stage at its rate, the band also waits for the full group of samples
+            return (b->nDecim > 1) ? (b->nDecim - 1) * b->pOver->get_halfband_taps() : 0;
+        }
+
+        void Crossover::configure_rate(band_t *b, size_t decim)
+        {
+            if (b->nDecim == decim)
+                return;
+
+            b->nDecim           = decim;
+            b->nPending         = 0;
+            b->nReady           = decim - 1;
+            dsp::fill_zero(b->vReady, XOVER_DECIM_MAX);
+            b->sDelay.clear();
+
+            if (decim <= 1)
+                return;
+
+            // The oversampler is used in reverse: the band is its oversampled signal
+            b->pOver->set_sample_rate(nSampleRate / decim);
+            b->pOver->set_mode((decim >= 8) ? OM_HALFBAND_8X : (decim >= 4) ? OM_HALFBAND_4X : OM_HALFBAND_2X);
+            b->pOver->update_settings();
+        }
+
+        void Crossover::process_band(band_t *b, float *buf, size_t first, size_t count)
+        {
+            const size_t decim  = b->nDecim;
+
+            if (decim <= 1)
+            {
+                if (b->pProc != NULL)
+                    b->pProc(b->pProcObject, b->pProcSubject, b->nId, buf, first, count);
+            }
+            else
+            {
+                // Decimate full groups of samples, keep the rest for the next call
+                float *x            = vRateBuf;
+                dsp::copy(x, b->vPending, b->nPending);
+                dsp::copy(&x[b->nPending], buf, count);
+                size_t total        = b->nPending + count;
+                size_t groups       = total / decim;
+                size_t tail         = groups * decim;
+                b->nPending         = total - tail;
+                dsp::copy(b->vPending, &x[tail], b->nPending);
+                if (groups > 0)
+                    b->pOver->downsample(vDecimBuf, x, groups);
+
+                // Process the band at its own rate and interpolate it after the samples left from the previous call
+                dsp::copy(x, b->vReady, b->nReady);
+                if (groups > 0)
+                {
+                    if (b->pProc != NULL)
+                        b->pProc(b->pProcObject, b->pProcSubject, b->nId, vDecimBuf, b->nFirst, groups);
+                    b->pOver->upsample(&x[b->nReady], vDecimBuf, groups);
+                    b->nFirst          += groups;
+                }
+
+                // There are always at least count samples available
+                total               = b->nReady + tail;
+                dsp::copy(buf, x, count);
+                b->nReady           = total - count;
+                dsp::copy(b->vReady, &x[count], b->nReady);
+            }
+
+            // Align the latency of the band to the latency of the crossover
+            if (b->sDelay.get_delay() > 0)
+                b->sDelay.process(buf, buf, count);
+        }
+
+        size_t Crossover::borrow_buffers()
+        {
+            if (pArena == NULL)
+                return 0;
+
+            size_t mark         = pArena->mark();
+            vLpfBuf             = pArena->alloc(nBufSize);
+            vHpfBuf             = pArena->alloc(nBufSize);
+            return mark;
+        }
+
+        void Crossover::return_buffers(size_t mark)
+        {
+            if (pArena == NULL)
+                return;
+
+            pArena->release(mark);
+            vLpfBuf             = NULL;
+            vHpfBuf             = NULL;
+        }
+
         void Crossover::process(const float *in, size_t samples)
         {
+            LSP_DSP_UNITS_PERF_SCOPE(sPerf, samples);
+
             reconfigure();
+            size_t mark         = borrow_buffers();
+            for (size_t i=0; i<=nSplits; ++i)
+                vBands[i].nFirst    = 0;
 
             for (size_t sample=0; sample < samples; )
             {
@@ -457,7 +731,10 @@ namespace lsp
 
                         // Now call handlers
                         if (left->pFunc != NULL)
+                        {
+                            process_band(left, vLpfBuf, sample, to_do);
                             left->pFunc(left->pObject, left->pSubject, left->nId, vLpfBuf, sample, to_do);
+                        }
 
                         src                 = vHpfBuf;
                         left                = right;
@@ -465,18 +742,81 @@ namespace lsp
 
                     // Process last band
                     if (left->pFunc != NULL)
+                    {
+                        process_band(left, vHpfBuf, sample, to_do);
                         left->pFunc(left->pObject, left->pSubject, left->nId, vHpfBuf, sample, to_do);
+                    }
                 }
                 else if (left->pFunc != NULL)
                 {
                     dsp::mul_k3(vLpfBuf, src, vBands[0].fGain, to_do);
+                    process_band(left, vLpfBuf, sample, to_do);
                     left->pFunc(left->pObject, left->pSubject, left->nId, vLpfBuf, sample, to_do);
                 }
 
                 // Update pointers
                 in                 += to_do;
-                sample             -= to_do;
+                sample             += to_do;
             }
+
+            return_buffers(mark);
+        }
+
+        void Crossover::process(float * const *out, const float *in, size_t samples)
+        {
+            LSP_DSP_UNITS_PERF_SCOPE(sPerf, samples);
+
+            reconfigure();
+            size_t mark         = borrow_buffers();
+            for (size_t i=0; i<=nSplits; ++i)
+                vBands[i].nFirst    = 0;
+
+            for (size_t sample=0; sample < samples; )
+            {
+                size_t to_do        = lsp_min(samples - sample, nBufSize);
+                band_t *left        = &vBands[0];
+                float *dst          = out[0];
+                const float *src    = in;
+
+                if (nPlanSize > 0)
+                {
+                    for (size_t i=0; i<nPlanSize; ++i)
+                    {
+                        split_t *sp         = vPlan[i];
+                        band_t *right       = &vBands[sp->nBandId];
+                        float *next         = out[sp->nBandId];
+
+                        // Perform HPF first because LPF may overwrite the source (in-place)
+                        float *hp           = (next != NULL) ? &next[sample] :
+                                              (src != vHpfBuf) ? vHpfBuf : vLpfBuf;
+                        sp->sHPF.process(hp, src, to_do);
+                        if (dst != NULL)
+                        {
+                            sp->sLPF.process(&dst[sample], src, to_do);
+                            process_band(left, &dst[sample], sample, to_do);
+                        }
+
+                        src                 = hp;
+                        dst                 = next;
+                        left                = right;
+                    }
+
+                    // Process last band, the high-pass signal is not needed anymore
+                    if (dst != NULL)
+                        process_band(left, &dst[sample], sample, to_do);
+                }
+                else if (dst != NULL)
+                {
+                    dsp::mul_k3(&dst[sample], src, vBands[0].fGain, to_do);
+                    process_band(left, &dst[sample], sample, to_do);
+                }
+
+                // Update pointers
+                in                 += to_do;
+                sample             += to_do;
+            }
+
+            return_buffers(mark);
         }
 
         bool Crossover::freq_chart(size_t band, float *re, float *im, const float *f, size_t count)
@@ -506,15 +846,21 @@ namespace lsp
                 b->pEnd->sLPF.freq_chart(re, im, f, count);
             else
             {
-                // Compute frequency chart with chunks of maximum nBufSize size
+                // Compute frequency chart with chunks of maximum nBufSize size, the buffers
+                // borrowed from the arena belong to the processing thread, use the stack instead
+                float xbuf[XOVER_CHART_CHUNK * 2];
+                float *xre      = (pArena != NULL) ? xbuf : vLpfBuf;
+                float *xim      = (pArena != NULL) ? &xbuf[XOVER_CHART_CHUNK] : vHpfBuf;
+                size_t chunk    = (pArena != NULL) ? lsp_min(nBufSize, size_t(XOVER_CHART_CHUNK)) : nBufSize;
+
                 while (count > 0)
                 {
-                    size_t to_do    = lsp_min(count, nBufSize);
+                    size_t to_do    = lsp_min(count, chunk);
 
                     // Apply frequency chart
                     b->pStart->sHPF.freq_chart(re, im, f, to_do);
-                    b->pEnd->sLPF.freq_chart(size_t(0), vLpfBuf, vHpfBuf, f, to_do);
-                    dsp::complex_mul2(re, im, vLpfBuf, vHpfBuf, to_do);
+                    b->pEnd->sLPF.freq_chart(size_t(0), xre, xim, f, to_do);
+                    dsp::complex_mul2(re, im, xre, xim, to_do);
 
                     // Update pointers
                     re             += to_do;
@@ -548,16 +894,21 @@ namespace lsp
                 b->pEnd->sLPF.freq_chart(c, f, count);
             else
             {
-                // Compute frequency chart with chunks of maximum nBufSize size
+                // Compute frequency chart with chunks of maximum nBufSize size, the buffers
+                // borrowed from the arena belong to the processing thread, use the stack instead
+                float xbuf[XOVER_CHART_CHUNK * 2];
+                float *xc       = (pArena != NULL) ? xbuf : vLpfBuf;
+                size_t chunk    = (pArena != NULL) ? lsp_min(nBufSize, size_t(XOVER_CHART_CHUNK)) : nBufSize;
+
                 while (count > 0)
                 {
                     // We can go out of vLpfBuf because vHpfBuf is there after it
-                    size_t to_do    = lsp_min(count, nBufSize);
+                    size_t to_do    = lsp_min(count, chunk);
 
                     // Apply frequency chart
                     b->pStart->sHPF.freq_chart(c, f, to_do);
-                    b->pEnd->sLPF.freq_chart(size_t(0), vLpfBuf, f, to_do);
-                    dsp::pcomplex_mul2(c, vLpfBuf, to_do);
+                    b->pEnd->sLPF.freq_chart(size_t(0), xc, f, to_do);
+                    dsp::pcomplex_mul2(c, xc, to_do);
 
                     // Update pointers
                     c              += to_do * 2;
@@ -593,6 +944,18 @@ namespace lsp
                     v->write("pOpbject", b->pObject);
                     v->write("pSubject", b->pSubject);
                     v->write("nId", b->nId);
+
+                    v->write("pProc", b->pProc);
+                    v->write("pProcObject", b->pProcObject);
+                    v->write("pProcSubject", b->pProcSubject);
+                    v->write("pOver", b->pOver);
+                    v->write_object("sDelay", &b->sDelay);
+                    v->write("nDecim", b->nDecim);
+                    v->write("nPending", b->nPending);
+                    v->write("nReady", b->nReady);
+                    v->write("nFirst", b->nFirst);
+                    v->writev("vPending", b->vPending, XOVER_DECIM_MAX);
+                    v->writev("vReady", b->vReady, XOVER_DECIM_MAX);
                 }
                 v->end_object();
             }
@@ -621,7 +984,22 @@ namespace lsp
 
             v->write("vLpfBuf", vLpfBuf);
             v->write("vHpfBuf", vHpfBuf);
+            v->write("vRateBuf", vRateBuf);
+            v->write("vDecimBuf", vDecimBuf);
+            if (vOver != NULL)
+            {
+                v->begin_array("vOver", vOver, nSplits+1);
+                for (size_t i=0; i<=nSplits; ++i)
+                    v->write_object(&vOver[i]);
+                v->end_array();
+            }
+            else
+                v->write("vOver", vOver);
+            v->write("nLatency", nLatency);
+            v->write("bMultirate", bMultirate);
             v->write("pData", pData);
+            v->write("pArena", pArena);
+            v->write_object("sPerf", &sPerf);
         }
     }
 } /* namespace lsp */
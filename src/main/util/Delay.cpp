@@ -46,6 +46,7 @@ namespace lsp
             nTail       = 0;
             nDelay      = 0;
             nSize       = 0;
+            sIdle.construct();
         }
 
         bool Delay::init(size_t max_size)
@@ -77,6 +78,12 @@ namespace lsp
 
         void Delay::process(float *dst, const float *src, size_t count)
         {
+            if (sIdle.process(src, count))
+            {
+                dsp::fill_zero(dst, count);
+                return;
+            }
+
             size_t free_gap = nSize - nDelay;
 
             while (count > 0)
@@ -115,6 +122,12 @@ namespace lsp
 
         void Delay::process(float *dst, const float *src, float gain, size_t count)
         {
+            if (sIdle.process(src, count))
+            {
+                dsp::fill_zero(dst, count);
+                return;
+            }
+
             size_t free_gap = nSize - nDelay;
 
             while (count > 0)
@@ -153,6 +166,12 @@ namespace lsp
 
         void Delay::process(float *dst, const float *src, const float *gain, size_t count)
         {
+            if (sIdle.process(src, count))
+            {
+                dsp::fill_zero(dst, count);
+                return;
+            }
+
             size_t free_gap = nSize - nDelay;
 
             while (count > 0)
@@ -216,6 +235,8 @@ namespace lsp
             } while ((--count) > 0);
 
             nDelay  = delay;
+            sIdle.set_tail(delay);
+            sIdle.wake();
         }
 
         void Delay::process_ramping(float *dst, const float *src, float gain, size_t delay, size_t count)
@@ -244,6 +265,8 @@ namespace lsp
             } while ((--count) > 0);
 
             nDelay  = delay;
+            sIdle.set_tail(delay);
+            sIdle.wake();
         }
 
         float Delay::process(float src)
@@ -252,6 +275,7 @@ namespace lsp
             float ret       = pBuffer[nTail];
             nHead           = (nHead + 1) % nSize;
             nTail           = (nTail + 1) % nSize;
+            sIdle.wake();   // The data bypasses the idle detector
 
             return ret;
         }
@@ -262,6 +286,7 @@ namespace lsp
             float ret       = pBuffer[nTail] * gain;
             nHead           = (nHead + 1) % nSize;
             nTail           = (nTail + 1) % nSize;
+            sIdle.wake();   // The data bypasses the idle detector
 
             return ret;
         }
@@ -271,6 +296,7 @@ namespace lsp
             delay      %= nSize;
             nDelay      = delay;
             nTail       = (nHead + nSize - delay) % nSize;
+            sIdle.set_tail(delay);
         }
 
         void Delay::clear()
@@ -280,6 +306,12 @@ namespace lsp
             dsp::fill_zero(pBuffer, nSize);
         }
 
+        void Delay::memory_usage(memory_report_t *r) const
+        {
+            if (pBuffer != NULL)
+                memory::add(r, nSize * sizeof(float), nDelay * sizeof(float));
+        }
+
         void Delay::dump(IStateDumper *v) const
         {
             v->write("pBuffer", pBuffer);
@@ -287,6 +319,7 @@ namespace lsp
             v->write("nTail", nTail);
             v->write("nDelay", nDelay);
             v->write("nSize", nSize);
+            v->write_object("sIdle", &sIdle);
         }
     }
 } /* namespace lsp */
@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/dsp-units/util/DelayBank.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#define DELAY_GAP       0x200
+
+namespace lsp
+{
+    namespace dspu
+    {
+        DelayBank::DelayBank()
+        {
+            construct();
+        }
+
+        DelayBank::~DelayBank()
+        {
+            destroy();
+        }
+
+        void DelayBank::construct()
+        {
+            vBuffer     = NULL;
+            vChannels   = NULL;
+            nChannels   = 0;
+            nHead       = 0;
+            nSize       = 0;
+            nMaxDelay   = 0;
+            pData       = NULL;
+        }
+
+        void DelayBank::destroy()
+        {
+            free_aligned(pData);
+            vBuffer     = NULL;
+            vChannels   = NULL;
+            nChannels   = 0;
+            nSize       = 0;
+        }
+
+        bool DelayBank::init(size_t channels, size_t max_delay)
+        {
+            size_t size         = align_size(max_delay + DELAY_GAP, DELAY_GAP);
+            size_t ch_size      = align_size(sizeof(channel_t) * channels, DEFAULT_ALIGN);
+            size_t to_alloc     = size * channels * sizeof(float) + ch_size;
+
+            uint8_t *data       = NULL;
+            uint8_t *ptr        = alloc_aligned<uint8_t>(data, lsp_max(to_alloc, size_t(DEFAULT_ALIGN)));
+            if (ptr == NULL)
+                return false;
+
+            free_aligned(pData);
+
+            vBuffer             = reinterpret_cast<float *>(ptr);
+            ptr                += size * channels * sizeof(float);
+            vChannels           = reinterpret_cast<channel_t *>(ptr);
+            ptr                += ch_size;
+
+            nChannels           = channels;
+            nHead               = 0;
+            nSize               = size;
+            nMaxDelay           = max_delay;
+            pData               = data;
+
+            dsp::fill_zero(vBuffer, nSize * nChannels);
+            for (size_t i=0; i<channels; ++i)
+            {
+                channel_t *c        = &vChannels[i];
+                c->nDelay           = 0;
+                c->nNewDelay        = 0;
+            }
+
+            return true;
+        }
+
+        void DelayBank::set_delay(size_t channel, size_t delay, bool ramp)
+        {
+            if (channel >= nChannels)
+                return;
+
+            channel_t *c        = &vChannels[channel];
+            c->nNewDelay        = lsp_min(delay, nMaxDelay);
+            if (!ramp)
+                c->nDelay           = c->nNewDelay;
+        }
+
+        size_t DelayBank::get_delay(size_t channel) const
+        {
+            return (channel < nChannels) ? vChannels[channel].nNewDelay : 0;
+        }
+
+        void DelayBank::process(float * const *dst, const float * const *src, size_t count)
+        {
+            size_t gap      = nSize - nMaxDelay;
+
+            for (size_t offset=0; offset < count; )
+            {
+                size_t to_do    = lsp_min(count - offset, gap);
+                size_t head     = nHead;
+
+                for (size_t i=0; i<nChannels; ++i)
+                {
+                    channel_t *c    = &vChannels[i];
+                    float *buf      = &vBuffer[i * nSize];
+                    const float *in = src[i];
+                    float *out      = dst[i];
+
+                    // Write the input data to the buffer of the channel
+                    size_t n        = lsp_min(nSize - head, to_do);
+                    if (in != NULL)
+                    {
+                        dsp::copy(&buf[head], &in[offset], n);
+                        dsp::copy(buf, &in[offset + n], to_do - n);
+                    }
+                    else
+                    {
+                        dsp::fill_zero(&buf[head], n);
+                        dsp::fill_zero(buf, to_do - n);
+                    }
+
+                    if (out == NULL)
+                        continue;
+                    out            += offset;
+
+                    if (c->nDelay == c->nNewDelay)
+                    {
+                        // Constant delay: at most two contiguous reads from the buffer
+                        size_t pos      = (head + nSize - c->nDelay) % nSize;
+                        n               = lsp_min(nSize - pos, to_do);
+                        dsp::copy(out, &buf[pos], n);
+                        dsp::copy(&out[n], buf, to_do - n);
+                    }
+                    else
+                    {
+                        // Ramp the delay over the whole call
+                        float dd        = float(ssize_t(c->nNewDelay) - ssize_t(c->nDelay)) / float(count);
+
+                        for (size_t j=0; j<to_do; ++j)
+                        {
+                            size_t delay    = ssize_t(c->nDelay + dd * (offset + j));
+                            out[j]          = buf[(head + j + nSize - delay) % nSize];
+                        }
+                    }
+                }
+
+                nHead           = (nHead + to_do) % nSize;
+                offset         += to_do;
+            }
+
+            // Commit the ramped delays
+            for (size_t i=0; i<nChannels; ++i)
+            {
+                channel_t *c    = &vChannels[i];
+                c->nDelay       = c->nNewDelay;
+            }
+        }
+
+        void DelayBank::clear()
+        {
+            if (vBuffer == NULL)
+                return;
+            dsp::fill_zero(vBuffer, nSize * nChannels);
+        }
+
+        void DelayBank::dump(IStateDumper *v) const
+        {
+            v->write("vBuffer", vBuffer);
+            v->begin_array("vChannels", vChannels, nChannels);
+            {
+                for (size_t i=0; i<nChannels; ++i)
+                {
+                    const channel_t *c = &vChannels[i];
+
+                    v->begin_object(c, sizeof(channel_t));
+                    {
+                        v->write("nDelay", c->nDelay);
+                        v->write("nNewDelay", c->nNewDelay);
+                    }
+                    v->end_object();
+                }
+            }
+            v->end_array();
+            v->write("nChannels", nChannels);
+            v->write("nHead", nHead);
+            v->write("nSize", nSize);
+            v->write("nMaxDelay", nMaxDelay);
+            v->write("pData", pData);
+        }
+    }
+} /* namespace lsp */
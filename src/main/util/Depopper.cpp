@@ -25,7 +25,8 @@
 #include <lsp-plug.in/stdlib/math.h>
 #include <lsp-plug.in/dsp/dsp.h>
 
-#define BUF_SIZE            0x1000
+#define BLOCK_SIZE          0x100       // Number of samples processed at once
+#define SCAN_SIZE           0x20        // Size of sub-block checked for the threshold crossing
 
 namespace lsp
 {
@@ -47,15 +48,16 @@ namespace lsp
             nState              = ST_CLOSED;
 
             fLookMax            = 0.0f;
-            nLookMin            = 0;
             nLookMax            = 0;
             nLookOff            = 0;
+            nLookCount          = 0;
+            nCurveMax           = 0;
 
             fRmsMax             = 0.0f;
             fRmsLength          = 0.0f;
-            nRmsMin             = 0;
             nRmsMax             = 0;
             nRmsOff             = 0;
+            nRmsLen             = 0;
             fRmsNorm            = 0.0f;
 
             nCounter            = 0;
@@ -70,6 +72,8 @@ namespace lsp
             sFadeIn.fPoly[1]    = 0.0f;
             sFadeIn.fPoly[2]    = 0.0f;
             sFadeIn.fPoly[3]    = 0.0f;
+            sFadeIn.vCurve      = NULL;
+            sFadeIn.nCurve      = 0;
 
             sFadeOut.enMode     = DPM_LINEAR;
             sFadeOut.fThresh    = GAIN_AMP_M_80_DB;
@@ -79,6 +83,8 @@ namespace lsp
             sFadeOut.fPoly[1]   = 0.0f;
             sFadeOut.fPoly[2]   = 0.0f;
             sFadeOut.fPoly[3]   = 0.0f;
+            sFadeOut.vCurve     = NULL;
+            sFadeOut.nCurve     = 0;
 
             pGainBuf            = NULL;
             pRmsBuf             = NULL;
@@ -97,6 +103,11 @@ namespace lsp
 
             pGainBuf            = NULL;
             pRmsBuf             = NULL;
+            sFadeIn.vCurve      = NULL;
+            sFadeIn.nCurve      = 0;
+            sFadeOut.vCurve     = NULL;
+            sFadeOut.nCurve     = 0;
+            nCurveMax           = 0;
         }
 
         bool Depopper::init(size_t srate, float max_fade, float max_rms)
@@ -117,18 +128,19 @@ namespace lsp
             size_t lk_samp      = millis_to_samples(nSampleRate, fLookMax);
             size_t rms_samp     = millis_to_samples(nSampleRate, fRmsMax);
 
-            ssize_t lk_buf      = align_size(lk_samp, DEFAULT_ALIGN);
-            ssize_t rms_buf     = align_size(rms_samp, DEFAULT_ALIGN);
+            ssize_t lk_buf      = align_size(lk_samp + 1, DEFAULT_ALIGN);
+            ssize_t rms_buf     = align_size(rms_samp + 1, DEFAULT_ALIGN);
 
-            nLookMin            = lk_buf   + rms_buf;
-            nLookMax            = nLookMin + lsp_max(lk_buf*4, BUF_SIZE);
-            nLookOff            = nLookMin;
+            // The ring buffers keep the history and one block of new samples
+            nLookMax            = lk_buf + rms_buf + BLOCK_SIZE;
+            nLookOff            = 0;
+
+            nRmsMax             = rms_buf + BLOCK_SIZE;
+            nRmsOff             = 0;
 
-            nRmsMin             = rms_buf;
-            nRmsMax             = nRmsMin  + lsp_max(rms_buf*4, BUF_SIZE);
-            nRmsOff             = nRmsMin;
+            nCurveMax           = lk_buf;
 
-            size_t buf_sz       = nRmsMax + nLookMax;
+            size_t buf_sz       = nRmsMax + nLookMax + nCurveMax * 2;
             float *data         = alloc_aligned<float>(pData, buf_sz);
             if (data == NULL)
                 return false;
@@ -136,7 +148,12 @@ namespace lsp
             dsp::fill_zero(data, buf_sz);
 
             pGainBuf            = data;
-            pRmsBuf             = &pGainBuf[nLookMax];
+            data               += nLookMax;
+            pRmsBuf             = data;
+            data               += nRmsMax;
+            sFadeIn.vCurve      = data;
+            data               += nCurveMax;
+            sFadeOut.vCurve     = data;
 
             nState              = ST_CLOSED;
             bReconfigure        = true;
@@ -147,6 +164,8 @@ namespace lsp
         void Depopper::calc_fade(fade_t *fade, bool in)
         {
             float time          = millis_to_samples(nSampleRate, fade->fTime);
+            if (!in)
+                time                = lsp_min(time, float(nCurveMax));  // The fade out should fit the gain buffer
             fade->nDelay        = millis_to_samples(nSampleRate, fade->fDelay);
             fade->nSamples      = time;
             float k             = 1.0f / time;
@@ -243,6 +262,11 @@ namespace lsp
                     fade->fPoly[3]  = 0.0f;
                     break;
             }
+
+            // Precompute the fade curve
+            fade->nCurve        = (fade->vCurve != NULL) ? lsp_min(fade->nSamples, nCurveMax) : 0;
+            for (ssize_t x=0; x<fade->nCurve; ++x)
+                fade->vCurve[x]     = crossfade(fade, x);
         }
 
         void Depopper::reconfigure()
@@ -253,12 +277,12 @@ namespace lsp
             calc_fade(&sFadeIn, true);
             calc_fade(&sFadeOut, false);
 
-            nRmsLen             = millis_to_samples(nSampleRate, fRmsLength);
+            nRmsLen             = lsp_max(ssize_t(millis_to_samples(nSampleRate, fRmsLength)), ssize_t(1));
             nLookCount          = sFadeOut.nSamples + nRmsLen;
             fRmsNorm            = 1.0f / nRmsLen;
 
             // Recompute RMS value
-            fRms                = dsp::h_sum(&pRmsBuf[nRmsOff - nRmsLen], nRmsLen);
+            fRms                = rms_sum();
 
             bReconfigure        = false;
         }
@@ -372,7 +396,7 @@ namespace lsp
             return old;
         }
 
-        float Depopper::crossfade(fade_t *fade, float x)
+        float Depopper::crossfade(const fade_t *fade, float x)
         {
             if (x < 0.0f)
                 return 0.0f;
@@ -413,7 +437,24 @@ namespace lsp
             return gain;
         }
 
-        void Depopper::apply_fadeout(float *dst, ssize_t samples)
+        void Depopper::fade_curve(float *dst, const fade_t *fade, ssize_t x, size_t count)
+        {
+            // Take the precomputed part of the curve
+            if ((x >= 0) && (x < fade->nCurve))
+            {
+                size_t n        = lsp_min(count, size_t(fade->nCurve - x));
+                dsp::copy(dst, &fade->vCurve[x], n);
+                dst            += n;
+                x              += n;
+                count          -= n;
+            }
+
+            // Compute the rest of the curve
+            for ( ; count > 0; --count)
+                *(dst++)        = crossfade(fade, x++);
+        }
+
+        void Depopper::apply_fadeout(size_t pos, ssize_t samples)
         {
             if (sFadeOut.nSamples <= 0)
                 return;
@@ -422,132 +463,229 @@ namespace lsp
             if (samples > sFadeOut.nSamples)
                 samples     = sFadeOut.nSamples;
 
-            // roll-back destination pointer
-            *dst    = 0.0f;                 // Closed
-            dst    -= samples + nRmsLen;    // Roll-back pointer by number of samples + RMS estimation
+            pGainBuf[pos]   = 0.0f;         // Closed
 
-            // Apply fade-out patch
-            for (ssize_t x = sFadeOut.nSamples - samples; x < sFadeOut.nSamples; ++x)
-                *(dst++)   *= crossfade(&sFadeOut, x);
+            // Roll-back position by number of samples + RMS estimation
+            size_t off      = (pos + nLookMax - samples - nRmsLen) % nLookMax;
+
+            // Apply fade-out patch, the fade out curve is always precomputed
+            for (ssize_t x = sFadeOut.nSamples - samples; x < sFadeOut.nSamples; )
+            {
+                size_t n        = lsp_min(size_t(sFadeOut.nSamples - x), size_t(nLookMax - off));
+                dsp::mul2(&pGainBuf[off], &sFadeOut.vCurve[x], n);
+                x              += n;
+                off            += n;
+                if (off >= size_t(nLookMax))
+                    off             = 0;
+            }
 
             // Fill rest samples with zeros
-            dsp::fill_zero(dst, nRmsLen);
+            for (ssize_t left = nRmsLen; left > 0; )
+            {
+                size_t n        = lsp_min(size_t(left), size_t(nLookMax - off));
+                dsp::fill_zero(&pGainBuf[off], n);
+                left           -= n;
+                off            += n;
+                if (off >= size_t(nLookMax))
+                    off             = 0;
+            }
         }
 
-        float Depopper::calc_rms(float s)
+        float Depopper::rms_sum() const
         {
-            // Need to shift the buffer ?
-            if (nRmsOff >= nRmsMax)
+            if (pRmsBuf == NULL)
+                return 0.0f;
+
+            // Sum the last nRmsLen squared samples stored in the ring buffer
+            size_t tail     = (nRmsOff + nRmsMax - nRmsLen) % nRmsMax;
+            size_t n        = lsp_min(size_t(nRmsLen), size_t(nRmsMax - tail));
+            float sum       = dsp::h_sum(&pRmsBuf[tail], n);
+            if (n < size_t(nRmsLen))
+                sum            += dsp::h_sum(pRmsBuf, nRmsLen - n);
+
+            return sum;
+        }
+
+        void Depopper::calc_rms(float *env, const float *src, size_t count)
+        {
+            // Store squared samples, the block does not cross the end of the ring buffer
+            float *sq       = &pRmsBuf[nRmsOff];
+            dsp::sqr2(sq, src, count);
+
+            // Compute differences with the squared samples that leave the window
+            size_t tail     = (nRmsOff + nRmsMax - nRmsLen) % nRmsMax;
+            size_t n        = lsp_min(count, size_t(nRmsMax - tail));
+            dsp::sub3(env, sq, &pRmsBuf[tail], n);
+            if (n < count)
+                dsp::sub3(&env[n], &sq[n], pRmsBuf, count - n);
+
+            // Only the running sum stays sequential
+            double sum      = fRms;
+            for (size_t i=0; i<count; ++i)
             {
-                dsp::move(pRmsBuf, &pRmsBuf[nRmsOff-nRmsMin], nRmsMin);
-                nRmsOff     = nRmsMin;
+                sum             = fabs(sum + env[i]);
+                env[i]          = sum;
+            }
 
-                // Recompute RMS value
-                fRms        = dsp::h_sum(&pRmsBuf[nRmsOff - nRmsLen], nRmsLen);
+            dsp::mul_k2(env, fRmsNorm, count);
+            dsp::ssqrt1(env, count);
+
+            nRmsOff        += count;
+            if (nRmsOff >= nRmsMax)
+                nRmsOff         = 0;
+
+            // Recompute RMS value to drop the accumulated error
+            fRms            = rms_sum();
+        }
+
+        static size_t scan_above(const float *v, size_t count, float thresh)
+        {
+            size_t i = 0;
+
+            // Skip sub-blocks that are entirely below the threshold
+            for ( ; (count - i) >= SCAN_SIZE; i += SCAN_SIZE)
+            {
+                if (dsp::max(&v[i], SCAN_SIZE) >= thresh)
+                    break;
+            }
+            for ( ; i < count; ++i)
+            {
+                if (v[i] >= thresh)
+                    break;
             }
-            else if ((nRmsOff & 0x1f) == 0) // Recompute RMS each 32 samples
-                fRms        = dsp::h_sum(&pRmsBuf[nRmsOff - nRmsLen], nRmsLen);
-
-            s                   = s*s;
-            float g             = pRmsBuf[nRmsOff - nRmsLen];
-            fRms                = fabs(fRms + s - g);
-            pRmsBuf[nRmsOff++]  = s;
-            return sqrtf(fRms * fRmsNorm);
+
+            return i;
         }
 
-        void Depopper::process(float *env, float *gain, const float *src, size_t count)
+        static size_t scan_below(const float *v, size_t count, float thresh)
         {
-            // Reconfigure if needed
-            reconfigure();
+            size_t i = 0;
 
-            while (count > 0)
+            // Skip sub-blocks that are entirely not below the threshold
+            for ( ; (count - i) >= SCAN_SIZE; i += SCAN_SIZE)
             {
-                // Need to shift gain buffer?
-                size_t can_do   = nLookMax - nLookOff;
-                if (can_do <= 0)
-                {
-                    dsp::move(pGainBuf, &pGainBuf[nLookOff-nLookMin], nLookMin);
-                    nLookOff    = nLookMin;
-                    can_do      = nLookMax - nLookOff;
-                }
+                if (dsp::min(&v[i], SCAN_SIZE) < thresh)
+                    break;
+            }
+            for ( ; i < count; ++i)
+            {
+                if (v[i] < thresh)
+                    break;
+            }
 
-                // Estimate number of samples and gain buffer position
-                float *gbuf     = &pGainBuf[nLookOff];
-                size_t to_do    = (count > can_do) ? can_do : count;
+            return i;
+        }
 
-                // Process each sample
-                for (size_t i=0; i<to_do; ++i)
-                {
-                    float s         = calc_rms(src[i]);
-                    env[i]          = s;
+        size_t Depopper::process_state(size_t pos, const float *env, size_t count)
+        {
+            float *gbuf     = &pGainBuf[pos];
+            size_t n;
 
-                    switch (nState)
+            switch (nState)
+            {
+                case ST_CLOSED:
+                    // Still closed until the signal raises above the threshold
+                    n           = scan_above(env, count, sFadeIn.fThresh);
+                    dsp::fill_zero(gbuf, n);
+                    if (n >= count)
+                        return n;
+
+                    // Open the fade in
+                    nCounter    = 0;
+                    nDelay      = sFadeIn.nDelay;
+                    nState      = ST_FADE;
+                    gbuf[n]     = crossfade(&sFadeIn, nCounter++);
+                    return n + 1;
+
+                case ST_FADE:
+                    // Signal stays above the fade out threshold: apply the fade in curve
+                    n           = scan_below(env, count, sFadeOut.fThresh);
+                    if (n > 0)
                     {
-                        case ST_CLOSED:
-                            gbuf[i]     = 0.0f; // Still closed
-                            if (s < sFadeIn.fThresh) // Can fade in?
-                                break;
-
-                            // Open the fade in
-                            nCounter    = 0;
-                            nDelay      = sFadeIn.nDelay;
-                            nState      = ST_FADE;
-                            gbuf[i]     = crossfade(&sFadeIn, nCounter++);
-                            break;
-
-                        case ST_FADE:
-                            // Compute gain
-                            gbuf[i]     = crossfade(&sFadeIn, nCounter++);
-
-                            // Fall-off below threshold ?
-                            if (s < sFadeOut.fThresh)
-                            {
-                                if ((--nDelay) <= 0)
-                                {
-                                    apply_fadeout(&gbuf[i], nCounter);
-                                    nCounter    = 0;
-                                    nState      = ST_WAIT;
-                                }
-                            }
-                            else
-                            {
-                                nDelay      = sFadeIn.nDelay;       // Reset delay
-                                if (nCounter >= sFadeIn.nSamples)   // Fade has been completed?
-                                    nState      = ST_OPENED;
-                            }
-                            break;
-
-                        case ST_OPENED:
-                            gbuf[i]     = 1.0f; // Opened
-                            if (nCounter < sFadeOut.nSamples) // Increment counter
-                                nCounter++;
-
-                            // Fall-off before threshold ?
-                            if (s < sFadeOut.fThresh)
-                            {
-                                apply_fadeout(&gbuf[i], nCounter);
-                                nState      = ST_WAIT;
-                                nDelay      = sFadeOut.nDelay;
-                            }
-                            break;
-
-                        case ST_WAIT:
-                            gbuf[i]     = 0.0f; // Wait state, same as closed
-                            if ((--nDelay) <= 0)
-                                nState      = ST_CLOSED;
-                            break;
-
-                        default:
-                            gbuf[i]     = 1.0f;
-                            break;
+                        if (nCounter < sFadeIn.nSamples)
+                            n           = lsp_min(n, size_t(sFadeIn.nSamples - nCounter));
+                        else
+                            n           = 1;
+
+                        fade_curve(gbuf, &sFadeIn, nCounter, n);
+                        nCounter   += n;
+                        nDelay      = sFadeIn.nDelay;       // Reset delay
+                        if (nCounter >= sFadeIn.nSamples)   // Fade has been completed?
+                            nState      = ST_OPENED;
+                        return n;
                     }
-                }
 
-                // Copy data from buffer and shift buffer
-                dsp::copy(gain, &gbuf[-nLookCount], to_do);
+                    // Fall-off below threshold
+                    gbuf[0]     = crossfade(&sFadeIn, nCounter++);
+                    if ((--nDelay) <= 0)
+                    {
+                        apply_fadeout(pos, nCounter);
+                        nCounter    = 0;
+                        nState      = ST_WAIT;
+                    }
+                    return 1;
+
+                case ST_OPENED:
+                    // Opened until the signal falls below the threshold
+                    n           = scan_below(env, count, sFadeOut.fThresh);
+                    if (n < count)
+                        ++n;
+                    dsp::fill_one(gbuf, n);
+                    if (nCounter < sFadeOut.nSamples) // Increment counter
+                        nCounter    = lsp_min(nCounter + ssize_t(n), sFadeOut.nSamples);
+
+                    // Fall-off below threshold ?
+                    if (env[n-1] < sFadeOut.fThresh)
+                    {
+                        apply_fadeout(pos + n - 1, nCounter);
+                        nState      = ST_WAIT;
+                        nDelay      = sFadeOut.nDelay;
+                    }
+                    return n;
+
+                case ST_WAIT:
+                    // Wait state, same as closed
+                    n           = lsp_min(count, size_t(lsp_max(nDelay, ssize_t(1))));
+                    dsp::fill_zero(gbuf, n);
+                    nDelay     -= n;
+                    if (nDelay <= 0)
+                        nState      = ST_CLOSED;
+                    return n;
+
+                default:
+                    dsp::fill_one(gbuf, count);
+                    return count;
+            }
+        }
+
+        void Depopper::process(float *env, float *gain, const float *src, size_t count)
+        {
+            // Reconfigure if needed
+            reconfigure();
+
+            while (count > 0)
+            {
+                // The block does not cross the end of ring buffers
+                size_t to_do    = lsp_min(count, size_t(BLOCK_SIZE));
+                to_do           = lsp_min(to_do, size_t(nLookMax - nLookOff));
+                to_do           = lsp_min(to_do, size_t(nRmsMax - nRmsOff));
+
+                // Compute the envelope and the gain for the whole block
+                calc_rms(env, src, to_do);
+                for (size_t i=0; i<to_do; )
+                    i              += process_state(nLookOff + i, &env[i], to_do - i);
+
+                // Copy the gain delayed by the lookahead
+                size_t tail     = (nLookOff + nLookMax - nLookCount) % nLookMax;
+                size_t n        = lsp_min(to_do, size_t(nLookMax - tail));
+                dsp::copy(gain, &pGainBuf[tail], n);
+                if (n < to_do)
+                    dsp::copy(&gain[n], pGainBuf, to_do - n);
 
                 // Update pointers
                 nLookOff       += to_do;
+                if (nLookOff >= nLookMax)
+                    nLookOff        = 0;
                 count          -= to_do;
                 env            += to_do;
                 gain           += to_do;
@@ -566,6 +704,8 @@ namespace lsp
                 v->write("nSamples", fade->nSamples);
                 v->write("nDelay", fade->nDelay);
                 v->writev("fPoly", fade->fPoly, 4);
+                v->write("vCurve", fade->vCurve);
+                v->write("nCurve", fade->nCurve);
             }
             v->end_object();
         }
@@ -576,14 +716,13 @@ namespace lsp
             v->write("nState", nState);
 
             v->write("fLookMax", fLookMax);
-            v->write("nLookMin", nLookMin);
             v->write("nLookMax", nLookMax);
             v->write("nLookOff", nLookOff);
             v->write("nLookCount", nLookCount);
+            v->write("nCurveMax", nCurveMax);
 
             v->write("fRmsMax", fRmsMax);
             v->write("fRmsLength", fRmsLength);
-            v->write("nRmsMin", nRmsMin);
             v->write("nRmsMax", nRmsMax);
             v->write("nRmsOff", nRmsOff);
             v->write("nRmsLen", nRmsLen);
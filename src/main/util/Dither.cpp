@@ -21,13 +21,23 @@
 
 #include <lsp-plug.in/dsp-units/util/Dither.h>
 #include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
 
 #define DITHER_8BIT         0.00390625  /* 1 / 256 */
+#define DITHER_BUF_SIZE     0x100       /* Size of the temporary buffer */
 
 namespace lsp
 {
     namespace dspu
     {
+        static const float dither_shapes[DITHER_SHAPE_TOTAL][DITHER_SHAPE_ORDER] =
+        {
+            { 0.0f, 0.0f, 0.0f },           // DITHER_FLAT
+            { 1.0f, 0.0f, 0.0f },           // DITHER_FIRST_ORDER
+            { 2.0f, -1.0f, 0.0f },          // DITHER_SECOND_ORDER
+            { 1.623f, -0.982f, 0.109f }     // DITHER_F_WEIGHTED
+        };
+
         Dither::Dither()
         {
             construct();
@@ -42,6 +52,21 @@ namespace lsp
             nBits   = 0;
             fGain   = 1.0f;
             fDelta  = 0.0f;
+            enShape = DITHER_FLAT;
+            for (size_t i=0; i<DITHER_SHAPE_ORDER; ++i)
+                vError[i]   = 0.0f;
+        }
+
+        const float *Dither::shape_filter(dither_shape_t shape)
+        {
+            return (shape < DITHER_SHAPE_TOTAL) ? dither_shapes[shape] : dither_shapes[DITHER_FLAT];
+        }
+
+        void Dither::set_shape(dither_shape_t shape)
+        {
+            enShape = (shape < DITHER_SHAPE_TOTAL) ? shape : DITHER_FLAT;
+            for (size_t i=0; i<DITHER_SHAPE_ORDER; ++i)
+                vError[i]   = 0.0f;
         }
 
         void Dither::set_bits(size_t bits)
@@ -69,8 +94,58 @@ namespace lsp
                 return;
             }
 
-            while (count--)
-                *(out++) = *(in++) * fGain + (sRandom.random(RND_TRIANGLE) - 0.5f) * fDelta;
+            float buf[DITHER_BUF_SIZE];
+
+            // Flat dither: the TPDF noise is generated and mixed by blocks
+            if (enShape == DITHER_FLAT)
+            {
+                while (count > 0)
+                {
+                    size_t to_do    = lsp_min(count, size_t(DITHER_BUF_SIZE));
+                    sRandom.random(buf, to_do, RND_TRIANGLE);
+                    dsp::add_k2(buf, -0.5f, to_do);
+                    dsp::mul_k2(buf, fDelta, to_do);
+                    dsp::fmadd_k3(buf, in, fGain, to_do);
+                    dsp::copy(out, buf, to_do);
+
+                    in             += to_do;
+                    out            += to_do;
+                    count          -= to_do;
+                }
+                return;
+            }
+
+            // Noise shaping: quantize the signal and feed the error back
+            const float *h  = dither_shapes[enShape];
+            const float lsb = 0.5f * fDelta;
+            const float klsb= 1.0f / lsb;
+            float e0        = vError[0], e1 = vError[1], e2 = vError[2];
+
+            while (count > 0)
+            {
+                size_t to_do    = lsp_min(count, size_t(DITHER_BUF_SIZE));
+                sRandom.random(buf, to_do, RND_TRIANGLE);
+
+                for (size_t i=0; i<to_do; ++i)
+                {
+                    float v         = in[i] * fGain - (h[0]*e0 + h[1]*e1 + h[2]*e2);
+                    float d         = (buf[i] - 0.5f) * fDelta;
+                    float y         = floorf((v + d) * klsb + 0.5f) * lsb;
+
+                    e2              = e1;
+                    e1              = e0;
+                    e0              = y - v;
+                    out[i]          = y;
+                }
+
+                in             += to_do;
+                out            += to_do;
+                count          -= to_do;
+            }
+
+            vError[0]       = e0;
+            vError[1]       = e1;
+            vError[2]       = e2;
         }
 
         void Dither::dump(IStateDumper *v) const
@@ -78,6 +153,8 @@ namespace lsp
             v->write("nBits", nBits);
             v->write("fGain", fGain);
             v->write("fDelta", fDelta);
+            v->write("enShape", enShape);
+            v->writev("vError", vError, DITHER_SHAPE_ORDER);
             v->write_object("sRandom", &sRandom);
         }
     }
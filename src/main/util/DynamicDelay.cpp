@@ -24,6 +24,7 @@
 #include <lsp-plug.in/dsp/dsp.h>
 
 #define BUF_SIZE        0x400
+#define PARAM_BUF_SIZE  0x100
 
 namespace lsp
 {
@@ -42,9 +43,13 @@ namespace lsp
         void DynamicDelay::construct()
         {
             vDelay      = NULL;
+            vApState    = NULL;
+            nChannels   = 0;
+            nStride     = 0;
             nHead       = 0;
             nCapacity   = 0;
             nMaxDelay   = 0;
+            nInterp     = DDI_NONE;
             pData       = NULL;
         }
 
@@ -54,6 +59,9 @@ namespace lsp
             {
                 free_aligned(pData);
                 vDelay      = NULL;
+                vApState    = NULL;
+                nChannels   = 0;
+                nStride     = 0;
                 nHead       = 0;
                 nCapacity   = 0;
                 nMaxDelay   = 0;
@@ -61,11 +69,16 @@ namespace lsp
             }
         }
 
-        status_t DynamicDelay::init(size_t max_size)
+        status_t DynamicDelay::init(size_t max_size, size_t channels)
         {
+            if (channels <= 0)
+                return STATUS_BAD_ARGUMENTS;
+
             size_t delay        = max_size + 1;
             size_t buf_sz       = delay - (delay % BUF_SIZE) + BUF_SIZE * 2;
-            size_t alloc        = buf_sz * sizeof(float);
+            size_t stride       = align_size(buf_sz + DYNAMIC_DELAY_GUARD, DEFAULT_ALIGN / sizeof(float));
+            size_t ap_sz        = align_size(channels * sizeof(float), DEFAULT_ALIGN);
+            size_t alloc        = stride * channels * sizeof(float) + ap_sz;
 
             uint8_t *data       = NULL;
             uint8_t *ptr        = alloc_aligned<uint8_t>(data, alloc);
@@ -76,45 +89,237 @@ namespace lsp
                 free_aligned(pData);
 
             vDelay              = reinterpret_cast<float *>(ptr);
-            ptr                += buf_sz * sizeof(float);
+            ptr                += stride * channels * sizeof(float);
+            vApState            = reinterpret_cast<float *>(ptr);
+            ptr                += ap_sz;
 
+            nChannels           = channels;
+            nStride             = stride;
             nHead               = 0;
             nCapacity           = buf_sz;
             nMaxDelay           = max_size;
             pData               = data;
 
+            dsp::fill_zero(vApState, nChannels);
+
             return STATUS_OK;
         }
 
+        void DynamicDelay::set_interpolation(dynamic_delay_interp_t mode)
+        {
+            if (nInterp == size_t(mode))
+                return;
+            nInterp             = mode;
+            dsp::fill_zero(vApState, nChannels);
+        }
+
         void DynamicDelay::clear()
         {
-            dsp::fill_zero(vDelay, nCapacity);
+            for (size_t i=0; i<nChannels; ++i)
+                dsp::fill_zero(&vDelay[i * nStride], nCapacity + DYNAMIC_DELAY_GUARD);
+            dsp::fill_zero(vApState, nChannels);
             nHead               = 0;
         }
 
+        inline void DynamicDelay::write(float *buf, size_t idx, float value)
+        {
+            // Keep the mirror after the end of the buffer, so all taps
+            // of the interpolator can be read without wrapping
+            buf[idx]            = value;
+            if (idx < DYNAMIC_DELAY_GUARD)
+                buf[idx + nCapacity]    = value;
+        }
+
         void DynamicDelay::process(float *out, const float *in, const float *delay, const float *fgain, const float *fdelay, size_t samples)
         {
+            process_modulated(vDelay, vApState, nHead, out, in, delay, fgain, fdelay, samples);
+            nHead           = (nHead + samples) % nCapacity;
+        }
+
+        void DynamicDelay::process(float *out, const float *in, float delay, float fgain, float fdelay, size_t samples)
+        {
+            process_constant(vDelay, vApState, nHead, out, in, delay, fgain, fdelay, samples);
+            nHead           = (nHead + samples) % nCapacity;
+        }
+
+        void DynamicDelay::process(float * const *out, const float * const *in, const float *delay, const float *fgain, const float *fdelay, size_t samples)
+        {
+            // All channels share the write position
+            for (size_t i=0; i<nChannels; ++i)
+                process_modulated(&vDelay[i * nStride], &vApState[i], nHead, out[i], in[i], delay, fgain, fdelay, samples);
+            nHead           = (nHead + samples) % nCapacity;
+        }
+
+        void DynamicDelay::process(float * const *out, const float * const *in, float delay, float fgain, float fdelay, size_t samples)
+        {
+            // All channels share the write position
+            for (size_t i=0; i<nChannels; ++i)
+                process_constant(&vDelay[i * nStride], &vApState[i], nHead, out[i], in[i], delay, fgain, fdelay, samples);
+            nHead           = (nHead + samples) % nCapacity;
+        }
+
+        void DynamicDelay::process_modulated(float *buf, float *ap, size_t head, float *out, const float *in, const float *delay, const float *fgain, const float *fdelay, size_t samples)
+        {
+            if (nInterp != DDI_NONE)
+            {
+                process_fractional(buf, ap, head, out, in, delay, fgain, fdelay, samples);
+                return;
+            }
+
             for (size_t i=0; i < samples; ++i)
             {
                 ssize_t shift   = lsp_limit(ssize_t(delay[i]), 0, nMaxDelay);   // Delay
-                ssize_t tail    = nHead - shift;
+                ssize_t tail    = head - shift;
                 if (tail < 0)
                     tail           += nCapacity;
                 size_t feed     = tail  + lsp_limit(fdelay[i], 0, shift);       // Feedback delay
-                if (feed > nCapacity)
+                if (feed >= nCapacity)
                     feed           -= nCapacity;
 
-                vDelay[nHead]   = in[i];            // Save input sample to buffer
-                float s         = vDelay[tail];     // Read delayed sample
-                vDelay[feed]   += s * fgain[i];     // Add feedback to the buffer
-                out[i]          = vDelay[tail];     // Read the final sample to output buffer
+                write(buf, head, in[i]);            // Save input sample to buffer
+                float s         = buf[tail];        // Read delayed sample
+                write(buf, feed, buf[feed] + s * fgain[i]);     // Add feedback to the buffer
+                out[i]          = buf[tail];        // Read the final sample to output buffer
 
                 // Update head pointer
-                if ((++nHead) >= nCapacity)
-                    nHead = 0;
+                if ((++head) >= nCapacity)
+                    head = 0;
             }
         }
 
+        void DynamicDelay::process_constant(float *buf, float *ap, size_t head, float *out, const float *in, float delay, float fgain, float fdelay, size_t samples)
+        {
+            if (nInterp != DDI_NONE)
+            {
+                // Expand the constants and use the general interpolating path
+                float vd[PARAM_BUF_SIZE], vg[PARAM_BUF_SIZE], vf[PARAM_BUF_SIZE];
+                size_t count    = lsp_min(samples, size_t(PARAM_BUF_SIZE));
+
+                dsp::fill(vd, delay, count);
+                dsp::fill(vg, fgain, count);
+                dsp::fill(vf, fdelay, count);
+
+                for (size_t offset=0; offset < samples; )
+                {
+                    size_t to_do    = lsp_min(samples - offset, size_t(PARAM_BUF_SIZE));
+                    process_fractional(buf, ap, head, &out[offset], &in[offset], vd, vg, vf, to_do);
+                    head            = (head + to_do) % nCapacity;
+                    offset         += to_do;
+                }
+                return;
+            }
+
+            ssize_t shift   = lsp_limit(ssize_t(delay), 0, nMaxDelay);
+            size_t fd       = lsp_limit(ssize_t(fdelay), 0, shift);
+            size_t tail     = (head + nCapacity - shift) % nCapacity;
+            size_t feed     = (tail + fd) % nCapacity;
+
+            // The feedback written by the sample affects the sample read fd samples later,
+            // so the block should not be longer than the feedback delay
+            size_t block    = ((fgain != 0.0f) && (fd > 0)) ? lsp_min(fd, size_t(BUF_SIZE)) : BUF_SIZE;
+
+            for (size_t offset=0; offset < samples; )
+            {
+                size_t to_do    = lsp_min(samples - offset, block);
+                to_do           = lsp_min(to_do, nCapacity - head);
+                to_do           = lsp_min(to_do, nCapacity - tail);
+                to_do           = lsp_min(to_do, nCapacity - feed);
+
+                dsp::copy(&buf[head], &in[offset], to_do);              // Save input samples to buffer
+                if (fgain != 0.0f)
+                {
+                    if (fd > 0)
+                        dsp::fmadd_k3(&buf[feed], &buf[tail], fgain, to_do);    // Add feedback to the buffer
+                    else
+                        dsp::mul_k2(&buf[tail], 1.0f + fgain, to_do);           // Feedback to the same sample
+                }
+                dsp::copy(&out[offset], &buf[tail], to_do);             // Read the final samples to output buffer
+
+                // Update the mirror of the buffer
+                if ((head < DYNAMIC_DELAY_GUARD) || (feed < DYNAMIC_DELAY_GUARD) || (tail < DYNAMIC_DELAY_GUARD))
+                    dsp::copy(&buf[nCapacity], buf, DYNAMIC_DELAY_GUARD);
+
+                head            = (head + to_do) % nCapacity;
+                tail            = (tail + to_do) % nCapacity;
+                feed            = (feed + to_do) % nCapacity;
+                offset         += to_do;
+            }
+        }
+
+        void DynamicDelay::process_fractional(float *buf, float *ap_state, size_t head, float *out, const float *in, const float *delay, const float *fgain, const float *fdelay, size_t samples)
+        {
+            float ap        = *ap_state;
+
+            for (size_t i=0; i < samples; ++i)
+            {
+                float d         = lsp_limit(delay[i], 0.0f, float(nMaxDelay));
+                ssize_t shift   = ssize_t(d);                                   // Integer part of the delay
+                float frac      = d - shift;                                    // Fractional part of the delay
+
+                // Position of the sample with delay (shift + 2), the samples with delays
+                // (shift + 2) .. (shift - 1) are stored contiguously at b[0] .. b[3]
+                ssize_t pos     = head - shift - 2;
+                if (pos < 0)
+                    pos            += nCapacity;
+                ssize_t tail    = head - shift;
+                if (tail < 0)
+                    tail           += nCapacity;
+                size_t feed     = tail  + lsp_limit(fdelay[i], 0, shift);       // Feedback delay
+                if (feed >= nCapacity)
+                    feed           -= nCapacity;
+
+                write(buf, head, in[i]);            // Save input sample to buffer
+
+                // Read delayed sample, the second pass takes the feedback into account
+                const float *b  = &buf[pos];
+                float s         = 0.0f;
+                for (size_t pass=0; pass < 2; ++pass)
+                {
+                    switch (nInterp)
+                    {
+                        case DDI_LINEAR:
+                            s               = b[2] + (b[1] - b[2]) * frac;
+                            break;
+
+                        case DDI_HERMITE:
+                        {
+                            float ym1       = (shift > 0) ? b[3] : b[2];  // The future sample is not available
+                            float c1        = 0.5f * (b[1] - ym1);
+                            float c2        = ym1 - 2.5f * b[2] + 2.0f * b[1] - 0.5f * b[0];
+                            float c3        = 0.5f * (b[0] - ym1) + 1.5f * (b[2] - b[1]);
+                            s               = ((c3 * frac + c2) * frac + c1) * frac + b[2];
+                            break;
+                        }
+
+                        case DDI_ALLPASS:
+                        default:
+                        {
+                            // Keep the allpass delay within [0.5 .. 1.5) when it is possible
+                            bool low        = (frac < 0.5f) && (shift > 0);
+                            float x0        = (low) ? b[3] : b[2];
+                            float x1        = (low) ? b[2] : b[1];
+                            float k         = (low) ? frac + 1.0f : frac;
+                            float a         = (1.0f - k) / (1.0f + k);
+                            s               = a * (x0 - ap) + x1;
+                            break;
+                        }
+                    }
+
+                    if (pass == 0)
+                        write(buf, feed, buf[feed] + s * fgain[i]);     // Add feedback to the buffer
+                }
+
+                ap              = s;
+                out[i]          = s;                // Store the final sample to output buffer
+
+                // Update head pointer
+                if ((++head) >= nCapacity)
+                    head = 0;
+            }
+
+            *ap_state       = ap;
+        }
+
         /**
          * Copy the contents of the dynamic delay
          * @param s delay to copy contents from
@@ -127,19 +332,35 @@ namespace lsp
             ssize_t st      = s->nHead - count;     // Position of source tail
             if (st < 0)
                 st         += s->nCapacity;
-
-            // Perform data copy
             size_t tail     = s->nCapacity - st;
-            if (tail < count)
+
+            for (size_t i=0; i<nChannels; ++i)
             {
-                dsp::copy(&vDelay[dt], &s->vDelay[st], tail);
-                dsp::copy(&vDelay[dt + tail], s->vDelay, count - tail);
-            }
-            else
-                dsp::copy(&vDelay[dt], &s->vDelay[st], count);
+                float *dbuf     = &vDelay[i * nStride];
+                if (i >= s->nChannels)
+                {
+                    dsp::fill_zero(dbuf, nCapacity + DYNAMIC_DELAY_GUARD);
+                    vApState[i]     = 0.0f;
+                    continue;
+                }
+                const float *sbuf   = &s->vDelay[i * s->nStride];
+
+                // Perform data copy
+                if (tail < count)
+                {
+                    dsp::copy(&dbuf[dt], &sbuf[st], tail);
+                    dsp::copy(&dbuf[dt + tail], sbuf, count - tail);
+                }
+                else
+                    dsp::copy(&dbuf[dt], &sbuf[st], count);
 
-            // Clear the rest samples
-            dsp::fill_zero(vDelay, dt);
+                // Clear the rest samples
+                dsp::fill_zero(dbuf, dt);
+
+                // Update the mirror of the buffer
+                dsp::copy(&dbuf[nCapacity], dbuf, DYNAMIC_DELAY_GUARD);
+                vApState[i]     = s->vApState[i];
+            }
 
             // Reset head to first sample
             nHead           = 0;
@@ -148,6 +369,9 @@ namespace lsp
         void DynamicDelay::swap(DynamicDelay *d)
         {
             lsp::swap(vDelay, d->vDelay);
+            lsp::swap(vApState, d->vApState);
+            lsp::swap(nChannels, d->nChannels);
+            lsp::swap(nStride, d->nStride);
             lsp::swap(nHead, d->nHead);
             lsp::swap(nCapacity, d->nCapacity);
             lsp::swap(nMaxDelay, d->nMaxDelay);
@@ -157,12 +381,14 @@ namespace lsp
         void DynamicDelay::dump(IStateDumper *v) const
         {
             v->write("vDelay", vDelay);
+            v->writev("vApState", vApState, nChannels);
+            v->write("nChannels", nChannels);
+            v->write("nStride", nStride);
             v->write("nHead", nHead);
             v->write("nCapacity", nCapacity);
             v->write("nMaxDelay", nMaxDelay);
+            v->write("nInterp", nInterp);
             v->write("pData", pData);
         }
     }
 }
-
-
@@ -0,0 +1,706 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/dsp-units/util/FDNReverb.h>
+#include <lsp-plug.in/dsp-units/const.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define FDN_VELVET_SEED         0x7dc1f3a5      /* Seed of the diffusion kernel */
+#define FDN_VELVET_DENSITY      2000.0f         /* Density of the diffusion impulses [1/s] */
+#define FDN_SIGN_IN             0x4b3a6c95      /* Signs of the input gains, one bit per line */
+#define FDN_SIGN_LEFT           0x2d9e1787      /* Signs of the left output gains */
+#define FDN_SIGN_RIGHT          0x58e6b4d1      /* Signs of the right output gains */
+
+namespace lsp
+{
+    namespace dspu
+    {
+        FDNReverb::FDNReverb()
+        {
+            construct();
+        }
+
+        FDNReverb::~FDNReverb()
+        {
+            destroy();
+        }
+
+        void FDNReverb::construct()
+        {
+            sVelvet.construct();
+
+            vBuffer         = NULL;
+            vTaps           = NULL;
+            vInput          = NULL;
+            vDiffBuf        = NULL;
+            vDiffValue      = NULL;
+            vDiffPos        = NULL;
+            nDiffImpulses   = 0;
+            nDiffLength     = 0;
+
+            nLines          = 0;
+            nCapacity       = 0;
+            nMaxDelay       = 0;
+            nHead           = 0;
+            nBlock          = 1;
+            nSampleRate     = LSP_DSP_UNITS_DEFAULT_SAMPLE_RATE;
+            enMatrix        = FDN_HADAMARD;
+            enInterp        = DDI_LINEAR;
+
+            fSize           = 80.0f;
+            fDecay          = 2.0f;
+            fDamping        = 0.5f;
+            fModDepth       = 0.0f;
+            fModRate        = 0.5f;
+            fDiffusion      = 0.0f;
+            fDepth          = 0.0f;
+            fLfoCos         = 1.0f;
+            fLfoSin         = 0.0f;
+
+            for (size_t i=0; i<FDN_LINES_MAX; ++i)
+            {
+                vDelay[i]       = 1.0f;
+                vInGain[i]      = 0.0f;
+                vOutGain[0][i]  = 0.0f;
+                vOutGain[1][i]  = 0.0f;
+                vB0[i]          = 0.0f;
+                vB1[i]          = 0.0f;
+                vB2[i]          = 0.0f;
+                vA1[i]          = 0.0f;
+                vA2[i]          = 0.0f;
+                vD0[i]          = 0.0f;
+                vD1[i]          = 0.0f;
+                vApState[i]     = 0.0f;
+                vLfoRe[i]       = 1.0f;
+                vLfoIm[i]       = 0.0f;
+            }
+
+            pData           = NULL;
+            bSync           = true;
+        }
+
+        void FDNReverb::destroy()
+        {
+            if (pData != NULL)
+            {
+                free_aligned(pData);
+                pData           = NULL;
+            }
+
+            vBuffer         = NULL;
+            vTaps           = NULL;
+            vInput          = NULL;
+            vDiffBuf        = NULL;
+            vDiffValue      = NULL;
+            vDiffPos        = NULL;
+            nDiffImpulses   = 0;
+            nDiffLength     = 0;
+            nLines          = 0;
+            nCapacity       = 0;
+            nMaxDelay       = 0;
+            nHead           = 0;
+        }
+
+        status_t FDNReverb::init(size_t lines, size_t max_delay)
+        {
+            if (max_delay <= 0)
+                return STATUS_BAD_ARGUMENTS;
+
+            lines               = (lines <= FDN_LINES_MIN) ? FDN_LINES_MIN : FDN_LINES_MAX;
+
+            // The block never reaches the frames being written, the guard keeps the
+            // taps of the interpolator inside the buffer
+            size_t capacity     = 1;
+            while (capacity < (max_delay + FDN_BLOCK + DYNAMIC_DELAY_GUARD))
+                capacity          <<= 1;
+
+            size_t buf_sz       = capacity * lines;
+            size_t taps_sz      = FDN_BLOCK * lines;
+            size_t in_sz        = FDN_BLOCK;
+            size_t diff_sz      = FDN_DIFFUSION_MAX + FDN_BLOCK;
+            size_t value_sz     = FDN_DIFFUSION_MAX;
+            size_t pos_sz       = FDN_DIFFUSION_MAX;
+            size_t alloc        = (buf_sz + taps_sz + in_sz + diff_sz + value_sz) * sizeof(float) + pos_sz * sizeof(uint32_t);
+
+            uint8_t *data       = NULL;
+            uint8_t *ptr        = alloc_aligned<uint8_t>(data, alloc);
+            if (ptr == NULL)
+                return STATUS_NO_MEM;
+
+            if (pData != NULL)
+                free_aligned(pData);
+
+            vBuffer             = reinterpret_cast<float *>(ptr);
+            ptr                += buf_sz * sizeof(float);
+            vTaps               = reinterpret_cast<float *>(ptr);
+            ptr                += taps_sz * sizeof(float);
+            vInput              = reinterpret_cast<float *>(ptr);
+            ptr                += in_sz * sizeof(float);
+            vDiffBuf            = reinterpret_cast<float *>(ptr);
+            ptr                += diff_sz * sizeof(float);
+            vDiffValue          = reinterpret_cast<float *>(ptr);
+            ptr                += value_sz * sizeof(float);
+            vDiffPos            = reinterpret_cast<uint32_t *>(ptr);
+            ptr                += pos_sz * sizeof(uint32_t);
+
+            nLines              = lines;
+            nCapacity           = capacity;
+            nMaxDelay           = max_delay;
+            nDiffImpulses       = 0;
+            nDiffLength         = 0;
+            pData               = data;
+
+            // Pseudo-random signs of gains keep the input and the outputs decorrelated
+            // from the rows of the feedback matrix
+            float norm          = 1.0f / sqrtf(lines);
+            for (size_t i=0; i<FDN_LINES_MAX; ++i)
+            {
+                bool active         = i < lines;
+                vInGain[i]          = (!active) ? 0.0f : (FDN_SIGN_IN & (1 << i)) ? -norm : norm;
+                vOutGain[0][i]      = (!active) ? 0.0f : (FDN_SIGN_LEFT & (1 << i)) ? -norm : norm;
+                vOutGain[1][i]      = (!active) ? 0.0f : (FDN_SIGN_RIGHT & (1 << i)) ? -norm : norm;
+            }
+
+            dsp::fill_zero(vTaps, taps_sz);
+            dsp::fill_zero(vInput, in_sz);
+            dsp::fill_zero(vDiffValue, value_sz);
+            clear();
+
+            bSync               = true;
+
+            return STATUS_OK;
+        }
+
+        bool FDNReverb::is_prime(size_t n)
+        {
+            if (n < 2)
+                return false;
+            if (n < 4)
+                return true;
+            if (!(n & 1))
+                return false;
+            for (size_t k=3; k*k <= n; k += 2)
+                if (!(n % k))
+                    return false;
+            return true;
+        }
+
+        void FDNReverb::reset_lfo()
+        {
+            for (size_t i=0; i<nLines; ++i)
+            {
+                float phase     = (2.0f * M_PI * i) / nLines;
+                vLfoRe[i]       = cosf(phase);
+                vLfoIm[i]       = sinf(phase);
+            }
+        }
+
+        void FDNReverb::set_sample_rate(size_t sr)
+        {
+            if ((sr == nSampleRate) || (sr <= 0))
+                return;
+            nSampleRate     = sr;
+            bSync           = true;
+        }
+
+        void FDNReverb::set_size(float size)
+        {
+            if (size == fSize)
+                return;
+            fSize           = size;
+            bSync           = true;
+        }
+
+        void FDNReverb::set_decay(float decay)
+        {
+            if (decay == fDecay)
+                return;
+            fDecay          = decay;
+            bSync           = true;
+        }
+
+        void FDNReverb::set_damping(float damping)
+        {
+            if (damping == fDamping)
+                return;
+            fDamping        = damping;
+            bSync           = true;
+        }
+
+        void FDNReverb::set_modulation(float depth, float rate)
+        {
+            if ((depth == fModDepth) && (rate == fModRate))
+                return;
+            fModDepth       = depth;
+            fModRate        = rate;
+            bSync           = true;
+        }
+
+        void FDNReverb::set_diffusion(float length)
+        {
+            if (length == fDiffusion)
+                return;
+            fDiffusion      = length;
+            bSync           = true;
+        }
+
+        void FDNReverb::set_matrix(fdn_matrix_t matrix)
+        {
+            enMatrix        = matrix;
+        }
+
+        void FDNReverb::set_interpolation(dynamic_delay_interp_t interp)
+        {
+            if (interp == enInterp)
+                return;
+            enInterp        = interp;
+            for (size_t i=0; i<FDN_LINES_MAX; ++i)
+                vApState[i]     = 0.0f;
+        }
+
+        float FDNReverb::line_gain(size_t line) const
+        {
+            if (line >= nLines)
+                return 0.0f;
+            return (vB0[line] + vB1[line] + vB2[line]) / (1.0f - vA1[line] - vA2[line]);
+        }
+
+        void FDNReverb::update_settings()
+        {
+            if (!bSync)
+                return;
+
+            float sr        = nSampleRate;
+            float len       = fSize * 0.001f * sr;
+            float depth     = lsp_max(fModDepth * 0.001f * sr, 0.0f);
+
+            // The shortest line is about half of the longest one, the modulation
+            // never takes more than a half of it
+            depth           = lsp_min(depth, len * 0.25f);
+            ssize_t margin  = ssize_t(ceilf(depth)) + 4;
+            ssize_t lo      = margin;
+            ssize_t hi      = lsp_max(ssize_t(nMaxDelay) - margin, lo * 2 + ssize_t(nLines));
+            len             = lsp_limit(len, float(lo * 2 + nLines), float(hi));
+            fDepth          = depth;
+
+            // Distribute lines logarithmically between len/2 and len, the lengths are
+            // mutually prime to spread the modes of the network
+            ssize_t dmin    = hi;
+            for (size_t i=0; i<nLines; ++i)
+            {
+                ssize_t target  = lsp_limit(ssize_t(len * exp2f(-float(i) / nLines) + 0.5f), lo, hi);
+                ssize_t found   = -1;
+
+                for (ssize_t n=target; (n <= hi) && (found < 0); ++n)
+                {
+                    bool used       = false;
+                    for (size_t j=0; j<i; ++j)
+                        used           |= ssize_t(vDelay[j]) == n;
+                    if ((!used) && (is_prime(n)))
+                        found           = n;
+                }
+                for (ssize_t n=target - 1; (n >= lo) && (found < 0); --n)
+                {
+                    bool used       = false;
+                    for (size_t j=0; j<i; ++j)
+                        used           |= ssize_t(vDelay[j]) == n;
+                    if ((!used) && (is_prime(n)))
+                        found           = n;
+                }
+                if (found < 0)
+                    found           = target;
+
+                vDelay[i]       = found;
+                dmin            = lsp_min(dmin, found);
+            }
+
+            // All reads of the block should refer to the frames written before the block
+            nBlock          = lsp_limit(dmin - ssize_t(ceilf(depth)) - 1, ssize_t(1), ssize_t(FDN_BLOCK));
+
+            // Absorption: one-pole lowpass with the gain matched to the decay of the line
+            // at zero frequency and at the Nyquist frequency
+            float decay     = lsp_max(fDecay, 0.01f);
+            float damping   = lsp_limit(fDamping, 0.01f, 1.0f);
+            float k         = -3.0f / (decay * sr);
+            for (size_t i=0; i<nLines; ++i)
+            {
+                float gdc       = powf(10.0f, k * vDelay[i]);
+                float gny       = powf(10.0f, k * vDelay[i] / damping);
+                float p         = (gdc - gny) / (gdc + gny);
+
+                vB0[i]          = gdc * (1.0f - p);
+                vB1[i]          = 0.0f;
+                vB2[i]          = 0.0f;
+                vA1[i]          = p;
+                vA2[i]          = 0.0f;
+            }
+
+            // Rotation of the LFO phasor per sample
+            float w         = (2.0f * M_PI * lsp_max(fModRate, 0.0f)) / sr;
+            fLfoCos         = cosf(w);
+            fLfoSin         = sinf(w);
+
+            // Velvet noise diffusion kernel with the exponential decay by 60 dB
+            size_t length   = lsp_min(size_t(lsp_max(fDiffusion * 0.001f * sr, 0.0f)), size_t(FDN_DIFFUSION_MAX));
+            if (length != nDiffLength)
+                dsp::fill_zero(vDiffBuf, FDN_DIFFUSION_MAX + FDN_BLOCK);
+            nDiffImpulses   = 0;
+            nDiffLength     = 0;
+
+            if (length >= 2)
+            {
+                sVelvet.init(FDN_VELVET_SEED, 16, 0);
+                sVelvet.set_core_type(VN_CORE_LCG);
+                sVelvet.set_velvet_type(VN_VELVET_OVN);
+                sVelvet.set_velvet_window_width(lsp_max(sr / FDN_VELVET_DENSITY, 1.0f));
+                sVelvet.set_amplitude(1.0f);
+                sVelvet.set_crush(false);
+
+                size_t n        = sVelvet.generate_sparse(vDiffPos, vDiffValue, length);
+                float kd        = logf(GAIN_AMP_M_60_DB) / length;
+                float energy    = 0.0f;
+                for (size_t i=0; i<n; ++i)
+                {
+                    vDiffValue[i]  *= expf(kd * vDiffPos[i]);
+                    energy         += vDiffValue[i] * vDiffValue[i];
+                }
+                if (energy > 0.0f)
+                {
+                    dsp::mul_k2(vDiffValue, 1.0f / sqrtf(energy), n);
+                    nDiffImpulses   = n;
+                    nDiffLength     = length;
+                }
+            }
+
+            bSync           = false;
+        }
+
+        void FDNReverb::diffuse(const float *in, size_t samples)
+        {
+            if (nDiffImpulses <= 0)
+            {
+                if (in != NULL)
+                    dsp::copy(vInput, in, samples);
+                else
+                    dsp::fill_zero(vInput, samples);
+                return;
+            }
+
+            // Overlap-add of the sparse convolution, the tail is kept for the next blocks
+            if (in != NULL)
+                Velvet::convolve(vDiffBuf, in, vDiffPos, vDiffValue, nDiffImpulses, samples);
+            dsp::copy(vInput, vDiffBuf, samples);
+            dsp::move(vDiffBuf, &vDiffBuf[samples], nDiffLength);
+            dsp::fill_zero(&vDiffBuf[nDiffLength], samples);
+        }
+
+        void FDNReverb::read_taps(size_t frames)
+        {
+            const size_t lanes  = nLines;
+            const size_t mask   = nCapacity - 1;
+            float *t            = vTaps;
+
+            // Fixed integer delays, the lanes of the tap are read from different frames
+            if (fDepth <= 0.0f)
+            {
+                for (size_t i=0; i<frames; ++i, t += lanes)
+                {
+                    size_t pos          = nHead + i;
+                    for (size_t l=0; l<lanes; ++l)
+                        t[l]                = vBuffer[((pos - size_t(vDelay[l])) & mask) * lanes + l];
+                }
+                return;
+            }
+
+            // Modulated delays, b0..b3 are the samples with delays (shift + 2) .. (shift - 1)
+            // interpolated the same way as DynamicDelay does
+            for (size_t i=0; i<frames; ++i, t += lanes)
+            {
+                size_t pos          = nHead + i;
+
+                for (size_t l=0; l<lanes; ++l)
+                {
+                    float re            = vLfoRe[l];
+                    float im            = vLfoIm[l];
+                    vLfoRe[l]           = re * fLfoCos - im * fLfoSin;
+                    vLfoIm[l]           = re * fLfoSin + im * fLfoCos;
+                }
+
+                for (size_t l=0; l<lanes; ++l)
+                {
+                    float d             = vDelay[l] + fDepth * vLfoIm[l];
+                    size_t shift        = size_t(d);
+                    float frac          = d - shift;
+                    size_t p            = pos - shift;
+                    float b0            = vBuffer[((p - 2) & mask) * lanes + l];
+                    float b1            = vBuffer[((p - 1) & mask) * lanes + l];
+                    float b2            = vBuffer[(p & mask) * lanes + l];
+                    float b3            = vBuffer[((p + 1) & mask) * lanes + l];
+                    float s;
+
+                    switch (enInterp)
+                    {
+                        case DDI_NONE:
+                            s                   = b2;
+                            break;
+
+                        case DDI_LINEAR:
+                            s                   = b2 + (b1 - b2) * frac;
+                            break;
+
+                        case DDI_HERMITE:
+                        {
+                            float c1            = 0.5f * (b1 - b3);
+                            float c2            = b3 - 2.5f * b2 + 2.0f * b1 - 0.5f * b0;
+                            float c3            = 0.5f * (b0 - b3) + 1.5f * (b2 - b1);
+                            s                   = ((c3 * frac + c2) * frac + c1) * frac + b2;
+                            break;
+                        }
+
+                        case DDI_ALLPASS:
+                        default:
+                        {
+                            bool low            = frac < 0.5f;
+                            float x0            = (low) ? b3 : b2;
+                            float x1            = (low) ? b2 : b1;
+                            float k             = (low) ? frac + 1.0f : frac;
+                            float a             = (1.0f - k) / (1.0f + k);
+                            s                   = a * (x0 - vApState[l]) + x1;
+                            vApState[l]         = s;
+                            break;
+                        }
+                    }
+
+                    t[l]                = s;
+                }
+            }
+
+            // Keep the magnitude of phasors at 1
+            for (size_t l=0; l<lanes; ++l)
+            {
+                float re            = vLfoRe[l];
+                float im            = vLfoIm[l];
+                float g             = 1.5f - 0.5f * (re*re + im*im);
+                vLfoRe[l]           = re * g;
+                vLfoIm[l]           = im * g;
+            }
+        }
+
+        void FDNReverb::absorb(size_t frames)
+        {
+            const size_t lanes  = nLines;
+            float *x            = vTaps;
+
+            // Transposed direct form II, all lanes at once, each lane has own coefficients
+            for (size_t i=0; i<frames; ++i, x += lanes)
+            {
+                for (size_t l=0; l<lanes; ++l)
+                {
+                    float s             = x[l];
+                    float r             = vB0[l] * s + vD0[l];
+                    vD0[l]              = vB1[l] * s + vA1[l] * r + vD1[l];
+                    vD1[l]              = vB2[l] * s + vA2[l] * r;
+                    x[l]                = r;
+                }
+            }
+        }
+
+        void FDNReverb::emit(float *left, float *right, size_t frames)
+        {
+            const size_t lanes  = nLines;
+            const float *x      = vTaps;
+            const float *gl     = vOutGain[0];
+            const float *gr     = vOutGain[1];
+
+            for (size_t i=0; i<frames; ++i, x += lanes)
+            {
+                float sl            = 0.0f;
+                for (size_t l=0; l<lanes; ++l)
+                    sl                 += x[l] * gl[l];
+                left[i]             = sl;
+            }
+
+            if (right == NULL)
+                return;
+
+            x                   = vTaps;
+            for (size_t i=0; i<frames; ++i, x += lanes)
+            {
+                float sr            = 0.0f;
+                for (size_t l=0; l<lanes; ++l)
+                    sr                 += x[l] * gr[l];
+                right[i]            = sr;
+            }
+        }
+
+        void FDNReverb::mix(size_t frames)
+        {
+            const size_t lanes  = nLines;
+            float *x            = vTaps;
+
+            if (enMatrix == FDN_HOUSEHOLDER)
+            {
+                // x = x - 2/N * sum(x)
+                float k             = -2.0f / lanes;
+                for (size_t i=0; i<frames; ++i, x += lanes)
+                {
+                    float s             = 0.0f;
+                    for (size_t l=0; l<lanes; ++l)
+                        s                  += x[l];
+                    s                  *= k;
+                    for (size_t l=0; l<lanes; ++l)
+                        x[l]               += s;
+                }
+                return;
+            }
+
+            // Fast Walsh-Hadamard transform by butterflies, normalized by 1/sqrt(N)
+            float norm          = 1.0f / sqrtf(lanes);
+            for (size_t i=0; i<frames; ++i, x += lanes)
+            {
+                for (size_t h=1; h<lanes; h <<= 1)
+                {
+                    for (size_t j=0; j<lanes; j += h << 1)
+                    {
+                        for (size_t k=j; k<j+h; ++k)
+                        {
+                            float a             = x[k];
+                            float b             = x[k + h];
+                            x[k]                = a + b;
+                            x[k + h]            = a - b;
+                        }
+                    }
+                }
+
+                for (size_t l=0; l<lanes; ++l)
+                    x[l]               *= norm;
+            }
+        }
+
+        void FDNReverb::write_frames(const float *in, size_t frames)
+        {
+            const size_t lanes  = nLines;
+            const size_t mask   = nCapacity - 1;
+            const float *x      = vTaps;
+
+            // Each frame holds all lanes, so the whole frame is written at once
+            for (size_t i=0; i<frames; ++i, x += lanes)
+            {
+                float *dst          = &vBuffer[((nHead + i) & mask) * lanes];
+                float s             = in[i];
+                for (size_t l=0; l<lanes; ++l)
+                    dst[l]              = x[l] + s * vInGain[l];
+            }
+        }
+
+        void FDNReverb::process(float *left, float *right, const float *in, size_t samples)
+        {
+            if (bSync)
+                update_settings();
+
+            for (size_t offset=0; offset < samples; )
+            {
+                size_t to_do        = lsp_min(samples - offset, nBlock);
+
+                diffuse((in != NULL) ? &in[offset] : NULL, to_do);
+                read_taps(to_do);
+                absorb(to_do);
+                emit(&left[offset], (right != NULL) ? &right[offset] : NULL, to_do);
+                mix(to_do);
+                write_frames(vInput, to_do);
+
+                nHead               = (nHead + to_do) & (nCapacity - 1);
+                offset             += to_do;
+            }
+        }
+
+        void FDNReverb::clear()
+        {
+            if (vBuffer != NULL)
+                dsp::fill_zero(vBuffer, nCapacity * nLines);
+            if (vDiffBuf != NULL)
+                dsp::fill_zero(vDiffBuf, FDN_DIFFUSION_MAX + FDN_BLOCK);
+
+            for (size_t i=0; i<FDN_LINES_MAX; ++i)
+            {
+                vD0[i]          = 0.0f;
+                vD1[i]          = 0.0f;
+                vApState[i]     = 0.0f;
+            }
+
+            nHead           = 0;
+            reset_lfo();
+        }
+
+        void FDNReverb::dump(IStateDumper *v) const
+        {
+            v->write_object("sVelvet", &sVelvet);
+
+            v->write("vBuffer", vBuffer);
+            v->write("vTaps", vTaps);
+            v->write("vInput", vInput);
+            v->write("vDiffBuf", vDiffBuf);
+            v->write("vDiffValue", vDiffValue);
+            v->write("vDiffPos", vDiffPos);
+            v->write("nDiffImpulses", nDiffImpulses);
+            v->write("nDiffLength", nDiffLength);
+
+            v->write("nLines", nLines);
+            v->write("nCapacity", nCapacity);
+            v->write("nMaxDelay", nMaxDelay);
+            v->write("nHead", nHead);
+            v->write("nBlock", nBlock);
+            v->write("nSampleRate", nSampleRate);
+            v->write("enMatrix", int(enMatrix));
+            v->write("enInterp", int(enInterp));
+
+            v->write("fSize", fSize);
+            v->write("fDecay", fDecay);
+            v->write("fDamping", fDamping);
+            v->write("fModDepth", fModDepth);
+            v->write("fModRate", fModRate);
+            v->write("fDiffusion", fDiffusion);
+            v->write("fDepth", fDepth);
+            v->write("fLfoCos", fLfoCos);
+            v->write("fLfoSin", fLfoSin);
+
+            v->writev("vDelay", vDelay, FDN_LINES_MAX);
+            v->writev("vInGain", vInGain, FDN_LINES_MAX);
+            v->writev("vOutGainL", vOutGain[0], FDN_LINES_MAX);
+            v->writev("vOutGainR", vOutGain[1], FDN_LINES_MAX);
+            v->writev("vB0", vB0, FDN_LINES_MAX);
+            v->writev("vB1", vB1, FDN_LINES_MAX);
+            v->writev("vB2", vB2, FDN_LINES_MAX);
+            v->writev("vA1", vA1, FDN_LINES_MAX);
+            v->writev("vA2", vA2, FDN_LINES_MAX);
+            v->writev("vD0", vD0, FDN_LINES_MAX);
+            v->writev("vD1", vD1, FDN_LINES_MAX);
+            v->writev("vApState", vApState, FDN_LINES_MAX);
+            v->writev("vLfoRe", vLfoRe, FDN_LINES_MAX);
+            v->writev("vLfoIm", vLfoIm, FDN_LINES_MAX);
+
+            v->write("pData", pData);
+            v->write("bSync", bSync);
+        }
+    }
+} /* namespace lsp */
@@ -0,0 +1,547 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp-units/util/FFTCrossover.h>
+#include <lsp-plug.in/dsp-units/units.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        FFTCrossover::FFTCrossover()
+        {
+            construct();
+        }
+
+        FFTCrossover::~FFTCrossover()
+        {
+            destroy();
+        }
+
+        void FFTCrossover::construct()
+        {
+            bReconfigure    = false;
+            nSplits         = 0;
+            nRank           = 0;
+            nSampleRate     = LSP_DSP_UNITS_DEFAULT_SAMPLE_RATE;
+            nOffset         = 0;
+
+            vBands          = NULL;
+            vSplit          = NULL;
+            vPlan           = NULL;
+            nPlanSize       = 0;
+
+            vInBuf          = NULL;
+            vFft            = NULL;
+            vTemp           = NULL;
+            vWnd            = NULL;
+
+            pData           = NULL;
+        }
+
+        void FFTCrossover::destroy()
+        {
+            free_aligned(pData);
+            construct();
+        }
+
+        bool FFTCrossover::init(size_t bands, size_t rank)
+        {
+            if ((bands < 1) || (rank < 2))
+                return false;
+
+            size_t fft_size     = 1 << rank;
+            size_t block_size   = fft_size >> 1;
+            size_t block_buf    = align_size(block_size * sizeof(float), DEFAULT_ALIGN);
+            size_t fft_buf      = align_size(fft_size * sizeof(float) * 2, DEFAULT_ALIGN);
+            size_t out_buf      = align_size(fft_size * sizeof(float), DEFAULT_ALIGN);
+            size_t band_size    = align_size(bands * sizeof(band_t), DEFAULT_ALIGN);
+            size_t split_size   = align_size((bands - 1) * sizeof(split_t), DEFAULT_ALIGN);
+            size_t plan_size    = align_size((bands - 1) * sizeof(split_t *), DEFAULT_ALIGN);
+            size_t to_alloc     = band_size +
+                                  split_size +
+                                  plan_size +
+                                  block_buf * 2 +               // vInBuf, vWnd
+                                  fft_buf * 2 +                 // vFft, vTemp
+                                  (fft_buf + out_buf) * bands;  // vKernel, vOut
+
+            // Allocate buffers
+            uint8_t *data       = NULL;
+            uint8_t *ptr        = alloc_aligned<uint8_t>(data, to_alloc);
+            if (ptr == NULL)
+                return false;
+
+            free_aligned(pData);
+
+            // Distribute the allocated space
+            vBands              = reinterpret_cast<band_t *>(ptr);
+            ptr                += band_size;
+            vSplit              = reinterpret_cast<split_t *>(ptr);
+            ptr                += split_size;
+            vPlan               = reinterpret_cast<split_t **>(ptr);
+            ptr                += plan_size;
+            vInBuf              = reinterpret_cast<float *>(ptr);
+            ptr                += block_buf;
+            vWnd                = reinterpret_cast<float *>(ptr);
+            ptr                += block_buf;
+            vFft                = reinterpret_cast<float *>(ptr);
+            ptr                += fft_buf;
+            vTemp               = reinterpret_cast<float *>(ptr);
+            ptr                += fft_buf;
+
+            // Initialize fields, keep sample_rate unchanged
+            bReconfigure        = true;
+            nSplits             = bands - 1;
+            nRank               = rank;
+            nOffset             = 0;
+            nPlanSize           = 0;
+
+            // Store allocated data pointer
+            pData               = data;
+
+            // Compute the symmetric kernel window centered at block_size/2
+            for (size_t i=0; i<block_size; ++i)
+                vWnd[i]             = 0.5f - 0.5f * cosf((2.0f * M_PI * i) / block_size);
+
+            // Construct all splits
+            float step          = logf(LSP_DSP_UNITS_SPEC_FREQ_MAX / LSP_DSP_UNITS_SPEC_FREQ_MIN) / bands;
+
+            for (size_t i=0; i<nSplits; ++i)
+            {
+                split_t *sp         = &vSplit[i];
+
+                sp->nBandId         = i + 1; // Band N+1 is attached to split point N
+                sp->nSlope          = 0;
+                sp->fFreq           = LSP_DSP_UNITS_SPEC_FREQ_MIN * expf((i+1) * step);
+            }
+
+            // Construct all bands
+            for (size_t i=0; i<=nSplits; ++i)
+            {
+                band_t *sb          = &vBands[i];
+
+                sb->fGain           = GAIN_AMP_0_DB;
+                sb->fStart          = (i == 0) ? LSP_DSP_UNITS_SPEC_FREQ_MIN : vSplit[i-1].fFreq;
+                sb->fEnd            = (i < nSplits) ? vSplit[i].fFreq : nSampleRate * 0.5f;
+                sb->bEnabled        = false;
+                sb->pStart          = NULL;
+                sb->pEnd            = NULL;
+
+                sb->vKernel         = reinterpret_cast<float *>(ptr);
+                ptr                += fft_buf;
+                sb->vOut            = reinterpret_cast<float *>(ptr);
+                ptr                += out_buf;
+
+                sb->pFunc           = NULL;
+                sb->pObject         = NULL;
+                sb->pSubject        = NULL;
+                sb->nId             = i;
+            }
+
+            clear();
+
+            return true;
+        }
+
+        void FFTCrossover::set_slope(size_t sp, size_t slope)
+        {
+            if (sp >= nSplits)
+                return;
+            if (slope == vSplit[sp].nSlope)
+                return;
+
+            vSplit[sp].nSlope   = slope;
+            bReconfigure        = true;
+        }
+
+        ssize_t FFTCrossover::get_slope(size_t sp) const
+        {
+            return (sp < nSplits) ? vSplit[sp].nSlope : -1;
+        }
+
+        void FFTCrossover::set_frequency(size_t sp, float freq)
+        {
+            if (sp >= nSplits)
+                return;
+            if (freq == vSplit[sp].fFreq)
+                return;
+
+            vSplit[sp].fFreq    = freq;
+            bReconfigure        = true;
+        }
+
+        float FFTCrossover::get_frequency(size_t sp) const
+        {
+            return (sp < nSplits) ? vSplit[sp].fFreq : -1.0f;
+        }
+
+        void FFTCrossover::set_gain(size_t band, float gain)
+        {
+            if (band > nSplits)
+                return;
+            if (gain == vBands[band].fGain)
+                return;
+
+            vBands[band].fGain  = gain;
+            bReconfigure        = true;
+        }
+
+        float FFTCrossover::get_gain(size_t band) const
+        {
+            return (band <= nSplits) ? vBands[band].fGain: -1.0f;
+        }
+
+        float FFTCrossover::get_band_start(size_t band)
+        {
+            reconfigure();
+            return (band <= nSplits) ? vBands[band].fStart : -1.0f;
+        }
+
+        float FFTCrossover::get_band_end(size_t band)
+        {
+            reconfigure();
+            return (band <= nSplits) ? vBands[band].fEnd : -1.0f;
+        }
+
+        bool FFTCrossover::set_handler(size_t band, crossover_func_t func, void *object, void *subject)
+        {
+            if (band > nSplits)
+                return false;
+
+            band_t *b       = &vBands[band];
+            b->pFunc        = func;
+            b->pObject      = object;
+            b->pSubject     = subject;
+
+            return true;
+        }
+
+        bool FFTCrossover::unset_handler(size_t band)
+        {
+            if (band > nSplits)
+                return false;
+
+            band_t *b       = &vBands[band];
+            b->pFunc        = NULL;
+            b->pObject      = NULL;
+            b->pSubject     = NULL;
+            return true;
+        }
+
+        bool FFTCrossover::band_active(size_t band)
+        {
+            if (band > nSplits)
+                return false;
+            else if (band == 0)
+                return true;
+
+            reconfigure();
+            return vBands[band].bEnabled;
+        }
+
+        void FFTCrossover::set_sample_rate(size_t sr)
+        {
+            if (nSampleRate == sr)
+                return;
+
+            nSampleRate     = sr;
+            bReconfigure    = true;
+        }
+
+        float FFTCrossover::lpf_response(const split_t *sp, float f)
+        {
+            // Magnitude response of the Linkwitz-Riley low-pass filter,
+            // the high-pass response is complementary: 1 - lpf_response()
+            float x         = powf(f / sp->fFreq, 2.0f * sp->nSlope);
+            return 1.0f / (1.0f + x);
+        }
+
+        float FFTCrossover::band_response(const band_t *b, float f)
+        {
+            if (!b->bEnabled)
+                return 0.0f;
+
+            // Band k is the product of high-pass responses of splits 0..k-1 and
+            // the low-pass response of split k, so the sum of all bands is always 1
+            float r         = b->fGain;
+            for (size_t i=0; i<nPlanSize; ++i)
+            {
+                split_t *sp     = vPlan[i];
+                float lpf       = lpf_response(sp, f);
+                if (sp == b->pEnd)
+                    return r * lpf;
+                r              *= 1.0f - lpf;
+            }
+
+            return r;
+        }
+
+        void FFTCrossover::build_kernel(band_t *b)
+        {
+            size_t fft_size     = 1 << nRank;
+            size_t half         = fft_size >> 1;
+            size_t center       = half >> 1;
+            float kf            = float(nSampleRate) / float(fft_size);
+
+            // Build zero-phase magnitude response of the band
+            for (size_t i=0; i<=half; ++i)
+            {
+                vTemp[i*2]          = band_response(b, i * kf);
+                vTemp[i*2 + 1]      = 0.0f;
+            }
+            for (size_t i=half+1; i<fft_size; ++i)
+            {
+                vTemp[i*2]          = vTemp[(fft_size - i)*2];
+                vTemp[i*2 + 1]      = 0.0f;
+            }
+
+            // Compute the impulse response, shift it to the center of the block and apply window
+            dsp::packed_reverse_fft(vTemp, vTemp, nRank);
+            dsp::pcomplex_c2r(vTemp, vTemp, fft_size);
+
+            dsp::fill_zero(vFft, fft_size);
+            dsp::mul3(&vFft[center], vTemp, &vWnd[center], half - center);
+            dsp::mul3(vFft, &vTemp[fft_size - center], vWnd, center);
+
+            // Store the spectrum of the kernel
+            dsp::pcomplex_r2c(b->vKernel, vFft, fft_size);
+            dsp::packed_direct_fft(b->vKernel, b->vKernel, nRank);
+        }
+
+        void FFTCrossover::reconfigure()
+        {
+            if (!bReconfigure)
+                return;
+
+            // Form the plan and reset band state
+            nPlanSize       = 0;
+            for (size_t i=0; i<nSplits; ++i)
+            {
+                if (vSplit[i].nSlope > 0)
+                    vPlan[nPlanSize++]  = &vSplit[i];
+            }
+            for (size_t i=0; i<=nSplits; ++i)
+                vBands[i].bEnabled  = false;
+
+            // Sort split bands in ascending order
+            for (ssize_t si=0, n=nPlanSize; si < n-1; ++si)
+                for (ssize_t sj=si+1; sj < n; ++sj)
+                    if (vPlan[sj]->fFreq < vPlan[si]->fFreq)
+                        swap(vPlan[si], vPlan[sj]);
+
+            band_t *left        = &vBands[0];
+            left->fStart        = LSP_DSP_UNITS_SPEC_FREQ_MIN;
+            left->bEnabled      = true;
+            left->pStart        = NULL;
+
+            for (size_t i=0; i<nPlanSize; ++i)
+            {
+                split_t *sp         = vPlan[i];
+                band_t *right       = &vBands[sp->nBandId];
+
+                left->fEnd          = sp->fFreq;
+                left->pEnd          = sp;
+                right->fStart       = sp->fFreq;
+                right->pStart       = sp;
+                right->bEnabled     = true;
+
+                left                = right;
+            }
+
+            left->fEnd          = nSampleRate * 0.5f;
+            left->pEnd          = NULL;
+
+            // Build kernels of all active bands
+            for (size_t i=0; i<=nSplits; ++i)
+            {
+                band_t *b           = &vBands[i];
+                if (b->bEnabled)
+                    build_kernel(b);
+            }
+
+            // Reset reconfiguration flag
+            bReconfigure        = false;
+        }
+
+        void FFTCrossover::clear()
+        {
+            size_t fft_size     = 1 << nRank;
+
+            dsp::fill_zero(vInBuf, fft_size >> 1);
+            for (size_t i=0; i<=nSplits; ++i)
+                dsp::fill_zero(vBands[i].vOut, fft_size);
+
+            nOffset             = 0;
+        }
+
+        void FFTCrossover::process_block()
+        {
+            size_t fft_size     = 1 << nRank;
+            size_t half         = fft_size >> 1;
+
+            // One direct FFT of the zero-padded input block
+            dsp::pcomplex_r2c(vFft, vInBuf, half);
+            dsp::fill_zero(&vFft[fft_size], fft_size);
+            dsp::packed_direct_fft(vFft, vFft, nRank);
+
+            // One reverse FFT for each band
+            for (size_t i=0; i<=nSplits; ++i)
+            {
+                band_t *b           = &vBands[i];
+                if ((!b->bEnabled) || (b->pFunc == NULL))
+                    continue;
+
+                dsp::move(b->vOut, &b->vOut[half], half);
+                dsp::fill_zero(&b->vOut[half], half);
+
+                dsp::pcomplex_mul3(vTemp, vFft, b->vKernel, fft_size);
+                dsp::packed_reverse_fft(vTemp, vTemp, nRank);
+                dsp::pcomplex_c2r(vTemp, vTemp, fft_size);
+                dsp::add2(b->vOut, vTemp, fft_size);
+            }
+        }
+
+        void FFTCrossover::process(const float *in, size_t samples)
+        {
+            reconfigure();
+
+            size_t half         = 1 << (nRank - 1);
+
+            for (size_t sample=0; sample < samples; )
+            {
+                size_t to_do        = lsp_min(samples - sample, half - nOffset);
+
+                // Store input data and emit the output of the previous block
+                dsp::copy(&vInBuf[nOffset], &in[sample], to_do);
+                for (size_t i=0; i<=nSplits; ++i)
+                {
+                    band_t *b           = &vBands[i];
+                    if ((b->bEnabled) && (b->pFunc != NULL))
+                        b->pFunc(b->pObject, b->pSubject, b->nId, &b->vOut[nOffset], sample, to_do);
+                }
+
+                // Process the block if it is complete
+                nOffset            += to_do;
+                sample             += to_do;
+                if (nOffset >= half)
+                {
+                    process_block();
+                    nOffset             = 0;
+                }
+            }
+        }
+
+        bool FFTCrossover::freq_chart(size_t band, float *re, float *im, const float *f, size_t count)
+        {
+            // Valid index of the band?
+            if (band > nSplits)
+                return false;
+
+            // Reconfigure
+            reconfigure();
+
+            band_t *b       = &vBands[band];
+            for (size_t i=0; i<count; ++i)
+                re[i]           = band_response(b, f[i]);
+            dsp::fill_zero(im, count);
+
+            return true;
+        }
+
+        bool FFTCrossover::freq_chart(size_t band, float *c, const float *f, size_t count)
+        {
+            // Valid index of the band?
+            if (band > nSplits)
+                return false;
+
+            // Reconfigure
+            reconfigure();
+
+            band_t *b       = &vBands[band];
+            for (size_t i=0; i<count; ++i, c += 2)
+            {
+                c[0]            = band_response(b, f[i]);
+                c[1]            = 0.0f;
+            }
+
+            return true;
+        }
+
+        void FFTCrossover::dump(IStateDumper *v) const
+        {
+            v->write("bReconfigure", bReconfigure);
+            v->write("nSplits", nSplits);
+            v->write("nRank", nRank);
+            v->write("nSampleRate", nSampleRate);
+            v->write("nOffset", nOffset);
+
+            v->begin_array("vBands", vBands, nSplits+1);
+            for (size_t i=0; i<=nSplits; ++i)
+            {
+                band_t *b   = &vBands[i];
+                v->begin_object(b, sizeof(band_t));
+                {
+                    v->write("fGain", b->fGain);
+                    v->write("fStart", b->fStart);
+                    v->write("fEnd", b->fEnd);
+                    v->write("bEnabled", b->bEnabled);
+                    v->write("pStart", b->pStart);
+                    v->write("pEnd", b->pEnd);
+                    v->write("vKernel", b->vKernel);
+                    v->write("vOut", b->vOut);
+
+                    v->write("pFunc", b->pFunc);
+                    v->write("pObject", b->pObject);
+                    v->write("pSubject", b->pSubject);
+                    v->write("nId", b->nId);
+                }
+                v->end_object();
+            }
+            v->end_array();
+
+            v->begin_array("vSplit", vSplit, nSplits);
+            for (size_t i=0; i < nSplits; ++i)
+            {
+                split_t *s  = &vSplit[i];
+                v->begin_object(s, sizeof(split_t));
+                {
+                    v->write("nBandId", s->nBandId);
+                    v->write("nSlope", s->nSlope);
+                    v->write("fFreq", s->fFreq);
+                }
+                v->end_object();
+            }
+            v->end_array();
+
+            v->writev("vPlan", vPlan, nPlanSize);
+            v->write("nPlanSize", nPlanSize);
+
+            v->write("vInBuf", vInBuf);
+            v->write("vFft", vFft);
+            v->write("vTemp", vTemp);
+            v->write("vWnd", vWnd);
+            v->write("pData", pData);
+        }
+    }
+} /* namespace lsp */
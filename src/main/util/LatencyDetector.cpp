@@ -23,8 +23,10 @@
 #include <lsp-plug.in/common/alloc.h>
 #include <lsp-plug.in/dsp-units/units.h>
 #include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/stdlib.h>
 
 #define LIM_BUF_SIZE        (1 << 15)
+#define LIM_CAPTURE_SIZE    (1 << 17)   // Maximum capture length for the deferred correlation
 
 namespace lsp
 {
@@ -37,6 +39,7 @@ namespace lsp
 
         LatencyDetector::~LatencyDetector()
         {
+            destroy();
         }
 
         void LatencyDetector::construct()
@@ -67,6 +70,8 @@ namespace lsp
             sInputProcessor.fDetect                 = 0.5f; // 500 ms
             sInputProcessor.nDetect                 = 0;
             sInputProcessor.nDetectCounter          = 0;
+            sInputProcessor.nCapture                = 0;
+            sInputProcessor.nCorrRank               = 0;
 
             sOutputProcessor.nState                 = OP_BYPASS;
             sOutputProcessor.og_time                = 0;
@@ -86,48 +91,99 @@ namespace lsp
 
             sPeakDetector.fAbsThreshold             = 0.0f;
             sPeakDetector.fPeakThreshold            = 0.0f;
-            sPeakDetector.fValue                    = 0.0f;
-            sPeakDetector.nPosition                 = 0;
             sPeakDetector.nTimeOrigin               = 0;
-            sPeakDetector.bDetected                 = false;
+
+            nChannels                               = 0;
+            vChannels                               = NULL;
 
             vChirp                                  = NULL;
             vAntiChirp                              = NULL;
-            vCapture                                = NULL;
-            vBuffer                                 = NULL;
             vChirpConv                              = NULL;
             vConvBuf                                = NULL;
+            vCorrConv                               = NULL;
+            vCorrBuf                                = NULL;
+            vCorrOut                                = NULL;
             pData                                   = NULL;
 
+            bDeferred                               = false;
+
             bCycleComplete                          = false;
             bLatencyDetected                        = false;
-            nLatency                                = -1;
 
             bSync                                   = true;
         }
 
         void LatencyDetector::init()
         {
-            // 1x chirp + 1x anti-chirp + 1x capture + 2x buffer + 4x conv image + 4x temporary convolution buffer
-            size_t samples  = 13 * LIM_BUF_SIZE;
+            init(1, false);
+        }
 
-            pData           = new uint8_t[samples * sizeof(float) + DEFAULT_ALIGN];
+        bool LatencyDetector::init(size_t channels, bool deferred)
+        {
+            destroy();
+            channels        = lsp_max(channels, size_t(1));
+
+            // 1x chirp + 1x anti-chirp + 4x conv image + 4x temporary convolution buffer,
+            // 1x capture + 2x buffer for each channel. Deferred correlation requires
+            // 4x image + 4x temporary buffer + 2x output of the capture size, and 1x capture for each channel
+            size_t samples  = (deferred) ?
+                10 * LIM_BUF_SIZE + (10 + channels) * LIM_CAPTURE_SIZE :
+                (10 + 3 * channels) * LIM_BUF_SIZE;
+            size_t szof_ch  = align_size(sizeof(channel_t) * channels, DEFAULT_ALIGN);
+
+            pData           = new uint8_t[samples * sizeof(float) + szof_ch + DEFAULT_ALIGN];
+            if (pData == NULL)
+                return false;
             uint8_t *ptr    = align_ptr(pData, DEFAULT_ALIGN);
 
+            vChannels       = reinterpret_cast<channel_t *>(ptr);
+            ptr            += szof_ch;
+            float *buf      = reinterpret_cast<float *>(ptr);
+            dsp::fill_zero(buf, samples);
+
             vChirp          = reinterpret_cast<float *>(ptr);
             ptr            += LIM_BUF_SIZE * sizeof(float);
             vAntiChirp      = reinterpret_cast<float *>(ptr);
             ptr            += LIM_BUF_SIZE * sizeof(float);
-            vCapture        = reinterpret_cast<float *>(ptr);
-            ptr            += LIM_BUF_SIZE * sizeof(float);
-            vBuffer         = reinterpret_cast<float *>(ptr);
-            ptr            += 2 * LIM_BUF_SIZE * sizeof(float);
             vChirpConv      = reinterpret_cast<float *>(ptr);
             ptr            += 4 * LIM_BUF_SIZE * sizeof(float);
             vConvBuf        = reinterpret_cast<float *>(ptr);
             ptr            += 4 * LIM_BUF_SIZE * sizeof(float);
 
-            dsp::fill_zero(vChirp, samples);
+            if (deferred)
+            {
+                vCorrConv       = reinterpret_cast<float *>(ptr);
+                ptr            += 4 * LIM_CAPTURE_SIZE * sizeof(float);
+                vCorrBuf        = reinterpret_cast<float *>(ptr);
+                ptr            += 4 * LIM_CAPTURE_SIZE * sizeof(float);
+                vCorrOut        = reinterpret_cast<float *>(ptr);
+                ptr            += 2 * LIM_CAPTURE_SIZE * sizeof(float);
+            }
+
+            for (size_t i=0; i<channels; ++i)
+            {
+                channel_t *c    = &vChannels[i];
+
+                c->vCapture     = reinterpret_cast<float *>(ptr);
+                if (deferred)
+                {
+                    ptr            += LIM_CAPTURE_SIZE * sizeof(float);
+                    c->vBuffer      = NULL;
+                }
+                else
+                {
+                    ptr            += LIM_BUF_SIZE * sizeof(float);
+                    c->vBuffer      = reinterpret_cast<float *>(ptr);
+                    ptr            += 2 * LIM_BUF_SIZE * sizeof(float);
+                }
+            }
+
+            nChannels       = channels;
+            bDeferred       = deferred;
+            bSync           = true;
+            reset_channels();
+
+            return true;
         }
 
         void LatencyDetector::destroy()
@@ -137,12 +193,46 @@ namespace lsp
                 delete [] pData;
                 pData = NULL;
             }
+            nChannels   = 0;
+            vChannels   = NULL;
             vChirp      = NULL;
             vAntiChirp  = NULL;
-            vCapture    = NULL;
-            vBuffer     = NULL;
             vChirpConv  = NULL;
             vConvBuf    = NULL;
+            vCorrConv   = NULL;
+            vCorrBuf    = NULL;
+            vCorrOut    = NULL;
+            bDeferred   = false;
+        }
+
+        void LatencyDetector::reset_channels()
+        {
+            for (size_t i=0; i<nChannels; ++i)
+            {
+                channel_t *c    = &vChannels[i];
+
+                c->fValue       = 0.0f;
+                c->nPosition    = 0;
+                c->nLatency     = 0;
+                c->fFraction    = 0.0f;
+                c->bDetected    = false;
+            }
+        }
+
+        static float peak_fraction(const float *buf, size_t position, size_t count)
+        {
+            if ((position <= 0) || ((position + 1) >= count))
+                return 0.0f;
+
+            // Vertex of the parabola passing through the peak and its neighbours
+            float a         = buf[position - 1];
+            float b         = buf[position];
+            float c         = buf[position + 1];
+            float d         = a - 2.0f * b + c;
+            if (d == 0.0f)
+                return 0.0f;
+
+            return lsp_limit(0.5f * (a - c) / d, -0.5f, 0.5f);
         }
 
         void LatencyDetector::update_settings()
@@ -260,11 +350,26 @@ namespace lsp
             sOutputProcessor.nPause         = seconds_to_samples(nSampleRate, sOutputProcessor.fPause);
             sInputProcessor.nDetect         = sChirpSystem.nDuration + seconds_to_samples(nSampleRate, sInputProcessor.fDetect);
 
+            if (bDeferred)
+            {
+                // Prepare the anti-chirp image of the FFT size that covers the whole capture
+                sInputProcessor.nCapture        = lsp_min(sInputProcessor.nDetect, size_t(LIM_CAPTURE_SIZE));
+                size_t half                     = lsp_max(sInputProcessor.nCapture, sChirpSystem.nLength);
+                sInputProcessor.nCorrRank       = 1;
+                while ((size_t(1) << (sInputProcessor.nCorrRank - 1)) < half)
+                    ++sInputProcessor.nCorrRank;
+
+                half                            = size_t(1) << (sInputProcessor.nCorrRank - 1);
+                dsp::copy(vCorrOut, vAntiChirp, sChirpSystem.nLength);
+                dsp::fill_zero(&vCorrOut[sChirpSystem.nLength], half - sChirpSystem.nLength);
+                dsp::fastconv_parse(vCorrConv, vCorrOut, sInputProcessor.nCorrRank);
+            }
+
             // Mark synced
             bSync = false;
         }
 
-        void LatencyDetector::detect_peak(float *buf, size_t count)
+        void LatencyDetector::detect_peak(channel_t *c, float *buf, size_t count)
         {
             // Scan trough and update the highest absolute peak recorded.
             // If the delta between the last highest peak recorded and the previous
@@ -274,84 +379,188 @@ namespace lsp
             size_t position     = dsp::abs_max_index(buf, count);
             float value         = sChirpSystem.fConvScale * fabs(buf[position]);
 
-            if ((value > sPeakDetector.fAbsThreshold) && (value > sPeakDetector.fValue))
+            if ((value > sPeakDetector.fAbsThreshold) && (value > c->fValue))
             {
-                float delta                 = value - sPeakDetector.fValue;
-                sPeakDetector.fValue        = value;
-                sPeakDetector.nPosition     = position + sInputProcessor.nDetectCounter - sChirpSystem.nLength;
+                float delta                 = value - c->fValue;
+                c->fValue                   = value;
+                c->nPosition                = position + sInputProcessor.nDetectCounter - sChirpSystem.nLength;
 
-                nLatency = sPeakDetector.nPosition - sPeakDetector.nTimeOrigin;
+                c->nLatency                 = c->nPosition - sPeakDetector.nTimeOrigin;
+                c->fFraction                = peak_fraction(buf, position, count);
 
                 // Early detection
-                if ((nLatency >= 0) && (delta > sPeakDetector.fPeakThreshold))
-                {
-                    bLatencyDetected            = true;
-                    sInputProcessor.nState      = IP_BYPASS;
-                    sOutputProcessor.nState     = OP_FADEIN;
-                    sInputProcessor.ig_stop     = sInputProcessor.ig_time;
-                    bCycleComplete              = true;
-                }
+                if ((c->nLatency >= 0) && (delta > sPeakDetector.fPeakThreshold))
+                    c->bDetected                = true;
             }
         }
 
+        void LatencyDetector::correlate_capture()
+        {
+            size_t rank         = sInputProcessor.nCorrRank;
+            size_t length       = size_t(1) << rank;
+            bool detected       = true;
+
+            for (size_t i=0; i<nChannels; ++i)
+            {
+                channel_t *c        = &vChannels[i];
+
+                // Compute the cross-correlation of the whole capture with the chirp
+                dsp::fill_zero(vCorrOut, length);
+                dsp::fastconv_parse_apply(vCorrOut, vCorrBuf, vCorrConv, c->vCapture, rank);
+
+                // Find the highest peak of the captured part
+                size_t position     = dsp::abs_max_index(vCorrOut, sInputProcessor.nCapture);
+                c->fValue           = sChirpSystem.fConvScale * fabs(vCorrOut[position]);
+                c->nPosition        = position;
+                c->nLatency         = c->nPosition - sPeakDetector.nTimeOrigin;
+                c->fFraction        = peak_fraction(vCorrOut, position, length);
+                c->bDetected        = (c->fValue > sPeakDetector.fAbsThreshold) && (c->nLatency >= 0);
+
+                detected            = detected && c->bDetected;
+            }
+
+            bLatencyDetected    = detected;
+        }
+
+        void LatencyDetector::complete_cycle()
+        {
+            sInputProcessor.nState      = IP_BYPASS;
+            sOutputProcessor.nState     = OP_FADEIN;
+            sInputProcessor.ig_stop     = sInputProcessor.ig_time;
+            bCycleComplete              = true;
+        }
+
         void LatencyDetector::process_in(float *dst, const float *src, size_t count)
+        {
+            if (nChannels <= 1)
+            {
+                process_in(&dst, &src, count);
+                return;
+            }
+
+            float **vdst        = reinterpret_cast<float **>(alloca(sizeof(float *) * nChannels));
+            const float **vsrc  = reinterpret_cast<const float **>(alloca(sizeof(float *) * nChannels));
+            for (size_t i=0; i<nChannels; ++i)
+            {
+                vdst[i]             = NULL;
+                vsrc[i]             = NULL;
+            }
+            vdst[0]             = dst;
+            vsrc[0]             = src;
+
+            process_in(vdst, vsrc, count);
+        }
+
+        void LatencyDetector::process_in(float * const *dst, const float * const *src, size_t count)
         {
             if (bSync)
                 update_settings();
 
-            while (count > 0)
+            for (size_t offset=0; offset < count; )
             {
                 switch (sInputProcessor.nState)
                 {
                     case IP_DETECT:
                     {
-                        // Fill-in capture buffer
+                        if (bDeferred)
+                        {
+                            // Capture the whole response and correlate it at once
+                            size_t to_do        = lsp_min(sInputProcessor.nCapture - sInputProcessor.nDetectCounter, count - offset);
+                            for (size_t i=0; i<nChannels; ++i)
+                            {
+                                float *capture      = &vChannels[i].vCapture[sInputProcessor.nDetectCounter];
+                                if (src[i] != NULL)
+                                    dsp::copy(capture, &src[i][offset], to_do);
+                                else
+                                    dsp::fill_zero(capture, to_do);
+                            }
+
+                            sInputProcessor.nDetectCounter      += to_do;
+                            sInputProcessor.ig_time             += to_do;
+                            offset                              += to_do;
+
+                            if (sInputProcessor.nDetectCounter >= sInputProcessor.nCapture)
+                            {
+                                correlate_capture();
+                                complete_cycle();
+                            }
+                            break;
+                        }
+
+                        // Fill-in capture buffers of all channels
                         size_t captureIdx   = sInputProcessor.nDetectCounter % sChirpSystem.nLength;
-                        size_t to_do        = sChirpSystem.nLength - captureIdx;
-                        if (to_do > count)
-                            to_do       = count;
+                        size_t to_do        = lsp_min(sChirpSystem.nLength - captureIdx, count - offset);
 
-                        dsp::copy(&vCapture[captureIdx], src, to_do);
+                        for (size_t i=0; i<nChannels; ++i)
+                        {
+                            float *capture      = &vChannels[i].vCapture[captureIdx];
+                            if (src[i] != NULL)
+                                dsp::copy(capture, &src[i][offset], to_do);
+                            else
+                                dsp::fill_zero(capture, to_do);
+                        }
 
                         sInputProcessor.nDetectCounter      += to_do;
                         sInputProcessor.ig_time             += to_do;
-                        dst                                 += to_do;
-                        src                                 += to_do;
-                        count                               -= to_do;
+                        offset                              += to_do;
 
                         if ((sInputProcessor.nDetectCounter % sChirpSystem.nLength) == 0)
                         {
-                            // Do the convolution
-                            dsp::fastconv_parse_apply(vBuffer, vConvBuf, vChirpConv, vCapture, sChirpSystem.nFftRank+1);
+                            // Correlate each channel with the chirp, the channels with detected latency are skipped
+                            bool detected       = true;
+                            for (size_t i=0; i<nChannels; ++i)
+                            {
+                                channel_t *c        = &vChannels[i];
+                                if (c->bDetected)
+                                    continue;
 
-                            detect_peak(vBuffer, sChirpSystem.nLength);
+                                // Do the convolution
+                                dsp::fastconv_parse_apply(c->vBuffer, vConvBuf, vChirpConv, c->vCapture, sChirpSystem.nFftRank+1);
 
-                            // Do post-actions after processing: shift convolution buffer to the chirp system length
-                            dsp::move(vBuffer, &vBuffer[sChirpSystem.nLength], sChirpSystem.nLength);
+                                detect_peak(c, c->vBuffer, sChirpSystem.nLength);
+
+                                // Do post-actions after processing: shift convolution buffer to the chirp system length
+                                dsp::move(c->vBuffer, &c->vBuffer[sChirpSystem.nLength], sChirpSystem.nLength);
+
+                                detected            = detected && c->bDetected;
+                            }
+
+                            // Early detection when latencies of all channels have been detected
+                            if (detected)
+                            {
+                                bLatencyDetected    = true;
+                                complete_cycle();
+                            }
                         }
 
                         // Force Processor transitions after the time allowed for detection have elapsed
                         if (sInputProcessor.nDetectCounter >= sInputProcessor.nDetect)
-                        {
-                            sInputProcessor.nState      = IP_BYPASS;
-                            sOutputProcessor.nState     = OP_FADEIN;
-                            sInputProcessor.ig_stop     = sInputProcessor.ig_time;
-                            bCycleComplete              = true;
-                        }
+                            complete_cycle();
 
                         break;
                     }
 
                     case IP_WAIT:
-                        sInputProcessor.ig_time += count;
-                        dsp::copy(dst, src, count);
-                        count = 0;
-                        break;
                     case IP_BYPASS:
                     default:
-                        dsp::copy(dst, src, count);
-                        count = 0;
+                    {
+                        size_t to_do        = count - offset;
+                        if (sInputProcessor.nState == IP_WAIT)
+                            sInputProcessor.ig_time += to_do;
+
+                        for (size_t i=0; i<nChannels; ++i)
+                        {
+                            if (dst[i] == NULL)
+                                continue;
+                            if (src[i] != NULL)
+                                dsp::copy(&dst[i][offset], &src[i][offset], to_do);
+                            else
+                                dsp::fill_zero(&dst[i][offset], to_do);
+                        }
+
+                        offset              = count;
                         break;
+                    }
                 }
             }
         }
@@ -403,15 +612,23 @@ namespace lsp
                             sInputProcessor.nState          = IP_DETECT;
                             sOutputProcessor.og_start       = sOutputProcessor.og_time;
                             sInputProcessor.ig_start        = sInputProcessor.ig_time;
-                            sPeakDetector.fValue            = 0.0f;
-                            sPeakDetector.nPosition         = 0;
                             // Correcting the apparent latency centre (nLength - 1) with the actually recorded samples:
                             sPeakDetector.nTimeOrigin       = sChirpSystem.nLength - (sInputProcessor.ig_start - sOutputProcessor.og_start) - 1;
-                            sPeakDetector.bDetected         = false;
                             bLatencyDetected                = false;
-                            nLatency                        = 0;
 
-                            dsp::fill_zero(vBuffer, 2 * LIM_BUF_SIZE);
+                            reset_channels();
+                            for (size_t i=0; i<nChannels; ++i)
+                            {
+                                channel_t *c    = &vChannels[i];
+                                if (bDeferred)
+                                {
+                                    // Zero padding of the capture for the correlation
+                                    size_t half     = size_t(1) << (sInputProcessor.nCorrRank - 1);
+                                    dsp::fill_zero(&c->vCapture[sInputProcessor.nCapture], half - sInputProcessor.nCapture);
+                                }
+                                else
+                                    dsp::fill_zero(c->vBuffer, 2 * LIM_BUF_SIZE);
+                            }
                         }
                         break;
                     }
@@ -480,12 +697,12 @@ namespace lsp
             return samples_to_seconds(nSampleRate, sChirpSystem.nDuration);
         }
 
-        float LatencyDetector::get_latency_seconds() const
+        float LatencyDetector::get_latency_seconds(size_t channel) const
         {
-            if (!bLatencyDetected)
+            if ((channel >= nChannels) || (!vChannels[channel].bDetected))
                 return 0.0f;
 
-            return samples_to_seconds(nSampleRate, nLatency);
+            return samples_to_seconds(nSampleRate, vChannels[channel].nLatency + vChannels[channel].fFraction);
         }
 
         void LatencyDetector::set_abs_threshold(float threshold)
@@ -529,14 +746,11 @@ namespace lsp
             sOutputProcessor.nPauseCounter      = 0;
             sOutputProcessor.nEmitCounter       = 0;
 
-            sPeakDetector.fValue                = 0.0f;
-            sPeakDetector.nPosition             = 0;
             sPeakDetector.nTimeOrigin           = 0;
-            sPeakDetector.bDetected             = false;
 
             bCycleComplete                      = false;
             bLatencyDetected                    = false;
-            nLatency                            = 0;
+            reset_channels();
         }
 
         void LatencyDetector::reset_capture()
@@ -553,14 +767,11 @@ namespace lsp
             sOutputProcessor.nPauseCounter      = 0;
             sOutputProcessor.nEmitCounter       = 0;
 
-            sPeakDetector.fValue                = 0.0f;
-            sPeakDetector.nPosition             = 0;
             sPeakDetector.nTimeOrigin           = 0;
-            sPeakDetector.bDetected             = false;
 
             bCycleComplete                      = false;
             bLatencyDetected                    = false;
-            nLatency                            = 0;
+            reset_channels();
         }
 
         void LatencyDetector::dump(IStateDumper *v) const
@@ -596,6 +807,8 @@ namespace lsp
                 v->write("fDetect", p->fDetect);
                 v->write("nDetect", p->nDetect);
                 v->write("nDetectCounter", p->nDetectCounter);
+                v->write("nCapture", p->nCapture);
+                v->write("nCorrRank", p->nCorrRank);
             }
             v->end_object();
 
@@ -623,23 +836,41 @@ namespace lsp
 
                 v->write("fAbsThreshold", p->fAbsThreshold);
                 v->write("fPeakThreshold", p->fPeakThreshold);
-                v->write("fValue", p->fValue);
-                v->write("nPosition", p->nPosition);
                 v->write("nTimeOrigin", p->nTimeOrigin);
-                v->write("bDetected", p->bDetected);
             }
             v->end_object();
 
+            v->write("nChannels", nChannels);
+            v->begin_array("vChannels", vChannels, nChannels);
+            for (size_t i=0; i<nChannels; ++i)
+            {
+                const channel_t *c = &vChannels[i];
+
+                v->begin_object(c, sizeof(channel_t));
+                {
+                    v->write("vCapture", c->vCapture);
+                    v->write("vBuffer", c->vBuffer);
+                    v->write("fValue", c->fValue);
+                    v->write("nPosition", c->nPosition);
+                    v->write("nLatency", c->nLatency);
+                    v->write("fFraction", c->fFraction);
+                    v->write("bDetected", c->bDetected);
+                }
+                v->end_object();
+            }
+            v->end_array();
+
             v->write("vChirp", vChirp);
             v->write("vAntiChirp", vAntiChirp);
-            v->write("vCapture", vCapture);
-            v->write("vBuffer", vBuffer);
             v->write("vChirpConv", vChirpConv);
             v->write("vConvBuf", vConvBuf);
+            v->write("vCorrConv", vCorrConv);
+            v->write("vCorrBuf", vCorrBuf);
+            v->write("vCorrOut", vCorrOut);
             v->write("pData", pData);
+            v->write("bDeferred", bDeferred);
             v->write("bCycleComplete", bCycleComplete);
             v->write("bLatencyDetected", bLatencyDetected);
-            v->write("nLatency", nLatency);
             v->write("bSync", bSync);
         }
     }
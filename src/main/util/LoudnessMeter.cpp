@@ -0,0 +1,483 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/dsp-units/util/LoudnessMeter.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define LOUDNESS_BUF_SIZE           0x400
+#define LOUDNESS_OFFSET             -0.691      /* Offset of the loudness scale, dB */
+
+namespace lsp
+{
+    namespace dspu
+    {
+        static inline float energy_to_lufs(double e)
+        {
+            if (e <= 0.0)
+                return LOUDNESS_MIN;
+            return lsp_max(float(LOUDNESS_OFFSET + 10.0 * log10(e)), LOUDNESS_MIN);
+        }
+
+        static inline size_t lufs_to_bin(float l)
+        {
+            ssize_t bin     = (l - LOUDNESS_MIN) / LOUDNESS_HIST_STEP;
+            return lsp_limit(bin, ssize_t(0), ssize_t(LOUDNESS_HIST_BINS - 1));
+        }
+
+        static inline float bin_to_lufs(size_t bin)
+        {
+            return LOUDNESS_MIN + (bin + 0.5f) * LOUDNESS_HIST_STEP;
+        }
+
+        LoudnessMeter::LoudnessMeter()
+        {
+            construct();
+        }
+
+        LoudnessMeter::~LoudnessMeter()
+        {
+            destroy();
+        }
+
+        void LoudnessMeter::construct()
+        {
+            sBank.construct();
+
+            sIntegrated.vEnergy = NULL;
+            sIntegrated.vCount  = NULL;
+            sIntegrated.fEnergy = 0.0;
+            sIntegrated.nCount  = 0;
+            sRange.vEnergy      = NULL;
+            sRange.vCount       = NULL;
+            sRange.fEnergy      = 0.0;
+            sRange.nCount       = 0;
+
+            nChannels           = 0;
+            nSampleRate         = 0;
+            nBlockSize          = 0;
+            nBlockOffset        = 0;
+            nBlocks             = 0;
+            nHead               = 0;
+            fBlockEnergy        = 0.0;
+            fMomentarySum       = 0.0;
+            fShortTermSum       = 0.0;
+            fMomentary          = LOUDNESS_MIN;
+            fShortTerm          = LOUDNESS_MIN;
+            fIntegrated         = LOUDNESS_MIN;
+            fRange              = 0.0f;
+            bUpdate             = true;
+
+            vRing               = NULL;
+            vWeights            = NULL;
+            vOut                = NULL;
+            vIn                 = NULL;
+            vBuffer             = NULL;
+            pData               = NULL;
+        }
+
+        bool LoudnessMeter::init(size_t channels)
+        {
+            destroy();
+
+            if (!sBank.init(channels, LOUDNESS_K_FILTERS))
+                return false;
+
+            size_t szof_ring    = align_size(sizeof(double) * LOUDNESS_SHORT_TERM_BLOCKS, DEFAULT_ALIGN);
+            size_t szof_energy  = align_size(sizeof(double) * LOUDNESS_HIST_BINS, DEFAULT_ALIGN);
+            size_t szof_count   = align_size(sizeof(uint32_t) * LOUDNESS_HIST_BINS, DEFAULT_ALIGN);
+            size_t szof_weights = align_size(sizeof(float) * channels, DEFAULT_ALIGN);
+            size_t szof_ptrs    = align_size(sizeof(float *) * channels, DEFAULT_ALIGN);
+            size_t szof_buf     = sizeof(float) * LOUDNESS_BUF_SIZE * channels;
+            size_t to_alloc     =
+                szof_ring +
+                (szof_energy + szof_count) * 2 +
+                szof_weights +
+                szof_ptrs * 2 +
+                szof_buf;
+
+            uint8_t *data       = NULL;
+            uint8_t *ptr        = alloc_aligned<uint8_t>(data, to_alloc, DEFAULT_ALIGN);
+            if (ptr == NULL)
+            {
+                sBank.destroy();
+                return false;
+            }
+
+            vRing               = reinterpret_cast<double *>(ptr);
+            ptr                += szof_ring;
+            sIntegrated.vEnergy = reinterpret_cast<double *>(ptr);
+            ptr                += szof_energy;
+            sIntegrated.vCount  = reinterpret_cast<uint32_t *>(ptr);
+            ptr                += szof_count;
+            sRange.vEnergy      = reinterpret_cast<double *>(ptr);
+            ptr                += szof_energy;
+            sRange.vCount       = reinterpret_cast<uint32_t *>(ptr);
+            ptr                += szof_count;
+            vWeights            = reinterpret_cast<float *>(ptr);
+            ptr                += szof_weights;
+            vOut                = reinterpret_cast<float **>(ptr);
+            ptr                += szof_ptrs;
+            vIn                 = reinterpret_cast<const float **>(ptr);
+            ptr                += szof_ptrs;
+            vBuffer             = reinterpret_cast<float *>(ptr);
+            ptr                += szof_buf;
+
+            for (size_t i=0; i<channels; ++i)
+            {
+                vWeights[i]         = 1.0f;
+                vOut[i]             = &vBuffer[i * LOUDNESS_BUF_SIZE];
+                vIn[i]              = NULL;
+            }
+
+            nChannels           = channels;
+            bUpdate             = true;
+            pData               = data;
+
+            reset();
+
+            return true;
+        }
+
+        void LoudnessMeter::destroy()
+        {
+            sBank.destroy();
+            free_aligned(pData);
+
+            sIntegrated.vEnergy = NULL;
+            sIntegrated.vCount  = NULL;
+            sRange.vEnergy      = NULL;
+            sRange.vCount       = NULL;
+            vRing               = NULL;
+            vWeights            = NULL;
+            vOut                = NULL;
+            vIn                 = NULL;
+            vBuffer             = NULL;
+            nChannels           = 0;
+        }
+
+        void LoudnessMeter::set_sample_rate(size_t sr)
+        {
+            if (nSampleRate == sr)
+                return;
+
+            nSampleRate         = sr;
+            nBlockSize          = (sr + 5) / 10;
+            bUpdate             = true;
+
+            reset();
+        }
+
+        void LoudnessMeter::set_weight(size_t channel, float weight)
+        {
+            if (channel < nChannels)
+                vWeights[channel]   = lsp_max(weight, 0.0f);
+        }
+
+        void LoudnessMeter::hist_clear(histogram_t *h)
+        {
+            if (h->vEnergy != NULL)
+            {
+                for (size_t i=0; i<LOUDNESS_HIST_BINS; ++i)
+                {
+                    h->vEnergy[i]       = 0.0;
+                    h->vCount[i]        = 0;
+                }
+            }
+            h->fEnergy          = 0.0;
+            h->nCount           = 0;
+        }
+
+        void LoudnessMeter::hist_add(histogram_t *h, double energy, float loudness)
+        {
+            size_t bin          = lufs_to_bin(loudness);
+            h->vEnergy[bin]    += energy;
+            h->vCount[bin]     ++;
+            h->fEnergy         += energy;
+            h->nCount          ++;
+        }
+
+        double LoudnessMeter::hist_gate(const histogram_t *h, float gate, size_t *first, size_t *count)
+        {
+            *first              = 0;
+            *count              = 0;
+            if (h->nCount <= 0)
+                return 0.0;
+
+            // The relative gate is set below the loudness of all blocks above the absolute gate.
+            // The bin containing the gate is included entirely, this limits the error to the
+            // histogram resolution
+            size_t bin          = lufs_to_bin(energy_to_lufs(h->fEnergy / h->nCount) - gate);
+            double energy       = 0.0;
+            size_t n            = 0;
+            for (size_t i=bin; i<LOUDNESS_HIST_BINS; ++i)
+            {
+                energy             += h->vEnergy[i];
+                n                  += h->vCount[i];
+            }
+
+            *first              = bin;
+            *count              = n;
+            return energy;
+        }
+
+        void LoudnessMeter::reset()
+        {
+            sBank.reset();
+            hist_clear(&sIntegrated);
+            hist_clear(&sRange);
+
+            if (vRing != NULL)
+            {
+                for (size_t i=0; i<LOUDNESS_SHORT_TERM_BLOCKS; ++i)
+                    vRing[i]            = 0.0;
+            }
+
+            nBlockOffset        = 0;
+            nBlocks             = 0;
+            nHead               = 0;
+            fBlockEnergy        = 0.0;
+            fMomentarySum       = 0.0;
+            fShortTermSum       = 0.0;
+            fMomentary          = LOUDNESS_MIN;
+            fShortTerm          = LOUDNESS_MIN;
+            fIntegrated         = LOUDNESS_MIN;
+            fRange              = 0.0f;
+        }
+
+        void LoudnessMeter::k_weighting(dsp::biquad_x1_t *f, size_t sr)
+        {
+            // K-weighting filter according to ITU-R BS.1770-4, the coefficients are
+            // re-computed for the actual sample rate from the analog prototypes
+            double fs           = sr;
+            double k, q, a0;
+
+            // Stage 1: high-shelf pre-filter modelling the acoustic effect of the head
+            double vh           = pow(10.0, 3.999843853973347 / 20.0);
+            double vb           = pow(vh, 0.4996667741545416);
+            k                   = tan(M_PI * 1681.974450955533 / fs);
+            q                   = 0.7071752369554196;
+            a0                  = 1.0 + k/q + k*k;
+
+            f[0].b0             = (vh + vb*k/q + k*k) / a0;
+            f[0].b1             = 2.0 * (k*k - vh) / a0;
+            f[0].b2             = (vh - vb*k/q + k*k) / a0;
+            f[0].a1             = -2.0 * (k*k - 1.0) / a0;
+            f[0].a2             = -(1.0 - k/q + k*k) / a0;
+            f[0].p0             = 0.0f;
+            f[0].p1             = 0.0f;
+            f[0].p2             = 0.0f;
+
+            // Stage 2: revised low-frequency B-curve (RLB) high-pass filter
+            k                   = tan(M_PI * 38.13547087602444 / fs);
+            q                   = 0.5003270373238773;
+            a0                  = 1.0 + k/q + k*k;
+
+            f[1].b0             = 1.0f;
+            f[1].b1             = -2.0f;
+            f[1].b2             = 1.0f;
+            f[1].a1             = -2.0 * (k*k - 1.0) / a0;
+            f[1].a2             = -(1.0 - k/q + k*k) / a0;
+            f[1].p0             = 0.0f;
+            f[1].p1             = 0.0f;
+            f[1].p2             = 0.0f;
+        }
+
+        void LoudnessMeter::update_settings()
+        {
+            if (!bUpdate)
+                return;
+            bUpdate             = false;
+
+            dsp::biquad_x1_t k[LOUDNESS_K_FILTERS];
+            k_weighting(k, nSampleRate);
+
+            sBank.begin();
+            for (size_t i=0; i<LOUDNESS_K_FILTERS; ++i)
+            {
+                dsp::biquad_x1_t *f = sBank.add_chain();
+                if (f != NULL)
+                    *f                  = k[i];
+            }
+            sBank.end(true);
+        }
+
+        void LoudnessMeter::complete_block()
+        {
+            double e            = fBlockEnergy / nBlockSize;
+            fBlockEnergy        = 0.0;
+            nBlockOffset        = 0;
+
+            // Update the running sums of the windows
+            double old_s        = vRing[nHead];
+            double old_m        = vRing[(nHead + LOUDNESS_SHORT_TERM_BLOCKS - LOUDNESS_MOMENTARY_BLOCKS) % LOUDNESS_SHORT_TERM_BLOCKS];
+            vRing[nHead]        = e;
+            nHead               = (nHead + 1) % LOUDNESS_SHORT_TERM_BLOCKS;
+            ++nBlocks;
+
+            if (nHead == 0)
+            {
+                // Re-compute the sums once per ring cycle to cancel the accumulated rounding error
+                fMomentarySum       = 0.0;
+                fShortTermSum       = 0.0;
+                for (size_t i=0; i<LOUDNESS_SHORT_TERM_BLOCKS; ++i)
+                    fShortTermSum      += vRing[i];
+                for (size_t i=LOUDNESS_SHORT_TERM_BLOCKS - LOUDNESS_MOMENTARY_BLOCKS; i<LOUDNESS_SHORT_TERM_BLOCKS; ++i)
+                    fMomentarySum      += vRing[i];
+            }
+            else
+            {
+                fMomentarySum       = lsp_max(fMomentarySum + e - old_m, 0.0);
+                fShortTermSum       = lsp_max(fShortTermSum + e - old_s, 0.0);
+            }
+
+            double zm           = fMomentarySum / LOUDNESS_MOMENTARY_BLOCKS;
+            double zs           = fShortTermSum / LOUDNESS_SHORT_TERM_BLOCKS;
+            fMomentary          = energy_to_lufs(zm);
+            fShortTerm          = energy_to_lufs(zs);
+
+            // Gating blocks overlap by 75% for integrated loudness, short-term values are
+            // sampled at 10 Hz for the loudness range, both are gated at -70 LUFS
+            if ((nBlocks >= LOUDNESS_MOMENTARY_BLOCKS) && (fMomentary > LOUDNESS_MIN))
+                hist_add(&sIntegrated, zm, fMomentary);
+            if ((nBlocks >= LOUDNESS_SHORT_TERM_BLOCKS) && (fShortTerm > LOUDNESS_MIN))
+                hist_add(&sRange, zs, fShortTerm);
+
+            // Integrated loudness: relative gate at -10 LU
+            size_t first, count;
+            double energy       = hist_gate(&sIntegrated, 10.0f, &first, &count);
+            fIntegrated         = (count > 0) ? energy_to_lufs(energy / count) : LOUDNESS_MIN;
+
+            // Loudness range: relative gate at -20 LU, distance between 10% and 95% percentiles
+            hist_gate(&sRange, 20.0f, &first, &count);
+            if (count > 0)
+            {
+                size_t lo           = count / 10;
+                size_t hi           = (count * 95) / 100;
+                float l_lo          = bin_to_lufs(first);
+                float l_hi          = l_lo;
+                size_t acc          = 0;
+
+                for (size_t i=first; i<LOUDNESS_HIST_BINS; ++i)
+                {
+                    size_t prev         = acc;
+                    acc                += sRange.vCount[i];
+                    if ((prev <= lo) && (acc > lo))
+                        l_lo                = bin_to_lufs(i);
+                    if (acc > hi)
+                    {
+                        l_hi                = bin_to_lufs(i);
+                        break;
+                    }
+                }
+
+                fRange              = l_hi - l_lo;
+            }
+            else
+                fRange              = 0.0f;
+        }
+
+        void LoudnessMeter::process(const float * const *in, size_t samples)
+        {
+            if ((nBlockSize <= 0) || (nChannels <= 0))
+                return;
+
+            update_settings();
+
+            for (size_t offset=0; offset < samples; )
+            {
+                size_t to_do        = lsp_min(samples - offset, lsp_min(nBlockSize - nBlockOffset, size_t(LOUDNESS_BUF_SIZE)));
+
+                // Apply K-weighting to all channels at once
+                for (size_t i=0; i<nChannels; ++i)
+                    vIn[i]              = &in[i][offset];
+                sBank.process(vOut, vIn, to_do);
+
+                // Accumulate weighted energy of the sub-block
+                for (size_t i=0; i<nChannels; ++i)
+                {
+                    if (vWeights[i] > 0.0f)
+                        fBlockEnergy       += vWeights[i] * dsp::h_sqr_sum(vOut[i], to_do);
+                }
+
+                nBlockOffset       += to_do;
+                offset             += to_do;
+                if (nBlockOffset >= nBlockSize)
+                    complete_block();
+            }
+        }
+
+        void LoudnessMeter::append(const float *energy, size_t count)
+        {
+            if (nBlockSize <= 0)
+                return;
+
+            for (size_t i=0; i<count; ++i)
+            {
+                fBlockEnergy        = double(energy[i]) * nBlockSize;
+                complete_block();
+            }
+        }
+
+        void LoudnessMeter::dump_hist(IStateDumper *v, const char *name, const histogram_t *h)
+        {
+            v->begin_object(name, h, sizeof(histogram_t));
+            {
+                v->writev("vEnergy", h->vEnergy, LOUDNESS_HIST_BINS);
+                v->writev("vCount", h->vCount, LOUDNESS_HIST_BINS);
+                v->write("fEnergy", h->fEnergy);
+                v->write("nCount", h->nCount);
+            }
+            v->end_object();
+        }
+
+        void LoudnessMeter::dump(IStateDumper *v) const
+        {
+            v->write_object("sBank", &sBank);
+            dump_hist(v, "sIntegrated", &sIntegrated);
+            dump_hist(v, "sRange", &sRange);
+
+            v->write("nChannels", nChannels);
+            v->write("nSampleRate", nSampleRate);
+            v->write("nBlockSize", nBlockSize);
+            v->write("nBlockOffset", nBlockOffset);
+            v->write("nBlocks", nBlocks);
+            v->write("nHead", nHead);
+            v->write("fBlockEnergy", fBlockEnergy);
+            v->write("fMomentarySum", fMomentarySum);
+            v->write("fShortTermSum", fShortTermSum);
+            v->write("fMomentary", fMomentary);
+            v->write("fShortTerm", fShortTerm);
+            v->write("fIntegrated", fIntegrated);
+            v->write("fRange", fRange);
+            v->write("bUpdate", bUpdate);
+
+            v->writev("vRing", vRing, LOUDNESS_SHORT_TERM_BLOCKS);
+            v->writev("vWeights", vWeights, nChannels);
+            v->write("vOut", vOut);
+            v->write("vIn", vIn);
+            v->write("vBuffer", vBuffer);
+            v->write("pData", pData);
+        }
+    } /* namespace dspu */
+} /* namespace lsp */
@@ -0,0 +1,402 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/dsp-units/util/MLSResponseTaker.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/bits.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/stdlib.h>
+
+#define MIN_BITS        2
+#define MAX_BITS        24
+#define DFL_BITS        16
+
+namespace lsp
+{
+    namespace dspu
+    {
+        MLSResponseTaker::MLSResponseTaker()
+        {
+            construct();
+        }
+
+        MLSResponseTaker::~MLSResponseTaker()
+        {
+            destroy();
+        }
+
+        void MLSResponseTaker::construct()
+        {
+            sMLS.construct();
+
+            nMaxBits        = 0;
+            nBits           = DFL_BITS;
+            nLength         = 0;
+            nPeriods        = 1;
+            nLatency        = 0;
+            fAmplitude      = 1.0f;
+
+            nInState        = IP_BYPASS;
+            nInSkip         = 0;
+            nInTime         = 0;
+            nInPos          = 0;
+
+            nOutState       = OP_BYPASS;
+            nOutTime        = 0;
+            nOutPos         = 0;
+
+            vSequence       = NULL;
+            vInTag          = NULL;
+            vOutTag         = NULL;
+            vAverage        = NULL;
+            vTransform      = NULL;
+            pData           = NULL;
+
+            bCycleComplete  = false;
+            bSync           = true;
+        }
+
+        void MLSResponseTaker::destroy()
+        {
+            sMLS.destroy();
+
+            if (pData != NULL)
+            {
+                free_aligned(pData);
+                pData           = NULL;
+            }
+
+            vSequence       = NULL;
+            vInTag          = NULL;
+            vOutTag         = NULL;
+            vAverage        = NULL;
+            vTransform      = NULL;
+            nMaxBits        = 0;
+            nLength         = 0;
+        }
+
+        bool MLSResponseTaker::init(size_t max_bits)
+        {
+            max_bits        = lsp_limit(max_bits, size_t(MIN_BITS), size_t(MAX_BITS));
+
+            // Period length is 2^N - 1, the transform buffer is 2^N
+            size_t len      = (size_t(1) << max_bits);
+            size_t szof_f   = align_size(len * sizeof(float), DEFAULT_ALIGN);
+            size_t szof_t   = align_size(len * sizeof(uint32_t), DEFAULT_ALIGN);
+
+            uint8_t *data   = NULL;
+            uint8_t *ptr    = alloc_aligned<uint8_t>(data, szof_f * 3 + szof_t * 2);
+            if (ptr == NULL)
+                return false;
+
+            if (pData != NULL)
+                free_aligned(pData);
+
+            vSequence       = reinterpret_cast<float *>(ptr);
+            ptr            += szof_f;
+            vAverage        = reinterpret_cast<float *>(ptr);
+            ptr            += szof_f;
+            vTransform      = reinterpret_cast<float *>(ptr);
+            ptr            += szof_f;
+            vInTag          = reinterpret_cast<uint32_t *>(ptr);
+            ptr            += szof_t;
+            vOutTag         = reinterpret_cast<uint32_t *>(ptr);
+            ptr            += szof_t;
+            pData           = data;
+
+            nMaxBits        = max_bits;
+            nLength         = 0;
+            bSync           = true;
+
+            reset_capture();
+
+            return true;
+        }
+
+        void MLSResponseTaker::update_settings()
+        {
+            if (!bSync)
+                return;
+            bSync           = false;
+
+            // Any change of settings invalidates the capture
+            reset_capture();
+            if (pData == NULL)
+                return;
+
+            nBits           = lsp_limit(nBits, size_t(MIN_BITS), nMaxBits);
+            size_t length   = (size_t(1) << nBits) - 1;
+            if (length == nLength)
+                return;
+            nLength         = length;
+
+            // Generate one period of +1/-1 sequence, the generator returns to the initial state after the period
+            sMLS.set_n_bits(nBits);
+            sMLS.set_state(0);
+            sMLS.set_amplitude(1.0f);
+            sMLS.set_offset(0.0f);
+            sMLS.update_settings();
+            sMLS.process_overwrite(vSequence, nLength);
+
+            build_tags();
+        }
+
+        void MLSResponseTaker::build_tags()
+        {
+            const size_t len    = nLength;
+            const size_t bits   = nBits;
+            const float *seq    = vSequence;
+
+            // The input tag of sample n is formed by the N bits of the sequence starting at n,
+            // all tags are distinct and non-zero and enumerate the rows of the Hadamard matrix
+            uint32_t tag        = 0;
+            for (size_t b=0; b<bits; ++b)
+                if (seq[b] > 0.0f)
+                    tag            |= uint32_t(1) << b;
+            for (size_t n=0; n<len; ++n)
+            {
+                vInTag[n]       = tag;
+                tag           >>= 1;
+                if (seq[(n + bits) % len] > 0.0f)
+                    tag            |= uint32_t(1) << (bits - 1);
+            }
+
+            // Positions of the single-bit tags give the column permutation
+            uint32_t pos[MAX_BITS];
+            for (size_t n=0; n<len; ++n)
+            {
+                tag             = vInTag[n];
+                if (!(tag & (tag - 1)))
+                    pos[int_log2(tag)]  = uint32_t(n);
+            }
+
+            // The output tag of the response sample j is formed by the sequence bits at pos[b] - j
+            for (size_t j=0; j<len; ++j)
+            {
+                size_t k        = (len - j) % len;
+                tag             = 0;
+                for (size_t b=0; b<bits; ++b)
+                {
+                    size_t idx      = pos[b] + k;
+                    if (idx >= len)
+                        idx            -= len;
+                    if (seq[idx] > 0.0f)
+                        tag            |= uint32_t(1) << b;
+                }
+                vOutTag[j]      = tag;
+            }
+        }
+
+        void MLSResponseTaker::hadamard(float *x, size_t bits)
+        {
+            const size_t len    = size_t(1) << bits;
+
+            for (size_t h=1; h<len; h <<= 1)
+            {
+                for (size_t i=0; i<len; i += (h << 1))
+                {
+                    float *a        = &x[i];
+                    float *b        = &x[i + h];
+                    for (size_t j=0; j<h; ++j)
+                    {
+                        float s         = a[j];
+                        float d         = b[j];
+                        a[j]            = s + d;
+                        b[j]            = s - d;
+                    }
+                }
+            }
+        }
+
+        status_t MLSResponseTaker::deconvolve(float *dst, size_t count)
+        {
+            if (dst == NULL)
+                return STATUS_BAD_ARGUMENTS;
+            if ((!bCycleComplete) || (nLength == 0))
+                return STATUS_BAD_STATE;
+
+            const size_t len    = nLength;
+
+            // Permute the averaged period into the Hadamard order, the zero row is not used by the sequence
+            vTransform[0]       = 0.0f;
+            for (size_t n=0; n<len; ++n)
+                vTransform[vInTag[n]]   = vAverage[n];
+            hadamard(vTransform, nBits);
+
+            // The zero row of the transform is the plain sum of the period,
+            // the +1/-1 sequence correlates with the sum minus the transform
+            const float sum     = vTransform[0];
+            const float k       = 1.0f / (float(len + 1) * float(nPeriods) * fAmplitude);
+            size_t n            = lsp_min(count, len);
+            for (size_t j=0; j<n; ++j)
+                dst[j]          = (sum - vTransform[vOutTag[j]]) * k;
+            if (count > n)
+                dsp::fill_zero(&dst[n], count - n);
+
+            return STATUS_OK;
+        }
+
+        void MLSResponseTaker::start_capture()
+        {
+            if ((bSync) || (nLength == 0))
+                return;
+
+            dsp::fill_zero(vAverage, nLength);
+
+            nInState        = IP_WAIT;
+            nInSkip         = nLatency + nLength;
+            nInTime         = 0;
+            nInPos          = 0;
+
+            nOutState       = OP_EMIT;
+            nOutTime        = 0;
+            nOutPos         = 0;
+
+            bCycleComplete  = false;
+        }
+
+        void MLSResponseTaker::reset_capture()
+        {
+            nInState        = IP_BYPASS;
+            nInSkip         = 0;
+            nInTime         = 0;
+            nInPos          = 0;
+
+            nOutState       = OP_BYPASS;
+            nOutTime        = 0;
+            nOutPos         = 0;
+
+            bCycleComplete  = false;
+        }
+
+        static void copy_or_zero(float *dst, const float *src, size_t count)
+        {
+            if (dst == NULL)
+                return;
+            if (src != NULL)
+                dsp::copy(dst, src, count);
+            else
+                dsp::fill_zero(dst, count);
+        }
+
+        void MLSResponseTaker::process_in(float *dst, const float *src, size_t count)
+        {
+            for (size_t offset=0; offset < count; )
+            {
+                size_t to_do        = count - offset;
+
+                switch (nInState)
+                {
+                    case IP_WAIT:
+                        to_do               = lsp_min(to_do, nInSkip);
+                        nInSkip            -= to_do;
+                        if (nInSkip == 0)
+                            nInState            = IP_ACQUIRE;
+                        break;
+
+                    case IP_ACQUIRE:
+                    {
+                        // Sum the periods sample by sample
+                        to_do               = lsp_min(to_do, lsp_min(nLength - nInPos, nLength * nPeriods - nInTime));
+                        if (src != NULL)
+                            dsp::add2(&vAverage[nInPos], &src[offset], to_do);
+
+                        nInTime            += to_do;
+                        nInPos             += to_do;
+                        if (nInPos >= nLength)
+                            nInPos              = 0;
+                        if (nInTime >= nLength * nPeriods)
+                        {
+                            nInState            = IP_BYPASS;
+                            bCycleComplete      = true;
+                        }
+                        break;
+                    }
+
+                    case IP_BYPASS:
+                    default:
+                        break;
+                }
+
+                if (dst != NULL)
+                    copy_or_zero(&dst[offset], (src != NULL) ? &src[offset] : NULL, to_do);
+                offset             += to_do;
+            }
+        }
+
+        void MLSResponseTaker::process_out(float *dst, const float *src, size_t count)
+        {
+            for (size_t offset=0; offset < count; )
+            {
+                size_t to_do        = count - offset;
+
+                if (nOutState == OP_EMIT)
+                {
+                    to_do               = lsp_min(to_do, lsp_min(nLength - nOutPos, get_duration() - nOutTime));
+                    if (dst != NULL)
+                        dsp::mul_k3(&dst[offset], &vSequence[nOutPos], fAmplitude, to_do);
+
+                    nOutTime           += to_do;
+                    nOutPos            += to_do;
+                    if (nOutPos >= nLength)
+                        nOutPos             = 0;
+                    if (nOutTime >= get_duration())
+                        nOutState           = OP_BYPASS;
+                }
+                else if (dst != NULL)
+                    copy_or_zero(&dst[offset], (src != NULL) ? &src[offset] : NULL, to_do);
+
+                offset             += to_do;
+            }
+        }
+
+        void MLSResponseTaker::dump(IStateDumper *v) const
+        {
+            v->write_object("sMLS", &sMLS);
+
+            v->write("nMaxBits", nMaxBits);
+            v->write("nBits", nBits);
+            v->write("nLength", nLength);
+            v->write("nPeriods", nPeriods);
+            v->write("nLatency", nLatency);
+            v->write("fAmplitude", fAmplitude);
+
+            v->write("nInState", nInState);
+            v->write("nInSkip", nInSkip);
+            v->write("nInTime", nInTime);
+            v->write("nInPos", nInPos);
+
+            v->write("nOutState", nOutState);
+            v->write("nOutTime", nOutTime);
+            v->write("nOutPos", nOutPos);
+
+            v->write("vSequence", vSequence);
+            v->write("vInTag", vInTag);
+            v->write("vOutTag", vOutTag);
+            v->write("vAverage", vAverage);
+            v->write("vTransform", vTransform);
+            v->write("pData", pData);
+
+            v->write("bCycleComplete", bCycleComplete);
+            v->write("bSync", bSync);
+        }
+    }
+}
@@ -21,6 +21,7 @@
 
 #include <lsp-plug.in/dsp-units/util/MeterGraph.h>
 #include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
 
 namespace lsp
 {
@@ -43,148 +44,245 @@ namespace lsp
             fCurrent    = 0.0f;
             nCount      = 0;
             nPeriod     = 1;
-            bMinimize   = false;
+            enMethod    = MM_MAXIMUM;
+            vLevels     = NULL;
+            nLevels     = 1;
         }
 
         void MeterGraph::destroy()
         {
             sBuffer.destroy();
+
+            if (vLevels != NULL)
+            {
+                delete [] vLevels;
+                vLevels     = NULL;
+            }
+            nLevels     = 1;
         }
 
-        bool MeterGraph::init(size_t frames, size_t period)
+        bool MeterGraph::init(size_t frames, size_t period, size_t levels)
         {
-            if (period <= 0)
+            if ((period <= 0) || (levels <= 0))
                 return false;
 
-            if (!sBuffer.init(frames * 4, frames))
+            if (!sBuffer.init(frames * 2, frames, true))
                 return false;
 
+            // Allocate decimated levels, the overall size of them does not exceed the finest level
+            if (vLevels != NULL)
+            {
+                delete [] vLevels;
+                vLevels     = NULL;
+            }
+            nLevels     = 1;
+
+            if (levels > 1)
+            {
+                vLevels     = new level_t[levels - 1];
+                if (vLevels == NULL)
+                    return false;
+
+                for (size_t i=1; i<levels; ++i)
+                {
+                    level_t *l      = &vLevels[i-1];
+                    size_t count    = lsp_max(frames >> i, size_t(1));
+                    if (!l->sBuffer.init(count * 2, count, true))
+                        return false;
+                    l->fPending     = 0.0f;
+                    l->bPending     = false;
+                }
+                nLevels     = levels;
+            }
+
             fCurrent    = 0.0f;
             nCount      = 0;
             nPeriod     = period;
             return true;
         }
 
+        size_t MeterGraph::get_frames(size_t level) const
+        {
+            if (level <= 0)
+                return sBuffer.size();
+            return (level < nLevels) ? vLevels[level-1].sBuffer.size() : 0;
+        }
+
+        float *MeterGraph::data(size_t level)
+        {
+            if (level <= 0)
+                return sBuffer.head();
+            return (level < nLevels) ? vLevels[level-1].sBuffer.head() : NULL;
+        }
+
+        size_t MeterGraph::select_level(size_t samples, size_t width) const
+        {
+            // Frames of the level cover (nPeriod << level) samples
+            size_t level    = 0;
+            while ((level + 1) < nLevels)
+            {
+                if ((samples / (nPeriod << (level + 1))) < width)
+                    break;
+                ++level;
+            }
+            return level;
+        }
+
+        void MeterGraph::fill(float level)
+        {
+            sBuffer.fill(level);
+            for (size_t i=1; i<nLevels; ++i)
+            {
+                level_t *l      = &vLevels[i-1];
+                l->sBuffer.fill(level);
+                l->bPending     = false;
+            }
+        }
+
         void MeterGraph::process(float sample)
         {
             // Make sample positive
             if (sample < 0)
                 sample      = - sample;
 
-            if (bMinimize)
+            // Update current sample
+            switch (enMethod)
             {
-                // Update current sample
-                if (nCount == 0)
-                    fCurrent    = sample;
-                else if (fCurrent < sample)
-                    fCurrent    = sample;
-            }
-            else
-            {
-                // Update current sample
-                if (nCount == 0)
-                    fCurrent    = sample;
-                else if (fCurrent > sample)
-                    fCurrent    = sample;
+                case MM_MINIMUM:
+                    if ((nCount == 0) || (fCurrent > sample))
+                        fCurrent    = sample;
+                    break;
+                case MM_RMS:
+                    fCurrent    = (nCount == 0) ? sample * sample : fCurrent + sample * sample;
+                    break;
+                case MM_MAXIMUM:
+                default:
+                    if ((nCount == 0) || (fCurrent < sample))
+                        fCurrent    = sample;
+                    break;
             }
 
             // Increment number of samples processed
             if ((++nCount) >= nPeriod)
-            {
-                // Append current sample to buffer
-                sBuffer.shift();
-                sBuffer.append(fCurrent);
-
-                // Update counter
-                nCount      = 0;
-            }
+                commit();
         }
 
         void MeterGraph::process(const float *s, size_t n)
         {
-            if (bMinimize)
+            while (n > 0)
             {
-                while (n > 0)
-                {
-                    // Determine amount of samples to process
-                    ssize_t can_do      = nPeriod - nCount;
-                    if (can_do > ssize_t(n))
-                        can_do          = n;
+                // Determine amount of samples to process
+                ssize_t can_do      = nPeriod - nCount;
+                if (can_do > ssize_t(n))
+                    can_do          = n;
 
-                    // Process the samples
-                    if (can_do > 0)
+                // Process the samples
+                if (can_do > 0)
+                {
+                    switch (enMethod)
                     {
-                        // Get maximum sample
-                        float sample        = dsp::abs_min(s, can_do);
-                        if (nCount == 0)
-                            fCurrent        = sample;
-                        else if (fCurrent > sample)
-                            fCurrent        = sample;
-
-                        // Update counters and pointers
-                        nCount             += can_do;
-                        n                  -= can_do;
-                        s                  += can_do;
+                        case MM_MINIMUM:
+                        {
+                            // Get minimum sample
+                            float sample        = dsp::abs_min(s, can_do);
+                            if ((nCount == 0) || (fCurrent > sample))
+                                fCurrent            = sample;
+                            break;
+                        }
+                        case MM_RMS:
+                        {
+                            // Get sum of squares
+                            float sample        = dsp::h_sqr_sum(s, can_do);
+                            fCurrent            = (nCount == 0) ? sample : fCurrent + sample;
+                            break;
+                        }
+                        case MM_MAXIMUM:
+                        default:
+                        {
+                            // Get maximum sample
+                            float sample        = dsp::abs_max(s, can_do);
+                            if ((nCount == 0) || (fCurrent < sample))
+                                fCurrent            = sample;
+                            break;
+                        }
                     }
 
-                    // Check that need to switch to next sample
-                    if (nCount >= nPeriod)
-                    {
-                        // Append current sample to buffer
-                        sBuffer.shift();
-                        sBuffer.append(fCurrent);
-
-                        // Update counter
-                        nCount      = 0;
-                    }
+                    // Update counters and pointers
+                    nCount             += can_do;
+                    n                  -= can_do;
+                    s                  += can_do;
                 }
+
+                // Check that need to switch to next sample
+                if (nCount >= nPeriod)
+                    commit();
             }
-            else
-            {
-                while (n > 0)
-                {
-                    // Determine amount of samples to process
-                    ssize_t can_do      = nPeriod - nCount;
-                    if (can_do > ssize_t(n))
-                        can_do          = n;
+        }
 
-                    // Process the samples
-                    if (can_do > 0)
-                    {
-                        // Get maximum sample
-                        float sample        = dsp::abs_max(s, can_do);
-                        if (nCount == 0)
-                            fCurrent        = sample;
-                        else if (fCurrent < sample)
-                            fCurrent        = sample;
-
-                        // Update counters and pointers
-                        nCount             += can_do;
-                        n                  -= can_do;
-                        s                  += can_do;
-                    }
+        void MeterGraph::commit()
+        {
+            // Append current sample to buffer
+            float value     = (enMethod == MM_RMS) ? sqrtf(fCurrent / nCount) : fCurrent;
+            sBuffer.shift();
+            sBuffer.append(value);
 
-                    // Check that need to switch to next sample
-                    if (nCount >= nPeriod)
-                    {
-                        // Append current sample to buffer
-                        sBuffer.shift();
-                        sBuffer.append(fCurrent);
+            // Update counter
+            nCount          = 0;
 
-                        // Update counter
-                        nCount      = 0;
-                    }
+            // Each pair of frames produces one frame of the next level
+            for (size_t i=1; i<nLevels; ++i)
+            {
+                level_t *l      = &vLevels[i-1];
+                if (!l->bPending)
+                {
+                    l->fPending     = value;
+                    l->bPending     = true;
+                    break;
                 }
+
+                value           = combine(l->fPending, value);
+                l->bPending     = false;
+                l->sBuffer.shift();
+                l->sBuffer.append(value);
             }
         }
 
+        float MeterGraph::combine(float a, float b) const
+        {
+            switch (enMethod)
+            {
+                case MM_MINIMUM:    return lsp_min(a, b);
+                case MM_RMS:        return sqrtf(0.5f * (a*a + b*b));
+                case MM_MAXIMUM:
+                default:
+                    break;
+            }
+            return lsp_max(a, b);
+        }
+
         void MeterGraph::dump(IStateDumper *v) const
         {
             v->write_object("sBuffer", &sBuffer);
             v->write("fCurrent", fCurrent);
             v->write("nCount", nCount);
             v->write("nPeriod", nPeriod);
-            v->write("bMinimize", bMinimize);
+            v->write("enMethod", enMethod);
+            v->begin_array("vLevels", vLevels, nLevels - 1);
+            {
+                for (size_t i=1; i<nLevels; ++i)
+                {
+                    const level_t *l = &vLevels[i-1];
+                    v->begin_object(l, sizeof(level_t));
+                    {
+                        v->write_object("sBuffer", &l->sBuffer);
+                        v->write("fPending", l->fPending);
+                        v->write("bPending", l->bPending);
+                    }
+                    v->end_object();
+                }
+            }
+            v->end_array();
+            v->write("nLevels", nLevels);
         }
     }
 }
@@ -0,0 +1,390 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/dsp-units/util/MultiConvolver.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#define CONVOLVER_MIN_CONV_BUF_SIZE         (1 << (CONVOLVER_RANK_MIN))
+#define CONVOLVER_MIN_DATA_BUF_SIZE         (1 << (CONVOLVER_RANK_MIN - 1))
+#define CONVOLVER_MIN_FFT_BUF_SIZE          (1 << (CONVOLVER_RANK_MIN + 1))
+
+#define CONVOLVER_DATA_ALIGN                0x40
+
+namespace lsp
+{
+    namespace dspu
+    {
+        MultiConvolver::MultiConvolver()
+        {
+            construct();
+        }
+
+        MultiConvolver::~MultiConvolver()
+        {
+            destroy();
+        }
+
+        void MultiConvolver::construct()
+        {
+            vDataBuffer         = NULL;
+            vFrames             = NULL;
+            vConvBuffer         = NULL;
+            vInputData          = NULL;
+            vTaskData           = NULL;
+            vConvData           = NULL;
+            vDirectData         = NULL;
+
+            nInputs             = 0;
+            nOutputs            = 0;
+            nDataBufferSize     = 0;
+            nDirectSize         = 0;
+            nDirectStride       = 0;
+            nFrameSize          = 0;
+            nFrameOff           = 0;
+            nConvSize           = 0;
+            nLevels             = 0;
+            nBlocks             = 0;
+            nBlocksDone         = 0;
+            nRank               = 0;
+            nBlkInit            = 0;
+            fBlkCoef            = 0.0f;
+
+            vData               = NULL;
+        }
+
+        void MultiConvolver::destroy()
+        {
+            free_aligned(vData);
+            construct();
+        }
+
+        void MultiConvolver::parse_partition(float *dst, const float *src, size_t count, size_t rank)
+        {
+            // Convolution data is already cleared, nothing to do for empty partitions
+            if (count <= 0)
+                return;
+
+            dsp::fill_zero(vConvBuffer, 1 << (rank + 1));
+            dsp::copy(vConvBuffer, src, count);
+            dsp::fastconv_parse(dst, vConvBuffer, rank);
+        }
+
+        bool MultiConvolver::init(const float * const *data, const size_t *count,
+                size_t inputs, size_t outputs, size_t rank, float phase)
+        {
+            // Check arguments
+            size_t pairs            = inputs * outputs;
+            size_t length           = 0;
+            if ((data != NULL) && (count != NULL))
+            {
+                for (size_t i=0; i<pairs; ++i)
+                {
+                    if (data[i] != NULL)
+                        length                  = lsp_max(length, count[i]);
+                }
+            }
+
+            if (length <= 0)
+            {
+                destroy();
+                return true;
+            }
+
+            // Determine number of buffers
+            rank                    = lsp_limit(ssize_t(rank), CONVOLVER_RANK_MIN, CONVOLVER_RANK_MAX);
+
+            // Determine size of buffer
+            size_t data_buf_size    = 1 << (rank - 1);
+            size_t fft_buf_size     = 1 << (rank + 1);
+            size_t direct_buf_size  = lsp_max(CONVOLVER_MIN_DATA_BUF_SIZE, int(CONVOLVER_DATA_ALIGN/sizeof(float)));
+            size_t bins             = (length + data_buf_size - 1) >> (rank - 1);
+
+            size_t allocate         = outputs * (bins + 1) * data_buf_size;     // Size of data buffers (convolution tail)
+            allocate               += inputs * data_buf_size * 2;               // Input data frames
+            allocate               += fft_buf_size;                             // Convolution buffer
+            allocate               += fft_buf_size;                             // FFT data of the input block
+            allocate               += inputs * fft_buf_size;                    // Task data for tail convolution
+            allocate               += pairs * bins * fft_buf_size;              // FFT convolution data
+            allocate               += pairs * direct_buf_size;                  // Direct convolution data
+
+            // Allocate buffer and clear
+            uint8_t *pdata          = NULL;
+            float *fptr             = alloc_aligned<float>(pdata, allocate, CONVOLVER_DATA_ALIGN);
+            if (fptr == NULL)
+                return false;
+
+            destroy();
+            vData                   = pdata;
+            dsp::fill_zero(fptr, allocate);                             // Cleanup all buffer data
+
+            // Perform initialization
+            vDataBuffer             = fptr;
+            fptr                   += outputs * (bins + 1) * data_buf_size;
+            vFrames                 = fptr;
+            fptr                   += inputs * data_buf_size * 2;
+            vConvBuffer             = fptr;
+            fptr                   += fft_buf_size;
+            vInputData              = fptr;
+            fptr                   += fft_buf_size;
+            vTaskData               = fptr;
+            fptr                   += inputs * fft_buf_size;
+            vConvData               = fptr;
+            fptr                   += pairs * bins * fft_buf_size;
+            vDirectData             = fptr;
+            fptr                   += pairs * direct_buf_size;
+
+            // Initialize simple values
+            nInputs                 = inputs;
+            nOutputs                = outputs;
+            nDataBufferSize         = (bins + 1) * data_buf_size;
+            nFrameSize              = data_buf_size;
+            nFrameOff               = size_t(phase * nFrameSize) % nFrameSize;
+            nDirectSize             = lsp_min(length, size_t(CONVOLVER_MIN_DATA_BUF_SIZE));
+            nDirectStride           = direct_buf_size;
+            nConvSize               = length;
+
+            // Compute the partitioning for the longest impulse response, it is the same for all
+            size_t left             = length - nDirectSize;
+            nLevels                 = 0;
+            for (size_t brank = CONVOLVER_RANK_MIN; (left > 0) && (brank < rank); ++brank)
+            {
+                left                   -= lsp_min(left, size_t(1 << (brank - 1)));
+                ++nLevels;
+            }
+            nBlocks                 = (left + data_buf_size - 1) / data_buf_size;
+
+            /* Calculate convolutions, each partition stores spectra of all impulse responses:
+
+                Conv buffer layout:
+                +-------+-------+----------+-----------+---------------+
+                |FFT x P|FFT x P|FFT x2 x P| FFT x4 x P|  FFT x8 x P   |  . . .
+                +-------+-------+----------+-----------+---------------+
+             */
+            for (size_t p=0; p<pairs; ++p)
+            {
+                const float *ir         = data[p];
+                left                    = (ir != NULL) ? count[p] : 0;
+
+                // Process direct convolution data
+                float *base             = vConvData;
+                size_t step             = CONVOLVER_MIN_FFT_BUF_SIZE;
+                size_t n                = lsp_min(left, nDirectSize);
+                dsp::copy(&vDirectData[p * nDirectStride], ir, n);
+                parse_partition(&base[p * step], ir, n, CONVOLVER_RANK_MIN);
+                ir                     += n;
+                left                   -= n;
+
+                // Prepare raising levels
+                size_t brank            = CONVOLVER_RANK_MIN;
+                for (size_t i=0; i<nLevels; ++i, ++brank)
+                {
+                    base                   += pairs * step;
+                    step                    = 1 << (brank + 1);
+                    n                       = lsp_min(left, size_t(1 << (brank - 1)));
+                    parse_partition(&base[p * step], ir, n, brank);
+                    ir                     += n;
+                    left                   -= n;
+                }
+
+                // Prepare constant part
+                for (size_t i=0; i<nBlocks; ++i)
+                {
+                    base                   += pairs * step;
+                    step                    = fft_buf_size;
+                    n                       = lsp_min(left, data_buf_size);
+                    parse_partition(&base[p * step], ir, n, rank);
+                    ir                     += n;
+                    left                   -= n;
+                }
+            }
+
+            nBlocksDone             = nBlocks;
+            ssize_t steps           = data_buf_size >> (CONVOLVER_RANK_MIN - 1);
+            if (steps <= 1)
+            {
+                nBlkInit                = nBlocks;
+                fBlkCoef                = 0.0f;
+            }
+            else
+            {
+                nBlkInit                = 1;
+                fBlkCoef                = (float(nBlocks) + 1e-3f) / (float(steps) - 1.0f);
+            }
+
+            nRank                   = rank;
+
+            return true;
+        }
+
+        void MultiConvolver::process(float * const *dst, const float * const *src, size_t count)
+        {
+            if (vData == NULL)
+            {
+                for (size_t o=0; o<nOutputs; ++o)
+                    dsp::fill_zero(dst[o], count);
+                return;
+            }
+
+            const size_t pairs  = nInputs * nOutputs;
+
+            for (size_t off=0; off < count; )
+            {
+                size_t sub_off      = nFrameOff & (CONVOLVER_MIN_DATA_BUF_SIZE - 1);        // Determine sub-offset in the frame
+
+                // We are strictly at the boundary of the frame?
+                if (sub_off == 0)
+                {
+                    // Calculate convolution mask, see Convolver::process() for details
+                    size_t sub_id       = nFrameOff >> (CONVOLVER_RANK_MIN - 1);
+                    size_t mask         = ((sub_id-1) ^ sub_id);
+                    size_t rank         = CONVOLVER_RANK_MIN;
+                    const float *conv   = &vConvData[pairs * CONVOLVER_MIN_FFT_BUF_SIZE];
+
+                    // Apply convolution with raising level, the FFT of input is shared between outputs
+                    for (size_t l=0; l<nLevels; ++l)
+                    {
+                        if (mask & 1)
+                        {
+                            size_t step         = 1 << (rank + 1);
+                            const float *c      = conv;
+                            for (size_t i=0; i<nInputs; ++i)
+                            {
+                                dsp::fastconv_parse(vInputData, frame(i) + nFrameOff - (1 << (rank - 1)), rank);
+                                for (size_t o=0; o<nOutputs; ++o, c += step)
+                                    dsp::fastconv_apply(&output(o)[nFrameOff], vConvBuffer, c, vInputData, rank);
+                            }
+                        }
+
+                        ++rank;
+                        conv               += pairs * (1 << rank);
+                        mask              >>= 1;
+                    }
+
+                    // Need to apply long tail?
+                    if (nBlocks > 0)
+                    {
+                        size_t fft_step     = 1 << (nRank + 1);
+
+                        // Need to reset tasks?
+                        if (mask & 1)
+                        {
+                            for (size_t i=0; i<nInputs; ++i)
+                                dsp::fastconv_parse(&vTaskData[i * fft_step], frame(i) - nFrameSize, nRank);
+                            nBlocksDone         = 0;
+                        }
+
+                        // Need to execute tasks?
+                        size_t target_blk   = lsp_min(nBlocks, size_t(nBlkInit + fBlkCoef * sub_id));
+                        conv                = &vConvData[(nBlocksDone + 1) * pairs * fft_step];     // Source convolution
+
+                        for ( ; nBlocksDone < target_blk; ++nBlocksDone)
+                        {
+                            size_t xoff         = nBlocksDone << (nRank - 1);                       // Offset to store the block
+                            for (size_t i=0; i<nInputs; ++i)
+                            {
+                                const float *task   = &vTaskData[i * fft_step];
+                                for (size_t o=0; o<nOutputs; ++o, conv += fft_step)
+                                    dsp::fastconv_apply(&output(o)[xoff], vConvBuffer, conv, task, nRank);
+                            }
+                        }
+                    }
+                }
+
+                // Apply direct convolution
+                size_t to_do        = lsp_min(count - off, size_t(CONVOLVER_MIN_DATA_BUF_SIZE - sub_off));
+                for (size_t i=0; i<nInputs; ++i)
+                    dsp::copy(&frame(i)[nFrameOff], &src[i][off], to_do);      // Store data to frame
+
+                if (to_do == CONVOLVER_MIN_DATA_BUF_SIZE)
+                {
+                    const float *c      = vConvData;
+                    for (size_t i=0; i<nInputs; ++i)
+                    {
+                        dsp::fastconv_parse(vInputData, &src[i][off], CONVOLVER_RANK_MIN);
+                        for (size_t o=0; o<nOutputs; ++o, c += CONVOLVER_MIN_FFT_BUF_SIZE)
+                            dsp::fastconv_apply(&output(o)[nFrameOff], vConvBuffer, c, vInputData, CONVOLVER_RANK_MIN);
+                    }
+                }
+                else
+                {
+                    const float *c      = vDirectData;
+                    for (size_t i=0; i<nInputs; ++i)
+                        for (size_t o=0; o<nOutputs; ++o, c += nDirectStride)
+                            dsp::convolve(&output(o)[nFrameOff], &src[i][off], c, nDirectSize, to_do);
+                }
+
+                // Output result
+                for (size_t o=0; o<nOutputs; ++o)
+                    dsp::copy(&dst[o][off], &output(o)[nFrameOff], to_do);
+
+                // Update counters/pointers
+                nFrameOff          += to_do;
+                off                += to_do;
+
+                // Check that we are out of the frame and need to shift the data and convolution tail
+                if (nFrameOff >= nFrameSize)
+                {
+                    nFrameOff          -= nFrameSize;
+                    for (size_t i=0; i<nInputs; ++i)
+                    {
+                        float *f            = frame(i);
+                        dsp::move(f - nFrameSize, f, nFrameSize);
+                    }
+                    for (size_t o=0; o<nOutputs; ++o)
+                    {
+                        float *buf          = output(o);
+                        dsp::move(buf, &buf[nFrameSize], nDataBufferSize - nFrameSize);
+                        dsp::fill_zero(&buf[nDataBufferSize - nFrameSize], nFrameSize);
+                    }
+                }
+            }
+        }
+
+        void MultiConvolver::dump(IStateDumper *v) const
+        {
+            v->write("vDataBuffer", vDataBuffer);
+            v->write("vFrames", vFrames);
+            v->write("vConvBuffer", vConvBuffer);
+            v->write("vInputData", vInputData);
+            v->write("vTaskData", vTaskData);
+            v->write("vConvData", vConvData);
+            v->write("vDirectData", vDirectData);
+
+            v->write("nInputs", nInputs);
+            v->write("nOutputs", nOutputs);
+            v->write("nDataBufferSize", nDataBufferSize);
+            v->write("nDirectSize", nDirectSize);
+            v->write("nDirectStride", nDirectStride);
+            v->write("nFrameSize", nFrameSize);
+            v->write("nFrameOff", nFrameOff);
+            v->write("nConvSize", nConvSize);
+            v->write("nLevels", nLevels);
+            v->write("nBlocks", nBlocks);
+            v->write("nBlocksDone", nBlocksDone);
+            v->write("nRank", nRank);
+            v->write("nBlkInit", nBlkInit);
+            v->write("fBlkCoef", fBlkCoef);
+
+            v->write("vData", vData);
+        }
+    }
+} /* namespace lsp */
@@ -0,0 +1,514 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp-units/util/MultiCrossover.h>
+#include <lsp-plug.in/dsp-units/units.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        MultiCrossover::MultiCrossover()
+        {
+            construct();
+        }
+
+        MultiCrossover::~MultiCrossover()
+        {
+            destroy();
+        }
+
+        void MultiCrossover::construct()
+        {
+            nReconfigure    = 0;
+            nSplits         = 0;
+            nChannels       = 0;
+            nBufSize        = 0;
+            nSampleRate     = LSP_DSP_UNITS_DEFAULT_SAMPLE_RATE;
+
+            vBands          = NULL;
+            vSplit          = NULL;
+            vPlan           = NULL;
+            nPlanSize       = 0;
+
+            sBank.construct();
+            sFilter.construct();
+
+            vLpfBuf         = NULL;
+            vHpfBuf         = NULL;
+            vIn             = NULL;
+
+            pData           = NULL;
+        }
+
+        void MultiCrossover::destroy()
+        {
+            if (vSplit != NULL)
+            {
+                for (size_t i=0; i<nSplits; ++i)
+                {
+                    split_t *sp     = &vSplit[i];
+                    sp->sLPF.destroy();
+                    sp->sHPF.destroy();
+                }
+            }
+
+            sFilter.destroy();
+            sBank.destroy();
+
+            free_aligned(pData);
+            construct();
+        }
+
+        bool MultiCrossover::init(size_t channels, size_t bands, size_t buf_size)
+        {
+            if ((bands < 1) || (channels < 1))
+                return false;
+
+            destroy();
+
+            size_t xbuf_size    = align_size(buf_size * sizeof(float), DEFAULT_ALIGN);
+            size_t band_size    = align_size(bands * sizeof(band_t), DEFAULT_ALIGN);
+            size_t split_size   = align_size((bands - 1) * sizeof(split_t), DEFAULT_ALIGN);
+            size_t plan_size    = align_size((bands - 1) * sizeof(split_t *), DEFAULT_ALIGN);
+            size_t ptr_size     = align_size(channels * sizeof(float *), DEFAULT_ALIGN);
+            size_t to_alloc     = band_size +
+                                  split_size +
+                                  plan_size +
+                                  ptr_size * 3 +
+                                  xbuf_size * 2 * channels;
+
+            // Allocate buffers
+            uint8_t *data       = NULL;
+            uint8_t *ptr        = alloc_aligned<uint8_t>(data, to_alloc);
+            if (ptr == NULL)
+                return false;
+
+            // Distribute the allocated space
+            vBands              = reinterpret_cast<band_t *>(ptr);
+            ptr                += band_size;
+            vSplit              = reinterpret_cast<split_t *>(ptr);
+            ptr                += split_size;
+            vPlan               = reinterpret_cast<split_t **>(ptr);
+            ptr                += plan_size;
+            vLpfBuf             = reinterpret_cast<float **>(ptr);
+            ptr                += ptr_size;
+            vHpfBuf             = reinterpret_cast<float **>(ptr);
+            ptr                += ptr_size;
+            vIn                 = reinterpret_cast<const float **>(ptr);
+            ptr                += ptr_size;
+            for (size_t i=0; i<channels; ++i)
+            {
+                vLpfBuf[i]          = reinterpret_cast<float *>(ptr);
+                ptr                += xbuf_size;
+                vHpfBuf[i]          = reinterpret_cast<float *>(ptr);
+                ptr                += xbuf_size;
+                vIn[i]              = NULL;
+            }
+
+            // Initialize fields, keep sample_rate unchanged
+            nReconfigure        = R_ALL;
+            nSplits             = bands - 1;
+            nChannels           = channels;
+            nBufSize            = buf_size;
+            nPlanSize           = 0;
+
+            // Store allocated data pointer
+            pData               = data;
+
+            // Initialize the filter used to build chains
+            if ((!sBank.init(bands * FILTER_CHAINS_MAX)) || (!sFilter.init(&sBank)))
+            {
+                destroy();
+                return false;
+            }
+
+            // Construct all splits
+            float step          = logf(LSP_DSP_UNITS_SPEC_FREQ_MAX / LSP_DSP_UNITS_SPEC_FREQ_MIN) / bands;
+
+            for (size_t i=0; i<nSplits; ++i)
+            {
+                split_t *sp         = &vSplit[i];
+
+                // Initialize filters
+                sp->sLPF.construct();
+                sp->sHPF.construct();
+
+                if ((!sp->sLPF.init(channels, nSplits * FILTER_CHAINS_MAX)) ||
+                    (!sp->sHPF.init(channels, FILTER_CHAINS_MAX)))
+                {
+                    destroy();
+                    return false;
+                }
+
+                // Initialize split point parameters
+                sp->nBandId         = i + 1; // Band N+1 is attached to split point N
+                sp->nSlope          = 0;
+                sp->fFreq           = LSP_DSP_UNITS_SPEC_FREQ_MIN * expf((i+1) * step);
+                sp->nMode           = CROSS_MODE_BT;
+            }
+
+            // Construct all bands
+            for (size_t i=0; i<=nSplits; ++i)
+            {
+                band_t *sb          = &vBands[i];
+
+                sb->fGain           = GAIN_AMP_0_DB;
+                sb->fStart          = (i == 0) ? LSP_DSP_UNITS_SPEC_FREQ_MIN : vSplit[i-1].fFreq;
+                sb->fEnd            = (i < nSplits) ? vSplit[i].fFreq : nSampleRate * 0.5f;
+                sb->bEnabled        = false;
+                sb->pStart          = NULL;
+                sb->pEnd            = NULL;
+
+                sb->pFunc           = NULL;
+                sb->pObject         = NULL;
+                sb->pSubject        = NULL;
+                sb->nId             = i;
+            }
+
+            return true;
+        }
+
+        filter_type_t MultiCrossover::select_filter(xover_type_t type, crossover_mode_t mode)
+        {
+            switch (type)
+            {
+                case FILTER_LPF: return (mode == CROSS_MODE_BT) ? FLT_BT_LRX_LOPASS  : FLT_MT_LRX_LOPASS;
+                case FILTER_HPF: return (mode == CROSS_MODE_BT) ? FLT_BT_LRX_HIPASS  : FLT_MT_LRX_HIPASS;
+                case FILTER_APF: return (mode == CROSS_MODE_BT) ? FLT_BT_LRX_ALLPASS : FLT_MT_LRX_ALLPASS;
+                default:
+                    return FLT_NONE;
+            }
+        }
+
+        void MultiCrossover::set_slope(size_t sp, size_t slope)
+        {
+            if (sp >= nSplits)
+                return;
+            if (slope == vSplit[sp].nSlope)
+                return;
+
+            vSplit[sp].nSlope   = slope;
+            nReconfigure       |= R_SPLIT;
+        }
+
+        ssize_t MultiCrossover::get_slope(size_t sp) const
+        {
+            return (sp < nSplits) ? vSplit[sp].nSlope : -1;
+        }
+
+        void MultiCrossover::set_frequency(size_t sp, float freq)
+        {
+            if (sp >= nSplits)
+                return;
+            if (freq == vSplit[sp].fFreq)
+                return;
+
+            vSplit[sp].fFreq    = freq;
+            nReconfigure       |= R_SPLIT;
+        }
+
+        float MultiCrossover::get_frequency(size_t sp) const
+        {
+            return (sp < nSplits) ? vSplit[sp].fFreq : -1.0f;
+        }
+
+        void MultiCrossover::set_mode(size_t sp, crossover_mode_t mode)
+        {
+            if (sp >= nSplits)
+                return;
+            if (mode == vSplit[sp].nMode)
+                return;
+
+            vSplit[sp].nMode    = mode;
+            nReconfigure       |= R_SPLIT;
+        }
+
+        ssize_t MultiCrossover::get_mode(size_t sp) const
+        {
+            return (sp < nSplits) ? vSplit[sp].nMode : -1;
+        }
+
+        void MultiCrossover::set_gain(size_t band, float gain)
+        {
+            if (band > nSplits)
+                return;
+            if (gain == vBands[band].fGain)
+                return;
+
+            vBands[band].fGain  = gain;
+            nReconfigure       |= R_GAIN;
+        }
+
+        float MultiCrossover::get_gain(size_t band) const
+        {
+            return (band <= nSplits) ? vBands[band].fGain: -1.0f;
+        }
+
+        float MultiCrossover::get_band_start(size_t band)
+        {
+            reconfigure();
+            return (band <= nSplits) ? vBands[band].fStart : -1.0f;
+        }
+
+        float MultiCrossover::get_band_end(size_t band)
+        {
+            reconfigure();
+            return (band <= nSplits) ? vBands[band].fEnd : -1.0f;
+        }
+
+        bool MultiCrossover::set_handler(size_t band, multi_crossover_func_t func, void *object, void *subject)
+        {
+            if (band > nSplits)
+                return false;
+
+            band_t *b       = &vBands[band];
+            b->pFunc        = func;
+            b->pObject      = object;
+            b->pSubject     = subject;
+
+            return true;
+        }
+
+        bool MultiCrossover::unset_handler(size_t band)
+        {
+            if (band > nSplits)
+                return false;
+
+            band_t *b       = &vBands[band];
+            b->pFunc        = NULL;
+            b->pObject      = NULL;
+            b->pSubject     = NULL;
+            return true;
+        }
+
+        bool MultiCrossover::band_active(size_t band)
+        {
+            if (band > nSplits)
+                return false;
+            else if (band == 0)
+                return true;
+
+            reconfigure();
+            return vBands[band].bEnabled;
+        }
+
+        void MultiCrossover::set_sample_rate(size_t sr)
+        {
+            if (nSampleRate == sr)
+                return;
+
+            nSampleRate     = sr;
+            nReconfigure   |= R_ALL;
+        }
+
+        void MultiCrossover::add_filter(xover_type_t type, const split_t *sp, float gain)
+        {
+            filter_params_t fp;
+
+            fp.nType            = select_filter(type, sp->nMode);
+            fp.fFreq            = sp->fFreq;
+            fp.fFreq2           = sp->fFreq;
+            fp.fGain            = gain;
+            fp.nSlope           = sp->nSlope;
+            fp.fQuality         = 0.0f;
+
+            // The filter appends it's chains to the shared filter bank
+            sFilter.update(nSampleRate, &fp);
+            sFilter.rebuild();
+        }
+
+        void MultiCrossover::reconfigure()
+        {
+            if (!nReconfigure)
+                return;
+
+            // Form the plan and reset band state
+            nPlanSize       = 0;
+            for (size_t i=0; i<nSplits; ++i)
+            {
+                if (vSplit[i].nSlope > 0)
+                    vPlan[nPlanSize++]  = &vSplit[i];
+            }
+            for (size_t i=0; i<=nSplits; ++i)
+                vBands[i].bEnabled  = false;
+
+            // Sort split bands in ascending order
+            for (ssize_t si=0, n=nPlanSize; si < n-1; ++si)
+                for (ssize_t sj=si+1; sj < n; ++sj)
+                    if (vPlan[sj]->fFreq < vPlan[si]->fFreq)
+                        swap(vPlan[si], vPlan[sj]);
+
+            band_t *left        = &vBands[0];
+            left->fStart        = LSP_DSP_UNITS_SPEC_FREQ_MIN;
+            left->bEnabled      = true;
+            left->pStart        = NULL;
+
+            // Configure LPF and HPF bands
+            for (size_t i=0; i<nPlanSize; ++i)
+            {
+                split_t *sp         = vPlan[i];
+                band_t *right       = &vBands[sp->nBandId];
+
+                left->fEnd          = sp->fFreq;
+                left->pEnd          = sp;
+                right->fStart       = sp->fFreq;
+                right->pStart       = sp;
+                right->bEnabled     = true;
+
+                // Build LPF with APF filters of all next split points
+                sBank.begin();
+                add_filter(FILTER_LPF, sp, left->fGain);
+                for (size_t j=i+1; j<nPlanSize; ++j)
+                    add_filter(FILTER_APF, vPlan[j], GAIN_AMP_0_DB);
+                sBank.end(true);
+                sp->sLPF.load(&sBank);
+
+                // Build HPF
+                sBank.begin();
+                add_filter(FILTER_HPF, sp, (i < (nPlanSize-1)) ? GAIN_AMP_0_DB : right->fGain);
+                sBank.end(true);
+                sp->sHPF.load(&sBank);
+
+                // Move to next band
+                left                = right;
+            }
+
+            // Update frequency of the last band
+            left->fEnd          = nSampleRate * 0.5f;
+            left->pEnd          = NULL;
+
+            // Reset reconfiguration flag
+            nReconfigure        = 0;
+        }
+
+        void MultiCrossover::process(const float * const *in, size_t samples)
+        {
+            reconfigure();
+
+            for (size_t sample=0; sample < samples; )
+            {
+                size_t to_do        = lsp_min(samples - sample, nBufSize);
+                band_t *left        = &vBands[0];
+
+                for (size_t i=0; i<nChannels; ++i)
+                    vIn[i]              = &in[i][sample];
+                const float * const *src = vIn;
+
+                if (nPlanSize > 0)
+                {
+                    // Process each band except last
+                    for (size_t i=0; i<nPlanSize; ++i)
+                    {
+                        split_t *sp         = vPlan[i];
+                        band_t *right       = &vBands[sp->nBandId];
+
+                        // Perform split of all channels first
+                        if (left->pFunc != NULL)
+                            sp->sLPF.process(vLpfBuf, src, to_do);
+                        sp->sHPF.process(vHpfBuf, src, to_do);
+
+                        // Now call handlers
+                        if (left->pFunc != NULL)
+                            left->pFunc(left->pObject, left->pSubject, left->nId, vLpfBuf, nChannels, sample, to_do);
+
+                        src                 = vHpfBuf;
+                        left                = right;
+                    }
+
+                    // Process last band
+                    if (left->pFunc != NULL)
+                        left->pFunc(left->pObject, left->pSubject, left->nId, vHpfBuf, nChannels, sample, to_do);
+                }
+                else if (left->pFunc != NULL)
+                {
+                    for (size_t i=0; i<nChannels; ++i)
+                        dsp::mul_k3(vLpfBuf[i], src[i], vBands[0].fGain, to_do);
+                    left->pFunc(left->pObject, left->pSubject, left->nId, vLpfBuf, nChannels, sample, to_do);
+                }
+
+                // Update pointers
+                sample             += to_do;
+            }
+        }
+
+        void MultiCrossover::dump(IStateDumper *v) const
+        {
+            v->write("nReconfigure", nReconfigure);
+            v->write("nSplits", nSplits);
+            v->write("nChannels", nChannels);
+            v->write("nBufSize", nBufSize);
+            v->write("nSampleRate", nSampleRate);
+
+            v->begin_array("vBands", vBands, nSplits+1);
+            for (size_t i=0; i<=nSplits; ++i)
+            {
+                band_t *b   = &vBands[i];
+                v->begin_object(b, sizeof(band_t));
+                {
+                    v->write("fGain", b->fGain);
+                    v->write("fStart", b->fStart);
+                    v->write("fEnd", b->fEnd);
+                    v->write("bEnabled", b->bEnabled);
+                    v->write("pStart", b->pStart);
+                    v->write("pEnd", b->pEnd);
+
+                    v->write("pFunc", b->pFunc);
+                    v->write("pObject", b->pObject);
+                    v->write("pSubject", b->pSubject);
+                    v->write("nId", b->nId);
+                }
+                v->end_object();
+            }
+            v->end_array();
+
+            v->begin_array("vSplit", vSplit, nSplits);
+            for (size_t i=0; i < nSplits; ++i)
+            {
+                split_t *s  = &vSplit[i];
+                v->begin_object(s, sizeof(split_t));
+                {
+                    v->write_object("sLPF", &s->sLPF);
+                    v->write_object("sHPF", &s->sHPF);
+
+                    v->write("nBandId", s->nBandId);
+                    v->write("nSlope", s->nSlope);
+                    v->write("fFreq", s->fFreq);
+                    v->write("nMode", s->nMode);
+                }
+                v->end_object();
+            }
+            v->end_array();
+
+            v->writev("vPlan", vPlan, nPlanSize);
+            v->write("nPlanSize", nPlanSize);
+
+            v->write_object("sBank", &sBank);
+            v->write_object("sFilter", &sFilter);
+
+            v->writev("vLpfBuf", vLpfBuf, nChannels);
+            v->writev("vHpfBuf", vHpfBuf, nChannels);
+            v->writev("vIn", vIn, nChannels);
+            v->write("pData", pData);
+        }
+    }
+} /* namespace lsp */
@@ -0,0 +1,277 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/dsp-units/util/MultiDither.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/runtime/system.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define DITHER_8BIT             0.00390625  /* 1 / 256 */
+#define DITHER_LANES            8           /* Number of channels processed at once */
+#define DITHER_BLOCK_SIZE       0x40        /* Number of samples processed at once */
+
+namespace lsp
+{
+    namespace dspu
+    {
+        MultiDither::MultiDither()
+        {
+            construct();
+        }
+
+        MultiDither::~MultiDither()
+        {
+            destroy();
+        }
+
+        void MultiDither::construct()
+        {
+            vRandom         = NULL;
+            for (size_t i=0; i<DITHER_SHAPE_ORDER; ++i)
+                vError[i]       = NULL;
+            vSignal         = NULL;
+            vNoise          = NULL;
+            nChannels       = 0;
+            nCapacity       = 0;
+            nBits           = 0;
+            fGain           = 1.0f;
+            fDelta          = 0.0f;
+            enShape         = DITHER_FLAT;
+            pData           = NULL;
+        }
+
+        void MultiDither::destroy()
+        {
+            free_aligned(pData);
+            vRandom         = NULL;
+            for (size_t i=0; i<DITHER_SHAPE_ORDER; ++i)
+                vError[i]       = NULL;
+            vSignal         = NULL;
+            vNoise          = NULL;
+            nChannels       = 0;
+            nCapacity       = 0;
+        }
+
+        bool MultiDither::init(size_t channels, uint32_t seed)
+        {
+            if (channels <= 0)
+                return false;
+
+            // Lanes are padded to the number of channels processed at once, padding lanes stay silent
+            size_t capacity     = align_size(channels, DITHER_LANES);
+            size_t rnd_size     = align_size(channels * sizeof(Randomizer), DEFAULT_ALIGN);
+            size_t err_size     = align_size(capacity * sizeof(float), DEFAULT_ALIGN);
+            size_t buf_size     = err_size * DITHER_BLOCK_SIZE;
+            size_t to_alloc     = rnd_size + err_size * DITHER_SHAPE_ORDER + buf_size * 2;
+
+            uint8_t *data       = NULL;
+            uint8_t *ptr        = alloc_aligned<uint8_t>(data, to_alloc);
+            if (ptr == NULL)
+                return false;
+
+            free_aligned(pData);
+
+            vRandom             = reinterpret_cast<Randomizer *>(ptr);
+            ptr                += rnd_size;
+            for (size_t i=0; i<DITHER_SHAPE_ORDER; ++i)
+            {
+                vError[i]           = reinterpret_cast<float *>(ptr);
+                ptr                += err_size;
+                dsp::fill_zero(vError[i], capacity);
+            }
+            vSignal             = reinterpret_cast<float *>(ptr);
+            ptr                += buf_size;
+            vNoise              = reinterpret_cast<float *>(ptr);
+            ptr                += buf_size;
+
+            nChannels           = channels;
+            nCapacity           = capacity;
+            pData               = data;
+
+            // Each channel uses its own stream of the same seed
+            for (size_t i=0; i<channels; ++i)
+            {
+                vRandom[i].construct();
+                vRandom[i].init_counter(seed, uint32_t(i));
+            }
+            dsp::fill_zero(vSignal, capacity * DITHER_BLOCK_SIZE);
+            dsp::fill_zero(vNoise, capacity * DITHER_BLOCK_SIZE);
+
+            return true;
+        }
+
+        bool MultiDither::init(size_t channels)
+        {
+            system::time_t ts;
+            system::get_time(&ts);
+            return init(channels, ts.seconds ^ ts.nanos);
+        }
+
+        void MultiDither::set_bits(size_t bits)
+        {
+            nBits   = bits;
+            if (bits <= 0)
+                return;
+
+            fDelta  = 4.0f; // The same amplitude as for the Dither class
+            while (bits >= 8)
+            {
+                fDelta     *= DITHER_8BIT;
+                bits       -= 8;
+            }
+            if (bits > 0)
+                fDelta     /= float(1 << bits);
+            fGain   = 1.0f - 0.5f * fDelta;
+        }
+
+        void MultiDither::set_shape(dither_shape_t shape)
+        {
+            enShape = (shape < DITHER_SHAPE_TOTAL) ? shape : DITHER_FLAT;
+            for (size_t i=0; i<DITHER_SHAPE_ORDER; ++i)
+            {
+                if (vError[i] != NULL)
+                    dsp::fill_zero(vError[i], nCapacity);
+            }
+        }
+
+        void MultiDither::process(float * const *out, const float * const *in, size_t count)
+        {
+            if (!nBits)
+            {
+                for (size_t i=0; i<nChannels; ++i)
+                    dsp::copy(out[i], in[i], count);
+                return;
+            }
+
+            if (enShape == DITHER_FLAT)
+                process_flat(out, in, count);
+            else
+                process_shaped(out, in, count);
+        }
+
+        void MultiDither::process_flat(float * const *out, const float * const *in, size_t count)
+        {
+            // Channels are independent, the noise is generated and mixed by blocks
+            float buf[DITHER_BLOCK_SIZE];
+
+            for (size_t i=0; i<nChannels; ++i)
+            {
+                const float *src    = in[i];
+                float *dst          = out[i];
+                Randomizer *r       = &vRandom[i];
+
+                for (size_t offset=0; offset < count; )
+                {
+                    size_t to_do        = lsp_min(count - offset, size_t(DITHER_BLOCK_SIZE));
+
+                    r->random(buf, to_do, RND_TRIANGLE);
+                    dsp::add_k2(buf, -0.5f, to_do);
+                    dsp::mul_k2(buf, fDelta, to_do);
+                    dsp::fmadd_k3(buf, &src[offset], fGain, to_do);
+                    dsp::copy(&dst[offset], buf, to_do);
+
+                    offset             += to_do;
+                }
+            }
+        }
+
+        void MultiDither::process_shaped(float * const *out, const float * const *in, size_t count)
+        {
+            const float *h      = Dither::shape_filter(enShape);
+            const float h0      = h[0], h1 = h[1], h2 = h[2];
+            const float lsb     = 0.5f * fDelta;
+            const float klsb    = 1.0f / lsb;
+            const size_t cap    = nCapacity;
+            float *e0           = vError[0];
+            float *e1           = vError[1];
+            float *e2           = vError[2];
+            float tmp[DITHER_BLOCK_SIZE];
+
+            for (size_t offset=0; offset < count; )
+            {
+                size_t to_do        = lsp_min(count - offset, size_t(DITHER_BLOCK_SIZE));
+
+                // Interleave the signal and the noise of channels: sample j of channel i is at j*cap + i
+                for (size_t i=0; i<nChannels; ++i)
+                {
+                    const float *src    = &in[i][offset];
+                    vRandom[i].random(tmp, to_do, RND_TRIANGLE);
+                    for (size_t j=0; j<to_do; ++j)
+                    {
+                        vSignal[j*cap + i]  = src[j] * fGain;
+                        vNoise[j*cap + i]   = (tmp[j] - 0.5f) * fDelta;
+                    }
+                }
+
+                // Error-feedback filters of all channels run in lockstep
+                for (size_t j=0; j<to_do; ++j)
+                {
+                    float *x            = &vSignal[j*cap];
+                    const float *d      = &vNoise[j*cap];
+
+                    for (size_t i=0; i<cap; ++i)
+                    {
+                        float v             = x[i] - (h0*e0[i] + h1*e1[i] + h2*e2[i]);
+                        float y             = floorf((v + d[i]) * klsb + 0.5f) * lsb;
+
+                        e2[i]               = e1[i];
+                        e1[i]               = e0[i];
+                        e0[i]               = y - v;
+                        x[i]                = y;
+                    }
+                }
+
+                // De-interleave the output
+                for (size_t i=0; i<nChannels; ++i)
+                {
+                    float *dst          = &out[i][offset];
+                    for (size_t j=0; j<to_do; ++j)
+                        dst[j]              = vSignal[j*cap + i];
+                }
+
+                offset             += to_do;
+            }
+        }
+
+        void MultiDither::dump(IStateDumper *v) const
+        {
+            v->begin_array("vRandom", vRandom, nChannels);
+            for (size_t i=0; i<nChannels; ++i)
+                v->write_object(&vRandom[i]);
+            v->end_array();
+
+            v->writev("vError0", vError[0], nChannels);
+            v->writev("vError1", vError[1], nChannels);
+            v->writev("vError2", vError[2], nChannels);
+            v->write("vSignal", vSignal);
+            v->write("vNoise", vNoise);
+            v->write("nChannels", nChannels);
+            v->write("nCapacity", nCapacity);
+            v->write("nBits", nBits);
+            v->write("fGain", fGain);
+            v->write("fDelta", fDelta);
+            v->write("enShape", enShape);
+            v->write("pData", pData);
+        }
+    }
+} /* namespace lsp */
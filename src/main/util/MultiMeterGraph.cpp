@@ -0,0 +1,251 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/dsp-units/util/MultiMeterGraph.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/bits.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        MultiMeterGraph::MultiMeterGraph()
+        {
+            construct();
+        }
+
+        MultiMeterGraph::~MultiMeterGraph()
+        {
+            destroy();
+        }
+
+        void MultiMeterGraph::construct()
+        {
+            vRing       = NULL;
+            vCurrent    = NULL;
+            nChannels   = 0;
+            nFrames     = 0;
+            nCapacity   = 0;
+            nCount      = 0;
+            nPeriod     = 1;
+            enMethod    = MM_MAXIMUM;
+            nHead       = 0;
+            pData       = NULL;
+        }
+
+        void MultiMeterGraph::destroy()
+        {
+            if (vRing != NULL)
+            {
+                delete [] vRing;
+                vRing       = NULL;
+            }
+
+            if (pData != NULL)
+            {
+                free_aligned(pData);
+                pData       = NULL;
+            }
+
+            vCurrent    = NULL;
+            nChannels   = 0;
+            nFrames     = 0;
+            nCapacity   = 0;
+        }
+
+        bool MultiMeterGraph::init(size_t channels, size_t frames, size_t period)
+        {
+            if ((period <= 0) || (frames <= 0))
+                return false;
+
+            destroy();
+
+            // The writer may run ahead of the reader by at least the number of frames,
+            // the power of 2 keeps the ring continuous when the frame counter wraps
+            size_t capacity     = size_t(1) << (int_log2(frames * 2 - 1) + 1);
+            size_t ring_size    = align_size(capacity * sizeof(float), DEFAULT_ALIGN);
+            size_t cur_size     = align_size(channels * sizeof(float), DEFAULT_ALIGN);
+
+            uint8_t *ptr        = alloc_aligned<uint8_t>(pData, ring_size * channels + cur_size, DEFAULT_ALIGN);
+            if (ptr == NULL)
+                return false;
+            vRing               = new float *[channels];
+            if (vRing == NULL)
+            {
+                destroy();
+                return false;
+            }
+
+            vCurrent            = reinterpret_cast<float *>(ptr);
+            ptr                += cur_size;
+            dsp::fill_zero(vCurrent, channels);
+            for (size_t i=0; i<channels; ++i)
+            {
+                vRing[i]            = reinterpret_cast<float *>(ptr);
+                ptr                += ring_size;
+                dsp::fill_zero(vRing[i], capacity);
+            }
+
+            nChannels           = channels;
+            nFrames             = frames;
+            nCapacity           = capacity;
+            nCount              = 0;
+            nPeriod             = period;
+            atomic_swap(&nHead, 0);
+
+            return true;
+        }
+
+        void MultiMeterGraph::process(const float * const *s, size_t n)
+        {
+            for (size_t offset=0; offset < n; )
+            {
+                // Determine amount of samples to process
+                ssize_t can_do      = nPeriod - nCount;
+                if (can_do > ssize_t(n - offset))
+                    can_do              = n - offset;
+
+                // Reduce the samples of each channel by vectorized routines
+                if (can_do > 0)
+                {
+                    switch (enMethod)
+                    {
+                        case MM_MINIMUM:
+                            for (size_t i=0; i<nChannels; ++i)
+                            {
+                                float sample        = dsp::abs_min(&s[i][offset], can_do);
+                                if ((nCount == 0) || (vCurrent[i] > sample))
+                                    vCurrent[i]         = sample;
+                            }
+                            break;
+                        case MM_RMS:
+                            for (size_t i=0; i<nChannels; ++i)
+                            {
+                                float sample        = dsp::h_sqr_sum(&s[i][offset], can_do);
+                                vCurrent[i]         = (nCount == 0) ? sample : vCurrent[i] + sample;
+                            }
+                            break;
+                        case MM_MAXIMUM:
+                        default:
+                            for (size_t i=0; i<nChannels; ++i)
+                            {
+                                float sample        = dsp::abs_max(&s[i][offset], can_do);
+                                if ((nCount == 0) || (vCurrent[i] < sample))
+                                    vCurrent[i]         = sample;
+                            }
+                            break;
+                    }
+
+                    nCount             += can_do;
+                    offset             += can_do;
+                }
+
+                // Check that need to switch to next frame
+                if (nCount >= nPeriod)
+                    commit();
+            }
+        }
+
+        void MultiMeterGraph::commit()
+        {
+            uint32_t head       = atomic_add(&nHead, 0);
+            size_t idx          = head & (nCapacity - 1);
+
+            if (enMethod == MM_RMS)
+            {
+                const float k       = 1.0f / nCount;
+                for (size_t i=0; i<nChannels; ++i)
+                    vRing[i][idx]       = sqrtf(vCurrent[i] * k);
+            }
+            else
+            {
+                for (size_t i=0; i<nChannels; ++i)
+                    vRing[i][idx]       = vCurrent[i];
+            }
+
+            // Publish the frame, atomic_swap acts as a full memory barrier
+            atomic_swap(&nHead, atomic_t(head + 1));
+            nCount              = 0;
+        }
+
+        void MultiMeterGraph::fill(float level)
+        {
+            // Overwrite the whole ring by publishing the capacity of frames
+            for (size_t i=0; i<nChannels; ++i)
+                vCurrent[i]         = (enMethod == MM_RMS) ? level * level : level;
+            for (size_t i=0; i<nCapacity; ++i)
+            {
+                nCount              = 1;
+                commit();
+            }
+        }
+
+        size_t MultiMeterGraph::published()
+        {
+            return uint32_t(atomic_add(&nHead, 0));
+        }
+
+        size_t MultiMeterGraph::read(float *dst, size_t channel, size_t count)
+        {
+            if ((channel >= nChannels) || (count <= 0))
+                return published();
+            count               = lsp_min(count, nFrames);
+
+            const float *ring   = vRing[channel];
+            const size_t mask   = nCapacity - 1;
+
+            while (true)
+            {
+                uint32_t head       = atomic_add(&nHead, 0);
+
+                // Copy the latest frames, the ring may wrap
+                size_t tail         = (head - count) & mask;
+                size_t part         = lsp_min(count, nCapacity - tail);
+                dsp::copy(dst, &ring[tail], part);
+                if (part < count)
+                    dsp::copy(&dst[part], ring, count - part);
+
+                // The writer fills the frames starting at head, the copy is valid
+                // until it reaches the oldest frame that has been read
+                uint32_t last       = atomic_add(&nHead, 0);
+                if (uint32_t(last - head) < nCapacity - count)
+                    return head;
+            }
+        }
+
+        void MultiMeterGraph::dump(IStateDumper *v) const
+        {
+            v->writev("vRing", vRing, nChannels);
+            v->writev("vCurrent", vCurrent, nChannels);
+            v->write("nChannels", nChannels);
+            v->write("nFrames", nFrames);
+            v->write("nCapacity", nCapacity);
+            v->write("nCount", nCount);
+            v->write("nPeriod", nPeriod);
+            v->write("enMethod", enMethod);
+            v->write("nHead", nHead);
+            v->write("pData", pData);
+        }
+    }
+} /* namespace lsp */
@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/dsp-units/util/MultiOversampler.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#define MOS_BUFFER_SIZE         (6 * 1024)      /* Multiple of 3 and 4 */
+
+namespace lsp
+{
+    namespace dspu
+    {
+        IMultiOversamplerCallback::~IMultiOversamplerCallback()
+        {
+        }
+
+        void IMultiOversamplerCallback::process(float * const *out, const float * const *in, size_t channels, size_t samples)
+        {
+            for (size_t i=0; i<channels; ++i)
+                dsp::copy(out[i], in[i], samples);
+        }
+
+        MultiOversampler::MultiOversampler()
+        {
+            construct();
+        }
+
+        MultiOversampler::~MultiOversampler()
+        {
+            destroy();
+        }
+
+        void MultiOversampler::construct()
+        {
+            pCallback       = NULL;
+            nChannels       = 0;
+            vChannels       = NULL;
+            vBuffers        = NULL;
+            bData           = NULL;
+        }
+
+        bool MultiOversampler::init(size_t channels)
+        {
+            destroy();
+
+            // Allocate buffers
+            float *ptr      = alloc_aligned<float>(bData, channels * MOS_BUFFER_SIZE, DEFAULT_ALIGN);
+            if (ptr == NULL)
+                return false;
+            vChannels       = new Oversampler[channels];
+            vBuffers        = new float *[channels];
+            if ((vChannels == NULL) || (vBuffers == NULL))
+            {
+                destroy();
+                return false;
+            }
+
+            nChannels       = channels;
+            dsp::fill_zero(ptr, channels * MOS_BUFFER_SIZE);
+
+            // Initialize channels
+            for (size_t i=0; i<channels; ++i)
+            {
+                if (!vChannels[i].init())
+                {
+                    destroy();
+                    return false;
+                }
+                vBuffers[i]     = ptr;
+                ptr            += MOS_BUFFER_SIZE;
+            }
+
+            return true;
+        }
+
+        void MultiOversampler::destroy()
+        {
+            if (vChannels != NULL)
+            {
+                for (size_t i=0; i<nChannels; ++i)
+                    vChannels[i].destroy();
+                delete [] vChannels;
+                vChannels       = NULL;
+            }
+
+            if (vBuffers != NULL)
+            {
+                delete [] vBuffers;
+                vBuffers        = NULL;
+            }
+
+            if (bData != NULL)
+            {
+                free_aligned(bData);
+                bData           = NULL;
+            }
+
+            nChannels       = 0;
+            pCallback       = NULL;
+        }
+
+        void MultiOversampler::set_sample_rate(size_t sr)
+        {
+            for (size_t i=0; i<nChannels; ++i)
+                vChannels[i].set_sample_rate(sr);
+        }
+
+        void MultiOversampler::set_mode(over_mode_t mode)
+        {
+            for (size_t i=0; i<nChannels; ++i)
+                vChannels[i].set_mode(mode);
+        }
+
+        void MultiOversampler::set_filtering(bool filter)
+        {
+            for (size_t i=0; i<nChannels; ++i)
+                vChannels[i].set_filtering(filter);
+        }
+
+        void MultiOversampler::set_halfband_taps(size_t taps)
+        {
+            for (size_t i=0; i<nChannels; ++i)
+                vChannels[i].set_halfband_taps(taps);
+        }
+
+        bool MultiOversampler::modified() const
+        {
+            for (size_t i=0; i<nChannels; ++i)
+                if (vChannels[i].modified())
+                    return true;
+            return false;
+        }
+
+        size_t MultiOversampler::get_oversampling() const
+        {
+            return (nChannels > 0) ? vChannels[0].get_oversampling() : 1;
+        }
+
+        void MultiOversampler::update_settings()
+        {
+            for (size_t i=0; i<nChannels; ++i)
+                vChannels[i].update_settings();
+        }
+
+        size_t MultiOversampler::latency() const
+        {
+            return (nChannels > 0) ? vChannels[0].latency() : 0;
+        }
+
+        size_t MultiOversampler::max_latency() const
+        {
+            return (nChannels > 0) ? vChannels[0].max_latency() : 0;
+        }
+
+        void MultiOversampler::process(float * const *dst, const float * const *src, size_t samples, IMultiOversamplerCallback *callback)
+        {
+            if (nChannels <= 0)
+                return;
+
+            size_t os       = get_oversampling();
+            if (os <= 1)
+            {
+                // No oversampling, call the handler directly
+                if (callback != NULL)
+                    callback->process(dst, src, nChannels, samples);
+                else
+                {
+                    for (size_t i=0; i<nChannels; ++i)
+                        dsp::copy(dst[i], src[i], samples);
+                }
+                return;
+            }
+
+            size_t can_do   = MOS_BUFFER_SIZE / os;
+
+            for (size_t offset=0; offset < samples; )
+            {
+                size_t to_do    = lsp_min(samples - offset, can_do);
+
+                // Do oversampling of all channels
+                for (size_t i=0; i<nChannels; ++i)
+                    vChannels[i].upsample(vBuffers[i], &src[i][offset], to_do);
+
+                // Call handler once for all channels
+                if (callback != NULL)
+                    callback->process(vBuffers, vBuffers, nChannels, to_do * os);
+
+                // Do downsampling of all channels
+                for (size_t i=0; i<nChannels; ++i)
+                    vChannels[i].downsample(&dst[i][offset], vBuffers[i], to_do);
+
+                offset         += to_do;
+            }
+        }
+
+        void MultiOversampler::dump(IStateDumper *v) const
+        {
+            v->write("pCallback", pCallback);
+            v->write("nChannels", nChannels);
+            v->write_object_array("vChannels", vChannels, nChannels);
+            v->write("vBuffers", vBuffers);
+            v->write("bData", bData);
+        }
+    }
+} /* namespace lsp */
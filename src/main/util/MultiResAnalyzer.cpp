@@ -0,0 +1,593 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/dsp-units/util/MultiResAnalyzer.h>
+#include <lsp-plug.in/dsp-units/misc/envelope.h>
+#include <lsp-plug.in/dsp-units/misc/windows.h>
+#include <lsp-plug.in/dsp-units/units.h>
+#include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#define MRA_FIR_HALF            23                          /* Half-length of the decimation filter */
+#define MRA_FIR_TAPS            (MRA_FIR_HALF * 2 + 1)      /* Number of taps of the decimation filter */
+#define MRA_FIR_COEFFS          ((MRA_FIR_HALF + 1) / 2)    /* Number of non-zero odd coefficients */
+#define MRA_HISTORY_SIZE        align_size(MRA_FIR_TAPS * 2, 16)
+#define MRA_PASSBAND            0.35f                       /* Part of the sample rate of the level without aliasing */
+#define MRA_RANK_MIN            4
+
+namespace lsp
+{
+    namespace dspu
+    {
+        MultiResAnalyzer::MultiResAnalyzer()
+        {
+            construct();
+        }
+
+        MultiResAnalyzer::~MultiResAnalyzer()
+        {
+            destroy();
+        }
+
+        void MultiResAnalyzer::construct()
+        {
+            nChannels       = 0;
+            nLevels         = 0;
+            nRank           = 0;
+            nSampleRate     = 0;
+            nCounter        = 0;
+            nPeriod         = 0;
+            fReactivity     = 0.0f;
+            fTau            = 1.0f;
+            fRate           = 1.0f;
+            fShift          = 1.0f;
+            nReconfigure    = 0;
+            nEnvelope       = envelope::PINK_NOISE;
+            nWindow         = windows::HANN;
+            nFront          = 0;
+
+            vChannels       = NULL;
+            vData           = NULL;
+            vSigRe          = NULL;
+            vFftReIm        = NULL;
+            vWindow         = NULL;
+            vEnvelope       = NULL;
+            vTemp           = NULL;
+            vFir            = NULL;
+        }
+
+        void MultiResAnalyzer::destroy()
+        {
+            if (vChannels != NULL)
+            {
+                delete [] vChannels;
+                vChannels   = NULL;
+            }
+
+            free_aligned(vData);
+            vData           = NULL;
+            windows::release(vWindow);
+            vWindow         = NULL;
+        }
+
+        bool MultiResAnalyzer::init(size_t channels, size_t rank, size_t levels)
+        {
+            destroy();
+
+            rank                    = lsp_max(rank, size_t(MRA_RANK_MIN));
+            levels                  = lsp_limit(levels, size_t(1), size_t(MRA_LEVELS_MAX));
+            size_t fft_size         = 1 << rank;
+            size_t allocate         = 4 * fft_size +                            // vSigRe, vFftReIm (re + im), vTemp
+                                      levels * fft_size +                       // vEnvelope
+                                      align_size(MRA_FIR_COEFFS, 16) +          // vFir
+                                      channels * levels * (
+                                          fft_size +                            // l->vBuffer
+                                          MRA_HISTORY_SIZE +                    // l->vHistory
+                                          fft_size +                            // l->vAmp
+                                          fft_size * 2                          // l->vData
+                                      );
+
+            // Allocate data
+            float *abuf         = alloc_aligned<float>(vData, allocate);
+            if (abuf == NULL)
+                return false;
+
+            // Allocate channels
+            channel_t *clist    = new channel_t[channels];
+            if (clist == NULL)
+            {
+                free_aligned(vData);
+                vData               = NULL;
+                return false;
+            }
+
+            nChannels           = channels;
+            nLevels             = levels;
+            nRank               = rank;
+
+            // Clear buffers
+            dsp::fill_zero(abuf, allocate);
+
+            // Initialize buffers
+            vSigRe              = abuf;
+            abuf               += fft_size;
+            vFftReIm            = abuf;
+            abuf               += fft_size * 2;
+            vTemp               = abuf;
+            abuf               += fft_size;
+            vEnvelope           = abuf;
+            abuf               += levels * fft_size;
+            vFir                = abuf;
+            abuf               += align_size(MRA_FIR_COEFFS, 16);
+
+            // Initialize channels
+            vChannels           = clist;
+            for (size_t i=0; i<channels; ++i)
+            {
+                channel_t *c        = &vChannels[i];
+
+                for (size_t j=0; j<levels; ++j)
+                {
+                    level_t *l          = &c->vLevels[j];
+
+                    l->vBuffer          = abuf;
+                    abuf               += fft_size;
+                    l->vHistory         = abuf;
+                    abuf               += MRA_HISTORY_SIZE;
+                    l->vAmp             = abuf;
+                    abuf               += fft_size;
+                    l->vData[0]         = abuf;
+                    abuf               += fft_size;
+                    l->vData[1]         = abuf;
+                    abuf               += fft_size;
+
+                    l->nHead            = 0;
+                    l->nHistory         = 0;
+                    l->nPhase           = 0;
+                }
+
+                c->bFreeze          = false;
+                c->bActive          = true;
+            }
+
+            // Design the half-band decimation filter: windowed sinc with zero even taps
+            windows::window(vFftReIm, MRA_FIR_TAPS, windows::BLACKMAN);
+            float sum           = 0.0f;
+            for (size_t j=0; j<MRA_FIR_COEFFS; ++j)
+            {
+                size_t d            = j*2 + 1;
+                float sign          = (j & 1) ? -1.0f : 1.0f;       // sin(pi * d / 2)
+                vFir[j]             = sign * vFftReIm[MRA_FIR_HALF + d] / (M_PI * d);
+                sum                += vFir[j];
+            }
+            // Normalize gain at DC to 1, central tap is 0.5
+            dsp::mul_k2(vFir, 0.25f / sum, MRA_FIR_COEFFS);
+
+            // Set reconfiguration flags
+            nReconfigure        = R_ALL;
+
+            return true;
+        }
+
+        void MultiResAnalyzer::set_sample_rate(size_t sr)
+        {
+            if (nSampleRate == sr)
+                return;
+
+            nSampleRate     = sr;
+            nReconfigure   |= R_ALL;
+        }
+
+        void MultiResAnalyzer::set_rate(float rate)
+        {
+            if (fRate == rate)
+                return;
+
+            fRate           = rate;
+            nReconfigure   |= R_COUNTERS | R_TAU;
+        }
+
+        void MultiResAnalyzer::set_window(size_t window)
+        {
+            if (nWindow == window)
+                return;
+
+            nWindow         = window;
+            nReconfigure   |= R_WINDOW;
+        }
+
+        void MultiResAnalyzer::set_envelope(size_t envelope)
+        {
+            if (nEnvelope == envelope)
+                return;
+
+            nEnvelope       = envelope;
+            nReconfigure   |= R_ENVELOPE;
+        }
+
+        void MultiResAnalyzer::set_shift(float shift)
+        {
+            if (fShift == shift)
+                return;
+
+            fShift          = shift;
+            nReconfigure   |= R_ENVELOPE;
+        }
+
+        void MultiResAnalyzer::set_reactivity(float reactivity)
+        {
+            if (fReactivity == reactivity)
+                return;
+
+            fReactivity     = reactivity;
+            nReconfigure   |= R_TAU;
+        }
+
+        bool MultiResAnalyzer::freeze_channel(size_t channel, bool freeze)
+        {
+            if (channel >= nChannels)
+                return false;
+            vChannels[channel].bFreeze      = freeze;
+            return true;
+        }
+
+        bool MultiResAnalyzer::enable_channel(size_t channel, bool enable)
+        {
+            if (channel >= nChannels)
+                return false;
+            vChannels[channel].bActive      = enable;
+            return true;
+        }
+
+        void MultiResAnalyzer::reconfigure()
+        {
+            if (!nReconfigure)
+                return;
+
+            size_t fft_size     = 1 << nRank;
+            nPeriod             = lsp_max(size_t(float(nSampleRate) / fRate), size_t(1));
+
+            // Update envelope
+            if (nReconfigure & R_ENVELOPE)
+            {
+                // Each next level has twice lower frequency for the same bin, compute the
+                // envelope for the first level and the ratio between envelope of level and
+                // it's successor
+                envelope::reverse_noise(vEnvelope, fft_size, envelope::envelope_t(nEnvelope));
+                envelope::reverse_noise(vFftReIm, fft_size * 2, envelope::envelope_t(nEnvelope));
+                float k             = vFftReIm[1] / vEnvelope[1];
+                dsp::mul_k2(vEnvelope, fShift / fft_size, fft_size);
+
+                for (size_t i=1; i<nLevels; ++i)
+                {
+                    float *dst          = &vEnvelope[i * fft_size];
+                    dsp::mul_k3(dst, &dst[-ssize_t(fft_size)], k, fft_size);
+                    dst[0]              = vEnvelope[0];
+                }
+            }
+
+            // Clear analysis
+            if (nReconfigure & R_ANALYSIS)
+            {
+                for (size_t i=0; i<nChannels; ++i)
+                {
+                    channel_t *c        = &vChannels[i];
+                    for (size_t j=0; j<nLevels; ++j)
+                    {
+                        level_t *l          = &c->vLevels[j];
+                        dsp::fill_zero(l->vBuffer, fft_size);
+                        dsp::fill_zero(l->vHistory, MRA_HISTORY_SIZE);
+                        dsp::fill_zero(l->vAmp, fft_size);
+                        dsp::fill_zero(l->vData[0], fft_size);
+                        dsp::fill_zero(l->vData[1], fft_size);
+                        l->nHead            = 0;
+                        l->nHistory         = 0;
+                        l->nPhase           = 0;
+                    }
+                }
+            }
+            // Update window
+            if (nReconfigure & R_WINDOW)
+            {
+                const float *wnd    = windows::acquire(windows::window_t(nWindow), fft_size);
+                windows::release(vWindow);
+                vWindow             = wnd;
+            }
+            // Update reactivity
+            if (nReconfigure & R_TAU)
+                fTau    = 1.0f - expf(logf(1.0f - M_SQRT1_2) / seconds_to_samples(float(nSampleRate) / float(nPeriod), fReactivity));
+            // Update counters
+            if (nReconfigure & R_COUNTERS)
+                nCounter            = 0;
+
+            // Clear reconfiguration flag
+            nReconfigure    = 0;
+        }
+
+        size_t MultiResAnalyzer::decimate(level_t *l, float *dst, const float *src, size_t count)
+        {
+            float *h        = l->vHistory;
+            size_t n        = 0;
+
+            for (size_t i=0; i<count; ++i)
+            {
+                // Store sample to the history, the history is duplicated to have contiguous window
+                float s                         = src[i];
+                h[l->nHistory]                  = s;
+                h[l->nHistory + MRA_FIR_TAPS]   = s;
+                if ((++l->nHistory) >= MRA_FIR_TAPS)
+                    l->nHistory                     = 0;
+
+                // Emit each second sample
+                l->nPhase      ^= 1;
+                if (l->nPhase)
+                    continue;
+
+                // Apply the half-band filter, all even taps except the central one are zero
+                const float *w  = &h[l->nHistory + MRA_FIR_HALF];
+                float y         = 0.5f * w[0];
+                for (size_t j=0; j<MRA_FIR_COEFFS; ++j)
+                {
+                    ssize_t d       = j*2 + 1;
+                    y              += vFir[j] * (w[-d] + w[d]);
+                }
+                dst[n++]        = y;
+            }
+
+            return n;
+        }
+
+        void MultiResAnalyzer::push(level_t *l, const float *src, size_t count)
+        {
+            size_t fft_size     = 1 << nRank;
+            size_t tail         = fft_size - l->nHead;
+
+            if (count >= tail)
+            {
+                dsp::copy(&l->vBuffer[l->nHead], src, tail);
+                dsp::copy(l->vBuffer, &src[tail], count - tail);
+                l->nHead            = count - tail;
+            }
+            else
+            {
+                dsp::copy(&l->vBuffer[l->nHead], src, count);
+                l->nHead           += count;
+            }
+        }
+
+        void MultiResAnalyzer::transform(level_t *l)
+        {
+            size_t fft_size     = 1 << nRank;
+            size_t fft_csize    = (fft_size >> 1) + 1;
+            size_t tail         = fft_size - l->nHead;
+
+            // Prepare the real buffer, the oldest sample is at the head of the ring buffer
+            if (vWindow != NULL)
+            {
+                dsp::mul3(vSigRe, &l->vBuffer[l->nHead], vWindow, tail);
+                if (l->nHead > 0)
+                    dsp::mul3(&vSigRe[tail], l->vBuffer, &vWindow[tail], l->nHead);
+            }
+            else
+            {
+                // The window table is not available, apply rectangular window
+                dsp::copy(vSigRe, &l->vBuffer[l->nHead], tail);
+                if (l->nHead > 0)
+                    dsp::copy(&vSigRe[tail], l->vBuffer, l->nHead);
+            }
+
+            // Do Real->complex conversion and FFT
+            dsp::pcomplex_r2c(vFftReIm, vSigRe, fft_size);
+            dsp::packed_direct_fft(vFftReIm, vFftReIm, nRank);
+            // Get complex argument
+            dsp::pcomplex_mod(vFftReIm, vFftReIm, fft_csize);
+            // Mix with the previous value
+            dsp::mix2(l->vAmp, vFftReIm, 1.0 - fTau, fTau, fft_csize);
+        }
+
+        void MultiResAnalyzer::publish()
+        {
+            size_t fft_size     = 1 << nRank;
+            size_t back         = nFront ^ 1;
+
+            for (size_t i=0; i<nChannels; ++i)
+            {
+                channel_t *c        = &vChannels[i];
+                for (size_t j=0; j<nLevels; ++j)
+                {
+                    level_t *l          = &c->vLevels[j];
+                    dsp::copy(l->vData[back], l->vAmp, fft_size);
+                }
+            }
+
+            atomic_swap(&nFront, back);
+        }
+
+        void MultiResAnalyzer::process(const float * const *in, size_t samples)
+        {
+            if (vChannels == NULL)
+                return;
+
+            // Auto-apply reconfiguration
+            reconfigure();
+
+            size_t fft_size     = 1 << nRank;
+
+            for (size_t offset = 0; offset < samples; )
+            {
+                size_t to_process   = lsp_min(samples - offset, lsp_min(nPeriod - nCounter, fft_size));
+
+                // Commit data to the levels of each channel
+                for (size_t i=0; i<nChannels; ++i)
+                {
+                    channel_t *c        = &vChannels[i];
+                    const float *src    = ((in != NULL) && (in[i] != NULL)) ? &in[i][offset] : NULL;
+                    if (src == NULL)
+                    {
+                        dsp::fill_zero(vTemp, to_process);
+                        src                 = vTemp;
+                    }
+
+                    push(&c->vLevels[0], src, to_process);
+                    for (size_t j=1, n=to_process; j<nLevels; ++j)
+                    {
+                        level_t *l          = &c->vLevels[j];
+                        n                   = decimate(l, vTemp, src, n);
+                        push(l, vTemp, n);
+                        src                 = vTemp;
+                    }
+                }
+
+                // Update positions
+                offset         += to_process;
+                nCounter       += to_process;
+                if (nCounter < nPeriod)
+                    continue;
+                nCounter        = 0;
+
+                // Perform FFT for all levels of all channels and publish the result
+                for (size_t i=0; i<nChannels; ++i)
+                {
+                    channel_t *c        = &vChannels[i];
+                    if (c->bFreeze)
+                        continue;
+
+                    for (size_t j=0; j<nLevels; ++j)
+                    {
+                        level_t *l          = &c->vLevels[j];
+                        if (c->bActive)
+                            transform(l);
+                        else
+                            dsp::fill_zero(l->vAmp, fft_size);
+                    }
+                }
+
+                publish();
+            }
+        }
+
+        void MultiResAnalyzer::get_frequencies(float *frq, uint32_t *idx, float start, float stop, size_t count)
+        {
+            size_t fft_size     = 1 << nRank;
+            size_t fft_csize    = (fft_size >> 1) + 1;
+            float norm          = (count > 1) ? logf(stop/start) / (count - 1) : 0.0f;
+
+            for (size_t i=0; i<count; ++i)
+            {
+                float f             = start * expf(i * norm);
+
+                // Select the level with the best resolution that has no aliasing at the frequency
+                size_t level        = 0;
+                while ((level + 1) < nLevels)
+                {
+                    if (f > MRA_PASSBAND * float(nSampleRate) / float(1 << (level + 1)))
+                        break;
+                    ++level;
+                }
+
+                size_t ix           = (f * float(fft_size << level)) / float(nSampleRate) + 0.5f;
+                if (ix >= fft_csize)
+                    ix                  = fft_csize - 1;
+
+                frq[i]              = f;
+                idx[i]              = (level << MRA_LEVEL_SHIFT) | ix;
+            }
+        }
+
+        bool MultiResAnalyzer::get_spectrum(size_t channel, float *out, const uint32_t *idx, size_t count)
+        {
+            if ((vChannels == NULL) || (channel >= nChannels))
+                return false;
+
+            size_t fft_size     = 1 << nRank;
+            size_t front        = atomic_add(&nFront, 0);
+            channel_t *c        = &vChannels[channel];
+
+            for (size_t i=0; i<count; ++i)
+            {
+                size_t level        = lsp_min(size_t(idx[i] >> MRA_LEVEL_SHIFT), nLevels - 1);
+                size_t j            = idx[i] & ((1 << MRA_LEVEL_SHIFT) - 1);
+                out[i]              = c->vLevels[level].vData[front][j] * vEnvelope[level * fft_size + j];
+            }
+
+            return true;
+        }
+
+        void MultiResAnalyzer::dump(IStateDumper *v) const
+        {
+            v->write("nChannels", nChannels);
+            v->write("nLevels", nLevels);
+            v->write("nRank", nRank);
+            v->write("nSampleRate", nSampleRate);
+            v->write("nCounter", nCounter);
+            v->write("nPeriod", nPeriod);
+            v->write("fReactivity", fReactivity);
+            v->write("fTau", fTau);
+            v->write("fRate", fRate);
+            v->write("fShift", fShift);
+            v->write("nReconfigure", nReconfigure);
+            v->write("nEnvelope", nEnvelope);
+            v->write("nWindow", nWindow);
+            v->write("nFront", int32_t(nFront));
+
+            v->begin_array("vChannels", vChannels, nChannels);
+            for (size_t i=0; i<nChannels; ++i)
+            {
+                const channel_t *c = &vChannels[i];
+                v->begin_object(c, sizeof(channel_t));
+                {
+                    v->begin_array("vLevels", c->vLevels, nLevels);
+                    for (size_t j=0; j<nLevels; ++j)
+                    {
+                        const level_t *l = &c->vLevels[j];
+                        v->begin_object(l, sizeof(level_t));
+                        {
+                            v->write("vBuffer", l->vBuffer);
+                            v->write("vHistory", l->vHistory);
+                            v->write("vAmp", l->vAmp);
+                            v->write("vData[0]", l->vData[0]);
+                            v->write("vData[1]", l->vData[1]);
+                            v->write("nHead", l->nHead);
+                            v->write("nHistory", l->nHistory);
+                            v->write("nPhase", l->nPhase);
+                        }
+                        v->end_object();
+                    }
+                    v->end_array();
+
+                    v->write("bFreeze", c->bFreeze);
+                    v->write("bActive", c->bActive);
+                }
+                v->end_object();
+            }
+            v->end_array();
+
+            v->write("vData", vData);
+            v->write("vSigRe", vSigRe);
+            v->write("vFftReIm", vFftReIm);
+            v->write("vWindow", vWindow);
+            v->write("vEnvelope", vEnvelope);
+            v->write("vTemp", vTemp);
+            v->write("vFir", vFir);
+        }
+    }
+} /* namespace lsp */
@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/dsp-units/util/MultiShiftBuffer.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        MultiShiftBuffer::MultiShiftBuffer()
+        {
+            construct();
+        }
+
+        MultiShiftBuffer::~MultiShiftBuffer()
+        {
+            destroy();
+        }
+
+        void MultiShiftBuffer::construct()
+        {
+            vData       = NULL;
+            nChannels   = 0;
+            nCapacity   = 0;
+            nStride     = 0;
+            nHead       = 0;
+            nTail       = 0;
+            pData       = NULL;
+        }
+
+        void MultiShiftBuffer::destroy()
+        {
+            free_aligned(pData);
+            vData       = NULL;
+            nChannels   = 0;
+            nCapacity   = 0;
+            nStride     = 0;
+            nHead       = 0;
+            nTail       = 0;
+        }
+
+        bool MultiShiftBuffer::init(size_t channels, size_t size, size_t gap)
+        {
+            // Check arguments
+            if ((gap > size) || (channels <= 0))
+                return false;
+
+            // The capacity is a power of two not less than 0x10, so each channel is aligned
+            size_t capacity     = 0x10;
+            while (capacity < size)
+                capacity          <<= 1;
+            size_t stride       = capacity * 2;
+
+            if ((pData == NULL) || (capacity != nCapacity) || (channels != nChannels))
+            {
+                uint8_t *data       = NULL;
+                float *ptr          = alloc_aligned<float>(data, stride * channels);
+                if (ptr == NULL)
+                    return false;
+
+                free_aligned(pData);
+                vData               = ptr;
+                pData               = data;
+            }
+
+            nChannels           = channels;
+            nCapacity           = capacity;
+            nStride             = stride;
+            nHead               = 0;
+            nTail               = gap;
+
+            // Zero the gap
+            for (size_t i=0; i<nChannels; ++i)
+                ring_write(&vData[i * nStride], 0, NULL, gap);
+
+            return true;
+        }
+
+        void MultiShiftBuffer::ring_write(float *buf, size_t pos, const float *data, size_t count)
+        {
+            // Write the data and it's mirror, count should not be greater than capacity
+            pos            &= nCapacity - 1;
+
+            while (count > 0)
+            {
+                size_t n        = lsp_min(count, nCapacity - pos);
+                if (data != NULL)
+                {
+                    dsp::copy(&buf[pos], data, n);
+                    dsp::copy(&buf[pos + nCapacity], data, n);
+                    data           += n;
+                }
+                else
+                {
+                    dsp::fill_zero(&buf[pos], n);
+                    dsp::fill_zero(&buf[pos + nCapacity], n);
+                }
+                count          -= n;
+                pos             = 0;
+            }
+        }
+
+        inline void MultiShiftBuffer::ring_shift()
+        {
+            // Keep the head within the first copy of data
+            if (nHead >= nCapacity)
+            {
+                nHead          -= nCapacity;
+                nTail          -= nCapacity;
+            }
+        }
+
+        size_t MultiShiftBuffer::append(const float * const *data, size_t count)
+        {
+            if (vData == NULL)
+                return 0;
+
+            count           = lsp_min(count, nCapacity - (nTail - nHead));
+            for (size_t i=0; i<nChannels; ++i)
+                ring_write(&vData[i * nStride], nTail, (data != NULL) ? data[i] : NULL, count);
+            nTail          += count;
+
+            return count;
+        }
+
+        size_t MultiShiftBuffer::shift(float * const *data, size_t count)
+        {
+            if (vData == NULL)
+                return 0;
+
+            count           = lsp_min(count, nTail - nHead);
+            if (data != NULL)
+            {
+                for (size_t i=0; i<nChannels; ++i)
+                {
+                    if (data[i] != NULL)
+                        dsp::copy(data[i], &vData[i * nStride + nHead], count);
+                }
+            }
+            nHead          += count;
+            ring_shift();
+
+            return count;
+        }
+
+        size_t MultiShiftBuffer::shift(size_t count)
+        {
+            if (vData == NULL)
+                return 0;
+
+            count           = lsp_min(count, nTail - nHead);
+            nHead          += count;
+            ring_shift();
+
+            return count;
+        }
+
+        float *MultiShiftBuffer::head(size_t channel)
+        {
+            return ((vData != NULL) && (channel < nChannels)) ? &vData[channel * nStride + nHead] : NULL;
+        }
+
+        float *MultiShiftBuffer::tail(size_t channel)
+        {
+            return ((vData != NULL) && (channel < nChannels)) ? &vData[channel * nStride + nTail] : NULL;
+        }
+
+        float *MultiShiftBuffer::head(size_t channel, size_t offset)
+        {
+            if ((vData == NULL) || (channel >= nChannels))
+                return NULL;
+            offset     += nHead;
+            return (offset >= nTail) ? NULL : &vData[channel * nStride + offset];
+        }
+
+        float *MultiShiftBuffer::tail(size_t channel, size_t offset)
+        {
+            if ((vData == NULL) || (channel >= nChannels))
+                return NULL;
+            ssize_t off     = nTail - offset;
+            return (off < ssize_t(nHead)) ? NULL : &vData[channel * nStride + off];
+        }
+
+        float MultiShiftBuffer::last(size_t channel, size_t offset) const
+        {
+            if ((vData == NULL) || (channel >= nChannels))
+                return 0.0f;
+            ssize_t off     = nTail - offset;
+            return (off >= ssize_t(nHead)) ? vData[channel * nStride + off] : 0.0f;
+        }
+
+        void MultiShiftBuffer::dump(IStateDumper *v) const
+        {
+            v->write("vData", vData);
+            v->write("nChannels", nChannels);
+            v->write("nCapacity", nCapacity);
+            v->write("nStride", nStride);
+            v->write("nHead", nHead);
+            v->write("nTail", nTail);
+            v->write("pData", pData);
+        }
+    }
+} /* namespace lsp */
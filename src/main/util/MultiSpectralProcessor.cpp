@@ -0,0 +1,346 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/dsp-units/util/MultiSpectralProcessor.h>
+#include <lsp-plug.in/dsp-units/misc/fft.h>
+#include <lsp-plug.in/dsp-units/misc/windows.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        MultiSpectralProcessor::MultiSpectralProcessor()
+        {
+            construct();
+        }
+
+        MultiSpectralProcessor::~MultiSpectralProcessor()
+        {
+            destroy();
+        }
+
+        void MultiSpectralProcessor::construct()
+        {
+            nChannels       = 0;
+            nRank           = 0;
+            nMaxRank        = 0;
+            fPhase          = 0.0f;
+            fOverlap        = 0.5f;
+            nHop            = 0;
+            pWnd            = NULL;
+            pFftTable       = NULL;
+            vChannels       = NULL;
+            vSpectra        = NULL;
+            nOffset         = 0;
+            pData           = NULL;
+            bUpdate         = true;
+
+            pFunc           = NULL;
+            pObject         = NULL;
+            pSubject        = NULL;
+        }
+
+        bool MultiSpectralProcessor::init(size_t channels, size_t max_rank)
+        {
+            destroy();
+
+            // Allocate buffer: window + (output, input and FFT x2) for each channel
+            size_t buf_sz   = 1 << max_rank;
+            float *ptr      = alloc_aligned<float>(pData, buf_sz * (1 + channels * 4), DEFAULT_ALIGN);
+            if (ptr == NULL)
+                return false;
+
+            vChannels       = new channel_t[channels];
+            vSpectra        = new float *[channels];
+            if ((vChannels == NULL) || (vSpectra == NULL))
+            {
+                destroy();
+                return false;
+            }
+
+            nChannels       = channels;
+            nRank           = max_rank;
+            nMaxRank        = max_rank;
+            fPhase          = 0.0f;
+            fOverlap        = 0.5f;
+            nHop            = 0;
+            pWnd            = ptr;
+            bUpdate         = true;
+
+            // The table is optional, complex transforms are used without it
+            pFftTable       = fft::acquire(max_rank);
+
+            for (size_t i=0; i<channels; ++i)
+            {
+                channel_t *c        = &vChannels[i];
+                c->pOutBuf          = NULL;
+                c->pInBuf           = NULL;
+                c->pFftBuf          = NULL;
+                vSpectra[i]         = NULL;
+            }
+
+            return true;
+        }
+
+        void MultiSpectralProcessor::destroy()
+        {
+            if (vChannels != NULL)
+            {
+                delete [] vChannels;
+                vChannels       = NULL;
+            }
+
+            if (vSpectra != NULL)
+            {
+                delete [] vSpectra;
+                vSpectra        = NULL;
+            }
+
+            if (pData != NULL)
+            {
+                free_aligned(pData);
+                pData           = NULL;
+            }
+
+            fft::release(pFftTable);
+            pFftTable       = NULL;
+
+            nChannels       = 0;
+            nRank           = 0;
+            nMaxRank        = 0;
+            fPhase          = 0.0f;
+            fOverlap        = 0.5f;
+            nHop            = 0;
+            pWnd            = NULL;
+            nOffset         = 0;
+            bUpdate         = false;
+
+            pFunc           = NULL;
+            pObject         = NULL;
+            pSubject        = NULL;
+        }
+
+        void MultiSpectralProcessor::bind(multi_spectral_processor_func_t func, void *object, void *subject)
+        {
+            pFunc           = func;
+            pObject         = object;
+            pSubject        = subject;
+        }
+
+        void MultiSpectralProcessor::unbind()
+        {
+            pFunc           = NULL;
+            pObject         = NULL;
+            pSubject        = NULL;
+        }
+
+        void MultiSpectralProcessor::update_settings()
+        {
+            // Distribute buffers, the stride between channels is defined by the maximum rank
+            size_t buf_size = 1 << nRank;
+            size_t stride   = 4 << nMaxRank;
+            float *ptr      = &pWnd[1 << nMaxRank];
+
+            for (size_t i=0; i<nChannels; ++i)
+            {
+                channel_t *c    = &vChannels[i];
+
+                c->pOutBuf      = ptr;
+                c->pInBuf       = &c->pOutBuf[buf_size];
+                c->pFftBuf      = &c->pInBuf[buf_size];
+                vSpectra[i]     = c->pFftBuf;
+
+                dsp::fill_zero(c->pOutBuf, buf_size*4);     // OutBuf + InBuf + Fft(x2)
+                ptr            += stride;
+            }
+
+            // Compute the hop size
+            nHop            = buf_size - size_t(buf_size * fOverlap);
+            nHop            = lsp_limit(nHop, size_t(1), buf_size);
+
+            // Compute the window and normalize it to have constant overlap-add sum,
+            // the FFT buffer of the first channel is used as a temporary storage for the sum
+            windows::sqr_cosine(pWnd, buf_size);
+            if (nChannels > 0)
+            {
+                float *sum      = vChannels[0].pFftBuf;
+                dsp::fill_zero(sum, nHop);
+                for (size_t i=0; i<buf_size; i += nHop)
+                    dsp::add2(sum, &pWnd[i], lsp_min(nHop, buf_size - i));
+                for (size_t i=0; i<buf_size; ++i)
+                {
+                    float s         = sum[i % nHop];
+                    pWnd[i]         = (s > 1e-6f) ? pWnd[i] / s : 1.0f;
+                }
+                dsp::fill_zero(sum, nHop);
+            }
+
+            // Reset pointers
+            nOffset         = nHop * fPhase;
+
+            // Mark settings applied
+            bUpdate         = false;
+        }
+
+        void MultiSpectralProcessor::set_phase(float phase)
+        {
+            fPhase          = (phase < 0.0f) ? 0.0f : (phase > 1.0f) ? 1.0f : phase;
+            bUpdate         = true;
+        }
+
+        void MultiSpectralProcessor::set_rank(size_t rank)
+        {
+            if ((rank == nRank) || (rank > nMaxRank))
+                return;
+
+            nRank           = rank;
+            bUpdate         = true;
+        }
+
+        void MultiSpectralProcessor::set_overlap(float overlap)
+        {
+            overlap         = lsp_limit(overlap, 0.0f, 1.0f);
+            if (overlap == fOverlap)
+                return;
+
+            fOverlap        = overlap;
+            bUpdate         = true;
+        }
+
+        void MultiSpectralProcessor::process(float * const *dst, const float * const *src, size_t count)
+        {
+            // Check if we need to commit new settings
+            if (bUpdate)
+                update_settings();
+
+            size_t buf_size     = 1 << nRank;
+            size_t frame_size   = nHop;
+            size_t tail         = buf_size - frame_size;
+            bool real_fft       = (pFftTable != NULL) && (nRank >= 2);
+
+            for (size_t offset=0; offset < count; )
+            {
+                // Need to perform transformations?
+                if (nOffset >= frame_size)
+                {
+                    // Perform direct FFT of all channels
+                    for (size_t i=0; i<nChannels; ++i)
+                    {
+                        channel_t *c        = &vChannels[i];
+                        if (pFunc == NULL)
+                            dsp::move(c->pFftBuf, c->pInBuf, buf_size);                // Copy data to FFT buffer
+                        else if (real_fft)
+                        {
+                            fft::real_direct(c->pFftBuf, c->pInBuf, nRank, pFftTable, nMaxRank);
+                            fft::real_expand(c->pFftBuf, nRank);                       // Restore the full spectrum
+                        }
+                        else
+                        {
+                            dsp::pcomplex_r2c(c->pFftBuf, c->pInBuf, buf_size);        // Convert from real to packed complex
+                            dsp::packed_direct_fft(c->pFftBuf, c->pFftBuf, nRank);     // Perform direct FFT
+                        }
+                    }
+
+                    // Call the function for all channels at once
+                    if (pFunc != NULL)
+                        pFunc(pObject, pSubject, vSpectra, nRank);
+
+                    for (size_t i=0; i<nChannels; ++i)
+                    {
+                        channel_t *c        = &vChannels[i];
+
+                        // Perform reverse FFT
+                        if ((pFunc != NULL) && (real_fft))
+                        {
+                            fft::real_fold(c->pFftBuf, nRank);                         // Take the conjugate-symmetric part
+                            fft::real_reverse(c->pFftBuf, c->pFftBuf, nRank, pFftTable, nMaxRank);
+                        }
+                        else if (pFunc != NULL)
+                        {
+                            dsp::packed_reverse_fft(c->pFftBuf, c->pFftBuf, nRank);    // Perform reverse FFT
+                            dsp::pcomplex_c2r(c->pFftBuf, c->pFftBuf, buf_size);       // Unpack complex numbers
+                        }
+
+                        // Shift input and output buffers
+                        dsp::move(c->pOutBuf, &c->pOutBuf[frame_size], buf_size + tail); // Shift buffers
+                        dsp::fill_zero(&c->pOutBuf[tail], frame_size);                  // Fill tail of output buffer with zeros
+
+                        // Apply window and add to the output buffer
+                        dsp::fmadd3(c->pOutBuf, c->pFftBuf, pWnd, buf_size);
+                    }
+
+                    // Reset read/write offset
+                    nOffset     = 0;
+                }
+
+                // Estimate number of samples to process
+                size_t to_process   = lsp_min(frame_size - nOffset, count - offset);
+
+                // Copy data
+                for (size_t i=0; i<nChannels; ++i)
+                {
+                    channel_t *c        = &vChannels[i];
+                    dsp::copy(&c->pInBuf[tail + nOffset], &src[i][offset], to_process);
+                    dsp::copy(&dst[i][offset], &c->pOutBuf[nOffset], to_process);
+                }
+
+                // Update pointers
+                nOffset    += to_process;
+                offset     += to_process;
+            }
+        }
+
+        void MultiSpectralProcessor::dump(IStateDumper *v) const
+        {
+            v->write("nChannels", nChannels);
+            v->write("nRank", nRank);
+            v->write("nMaxRank", nMaxRank);
+            v->write("fPhase", fPhase);
+            v->write("fOverlap", fOverlap);
+            v->write("nHop", nHop);
+            v->write("pWnd", pWnd);
+            v->write("pFftTable", pFftTable);
+            v->begin_array("vChannels", vChannels, nChannels);
+            for (size_t i=0; i<nChannels; ++i)
+            {
+                const channel_t *c = &vChannels[i];
+                v->begin_object(c, sizeof(channel_t));
+                {
+                    v->write("pOutBuf", c->pOutBuf);
+                    v->write("pInBuf", c->pInBuf);
+                    v->write("pFftBuf", c->pFftBuf);
+                }
+                v->end_object();
+            }
+            v->end_array();
+            v->write("vSpectra", vSpectra);
+            v->write("nOffset", nOffset);
+            v->write("pData", pData);
+            v->write("bUpdate", bUpdate);
+
+            v->write("pFunc", pFunc);
+            v->write("pObject", pObject);
+            v->write("pSubject", pSubject);
+        }
+    }
+} /* namespace lsp */
@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/dsp-units/util/MultiTapDelay.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#define DELAY_GAP       0x200
+
+namespace lsp
+{
+    namespace dspu
+    {
+        MultiTapDelay::MultiTapDelay()
+        {
+            construct();
+        }
+
+        MultiTapDelay::~MultiTapDelay()
+        {
+            destroy();
+        }
+
+        void MultiTapDelay::construct()
+        {
+            vBuffer     = NULL;
+            vTaps       = NULL;
+            nHead       = 0;
+            nSize       = 0;
+            nMaxDelay   = 0;
+            nTaps       = 0;
+            pData       = NULL;
+        }
+
+        void MultiTapDelay::destroy()
+        {
+            free_aligned(pData);
+            vBuffer     = NULL;
+            vTaps       = NULL;
+            nSize       = 0;
+            nTaps       = 0;
+        }
+
+        bool MultiTapDelay::init(size_t max_delay, size_t taps)
+        {
+            size_t size         = align_size(max_delay + DELAY_GAP, DELAY_GAP);
+            size_t tap_size     = align_size(sizeof(tap_t) * taps, DEFAULT_ALIGN);
+            size_t to_alloc     = size * sizeof(float) + tap_size;
+
+            uint8_t *data       = NULL;
+            uint8_t *ptr        = alloc_aligned<uint8_t>(data, to_alloc);
+            if (ptr == NULL)
+                return false;
+
+            free_aligned(pData);
+
+            vBuffer             = reinterpret_cast<float *>(ptr);
+            ptr                += size * sizeof(float);
+            vTaps               = reinterpret_cast<tap_t *>(ptr);
+            ptr                += tap_size;
+
+            nHead               = 0;
+            nSize               = size;
+            nMaxDelay           = max_delay;
+            nTaps               = taps;
+            pData               = data;
+
+            dsp::fill_zero(vBuffer, nSize);
+            for (size_t i=0; i<taps; ++i)
+            {
+                tap_t *t            = &vTaps[i];
+                t->nDelay           = 0;
+                t->nNewDelay        = 0;
+                t->fGain            = 1.0f;
+                t->fNewGain         = 1.0f;
+            }
+
+            return true;
+        }
+
+        void MultiTapDelay::set_delay(size_t tap, size_t delay)
+        {
+            if (tap >= nTaps)
+                return;
+            vTaps[tap].nNewDelay    = lsp_min(delay, nMaxDelay);
+        }
+
+        size_t MultiTapDelay::get_delay(size_t tap) const
+        {
+            return (tap < nTaps) ? vTaps[tap].nNewDelay : 0;
+        }
+
+        void MultiTapDelay::set_gain(size_t tap, float gain)
+        {
+            if (tap >= nTaps)
+                return;
+            vTaps[tap].fNewGain     = gain;
+        }
+
+        float MultiTapDelay::get_gain(size_t tap) const
+        {
+            return (tap < nTaps) ? vTaps[tap].fNewGain : 0.0f;
+        }
+
+        void MultiTapDelay::process(float *dst, const float *src, size_t count)
+        {
+            process_taps(dst, NULL, src, count);
+        }
+
+        void MultiTapDelay::process(float * const *dst, const float *src, size_t count)
+        {
+            process_taps(NULL, dst, src, count);
+        }
+
+        void MultiTapDelay::process_taps(float *sum, float * const *out, const float *src, size_t count)
+        {
+            size_t gap      = nSize - nMaxDelay;
+
+            for (size_t offset=0; offset < count; )
+            {
+                size_t to_do    = lsp_min(count - offset, gap);
+                size_t head     = nHead;
+
+                // Write the input data to the buffer once
+                for (size_t in=0; in < to_do; )
+                {
+                    size_t to_copy  = lsp_min(nSize - nHead, to_do - in);
+                    dsp::copy(&vBuffer[nHead], &src[offset + in], to_copy);
+                    nHead           = (nHead + to_copy) % nSize;
+                    in             += to_copy;
+                }
+
+                if (sum != NULL)
+                    dsp::fill_zero(&sum[offset], to_do);
+
+                // Read all taps
+                for (size_t i=0; i<nTaps; ++i)
+                {
+                    tap_t *t        = &vTaps[i];
+                    float *dst      = (sum != NULL) ? &sum[offset] :
+                                      (out[i] != NULL) ? &out[i][offset] : NULL;
+                    if (dst == NULL)
+                        continue;
+
+                    if ((t->nDelay == t->nNewDelay) && (t->fGain == t->fNewGain))
+                    {
+                        // Constant settings: at most two contiguous reads from the buffer
+                        size_t pos      = (head + nSize - t->nDelay) % nSize;
+                        size_t n        = lsp_min(nSize - pos, to_do);
+                        if (sum != NULL)
+                        {
+                            dsp::fmadd_k3(dst, &vBuffer[pos], t->fGain, n);
+                            dsp::fmadd_k3(&dst[n], vBuffer, t->fGain, to_do - n);
+                        }
+                        else
+                        {
+                            dsp::mul_k3(dst, &vBuffer[pos], t->fGain, n);
+                            dsp::mul_k3(&dst[n], vBuffer, t->fGain, to_do - n);
+                        }
+                    }
+                    else
+                    {
+                        // Ramp the delay and the gain over the whole call
+                        float dd        = float(ssize_t(t->nNewDelay) - ssize_t(t->nDelay)) / float(count);
+                        float dg        = (t->fNewGain - t->fGain) / float(count);
+
+                        for (size_t j=0; j<to_do; ++j)
+                        {
+                            size_t step     = offset + j;
+                            size_t delay    = ssize_t(t->nDelay + dd * step);
+                            float s         = vBuffer[(head + j + nSize - delay) % nSize] * (t->fGain + dg * step);
+                            dst[j]          = (sum != NULL) ? dst[j] + s : s;
+                        }
+                    }
+                }
+
+                offset         += to_do;
+            }
+
+            // Commit the ramped settings
+            for (size_t i=0; i<nTaps; ++i)
+            {
+                tap_t *t        = &vTaps[i];
+                t->nDelay       = t->nNewDelay;
+                t->fGain        = t->fNewGain;
+            }
+        }
+
+        void MultiTapDelay::clear()
+        {
+            if (vBuffer == NULL)
+                return;
+            dsp::fill_zero(vBuffer, nSize);
+        }
+
+        void MultiTapDelay::dump(IStateDumper *v) const
+        {
+            v->write("vBuffer", vBuffer);
+            v->begin_array("vTaps", vTaps, nTaps);
+            {
+                for (size_t i=0; i<nTaps; ++i)
+                {
+                    const tap_t *t = &vTaps[i];
+
+                    v->begin_object(t, sizeof(tap_t));
+                    {
+                        v->write("nDelay", t->nDelay);
+                        v->write("nNewDelay", t->nNewDelay);
+                        v->write("fGain", t->fGain);
+                        v->write("fNewGain", t->fNewGain);
+                    }
+                    v->end_object();
+                }
+            }
+            v->end_array();
+            v->write("nHead", nHead);
+            v->write("nSize", nSize);
+            v->write("nMaxDelay", nMaxDelay);
+            v->write("nTaps", nTaps);
+            v->write("pData", pData);
+        }
+    }
+} /* namespace lsp */
@@ -24,6 +24,8 @@
 #include <lsp-plug.in/stdlib/math.h>
 
 #define PROCESS_BUF_LIMIT_SIZE  (12 * 1024) // Multiple of 3, 4 and 8
+#define KERNEL_BLOCK_SIZE       0x100       // Size of the block for waveform kernels
+#define KERNEL_LANES            8           // Number of samples processed by waveform kernels at once
 
 namespace lsp
 {
@@ -113,6 +115,15 @@ namespace lsp
 
             nFreqCtrlWord_Over          = 0;
 
+            enBLMode                    = BL_OVERSAMPLING;
+            for (size_t i=0; i<OSCILLATOR_BLEP_POINTS; ++i)
+            {
+                vBlep[i].nPhase             = 0;
+                vBlep[i].fStep              = 0.0f;
+                vBlep[i].fSlope             = 0.0f;
+            }
+            nBlepPoints                 = 0;
+
             bSync                       = true;
         }
 
@@ -378,281 +389,457 @@ namespace lsp
             nOversampling       = sOver.get_oversampling();
             nFreqCtrlWord_Over  = nFreqCtrlWord / nOversampling;
 
+            update_blep();
+
             bSync               = false;
         }
 
-        void Oscillator::do_process(Oversampler *os, float *dst, size_t count)
+        /*
+         * Waveform kernels process groups of KERNEL_LANES samples, every sample of the
+         * group does not depend on others, so the compiler is able to map the group
+         * onto SIMD registers. The count of samples should be multiple of KERNEL_LANES.
+         */
+        static void phase_ramp(uint32_t *dst, uint32_t acc, uint32_t step, uint32_t mask, size_t count)
         {
-            // Prevent overwrite of vProcessBuffer when the size of processed data is smaller
-            // or equal the size of the original data (before oversampling) by imposing
-            // dst != vProcessBuffer
-            if (dst == vProcessBuffer)
-                return;
+            for (size_t i=0; i<count; i += KERNEL_LANES, dst += KERNEL_LANES, acc += KERNEL_LANES * step)
+                for (size_t j=0; j<KERNEL_LANES; ++j)
+                    dst[j]      = (acc + uint32_t(j) * step) & mask;
+        }
 
-            switch (enFunction)
+        /*
+         * Convert the phase word to float: both halves are exact and the sum is rounded
+         * once, so the result is the same as for the direct conversion which does not
+         * vectorize for unsigned integers on most architectures
+         */
+        static inline float phase_to_float(uint32_t x)
+        {
+            return float(int32_t(x >> 16)) * 65536.0f + float(int32_t(x & 0xffff));
+        }
+
+        /*
+         * Compute amp * sin(2 * pi * (x << shift + offset) / 2^32) + dc for the block of phase words.
+         * The phase is wrapped to [-0.5, 0.5) of the period by the signed interpretation,
+         * folded to the [-0.25, 0.25] range and approximated with the odd polynomial of the
+         * 9th order. The absolute error of the polynomial is less than 3.4e-9, the overall
+         * absolute error of single-precision evaluation does not exceed 2.5e-7 * amp.
+         */
+        static void sine_block(float *dst, const uint32_t *src, uint32_t shift, uint32_t offset,
+            float amp, float dc, size_t count)
+        {
+            const float k   = 4.0f / 4294967296.0f;
+
+            for (size_t i=0; i<count; i += KERNEL_LANES, dst += KERNEL_LANES, src += KERNEL_LANES)
             {
-                case FG_SINE:
-                    while (count--)
+                for (size_t j=0; j<KERNEL_LANES; ++j)
+                {
+                    float v     = int32_t((src[j] << shift) + offset) * k;  // [-2, 2)
+                    float a     = fabsf(v);
+                    float b     = 2.0f - a;
+                    v           = copysignf((a < b) ? a : b, v);            // [-1, 1]
+                    float v2    = v * v;
+                    float y     = v * (1.5707962899e+00f + v2 * (-6.4596335826e-01f + v2 * (7.9688474756e-02f +
+                                  v2 * (-4.6722202167e-03f + v2 * 1.5081714132e-04f))));
+                    dst[j]      = amp * y + dc;
+                }
+            }
+        }
+
+        static void rectangular_block(float *dst, const uint32_t *src, uint32_t duty,
+            float v0, float v1, size_t count)
+        {
+            for (size_t i=0; i<count; i += KERNEL_LANES, dst += KERNEL_LANES, src += KERNEL_LANES)
+                for (size_t j=0; j<KERNEL_LANES; ++j)
+                    dst[j]      = (src[j] < duty) ? v0 : v1;
+        }
+
+        static void sawtooth_block(float *dst, const uint32_t *src, uint32_t width,
+            const float *c, float dc, float k, size_t count)
+        {
+            const float c0 = k * c[0], c1 = k * (c[1] + dc);
+            const float c2 = k * c[2], c3 = k * (c[3] + dc);
+
+            for (size_t i=0; i<count; i += KERNEL_LANES, dst += KERNEL_LANES, src += KERNEL_LANES)
+            {
+                for (size_t j=0; j<KERNEL_LANES; ++j)
+                {
+                    bool up     = src[j] < width;
+                    float a     = (up) ? c0 : c2;
+                    float b     = (up) ? c1 : c3;
+                    dst[j]      = a * phase_to_float(src[j]) + b;
+                }
+            }
+        }
+
+        static void trapezoid_block(float *dst, const uint32_t *src, const uint32_t *p,
+            const float *c, float amp, float dc, float k, size_t count)
+        {
+            // Coefficients of the line for each piece of the wave
+            const float a0 = k * c[0], b0 = k * dc;
+            const float b1 = k * (amp + dc);
+            const float a2 = k * c[1], b2 = k * (c[2] + dc);
+            const float b3 = k * (dc - amp);
+            const float b4 = k * (c[3] + dc);
+            const uint32_t p0 = p[0], p1 = p[1], p2 = p[2], p3 = p[3];
+
+            for (size_t i=0; i<count; i += KERNEL_LANES, dst += KERNEL_LANES, src += KERNEL_LANES)
+            {
+                for (size_t j=0; j<KERNEL_LANES; ++j)
+                {
+                    uint32_t w  = src[j];
+                    bool r3     = w <= p3;
+                    bool r2     = w < p2;
+                    bool r1     = w <= p1;
+                    bool r0     = w < p0;
+                    float a     = (r3) ? 0.0f : a0;
+                    float b     = (r3) ? b3 : b4;
+                    a           = (r2) ? a2 : a;
+                    b           = (r2) ? b2 : b;
+                    a           = (r1) ? 0.0f : a;
+                    b           = (r1) ? b1 : b;
+                    a           = (r0) ? a0 : a;
+                    b           = (r0) ? b0 : b;
+                    dst[j]      = a * phase_to_float(w) + b;
+                }
+            }
+        }
+
+        static void pulsetrain_block(float *dst, const uint32_t *src, const uint32_t *p,
+            float v0, float v1, float v2, size_t count)
+        {
+            const uint32_t p0 = p[0], p1 = p[1], p2 = p[2];
+
+            for (size_t i=0; i<count; i += KERNEL_LANES, dst += KERNEL_LANES, src += KERNEL_LANES)
+            {
+                for (size_t j=0; j<KERNEL_LANES; ++j)
+                {
+                    uint32_t w  = src[j];
+                    float v     = ((w >= p1) & (w <= p2)) ? v1 : v2;
+                    dst[j]      = (w <= p0) ? v0 : v;
+                }
+            }
+        }
+
+        static void parabolic_block(float *dst, const uint32_t *src, uint32_t width,
+            float amp, float dc, float k, size_t count)
+        {
+            const float kx  = (width > 0) ? 2.0f / width : 0.0f;
+            const float ka  = k * amp;
+            const float kd  = k * dc;
+
+            for (size_t i=0; i<count; i += KERNEL_LANES, dst += KERNEL_LANES, src += KERNEL_LANES)
+            {
+                for (size_t j=0; j<KERNEL_LANES; ++j)
+                {
+                    bool in     = src[j] < width;
+                    float x     = kx * phase_to_float(src[j]) - 1.0f;
+                    float a     = (in) ? ka : 0.0f;
+                    float b     = (in) ? kd : dc;
+                    dst[j]      = a * (1.0f - x*x) + b;
+                }
+            }
+        }
+
+        /*
+         * Add the polynomial residuals of the discontinuities to the naive wave. The residuals
+         * are the 2-point integrals of the triangular kernel: the step residual is
+         * +/- (1 - |t|)^2 / 2 and the ramp residual is (1 - |t|)^3 / 6, where t is the
+         * signed distance to the discontinuity in samples. The distance is computed and
+         * clamped with the 32-bit phase words, so the wrap of the period comes for free and
+         * the kernel has no floating-point branches.
+         */
+        static void blep_block(float *dst, const uint32_t *src, uint32_t shift,
+            const uint32_t *phase, const float *step, const float *slope, size_t points,
+            uint32_t range, size_t count)
+        {
+            const int32_t lim   = range;
+            const float scale   = 1.0f / range;
+
+            for (size_t i=0; i<count; i += KERNEL_LANES, dst += KERNEL_LANES, src += KERNEL_LANES)
+            {
+                for (size_t k=0; k<points; ++k)
+                {
+                    const uint32_t p    = phase[k];
+                    const float hs      = 0.5f * step[k];
+                    const float ks      = slope[k] * (1.0f / 6.0f);
+
+                    for (size_t j=0; j<KERNEL_LANES; ++j)
                     {
-                        *(dst++)    = fAmplitude * sin(fAcc2Phase * nPhaseAcc) + fReferencedDC;
-                        nPhaseAcc   = (nPhaseAcc + nFreqCtrlWord) & nPhaseAccMask;
+                        int32_t d   = int32_t((src[j] << shift) - p);
+                        d           = (d < lim) ? d : lim;
+                        d           = (d > -lim) ? d : -lim;
+                        float t     = d * scale;
+                        float u     = 1.0f - fabsf(t);
+                        float u2    = u * u;
+                        dst[j]     += hs * copysignf(u2, -t) + ks * u2 * u;
                     }
+                }
+            }
+        }
+
+        float Oscillator::bl_peak_atten() const
+        {
+            switch (enFunction)
+            {
+                case FG_BL_RECTANGULAR:     return sRectangular.fBLPeakAtten;
+                case FG_BL_SAWTOOTH:        return sSawtooth.fBLPeakAtten;
+                case FG_BL_TRAPEZOID:       return sTrapezoid.fBLPeakAtten;
+                case FG_BL_PULSETRAIN:      return sPulse.fBLPeakAtten;
+                case FG_BL_PARABOLIC:       return sParabolic.fBLPeakAtten;
+                default:                    break;
+            }
+            return 1.0f;
+        }
+
+        void Oscillator::render(float *dst, const phacc_t *ph, float k, size_t count)
+        {
+            const uint32_t shift    = sizeof(phacc_t) * 8 - nPhaseAccBits;
+
+            switch (enFunction)
+            {
+                case FG_SINE:
+                    sine_block(dst, ph, shift, 0, fAmplitude, fReferencedDC, count);
                     break;
 
                 case FG_COSINE:
-                    while (count--)
-                    {
-                        *(dst++)    = fAmplitude * cos(fAcc2Phase * nPhaseAcc) + fReferencedDC;
-                        nPhaseAcc   = (nPhaseAcc + nFreqCtrlWord) & nPhaseAccMask;
-                    }
+                    sine_block(dst, ph, shift, 0x40000000U, fAmplitude, fReferencedDC, count);
                     break;
 
                 case FG_SQUARED_SINE:
-                    while (count--)
-                    {
-                        // We put a 0.5 as simple squaring sinusoids will double the
-                        // fundamental frequency with respect fFrequency.
-                        float x     = sin(0.5f * fAcc2Phase * nPhaseAcc);
-                        *(dst++)    = sSquaredSinusoid.fAmplitude * x * x + fReferencedDC;
-                        nPhaseAcc   = (nPhaseAcc + nFreqCtrlWord) & nPhaseAccMask;
-                    }
+                {
+                    // sin(x/2)^2 = (1 - cos(x)) / 2
+                    float amp           = 0.5f * sSquaredSinusoid.fAmplitude;
+                    sine_block(dst, ph, shift, 0x40000000U, -amp, amp + fReferencedDC, count);
                     break;
+                }
 
                 case FG_SQUARED_COSINE:
-                    while (count--)
-                    {
-                        // We put a 0.5 as simple squaring sinusoids will double the
-                        // fundamental frequency with respect fFrequency.
-                        float x     = cos(0.5f * fAcc2Phase * nPhaseAcc);
-                        *(dst++)    = sSquaredSinusoid.fAmplitude * x * x + fReferencedDC;
-                        nPhaseAcc   = (nPhaseAcc + nFreqCtrlWord) & nPhaseAccMask;
-                    }
+                {
+                    // cos(x/2)^2 = (1 + cos(x)) / 2
+                    float amp           = 0.5f * sSquaredSinusoid.fAmplitude;
+                    sine_block(dst, ph, shift, 0x40000000U, amp, amp + fReferencedDC, count);
                     break;
+                }
 
                 case FG_RECTANGULAR:
-                    while (count--)
-                    {
-                        *(dst++)    = ((nPhaseAcc < sRectangular.nDutyWord) ? fAmplitude : -fAmplitude) + fReferencedDC;
-                        nPhaseAcc   = (nPhaseAcc + nFreqCtrlWord) & nPhaseAccMask;
-                    }
+                case FG_BL_RECTANGULAR:
+                    rectangular_block(dst, ph, sRectangular.nDutyWord,
+                        k * (fAmplitude + fReferencedDC), k * (fReferencedDC - fAmplitude), count);
                     break;
 
                 case FG_SAWTOOTH:
-                    while (count--)
-                    {
-                        if (nPhaseAcc < sSawtooth.nWidthWord)
-                            *(dst++)    = sSawtooth.fCoeffs[0] * nPhaseAcc + sSawtooth.fCoeffs[1] + fReferencedDC;
-                        else
-                            *(dst++)    = sSawtooth.fCoeffs[2] * nPhaseAcc + sSawtooth.fCoeffs[3] + fReferencedDC;
-
-                        nPhaseAcc       = (nPhaseAcc + nFreqCtrlWord) & nPhaseAccMask;
-                    }
+                case FG_BL_SAWTOOTH:
+                    sawtooth_block(dst, ph, sSawtooth.nWidthWord, sSawtooth.fCoeffs, fReferencedDC, k, count);
                     break;
 
                 case FG_TRAPEZOID:
-                    while (count--)
-                    {
-                        if (nPhaseAcc < sTrapezoid.nPoints[0])
-                            *(dst++)    = sTrapezoid.fCoeffs[0] * nPhaseAcc + fReferencedDC;
-
-                        if ((nPhaseAcc >= sTrapezoid.nPoints[0]) && (nPhaseAcc <= sTrapezoid.nPoints[1]))
-                            *(dst++)    = fAmplitude + fReferencedDC;
-
-                        if ((nPhaseAcc > sTrapezoid.nPoints[1]) && (nPhaseAcc < sTrapezoid.nPoints[2]))
-                            *(dst++)    = sTrapezoid.fCoeffs[1] * nPhaseAcc + sTrapezoid.fCoeffs[2] + fReferencedDC;
-
-                        if ((nPhaseAcc >= sTrapezoid.nPoints[2]) && (nPhaseAcc <= sTrapezoid.nPoints[3]))
-                            *(dst++)    = fReferencedDC - fAmplitude;
-
-                        if (nPhaseAcc > sTrapezoid.nPoints[3])
-                            *(dst++)    = sTrapezoid.fCoeffs[0] * nPhaseAcc + sTrapezoid.fCoeffs[3] + fReferencedDC;
-
-                        nPhaseAcc       = (nPhaseAcc + nFreqCtrlWord) & nPhaseAccMask;
-
-                    }
+                case FG_BL_TRAPEZOID:
+                    trapezoid_block(dst, ph, sTrapezoid.nPoints, sTrapezoid.fCoeffs, fAmplitude, fReferencedDC, k, count);
                     break;
 
                 case FG_PULSETRAIN:
-                    while (count--)
-                    {
-                        if (nPhaseAcc <= sPulse.nTrainPoints[0])
-                            *(dst++)    = fAmplitude + fReferencedDC;
-                        else if ((nPhaseAcc >= sPulse.nTrainPoints[1]) && (nPhaseAcc <= sPulse.nTrainPoints[2]))
-                            *(dst++)    = fReferencedDC - fAmplitude;
-                        else
-                            *(dst++)    = 0.0f + fReferencedDC;
-
-                        nPhaseAcc       = (nPhaseAcc + nFreqCtrlWord) & nPhaseAccMask;
-                    }
+                case FG_BL_PULSETRAIN:
+                    pulsetrain_block(dst, ph, sPulse.nTrainPoints,
+                        k * (fAmplitude + fReferencedDC), k * (fReferencedDC - fAmplitude), fReferencedDC, count);
                     break;
 
                 case FG_PARABOLIC:
-                    while (count--)
-                    {
-                        if (nPhaseAcc < sParabolic.nWidthWord)
-                        {
-                            float x     = (2.0f / sParabolic.nWidthWord) * nPhaseAcc - 1.0f;
-                            *(dst++)    = sParabolic.fAmplitude * (1.0f - x*x) + fReferencedDC;
-                        }
-                        else
-                            *(dst++)    = 0.0f + fReferencedDC;
-
-                        nPhaseAcc       = (nPhaseAcc + nFreqCtrlWord) & nPhaseAccMask;
-                    }
+                case FG_BL_PARABOLIC:
+                    parabolic_block(dst, ph, sParabolic.nWidthWord, sParabolic.fAmplitude, fReferencedDC, k, count);
                     break;
 
-                case FG_BL_RECTANGULAR:
-                {
-                    size_t buf_size     = PROCESS_BUF_LIMIT_SIZE / nOversampling;
-
-                    while (count > 0)
-                    {
-                        size_t to_do        = (count > buf_size) ? buf_size : count;
-                        size_t synthCount   = nOversampling * to_do;
+                default:
+                    dsp::fill(dst, fReferencedDC, count);
+                    break;
+            }
+        }
 
-                        for (size_t n = 0; n < synthCount; ++n)
-                        {
-                            vProcessBuffer[n]   = sRectangular.fBLPeakAtten * (((nPhaseAcc < sRectangular.nDutyWord) ? fAmplitude : -fAmplitude) + fReferencedDC);
-                            nPhaseAcc           = (nPhaseAcc + nFreqCtrlWord_Over) & nPhaseAccMask;
-                        }
+        void Oscillator::synthesize(float *dst, phacc_t step, float k, size_t count)
+        {
+            phacc_t ph[KERNEL_BLOCK_SIZE];
+            float tail[KERNEL_LANES];
+
+            // Unpack the discontinuities for the kernel
+            const uint32_t shift    = sizeof(phacc_t) * 8 - nPhaseAccBits;
+            uint32_t b_phase[OSCILLATOR_BLEP_POINTS];
+            float b_step[OSCILLATOR_BLEP_POINTS], b_slope[OSCILLATOR_BLEP_POINTS];
+            for (size_t i=0; i<nBlepPoints; ++i)
+            {
+                b_phase[i]          = vBlep[i].nPhase;
+                b_step[i]           = vBlep[i].fStep;
+                b_slope[i]          = vBlep[i].fSlope;
+            }
 
-                        os->downsample(dst, vProcessBuffer, to_do);
+            while (count > 0)
+            {
+                size_t to_do        = lsp_min(count, size_t(KERNEL_BLOCK_SIZE));
+                size_t head         = to_do & ~size_t(KERNEL_LANES - 1);
 
-                        dst             += to_do;
-                        count           -= to_do;
-                    }
+                phase_ramp(ph, nPhaseAcc, step, nPhaseAccMask, align_size(to_do, KERNEL_LANES));
+                nPhaseAcc           = (nPhaseAcc + phacc_t(to_do) * step) & nPhaseAccMask;
 
+                // Render the groups of samples directly, the incomplete group via the temporary buffer
+                if (head > 0)
+                {
+                    render(dst, ph, k, head);
+                    if (nBlepPoints > 0)
+                        blep_block(dst, ph, shift, b_phase, b_step, b_slope, nBlepPoints, step << shift, head);
                 }
-                break;
-
-                case FG_BL_SAWTOOTH:
+                if (head < to_do)
                 {
-                    size_t buf_size     = PROCESS_BUF_LIMIT_SIZE / nOversampling;
+                    render(tail, &ph[head], k, KERNEL_LANES);
+                    if (nBlepPoints > 0)
+                        blep_block(tail, &ph[head], shift, b_phase, b_step, b_slope, nBlepPoints, step << shift, KERNEL_LANES);
+                    dsp::copy(&dst[head], tail, to_do - head);
+                }
 
-                    while (count > 0)
-                    {
-                        size_t to_do        = (count > buf_size) ? buf_size : count;
-                        size_t synthCount   = nOversampling * to_do;
+                dst                += to_do;
+                count              -= to_do;
+            }
+        }
 
-                        for (size_t n = 0; n < synthCount; ++n)
-                        {
-                            if (nPhaseAcc < sSawtooth.nWidthWord)
-                                vProcessBuffer[n]    = sSawtooth.fBLPeakAtten * (sSawtooth.fCoeffs[0] * nPhaseAcc + sSawtooth.fCoeffs[1] + fReferencedDC);
-                            else
-                                vProcessBuffer[n]    = sSawtooth.fBLPeakAtten * (sSawtooth.fCoeffs[2] * nPhaseAcc + sSawtooth.fCoeffs[3] + fReferencedDC);
+        void Oscillator::add_blep(phacc_t phase, float step, float slope)
+        {
+            if (nBlepPoints >= OSCILLATOR_BLEP_POINTS)
+                return;
 
-                            nPhaseAcc           = (nPhaseAcc + nFreqCtrlWord_Over) & nPhaseAccMask;
-                        }
+            blep_t *b       = &vBlep[nBlepPoints++];
+            b->nPhase       = phase;
+            b->fStep        = step;
+            b->fSlope       = slope;
+        }
 
-                        os->downsample(dst, vProcessBuffer, to_do);
+        void Oscillator::update_blep()
+        {
+            nBlepPoints             = 0;
+            if (enBLMode != BL_POLYBLEP)
+                return;
 
-                        dst             += to_do;
-                        count           -= to_do;
-                    }
+            // Frequency control word scaled to 32 bits, the correction makes no sense at Nyquist and above
+            const uint32_t shift    = sizeof(phacc_t) * 8 - nPhaseAccBits;
+            const uint32_t step     = nFreqCtrlWord << shift;
+            if ((step == 0) || (step >= 0x80000000U))
+                return;
+
+            const float dt          = step / 4294967296.0f;   // Phase increment per sample, in periods
+            const float amp         = fAmplitude;
 
+            // Jumps of the value and of the derivative (per period) of the naive waves
+            switch (enFunction)
+            {
+                case FG_BL_RECTANGULAR:
+                    add_blep(0, 2.0f * amp, 0.0f);
+                    add_blep(sRectangular.nDutyWord << shift, -2.0f * amp, 0.0f);
+                    break;
+
+                case FG_BL_SAWTOOTH:
+                {
+                    float w         = sSawtooth.fWidth;
+                    if (w <= 0.0f)
+                        add_blep(0, 2.0f * amp, 0.0f);
+                    else if (w >= 1.0f)
+                        add_blep(0, -2.0f * amp, 0.0f);
+                    else
+                    {
+                        float ds        = 2.0f * amp * (1.0f / w + 1.0f / (1.0f - w)) * dt;
+                        add_blep(0, 0.0f, ds);
+                        add_blep(sSawtooth.nWidthWord << shift, 0.0f, -ds);
+                    }
+                    break;
                 }
-                break;
 
                 case FG_BL_TRAPEZOID:
                 {
-                    size_t buf_size     = PROCESS_BUF_LIMIT_SIZE / nOversampling;
-
-                    while (count > 0)
+                    float r         = sTrapezoid.fRaiseRatio;
+                    float f         = sTrapezoid.fFallRatio;
+                    if (r > 0.0f)
                     {
-                        size_t to_do        = (count > buf_size) ? buf_size : count;
-                        size_t synthCount   = nOversampling * to_do;
-
-                        for (size_t n = 0; n < synthCount; ++n)
-                        {
-                            if (nPhaseAcc < sTrapezoid.nPoints[0])
-                                vProcessBuffer[n]    = sTrapezoid.fBLPeakAtten * (sTrapezoid.fCoeffs[0] * nPhaseAcc + fReferencedDC);
-
-                            if ((nPhaseAcc >= sTrapezoid.nPoints[0]) && (nPhaseAcc <= sTrapezoid.nPoints[1]))
-                                vProcessBuffer[n]    = sTrapezoid.fBLPeakAtten * (fAmplitude + fReferencedDC);
-
-                            if ((nPhaseAcc > sTrapezoid.nPoints[1]) && (nPhaseAcc < sTrapezoid.nPoints[2]))
-                                vProcessBuffer[n]    = sTrapezoid.fBLPeakAtten * (sTrapezoid.fCoeffs[1] * nPhaseAcc + sTrapezoid.fCoeffs[2] + fReferencedDC);
-
-                            if ((nPhaseAcc >= sTrapezoid.nPoints[2]) && (nPhaseAcc <= sTrapezoid.nPoints[3]))
-                                vProcessBuffer[n]    = sTrapezoid.fBLPeakAtten * (fReferencedDC - fAmplitude);
-
-                            if (nPhaseAcc > sTrapezoid.nPoints[3])
-                                vProcessBuffer[n]    = sTrapezoid.fBLPeakAtten * (sTrapezoid.fCoeffs[0] * nPhaseAcc + sTrapezoid.fCoeffs[3] + fReferencedDC);
-
-                            nPhaseAcc           = (nPhaseAcc + nFreqCtrlWord_Over) & nPhaseAccMask;
-                        }
-
-                        os->downsample(dst, vProcessBuffer, to_do);
-
-                        dst             += to_do;
-                        count           -= to_do;
+                        float ds        = 2.0f * amp * dt / r;
+                        add_blep(sTrapezoid.nPoints[0] << shift, 0.0f, -ds);
+                        add_blep(sTrapezoid.nPoints[3] << shift, 0.0f, ds);
                     }
+                    else
+                        add_blep(0, 2.0f * amp, 0.0f);
 
+                    if (f > 0.0f)
+                    {
+                        float ds        = 2.0f * amp * dt / f;
+                        add_blep(sTrapezoid.nPoints[1] << shift, 0.0f, -ds);
+                        add_blep(sTrapezoid.nPoints[2] << shift, 0.0f, ds);
+                    }
+                    else
+                        add_blep(sTrapezoid.nPoints[1] << shift, -2.0f * amp, 0.0f);
+                    break;
                 }
-                break;
 
                 case FG_BL_PULSETRAIN:
-                {
-                    size_t buf_size     = PROCESS_BUF_LIMIT_SIZE / nOversampling;
+                    // The pulses include their end points
+                    add_blep(0, amp, 0.0f);
+                    add_blep((sPulse.nTrainPoints[0] + 1) << shift, -amp, 0.0f);
+                    add_blep(sPulse.nTrainPoints[1] << shift, -amp, 0.0f);
+                    add_blep((sPulse.nTrainPoints[2] + 1) << shift, amp, 0.0f);
+                    break;
 
-                    while (count > 0)
+                case FG_BL_PARABOLIC:
+                {
+                    // The slope corrections of the same sign are balanced by the curvature
+                    // of the parabola, this does not hold for the parabola shorter than 2 samples
+                    float w         = sParabolic.fWidth;
+                    if (w >= 2.0f * dt)
                     {
-                        size_t to_do        = (count > buf_size) ? buf_size : count;
-                        size_t synthCount   = nOversampling * to_do;
-
-                        for (size_t n = 0; n < synthCount; ++n)
-                        {
-                            if (nPhaseAcc <= sPulse.nTrainPoints[0])
-                                vProcessBuffer[n]    = sPulse.fBLPeakAtten * (fAmplitude + fReferencedDC);
-                            else if ((nPhaseAcc >= sPulse.nTrainPoints[1]) && (nPhaseAcc <= sPulse.nTrainPoints[2]))
-                                vProcessBuffer[n]    = sPulse.fBLPeakAtten * (fReferencedDC - fAmplitude);
-                            else
-                                vProcessBuffer[n]    = 0.0f + fReferencedDC;
-
-                            nPhaseAcc           = (nPhaseAcc + nFreqCtrlWord_Over) & nPhaseAccMask;
-                        }
-
-                        os->downsample(dst, vProcessBuffer, to_do);
-
-                        dst             += to_do;
-                        count           -= to_do;
+                        float ds        = 4.0f * sParabolic.fAmplitude * dt / w;
+                        add_blep(0, 0.0f, ds);
+                        add_blep(sParabolic.nWidthWord << shift, 0.0f, ds);
                     }
-
+                    break;
                 }
-                break;
 
+                default:
+                    break;
+            }
+        }
+
+        void Oscillator::do_process(Oversampler *os, float *dst, size_t count)
+        {
+            // Prevent overwrite of vProcessBuffer when the size of processed data is smaller
+            // or equal the size of the original data (before oversampling) by imposing
+            // dst != vProcessBuffer
+            if (dst == vProcessBuffer)
+                return;
+
+            switch (enFunction)
+            {
+                case FG_BL_RECTANGULAR:
+                case FG_BL_SAWTOOTH:
+                case FG_BL_TRAPEZOID:
+                case FG_BL_PULSETRAIN:
                 case FG_BL_PARABOLIC:
                 {
+                    // Synthesize at 1x rate, synthesize() corrects the discontinuities computed by update_blep()
+                    if (enBLMode == BL_POLYBLEP)
+                    {
+                        synthesize(dst, nFreqCtrlWord, 1.0f, count);
+                        break;
+                    }
+
                     size_t buf_size     = PROCESS_BUF_LIMIT_SIZE / nOversampling;
+                    float k             = bl_peak_atten();
 
                     while (count > 0)
                     {
                         size_t to_do        = (count > buf_size) ? buf_size : count;
                         size_t synthCount   = nOversampling * to_do;
 
-                        for (size_t n = 0; n < synthCount; ++n)
-                        {
-                            if (nPhaseAcc < sParabolic.nWidthWord)
-                            {
-                                float x             = (2.0f / sParabolic.nWidthWord) * nPhaseAcc - 1.0f;
-                                vProcessBuffer[n]   = sParabolic.fBLPeakAtten * (sParabolic.fAmplitude * (1.0f - x*x) + fReferencedDC); // Do not use pow(x, 2). Simple x*x multiplication is faster
-                            }
-                            else
-                                vProcessBuffer[n]    = 0.0f + fReferencedDC;
-
-                            nPhaseAcc           = (nPhaseAcc + nFreqCtrlWord_Over) & nPhaseAccMask;
-                        }
-
+                        synthesize(vProcessBuffer, nFreqCtrlWord_Over, k, synthCount);
                         os->downsample(dst, vProcessBuffer, to_do);
 
                         dst             += to_do;
                         count           -= to_do;
                     }
-
+                    break;
                 }
-                break;
 
                 default:
+                    synthesize(dst, nFreqCtrlWord, 1.0f, count);
                     break;
             }
         }
@@ -908,6 +1095,15 @@ namespace lsp
             bSync = true;
         }
 
+        void Oscillator::set_band_limit_mode(bl_mode_t mode)
+        {
+            if ((mode < BL_OVERSAMPLING) || (mode >= BL_MAX) || (mode == enBLMode))
+                return;
+
+            enBLMode = mode;
+            bSync = true;
+        }
+
         void Oscillator::set_amplitude(float amplitude)
         {
             if (fAmplitude == amplitude)
@@ -1007,6 +1203,24 @@ namespace lsp
             v->write("nOversampling", nOversampling);
             v->write("enOverMode", enOverMode);
             v->write("nFreqCtrlWord_Over", nFreqCtrlWord_Over);
+
+            v->write("enBLMode", enBLMode);
+            v->begin_array("vBlep", vBlep, nBlepPoints);
+            {
+                for (size_t i=0; i<nBlepPoints; ++i)
+                {
+                    const blep_t *b = &vBlep[i];
+                    v->begin_object(b, sizeof(blep_t));
+                    {
+                        v->write("nPhase", b->nPhase);
+                        v->write("fStep", b->fStep);
+                        v->write("fSlope", b->fSlope);
+                    }
+                    v->end_object();
+                }
+            }
+            v->end_array();
+            v->write("nBlepPoints", nBlepPoints);
             v->write("bSync", bSync);
         }
     }
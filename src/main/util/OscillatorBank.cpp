@@ -0,0 +1,366 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/dsp-units/util/OscillatorBank.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define BANK_BLOCK_SIZE         0x100       // Size of the temporary buffer
+#define BANK_LANES              8           // Number of oscillators processed at once
+
+namespace lsp
+{
+    namespace dspu
+    {
+        OscillatorBank::OscillatorBank()
+        {
+            construct();
+        }
+
+        OscillatorBank::~OscillatorBank()
+        {
+            destroy();
+        }
+
+        void OscillatorBank::construct()
+        {
+            vPhase          = NULL;
+            vInitPhase      = NULL;
+            vStep           = NULL;
+            vGain           = NULL;
+            vNewGain        = NULL;
+            vDelta          = NULL;
+            vFrequency      = NULL;
+            vAmplitude      = NULL;
+            vPhaseShift     = NULL;
+            nOscillators    = 0;
+            nCapacity       = 0;
+            nSampleRate     = 0;
+            fDCOffset       = 0.0f;
+            bSync           = true;
+            bReset          = true;
+            pData           = NULL;
+        }
+
+        void OscillatorBank::destroy()
+        {
+            free_aligned(pData);
+            vPhase          = NULL;
+            vInitPhase      = NULL;
+            vStep           = NULL;
+            vGain           = NULL;
+            vNewGain        = NULL;
+            vDelta          = NULL;
+            vFrequency      = NULL;
+            vAmplitude      = NULL;
+            vPhaseShift     = NULL;
+            nOscillators    = 0;
+            nCapacity       = 0;
+        }
+
+        bool OscillatorBank::init(size_t oscillators)
+        {
+            // All arrays are padded to the number of lanes, padding oscillators stay silent
+            size_t capacity     = align_size(lsp_max(oscillators, size_t(1)), BANK_LANES);
+            size_t arr_size     = align_size(capacity * sizeof(float), DEFAULT_ALIGN);
+            size_t to_alloc     = arr_size * 9;
+
+            uint8_t *data       = NULL;
+            uint8_t *ptr        = alloc_aligned<uint8_t>(data, to_alloc);
+            if (ptr == NULL)
+                return false;
+
+            free_aligned(pData);
+
+            vPhase              = reinterpret_cast<uint32_t *>(ptr);
+            ptr                += arr_size;
+            vInitPhase          = reinterpret_cast<uint32_t *>(ptr);
+            ptr                += arr_size;
+            vStep               = reinterpret_cast<uint32_t *>(ptr);
+            ptr                += arr_size;
+            vGain               = reinterpret_cast<float *>(ptr);
+            ptr                += arr_size;
+            vNewGain            = reinterpret_cast<float *>(ptr);
+            ptr                += arr_size;
+            vDelta              = reinterpret_cast<float *>(ptr);
+            ptr                += arr_size;
+            vFrequency          = reinterpret_cast<float *>(ptr);
+            ptr                += arr_size;
+            vAmplitude          = reinterpret_cast<float *>(ptr);
+            ptr                += arr_size;
+            vPhaseShift         = reinterpret_cast<float *>(ptr);
+            ptr                += arr_size;
+
+            nOscillators        = oscillators;
+            nCapacity           = capacity;
+            pData               = data;
+
+            for (size_t i=0; i<capacity; ++i)
+            {
+                vPhase[i]           = 0;
+                vInitPhase[i]       = 0;
+                vStep[i]            = 0;
+            }
+            dsp::fill_zero(vGain, capacity);
+            dsp::fill_zero(vNewGain, capacity);
+            dsp::fill_zero(vDelta, capacity);
+            dsp::fill_zero(vFrequency, capacity);
+            dsp::fill_one(vAmplitude, capacity);
+            dsp::fill_zero(vPhaseShift, capacity);
+
+            bSync               = true;
+            bReset              = true;
+
+            return true;
+        }
+
+        void OscillatorBank::update_settings()
+        {
+            if (!bSync)
+                return;
+
+            const double k      = (nSampleRate > 0) ? 4294967296.0 / nSampleRate : 0.0;
+            const float nyquist = 0.5f * nSampleRate;
+
+            for (size_t i=0; i<nOscillators; ++i)
+            {
+                // Shift the running phase by the change of the initial phase
+                float phase         = vPhaseShift[i];
+                uint32_t init       = uint64_t(4294967296.0 * 0.5 * M_1_PI * (phase - 2.0 * M_PI * floor(phase * 0.5 * M_1_PI)));
+                vPhase[i]          += init - vInitPhase[i];
+                vInitPhase[i]       = init;
+
+                // Mute oscillators that can not be represented at this sample rate
+                float f             = vFrequency[i];
+                bool valid          = (f >= 0.0f) && (f < nyquist);
+                vStep[i]            = (valid) ? uint32_t(k * f) : 0;
+                vNewGain[i]         = (valid) ? vAmplitude[i] : 0.0f;
+            }
+
+            if (bReset)
+                dsp::copy(vGain, vNewGain, nOscillators);
+
+            bSync               = false;
+            bReset              = false;
+        }
+
+        void OscillatorBank::set_sample_rate(size_t sr)
+        {
+            if (nSampleRate == sr)
+                return;
+
+            nSampleRate         = sr;
+            reset_phase();
+            bSync               = true;
+            bReset              = true;
+        }
+
+        void OscillatorBank::set_frequency(size_t id, float frequency)
+        {
+            if ((id >= nOscillators) || (vFrequency[id] == frequency))
+                return;
+
+            vFrequency[id]      = frequency;
+            bSync               = true;
+        }
+
+        float OscillatorBank::get_frequency(size_t id) const
+        {
+            return (id < nOscillators) ? vFrequency[id] : 0.0f;
+        }
+
+        void OscillatorBank::set_amplitude(size_t id, float amplitude)
+        {
+            if ((id >= nOscillators) || (vAmplitude[id] == amplitude))
+                return;
+
+            vAmplitude[id]      = amplitude;
+            bSync               = true;
+        }
+
+        float OscillatorBank::get_amplitude(size_t id) const
+        {
+            return (id < nOscillators) ? vAmplitude[id] : 0.0f;
+        }
+
+        void OscillatorBank::set_phase(size_t id, float phase)
+        {
+            if ((id >= nOscillators) || (vPhaseShift[id] == phase))
+                return;
+
+            vPhaseShift[id]     = phase;
+            bSync               = true;
+        }
+
+        float OscillatorBank::get_phase(size_t id) const
+        {
+            return (id < nOscillators) ? vPhaseShift[id] : 0.0f;
+        }
+
+        void OscillatorBank::reset_phase()
+        {
+            for (size_t i=0; i<nCapacity; ++i)
+                vPhase[i]           = vInitPhase[i];
+        }
+
+        /*
+         * The lanes of the inner loop are independent oscillators, so the compiler maps
+         * them onto SIMD registers, the partial sums are reduced once per sample. The sine
+         * is computed with the same folded 9th order polynomial as the Oscillator kernels,
+         * the absolute error does not exceed 2.5e-7 * amplitude per oscillator.
+         */
+        void OscillatorBank::synthesize(float *dst, size_t count)
+        {
+            const float k       = 4.0f / 4294967296.0f;
+            float acc[BANK_LANES];
+
+            for (size_t i=0; i<count; ++i)
+            {
+                for (size_t j=0; j<BANK_LANES; ++j)
+                    acc[j]              = 0.0f;
+
+                for (size_t n=0; n<nCapacity; n += BANK_LANES)
+                {
+                    uint32_t *ph        = &vPhase[n];
+                    const uint32_t *st  = &vStep[n];
+                    float *g            = &vGain[n];
+                    const float *dg     = &vDelta[n];
+
+                    for (size_t j=0; j<BANK_LANES; ++j)
+                    {
+                        float v     = int32_t(ph[j]) * k;                       // [-2, 2)
+                        float a     = fabsf(v);
+                        float b     = 2.0f - a;
+                        v           = copysignf((a < b) ? a : b, v);            // [-1, 1]
+                        float v2    = v * v;
+                        float y     = v * (1.5707962899e+00f + v2 * (-6.4596335826e-01f + v2 * (7.9688474756e-02f +
+                                      v2 * (-4.6722202167e-03f + v2 * 1.5081714132e-04f))));
+                        acc[j]     += g[j] * y;
+                        ph[j]      += st[j];
+                        g[j]       += dg[j];
+                    }
+                }
+
+                float s             = fDCOffset;
+                for (size_t j=0; j<BANK_LANES; ++j)
+                    s                  += acc[j];
+                dst[i]              = s;
+            }
+        }
+
+        void OscillatorBank::process_add(float *dst, const float *src, size_t count)
+        {
+            float buf[BANK_BLOCK_SIZE];
+
+            update_settings();
+
+            if (src != NULL)
+                dsp::copy(dst, src, count);
+            else
+                dsp::fill_zero(dst, count);
+
+            start_ramp(count);
+            while (count > 0)
+            {
+                size_t to_do = lsp_min(count, size_t(BANK_BLOCK_SIZE));
+
+                synthesize(buf, to_do);
+                dsp::add2(dst, buf, to_do);
+
+                dst     += to_do;
+                count   -= to_do;
+            }
+            finish_ramp();
+        }
+
+        void OscillatorBank::process_mul(float *dst, const float *src, size_t count)
+        {
+            float buf[BANK_BLOCK_SIZE];
+
+            update_settings();
+
+            if (src != NULL)
+                dsp::copy(dst, src, count);
+            else
+                dsp::fill_zero(dst, count);
+
+            start_ramp(count);
+            while (count > 0)
+            {
+                size_t to_do = lsp_min(count, size_t(BANK_BLOCK_SIZE));
+
+                synthesize(buf, to_do);
+                dsp::mul2(dst, buf, to_do);
+
+                dst     += to_do;
+                count   -= to_do;
+            }
+            finish_ramp();
+        }
+
+        void OscillatorBank::process_overwrite(float *dst, size_t count)
+        {
+            update_settings();
+
+            start_ramp(count);
+            synthesize(dst, count);
+            finish_ramp();
+        }
+
+        void OscillatorBank::start_ramp(size_t count)
+        {
+            if (count == 0)
+                return;
+
+            const float k       = 1.0f / count;
+            for (size_t i=0; i<nOscillators; ++i)
+                vDelta[i]           = (vNewGain[i] - vGain[i]) * k;
+        }
+
+        void OscillatorBank::finish_ramp()
+        {
+            // Drop the accumulated rounding error of the ramp
+            dsp::copy(vGain, vNewGain, nOscillators);
+            dsp::fill_zero(vDelta, nOscillators);
+        }
+
+        void OscillatorBank::dump(IStateDumper *v) const
+        {
+            v->writev("vPhase", vPhase, nOscillators);
+            v->writev("vInitPhase", vInitPhase, nOscillators);
+            v->writev("vStep", vStep, nOscillators);
+            v->writev("vGain", vGain, nOscillators);
+            v->writev("vNewGain", vNewGain, nOscillators);
+            v->writev("vDelta", vDelta, nOscillators);
+            v->writev("vFrequency", vFrequency, nOscillators);
+            v->writev("vAmplitude", vAmplitude, nOscillators);
+            v->writev("vPhaseShift", vPhaseShift, nOscillators);
+            v->write("nOscillators", nOscillators);
+            v->write("nCapacity", nCapacity);
+            v->write("nSampleRate", nSampleRate);
+            v->write("fDCOffset", fDCOffset);
+            v->write("bSync", bSync);
+            v->write("bReset", bReset);
+            v->write("pData", pData);
+        }
+    }
+} /* namespace lsp */
@@ -20,12 +20,21 @@
  */
 
 #include <lsp-plug.in/dsp-units/util/Oversampler.h>
+#include <lsp-plug.in/dsp-units/misc/windows.h>
+#include <lsp-plug.in/stdlib/math.h>
 #include <lsp-plug.in/common/alloc.h>
 #include <lsp-plug.in/dsp/dsp.h>
 
 #define OS_UP_BUFFER_SIZE       (12 * 1024)   /* Multiple of 3 and 4 */
 #define OS_DOWN_BUFFER_SIZE     (12 * 1024)   /* Multiple of 3 and 4 */
 #define OS_CUTOFF               21000.0f
+#define OS_HB_COEFFS_MAX        ((OS_HALFBAND_TAPS_MAX + 1) / 4)
+#define OS_HB_UP_SIZE           (OS_HB_COEFFS_MAX * 4)          /* Doubled history of 2*K samples */
+#define OS_HB_DOWN_SIZE         (OS_HB_COEFFS_MAX * 8)          /* Doubled history of 4*K-1 samples, aligned */
+#define OS_IIR_TRANSITION       0.04                            /* Normalized transition band of the IIR filter */
+#define OS_FADE_BUFFER_SIZE     0x400                           /* Size of the buffer for the mode that fades out */
+#define OS_STATE_SIZE           (OS_UP_BUFFER_SIZE + LSP_DSP_RESAMPLING_RSV_SAMPLES + \
+                                 OS_HB_COEFFS_MAX + OS_HALFBAND_STAGES_MAX * (OS_HB_UP_SIZE + OS_HB_DOWN_SIZE))
 
 namespace lsp
 {
@@ -53,6 +62,7 @@ namespace lsp
         void Oversampler::construct()
         {
             pCallback   = NULL;
+            nChain      = 0;
             fUpBuffer   = NULL;
             fDownBuffer = NULL;
             nUpHead     = 0;
@@ -61,16 +71,51 @@ namespace lsp
             nUpdate     = UP_ALL;
             bData       = NULL;
             bFilter     = true;
+            nHBCoeffs   = (OS_HALFBAND_TAPS_DFL + 1) / 4;
+            vHBFir      = NULL;
+
+            pFilter     = &sFilter;
+            vFadeBuf    = NULL;
+            nFadeLength = OS_TRANSITION_DFL;
+            nFadeLeft   = 0;
+            nActMode    = nMode;
+            nActHBCoeffs= nHBCoeffs;
+            bActFilter  = bFilter;
+
+            sFade.vUpBuffer = NULL;
+            sFade.vHBFir    = NULL;
+            sFade.pFilter   = &sFadeFilter;
+            sFade.nUpHead   = 0;
+            sFade.nMode     = OM_NONE;
+            sFade.nHBCoeffs = nHBCoeffs;
+            sFade.nLatency  = 0;
+            sFade.bFilter   = bFilter;
+
+            for (size_t i=0; i<OS_HALFBAND_STAGES_MAX; ++i)
+            {
+                halfband_t *hb  = &vHalfBand[i];
+                hb->vUp         = NULL;
+                hb->vDown       = NULL;
+                hb->nUpHead     = 0;
+                hb->nDownHead   = 0;
+                hb->nDownPhase  = 0;
+                sFade.vHalfBand[i]  = *hb;
+            }
+
+            design_iir();
         }
 
         bool Oversampler::init()
         {
             if (!sFilter.init(NULL))
                 return false;
+            if (!sFadeFilter.init(NULL))
+                return false;
 
             if (bData == NULL)
             {
-                size_t samples  = OS_UP_BUFFER_SIZE + OS_DOWN_BUFFER_SIZE + LSP_DSP_RESAMPLING_RSV_SAMPLES;
+                // The state of the mode that fades out is allocated in advance
+                size_t samples  = OS_DOWN_BUFFER_SIZE + OS_FADE_BUFFER_SIZE + OS_STATE_SIZE * 2;
                 float *ptr      = alloc_aligned<float>(bData, samples, DEFAULT_ALIGN);
                 if (ptr == NULL)
                     return false;
@@ -78,12 +123,45 @@ namespace lsp
                 ptr            += OS_DOWN_BUFFER_SIZE;
                 fUpBuffer       = reinterpret_cast<float *>(ptr);
                 ptr            += OS_UP_BUFFER_SIZE + LSP_DSP_RESAMPLING_RSV_SAMPLES;
+                vHBFir          = ptr;
+                ptr            += OS_HB_COEFFS_MAX;
+
+                for (size_t i=0; i<OS_HALFBAND_STAGES_MAX; ++i)
+                {
+                    halfband_t *hb  = &vHalfBand[i];
+                    hb->vUp         = ptr;
+                    ptr            += OS_HB_UP_SIZE;
+                    hb->vDown       = ptr;
+                    ptr            += OS_HB_DOWN_SIZE;
+                }
+
+                vFadeBuf        = ptr;
+                ptr            += OS_FADE_BUFFER_SIZE;
+                sFade.vUpBuffer = ptr;
+                ptr            += OS_UP_BUFFER_SIZE + LSP_DSP_RESAMPLING_RSV_SAMPLES;
+                sFade.vHBFir    = ptr;
+                ptr            += OS_HB_COEFFS_MAX;
+
+                for (size_t i=0; i<OS_HALFBAND_STAGES_MAX; ++i)
+                {
+                    halfband_t *hb  = &sFade.vHalfBand[i];
+                    hb->vUp         = ptr;
+                    ptr            += OS_HB_UP_SIZE;
+                    hb->vDown       = ptr;
+                    ptr            += OS_HB_DOWN_SIZE;
+                }
             }
 
             // Clear buffer
             dsp::fill_zero(fUpBuffer, OS_UP_BUFFER_SIZE + LSP_DSP_RESAMPLING_RSV_SAMPLES);
             dsp::fill_zero(fDownBuffer, OS_DOWN_BUFFER_SIZE);
+            dsp::fill_zero(sFade.vUpBuffer, OS_UP_BUFFER_SIZE + LSP_DSP_RESAMPLING_RSV_SAMPLES);
             nUpHead       = 0;
+            nFadeLeft     = 0;
+
+            // Initialize half-band filter
+            design_halfband();
+            clear_halfband();
 
             return true;
         }
@@ -91,14 +169,67 @@ namespace lsp
         void Oversampler::destroy()
         {
             sFilter.destroy();
+            sFadeFilter.destroy();
             if (bData != NULL)
             {
                 free_aligned(bData);
                 fUpBuffer   = NULL;
                 fDownBuffer = NULL;
                 bData       = NULL;
+                vHBFir      = NULL;
+                vFadeBuf    = NULL;
+                sFade.vUpBuffer = NULL;
+                sFade.vHBFir    = NULL;
+
+                for (size_t i=0; i<OS_HALFBAND_STAGES_MAX; ++i)
+                {
+                    vHalfBand[i].vUp        = NULL;
+                    vHalfBand[i].vDown      = NULL;
+                    sFade.vHalfBand[i].vUp  = NULL;
+                    sFade.vHalfBand[i].vDown= NULL;
+                }
             }
+            nFadeLeft = 0;
             pCallback = NULL;
+            nChain    = 0;
+        }
+
+        bool Oversampler::add_callback(IOversamplerCallback *callback)
+        {
+            if ((callback == NULL) || (nChain >= OS_CALLBACK_CHAIN_MAX))
+                return false;
+            vChain[nChain++]    = callback;
+            return true;
+        }
+
+        bool Oversampler::remove_callback(IOversamplerCallback *callback)
+        {
+            for (size_t i=0; i<nChain; ++i)
+            {
+                if (vChain[i] != callback)
+                    continue;
+                for (--nChain; i<nChain; ++i)
+                    vChain[i]           = vChain[i+1];
+                return true;
+            }
+            return false;
+        }
+
+        void Oversampler::run_callbacks(IOversamplerCallback *callback, float *dst, const float *src, size_t count)
+        {
+            // The first stage reads the source, other stages process the destination in place
+            if (callback != NULL)
+            {
+                callback->process(dst, src, count);
+                src     = dst;
+            }
+            for (size_t i=0; i<nChain; ++i)
+            {
+                vChain[i]->process(dst, src, count);
+                src     = dst;
+            }
+            if (src != dst)
+                dsp::copy(dst, src, count);
         }
 
         void Oversampler::set_sample_rate(size_t sr)
@@ -119,26 +250,394 @@ namespace lsp
             fp.nType        = FLT_BT_BWC_LOPASS;// Chebyshev filter
 
             sFilter.update(nSampleRate * os, &fp);
+            sFadeFilter.update(nSampleRate * os, &fp);
         }
 
         void Oversampler::update_settings()
         {
-            if (nUpdate & (UP_MODE | UP_SAMPLE_RATE))
+            bool changed    = (nMode != nActMode) || (nHBCoeffs != nActHBCoeffs) || (bFilter != bActFilter);
+
+            if (nUpdate & UP_SAMPLE_RATE)
             {
                 dsp::fill_zero(fUpBuffer, OS_UP_BUFFER_SIZE + LSP_DSP_RESAMPLING_RSV_SAMPLES);
                 nUpHead       = 0;
-                sFilter.clear();
+                nFadeLeft     = 0;
+                pFilter->clear();
+
+                design_halfband();
+                clear_halfband();
+            }
+            else if ((nUpdate & UP_MODE) && (changed))
+            {
+                if ((nFadeLength > 0) && (fUpBuffer != NULL))
+                {
+                    // Move the running state to the fading slot, the new mode starts
+                    // with the state of the previous fading slot
+                    size_t mode     = nMode;
+                    size_t coeffs   = nHBCoeffs;
+                    bool filter     = bFilter;
+
+                    nMode           = nActMode;
+                    nHBCoeffs       = nActHBCoeffs;
+                    bFilter         = bActFilter;
+                    sFade.nLatency  = latency();
+                    swap_state();
+
+                    nMode           = mode;
+                    nHBCoeffs       = coeffs;
+                    bFilter         = filter;
+                    nFadeLeft       = nFadeLength;
+
+                    reset_state();
+                }
+                else
+                {
+                    dsp::fill_zero(fUpBuffer, OS_UP_BUFFER_SIZE + LSP_DSP_RESAMPLING_RSV_SAMPLES);
+                    nUpHead       = 0;
+                    nFadeLeft     = 0;
+                    pFilter->clear();
+
+                    design_halfband();
+                    clear_halfband();
+                }
             }
 
             size_t os       = get_oversampling();
             filter_params_t fp;
-            sFilter.get_params(&fp);
-            sFilter.update(nSampleRate * os, &fp);
+            pFilter->get_params(&fp);
+            pFilter->update(nSampleRate * os, &fp);
+
+            nActMode        = nMode;
+            nActHBCoeffs    = nHBCoeffs;
+            bActFilter      = bFilter;
 
             nUpdate = 0;
             return;
         }
 
+        void Oversampler::set_transition(size_t samples)
+        {
+            nFadeLength     = lsp_min(samples, size_t(OS_TRANSITION_MAX));
+        }
+
+        void Oversampler::swap_state()
+        {
+            lsp::swap(fUpBuffer, sFade.vUpBuffer);
+            lsp::swap(vHBFir, sFade.vHBFir);
+            lsp::swap(pFilter, sFade.pFilter);
+            lsp::swap(nUpHead, sFade.nUpHead);
+            lsp::swap(nMode, sFade.nMode);
+            lsp::swap(nHBCoeffs, sFade.nHBCoeffs);
+            lsp::swap(bFilter, sFade.bFilter);
+            for (size_t i=0; i<OS_HALFBAND_STAGES_MAX; ++i)
+                lsp::swap(vHalfBand[i], sFade.vHalfBand[i]);
+        }
+
+        void Oversampler::reset_state()
+        {
+            // Only the reserved tail of the buffer is cleared: the head placed at the end
+            // of the buffer forces the regular buffer shift at the next call
+            dsp::fill_zero(&fUpBuffer[OS_UP_BUFFER_SIZE], LSP_DSP_RESAMPLING_RSV_SAMPLES);
+            nUpHead         = OS_UP_BUFFER_SIZE;
+            pFilter->clear();
+
+            design_halfband();
+            clear_halfband();
+        }
+
+        void Oversampler::set_halfband_taps(size_t taps)
+        {
+            taps            = lsp_limit(taps, size_t(OS_HALFBAND_TAPS_MIN), size_t(OS_HALFBAND_TAPS_MAX));
+            size_t coeffs   = (taps + 1 + 2) / 4;   // Round to the nearest 4*k - 1 value
+            coeffs          = lsp_limit(coeffs, size_t((OS_HALFBAND_TAPS_MIN + 1) / 4), size_t(OS_HB_COEFFS_MAX));
+            if (coeffs == nHBCoeffs)
+                return;
+
+            nHBCoeffs       = coeffs;
+            nUpdate        |= UP_MODE;
+        }
+
+        void Oversampler::design_halfband()
+        {
+            if (vHBFir == NULL)
+                return;
+
+            // The filter has 4*K - 1 taps, all even taps except the central one are zero,
+            // the down buffer is used as a temporary storage for the window function
+            size_t half     = nHBCoeffs * 2 - 1;
+            windows::window(fDownBuffer, half * 2 + 1, windows::BLACKMAN);
+
+            float sum       = 0.0f;
+            for (size_t j=0; j<nHBCoeffs; ++j)
+            {
+                size_t d        = j*2 + 1;
+                float sign      = (j & 1) ? -1.0f : 1.0f;       // sin(pi * d / 2)
+                vHBFir[j]       = sign * fDownBuffer[half + d] / (M_PI * d);
+                sum            += vHBFir[j];
+            }
+
+            // Normalize gain at DC to 1, central tap is 0.5
+            dsp::mul_k2(vHBFir, 0.25f / sum, nHBCoeffs);
+            dsp::fill_zero(fDownBuffer, half * 2 + 1);
+        }
+
+        void Oversampler::clear_halfband()
+        {
+            for (size_t i=0; i<OS_HALFBAND_STAGES_MAX; ++i)
+            {
+                halfband_t *hb  = &vHalfBand[i];
+                if (hb->vUp != NULL)
+                    dsp::fill_zero(hb->vUp, OS_HB_UP_SIZE);
+                if (hb->vDown != NULL)
+                    dsp::fill_zero(hb->vDown, OS_HB_DOWN_SIZE);
+                hb->nUpHead     = 0;
+                hb->nDownHead   = 0;
+                hb->nDownPhase  = 0;
+
+                for (size_t j=0; j<OS_IIR_COEFFS; ++j)
+                {
+                    hb->sUpIIR.vX[j]    = 0.0f;
+                    hb->sUpIIR.vY[j]    = 0.0f;
+                    hb->sDownIIR.vX[j]  = 0.0f;
+                    hb->sDownIIR.vY[j]  = 0.0f;
+                }
+            }
+        }
+
+        size_t Oversampler::halfband_stages() const
+        {
+            switch (nMode)
+            {
+                case OM_HALFBAND_2X:
+                case OM_IIR_2X:
+                    return 1;
+                case OM_HALFBAND_4X:
+                case OM_IIR_4X:
+                    return 2;
+                case OM_HALFBAND_8X:
+                case OM_IIR_8X:
+                    return 3;
+                default:
+                    break;
+            }
+            return 0;
+        }
+
+        static double iir_acc_num(double q, size_t order, size_t c)
+        {
+            double acc      = 0.0;
+            double term     = 0.0;
+            double sign     = 1.0;
+
+            for (size_t i=0; ; ++i)
+            {
+                term            = pow(q, double(i * (i + 1))) * sin(double((i*2 + 1) * c) * M_PI / order) * sign;
+                acc            += term;
+                sign            = -sign;
+                if (fabs(term) <= 1e-100)
+                    break;
+            }
+
+            return acc;
+        }
+
+        static double iir_acc_den(double q, size_t order, size_t c)
+        {
+            double acc      = 0.0;
+            double term     = 0.0;
+            double sign     = -1.0;
+
+            for (size_t i=1; ; ++i)
+            {
+                term            = pow(q, double(i * i)) * cos(double(i * 2 * c) * M_PI / order) * sign;
+                acc            += term;
+                sign            = -sign;
+                if (fabs(term) <= 1e-100)
+                    break;
+            }
+
+            return acc;
+        }
+
+        void Oversampler::design_iir()
+        {
+            // Design the polyphase half-band elliptic filter made of two chains of
+            // allpass sections: H(z) = 1/2 * (A0(z^2) + z^-1 * A1(z^2))
+            double k        = tan((1.0 - 2.0 * OS_IIR_TRANSITION) * M_PI * 0.25);
+            k              *= k;
+            double kksqrt   = pow(1.0 - k * k, 0.25);
+            double e        = 0.5 * (1.0 - kksqrt) / (1.0 + kksqrt);
+            double e4       = e * e * e * e;
+            double q        = e * (1.0 + e4 * (2.0 + e4 * (15.0 + 150.0 * e4)));
+            size_t order    = OS_IIR_COEFFS * 2 + 1;
+
+            double delay[2] = { 0.0, 0.0 };
+            for (size_t i=0; i<OS_IIR_COEFFS; ++i)
+            {
+                double num      = iir_acc_num(q, order, i + 1) * pow(q, 0.25);
+                double den      = iir_acc_den(q, order, i + 1) + 0.5;
+                double ww       = num / den;
+                double wwsq     = ww * ww;
+                double x        = sqrt((1.0 - wwsq * k) * (1.0 - wwsq / k)) / (1.0 + wwsq);
+                double a        = (1.0 - x) / (1.0 + x);
+
+                vIIRCoeffs[i]   = a;
+
+                // Group delay at DC of the allpass section (a + z^-2)/(1 + a*z^-2)
+                delay[i & 1]   += 2.0 * (1.0 - a) / (1.0 + a);
+            }
+
+            // Compute the overall delay of the interpolation and decimation stage at DC
+            // in samples of the lower sample rate
+            fIIRDelay       = (delay[0] + delay[1] + 1.0) * 0.5 - 0.5;
+        }
+
+        static inline void iir_process(float *x, float *y, const float *k, float &s0, float &s1)
+        {
+            // Even sections belong to the first chain, odd sections belong to the second chain
+            for (size_t i=0; i<OS_IIR_COEFFS; i += 2)
+            {
+                float t0        = (s0 - y[i]) * k[i] + x[i];
+                float t1        = (s1 - y[i+1]) * k[i+1] + x[i+1];
+                x[i]            = s0;
+                x[i+1]          = s1;
+                y[i]            = t0;
+                y[i+1]          = t1;
+                s0              = t0;
+                s1              = t1;
+            }
+        }
+
+        void Oversampler::iir_upsample(halfband_t *hb, float *dst, const float *src, size_t count)
+        {
+            for (size_t i=0; i<count; ++i)
+            {
+                float s0        = src[i];
+                float s1        = s0;
+                iir_process(hb->sUpIIR.vX, hb->sUpIIR.vY, vIIRCoeffs, s0, s1);
+                dst[0]          = s0;
+                dst[1]          = s1;
+                dst            += 2;
+            }
+        }
+
+        size_t Oversampler::iir_downsample(halfband_t *hb, float *dst, const float *src, size_t count)
+        {
+            size_t n        = count >> 1;
+            for (size_t i=0; i<n; ++i)
+            {
+                float s0        = src[1];
+                float s1        = src[0];
+                iir_process(hb->sDownIIR.vX, hb->sDownIIR.vY, vIIRCoeffs, s0, s1);
+                dst[i]          = 0.5f * (s0 + s1);
+                src            += 2;
+            }
+
+            return n;
+        }
+
+        void Oversampler::halfband_upsample(halfband_t *hb, float *dst, const float *src, size_t count)
+        {
+            // The history contains 2*K last input samples and is written twice to
+            // have a contiguous window without moving the data
+            size_t len      = nHBCoeffs * 2;
+            float *h        = hb->vUp;
+
+            for (size_t i=0; i<count; ++i)
+            {
+                float s             = src[i];
+                h[hb->nUpHead]      = s;
+                h[hb->nUpHead + len]= s;
+                if ((++hb->nUpHead) >= len)
+                    hb->nUpHead         = 0;
+
+                // Even output sample is interpolated, odd output sample is the delayed input
+                const float *w      = &h[hb->nUpHead + nHBCoeffs];
+                float y             = 0.0f;
+                for (size_t j=0; j<nHBCoeffs; ++j)
+                    y                  += vHBFir[j] * (w[j] + w[-1 - ssize_t(j)]);
+
+                dst[0]              = 2.0f * y;
+                dst[1]              = w[0];
+                dst                += 2;
+            }
+        }
+
+        size_t Oversampler::halfband_downsample(halfband_t *hb, float *dst, const float *src, size_t count)
+        {
+            // The history contains 4*K - 1 last input samples and is written twice to
+            // have a contiguous window without moving the data
+            size_t half     = nHBCoeffs * 2 - 1;
+            size_t len      = half * 2 + 1;
+            float *h        = hb->vDown;
+            size_t n        = 0;
+
+            for (size_t i=0; i<count; ++i)
+            {
+                float s             = src[i];
+                h[hb->nDownHead]    = s;
+                h[hb->nDownHead + len] = s;
+                if ((++hb->nDownHead) >= len)
+                    hb->nDownHead       = 0;
+
+                // Emit each second sample
+                if (hb->nDownPhase)
+                {
+                    hb->nDownPhase      = 0;
+                    continue;
+                }
+                hb->nDownPhase      = 1;
+
+                // Apply the filter, all even taps except the central one are zero
+                const float *w      = &h[hb->nDownHead + half];
+                float y             = 0.5f * w[0];
+                for (size_t j=0; j<nHBCoeffs; ++j)
+                {
+                    ssize_t d           = j*2 + 1;
+                    y                  += vHBFir[j] * (w[-d] + w[d]);
+                }
+                dst[n++]            = y;
+            }
+
+            return n;
+        }
+
+        void Oversampler::cascade_upsample(float *dst, const float *src, size_t count)
+        {
+            // Each stage output is placed at the end of the destination buffer, so the
+            // next stage can safely process it in place
+            size_t stages   = halfband_stages();
+            size_t total    = count << stages;
+
+            for (size_t i=0; i<stages; ++i)
+            {
+                float *out      = &dst[total - (count << 1)];
+                if (nMode >= OM_IIR_2X)
+                    iir_upsample(&vHalfBand[i], out, src, count);
+                else
+                    halfband_upsample(&vHalfBand[i], out, src, count);
+                src             = out;
+                count         <<= 1;
+            }
+        }
+
+        void Oversampler::cascade_downsample(float *dst, const float *src, size_t count)
+        {
+            // The number of samples is reduced at each stage, so the temporary
+            // buffer can be processed in place
+            size_t stages   = halfband_stages();
+            size_t n        = count << stages;
+
+            for (size_t i=stages; i > 0; --i)
+            {
+                float *out      = (i > 1) ? fDownBuffer : dst;
+                n               = (nMode >= OM_IIR_2X) ?
+                                    iir_downsample(&vHalfBand[i-1], out, src, n) :
+                                    halfband_downsample(&vHalfBand[i-1], out, src, n);
+                src             = out;
+            }
+        }
+
         size_t Oversampler::get_oversampling() const
         {
             switch (nMode)
@@ -168,6 +667,16 @@ namespace lsp
                 case OM_LANCZOS_8X4:
                     return 8;
 
+                case OM_HALFBAND_2X:
+                case OM_IIR_2X:
+                    return 2;
+                case OM_HALFBAND_4X:
+                case OM_IIR_4X:
+                    return 4;
+                case OM_HALFBAND_8X:
+                case OM_IIR_8X:
+                    return 8;
+
                 default:
                     break;
             }
@@ -177,6 +686,9 @@ namespace lsp
 
         void Oversampler::upsample(float *dst, const float *src, size_t samples)
         {
+            // The transition between modes is supported by process() only
+            nFadeLeft       = 0;
+
             switch (nMode)
             {
                 case OM_LANCZOS_2X2:
@@ -359,6 +871,14 @@ namespace lsp
                     break;
                 }
 
+                case OM_HALFBAND_2X:
+                case OM_HALFBAND_4X:
+                case OM_HALFBAND_8X:
+                case OM_IIR_2X:
+                case OM_IIR_4X:
+                case OM_IIR_8X:
+                    cascade_upsample(dst, src, samples);
+                    break;
 
                 case OM_NONE:
                 default:
@@ -369,6 +889,9 @@ namespace lsp
 
         void Oversampler::downsample(float *dst, const float *src, size_t samples)
         {
+            // The transition between modes is supported by process() only
+            nFadeLeft       = 0;
+
             switch (nMode)
             {
                 case OM_LANCZOS_2X2:
@@ -383,7 +906,7 @@ namespace lsp
 
                         if (bFilter)
                         {
-                            sFilter.process(fDownBuffer, src, to_do << 1);
+                            pFilter->process(fDownBuffer, src, to_do << 1);
                             dsp::downsample_2x(dst, fDownBuffer, to_do);
                         }
                         else
@@ -409,7 +932,7 @@ namespace lsp
 
                         if (bFilter)
                         {
-                            sFilter.process(fDownBuffer, src, to_do * 3);
+                            pFilter->process(fDownBuffer, src, to_do * 3);
                             dsp::downsample_3x(dst, fDownBuffer, to_do);
                         }
                         else
@@ -435,7 +958,7 @@ namespace lsp
 
                         if (bFilter)
                         {
-                            sFilter.process(fDownBuffer, src, to_do << 2);
+                            pFilter->process(fDownBuffer, src, to_do << 2);
                             dsp::downsample_4x(dst, fDownBuffer, to_do);
                         }
                         else
@@ -462,7 +985,7 @@ namespace lsp
                         // Pack samples to dst
                         if (bFilter)
                         {
-                            sFilter.process(fDownBuffer, src, to_do * 6);
+                            pFilter->process(fDownBuffer, src, to_do * 6);
                             dsp::downsample_6x(dst, fDownBuffer, to_do);
                         }
                         else
@@ -489,7 +1012,7 @@ namespace lsp
                         // Pack samples to dst
                         if (bFilter)
                         {
-                            sFilter.process(fDownBuffer, src, to_do << 3);
+                            pFilter->process(fDownBuffer, src, to_do << 3);
                             dsp::downsample_8x(dst, fDownBuffer, to_do);
                         }
                         else
@@ -503,6 +1026,30 @@ namespace lsp
                     break;
                 }
 
+                case OM_HALFBAND_2X:
+                case OM_HALFBAND_4X:
+                case OM_HALFBAND_8X:
+                case OM_IIR_2X:
+                case OM_IIR_4X:
+                case OM_IIR_8X:
+                {
+                    // The half-band decimator is the anti-aliasing filter itself
+                    size_t stages   = halfband_stages();
+                    while (samples > 0)
+                    {
+                        size_t can_do   = OS_DOWN_BUFFER_SIZE >> (stages - 1);
+                        size_t to_do    = (samples > can_do) ? can_do : samples;
+
+                        cascade_downsample(dst, src, to_do);
+
+                        // Update pointers
+                        src            += to_do << stages;
+                        dst            += to_do;
+                        samples        -= to_do;
+                    }
+                    break;
+                }
+
                 case OM_NONE:
                 default:
                     dsp::copy(dst, src, samples);
@@ -511,6 +1058,34 @@ namespace lsp
         }
 
         void Oversampler::process(float *dst, const float *src, size_t samples, IOversamplerCallback *callback)
+        {
+            // Both modes are running during the transition, the previous mode is processed
+            // first since the destination may be the same as the source
+            while ((nFadeLeft > 0) && (samples > 0))
+            {
+                size_t to_do    = lsp_min(samples, lsp_min(nFadeLeft, size_t(OS_FADE_BUFFER_SIZE)));
+
+                swap_state();
+                process_mode(vFadeBuf, src, to_do, callback);
+                swap_state();
+                process_mode(dst, src, to_do, callback);
+
+                float k         = 1.0f / (nFadeLength + 1);
+                float g         = float(nFadeLength - nFadeLeft + 1) * k;
+                for (size_t i=0; i<to_do; ++i, g += k)
+                    dst[i]          = vFadeBuf[i] + (dst[i] - vFadeBuf[i]) * g;
+
+                nFadeLeft      -= to_do;
+                dst            += to_do;
+                src            += to_do;
+                samples        -= to_do;
+            }
+
+            if (samples > 0)
+                process_mode(dst, src, samples, callback);
+        }
+
+        void Oversampler::process_mode(float *dst, const float *src, size_t samples, IOversamplerCallback *callback)
         {
             switch (nMode)
             {
@@ -540,13 +1115,12 @@ namespace lsp
                         else
                             dsp::lanczos_resample_2x4(&fUpBuffer[nUpHead], src, to_do);
 
-                        // Call handler
-                        if (callback != NULL)
-                            callback->process(&fUpBuffer[nUpHead], &fUpBuffer[nUpHead], to_do << 1);
+                        // Call handlers
+                        run_callbacks(callback, &fUpBuffer[nUpHead], &fUpBuffer[nUpHead], to_do << 1);
 
                         // Do downsampling
                         if (bFilter)
-                            sFilter.process(&fUpBuffer[nUpHead], &fUpBuffer[nUpHead], to_do << 1);
+                            pFilter->process(&fUpBuffer[nUpHead], &fUpBuffer[nUpHead], to_do << 1);
                         dsp::downsample_2x(dst, &fUpBuffer[nUpHead], to_do);
 
                         // Update pointers
@@ -584,13 +1158,12 @@ namespace lsp
                         else
                             dsp::lanczos_resample_3x4(&fUpBuffer[nUpHead], src, to_do);
 
-                        // Call handler
-                        if (callback != NULL)
-                            callback->process(&fUpBuffer[nUpHead], &fUpBuffer[nUpHead], to_do * 3);
+                        // Call handlers
+                        run_callbacks(callback, &fUpBuffer[nUpHead], &fUpBuffer[nUpHead], to_do * 3);
 
                         // Do downsampling
                         if (bFilter)
-                            sFilter.process(&fUpBuffer[nUpHead], &fUpBuffer[nUpHead], to_do * 3);
+                            pFilter->process(&fUpBuffer[nUpHead], &fUpBuffer[nUpHead], to_do * 3);
                         dsp::downsample_3x(dst, &fUpBuffer[nUpHead], to_do);
 
                         // Update pointers
@@ -628,13 +1201,12 @@ namespace lsp
                         else
                             dsp::lanczos_resample_4x4(&fUpBuffer[nUpHead], src, to_do);
 
-                        // Call handler
-                        if (callback != NULL)
-                            callback->process(&fUpBuffer[nUpHead], &fUpBuffer[nUpHead], to_do << 2);
+                        // Call handlers
+                        run_callbacks(callback, &fUpBuffer[nUpHead], &fUpBuffer[nUpHead], to_do << 2);
 
                         // Do downsampling
                         if (bFilter)
-                            sFilter.process(&fUpBuffer[nUpHead], &fUpBuffer[nUpHead], to_do << 2);
+                            pFilter->process(&fUpBuffer[nUpHead], &fUpBuffer[nUpHead], to_do << 2);
                         dsp::downsample_4x(dst, &fUpBuffer[nUpHead], to_do);
 
                         // Update pointers
@@ -672,13 +1244,12 @@ namespace lsp
                         else
                             dsp::lanczos_resample_6x4(&fUpBuffer[nUpHead], src, to_do);
 
-                        // Call handler
-                        if (callback != NULL)
-                            callback->process(&fUpBuffer[nUpHead], &fUpBuffer[nUpHead], to_do * 6);
+                        // Call handlers
+                        run_callbacks(callback, &fUpBuffer[nUpHead], &fUpBuffer[nUpHead], to_do * 6);
 
                         // Do downsampling
                         if (bFilter)
-                            sFilter.process(&fUpBuffer[nUpHead], &fUpBuffer[nUpHead], to_do * 6);
+                            pFilter->process(&fUpBuffer[nUpHead], &fUpBuffer[nUpHead], to_do * 6);
                         dsp::downsample_6x(dst, &fUpBuffer[nUpHead], to_do);
 
                         // Update pointers
@@ -716,13 +1287,12 @@ namespace lsp
                         else
                             dsp::lanczos_resample_8x4(&fUpBuffer[nUpHead], src, to_do);
 
-                        // Call handler
-                        if (callback != NULL)
-                            callback->process(&fUpBuffer[nUpHead], &fUpBuffer[nUpHead], to_do << 3);
+                        // Call handlers
+                        run_callbacks(callback, &fUpBuffer[nUpHead], &fUpBuffer[nUpHead], to_do << 3);
 
                         // Do downsampling
                         if (bFilter)
-                            sFilter.process(&fUpBuffer[nUpHead], &fUpBuffer[nUpHead], to_do << 3);
+                            pFilter->process(&fUpBuffer[nUpHead], &fUpBuffer[nUpHead], to_do << 3);
                         dsp::downsample_8x(dst, &fUpBuffer[nUpHead], to_do);
 
                         // Update pointers
@@ -734,12 +1304,41 @@ namespace lsp
                     break;
                 }
 
+                case OM_HALFBAND_2X:
+                case OM_HALFBAND_4X:
+                case OM_HALFBAND_8X:
+                case OM_IIR_2X:
+                case OM_IIR_4X:
+                case OM_IIR_8X:
+                {
+                    // The half-band filters keep their own history, so the up buffer
+                    // is used from the beginning and never needs shifting or clearing
+                    size_t stages   = halfband_stages();
+                    while (samples > 0)
+                    {
+                        size_t can_do   = OS_UP_BUFFER_SIZE >> stages;
+                        size_t to_do    = (samples > can_do) ? can_do : samples;
+
+                        // Do oversampling
+                        cascade_upsample(fUpBuffer, src, to_do);
+
+                        // Call handlers
+                        run_callbacks(callback, fUpBuffer, fUpBuffer, to_do << stages);
+
+                        // Do downsampling
+                        cascade_downsample(dst, fUpBuffer, to_do);
+
+                        // Update pointers
+                        dst            += to_do;
+                        src            += to_do;
+                        samples        -= to_do;
+                    }
+                    break;
+                }
+
                 case OM_NONE:
                 default:
-                    if (callback != NULL)
-                        callback->process(dst, src, samples);
-                    else
-                        dsp::copy(dst, src, samples);
+                    run_callbacks(callback, dst, src, samples);
                     break;
             }
         }
@@ -769,6 +1368,28 @@ namespace lsp
                 case OM_LANCZOS_8X4:
                     return 4;
 
+                case OM_HALFBAND_2X:
+                case OM_HALFBAND_4X:
+                case OM_HALFBAND_8X:
+                {
+                    // Each 2x stage delays the signal by (2*K - 1) samples of its rate
+                    // twice: once for interpolation and once for decimation
+                    size_t stages   = halfband_stages();
+                    float half      = nHBCoeffs * 2 - 1;
+                    float delay     = 2.0f * half * (1.0f - 1.0f / float(1 << stages));
+                    return delay + 0.5f;
+                }
+
+                case OM_IIR_2X:
+                case OM_IIR_4X:
+                case OM_IIR_8X:
+                {
+                    // Each next stage adds twice lower delay
+                    size_t stages   = halfband_stages();
+                    float delay     = fIIRDelay * (2.0f - 2.0f / float(1 << stages));
+                    return delay + 0.5f;
+                }
+
                 default:
                     break;
             }
@@ -776,9 +1397,38 @@ namespace lsp
             return 0;
         }
 
+        size_t Oversampler::max_latency() const
+        {
+            float half      = OS_HB_COEFFS_MAX * 2 - 1;
+            float delay     = 2.0f * half * (1.0f - 1.0f / float(1 << OS_HALFBAND_STAGES_MAX));
+            return delay + 0.5f;
+        }
+
+        void Oversampler::memory_usage(memory_report_t *r) const
+        {
+            // The state of the mode that fades out is used only by transitions
+            if (bData != NULL)
+            {
+                size_t allocate     = OS_DOWN_BUFFER_SIZE + OS_FADE_BUFFER_SIZE + OS_STATE_SIZE * 2;
+                size_t used         = OS_DOWN_BUFFER_SIZE + OS_STATE_SIZE +
+                                      ((in_transition()) ? OS_FADE_BUFFER_SIZE + OS_STATE_SIZE : 0);
+                memory::add_aligned(r, bData, allocate * sizeof(float), used * sizeof(float));
+            }
+
+            sFilter.memory_usage(r);
+            sFadeFilter.memory_usage(r);
+        }
+
         void Oversampler::dump(IStateDumper *v) const
         {
             v->write("pCallback", pCallback);
+            v->begin_array("vChain", vChain, nChain);
+            {
+                for (size_t i=0; i<nChain; ++i)
+                    v->write(vChain[i]);
+            }
+            v->end_array();
+            v->write("nChain", nChain);
             v->write("fUpBuffer", fUpBuffer);
             v->write("fDownBuffer", fDownBuffer);
             v->write("nUpHead", nUpHead);
@@ -786,8 +1436,47 @@ namespace lsp
             v->write("nSampleRate", nSampleRate);
             v->write("nUpdate", nUpdate);
             v->write_object("sFilter", &sFilter);
+            v->write_object("sFadeFilter", &sFadeFilter);
+            v->write("pFilter", pFilter);
+            v->begin_object("sFade", &sFade, sizeof(fade_t));
+            {
+                v->write("vUpBuffer", sFade.vUpBuffer);
+                v->write("vHBFir", sFade.vHBFir);
+                v->write("pFilter", sFade.pFilter);
+                v->write("nUpHead", sFade.nUpHead);
+                v->write("nMode", sFade.nMode);
+                v->write("nHBCoeffs", sFade.nHBCoeffs);
+                v->write("nLatency", sFade.nLatency);
+                v->write("bFilter", sFade.bFilter);
+            }
+            v->end_object();
+            v->write("vFadeBuf", vFadeBuf);
+            v->write("nFadeLength", nFadeLength);
+            v->write("nFadeLeft", nFadeLeft);
+            v->write("nActMode", nActMode);
+            v->write("nActHBCoeffs", nActHBCoeffs);
+            v->write("bActFilter", bActFilter);
             v->write("bData", bData);
             v->write("bFilter", bFilter);
+            v->write("nHBCoeffs", nHBCoeffs);
+            v->write("vHBFir", vHBFir);
+            v->writev("vIIRCoeffs", vIIRCoeffs, OS_IIR_COEFFS);
+            v->write("fIIRDelay", fIIRDelay);
+            v->begin_array("vHalfBand", vHalfBand, OS_HALFBAND_STAGES_MAX);
+            for (size_t i=0; i<OS_HALFBAND_STAGES_MAX; ++i)
+            {
+                const halfband_t *hb = &vHalfBand[i];
+                v->begin_object(hb, sizeof(halfband_t));
+                {
+                    v->write("vUp", hb->vUp);
+                    v->write("vDown", hb->vDown);
+                    v->write("nUpHead", hb->nUpHead);
+                    v->write("nDownHead", hb->nDownHead);
+                    v->write("nDownPhase", hb->nDownPhase);
+                }
+                v->end_object();
+            }
+            v->end_array();
         }
     }
 } /* namespace lsp */
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/dsp-units/util/PerfCounter.h>
+#include <lsp-plug.in/runtime/system.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        PerfCounter::PerfCounter()
+        {
+            construct();
+        }
+
+        PerfCounter::~PerfCounter()
+        {
+        }
+
+        void PerfCounter::construct()
+        {
+            nSeq                = 0;
+            sData.nCalls        = 0;
+            sData.nSamples      = 0;
+            sData.nTime         = 0;
+            sData.nReconfigs    = 0;
+        }
+
+        uint64_t PerfCounter::timestamp()
+        {
+            system::time_t ts;
+            system::get_time(&ts);
+            return uint64_t(ts.seconds) * 1000000000ULL + ts.nanos;
+        }
+
+        void PerfCounter::processed(size_t samples, uint64_t time)
+        {
+            begin_update();
+            ++sData.nCalls;
+            sData.nSamples     += samples;
+            sData.nTime        += time;
+            end_update();
+        }
+
+        void PerfCounter::reconfigured()
+        {
+            begin_update();
+            ++sData.nReconfigs;
+            end_update();
+        }
+
+        void PerfCounter::reset()
+        {
+            begin_update();
+            sData.nCalls        = 0;
+            sData.nSamples      = 0;
+            sData.nTime         = 0;
+            sData.nReconfigs    = 0;
+            end_update();
+        }
+
+        void PerfCounter::read(perf_counters_t *dst) const
+        {
+            atomic_t *seq       = const_cast<atomic_t *>(&nSeq);
+
+            while (true)
+            {
+                atomic_t s1         = atomic_add(seq, 0);
+                if (s1 & 1)
+                    continue;
+
+                perf_counters_t tmp = sData;
+                atomic_t s2         = atomic_add(seq, 0);
+                if (s1 == s2)
+                {
+                    *dst                = tmp;
+                    return;
+                }
+            }
+        }
+
+        void PerfCounter::dump(IStateDumper *v) const
+        {
+            perf_counters_t c;
+            read(&c);
+
+            v->write("nCalls", c.nCalls);
+            v->write("nSamples", c.nSamples);
+            v->write("nTime", c.nTime);
+            v->write("nReconfigs", c.nReconfigs);
+        }
+    } /* namespace dspu */
+} /* namespace lsp */
@@ -0,0 +1,650 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/dsp-units/util/ProcessGraph.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/stdlib.h>
+
+#define GRAPH_BUF_ALIGN         16
+
+namespace lsp
+{
+    namespace dspu
+    {
+        ProcessGraph::ProcessGraph()
+        {
+            nInputs         = 0;
+            nBuffers        = 0;
+            nBufSize        = 0;
+            nLatency        = 0;
+            bCompiled       = false;
+            pWorkers        = NULL;
+
+            pIn             = NULL;
+            nOffset         = 0;
+            nToDo           = 0;
+            nLevelFirst     = 0;
+
+            vBuffers        = NULL;
+            vZero           = NULL;
+            vSink           = NULL;
+            vPtrs           = NULL;
+            pData           = NULL;
+        }
+
+        ProcessGraph::~ProcessGraph()
+        {
+            destroy();
+        }
+
+        void ProcessGraph::destroy()
+        {
+            destroy_plan();
+
+            vNodes.flush();
+            vLinks.flush();
+            vOutLinks.flush();
+            nInputs         = 0;
+        }
+
+        void ProcessGraph::destroy_plan()
+        {
+            for (size_t i=0, n=vDelays.size(); i<n; ++i)
+            {
+                delay_t *d      = vDelays.uget(i);
+                d->pDelay->destroy();
+                delete d->pDelay;
+            }
+            for (size_t i=0, n=vOutputs.size(); i<n; ++i)
+            {
+                output_t *o     = vOutputs.uget(i);
+                if (o->pDelay == NULL)
+                    continue;
+                o->pDelay->destroy();
+                delete o->pDelay;
+            }
+
+            vSteps.flush();
+            vLevels.flush();
+            vRefs.flush();
+            vDelays.flush();
+            vOutputs.flush();
+
+            free_aligned(pData);
+            vBuffers        = NULL;
+            vZero           = NULL;
+            vSink           = NULL;
+            vPtrs           = NULL;
+
+            nBuffers        = 0;
+            nBufSize        = 0;
+            nLatency        = 0;
+            bCompiled       = false;
+        }
+
+        ssize_t ProcessGraph::add_input()
+        {
+            bCompiled       = false;
+            return nInputs++;
+        }
+
+        ssize_t ProcessGraph::add_output()
+        {
+            link_t *l       = vOutLinks.add();
+            if (l == NULL)
+                return -STATUS_NO_MEM;
+
+            l->nNode        = SRC_NONE;
+            l->nPort        = 0;
+            bCompiled       = false;
+
+            return vOutLinks.size() - 1;
+        }
+
+        ssize_t ProcessGraph::add_node(size_t inputs, size_t outputs, graph_process_t func, void *object, void *subject, size_t latency)
+        {
+            if (func == NULL)
+                return -STATUS_BAD_ARGUMENTS;
+
+            size_t first    = vLinks.size();
+            link_t *l       = (inputs > 0) ? vLinks.append_n(inputs) : NULL;
+            if ((inputs > 0) && (l == NULL))
+                return -STATUS_NO_MEM;
+            for (size_t i=0; i<inputs; ++i)
+            {
+                l[i].nNode      = SRC_NONE;
+                l[i].nPort      = 0;
+            }
+
+            node_t *n       = vNodes.add();
+            if (n == NULL)
+                return -STATUS_NO_MEM;
+
+            n->pFunc        = func;
+            n->pObject      = object;
+            n->pSubject     = subject;
+            n->nInputs      = inputs;
+            n->nOutputs     = outputs;
+            n->nLatency     = latency;
+            n->nLink        = first;
+            n->nFirstOut    = 0;
+            n->nPending     = 0;
+            n->nArrival     = 0;
+            n->nLevel       = 0;
+            bCompiled       = false;
+
+            return vNodes.size() - 1;
+        }
+
+        status_t ProcessGraph::set_latency(size_t node, size_t latency)
+        {
+            node_t *n       = vNodes.get(node);
+            if (n == NULL)
+                return STATUS_INVALID_VALUE;
+            if (n->nLatency != latency)
+            {
+                n->nLatency     = latency;
+                bCompiled       = false;
+            }
+            return STATUS_OK;
+        }
+
+        status_t ProcessGraph::connect(size_t src, size_t src_port, size_t dst, size_t dst_port)
+        {
+            node_t *s       = vNodes.get(src);
+            node_t *d       = vNodes.get(dst);
+            if ((s == NULL) || (d == NULL))
+                return STATUS_INVALID_VALUE;
+            if ((src_port >= s->nOutputs) || (dst_port >= d->nInputs))
+                return STATUS_OVERFLOW;
+
+            link_t *l       = vLinks.uget(d->nLink + dst_port);
+            if (l->nNode != SRC_NONE)
+                return STATUS_ALREADY_BOUND;
+
+            l->nNode        = src;
+            l->nPort        = src_port;
+            bCompiled       = false;
+
+            return STATUS_OK;
+        }
+
+        status_t ProcessGraph::connect_input(size_t input, size_t dst, size_t dst_port)
+        {
+            node_t *d       = vNodes.get(dst);
+            if ((d == NULL) || (input >= nInputs))
+                return STATUS_INVALID_VALUE;
+            if (dst_port >= d->nInputs)
+                return STATUS_OVERFLOW;
+
+            link_t *l       = vLinks.uget(d->nLink + dst_port);
+            if (l->nNode != SRC_NONE)
+                return STATUS_ALREADY_BOUND;
+
+            l->nNode        = SRC_INPUT;
+            l->nPort        = input;
+            bCompiled       = false;
+
+            return STATUS_OK;
+        }
+
+        status_t ProcessGraph::connect_output(size_t src, size_t src_port, size_t output)
+        {
+            node_t *s       = vNodes.get(src);
+            link_t *l       = vOutLinks.get(output);
+            if ((s == NULL) || (l == NULL))
+                return STATUS_INVALID_VALUE;
+            if (src_port >= s->nOutputs)
+                return STATUS_OVERFLOW;
+            if (l->nNode != SRC_NONE)
+                return STATUS_ALREADY_BOUND;
+
+            l->nNode        = src;
+            l->nPort        = src_port;
+            bCompiled       = false;
+
+            return STATUS_OK;
+        }
+
+        size_t ProcessGraph::alloc_buffer(lltl::darray<size_t> *pool, size_t *count)
+        {
+            size_t n        = pool->size();
+            if (n <= 0)
+                return (*count)++;
+
+            size_t id       = *(pool->uget(n - 1));
+            pool->remove(n - 1);
+            return id;
+        }
+
+        status_t ProcessGraph::compile(size_t buf_size)
+        {
+            if (buf_size <= 0)
+                return STATUS_BAD_ARGUMENTS;
+
+            destroy_plan();
+
+            size_t nodes        = vNodes.size();
+            size_t total_outs   = 0;
+
+            // Enumerate outputs of all nodes and count dependencies of nodes
+            for (size_t i=0; i<nodes; ++i)
+            {
+                node_t *n           = vNodes.uget(i);
+                n->nFirstOut        = total_outs;
+                n->nPending         = 0;
+                n->nArrival         = 0;
+                n->nLevel           = 0;
+                total_outs         += n->nOutputs;
+
+                for (size_t j=0; j<n->nInputs; ++j)
+                {
+                    const link_t *l     = vLinks.uget(n->nLink + j);
+                    if (l->nNode >= 0)
+                        ++n->nPending;
+                }
+            }
+
+            // Sort nodes in the order of processing and compute the latency at node inputs,
+            // the queue is ordered by levels since each node is added after all its sources
+            size_t *order       = static_cast<size_t *>(malloc(sizeof(size_t) * (nodes + total_outs * 2 + 1)));
+            if (order == NULL)
+                return STATUS_NO_MEM;
+            size_t *users       = &order[nodes];            // Number of consumers of each node output
+            ssize_t *refs       = reinterpret_cast<ssize_t *>(&users[total_outs]); // Buffer of each node output
+
+            size_t sorted       = 0;
+            for (size_t i=0; i<nodes; ++i)
+                if (vNodes.uget(i)->nPending == 0)
+                    order[sorted++]     = i;
+
+            for (size_t i=0; i<sorted; ++i)
+            {
+                const node_t *s     = vNodes.uget(order[i]);
+                size_t out_lat      = s->nArrival + s->nLatency;
+
+                for (size_t j=0; j<nodes; ++j)
+                {
+                    node_t *n           = vNodes.uget(j);
+                    for (size_t k=0; k<n->nInputs; ++k)
+                    {
+                        const link_t *l     = vLinks.uget(n->nLink + k);
+                        if (l->nNode != ssize_t(order[i]))
+                            continue;
+                        n->nArrival         = lsp_max(n->nArrival, out_lat);
+                        n->nLevel           = lsp_max(n->nLevel, s->nLevel + 1);
+                        if ((--n->nPending) == 0)
+                            order[sorted++]     = j;
+                    }
+                }
+            }
+            if (sorted < nodes)
+            {
+                free(order);
+                return STATUS_BAD_STATE;
+            }
+
+            // Compute the overall latency and count consumers of each node output
+            for (size_t i=0; i<total_outs; ++i)
+            {
+                users[i]            = 0;
+                refs[i]             = REF_SINK;
+            }
+            for (size_t i=0, n=vLinks.size(); i<n; ++i)
+            {
+                const link_t *l     = vLinks.uget(i);
+                if (l->nNode >= 0)
+                    ++users[vNodes.uget(l->nNode)->nFirstOut + l->nPort];
+            }
+
+            size_t latency      = 0;
+            for (size_t i=0, n=vOutLinks.size(); i<n; ++i)
+            {
+                const link_t *l     = vOutLinks.uget(i);
+                if (l->nNode < 0)
+                    continue;
+                const node_t *s     = vNodes.uget(l->nNode);
+                ++users[s->nFirstOut + l->nPort];
+                latency             = lsp_max(latency, s->nArrival + s->nLatency);
+            }
+
+            // Build the plan: the buffer is returned to the pool after the level which contains the
+            // last consumer of the signal has been processed, so the nodes of the same level never
+            // share buffers and the outputs of the node never share buffers with its inputs
+            lltl::darray<size_t> pool, released;
+            size_t buffers      = 0;
+            status_t res        = STATUS_OK;
+            level_t *lvl        = NULL;
+
+            for (size_t i=0; (i<nodes) && (res == STATUS_OK); ++i)
+            {
+                const node_t *n     = vNodes.uget(order[i]);
+
+                // Start new level
+                if ((lvl == NULL) || (n->nLevel != vNodes.uget(order[i-1])->nLevel))
+                {
+                    for (size_t j=0, m=released.size(); j<m; ++j)
+                    {
+                        size_t *id          = pool.add();
+                        if (id == NULL)
+                        {
+                            res                 = STATUS_NO_MEM;
+                            break;
+                        }
+                        *id                 = *(released.uget(j));
+                    }
+                    released.clear();
+
+                    if ((res != STATUS_OK) || ((lvl = vLevels.add()) == NULL))
+                    {
+                        res                 = STATUS_NO_MEM;
+                        break;
+                    }
+                    lvl->nFirst         = vSteps.size();
+                    lvl->nSteps         = 0;
+                }
+                ++lvl->nSteps;
+
+                step_t *st          = vSteps.add();
+                ssize_t *r          = (n->nInputs + n->nOutputs > 0) ? vRefs.append_n(n->nInputs + n->nOutputs) : NULL;
+                if ((st == NULL) || ((n->nInputs + n->nOutputs > 0) && (r == NULL)))
+                {
+                    res                 = STATUS_NO_MEM;
+                    break;
+                }
+
+                st->nNode           = order[i];
+                st->nRef            = vRefs.size() - n->nInputs - n->nOutputs;
+                st->nDelay          = vDelays.size();
+                st->nDelays         = 0;
+
+                // Resolve inputs, insert delays for signals that arrive earlier than others
+                for (size_t j=0; j<n->nInputs; ++j)
+                {
+                    const link_t *l     = vLinks.uget(n->nLink + j);
+                    size_t lat;
+                    if (l->nNode >= 0)
+                    {
+                        const node_t *s     = vNodes.uget(l->nNode);
+                        r[j]                = refs[s->nFirstOut + l->nPort];
+                        lat                 = s->nArrival + s->nLatency;
+                    }
+                    else if (l->nNode == SRC_INPUT)
+                    {
+                        r[j]                = REF_INPUT - ssize_t(l->nPort);
+                        lat                 = 0;
+                    }
+                    else
+                    {
+                        r[j]                = REF_ZERO;
+                        continue;
+                    }
+
+                    if (lat >= n->nArrival)
+                        continue;
+
+                    delay_t *d          = vDelays.add();
+                    if (d == NULL)
+                    {
+                        res                 = STATUS_NO_MEM;
+                        break;
+                    }
+                    d->pDelay           = new Delay();
+                    d->nSrc             = r[j];
+                    d->nDst             = alloc_buffer(&pool, &buffers);
+                    if ((d->pDelay == NULL) || (!d->pDelay->init(n->nArrival - lat)))
+                    {
+                        if (d->pDelay != NULL)
+                            delete d->pDelay;
+                        vDelays.remove(vDelays.size() - 1);
+                        res                 = STATUS_NO_MEM;
+                        break;
+                    }
+                    d->pDelay->set_delay(n->nArrival - lat);
+                    r[j]                = d->nDst;
+                    ++st->nDelays;
+                }
+                if (res != STATUS_OK)
+                    break;
+
+                // Assign buffers to outputs
+                for (size_t j=0; j<n->nOutputs; ++j)
+                {
+                    size_t id           = n->nFirstOut + j;
+                    if (users[id] > 0)
+                        refs[id]            = alloc_buffer(&pool, &buffers);
+                    r[n->nInputs + j]   = refs[id];
+                }
+
+                // Release buffers of delayed inputs and inputs which have no more consumers
+                for (size_t j=0; j<st->nDelays; ++j)
+                {
+                    size_t *id          = released.add();
+                    if (id == NULL)
+                    {
+                        res                 = STATUS_NO_MEM;
+                        break;
+                    }
+                    *id                 = vDelays.uget(st->nDelay + j)->nDst;
+                }
+                for (size_t j=0; (j<n->nInputs) && (res == STATUS_OK); ++j)
+                {
+                    const link_t *l     = vLinks.uget(n->nLink + j);
+                    if (l->nNode < 0)
+                        continue;
+                    size_t id           = vNodes.uget(l->nNode)->nFirstOut + l->nPort;
+                    if ((--users[id]) > 0)
+                        continue;
+
+                    size_t *fid         = released.add();
+                    if (fid == NULL)
+                        res                 = STATUS_NO_MEM;
+                    else
+                        *fid                = refs[id];
+                }
+            }
+
+            // Resolve outputs of the graph
+            for (size_t i=0, n=vOutLinks.size(); (i<n) && (res == STATUS_OK); ++i)
+            {
+                const link_t *l     = vOutLinks.uget(i);
+                output_t *o         = vOutputs.add();
+                if (o == NULL)
+                {
+                    res                 = STATUS_NO_MEM;
+                    break;
+                }
+                o->pDelay           = NULL;
+                if (l->nNode < 0)
+                {
+                    o->nRef             = REF_ZERO;
+                    continue;
+                }
+
+                const node_t *s     = vNodes.uget(l->nNode);
+                size_t lat          = s->nArrival + s->nLatency;
+                o->nRef             = refs[s->nFirstOut + l->nPort];
+                if (lat >= latency)
+                    continue;
+
+                o->pDelay           = new Delay();
+                if ((o->pDelay == NULL) || (!o->pDelay->init(latency - lat)))
+                {
+                    if (o->pDelay != NULL)
+                        delete o->pDelay;
+                    o->pDelay           = NULL;
+                    res                 = STATUS_NO_MEM;
+                    break;
+                }
+                o->pDelay->set_delay(latency - lat);
+            }
+            pool.flush();
+            released.flush();
+            free(order);
+
+            // Allocate buffers
+            if (res == STATUS_OK)
+            {
+                size_t buf_len      = align_size(buf_size, GRAPH_BUF_ALIGN);
+                size_t szof_bufs    = (buffers + 2) * buf_len * sizeof(float);
+                size_t szof_ptrs    = align_size(vRefs.size() * sizeof(float *), DEFAULT_ALIGN);
+                uint8_t *ptr        = alloc_aligned<uint8_t>(pData, szof_bufs + szof_ptrs, DEFAULT_ALIGN);
+                if (ptr == NULL)
+                    res                 = STATUS_NO_MEM;
+                else
+                {
+                    vZero               = reinterpret_cast<float *>(ptr);
+                    vSink               = &vZero[buf_len];
+                    vBuffers            = &vSink[buf_len];
+                    vPtrs               = reinterpret_cast<float **>(&ptr[szof_bufs]);
+                    dsp::fill_zero(vZero, (buffers + 2) * buf_len);
+
+                    nBuffers            = buffers;
+                    nBufSize            = buf_len;
+                    nLatency            = latency;
+                    bCompiled           = true;
+                }
+            }
+
+            if (res != STATUS_OK)
+                destroy_plan();
+
+            return res;
+        }
+
+        inline float *ProcessGraph::resolve(ssize_t ref, const float * const *in, size_t offset)
+        {
+            if (ref >= 0)
+                return &vBuffers[ref * nBufSize];
+            if (ref == REF_SINK)
+                return vSink;
+            if (ref == REF_ZERO)
+                return vZero;
+
+            const float *src    = in[REF_INPUT - ref];
+            return (src != NULL) ? const_cast<float *>(&src[offset]) : vZero;
+        }
+
+        void ProcessGraph::run_step(size_t step)
+        {
+            const step_t *st    = vSteps.uget(step);
+            const node_t *n     = vNodes.uget(st->nNode);
+            const ssize_t *r    = vRefs.uget(st->nRef);
+            float **ptrs        = &vPtrs[st->nRef];
+
+            // Align the inputs in time
+            for (size_t j=0; j<st->nDelays; ++j)
+            {
+                const delay_t *d    = vDelays.uget(st->nDelay + j);
+                d->pDelay->process(resolve(d->nDst, pIn, nOffset), resolve(d->nSrc, pIn, nOffset), nToDo);
+            }
+
+            // Call the node
+            for (size_t j=0, m=n->nInputs + n->nOutputs; j<m; ++j)
+                ptrs[j]             = resolve(r[j], pIn, nOffset);
+            n->pFunc(n->pObject, n->pSubject, &ptrs[n->nInputs], ptrs, nToDo);
+        }
+
+        void ProcessGraph::run_task(void *object, size_t task)
+        {
+            ProcessGraph *self  = static_cast<ProcessGraph *>(object);
+            self->run_step(self->nLevelFirst + task);
+        }
+
+        void ProcessGraph::process(float * const *out, const float * const *in, size_t samples)
+        {
+            if (!bCompiled)
+            {
+                for (size_t i=0, n=vOutLinks.size(); i<n; ++i)
+                    if (out[i] != NULL)
+                        dsp::fill_zero(out[i], samples);
+                return;
+            }
+
+            size_t n_levels     = vLevels.size();
+            size_t n_outs       = vOutputs.size();
+            pIn                 = in;
+
+            for (nOffset=0; nOffset < samples; nOffset += nToDo)
+            {
+                nToDo               = lsp_min(samples - nOffset, nBufSize);
+
+                for (size_t i=0; i<n_levels; ++i)
+                {
+                    const level_t *l    = vLevels.uget(i);
+                    if ((pWorkers != NULL) && (l->nSteps > 1))
+                    {
+                        nLevelFirst         = l->nFirst;
+                        pWorkers->execute(run_task, this, l->nSteps);
+                    }
+                    else
+                    {
+                        for (size_t j=0; j<l->nSteps; ++j)
+                            run_step(l->nFirst + j);
+                    }
+                }
+
+                // Emit outputs
+                for (size_t i=0; i<n_outs; ++i)
+                {
+                    if (out[i] == NULL)
+                        continue;
+                    const output_t *o   = vOutputs.uget(i);
+                    const float *src    = resolve(o->nRef, in, nOffset);
+                    if (o->pDelay != NULL)
+                        o->pDelay->process(&out[i][nOffset], src, nToDo);
+                    else
+                        dsp::copy(&out[i][nOffset], src, nToDo);
+                }
+            }
+
+            pIn                 = NULL;
+        }
+
+        void ProcessGraph::dump(IStateDumper *v) const
+        {
+            v->write("nNodes", vNodes.size());
+            v->write("nLinks", vLinks.size());
+            v->write("nOutLinks", vOutLinks.size());
+            v->write("nInputs", nInputs);
+            v->write("nSteps", vSteps.size());
+            v->write("nRefs", vRefs.size());
+            v->write("nDelays", vDelays.size());
+            v->write("nOutputs", vOutputs.size());
+            v->write("nBuffers", nBuffers);
+            v->write("nBufSize", nBufSize);
+            v->write("nLatency", nLatency);
+            v->write("nLevels", vLevels.size());
+            v->write("bCompiled", bCompiled);
+            v->write("pWorkers", pWorkers);
+            v->write("nOffset", nOffset);
+            v->write("nToDo", nToDo);
+            v->write("nLevelFirst", nLevelFirst);
+            v->write("vBuffers", vBuffers);
+            v->write("vZero", vZero);
+            v->write("vSink", vSink);
+            v->write("vPtrs", vPtrs);
+            v->write("pData", pData);
+        }
+    } /* namespace dspu */
+} /* namespace lsp */
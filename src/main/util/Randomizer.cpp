@@ -20,6 +20,8 @@
  */
 
 #include <lsp-plug.in/dsp-units/util/Randomizer.h>
+#include <lsp-plug.in/dsp-units/misc/kernels.h>
+#include <lsp-plug.in/dsp/dsp.h>
 #include <lsp-plug.in/stdlib/math.h>
 #include <lsp-plug.in/runtime/system.h>
 
@@ -27,6 +29,13 @@
 #define RAND_LAMBDA         M_E * M_SQRT2
 
 #define RAND_T              0.5f
+#define RAND_BLOCK_SIZE     0x100   /* Size of the block for block generation */
+
+#define PHILOX_M0           0xd2511f53U
+#define PHILOX_M1           0xcd9e8d57U
+#define PHILOX_W0           0x9e3779b9U
+#define PHILOX_W1           0xbb67ae85U
+#define PHILOX_ROUNDS       10
 
 namespace lsp
 {
@@ -72,6 +81,14 @@ namespace lsp
             }
 
             nBufID = -1;
+
+            bCounter    = false;
+            vKey[0]     = 0;
+            vKey[1]     = 0;
+            nCounter    = 0;
+            nBlock      = 0;
+            for (size_t i=0; i<4; ++i)
+                vBlock[i]   = 0;
         }
 
         void Randomizer::init(uint32_t seed)
@@ -87,6 +104,7 @@ namespace lsp
             }
 
             nBufID      = 0;
+            bCounter    = false;
         }
 
         void Randomizer::init()
@@ -96,13 +114,184 @@ namespace lsp
             init(ts.seconds ^ ts.nanos);
         }
 
-        float Randomizer::generate_linear()
+        void Randomizer::init_counter(uint32_t seed, uint32_t stream)
         {
-            // Generate linear random number
+            init(seed);
+
+            bCounter    = true;
+            vKey[0]     = seed;
+            vKey[1]     = stream;
+            nCounter    = 0;
+            nBlock      = 0;
+            philox(vBlock, nBlock, vKey);
+        }
+
+        bool Randomizer::seek(uint64_t index, random_function_t func)
+        {
+            if (!bCounter)
+                return false;
+
+            nCounter    = (func == RND_GAUSSIAN) ? index * 2 : index;
+            return true;
+        }
+
+        /*
+         * Philox4x32-10 counter-based generator (Salmon et al., "Parallel random numbers:
+         * as easy as 1, 2, 3"): the 128-bit counter consists of the block index in the
+         * lower 64 bits and zeros in the upper 64 bits
+         */
+        inline void Randomizer::philox(uint32_t *dst, uint64_t block, const uint32_t *key)
+        {
+            uint32_t c0 = uint32_t(block), c1 = uint32_t(block >> 32), c2 = 0, c3 = 0;
+            uint32_t k0 = key[0], k1 = key[1];
+
+            for (size_t i=0; i<PHILOX_ROUNDS; ++i)
+            {
+                uint64_t p0     = uint64_t(PHILOX_M0) * c0;
+                uint64_t p1     = uint64_t(PHILOX_M1) * c2;
+
+                c0              = uint32_t(p1 >> 32) ^ c1 ^ k0;
+                c1              = uint32_t(p1);
+                c2              = uint32_t(p0 >> 32) ^ c3 ^ k1;
+                c3              = uint32_t(p0);
+
+                k0             += PHILOX_W0;
+                k1             += PHILOX_W1;
+            }
+
+            dst[0]          = c0;
+            dst[1]          = c1;
+            dst[2]          = c2;
+            dst[3]          = c3;
+        }
+
+        inline uint32_t Randomizer::next_word()
+        {
+            if (bCounter)
+            {
+                uint64_t block  = nCounter >> 2;
+                if (block != nBlock)
+                {
+                    philox(vBlock, block, vKey);
+                    nBlock          = block;
+                }
+                return vBlock[(nCounter++) & 0x03];
+            }
+
             randgen_t *rg   = &vRandom[nBufID];
             nBufID          = (nBufID + 1) & 0x03;
             rg->vLast       = (rg->vMul1 * rg->vLast) + ((rg->vMul2 * rg->vLast) >> 16) + rg->vAdd;
-            return rg->vLast * RAND_RANGE;
+            return rg->vLast;
+        }
+
+        float Randomizer::generate_linear()
+        {
+            // Generate linear random number
+            return next_word() * RAND_RANGE;
+        }
+
+        void Randomizer::generate_counter_words(uint32_t *dst, size_t count)
+        {
+            // Advance to the start of the block
+            for ( ; (count > 0) && (nCounter & 0x03); --count)
+                *(dst++)        = next_word();
+
+            // Compute whole blocks directly into the destination buffer
+            for ( ; count >= 4; count -= 4, dst += 4)
+            {
+                philox(dst, nCounter >> 2, vKey);
+                nCounter       += 4;
+            }
+
+            // Generate the tail
+            for ( ; count > 0; --count)
+                *(dst++)        = next_word();
+        }
+
+        void Randomizer::generate_words(uint32_t *dst, size_t count)
+        {
+            if (bCounter)
+            {
+                generate_counter_words(dst, count);
+                return;
+            }
+
+            // Advance the generators one by one until the first one is next
+            for ( ; (count > 0) && (nBufID != 0); --count)
+                *(dst++)        = next_word();
+
+            // The generators do not depend on each other, so each group of 4 words
+            // is computed at once
+            uint32_t last[4], mul1[4], mul2[4], add[4];
+            for (size_t j=0; j<4; ++j)
+            {
+                last[j]         = vRandom[j].vLast;
+                mul1[j]         = vRandom[j].vMul1;
+                mul2[j]         = vRandom[j].vMul2;
+                add[j]          = vRandom[j].vAdd;
+            }
+
+            size_t blocks   = count >> 2;
+            kernels::lcg_words(dst, last, mul1, mul2, add, blocks);
+            dst            += blocks << 2;
+            count          &= 0x03;
+
+            for (size_t j=0; j<4; ++j)
+                vRandom[j].vLast    = last[j];
+
+            // Generate the tail
+            for ( ; count > 0; --count)
+                *(dst++)        = next_word();
+        }
+
+        /*
+         * Convert the random word to float in [0, 1]: both halves are exact and the sum is
+         * rounded once, so the result is the same as for the double-precision conversion
+         * of random(), but the code vectorizes for unsigned integers
+         */
+        static inline float word_to_float(uint32_t x)
+        {
+            return (float(int32_t(x >> 16)) * 65536.0f + float(int32_t(x & 0xffff))) * float(RAND_RANGE);
+        }
+
+        static void triangle_block(float *dst, size_t count)
+        {
+            const float k0  = M_SQRT2 * RAND_T;
+
+            for (size_t i=0; i<count; ++i)
+            {
+                float rv        = dst[i];
+                float a         = k0 * sqrtf(rv);
+                float b         = 2.0f*RAND_T - sqrtf(4.0f - 2.0f*(1.0f + rv)) * RAND_T;
+                dst[i]          = (rv <= 0.5f) ? a : b;
+            }
+        }
+
+        /*
+         * Box-Muller transform over pairs of random words: dst[i] = sqrt(-2 * ln(u1)) * cos(2*pi*u2).
+         * The second word is used as the phase of the cosine directly, the cosine is computed with
+         * the folded 9th order odd polynomial (absolute error less than 2.5e-7) instead of cosf().
+         */
+        static void gaussian_block(float *dst, const uint32_t *src, size_t count)
+        {
+            const float k   = 4.0f / 4294967296.0f;
+
+            for (size_t i=0; i<count; ++i)
+                dst[i]          = word_to_float(src[i*2]);
+
+            dsp::loge1(dst, count);
+
+            for (size_t i=0; i<count; ++i)
+            {
+                float v     = int32_t(src[i*2 + 1] + 0x40000000U) * k;  // [-2, 2)
+                float a     = fabsf(v);
+                float b     = 2.0f - a;
+                v           = copysignf((a < b) ? a : b, v);            // [-1, 1]
+                float v2    = v * v;
+                float c     = v * (1.5707962899e+00f + v2 * (-6.4596335826e-01f + v2 * (7.9688474756e-02f +
+                              v2 * (-4.6722202167e-03f + v2 * 1.5081714132e-04f))));
+                dst[i]      = sqrtf(-2.0f * dst[i]) * c;
+            }
         }
 
         float Randomizer::random(random_function_t func)
@@ -133,6 +322,48 @@ namespace lsp
             }
         }
 
+        void Randomizer::random(float *dst, size_t count, random_function_t func)
+        {
+            uint32_t words[RAND_BLOCK_SIZE * 2];
+            float buf[RAND_BLOCK_SIZE];
+
+            while (count > 0)
+            {
+                size_t to_do    = lsp_min(count, size_t(RAND_BLOCK_SIZE));
+
+                switch (func)
+                {
+                    case RND_EXP:
+                        generate_words(words, to_do);
+                        kernels::words_to_float(buf, words, to_do);
+                        dsp::mul_k2(buf, RAND_LAMBDA, to_do);
+                        dsp::exp2(dst, buf, to_do);
+                        dsp::add_k2(dst, -1.0f, to_do);
+                        dsp::mul_k2(dst, 1.0f / (expf(RAND_LAMBDA) - 1.0f), to_do);
+                        break;
+
+                    case RND_TRIANGLE:
+                        generate_words(words, to_do);
+                        kernels::words_to_float(dst, words, to_do);
+                        triangle_block(dst, to_do);
+                        break;
+
+                    case RND_GAUSSIAN:
+                        generate_words(words, to_do * 2);
+                        gaussian_block(dst, words, to_do);
+                        break;
+
+                    default:
+                        generate_words(words, to_do);
+                        kernels::words_to_float(dst, words, to_do);
+                        break;
+                }
+
+                dst            += to_do;
+                count          -= to_do;
+            }
+        }
+
         void Randomizer::dump(IStateDumper *v) const
         {
             v->begin_array("vRandom", vRandom, 4);
@@ -151,6 +382,11 @@ namespace lsp
             v->end_array();
 
             v->write("nBufID", nBufID);
+            v->write("bCounter", bCounter);
+            v->writev("vKey", vKey, 2);
+            v->write("nCounter", nCounter);
+            v->write("nBlock", nBlock);
+            v->writev("vBlock", vBlock, 4);
         }
     }
 } /* namespace lsp */
@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/dsp-units/util/Resampler.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define KERNEL_PHASES           0x100
+#define KERNEL_CUTOFF           0.95f
+#define BUFFER_SIZE             0x400
+
+namespace lsp
+{
+    namespace dspu
+    {
+        Resampler::Resampler()
+        {
+            construct();
+        }
+
+        Resampler::~Resampler()
+        {
+            destroy();
+        }
+
+        void Resampler::construct()
+        {
+            vKernel     = NULL;
+            vBuffer     = NULL;
+            nInRate     = 0;
+            nOutRate    = 0;
+            nQuality    = RESAMPLER_QUALITY_DFL;
+            nHalf       = 0;
+            nTaps       = 0;
+            nFill       = 0;
+            nCapacity   = 0;
+            fPosition   = 0.0;
+            fStep       = 1.0;
+            fDrift      = 1.0f;
+            pData       = NULL;
+        }
+
+        void Resampler::destroy()
+        {
+            free_aligned(pData);
+            vKernel     = NULL;
+            vBuffer     = NULL;
+            nHalf       = 0;
+            nTaps       = 0;
+            nFill       = 0;
+            nCapacity   = 0;
+        }
+
+        bool Resampler::init(size_t in_rate, size_t out_rate, size_t quality)
+        {
+            if ((in_rate <= 0) || (out_rate <= 0))
+                return false;
+            if ((in_rate > out_rate * RESAMPLER_RATIO_MAX) || (out_rate > in_rate * RESAMPLER_RATIO_MAX))
+                return false;
+
+            // The kernel is stretched to cut off frequencies above the new Nyquist frequency
+            quality             = lsp_limit(quality, size_t(RESAMPLER_QUALITY_MIN), size_t(RESAMPLER_QUALITY_MAX));
+            float cutoff        = (out_rate < in_rate) ? KERNEL_CUTOFF * float(out_rate) / float(in_rate) : 1.0f;
+            size_t half         = size_t(ceilf(quality / cutoff));
+            size_t taps         = half * 2;
+            size_t capacity     = taps + BUFFER_SIZE;
+
+            size_t szof_kernel  = align_size(sizeof(float) * taps * (KERNEL_PHASES + 1), DEFAULT_ALIGN);
+            size_t szof_buffer  = align_size(sizeof(float) * capacity, DEFAULT_ALIGN);
+
+            uint8_t *data       = NULL;
+            uint8_t *ptr        = alloc_aligned<uint8_t>(data, szof_kernel + szof_buffer);
+            if (ptr == NULL)
+                return false;
+
+            free_aligned(pData);
+
+            pData               = data;
+            vKernel             = reinterpret_cast<float *>(ptr);
+            ptr                += szof_kernel;
+            vBuffer             = reinterpret_cast<float *>(ptr);
+            ptr                += szof_buffer;
+
+            nInRate             = in_rate;
+            nOutRate            = out_rate;
+            nQuality            = quality;
+            nHalf               = half;
+            nTaps               = taps;
+            nCapacity           = capacity;
+            fStep               = double(in_rate) / double(out_rate);
+
+            build_kernel(cutoff);
+            clear();
+
+            return true;
+        }
+
+        void Resampler::build_kernel(float cutoff)
+        {
+            const float a       = nQuality;
+
+            for (size_t i=0; i<=KERNEL_PHASES; ++i)
+            {
+                float *row          = &vKernel[i * nTaps];
+                float phase         = float(i) / float(KERNEL_PHASES);
+                float sum           = 0.0f;
+
+                // Tap j is applied to the sample at the distance (j - half + 1) from the position
+                for (size_t j=0; j<nTaps; ++j)
+                {
+                    float x             = (float(j) - float(nHalf - 1) - phase) * cutoff;
+                    float v             = 0.0f;
+                    if ((x > -a) && (x < a))
+                    {
+                        float x2            = M_PI * x;
+                        v                   = (x != 0.0f) ? a * sinf(x2) * sinf(x2 / a) / (x2 * x2) : 1.0f;
+                    }
+                    row[j]              = v;
+                    sum                += v;
+                }
+
+                // Normalize the gain at DC
+                if (sum != 0.0f)
+                    dsp::mul_k2(row, 1.0f / sum, nTaps);
+            }
+        }
+
+        void Resampler::set_drift(float drift)
+        {
+            fDrift              = lsp_limit(drift, 1.0f - RESAMPLER_DRIFT_MAX, 1.0f + RESAMPLER_DRIFT_MAX);
+        }
+
+        size_t Resampler::max_output(size_t count) const
+        {
+            double step         = fStep / (1.0f + RESAMPLER_DRIFT_MAX);
+            return size_t(count / step) + 2;
+        }
+
+        void Resampler::clear()
+        {
+            if (vBuffer == NULL)
+                return;
+
+            // The samples before the start of the stream are zeros
+            dsp::fill_zero(vBuffer, nCapacity);
+            nFill               = nHalf - 1;
+            fPosition           = nHalf - 1;
+        }
+
+        size_t Resampler::process(float *dst, const float *src, size_t count)
+        {
+            if (vBuffer == NULL)
+                return 0;
+
+            const double step   = fStep / fDrift;
+            size_t done         = 0;
+
+            while (count > 0)
+            {
+                // Append the input data to the buffer
+                size_t to_do        = lsp_min(count, nCapacity - nFill);
+                dsp::copy(&vBuffer[nFill], src, to_do);
+                nFill              += to_do;
+                src                += to_do;
+                count              -= to_do;
+
+                // Compute the output samples which have all the input data available
+                double pos          = fPosition;
+                while (true)
+                {
+                    size_t k            = size_t(pos);
+                    if (k + nHalf >= nFill)
+                        break;
+
+                    float f             = (pos - k) * KERNEL_PHASES;
+                    size_t phase        = lsp_min(size_t(f), size_t(KERNEL_PHASES - 1));
+                    f                  -= phase;
+
+                    // Interpolate between two adjacent phases of the kernel
+                    const float *s      = &vBuffer[k + 1 - nHalf];
+                    const float *r0     = &vKernel[phase * nTaps];
+                    const float *r1     = &r0[nTaps];
+                    float v0            = 0.0f, v1 = 0.0f;
+                    for (size_t j=0; j<nTaps; ++j)
+                    {
+                        v0                 += s[j] * r0[j];
+                        v1                 += s[j] * r1[j];
+                    }
+
+                    dst[done++]         = v0 + f * (v1 - v0);
+                    pos                += step;
+                }
+
+                // Drop the samples that are not required for the next output samples
+                size_t shift        = lsp_min(size_t(pos) + 1 - nHalf, nFill);
+                if (shift > 0)
+                {
+                    dsp::move(vBuffer, &vBuffer[shift], nFill - shift);
+                    nFill              -= shift;
+                    pos                -= shift;
+                }
+                fPosition           = pos;
+            }
+
+            return done;
+        }
+
+        void Resampler::dump(IStateDumper *v) const
+        {
+            v->write("vKernel", vKernel);
+            v->write("vBuffer", vBuffer);
+            v->write("nInRate", nInRate);
+            v->write("nOutRate", nOutRate);
+            v->write("nQuality", nQuality);
+            v->write("nHalf", nHalf);
+            v->write("nTaps", nTaps);
+            v->write("nFill", nFill);
+            v->write("nCapacity", nCapacity);
+            v->write("fPosition", fPosition);
+            v->write("fStep", fStep);
+            v->write("fDrift", fDrift);
+            v->write("pData", pData);
+        }
+    }
+} /* namespace lsp */
@@ -22,6 +22,7 @@
 #include <lsp-plug.in/dsp-units/util/ResponseTaker.h>
 #include <lsp-plug.in/dsp-units/units.h>
 #include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/stdlib.h>
 
 #define DFL_GAIN    1.0f
 #define DFL_FADE    0.01f
@@ -83,6 +84,10 @@ namespace lsp
             nLatency                        = 0;
             nTimeWarp                       = 0;
             nCaptureStart                   = 0;
+            nInputs                         = 1;
+            nOutputs                        = 1;
+            fStagger                        = 0.0f;
+            nStagger                        = 0;
 
             bCycleComplete                  = false;
 
@@ -90,16 +95,28 @@ namespace lsp
         }
 
         status_t ResponseTaker::reconfigure(Sample *testsig)
+        {
+            if ((testsig == NULL) || (!testsig->valid()))
+                return STATUS_NO_DATA;
+
+            return reconfigure(testsig, testsig->channels(), 1);
+        }
+
+        status_t ResponseTaker::reconfigure(Sample *testsig, size_t inputs, size_t outputs)
         {
             if (bSync)
                 update_settings();
 
             if ((testsig == NULL) || (!testsig->valid()))
                 return STATUS_NO_DATA;
+            if ((inputs <= 0) || (outputs <= 0))
+                return STATUS_BAD_ARGUMENTS;
 
             pTestSig                        = testsig;
-            size_t nCaptureLength           = testsig->length() + sOutputProcessor.nTail + nLatency;
-            size_t nChannels                = testsig->channels();
+            nInputs                         = inputs;
+            nOutputs                        = outputs;
+            size_t nCaptureLength           = testsig->length() + (outputs - 1) * nStagger + sOutputProcessor.nTail + nLatency;
+            size_t nChannels                = inputs;
 
             bool bReAllocate                = false;
 
@@ -162,32 +179,66 @@ namespace lsp
             sOutputProcessor.fTail          = (sOutputProcessor.fTail < MAX_TAIL) ? sOutputProcessor.fTail : MAX_TAIL;
             sOutputProcessor.nTail          = seconds_to_samples(nSampleRate, sOutputProcessor.fTail);
 
+            nStagger                        = seconds_to_samples(nSampleRate, lsp_max(fStagger, 0.0f));
+
             bSync                           = false;
         }
 
+        static void copy_or_zero(float *dst, const float *src, size_t count)
+        {
+            if (dst == NULL)
+                return;
+            if (src != NULL)
+                dsp::copy(dst, src, count);
+            else
+                dsp::fill_zero(dst, count);
+        }
+
         void ResponseTaker::process_in(float *dst, const float *src, size_t count)
+        {
+            if (nInputs <= 1)
+            {
+                process_in(&dst, &src, count);
+                return;
+            }
+
+            float **vdst        = reinterpret_cast<float **>(alloca(sizeof(float *) * nInputs));
+            const float **vsrc  = reinterpret_cast<const float **>(alloca(sizeof(float *) * nInputs));
+            for (size_t i=0; i<nInputs; ++i)
+            {
+                vdst[i]             = NULL;
+                vsrc[i]             = NULL;
+            }
+            vdst[0]             = dst;
+            vsrc[0]             = src;
+
+            process_in(vdst, vsrc, count);
+        }
+
+        void ResponseTaker::process_in(float * const *dst, const float * const *src, size_t count)
         {
             if (bSync)
                 update_settings();
 
-            while (count > 0)
+            for (size_t offset=0; offset < count; )
             {
                 switch (sInputProcessor.nState)
                 {
                     case IP_ACQUIRE:
                     {
-                        size_t captureIdx   = sInputProcessor.nAcquireTime % sInputProcessor.nAcquire;
-                        size_t to_do        = sInputProcessor.nAcquire - captureIdx;
-                        if (to_do > count)
-                            to_do = count;
+                        // Stream all inputs directly into the preallocated capture
+                        size_t captureIdx   = sInputProcessor.nAcquireTime;
+                        size_t to_do        = lsp_min(sInputProcessor.nAcquire - captureIdx, count - offset);
 
-                        dsp::copy(pCapture->getBuffer(0, captureIdx), src, to_do);
+                        for (size_t i=0; i<nInputs; ++i)
+                        {
+                            const float *in     = (src[i] != NULL) ? &src[i][offset] : NULL;
+                            copy_or_zero(pCapture->getBuffer(i, captureIdx), in, to_do);
+                        }
 
                         sInputProcessor.nAcquireTime    += to_do;
                         sInputProcessor.ig_time         += to_do;
-                        dst                             += to_do;
-                        src                             += to_do;
-                        count                           -= to_do;
+                        offset                          += to_do;
 
                         if (sInputProcessor.nAcquireTime >= sInputProcessor.nAcquire)
                         {
@@ -200,31 +251,88 @@ namespace lsp
                         break;
                     }
                     case IP_WAIT:
-                        sInputProcessor.ig_time += count;
-                        dsp::copy(dst, src, count);
-                        count = 0;
-                        break;
                     case IP_BYPASS:
                     default:
-                        dsp::copy(dst, src, count);
-                        count = 0;
+                    {
+                        size_t to_do        = count - offset;
+                        if (sInputProcessor.nState == IP_WAIT)
+                            sInputProcessor.ig_time += to_do;
+
+                        for (size_t i=0; i<nInputs; ++i)
+                        {
+                            if (dst[i] != NULL)
+                                copy_or_zero(&dst[i][offset], (src[i] != NULL) ? &src[i][offset] : NULL, to_do);
+                        }
+                        offset             += to_do;
                         break;
+                    }
                 }
             }
         }
 
         void ResponseTaker::process_out(float *dst, const float *src, size_t count)
+        {
+            if (nOutputs <= 1)
+            {
+                process_out(&dst, &src, count);
+                return;
+            }
+
+            float **vdst        = reinterpret_cast<float **>(alloca(sizeof(float *) * nOutputs));
+            const float **vsrc  = reinterpret_cast<const float **>(alloca(sizeof(float *) * nOutputs));
+            for (size_t i=0; i<nOutputs; ++i)
+            {
+                vdst[i]             = NULL;
+                vsrc[i]             = NULL;
+            }
+            vdst[0]             = dst;
+            vsrc[0]             = src;
+
+            process_out(vdst, vsrc, count);
+        }
+
+        void ResponseTaker::emit_test_signal(float * const *dst, size_t offset, size_t count)
+        {
+            size_t length       = pTestSig->length();
+            size_t channels     = pTestSig->channels();
+            size_t t_begin      = sOutputProcessor.nTestSigTime;
+            size_t t_end        = t_begin + count;
+
+            for (size_t i=0; i<nOutputs; ++i)
+            {
+                if (dst[i] == NULL)
+                    continue;
+
+                // Each output plays its own test signal delayed by the stagger
+                float *out          = &dst[i][offset];
+                const float *sig    = pTestSig->channel(i % channels);
+                size_t head         = i * nStagger;
+                size_t first        = lsp_max(t_begin, head);
+                size_t last         = lsp_min(t_end, head + length);
+
+                if (first < last)
+                {
+                    dsp::fill_zero(out, first - t_begin);
+                    dsp::copy(&out[first - t_begin], &sig[first - head], last - first);
+                    dsp::fill_zero(&out[last - t_begin], t_end - last);
+                }
+                else
+                    dsp::fill_zero(out, count);
+            }
+        }
+
+        void ResponseTaker::process_out(float * const *dst, const float * const *src, size_t count)
         {
             if (bSync)
                 update_settings();
 
-            while (count > 0)
+            for (size_t offset=0; offset < count; )
             {
                 switch (sOutputProcessor.nState)
                 {
                     case OP_FADEOUT:
                     {
-                        while (count > 0)
+                        for ( ; offset < count; ++offset)
                         {
                             sOutputProcessor.fGain      -= sOutputProcessor.fGainDelta;
 
@@ -236,22 +344,27 @@ namespace lsp
                                 break;
                             }
 
-                            *(dst++) = *(src++) * sOutputProcessor.fGain;
-                            count--;
+                            for (size_t i=0; i<nOutputs; ++i)
+                            {
+                                if (dst[i] != NULL)
+                                    dst[i][offset]      = (src[i] != NULL) ? src[i][offset] * sOutputProcessor.fGain : 0.0f;
+                            }
                             sOutputProcessor.og_time++;
                         }
                         break;
                     }
                     case OP_PAUSE:
                     {
-                        size_t to_do                    = (sOutputProcessor.nPauseTime > count) ? count : sOutputProcessor.nPauseTime;
-                        dsp::fill_zero(dst, to_do);
+                        size_t to_do                    = lsp_min(sOutputProcessor.nPauseTime, count - offset);
+                        for (size_t i=0; i<nOutputs; ++i)
+                        {
+                            if (dst[i] != NULL)
+                                dsp::fill_zero(&dst[i][offset], to_do);
+                        }
 
                         sOutputProcessor.nPauseTime    -= to_do;
                         sOutputProcessor.og_time       += to_do;
-                        src                            += to_do;
-                        dst                            += to_do;
-                        count                          -= to_do;
+                        offset                         += to_do;
 
                         if (sOutputProcessor.nPauseTime <= 0)
                         {
@@ -260,7 +373,7 @@ namespace lsp
                             sInputProcessor.nState      = IP_ACQUIRE;
                             sInputProcessor.nAcquire    = pCapture->length();
                             sInputProcessor.fAcquire    = samples_to_seconds(nSampleRate, sInputProcessor.nAcquire);
-                            sOutputProcessor.nTestSig   = pTestSig->length();
+                            sOutputProcessor.nTestSig   = pTestSig->length() + (nOutputs - 1) * nStagger;
                             sOutputProcessor.fTestSig   = samples_to_seconds(nSampleRate, sOutputProcessor.nTestSig);
                             sOutputProcessor.og_start   = sOutputProcessor.og_time;
                             sInputProcessor.ig_start    = sInputProcessor.ig_time;
@@ -271,18 +384,13 @@ namespace lsp
                     }
                     case OP_TEST_SIG_EMIT:
                     {
-                        size_t playbackIdx              = sOutputProcessor.nTestSigTime % sOutputProcessor.nTestSig;
-                        size_t to_do                    = sOutputProcessor.nTestSig - playbackIdx;
-                        if (to_do > count)
-                            to_do = count;
+                        size_t to_do                    = lsp_min(sOutputProcessor.nTestSig - sOutputProcessor.nTestSigTime, count - offset);
 
-                        dsp::copy(dst, pTestSig->getBuffer(0, playbackIdx), to_do);
+                        emit_test_signal(dst, offset, to_do);
 
                         sOutputProcessor.nTestSigTime  += to_do;
                         sOutputProcessor.og_time       += to_do;
-                        dst                            += to_do;
-                        src                            += to_do;
-                        count                          -= to_do;
+                        offset                         += to_do;
 
                         if (sOutputProcessor.nTestSigTime >= sOutputProcessor.nTestSig)
                         {
@@ -294,18 +402,21 @@ namespace lsp
                     }
                     case OP_TAIL_EMIT:
                     {
-                        dsp::fill_zero(dst, count);
+                        size_t to_do                    = count - offset;
+                        for (size_t i=0; i<nOutputs; ++i)
+                        {
+                            if (dst[i] != NULL)
+                                dsp::fill_zero(&dst[i][offset], to_do);
+                        }
 
-                        sOutputProcessor.nTailTime     += count;
-                        sOutputProcessor.og_time       += count;
-                        dst                            += count;
-                        src                            += count;
-                        count                           = 0;
+                        sOutputProcessor.nTailTime     += to_do;
+                        sOutputProcessor.og_time       += to_do;
+                        offset                          = count;
                         break;
                     }
                     case OP_FADEIN:
                     {
-                        while (count > 0)
+                        for ( ; offset < count; ++offset)
                         {
                             sOutputProcessor.fGain  += sOutputProcessor.fGainDelta;
                             if (sOutputProcessor.fGain >= 1.0f)
@@ -315,17 +426,27 @@ namespace lsp
                                 break;
                             }
 
-                            *(dst++) = *(src++) * sOutputProcessor.fGain;
-                            count--;
+                            for (size_t i=0; i<nOutputs; ++i)
+                            {
+                                if (dst[i] != NULL)
+                                    dst[i][offset]      = (src[i] != NULL) ? src[i][offset] * sOutputProcessor.fGain : 0.0f;
+                            }
                             sOutputProcessor.og_time++;
                         }
                         break;
                     }
                     case OP_BYPASS:
                     default:
-                        dsp::copy(dst, src, count);
-                        count = 0;
+                    {
+                        size_t to_do                    = count - offset;
+                        for (size_t i=0; i<nOutputs; ++i)
+                        {
+                            if (dst[i] != NULL)
+                                copy_or_zero(&dst[i][offset], (src[i] != NULL) ? &src[i][offset] : NULL, to_do);
+                        }
+                        offset                          = count;
                         break;
+                    }
                 }
             }
         }
@@ -416,6 +537,10 @@ namespace lsp
             v->write("nLatency", nLatency);
             v->write("nTimeWarp", nTimeWarp);
             v->write("nCaptureStart", nCaptureStart);
+            v->write("nInputs", nInputs);
+            v->write("nOutputs", nOutputs);
+            v->write("fStagger", fStagger);
+            v->write("nStagger", nStagger);
             v->write("bCycleComplete", bCycleComplete);
             v->write("bSync", bSync);
         }
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/dsp-units/util/ScratchArena.h>
+#include <lsp-plug.in/common/alloc.h>
+
+#define ARENA_ALIGN             0x10    /* Alignment of borrowed buffers in floats */
+
+namespace lsp
+{
+    namespace dspu
+    {
+        ScratchArena::ScratchArena()
+        {
+            construct();
+        }
+
+        ScratchArena::~ScratchArena()
+        {
+            destroy();
+        }
+
+        void ScratchArena::construct()
+        {
+            vData       = NULL;
+            nCapacity   = 0;
+            nUsed       = 0;
+            nPeak       = 0;
+            pData       = NULL;
+        }
+
+        void ScratchArena::destroy()
+        {
+            free_aligned(pData);
+            vData       = NULL;
+            nCapacity   = 0;
+            nUsed       = 0;
+            nPeak       = 0;
+        }
+
+        size_t ScratchArena::aligned(size_t count)
+        {
+            return align_size(count, ARENA_ALIGN);
+        }
+
+        bool ScratchArena::reserve(size_t count)
+        {
+            count       = aligned(count);
+            if (count <= nCapacity)
+                return true;
+
+            uint8_t *data   = NULL;
+            float *ptr      = alloc_aligned<float>(data, count, ARENA_ALIGN * sizeof(float));
+            if (ptr == NULL)
+                return false;
+
+            free_aligned(pData);
+            vData       = ptr;
+            nCapacity   = count;
+            nUsed       = 0;
+            pData       = data;
+
+            return true;
+        }
+
+        float *ScratchArena::alloc(size_t count)
+        {
+            count       = aligned(count);
+            if (nUsed + count > nCapacity)
+                return NULL;
+
+            float *ptr  = &vData[nUsed];
+            nUsed      += count;
+            nPeak       = lsp_max(nPeak, nUsed);
+
+            return ptr;
+        }
+
+        void ScratchArena::dump(IStateDumper *v) const
+        {
+            v->write("vData", vData);
+            v->write("nCapacity", nCapacity);
+            v->write("nUsed", nUsed);
+            v->write("nPeak", nPeak);
+            v->write("pData", pData);
+        }
+    } /* namespace dspu */
+} /* namespace lsp */
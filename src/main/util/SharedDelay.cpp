@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/dsp-units/util/SharedDelay.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#define DELAY_GAP       0x200
+
+namespace lsp
+{
+    namespace dspu
+    {
+        SharedDelay::SharedDelay()
+        {
+            construct();
+        }
+
+        SharedDelay::~SharedDelay()
+        {
+            destroy();
+        }
+
+        void SharedDelay::construct()
+        {
+            vBuffer     = NULL;
+            nChannels   = 0;
+            nHead       = 0;
+            nTail       = 0;
+            nDelay      = 0;
+            nMaxDelay   = 0;
+            nSize       = 0;
+            pData       = NULL;
+        }
+
+        void SharedDelay::destroy()
+        {
+            free_aligned(pData);
+            vBuffer     = NULL;
+            nChannels   = 0;
+            nSize       = 0;
+        }
+
+        bool SharedDelay::init(size_t channels, size_t max_delay)
+        {
+            // The gap allows to write the new block before the delayed one is read
+            size_t size     = align_size(max_delay + DELAY_GAP, DELAY_GAP);
+            uint8_t *data   = NULL;
+            float *ptr      = alloc_aligned<float>(data, size * lsp_max(channels, size_t(1)));
+            if (ptr == NULL)
+                return false;
+
+            free_aligned(pData);
+            vBuffer         = ptr;
+            nChannels       = channels;
+            nHead           = 0;
+            nTail           = 0;
+            nDelay          = 0;
+            nMaxDelay       = max_delay;
+            nSize           = size;
+            pData           = data;
+
+            dsp::fill_zero(vBuffer, size * lsp_max(channels, size_t(1)));
+
+            return true;
+        }
+
+        void SharedDelay::set_delay(size_t delay)
+        {
+            nDelay      = lsp_min(delay, nMaxDelay);
+            if (nSize > 0)
+                nTail       = (nHead + nSize - nDelay) % nSize;
+        }
+
+        void SharedDelay::clear()
+        {
+            if (vBuffer != NULL)
+                dsp::fill_zero(vBuffer, nSize * nChannels);
+        }
+
+        void SharedDelay::process(float * const *dst, const float * const *src, const float *gain, size_t samples)
+        {
+            if (nSize == 0)
+                return;
+
+            for (size_t offset=0; offset < samples; )
+            {
+                // Do not cross the end of the ring buffer both for the head and the tail
+                size_t to_do    = lsp_min(samples - offset, size_t(DELAY_GAP));
+                to_do           = lsp_min(to_do, lsp_min(nSize - nHead, nSize - nTail));
+
+                for (size_t i=0; i<nChannels; ++i)
+                {
+                    float *buf      = &vBuffer[i * nSize];
+                    dsp::copy(&buf[nHead], &src[i][offset], to_do);
+                    if (gain != NULL)
+                        dsp::mul3(&dst[i][offset], &buf[nTail], &gain[offset], to_do);
+                    else
+                        dsp::copy(&dst[i][offset], &buf[nTail], to_do);
+                }
+
+                nHead           = (nHead + to_do) % nSize;
+                nTail           = (nTail + to_do) % nSize;
+                offset         += to_do;
+            }
+        }
+
+        void SharedDelay::dump(IStateDumper *v) const
+        {
+            v->write("vBuffer", vBuffer);
+            v->write("nChannels", nChannels);
+            v->write("nHead", nHead);
+            v->write("nTail", nTail);
+            v->write("nDelay", nDelay);
+            v->write("nMaxDelay", nMaxDelay);
+            v->write("nSize", nSize);
+            v->write("pData", pData);
+        }
+    } /* namespace dspu */
+} /* namespace lsp */
@@ -43,20 +43,29 @@ namespace lsp
             nCapacity   = 0;
             nHead       = 0;
             nTail       = 0;
+            bRing       = false;
         }
 
-        bool ShiftBuffer::init(size_t size, size_t gap)
+        static size_t ring_capacity(size_t size)
+        {
+            size_t capacity     = 0x10;
+            while (capacity < size)
+                capacity          <<= 1;
+            return capacity;
+        }
+
+        bool ShiftBuffer::init(size_t size, size_t gap, bool ring)
         {
             // Check gap
             if (gap > size)
                 return false;
 
-            // Make size multiple of 0x10
-            size_t new_capacity     = align_size(size, 0x10);
-            if ((pData == NULL) || (new_capacity != nCapacity))
+            // Make size multiple of 0x10 or power of 2 for the ring buffer
+            size_t new_capacity     = (ring) ? ring_capacity(size) : align_size(size, 0x10);
+            if ((pData == NULL) || (new_capacity != nCapacity) || (ring != bRing))
             {
-                // Allocate new buffer
-                float *new_data     = new float[new_capacity];
+                // Allocate new buffer, the ring buffer keeps the mirror after the end
+                float *new_data     = new float[(ring) ? new_capacity * 2 : new_capacity];
                 if (new_data == NULL)
                     return false;
 
@@ -68,14 +77,53 @@ namespace lsp
             nCapacity   = new_capacity;
             nHead       = 0;
             nTail       = gap;
+            bRing       = ring;
 
     //        lsp_trace("capacity = %d, head = %d, tail = %d", int(nCapacity), int(nHead), int(nTail));
 
             // Zero the gap
-            dsp::fill_zero(pData, gap);
+            if (bRing)
+                ring_write(0, NULL, gap);
+            else
+                dsp::fill_zero(pData, gap);
             return true;
         }
 
+        void ShiftBuffer::ring_write(size_t pos, const float *data, size_t count)
+        {
+            // Write the data and it's mirror, count should not be greater than capacity
+            size_t mask     = nCapacity - 1;
+            pos            &= mask;
+
+            while (count > 0)
+            {
+                size_t n        = lsp_min(count, nCapacity - pos);
+                if (data != NULL)
+                {
+                    dsp::copy(&pData[pos], data, n);
+                    dsp::copy(&pData[pos + nCapacity], data, n);
+                    data           += n;
+                }
+                else
+                {
+                    dsp::fill_zero(&pData[pos], n);
+                    dsp::fill_zero(&pData[pos + nCapacity], n);
+                }
+                count          -= n;
+                pos             = 0;
+            }
+        }
+
+        inline void ShiftBuffer::ring_shift()
+        {
+            // Keep the head within the first copy of data
+            if (nHead >= nCapacity)
+            {
+                nHead          -= nCapacity;
+                nTail          -= nCapacity;
+            }
+        }
+
         bool ShiftBuffer::resize(size_t size, size_t gap)
         {
             // Check that need simply allocate new buffer
@@ -86,6 +134,30 @@ namespace lsp
             if (gap > size)
                 return false;
 
+            if (bRing)
+            {
+                // Allocate new buffer
+                size_t new_capacity = ring_capacity(size);
+                float *dst          = new float[new_capacity * 2];
+                if (dst == NULL)
+                    return false;
+
+                // The data is contiguous in the ring buffer, keep the last samples
+                size_t keep         = lsp_min(nTail - nHead, gap);
+                float *src          = &pData[nTail - keep];
+                float *old          = pData;
+
+                pData               = dst;
+                nCapacity           = new_capacity;
+                nHead               = 0;
+                nTail               = gap;
+                ring_write(0, NULL, gap - keep);
+                ring_write(gap - keep, src, keep);
+                delete [] old;
+
+                return true;
+            }
+
             // Make size multiple of 0x10
             size_t new_capacity = align_size(size, 0x10);
             size_t avail        = nTail - nHead;            // Current gap size
@@ -105,7 +177,7 @@ namespace lsp
                     dsp::copy(&dst[fill], &pData[nHead], avail);
                 }
                 else
-                    dsp::copy(dst, &pData[nTail + fill], gap);
+                    dsp::copy(dst, &pData[nTail - gap], gap);
                 delete [] pData;
 
                 // Update pointers
@@ -149,6 +221,7 @@ namespace lsp
             nCapacity   = 0;
             nHead       = 0;
             nTail       = 0;
+            bRing       = false;
         }
 
         size_t ShiftBuffer::append(const float *data, size_t count)
@@ -157,6 +230,14 @@ namespace lsp
             if (pData == NULL)
                 return 0;
 
+            if (bRing)
+            {
+                count               = lsp_min(count, nCapacity - (nTail - nHead));
+                ring_write(nTail, data, count);
+                nTail              += count;
+                return count;
+            }
+
             // Check free space in buffer
             size_t can_append       = nCapacity - nTail;
             if (can_append <= 0)
@@ -196,6 +277,17 @@ namespace lsp
             if (pData == NULL)
                 return 0;
 
+            if (bRing)
+            {
+                if ((nTail - nHead) >= nCapacity)
+                    return 0;
+                size_t pos          = nTail & (nCapacity - 1);
+                pData[pos]          = data;
+                pData[pos + nCapacity] = data;
+                ++nTail;
+                return 1;
+            }
+
             // Check free space in buffer
             if (nTail >= nCapacity)
             {
@@ -226,6 +318,8 @@ namespace lsp
             if (data != NULL)
                 dsp::copy(data, &pData[nHead], count);
             nHead      += count;
+            if (bRing)
+                ring_shift();
 
     //        lsp_trace("count=%d, capacity=%d, head=%d, tail=%d", int(count), int(nCapacity), int(nHead), int(nTail));
 
@@ -245,6 +339,8 @@ namespace lsp
 
             // Flush the buffer
             nHead      += count;
+            if (bRing)
+                ring_shift();
     //        lsp_trace("count=%d, capacity=%d, head=%d, tail=%d", int(count), int(nCapacity), int(nHead), int(nTail));
 
             return count;
@@ -255,7 +351,10 @@ namespace lsp
             // Check state
             if ((pData == NULL) || (nTail <= nHead))
                 return 0.0f;
-            return pData[nHead++];
+            float value     = pData[nHead++];
+            if (bRing)
+                ring_shift();
+            return value;
         }
 
         void ShiftBuffer::copy(const ShiftBuffer *src)
@@ -328,7 +427,9 @@ namespace lsp
 
         void ShiftBuffer::fill(float value)
         {
-            if (nHead < nTail)
+            if (bRing)
+                dsp::fill(pData, value, nCapacity * 2);
+            else if (nHead < nTail)
                 dsp::fill(&pData[nHead], value, nTail - nHead);
         }
 
@@ -338,6 +439,7 @@ namespace lsp
             v->write("nCapacity", nCapacity);
             v->write("nHead", nHead);
             v->write("nTail", nTail);
+            v->write("bRing", bRing);
         }
     }
 } /* namespace lsp */
@@ -21,10 +21,13 @@
 
 #include <lsp-plug.in/dsp-units/util/Sidechain.h>
 #include <lsp-plug.in/dsp-units/units.h>
+#include <lsp-plug.in/dsp-units/const.h>
+#include <lsp-plug.in/dsp/dsp.h>
 #include <lsp-plug.in/stdlib/math.h>
 
 #define REFRESH_RATE        0x1000
 #define MIN_GAP_ITEMS       0x200
+#define BATCH_SIZE          0x100
 
 namespace lsp
 {
@@ -92,7 +95,7 @@ namespace lsp
             bUpdate             = true;
             size_t gap          = millis_to_samples(sr, fMaxReactivity);
             size_t buf_size     = (gap < MIN_GAP_ITEMS) ? MIN_GAP_ITEMS : gap;
-            sBuffer.init(buf_size * 4, gap);
+            sBuffer.init(buf_size * 2, gap, true);
         }
 
         void Sidechain::update_settings()
@@ -233,6 +236,57 @@ namespace lsp
             return true;
         }
 
+        void Sidechain::process_uniform(float *out, const float *tail, size_t samples)
+        {
+            float vdelta[BATCH_SIZE];
+            float interval  = nReactivity;
+
+            for (size_t offset=0; offset < samples; )
+            {
+                size_t to_do    = lsp_min(samples - offset, size_t(BATCH_SIZE));
+                float *dst      = &out[offset];
+
+                // Compute differences for the whole block, only the running sum stays sequential
+                dsp::sub3(vdelta, dst, &tail[offset], to_do);
+                for (size_t i=0; i<to_do; ++i)
+                {
+                    fRmsValue      += vdelta[i];
+                    dst[i]          = fRmsValue;
+                }
+
+                dsp::div_k2(dst, interval, to_do);
+                dsp::limit1(dst, 0.0f, FLOAT_SAT_P_INF, to_do);
+                offset         += to_do;
+            }
+        }
+
+        void Sidechain::process_rms(float *out, const float *tail, size_t samples)
+        {
+            float vdelta[BATCH_SIZE], vlast[BATCH_SIZE];
+            float interval  = nReactivity;
+
+            for (size_t offset=0; offset < samples; )
+            {
+                size_t to_do    = lsp_min(samples - offset, size_t(BATCH_SIZE));
+                float *dst      = &out[offset];
+
+                // Compute differences of squares for the whole block, only the running sum stays sequential
+                dsp::sqr2(vdelta, dst, to_do);
+                dsp::sqr2(vlast, &tail[offset], to_do);
+                dsp::sub2(vdelta, vlast, to_do);
+                for (size_t i=0; i<to_do; ++i)
+                {
+                    fRmsValue      += vdelta[i];
+                    dst[i]          = fRmsValue;
+                }
+
+                // Safe square root gives zero for negative values
+                dsp::div_k2(dst, interval, to_do);
+                dsp::ssqrt1(dst, to_do);
+                offset         += to_do;
+            }
+        }
+
         bool Sidechain::preprocess(float *out, const float *in)
         {
             float s;
@@ -373,20 +427,14 @@ namespace lsp
                 {
                     if (nReactivity <= 0)
                         break;
-                    float interval  = nReactivity;
 
                     while (samples > 0)
                     {
                         size_t n    = sBuffer.append(out, samples);
-                        float *p    = sBuffer.tail(nReactivity + n);
+                        process_uniform(out, sBuffer.tail(nReactivity + n), n);
+                        out        += n;
                         samples    -= n;
 
-                        for (size_t i=0; i<n; ++i)
-                        {
-                            fRmsValue      += *(out) - *(p++);
-                            *(out++)        = (fRmsValue < 0.0f) ? 0.0f : fRmsValue / interval;
-                        }
-
                         // Remove old sample
                         sBuffer.shift(n);
                     }
@@ -398,21 +446,13 @@ namespace lsp
                 {
                     if (nReactivity <= 0)
                         break;
-                    float interval  = nReactivity;
 
                     while (samples > 0)
                     {
                         size_t n        = sBuffer.append(out, samples);
-                        float *p        = sBuffer.tail(nReactivity + n);
+                        process_rms(out, sBuffer.tail(nReactivity + n), n);
+                        out            += n;
                         samples        -= n;
-
-                        for (size_t i=0; i<n; ++i)
-                        {
-                            float sample    = *out;
-                            float last      = *(p++);
-                            fRmsValue      += sample*sample - last*last;
-                            *(out++)        = (fRmsValue < 0.0f) ? 0.0f : sqrtf(fRmsValue / interval);
-                        }
                         sBuffer.shift(n);
                     }
                     break;
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/dsp-units/util/SidechainBus.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        SidechainBus::SidechainBus()
+        {
+            construct();
+        }
+
+        SidechainBus::~SidechainBus()
+        {
+            destroy();
+        }
+
+        void SidechainBus::construct()
+        {
+            sSC.construct();
+
+            vBuffer         = NULL;
+            nCapacity       = 0;
+            nSamples        = 0;
+            nBlock          = 0;
+            pData           = NULL;
+        }
+
+        bool SidechainBus::init(size_t channels, float max_reactivity, size_t block_size)
+        {
+            destroy();
+
+            if (block_size <= 0)
+                return false;
+            if (!sSC.init(channels, max_reactivity))
+                return false;
+
+            float *ptr      = alloc_aligned<float>(pData, block_size);
+            if (ptr == NULL)
+            {
+                destroy();
+                return false;
+            }
+            dsp::fill_zero(ptr, block_size);
+
+            vBuffer         = ptr;
+            nCapacity       = block_size;
+            nSamples        = 0;
+            nBlock          = 0;
+
+            return true;
+        }
+
+        void SidechainBus::destroy()
+        {
+            if (pData != NULL)
+            {
+                free_aligned(pData);
+                pData           = NULL;
+            }
+
+            vBuffer         = NULL;
+            nCapacity       = 0;
+            nSamples        = 0;
+
+            sSC.destroy();
+        }
+
+        size_t SidechainBus::process(const float **in, size_t samples)
+        {
+            size_t to_do    = lsp_min(samples, nCapacity);
+            sSC.process(vBuffer, in, to_do);
+
+            nSamples        = to_do;
+            ++nBlock;
+
+            return to_do;
+        }
+
+        void SidechainBus::dump(IStateDumper *v) const
+        {
+            v->write_object("sSC", &sSC);
+            v->write("vBuffer", vBuffer);
+            v->write("nCapacity", nCapacity);
+            v->write("nSamples", nSamples);
+            v->write("nBlock", nBlock);
+            v->write("pData", pData);
+        }
+    }
+} /* namespace lsp */
@@ -20,6 +20,7 @@
  */
 
 #include <lsp-plug.in/dsp-units/util/SpectralProcessor.h>
+#include <lsp-plug.in/dsp-units/misc/fft.h>
 #include <lsp-plug.in/dsp-units/misc/windows.h>
 #include <lsp-plug.in/common/alloc.h>
 #include <lsp-plug.in/dsp/dsp.h>
@@ -43,17 +44,18 @@ namespace lsp
             nRank           = 0;
             nMaxRank        = 0;
             fPhase          = 0.0f;
+            fOverlap        = 0.5f;
+            nHop            = 0;
             pWnd            = NULL;
             pOutBuf         = NULL;
             pInBuf          = NULL;
             pFftBuf         = NULL;
+            pFftTable       = NULL;
             pData           = NULL;
             nOffset         = 0;
             bUpdate         = true;
 
-            pFunc           = NULL;
-            pObject         = NULL;
-            pSubject        = NULL;
+            nChain          = 0;
         }
 
         bool SpectralProcessor::init(size_t max_rank)
@@ -61,21 +63,27 @@ namespace lsp
             nRank           = max_rank;
             nMaxRank        = max_rank;
             fPhase          = 0.0f;
+            fOverlap        = 0.5f;
+            nHop            = 0;
             bUpdate         = true;
 
-            pFunc           = NULL;
-            pObject         = NULL;
-            pSubject        = NULL;
+            nChain          = 0;
 
             // Allocate buffer
             size_t buf_sz   = sizeof(float) << max_rank;
             pWnd            = alloc_aligned<float>(pData, buf_sz * 5, DEFAULT_ALIGN);
 
+            // The table is optional, complex transforms are used without it
+            fft::release(pFftTable);
+            pFftTable       = fft::acquire(max_rank);
+
             return true;
         }
     
         void SpectralProcessor::destroy()
         {
+            fft::release(pFftTable);
+
             if (pData != NULL)
             {
                 free_aligned(pData);
@@ -85,30 +93,58 @@ namespace lsp
             nRank           = 0;
             nMaxRank        = 0;
             fPhase          = 0.0f;
+            fOverlap        = 0.5f;
+            nHop            = 0;
             pWnd            = NULL;
             pOutBuf         = NULL;
             pInBuf          = NULL;
             pFftBuf         = NULL;
+            pFftTable       = NULL;
             pData           = NULL;
             bUpdate         = false;
 
-            pFunc           = NULL;
-            pObject         = NULL;
-            pSubject        = NULL;
+            nChain          = 0;
         }
 
         void SpectralProcessor::bind(spectral_processor_func_t func, void *object, void *subject)
         {
-            pFunc           = func;
-            pObject         = object;
-            pSubject        = subject;
+            nChain          = 0;
+            add(func, object, subject);
+        }
+
+        bool SpectralProcessor::add(spectral_processor_func_t func, void *object, void *subject)
+        {
+            if ((func == NULL) || (nChain >= SPECTRAL_PROCESSOR_CHAIN_MAX))
+                return false;
+
+            binding_t *b    = &vChain[nChain++];
+            b->pFunc        = func;
+            b->pObject      = object;
+            b->pSubject     = subject;
+
+            return true;
+        }
+
+        bool SpectralProcessor::remove(spectral_processor_func_t func, void *object, void *subject)
+        {
+            for (size_t i=0; i<nChain; ++i)
+            {
+                binding_t *b    = &vChain[i];
+                if ((b->pFunc != func) || (b->pObject != object) || (b->pSubject != subject))
+                    continue;
+
+                // Keep the order of the remaining handlers
+                for (--nChain; i<nChain; ++i)
+                    vChain[i]       = vChain[i+1];
+                return true;
+            }
+
+            return false;
         }
 
         void SpectralProcessor::unbind()
         {
-            pFunc           = NULL;
-            pObject         = NULL;
-            pSubject        = NULL;
+            nChain          = 0;
         }
 
         void SpectralProcessor::update_settings()
@@ -120,10 +156,25 @@ namespace lsp
             pInBuf          = &pOutBuf[buf_size];
             pFftBuf         = &pInBuf[buf_size];
 
-            // Clear buffers and reset pointers
+            // Compute the hop size
+            nHop            = buf_size - size_t(buf_size * fOverlap);
+            nHop            = lsp_limit(nHop, size_t(1), buf_size);
+
+            // Compute the window and normalize it to have constant overlap-add sum,
+            // the FFT buffer is used as a temporary storage for the sum
             windows::sqr_cosine(pWnd, buf_size);
+            dsp::fill_zero(pFftBuf, nHop);
+            for (size_t i=0; i<buf_size; i += nHop)
+                dsp::add2(pFftBuf, &pWnd[i], lsp_min(nHop, buf_size - i));
+            for (size_t i=0; i<buf_size; ++i)
+            {
+                float s         = pFftBuf[i % nHop];
+                pWnd[i]         = (s > 1e-6f) ? pWnd[i] / s : 1.0f;
+            }
+
+            // Clear buffers and reset pointers
             dsp::fill_zero(pOutBuf, buf_size*4);     // OutBuf + InBuf + Fft(x2)
-            nOffset         = buf_size * fPhase;
+            nOffset         = nHop * fPhase;
 
             // Mark settings applied
             bUpdate         = false;
@@ -135,6 +186,16 @@ namespace lsp
             bUpdate         = true;
         }
 
+        void SpectralProcessor::set_overlap(float overlap)
+        {
+            overlap         = lsp_limit(overlap, 0.0f, 1.0f);
+            if (overlap == fOverlap)
+                return;
+
+            fOverlap        = overlap;
+            bUpdate         = true;
+        }
+
         void SpectralProcessor::set_rank(size_t rank)
         {
             if ((rank == nRank) || (rank > nMaxRank))
@@ -151,28 +212,55 @@ namespace lsp
                 update_settings();
 
             size_t buf_size     = 1 << nRank;
-            size_t frame_size   = 1 << (nRank - 1);
+            size_t frame_size   = nHop;
+            size_t tail         = buf_size - frame_size;
 
             while (count > 0)
             {
                 // Need to perform transformations?
                 if (nOffset >= frame_size)
                 {
-                    if (pFunc != NULL)
+                    if (nChain > 0)
                     {
-                        // Perform FFT and processing
-                        dsp::pcomplex_r2c(pFftBuf, pInBuf, buf_size);       // Convert from real to packed complex
-                        dsp::packed_direct_fft(pFftBuf, pFftBuf, nRank);    // Perform direct FFT
-                        pFunc(pObject, pSubject, pFftBuf, nRank);           // Call the function
-                        dsp::packed_reverse_fft(pFftBuf, pFftBuf, nRank);   // Perform reverse FFT
-                        dsp::pcomplex_c2r(pFftBuf, pFftBuf, buf_size);      // Unpack complex numbers
+                        // Perform direct FFT
+                        bool real_fft       = (pFftTable != NULL) && (nRank >= 2);
+                        if (real_fft)
+                        {
+                            // Handlers get the full spectrum, the output is the real part
+                            fft::real_direct(pFftBuf, pInBuf, nRank, pFftTable, nMaxRank);
+                            fft::real_expand(pFftBuf, nRank);               // Restore the full spectrum
+                        }
+                        else
+                        {
+                            dsp::pcomplex_r2c(pFftBuf, pInBuf, buf_size);   // Convert from real to packed complex
+                            dsp::packed_direct_fft(pFftBuf, pFftBuf, nRank);// Perform direct FFT
+                        }
+
+                        // Call all handlers of the chain for the same spectrum
+                        for (size_t i=0; i<nChain; ++i)
+                        {
+                            const binding_t *b  = &vChain[i];
+                            b->pFunc(b->pObject, b->pSubject, pFftBuf, nRank);
+                        }
+
+                        // Perform reverse FFT
+                        if (real_fft)
+                        {
+                            fft::real_fold(pFftBuf, nRank);                 // Take the conjugate-symmetric part
+                            fft::real_reverse(pFftBuf, pFftBuf, nRank, pFftTable, nMaxRank);
+                        }
+                        else
+                        {
+                            dsp::packed_reverse_fft(pFftBuf, pFftBuf, nRank);// Perform reverse FFT
+                            dsp::pcomplex_c2r(pFftBuf, pFftBuf, buf_size);  // Unpack complex numbers
+                        }
                     }
                     else
                         dsp::move(pFftBuf, pInBuf, buf_size);               // Copy data to FFT buffer
 
                     // Shift input and output buffers
-                    dsp::move(pOutBuf, &pOutBuf[frame_size], buf_size + frame_size);  // Shift buffers
-                    dsp::fill_zero(&pOutBuf[frame_size], frame_size);       // Fill tail of input buffer with zeros
+                    dsp::move(pOutBuf, &pOutBuf[frame_size], buf_size + tail);  // Shift buffers
+                    dsp::fill_zero(&pOutBuf[tail], frame_size);             // Fill tail of output buffer with zeros
 
                     // Apply window and add to the output buffer
                     dsp::fmadd3(pOutBuf, pFftBuf, pWnd, buf_size);          // Apply window and
@@ -187,7 +275,7 @@ namespace lsp
                     to_process          = count;
 
                 // Copy data
-                dsp::copy(&pInBuf[frame_size + nOffset], src, to_process);
+                dsp::copy(&pInBuf[tail + nOffset], src, to_process);
                 dsp::copy(dst, &pOutBuf[nOffset], to_process);
 
                 // Update pointers
@@ -203,17 +291,31 @@ namespace lsp
             v->write("nRank", nRank);
             v->write("nMaxRank", nMaxRank);
             v->write("fPhase", fPhase);
+            v->write("fOverlap", fOverlap);
+            v->write("nHop", nHop);
             v->write("pWnd", pWnd);
             v->write("pOutBuf", pOutBuf);
             v->write("pInBuf", pInBuf);
             v->write("pFftBuf", pFftBuf);
+            v->write("pFftTable", pFftTable);
             v->write("nOffset", nOffset);
             v->write("pData", pData);
             v->write("bUpdate", bUpdate);
 
-            v->write("pFunc", pFunc);
-            v->write("pObject", pObject);
-            v->write("pSubject", pSubject);
+            v->begin_array("vChain", vChain, nChain);
+            for (size_t i=0; i<nChain; ++i)
+            {
+                const binding_t *b = &vChain[i];
+                v->begin_object(b, sizeof(binding_t));
+                {
+                    v->write("pFunc", b->pFunc);
+                    v->write("pObject", b->pObject);
+                    v->write("pSubject", b->pSubject);
+                }
+                v->end_object();
+            }
+            v->end_array();
+            v->write("nChain", nChain);
         }
     }
 } /* namespace lsp */
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/dsp-units/util/StateSnapshot.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        StateSnapshot::StateSnapshot()
+        {
+            construct();
+        }
+
+        StateSnapshot::~StateSnapshot()
+        {
+            destroy();
+        }
+
+        void StateSnapshot::construct()
+        {
+            for (size_t i=0; i<3; ++i)
+                vBuffers[i].construct();
+
+            nBack           = 0;
+            nFront          = 1;
+            nState          = 2;
+            nPeriod         = 0;
+            nCounter        = 0;
+        }
+
+        void StateSnapshot::destroy()
+        {
+            for (size_t i=0; i<3; ++i)
+                vBuffers[i].destroy();
+        }
+
+        bool StateSnapshot::init(size_t size, size_t names)
+        {
+            for (size_t i=0; i<3; ++i)
+            {
+                if (!vBuffers[i].init(size, names))
+                {
+                    destroy();
+                    return false;
+                }
+            }
+
+            nBack           = 0;
+            nFront          = 1;
+            nState          = 2;
+            nCounter        = 0;
+
+            return true;
+        }
+
+        BinaryStateDumper *StateSnapshot::begin_capture(size_t samples)
+        {
+            // Rate limiting
+            nCounter       += samples;
+            if (nCounter < nPeriod)
+                return NULL;
+            nCounter        = (nPeriod > 0) ? nCounter % nPeriod : 0;
+
+            BinaryStateDumper *v    = &vBuffers[nBack];
+            if (v->capacity() <= 0)
+                return NULL;
+
+            v->clear();
+            return v;
+        }
+
+        void StateSnapshot::commit_capture()
+        {
+            // Exchange the back buffer with the middle one
+            atomic_t state  = atomic_swap(&nState, atomic_t(nBack | S_FRESH));
+            nBack           = state & S_INDEX;
+        }
+
+        bool StateSnapshot::fetch()
+        {
+            if (!(atomic_add(&nState, 0) & S_FRESH))
+                return false;
+
+            // Exchange the front buffer with the middle one
+            atomic_t state  = atomic_swap(&nState, atomic_t(nFront));
+            nFront          = state & S_INDEX;
+            return true;
+        }
+    } /* namespace dspu */
+} /* namespace lsp */
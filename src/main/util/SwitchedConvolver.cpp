@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/dsp-units/util/SwitchedConvolver.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#define SWITCHED_CONVOLVER_BUF_SIZE         0x400
+
+namespace lsp
+{
+    namespace dspu
+    {
+        SwitchedConvolver::SwitchedConvolver()
+        {
+            construct();
+        }
+
+        SwitchedConvolver::~SwitchedConvolver()
+        {
+            destroy();
+        }
+
+        void SwitchedConvolver::construct()
+        {
+            for (size_t i=0; i<3; ++i)
+                vConv[i].construct();
+            sCrossfade.construct();
+
+            pActive             = &vConv[0];
+            pFade               = &vConv[1];
+            pSpare              = &vConv[2];
+            nState              = S_IDLE;
+            vFadeOut            = NULL;
+            vFadeIn             = NULL;
+            vData               = NULL;
+        }
+
+        void SwitchedConvolver::destroy()
+        {
+            for (size_t i=0; i<3; ++i)
+                vConv[i].destroy();
+            sCrossfade.destroy();
+
+            free_aligned(vData);
+            vData               = NULL;
+            vFadeOut            = NULL;
+            vFadeIn             = NULL;
+
+            pActive             = &vConv[0];
+            pFade               = &vConv[1];
+            pSpare              = &vConv[2];
+            nState              = S_IDLE;
+        }
+
+        bool SwitchedConvolver::init(int sample_rate, float time)
+        {
+            if (vData == NULL)
+            {
+                float *ptr          = alloc_aligned<float>(vData, SWITCHED_CONVOLVER_BUF_SIZE * 2);
+                if (ptr == NULL)
+                    return false;
+
+                vFadeOut            = ptr;
+                ptr                += SWITCHED_CONVOLVER_BUF_SIZE;
+                vFadeIn             = ptr;
+                ptr                += SWITCHED_CONVOLVER_BUF_SIZE;
+            }
+
+            sCrossfade.init(sample_rate, time);
+            return true;
+        }
+
+        bool SwitchedConvolver::prepare(const float *data, size_t count, size_t rank, float phase,
+                bool background, ConvolverCache *cache)
+        {
+            // Acquire the spare convolver
+            if (!atomic_cas(&nState, S_IDLE, S_PREPARING))
+                return false;
+
+            // The spare convolver is not used by the processing thread, initialize it
+            if (!pSpare->init(data, count, rank, phase, background, cache))
+            {
+                atomic_swap(&nState, S_IDLE);
+                return false;
+            }
+
+            // Publish the prepared convolver
+            atomic_swap(&nState, S_PREPARED);
+            return true;
+        }
+
+        bool SwitchedConvolver::commit()
+        {
+            if (atomic_add(&nState, 0) != S_PREPARED)
+                return false;
+            if (sCrossfade.active())
+                return false;
+
+            // Rotate convolvers, the convolver that has faded out before becomes spare
+            Convolver *spare    = pFade;
+            pFade               = pActive;
+            pActive             = pSpare;
+            pSpare              = spare;
+            sCrossfade.toggle();
+
+            // Allow preparing of the spare convolver
+            atomic_swap(&nState, S_IDLE);
+            return true;
+        }
+
+        void SwitchedConvolver::process(float *dst, const float *src, size_t count)
+        {
+            // Crossfade between convolvers
+            while ((count > 0) && (sCrossfade.active()))
+            {
+                size_t to_do    = lsp_min(count, size_t(SWITCHED_CONVOLVER_BUF_SIZE));
+
+                pFade->process(vFadeOut, src, to_do);
+                pActive->process(vFadeIn, src, to_do);
+                sCrossfade.process(dst, vFadeOut, vFadeIn, to_do);
+
+                dst            += to_do;
+                src            += to_do;
+                count          -= to_do;
+            }
+
+            // Process the active convolver only
+            if (count > 0)
+                pActive->process(dst, src, count);
+        }
+
+        void SwitchedConvolver::dump(IStateDumper *v) const
+        {
+            v->write_object_array("vConv", vConv, 3);
+
+            v->write("pActive", pActive);
+            v->write("pFade", pFade);
+            v->write("pSpare", pSpare);
+            v->write_object("sCrossfade", &sCrossfade);
+            v->write("nState", int32_t(nState));
+            v->write("vFadeOut", vFadeOut);
+            v->write("vFadeIn", vFadeIn);
+            v->write("vData", vData);
+        }
+    }
+} /* namespace lsp */
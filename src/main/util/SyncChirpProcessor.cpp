@@ -21,11 +21,14 @@
 
 #include <lsp-plug.in/dsp-units/util/SyncChirpProcessor.h>
 #include <lsp-plug.in/dsp-units/units.h>
+#include <lsp-plug.in/dsp-units/util/Crossover.h>
 #include <lsp-plug.in/common/alloc.h>
 #include <lsp-plug.in/common/endian.h>
 #include <lsp-plug.in/fmt/lspc/File.h>
 #include <lsp-plug.in/fmt/lspc/AudioReader.h>
 #include <lsp-plug.in/fmt/lspc/AudioWriter.h>
+#include <lsp-plug.in/ipc/Thread.h>
+#include <lsp-plug.in/lltl/parray.h>
 #include <lsp-plug.in/stdlib/math.h>
 #include <lsp-plug.in/stdlib/string.h>
 #include <lsp-plug.in/stdlib/stdlib.h>
@@ -46,12 +49,77 @@
 #define OVER_BUF_LIMIT_SIZE         (12 * 1024)     // Multiple of 3, 4 and 8
 #define ENVELOPE_BUF_LIMIT_SIZE     65536           // Maximum size for post processing envelope follower
 #define BG_NOISE_LIMIT             -10.0            // Threshold level to consider postprocessing data reliable (relative to RT low regression line fitting limit)
+#define SCHROEDER_BLOCK_SIZE        0x400           // Block size for the backward integration of the energy decay curve
+#define RT_XOVER_BUF_SIZE           0x1000          // Buffer size of the crossover for band reverberation time calculation
+#define LSPC_EXPORT_FRAMES          0x4000          // Number of frames written or read by one LSPC chunk transfer
 #define MAX_WINDOW_RANK             16              // Maximum window rank for higher order responses windowing
 
 namespace lsp
 {
     namespace dspu
     {
+        class SyncChirpProcessor::ConvThread: public ipc::Thread
+        {
+            private:
+                SyncChirpProcessor *pProc;
+                size_t              nWorker;
+
+            public:
+                explicit ConvThread(SyncChirpProcessor *proc, size_t worker)
+                {
+                    pProc       = proc;
+                    nWorker     = worker;
+                }
+
+                virtual ~ConvThread()
+                {
+                    pProc       = NULL;
+                }
+
+            public:
+                virtual status_t run()
+                {
+                    dsp::context_t ctx;
+                    dsp::start(&ctx);
+
+                    status_t res = pProc->convolution_jobs(nWorker);
+
+                    dsp::finish(&ctx);
+                    return res;
+                }
+        };
+
+        class SyncChirpProcessor::IdentThread: public ipc::Thread
+        {
+            private:
+                SyncChirpProcessor *pProc;
+                size_t              nWorker;
+
+            public:
+                explicit IdentThread(SyncChirpProcessor *proc, size_t worker)
+                {
+                    pProc       = proc;
+                    nWorker     = worker;
+                }
+
+                virtual ~IdentThread()
+                {
+                    pProc       = NULL;
+                }
+
+            public:
+                virtual status_t run()
+                {
+                    dsp::context_t ctx;
+                    dsp::start(&ctx);
+
+                    status_t res = pProc->identification_jobs(nWorker);
+
+                    dsp::finish(&ctx);
+                    return res;
+                }
+        };
+
         SyncChirpProcessor::SyncChirpProcessor()
         {
             construct();
@@ -106,13 +174,33 @@ namespace lsp
             sConvParams.vConvLengths        = NULL;
             sConvParams.vAlignOffsets       = NULL;
             sConvParams.pData               = NULL;
+            sConvParams.nWorkers            = 0;
+            sConvParams.nInvImages          = 0;
             sConvParams.vInPart             = NULL;
             sConvParams.vInvPart            = NULL;
             sConvParams.vInImage            = NULL;
-            sConvParams.vInvImage           = NULL;
+            sConvParams.vInvImages          = NULL;
             sConvParams.vTemp               = NULL;
             sConvParams.pTempData           = NULL;
+            sConvParams.pInvData            = NULL;
+            sConvParams.vJobData            = NULL;
+            sConvParams.vJobOffsets         = NULL;
             sConvParams.bReallocateTemp     = true;
+            nConvJob                        = 0;
+
+            sStream.nLength                 = 0;
+            sStream.vOffsets                = NULL;
+            sStream.vHead                   = NULL;
+            sStream.vInPart                 = NULL;
+            sStream.pData                   = NULL;
+            sStream.bActive                 = false;
+
+            sExport.pFile                   = NULL;
+            sExport.pWriter                 = NULL;
+            sExport.nFrames                 = 0;
+            sExport.nWritten                = 0;
+            sExport.nSkip                   = 0;
+            sExport.nChunkId                = 0;
 
             sCRPostProc.noiseLevel          = 0.0;
             sCRPostProc.noiseValue          = 0.0;
@@ -139,7 +227,20 @@ namespace lsp
             sCRPostProc.vTemprow1Im         = NULL;
             sCRPostProc.vTemprow2Re         = NULL;
             sCRPostProc.vTemprow2Im         = NULL;
+            sCRPostProc.nWorkers            = 0;
+            sCRPostProc.vWindow             = NULL;
+            sCRPostProc.enWindowType        = windows::RECTANGULAR;
+            sCRPostProc.fCoeffsAlpha        = 0.0f;
+            sCRPostProc.bCoeffsValid        = false;
+            sCRPostProc.bWindowValid        = false;
             sCRPostProc.pData               = NULL;
+            sCRPostProc.enStage             = IDENT_WINDOW;
+            sCRPostProc.nJobs               = 0;
+            sCRPostProc.nJobChannel         = 0;
+            sCRPostProc.bJobSmoothing       = false;
+            sCRPostProc.nJobFadeIn          = 0;
+            sCRPostProc.nJobFadeOut         = 0;
+            nIdentJob                       = 0;
 
             pChirp                          = NULL;
             pInverseFilter                  = NULL;
@@ -183,6 +284,8 @@ namespace lsp
         {
             destroyConvolutionParameters();
             destroyConvolutionTempArrays();
+            destroyStreamBuffers();
+            destroyExport();
             destroyIdentificationMatrices();
 
             if (pChirp != NULL)
@@ -239,7 +342,7 @@ namespace lsp
             return STATUS_OK;
         }
 
-        status_t SyncChirpProcessor::allocateIdentificationMatrices(size_t order, size_t windowSize)
+        status_t SyncChirpProcessor::allocateIdentificationMatrices(size_t order, size_t windowSize, size_t workers)
         {
             /** Allocating all matrices in the same memory block for fast access.
              *  Row Major order, so chunks of data from convolution result can be
@@ -247,16 +350,24 @@ namespace lsp
              *  row by row.
              */
 
-            destroyIdentificationMatrices();
-
-            if ((order == 0) || (windowSize == 0))
+            if ((order == 0) || (windowSize == 0) || (workers == 0))
                 return STATUS_BAD_ARGUMENTS;
 
+            // Keep the matrices together with the cached coefficients and window
+            if ((sCRPostProc.pData != NULL) &&
+                (sCRPostProc.nHamOrder == order) &&
+                (sCRPostProc.nHwinSize == windowSize) &&
+                (sCRPostProc.nWorkers == workers))
+                return STATUS_OK;
+
+            destroyIdentificationMatrices();
+
             // 2X order by order matrices (Coefficients, Real Part and Imaginary Part)
             // 2X order by windowSize matrices (Higher order responses, Real Part and Imaginary Part)
             // 2X order by windowSize matrices (Kernel responses, Real Part and Imaginary Part)
-            // 4X windowSize long temporary vectors
-            size_t samples          = 2 * (order * order) + 4 * (order * windowSize) + 4 * windowSize;
+            // 4X windowSize long temporary vectors per worker
+            // 1X windowSize long smoothing window
+            size_t samples          = 2 * (order * order) + 4 * (order * windowSize) + 4 * windowSize * workers + windowSize;
 
             float *ptr              = alloc_aligned<float>(sCRPostProc.pData, samples);
             if (ptr == NULL)
@@ -274,6 +385,10 @@ namespace lsp
             ptr                    += order * windowSize;
             sCRPostProc.mKernelsIm  = ptr;
             ptr                    += order * windowSize;
+            sCRPostProc.vWindow     = ptr;
+            ptr                    += windowSize;
+
+            // The temporary rows of the worker w start at (4 * windowSize * w)
             sCRPostProc.vTemprow1Re = ptr;
             ptr                    += windowSize;
             sCRPostProc.vTemprow1Im = ptr;
@@ -287,6 +402,7 @@ namespace lsp
 
             sCRPostProc.nHamOrder   = order;
             sCRPostProc.nHwinSize   = windowSize;
+            sCRPostProc.nWorkers    = workers;
 
             return STATUS_OK;
         }
@@ -297,6 +413,7 @@ namespace lsp
             sCRPostProc.pData   = NULL;
             sCRPostProc.nHamOrder   = 0;
             sCRPostProc.nHwinSize   = 0;
+            sCRPostProc.nWorkers    = 0;
             sCRPostProc.mCoeffsRe   = NULL;
             sCRPostProc.mCoeffsIm   = NULL;
             sCRPostProc.mHigherRe   = NULL;
@@ -307,6 +424,9 @@ namespace lsp
             sCRPostProc.vTemprow1Im = NULL;
             sCRPostProc.vTemprow2Re = NULL;
             sCRPostProc.vTemprow2Im = NULL;
+            sCRPostProc.vWindow     = NULL;
+            sCRPostProc.bCoeffsValid    = false;
+            sCRPostProc.bWindowValid    = false;
         }
 
         inline size_t SyncChirpProcessor::sub2ind_Coeffs(size_t r, size_t c)
@@ -328,6 +448,10 @@ namespace lsp
                )
                 return;
 
+            // The coefficients depend only on the order and the chirp amplitude
+            if ((sCRPostProc.bCoeffsValid) && (sCRPostProc.fCoeffsAlpha == sChirpParams.fAlpha))
+                return;
+
             dsp::fill_zero(sCRPostProc.mCoeffsRe, sCRPostProc.nHamOrder * sCRPostProc.nHamOrder);
             dsp::fill_zero(sCRPostProc.mCoeffsIm, sCRPostProc.nHamOrder * sCRPostProc.nHamOrder);
 
@@ -417,6 +541,27 @@ namespace lsp
 
             sCRPostProc.mCoeffsReDet = determinantRe;
             sCRPostProc.mCoeffsImDet = determinantIm;
+            sCRPostProc.fCoeffsAlpha = sChirpParams.fAlpha;
+            sCRPostProc.bCoeffsValid = true;
+        }
+
+        /** Fill the range of a Hermitian vector with the complex value: the value is used for the
+         * positive frequencies, the conjugated value for the negative ones, the imaginary part of
+         * the Nyquist frequency bin is zero.
+         */
+        static void fill_hermitian(float *re, float *im, float valueRe, float valueIm, size_t first, size_t count, size_t nyquist)
+        {
+            size_t last     = first + count;
+            size_t pos      = (nyquist > first) ? lsp_min(nyquist, last) - first : 0;
+
+            dsp::fill(re, valueRe, count);
+            dsp::fill(im, valueIm, pos);
+            if ((first + pos) == nyquist)
+            {
+                if (pos < count)
+                    im[pos++]       = 0.0f;
+            }
+            dsp::fill(&im[pos], -valueIm, count - pos);
         }
 
         void SyncChirpProcessor::solve()
@@ -437,15 +582,30 @@ namespace lsp
                )
                 return;
 
-            // Fill with zeros all the kernels matrices and temp vectors
-            dsp::fill_zero(sCRPostProc.mKernelsRe, sCRPostProc.nHamOrder * sCRPostProc.nHwinSize);
-            dsp::fill_zero(sCRPostProc.mKernelsIm, sCRPostProc.nHamOrder * sCRPostProc.nHwinSize);
+            // The linear systems of different frequency bins are independent, each
+            // worker solves its own range of bins
+            run_identification_jobs(IDENT_SOLVE, lsp_min(sCRPostProc.nWorkers, sCRPostProc.nHwinSize));
+        }
+
+        void SyncChirpProcessor::solve_bins(size_t first, size_t count, size_t worker)
+        {
+            if (count == 0)
+                return;
 
-            dsp::fill_zero(sCRPostProc.vTemprow1Re, sCRPostProc.nHwinSize);
-            dsp::fill_zero(sCRPostProc.vTemprow1Im, sCRPostProc.nHwinSize);
+            // Temporary rows of the worker
+            size_t stride       = 4 * sCRPostProc.nHwinSize * worker;
+            float *vTemprow1Re  = &sCRPostProc.vTemprow1Re[stride];
+            float *vTemprow1Im  = &sCRPostProc.vTemprow1Im[stride];
+            float *vTemprow2Re  = &sCRPostProc.vTemprow2Re[stride];
+            float *vTemprow2Im  = &sCRPostProc.vTemprow2Im[stride];
 
-            dsp::fill_zero(sCRPostProc.vTemprow2Re, sCRPostProc.nHwinSize);
-            dsp::fill_zero(sCRPostProc.vTemprow2Im, sCRPostProc.nHwinSize);
+            // Fill with zeros the kernels matrices
+            for (size_t r = 0; r < sCRPostProc.nHamOrder; ++r)
+            {
+                size_t rowSelect    = sub2ind_Data(r, first);
+                dsp::fill_zero(&sCRPostProc.mKernelsRe[rowSelect], count);
+                dsp::fill_zero(&sCRPostProc.mKernelsIm[rowSelect], count);
+            }
 
             // We aim to solve the linear systems Coeffs * Kernels = Higher for the unknown matrix Kernels (a linear system per column of Kernels and Higher)
             // Coeffs is upper triangular. So we use backward substitution.
@@ -459,7 +619,6 @@ namespace lsp
             // so that we preserve Hermitian symmetry.
 
             size_t nyquist  = sCRPostProc.nHwinSize / 2;
-            size_t negStart = (sCRPostProc.nHwinSize - nyquist + 1) % sCRPostProc.nHwinSize; // Negative samples start here.
 
             // This in the index witch which we step through the rows, bottom to top.
             ssize_t r = sCRPostProc.nHamOrder - 1;
@@ -474,40 +633,38 @@ namespace lsp
                 //                Higher is a HamOrder by WinSize matrix.
 
                 // We start by copying Higher[r, :] over to Kernels[r, :]
-                size_t rowSelect    = sub2ind_Data(r, 0);
-                dsp::copy(&sCRPostProc.mKernelsRe[rowSelect], &sCRPostProc.mHigherRe[rowSelect], sCRPostProc.nHwinSize);
-                dsp::copy(&sCRPostProc.mKernelsIm[rowSelect], &sCRPostProc.mHigherIm[rowSelect], sCRPostProc.nHwinSize);
+                size_t rowSelect    = sub2ind_Data(r, first);
+                dsp::copy(&sCRPostProc.mKernelsRe[rowSelect], &sCRPostProc.mHigherRe[rowSelect], count);
+                dsp::copy(&sCRPostProc.mKernelsIm[rowSelect], &sCRPostProc.mHigherIm[rowSelect], count);
 
                 // We will then accumulate the sum into Temprow1
-                dsp::fill_zero(sCRPostProc.vTemprow1Re, sCRPostProc.nHwinSize);
-                dsp::fill_zero(sCRPostProc.vTemprow1Im, sCRPostProc.nHwinSize);
+                dsp::fill_zero(vTemprow1Re, count);
+                dsp::fill_zero(vTemprow1Im, count);
 
                 for (size_t c = r + 1; c < sCRPostProc.nHamOrder; ++c)
                 {
                     size_t coeffIdx     = sub2ind_Coeffs(r, c);
-                    size_t kRowSelect   = sub2ind_Data(c, 0);
+                    size_t kRowSelect   = sub2ind_Data(c, first);
 
                     // We fill Temprow2 with Coeffs[r, c], so that we can do element-wise complex multiplication of Coeffs[r, c]
                     // and Kernels[c, :]. We do the multiplication in place into Temprow2.
                     // Make Hermitian Vector.
-                    dsp::fill(sCRPostProc.vTemprow2Re, sCRPostProc.mCoeffsRe[coeffIdx], sCRPostProc.nHwinSize);
-                    dsp::fill(sCRPostProc.vTemprow2Im, sCRPostProc.mCoeffsIm[coeffIdx], negStart - 1);
-                    dsp::fill(&sCRPostProc.vTemprow2Im[negStart], -sCRPostProc.mCoeffsIm[coeffIdx], sCRPostProc.nHwinSize - negStart);
+                    fill_hermitian(vTemprow2Re, vTemprow2Im, sCRPostProc.mCoeffsRe[coeffIdx], sCRPostProc.mCoeffsIm[coeffIdx], first, count, nyquist);
 
                     dsp::complex_mul2(
-                            sCRPostProc.vTemprow2Re, sCRPostProc.vTemprow2Im,
+                            vTemprow2Re, vTemprow2Im,
                             &sCRPostProc.mKernelsRe[kRowSelect], &sCRPostProc.mKernelsIm[kRowSelect],
-                            sCRPostProc.nHwinSize
+                            count
                             );
 
-                    dsp::add2(sCRPostProc.vTemprow1Re, sCRPostProc.vTemprow2Re, sCRPostProc.nHwinSize);
-                    dsp::add2(sCRPostProc.vTemprow1Im, sCRPostProc.vTemprow2Im, sCRPostProc.nHwinSize);
+                    dsp::add2(vTemprow1Re, vTemprow2Re, count);
+                    dsp::add2(vTemprow1Im, vTemprow2Im, count);
                 }
 
                 // Now we can subtract in place the accumulated sum from Kernels[r, :] which, being initialized to
                 // Higher[r, :], yields to the numerator of the expression.
-                dsp::sub2(&sCRPostProc.mKernelsRe[rowSelect], sCRPostProc.vTemprow1Re, sCRPostProc.nHwinSize);
-                dsp::sub2(&sCRPostProc.mKernelsIm[rowSelect], sCRPostProc.vTemprow1Im, sCRPostProc.nHwinSize);
+                dsp::sub2(&sCRPostProc.mKernelsRe[rowSelect], vTemprow1Re, count);
+                dsp::sub2(&sCRPostProc.mKernelsIm[rowSelect], vTemprow1Im, count);
 
                 // We just need to element-wise divide this numerator by Coeffs[r, r], which is the same as
                 // element-wise multiplying with the complex inverse of Coeffs[r, r]
@@ -517,15 +674,13 @@ namespace lsp
                 dsp::complex_rcp2(&coeffRe, &coeffIm, &sCRPostProc.mCoeffsRe[coeffIdx], &sCRPostProc.mCoeffsIm[coeffIdx], 1);
 
                 // Make Hermitian vector
-                dsp::fill(sCRPostProc.vTemprow2Re, coeffRe, sCRPostProc.nHwinSize);
-                dsp::fill(sCRPostProc.vTemprow2Im, coeffIm, negStart - 1);
-                dsp::fill(&sCRPostProc.vTemprow2Im[negStart], -coeffIm, sCRPostProc.nHwinSize - negStart);
+                fill_hermitian(vTemprow2Re, vTemprow2Im, coeffRe, coeffIm, first, count, nyquist);
 
                 dsp::complex_mul3(
                         &sCRPostProc.mKernelsRe[rowSelect], &sCRPostProc.mKernelsIm[rowSelect],
                         &sCRPostProc.mKernelsRe[rowSelect], &sCRPostProc.mKernelsIm[rowSelect],
-                        sCRPostProc.vTemprow2Re, sCRPostProc.vTemprow2Im,
-                        sCRPostProc.nHwinSize
+                        vTemprow2Re, vTemprow2Im,
+                        count
                         );
 
                 --r;
@@ -577,24 +732,54 @@ namespace lsp
             if (channel >= sConvParams.nChannels)
                 return;
 
-            size_t dataLength = pConvResult->length();
-            if (dataLength == 0)
+            if (pConvResult->length() == 0)
                 return;
 
-            float *vResult          = pConvResult->channel(channel);
-            if (vResult == NULL)
+            if (pConvResult->channel(channel) == NULL)
                 return;
 
+            // We will fill the matrix of higher order responses with the higher
+            // order frequency responses. So, we first fill everything with zero,
+            // just in case there was some rubbish.
+            dsp::fill_zero(sCRPostProc.mHigherRe, sCRPostProc.nHamOrder * sCRPostProc.nHwinSize);
+            dsp::fill_zero(sCRPostProc.mHigherIm, sCRPostProc.nHamOrder * sCRPostProc.nHwinSize);
+
+            // The overall smoothing window is the same for all orders
+            if ((!sCRPostProc.bWindowValid) || (sCRPostProc.enWindowType != windowType))
+            {
+                windows::window(sCRPostProc.vWindow, sCRPostProc.nHwinSize, windowType);
+                sCRPostProc.enWindowType    = windowType;
+                sCRPostProc.bWindowValid    = true;
+            }
+
+            // Each order is windowed independently
+            sCRPostProc.nJobChannel     = channel;
+            sCRPostProc.bJobSmoothing   = doInnerSmoothing;
+            sCRPostProc.nJobFadeIn      = nFadeIn;
+            sCRPostProc.nJobFadeOut     = nFadeOut;
+
+            run_identification_jobs(IDENT_WINDOW, sCRPostProc.nHamOrder);
+        }
+
+        void SyncChirpProcessor::windowHigherOrderResponse(size_t m, size_t worker)
+        {
+            size_t dataLength       = pConvResult->length();
+            float *vResult          = pConvResult->channel(sCRPostProc.nJobChannel);
+
+            // Temporary rows of the worker
+            size_t stride           = 4 * sCRPostProc.nHwinSize * worker;
+            float *vTemprow1Re      = &sCRPostProc.vTemprow1Re[stride];
+            float *vTemprow1Im      = &sCRPostProc.vTemprow1Im[stride];
+            float *vTemprow2Re      = &sCRPostProc.vTemprow2Re[stride];
+            float *vTemprow2Im      = &sCRPostProc.vTemprow2Im[stride];
+
             // We locate the center of the convolution result, that acts as a
             // reference point (origin of time). Beware that for linear phase
             // systems we will see a linear impulse response -centered- around this.
             size_t timeOrigin       = (dataLength / 2) - 1;
             size_t maxCount         = dataLength - timeOrigin;
 
-            // We will fill the matrix of higher order responses with the higher
-            // order frequency responses. So, we first fill everything with zero,
-            // just in case there was some rubbish.
-            // Then, we move along the negative time zone of the convolution
+            // We move along the negative time zone of the convolution
             // result, and we find the centres of the higher order impulse responses.
             // To window them, we get as ahead as we can from their center, and we
             // copy all the way to farthest possible from the centre. The reason
@@ -604,13 +789,6 @@ namespace lsp
             // Finally, we Fourier transform and, since the copyheads were floats,
             // but we actually used close integer indexes, we compensate in the
             // frequency domain by doing noninteger sample shift.
-            dsp::fill_zero(sCRPostProc.mHigherRe, sCRPostProc.nHamOrder * sCRPostProc.nHwinSize);
-            dsp::fill_zero(sCRPostProc.mHigherIm, sCRPostProc.nHamOrder * sCRPostProc.nHwinSize);
-
-            dsp::fill_zero(sCRPostProc.vTemprow1Re, sCRPostProc.nHwinSize);
-            dsp::fill_zero(sCRPostProc.vTemprow1Im, sCRPostProc.nHwinSize);
-            dsp::fill_zero(sCRPostProc.vTemprow2Re, sCRPostProc.nHwinSize);
-            dsp::fill_zero(sCRPostProc.vTemprow2Im, sCRPostProc.nHwinSize);;
 
             // Nyquist sample of the higher order frequency responses
             size_t nyquist              = sCRPostProc.nHwinSize / 2;
@@ -618,96 +796,155 @@ namespace lsp
             double gap2prev             = maxCount;
             double halfWindowWidth      = 0.5 * sCRPostProc.nHwinSize;
 
-            for (size_t m = 1; m <= sCRPostProc.nHamOrder; ++m)
-            {
-                double higherOrigin     = timeOrigin - seconds_to_samples(nSampleRate, sChirpParams.gamma * log(m));
-                double gap2next         = seconds_to_samples(nSampleRate, sChirpParams.gamma * log(1.0 + 1.0 / m));
-                if (m > 1)
-                    gap2prev            = seconds_to_samples(nSampleRate, sChirpParams.gamma * log(m / (m - 1.0)));
+            double higherOrigin     = timeOrigin - seconds_to_samples(nSampleRate, sChirpParams.gamma * log(m));
+            double gap2next         = seconds_to_samples(nSampleRate, sChirpParams.gamma * log(1.0 + 1.0 / m));
+            if (m > 1)
+                gap2prev            = seconds_to_samples(nSampleRate, sChirpParams.gamma * log(m / (m - 1.0)));
 
-                double maxAhead         = 0.5 * gap2next;
-                double maxBehind        = 0.5 * gap2prev;
+            double maxAhead         = 0.5 * gap2next;
+            double maxBehind        = 0.5 * gap2prev;
 
-                double headGap          = (maxAhead > halfWindowWidth) ? halfWindowWidth : maxAhead;
-                double tailGap          = (maxBehind > halfWindowWidth) ? halfWindowWidth : maxBehind;
+            double headGap          = (maxAhead > halfWindowWidth) ? halfWindowWidth : maxAhead;
+            double tailGap          = (maxBehind > halfWindowWidth) ? halfWindowWidth : maxBehind;
 
-                double dCopyHead        = higherOrigin - headGap;
+            double dCopyHead        = higherOrigin - headGap;
 
-                if (dCopyHead < 0)
-                    break;
+            // The response is out of the convolution result, the row stays zero
+            if (dCopyHead < 0)
+                return;
 
-                size_t nCopyHead    = dCopyHead;
+            size_t nCopyHead    = dCopyHead;
 
-                size_t copyCount    = headGap + tailGap;
+            size_t copyCount    = headGap + tailGap;
 
-                double dWindowHead  = halfWindowWidth - headGap;
-                size_t nWindowHead  = dWindowHead;
+            double dWindowHead  = halfWindowWidth - headGap;
+            size_t nWindowHead  = dWindowHead;
 
-                dsp::fill_zero(sCRPostProc.vTemprow1Re, sCRPostProc.nHwinSize);
-                dsp::fill_zero(sCRPostProc.vTemprow1Im, sCRPostProc.nHwinSize);
-                dsp::copy(&sCRPostProc.vTemprow1Re[nWindowHead], &vResult[nCopyHead], copyCount);
+            dsp::fill_zero(vTemprow1Re, sCRPostProc.nHwinSize);
+            dsp::fill_zero(vTemprow1Im, sCRPostProc.nHwinSize);
+            dsp::copy(&vTemprow1Re[nWindowHead], &vResult[nCopyHead], copyCount);
 
-                // Applying the smoothing fade-in and fade out to the data.
-                if (doInnerSmoothing)
-                {
-                    size_t fadeInLength     = (nFadeIn < headGap) ? nFadeIn: headGap;
-                    size_t fadeOutLength    = (nFadeOut < tailGap) ? nFadeOut : tailGap;
+            // Applying the smoothing fade-in and fade out to the data.
+            if (sCRPostProc.bJobSmoothing)
+            {
+                size_t fadeInLength     = (sCRPostProc.nJobFadeIn < headGap) ? sCRPostProc.nJobFadeIn : headGap;
+                size_t fadeOutLength    = (sCRPostProc.nJobFadeOut < tailGap) ? sCRPostProc.nJobFadeOut : tailGap;
 
-                    float *fadeHead         = &sCRPostProc.vTemprow1Re[nWindowHead];
+                float *fadeHead         = &vTemprow1Re[nWindowHead];
 
-                    for (size_t n = 0; n < fadeInLength; ++n)
-                    {
-                        fadeHead[n] *= 0.5f * (sin(M_PI * (double(n) / fadeInLength - 0.5)) + 1.0f);
-                    }
+                for (size_t n = 0; n < fadeInLength; ++n)
+                {
+                    fadeHead[n] *= 0.5f * (sin(M_PI * (double(n) / fadeInLength - 0.5)) + 1.0f);
+                }
 
-                    fadeHead                = &sCRPostProc.vTemprow1Re[nWindowHead + copyCount - fadeOutLength - 1];
+                fadeHead                = &vTemprow1Re[nWindowHead + copyCount - fadeOutLength - 1];
 
-                    for (size_t n = 1; n <= fadeOutLength; ++n)
-                    {
-                        fadeHead[n] *= 0.5f * (sin(-M_PI * (double(n) / fadeOutLength - 0.5)) + 1.0f);
-                    }
+                for (size_t n = 1; n <= fadeOutLength; ++n)
+                {
+                    fadeHead[n] *= 0.5f * (sin(-M_PI * (double(n) / fadeOutLength - 0.5)) + 1.0f);
                 }
+            }
+
+            // Applying overall smoothing window
+            dsp::mul2(vTemprow1Re, sCRPostProc.vWindow, sCRPostProc.nHwinSize);
 
-                // Applying overall smoothing window
-                windows::window(sCRPostProc.vTemprow2Re, sCRPostProc.nHwinSize, windowType);
+            dsp::direct_fft(
+                    vTemprow2Re, vTemprow2Im,
+                    vTemprow1Re, vTemprow1Im,
+                    sCRPostProc.nWinRank
+                    );
 
-                dsp::mul2(sCRPostProc.vTemprow1Re, sCRPostProc.vTemprow2Re, sCRPostProc.nHwinSize);
+            double shift        = nCopyHead - dCopyHead + dWindowHead - nWindowHead;
 
-                dsp::direct_fft(
-                        sCRPostProc.vTemprow2Re, sCRPostProc.vTemprow2Im,
-                        sCRPostProc.vTemprow1Re, sCRPostProc.vTemprow1Im,
-                        sCRPostProc.nWinRank
-                        );
+            size_t rowSelect    = sub2ind_Data(m - 1, 0);
+
+            for (size_t k = 0; k <= nyquist; ++k)
+            {
+                size_t p            = (sCRPostProc.nHwinSize - k) % sCRPostProc.nHwinSize;
 
-                double shift        = nCopyHead - dCopyHead + dWindowHead - nWindowHead;
+                double delayFactor  = shift * double(k) / sCRPostProc.nHwinSize;
+                double angle        = 2.0 * M_PI * (delayFactor - floor(delayFactor)); // Wrapped within [0, 2 * M_PI]
 
-                size_t rowSelect    = sub2ind_Data(m - 1, 0);
+                vTemprow1Re[k] = cos(angle);
+                vTemprow1Im[k] = -sin(angle);
 
-                for (size_t k = 0; k <= nyquist; ++k)
+                if ((k != 0) && k != nyquist)
                 {
-                    size_t p            = (sCRPostProc.nHwinSize - k) % sCRPostProc.nHwinSize;
+                    vTemprow1Re[p] = vTemprow1Re[k];
+                    vTemprow1Im[p] = -vTemprow1Im[k];
+                }
+
+            }
 
-                    double delayFactor  = shift * double(k) / sCRPostProc.nHwinSize;
-                    double angle        = 2.0 * M_PI * (delayFactor - floor(delayFactor)); // Wrapped within [0, 2 * M_PI]
+            dsp::complex_mul3(
+                    &sCRPostProc.mHigherRe[rowSelect], &sCRPostProc.mHigherIm[rowSelect],
+                    vTemprow2Re, vTemprow2Im,
+                    vTemprow1Re, vTemprow1Im,
+                    sCRPostProc.nHwinSize
+                    );
+        }
 
-                    sCRPostProc.vTemprow1Re[k] = cos(angle);
-                    sCRPostProc.vTemprow1Im[k] = -sin(angle);
+        void SyncChirpProcessor::run_identification_jobs(ident_stage_t stage, size_t jobs)
+        {
+            sCRPostProc.enStage     = stage;
+            sCRPostProc.nJobs       = jobs;
+            atomic_swap(&nIdentJob, 0);
 
-                    if ((k != 0) && k != nyquist)
-                    {
-                        sCRPostProc.vTemprow1Re[p] = sCRPostProc.vTemprow1Re[k];
-                        sCRPostProc.vTemprow1Im[p] = -sCRPostProc.vTemprow1Im[k];
-                    }
+            size_t workers          = lsp_min(sCRPostProc.nWorkers, jobs);
 
+            lltl::parray<IdentThread> threads_list;
+            for (size_t i=1; i<workers; ++i)
+            {
+                // Failing to start the thread is not critical, the jobs
+                // will be performed by the remaining threads
+                IdentThread *t  = new IdentThread(this, i);
+                if (t == NULL)
+                    break;
+                if (t->start() != STATUS_OK)
+                {
+                    delete t;
+                    break;
                 }
+                if (!threads_list.add(t))
+                {
+                    t->join();
+                    delete t;
+                    break;
+                }
+            }
 
-                dsp::complex_mul3(
-                        &sCRPostProc.mHigherRe[rowSelect], &sCRPostProc.mHigherIm[rowSelect],
-                        sCRPostProc.vTemprow2Re, sCRPostProc.vTemprow2Im,
-                        sCRPostProc.vTemprow1Re, sCRPostProc.vTemprow1Im,
-                        sCRPostProc.nHwinSize
-                        );
+            // Perform jobs in this thread too
+            identification_jobs(0);
+
+            // Wait for the threads
+            for (size_t i=0, n=threads_list.size(); i<n; ++i)
+            {
+                IdentThread *t  = threads_list.uget(i);
+                t->join();
+                delete t;
             }
+            threads_list.flush();
+        }
+
+        status_t SyncChirpProcessor::identification_jobs(size_t worker)
+        {
+            while (true)
+            {
+                size_t job      = atomic_add(&nIdentJob, 1);
+                if (job >= sCRPostProc.nJobs)
+                    break;
+
+                if (sCRPostProc.enStage == IDENT_WINDOW)
+                    windowHigherOrderResponse(job + 1, worker);
+                else
+                {
+                    size_t first    = (job * sCRPostProc.nHwinSize) / sCRPostProc.nJobs;
+                    size_t last     = ((job + 1) * sCRPostProc.nHwinSize) / sCRPostProc.nJobs;
+                    solve_bins(first, last - first, worker);
+                }
+            }
+
+            return STATUS_OK;
         }
 
         status_t SyncChirpProcessor::fill_with_kernel_taps(float *dst)
@@ -849,6 +1086,201 @@ namespace lsp
             return STATUS_OK;
         }
 
+        typedef struct decay_fit_t
+        {
+            double          fEnergy;            // Total energy of the response
+            double          fSlope;             // Slope of the regression line [dB / sample]
+            double          fIntercept;         // Intercept of the regression line [dB]
+            double          fCorrelation;       // Correlation coefficient of the regression
+            size_t          nCount;             // Number of samples used for the regression
+        } decay_fit_t;
+
+        static void rt_thresholds(scp_rtcalc_t rtCalc, double *decayThreshold, double *highRegLevel, double *lowRegLevel)
+        {
+            *decayThreshold     = -60.0;
+
+            switch (rtCalc)
+            {
+                case SCP_RT_EDT_0:  *highRegLevel =  0.0; *lowRegLevel = -10.0; break;
+                case SCP_RT_EDT_1:  *highRegLevel = -1.0; *lowRegLevel = -10.0; break;
+                case SCP_RT_T_10:   *highRegLevel = -5.0; *lowRegLevel = -15.0; break;
+                case SCP_RT_T_20:   *highRegLevel = -5.0; *lowRegLevel = -25.0; break;
+                case SCP_RT_T_30:   *highRegLevel = -5.0; *lowRegLevel = -35.0; break;
+                default:            *highRegLevel = -5.0; *lowRegLevel = -25.0; break;
+            }
+        }
+
+        /** Find the sample at which the envelope of the response fades into noise: the envelope
+         * follower holds the peak of the last windowSize samples, so the response fades when
+         * windowSize consecutive samples after the peak do not exceed the noise. The runs are
+         * searched by blocks: the block which peak does not exceed the noise extends the run,
+         * otherwise the run restarts after the last loud sample of the block.
+         */
+        static size_t find_integration_limit(const float *data, size_t samples, size_t windowSize, float noiseValue, double noiseLevel, double tolerance)
+        {
+            size_t integrationLimit = samples;
+            size_t peakIdx          = dsp::abs_max_index(data, samples);
+            windowSize              = lsp_max(windowSize, size_t(1));
+
+            bool doSearch           = 20.0 * log10(fabs(data[peakIdx])) > (noiseLevel + tolerance);
+
+            while (doSearch)
+            {
+                size_t runStart         = peakIdx + 1;
+                size_t pos              = runStart;
+
+                while ((pos < samples) && ((pos - runStart) < windowSize))
+                {
+                    size_t to_do            = lsp_min(runStart + windowSize - pos, samples - pos);
+                    if (dsp::abs_max(&data[pos], to_do) <= noiseValue)
+                    {
+                        pos                    += to_do;
+                        continue;
+                    }
+
+                    // Restart the run after the last sample above the noise
+                    size_t last             = pos + to_do - 1;
+                    while (fabsf(data[last]) <= noiseValue)
+                        --last;
+                    runStart                = last + 1;
+                    pos                     = runStart;
+                }
+
+                // The response does not fade into noise till the end
+                if ((pos - runStart) < windowSize)
+                    break;
+
+                size_t n                = runStart + windowSize - 1;
+                integrationLimit        = n;
+                peakIdx                 = dsp::abs_max_index(&data[n], samples - n) + n; // Need to offset properly this index so that it indexes into data.
+                doSearch                = 20.0 * log10(fabs(data[peakIdx])) > (noiseLevel + tolerance);
+            }
+
+            return integrationLimit;
+        }
+
+        /** Fit the regression line to the energy decay curve (backwards integration of the squared
+         * impulse response, normalised to 0 dB at 0 time) between the high and low regression levels.
+         * The curve decays monotonically, so the regression samples form a contiguous range: the
+         * blocks completely above the high level are skipped by their energy, and the levels of the
+         * regression range are computed by blocks. The regression sums of the sample indices are
+         * known in closed form, so one pass is enough.
+         */
+        static void fit_energy_decay(decay_fit_t *fit, float *buf, const float *data, size_t count, double highRegLevel, double lowRegLevel)
+        {
+            fit->fEnergy            = 0.0;
+            fit->fSlope             = 0.0;
+            fit->fIntercept         = 0.0;
+            fit->fCorrelation       = 0.0;
+            fit->nCount             = 0;
+
+            // Total energy, the block sums are accumulated in double precision
+            double energy           = 0.0;
+            for (size_t i = 0; i < count; i += SCHROEDER_BLOCK_SIZE)
+                energy                 += dsp::h_sqr_sum(&data[i], lsp_min(count - i, size_t(SCHROEDER_BLOCK_SIZE)));
+
+            fit->fEnergy            = energy;
+            if (energy <= 0.0)
+                return;
+
+            double highEnergy       = energy * exp(M_LN10 * 0.1 * highRegLevel);
+            double lowEnergy        = energy * exp(M_LN10 * 0.1 * lowRegLevel);
+            float kNorm             = 1.0 / energy;
+            float kLevel            = 10.0 / M_LN10;
+
+            double removed          = 0.0;      // Energy of the samples preceding the block
+            size_t first            = 0;        // First sample of the regression
+            size_t n                = 0;        // Number of samples of the regression
+            double sumL             = 0.0;      // Sum of levels
+            double sumLL            = 0.0;      // Sum of squared levels
+            double sumIL            = 0.0;      // Sum of levels multiplied by (sample - first)
+
+            for (size_t head = 0; head < count; )
+            {
+                size_t to_do            = lsp_min(count - head, size_t(SCHROEDER_BLOCK_SIZE));
+                double decay            = energy - removed;     // Energy decay curve at the block start
+                if (decay < lowEnergy)
+                    break;
+
+                // The whole block is above the high regression level?
+                removed                += dsp::h_sqr_sum(&data[head], to_do);
+                if ((energy - removed) > highEnergy)
+                {
+                    head                   += to_do;
+                    continue;
+                }
+
+                // Energy decay curve of the block
+                dsp::mul3(buf, &data[head], &data[head], to_do);
+                for (size_t i = 0; i < to_do; ++i)
+                {
+                    float v                 = buf[i];
+                    buf[i]                  = decay;
+                    decay                  -= v;
+                }
+
+                // Regression range of the block, the 0 time sample does not participate
+                size_t i0               = (head > 0) ? 0 : 1;
+                while ((i0 < to_do) && (buf[i0] > highEnergy))
+                    ++i0;
+                size_t i1               = i0;
+                while ((i1 < to_do) && (buf[i1] >= lowEnergy))
+                    ++i1;
+
+                size_t k                = i1 - i0;
+                if (k > 0)
+                {
+                    // Convert to levels [dB]
+                    float *level            = &buf[i0];
+                    dsp::mul_k2(level, kNorm, k);
+                    dsp::loge1(level, k);
+                    dsp::mul_k2(level, kLevel, k);
+
+                    if (n == 0)
+                        first                   = head + i0;
+
+                    double sum              = dsp::h_sum(level, k);
+                    double moment           = 0.0;
+                    for (size_t i = 0; i < k; ++i)
+                        moment                 += double(i) * level[i];
+
+                    sumL                   += sum;
+                    sumLL                  += dsp::h_sqr_sum(level, k);
+                    sumIL                  += moment + double(n) * sum;
+                    n                      += k;
+                }
+
+                // The curve has fallen below the low regression level
+                if (i1 < to_do)
+                    break;
+                head                   += to_do;
+            }
+
+            fit->nCount             = n;
+            if (n < 2)
+                return;
+
+            // Regression line parameters (all variance normalisation factors get erased):
+            double meanI            = 0.5 * (n - 1.0);
+            double meanL            = sumL / n;
+            double sqErrI           = n * (double(n) * n - 1.0) / 12.0;
+            double sqErrL           = lsp_max(sumLL - n * meanL * meanL, 0.0);
+            double comoment         = sumIL - n * meanI * meanL;
+            double norm             = sqrt(sqErrI * sqErrL);
+
+            fit->fSlope             = comoment / sqErrI;
+            fit->fIntercept         = meanL - fit->fSlope * (first + meanI);
+            fit->fCorrelation       = (norm > 0.0) ? comoment / norm : 0.0; // Avoid NANs
+        }
+
+        static size_t rt_samples(const decay_fit_t *fit, double decayThreshold)
+        {
+            // RT extrapolation, the decay should be descending
+            if ((fit->nCount < 2) || (fit->fSlope >= 0.0))
+                return 0;
+            return (decayThreshold - fit->fIntercept) / fit->fSlope;
+        }
+
         status_t SyncChirpProcessor::calibrate_backwards_integration_limit(size_t channel, size_t head, size_t windowSize, double tolerance)
         {
             if (pConvResult == NULL)
@@ -869,54 +1301,10 @@ namespace lsp
                 return STATUS_BAD_ARGUMENTS;
 
             size_t samples          = dataLength - head;
-            float *vData            = &vResult[head];
-
             windowSize              = (windowSize < ENVELOPE_BUF_LIMIT_SIZE) ? windowSize : ENVELOPE_BUF_LIMIT_SIZE;
 
-            // Let's start searching for the point at which the envelope fades into
-            // noise from the right of the peak: it is not gonna be earlier than
-            // there.
-            size_t peakIdx          = dsp::abs_max_index(vData, samples);
-
-            // We will now follow the envelope of the signal with our window, and
-            // track when it fades below the noise floor.
-
-            size_t integrationLimit = samples;
-
-            bool doSearch           = 20.0 * log10(fabs(vData[peakIdx])) > (sCRPostProc.noiseLevel + tolerance);
-
-            while (doSearch)
-            {
-                dsp::fill_zero(vEnvelopeBuffer, windowSize);
-                size_t windowHead       = 0;
-                size_t windowPeakIdx    = 0;
-
-                for (size_t n = peakIdx; n < samples; ++n)
-                {
-                    ++windowHead;
-                    windowHead          = windowHead % windowSize;
-
-                    vEnvelopeBuffer[windowHead] = fabs(vData[n]);
-
-                    if (windowPeakIdx == windowHead)
-                        windowPeakIdx   = dsp::max_index(vEnvelopeBuffer, windowSize);
-                    else if (vEnvelopeBuffer[windowHead] > vEnvelopeBuffer[windowPeakIdx])
-                        windowPeakIdx   = windowHead;
-
-                    double peak         = vEnvelopeBuffer[windowPeakIdx];
-
-                    if (peak <= sCRPostProc.noiseValue)
-                    {
-                        integrationLimit    = n;
-                        peakIdx             = dsp::abs_max_index(&vData[n], samples - n) + n; // Need to offset properly this index so that it indexes into vData.
-                        doSearch            = 20.0 * log10(fabs(vData[peakIdx])) > (sCRPostProc.noiseLevel + tolerance);
-                        break;
-                    }
-                }
-            }
-
             // This integration limit will be relative to head.
-            sCRPostProc.nIrLimit    = integrationLimit;
+            sCRPostProc.nIrLimit    = find_integration_limit(&vResult[head], samples, windowSize, sCRPostProc.noiseValue, sCRPostProc.noiseLevel, tolerance);
             sCRPostProc.fIrLimit    = samples_to_seconds(nSampleRate, sCRPostProc.nIrLimit);
 
             return STATUS_OK;
@@ -937,85 +1325,26 @@ namespace lsp
             if ((highRegLevel > 0) || (lowRegLevel > 0) || (highRegLevel <= lowRegLevel) || (head >= dataLength))
                 return STATUS_BAD_ARGUMENTS;
 
-            // Extract estimate of RT from positive time impulse response.
-            // While scanning through the IR:
+            // Extract estimate of RT from positive time impulse response:
             // Find the decay energy curve values
             // Find the regression line between the Regression thresholds.
             // Find the time at which the regression line reaches the low decay threshold.
 
-            // Backwards integration of the squared impulse response supplies the average
-            // energy decay curve. This curve is maximal at 0 time and decays as time
-            // gets larger. Here we use it normalised: so the 0 time value is 1.
-
             float *vResult          = pConvResult->channel(channel);
             if (vResult == NULL)
                 return STATUS_BAD_ARGUMENTS;
 
             size_t samples          = dataLength - head;
             size_t count            = (samples > limit) ? limit : samples;
-            float *vData            = &vResult[head];
-
-            // Initialise the squared impulse response summer and statistics at
-            // iteration 0.
-
-            double lookAheadSum     = 0.0;
-
-            for (size_t n = 0; n < count; ++n)
-            {
-                double value        = vData[n];
-                lookAheadSum       += (value * value);
-            }
-
-            double energyDecayNorm  = lookAheadSum;                         // This is the norm to normalise the decay values
-            double convolutionNorm  = sqrt(nSampleRate / lookAheadSum);     // This is the norm to normalise the impulse response to its total energy
-            double energyDecayValue = 1.0;                                  // First value is then 1: lookAheadSum / energyDecayNorm
-            double energyDecayLevel = 0.0;                                  // Correspondent decay level [dB]
-
-            double energyDecayMean  = 0;                                    // Decay mean
-            double energyDecaySqErr = 0;                                    // Decay Squared Error (from the mean)
-            double samplesMean      = 0;                                    // Samples Mean
-            double samplesSqErr     = 0;                                    // Samples Squared Error (from the mean)
-            double comoment         = 0;                                    // Co-moment for co-variance calculation
-            size_t counter          = 1;                                    // Counts processed samples
 
-            // Subsequent iterations by simply updating the values (online algorithms)
-            for (size_t m = 1; m < count; ++m)
-            {
-                double value        = vData[m - 1];
-                lookAheadSum       -= (value * value);
-
-                energyDecayValue    = lookAheadSum / energyDecayNorm;
-                energyDecayLevel    = 10.0 * log10(energyDecayValue);
-
-                // Finish calculation?
-                if (energyDecayLevel < lowRegLevel)
-                    break;
-
-                // Do linear regression?
-                if (energyDecayLevel <= highRegLevel)
-                {
-                    double samplesMean_previous         = samplesMean;
-                    double energyDecayMean_previous     = energyDecayMean;
-
-                    energyDecayMean                    += (energyDecayLevel - energyDecayMean) / counter;
-                    energyDecaySqErr                   += (energyDecayLevel - energyDecayMean) * (energyDecayLevel - energyDecayMean_previous);
-                    samplesMean                        += (m - samplesMean) / counter;
-                    samplesSqErr                       += (m - samplesMean) * (m - samplesMean_previous);
-                    comoment                           += (m - samplesMean) * (energyDecayLevel - energyDecayMean_previous);
-
-                    ++counter;
-                }
-            }
+            decay_fit_t fit;
+            fit_energy_decay(&fit, vEnvelopeBuffer, &vResult[head], count, highRegLevel, lowRegLevel);
 
-            // Regression line parameters (all variance normalisation factors get erased):
-            double slope            = comoment / samplesSqErr;
-            double intercept        = energyDecayMean - slope * samplesMean;
-            double correlation      = sqrt(samplesSqErr * energyDecaySqErr);
+            double convolutionNorm  = (fit.fEnergy > 0.0) ? sqrt(nSampleRate / fit.fEnergy) : 0.0; // This is the norm to normalise the impulse response to its total energy
 
-            // RT extrapolation:
-            sCRPostProc.nRT             = ((decayThreshold - intercept) / slope); // - middle + head; // to make relative to middle
+            sCRPostProc.nRT             = rt_samples(&fit, decayThreshold);
             sCRPostProc.fRT             = samples_to_seconds(nSampleRate, sCRPostProc.nRT);
-            sCRPostProc.fCorrelation    = (correlation == 0.0) ? correlation : comoment / correlation; // Avoid NANs
+            sCRPostProc.fCorrelation    = fit.fCorrelation;
 
             // Other data:
             sCRPostProc.noiseValueNorm  = convolutionNorm * sCRPostProc.noiseValue;
@@ -1028,21 +1357,10 @@ namespace lsp
 
         status_t SyncChirpProcessor::calculate_reverberation_time(size_t channel, size_t head, scp_rtcalc_t rtCalc, size_t limit)
         {
-            switch (rtCalc)
-            {
-                case SCP_RT_EDT_0:
-                    return calculate_reverberation_time(channel, head, -60.0,  0.0, -10.0, limit);
-                case SCP_RT_EDT_1:
-                    return calculate_reverberation_time(channel, head, -60.0, -1.0, -10.0, limit);
-                case SCP_RT_T_10:
-                    return calculate_reverberation_time(channel, head, -60.0, -5.0, -15.0, limit);
-                case SCP_RT_T_20:
-                    return calculate_reverberation_time(channel, head, -60.0, -5.0, -25.0, limit);
-                case SCP_RT_T_30:
-                    return calculate_reverberation_time(channel, head, -60.0, -5.0, -35.0, limit);
-                default:
-                    return calculate_reverberation_time(channel, head, -60.0, -5.0, -25.0, limit);
-            }
+            double decayThreshold, highRegLevel, lowRegLevel;
+            rt_thresholds(rtCalc, &decayThreshold, &highRegLevel, &lowRegLevel);
+
+            return calculate_reverberation_time(channel, head, decayThreshold, highRegLevel, lowRegLevel, limit);
         }
 
         double SyncChirpProcessor::nchoosek(size_t n, size_t k)
@@ -1298,6 +1616,15 @@ namespace lsp
         }
 
         void SyncChirpProcessor::calculateConvolutionParameters(Sample **data, size_t *offset)
+        {
+            // The lengths are stored in vConvLengths: each of them is read before being overwritten
+            for (size_t ch = 0; ch < sConvParams.nChannels; ++ch)
+                sConvParams.vConvLengths[ch]        = data[ch]->length() - offset[ch];
+
+            calculateConvolutionParameters(sConvParams.vConvLengths);
+        }
+
+        void SyncChirpProcessor::calculateConvolutionParameters(const size_t *lengths)
         {
             sConvParams.nAllocationSize = 0;
 
@@ -1311,7 +1638,7 @@ namespace lsp
                 // the tail, the inverse filter as padded at the beginning (to not shift
                 // the convolution centre).
 
-                size_t nInputData       		    = data[ch]->length() - offset[ch];
+                size_t nInputData       		    = lengths[ch];
                 size_t nInverseFilter   		    = pInverseFilter->length();
 
                 size_t nMaxLength       		    = (nInputData > nInverseFilter) ? nInputData : nInverseFilter;
@@ -1331,32 +1658,33 @@ namespace lsp
                 sConvParams.vAlignOffsets[ch] = middle - (sConvParams.vConvLengths[ch] / 2) + 1;
         }
 
-        status_t SyncChirpProcessor::allocateConvolutionTempArrays()
+        status_t SyncChirpProcessor::allocateConvolutionTempArrays(size_t workers)
         {
-            if (!sConvParams.bReallocateTemp)
+            if ((!sConvParams.bReallocateTemp) && (sConvParams.nWorkers == workers))
                 return STATUS_OK;
 
             destroyConvolutionTempArrays();
 
-            // Allocate 2X Partition temp buffers + 2X Partition Image temp buffers 1X Temporary buffer
-            size_t samples          = 2 * sConvParams.nPartitionSize + 3 * sConvParams.nImage;
+            // Allocate 1X Inverse filter partition temp buffer and for each worker
+            // 1X Partition temp buffer + 1X Partition Image temp buffer + 1X Temporary buffer
+            size_t stride           = sConvParams.nPartitionSize + 2 * sConvParams.nImage;
+            size_t samples          = sConvParams.nPartitionSize + workers * stride;
 
             float *ptr        		= alloc_aligned<float>(sConvParams.pTempData, samples);
             if (ptr == NULL)
                 return STATUS_NO_MEM;
 
-            sConvParams.vInPart     = ptr;
-            ptr                    += sConvParams.nPartitionSize;
             sConvParams.vInvPart    = ptr;
             ptr                    += sConvParams.nPartitionSize;
+            sConvParams.vInPart     = ptr;
+            ptr                    += sConvParams.nPartitionSize * workers;
             sConvParams.vInImage    = ptr;
-            ptr                    += sConvParams.nImage;
-            sConvParams.vInvImage   = ptr;
-            ptr                    += sConvParams.nImage;
+            ptr                    += sConvParams.nImage * workers;
             sConvParams.vTemp       = ptr;
-            ptr                    += sConvParams.nImage;
+            ptr                    += sConvParams.nImage * workers;
+            sConvParams.nWorkers    = workers;
 
-            dsp::fill_zero(sConvParams.vInPart, samples);
+            dsp::fill_zero(sConvParams.vInvPart, samples);
 
             return STATUS_OK;
         }
@@ -1364,19 +1692,71 @@ namespace lsp
         void SyncChirpProcessor::destroyConvolutionTempArrays()
         {
             free_aligned(sConvParams.pTempData);
+            free_aligned(sConvParams.pInvData);
             sConvParams.pTempData 	= NULL;
+            sConvParams.pInvData    = NULL;
+            sConvParams.nWorkers    = 0;
+            sConvParams.nInvImages  = 0;
             sConvParams.vInPart     = NULL;
             sConvParams.vInvPart    = NULL;
             sConvParams.vInImage    = NULL;
-            sConvParams.vInvImage   = NULL;
+            sConvParams.vInvImages  = NULL;
             sConvParams.vTemp       = NULL;
         }
 
-        status_t SyncChirpProcessor::do_linear_convolutions(Sample **data, size_t *offset, size_t nchannels, size_t partSizeLimit)
+        status_t SyncChirpProcessor::prepareInverseFilterImages()
+        {
+            size_t nPartSize        = sConvParams.nPartitionSize;
+            size_t nInverseFilter   = pInverseFilter->length();
+            float *vInverseFilter   = pInverseFilter->getBuffer(0);
+
+            // The padded lengths are multiples of the partition size, so the prepend of each
+            // channel is the same amount of samples modulo the partition size
+            size_t shift            = (nPartSize - (nInverseFilter % nPartSize)) % nPartSize;
+            size_t images           = (shift + nInverseFilter) / nPartSize;
+
+            free_aligned(sConvParams.pInvData);
+            sConvParams.vInvImages  = NULL;
+            sConvParams.nInvImages  = 0;
+
+            float *ptr              = alloc_aligned<float>(sConvParams.pInvData, images * sConvParams.nImage);
+            if (ptr == NULL)
+                return STATUS_NO_MEM;
+
+            sConvParams.vInvImages  = ptr;
+            sConvParams.nInvImages  = images;
+
+            // Normalising by square sample rate to recover physical units, the scaling is
+            // applied to the images so the partial convolution result is already scaled.
+            float k                 = sChirpParams.fConvScale / (nSampleRate * nSampleRate);
+
+            // Image i covers the inverse filter samples starting at (i * nPartSize - shift)
+            for (size_t i = 0; i < images; ++i, ptr += sConvParams.nImage)
+            {
+                ssize_t head        = ssize_t(i * nPartSize) - ssize_t(shift);
+
+                if (head < 0)
+                {
+                    dsp::fill_zero(sConvParams.vInvPart, -head);
+                    dsp::mul_k3(&sConvParams.vInvPart[-head], vInverseFilter, k, nPartSize + head);
+                }
+                else
+                    dsp::mul_k3(sConvParams.vInvPart, &vInverseFilter[head], k, nPartSize);
+
+                dsp::fastconv_parse(ptr, sConvParams.vInvPart, sConvParams.nConvRank);
+            }
+
+            return STATUS_OK;
+        }
+
+        status_t SyncChirpProcessor::do_linear_convolutions(Sample **data, size_t *offset, size_t nchannels, size_t partSizeLimit, size_t threads)
         {
             if ((data == NULL) || (offset == NULL) || (nchannels == 0))
                 return STATUS_NO_DATA;
+            if (pInverseFilter == NULL)
+                return STATUS_NO_DATA;
 
+            sStream.bActive = false;
             calculateConvolutionPartitionSize(partSizeLimit);
 
             status_t status = allocateConvolutionParameters(nchannels);
@@ -1389,14 +1769,70 @@ namespace lsp
             if (status != STATUS_OK)
                 return status;
 
-            status = allocateConvolutionTempArrays();
+            size_t workers  = lsp_max(lsp_min(threads, nchannels), size_t(1));
+            status = allocateConvolutionTempArrays(workers);
             if (status != STATUS_OK)
                 return status;
 
-            for (size_t ch = 0; ch < nchannels; ++ch)
-            {
-                status = do_linear_convolution(data[ch], offset[ch], ch);
-
+            status = prepareInverseFilterImages();
+            if (status != STATUS_OK)
+                return status;
+
+            // Each channel is convolved by exactly one worker
+            sConvParams.vJobData        = data;
+            sConvParams.vJobOffsets     = offset;
+            atomic_swap(&nConvJob, 0);
+
+            lltl::parray<ConvThread> threads_list;
+            for (size_t i=1; i<workers; ++i)
+            {
+                // Failing to start the thread is not critical, the channels
+                // will be convolved by the remaining threads
+                ConvThread *t   = new ConvThread(this, i);
+                if (t == NULL)
+                    break;
+                if (t->start() != STATUS_OK)
+                {
+                    delete t;
+                    break;
+                }
+                if (!threads_list.add(t))
+                {
+                    t->join();
+                    delete t;
+                    break;
+                }
+            }
+
+            // Perform convolutions in this thread too
+            status          = convolution_jobs(0);
+
+            // Wait for the threads
+            for (size_t i=0, n=threads_list.size(); i<n; ++i)
+            {
+                ConvThread *t   = threads_list.uget(i);
+                t->join();
+                if (status == STATUS_OK)
+                    status          = t->get_result();
+                delete t;
+            }
+            threads_list.flush();
+
+            sConvParams.vJobData        = NULL;
+            sConvParams.vJobOffsets     = NULL;
+
+            return status;
+        }
+
+        status_t SyncChirpProcessor::convolution_jobs(size_t worker)
+        {
+            while (true)
+            {
+                size_t ch       = atomic_add(&nConvJob, 1);
+                if (ch >= sConvParams.nChannels)
+                    break;
+
+                status_t status = do_linear_convolution(sConvParams.vJobData[ch], sConvParams.vJobOffsets[ch], ch, worker);
                 if (status != STATUS_OK)
                     return status;
             }
@@ -1404,34 +1840,37 @@ namespace lsp
             return STATUS_OK;
         }
 
-        status_t SyncChirpProcessor::do_linear_convolution(Sample *data, size_t offset, size_t channel)
+        status_t SyncChirpProcessor::do_linear_convolution(Sample *data, size_t offset, size_t channel, size_t worker)
         {
             if ((pInverseFilter == NULL) || (data == NULL))
                 return STATUS_NO_DATA;
 
-            if (channel >= sConvParams.nChannels)
+            if ((channel >= sConvParams.nChannels) || (worker >= sConvParams.nWorkers))
                 return STATUS_BAD_ARGUMENTS;
 
-            dsp::fill_zero(sConvParams.vInPart, 	sConvParams.nPartitionSize);
-            dsp::fill_zero(sConvParams.vInvPart, 	sConvParams.nPartitionSize);
-            dsp::fill_zero(sConvParams.vInImage, 	sConvParams.nImage);
-            dsp::fill_zero(sConvParams.vInvImage, 	sConvParams.nImage);
-            dsp::fill_zero(sConvParams.vTemp, 		sConvParams.nImage);
+            // Temporary buffers of the worker
+            float *vInPart          = &sConvParams.vInPart[worker * sConvParams.nPartitionSize];
+            float *vInImage         = &sConvParams.vInImage[worker * sConvParams.nImage];
+            float *vTemp            = &sConvParams.vTemp[worker * sConvParams.nImage];
+
+            dsp::fill_zero(vInPart, 	sConvParams.nPartitionSize);
+            dsp::fill_zero(vInImage, 	sConvParams.nImage);
+            dsp::fill_zero(vTemp, 		sConvParams.nImage);
 
             // Results
             float *vInputData       = data->getBuffer(0, offset);
             size_t nInputData       = data->length() - offset;
 
-            float *vInverseFilter   = pInverseFilter->getBuffer(0);
-
             float *vResult 			= pConvResult->channel(channel);
             if (vResult == NULL)
                 return STATUS_BAD_ARGUMENTS;
+            dsp::fill_zero(vResult, pConvResult->length());
 
-            // Do the convolution.
-            bool bNullInputPart     = false; // If one of the operands of the convolution is zeros, set to true and avoid convolution
-            bool bNullInversePart   = false;
+            // The prepend pad of the inverse filter consists of whole zero partitions followed
+            // by the partitions which images are cached, the zero partitions give zero result.
+            size_t nInvSkip         = sConvParams.vInversePrepends[channel] / sConvParams.nPartitionSize;
 
+            // Do the convolution.
             for (size_t inp = 0; inp < sConvParams.vPartitions[channel]; ++inp) // Cycle through input partitions
             {
                 // Scanning through the input data: current position is inputHead.
@@ -1441,86 +1880,190 @@ namespace lsp
                 ssize_t inSamplesAhead = ssize_t(nInputData) - ssize_t(inputHead);
 
                 if (inSamplesAhead > ssize_t(sConvParams.nPartitionSize)) // The whole current partition is within the input data
-                {
-                    bNullInputPart  = false;
-                    dsp::fastconv_parse(sConvParams.vInImage, &vInputData[inputHead], sConvParams.nConvRank);
-                }
+                    dsp::fastconv_parse(vInImage, &vInputData[inputHead], sConvParams.nConvRank);
                 else if (inSamplesAhead > 0) // The current partition is across the end of input data and the beginning of the pad
                 {
-                    bNullInputPart  = false;
-                    dsp::copy(sConvParams.vInPart, &vInputData[inputHead], inSamplesAhead);
-                    dsp::fill_zero(&sConvParams.vInPart[inSamplesAhead], sConvParams.nPartitionSize - inSamplesAhead);
-                    dsp::fastconv_parse(sConvParams.vInImage, sConvParams.vInPart, sConvParams.nConvRank);
+                    dsp::copy(vInPart, &vInputData[inputHead], inSamplesAhead);
+                    dsp::fill_zero(&vInPart[inSamplesAhead], sConvParams.nPartitionSize - inSamplesAhead);
+                    dsp::fastconv_parse(vInImage, vInPart, sConvParams.nConvRank);
                 }
-                else // The current partition is completely in the pad
+                else // The current partition is completely in the pad, result is zero
+                    continue;
+
+                const float *vInvImage  = sConvParams.vInvImages;
+                for (size_t invp = 0; invp < sConvParams.nInvImages; ++invp, vInvImage += sConvParams.nImage) // Cycle through inverse filter partitions
                 {
-                    bNullInputPart  = true;
+                    dsp::fastconv_apply(&vResult[sConvParams.nPartitionSize * (inp + invp + nInvSkip) + sConvParams.vAlignOffsets[channel]],
+                                vTemp,
+                                vInImage,
+                                vInvImage,
+                                sConvParams.nConvRank
+                                );
                 }
+            }
 
-                // Initialise the position tracker for the inverse filter.
-                // This will be bumped as the loop scans through the pad first
-                // and the actual inverse filter data later.
-                size_t inverseHead  = 0;
+            return STATUS_OK;
+        }
 
-                for (size_t invp = 0; invp < sConvParams.vPartitions[channel]; ++invp) // Cycle through inverse filter partitions
-                {
-                    // Scanning through the imaginary array made of prepend pad followed by inverse filter:
-                    // current position is virtualHead
-                    size_t virtualHead = invp * sConvParams.nPartitionSize;
+        void SyncChirpProcessor::destroyStreamBuffers()
+        {
+            free_aligned(sStream.pData);
+            sStream.pData           = NULL;
+            sStream.vOffsets        = NULL;
+            sStream.vHead           = NULL;
+            sStream.vInPart         = NULL;
+            sStream.nLength         = 0;
+            sStream.bActive         = false;
+        }
 
-                    // Evaluate distance of head from end of prepend pad
-                    ssize_t viSamplesAhead = ssize_t(sConvParams.vInversePrepends[channel]) - ssize_t(virtualHead);
+        status_t SyncChirpProcessor::begin_streaming(size_t nchannels, size_t length, const size_t *offset, size_t partSizeLimit)
+        {
+            if ((nchannels == 0) || (pInverseFilter == NULL))
+                return STATUS_NO_DATA;
 
-                    if (viSamplesAhead > ssize_t(sConvParams.nPartitionSize)) // The whole partition is within the pad
-                    {
-                        bNullInversePart = true;
-                    }
-                    else if (viSamplesAhead > 0) // The partition is across the end of the pad and the beginning of data
-                    {
-                        bNullInversePart    = false;
-                        size_t toCopy       = sConvParams.nPartitionSize - viSamplesAhead;
-                        dsp::fill_zero(sConvParams.vInvPart, viSamplesAhead);
-                        dsp::copy(&sConvParams.vInvPart[viSamplesAhead], &vInverseFilter[inverseHead], toCopy);
-                        dsp::fastconv_parse(sConvParams.vInvImage, sConvParams.vInvPart, sConvParams.nConvRank);
-                        inverseHead += toCopy;
-                    }
-                    else // The partition is inside the inverse filter
-                    {
-                        bNullInversePart    = false;
-                        dsp::fastconv_parse(sConvParams.vInvImage, &vInverseFilter[inverseHead], sConvParams.nConvRank);
-                        inverseHead += sConvParams.nPartitionSize;
-                    }
+            destroyStreamBuffers();
+            calculateConvolutionPartitionSize(partSizeLimit);
 
-                    if (bNullInputPart || bNullInversePart)
-                        continue; // Result is zero, nothing to do.
+            status_t status = allocateConvolutionParameters(nchannels);
+            if (status != STATUS_OK)
+                return status;
 
-                    dsp::fastconv_apply(&vResult[sConvParams.nPartitionSize * (inp + invp) + sConvParams.vAlignOffsets[channel]],
-                                sConvParams.vTemp,
-                                sConvParams.vInImage,
-                                sConvParams.vInvImage,
-                                sConvParams.nConvRank
-                                );
+            // 2X per-channel index arrays, 1X pending partition per channel
+            size_t szof_idx         = align_size(nchannels * sizeof(size_t), DEFAULT_ALIGN);
+            size_t szof_part        = nchannels * sConvParams.nPartitionSize * sizeof(float);
+            uint8_t *ptr            = alloc_aligned<uint8_t>(sStream.pData, 2 * szof_idx + szof_part);
+            if (ptr == NULL)
+                return STATUS_NO_MEM;
+
+            sStream.vOffsets        = reinterpret_cast<size_t *>(ptr);
+            ptr                    += szof_idx;
+            sStream.vHead           = reinterpret_cast<size_t *>(ptr);
+            ptr                    += szof_idx;
+            sStream.vInPart         = reinterpret_cast<float *>(ptr);
+            ptr                    += szof_part;
+
+            // The convolution parameters are the same as for the complete input time series
+            for (size_t ch = 0; ch < nchannels; ++ch)
+            {
+                size_t off              = (offset != NULL) ? offset[ch] : 0;
+                sStream.vOffsets[ch]    = off;
+                sStream.vHead[ch]       = (length > off) ? length - off : 0;
+            }
+            calculateConvolutionParameters(sStream.vHead);
+
+            status = allocateConvolutionResult(nSampleRate, sConvParams.nChannels, sConvParams.nAllocationSize);
+            if (status != STATUS_OK)
+                return status;
+
+            status = allocateConvolutionTempArrays(1);
+            if (status != STATUS_OK)
+                return status;
+
+            status = prepareInverseFilterImages();
+            if (status != STATUS_OK)
+                return status;
+
+            for (size_t ch = 0; ch < nchannels; ++ch)
+            {
+                dsp::fill_zero(pConvResult->channel(ch), pConvResult->length());
+                sStream.vHead[ch]       = 0;
+            }
+            dsp::fill_zero(sStream.vInPart, nchannels * sConvParams.nPartitionSize);
+
+            sStream.nLength         = length;
+            sStream.bActive         = true;
+
+            return STATUS_OK;
+        }
+
+        status_t SyncChirpProcessor::stream_convolution(size_t channel, const float *src, size_t count)
+        {
+            if (!sStream.bActive)
+                return STATUS_BAD_STATE;
+            if ((channel >= sConvParams.nChannels) || (src == NULL))
+                return STATUS_BAD_ARGUMENTS;
+
+            size_t nPartSize        = sConvParams.nPartitionSize;
+            size_t off              = sStream.vOffsets[channel];
+            size_t head             = sStream.vHead[channel];
+            float *vInPart          = &sStream.vInPart[channel * nPartSize];
+
+            while ((count > 0) && (head < sStream.nLength))
+            {
+                // Skip the samples preceding the 0 time index
+                if (head < off)
+                {
+                    size_t to_do        = lsp_min(off - head, count);
+                    head               += to_do;
+                    src                += to_do;
+                    count              -= to_do;
+                    continue;
                 }
+
+                size_t pos          = (head - off) % nPartSize;
+                size_t to_do        = lsp_min(nPartSize - pos, lsp_min(count, sStream.nLength - head));
+
+                dsp::copy(&vInPart[pos], src, to_do);
+                head               += to_do;
+                src                += to_do;
+                count              -= to_do;
+
+                // Partition is complete, convolve it
+                if ((pos + to_do) >= nPartSize)
+                    stream_partition(channel, (head - off) / nPartSize - 1);
             }
 
-            // Normalising by square sample rate to recover physical units.
-            dsp::mul_k2(vResult, sChirpParams.fConvScale / (nSampleRate * nSampleRate), sConvParams.vConvLengths[channel]);
+            sStream.vHead[channel]  = head;
 
             return STATUS_OK;
         }
 
-        status_t SyncChirpProcessor::postprocess_linear_convolution(size_t channel, ssize_t offset, scp_rtcalc_t rtCalc, float windowSize, double tolerance)
+        status_t SyncChirpProcessor::end_streaming()
         {
-            if (pConvResult == NULL)
-                return STATUS_NO_DATA;
+            if (!sStream.bActive)
+                return STATUS_BAD_STATE;
 
-            if (channel >= sConvParams.nChannels)
-                return STATUS_BAD_ARGUMENTS;
+            size_t nPartSize        = sConvParams.nPartitionSize;
 
-            size_t dataLength = pConvResult->length();
-            if (dataLength == 0)
-                return STATUS_NO_DATA;
+            for (size_t ch = 0; ch < sConvParams.nChannels; ++ch)
+            {
+                size_t off              = sStream.vOffsets[ch];
+                size_t head             = sStream.vHead[ch];
+                if (head <= off)
+                    continue;
+
+                // Convolve the partial partition padded with zeros
+                size_t pos              = (head - off) % nPartSize;
+                if (pos == 0)
+                    continue;
+
+                float *vInPart          = &sStream.vInPart[ch * nPartSize];
+                dsp::fill_zero(&vInPart[pos], nPartSize - pos);
+                stream_partition(ch, (head - off) / nPartSize);
+            }
+
+            sStream.bActive         = false;
+
+            return STATUS_OK;
+        }
+
+        void SyncChirpProcessor::stream_partition(size_t channel, size_t index)
+        {
+            size_t nPartSize        = sConvParams.nPartitionSize;
+            float *vResult          = pConvResult->channel(channel);
+            float *vInPart          = &sStream.vInPart[channel * nPartSize];
+            float *dst              = &vResult[nPartSize * (index + sConvParams.vInversePrepends[channel] / nPartSize) + sConvParams.vAlignOffsets[channel]];
+
+            dsp::fastconv_parse(sConvParams.vInImage, vInPart, sConvParams.nConvRank);
 
+            const float *vInvImage  = sConvParams.vInvImages;
+            for (size_t invp = 0; invp < sConvParams.nInvImages; ++invp, vInvImage += sConvParams.nImage, dst += nPartSize)
+                dsp::fastconv_apply(dst, sConvParams.vTemp, sConvParams.vInImage, vInvImage, sConvParams.nConvRank);
+        }
+
+        void SyncChirpProcessor::locate_postprocessing_ranges(ssize_t offset, size_t *bgHead, size_t *bgCount, size_t *irHead)
+        {
+            size_t dataLength = pConvResult->length();
             size_t middle = (dataLength / 2) - 1;
 
             // Convert offset to unsigned, so to make safe operations with unsigned types
@@ -1562,7 +2105,25 @@ namespace lsp
                 irProcessHead       = middle - nOffset;
             }
 
-            irProcessHead           = (irProcessHead > middle) ? middle : irProcessHead;
+            *bgHead                 = bgProfileHead;
+            *bgCount                = bgProfileCount;
+            *irHead                 = (irProcessHead > middle) ? middle : irProcessHead;
+        }
+
+        status_t SyncChirpProcessor::postprocess_linear_convolution(size_t channel, ssize_t offset, scp_rtcalc_t rtCalc, float windowSize, double tolerance)
+        {
+            if (pConvResult == NULL)
+                return STATUS_NO_DATA;
+
+            if (channel >= sConvParams.nChannels)
+                return STATUS_BAD_ARGUMENTS;
+
+            size_t dataLength = pConvResult->length();
+            if (dataLength == 0)
+                return STATUS_NO_DATA;
+
+            size_t bgProfileHead, bgProfileCount, irProcessHead;
+            locate_postprocessing_ranges(offset, &bgProfileHead, &bgProfileCount, &irProcessHead);
 
             status_t returnValue;
 
@@ -1580,15 +2141,126 @@ namespace lsp
             return                    calculate_reverberation_time(channel, irProcessHead, rtCalc, sCRPostProc.nIrLimit);
         }
 
-        status_t SyncChirpProcessor::postprocess_nonlinear_convolution(size_t channel, size_t order, bool doInnerSmoothing, size_t nFadeIn, size_t nFadeOut, windows::window_t windowType, size_t nWindowRank)
+        status_t SyncChirpProcessor::calculate_reverberation_times(scp_rt_t *dst, const float *splits, size_t nsplits, size_t slope,
+                ssize_t offset, scp_rtcalc_t rtCalc, float windowSize, double tolerance)
+        {
+            if (pConvResult == NULL)
+                return STATUS_NO_DATA;
+
+            if ((dst == NULL) || ((nsplits > 0) && (splits == NULL)))
+                return STATUS_BAD_ARGUMENTS;
+
+            size_t dataLength = pConvResult->length();
+            if (dataLength == 0)
+                return STATUS_NO_DATA;
+
+            size_t bgProfileHead, bgProfileCount, irProcessHead;
+            locate_postprocessing_ranges(offset, &bgProfileHead, &bgProfileCount, &irProcessHead);
+            if (bgProfileHead >= (dataLength - bgProfileCount))
+                return STATUS_BAD_ARGUMENTS;
+
+            double decayThreshold, highRegLevel, lowRegLevel;
+            rt_thresholds(rtCalc, &decayThreshold, &highRegLevel, &lowRegLevel);
+
+            size_t bands            = nsplits + 1;
+            size_t window           = seconds_to_samples(nSampleRate, windowSize);
+            window                  = (window < ENVELOPE_BUF_LIMIT_SIZE) ? window : ENVELOPE_BUF_LIMIT_SIZE;
+
+            // The band signals start at the beginning of the background noise profiling range
+            size_t head             = lsp_min(bgProfileHead, irProcessHead);
+            size_t count            = dataLength - head;
+            size_t samples          = dataLength - irProcessHead;
+
+            size_t szof_ptrs        = align_size(bands * sizeof(float *), DEFAULT_ALIGN);
+            size_t szof_band        = align_size(count * sizeof(float), DEFAULT_ALIGN);
+            uint8_t *data           = NULL;
+            uint8_t *ptr            = alloc_aligned<uint8_t>(data, szof_ptrs + bands * szof_band);
+            if (ptr == NULL)
+                return STATUS_NO_MEM;
+
+            float **vBands          = reinterpret_cast<float **>(ptr);
+            ptr                    += szof_ptrs;
+            for (size_t i = 0; i < bands; ++i)
+            {
+                vBands[i]               = reinterpret_cast<float *>(ptr);
+                ptr                    += szof_band;
+            }
+
+            status_t res            = STATUS_OK;
+
+            for (size_t ch = 0; ch < sConvParams.nChannels; ++ch)
+            {
+                float *vResult          = pConvResult->channel(ch);
+                if (vResult == NULL)
+                {
+                    res                     = STATUS_BAD_ARGUMENTS;
+                    break;
+                }
+
+                // Split the channel into all bands in one pass, the crossover
+                // is created for each channel to start with the clean filter state
+                Crossover xover;
+                if (!xover.init(bands, RT_XOVER_BUF_SIZE))
+                {
+                    res                     = STATUS_NO_MEM;
+                    break;
+                }
+
+                xover.set_sample_rate(nSampleRate);
+                for (size_t i = 0; i < nsplits; ++i)
+                {
+                    xover.set_frequency(i, splits[i]);
+                    xover.set_slope(i, slope);
+                }
+                for (size_t i = 0; i < bands; ++i)
+                    dsp::fill_zero(vBands[i], count);
+
+                xover.process(vBands, &vResult[head], count);
+                xover.destroy();
+
+                for (size_t i = 0; i < bands; ++i)
+                {
+                    const float *vBand      = vBands[i];
+                    scp_rt_t *rt            = &dst[ch * bands + i];
+
+                    // Background noise of the band
+                    double noisePeak        = dsp::abs_max(&vBand[bgProfileHead - head], bgProfileCount);
+                    double noiseLevel       = ceil(20.0 * log10(noisePeak));
+                    double noiseValue       = exp(M_LN10 * 0.05 * noiseLevel);
+
+                    // Backwards integration limit and energy decay regression of the band
+                    const float *vData      = &vBand[irProcessHead - head];
+                    size_t limit            = find_integration_limit(vData, samples, window, noiseValue, noiseLevel, tolerance);
+
+                    decay_fit_t fit;
+                    fit_energy_decay(&fit, vEnvelopeBuffer, vData, limit, highRegLevel, lowRegLevel);
+
+                    double convolutionNorm  = (fit.fEnergy > 0.0) ? sqrt(nSampleRate / fit.fEnergy) : 0.0;
+                    double noiseLevelNorm   = 20.0 * log10(convolutionNorm * noiseValue);
+
+                    rt->fRT                 = samples_to_seconds(nSampleRate, rt_samples(&fit, decayThreshold));
+                    rt->fCorrelation        = fit.fCorrelation;
+                    rt->fIrLimit            = samples_to_seconds(nSampleRate, limit);
+                    rt->fNoiseLevel         = noiseLevelNorm;
+                    rt->bLowNoise           = (noiseLevelNorm < (lowRegLevel + BG_NOISE_LIMIT));
+                }
+            }
+
+            free_aligned(data);
+
+            return res;
+        }
+
+        status_t SyncChirpProcessor::postprocess_nonlinear_convolution(size_t channel, size_t order, bool doInnerSmoothing, size_t nFadeIn, size_t nFadeOut, windows::window_t windowType, size_t nWindowRank, size_t threads)
         {
             if (channel >= sConvParams.nChannels)
                 return STATUS_BAD_ARGUMENTS;
 
             sCRPostProc.nWinRank    = (nWindowRank < MAX_WINDOW_RANK) ? nWindowRank : MAX_WINDOW_RANK;
-            size_t nTaps            = 1 << nWindowRank;
+            size_t nTaps            = 1 << sCRPostProc.nWinRank;
+            size_t workers          = lsp_max(lsp_min(threads, nTaps), size_t(1));
 
-            status_t returnValue    = allocateIdentificationMatrices(order, nTaps);
+            status_t returnValue    = allocateIdentificationMatrices(order, nTaps, workers);
 
             if (returnValue != STATUS_OK)
                 return returnValue;
@@ -1725,6 +2397,41 @@ namespace lsp
         }
 
         status_t SyncChirpProcessor::save_to_lspc(const io::Path *path, ssize_t offset)
+        {
+            status_t res = begin_lspc_export(path, offset);
+            if (res != STATUS_OK)
+                return res;
+
+            while (true)
+            {
+                ssize_t written = export_lspc(LSPC_EXPORT_FRAMES);
+                if (written == 0)
+                    break;
+                if (written < 0)
+                {
+                    destroyExport();
+                    return status_t(-written);
+                }
+            }
+
+            return end_lspc_export();
+        }
+
+        status_t SyncChirpProcessor::begin_lspc_export(const char *path, ssize_t offset)
+        {
+            io::Path p;
+            status_t res = p.set(path);
+            return (res == STATUS_OK) ? begin_lspc_export(&p, offset) : res;
+        }
+
+        status_t SyncChirpProcessor::begin_lspc_export(const LSPString *path, ssize_t offset)
+        {
+            io::Path p;
+            status_t res = p.set(path);
+            return (res == STATUS_OK) ? begin_lspc_export(&p, offset) : res;
+        }
+
+        status_t SyncChirpProcessor::begin_lspc_export(const io::Path *path, ssize_t offset)
         {
             if (pConvResult == NULL)
                 return STATUS_NO_DATA;
@@ -1733,81 +2440,124 @@ namespace lsp
             if (dataLength == 0)
                 return STATUS_NO_DATA;
 
+            // Cancel the previous export
+            destroyExport();
+
+            // Figuring out the number of frames to skip
+            size_t skip = 0;
+
+            size_t middle       = dataLength / 2 - 1;
+            // We remove 1 now because, without offset, we skip all samples BEFORE the middle.
+            size_t skipNoOffset = middle - 1;
+            size_t maxAhead     = dataLength - skipNoOffset;
+
+            if (offset >= 0)
+            {
+                size_t nOffset  = offset;
+                nOffset         = (nOffset > maxAhead)? maxAhead : nOffset;
+                skip            = skipNoOffset + nOffset;
+            }
+            else
+            {
+                size_t nOffset  = -offset;
+                nOffset         = (nOffset > skipNoOffset)? skipNoOffset : nOffset;
+                skip            = skipNoOffset - nOffset;
+            }
+
             // Create chunk file
-            lspc::File fd;
-            lspc::AudioWriter aw;
-            lspc::audio_parameters_t p;
+            sExport.pFile       = new lspc::File();
+            sExport.pWriter     = new lspc::AudioWriter();
+            if ((sExport.pFile == NULL) || (sExport.pWriter == NULL))
+            {
+                destroyExport();
+                return STATUS_NO_MEM;
+            }
 
-            status_t res = fd.create(path);
+            status_t res = sExport.pFile->create(path);
             if (res != STATUS_OK)
             {
-                aw.close();
-                fd.close();
+                destroyExport();
                 return res;
             }
 
-            // Write complete convolution result as audio chunk
+            // The audio chunk holds the complete convolution result
+            lspc::audio_parameters_t p;
             p.channels          = sConvParams.nChannels;
-            p.sample_format     = __IF_LEBE(LSPC_SAMPLE_FMT_F32LE, LSPC_SAMPLE_FMT_F32BE);;
+            p.sample_format     = __IF_LEBE(LSPC_SAMPLE_FMT_F32LE, LSPC_SAMPLE_FMT_F32BE);
             p.sample_rate       = nSampleRate;
             p.codec             = LSPC_CODEC_PCM;
             p.frames            = dataLength;
 
-            res = aw.open(&fd, &p);
+            res = sExport.pWriter->open(sExport.pFile, &p);
             if (res != STATUS_OK)
             {
-                aw.close();
-                fd.close();
+                destroyExport();
                 return res;
             }
 
-            uint32_t audio_chunk_id = aw.unique_id();
-            const float **vp = reinterpret_cast<const float **>(alloca(sizeof(float *) * p.channels));
-            for (size_t i = 0, n = p.channels; i < n; ++i)
-                vp[i] = pConvResult->channel(i);
+            sExport.nFrames     = dataLength;
+            sExport.nWritten    = 0;
+            sExport.nSkip       = skip;
+            sExport.nChunkId    = sExport.pWriter->unique_id();
 
-            res = aw.write_samples(vp, dataLength);
-            if (res == STATUS_OK)
-                res = aw.close();
+            return STATUS_OK;
+        }
 
-            if (res != STATUS_OK)
-            {
-                aw.close();
-                fd.close();
-                return res;
-            }
+        ssize_t SyncChirpProcessor::export_lspc(size_t frames)
+        {
+            if (sExport.pWriter == NULL)
+                return -STATUS_BAD_STATE;
 
-            // Write profile data chunk
+            size_t to_do = lsp_min(frames, sExport.nFrames - sExport.nWritten);
+            if (to_do == 0)
+                return 0;
 
-            // Figuring out the number of frames to skip
-            size_t skip = 0;
+            // The frames are taken directly from the convolution result
+            size_t nchannels = sConvParams.nChannels;
+            const float **vp = reinterpret_cast<const float **>(alloca(sizeof(float *) * nchannels));
+            for (size_t i = 0; i < nchannels; ++i)
+                vp[i] = pConvResult->channel(i) + sExport.nWritten;
 
-            size_t middle       = dataLength / 2 - 1;
-            // We remove 1 now because, without offset, we skip all samples BEFORE the middle.
-            size_t skipNoOffset = middle - 1;
-            size_t maxAhead     = dataLength - skipNoOffset;
+            status_t res = sExport.pWriter->write_samples(vp, to_do);
+            if (res != STATUS_OK)
+                return -res;
 
-            if (offset >= 0)
+            sExport.nWritten   += to_do;
+            return to_do;
+        }
+
+        status_t SyncChirpProcessor::end_lspc_export()
+        {
+            if (sExport.pWriter == NULL)
+                return STATUS_BAD_STATE;
+
+            if (sExport.nWritten < sExport.nFrames)
             {
-                size_t nOffset  = offset;
-                nOffset         = (nOffset > maxAhead)? maxAhead : nOffset;
-                skip            = skipNoOffset + nOffset;
+                destroyExport();
+                return STATUS_BAD_STATE;
             }
-            else
+
+            status_t res = sExport.pWriter->close();
+            if (res != STATUS_OK)
             {
-                size_t nOffset  = -offset;
-                nOffset         = (nOffset > skipNoOffset)? skipNoOffset : nOffset;
-                skip            = skipNoOffset - nOffset;
+                destroyExport();
+                return res;
             }
 
-            lspc::ChunkWriter *wr = fd.write_chunk(LSPC_CHUNK_PROFILE);
+            // Write profile data chunk
+            lspc::ChunkWriter *wr = sExport.pFile->write_chunk(LSPC_CHUNK_PROFILE);
+            if (wr == NULL)
+            {
+                destroyExport();
+                return STATUS_NO_MEM;
+            }
 
             lspc::chunk_audio_profile_t prof;
             bzero(&prof, sizeof(lspc::chunk_audio_profile_t));
 
             prof.common.version     = 2;
             prof.common.size        = sizeof(lspc::chunk_audio_profile_t);
-            prof.chunk_id           = audio_chunk_id;
+            prof.chunk_id           = sExport.nChunkId;
             prof.chirp_order        = sChirpParams.nOrder;
             prof.alpha              = sChirpParams.fAlpha;
             prof.beta               = sChirpParams.beta;
@@ -1815,7 +2565,7 @@ namespace lsp
             prof.delta              = sChirpParams.delta;
             prof.initial_freq       = sChirpParams.initialFrequency;
             prof.final_freq         = sChirpParams.finalFrequency;
-            prof.skip               = skip;
+            prof.skip               = sExport.nSkip;
 
             // Convert header fields CPU -> BE
             prof.chunk_id           = CPU_TO_BE(prof.chunk_id);
@@ -1838,15 +2588,38 @@ namespace lsp
             {
                 wr->close();
                 delete wr;
-                fd.close();
+                destroyExport();
                 return res;
             }
-
             delete wr;
-            res = fd.close();
+
+            res = sExport.pFile->close();
+            destroyExport();
             return res;
         }
 
+        void SyncChirpProcessor::destroyExport()
+        {
+            if (sExport.pWriter != NULL)
+            {
+                sExport.pWriter->close();
+                delete sExport.pWriter;
+                sExport.pWriter = NULL;
+            }
+
+            if (sExport.pFile != NULL)
+            {
+                sExport.pFile->close();
+                delete sExport.pFile;
+                sExport.pFile   = NULL;
+            }
+
+            sExport.nFrames     = 0;
+            sExport.nWritten    = 0;
+            sExport.nSkip       = 0;
+            sExport.nChunkId    = 0;
+        }
+
         status_t SyncChirpProcessor::load_from_lspc(const char *path)
         {
             io::Path p;
@@ -1862,6 +2635,25 @@ namespace lsp
         }
 
         status_t SyncChirpProcessor::load_from_lspc(const io::Path *path)
+        {
+            return load_from_lspc(path, size_t(0), size_t(-1));
+        }
+
+        status_t SyncChirpProcessor::load_from_lspc(const char *path, size_t head, size_t count)
+        {
+            io::Path p;
+            status_t res = p.set(path);
+            return (res == STATUS_OK) ? load_from_lspc(&p, head, count) : res;
+        }
+
+        status_t SyncChirpProcessor::load_from_lspc(const LSPString *path, size_t head, size_t count)
+        {
+            io::Path p;
+            status_t res = p.set(path);
+            return (res == STATUS_OK) ? load_from_lspc(&p, head, count) : res;
+        }
+
+        status_t SyncChirpProcessor::load_from_lspc(const io::Path *path, size_t head, size_t count)
         {
             lspc::File fd;
             status_t res = fd.open(path);
@@ -1928,11 +2720,11 @@ namespace lsp
             }
             delete rd;
 
-            // Read audio chunk
+            // Read the audio chunk referenced by the profile
             lspc::AudioReader ar;
             lspc::audio_parameters_t p;
 
-            res = ar.open(&fd);
+            res = ar.open(&fd, chunk_id);
             if (res != STATUS_OK)
             {
                 fd.close();
@@ -1942,29 +2734,57 @@ namespace lsp
             res = ar.get_parameters(&p);
             if (res != STATUS_OK)
             {
+                ar.close();
                 fd.close();
                 return res;
             }
 
-            status_t status = allocateConvolutionResult(p.sample_rate, p.channels, p.frames);
+            if (head >= p.frames)
+            {
+                ar.close();
+                fd.close();
+                return STATUS_BAD_ARGUMENTS;
+            }
+            count = lsp_min(count, size_t(p.frames - head));
+
+            // Skip the frames before the range
+            while (head > 0)
+            {
+                ssize_t n_skip = ar.skip_frames(head);
+                if (n_skip <= 0)
+                {
+                    ar.close();
+                    fd.close();
+                    return (n_skip < 0) ? status_t(-n_skip) : STATUS_CORRUPTED_FILE;
+                }
+                head   -= n_skip;
+            }
+
+            status_t status = allocateConvolutionResult(p.sample_rate, p.channels, count);
             if (status != STATUS_OK)
             {
+                ar.close();
                 fd.close();
                 return status;
             }
 
+            // Read the range directly into the convolution result
             float **vp = reinterpret_cast<float **>(alloca(sizeof(float *) * p.channels));
             for (size_t i = 0, n = p.channels; i < n; ++i)
                 vp[i] = pConvResult->channel(i);
 
             size_t read = 0;
-            while (read < p.frames)
+            while (read < count)
             {
-                size_t to_read = p.frames - read;
-                if (to_read > p.frames)
-                    to_read = p.frames;
+                size_t to_read = lsp_min(count - read, size_t(LSPC_EXPORT_FRAMES));
 
                 ssize_t n_read = ar.read_samples(vp, to_read);
+                if (n_read <= 0)
+                {
+                    ar.close();
+                    fd.close();
+                    return (n_read < 0) ? status_t(-n_read) : STATUS_CORRUPTED_FILE;
+                }
 
                 read += n_read;
                 for (size_t i = 0, n = p.channels; i < n; ++i)
@@ -2257,16 +3077,47 @@ namespace lsp
                 v->write("vConvLengths", c->vConvLengths);
                 v->write("vAlignOffsets", c->vAlignOffsets);
                 v->write("pData", c->pData);
+                v->write("nWorkers", c->nWorkers);
+                v->write("nInvImages", c->nInvImages);
                 v->write("vInPart", c->vInPart);
                 v->write("vInvPart", c->vInvPart);
                 v->write("vInImage", c->vInImage);
-                v->write("vInvImage", c->vInvImage);
+                v->write("vInvImages", c->vInvImages);
                 v->write("vTemp", c->vTemp);
                 v->write("pTempData", c->pTempData);
+                v->write("pInvData", c->pInvData);
+                v->write("vJobData", c->vJobData);
+                v->write("vJobOffsets", c->vJobOffsets);
                 v->write("bReallocateTemp", c->bReallocateTemp);
             }
             v->end_object();
 
+            v->begin_object("sStream", &sStream, sizeof(stream_t));
+            {
+                const stream_t *c = &sStream;
+
+                v->write("nLength", c->nLength);
+                v->write("vOffsets", c->vOffsets);
+                v->write("vHead", c->vHead);
+                v->write("vInPart", c->vInPart);
+                v->write("pData", c->pData);
+                v->write("bActive", c->bActive);
+            }
+            v->end_object();
+
+            v->begin_object("sExport", &sExport, sizeof(export_t));
+            {
+                const export_t *c = &sExport;
+
+                v->write("pFile", c->pFile);
+                v->write("pWriter", c->pWriter);
+                v->write("nFrames", c->nFrames);
+                v->write("nWritten", c->nWritten);
+                v->write("nSkip", c->nSkip);
+                v->write("nChunkId", c->nChunkId);
+            }
+            v->end_object();
+
             v->begin_object("sCRPostProc", &sCRPostProc, sizeof(crpostproc_t));
             {
                 const crpostproc_t *c = &sCRPostProc;
@@ -2296,7 +3147,19 @@ namespace lsp
                 v->write("vTemprow1Im", c->vTemprow1Im);
                 v->write("vTemprow2Re", c->vTemprow2Re);
                 v->write("vTemprow2Im", c->vTemprow2Im);
+                v->write("nWorkers", c->nWorkers);
+                v->write("vWindow", c->vWindow);
+                v->write("enWindowType", int(c->enWindowType));
+                v->write("fCoeffsAlpha", c->fCoeffsAlpha);
+                v->write("bCoeffsValid", c->bCoeffsValid);
+                v->write("bWindowValid", c->bWindowValid);
                 v->write("pData", c->pData);
+                v->write("enStage", int(c->enStage));
+                v->write("nJobs", c->nJobs);
+                v->write("nJobChannel", c->nJobChannel);
+                v->write("bJobSmoothing", c->bJobSmoothing);
+                v->write("nJobFadeIn", c->nJobFadeIn);
+                v->write("nJobFadeOut", c->nJobFadeOut);
             }
             v->end_object();
 
@@ -0,0 +1,311 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/dsp-units/util/TailConvolver.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/bits.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+namespace lsp
+{
+    namespace dspu
+    {
+        TailConvolver::TailConvolver()
+        {
+            construct();
+        }
+
+        TailConvolver::~TailConvolver()
+        {
+            destroy();
+        }
+
+        void TailConvolver::construct()
+        {
+            sHead.construct();
+            sTail.construct();
+            sDown.construct();
+            sUp.construct();
+
+            vIn             = NULL;
+            vDec            = NULL;
+            vDecOut         = NULL;
+            vOut            = NULL;
+            nFactor         = 0;
+            nSplit          = 0;
+            nDelay          = 0;
+            nInFill         = 0;
+            nOutFill        = 0;
+            nConvSize       = 0;
+
+            pData           = NULL;
+        }
+
+        void TailConvolver::destroy()
+        {
+            sHead.destroy();
+            sTail.destroy();
+            sDown.destroy();
+            sUp.destroy();
+
+            free_aligned(pData);
+            pData           = NULL;
+
+            vIn             = NULL;
+            vDec            = NULL;
+            vDecOut         = NULL;
+            vOut            = NULL;
+            nFactor         = 0;
+            nSplit          = 0;
+            nDelay          = 0;
+            nInFill         = 0;
+            nOutFill        = 0;
+            nConvSize       = 0;
+        }
+
+        static bool init_resampler(Oversampler *os, over_mode_t mode)
+        {
+            if (!os->init())
+                return false;
+            os->set_transition(0);
+            os->set_filtering(false);
+            os->set_mode(mode);
+            os->update_settings();
+            return true;
+        }
+
+        ssize_t TailConvolver::measure_delay(over_mode_t mode)
+        {
+            // Pass the impulse through the decimation and interpolation and find the peak
+            Oversampler down, up;
+            if ((!init_resampler(&down, mode)) || (!init_resampler(&up, mode)))
+                return -1;
+
+            size_t factor   = down.get_oversampling();
+            size_t dec      = down.max_latency() * 2 + 0x40;
+            size_t len      = dec * factor;
+
+            uint8_t *data   = NULL;
+            float *in       = alloc_aligned<float>(data, len * 2 + dec);
+            if (in == NULL)
+                return -1;
+            float *out      = &in[len];
+            float *tmp      = &out[len];
+
+            dsp::fill_zero(in, len);
+            in[0]           = 1.0f;
+            down.downsample(tmp, in, dec);
+            up.upsample(out, tmp, dec);
+            ssize_t delay   = dsp::abs_max_index(out, len);
+
+            free_aligned(data);
+            return delay;
+        }
+
+        void TailConvolver::decimate(float *dst, size_t dst_count, const float *src, size_t src_count, size_t factor)
+        {
+            // Sample the band-limited impulse response at the decimated rate:
+            //   dst[m] = sum { src[k] * L((m*factor - k) / factor) }
+            // where L is the Lanczos kernel, the gain of the decimated convolution is preserved
+            ssize_t radius  = TAIL_CONVOLVER_LANCZOS * factor;
+            float kx        = 1.0f / factor;
+            float ka        = 1.0f / TAIL_CONVOLVER_LANCZOS;
+
+            for (size_t m=0; m<dst_count; ++m)
+            {
+                ssize_t center  = m * factor;
+                ssize_t first   = lsp_max(center - radius + 1, ssize_t(0));
+                ssize_t last    = lsp_min(center + radius, ssize_t(src_count));
+                float sum       = 0.0f;
+
+                for (ssize_t k=first; k<last; ++k)
+                {
+                    if (src[k] == 0.0f)
+                        continue;
+                    float x         = M_PI * (center - k) * kx;
+                    float w         = (center == k) ? 1.0f : sinf(x) * sinf(x * ka) / (x * x * ka);
+                    sum            += src[k] * w;
+                }
+
+                dst[m]          = sum;
+            }
+        }
+
+        bool TailConvolver::init(const float *data, size_t count, size_t split, size_t factor, size_t rank, bool background)
+        {
+            destroy();
+            nConvSize       = count;
+
+            // Check that the tail can be decimated
+            over_mode_t mode    =
+                (factor >= 8) ? OM_HALFBAND_8X :
+                (factor >= 4) ? OM_HALFBAND_4X :
+                (factor >= 2) ? OM_HALFBAND_2X : OM_NONE;
+            if ((mode == OM_NONE) || (split >= count))
+            {
+                nSplit          = count;
+                return sHead.init(data, count, rank, 0.0f, background);
+            }
+
+            // The tail is delayed by the resampling and by the buffering of the decimated samples
+            ssize_t delay   = measure_delay(mode);
+            if (delay < 0)
+                return false;
+            if ((!init_resampler(&sDown, mode)) || (!init_resampler(&sUp, mode)))
+                return false;
+            factor          = sDown.get_oversampling();
+            delay          += factor - 1;
+
+            split           = lsp_max(split, size_t(delay));
+            if (split >= count)
+            {
+                sDown.destroy();
+                sUp.destroy();
+                nSplit          = count;
+                return sHead.init(data, count, rank, 0.0f, background);
+            }
+
+            // Allocate buffers
+            size_t tail_len = count - delay;                                    // Tail shifted by the delay
+            size_t dec_len  = (tail_len + factor - 1) / factor + TAIL_CONVOLVER_LANCZOS;
+            size_t dec_buf  = TAIL_CONVOLVER_BUF_SIZE / factor;
+            size_t allocate = TAIL_CONVOLVER_BUF_SIZE +                         // vIn
+                              dec_buf * 2 +                                     // vDec, vDecOut
+                              TAIL_CONVOLVER_BUF_SIZE + factor;                 // vOut
+            size_t tmp_size = tail_len + dec_len;
+
+            uint8_t *tmp_data   = NULL;
+            float *tmp      = alloc_aligned<float>(tmp_data, tmp_size);
+            if (tmp == NULL)
+                return false;
+            float *ptr      = alloc_aligned<float>(pData, allocate);
+            if (ptr == NULL)
+            {
+                free_aligned(tmp_data);
+                return false;
+            }
+            dsp::fill_zero(ptr, allocate);
+
+            vIn             = ptr;
+            ptr            += TAIL_CONVOLVER_BUF_SIZE;
+            vDec            = ptr;
+            ptr            += dec_buf;
+            vDecOut         = ptr;
+            ptr            += dec_buf;
+            vOut            = ptr;
+            ptr            += TAIL_CONVOLVER_BUF_SIZE + factor;
+
+            // Build the decimated tail: the part of the impulse response after the split
+            // point, shifted by the delay of processing chain
+            float *tail     = tmp;
+            float *dec      = &tmp[tail_len];
+            size_t head     = split - delay;
+            dsp::fill_zero(tail, head);
+            dsp::copy(&tail[head], &data[split], count - split);
+            decimate(dec, dec_len, tail, tail_len, factor);
+
+            // Initialize convolvers
+            size_t tail_rank    = lsp_max(ssize_t(rank) - ssize_t(int_log2(factor)), ssize_t(CONVOLVER_RANK_MIN));
+            bool res        =
+                (sHead.init(data, split, rank, 0.0f, background)) &&
+                (sTail.init(dec, dec_len, tail_rank, 0.0f, background));
+            free_aligned(tmp_data);
+            if (!res)
+            {
+                destroy();
+                nConvSize       = count;
+                return false;
+            }
+
+            nFactor         = factor;
+            nSplit          = split;
+            nDelay          = delay;
+            nInFill         = 0;
+            nOutFill        = factor - 1;           // The buffering delay of decimated samples
+
+            return true;
+        }
+
+        void TailConvolver::process(float *dst, const float *src, size_t count)
+        {
+            if (nFactor == 0)
+            {
+                sHead.process(dst, src, count);
+                return;
+            }
+
+            while (count > 0)
+            {
+                // Store the input before the head overwrites it
+                size_t to_do    = lsp_min(count, TAIL_CONVOLVER_BUF_SIZE - nInFill);
+                dsp::copy(&vIn[nInFill], src, to_do);
+                nInFill        += to_do;
+                sHead.process(dst, src, to_do);
+
+                // Process the complete decimated samples
+                size_t blocks   = nInFill / nFactor;
+                if (blocks > 0)
+                {
+                    size_t n        = blocks * nFactor;
+                    sDown.downsample(vDec, vIn, blocks);
+                    sTail.process(vDecOut, vDec, blocks);
+                    sUp.upsample(&vOut[nOutFill], vDecOut, blocks);
+                    nOutFill       += n;
+
+                    nInFill        -= n;
+                    dsp::move(vIn, &vIn[n], nInFill);
+                }
+
+                // Mix the tail to the output
+                dsp::add2(dst, vOut, to_do);
+                nOutFill       -= to_do;
+                dsp::move(vOut, &vOut[to_do], nOutFill);
+
+                dst            += to_do;
+                src            += to_do;
+                count          -= to_do;
+            }
+        }
+
+        void TailConvolver::dump(IStateDumper *v) const
+        {
+            v->write_object("sHead", &sHead);
+            v->write_object("sTail", &sTail);
+            v->write_object("sDown", &sDown);
+            v->write_object("sUp", &sUp);
+
+            v->write("vIn", vIn);
+            v->write("vDec", vDec);
+            v->write("vDecOut", vDecOut);
+            v->write("vOut", vOut);
+            v->write("nFactor", nFactor);
+            v->write("nSplit", nSplit);
+            v->write("nDelay", nDelay);
+            v->write("nInFill", nInFill);
+            v->write("nOutFill", nOutFill);
+            v->write("nConvSize", nConvSize);
+
+            v->write("pData", pData);
+        }
+    } /* namespace dspu */
+} /* namespace lsp */
@@ -23,6 +23,7 @@
 #include <lsp-plug.in/dsp/dsp.h>
 
 #define MEM_LIM_SIZE            16
+#define SCAN_BLOCK_SIZE         64          // Size of the sub-block checked for possible state changes
 
 namespace lsp
 {
@@ -231,6 +232,122 @@ namespace lsp
             fPrevious = value;
         }
 
+        bool Trigger::skip_block(const float *src, size_t count)
+        {
+            // The hold time is not elapsed for all samples of the block
+            bool hold           = nTriggerHoldCounter + count <= nTriggerHold;
+            float vmin, vmax;
+
+            switch (enTriggerType)
+            {
+                case TRG_TYPE_SIMPLE_RISING_EDGE:
+                    if (!hold)
+                    {
+                        dsp::minmax(src, count, &vmin, &vmax);
+                        if (vmax >= sSimpleTrg.fThreshold)
+                            return false;
+                    }
+                    enTriggerState      = TRG_STATE_WAITING;
+                    break;
+
+                case TRG_TYPE_SIMPLE_FALLING_EDGE:
+                    if (!hold)
+                    {
+                        dsp::minmax(src, count, &vmin, &vmax);
+                        if (vmin <= sSimpleTrg.fThreshold)
+                            return false;
+                    }
+                    enTriggerState      = TRG_STATE_WAITING;
+                    break;
+
+                case TRG_TYPE_ADVANCED_RISING_EDGE:
+                case TRG_TYPE_ADVANCED_FALLING_EDGE:
+                {
+                    // The armed trigger may fire regardless of the hold time, check the levels only
+                    dsp::minmax(src, count, &vmin, &vmax);
+
+                    bool disarm, sustain;
+                    if (enTriggerType == TRG_TYPE_ADVANCED_RISING_EDGE)
+                    {
+                        disarm      = vmax < sAdvancedTrg.fLowerThreshold;
+                        sustain     = (vmin >= sAdvancedTrg.fUpperThreshold) && (fPrevious >= sAdvancedTrg.fUpperThreshold);
+                    }
+                    else
+                    {
+                        disarm      = vmin > sAdvancedTrg.fUpperThreshold;
+                        sustain     = (vmax <= sAdvancedTrg.fLowerThreshold) && (fPrevious <= sAdvancedTrg.fLowerThreshold);
+                    }
+
+                    if (disarm)
+                    {
+                        // Each sample disarms the trigger, the next one resets the state
+                        if ((sAdvancedTrg.bDisarm) || (count > 1))
+                            enTriggerState      = TRG_STATE_WAITING;
+                        sAdvancedTrg.bDisarm    = true;
+                    }
+                    else if (sustain)
+                    {
+                        // The signal stays beyond the far threshold, only the pending disarm is applied
+                        if (sAdvancedTrg.bDisarm)
+                            enTriggerState      = TRG_STATE_WAITING;
+                        sAdvancedTrg.bDisarm    = false;
+                    }
+                    else
+                        return false;
+                    break;
+                }
+
+                case TRG_TYPE_NONE:
+                default:
+                    if (!hold)
+                        return false;
+                    enTriggerState      = TRG_STATE_WAITING;
+                    break;
+            }
+
+            nTriggerHoldCounter    += count;
+            fPrevious               = src[count - 1];
+
+            return true;
+        }
+
+        size_t Trigger::process(uint32_t *events, const float *src, size_t count)
+        {
+            size_t fired = 0;
+
+            for (size_t offset=0; offset < count; )
+            {
+                size_t to_do = lsp_min(count - offset, size_t(SCAN_BLOCK_SIZE));
+
+                // The locked trigger does not process samples at all
+                if (locked())
+                {
+                    enTriggerState      = TRG_STATE_WAITING;
+                    break;
+                }
+
+                if (skip_block(&src[offset], to_do))
+                {
+                    offset             += to_do;
+                    continue;
+                }
+
+                // Possible state change, run the state machine for the whole sub-block
+                for (size_t i=0; i<to_do; ++i, ++offset)
+                {
+                    single_sample_processor(src[offset]);
+                    if (enTriggerState != TRG_STATE_FIRED)
+                        continue;
+
+                    if (events != NULL)
+                        events[fired]       = offset;
+                    ++fired;
+                }
+            }
+
+            return fired;
+        }
+
         void Trigger::dump(IStateDumper *v) const
         {
             v->write("fpRevious", fPrevious);
@@ -0,0 +1,233 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/dsp-units/util/WorkerPool.h>
+#include <lsp-plug.in/dsp-units/util/PerfCounter.h>
+#include <lsp-plug.in/ipc/Thread.h>
+
+#define WORKER_SPIN_CHECK       0x100       /* Number of spins between checks of time */
+
+namespace lsp
+{
+    namespace dspu
+    {
+        class WorkerPool::Worker: public ipc::Thread
+        {
+            private:
+                WorkerPool         *pPool;
+                volatile bool       bCancel;
+
+            public:
+                explicit Worker(WorkerPool *pool)
+                {
+                    pPool       = pool;
+                    bCancel     = false;
+                }
+
+                virtual ~Worker()
+                {
+                }
+
+            public:
+                inline void         stop()      { bCancel = true; }
+
+                virtual status_t run()
+                {
+                    atomic_t gen        = atomic_add(&pPool->nGeneration, 0);
+                    uint64_t spin       = uint64_t(pPool->nSpinTime) * 1000;
+                    uint64_t idle       = PerfCounter::timestamp();
+                    size_t counter      = 0;
+
+                    while (!bCancel)
+                    {
+                        atomic_t next       = atomic_add(&pPool->nGeneration, 0);
+                        if (next != gen)
+                        {
+                            // New job has been published
+                            gen                 = next;
+                            pPool->work(gen);
+                            idle                = PerfCounter::timestamp();
+                            counter             = 0;
+                            continue;
+                        }
+
+                        // Spin for a while, then fall asleep
+                        if ((++counter) < WORKER_SPIN_CHECK)
+                            continue;
+                        counter             = 0;
+                        if ((PerfCounter::timestamp() - idle) > spin)
+                            ipc::Thread::sleep(1);
+                    }
+
+                    return STATUS_OK;
+                }
+        };
+
+        WorkerPool::WorkerPool()
+        {
+            construct();
+        }
+
+        WorkerPool::~WorkerPool()
+        {
+            destroy();
+        }
+
+        void WorkerPool::construct()
+        {
+            vWorkers        = NULL;
+            nWorkers        = 0;
+            nSpinTime       = 0;
+
+            pFunc           = NULL;
+            pObject         = NULL;
+            nTasks          = 0;
+            nGeneration     = 0;
+            nNext           = 0;
+            nDone           = 0;
+            nActive         = 0;
+        }
+
+        status_t WorkerPool::init(size_t workers, size_t spin_time)
+        {
+            destroy();
+
+            nSpinTime       = spin_time;
+            if (workers <= 0)
+                return STATUS_OK;
+
+            vWorkers        = new Worker *[workers];
+            if (vWorkers == NULL)
+                return STATUS_NO_MEM;
+
+            for (size_t i=0; i<workers; ++i)
+            {
+                Worker *w       = new Worker(this);
+                if (w == NULL)
+                {
+                    destroy();
+                    return STATUS_NO_MEM;
+                }
+
+                status_t res    = w->start();
+                if (res != STATUS_OK)
+                {
+                    delete w;
+                    destroy();
+                    return res;
+                }
+
+                vWorkers[nWorkers++]    = w;
+            }
+
+            return STATUS_OK;
+        }
+
+        void WorkerPool::destroy()
+        {
+            if (vWorkers != NULL)
+            {
+                for (size_t i=0; i<nWorkers; ++i)
+                    vWorkers[i]->stop();
+                for (size_t i=0; i<nWorkers; ++i)
+                {
+                    vWorkers[i]->join();
+                    delete vWorkers[i];
+                }
+                delete [] vWorkers;
+                vWorkers        = NULL;
+            }
+
+            nWorkers        = 0;
+        }
+
+        void WorkerPool::run_tasks()
+        {
+            while (true)
+            {
+                size_t task     = atomic_add(&nNext, 1);
+                if (task >= nTasks)
+                    break;
+
+                pFunc(pObject, task);
+                atomic_add(&nDone, 1);
+            }
+        }
+
+        bool WorkerPool::work(atomic_t generation)
+        {
+            // Register as active and check that the job is still the same,
+            // the job can not be replaced while there are active workers
+            atomic_add(&nActive, 1);
+            bool valid      = atomic_add(&nGeneration, 0) == generation;
+            if (valid)
+                run_tasks();
+            atomic_add(&nActive, -1);
+
+            return valid;
+        }
+
+        void WorkerPool::execute(worker_task_t func, void *object, size_t tasks)
+        {
+            if (tasks <= 0)
+                return;
+
+            // Process all tasks in the calling thread if there are no workers
+            if ((nWorkers <= 0) || (tasks <= 1))
+            {
+                for (size_t i=0; i<tasks; ++i)
+                    func(object, i);
+                return;
+            }
+
+            // Wait until late workers leave the previous job
+            while (atomic_add(&nActive, 0) != 0)
+                /* spin */ ;
+
+            // Publish the job
+            pFunc           = func;
+            pObject         = object;
+            nTasks          = tasks;
+            atomic_swap(&nNext, 0);
+            atomic_swap(&nDone, 0);
+            atomic_add(&nGeneration, 1);
+
+            // Take part in execution and wait for tasks taken by workers
+            run_tasks();
+            while (size_t(atomic_add(&nDone, 0)) < tasks)
+                /* spin */ ;
+        }
+
+        void WorkerPool::dump(IStateDumper *v) const
+        {
+            v->write("vWorkers", vWorkers);
+            v->write("nWorkers", nWorkers);
+            v->write("nSpinTime", nSpinTime);
+            v->write("pObject", pObject);
+            v->write("nTasks", nTasks);
+            v->write("nGeneration", int32_t(nGeneration));
+            v->write("nNext", int32_t(nNext));
+            v->write("nDone", int32_t(nDone));
+            v->write("nActive", int32_t(nActive));
+        }
+    } /* namespace dspu */
+} /* namespace lsp */
@@ -21,12 +21,14 @@
 
 #include <lsp-plug.in/test-fw/init.h>
 #include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/dsp-units/misc/kernels.h>
 
 INIT_BEGIN(test_initializer)
 
     INIT_FUNC
     {
         dsp::init();
+        lsp::dspu::kernels::init();
     }
 
 INIT_END
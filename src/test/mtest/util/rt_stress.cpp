@@ -0,0 +1,342 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/mtest.h>
+#include <lsp-plug.in/dsp-units/dynamics/Limiter.h>
+#include <lsp-plug.in/dsp-units/filters/Equalizer.h>
+#include <lsp-plug.in/dsp-units/util/Analyzer.h>
+#include <lsp-plug.in/dsp-units/util/Convolver.h>
+#include <lsp-plug.in/dsp-units/util/PerfCounter.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/io/Path.h>
+#include <lsp-plug.in/ipc/Thread.h>
+#include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/stdlib/string.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#include <stdlib.h>
+
+#define SRATE           48000
+#define BLOCK_SIZE      256
+#define DURATION        10              /* Duration of the simulated session in seconds */
+#define SPLIT_PERIOD    16              /* Each SPLIT_PERIOD'th callback is split by automation event */
+#define IR_SIZE         (SRATE * 2)
+#define HIST_STEPS      4               /* Number of histogram buckets per octave */
+#define HIST_BUCKETS    (HIST_STEPS * 20)
+#define WORST_RATIO     20.0            /* Maximum allowed worst-case to average ratio */
+
+namespace
+{
+    using namespace lsp;
+
+    /**
+     * The unit driven by the harness
+     */
+    class Subject
+    {
+        public:
+            virtual ~Subject() {}
+
+        public:
+            virtual const char *name() const = 0;
+            virtual bool        init() = 0;
+            virtual void        automate(size_t block) = 0;
+            virtual void        process(float *out, const float *in, size_t samples) = 0;
+            virtual void        destroy() = 0;
+    };
+
+    class EqualizerSubject: public Subject
+    {
+        private:
+            dspu::Equalizer     sEq;
+
+        protected:
+            void set_filter(size_t id, float gain)
+            {
+                dspu::filter_params_t fp;
+                fp.nType    = dspu::FLT_BT_RLC_BELL;
+                fp.fFreq    = 40.0f * (1 << id);
+                fp.fFreq2   = fp.fFreq;
+                fp.fGain    = gain;
+                fp.nSlope   = 2;
+                fp.fQuality = 0.5f;
+                sEq.set_params(id, &fp);
+            }
+
+        public:
+            virtual const char *name() const    { return "equalizer"; }
+
+            virtual bool init()
+            {
+                if (!sEq.init(8, 12))
+                    return false;
+                sEq.set_mode(dspu::EQM_FIR);
+                sEq.set_sample_rate(SRATE);
+                for (size_t i=0; i<8; ++i)
+                    set_filter(i, 1.0f);
+                return true;
+            }
+
+            virtual void automate(size_t block)
+            {
+                // Slow knob movement: rebuild of the FIR kernel each 64 blocks
+                if ((block % 64) == 0)
+                    set_filter((block / 64) % 8, 0.5f + ((block / 64) & 1));
+            }
+
+            virtual void process(float *out, const float *in, size_t samples)
+            {
+                sEq.process(out, in, samples);
+            }
+
+            virtual void destroy()              { sEq.destroy(); }
+    };
+
+    class ConvolverSubject: public Subject
+    {
+        private:
+            dspu::Convolver     sConv;
+            uint8_t            *pData;
+
+        public:
+            explicit ConvolverSubject()         { pData = NULL; }
+
+            virtual const char *name() const    { return "convolver"; }
+
+            virtual bool init()
+            {
+                float *ir       = alloc_aligned<float>(pData, IR_SIZE, 64);
+                if (ir == NULL)
+                    return false;
+                for (size_t i=0; i<IR_SIZE; ++i)
+                    ir[i]           = (float(rand()) / RAND_MAX - 0.5f) * expf(-5.0f * i / IR_SIZE);
+
+                return sConv.init(ir, IR_SIZE, 10, 0.0f);
+            }
+
+            virtual void automate(size_t block) {}
+
+            virtual void process(float *out, const float *in, size_t samples)
+            {
+                sConv.process(out, in, samples);
+            }
+
+            virtual void destroy()
+            {
+                sConv.destroy();
+                free_aligned(pData);
+            }
+    };
+
+    class LimiterSubject: public Subject
+    {
+        private:
+            dspu::Limiter       sLimiter;
+
+        public:
+            virtual const char *name() const    { return "limiter"; }
+
+            virtual bool init()
+            {
+                if (!sLimiter.init(SRATE, 20.0f))
+                    return false;
+                sLimiter.set_sample_rate(SRATE);
+                sLimiter.set_mode(dspu::LM_HERM_THIN);
+                sLimiter.set_threshold(0.5f, true);
+                sLimiter.set_attack(1.5f);
+                sLimiter.set_release(10.0f);
+                sLimiter.set_lookahead(5.0f);
+                return true;
+            }
+
+            virtual void automate(size_t block)
+            {
+                // Preset change: burst of parameter updates during 8 blocks each 128 blocks
+                size_t phase    = block % 128;
+                if (phase >= 8)
+                    return;
+                sLimiter.set_threshold(0.25f + phase * 0.05f, false);
+                sLimiter.set_attack(1.0f + phase * 0.5f);
+                sLimiter.set_lookahead(2.0f + phase);
+                sLimiter.set_mode(dspu::limiter_mode_t(phase + dspu::LM_HERM_THIN));
+            }
+
+            virtual void process(float *out, const float *in, size_t samples)
+            {
+                sLimiter.process(out, &out[BLOCK_SIZE], in, in, samples);
+            }
+
+            virtual void destroy()              { sLimiter.destroy(); }
+    };
+
+    class AnalyzerSubject: public Subject
+    {
+        private:
+            dspu::Analyzer      sAnalyzer;
+
+        public:
+            virtual const char *name() const    { return "analyzer"; }
+
+            virtual bool init()
+            {
+                if (!sAnalyzer.init(1, 14, SRATE, 20.0f))
+                    return false;
+                sAnalyzer.set_sample_rate(SRATE);
+                sAnalyzer.set_rank(13);
+                sAnalyzer.set_rate(20.0f);
+                sAnalyzer.set_reactivity(0.2f);
+                return true;
+            }
+
+            virtual void automate(size_t block)
+            {
+                // Change of the FFT rank by the user each 512 blocks
+                if ((block % 512) == 0)
+                    sAnalyzer.set_rank(12 + ((block / 512) & 1));
+            }
+
+            virtual void process(float *out, const float *in, size_t samples)
+            {
+                sAnalyzer.process(&in, samples);
+                dsp::copy(out, in, samples);
+            }
+
+            virtual void destroy()              { sAnalyzer.destroy(); }
+    };
+
+    static int cmp_time(const void *a, const void *b)
+    {
+        uint64_t ta = *static_cast<const uint64_t *>(a);
+        uint64_t tb = *static_cast<const uint64_t *>(b);
+        return (ta < tb) ? -1 : (ta > tb) ? 1 : 0;
+    }
+}
+
+MTEST_BEGIN("dspu.util", rt_stress)
+
+    void run(Subject *s, float *out, const float *in, uint64_t *times, size_t blocks, bool paced, size_t *failed)
+    {
+        size_t hist[HIST_BUCKETS];
+        for (size_t i=0; i<HIST_BUCKETS; ++i)
+            hist[i]         = 0;
+
+        MTEST_ASSERT(s->init());
+
+        // Simulate the callbacks of the host
+        uint64_t period     = uint64_t(BLOCK_SIZE) * 1000000000ULL / SRATE;
+        uint64_t deadline   = dspu::PerfCounter::timestamp();
+
+        for (size_t i=0; i<blocks; ++i)
+        {
+            uint64_t start      = dspu::PerfCounter::timestamp();
+
+            // The host splits the callback at the sample-accurate automation event
+            if ((i % SPLIT_PERIOD) == 0)
+            {
+                size_t split        = (i * 37) % BLOCK_SIZE;
+                s->process(out, in, split);
+                s->automate(i);
+                s->process(&out[split], &in[split], BLOCK_SIZE - split);
+            }
+            else
+            {
+                s->automate(i);
+                s->process(out, in, BLOCK_SIZE);
+            }
+
+            uint64_t end        = dspu::PerfCounter::timestamp();
+            times[i]            = end - start;
+
+            // Wait for the next callback
+            deadline           += period;
+            if ((paced) && (deadline > end))
+                ipc::Thread::sleep((deadline - end) / 1000000);
+        }
+
+        s->destroy();
+
+        // Compute the statistics
+        double mean         = 0.0;
+        for (size_t i=0; i<blocks; ++i)
+        {
+            mean               += times[i];
+            ssize_t idx         = (times[i] > 1000) ? ssize_t(HIST_STEPS * log2(times[i] * 1e-3)) : 0;
+            ++hist[lsp_limit(idx, ssize_t(0), ssize_t(HIST_BUCKETS - 1))];
+        }
+        mean               /= blocks;
+
+        io::Path path;
+        MTEST_ASSERT(path.fmt("%s/rt_stress-%s.csv", tempdir(), s->name()) > 0);
+        FILE *fd = fopen(path.as_native(), "w");
+        MTEST_ASSERT(fd != NULL);
+        fprintf(fd, "time_us;blocks\n");
+        for (size_t i=0; i<HIST_BUCKETS; ++i)
+            fprintf(fd, "%.2f;%d\n", exp2(double(i) / HIST_STEPS), int(hist[i]));
+        fclose(fd);
+
+        qsort(times, blocks, sizeof(uint64_t), cmp_time);
+        double p999         = times[(blocks * 999) / 1000];
+        double worst        = times[blocks - 1];
+        double ratio        = worst / lsp_max(mean, 1.0);
+        double budget       = double(BLOCK_SIZE) * 1e+6 / SRATE;
+
+        printf("%-12s: mean=%.2f us, p99.9=%.2f us, max=%.2f us, max/mean=%.1f, budget=%.2f us %s\n",
+            s->name(), mean * 1e-3, p999 * 1e-3, worst * 1e-3, ratio, budget,
+            (ratio > WORST_RATIO) ? "[WORST CASE EXCEEDED]" : "");
+        printf("  histogram: %s\n", path.as_native());
+
+        if (ratio > WORST_RATIO)
+            ++(*failed);
+    }
+
+    MTEST_MAIN
+    {
+        // Pass "paced" argument to wait for the next callback like the real host does
+        bool paced          = (argc > 0) && (!strcmp(argv[0], "paced"));
+        size_t blocks       = (DURATION * SRATE) / BLOCK_SIZE;
+
+        uint8_t *data       = NULL;
+        float *in           = alloc_aligned<float>(data, BLOCK_SIZE * 3, 64);
+        float *out          = &in[BLOCK_SIZE];
+        uint64_t *times     = static_cast<uint64_t *>(malloc(blocks * sizeof(uint64_t)));
+        MTEST_ASSERT(in != NULL);
+        MTEST_ASSERT(times != NULL);
+
+        for (size_t i=0; i<BLOCK_SIZE; ++i)
+            in[i]               = float(rand()) / RAND_MAX - 0.5f;
+
+        EqualizerSubject eq;
+        ConvolverSubject conv;
+        LimiterSubject lim;
+        AnalyzerSubject an;
+        Subject *list[] = { &eq, &conv, &lim, &an };
+
+        size_t failed       = 0;
+        for (size_t i=0; i<sizeof(list)/sizeof(Subject *); ++i)
+            run(list[i], out, in, times, blocks, paced, &failed);
+
+        printf("%d unit(s) exceed the worst-case to average ratio of %.1f\n", int(failed), WORST_RATIO);
+
+        free(times);
+        free_aligned(data);
+    }
+
+MTEST_END
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/ptest.h>
+#include <lsp-plug.in/dsp-units/3d/rt/context.h>
+#include <lsp-plug.in/dsp-units/3d/rt/bvh.h>
+#include <lsp-plug.in/lltl/darray.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#define GRID_MIN            16
+#define GRID_MAX            256
+
+namespace
+{
+    using namespace lsp;
+
+    typedef struct scene_t
+    {
+        lltl::darray<rtx::triangle_t>   mesh;
+        lltl::darray<rtx::edge_t>       plan;
+        dspu::rt::bvh_t                 bvh;
+    } scene_t;
+
+    static void add_triangle(scene_t *s, rtx::edge_t *e, size_t face,
+        const dsp::point3d_t *p0, const dsp::point3d_t *p1, const dsp::point3d_t *p2)
+    {
+        rtx::triangle_t *t  = s->mesh.add();
+        t->v[0]     = *p0;
+        t->v[1]     = *p1;
+        t->v[2]     = *p2;
+        dsp::calc_plane_pv(&t->n, t->v);
+        t->oid      = 0;
+        t->face     = face;
+        t->m        = NULL;
+
+        for (size_t i=0; i<3; ++i)
+        {
+            e[i].v[0]   = t->v[i];
+            e[i].v[1]   = t->v[(i+1) % 3];
+            e[i].itag   = 0;
+            t->e[i]     = &e[i];
+        }
+    }
+
+    static bool generate_scene(scene_t *s, size_t n)
+    {
+        dsp::point3d_t p[4];
+        float step      = 100.0f / n;
+
+        rtx::edge_t *e  = s->plan.append_n(n * n * 6);
+        if (e == NULL)
+            return false;
+
+        // Generate flat grid of quads at the floor level
+        for (size_t i=0; i<n; ++i)
+            for (size_t j=0; j<n; ++j)
+            {
+                float x     = -50.0f + j * step;
+                float y     = -50.0f + i * step;
+                dsp::init_point_xyz(&p[0], x, y, 0.0f);
+                dsp::init_point_xyz(&p[1], x + step, y, 0.0f);
+                dsp::init_point_xyz(&p[2], x + step, y + step, 0.0f);
+                dsp::init_point_xyz(&p[3], x, y + step, 0.0f);
+
+                add_triangle(s, e, s->mesh.size(), &p[0], &p[1], &p[2]);
+                e          += 3;
+                add_triangle(s, e, s->mesh.size(), &p[0], &p[2], &p[3]);
+                e          += 3;
+            }
+
+        return s->bvh.build(s->mesh.array(), s->mesh.size()) == STATUS_OK;
+    }
+
+    static void init_view(dspu::rt::view_t *v)
+    {
+        // Narrow beam pointing down to the floor
+        dsp::init_point_xyz(&v->s, 0.0f, 0.0f, 10.0f);
+        dsp::init_point_xyz(&v->p[0], -0.5f, -0.5f, 9.0f);
+        dsp::init_point_xyz(&v->p[1], 0.5f, -0.5f, 9.0f);
+        dsp::init_point_xyz(&v->p[2], 0.0f, 0.5f, 9.0f);
+        v->oid      = -1;
+        v->face     = -1;
+    }
+}
+
+PTEST_BEGIN("dspu.3d", bvh_scan, 5, 100)
+
+    void scan_linear(const char *label, scene_t *s, const dspu::rt::view_t *view)
+    {
+        char buf[80];
+        sprintf(buf, "%s x %d", label, int(s->mesh.size()));
+        printf("Testing %s triangles...\n", buf);
+
+        dspu::rt::context_t ctx(view);
+        ctx.init_view();
+
+        PTEST_LOOP(buf,
+            ctx.clear();
+            ctx.add_object(s->mesh.array(), s->plan.array(), s->mesh.size(), s->plan.size());
+            ctx.cull_view();
+        );
+    }
+
+    void scan_bvh(const char *label, scene_t *s, const dspu::rt::view_t *view)
+    {
+        char buf[80];
+        sprintf(buf, "%s x %d", label, int(s->mesh.size()));
+        printf("Testing %s triangles...\n", buf);
+
+        dspu::rt::context_t ctx(view);
+        ctx.init_view();
+        ssize_t stamp = 1;
+
+        PTEST_LOOP(buf,
+            ctx.clear();
+            ctx.add_object(s->mesh.array(), &s->bvh, ++stamp);
+            ctx.cull_view();
+        );
+    }
+
+    PTEST_MAIN
+    {
+        dspu::rt::context_t tmp;
+        dspu::rt::view_t view = tmp.view;
+        init_view(&view);
+
+        for (size_t n=GRID_MIN; n<=GRID_MAX; n <<= 1)
+        {
+            scene_t s;
+            if (!generate_scene(&s, n))
+            {
+                printf("Could not generate scene of %d triangles\n", int(n * n * 2));
+                continue;
+            }
+
+            scan_linear("linear", &s, &view);
+            scan_bvh("bvh", &s, &view);
+            PTEST_SEPARATOR;
+        }
+    }
+
+PTEST_END
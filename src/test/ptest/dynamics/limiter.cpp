@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <lsp-plug.in/test-fw/ptest.h>
+#include <lsp-plug.in/dsp-units/dynamics/Limiter.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#define SRATE           48000
+#define MAX_BLOCK       8192
+#define MAX_CHANNELS    2
+
+namespace
+{
+    using namespace lsp;
+
+    typedef struct lim_mode_desc_t
+    {
+        dspu::limiter_mode_t    mode;
+        const char             *name;
+    } lim_mode_desc_t;
+
+    static const lim_mode_desc_t modes[] =
+    {
+        { dspu::LM_HERM_THIN,   "herm_thin" },
+        { dspu::LM_HERM_WIDE,   "herm_wide" },
+        { dspu::LM_HERM_TAIL,   "herm_tail" },
+        { dspu::LM_HERM_DUCK,   "herm_duck" },
+        { dspu::LM_EXP_THIN,    "exp_thin"  },
+        { dspu::LM_EXP_WIDE,    "exp_wide"  },
+        { dspu::LM_EXP_TAIL,    "exp_tail"  },
+        { dspu::LM_EXP_DUCK,    "exp_duck"  },
+        { dspu::LM_LINE_THIN,   "line_thin" },
+        { dspu::LM_LINE_WIDE,   "line_wide" },
+        { dspu::LM_LINE_TAIL,   "line_tail" },
+        { dspu::LM_LINE_DUCK,   "line_duck" },
+        { dspu::LM_HERM_THIN,   NULL        }
+    };
+
+    static const size_t blocks[] = { 16, 64, 256, 1024, 8192, 0 };
+}
+
+PTEST_BEGIN("dspu.dynamics", limiter, 1, 1000)
+
+    void call(const lim_mode_desc_t *m, float * const *out, float *gain, const float * const *in,
+        size_t channels, size_t count)
+    {
+        dspu::Limiter l;
+        if (!l.init(SRATE, 20.0f, channels))
+            return;
+        l.set_sample_rate(SRATE);
+        l.set_mode(m->mode);
+        l.set_threshold(0.5f, true);
+        l.set_attack(1.5f);
+        l.set_release(10.0f);
+        l.set_lookahead(5.0f);
+        l.update_settings();
+
+        char buf[80];
+        sprintf(buf, "%s x%d x %d", m->name, int(channels), int(count));
+        printf("Testing %s samples...\n", buf);
+
+        PTEST_LOOP(buf,
+            l.process(out, gain, in, NULL, count);
+        );
+
+        l.destroy();
+    }
+
+    PTEST_MAIN
+    {
+        uint8_t *data   = NULL;
+        float *ptr      = alloc_aligned<float>(data, MAX_BLOCK * (MAX_CHANNELS * 2 + 1), 64);
+        float *in[MAX_CHANNELS], *out[MAX_CHANNELS];
+        for (size_t i=0; i<MAX_CHANNELS; ++i)
+        {
+            in[i]           = ptr;
+            ptr            += MAX_BLOCK;
+            out[i]          = ptr;
+            ptr            += MAX_BLOCK;
+
+            for (size_t j=0; j<MAX_BLOCK; ++j)
+                in[i][j]        = float(rand()) / RAND_MAX - 0.5f;
+            dsp::fill_zero(out[i], MAX_BLOCK);
+        }
+        float *gain     = ptr;
+
+        for (const lim_mode_desc_t *m = modes; m->name != NULL; ++m)
+        {
+            for (size_t ch=1; ch <= MAX_CHANNELS; ++ch)
+                for (const size_t *b = blocks; *b != 0; ++b)
+                    call(m, out, gain, in, ch, *b);
+            PTEST_SEPARATOR;
+        }
+
+        free_aligned(data);
+    }
+
+PTEST_END
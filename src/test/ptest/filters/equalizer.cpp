@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <lsp-plug.in/test-fw/ptest.h>
+#include <lsp-plug.in/dsp-units/filters/Equalizer.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#define SRATE           48000
+#define MAX_BLOCK       8192
+#define FILTERS         8
+#define FIR_RANK        12
+
+namespace
+{
+    using namespace lsp;
+
+    typedef struct eq_mode_desc_t
+    {
+        dspu::equalizer_mode_t  mode;
+        const char             *name;
+    } eq_mode_desc_t;
+
+    static const eq_mode_desc_t modes[] =
+    {
+        { dspu::EQM_BYPASS,     "bypass"    },
+        { dspu::EQM_IIR,        "iir"       },
+        { dspu::EQM_FIR,        "fir"       },
+        { dspu::EQM_FFT,        "fft"       },
+        { dspu::EQM_SPM,        "spm"       },
+        { dspu::EQM_FIR_LL,     "fir_ll"    },
+        { dspu::EQM_FFT_LL,     "fft_ll"    },
+        { dspu::EQM_BYPASS,     NULL        }
+    };
+
+    static const size_t blocks[] = { 16, 64, 256, 1024, 8192, 0 };
+}
+
+PTEST_BEGIN("dspu.filters", equalizer, 1, 1000)
+
+    void call(const eq_mode_desc_t *m, float *out, const float *in, size_t count)
+    {
+        dspu::Equalizer eq;
+        dspu::filter_params_t fp;
+
+        if (!eq.init(FILTERS, FIR_RANK))
+            return;
+        eq.set_mode(m->mode);
+        eq.set_sample_rate(SRATE);
+
+        for (size_t i=0; i<FILTERS; ++i)
+        {
+            fp.nType    = dspu::FLT_BT_RLC_BELL;
+            fp.fFreq    = 40.0f * (1 << i);
+            fp.fFreq2   = fp.fFreq;
+            fp.fGain    = (i & 1) ? 2.0f : 0.5f;
+            fp.nSlope   = 2;
+            fp.fQuality = 0.5f;
+            eq.set_params(i, &fp);
+        }
+
+        // Apply the settings before measurement
+        eq.process(out, in, count);
+
+        char buf[80];
+        sprintf(buf, "%s x %d", m->name, int(count));
+        printf("Testing %s samples...\n", buf);
+
+        PTEST_LOOP(buf,
+            eq.process(out, in, count);
+        );
+
+        eq.destroy();
+    }
+
+    PTEST_MAIN
+    {
+        uint8_t *data   = NULL;
+        float *in       = alloc_aligned<float>(data, MAX_BLOCK * 2, 64);
+        float *out      = &in[MAX_BLOCK];
+
+        for (size_t i=0; i<MAX_BLOCK; ++i)
+            in[i]           = float(rand()) / RAND_MAX;
+        dsp::fill_zero(out, MAX_BLOCK);
+
+        for (const eq_mode_desc_t *m = modes; m->name != NULL; ++m)
+        {
+            for (const size_t *b = blocks; *b != 0; ++b)
+                call(m, out, in, *b);
+            PTEST_SEPARATOR;
+        }
+
+        free_aligned(data);
+    }
+
+PTEST_END
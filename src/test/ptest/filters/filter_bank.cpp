@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/ptest.h>
+#include <lsp-plug.in/dsp-units/filters/FilterBank.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#define MAX_BLOCK       8192
+#define MAX_FILTERS     4
+
+namespace
+{
+    using namespace lsp;
+
+    // Filter bank which can be switched to the generic kernel
+    class TestBank: public dspu::FilterBank
+    {
+        public:
+            void use_generic()
+            {
+                // The empty bank selects the generic kernel
+                pCascade        = select_cascade(0);
+            }
+    };
+
+    static const size_t blocks[] = { 16, 64, 256, 1024, 8192, 0 };
+}
+
+PTEST_BEGIN("dspu.filters", filter_bank, 1, 1000)
+
+    void call(size_t filters, bool generic, float *out, const float *in, size_t count)
+    {
+        TestBank bank;
+        if (!bank.init(filters))
+            return;
+
+        bank.begin();
+        for (size_t i=0; i<filters; ++i)
+        {
+            dsp::biquad_x1_t *f = bank.add_chain();
+            f->b0   = 0.25f;
+            f->b1   = 0.5f;
+            f->b2   = 0.25f;
+            f->a1   = 0.5f;
+            f->a2   = -0.25f;
+            f->p0   = 0.0f;
+            f->p1   = 0.0f;
+            f->p2   = 0.0f;
+        }
+        bank.end(true);
+        if (generic)
+            bank.use_generic();
+
+        char buf[80];
+        sprintf(buf, "%s x%d x %d", (generic) ? "generic" : "fixed", int(filters), int(count));
+        printf("Testing %s samples...\n", buf);
+
+        PTEST_LOOP(buf,
+            bank.process(out, in, count);
+        );
+
+        bank.destroy();
+    }
+
+    PTEST_MAIN
+    {
+        uint8_t *data   = NULL;
+        float *in       = alloc_aligned<float>(data, MAX_BLOCK * 2, 64);
+        float *out      = &in[MAX_BLOCK];
+
+        for (size_t i=0; i<MAX_BLOCK; ++i)
+            in[i]           = float(rand()) / RAND_MAX;
+        dsp::fill_zero(out, MAX_BLOCK);
+
+        for (size_t filters=1; filters <= MAX_FILTERS; ++filters)
+        {
+            for (const size_t *b = blocks; *b != 0; ++b)
+            {
+                call(filters, true, out, in, *b);
+                call(filters, false, out, in, *b);
+            }
+            PTEST_SEPARATOR;
+        }
+
+        free_aligned(data);
+    }
+
+PTEST_END
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <lsp-plug.in/test-fw/ptest.h>
+#include <lsp-plug.in/dsp-units/util/Convolver.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#define MAX_BLOCK       8192
+#define IR_SIZE         48000
+#define RANK_MIN        8
+#define RANK_MAX        14
+
+namespace
+{
+    static const size_t blocks[] = { 16, 64, 256, 1024, 8192, 0 };
+}
+
+PTEST_BEGIN("dspu.util", convolver, 1, 1000)
+
+    void call(const float *ir, size_t rank, bool background, float *out, const float *in, size_t count)
+    {
+        dspu::Convolver cv;
+        if (!cv.init(ir, IR_SIZE, rank, 0.0f, background))
+            return;
+
+        char buf[80];
+        sprintf(buf, "rank %d%s x %d", int(rank), (background) ? " bg" : "", int(count));
+        printf("Testing %s samples...\n", buf);
+
+        PTEST_LOOP(buf,
+            cv.process(out, in, count);
+        );
+
+        cv.destroy();
+    }
+
+    PTEST_MAIN
+    {
+        uint8_t *data   = NULL;
+        float *ir       = alloc_aligned<float>(data, IR_SIZE + MAX_BLOCK * 2, 64);
+        float *in       = &ir[IR_SIZE];
+        float *out      = &in[MAX_BLOCK];
+
+        // Exponentially decaying noise as impulse response
+        for (size_t i=0; i<IR_SIZE; ++i)
+            ir[i]           = (float(rand()) / RAND_MAX - 0.5f) * expf(-5.0f * i / IR_SIZE);
+        for (size_t i=0; i<MAX_BLOCK; ++i)
+            in[i]           = float(rand()) / RAND_MAX - 0.5f;
+        dsp::fill_zero(out, MAX_BLOCK);
+
+        for (size_t rank=RANK_MIN; rank <= RANK_MAX; ++rank)
+        {
+            for (const size_t *b = blocks; *b != 0; ++b)
+                call(ir, rank, false, out, in, *b);
+            for (const size_t *b = blocks; *b != 0; ++b)
+                call(ir, rank, true, out, in, *b);
+            PTEST_SEPARATOR;
+        }
+
+        free_aligned(data);
+    }
+
+PTEST_END
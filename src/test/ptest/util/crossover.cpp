@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <lsp-plug.in/test-fw/ptest.h>
+#include <lsp-plug.in/dsp-units/util/Crossover.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#define SRATE           48000
+#define MAX_BLOCK       8192
+#define MAX_BANDS       8
+
+namespace
+{
+    using namespace lsp;
+
+    typedef struct xover_mode_desc_t
+    {
+        dspu::crossover_mode_t  mode;
+        const char             *name;
+    } xover_mode_desc_t;
+
+    static const xover_mode_desc_t modes[] =
+    {
+        { dspu::CROSS_MODE_BT,  "bt"        },
+        { dspu::CROSS_MODE_MT,  "mt"        },
+        { dspu::CROSS_MODE_BT,  NULL        }
+    };
+
+    static const size_t blocks[] = { 16, 64, 256, 1024, 8192, 0 };
+}
+
+PTEST_BEGIN("dspu.util", crossover, 1, 1000)
+
+    void call(const xover_mode_desc_t *m, size_t bands, float * const *out, const float *in, size_t count)
+    {
+        dspu::Crossover xover;
+        if (!xover.init(bands, MAX_BLOCK))
+            return;
+        xover.set_sample_rate(SRATE);
+        for (size_t i=0; i<bands-1; ++i)
+        {
+            xover.set_mode(i, m->mode);
+            xover.set_slope(i, 4);
+            xover.set_frequency(i, 60.0f * (2 << i));
+        }
+
+        char buf[80];
+        sprintf(buf, "%s %d bands x %d", m->name, int(bands), int(count));
+        printf("Testing %s samples...\n", buf);
+
+        PTEST_LOOP(buf,
+            xover.process(out, in, count);
+        );
+
+        xover.destroy();
+    }
+
+    PTEST_MAIN
+    {
+        uint8_t *data   = NULL;
+        float *ptr      = alloc_aligned<float>(data, MAX_BLOCK * (MAX_BANDS + 1), 64);
+        float *in       = ptr;
+        float *out[MAX_BANDS];
+
+        for (size_t i=0; i<MAX_BLOCK; ++i)
+            in[i]           = float(rand()) / RAND_MAX - 0.5f;
+        for (size_t i=0; i<MAX_BANDS; ++i)
+        {
+            ptr            += MAX_BLOCK;
+            out[i]          = ptr;
+            dsp::fill_zero(out[i], MAX_BLOCK);
+        }
+
+        for (const xover_mode_desc_t *m = modes; m->name != NULL; ++m)
+        {
+            for (size_t bands=2; bands <= MAX_BANDS; bands <<= 1)
+                for (const size_t *b = blocks; *b != 0; ++b)
+                    call(m, bands, out, in, *b);
+            PTEST_SEPARATOR;
+        }
+
+        free_aligned(data);
+    }
+
+PTEST_END
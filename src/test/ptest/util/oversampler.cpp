@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/ptest.h>
+#include <lsp-plug.in/dsp-units/util/Oversampler.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#define SRATE           48000
+#define BUF_SIZE        8192
+#define TEST_FREQ       18000.0f
+#define QUALITY_SAMPLES 16384
+
+namespace
+{
+    using namespace lsp;
+
+    typedef struct os_mode_desc_t
+    {
+        dspu::over_mode_t   mode;
+        const char         *name;
+    } os_mode_desc_t;
+
+    static const os_mode_desc_t modes[] =
+    {
+        { dspu::OM_LANCZOS_2X2, "lanczos 2x2"   },
+        { dspu::OM_LANCZOS_2X3, "lanczos 2x3"   },
+        { dspu::OM_LANCZOS_2X4, "lanczos 2x4"   },
+        { dspu::OM_LANCZOS_3X2, "lanczos 3x2"   },
+        { dspu::OM_LANCZOS_3X3, "lanczos 3x3"   },
+        { dspu::OM_LANCZOS_3X4, "lanczos 3x4"   },
+        { dspu::OM_LANCZOS_4X2, "lanczos 4x2"   },
+        { dspu::OM_LANCZOS_4X3, "lanczos 4x3"   },
+        { dspu::OM_LANCZOS_4X4, "lanczos 4x4"   },
+        { dspu::OM_LANCZOS_6X2, "lanczos 6x2"   },
+        { dspu::OM_LANCZOS_6X3, "lanczos 6x3"   },
+        { dspu::OM_LANCZOS_6X4, "lanczos 6x4"   },
+        { dspu::OM_LANCZOS_8X2, "lanczos 8x2"   },
+        { dspu::OM_LANCZOS_8X3, "lanczos 8x3"   },
+        { dspu::OM_LANCZOS_8X4, "lanczos 8x4"   },
+        { dspu::OM_HALFBAND_2X, "halfband 2x"   },
+        { dspu::OM_HALFBAND_4X, "halfband 4x"   },
+        { dspu::OM_HALFBAND_8X, "halfband 8x"   },
+        { dspu::OM_IIR_2X,      "iir 2x"        },
+        { dspu::OM_IIR_4X,      "iir 4x"        },
+        { dspu::OM_IIR_8X,      "iir 8x"        },
+        { dspu::OM_NONE,        NULL            }
+    };
+
+    static const size_t blocks[] = { 16, 64, 256, 1024, 8192, 0 };
+
+    // Compute the magnitude of the frequency component with Goertzel algorithm
+    static float goertzel(const float *src, size_t count, float f)
+    {
+        float k     = 2.0f * cosf(2.0f * M_PI * f);
+        float s1    = 0.0f, s2 = 0.0f;
+        for (size_t i=0; i<count; ++i)
+        {
+            float s     = src[i] + k * s1 - s2;
+            s2          = s1;
+            s1          = s;
+        }
+        return sqrtf(s1*s1 + s2*s2 - k*s1*s2) * 2.0f / count;
+    }
+}
+
+PTEST_BEGIN("dspu.util", oversampler, 5, 1000)
+
+    void measure_quality(const os_mode_desc_t *m, dspu::Oversampler *os)
+    {
+        size_t ratio    = os->get_oversampling();
+        uint8_t *data   = NULL;
+        float *src      = alloc_aligned<float>(data, QUALITY_SAMPLES * (ratio + 1), 64);
+        if (src == NULL)
+            return;
+        float *dst      = &src[QUALITY_SAMPLES];
+
+        // Upsample the tone and compare the tone and the first image
+        float w         = 2.0f * M_PI * TEST_FREQ / SRATE;
+        for (size_t i=0; i<QUALITY_SAMPLES; ++i)
+            src[i]          = sinf(w * i);
+        os->upsample(dst, src, QUALITY_SAMPLES);
+
+        size_t skip     = QUALITY_SAMPLES * ratio / 4;
+        size_t count    = QUALITY_SAMPLES * ratio - skip;
+        float srate     = SRATE * ratio;
+        float tone      = goertzel(&dst[skip], count, TEST_FREQ / srate);
+        float image     = goertzel(&dst[skip], count, (SRATE - TEST_FREQ) / srate);
+
+        printf("%s: latency=%d samples, tone=%.2f dB, image=%.2f dB\n",
+            m->name, int(os->latency()),
+            20.0f * log10f(tone + 1e-10f), 20.0f * log10f(image + 1e-10f));
+
+        free_aligned(data);
+    }
+
+    void call(const os_mode_desc_t *m, float *out, const float *in, size_t count)
+    {
+        dspu::Oversampler os;
+        if (!os.init())
+            return;
+        os.set_sample_rate(SRATE);
+        os.set_mode(m->mode);
+        if (os.modified())
+            os.update_settings();
+
+        if (count == BUF_SIZE)
+            measure_quality(m, &os);
+
+        char buf[80];
+        sprintf(buf, "%s x %d", m->name, int(count));
+        printf("Testing %s samples...\n", buf);
+
+        PTEST_LOOP(buf,
+            os.process(out, in, count);
+        );
+
+        os.destroy();
+    }
+
+    PTEST_MAIN
+    {
+        uint8_t *data   = NULL;
+        float *in       = alloc_aligned<float>(data, BUF_SIZE * 2, 64);
+        float *out      = &in[BUF_SIZE];
+
+        for (size_t i=0; i<BUF_SIZE; ++i)
+            in[i]           = float(rand()) / RAND_MAX;
+        dsp::fill_zero(out, BUF_SIZE);
+
+        for (const os_mode_desc_t *m = modes; m->name != NULL; ++m)
+        {
+            for (const size_t *b = blocks; *b != 0; ++b)
+                call(m, out, in, *b);
+            PTEST_SEPARATOR;
+        }
+
+        free_aligned(data);
+    }
+
+PTEST_END
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/dsp-units/3d/bsp/context.h>
+#include <lsp-plug.in/stdlib/stdlib.h>
+#include <lsp-plug.in/stdlib/string.h>
+
+#define TRIANGLES       64
+#define POSITIONS       16
+
+UTEST_BEGIN("dspu.3d", bsp_mesh)
+
+    float randf(float range)
+    {
+        return (float(rand()) / float(RAND_MAX) - 0.5f) * range;
+    }
+
+    void fill_scene(dspu::bsp::context_t *ctx)
+    {
+        dsp::point3d_t v[TRIANGLES * 3];
+        for (size_t i=0; i<TRIANGLES; ++i)
+        {
+            float cx = randf(8.0f), cy = randf(8.0f), cz = randf(8.0f);
+            for (size_t j=0; j<3; ++j)
+                dsp::init_point_xyz(&v[i*3 + j], cx + randf(2.0f), cy + randf(2.0f), cz + randf(2.0f));
+        }
+
+        dsp::matrix3d_t m;
+        dsp::color3d_t c;
+        dsp::init_matrix3d_identity(&m);
+        c.r = 1.0f; c.g = 0.5f; c.b = 0.25f; c.a = 0.0f;
+
+        UTEST_ASSERT(ctx->add_triangles(v, TRIANGLES, &m, &c) == STATUS_OK);
+        UTEST_ASSERT(ctx->build_tree() == STATUS_OK);
+    }
+
+    void check_mesh(dspu::bsp::context_t *ctx, dspu::bsp::vbuffer_t *vb, const dsp::point3d_t *pov)
+    {
+        // Remember the previous state of the buffer
+        lltl::darray<dspu::view::vertex3d_t> prev, ref;
+        size_t nprev = vb->vertex.size();
+        if (nprev > 0)
+        {
+            dspu::view::vertex3d_t *v = prev.append_n(nprev);
+            UTEST_ASSERT(v != NULL);
+            memcpy(v, vb->vertex.array(), nprev * sizeof(dspu::view::vertex3d_t));
+        }
+
+        UTEST_ASSERT(ctx->build_mesh(&ref, pov) == STATUS_OK);
+        UTEST_ASSERT(ctx->build_mesh(vb, pov) == STATUS_OK);
+
+        // The incremental mesh should match the full mesh
+        size_t n = ref.size();
+        UTEST_ASSERT(vb->vertex.size() == n);
+        UTEST_ASSERT(memcmp(vb->vertex.array(), ref.array(), n * sizeof(dspu::view::vertex3d_t)) == 0);
+
+        // All modified vertices should be covered by sorted dirty ranges
+        size_t next = 0;
+        for (size_t i=0, nr=vb->dirty.size(); i<nr; ++i)
+        {
+            const dspu::bsp::range_t *r = vb->dirty.uget(i);
+            UTEST_ASSERT(r->count > 0);
+            UTEST_ASSERT(r->first >= next);
+            UTEST_ASSERT(r->first + r->count <= n);
+            next        = r->first + r->count;
+        }
+
+        if (nprev != n)
+        {
+            UTEST_ASSERT(vb->dirty.size() == 1);
+            UTEST_ASSERT(vb->dirty.uget(0)->count == n);
+            return;
+        }
+
+        for (size_t i=0, j=0; i<n; ++i)
+        {
+            if (!memcmp(prev.uget(i), vb->vertex.uget(i), sizeof(dspu::view::vertex3d_t)))
+                continue;
+            while ((j < vb->dirty.size()) && (vb->dirty.uget(j)->first + vb->dirty.uget(j)->count <= i))
+                ++j;
+            UTEST_ASSERT_MSG((j < vb->dirty.size()) && (vb->dirty.uget(j)->first <= i),
+                "Vertex %d has changed outside of dirty ranges", int(i));
+        }
+    }
+
+    UTEST_MAIN
+    {
+        srand(0x1234);
+
+        dspu::bsp::context_t ctx;
+        fill_scene(&ctx);
+
+        dspu::bsp::vbuffer_t vb;
+        dsp::point3d_t pov;
+
+        // The first update emits everything, the same point of view changes nothing
+        dsp::init_point_xyz(&pov, 10.0f, 0.0f, 0.0f);
+        check_mesh(&ctx, &vb, &pov);
+        UTEST_ASSERT(vb.dirty.size() == 1);
+        check_mesh(&ctx, &vb, &pov);
+        UTEST_ASSERT(vb.dirty.size() == 0);
+
+        // Move the camera around the scene
+        for (size_t i=0; i<POSITIONS; ++i)
+        {
+            dsp::init_point_xyz(&pov, randf(20.0f), randf(20.0f), randf(20.0f));
+            check_mesh(&ctx, &vb, &pov);
+        }
+
+        // Another tree causes full update
+        dspu::bsp::context_t tmp;
+        fill_scene(&tmp);
+        ctx.swap(&tmp);
+        check_mesh(&ctx, &vb, &pov);
+        UTEST_ASSERT(vb.dirty.size() == 1);
+    }
+
+UTEST_END
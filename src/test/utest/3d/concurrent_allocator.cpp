@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/dsp-units/3d/Allocator3D.h>
+#include <lsp-plug.in/ipc/Thread.h>
+
+#define THREADS         4
+#define ITEMS           20000
+#define BATCH           37      /* Not a multiple of the chunk size */
+#define CHUNK_SIZE      64
+
+namespace
+{
+    using namespace lsp;
+
+    typedef struct item_t
+    {
+        size_t      thread;
+        size_t      seq;
+        ssize_t     index;
+    } item_t;
+
+    // Thread that appends items to the shared allocator
+    class Writer: public ipc::Thread
+    {
+        public:
+            dspu::ConcurrentAllocator3D<item_t>    *pAlloc;
+            size_t                                  nThread;
+            size_t                                  nFailed;
+
+        public:
+            explicit Writer(dspu::ConcurrentAllocator3D<item_t> *alloc, size_t thread)
+            {
+                pAlloc      = alloc;
+                nThread     = thread;
+                nFailed     = 0;
+            }
+
+            virtual status_t run()
+            {
+                item_t *batch[BATCH];
+
+                for (size_t seq=0; seq < ITEMS; )
+                {
+                    // Mix single and batch allocations
+                    if (seq & 1)
+                    {
+                        item_t *it;
+                        ssize_t idx     = pAlloc->ialloc(&it);
+                        if (idx < 0)
+                        {
+                            ++nFailed;
+                            return -idx;
+                        }
+                        it->thread      = nThread;
+                        it->seq         = seq++;
+                        it->index       = idx;
+                        continue;
+                    }
+
+                    size_t n        = lsp_min(size_t(BATCH), size_t(ITEMS) - seq);
+                    ssize_t first   = pAlloc->alloc_n(batch, n);
+                    if (first < 0)
+                    {
+                        ++nFailed;
+                        return -first;
+                    }
+                    for (size_t i=0; i<n; ++i)
+                    {
+                        batch[i]->thread    = nThread;
+                        batch[i]->seq       = seq++;
+                        batch[i]->index     = first + i;
+                    }
+                }
+
+                return STATUS_OK;
+            }
+    };
+}
+
+UTEST_BEGIN("dspu.3d", concurrent_allocator)
+
+    void test_single()
+    {
+        printf("Testing single-thread allocation\n");
+
+        dspu::ConcurrentAllocator3D<item_t> a(CHUNK_SIZE);
+        UTEST_ASSERT(a.chunk_size() == CHUNK_SIZE);
+
+        item_t *batch[BATCH];
+        UTEST_ASSERT(a.alloc_n(batch, BATCH) == 0);
+        item_t *it  = a.alloc();
+        UTEST_ASSERT(it != NULL);
+        UTEST_ASSERT(a.size() == BATCH + 1);
+        UTEST_ASSERT(a.index_of(it) == BATCH);
+        UTEST_ASSERT(a.get(BATCH) == it);
+        UTEST_ASSERT(a.get(BATCH + 1) == NULL);
+        for (size_t i=0; i<BATCH; ++i)
+            UTEST_ASSERT(a.get(i) == batch[i]);
+
+        // Cleared allocator reuses chunks
+        a.clear();
+        UTEST_ASSERT(a.size() == 0);
+        UTEST_ASSERT(a.alloc() == batch[0]);
+    }
+
+    void test_concurrent()
+    {
+        printf("Testing concurrent allocation from %d threads\n", int(THREADS));
+
+        dspu::ConcurrentAllocator3D<item_t> a(CHUNK_SIZE);
+        Writer *w[THREADS];
+
+        for (size_t i=0; i<THREADS; ++i)
+            w[i]    = new Writer(&a, i);
+        for (size_t i=0; i<THREADS; ++i)
+            UTEST_ASSERT(w[i]->start() == STATUS_OK);
+        for (size_t i=0; i<THREADS; ++i)
+        {
+            UTEST_ASSERT(w[i]->join() == STATUS_OK);
+            UTEST_ASSERT(w[i]->nFailed == 0);
+        }
+
+        // Each item is allocated exactly once and keeps the per-thread order
+        UTEST_ASSERT(a.size() == THREADS * ITEMS);
+        size_t next[THREADS];
+        for (size_t i=0; i<THREADS; ++i)
+            next[i]     = 0;
+
+        for (size_t i=0, n=a.size(); i<n; ++i)
+        {
+            item_t *it  = a.get(i);
+            UTEST_ASSERT(it != NULL);
+            UTEST_ASSERT_MSG(it->index == ssize_t(i), "Item %d has index %d", int(i), int(it->index));
+            UTEST_ASSERT(it->thread < THREADS);
+            UTEST_ASSERT_MSG(it->seq == next[it->thread], "Item %d of thread %d is out of order", int(i), int(it->thread));
+            ++next[it->thread];
+            if ((i % BATCH) == 0)
+                UTEST_ASSERT(a.index_of(it) == ssize_t(i));
+        }
+
+        for (size_t i=0; i<THREADS; ++i)
+        {
+            UTEST_ASSERT(next[i] == ITEMS);
+            delete w[i];
+        }
+    }
+
+    UTEST_MAIN
+    {
+        test_single();
+        test_concurrent();
+    }
+
+UTEST_END
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/dsp-units/3d/ImageSource3D.h>
+#include <lsp-plug.in/dsp-units/const.h>
+#include <lsp-plug.in/io/InStringSequence.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define SAMPLE_RATE     48000
+
+static const char *floor_scene =
+    "o Floor\n"
+    "v -10 -10 0\n"
+    "v 10 -10 0\n"
+    "v 10 10 0\n"
+    "v -10 10 0\n"
+    "f 1 2 3 4\n";
+
+// The wall blocks the direct path but not the reflection from the floor
+static const char *wall_scene =
+    "o Floor\n"
+    "v -10 -10 0\n"
+    "v 10 -10 0\n"
+    "v 10 10 0\n"
+    "v -10 10 0\n"
+    "f 1 2 3 4\n"
+    "o Wall\n"
+    "v 1.5 -1 0.75\n"
+    "v 1.5 1 0.75\n"
+    "v 1.5 1 2\n"
+    "v 1.5 -1 2\n"
+    "f 5 6 7 8\n";
+
+UTEST_BEGIN("dspu.3d", image_source)
+
+    void load_scene(dspu::Scene3D &s, const char *text)
+    {
+        io::InStringSequence is;
+        UTEST_ASSERT(is.wrap(text, "UTF-8") == STATUS_OK);
+        UTEST_ASSERT(s.load(&is, WRAP_CLOSE) == STATUS_OK);
+    }
+
+    void compute(dspu::ImageSource3D &is, lltl::darray<dspu::is_tap_t> &taps)
+    {
+        dsp::point3d_t src, lis;
+        dsp::init_point_xyz(&src, 0.0f, 0.0f, 1.0f);
+        dsp::init_point_xyz(&lis, 2.0f, 0.0f, 1.0f);
+
+        is.set_max_order(1);
+        is.set_source(&src, 1.0f);
+        UTEST_ASSERT(is.process(&taps, &lis) == STATUS_OK);
+
+        for (size_t i=0, n=taps.size(); i<n; ++i)
+        {
+            const dspu::is_tap_t *t = taps.uget(i);
+            printf("  tap %d: order=%d, delay=%f, gain=%f\n", int(i), int(t->order), t->delay, t->gain);
+        }
+    }
+
+    void test_floor()
+    {
+        printf("Testing reflection from the floor\n");
+
+        dspu::Scene3D s;
+        load_scene(s, floor_scene);
+
+        dspu::ImageSource3D is;
+        UTEST_ASSERT(is.set_scene(&s) == STATUS_OK);
+
+        lltl::darray<dspu::is_tap_t> taps;
+        compute(is, taps);
+        UTEST_ASSERT(is.num_planes() == 1);
+        UTEST_ASSERT(taps.size() == 2);
+
+        // Direct sound
+        const dspu::is_tap_t *t = taps.uget(0);
+        UTEST_ASSERT(t->order == 0);
+        UTEST_ASSERT(float_equals_relative(t->delay, 2.0f / LSP_DSP_UNITS_SOUND_SPEED_M_S));
+        UTEST_ASSERT(float_equals_relative(t->gain, 0.5f));
+        UTEST_ASSERT(float_equals_absolute(t->dir.dx, 1.0f) && float_equals_absolute(t->dir.dz, 0.0f));
+
+        // Reflection from the floor, the sign is inverted
+        float dist  = sqrtf(8.0f);
+        float k     = (1.0f - 0.02f) * (0.48f - 1.0f);
+        t           = taps.uget(1);
+        UTEST_ASSERT(t->order == 1);
+        UTEST_ASSERT(float_equals_relative(t->delay, dist / LSP_DSP_UNITS_SOUND_SPEED_M_S));
+        UTEST_ASSERT(float_equals_relative(t->gain, k / dist));
+        UTEST_ASSERT(t->dir.dz < 0.0f);
+
+        // The strongest tap goes to the delay
+        dspu::MultiTapDelay dly;
+        UTEST_ASSERT(dly.init(1000, 1));
+        UTEST_ASSERT(dspu::ImageSource3D::apply(&dly, taps.array(), taps.size(), SAMPLE_RATE) == 1);
+        UTEST_ASSERT(dly.get_delay(0) == size_t(taps.uget(0)->delay * SAMPLE_RATE + 0.5f));
+        UTEST_ASSERT(dly.get_gain(0) == taps.uget(0)->gain);
+
+        // The listener under the floor does not hear the reflection
+        dsp::point3d_t lis;
+        dsp::init_point_xyz(&lis, 2.0f, 0.0f, -1.0f);
+        UTEST_ASSERT(is.process(&taps, &lis) == STATUS_OK);
+        for (size_t i=0, n=taps.size(); i<n; ++i)
+            UTEST_ASSERT(taps.uget(i)->order == 0);
+    }
+
+    void test_occlusion()
+    {
+        printf("Testing occlusion of the direct sound\n");
+
+        dspu::Scene3D s;
+        load_scene(s, wall_scene);
+
+        dspu::ImageSource3D is;
+        UTEST_ASSERT(is.set_scene(&s) == STATUS_OK);
+
+        lltl::darray<dspu::is_tap_t> taps;
+        compute(is, taps);
+        UTEST_ASSERT(is.num_planes() == 2);
+        UTEST_ASSERT(taps.size() == 2);
+
+        // The direct sound passes through the wall
+        const dspu::is_tap_t *t = taps.uget(0);
+        UTEST_ASSERT(t->order == 0);
+        UTEST_ASSERT((t->gain > 0.5f * 0.47f) && (t->gain < 0.5f * 0.53f));
+
+        // The reflection from the floor is not affected
+        t           = taps.uget(1);
+        UTEST_ASSERT(t->order == 1);
+        UTEST_ASSERT(float_equals_relative(t->gain, (1.0f - 0.02f) * (0.48f - 1.0f) / sqrtf(8.0f)));
+    }
+
+    UTEST_MAIN
+    {
+        test_floor();
+        test_occlusion();
+    }
+
+UTEST_END
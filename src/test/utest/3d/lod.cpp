@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/dsp-units/3d/Scene3D.h>
+#include <lsp-plug.in/dsp-units/3d/rt/lod.h>
+#include <lsp-plug.in/io/InStringSequence.h>
+#include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/stdlib/stdio.h>
+
+#define GRID        5
+
+UTEST_BEGIN("dspu.3d", lod)
+
+    void make_grid(char *buf, size_t size, float bump)
+    {
+        size_t len = snprintf(buf, size, "o Grid\n");
+
+        // The center vertex can be moved out of the plane
+        for (size_t y=0; y<GRID; ++y)
+            for (size_t x=0; x<GRID; ++x)
+            {
+                float z     = ((x == GRID/2) && (y == GRID/2)) ? bump : 0.0f;
+                len        += snprintf(&buf[len], size - len, "v %d %d %f\n", int(x), int(y), z);
+            }
+
+        for (size_t y=0; y<GRID-1; ++y)
+            for (size_t x=0; x<GRID-1; ++x)
+            {
+                size_t i    = y * GRID + x + 1;
+                len        += snprintf(&buf[len], size - len, "f %d %d %d %d\n",
+                    int(i), int(i + 1), int(i + GRID + 1), int(i + GRID));
+            }
+    }
+
+    void load_grid(dspu::Scene3D &s, float bump)
+    {
+        char buf[0x1000];
+        make_grid(buf, sizeof(buf), bump);
+
+        io::InStringSequence is;
+        UTEST_ASSERT(is.wrap(buf, "UTF-8") == STATUS_OK);
+        UTEST_ASSERT(s.load(&is, WRAP_CLOSE) == STATUS_OK);
+        UTEST_ASSERT(s.num_objects() == 1);
+    }
+
+    double area(const dspu::rt::lod_t &lod)
+    {
+        double a = 0.0;
+        for (size_t i=0, n=lod.triangle.size(); i<n; ++i)
+        {
+            const dspu::rt::lod_triangle_t *t = lod.triangle.uget(i);
+            const dsp::point3d_t *p0 = lod.vertex.uget(t->v[0]);
+            const dsp::point3d_t *p1 = lod.vertex.uget(t->v[1]);
+            const dsp::point3d_t *p2 = lod.vertex.uget(t->v[2]);
+
+            double ax = p1->x - p0->x, ay = p1->y - p0->y, az = p1->z - p0->z;
+            double bx = p2->x - p0->x, by = p2->y - p0->y, bz = p2->z - p0->z;
+            double nx = ay*bz - az*by, ny = az*bx - ax*bz, nz = ax*by - ay*bx;
+            a        += 0.5 * sqrt(nx*nx + ny*ny + nz*nz);
+        }
+        return a;
+    }
+
+    void test_flat()
+    {
+        printf("Testing simplification of flat grid\n");
+
+        dspu::Scene3D s;
+        load_grid(s, 0.0f);
+        dspu::Object3D *obj = s.object(0);
+        UTEST_ASSERT(obj != NULL);
+
+        dspu::rt::lod_t lod;
+        UTEST_ASSERT(lod.init(obj, obj->matrix()) == STATUS_OK);
+        UTEST_ASSERT(lod.vertex.size() == GRID * GRID);
+        UTEST_ASSERT(lod.triangle.size() == (GRID-1) * (GRID-1) * 2);
+
+        // Zero error keeps the mesh
+        UTEST_ASSERT(lod.simplify(0.0f) == STATUS_OK);
+        UTEST_ASSERT(lod.triangle.size() == (GRID-1) * (GRID-1) * 2);
+
+        // Interior vertexes of the plane are removed, boundary is kept
+        UTEST_ASSERT(lod.simplify(1e-3f) == STATUS_OK);
+        printf("  simplified to %d vertexes, %d triangles\n", int(lod.vertex.size()), int(lod.triangle.size()));
+        UTEST_ASSERT(lod.vertex.size() >= (GRID-1) * 4);
+        UTEST_ASSERT(lod.vertex.size() < GRID * GRID);
+        UTEST_ASSERT(lod.triangle.size() < (GRID-1) * (GRID-1) * 2);
+        UTEST_ASSERT(fabs(area(lod) - (GRID-1) * (GRID-1)) < 1e-4);
+    }
+
+    void test_bump()
+    {
+        printf("Testing simplification of grid with bump\n");
+
+        dspu::Scene3D s;
+        load_grid(s, 0.5f);
+        dspu::Object3D *obj = s.object(0);
+        UTEST_ASSERT(obj != NULL);
+
+        dspu::rt::lod_t lod;
+        UTEST_ASSERT(lod.init(obj, obj->matrix()) == STATUS_OK);
+        UTEST_ASSERT(lod.simplify(1e-2f) == STATUS_OK);
+
+        // The bump exceeds the error and should be kept
+        bool found = false;
+        for (size_t i=0, n=lod.vertex.size(); i<n; ++i)
+            if (lod.vertex.uget(i)->z > 0.25f)
+                found = true;
+        UTEST_ASSERT(found);
+        UTEST_ASSERT(lod.triangle.size() < (GRID-1) * (GRID-1) * 2);
+    }
+
+    UTEST_MAIN
+    {
+        test_flat();
+        test_bump();
+    }
+
+UTEST_END
@@ -20,39 +20,43 @@
  */
 
 #include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
 #include <lsp-plug.in/dsp-units/3d/Scene3D.h>
 #include <lsp-plug.in/io/InStringSequence.h>
+#include <lsp-plug.in/io/OutMemoryStream.h>
+#include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/stdlib/stdio.h>
+#include <lsp-plug.in/stdlib/stdlib.h>
+
+#define GRID_W          100
+#define GRID_H          300
+#define GRID_COUNT      3
+
+static const char *quad_data =
+    "# Quad test\n"
+    "# (C) Linux Studio Plugins Project\n"
+    "o Quad 1\n"
+    "v -2 -2 -1\n"
+    "v 2 -2 -1\n"
+    "v 2 2 -1\n"
+    "v -2 2 -1\n"
+    "vn 0 0 1\n"
+    "f 1//1 2//1 3//1 4//1\n"
+    "\n"
+    "o Quad 2\n"
+    "v -2 -2 -2\n"
+    "v 2 -2 -2\n"
+    "v 2 2 -2\n"
+    "v -2 2 -2\n"
+    "vn 0 0 1\n"
+    "f 5//2 6//2 7//2 8//2\n";
 
 UTEST_BEGIN("dspu.3d", scene_load)
 
-    void test_load_from_obj()
+    void validate_scene(dspu::Scene3D &s)
     {
-        dspu::Scene3D s;
         dspu::Object3D *o;
 
-        static const char *data =
-            "# Quad test\n"
-            "# (C) Linux Studio Plugins Project\n"
-            "o Quad 1\n"
-            "v -2 -2 -1\n"
-            "v 2 -2 -1\n"
-            "v 2 2 -1\n"
-            "v -2 2 -1\n"
-            "vn 0 0 1\n"
-            "f 1//1 2//1 3//1 4//1\n"
-            "\n"
-            "o Quad 2\n"
-            "v -2 -2 -2\n"
-            "v 2 -2 -2\n"
-            "v 2 2 -2\n"
-            "v -2 2 -2\n"
-            "vn 0 0 1\n"
-            "f 5//2 6//2 7//2 8//2\n";
-
-        io::InStringSequence is;
-        UTEST_ASSERT(is.wrap(data, "UTF-8") == STATUS_OK);
-        UTEST_ASSERT(s.load(&is, WRAP_CLOSE) == STATUS_OK);
-
         // Validate scene
         UTEST_ASSERT(s.num_objects() == 2);
         UTEST_ASSERT(s.num_vertexes() == 8);
@@ -75,9 +79,245 @@ UTEST_BEGIN("dspu.3d", scene_load)
         UTEST_ASSERT(o->num_triangles() == 2);
     }
 
+    void test_load_from_obj()
+    {
+        dspu::Scene3D s;
+
+        io::InStringSequence is;
+        UTEST_ASSERT(is.wrap(quad_data, "UTF-8") == STATUS_OK);
+        UTEST_ASSERT(s.load(&is, WRAP_CLOSE) == STATUS_OK);
+
+        validate_scene(s);
+    }
+
+    void test_binary_format()
+    {
+        dspu::Scene3D s, d;
+
+        io::InStringSequence is;
+        UTEST_ASSERT(is.wrap(quad_data, "UTF-8") == STATUS_OK);
+        UTEST_ASSERT(s.load(&is, WRAP_CLOSE) == STATUS_OK);
+
+        // Save scene to binary format and load it back
+        io::OutMemoryStream os;
+        UTEST_ASSERT(s.save_binary(&os) == STATUS_OK);
+        UTEST_ASSERT(d.load_binary(os.data(), os.size()) == STATUS_OK);
+        UTEST_ASSERT(d.validate());
+
+        validate_scene(d);
+        UTEST_ASSERT(d.num_triangles() == s.num_triangles());
+        UTEST_ASSERT(d.num_edges() == s.num_edges());
+
+        // Corrupted data should not be loaded
+        UTEST_ASSERT(d.load_binary(os.data(), os.size() / 2) != STATUS_OK);
+    }
+
+    void check_center(dspu::Object3D *o, float x, float y, float z)
+    {
+        const dsp::point3d_t *c = o->world_center();
+        UTEST_ASSERT_MSG(float_equals_absolute(c->x, x, 1e-5f) && float_equals_absolute(c->y, y, 1e-5f) && float_equals_absolute(c->z, z, 1e-5f),
+            "Invalid world center {%f, %f, %f}, expected {%f, %f, %f}", c->x, c->y, c->z, x, y, z);
+    }
+
+    void test_world_bounds()
+    {
+        dspu::Scene3D s;
+
+        io::InStringSequence is;
+        UTEST_ASSERT(is.wrap(quad_data, "UTF-8") == STATUS_OK);
+        UTEST_ASSERT(s.load(&is, WRAP_CLOSE) == STATUS_OK);
+
+        dspu::Object3D *o = s.object(0);
+        UTEST_ASSERT(o != NULL);
+        check_center(o, 0.0f, 0.0f, -1.0f);
+        UTEST_ASSERT(float_equals_absolute(o->world_radius(), sqrtf(8.0f), 1e-5f));
+
+        // The cached bounds follow the matrix
+        dsp::matrix3d_t m;
+        dsp::init_matrix3d_translate(&m, 1.0f, 0.0f, 0.0f);
+        o->set_matrix(&m);
+        check_center(o, 1.0f, 0.0f, -1.0f);
+        const dsp::point3d_t *p = &o->world_bound_box()->p[0];
+        UTEST_ASSERT(float_equals_absolute(p->x, -1.0f, 1e-5f));
+
+        dsp::init_matrix3d_translate(o->matrix(), 0.0f, 3.0f, 0.0f);
+        check_center(o, 0.0f, 3.0f, -1.0f);
+        UTEST_ASSERT(float_equals_absolute(o->world_radius(), sqrtf(8.0f), 1e-5f));
+    }
+
+    char *make_grids(size_t *size)
+    {
+        size_t cap  = 0x800000;
+        char *buf   = static_cast<char *>(malloc(cap));
+        if (buf == NULL)
+            return NULL;
+
+        size_t len = 0, vbase = 0;
+        for (size_t g=0; g<GRID_COUNT; ++g)
+        {
+            len    += snprintf(&buf[len], cap - len, "o Grid %d\n", int(g));
+            for (size_t y=0; y<GRID_H; ++y)
+                for (size_t x=0; x<GRID_W; ++x)
+                    len    += snprintf(&buf[len], cap - len, "v %d.%03d %d.%03d %d.5e-1\n",
+                        int(x), int((x * 37 + y) % 1000), int(y), int((y * 11) % 1000), int(g));
+            len    += snprintf(&buf[len], cap - len, "vn 0 0 1\n");
+
+            // Odd grids use relative indexes
+            ssize_t total   = vbase + GRID_W * GRID_H;
+            for (size_t y=0; y<GRID_H-1; ++y)
+                for (size_t x=0; x<GRID_W-1; ++x)
+                {
+                    ssize_t i   = vbase + y * GRID_W + x + 1;
+                    ssize_t v[4] = { i, i + 1, i + GRID_W + 1, i + GRID_W };
+                    ssize_t n   = g + 1;
+                    if (g & 1)
+                    {
+                        for (size_t k=0; k<4; ++k)
+                            v[k]       -= total + 1;
+                        n           = -1;
+                    }
+                    len    += snprintf(&buf[len], cap - len, "f %d//%d %d//%d %d//%d %d//%d\n",
+                        int(v[0]), int(n), int(v[1]), int(n), int(v[2]), int(n), int(v[3]), int(n));
+                }
+
+            vbase   = total;
+        }
+
+        *size       = len;
+        return buf;
+    }
+
+    void compare_scenes(dspu::Scene3D &a, dspu::Scene3D &b)
+    {
+        UTEST_ASSERT(a.num_objects() == b.num_objects());
+        UTEST_ASSERT(a.num_vertexes() == b.num_vertexes());
+        UTEST_ASSERT(a.num_normals() == b.num_normals());
+        UTEST_ASSERT(a.num_edges() == b.num_edges());
+        UTEST_ASSERT(a.num_triangles() == b.num_triangles());
+
+        for (size_t i=0, n=a.num_vertexes(); i<n; ++i)
+        {
+            dspu::obj_vertex_t *va = a.vertex(i);
+            dspu::obj_vertex_t *vb = b.vertex(i);
+            UTEST_ASSERT_MSG(
+                float_equals_absolute(va->x, vb->x, 1e-5f) &&
+                float_equals_absolute(va->y, vb->y, 1e-5f) &&
+                float_equals_absolute(va->z, vb->z, 1e-5f),
+                "Vertex %d differs", int(i));
+        }
+
+        for (size_t i=0, n=a.num_objects(); i<n; ++i)
+        {
+            dspu::Object3D *oa = a.object(i);
+            dspu::Object3D *ob = b.object(i);
+            UTEST_ASSERT(strcmp(oa->get_name(), ob->get_name()) == 0);
+            UTEST_ASSERT(oa->num_triangles() == ob->num_triangles());
+            for (size_t j=0, m=oa->num_triangles(); j<m; ++j)
+            {
+                dspu::obj_triangle_t *ta = oa->triangle(j);
+                dspu::obj_triangle_t *tb = ob->triangle(j);
+                for (size_t k=0; k<3; ++k)
+                {
+                    UTEST_ASSERT(ta->v[k]->id == tb->v[k]->id);
+                    UTEST_ASSERT(ta->n[k]->id == tb->n[k]->id);
+                }
+            }
+        }
+    }
+
+    void test_load_parallel()
+    {
+        printf("Testing parallel load of OBJ data\n");
+
+        // Small data is parsed as one chunk
+        dspu::Scene3D s;
+        UTEST_ASSERT(s.load_parallel(quad_data, strlen(quad_data), 4) == STATUS_OK);
+        validate_scene(s);
+
+        // Large data is split into chunks, the result matches the sequential parser
+        size_t size = 0;
+        char *data  = make_grids(&size);
+        UTEST_ASSERT(data != NULL);
+        printf("  generated %d bytes of OBJ data\n", int(size));
+
+        dspu::Scene3D s1, s2;
+        io::InStringSequence is;
+        UTEST_ASSERT(is.wrap(data, "UTF-8") == STATUS_OK);
+        UTEST_ASSERT(s1.load(&is, WRAP_CLOSE) == STATUS_OK);
+        UTEST_ASSERT(s2.load_parallel(data, size, 4) == STATUS_OK);
+        UTEST_ASSERT(s2.num_objects() == GRID_COUNT);
+        UTEST_ASSERT(s2.num_vertexes() == GRID_COUNT * GRID_W * GRID_H);
+        compare_scenes(s1, s2);
+
+        // Unsupported statements are handled by the sequential parser
+        static const char *lines = "o Lines\nv 0 0 0\nv 1 0 0\nv 0 1 0\nl 1 2\nf 1 2 3\n";
+        dspu::Scene3D s3;
+        UTEST_ASSERT(s3.load_parallel(lines, strlen(lines), 4) == STATUS_OK);
+        UTEST_ASSERT(s3.num_triangles() == 1);
+
+        free(data);
+    }
+
+    void test_packed()
+    {
+        printf("Testing packed representation of objects\n");
+
+        dspu::Scene3D s;
+        io::InStringSequence is;
+        UTEST_ASSERT(is.wrap(quad_data, "UTF-8") == STATUS_OK);
+        UTEST_ASSERT(s.load(&is, WRAP_CLOSE) == STATUS_OK);
+
+        for (size_t i=0; i<s.num_objects(); ++i)
+        {
+            dspu::Object3D *o = s.object(i);
+            const dspu::obj_packed_t *pk = o->packed();
+            UTEST_ASSERT(pk != NULL);
+            UTEST_ASSERT(pk->vertex.size() == 4);
+            UTEST_ASSERT(pk->normal.size() == 1);
+            UTEST_ASSERT(pk->edge.size() == 5 * 2);
+            UTEST_ASSERT(pk->face.size() == o->num_triangles());
+            UTEST_ASSERT(pk->vindex.size() == o->num_triangles() * 3);
+            UTEST_ASSERT(pk->nindex.size() == o->num_triangles() * 3);
+            UTEST_ASSERT(pk->eindex.size() == o->num_triangles() * 3);
+
+            // Indexes refer to the same data as triangle pointers
+            for (size_t j=0, n=o->num_triangles(); j<n; ++j)
+            {
+                dspu::obj_triangle_t *t = o->triangle(j);
+                UTEST_ASSERT(*(pk->face.uget(j)) == t->face);
+                for (size_t k=0; k<3; ++k)
+                {
+                    const dsp::point3d_t *v     = pk->vertex.uget(*(pk->vindex.uget(j*3 + k)));
+                    const dsp::vector3d_t *vn   = pk->normal.uget(*(pk->nindex.uget(j*3 + k)));
+                    const uint32_t *e           = pk->edge.uget(*(pk->eindex.uget(j*3 + k)) * 2);
+                    UTEST_ASSERT((v->x == t->v[k]->x) && (v->y == t->v[k]->y) && (v->z == t->v[k]->z));
+                    UTEST_ASSERT((vn->dx == t->n[k]->dx) && (vn->dy == t->n[k]->dy) && (vn->dz == t->n[k]->dz));
+
+                    const dsp::point3d_t *e0    = pk->vertex.uget(e[0]);
+                    const dsp::point3d_t *e1    = pk->vertex.uget(e[1]);
+                    UTEST_ASSERT((e0->x == t->e[k]->v[0]->x) && (e0->y == t->e[k]->v[0]->y));
+                    UTEST_ASSERT((e1->x == t->e[k]->v[1]->x) && (e1->y == t->e[k]->v[1]->y));
+                }
+            }
+        }
+
+        // Adding the triangle invalidates the representation
+        dspu::Object3D *o = s.object(0);
+        UTEST_ASSERT(o->add_triangle(0, 0, 2, 5) == STATUS_OK);
+        const dspu::obj_packed_t *pk = o->packed();
+        UTEST_ASSERT(pk != NULL);
+        UTEST_ASSERT(pk->face.size() == 3);
+        UTEST_ASSERT(pk->vertex.size() == 5);
+        UTEST_ASSERT(pk->normal.size() == 2);
+    }
+
     UTEST_MAIN
     {
         test_load_from_obj();
+        test_binary_format();
+        test_world_bounds();
+        test_load_parallel();
+        test_packed();
     }
 
 UTEST_END
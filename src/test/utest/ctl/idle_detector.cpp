@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/ctl/IdleDetector.h>
+#include <lsp-plug.in/dsp-units/filters/FilterBank.h>
+#include <lsp-plug.in/dsp-units/util/Delay.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define BLOCK       0x100
+#define BLOCKS      40
+#define THRESHOLD   1e-6f
+#define POLE        0.99f
+
+UTEST_BEGIN("dspu.ctl", idle_detector)
+
+    void test_detector()
+    {
+        printf("Testing idle detector\n");
+
+        FloatBuffer sig(BLOCK), zero(BLOCK);
+        sig.randomize_sign();
+        zero.fill_zero();
+
+        dspu::IdleDetector d;
+        UTEST_ASSERT(!d.process(zero, BLOCK));  // Disabled
+
+        d.set_threshold(THRESHOLD);
+        d.set_tail(BLOCK * 2 + 1);
+        UTEST_ASSERT(!d.process(sig, BLOCK));
+        UTEST_ASSERT(!d.process(zero, BLOCK));
+        UTEST_ASSERT(!d.process(zero, BLOCK));
+        UTEST_ASSERT(!d.process(zero, BLOCK));
+        UTEST_ASSERT(d.process(zero, BLOCK));
+        UTEST_ASSERT(d.idle());
+
+        // Non-silent input wakes up immediately
+        UTEST_ASSERT(!d.process(sig, BLOCK));
+        UTEST_ASSERT(!d.idle());
+
+        const float *list[2] = { zero, NULL };
+        d.set_tail(0);
+        d.wake();
+        UTEST_ASSERT(d.process(list, 2, BLOCK));
+        list[1]     = sig;
+        UTEST_ASSERT(!d.process(list, 2, BLOCK));
+
+        // Tail of the exponential decay
+        size_t n    = dspu::IdleDetector::decay_tail(POLE, THRESHOLD);
+        UTEST_ASSERT(powf(POLE, n) <= THRESHOLD);
+        UTEST_ASSERT(powf(POLE, n - 2) > THRESHOLD);
+        UTEST_ASSERT(dspu::IdleDetector::decay_tail(1.0f, THRESHOLD) == IDLE_TAIL_INFINITE);
+        UTEST_ASSERT(dspu::IdleDetector::add_tail(IDLE_TAIL_INFINITE, 10) == IDLE_TAIL_INFINITE);
+    }
+
+    void setup(dspu::FilterBank &fb)
+    {
+        // One-pole low-pass filter
+        fb.init(4);
+        fb.begin();
+        dsp::biquad_x1_t *f = fb.add_chain();
+        f->b0       = 1.0f - POLE;
+        f->b1       = 0.0f;
+        f->b2       = 0.0f;
+        f->a1       = POLE;
+        f->a2       = 0.0f;
+        f->p0       = 0.0f;
+        f->p1       = 0.0f;
+        f->p2       = 0.0f;
+        fb.end(true);
+    }
+
+    void test_filter_bank()
+    {
+        printf("Testing idle filter bank\n");
+
+        dspu::FilterBank f1, f2;
+        setup(f1);
+        setup(f2);
+        f2.set_idle_threshold(THRESHOLD);
+        UTEST_ASSERT(f2.tail(THRESHOLD) >= dspu::IdleDetector::decay_tail(POLE, THRESHOLD));
+
+        FloatBuffer in(BLOCK * BLOCKS), out1(BLOCK * BLOCKS), out2(BLOCK * BLOCKS);
+        in.fill_zero();
+        for (size_t i=0; i<BLOCK; ++i)
+            in[i]       = (i & 1) ? 0.5f : -0.5f;
+        for (size_t i=BLOCK * 20; i<BLOCK * 21; ++i)
+            in[i]       = 0.25f;
+
+        bool slept  = false;
+        for (size_t i=0; i<BLOCKS; ++i)
+        {
+            f1.process(&out1[i * BLOCK], &in[i * BLOCK], BLOCK);
+            f2.process(&out2[i * BLOCK], &in[i * BLOCK], BLOCK);
+            slept      |= f2.idle();
+        }
+        UTEST_ASSERT(slept);
+        UTEST_ASSERT(f2.idle());
+        UTEST_ASSERT(out2.valid());
+        if (!out1.equals_absolute(out2, THRESHOLD))
+        {
+            out1.dump("out1");
+            out2.dump("out2");
+            UTEST_FAIL_MSG("Output of the idle filter bank differs");
+        }
+    }
+
+    void test_delay()
+    {
+        printf("Testing idle delay\n");
+
+        dspu::Delay d1, d2;
+        UTEST_ASSERT(d1.init(BLOCK * 4));
+        UTEST_ASSERT(d2.init(BLOCK * 4));
+        d1.set_delay(BLOCK + 17);
+        d2.set_delay(BLOCK + 17);
+        d2.set_idle_threshold(THRESHOLD);
+        UTEST_ASSERT(d2.tail() == BLOCK + 17);
+
+        FloatBuffer in(BLOCK * BLOCKS), out1(BLOCK * BLOCKS), out2(BLOCK * BLOCKS);
+        in.fill_zero();
+        for (size_t i=BLOCK * 2; i<BLOCK * 3; ++i)
+            in[i]       = 1.0f;
+        for (size_t i=BLOCK * 30; i<BLOCK * 31 - 5; ++i)
+            in[i]       = -1.0f;
+
+        bool slept  = false;
+        for (size_t i=0; i<BLOCKS; ++i)
+        {
+            d1.process(&out1[i * BLOCK], &in[i * BLOCK], BLOCK);
+            d2.process(&out2[i * BLOCK], &in[i * BLOCK], BLOCK);
+            slept      |= d2.idle();
+        }
+        UTEST_ASSERT(slept);
+        UTEST_ASSERT(out2.valid());
+        if (!out1.equals_absolute(out2, 0.0f))
+        {
+            out1.dump("out1");
+            out2.dump("out2");
+            UTEST_FAIL_MSG("Output of the idle delay differs");
+        }
+    }
+
+    UTEST_MAIN
+    {
+        test_detector();
+        test_filter_bank();
+        test_delay();
+    }
+
+UTEST_END
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/ctl/ParamEvents.h>
+#include <lsp-plug.in/dsp-units/dynamics/Compressor.h>
+#include <lsp-plug.in/dsp-units/units.h>
+
+#define SRATE       48000
+#define SAMPLES     1000
+
+namespace
+{
+    typedef struct recorder_t
+    {
+        size_t      count;
+        size_t      ids[16];
+        float       values[16];
+    } recorder_t;
+
+    void record(void *object, size_t id, float value)
+    {
+        recorder_t *r       = static_cast<recorder_t *>(object);
+        r->ids[r->count]    = id;
+        r->values[r->count] = value;
+        ++r->count;
+    }
+}
+
+UTEST_BEGIN("dspu.ctl", param_events)
+
+    void test_split()
+    {
+        printf("Testing splitting of the block\n");
+
+        dspu::ParamEvents ev;
+        UTEST_ASSERT(ev.add(300, 1, 1.0f));
+        UTEST_ASSERT(ev.add(100, 2, 2.0f));
+        UTEST_ASSERT(ev.add(300, 3, 3.0f));
+        UTEST_ASSERT(ev.add(0, 4, 4.0f));
+        UTEST_ASSERT(ev.add(2000, 5, 5.0f));
+        UTEST_ASSERT(ev.size() == 5);
+
+        // Events are sorted by offset, events with the same offset keep the order of addition
+        static const size_t ids[]       = { 4, 2, 1, 3, 5 };
+        static const size_t splits[]    = { 100, 200, 700 };
+        for (size_t i=0; i<5; ++i)
+            UTEST_ASSERT(ev.get(i)->id == ids[i]);
+
+        recorder_t r;
+        r.count         = 0;
+        size_t index    = 0, n = 0;
+        for (size_t offset=0; offset < SAMPLES; ++n)
+        {
+            size_t to_do    = ev.apply(&index, offset, SAMPLES - offset, record, &r);
+            UTEST_ASSERT(n < 3);
+            UTEST_ASSERT_MSG(to_do == splits[n], "Invalid sub-block %d: %d", int(n), int(to_do));
+            offset         += to_do;
+        }
+        UTEST_ASSERT(r.count == 4);
+        ev.apply_tail(&index, record, &r);
+        UTEST_ASSERT(r.count == 5);
+        for (size_t i=0; i<5; ++i)
+            UTEST_ASSERT((r.ids[i] == ids[i]) && (r.values[i] == float(ids[i])));
+
+        ev.clear();
+        UTEST_ASSERT(ev.size() == 0);
+    }
+
+    void setup(dspu::Compressor *c)
+    {
+        c->set_sample_rate(SRATE);
+        c->set_mode(dspu::CM_DOWNWARD);
+        c->set_threshold(0.1f, 0.5f);
+        c->set_timings(1.0f, 10.0f);
+        c->set_knee(GAIN_AMP_M_6_DB);
+        c->set_ratio(4.0f);
+        c->update_settings();
+    }
+
+    void test_compressor()
+    {
+        printf("Testing sample-accurate automation of compressor\n");
+
+        dspu::Compressor c1, c2;
+        setup(&c1);
+        setup(&c2);
+
+        FloatBuffer in(SAMPLES), out1(SAMPLES), out2(SAMPLES);
+        in.randomize(0.0f, 1.0f);
+
+        dspu::ParamEvents ev;
+        ev.add(250, dspu::CP_RATIO, 8.0f);
+        ev.add(250, dspu::CP_ATTACK_THRESH, 0.2f);
+        ev.add(640, dspu::CP_ATTACK, 5.0f);
+
+        // Reference: the host slices the block itself
+        c1.process(&out1[0], NULL, &in[0], 250);
+        c1.set_ratio(8.0f);
+        c1.set_threshold(0.2f, 0.5f);
+        c1.update_settings();
+        c1.process(&out1[250], NULL, &in[250], 390);
+        c1.set_attack(5.0f);
+        c1.update_settings();
+        c1.process(&out1[640], NULL, &in[640], SAMPLES - 640);
+
+        c2.process(out2, NULL, in, SAMPLES, &ev);
+        UTEST_ASSERT(out2.valid());
+        if (!out1.equals_absolute(out2, 1e-6f))
+        {
+            out1.dump("out1");
+            out2.dump("out2");
+            UTEST_FAIL_MSG("Compressor outputs differ");
+        }
+    }
+
+    UTEST_MAIN
+    {
+        test_split();
+        test_compressor();
+    }
+
+UTEST_END
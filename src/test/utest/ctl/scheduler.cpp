@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/dsp-units/ctl/Scheduler.h>
+#include <lsp-plug.in/stdlib/stdlib.h>
+
+#define TIMERS          200
+#define BLOCKS          400
+
+UTEST_BEGIN("dspu.ctl", scheduler)
+
+    typedef struct ref_timer_t
+    {
+        uint64_t    deadline;
+        size_t      period;
+        bool        active;
+    } ref_timer_t;
+
+    void test_random()
+    {
+        printf("Testing scheduler against the reference model\n");
+
+        dspu::Scheduler s;
+        ref_timer_t ref[TIMERS];
+        uint64_t now = 0;
+
+        srand(0x5c4ed);
+        for (size_t i=0; i<TIMERS; ++i)
+        {
+            size_t delay        = rand() % 50000;
+            size_t period       = (i % 3) ? 1 + rand() % 20000 : 0;
+            if (i % 17 == 0)
+                period              = 1 + rand() % 10;  // Fires many times per block
+            ssize_t id          = s.add(delay, period, &ref[i]);
+            UTEST_ASSERT(id == ssize_t(i));
+
+            ref[i].deadline     = delay;
+            ref[i].period       = period;
+            ref[i].active       = true;
+        }
+        UTEST_ASSERT(s.timers() == TIMERS);
+
+        for (size_t b=0; b<BLOCKS; ++b)
+        {
+            size_t samples      = 1 + rand() % ((b % 50 == 0) ? 40000 : 1024);
+
+            // Compute the reference events
+            size_t expected     = 0;
+            for (size_t i=0; i<TIMERS; ++i)
+            {
+                ref_timer_t *t      = &ref[i];
+                while ((t->active) && (t->deadline < now + samples))
+                {
+                    ++expected;
+                    if (t->period <= 0)
+                        t->active       = false;
+                    else
+                        t->deadline    += t->period;
+                }
+            }
+
+            size_t n            = s.process(samples);
+            UTEST_ASSERT_MSG(n == expected, "Block %d: %d events, expected %d", int(b), int(n), int(expected));
+
+            for (size_t i=0; i<n; ++i)
+            {
+                const dspu::Scheduler::event_t *ev = s.event(i);
+                UTEST_ASSERT(ev != NULL);
+                UTEST_ASSERT(ev->offset < samples);
+                UTEST_ASSERT(ev->tag == &ref[ev->id]);
+                if (i > 0)
+                    UTEST_ASSERT(ev->offset >= s.event(i-1)->offset);
+
+                // The offset should match the period of the timer
+                const ref_timer_t *t = &ref[ev->id];
+                if (t->period > 0)
+                    UTEST_ASSERT((t->deadline - (now + ev->offset)) % t->period == 0);
+            }
+
+            now                += samples;
+            UTEST_ASSERT(s.time() == now);
+
+            for (size_t i=0; i<TIMERS; ++i)
+            {
+                UTEST_ASSERT(s.active(i) == ref[i].active);
+                if (ref[i].active)
+                    UTEST_ASSERT(s.pending(i) == ssize_t(ref[i].deadline - now));
+            }
+        }
+    }
+
+    void test_control()
+    {
+        printf("Testing control of timers\n");
+
+        dspu::Scheduler s;
+        ssize_t t1 = s.add(10, 100);
+        ssize_t t2 = s.add(20);
+        UTEST_ASSERT((t1 == 0) && (t2 == 1));
+
+        UTEST_ASSERT(s.process(5) == 0);
+        UTEST_ASSERT(s.process(20) == 2);
+        UTEST_ASSERT((s.event(0)->id == 0) && (s.event(0)->offset == 5));
+        UTEST_ASSERT((s.event(1)->id == 1) && (s.event(1)->offset == 15));
+        UTEST_ASSERT(s.active(t1));
+        UTEST_ASSERT(!s.active(t2));
+        UTEST_ASSERT(s.timers() == 1);
+
+        // Cancel, restart and remove timers
+        UTEST_ASSERT(s.cancel(t1));
+        UTEST_ASSERT(s.process(1000) == 0);
+        UTEST_ASSERT(s.set(t2, 3));
+        UTEST_ASSERT(s.process(4) == 1);
+        UTEST_ASSERT(s.event(0)->offset == 3);
+
+        UTEST_ASSERT(s.remove(t1));
+        UTEST_ASSERT(!s.remove(t1));
+        UTEST_ASSERT(!s.set(t1, 10));
+        UTEST_ASSERT(s.add(1) == t1);
+        UTEST_ASSERT(s.process(1) == 0);
+        UTEST_ASSERT(s.process(1) == 1);
+    }
+
+    UTEST_MAIN
+    {
+        test_random();
+        test_control();
+    }
+
+UTEST_END
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/dsp-units/ctl/SettingsBuffer.h>
+#include <lsp-plug.in/dsp-units/dynamics/Compressor.h>
+#include <lsp-plug.in/dsp-units/units.h>
+
+#define SRATE       48000
+
+namespace
+{
+    typedef struct settings_t
+    {
+        size_t      nValue;
+        float       fValue;
+    } settings_t;
+}
+
+UTEST_BEGIN("dspu.ctl", settings_buffer)
+
+    void test_exchange()
+    {
+        printf("Testing exchange of settings\n");
+
+        settings_t init = { 1, 1.0f };
+        dspu::SettingsBuffer<settings_t> sb;
+        sb.init(&init);
+
+        UTEST_ASSERT(!sb.pending());
+        UTEST_ASSERT(!sb.fetch());
+        UTEST_ASSERT(sb.current()->nValue == 1);
+
+        // The writer continues from the published settings
+        sb.edit()->nValue   = 2;
+        sb.publish();
+        UTEST_ASSERT(sb.pending());
+        UTEST_ASSERT(sb.edit()->nValue == 2);
+        UTEST_ASSERT(sb.current()->nValue == 1);
+
+        UTEST_ASSERT(sb.fetch());
+        UTEST_ASSERT(!sb.pending());
+        UTEST_ASSERT(!sb.fetch());
+        UTEST_ASSERT((sb.current()->nValue == 2) && (sb.current()->fValue == 1.0f));
+
+        // Intermediate settings are skipped, the reader gets the latest ones
+        for (size_t i=3; i<10; ++i)
+        {
+            sb.edit()->nValue   = i;
+            sb.edit()->fValue   = i * 0.5f;
+            sb.publish();
+        }
+        UTEST_ASSERT((sb.current()->nValue == 2) && (sb.current()->fValue == 1.0f));
+        UTEST_ASSERT(sb.fetch());
+        UTEST_ASSERT((sb.current()->nValue == 9) && (sb.current()->fValue == 4.5f));
+
+        // Interleaved publishing and fetching never exposes the buffer being edited
+        size_t published = 9;
+        for (size_t i=10; i<100; ++i)
+        {
+            sb.edit()->nValue   = i;
+            if (i % 3)
+            {
+                sb.publish();
+                published           = i;
+            }
+            if (i % 5)
+            {
+                bool pending        = sb.pending();
+                UTEST_ASSERT(sb.fetch() == pending);
+                UTEST_ASSERT(sb.current()->nValue == published);
+            }
+        }
+    }
+
+    void test_compressor()
+    {
+        printf("Testing compressor settings\n");
+
+        dspu::Compressor c;
+        c.set_sample_rate(SRATE);
+        c.update_settings();
+
+        dspu::compressor_settings_t cs;
+        c.get_settings(&cs);
+        dspu::SettingsBuffer<dspu::compressor_settings_t> sb;
+        sb.init(&cs);
+
+        size_t version  = c.version();
+        UTEST_ASSERT(!c.update_settings(&sb));
+        UTEST_ASSERT(c.version() == version);
+
+        // UI thread
+        dspu::compressor_settings_t *s = sb.edit();
+        s->fAttackThresh    = 0.2f;
+        s->fReleaseThresh   = 0.1f;
+        s->fRatio           = 8.0f;
+        s->fKnee            = GAIN_AMP_M_6_DB;
+        s->nMode            = dspu::CM_UPWARD;
+        sb.publish();
+
+        // Audio thread
+        UTEST_ASSERT(c.update_settings(&sb));
+        UTEST_ASSERT(!c.modified());
+        UTEST_ASSERT(c.version() != version);
+
+        c.get_settings(&cs);
+        UTEST_ASSERT((cs.fAttackThresh == 0.2f) && (cs.fReleaseThresh == 0.1f));
+        UTEST_ASSERT(cs.fRatio == 8.0f);
+        UTEST_ASSERT(cs.fKnee == GAIN_AMP_M_6_DB);
+        UTEST_ASSERT(cs.nMode == dspu::CM_UPWARD);
+    }
+
+    UTEST_MAIN
+    {
+        test_exchange();
+        test_compressor();
+    }
+
+UTEST_END
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/dynamics/Compressor.h>
+#include <lsp-plug.in/dsp-units/dynamics/Expander.h>
+#include <lsp-plug.in/dsp-units/dynamics/Gate.h>
+#include <lsp-plug.in/dsp-units/const.h>
+#include <lsp-plug.in/dsp-units/units.h>
+
+#define SRATE       48000
+#define DOTS        0x203       /* Not a multiple of the batch size */
+
+UTEST_BEGIN("dspu.dynamics", curves)
+
+    void init_dots(FloatBuffer &in)
+    {
+        // Sweep the level from -96 dB to +24 dB, odd dots are negative
+        for (size_t i=0; i<DOTS; ++i)
+        {
+            float v     = dspu::db_to_gain(-96.0f + (120.0f * i) / (DOTS - 1));
+            in[i]       = (i & 1) ? -v : v;
+        }
+    }
+
+    void check(const FloatBuffer &out, const float *ref, const char *name)
+    {
+        UTEST_ASSERT(out.valid());
+        for (size_t i=0; i<DOTS; ++i)
+            UTEST_ASSERT_MSG(float_equals_relative(out[i], ref[i], 1e-3f),
+                "%s: curve differs at %d: %g vs %g", name, int(i), out[i], ref[i]);
+    }
+
+    void test_compressor(size_t mode, const char *name)
+    {
+        printf("Testing %s curve\n", name);
+
+        dspu::Compressor c;
+        c.set_sample_rate(SRATE);
+        c.set_mode(mode);
+        c.set_threshold(GAIN_AMP_M_24_DB, 0.5f);
+        c.set_timings(5.0f, 50.0f);
+        c.set_knee(GAIN_AMP_M_6_DB);
+        c.set_ratio(4.0f);
+
+        size_t version = c.version();
+        c.update_settings();
+        UTEST_ASSERT(c.version() != version);
+
+        FloatBuffer in(DOTS), out(DOTS);
+        float ref[DOTS];
+        init_dots(in);
+        for (size_t i=0; i<DOTS; ++i)
+            ref[i]      = c.curve(in[i]);
+
+        c.curve(out, in, DOTS);
+        check(out, ref, name);
+
+        // The curve can be computed in place
+        c.curve(in, in, DOTS);
+        check(in, ref, name);
+    }
+
+    void test_expander(size_t mode, const char *name)
+    {
+        printf("Testing %s curve\n", name);
+
+        dspu::Expander e;
+        e.set_sample_rate(SRATE);
+        e.set_mode(mode);
+        e.set_threshold(GAIN_AMP_M_24_DB, 0.5f);
+        e.set_timings(5.0f, 50.0f);
+        e.set_knee(GAIN_AMP_M_6_DB);
+        e.set_ratio(2.0f);
+
+        size_t version = e.version();
+        e.update_settings();
+        UTEST_ASSERT(e.version() != version);
+
+        FloatBuffer in(DOTS), out(DOTS);
+        float ref[DOTS];
+        init_dots(in);
+        for (size_t i=0; i<DOTS; ++i)
+            ref[i]      = e.curve(in[i]);
+
+        e.curve(out, in, DOTS);
+        check(out, ref, name);
+    }
+
+    void test_gate()
+    {
+        printf("Testing gate curves\n");
+
+        dspu::Gate g;
+        g.set_sample_rate(SRATE);
+        g.set_threshold(GAIN_AMP_M_24_DB, GAIN_AMP_M_36_DB);
+        g.set_zone(GAIN_AMP_M_12_DB, GAIN_AMP_M_12_DB);
+        g.set_reduction(GAIN_AMP_M_48_DB);
+        g.set_timings(5.0f, 50.0f);
+
+        size_t version = g.version();
+        g.update_settings();
+        UTEST_ASSERT(g.version() != version);
+
+        FloatBuffer in(DOTS), out(DOTS);
+        float ref[DOTS];
+        init_dots(in);
+        for (size_t h=0; h<2; ++h)
+        {
+            for (size_t i=0; i<DOTS; ++i)
+                ref[i]      = g.curve(in[i], h);
+
+            g.curve(out, in, DOTS, h);
+            check(out, ref, "gate");
+        }
+    }
+
+    UTEST_MAIN
+    {
+        test_compressor(dspu::CM_DOWNWARD, "downward compressor");
+        test_compressor(dspu::CM_UPWARD, "upward compressor");
+        test_compressor(dspu::CM_BOOSTING, "boosting compressor");
+        test_expander(dspu::EM_DOWNWARD, "downward expander");
+        test_expander(dspu::EM_UPWARD, "upward expander");
+        test_gate();
+    }
+
+UTEST_END
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/dynamics/DynamicProcessor.h>
+#include <lsp-plug.in/dsp-units/units.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#define SRATE       48000
+#define SAMPLES     1000
+#define CHANNELS    3
+
+UTEST_BEGIN("dspu.dynamics", dynamic_processor)
+
+    void setup(dspu::DynamicProcessor *dp)
+    {
+        dp->set_sample_rate(SRATE);
+        dp->set_dot(0, dspu::db_to_gain(-36.0f), dspu::db_to_gain(-36.0f), dspu::db_to_gain(6.0f));
+        dp->set_dot(1, dspu::db_to_gain(-12.0f), dspu::db_to_gain(-18.0f), dspu::db_to_gain(6.0f));
+        dp->set_in_ratio(1.0f);
+        dp->set_out_ratio(0.25f);
+        for (size_t i=0; i<DYNAMIC_PROCESSOR_RANGES; ++i)
+        {
+            dp->set_attack_time(i, 5.0f + i);
+            dp->set_release_time(i, 50.0f + i * 10.0f);
+        }
+        dp->update_settings();
+    }
+
+    void test_link(dspu::dynamic_link_t link, const char *name)
+    {
+        dspu::DynamicProcessor dp1, dp2;
+        setup(&dp1);
+        setup(&dp2);
+        dp2.set_link(link);
+        UTEST_ASSERT(!dp1.modified());
+        UTEST_ASSERT(dp2.get_link() == link);
+
+        FloatBuffer *src[CHANNELS];
+        const float *vin[CHANNELS];
+        FloatBuffer sc(SAMPLES), out1(SAMPLES), out2(SAMPLES), env1(SAMPLES), env2(SAMPLES);
+
+        for (size_t i=0; i<CHANNELS; ++i)
+        {
+            src[i]      = new FloatBuffer(SAMPLES);
+            src[i]->randomize(-1.0f, 1.0f);
+            vin[i]      = src[i]->data();
+        }
+
+        // Link the sidechain manually
+        for (size_t j=0; j<SAMPLES; ++j)
+        {
+            float v     = 0.0f;
+            for (size_t i=0; i<CHANNELS; ++i)
+            {
+                float s     = fabsf(vin[i][j]);
+                v           = (link == dspu::DL_AVERAGE) ? v + s : lsp_max(v, s);
+            }
+            sc[j]       = (link == dspu::DL_AVERAGE) ? v / CHANNELS : v;
+        }
+
+        dp1.process(out1, env1, sc, SAMPLES);
+        dp2.process(out2, env2, vin, CHANNELS, SAMPLES);
+
+        UTEST_ASSERT(out2.valid());
+        UTEST_ASSERT(env2.valid());
+        if (!env1.equals_relative(env2, 1e-5f))
+            UTEST_FAIL_MSG("%s: envelopes differ", name);
+        if (!out1.equals_relative(out2, 1e-5f))
+            UTEST_FAIL_MSG("%s: gains differ", name);
+
+        // Block gain curve should match the scalar one
+        for (size_t i=0; i<SAMPLES; ++i)
+            sc[i]       = dspu::db_to_gain(-72.0f + 80.0f * i / SAMPLES);
+        dp1.reduction(out1, sc, SAMPLES);
+        for (size_t i=0; i<SAMPLES; ++i)
+        {
+            float v     = dp1.reduction(sc[i]);
+            UTEST_ASSERT_MSG(float_equals_relative(out1[i], v, 1e-3f),
+                "%s: reduction differs at %d: %f vs %f", name, int(i), out1[i], v);
+        }
+
+        for (size_t i=0; i<CHANNELS; ++i)
+            delete src[i];
+    }
+
+    UTEST_MAIN
+    {
+        test_link(dspu::DL_MAX, "max");
+        test_link(dspu::DL_AVERAGE, "average");
+    }
+
+UTEST_END
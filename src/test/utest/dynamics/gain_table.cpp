@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/dynamics/Compressor.h>
+#include <lsp-plug.in/dsp-units/dynamics/Expander.h>
+#include <lsp-plug.in/dsp-units/dynamics/Gate.h>
+#include <lsp-plug.in/dsp-units/const.h>
+#include <lsp-plug.in/dsp-units/units.h>
+
+#define SRATE       48000
+#define SAMPLES     4000
+#define ERROR       1e-3f
+
+UTEST_BEGIN("dspu.dynamics", gain_table)
+
+    template <class T>
+        void compare(T *exact, T *table, const char *name)
+        {
+            FloatBuffer src(SAMPLES), out1(SAMPLES), out2(SAMPLES);
+
+            // Sweep the level from -96 dB to +24 dB and back
+            for (size_t i=0; i<SAMPLES; ++i)
+            {
+                float k     = (i < SAMPLES/2) ? float(i) / (SAMPLES/2) : float(SAMPLES - i) / (SAMPLES/2);
+                src[i]      = dspu::db_to_gain(-96.0f + 120.0f * k);
+            }
+
+            exact->process(out1, NULL, src, SAMPLES);
+            table->process(out2, NULL, src, SAMPLES);
+            UTEST_ASSERT(out2.valid());
+
+            for (size_t i=0; i<SAMPLES; ++i)
+            {
+                UTEST_ASSERT_MSG(float_equals_relative(out1[i], out2[i], ERROR * 2.0f),
+                    "%s: gain differs at %d: %f vs %f", name, int(i), out1[i], out2[i]);
+            }
+        }
+
+    void test_compressor(size_t mode, dspu::gain_table_mode_t table, const char *name)
+    {
+        dspu::Compressor c[2];
+        for (size_t i=0; i<2; ++i)
+        {
+            c[i].set_sample_rate(SRATE);
+            c[i].set_mode(mode);
+            c[i].set_threshold(GAIN_AMP_M_24_DB, 0.5f);
+            c[i].set_timings(5.0f, 50.0f);
+            c[i].set_knee(GAIN_AMP_M_6_DB);
+            c[i].set_ratio(4.0f);
+        }
+        c[1].set_gain_table(table, ERROR);
+        UTEST_ASSERT(c[1].get_gain_table() == table);
+        c[0].update_settings();
+        c[1].update_settings();
+
+        compare(&c[0], &c[1], name);
+    }
+
+    void test_expander(size_t mode, dspu::gain_table_mode_t table, const char *name)
+    {
+        dspu::Expander e[2];
+        for (size_t i=0; i<2; ++i)
+        {
+            e[i].set_sample_rate(SRATE);
+            e[i].set_mode(mode);
+            e[i].set_threshold(GAIN_AMP_M_24_DB, 0.5f);
+            e[i].set_timings(5.0f, 50.0f);
+            e[i].set_knee(GAIN_AMP_M_6_DB);
+            e[i].set_ratio(2.0f);
+        }
+        e[1].set_gain_table(table, ERROR);
+        e[0].update_settings();
+        e[1].update_settings();
+
+        compare(&e[0], &e[1], name);
+    }
+
+    void test_gate(dspu::gain_table_mode_t table, const char *name)
+    {
+        dspu::Gate g[2];
+        for (size_t i=0; i<2; ++i)
+        {
+            g[i].set_sample_rate(SRATE);
+            g[i].set_threshold(GAIN_AMP_M_24_DB, GAIN_AMP_M_36_DB);
+            g[i].set_zone(GAIN_AMP_M_12_DB, GAIN_AMP_M_12_DB);
+            g[i].set_reduction(GAIN_AMP_M_48_DB);
+            g[i].set_timings(5.0f, 50.0f);
+        }
+        g[1].set_gain_table(table, ERROR);
+        g[0].update_settings();
+        g[1].update_settings();
+
+        compare(&g[0], &g[1], name);
+    }
+
+    UTEST_MAIN
+    {
+        test_compressor(dspu::CM_DOWNWARD, dspu::GT_LINEAR, "linear downward compressor");
+        test_compressor(dspu::CM_UPWARD, dspu::GT_LINEAR, "linear upward compressor");
+        test_compressor(dspu::CM_BOOSTING, dspu::GT_LINEAR, "linear boosting compressor");
+        test_compressor(dspu::CM_DOWNWARD, dspu::GT_CUBIC, "cubic downward compressor");
+        test_compressor(dspu::CM_UPWARD, dspu::GT_CUBIC, "cubic upward compressor");
+        test_compressor(dspu::CM_BOOSTING, dspu::GT_CUBIC, "cubic boosting compressor");
+
+        test_expander(dspu::EM_DOWNWARD, dspu::GT_LINEAR, "linear downward expander");
+        test_expander(dspu::EM_UPWARD, dspu::GT_LINEAR, "linear upward expander");
+        test_expander(dspu::EM_DOWNWARD, dspu::GT_CUBIC, "cubic downward expander");
+        test_expander(dspu::EM_UPWARD, dspu::GT_CUBIC, "cubic upward expander");
+
+        test_gate(dspu::GT_LINEAR, "linear gate");
+        test_gate(dspu::GT_CUBIC, "cubic gate");
+    }
+
+UTEST_END
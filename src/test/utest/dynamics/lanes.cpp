@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/dynamics/Compressor.h>
+#include <lsp-plug.in/dsp-units/dynamics/Expander.h>
+#include <lsp-plug.in/dsp-units/dynamics/Gate.h>
+#include <lsp-plug.in/dsp-units/const.h>
+#include <lsp-plug.in/dsp-units/units.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#define SRATE       48000
+#define SAMPLES     1000
+#define INSTANCES   11      /* Not multiple of the number of lanes */
+
+UTEST_BEGIN("dspu.dynamics", lanes)
+
+    template <class T>
+        void compare(T *single, T *lanes, const char *name)
+        {
+            FloatBuffer *src[INSTANCES], *out1[INSTANCES], *out2[INSTANCES], *env1[INSTANCES], *env2[INSTANCES];
+            const float *vin[INSTANCES];
+            float *vout[INSTANCES], *venv[INSTANCES];
+            T *list[INSTANCES];
+
+            for (size_t i=0; i<INSTANCES; ++i)
+            {
+                src[i]      = new FloatBuffer(SAMPLES);
+                out1[i]     = new FloatBuffer(SAMPLES);
+                out2[i]     = new FloatBuffer(SAMPLES);
+                env1[i]     = new FloatBuffer(SAMPLES);
+                env2[i]     = new FloatBuffer(SAMPLES);
+                src[i]->randomize(0.0f, 1.0f);
+
+                vin[i]      = src[i]->data();
+                vout[i]     = out2[i]->data();
+                venv[i]     = env2[i]->data();
+                list[i]     = &lanes[i];
+
+                single[i].process(out1[i]->data(), env1[i]->data(), vin[i], SAMPLES);
+            }
+
+            T::process(list, vout, venv, vin, INSTANCES, SAMPLES);
+
+            for (size_t i=0; i<INSTANCES; ++i)
+            {
+                UTEST_ASSERT(out2[i]->valid());
+                UTEST_ASSERT(env2[i]->valid());
+                if (!env1[i]->equals_relative(*env2[i], 1e-5f))
+                    UTEST_FAIL_MSG("%s %d: envelopes differ", name, int(i));
+                if (!out1[i]->equals_relative(*out2[i], 1e-5f))
+                    UTEST_FAIL_MSG("%s %d: gains differ", name, int(i));
+
+                delete src[i];
+                delete out1[i];
+                delete out2[i];
+                delete env1[i];
+                delete env2[i];
+            }
+        }
+
+    void test_compressor()
+    {
+        dspu::Compressor c1[INSTANCES], c2[INSTANCES];
+        FloatBuffer in(SAMPLES), out(SAMPLES);
+
+        for (size_t i=0; i<INSTANCES; ++i)
+        {
+            dspu::Compressor *c[2] = { &c1[i], &c2[i] };
+            for (size_t j=0; j<2; ++j)
+            {
+                c[j]->set_sample_rate(SRATE);
+                c[j]->set_mode((i % 3 == 0) ? dspu::CM_UPWARD : dspu::CM_DOWNWARD);
+                c[j]->set_threshold(0.1f + i * 0.05f, 0.5f);
+                c[j]->set_timings(1.0f + i, 10.0f + i * 5.0f);
+                c[j]->set_knee(GAIN_AMP_M_6_DB);
+                c[j]->set_ratio(2.0f + i);
+                c[j]->update_settings();
+            }
+        }
+
+        // Batch gain curve should match the scalar one
+        for (size_t i=0; i<SAMPLES; ++i)
+            in[i]       = dspu::db_to_gain(-72.0f + 80.0f * i / SAMPLES);
+        for (size_t i=0; i<INSTANCES; ++i)
+        {
+            c1[i].reduction(out, in, SAMPLES);
+            for (size_t j=0; j<SAMPLES; ++j)
+            {
+                float v = c1[i].reduction(in[j]);
+                UTEST_ASSERT_MSG(float_equals_relative(out[j], v, 1e-3f),
+                    "Compressor %d reduction differs at %d: %f vs %f", int(i), int(j), out[j], v);
+            }
+        }
+
+        compare(c1, c2, "Compressor");
+    }
+
+    void test_expander()
+    {
+        dspu::Expander e1[INSTANCES], e2[INSTANCES];
+        FloatBuffer in(SAMPLES), out(SAMPLES);
+
+        for (size_t i=0; i<INSTANCES; ++i)
+        {
+            dspu::Expander *e[2] = { &e1[i], &e2[i] };
+            for (size_t j=0; j<2; ++j)
+            {
+                e[j]->set_sample_rate(SRATE);
+                e[j]->set_mode((i & 1) ? dspu::EM_UPWARD : dspu::EM_DOWNWARD);
+                e[j]->set_threshold(0.1f + i * 0.05f, 0.5f);
+                e[j]->set_timings(1.0f + i, 10.0f + i * 5.0f);
+                e[j]->set_knee(GAIN_AMP_M_6_DB);
+                e[j]->set_ratio(2.0f + i * 0.25f);
+                e[j]->update_settings();
+            }
+        }
+
+        for (size_t i=0; i<SAMPLES; ++i)
+            in[i]       = dspu::db_to_gain(-72.0f + 80.0f * i / SAMPLES);
+        for (size_t i=0; i<INSTANCES; ++i)
+        {
+            e1[i].amplification(out, in, SAMPLES);
+            for (size_t j=0; j<SAMPLES; ++j)
+            {
+                float v = e1[i].amplification(in[j]);
+                UTEST_ASSERT_MSG(float_equals_relative(out[j], v, 1e-3f),
+                    "Expander %d amplification differs at %d: %f vs %f", int(i), int(j), out[j], v);
+            }
+        }
+
+        compare(e1, e2, "Expander");
+    }
+
+    void test_gate()
+    {
+        dspu::Gate g1[INSTANCES], g2[INSTANCES];
+        FloatBuffer in(SAMPLES), out(SAMPLES);
+
+        for (size_t i=0; i<INSTANCES; ++i)
+        {
+            dspu::Gate *g[2] = { &g1[i], &g2[i] };
+            for (size_t j=0; j<2; ++j)
+            {
+                g[j]->set_sample_rate(SRATE);
+                g[j]->set_threshold(0.2f + i * 0.02f, 0.1f + i * 0.02f);
+                g[j]->set_zone(GAIN_AMP_M_6_DB, GAIN_AMP_M_6_DB);
+                g[j]->set_reduction(GAIN_AMP_M_24_DB);
+                g[j]->set_timings(1.0f + i, 10.0f + i * 5.0f);
+                g[j]->update_settings();
+            }
+        }
+
+        for (size_t i=0; i<SAMPLES; ++i)
+            in[i]       = dspu::db_to_gain(-72.0f + 80.0f * i / SAMPLES);
+        for (size_t i=0; i<INSTANCES; ++i)
+        {
+            for (size_t k=0; k<2; ++k)
+            {
+                g1[i].amplification(out, in, SAMPLES, k > 0);
+                for (size_t j=0; j<SAMPLES; ++j)
+                {
+                    float v = g1[i].amplification(in[j], k > 0);
+                    UTEST_ASSERT_MSG(float_equals_relative(out[j], v, 1e-3f),
+                        "Gate %d amplification differs at %d: %f vs %f", int(i), int(j), out[j], v);
+                }
+            }
+        }
+
+        compare(g1, g2, "Gate");
+    }
+
+    UTEST_MAIN
+    {
+        test_compressor();
+        test_expander();
+        test_gate();
+    }
+
+UTEST_END
@@ -23,9 +23,11 @@
 #include <lsp-plug.in/test-fw/helpers.h>
 #include <lsp-plug.in/test-fw/FloatBuffer.h>
 #include <lsp-plug.in/dsp-units/dynamics/Limiter.h>
+#include <lsp-plug.in/dsp-units/sampling/Sample.h>
 #include <lsp-plug.in/runtime/LSPString.h>
 #include <lsp-plug.in/io/OutSequence.h>
 #include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
 
 #define SRATE       48000
 #define BUF_SIZE    4096
@@ -155,10 +157,199 @@ UTEST_BEGIN("dspu.dynamics", limiter)
         l.destroy();
     }
 
+    void test_linked()
+    {
+        FloatBuffer in1(BUF_SIZE), in2(BUF_SIZE), sc(BUF_SIZE);
+        FloatBuffer out(BUF_SIZE), gain(BUF_SIZE);
+        FloatBuffer mout1(BUF_SIZE), mout2(BUF_SIZE), mgain(BUF_SIZE);
+
+        in1.randomize(-1.0f, 1.0f);
+        in2.randomize(-0.5f, 0.5f);
+        for (size_t i=0; i<BUF_SIZE; ++i)
+            sc[i]           = lsp_max(fabsf(in1[i]), fabsf(in2[i]));
+
+        // Initialize limiters
+        dspu::Limiter l, ml;
+        UTEST_ASSERT(l.init(SRATE*4, 20.0f));
+        UTEST_ASSERT(ml.init(SRATE*4, 20.0f, 2));
+        UTEST_ASSERT(ml.channels() == 2);
+
+        dspu::Limiter *lim[2] = { &l, &ml };
+        for (size_t i=0; i<2; ++i)
+        {
+            lim[i]->set_sample_rate(SRATE);
+            lim[i]->set_mode(dspu::LM_HERM_THIN);
+            lim[i]->set_knee(1.0f);
+            lim[i]->set_threshold(0.5f, true);
+            lim[i]->set_attack(1.5);
+            lim[i]->set_release(1.5);
+            lim[i]->set_lookahead(5);
+        }
+
+        // Mono limiter with manually linked sidechain is the reference
+        l.process(out, gain, in1, sc, BUF_SIZE);
+        dsp::mul2(out, gain, BUF_SIZE);
+
+        float *vdst[2]          = { mout1, mout2 };
+        const float *vsrc[2]    = { in1, in2 };
+        ml.process(vdst, mgain, vsrc, NULL, BUF_SIZE);
+
+        UTEST_ASSERT(mout1.valid());
+        UTEST_ASSERT(mout2.valid());
+        UTEST_ASSERT(mgain.valid());
+        UTEST_ASSERT(ml.get_latency() == l.get_latency());
+        if (!gain.equals_absolute(mgain, 1e-5f))
+        {
+            gain.dump("gain");
+            mgain.dump("mgain");
+            UTEST_FAIL_MSG("Linked gain differs");
+        }
+        if (!out.equals_absolute(mout1, 1e-5f))
+        {
+            out.dump("out");
+            mout1.dump("mout1");
+            UTEST_FAIL_MSG("Channel 0 output differs");
+        }
+
+        size_t latency = l.get_latency();
+        for (size_t i=0; i<BUF_SIZE; ++i)
+        {
+            float v = (i >= latency) ? in2[i - latency] * mgain[i] : 0.0f;
+            UTEST_ASSERT_MSG(float_equals_absolute(mout2[i], v, 1e-5f),
+                "Channel 1 output differs at sample %d: %f vs %f", int(i), mout2[i], v);
+        }
+
+        l.destroy();
+        ml.destroy();
+    }
+
+    void test_true_peak()
+    {
+        FloatBuffer in(BUF_SIZE);
+        FloatBuffer out(BUF_SIZE);
+        FloatBuffer gain(BUF_SIZE);
+
+        // Sine wave at quarter of the sample rate with 45 degree phase shift has
+        // sample peaks of -3 dB while the true peak is 0 dB
+        for (size_t i=0; i<BUF_SIZE; ++i)
+            in[i]           = sinf(M_PI * 0.5f * i + M_PI * 0.25f);
+
+        dspu::Limiter l;
+        UTEST_ASSERT(l.init(SRATE*4, 20.0f));
+        l.set_sample_rate(SRATE);
+        l.set_mode(dspu::LM_HERM_THIN);
+        l.set_knee(1.0f);
+        l.set_threshold(0.8f, true);
+        l.set_attack(1.5);
+        l.set_release(1.5);
+        l.set_lookahead(5);
+
+        // Sample peak mode should not reduce the gain
+        l.process(out, gain, in, in, BUF_SIZE);
+        UTEST_ASSERT(float_equals_adaptive(dsp::min(gain, BUF_SIZE), 1.0f));
+
+        // True peak mode should reduce the gain
+        UTEST_ASSERT(!l.set_true_peak(true));
+        UTEST_ASSERT(l.get_true_peak());
+        l.process(out, gain, in, in, BUF_SIZE);
+        UTEST_ASSERT(l.get_latency() == size_t(5.0f * SRATE * 0.001f) + LIMITER_TP_DELAY);
+        UTEST_ASSERT_MSG(dsp::max(&gain[BUF_SIZE/2], BUF_SIZE/2) < 0.85f,
+            "Gain is too high: %f", dsp::max(&gain[BUF_SIZE/2], BUF_SIZE/2));
+
+        l.destroy();
+    }
+
+    void test_merge_peaks()
+    {
+        FloatBuffer in(BUF_SIZE);
+        FloatBuffer out(BUF_SIZE);
+        FloatBuffer gain(BUF_SIZE);
+
+        // Heavily clipped material with many peaks per block
+        in.randomize(-2.0f, 2.0f);
+
+        dspu::Limiter l;
+        UTEST_ASSERT(l.init(SRATE*4, 20.0f));
+        l.set_sample_rate(SRATE);
+        l.set_mode(dspu::LM_HERM_THIN);
+        l.set_knee(1.0f);
+        l.set_threshold(0.5f, true);
+        l.set_attack(1.5);
+        l.set_release(1.5);
+        l.set_lookahead(5);
+        UTEST_ASSERT(!l.set_merge_peaks(true));
+        UTEST_ASSERT(l.get_merge_peaks());
+
+        l.process(out, gain, in, in, BUF_SIZE);
+        dsp::mul2(out, gain, BUF_SIZE);
+
+        UTEST_ASSERT(out.valid());
+        UTEST_ASSERT(gain.valid());
+        UTEST_ASSERT(dsp::min(gain, BUF_SIZE) >= 0.0f);
+        UTEST_ASSERT_MSG(dsp::abs_max(out, BUF_SIZE) <= 0.5f + 1e-4f,
+            "Output peak is too high: %f", dsp::abs_max(out, BUF_SIZE));
+
+        l.destroy();
+    }
+
+    void test_offline()
+    {
+        printf("Testing offline processing of the sample\n");
+
+        dspu::Sample src, dst;
+        UTEST_ASSERT(src.init(2, BUF_SIZE, BUF_SIZE));
+        src.set_sample_rate(SRATE);
+        for (size_t i=0; i<BUF_SIZE; ++i)
+        {
+            float env           = (i > BUF_SIZE/4) && (i < BUF_SIZE/2) ? 1.0f : 0.25f;
+            src.channel(0)[i]   = env * sinf(2.0f * M_PI * 440.0f * i / SRATE);
+            src.channel(1)[i]   = env * 0.5f * cosf(2.0f * M_PI * 330.0f * i / SRATE);
+        }
+
+        dspu::Limiter l;
+        UTEST_ASSERT(l.init(SRATE*4, 20.0f));
+        l.set_sample_rate(SRATE);
+        l.set_threshold(0.5f, true);
+        l.set_attack(1.5);
+        l.set_release(5.0);
+
+        FloatBuffer gain(BUF_SIZE);
+        UTEST_ASSERT(l.process(&dst, &src, gain) == STATUS_OK);
+        UTEST_ASSERT(gain.valid());
+        UTEST_ASSERT(dst.channels() == 2);
+        UTEST_ASSERT(dst.length() == BUF_SIZE);
+
+        // No latency, the gain is only lowered where it is needed, the peak is under threshold
+        UTEST_ASSERT(dsp::max(gain, BUF_SIZE) <= 1.0f);
+        UTEST_ASSERT(float_equals_adaptive(gain.get(0), 1.0f));
+        UTEST_ASSERT(float_equals_adaptive(gain.get(BUF_SIZE-1), 1.0f));
+        for (size_t i=0; i<2; ++i)
+        {
+            const float *in     = src.channel(i);
+            const float *out    = dst.channel(i);
+            UTEST_ASSERT(dsp::abs_max(out, BUF_SIZE) <= 0.5f + 1e-6f);
+            for (size_t j=0; j<BUF_SIZE; ++j)
+                UTEST_ASSERT_MSG(float_equals_absolute(out[j], in[j] * gain[j], 1e-6f),
+                    "Invalid sample %d of channel %d: %f vs %f", int(j), int(i), out[j], in[j] * gain[j]);
+        }
+
+        // In-place processing gives the same result
+        UTEST_ASSERT(l.process(&src, &src) == STATUS_OK);
+        for (size_t i=0; i<2; ++i)
+            for (size_t j=0; j<BUF_SIZE; ++j)
+                UTEST_ASSERT(src.channel(i)[j] == dst.channel(i)[j]);
+
+        l.destroy();
+    }
+
     UTEST_MAIN
     {
         test_triangle_peak();
         test_trapezoid_peak();
+        test_linked();
+        test_true_peak();
+        test_merge_peaks();
+        test_offline();
     }
 
 UTEST_END
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/dynamics/MultibandLimiter.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define SRATE       48000
+#define BANDS       3
+#define SAMPLES     0x1803      /* Not a multiple of the block size */
+
+UTEST_BEGIN("dspu.dynamics", multiband_limiter)
+
+    void setup(dspu::MultibandLimiter &ml, float thresh)
+    {
+        UTEST_ASSERT(ml.init(BANDS, SRATE, 20.0f));
+        ml.set_sample_rate(SRATE);
+        ml.set_frequency(0, 200.0f);
+        ml.set_frequency(1, 2000.0f);
+        ml.set_slope(0, 2);
+        ml.set_slope(1, 2);
+        ml.set_lookahead(5.0f);
+        ml.set_mode(dspu::LM_HERM_THIN);
+        for (size_t i=0; i<BANDS; ++i)
+        {
+            ml.set_threshold(i, thresh, true);
+            ml.set_attack(i, 1.5f);
+            ml.set_release(i, 1.5f);
+            ml.set_knee(i, 1.0f);
+        }
+    }
+
+    void test_transparent()
+    {
+        printf("Testing transparency of the multiband limiter below threshold\n");
+
+        FloatBuffer src(SAMPLES), dst(SAMPLES), ref(SAMPLES);
+        FloatBuffer b0(SAMPLES), b1(SAMPLES), b2(SAMPLES);
+        src.randomize(-0.1f, 0.1f);
+
+        dspu::MultibandLimiter ml;
+        setup(ml, 1.0f);
+        ml.process(dst, src, SAMPLES);
+        UTEST_ASSERT(dst.valid());
+
+        // The reference is the sum of crossover bands of the delayed signal
+        dspu::Crossover xc;
+        UTEST_ASSERT(xc.init(BANDS, 0x400));
+        xc.set_sample_rate(SRATE);
+        xc.set_frequency(0, 200.0f);
+        xc.set_frequency(1, 2000.0f);
+        xc.set_slope(0, 2);
+        xc.set_slope(1, 2);
+
+        size_t latency  = ml.latency();
+        UTEST_ASSERT(latency == size_t(5.0f * SRATE * 0.001f));
+
+        FloatBuffer delayed(SAMPLES);
+        delayed.fill_zero();
+        dsp::copy(&delayed[latency], src, SAMPLES - latency);
+
+        float *bands[BANDS] = { b0, b1, b2 };
+        xc.process(bands, delayed, SAMPLES);
+        dsp::add3(ref, b0, b1, SAMPLES);
+        dsp::add2(ref, b2, SAMPLES);
+
+        if (!dst.equals_absolute(ref, 1e-5f))
+        {
+            src.dump("src");
+            dst.dump("dst");
+            ref.dump("ref");
+            UTEST_FAIL_MSG("Output of the multiband limiter differs from the crossover");
+        }
+
+        xc.destroy();
+        ml.destroy();
+    }
+
+    void test_limiting()
+    {
+        printf("Testing peak limiting of the multiband limiter\n");
+
+        FloatBuffer src(SAMPLES);
+        for (size_t i=0; i<SAMPLES; ++i)
+            src[i]      = 0.9f * sinf(2.0f * M_PI * 100.0f * i / SRATE) +
+                          0.9f * sinf(2.0f * M_PI * 5000.0f * i / SRATE);
+
+        // Processing in place is allowed
+        FloatBuffer dst(SAMPLES);
+        dsp::copy(dst, src, SAMPLES);
+        dspu::MultibandLimiter ml;
+        setup(ml, 0.25f);
+        ml.process(dst, dst, SAMPLES);
+        UTEST_ASSERT(dst.valid());
+
+        for (size_t i=0; i<BANDS; ++i)
+        {
+            const float *gain = ml.band_gain(i);
+            UTEST_ASSERT(gain != NULL);
+            UTEST_ASSERT(dsp::max(gain, 0x400) <= 1.0f + 1e-6f);
+        }
+
+        // Each band does not exceed its threshold, so does the sum of bands
+        float peak  = dsp::abs_max(&dst[SAMPLES/2], SAMPLES/2);
+        printf("  output peak = %f\n", peak);
+        UTEST_ASSERT_MSG(peak <= BANDS * 0.25f * 1.05f, "Output peak %f is too high", peak);
+        UTEST_ASSERT_MSG(peak < dsp::abs_max(src, SAMPLES) * 0.5f, "Output is not limited");
+
+        ml.destroy();
+    }
+
+    UTEST_MAIN
+    {
+        test_transparent();
+        test_limiting();
+    }
+
+UTEST_END
@@ -0,0 +1,237 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/filters/DynamicFilters.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+using namespace lsp;
+
+#define BUF_SIZE        4096
+
+UTEST_BEGIN("dspu.filters", dynamic_filters)
+
+    void test_decimation(size_t type, size_t slope, size_t decimation)
+    {
+        dspu::DynamicFilters df[2];
+        dspu::filter_params_t fp;
+
+        printf("Testing decimation=%d for filter type=%d, slope=%d\n", int(decimation), int(type), int(slope));
+
+        fp.nType        = type;
+        fp.fFreq        = 1000.0f;
+        fp.fFreq2       = 4000.0f;
+        fp.fGain        = 1.0f;
+        fp.nSlope       = slope;
+        fp.fQuality     = 0.5f;
+
+        for (size_t i=0; i<2; ++i)
+        {
+            UTEST_ASSERT(df[i].init(1) == STATUS_OK);
+            df[i].set_sample_rate(48000);
+            UTEST_ASSERT(df[i].set_params(0, &fp));
+            UTEST_ASSERT(df[i].set_filter_active(0, true));
+        }
+        df[1].set_decimation(decimation);
+        UTEST_ASSERT(df[1].decimation() == decimation);
+
+        // Slowly varying gain curve
+        FloatBuffer gain(BUF_SIZE);
+        FloatBuffer src(BUF_SIZE);
+        FloatBuffer dst1(BUF_SIZE);
+        FloatBuffer dst2(BUF_SIZE);
+        for (size_t i=0; i<BUF_SIZE; ++i)
+            gain[i]         = 1.0f + float(i) / BUF_SIZE;
+        src.randomize(-1.0f, 1.0f);
+
+        df[0].process(0, dst1, src, gain, BUF_SIZE);
+        df[1].process(0, dst2, src, gain, BUF_SIZE);
+
+        UTEST_ASSERT(dst1.valid());
+        UTEST_ASSERT(dst2.valid());
+        if (!dst1.equals_absolute(dst2, 1e-3f))
+        {
+            dst1.dump("dst1");
+            dst2.dump("dst2");
+            UTEST_FAIL_MSG("Output of decimated dynamic filter differs");
+        }
+
+        df[0].destroy();
+        df[1].destroy();
+    }
+
+    void test_channels(size_t type, size_t slope, size_t channels)
+    {
+        dspu::DynamicFilters mc, sc;
+        dspu::filter_params_t fp;
+
+        printf("Testing %d channels for filter type=%d, slope=%d\n", int(channels), int(type), int(slope));
+
+        fp.nType        = type;
+        fp.fFreq        = 1000.0f;
+        fp.fFreq2       = 4000.0f;
+        fp.fGain        = 1.0f;
+        fp.nSlope       = slope;
+        fp.fQuality     = 0.5f;
+
+        UTEST_ASSERT(mc.init(1, channels) == STATUS_OK);
+        UTEST_ASSERT(mc.channels() == channels);
+        UTEST_ASSERT(sc.init(channels) == STATUS_OK);
+        mc.set_sample_rate(48000);
+        sc.set_sample_rate(48000);
+        UTEST_ASSERT(mc.set_params(0, &fp));
+        UTEST_ASSERT(mc.set_filter_active(0, true));
+        for (size_t i=0; i<channels; ++i)
+        {
+            UTEST_ASSERT(sc.set_params(i, &fp));
+            UTEST_ASSERT(sc.set_filter_active(i, true));
+        }
+
+        FloatBuffer gain(BUF_SIZE);
+        for (size_t i=0; i<BUF_SIZE; ++i)
+            gain[i]         = 1.0f + float(i) / BUF_SIZE;
+
+        FloatBuffer *src[4], *dst1[4], *dst2[4];
+        float *out[4];
+        const float *in[4];
+        for (size_t i=0; i<channels; ++i)
+        {
+            src[i]          = new FloatBuffer(BUF_SIZE);
+            dst1[i]         = new FloatBuffer(BUF_SIZE);
+            dst2[i]         = new FloatBuffer(BUF_SIZE);
+            src[i]->randomize(-1.0f, 1.0f);
+            out[i]          = dst1[i]->data();
+            in[i]           = src[i]->data();
+        }
+
+        // Process in two chunks to check the state of each channel
+        size_t half     = BUF_SIZE / 2;
+        mc.process(0, out, in, gain, channels, half);
+        for (size_t i=0; i<channels; ++i)
+        {
+            out[i]         += half;
+            in[i]          += half;
+        }
+        mc.process(0, out, in, &gain[half], channels, BUF_SIZE - half);
+
+        for (size_t i=0; i<channels; ++i)
+        {
+            sc.process(i, dst2[i]->data(), src[i]->data(), gain, BUF_SIZE);
+
+            UTEST_ASSERT(dst1[i]->valid());
+            UTEST_ASSERT(dst2[i]->valid());
+            if (!dst1[i]->equals_absolute(*dst2[i], 1e-5f))
+            {
+                dst1[i]->dump("dst1");
+                dst2[i]->dump("dst2");
+                UTEST_FAIL_MSG("Output of channel %d differs", int(i));
+            }
+        }
+
+        for (size_t i=0; i<channels; ++i)
+        {
+            delete src[i];
+            delete dst1[i];
+            delete dst2[i];
+        }
+        mc.destroy();
+        sc.destroy();
+    }
+
+    void test_freq_chart(size_t type, size_t slope)
+    {
+        static const float gains[] = { 0.25f, 1.0f, 2.0f, 8.0f };
+        const size_t n_gains = sizeof(gains)/sizeof(gains[0]);
+
+        dspu::DynamicFilters df;
+        dspu::filter_params_t fp;
+
+        printf("Testing batched frequency chart for filter type=%d, slope=%d\n", int(type), int(slope));
+
+        fp.nType        = type;
+        fp.fFreq        = 1000.0f;
+        fp.fFreq2       = 4000.0f;
+        fp.fGain        = 1.0f;
+        fp.nSlope       = slope;
+        fp.fQuality     = 0.5f;
+
+        UTEST_ASSERT(df.init(1) == STATUS_OK);
+        df.set_sample_rate(48000);
+        UTEST_ASSERT(df.set_params(0, &fp));
+
+        FloatBuffer f(BUF_SIZE);
+        for (size_t i=0; i<BUF_SIZE; ++i)
+            f[i]            = 10.0f * expf(i * logf(2400.0f) / BUF_SIZE);
+
+        FloatBuffer *dst1[n_gains], *dst2[n_gains];
+        float *out[n_gains];
+        for (size_t i=0; i<n_gains; ++i)
+        {
+            dst1[i]         = new FloatBuffer(BUF_SIZE * 2);
+            dst2[i]         = new FloatBuffer(BUF_SIZE * 2);
+            out[i]          = dst1[i]->data();
+        }
+
+        UTEST_ASSERT(df.freq_chart(0, out, f, gains, n_gains, BUF_SIZE));
+        for (size_t i=0; i<n_gains; ++i)
+        {
+            UTEST_ASSERT(df.freq_chart(0, dst2[i]->data(), f, gains[i], BUF_SIZE));
+            UTEST_ASSERT(dst1[i]->valid());
+            UTEST_ASSERT(dst2[i]->valid());
+            if (!dst1[i]->equals_absolute(*dst2[i], 1e-4f))
+            {
+                dst1[i]->dump("dst1");
+                dst2[i]->dump("dst2");
+                UTEST_FAIL_MSG("Frequency chart for gain %f differs", gains[i]);
+            }
+        }
+
+        for (size_t i=0; i<n_gains; ++i)
+        {
+            delete dst1[i];
+            delete dst2[i];
+        }
+        df.destroy();
+    }
+
+    UTEST_MAIN
+    {
+        static const size_t types[] =
+        {
+            dspu::FLT_BT_RLC_BELL,
+            dspu::FLT_MT_RLC_LOSHELF,
+            dspu::FLT_BT_BWC_HISHELF,
+            dspu::FLT_BT_LRX_LADDERPASS
+        };
+
+        for (size_t i=0; i<sizeof(types)/sizeof(types[0]); ++i)
+        {
+            test_decimation(types[i], 1, 4);
+            test_decimation(types[i], 4, 16);
+            test_channels(types[i], 2, 2);
+            test_channels(types[i], 3, 4);
+            test_freq_chart(types[i], 4);
+        }
+    }
+
+UTEST_END
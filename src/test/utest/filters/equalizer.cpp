@@ -24,6 +24,7 @@
 #include <lsp-plug.in/test-fw/FloatBuffer.h>
 #include <lsp-plug.in/dsp-units/filters/Equalizer.h>
 #include <lsp-plug.in/io/File.h>
+#include <lsp-plug.in/ipc/Thread.h>
 
 using namespace lsp;
 
@@ -84,11 +85,145 @@ UTEST_BEGIN("dspu.filters", equalizer)
         eq.destroy();
     }
 
+    void test_freq_chart()
+    {
+        static const size_t types[] = { dspu::FLT_BT_LRX_HIPASS, dspu::FLT_MT_RLC_BELL, dspu::FLT_DR_APO_PEAKING };
+        static const size_t points  = 640;
+
+        dspu::Equalizer eq;
+        dspu::filter_params_t fp;
+
+        printf("Testing batched equalizer frequency chart\n");
+
+        eq.init(3, 0);
+        eq.set_mode(dspu::EQM_IIR);
+        eq.set_sample_rate(48000);
+
+        for (size_t i=0; i<3; ++i)
+        {
+            fp.nType    = types[i];
+            fp.fFreq    = 100.0f * (i + 1) * (i + 1);
+            fp.fFreq2   = fp.fFreq;
+            fp.fGain    = 2.0f;
+            fp.nSlope   = 2;
+            fp.fQuality = 0.5f;
+            eq.set_params(i, &fp);
+        }
+
+        FloatBuffer f(points);
+        FloatBuffer re(points), im(points), c(points * 2);
+        FloatBuffer xre(points), xim(points), rre(points), rim(points);
+
+        for (size_t i=0; i<points; ++i)
+            f[i]        = 10.0f * expf(i * logf(2000.0f) / points);
+
+        // Compute reference chart as a product of charts of each filter
+        dsp::fill_one(rre, points);
+        dsp::fill_zero(rim, points);
+        for (size_t i=0; i<3; ++i)
+        {
+            UTEST_ASSERT(eq.freq_chart(i, xre, xim, f, points));
+            dsp::complex_mul2(rre, rim, xre, xim, points);
+        }
+
+        // Compute batched charts
+        eq.freq_chart(re, im, f, points);
+        eq.freq_chart(c, f, points);
+
+        UTEST_ASSERT(re.valid());
+        UTEST_ASSERT(im.valid());
+        UTEST_ASSERT(c.valid());
+        for (size_t i=0; i<points; ++i)
+        {
+            if ((!float_equals_absolute(re[i], rre[i], 1e-4f)) ||
+                (!float_equals_absolute(im[i], rim[i], 1e-4f)) ||
+                (!float_equals_absolute(c[i*2], rre[i], 1e-4f)) ||
+                (!float_equals_absolute(c[i*2+1], rim[i], 1e-4f)))
+                UTEST_FAIL_MSG("Chart mismatch at point %d: (%g, %g), (%g, %g) vs (%g, %g)",
+                    int(i), re[i], im[i], c[i*2], c[i*2+1], rre[i], rim[i]);
+        }
+
+        eq.destroy();
+    }
+
+    void test_async(const char *label, dspu::equalizer_mode_t mode)
+    {
+        static const size_t fir_rank    = 10;
+        static const size_t block       = 1 << fir_rank;
+        static const size_t blocks      = 16;
+
+        dspu::Equalizer eq[2];
+        dspu::filter_params_t fp;
+
+        printf("Testing background kernel rebuild for %s mode\n", label);
+
+        for (size_t i=0; i<2; ++i)
+        {
+            UTEST_ASSERT(eq[i].init(1, fir_rank));
+            eq[i].set_mode(mode);
+            eq[i].set_sample_rate(48000);
+        }
+        UTEST_ASSERT(eq[1].set_async(true));
+        UTEST_ASSERT(eq[1].async());
+
+        fp.nType    = dspu::FLT_BT_RLC_BELL;
+        fp.fFreq    = 1000.0f;
+        fp.fFreq2   = 1000.0f;
+        fp.fGain    = 2.0f;
+        fp.nSlope   = 2;
+        fp.fQuality = 1.0f;
+
+        FloatBuffer src(block);
+        FloatBuffer dst1(block);
+        FloatBuffer dst2(block);
+
+        for (size_t j=0; j<blocks; ++j)
+        {
+            // Change the gain of the filter after the first block
+            if (j == 1)
+            {
+                fp.fGain    = 0.5f;
+                eq[0].set_params(0, &fp);
+                eq[1].set_params(0, &fp);
+            }
+            else if (j == 0)
+            {
+                eq[0].set_params(0, &fp);
+                eq[1].set_params(0, &fp);
+            }
+
+            src.randomize(-1.0f, 1.0f);
+            eq[0].process(dst1, src, block);
+            eq[1].process(dst2, src, block);
+            UTEST_ASSERT(eq[0].get_latency() == eq[1].get_latency());
+            ipc::Thread::sleep(10);
+        }
+
+        // After the kernel has been switched, outputs should match
+        UTEST_ASSERT(dst1.valid());
+        UTEST_ASSERT(dst2.valid());
+        if (!dst1.equals_absolute(dst2, 1e-4f))
+        {
+            dst1.dump("dst1");
+            dst2.dump("dst2");
+            UTEST_FAIL_MSG("Output of asynchronous equalizer differs");
+        }
+
+        UTEST_ASSERT(eq[1].set_async(false));
+        eq[0].destroy();
+        eq[1].destroy();
+    }
+
     UTEST_MAIN
     {
+        test_async("FIR", dspu::EQM_FIR);
+        test_async("FFT", dspu::EQM_FFT);
+        test_freq_chart();
         test_latency("FIR", dspu::EQM_FIR);
         test_latency("FFT", dspu::EQM_FFT);
         test_latency("SPM", dspu::EQM_SPM);
+        test_latency("FIR_LL", dspu::EQM_FIR_LL);
+        test_latency("FFT_LL", dspu::EQM_FFT_LL);
     }
 
 UTEST_END
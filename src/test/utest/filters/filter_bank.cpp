@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/filters/FilterBank.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+using namespace lsp;
+
+#define BUF_SIZE        1024
+#define SMOOTH          256
+
+UTEST_BEGIN("dspu.filters", filter_bank)
+
+    static void set_gain(dspu::FilterBank *bank, float gain, size_t count)
+    {
+        bank->begin();
+        for (size_t i=0; i<count; ++i)
+        {
+            dsp::biquad_x1_t *f = bank->add_chain();
+            f->b0   = (i == 0) ? gain : 1.0f;
+            f->b1   = 0.0f;
+            f->b2   = 0.0f;
+            f->a1   = 0.0f;
+            f->a2   = 0.0f;
+            f->p0   = 0.0f;
+            f->p1   = 0.0f;
+            f->p2   = 0.0f;
+        }
+        bank->end(false);
+    }
+
+    void test_smooth(size_t count)
+    {
+        dspu::FilterBank bank;
+        FloatBuffer src(BUF_SIZE);
+        FloatBuffer dst(BUF_SIZE);
+
+        printf("Testing smoothing for %d filters...\n", int(count));
+
+        UTEST_ASSERT(bank.init(count + 1));
+        bank.set_smooth(SMOOTH);
+        set_gain(&bank, 1.0f, count);
+        UTEST_ASSERT(!bank.smoothing());
+
+        // Change the gain, coefficients should be interpolated
+        set_gain(&bank, 2.0f, count);
+        UTEST_ASSERT(bank.smoothing());
+
+        // The impulse response should match the target coefficients
+        bank.impulse_response(dst.data(), BUF_SIZE);
+        UTEST_ASSERT(float_equals_absolute(dst[0], 2.0f));
+
+        // Process constant signal by small chunks
+        dsp::fill_one(src.data(), BUF_SIZE);
+        dst.fill_zero();
+        for (size_t i=0; i<BUF_SIZE; i += 100)
+            bank.process(&dst.data()[i], &src.data()[i], lsp_min(size_t(BUF_SIZE) - i, size_t(100)));
+        UTEST_ASSERT(!bank.smoothing());
+        UTEST_ASSERT(src.valid());
+        UTEST_ASSERT(dst.valid());
+
+        // Check the ramp
+        UTEST_ASSERT(dst[0] > 1.0f);
+        UTEST_ASSERT(dst[0] < 1.5f);
+        for (size_t i=1; i<BUF_SIZE; ++i)
+        {
+            if (dst[i] < dst[i-1])
+                UTEST_FAIL_MSG("Non-monotonic gain change at sample %d: %f -> %f", int(i), dst[i-1], dst[i]);
+        }
+        for (size_t i=SMOOTH; i<BUF_SIZE; ++i)
+        {
+            if (!float_equals_absolute(dst[i], 2.0f))
+                UTEST_FAIL_MSG("Invalid gain at sample %d: %f", int(i), dst[i]);
+        }
+
+        // Structure change should not be smoothed
+        set_gain(&bank, 1.0f, count + 1);
+        UTEST_ASSERT(!bank.smoothing());
+
+        bank.destroy();
+    }
+
+    void test_cascade(size_t count)
+    {
+        dspu::FilterBank bank;
+        FloatBuffer src(BUF_SIZE);
+        FloatBuffer dst(BUF_SIZE);
+        FloatBuffer ref(BUF_SIZE);
+
+        printf("Testing cascade of %d filters...\n", int(count));
+
+        // Stable filters with different complex poles
+        UTEST_ASSERT(bank.init(count));
+        bank.begin();
+        for (size_t i=0; i<count; ++i)
+        {
+            float r     = 0.5f + 0.4f * i / count;
+            float w     = 0.1f + 0.3f * i;
+            dsp::biquad_x1_t *f = bank.add_chain();
+            f->b0   = 0.25f + 0.05f * i;
+            f->b1   = -0.2f;
+            f->b2   = 0.1f;
+            f->a1   = 2.0f * r * cosf(w);
+            f->a2   = -r * r;
+            f->p0   = 0.0f;
+            f->p1   = 0.0f;
+            f->p2   = 0.0f;
+        }
+        bank.end(true);
+
+        // Reference direct form II transposed cascade in double precision
+        double d[32][2];
+        for (size_t j=0; j<count; ++j)
+            d[j][0]     = d[j][1] = 0.0;
+        src.randomize_sign();
+        for (size_t i=0; i<BUF_SIZE; ++i)
+        {
+            double s    = src[i];
+            for (size_t j=0; j<count; ++j)
+            {
+                const dsp::biquad_x1_t *f = bank.chain(j);
+                double r    = f->b0 * s + d[j][0];
+                d[j][0]     = d[j][1] + f->b1 * s + f->a1 * r;
+                d[j][1]     = f->b2 * s + f->a2 * r;
+                s           = r;
+            }
+            ref[i]      = s;
+        }
+
+        // Process by blocks of different size to check the state
+        for (size_t i=0, n=1; i<BUF_SIZE; i += n, n = n*2 + 1)
+            bank.process(&dst[i], &src[i], lsp_min(size_t(BUF_SIZE) - i, n));
+        UTEST_ASSERT(src.valid());
+        UTEST_ASSERT(dst.valid());
+
+        if (!dst.equals_absolute(ref, 1e-4f))
+        {
+            ref.dump("ref");
+            dst.dump("dst");
+            UTEST_FAIL_MSG("Output of the cascade of %d filters differs", int(count));
+        }
+
+        bank.destroy();
+    }
+
+    UTEST_MAIN
+    {
+        test_smooth(1);
+        test_smooth(3);
+        test_smooth(12);
+
+        for (size_t i=1; i<=6; ++i)
+            test_cascade(i);
+        test_cascade(13);
+    }
+
+UTEST_END;
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/filters/Filter.h>
+#include <lsp-plug.in/dsp-units/filters/FilterCache.h>
+
+using namespace lsp;
+
+#define BUF_SIZE        512
+
+UTEST_BEGIN("dspu.filters", filter_cache)
+
+    static void set_params(dspu::filter_params_t *fp, size_t type, float freq, float gain, size_t slope)
+    {
+        fp->nType       = type;
+        fp->fFreq       = freq;
+        fp->fFreq2      = freq;
+        fp->fGain       = gain;
+        fp->nSlope      = slope;
+        fp->fQuality    = 0.5f;
+    }
+
+    void test_filter(dspu::Filter *cached, dspu::Filter *plain, const dspu::filter_params_t *fp)
+    {
+        FloatBuffer b1(BUF_SIZE);
+        FloatBuffer b2(BUF_SIZE);
+
+        cached->update(48000, fp);
+        plain->update(48000, fp);
+        UTEST_ASSERT(cached->impulse_response(b1.data(), BUF_SIZE));
+        UTEST_ASSERT(plain->impulse_response(b2.data(), BUF_SIZE));
+        UTEST_ASSERT(cached->active() == plain->active());
+
+        UTEST_ASSERT(b1.valid());
+        UTEST_ASSERT(b2.valid());
+        if (!b1.equals_absolute(b2, 1e-6f))
+        {
+            b1.dump("b1");
+            b2.dump("b2");
+            UTEST_FAIL_MSG("Impulse response of cached filter type=%d differs", int(fp->nType));
+        }
+    }
+
+    UTEST_MAIN
+    {
+        dspu::FilterCache cache;
+        dspu::Filter cached, plain;
+        dspu::filter_params_t fp[4];
+
+        UTEST_ASSERT(cache.init(2));
+        UTEST_ASSERT(cached.init(NULL));
+        UTEST_ASSERT(plain.init(NULL));
+        cached.set_cache(&cache);
+
+        set_params(&fp[0], dspu::FLT_BT_BWC_LOPASS, 1000.0f, 1.0f, 4);
+        set_params(&fp[1], dspu::FLT_MT_RLC_BELL, 440.0f, 2.0f, 2);
+        set_params(&fp[2], dspu::FLT_BT_LRX_HIPASS, 200.0f, 1.0f, 3);
+        set_params(&fp[3], dspu::FLT_DR_APO_PEAKING, 3000.0f, 0.5f, 1);
+
+        // Fill the cache
+        test_filter(&cached, &plain, &fp[0]);
+        test_filter(&cached, &plain, &fp[1]);
+        UTEST_ASSERT(cache.size() == 2);
+        UTEST_ASSERT(cache.misses() == 2);
+        UTEST_ASSERT(cache.hits() == 0);
+
+        // Obtain filters from the cache
+        test_filter(&cached, &plain, &fp[0]);
+        test_filter(&cached, &plain, &fp[1]);
+        UTEST_ASSERT(cache.hits() == 2);
+
+        // Evict least recently used filter (fp[0])
+        test_filter(&cached, &plain, &fp[2]);
+        test_filter(&cached, &plain, &fp[1]);
+        UTEST_ASSERT(cache.hits() == 3);
+        test_filter(&cached, &plain, &fp[0]);
+        UTEST_ASSERT(cache.hits() == 3);
+        UTEST_ASSERT(cache.misses() == 4);
+
+        // Check APO filter
+        test_filter(&cached, &plain, &fp[3]);
+        test_filter(&cached, &plain, &fp[3]);
+        UTEST_ASSERT(cache.hits() == 4);
+        UTEST_ASSERT(cache.size() == 2);
+
+        cached.destroy();
+        plain.destroy();
+        cache.destroy();
+    }
+
+UTEST_END
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/filters/MultiEqualizer.h>
+
+using namespace lsp;
+
+#define CHANNELS        5
+#define FILTERS         3
+#define FIR_RANK        10
+#define SRATE           48000
+#define BUF_SIZE        0x1800
+
+UTEST_BEGIN("dspu.filters", multi_equalizer)
+
+    template <class E>
+        void setup(E *eq, dspu::equalizer_mode_t mode)
+        {
+            dspu::filter_params_t fp;
+
+            eq->set_sample_rate(SRATE);
+            eq->set_mode(mode);
+
+            fp.nType    = dspu::FLT_BT_LRX_HIPASS;
+            fp.fFreq    = 100.0f;
+            fp.fFreq2   = 100.0f;
+            fp.fGain    = 1.0f;
+            fp.nSlope   = 2;
+            fp.fQuality = 0.0f;
+            eq->set_params(0, &fp);
+
+            fp.nType    = dspu::FLT_BT_BWC_BELL;
+            fp.fFreq    = 1000.0f;
+            fp.fFreq2   = 1000.0f;
+            fp.fGain    = 2.0f;
+            fp.nSlope   = 2;
+            fp.fQuality = 1.0f;
+            eq->set_params(1, &fp);
+
+            fp.nType    = dspu::FLT_BT_LRX_LOSHELF;
+            fp.fFreq    = 300.0f;
+            fp.fFreq2   = 300.0f;
+            fp.fGain    = 0.5f;
+            fp.nSlope   = 1;
+            fp.fQuality = 0.0f;
+            eq->set_params(2, &fp);
+        }
+
+    void test_mode(const char *label, dspu::equalizer_mode_t mode)
+    {
+        printf("Testing multi-channel equalizer in %s mode\n", label);
+
+        dspu::MultiEqualizer meq;
+        dspu::Equalizer *eq = new dspu::Equalizer[CHANNELS];
+
+        UTEST_ASSERT(meq.init(CHANNELS, FILTERS, FIR_RANK));
+        UTEST_ASSERT(meq.channels() == CHANNELS);
+        setup(&meq, mode);
+
+        FloatBuffer *in[CHANNELS], *out[CHANNELS], *ref[CHANNELS];
+        for (size_t i=0; i<CHANNELS; ++i)
+        {
+            UTEST_ASSERT(eq[i].init(FILTERS, FIR_RANK));
+            setup(&eq[i], mode);
+
+            in[i]       = new FloatBuffer(BUF_SIZE);
+            out[i]      = new FloatBuffer(BUF_SIZE);
+            ref[i]      = new FloatBuffer(BUF_SIZE);
+            in[i]->randomize(-1.0f, 1.0f);
+            out[i]->fill_zero();
+            eq[i].process(ref[i]->data(), in[i]->data(), BUF_SIZE);
+        }
+
+        UTEST_ASSERT(meq.get_latency() == eq[0].get_latency());
+
+        // Process by chunks of different size
+        for (size_t off=0, step=1; off < BUF_SIZE; step = step*2 + 1)
+        {
+            size_t to_do = lsp_min(size_t(BUF_SIZE) - off, step);
+            float *d[CHANNELS];
+            const float *s[CHANNELS];
+            for (size_t i=0; i<CHANNELS; ++i)
+            {
+                d[i]    = &out[i]->data()[off];
+                s[i]    = &in[i]->data()[off];
+            }
+            meq.process(d, s, to_do);
+            off    += to_do;
+        }
+
+        for (size_t i=0; i<CHANNELS; ++i)
+        {
+            UTEST_ASSERT(in[i]->valid());
+            UTEST_ASSERT(out[i]->valid());
+            UTEST_ASSERT(ref[i]->valid());
+            if (!out[i]->equals_absolute(*ref[i], 1e-4f))
+            {
+                ref[i]->dump("ref");
+                out[i]->dump("out");
+                UTEST_FAIL_MSG("Output of %s equalizer for channel %d differs", label, int(i));
+            }
+
+            delete in[i];
+            delete out[i];
+            delete ref[i];
+        }
+
+        delete [] eq;
+        meq.destroy();
+    }
+
+    UTEST_MAIN
+    {
+        test_mode("IIR", dspu::EQM_IIR);
+        test_mode("FIR", dspu::EQM_FIR);
+        test_mode("FFT", dspu::EQM_FFT);
+        test_mode("SPM", dspu::EQM_SPM);
+        test_mode("FIR_LL", dspu::EQM_FIR_LL);
+        test_mode("FFT_LL", dspu::EQM_FFT_LL);
+        test_mode("bypass", dspu::EQM_BYPASS);
+    }
+
+UTEST_END
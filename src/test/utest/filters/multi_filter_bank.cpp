@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/filters/MultiFilterBank.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+using namespace lsp;
+
+#define CHANNELS        11
+#define FILTERS         13
+#define BUF_SIZE        1000
+
+UTEST_BEGIN("dspu.filters", multi_filter_bank)
+
+    void init_chain(dsp::biquad_x1_t *f, size_t i)
+    {
+        // Stable resonator
+        float r     = 0.3f + 0.03f * i;
+        float w     = 0.1f + 0.2f * i;
+        f->b0       = 0.5f + i * 0.05f;
+        f->b1       = 0.2f;
+        f->b2       = -0.1f;
+        f->a1       = 2.0f * r * cosf(w);
+        f->a2       = -r * r;
+        f->p0       = 0.0f;
+        f->p1       = 0.0f;
+        f->p2       = 0.0f;
+    }
+
+    UTEST_MAIN
+    {
+        FloatBuffer *in[CHANNELS], *out[CHANNELS], *ref[CHANNELS];
+        float *vin[CHANNELS], *vout[CHANNELS];
+
+        // Prepare single-channel filter bank
+        dspu::FilterBank bank;
+        UTEST_ASSERT(bank.init(FILTERS));
+        bank.begin();
+        for (size_t i=0; i<FILTERS; ++i)
+            init_chain(bank.add_chain(), i);
+        bank.end(true);
+        UTEST_ASSERT(bank.size() == FILTERS);
+
+        // Prepare multi-channel filter bank
+        dspu::MultiFilterBank mbank;
+        UTEST_ASSERT(mbank.init(CHANNELS, FILTERS));
+        mbank.load(&bank, true);
+        UTEST_ASSERT(mbank.size() == FILTERS);
+        UTEST_ASSERT(mbank.channels() == CHANNELS);
+
+        // Generate signals and the reference output
+        for (size_t i=0; i<CHANNELS; ++i)
+        {
+            in[i]       = new FloatBuffer(BUF_SIZE);
+            out[i]      = new FloatBuffer(BUF_SIZE);
+            ref[i]      = new FloatBuffer(BUF_SIZE);
+            in[i]->randomize(-1.0f, 1.0f);
+            out[i]->fill_zero();
+            bank.reset();
+            bank.process(ref[i]->data(), in[i]->data(), BUF_SIZE);
+
+            vin[i]      = in[i]->data();
+            vout[i]     = out[i]->data();
+        }
+
+        // Process by chunks of different size
+        for (size_t off=0, step=1; off < BUF_SIZE; step = step*2 + 1)
+        {
+            size_t to_do = lsp_min(BUF_SIZE - off, step);
+            float *d[CHANNELS];
+            const float *s[CHANNELS];
+            for (size_t i=0; i<CHANNELS; ++i)
+            {
+                d[i]    = &vout[i][off];
+                s[i]    = &vin[i][off];
+            }
+            mbank.process(d, s, to_do);
+            off    += to_do;
+        }
+
+        // Check results
+        for (size_t i=0; i<CHANNELS; ++i)
+        {
+            UTEST_ASSERT(in[i]->valid());
+            UTEST_ASSERT(out[i]->valid());
+            UTEST_ASSERT(ref[i]->valid());
+            if (!out[i]->equals_relative(*ref[i], 1e-3f))
+            {
+                ref[i]->dump("ref");
+                out[i]->dump("out");
+                UTEST_FAIL_MSG("Output of channel %d differs", int(i));
+            }
+
+            delete in[i];
+            delete out[i];
+            delete ref[i];
+        }
+
+        mbank.destroy();
+        bank.destroy();
+    }
+
+UTEST_END;
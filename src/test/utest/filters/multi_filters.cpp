@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/filters/MultiButterworthFilter.h>
+#include <lsp-plug.in/dsp-units/filters/MultiSpectralTilt.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+using namespace lsp;
+
+#define CHANNELS        11
+#define SRATE           48000
+#define BUF_SIZE        1000
+
+UTEST_BEGIN("dspu.filters", multi_filters)
+
+    template <class S>
+        void setup_tilt(S *f)
+        {
+            f->set_sample_rate(SRATE);
+            f->set_order(20);
+            f->set_slope(-3.0f, dspu::STLT_SLOPE_UNIT_DB_PER_OCTAVE);
+            f->set_lower_frequency(20.0f);
+            f->set_upper_frequency(20000.0f);
+            f->update_settings();
+        }
+
+    template <class S>
+        void setup_butterworth(S *f)
+        {
+            f->set_sample_rate(SRATE);
+            f->set_order(8);
+            f->set_cutoff_frequency(1000.0f);
+            f->set_filter_type(dspu::BW_FLT_TYPE_HIGHPASS);
+            f->update_settings();
+        }
+
+    template <class M, class S>
+        void check(const char *label, M *mf, S *sf)
+        {
+            printf("Testing multi-channel %s filter\n", label);
+
+            FloatBuffer *in[CHANNELS], *out[CHANNELS], *add[CHANNELS], *ref[CHANNELS];
+            float *vin[CHANNELS], *vout[CHANNELS], *vadd[CHANNELS];
+
+            UTEST_ASSERT(mf->channels() == CHANNELS);
+            UTEST_ASSERT(!mf->needs_update());
+            UTEST_ASSERT(!mf->bypassed());
+
+            // Generate signals and the reference output, each channel has its own filter
+            for (size_t i=0; i<CHANNELS; ++i)
+            {
+                in[i]       = new FloatBuffer(BUF_SIZE);
+                out[i]      = new FloatBuffer(BUF_SIZE);
+                add[i]      = new FloatBuffer(BUF_SIZE);
+                ref[i]      = new FloatBuffer(BUF_SIZE);
+                in[i]->randomize(-1.0f, 1.0f);
+                out[i]->fill_zero();
+                add[i]->fill_one();
+                sf[i].process_overwrite(ref[i]->data(), in[i]->data(), BUF_SIZE);
+
+                vin[i]      = in[i]->data();
+                vout[i]     = out[i]->data();
+                vadd[i]     = add[i]->data();
+            }
+
+            // Process by chunks of different size
+            for (size_t off=0, step=1; off < BUF_SIZE; step = step*2 + 1)
+            {
+                size_t to_do = lsp_min(BUF_SIZE - off, step);
+                float *d[CHANNELS];
+                const float *s[CHANNELS];
+                for (size_t i=0; i<CHANNELS; ++i)
+                {
+                    d[i]    = &vout[i][off];
+                    s[i]    = &vin[i][off];
+                }
+                mf->process_overwrite(d, s, to_do);
+                off    += to_do;
+            }
+
+            // Additive mode continues the same filter memory from the start
+            mf->reset();
+            mf->process_add(vadd, vin, BUF_SIZE);
+
+            // Check results
+            for (size_t i=0; i<CHANNELS; ++i)
+            {
+                UTEST_ASSERT(in[i]->valid());
+                UTEST_ASSERT(out[i]->valid());
+                UTEST_ASSERT(add[i]->valid());
+                UTEST_ASSERT(ref[i]->valid());
+                if (!out[i]->equals_relative(*ref[i], 1e-3f))
+                {
+                    ref[i]->dump("ref");
+                    out[i]->dump("out");
+                    UTEST_FAIL_MSG("Output of %s filter for channel %d differs", label, int(i));
+                }
+
+                for (size_t j=0; j<BUF_SIZE; ++j)
+                    vout[i][j]     += 1.0f;
+                if (!out[i]->equals_relative(*add[i], 1e-3f))
+                {
+                    out[i]->dump("out");
+                    add[i]->dump("add");
+                    UTEST_FAIL_MSG("Additive output of %s filter for channel %d differs", label, int(i));
+                }
+
+                delete in[i];
+                delete out[i];
+                delete add[i];
+                delete ref[i];
+            }
+        }
+
+    UTEST_MAIN
+    {
+        // Spectral tilt
+        dspu::MultiSpectralTilt mtilt;
+        dspu::SpectralTilt *tilt = new dspu::SpectralTilt[CHANNELS];
+        UTEST_ASSERT(mtilt.init(CHANNELS));
+        setup_tilt(&mtilt);
+        for (size_t i=0; i<CHANNELS; ++i)
+            setup_tilt(&tilt[i]);
+        check("spectral tilt", &mtilt, tilt);
+        delete [] tilt;
+
+        // Zero slope bypasses the filter
+        mtilt.set_slope(0.0f, dspu::STLT_SLOPE_UNIT_DB_PER_OCTAVE);
+        UTEST_ASSERT(mtilt.needs_update());
+        mtilt.update_settings();
+        UTEST_ASSERT(mtilt.bypassed());
+        mtilt.destroy();
+
+        // Butterworth filter
+        dspu::MultiButterworthFilter mbw;
+        dspu::ButterworthFilter *bw = new dspu::ButterworthFilter[CHANNELS];
+        UTEST_ASSERT(mbw.init(CHANNELS));
+        setup_butterworth(&mbw);
+        for (size_t i=0; i<CHANNELS; ++i)
+            setup_butterworth(&bw[i]);
+        check("butterworth", &mbw, bw);
+        delete [] bw;
+        mbw.destroy();
+    }
+
+UTEST_END;
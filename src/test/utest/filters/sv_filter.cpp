@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/filters/SVFilter.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+using namespace lsp;
+
+#define SAMPLE_RATE     48000
+#define FREQ            1000.0f
+#define QUALITY         2.0f
+#define GAIN            4.0f
+#define BUF_SIZE        0x4000
+
+UTEST_BEGIN("dspu.filters", sv_filter)
+
+    void setup(dspu::SVFilter &f, dspu::svf_type_t type)
+    {
+        f.set_sample_rate(SAMPLE_RATE);
+        f.set_type(type);
+        f.set_frequency(FREQ);
+        f.set_quality(QUALITY);
+        f.set_gain(GAIN);
+        f.update_settings();
+        UTEST_ASSERT(!f.needs_update());
+    }
+
+    // Amplitude of the steady-state response to the sine wave
+    float response(dspu::SVFilter &f, float freq)
+    {
+        FloatBuffer buf(BUF_SIZE);
+        for (size_t i=0; i<BUF_SIZE; ++i)
+            buf[i]      = sinf(2.0f * M_PI * freq * i / SAMPLE_RATE);
+        f.clear();
+        f.process(buf, buf, BUF_SIZE);
+        UTEST_ASSERT(buf.valid());
+
+        size_t tail     = BUF_SIZE / 2;
+        return sqrtf(2.0f * dsp::h_sqr_sum(&buf[BUF_SIZE - tail], tail) / tail);
+    }
+
+    void test_response(const char *label, dspu::svf_type_t type, float freq, float expected)
+    {
+        printf("Testing response of %s filter at %.1f Hz\n", label, freq);
+
+        dspu::SVFilter f;
+        setup(f, type);
+        float amp = response(f, freq);
+        UTEST_ASSERT_MSG(float_equals_absolute(amp, expected, 2e-2f * lsp_max(expected, 1.0f)),
+            "Response of %s filter: %f, expected %f", label, amp, expected);
+    }
+
+    void test_modulation()
+    {
+        printf("Testing frequency modulation\n");
+
+        dspu::SVFilter f1, f2;
+        setup(f1, dspu::SVF_BELL);
+        setup(f2, dspu::SVF_BELL);
+
+        FloatBuffer src(BUF_SIZE), freq(BUF_SIZE), dst1(BUF_SIZE), dst2(BUF_SIZE);
+        src.randomize_sign();
+
+        // Constant modulation gives the same result as the static filter
+        dsp::fill(freq, FREQ, BUF_SIZE);
+        f1.process(dst1, src, BUF_SIZE);
+        f2.process(dst2, src, freq, BUF_SIZE);
+        UTEST_ASSERT(dst1.valid() && dst2.valid());
+        if (!dst1.equals_absolute(dst2, 1e-4f))
+            UTEST_FAIL_MSG("Modulated filter differs from the static one");
+
+        // The filter remains stable when the frequency jumps at each sample
+        setup(f2, dspu::SVF_LOPASS);
+        f2.set_quality(20.0f);
+        for (size_t i=0; i<BUF_SIZE; ++i)
+            freq[i]     = (i & 1) ? 20.0f : 20000.0f;
+        f2.process(dst2, src, freq, BUF_SIZE);
+        UTEST_ASSERT(dst2.valid());
+        for (size_t i=0; i<BUF_SIZE; ++i)
+            UTEST_ASSERT_MSG(fabsf(dst2[i]) < 100.0f, "Unstable output at sample %d: %f", int(i), dst2[i]);
+    }
+
+    UTEST_MAIN
+    {
+        test_response("low-pass", dspu::SVF_LOPASS, FREQ, QUALITY);
+        test_response("low-pass", dspu::SVF_LOPASS, 20.0f, 1.0f);
+        test_response("high-pass", dspu::SVF_HIPASS, FREQ, QUALITY);
+        test_response("high-pass", dspu::SVF_HIPASS, 15000.0f, 1.0f);
+        test_response("band-pass", dspu::SVF_BANDPASS, FREQ, 1.0f);
+        test_response("notch", dspu::SVF_NOTCH, FREQ, 0.0f);
+        test_response("all-pass", dspu::SVF_ALLPASS, 300.0f, 1.0f);
+        test_response("bell", dspu::SVF_BELL, FREQ, GAIN);
+        test_response("low shelf", dspu::SVF_LOSHELF, 20.0f, GAIN);
+        test_response("low shelf", dspu::SVF_LOSHELF, FREQ, sqrtf(GAIN));
+        test_response("high shelf", dspu::SVF_HISHELF, 20000.0f, GAIN);
+        test_response("high shelf", dspu::SVF_HISHELF, FREQ, sqrtf(GAIN));
+        test_modulation();
+    }
+
+UTEST_END
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/misc/envelope.h>
+#include <lsp-plug.in/dsp-units/const.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define SAMPLES     0x1003      /* Not a multiple of the block size */
+
+UTEST_BEGIN("dspu.misc", envelope)
+
+    void test_curve(const char *label, dspu::envelope::envelope_t type, double k)
+    {
+        printf("Testing %s envelope\n", label);
+
+        FloatBuffer dst(SAMPLES);
+        dspu::envelope::noise(dst, SAMPLES, type);
+        UTEST_ASSERT_MSG(dst.valid(), "Destination buffer corrupted");
+
+        // Compare with the double-precision power law
+        double kd   = (LSP_DSP_UNITS_SPEC_FREQ_MAX / LSP_DSP_UNITS_SPEC_FREQ_MIN) / double(SAMPLES);
+        UTEST_ASSERT(dst[0] == 1.0f);
+        for (size_t i=1; i<SAMPLES; ++i)
+        {
+            double v    = pow(i * kd, k);
+            UTEST_ASSERT_MSG(float_equals_relative(dst[i], v, 1e-4f),
+                "Invalid %s envelope sample %d: %f, expected %f", label, int(i), dst[i], v);
+        }
+    }
+
+    void test_cache()
+    {
+        printf("Testing cached envelope tables\n");
+
+        FloatBuffer ref(SAMPLES);
+        dspu::envelope::reverse_noise(ref, SAMPLES, dspu::envelope::PINK_NOISE);
+
+        const float *t1 = dspu::envelope::acquire(dspu::envelope::PINK_NOISE, SAMPLES, true);
+        const float *t2 = dspu::envelope::acquire(dspu::envelope::PINK_NOISE, SAMPLES, true);
+        const float *t3 = dspu::envelope::acquire(dspu::envelope::PINK_NOISE, SAMPLES, false);
+        UTEST_ASSERT((t1 != NULL) && (t2 != NULL) && (t3 != NULL));
+        UTEST_ASSERT(t1 == t2);
+        UTEST_ASSERT(t1 != t3);
+
+        for (size_t i=0; i<SAMPLES; ++i)
+            UTEST_ASSERT_MSG(t1[i] == ref[i], "Cached table differs at sample %d: %f vs %f", int(i), t1[i], ref[i]);
+
+        dspu::envelope::release(t1);
+        dspu::envelope::release(t2);
+        dspu::envelope::release(t3);
+    }
+
+    UTEST_MAIN
+    {
+        test_curve("white", dspu::envelope::WHITE_NOISE, 0.0);
+        test_curve("pink", dspu::envelope::PINK_NOISE, -0.5);
+        test_curve("brown", dspu::envelope::BROWN_NOISE, -1.0);
+        test_curve("blue", dspu::envelope::BLUE_NOISE, 0.5);
+        test_curve("violet", dspu::envelope::VIOLET_NOISE, 1.0);
+        test_cache();
+    }
+
+UTEST_END
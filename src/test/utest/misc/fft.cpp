@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/misc/fft.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#define MIN_RANK    2
+#define MAX_RANK    14
+
+UTEST_BEGIN("dspu.misc", fft)
+
+    void test_transform(size_t rank, const float *table, size_t table_rank)
+    {
+        printf("Testing real transforms of rank %d with table of rank %d\n", int(rank), int(table_rank));
+
+        size_t n        = 1 << rank;
+        size_t m        = n >> 1;
+        float tol       = 1e-6f * n;
+
+        FloatBuffer src(n), ref(n * 2), dst(n * 2);
+        src.randomize_sign();
+
+        // Reference direct transform
+        dsp::pcomplex_r2c(ref, src, n);
+        dsp::packed_direct_fft(ref, ref, rank);
+
+        dsp::fill_zero(dst, n * 2);
+        dspu::fft::real_direct(dst, src, rank, table, table_rank);
+        UTEST_ASSERT(dst.valid());
+        for (size_t i=0; i<(m + 1)*2; ++i)
+            UTEST_ASSERT_MSG(float_equals_absolute(dst[i], ref[i], tol),
+                "Direct transform differs at %d: %f vs %f", int(i), dst[i], ref[i]);
+
+        // Expand the spectrum to the full one
+        dspu::fft::real_expand(dst, rank);
+        UTEST_ASSERT(dst.valid());
+        for (size_t i=0; i<n*2; ++i)
+            UTEST_ASSERT_MSG(float_equals_absolute(dst[i], ref[i], tol),
+                "Expanded spectrum differs at %d: %f vs %f", int(i), dst[i], ref[i]);
+
+        // Add the spectrum of the random imaginary signal, fold it and perform reverse transform
+        FloatBuffer tmp(n);
+        tmp.randomize_sign();
+        dsp::fill_zero(ref, n * 2);
+        for (size_t i=0; i<n; ++i)
+            ref[i*2 + 1]    = tmp[i];
+        dsp::packed_direct_fft(ref, ref, rank);
+        dsp::add2(dst, ref, n * 2);
+        dsp::copy(ref, dst, n * 2);
+
+        dspu::fft::real_fold(dst, rank);
+        dspu::fft::real_reverse(dst, dst, rank, table, table_rank);
+        UTEST_ASSERT(dst.valid());
+        for (size_t i=0; i<n; ++i)
+            UTEST_ASSERT_MSG(float_equals_absolute(dst[i], src[i], 1e-5f),
+                "Reverse transform differs at %d: %f vs %f", int(i), dst[i], src[i]);
+
+        dsp::packed_reverse_fft(ref, ref, rank);
+        dsp::pcomplex_c2r(ref, ref, n);
+        for (size_t i=0; i<n; ++i)
+            UTEST_ASSERT_MSG(float_equals_absolute(dst[i], ref[i], 1e-5f),
+                "Reverse transform differs from reference at %d: %f vs %f", int(i), dst[i], ref[i]);
+    }
+
+    UTEST_MAIN
+    {
+        // The same table is shared by the requests of the same rank
+        const float *t1 = dspu::fft::acquire(MAX_RANK);
+        const float *t2 = dspu::fft::acquire(MAX_RANK);
+        UTEST_ASSERT((t1 != NULL) && (t1 == t2));
+        UTEST_ASSERT(dspu::fft::acquire(1) == NULL);
+
+        for (size_t rank=MIN_RANK; rank<=MAX_RANK; ++rank)
+        {
+            test_transform(rank, t1, MAX_RANK);
+
+            const float *t = dspu::fft::acquire(rank);
+            UTEST_ASSERT(t != NULL);
+            test_transform(rank, t, rank);
+            dspu::fft::release(t);
+        }
+
+        dspu::fft::release(t1);
+        dspu::fft::release(t2);
+    }
+
+UTEST_END
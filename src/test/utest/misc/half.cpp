@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/misc/half.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define SAMPLES     0x1000
+
+UTEST_BEGIN("dspu.misc", half)
+
+    void test_fp16_exact()
+    {
+        printf("Testing exact binary16 conversion\n");
+
+        // All finite binary16 values should survive the round trip
+        uint16_t *src   = new uint16_t[0x10000];
+        uint16_t *dst   = new uint16_t[0x10000];
+        float *buf      = new float[0x10000];
+        for (size_t i=0; i<0x10000; ++i)
+            src[i]          = uint16_t(i);
+
+        dspu::half::decode_fp16(buf, src, 0x10000);
+        dspu::half::encode_fp16(dst, buf, 0x10000);
+        for (size_t i=0; i<0x10000; ++i)
+        {
+            if ((i & 0x7c00) == 0x7c00)
+                continue;
+            UTEST_ASSERT_MSG(src[i] == dst[i], "Invalid round trip of 0x%04x: %g -> 0x%04x", int(src[i]), buf[i], int(dst[i]));
+        }
+
+        // Some well-known values
+        UTEST_ASSERT(buf[0x3c00] == 1.0f);
+        UTEST_ASSERT(buf[0xc000] == -2.0f);
+        UTEST_ASSERT(buf[0x7bff] == 65504.0f);
+        UTEST_ASSERT(buf[0x0001] == 5.9604644775390625e-8f);
+
+        // Saturation
+        float big       = 1e+6f;
+        dspu::half::encode_fp16(dst, &big, 1);
+        UTEST_ASSERT(dst[0] == 0x7bff);
+
+        delete [] src;
+        delete [] dst;
+        delete [] buf;
+    }
+
+    void test_error(const char *label, dspu::half::format_t format, float tol)
+    {
+        printf("Testing %s conversion error\n", label);
+
+        FloatBuffer src(SAMPLES), dst(SAMPLES);
+        uint16_t *tmp   = new uint16_t[SAMPLES];
+        src.randomize(-1000.0f, 1000.0f);
+
+        dspu::half::encode(tmp, src, SAMPLES, format);
+        dspu::half::decode(dst, tmp, SAMPLES, format);
+        UTEST_ASSERT(dst.valid());
+
+        for (size_t i=0; i<SAMPLES; ++i)
+        {
+            if (fabsf(src[i]) < 1e-3f)
+                continue;
+            float err = fabsf(dst[i] - src[i]) / fabsf(src[i]);
+            UTEST_ASSERT_MSG(err <= tol, "Too large %s error at sample %d: %g vs %g", label, int(i), src[i], dst[i]);
+        }
+
+        delete [] tmp;
+    }
+
+    UTEST_MAIN
+    {
+        test_fp16_exact();
+        test_error("binary16", dspu::half::FLOAT16, 1.0f / 2048.0f);
+        test_error("bfloat16", dspu::half::BFLOAT16, 1.0f / 256.0f);
+    }
+
+UTEST_END
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/misc/interpolation.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define SAMPLES     0x333
+
+UTEST_BEGIN("dspu.misc", interpolation)
+
+    void check(const char *label, const float *dst, const float *ref, size_t count, float tol)
+    {
+        for (size_t i=0; i<count; ++i)
+            UTEST_ASSERT_MSG(float_equals_relative(dst[i], ref[i], tol),
+                "Invalid %s value %d: %f, expected %f", label, int(i), dst[i], ref[i]);
+    }
+
+    void test_curves()
+    {
+        printf("Testing array evaluation of curves\n");
+
+        FloatBuffer src(SAMPLES), dst(SAMPLES), ref(SAMPLES);
+        for (size_t i=0; i<SAMPLES; ++i)
+            src[i]      = i * 0.01f - 2.0f;
+
+        float p[4];
+
+        dspu::interpolation::linear(p, -1.0f, 0.5f, 2.0f, 3.0f);
+        for (size_t i=0; i<SAMPLES; ++i)
+            ref[i]      = p[0]*src[i] + p[1];
+        dspu::interpolation::apply_linear(dst, src, p, SAMPLES);
+        UTEST_ASSERT(dst.valid());
+        check("linear", dst, ref, SAMPLES, 1e-5f);
+
+        dspu::interpolation::hermite_quadratic(p, -1.0f, 0.5f, 1.0f, 2.0f, 0.25f);
+        for (size_t i=0; i<SAMPLES; ++i)
+            ref[i]      = (p[0]*src[i] + p[1])*src[i] + p[2];
+        dspu::interpolation::apply_quadratic(dst, src, p, SAMPLES);
+        UTEST_ASSERT(dst.valid());
+        check("quadratic", dst, ref, SAMPLES, 1e-5f);
+
+        dspu::interpolation::hermite_cubic(p, -1.0f, 0.0f, 0.0f, 2.0f, 1.0f, 0.0f);
+        for (size_t i=0; i<SAMPLES; ++i)
+            ref[i]      = ((p[0]*src[i] + p[1])*src[i] + p[2])*src[i] + p[3];
+        dspu::interpolation::apply_cubic(dst, src, p, SAMPLES);
+        UTEST_ASSERT(dst.valid());
+        check("cubic", dst, ref, SAMPLES, 1e-5f);
+
+        dspu::interpolation::exponent(p, -1.0f, 0.0f, 2.0f, 1.0f, 1.5f);
+        for (size_t i=0; i<SAMPLES; ++i)
+            ref[i]      = p[0] + p[1] * expf(p[2] * src[i]);
+
+        // In-place evaluation
+        for (size_t i=0; i<SAMPLES; ++i)
+            dst[i]      = src[i];
+        dspu::interpolation::apply_exponent(dst, dst, p, SAMPLES);
+        UTEST_ASSERT(dst.valid());
+        check("exponent", dst, ref, SAMPLES, 1e-4f);
+    }
+
+    void test_knee()
+    {
+        printf("Testing knee evaluation\n");
+
+        FloatBuffer src(SAMPLES), dst(SAMPLES), ref(SAMPLES);
+        for (size_t i=0; i<SAMPLES; ++i)
+            src[i]      = expf(i * 0.02f - 12.0f);
+
+        // Compressor knee with ratio 4 around threshold exp(-6): gain of the curve in logarithmic domain
+        float ratio = 0.25f, th = -6.0f, x0 = th - 1.0f, x1 = th + 1.0f;
+        float h[3], k[4], l0[2], l1[2];
+        dspu::interpolation::hermite_quadratic(h, x0, x0, 1.0f, x1, ratio);
+        k[0]    = 0.0f;
+        k[1]    = h[0];
+        k[2]    = h[1] - 1.0f;
+        k[3]    = h[2];
+        l0[0]   = 0.0f;
+        l0[1]   = 0.0f;
+        l1[0]   = ratio - 1.0f;
+        l1[1]   = -l1[0] * th;
+
+        for (size_t i=0; i<SAMPLES; ++i)
+        {
+            float lx    = logf(src[i]);
+            float g     = (lx <= x0) ? 0.0f :
+                          (lx >= x1) ? (ratio - 1.0f) * (lx - th) :
+                          (h[0]*lx + h[1] - 1.0f)*lx + h[2];
+            ref[i]      = expf(g);
+        }
+
+        dspu::interpolation::apply_log_knee(dst, src, x0, x1, l0, k, l1, SAMPLES);
+        UTEST_ASSERT(dst.valid());
+        check("log knee", dst, ref, SAMPLES, 1e-4f);
+
+        // The knee is continuous at the boundaries: evaluate the polynom at the boundaries
+        float v[2], r[2];
+        v[0]    = x0;
+        v[1]    = x1;
+        dspu::interpolation::apply_knee(r, v, x0 - 1.0f, x1 + 1.0f, l0, k, l1, 2);
+        UTEST_ASSERT(float_equals_absolute(r[0], 0.0f, 1e-5f));
+        UTEST_ASSERT(float_equals_absolute(r[1], (ratio - 1.0f) * (x1 - th), 1e-5f));
+    }
+
+    UTEST_MAIN
+    {
+        test_curves();
+        test_knee();
+    }
+
+UTEST_END
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/misc/ir.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define IR_SIZE         0x4000
+#define DECAY_SIZE      0x1000
+#define WINDOW          0x100
+#define FIR_SIZE        0x101
+
+UTEST_BEGIN("dspu.misc", ir)
+
+    void test_trim()
+    {
+        printf("Testing truncation at the noise floor\n");
+
+        // Decaying noise down to -120 dB followed by the noise floor at -100 dB
+        FloatBuffer ir(IR_SIZE);
+        ir.randomize_sign();
+        for (size_t i=0; i<IR_SIZE; ++i)
+            ir[i]  *= (i < DECAY_SIZE) ? expf(-13.8f * i / DECAY_SIZE) : 0.0f;
+        for (size_t i=0; i<IR_SIZE; ++i)
+            ir[i]  += 1e-5f * ((rand() & 1) ? 1.0f : -1.0f);
+
+        size_t length = dspu::ir::noise_floor_length(ir, IR_SIZE, WINDOW, 10.0f);
+        printf("  detected length = %d\n", int(length));
+        UTEST_ASSERT((length > DECAY_SIZE / 2) && (length <= DECAY_SIZE));
+
+        FloatBuffer copy(IR_SIZE);
+        dsp::copy(copy, ir, IR_SIZE);
+        UTEST_ASSERT(dspu::ir::trim(copy, IR_SIZE, WINDOW, 10.0f) == length);
+        UTEST_ASSERT(copy.valid());
+        UTEST_ASSERT(copy[length - 1] == 0.0f);
+        UTEST_ASSERT(copy[0] == ir[0]);
+
+        // Trailing silence is removed completely
+        FloatBuffer silent(IR_SIZE);
+        silent.fill_zero();
+        dsp::copy(silent, ir, DECAY_SIZE);
+        length = dspu::ir::noise_floor_length(silent, IR_SIZE, WINDOW, 10.0f);
+        UTEST_ASSERT(length == DECAY_SIZE);
+    }
+
+    void test_minimum_phase()
+    {
+        printf("Testing minimum phase conversion\n");
+
+        // Symmetric (linear phase) low-pass FIR filter
+        FloatBuffer fir(FIR_SIZE), mp(FIR_SIZE);
+        ssize_t center = FIR_SIZE / 2;
+        for (ssize_t i=0; i<FIR_SIZE; ++i)
+        {
+            float x = M_PI * 0.25f * (i - center);
+            float w = 0.5f - 0.5f * cosf(2.0f * M_PI * i / (FIR_SIZE - 1));
+            fir[i]  = ((i == center) ? 0.25f : sinf(x) / (M_PI * (i - center))) * w;
+        }
+
+        UTEST_ASSERT(dspu::ir::minimum_phase(mp, fir, FIR_SIZE));
+        UTEST_ASSERT(mp.valid());
+
+        // The energy is preserved and concentrated at the beginning
+        float e1 = dsp::h_sqr_sum(fir, FIR_SIZE);
+        float e2 = dsp::h_sqr_sum(mp, FIR_SIZE);
+        float h1 = dsp::h_sqr_sum(fir, center / 2);
+        float h2 = dsp::h_sqr_sum(mp, center / 2);
+        printf("  energy = %f vs %f, head energy = %f vs %f\n", e1, e2, h1, h2);
+        UTEST_ASSERT(float_equals_relative(e1, e2, 2e-2f));
+        UTEST_ASSERT(h2 > 0.9f * e2);
+        UTEST_ASSERT(h1 < 0.1f * e1);
+
+        // The DC gain is preserved
+        float dc1 = 0.0f, dc2 = 0.0f;
+        for (size_t i=0; i<FIR_SIZE; ++i)
+        {
+            dc1    += fir[i];
+            dc2    += mp[i];
+        }
+        UTEST_ASSERT_MSG(float_equals_relative(dc1, dc2, 1e-2f), "DC gain differs: %f vs %f", dc1, dc2);
+    }
+
+    UTEST_MAIN
+    {
+        test_trim();
+        test_minimum_phase();
+    }
+
+UTEST_END
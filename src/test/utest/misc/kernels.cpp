@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/misc/kernels.h>
+
+#define SAMPLES     0x1003      /* Not a multiple of any vector size */
+#define BLOCKS      0x101
+
+UTEST_BEGIN("dspu.misc", kernels)
+
+    void test_words_to_float()
+    {
+        printf("Testing words_to_float kernel\n");
+
+        uint32_t *src   = new uint32_t[SAMPLES];
+        for (size_t i=0; i<SAMPLES; ++i)
+            src[i]          = uint32_t(i * 0x9e3779b9U + (i >> 3));
+        src[0]          = 0;
+        src[1]          = 0xffffffffU;
+        src[2]          = 0x80000000U;
+
+        FloatBuffer ref(SAMPLES), dst(SAMPLES);
+        dspu::kernels::generic::words_to_float(ref, src, SAMPLES);
+        for (size_t i=0; i<8; ++i)
+        {
+            // Check all alignments of buffers
+            dspu::kernels::words_to_float(&dst[i], &src[i], SAMPLES - i);
+            UTEST_ASSERT(dst.valid());
+            for (size_t j=i; j<SAMPLES; ++j)
+                UTEST_ASSERT_MSG(dst[j] == ref[j], "Word %d converted to %.10f, expected %.10f", int(j), dst[j], ref[j]);
+        }
+        UTEST_ASSERT(ref[0] == 0.0f);
+        UTEST_ASSERT(ref[1] == 1.0f);
+        UTEST_ASSERT(ref[2] == 0.5f);
+
+        delete [] src;
+    }
+
+    void test_lcg_words()
+    {
+        printf("Testing lcg_words kernel\n");
+
+        static const uint32_t mul1[]    = { 0x9e3779b9U, 0x7f4a7c15U, 0x12345679U, 0xdeadbeefU };
+        static const uint32_t mul2[]    = { 0x01234567U, 0x07654321U, 0x31415927U, 0x27182819U };
+        static const uint32_t add[]     = { 1, 3, 5, 7 };
+
+        uint32_t s1[4]  = { 1, 2, 3, 4 };
+        uint32_t s2[4]  = { 1, 2, 3, 4 };
+        uint32_t *d1    = new uint32_t[BLOCKS * 4];
+        uint32_t *d2    = new uint32_t[BLOCKS * 4];
+
+        dspu::kernels::generic::lcg_words(d1, s1, mul1, mul2, add, BLOCKS);
+        dspu::kernels::lcg_words(d2, s2, mul1, mul2, add, BLOCKS);
+
+        for (size_t i=0; i<BLOCKS*4; ++i)
+            UTEST_ASSERT_MSG(d1[i] == d2[i], "Word %d: 0x%08x, expected 0x%08x", int(i), d2[i], d1[i]);
+        for (size_t i=0; i<4; ++i)
+            UTEST_ASSERT(s1[i] == s2[i]);
+
+        delete [] d1;
+        delete [] d2;
+    }
+
+    UTEST_MAIN
+    {
+        printf("Selected instruction set: %s\n", dspu::kernels::isa());
+        test_words_to_float();
+        test_lcg_words();
+    }
+
+UTEST_END
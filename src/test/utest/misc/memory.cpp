@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/dsp-units/misc/memory.h>
+#include <lsp-plug.in/dsp-units/misc/pages.h>
+#include <lsp-plug.in/dsp-units/dynamics/Limiter.h>
+#include <lsp-plug.in/dsp-units/sampling/Sample.h>
+
+#define SRATE       48000
+#define CHANNELS    2
+#define MAX_LENGTH  0x1000
+#define LENGTH      0x400
+
+UTEST_BEGIN("dspu.misc", memory)
+
+    void check_report(const char *label, const dspu::memory_report_t *r)
+    {
+        printf("  %s: allocated=%d, used=%d, padding=%d, blocks=%d\n",
+            label, int(r->nAllocated), int(r->nUsed), int(r->nPadding), int(r->nBlocks));
+        UTEST_ASSERT(r->nBlocks > 0);
+        UTEST_ASSERT(r->nUsed > 0);
+        UTEST_ASSERT(r->nUsed + r->nPadding <= r->nAllocated);
+    }
+
+    void test_tracking()
+    {
+        printf("Testing allocation counter\n");
+
+        dspu::pages::stats_t s0, s1, s2;
+        dspu::pages::set_tracking(true);
+        UTEST_ASSERT(dspu::pages::tracking());
+        dspu::pages::get_stats(&s0);
+
+        void *p1    = dspu::pages::alloc(1000);
+        void *p2    = dspu::pages::alloc(3000, 0x40);
+        UTEST_ASSERT((p1 != NULL) && (p2 != NULL));
+        UTEST_ASSERT(dspu::pages::size(p1) == 1000);
+        UTEST_ASSERT(dspu::pages::size(p2) == 3000);
+        UTEST_ASSERT(dspu::pages::reserved(p2) >= 3000 + 0x40);
+
+        dspu::pages::get_stats(&s1);
+        UTEST_ASSERT(s1.nBlocks == s0.nBlocks + 2);
+        UTEST_ASSERT(s1.nAllocs == s0.nAllocs + 2);
+        UTEST_ASSERT(s1.nBytes == s0.nBytes + 4000);
+        UTEST_ASSERT(s1.nReserved == s0.nReserved + dspu::pages::reserved(p1) + dspu::pages::reserved(p2));
+        UTEST_ASSERT(s1.nPeak >= s1.nReserved);
+
+        // The buffer allocated before enabling the counter is not accounted at release
+        dspu::pages::set_tracking(false);
+        void *p3    = dspu::pages::alloc(500);
+        dspu::pages::set_tracking(true);
+
+        dspu::pages::free(p1);
+        dspu::pages::free(p2);
+        dspu::pages::free(p3);
+        dspu::pages::get_stats(&s2);
+        UTEST_ASSERT(s2.nBlocks == s0.nBlocks);
+        UTEST_ASSERT(s2.nBytes == s0.nBytes);
+        UTEST_ASSERT(s2.nReserved == s0.nReserved);
+        UTEST_ASSERT(s2.nFrees == s0.nFrees + 2);
+        UTEST_ASSERT(s2.nPeak == s1.nPeak);
+
+        dspu::pages::reset_peak();
+        dspu::pages::get_stats(&s2);
+        UTEST_ASSERT(s2.nPeak == s2.nReserved);
+        dspu::pages::set_tracking(false);
+    }
+
+    void test_sample()
+    {
+        printf("Testing memory report of the sample\n");
+
+        dspu::Sample s;
+        dspu::memory_report_t r;
+        dspu::memory::clear(&r);
+        s.memory_usage(&r);
+        UTEST_ASSERT((r.nAllocated == 0) && (r.nBlocks == 0));
+
+        UTEST_ASSERT(s.init(CHANNELS, MAX_LENGTH, LENGTH));
+        s.memory_usage(&r);
+        check_report("sample", &r);
+        UTEST_ASSERT(r.nUsed == LENGTH * CHANNELS * sizeof(float));
+        UTEST_ASSERT(r.nAllocated - r.nPadding == MAX_LENGTH * CHANNELS * sizeof(float));
+    }
+
+    void test_limiter()
+    {
+        printf("Testing memory report of the limiter\n");
+
+        dspu::Limiter l;
+        UTEST_ASSERT(l.init(SRATE, 20.0f));
+        l.set_sample_rate(SRATE);
+
+        // The used memory depends on the current lookahead
+        dspu::memory_report_t r1, r2, r;
+        l.set_lookahead(5.0f);
+        l.update_settings();
+        dspu::memory::clear(&r1);
+        l.memory_usage(&r1);
+        check_report("lookahead 5 ms", &r1);
+
+        l.set_lookahead(20.0f);
+        l.update_settings();
+        dspu::memory::clear(&r2);
+        l.memory_usage(&r2);
+        check_report("lookahead 20 ms", &r2);
+
+        UTEST_ASSERT(r1.nAllocated == r2.nAllocated);
+        UTEST_ASSERT(r1.nPadding == r2.nPadding);
+        UTEST_ASSERT(r1.nUsed < r2.nUsed);
+
+        dspu::memory::clear(&r);
+        dspu::memory::merge(&r, &r1);
+        dspu::memory::merge(&r, &r2);
+        UTEST_ASSERT(r.nAllocated == r1.nAllocated * 2);
+        UTEST_ASSERT(r.nBlocks == r1.nBlocks * 2);
+    }
+
+    UTEST_MAIN
+    {
+        test_tracking();
+        test_sample();
+        test_limiter();
+    }
+
+UTEST_END
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/dsp-units/misc/pages.h>
+#include <lsp-plug.in/stdlib/string.h>
+
+UTEST_BEGIN("dspu.misc", pages)
+
+    void test_policy(const char *label, dspu::pages::policy_t policy)
+    {
+        static const size_t sizes[]     = { 1, 100, 0x1000, 0x10001, 0x300000 };
+        static const size_t aligns[]    = { 1, 16, 64, 0x1000 };
+
+        printf("Testing %s allocation policy\n", label);
+
+        dspu::pages::set_policy(policy);
+        dspu::pages::set_threshold(0x10000);
+        UTEST_ASSERT(dspu::pages::policy() == policy);
+
+        for (size_t i=0; i<sizeof(sizes)/sizeof(size_t); ++i)
+            for (size_t j=0; j<sizeof(aligns)/sizeof(size_t); ++j)
+            {
+                size_t bytes    = sizes[i];
+                size_t align    = aligns[j];
+
+                uint8_t *ptr    = static_cast<uint8_t *>(dspu::pages::alloc(bytes, align));
+                UTEST_ASSERT(ptr != NULL);
+                UTEST_ASSERT_MSG((uintptr_t(ptr) & (align - 1)) == 0,
+                    "Buffer of %d bytes is not aligned to %d bytes", int(bytes), int(align));
+
+                // Small buffers never use huge pages, huge pages may be unavailable for large ones
+                dspu::pages::method_t m = dspu::pages::method(ptr);
+                if ((policy == dspu::pages::DEFAULT) || (bytes < dspu::pages::threshold()))
+                    UTEST_ASSERT(m == dspu::pages::M_HEAP);
+                if (policy != dspu::pages::EXPLICIT)
+                    UTEST_ASSERT(m != dspu::pages::M_EXPLICIT);
+
+                // The whole buffer should be writable
+                memset(ptr, 0x55, bytes);
+                UTEST_ASSERT((ptr[0] == 0x55) && (ptr[bytes - 1] == 0x55));
+                dspu::pages::free(ptr);
+            }
+
+        // Typed allocation
+        void *data      = NULL;
+        float *buf      = dspu::pages::alloc_aligned<float>(data, 0x20000, 0x40);
+        UTEST_ASSERT((buf != NULL) && (data == buf));
+        UTEST_ASSERT((uintptr_t(buf) & 0x3f) == 0);
+        for (size_t i=0; i<0x20000; ++i)
+            buf[i]          = i;
+        UTEST_ASSERT(buf[0x1ffff] == float(0x1ffff));
+        dspu::pages::free_aligned(data);
+        UTEST_ASSERT(data == NULL);
+
+        dspu::pages::free(NULL);
+    }
+
+    UTEST_MAIN
+    {
+        size_t threshold = dspu::pages::threshold();
+
+        test_policy("default", dspu::pages::DEFAULT);
+        test_policy("transparent", dspu::pages::TRANSPARENT);
+        test_policy("explicit", dspu::pages::EXPLICIT);
+
+        dspu::pages::set_policy(dspu::pages::DEFAULT);
+        dspu::pages::set_threshold(threshold);
+    }
+
+UTEST_END
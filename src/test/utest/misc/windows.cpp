@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/misc/windows.h>
+
+#define SAMPLES     0x400
+
+UTEST_BEGIN("dspu.misc", windows)
+
+    UTEST_MAIN
+    {
+        for (size_t i=dspu::windows::FIRST; i<=dspu::windows::LAST; ++i)
+        {
+            dspu::windows::window_t type = dspu::windows::window_t(i);
+            printf("Testing cached table of window %d\n", int(i));
+
+            FloatBuffer ref(SAMPLES);
+            dspu::windows::window(ref, SAMPLES, type);
+
+            // The same table is shared by the requests of the same type and size
+            const float *t1 = dspu::windows::acquire(type, SAMPLES);
+            const float *t2 = dspu::windows::acquire(type, SAMPLES);
+            const float *t3 = dspu::windows::acquire(type, SAMPLES + 1);
+            UTEST_ASSERT((t1 != NULL) && (t2 != NULL) && (t3 != NULL));
+            UTEST_ASSERT(t1 == t2);
+            UTEST_ASSERT(t1 != t3);
+
+            for (size_t j=0; j<SAMPLES; ++j)
+                UTEST_ASSERT_MSG(t1[j] == ref[j], "Cached table differs at sample %d: %f vs %f", int(j), t1[j], ref[j]);
+
+            dspu::windows::release(t1);
+            dspu::windows::release(t2);
+            dspu::windows::release(t3);
+        }
+    }
+
+UTEST_END
@@ -50,6 +50,44 @@ UTEST_BEGIN("dspu.noise", MLS)
         }
     }
 
+    // Block generation should output the same sequence as the step-by-step generation
+    void test_block(size_t bits)
+    {
+        static const size_t blocks[] = { 1, 5, 64, 3, 200, 127, 1000 };
+        const size_t samples = 0x2000;
+
+        dspu::MLS m1, m2;
+        m1.set_n_bits(bits);
+        m1.set_state(0x12345);
+        m1.set_amplitude(0.5f);
+        m1.set_offset(0.25f);
+        m1.update_settings();
+        m2.set_n_bits(bits);
+        m2.set_state(0x12345);
+        m2.set_amplitude(0.5f);
+        m2.set_offset(0.25f);
+        m2.update_settings();
+
+        float *vBlock = new float[samples];
+        for (size_t offset=0, i=0; offset < samples; ++i)
+        {
+            size_t to_do    = lsp_min(samples - offset, blocks[i % (sizeof(blocks)/sizeof(size_t))]);
+            m2.process_overwrite(&vBlock[offset], to_do);
+            offset         += to_do;
+        }
+
+        for (size_t n = 0; n < samples; ++n)
+        {
+            float v = m1.process_single();
+            UTEST_ASSERT_MSG(vBlock[n] == v, "Block output differs for %d bits at sample %d", int(bits), int(n));
+        }
+
+        delete [] vBlock;
+
+        m1.destroy();
+        m2.destroy();
+    }
+
     UTEST_MAIN
     {
         dspu::MLS mls;
@@ -93,6 +131,11 @@ UTEST_BEGIN("dspu.noise", MLS)
         delete [] vCautoX;
 
         mls.destroy();
+
+        static const size_t block_bits[] = { 2, 7, 8, 13, 31, 32 };
+        for (size_t i=0; i<sizeof(block_bits)/sizeof(size_t); ++i)
+            test_block(block_bits[i]);
+        test_block(nMaxBits);
     }
 
 
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/noise/LCG.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define SEED        0x1c6
+#define SAMPLES     0x100000
+#define AMPLITUDE   0.5f
+#define OFFSET      0.1f
+
+UTEST_BEGIN("dspu.noise", lcg)
+
+    void test_distribution(const char *label, dspu::lcg_dist_t dist, double mean, double var)
+    {
+        printf("Testing %s distribution\n", label);
+
+        dspu::LCG lcg;
+        lcg.init(SEED);
+        lcg.set_distribution(dist);
+        lcg.set_amplitude(AMPLITUDE);
+        lcg.set_offset(OFFSET);
+
+        FloatBuffer dst(SAMPLES);
+        lcg.process_overwrite(dst, SAMPLES);
+        UTEST_ASSERT_MSG(dst.valid(), "Destination buffer corrupted");
+
+        double s1 = 0.0, s2 = 0.0;
+        for (size_t i=0; i<SAMPLES; ++i)
+            s1     += dst[i];
+        s1         /= SAMPLES;
+        for (size_t i=0; i<SAMPLES; ++i)
+            s2     += (dst[i] - s1) * (dst[i] - s1);
+        s2         /= SAMPLES - 1;
+
+        printf("  mean = %f (expected %f), variance = %f (expected %f)\n", s1, mean, s2, var);
+
+        UTEST_ASSERT_MSG(fabs(s1 - mean) < 5e-3 * sqrt(var), "Mean of %s distribution is out of range", label);
+        UTEST_ASSERT_MSG(fabs(s2 - var) < 1e-2 * var, "Variance of %s distribution is out of range", label);
+
+        // Additive mode with NULL source produces the same sequence
+        FloatBuffer add(SAMPLES);
+        lcg.init(SEED);
+        lcg.process_add(add, NULL, SAMPLES);
+        UTEST_ASSERT(add.valid());
+        if (!dst.equals_absolute(add, 1e-6f))
+            UTEST_FAIL_MSG("Additive output of %s distribution differs", label);
+    }
+
+    UTEST_MAIN
+    {
+        const double a2 = AMPLITUDE * AMPLITUDE;
+
+        test_distribution("uniform", dspu::LCG_UNIFORM, OFFSET, 4.0 * a2 / 12.0);
+        test_distribution("triangular", dspu::LCG_TRIANGULAR, OFFSET + AMPLITUDE - 0.5, 4.0 * a2 / 24.0);
+        test_distribution("gaussian", dspu::LCG_GAUSSIAN, OFFSET, a2);
+    }
+
+UTEST_END
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/noise/MultiGenerator.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define SEED        0x1234abcd
+#define SRATE       48000
+#define CHANNELS    11              /* Not a multiple of the lane count to check padding */
+#define SAMPLES     0x4000
+
+UTEST_BEGIN("dspu.noise", multi_generator)
+
+    void setup(dspu::MultiNoiseGenerator &g, dspu::ng_color_t color)
+    {
+        UTEST_ASSERT(g.init(CHANNELS, SEED));
+        UTEST_ASSERT(g.channels() == CHANNELS);
+        g.set_sample_rate(SRATE);
+        g.set_generator(dspu::NG_GEN_LCG);
+        g.set_lcg_distribution(dspu::LCG_UNIFORM);
+        g.set_noise_color(color);
+        g.set_amplitude(0.5f);
+        g.update_settings();
+    }
+
+    void test_decorrelation()
+    {
+        printf("Testing decorrelation of channels\n");
+
+        dspu::MultiNoiseGenerator g;
+        setup(g, dspu::NG_COLOR_WHITE);
+
+        FloatBuffer *buf[CHANNELS];
+        float *dst[CHANNELS];
+        for (size_t i=0; i<CHANNELS; ++i)
+        {
+            buf[i]      = new FloatBuffer(SAMPLES);
+            dst[i]      = *buf[i];
+        }
+
+        g.process_overwrite(dst, SAMPLES);
+
+        for (size_t i=0; i<CHANNELS; ++i)
+        {
+            UTEST_ASSERT_MSG(buf[i]->valid(), "Buffer %d corrupted", int(i));
+
+            for (size_t j=i+1; j<CHANNELS; ++j)
+            {
+                double xy = 0.0, xx = 0.0, yy = 0.0;
+                for (size_t k=0; k<SAMPLES; ++k)
+                {
+                    xy     += dst[i][k] * dst[j][k];
+                    xx     += dst[i][k] * dst[i][k];
+                    yy     += dst[j][k] * dst[j][k];
+                }
+
+                // The standard deviation of the correlation of independent streams is 1/sqrt(SAMPLES) ~ 0.008
+                double r    = xy / sqrt(xx * yy);
+                UTEST_ASSERT_MSG(fabs(r) < 0.05, "Channels %d and %d are correlated: %f", int(i), int(j), r);
+            }
+        }
+
+        for (size_t i=0; i<CHANNELS; ++i)
+            delete buf[i];
+    }
+
+    void test_coloring(const char *label, dspu::ng_color_t color, float slope)
+    {
+        printf("Testing %s coloring of channels\n", label);
+
+        // White and colored generators produce the same source noise
+        dspu::MultiNoiseGenerator gw, gc;
+        setup(gw, dspu::NG_COLOR_WHITE);
+        setup(gc, color);
+
+        // Reference filter, configured as NoiseGenerator does it
+        dspu::SpectralTilt *tilt = new dspu::SpectralTilt[CHANNELS];
+        FloatBuffer *bw[CHANNELS], *bc[CHANNELS];
+        float *dw[CHANNELS], *dc[CHANNELS];
+        for (size_t i=0; i<CHANNELS; ++i)
+        {
+            tilt[i].set_sample_rate(SRATE);
+            tilt[i].set_order(50);
+            tilt[i].set_slope(slope, dspu::STLT_SLOPE_UNIT_NEPER_PER_NEPER);
+            tilt[i].set_lower_frequency(10.0f);
+            tilt[i].set_upper_frequency(0.9f * 0.5f * SRATE);
+            tilt[i].update_settings();
+
+            bw[i]       = new FloatBuffer(SAMPLES);
+            bc[i]       = new FloatBuffer(SAMPLES);
+            dw[i]       = *bw[i];
+            dc[i]       = *bc[i];
+        }
+
+        // Process by blocks of different size
+        for (size_t offset=0, step=1; offset < SAMPLES; step = step * 3 + 1)
+        {
+            size_t to_do    = lsp_min(size_t(SAMPLES) - offset, step);
+            gw.process_overwrite(dw, to_do);
+            gc.process_overwrite(dc, to_do);
+            for (size_t i=0; i<CHANNELS; ++i)
+            {
+                tilt[i].process_overwrite(dw[i], dw[i], to_do);
+                dw[i]          += to_do;
+                dc[i]          += to_do;
+            }
+            offset         += to_do;
+        }
+
+        for (size_t i=0; i<CHANNELS; ++i)
+        {
+            UTEST_ASSERT(bw[i]->valid());
+            UTEST_ASSERT(bc[i]->valid());
+            if (!bw[i]->equals_relative(*bc[i], 1e-3f))
+            {
+                bw[i]->dump("reference");
+                bc[i]->dump("colored");
+                UTEST_FAIL_MSG("Coloring of channel %d differs", int(i));
+            }
+        }
+
+        for (size_t i=0; i<CHANNELS; ++i)
+        {
+            delete bw[i];
+            delete bc[i];
+        }
+        delete [] tilt;
+    }
+
+    UTEST_MAIN
+    {
+        test_decorrelation();
+        test_coloring("pink", dspu::NG_COLOR_PINK, -0.5f);
+        test_coloring("red", dspu::NG_COLOR_RED, -1.0f);
+    }
+
+UTEST_END
@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/noise/Velvet.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#define SEED        0x7e1
+#define SAMPLES     0x2000
+#define WIDTH       12.5f
+#define KERNEL      0x200
+#define SOURCE      0x300
+
+UTEST_BEGIN("dspu.noise", velvet)
+
+    void setup(dspu::Velvet &v, dspu::vn_velvet_type_t type, bool crush)
+    {
+        v.init(SEED, 16, 0);
+        v.set_core_type(dspu::VN_CORE_LCG);
+        v.set_velvet_type(type);
+        v.set_velvet_window_width(WIDTH);
+        v.set_crush(crush);
+        v.set_amplitude(0.5f);
+    }
+
+    void test_sparse(const char *label, dspu::vn_velvet_type_t type, bool crush)
+    {
+        static const size_t blocks[] = { 1, 7, 300, 13, 1000, 256, 3 };
+
+        printf("Testing sparse %s noise, crush=%s\n", label, (crush) ? "true" : "false");
+
+        dspu::Velvet v1, v2;
+        setup(v1, type, crush);
+        setup(v2, type, crush);
+
+        // Dense output by blocks of odd sizes
+        FloatBuffer dense(SAMPLES);
+        for (size_t offset=0, i=0; offset < SAMPLES; ++i)
+        {
+            size_t to_do    = lsp_min(size_t(SAMPLES) - offset, blocks[i % (sizeof(blocks)/sizeof(size_t))]);
+            v1.process_overwrite(&dense[offset], to_do);
+            offset         += to_do;
+        }
+        UTEST_ASSERT(dense.valid());
+
+        // Sparse output for the whole range
+        uint32_t *pos   = new uint32_t[SAMPLES];
+        FloatBuffer value(SAMPLES), sparse(SAMPLES);
+        size_t n        = v2.generate_sparse(pos, value, SAMPLES);
+        UTEST_ASSERT(n > 0);
+
+        sparse.fill_zero();
+        for (size_t i=0; i<n; ++i)
+        {
+            UTEST_ASSERT(pos[i] < SAMPLES);
+            if (i > 0)
+                UTEST_ASSERT_MSG(pos[i] > pos[i-1], "Impulse positions are not sorted");
+            UTEST_ASSERT_MSG(value[i] != 0.0f, "Zero impulse %d", int(i));
+            sparse[pos[i]]  = value[i];
+        }
+        UTEST_ASSERT(sparse.valid());
+
+        if (!dense.equals_absolute(sparse, 1e-6f))
+        {
+            dense.dump("dense");
+            sparse.dump("sparse");
+            UTEST_FAIL_MSG("Sparse and dense %s noise differ", label);
+        }
+
+        // OVN has exactly one impulse per window
+        if (type == dspu::VN_VELVET_OVN)
+        {
+            for (size_t i=0; i<n; ++i)
+                UTEST_ASSERT_MSG(size_t(pos[i] / WIDTH) == i, "Impulse %d at %d is out of its window", int(i), int(pos[i]));
+        }
+
+        delete [] pos;
+    }
+
+    void test_convolve()
+    {
+        printf("Testing sparse convolution\n");
+
+        dspu::Velvet v;
+        setup(v, dspu::VN_VELVET_OVNA, false);
+
+        uint32_t pos[KERNEL];
+        float value[KERNEL];
+        size_t n = v.generate_sparse(pos, value, KERNEL);
+        UTEST_ASSERT(n > 0);
+
+        FloatBuffer kernel(KERNEL), src(SOURCE);
+        FloatBuffer dst1(SOURCE + KERNEL), dst2(SOURCE + KERNEL);
+        kernel.fill_zero();
+        for (size_t i=0; i<n; ++i)
+            kernel[pos[i]]  = value[i];
+        src.randomize_sign();
+
+        // Direct convolution with the dense kernel
+        dst1.fill_zero();
+        for (size_t i=0; i<SOURCE; ++i)
+            for (size_t j=0; j<KERNEL; ++j)
+                dst1[i + j]    += src[i] * kernel[j];
+
+        dst2.fill_zero();
+        dspu::Velvet::convolve(dst2, src, pos, value, n, SOURCE);
+
+        UTEST_ASSERT(dst1.valid());
+        UTEST_ASSERT(dst2.valid());
+        if (!dst1.equals_absolute(dst2, 1e-5f))
+        {
+            dst1.dump("dst1");
+            dst2.dump("dst2");
+            UTEST_FAIL_MSG("Sparse convolution differs");
+        }
+    }
+
+    UTEST_MAIN
+    {
+        test_sparse("OVN", dspu::VN_VELVET_OVN, false);
+        test_sparse("OVN", dspu::VN_VELVET_OVN, true);
+        test_sparse("OVNA", dspu::VN_VELVET_OVNA, false);
+        test_sparse("ARN", dspu::VN_VELVET_ARN, false);
+        test_sparse("TRN", dspu::VN_VELVET_TRN, false);
+        test_convolve();
+    }
+
+UTEST_END
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/dsp-units/sampling/SampleLoader.h>
+#include <lsp-plug.in/common/atomic.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define TEST_SRATE      48000
+#define TEST_FILES      4
+
+namespace
+{
+    typedef struct loaded_t
+    {
+        atomic_t    nCalls;
+        atomic_t    nMask;
+    } loaded_t;
+
+    void on_loaded(size_t index, lsp::dspu::Sample *sample, lsp::status_t status, void *arg)
+    {
+        loaded_t *l = static_cast<loaded_t *>(arg);
+        lsp::atomic_add(&l->nCalls, 1);
+        if (status == lsp::STATUS_OK)
+            lsp::atomic_add(&l->nMask, 1 << index);
+    }
+}
+
+UTEST_BEGIN("dspu.sampling", loader)
+
+    void init_sample(dspu::Sample *s, size_t channels, size_t length)
+    {
+        UTEST_ASSERT(s->init(channels, length, length));
+        s->set_sample_rate(TEST_SRATE);
+
+        for (size_t i=0; i<channels; ++i)
+        {
+            float *dst  = s->channel(i);
+            float w     = 2.0f * M_PI * (i + 1) * 220.0f / float(TEST_SRATE);
+            for (size_t j=0; j<length; ++j)
+                dst[j]      = 0.5f * sinf(w * j);
+        }
+    }
+
+    void test_load()
+    {
+        printf("Testing parallel loading of samples...\n");
+
+        dspu::Sample src[TEST_FILES], dst[TEST_FILES + 1];
+        io::Path path[TEST_FILES];
+        dspu::SampleLoader loader;
+        loaded_t l;
+        l.nCalls    = 0;
+        l.nMask     = 0;
+
+        // Different number of channels checks all deinterleave branches
+        for (size_t i=0; i<TEST_FILES; ++i)
+        {
+            init_sample(&src[i], i + 1, 1000 + i * 777);
+            UTEST_ASSERT(path[i].fmt("%s/%s-%d.wav", tempdir(), full_name(), int(i)) > 0);
+            UTEST_ASSERT(src[i].save(&path[i]) == ssize_t(src[i].length()));
+            UTEST_ASSERT(loader.add(&dst[i], &path[i]) == STATUS_OK);
+        }
+        UTEST_ASSERT(loader.add(&dst[TEST_FILES], "/nonexistent/file.wav") == STATUS_OK);
+        UTEST_ASSERT(loader.size() == TEST_FILES + 1);
+
+        loader.set_threads(3);
+        loader.set_callback(on_loaded, &l);
+        UTEST_ASSERT(loader.load() != STATUS_OK);
+        UTEST_ASSERT(l.nCalls == TEST_FILES + 1);
+        UTEST_ASSERT(l.nMask == (1 << TEST_FILES) - 1);
+        UTEST_ASSERT(loader.status(TEST_FILES) != STATUS_OK);
+
+        for (size_t i=0; i<TEST_FILES; ++i)
+        {
+            UTEST_ASSERT(loader.status(i) == STATUS_OK);
+            UTEST_ASSERT(dst[i].channels() == src[i].channels());
+            UTEST_ASSERT(dst[i].length() == src[i].length());
+            UTEST_ASSERT(dst[i].sample_rate() == TEST_SRATE);
+
+            for (size_t j=0; j<src[i].channels(); ++j)
+            {
+                const float *a = src[i].channel(j);
+                const float *b = dst[i].channel(j);
+                for (size_t k=0; k<src[i].length(); ++k)
+                    UTEST_ASSERT_MSG(float_equals_absolute(a[k], b[k]),
+                        "Sample %d channel %d differs at %d: %f vs %f", int(i), int(j), int(k), a[k], b[k]);
+            }
+        }
+
+        // Load with resampling
+        loader.clear();
+        for (size_t i=0; i<TEST_FILES; ++i)
+            UTEST_ASSERT(loader.add(&dst[i], &path[i]) == STATUS_OK);
+        loader.set_sample_rate(TEST_SRATE / 2);
+        loader.set_callback(NULL, NULL);
+        UTEST_ASSERT(loader.load() == STATUS_OK);
+
+        for (size_t i=0; i<TEST_FILES; ++i)
+        {
+            UTEST_ASSERT(dst[i].channels() == src[i].channels());
+            UTEST_ASSERT(dst[i].sample_rate() == TEST_SRATE / 2);
+            UTEST_ASSERT(dst[i].length() >= src[i].length() / 2);
+        }
+    }
+
+    UTEST_MAIN
+    {
+        test_load();
+    }
+
+UTEST_END
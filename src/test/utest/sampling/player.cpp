@@ -23,6 +23,9 @@
 #include <lsp-plug.in/test-fw/FloatBuffer.h>
 #include <lsp-plug.in/dsp-units/sampling/SamplePlayer.h>
 #include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/common/atomic.h>
+#include <lsp-plug.in/ipc/Thread.h>
 
 
 #define SAMPLE_LENGTH       8
@@ -35,9 +38,41 @@ static const float samples[4][SAMPLE_LENGTH] =
     { 1, 2, 3, 2, 2, 3, 2, 1 }
 };
 
+#define POST_THREADS        4
+#define POST_COMMANDS       1000
+
 UTEST_BEGIN("dspu.sampling", player)
-    UTEST_MAIN
+    class Poster: public ipc::Thread
     {
+        private:
+            dspu::SamplePlayer *pPlayer;
+            atomic_t           *pDone;
+
+        public:
+            explicit Poster(dspu::SamplePlayer *sp, atomic_t *done)
+            {
+                pPlayer     = sp;
+                pDone       = done;
+            }
+
+            virtual status_t run()
+            {
+                for (size_t i=0; i<POST_COMMANDS; )
+                {
+                    if (pPlayer->post_play(0, 0, 1.0f))
+                        ++i;
+                    else
+                        ipc::Thread::sleep(0);
+                }
+                atomic_add(pDone, 1);
+                return STATUS_OK;
+            }
+    };
+
+    void test_mix()
+    {
+        printf("Testing mixing of samples...\n");
+
         dspu::SamplePlayer sp;
         sp.init(4, 5);
 
@@ -74,6 +109,7 @@ UTEST_BEGIN("dspu.sampling", player)
                 n = 16;
             sp.process(&dptr[processed], &sptr[processed], n);
         }
+        UTEST_ASSERT(sp.playbacks() == 0);
 
         // Destroy player
         sp.destroy(true);
@@ -89,13 +125,452 @@ UTEST_BEGIN("dspu.sampling", player)
             src.dump("src");
             dst1.dump("dst1");
             dst2.dump("dst2");
+            UTEST_FAIL_MSG("Output of the player differs");
         }
     }
-UTEST_END;
 
+    void test_fadeout()
+    {
+        printf("Testing fadeout of samples...\n");
+
+        dspu::SamplePlayer sp;
+        sp.init(1, 4);
+
+        dspu::Sample *s = new dspu::Sample();
+        s->init(1, 0x800, 0x800);
+        dsp::fill(s->getBuffer(0), 1.0f, 0x800);
+        UTEST_ASSERT(sp.bind(0, s));
+
+        UTEST_ASSERT(sp.play(0, 0, 0.5f, 3));
+        UTEST_ASSERT(sp.cancel_all(0, 0, 0x300, 0x40) == 1);
+
+        FloatBuffer dst(0x800);
+        for (size_t off=0; off<dst.size(); off += 0x7f)
+            sp.process(&dst[off], lsp_min(dst.size() - off, size_t(0x7f)));
+        UTEST_ASSERT(sp.playbacks() == 0);
+        UTEST_ASSERT_MSG(dst.valid(), "Destination buffer corrupted");
+
+        // Compute the expected output
+        float fgain = 0.5f / (0x300 + 1);
+        for (size_t i=0; i<dst.size(); ++i)
+        {
+            ssize_t fade = ssize_t(i) - 3 - 0x40;
+            float v = (i < 3) ? 0.0f :
+                      (fade < 0) ? 0.5f :
+                      (fade < 0x300) ? fgain * (0x300 - fade) : 0.0f;
+            if (!float_equals_absolute(dst[i], v, 1e-5f))
+                UTEST_FAIL_MSG("Invalid sample %d: %f, expected %f", int(i), dst[i], v);
+        }
+
+        sp.destroy(true);
+    }
+
+    void test_steal()
+    {
+        printf("Testing voice stealing...\n");
+
+        dspu::SamplePlayer sp;
+        sp.init(3, 3);
+
+        for (size_t i=0; i<3; ++i)
+        {
+            dspu::Sample *s = new dspu::Sample();
+            s->init(1, 0x100, 0x100);
+            dsp::fill(s->getBuffer(0), float(1 << i), 0x100);
+            UTEST_ASSERT(sp.bind(i, s));
+        }
+
+        FloatBuffer dst(0x10);
+
+        // The quietest playback should be stolen
+        UTEST_ASSERT(sp.play(0, 0, 1.0f));
+        UTEST_ASSERT(sp.play(1, 0, 0.1f));
+        UTEST_ASSERT(sp.play(1, 0, 0.9f));
+        UTEST_ASSERT(sp.play(2, 0, 1.0f));
+        UTEST_ASSERT(sp.playbacks() == 3);
+        sp.process(dst, dst.size());
+        UTEST_ASSERT(float_equals_absolute(dst[0], 1.0f + 1.8f + 4.0f, 1e-5f));
+
+        // The cancelled playback should be stolen before the louder ones
+        UTEST_ASSERT(sp.cancel_all(0, 0, 0x1000) == 1);
+        UTEST_ASSERT(sp.play(1, 0, 0.01f));
+        UTEST_ASSERT(sp.playbacks() == 3);
+        sp.process(dst, dst.size());
+        UTEST_ASSERT(float_equals_absolute(dst[0], 1.8f + 4.0f + 0.02f, 1e-5f));
+
+        // The oldest playback of the same priority should be stolen
+        UTEST_ASSERT(sp.play(2, 0, 0.011f));
+        sp.process(dst, dst.size());
+        UTEST_ASSERT(float_equals_absolute(dst[0], 1.8f + 4.0f + 0.044f, 1e-5f));
+
+        sp.stop();
+        UTEST_ASSERT(sp.playbacks() == 0);
+        sp.destroy(true);
+    }
+
+    void test_rate(dspu::sp_interpolation_t mode, const char *name, float rate, float tolerance)
+    {
+        printf("Testing %s playback at rate %.2f...\n", name, rate);
+
+        dspu::SamplePlayer sp;
+        sp.init(1, 1);
+        sp.set_interpolation(mode);
+        UTEST_ASSERT(sp.interpolation() == mode);
+
+        // Low-frequency sine
+        const size_t len    = 0x1000;
+        const float w       = 2.0f * M_PI / 100.0f;
+        dspu::Sample *s = new dspu::Sample();
+        s->init(1, len, len);
+        float *buf          = s->getBuffer(0);
+        for (size_t i=0; i<len; ++i)
+            buf[i]              = sinf(w * i);
+        UTEST_ASSERT(sp.bind(0, s));
+
+        UTEST_ASSERT(!sp.play(0, 0, 1.0f, 0, 0.0f));
+        UTEST_ASSERT(!sp.play(0, 0, 1.0f, 0, SAMPLE_PLAYER_MAX_RATE * 2.0f));
+        UTEST_ASSERT(sp.play(0, 0, 0.5f, 5, rate));
+
+        FloatBuffer dst(len * 3);
+        for (size_t off=0; off<dst.size(); off += 0xf1)
+            sp.process(&dst[off], lsp_min(dst.size() - off, size_t(0xf1)));
+        UTEST_ASSERT(sp.playbacks() == 0);
+        UTEST_ASSERT_MSG(dst.valid(), "Destination buffer corrupted");
+
+        // Check the interior of the played sample
+        size_t played       = (len + rate - 1) / rate;
+        for (size_t i=0; i<dst.size(); ++i)
+        {
+            float v = ((i < 5) || (i >= played + 5)) ? 0.0f : 0.5f * sinf(w * rate * (i - 5));
+            if ((i < 10) || ((i + 10 > played + 5) && (i < played + 10)))
+                continue;
+            if (!float_equals_absolute(dst[i], v, tolerance))
+                UTEST_FAIL_MSG("Invalid sample %d: %f, expected %f", int(i), dst[i], v);
+        }
+
+        sp.destroy(true);
+    }
+
+    float loop_sample(const float *buf, ssize_t u, const dspu::sp_loop_t *loop)
+    {
+        // Reference: the data after the start of the loop is periodic, the end of the loop
+        // is crossfaded with the data before the start of the loop
+        if (u < ssize_t(loop->nStart))
+            return buf[u];
+        ssize_t len     = loop->nEnd - loop->nStart;
+        ssize_t w       = loop->nStart + (u - loop->nStart) % len;
+        ssize_t xf      = loop->nEnd - loop->nFade;
+        if (w < xf)
+            return buf[w];
+        float k         = float(w - xf + 1) / float(loop->nFade + 1);
+        return buf[w] + k * (buf[w - len] - buf[w]);
+    }
 
+    void test_loop(float rate)
+    {
+        printf("Testing looped playback at rate %.2f...\n", rate);
 
+        dspu::SamplePlayer sp;
+        sp.init(1, 2);
+        sp.set_interpolation(dspu::SPI_LINEAR);
 
+        const size_t len    = 0x100;
+        dspu::Sample *s     = new dspu::Sample();
+        s->init(1, len, len);
+        float *buf          = s->getBuffer(0);
+        for (size_t i=0; i<len; ++i)
+            buf[i]              = sinf(i * 0.1f) + i * 0.01f;
+        UTEST_ASSERT(sp.bind(0, s));
 
+        // Invalid region, crossfade limited by the start of the loop
+        dspu::sp_loop_t loop;
+        loop.nStart         = 0x40;
+        loop.nEnd           = len + 1;
+        loop.nFade          = 0x10;
+        UTEST_ASSERT(!sp.play_loop(0, 0, 1.0f, &loop, 0, rate));
+        loop.nEnd           = 0xc0;
+        UTEST_ASSERT(sp.play_loop(0, 0, 1.0f, &loop, 3, rate));
 
+        // Play several loops by blocks of odd size
+        FloatBuffer dst(len * 8);
+        for (size_t off=0; off<dst.size(); off += 0x71)
+            sp.process(&dst[off], lsp_min(dst.size() - off, size_t(0x71)));
+        UTEST_ASSERT(sp.playbacks() == 1);
+        UTEST_ASSERT_MSG(dst.valid(), "Destination buffer corrupted");
 
+        for (size_t i=0; i<dst.size(); ++i)
+        {
+            float v;
+            if (i < 3)
+                v               = 0.0f;
+            else
+            {
+                double p        = (i - 3) * double(rate);
+                ssize_t k       = ssize_t(p);
+                float f         = p - k;
+                float s0        = loop_sample(buf, k, &loop);
+                float s1        = loop_sample(buf, k + 1, &loop);
+                v               = s0 + f * (s1 - s0);
+            }
+            if (!float_equals_absolute(dst[i], v, 1e-3f))
+                UTEST_FAIL_MSG("Invalid sample %d: %f, expected %f", int(i), dst[i], v);
+        }
+
+        // The loop stops after the cancellation
+        UTEST_ASSERT(sp.cancel_all(0, 0, 0x20) == 1);
+        for (size_t off=0; off<dst.size(); off += 0x71)
+            sp.process(&dst[off], lsp_min(dst.size() - off, size_t(0x71)));
+        UTEST_ASSERT(sp.playbacks() == 0);
+
+        sp.destroy(true);
+    }
+
+    void test_compact(float rate)
+    {
+        printf("Testing playback of the compact sample at rate %.2f...\n", rate);
+
+        const size_t len    = 0x400;
+        dspu::SamplePlayer sp[2];
+        dspu::Sample *s[2];
+        for (size_t i=0; i<2; ++i)
+        {
+            UTEST_ASSERT(sp[i].init(1, 2));
+            sp[i].set_interpolation(dspu::SPI_CUBIC);
+            s[i]                = new dspu::Sample();
+            UTEST_ASSERT(s[i]->init(1, len, len));
+            float *buf          = s[i]->getBuffer(0);
+            for (size_t j=0; j<len; ++j)
+                buf[j]              = sinf(j * 0.05f) * (1.0f + j * 0.002f);
+        }
+        UTEST_ASSERT(s[1]->compact() == STATUS_OK);
+        UTEST_ASSERT(s[1]->compacted());
+        UTEST_ASSERT(s[1]->valid());
+
+        // The compact sample should play the same way as the floating-point sample
+        dspu::sp_loop_t loop;
+        loop.nStart         = 0x100;
+        loop.nEnd           = 0x300;
+        loop.nFade          = 0x20;
+
+        FloatBuffer dst1(len * 3), dst2(len * 3);
+        dst1.fill_zero();
+        dst2.fill_zero();
+        FloatBuffer *dst[2] = { &dst1, &dst2 };
+        for (size_t i=0; i<2; ++i)
+        {
+            UTEST_ASSERT(sp[i].bind(0, s[i], true));
+            UTEST_ASSERT(sp[i].play(0, 0, 1.0f, 5, rate));
+            UTEST_ASSERT(sp[i].play_loop(0, 0, 0.5f, &loop, 11, rate));
+            for (size_t off=0; off<dst[i]->size(); off += 0x71)
+                sp[i].process(dst[i]->data(off), lsp_min(dst[i]->size() - off, size_t(0x71)));
+            UTEST_ASSERT_MSG(dst[i]->valid(), "Destination buffer corrupted");
+        }
+
+        if (!dst1.equals_absolute(dst2, 1e-3f))
+        {
+            dst1.dump("dst1");
+            dst2.dump("dst2");
+            UTEST_FAIL_MSG("Compact sample output differs");
+        }
+
+        sp[0].destroy(true);
+        sp[1].destroy(true);
+    }
+
+    void test_mapped()
+    {
+        printf("Testing multichannel playback...\n");
+
+        dspu::SamplePlayer sp;
+        sp.init(1, 2);
+
+        const size_t len    = 0x100;
+        dspu::Sample *s     = new dspu::Sample();
+        s->init(2, len, len);
+        for (size_t i=0; i<len; ++i)
+        {
+            s->getBuffer(0)[i]  = 1.0f + i * 0.01f;
+            s->getBuffer(1)[i]  = -2.0f * (1.0f + i * 0.01f);
+        }
+        UTEST_ASSERT(sp.bind(0, s));
+
+        // Invalid channel maps
+        dspu::sp_channel_map_t map;
+        map.nChannels       = 0;
+        UTEST_ASSERT(!sp.play_mapped(0, &map, 1.0f));
+        map.nChannels       = 2;
+        map.vChannel[0]     = 1;
+        map.vOutput[0]      = 0;
+        map.vGain[0]        = 0.5f;
+        map.vChannel[1]     = 2;
+        map.vOutput[1]      = 1;
+        map.vGain[1]        = 2.0f;
+        UTEST_ASSERT(!sp.play_mapped(0, &map, 1.0f));
+        map.vChannel[1]     = 0;
+
+        // All channels to the outputs with the same index and the swapped channels by one voice each
+        FloatBuffer l(len * 2), r(len * 2), m(len * 2);
+        UTEST_ASSERT(sp.play_mapped(0, NULL, 0.5f, NULL, 3));
+        UTEST_ASSERT(sp.play_mapped(0, &map, 1.0f, NULL, 3));
+        UTEST_ASSERT(sp.playbacks() == 2);
+
+        // Both channels fade out together
+        UTEST_ASSERT(sp.cancel_all(0, 0, 0x40, 0x80) == 2);
+        for (size_t off=0; off<l.size(); off += 0x33)
+        {
+            float *out[2]       = { &l[off], &r[off] };
+            sp.process(out, 2, lsp_min(l.size() - off, size_t(0x33)));
+        }
+        UTEST_ASSERT(sp.playbacks() == 0);
+        UTEST_ASSERT(l.valid());
+        UTEST_ASSERT(r.valid());
+
+        for (size_t i=0; i<l.size(); ++i)
+        {
+            float a     = ((i < 3) || (i >= len + 3)) ? 0.0f : 1.0f + (i - 3) * 0.01f;
+            float f     = (i < 0x83) ? 1.0f : (i < 0xc3) ? float(0xc3 - i) / float(0x41) : 0.0f; // Fadeout counts played samples
+            float vl    = (0.5f * a - a) * f;       // 0.5 * ch0 + 0.5 * ch1
+            float vr    = (-a + 2.0f * a) * f;      // 0.5 * ch1 + 2.0 * ch0
+            UTEST_ASSERT_MSG(float_equals_absolute(l[i], vl, 1e-4f), "Left sample %d: %f, expected %f", int(i), l[i], vl);
+            UTEST_ASSERT_MSG(float_equals_absolute(r[i], vr, 1e-4f), "Right sample %d: %f, expected %f", int(i), r[i], vr);
+        }
+
+        // Outputs are wrapped for the mono output: both channels are mixed together
+        UTEST_ASSERT(sp.play_mapped(0, NULL, 1.0f));
+        sp.process(m, m.size());
+        UTEST_ASSERT(sp.playbacks() == 0);
+        for (size_t i=0; i<m.size(); ++i)
+        {
+            float v     = (i < len) ? -(1.0f + i * 0.01f) : 0.0f;
+            UTEST_ASSERT_MSG(float_equals_absolute(m[i], v, 1e-4f), "Mono sample %d: %f, expected %f", int(i), m[i], v);
+        }
+
+        sp.destroy(true);
+    }
+
+    void test_commands()
+    {
+        printf("Testing posting of commands...\n");
+
+        dspu::SamplePlayer sp;
+        UTEST_ASSERT(sp.init(2, 4, 4));
+
+        dspu::Sample *s1 = new dspu::Sample();
+        dspu::Sample *s2 = new dspu::Sample();
+        s1->init(1, 0x10, 0x10);
+        s2->init(1, 0x10, 0x10);
+        dsp::fill(s1->getBuffer(0), 1.0f, 0x10);
+        dsp::fill(s2->getBuffer(0), 2.0f, 0x10);
+
+        // Nothing is executed until process() is called
+        FloatBuffer dst(0x40);
+        UTEST_ASSERT(sp.post_bind(0, s1));
+        UTEST_ASSERT(sp.post_play(0, 0, 1.0f, 5));
+        UTEST_ASSERT(sp.post_play(1, 0, 1.0f, 5));
+        UTEST_ASSERT(sp.post_cancel_all(0, 0, 0, 0x24));
+        UTEST_ASSERT(!sp.post_stop());
+        UTEST_ASSERT(sp.playbacks() == 0);
+
+        // Commands should be executed sample-accurately
+        sp.process(&dst[0], 0x20);
+        UTEST_ASSERT(sp.timestamp() == 0x20);
+        UTEST_ASSERT(sp.playbacks() == 0);
+        for (size_t i=0; i<0x20; ++i)
+        {
+            float v = ((i >= 5) && (i < 0x15)) ? 1.0f : 0.0f;
+            if (!float_equals_absolute(dst[i], v, 1e-5f))
+                UTEST_FAIL_MSG("Invalid sample %d: %f, expected %f", int(i), dst[i], v);
+        }
+
+        // The cancel command which is late should be applied immediately
+        UTEST_ASSERT(sp.post_play(0, 0, 1.0f, 0x28));
+        UTEST_ASSERT(sp.post_cancel_all(0, 0, 0, 0x10));
+        sp.process(&dst[0x20], 0x20);
+        UTEST_ASSERT(sp.playbacks() == 0);
+        for (size_t i=0x20; i<0x40; ++i)
+            UTEST_ASSERT(float_equals_absolute(dst[i], 0.0f, 1e-5f));
+
+        // The replaced sample should be passed to the garbage queue
+        UTEST_ASSERT(sp.gc() == 0);
+        UTEST_ASSERT(sp.post_bind(0, s2));
+        UTEST_ASSERT(sp.post_play(0, 0, 1.0f));
+        sp.process(&dst[0], 0x20);
+        UTEST_ASSERT(float_equals_absolute(dst[0], 2.0f, 1e-5f));
+        UTEST_ASSERT(sp.gc() == 1);
+        UTEST_ASSERT(sp.post_stop());
+        UTEST_ASSERT(sp.post_unbind(0));
+        sp.process(&dst[0], 0x20);
+        UTEST_ASSERT(sp.playbacks() == 0);
+        UTEST_ASSERT(float_equals_absolute(dst[0], 0.0f, 1e-5f));
+        UTEST_ASSERT(sp.gc() == 1);
+
+        sp.destroy(true);
+    }
+
+    void test_concurrent_commands()
+    {
+        printf("Testing concurrent posting of commands...\n");
+
+        dspu::SamplePlayer sp;
+        UTEST_ASSERT(sp.init(1, 0x40, 0x40));
+
+        dspu::Sample *s = new dspu::Sample();
+        s->init(1, 1, 1);
+        s->getBuffer(0)[0] = 1.0f;
+        UTEST_ASSERT(sp.bind(0, s));
+
+        // Each executed command produces exactly one sample of the unit amplitude
+        atomic_t done = 0;
+        Poster *threads[POST_THREADS];
+        for (size_t i=0; i<POST_THREADS; ++i)
+        {
+            threads[i] = new Poster(&sp, &done);
+            UTEST_ASSERT(threads[i]->start() == STATUS_OK);
+        }
+
+        FloatBuffer dst(0x10);
+        float sum = 0.0f;
+        while (true)
+        {
+            bool finished = atomic_add(&done, 0) >= POST_THREADS;
+            sp.process(dst, dst.size());
+            for (size_t i=0; i<dst.size(); ++i)
+                sum += dst[i];
+            if (finished)
+                break;
+            ipc::Thread::sleep(0);
+        }
+
+        for (size_t i=0; i<POST_THREADS; ++i)
+        {
+            threads[i]->join();
+            delete threads[i];
+        }
+
+        UTEST_ASSERT_MSG(float_equals_absolute(sum, POST_THREADS * POST_COMMANDS, 1e-3f),
+            "Executed %d commands, expected %d", int(sum), int(POST_THREADS * POST_COMMANDS));
+
+        sp.destroy(true);
+    }
+
+    UTEST_MAIN
+    {
+        test_mix();
+        test_fadeout();
+        test_steal();
+
+        test_rate(dspu::SPI_LINEAR, "linear", 0.83f, 1e-3f);
+        test_rate(dspu::SPI_CUBIC, "cubic", 0.5f, 1e-4f);
+        test_rate(dspu::SPI_CUBIC, "cubic", 1.37f, 1e-4f);
+        test_rate(dspu::SPI_SINC, "sinc", 0.71f, 1e-3f);
+        test_rate(dspu::SPI_SINC, "sinc", 3.0f, 1e-3f);
+        test_loop(1.0f);
+        test_loop(0.75f);
+        test_loop(2.5f);
+        test_mapped();
+        test_compact(1.0f);
+        test_compact(0.75f);
+        test_commands();
+        test_concurrent_commands();
+    }
+UTEST_END;
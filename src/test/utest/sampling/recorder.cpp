@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/sampling/SampleRecorder.h>
+#include <lsp-plug.in/dsp-units/sampling/Sample.h>
+#include <lsp-plug.in/ipc/Thread.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define TEST_SRATE      48000
+#define TEST_LENGTH     0x30000
+#define TEST_CHANNELS   3
+
+UTEST_BEGIN("dspu.sampling", recorder)
+
+    static float test_value(size_t channel, size_t index)
+    {
+        return sinf(index * 0.01f * (channel + 1));
+    }
+
+    void test_record()
+    {
+        static const size_t blocks[] = { 0x100, 0x7, 0x333, 0x40, 0x1000 };
+
+        printf("Testing background recording of the sample...\n");
+
+        io::Path path;
+        UTEST_ASSERT(path.fmt("%s/%s.wav", tempdir(), full_name()) > 0);
+
+        // The ring buffer is much smaller than the recording
+        dspu::SampleRecorder rec;
+        UTEST_ASSERT(rec.open(&path, TEST_CHANNELS, TEST_SRATE, 0x2000, 0x800) == STATUS_OK);
+        UTEST_ASSERT(rec.valid());
+        UTEST_ASSERT(rec.capacity() == 0x2000);
+
+        FloatBuffer buf(0x1000 * TEST_CHANNELS);
+        for (size_t off=0, i=0; off < TEST_LENGTH; ++i)
+        {
+            size_t to_do    = lsp_min(size_t(TEST_LENGTH) - off, blocks[i % (sizeof(blocks)/sizeof(size_t))]);
+            const float *src[TEST_CHANNELS];
+            for (size_t j=0; j<TEST_CHANNELS; ++j)
+            {
+                float *dst      = buf.data(j * 0x1000);
+                for (size_t k=0; k<to_do; ++k)
+                    dst[k]          = test_value(j, off + k);
+                src[j]          = dst;
+            }
+            src[TEST_CHANNELS - 1]  = NULL;
+
+            // Wait for the writer if the ring buffer is full
+            for (size_t done = 0; done < to_do; )
+            {
+                const float *ptr[TEST_CHANNELS];
+                for (size_t j=0; j<TEST_CHANNELS; ++j)
+                    ptr[j]          = (src[j] != NULL) ? &src[j][done] : NULL;
+                done           += rec.write(ptr, to_do - done);
+                if (done < to_do)
+                    ipc::Thread::sleep(1);
+            }
+            off            += to_do;
+        }
+
+        UTEST_ASSERT(rec.close() == STATUS_OK);
+        UTEST_ASSERT(!rec.valid());
+
+        // Check the file contents
+        dspu::Sample s;
+        UTEST_ASSERT(s.load(&path) == STATUS_OK);
+        UTEST_ASSERT(s.channels() == TEST_CHANNELS);
+        UTEST_ASSERT(s.sample_rate() == TEST_SRATE);
+        UTEST_ASSERT(s.length() == TEST_LENGTH);
+
+        for (size_t i=0; i<TEST_CHANNELS; ++i)
+        {
+            const float *src    = s.channel(i);
+            for (size_t j=0; j<TEST_LENGTH; ++j)
+            {
+                float v             = (i < TEST_CHANNELS - 1) ? test_value(i, j) : 0.0f;
+                UTEST_ASSERT_MSG(float_equals_absolute(src[j], v, 1e-6f),
+                    "Invalid frame %d of channel %d: %f, expected %f", int(j), int(i), src[j], v);
+            }
+        }
+    }
+
+    UTEST_MAIN
+    {
+        test_record();
+    }
+
+UTEST_END
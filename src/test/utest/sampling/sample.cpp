@@ -22,7 +22,9 @@
 #include <lsp-plug.in/test-fw/utest.h>
 #include <lsp-plug.in/test-fw/FloatBuffer.h>
 #include <lsp-plug.in/dsp-units/sampling/Sample.h>
+#include <lsp-plug.in/dsp-units/util/LoudnessMeter.h>
 #include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/stdlib/string.h>
 
 #define TEST_SRATE      48000
 #define TONE_RATE       440.0f
@@ -111,6 +113,63 @@ UTEST_BEGIN("dspu.sampling", sample)
         }
     }
 
+    void test_cache()
+    {
+        printf("Testing save & load for Sample cache...\n");
+
+        dspu::Sample s, l;
+        init_sample(&s);
+
+        io::Path src, dir, path, path2;
+        UTEST_ASSERT(src.fmt("%s/%s-cache-src.wav", tempdir(), full_name()) > 0);
+        UTEST_ASSERT(dir.set(tempdir()) == STATUS_OK);
+        UTEST_ASSERT(s.save(&src) == TEST_SRATE);
+
+        UTEST_ASSERT(dspu::Sample::cache_path(&path, &dir, &src, TEST_SRATE) == STATUS_OK);
+        UTEST_ASSERT(dspu::Sample::cache_path(&path2, &dir, &src, TEST_SRATE * 2) == STATUS_OK);
+        UTEST_ASSERT(strcmp(path.as_utf8(), path2.as_utf8()) != 0);
+
+        printf("Saving sample cache to '%s'\n", path.as_utf8());
+        UTEST_ASSERT(s.save_cache(&path, &src) == STATUS_OK);
+
+        UTEST_ASSERT(l.load_cache(&path, &src, TEST_SRATE * 2) == STATUS_NOT_FOUND);
+        UTEST_ASSERT(l.load_cache(&path2, &src, TEST_SRATE * 2) == STATUS_NOT_FOUND);
+        UTEST_ASSERT(!l.valid());
+
+        printf("Loading sample cache from '%s'\n", path.as_utf8());
+        UTEST_ASSERT(l.load_cache(&path, &src, TEST_SRATE) == STATUS_OK);
+        UTEST_ASSERT(l.mapped());
+        UTEST_ASSERT(l.channels() == s.channels());
+        UTEST_ASSERT(l.sample_rate() == s.sample_rate());
+        UTEST_ASSERT(l.length() == s.length());
+        UTEST_ASSERT(l.max_length() == s.max_length());
+
+        // Check the sample
+        for (size_t i=0; i<s.channels(); ++i)
+        {
+            float *s0 = s.channel(i);
+            float *s1 = l.channel(i);
+
+            for (size_t j=0; j<s.length(); ++j)
+            {
+                if (s0[j] != s1[j])
+                {
+                    eprintf("Failed sample check at sample %d, channel %d: s0=%f, s1=%f\n",
+                            int(j), int(i), s0[j], s1[j]);
+                    UTEST_FAIL();
+                }
+            }
+        }
+
+        // Mapped data should be modifiable and survive reallocation
+        l.reverse();
+        UTEST_ASSERT(float_equals_absolute(l.channel(1)[0], 1.0f));
+        UTEST_ASSERT(l.resize(l.channels(), l.max_length() * 2, l.length()));
+        UTEST_ASSERT(!l.mapped());
+        UTEST_ASSERT(float_equals_absolute(l.channel(1)[0], 1.0f));
+        l.destroy();
+    }
+
     void test_resample(size_t srate)
     {
         printf("Testing resample with sample rate %d...\n", int(srate));
@@ -135,15 +194,288 @@ UTEST_BEGIN("dspu.sampling", sample)
         UTEST_ASSERT(l.sample_rate() == srate);
     }
 
+    void test_resample_accuracy(size_t srate)
+    {
+        printf("Testing resample accuracy with sample rate %d...\n", int(srate));
+
+        dspu::Sample s;
+        init_sample(&s);
+        UTEST_ASSERT(s.resample(srate, 2) == STATUS_OK);
+        UTEST_ASSERT(s.sample_rate() == srate);
+        UTEST_ASSERT(s.length() == (size_t(TEST_SRATE) * srate + TEST_SRATE - 1) / TEST_SRATE);
+
+        // The tone should be preserved, except the edges of the sample
+        const float *c0 = s.channel(0);
+        float w = 2.0f * M_PI * TONE_RATE / float(srate);
+        for (size_t i=0x40; i<s.length() - 0x40; ++i)
+        {
+            float v = sinf(w * i);
+            if (!float_equals_absolute(c0[i], v, 2e-3f))
+            {
+                eprintf("Failed sample check at sample %d: s=%f, v=%f\n", int(i), c0[i], v);
+                UTEST_FAIL();
+            }
+        }
+    }
+
+    void test_parallel_resample(size_t srate)
+    {
+        printf("Testing parallel resample with sample rate %d...\n", int(srate));
+
+        dspu::Sample o, s, b[3];
+        init_sample(&o);
+
+        UTEST_ASSERT(s.copy(&o) == STATUS_OK);
+        UTEST_ASSERT(s.resample(srate) == STATUS_OK);
+        for (size_t i=0; i<3; ++i)
+            UTEST_ASSERT(b[i].copy(&o) == STATUS_OK);
+
+        // Resample the batch of samples, one sample already matches the sample rate
+        UTEST_ASSERT(b[2].resample(srate, 4) == STATUS_OK);
+        dspu::Sample *list[3] = { &b[0], &b[1], &b[2] };
+        UTEST_ASSERT(dspu::Sample::resample(list, 3, srate, 4) == STATUS_OK);
+
+        for (size_t k=0; k<3; ++k)
+        {
+            const dspu::Sample *l = &b[k];
+            UTEST_ASSERT(l->channels() == s.channels());
+            UTEST_ASSERT(l->sample_rate() == srate);
+            UTEST_ASSERT(l->length() == s.length());
+
+            for (size_t i=0; i<s.channels(); ++i)
+            {
+                const float *s0 = s.channel(i);
+                const float *s1 = l->channel(i);
+
+                for (size_t j=0; j<s.length(); ++j)
+                {
+                    if (!float_equals_absolute(s0[j], s1[j], 1e-4f))
+                    {
+                        eprintf("Failed sample check at sample %d, channel %d: s0=%f, s1=%f\n",
+                                int(j), int(i), s0[j], s1[j]);
+                        UTEST_FAIL();
+                    }
+                }
+            }
+        }
+    }
+
+    void init_tone(dspu::Sample *s, size_t length, float level)
+    {
+        UTEST_ASSERT(s->init(2, length, length));
+        s->set_sample_rate(TEST_SRATE);
+
+        float amp = expf(level * M_LN10 / 20.0f);
+        float w = 2.0f * M_PI * 1000.0f / float(TEST_SRATE);
+        for (size_t i=0; i<length; ++i)
+        {
+            float v = amp * sinf(w * (i % TEST_SRATE));
+            s->channel(0)[i] = v;
+            s->channel(1)[i] = v;
+        }
+    }
+
+    float to_lufs(float level)
+    {
+        return 20.0f * log10f(level);
+    }
+
+    void test_normalize()
+    {
+        printf("Testing sample normalization...\n");
+
+        dspu::Sample s;
+        float l1, l2;
+
+        // Parallel measurement matches the sequential one and the loudness meter
+        init_tone(&s, TEST_SRATE * 20, -20.0f);
+        UTEST_ASSERT(s.measure(&l1, dspu::SAMPLE_MEASURE_LUFS, 1) == STATUS_OK);
+        UTEST_ASSERT(s.measure(&l2, dspu::SAMPLE_MEASURE_LUFS, 4) == STATUS_OK);
+        UTEST_ASSERT(l1 == l2);
+
+        dspu::LoudnessMeter m;
+        UTEST_ASSERT(m.init(2));
+        m.set_sample_rate(TEST_SRATE);
+        const float *in[2] = { s.channel(0), s.channel(1) };
+        m.process(in, s.length());
+        printf("  sample: %.3f LUFS, meter: %.3f LUFS\n", to_lufs(l1), m.integrated());
+        UTEST_ASSERT(float_equals_absolute(to_lufs(l1), m.integrated(), 0.05f));
+        UTEST_ASSERT(float_equals_absolute(to_lufs(l1), -20.0f, 0.1f));
+
+        // Loudness normalization
+        UTEST_ASSERT(s.normalize(expf(-23.0f * M_LN10 / 20.0f), dspu::SAMPLE_NORM_ALWAYS, dspu::SAMPLE_MEASURE_LUFS, 4) == STATUS_OK);
+        UTEST_ASSERT(s.measure(&l1, dspu::SAMPLE_MEASURE_LUFS, 4) == STATUS_OK);
+        UTEST_ASSERT(float_equals_absolute(to_lufs(l1), -23.0f, 0.05f));
+
+        // Normalization below the level does not change the sample
+        UTEST_ASSERT(s.normalize(0.01f, dspu::SAMPLE_NORM_BELOW, dspu::SAMPLE_MEASURE_RMS, 4) == STATUS_OK);
+        UTEST_ASSERT(s.measure(&l2, dspu::SAMPLE_MEASURE_LUFS, 4) == STATUS_OK);
+        UTEST_ASSERT(l1 == l2);
+
+        // RMS and peak normalization
+        UTEST_ASSERT(s.normalize(0.1f, dspu::SAMPLE_NORM_ALWAYS, dspu::SAMPLE_MEASURE_RMS, 3) == STATUS_OK);
+        UTEST_ASSERT(s.measure(&l1, dspu::SAMPLE_MEASURE_RMS, 2) == STATUS_OK);
+        UTEST_ASSERT(float_equals_absolute(l1, 0.1f, 1e-4f));
+        s.normalize(0.5f, dspu::SAMPLE_NORM_ALWAYS);
+        UTEST_ASSERT(s.measure(&l1, dspu::SAMPLE_MEASURE_PEAK, 4) == STATUS_OK);
+        UTEST_ASSERT(float_equals_absolute(l1, 0.5f, 1e-5f));
+
+        // Samples shorter than the gating block are measured as a whole
+        init_tone(&s, TEST_SRATE / 5, -20.0f);
+        UTEST_ASSERT(s.measure(&l1, dspu::SAMPLE_MEASURE_LUFS, 4) == STATUS_OK);
+        UTEST_ASSERT(float_equals_absolute(to_lufs(l1), -20.0f, 0.1f));
+    }
+
+    void check_overview(const dspu::Sample *s, size_t first, size_t count, size_t width)
+    {
+        FloatBuffer vmin(width), vmax(width);
+
+        for (size_t c=0; c<s->channels(); ++c)
+        {
+            UTEST_ASSERT(s->overview(c, vmin, vmax, first, count, width) == STATUS_OK);
+            UTEST_ASSERT(vmin.valid());
+            UTEST_ASSERT(vmax.valid());
+
+            const float *src = s->channel(c);
+            count = lsp_min(count, s->length() - first);
+            for (size_t i=0; i<width; ++i)
+            {
+                size_t a = first + (uint64_t(i) * count) / width;
+                size_t b = lsp_min(lsp_max(first + (uint64_t(i + 1) * count) / width, a + 1), first + count);
+                float xmin = src[a], xmax = src[a];
+                for (size_t j=a; j<b; ++j)
+                {
+                    xmin = lsp_min(xmin, src[j]);
+                    xmax = lsp_max(xmax, src[j]);
+                }
+
+                UTEST_ASSERT_MSG((vmin[i] == xmin) && (vmax[i] == xmax),
+                    "Invalid overview of channel %d column %d: [%f, %f], expected [%f, %f]",
+                    int(c), int(i), vmin[i], vmax[i], xmin, xmax);
+            }
+        }
+    }
+
+    void test_peaks()
+    {
+        printf("Testing waveform overview...\n");
+
+        dspu::Sample s;
+        UTEST_ASSERT(s.init(2, TEST_SRATE, TEST_SRATE - 7));
+        s.set_sample_rate(TEST_SRATE);
+        for (size_t c=0; c<s.channels(); ++c)
+        {
+            float *dst = s.channel(c);
+            for (size_t i=0; i<s.max_length(); ++i)
+                dst[i] = (float(rand()) / RAND_MAX) * 2.0f - 1.0f;
+        }
+
+        UTEST_ASSERT(s.peaks() == NULL);
+        check_overview(&s, 0, s.length(), 200);
+
+        UTEST_ASSERT(s.build_peaks(2) == STATUS_OK);
+        UTEST_ASSERT(s.peaks() != NULL);
+        UTEST_ASSERT(s.peaks()->length() == s.length());
+        check_overview(&s, 0, s.length(), 200);
+        check_overview(&s, 1000, 30000, 777);
+        check_overview(&s, 12345, 100, 640);
+
+        // Incremental updates
+        s.set_length(10000);
+        check_overview(&s, 0, s.length(), 333);
+        s.channel(1)[9000] = 2.0f;
+        s.update_peaks(9000);
+        for (size_t len=10000; len < TEST_SRATE; len += 1234)
+        {
+            s.extend(len);
+            UTEST_ASSERT(s.peaks()->length() == s.length());
+            check_overview(&s, 7, s.length(), 111);
+        }
+
+        // The overview is kept after modification of the sample
+        s.reverse();
+        check_overview(&s, 0, s.length(), 200);
+        UTEST_ASSERT(s.resample(TEST_SRATE / 2, 2) == STATUS_OK);
+        UTEST_ASSERT(s.peaks() != NULL);
+        UTEST_ASSERT(s.peaks()->length() == s.length());
+        check_overview(&s, 0, s.length(), 200);
+
+        s.drop_peaks();
+        UTEST_ASSERT(s.peaks() == NULL);
+    }
+
+    void test_compact()
+    {
+        printf("Testing compact storage...\n");
+
+        dspu::Sample s, c;
+        init_sample(&s);
+        // Quiet block should keep the precision
+        for (size_t i=0; i<SAMPLE_COMPACT_BLOCK_SIZE; ++i)
+            s.channel(0)[i + SAMPLE_COMPACT_BLOCK_SIZE] *= 1e-4f;
+        UTEST_ASSERT(c.copy(&s) == STATUS_OK);
+
+        UTEST_ASSERT(c.compact() == STATUS_OK);
+        UTEST_ASSERT(c.compacted());
+        UTEST_ASSERT(c.valid());
+        UTEST_ASSERT(c.length() == s.length());
+        UTEST_ASSERT(c.build_peaks() == STATUS_BAD_STATE);
+        UTEST_ASSERT(!c.reverse(0));
+
+        // Read data by odd blocks, the tail after the end is silence
+        FloatBuffer buf(s.length() + 100);
+        for (size_t i=0; i<s.channels(); ++i)
+        {
+            for (size_t off=0; off<buf.size(); off += 333)
+            {
+                size_t to_do = lsp_min(buf.size() - off, size_t(333));
+                size_t n = c.read(i, buf.data(off), off, to_do);
+                UTEST_ASSERT(n == size_t(lsp_max(ssize_t(lsp_min(s.length(), off + to_do)) - ssize_t(off), ssize_t(0))));
+            }
+            UTEST_ASSERT(buf.valid());
+
+            const float *src = s.channel(i);
+            for (size_t j=0; j<buf.size(); ++j)
+            {
+                bool quiet = (i == 0) && (j >= SAMPLE_COMPACT_BLOCK_SIZE) && (j < SAMPLE_COMPACT_BLOCK_SIZE * 2);
+                float v = (j < s.length()) ? src[j] : 0.0f;
+                UTEST_ASSERT_MSG(float_equals_absolute(buf[j], v, (quiet) ? 1e-8f : 1e-4f),
+                    "Invalid sample %d of channel %d: %f, expected %f", int(j), int(i), buf[j], v);
+            }
+        }
+
+        // Expand back to the floating-point data
+        UTEST_ASSERT(c.expand() == STATUS_OK);
+        UTEST_ASSERT(!c.compacted());
+        for (size_t i=0; i<s.channels(); ++i)
+        {
+            const float *a = s.channel(i);
+            const float *b = c.channel(i);
+            for (size_t j=0; j<s.length(); ++j)
+                UTEST_ASSERT(float_equals_absolute(a[j], b[j], 1e-4f));
+        }
+    }
+
     UTEST_MAIN
     {
         test_copy();
         test_io();
+        test_cache();
         test_resample(TEST_SRATE);
         test_resample(TEST_SRATE / 2);
         test_resample(TEST_SRATE * 2);
         test_resample(44100);
         test_resample(88200);
+        test_resample_accuracy(44100);
+        test_resample_accuracy(96000);
+        test_resample_accuracy(22050);
+        test_parallel_resample(TEST_SRATE / 2);
+        test_parallel_resample(TEST_SRATE * 2);
+        test_parallel_resample(44100);
+        test_parallel_resample(96000);
+        test_normalize();
+        test_peaks();
+        test_compact();
     }
 UTEST_END
 
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/sampling/SamplePlayer.h>
+#include <lsp-plug.in/dsp-units/sampling/SampleStream.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/ipc/Thread.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define TEST_SRATE      48000
+#define TEST_LENGTH     20000
+#define PAGE_SIZE       0x400
+#define PAGES           4
+#define BLOCK_SIZE      0x100
+#define WAIT_TIMEOUT    5000
+
+UTEST_BEGIN("dspu.sampling", stream)
+    void init_sample(dspu::Sample *s)
+    {
+        UTEST_ASSERT(s->init(2, TEST_LENGTH, TEST_LENGTH));
+        s->set_sample_rate(TEST_SRATE);
+
+        float *c0 = s->channel(0);
+        float *c1 = s->channel(1);
+        float w = 2.0f * M_PI * 440.0f / float(TEST_SRATE);
+        float k = 1.0f / (TEST_LENGTH - 1);
+
+        for (size_t i=0; i<TEST_LENGTH; ++i)
+        {
+            c0[i] = sinf(w * i);
+            c1[i] = i * k;
+        }
+    }
+
+    void wait_ready(dspu::SampleStream *ss, wsize_t offset, size_t count)
+    {
+        // Request the data and wait for the reader to load it
+        ss->prefetch(offset);
+        wsize_t last = lsp_min(offset + count, ss->length()) - 1;
+        for (size_t i=0; ; ++i)
+        {
+            if ((ss->ready(offset)) && (ss->ready(last)))
+                return;
+            if (i >= WAIT_TIMEOUT)
+                UTEST_FAIL_MSG("Timeout waiting for data at offset %d", int(offset));
+            ipc::Thread::sleep(1);
+        }
+    }
+
+    void test_read(const dspu::Sample *s, const io::Path *path)
+    {
+        printf("Testing sequential read of the stream...\n");
+
+        dspu::SampleStream ss;
+        UTEST_ASSERT(ss.open(path, PAGES, PAGE_SIZE - 1) == STATUS_OK);
+        UTEST_ASSERT(ss.valid());
+        UTEST_ASSERT(ss.channels() == s->channels());
+        UTEST_ASSERT(ss.sample_rate() == s->sample_rate());
+        UTEST_ASSERT(ss.length() == s->length());
+        UTEST_ASSERT(ss.page_size() == PAGE_SIZE);
+        UTEST_ASSERT(ss.pages() == PAGES);
+
+        FloatBuffer buf(BLOCK_SIZE + 3);
+        for (size_t offset=0; offset < TEST_LENGTH + BLOCK_SIZE; offset += BLOCK_SIZE + 3)
+        {
+            size_t avail = (offset < TEST_LENGTH) ? lsp_min(size_t(TEST_LENGTH - offset), buf.size()) : 0;
+            if (avail > 0)
+                wait_ready(&ss, offset, buf.size());
+
+            for (size_t i=0; i<ss.channels(); ++i)
+            {
+                buf.randomize(-1.0f, 1.0f);
+                UTEST_ASSERT(ss.read(i, buf, offset, buf.size()) == avail);
+                UTEST_ASSERT_MSG(buf.valid(), "Buffer corrupted");
+
+                const float *src = s->channel(i);
+                for (size_t j=0; j<buf.size(); ++j)
+                {
+                    float v = (j < avail) ? src[offset + j] : 0.0f;
+                    if (!float_equals_absolute(buf[j], v, 1e-5f))
+                        UTEST_FAIL_MSG("Failed sample check at sample %d, channel %d: s=%f, v=%f",
+                                int(offset + j), int(i), buf[j], v);
+                }
+            }
+        }
+
+        // Reading of the data far from the cached window should not block and return silence
+        size_t ur = ss.underruns();
+        size_t nread = ss.read(0, buf, 0, buf.size());
+        if (nread == 0)
+        {
+            UTEST_ASSERT(ss.underruns() == ur + 1);
+            for (size_t j=0; j<buf.size(); ++j)
+                UTEST_ASSERT(buf[j] == 0.0f);
+        }
+
+        UTEST_ASSERT(ss.close() == STATUS_OK);
+        UTEST_ASSERT(!ss.valid());
+    }
+
+    void test_player(const dspu::Sample *s, const io::Path *path)
+    {
+        printf("Testing playback of the stream...\n");
+
+        dspu::SampleStream ss;
+        UTEST_ASSERT(ss.open(path, PAGES, PAGE_SIZE) == STATUS_OK);
+
+        dspu::SamplePlayer sp;
+        UTEST_ASSERT(sp.init(1, 2));
+        UTEST_ASSERT(sp.bind_stream(0, &ss));
+        UTEST_ASSERT(!sp.play(0, 2, 1.0f));
+        UTEST_ASSERT(sp.play(0, 1, 0.5f, 10));
+
+        FloatBuffer dst(TEST_LENGTH + BLOCK_SIZE);
+        FloatBuffer exp(TEST_LENGTH + BLOCK_SIZE);
+        exp.fill_zero();
+        dsp::mul_k3(&exp[10], s->channel(1), 0.5f, TEST_LENGTH);
+
+        for (size_t offset=0; offset < dst.size(); offset += BLOCK_SIZE)
+        {
+            size_t to_do = lsp_min(dst.size() - offset, size_t(BLOCK_SIZE));
+            if (offset < TEST_LENGTH + 10)
+                wait_ready(&ss, (offset >= 10) ? offset - 10 : 0, to_do);
+            sp.process(&dst[offset], to_do);
+        }
+
+        UTEST_ASSERT(sp.unbind_stream(0));
+        sp.destroy(true);
+        UTEST_ASSERT(ss.close() == STATUS_OK);
+
+        UTEST_ASSERT_MSG(dst.valid(), "Destination buffer corrupted");
+        if (!dst.equals_absolute(exp, 1e-5f))
+        {
+            exp.dump("exp");
+            dst.dump("dst");
+            UTEST_FAIL_MSG("Output of the player differs");
+        }
+    }
+
+    UTEST_MAIN
+    {
+        dspu::Sample s;
+        init_sample(&s);
+
+        io::Path path;
+        UTEST_ASSERT(path.fmt("%s/%s-stream.wav", tempdir(), full_name()) > 0);
+        printf("Saving sample to '%s'\n", path.as_utf8());
+        UTEST_ASSERT(s.save(&path) == TEST_LENGTH);
+
+        test_read(&s, &path);
+        test_player(&s, &path);
+    }
+UTEST_END
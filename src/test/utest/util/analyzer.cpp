@@ -0,0 +1,295 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/util/Analyzer.h>
+#include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/stdlib/string.h>
+
+#define SAMPLE_RATE     48000
+#define RANK            12
+#define POINTS          64
+#define ROWS            16
+#define BUF_SIZE        0x400
+
+UTEST_BEGIN("dspu.util", analyzer)
+
+    void test_spectrogram(const char *label, dspu::spectrogram_format_t format, float step)
+    {
+        printf("Testing %s spectrogram\n", label);
+
+        dspu::Analyzer a;
+        float frq[POINTS];
+        uint32_t idx[POINTS];
+
+        UTEST_ASSERT(a.init(2, RANK, SAMPLE_RATE, 20.0f));
+        a.set_sample_rate(SAMPLE_RATE);
+        a.set_rank(RANK);
+        a.set_rate(50.0f);
+        a.set_batch(true);
+        a.reconfigure();
+        a.get_frequencies(frq, idx, 20.0f, 20000.0f, POINTS);
+
+        UTEST_ASSERT(a.init_snapshot(idx, POINTS));
+        UTEST_ASSERT(a.init_spectrogram(idx, POINTS, ROWS, format, -120.0f, 24.0f));
+        UTEST_ASSERT(a.spectrogram_size() == POINTS);
+        UTEST_ASSERT(a.spectrogram_rows() == ROWS);
+        UTEST_ASSERT(a.spectrogram_position() == 0);
+
+        // Sine wave in the first channel, silence in the second one
+        FloatBuffer sig(BUF_SIZE);
+        const float *in[2] = { sig.data(), NULL };
+        for (size_t i=0, phase=0; i<SAMPLE_RATE; i += BUF_SIZE)
+        {
+            for (size_t j=0; j<BUF_SIZE; ++j, ++phase)
+                sig[j]      = 0.5f * sinf(2.0f * M_PI * 1000.0f * phase / SAMPLE_RATE);
+            a.process(in, BUF_SIZE);
+        }
+        UTEST_ASSERT(sig.valid());
+
+        size_t position = a.spectrogram_position();
+        printf("  appended %d rows\n", int(position));
+        UTEST_ASSERT(position > ROWS);
+
+        // The latest row of the view matches the latest snapshot
+        UTEST_ASSERT(a.fetch_snapshot());
+        const float *snap = a.snapshot(0);
+        const void *view = a.spectrogram(0, position);
+        UTEST_ASSERT((snap != NULL) && (view != NULL));
+
+        for (size_t i=0; i<POINTS; ++i)
+        {
+            size_t off      = (ROWS - 1) * POINTS + i;
+            size_t value    = (format == dspu::SPECTROGRAM_U16) ?
+                static_cast<const uint16_t *>(view)[off] :
+                static_cast<const uint8_t *>(view)[off];
+            float level     = a.spectrogram_level(value);
+            float expected  = lsp_limit(20.0f * log10f(lsp_max(snap[i], 1e-10f)), -120.0f, 24.0f);
+
+            UTEST_ASSERT_MSG(fabsf(level - expected) <= step,
+                "Invalid level at frequency %.1f: %f, expected %f", frq[i], level, expected);
+        }
+
+        // The silent channel stays at the minimum level
+        view = a.spectrogram(1, position);
+        for (size_t i=0; i<ROWS * POINTS; ++i)
+        {
+            size_t value    = (format == dspu::SPECTROGRAM_U16) ?
+                static_cast<const uint16_t *>(view)[i] :
+                static_cast<const uint8_t *>(view)[i];
+            UTEST_ASSERT(value == 0);
+        }
+
+        // The view at the previous position is shifted by one row
+        const uint8_t *v1 = static_cast<const uint8_t *>(a.spectrogram(0, position));
+        const uint8_t *v2 = static_cast<const uint8_t *>(a.spectrogram(0, position - 1));
+        size_t row = POINTS * ((format == dspu::SPECTROGRAM_U16) ? sizeof(uint16_t) : sizeof(uint8_t));
+        UTEST_ASSERT(memcmp(v1, &v2[row], (ROWS - 1) * row) == 0);
+    }
+
+    void setup(dspu::Analyzer &a, bool batch, bool amortize)
+    {
+        UTEST_ASSERT(a.init(2, RANK + 2, SAMPLE_RATE, 20.0f));
+        a.set_sample_rate(SAMPLE_RATE);
+        a.set_rank(RANK + 2);
+        a.set_rate(20.0f);
+        a.set_batch(batch);
+        a.set_amortized(amortize);
+        a.set_reactivity(50.0f);
+        a.reconfigure();
+    }
+
+    void feed(dspu::Analyzer &a, const float *l, const float *r, size_t samples)
+    {
+        static const size_t blocks[] = { 1, 64, 300, 17, 1024, 2048 };
+
+        for (size_t offset=0, i=0; offset < samples; ++i)
+        {
+            size_t to_do    = lsp_min(samples - offset, blocks[i % (sizeof(blocks)/sizeof(size_t))]);
+            const float *in[2] = { &l[offset], &r[offset] };
+            a.process(in, to_do);
+            offset         += to_do;
+        }
+    }
+
+    void test_amortized(bool batch)
+    {
+        printf("Testing amortized FFT, batch=%s\n", (batch) ? "true" : "false");
+
+        dspu::Analyzer a1, a2;
+        setup(a1, batch, false);
+        setup(a2, batch, true);
+        UTEST_ASSERT(a2.get_amortized());
+
+        // In batch mode the amortized analyzer publishes the same spectrum one strobe later,
+        // in regular mode the transform of each channel completes before the publication anyway
+        size_t period   = SAMPLE_RATE / 20;
+        size_t samples  = period * 8;
+        FloatBuffer l(samples + period + 1), r(samples + period + 1);
+        l.randomize_sign();
+        r.randomize_sign();
+
+        feed(a1, l, r, samples);
+        feed(a2, l, r, samples + ((batch) ? period + 1 : 0));
+
+        uint32_t idx[POINTS];
+        float frq[POINTS], s1[POINTS], s2[POINTS];
+        a1.get_frequencies(frq, idx, 20.0f, 20000.0f, POINTS);
+        for (size_t i=0; i<2; ++i)
+        {
+            UTEST_ASSERT(a1.get_spectrum(i, s1, idx, POINTS));
+            UTEST_ASSERT(a2.get_spectrum(i, s2, idx, POINTS));
+            for (size_t j=0; j<POINTS; ++j)
+            {
+                UTEST_ASSERT_MSG(s1[j] > 0.0f, "Empty spectrum at frequency %.1f", frq[j]);
+                UTEST_ASSERT_MSG(float_equals_relative(s1[j], s2[j], 1e-3f),
+                    "Channel %d, frequency %.1f: amortized %g, expected %g", int(i), frq[j], s2[j], s1[j]);
+            }
+        }
+    }
+
+    void test_ranges()
+    {
+        printf("Testing spectrum reduced over frequency ranges\n");
+
+        dspu::Analyzer a;
+        setup(a, true, false);
+
+        size_t samples  = SAMPLE_RATE / 2;
+        FloatBuffer l(samples), r(samples);
+        l.randomize_sign();
+        r.randomize_sign();
+        feed(a, l, r, samples);
+
+        uint32_t bounds[POINTS + 1];
+        float frq[POINTS], vmax[POINTS], vmin[POINTS], vavg[POINTS];
+        a.get_frequency_ranges(frq, bounds, 20.0f, 20000.0f, POINTS);
+        UTEST_ASSERT(a.get_spectrum(0, vmax, bounds, POINTS, dspu::FRQA_FUNC_MAX));
+        UTEST_ASSERT(a.get_spectrum(0, vmin, bounds, POINTS, dspu::FRQA_FUNC_MIN));
+        UTEST_ASSERT(a.get_spectrum(0, vavg, bounds, POINTS, dspu::FRQA_FUNC_AVG));
+
+        for (size_t i=0; i<POINTS; ++i)
+        {
+            UTEST_ASSERT(bounds[i] <= bounds[i+1]);
+
+            // Compare with the levels of individual bins
+            size_t last     = lsp_max(bounds[i+1], bounds[i] + 1);
+            float emax      = 0.0f, emin = 1e+10f, esum = 0.0f;
+            for (size_t j=bounds[i]; j<last; ++j)
+            {
+                float v         = a.get_level(0, j);
+                emax            = lsp_max(emax, v);
+                emin            = lsp_min(emin, v);
+                esum           += v * v;
+            }
+            float eavg      = sqrtf(esum / (last - bounds[i]));
+
+            UTEST_ASSERT_MSG(float_equals_relative(vmax[i], emax, 1e-5f),
+                "Maximum at frequency %.1f: %g, expected %g", frq[i], vmax[i], emax);
+            UTEST_ASSERT_MSG(float_equals_relative(vmin[i], emin, 1e-5f),
+                "Minimum at frequency %.1f: %g, expected %g", frq[i], vmin[i], emin);
+            UTEST_ASSERT_MSG(float_equals_relative(vavg[i], eavg, 1e-4f),
+                "Average at frequency %.1f: %g, expected %g", frq[i], vavg[i], eavg);
+            UTEST_ASSERT((vmin[i] <= vavg[i] * 1.0001f) && (vavg[i] <= vmax[i] * 1.0001f));
+        }
+    }
+
+    void test_lazy()
+    {
+        printf("Testing lazy allocation of buffers\n");
+
+        dspu::Analyzer a1, a2;
+        setup(a1, true, false);
+
+        UTEST_ASSERT(a2.init(2, RANK + 4, SAMPLE_RATE, 5.0f, true));
+        UTEST_ASSERT(a2.get_lazy());
+        a2.set_sample_rate(SAMPLE_RATE);
+        a2.set_rank(RANK + 2);
+        a2.set_rate(20.0f);
+        a2.set_batch(true);
+        a2.set_reactivity(50.0f);
+
+        // Nothing is allocated and analyzed until prepare() is called
+        uint32_t idx[POINTS];
+        float frq[POINTS], s1[POINTS], s2[POINTS];
+        a1.get_frequencies(frq, idx, 20.0f, 20000.0f, POINTS);
+
+        size_t samples  = SAMPLE_RATE / 2;
+        FloatBuffer l(samples), r(samples);
+        l.randomize_sign();
+        r.randomize_sign();
+
+        UTEST_ASSERT(!a2.prepared());
+        UTEST_ASSERT(a2.get_allocated_rank() == 0);
+        feed(a2, l, r, BUF_SIZE);
+        UTEST_ASSERT(!a2.get_spectrum(0, s2, idx, POINTS));
+
+        // The buffers are sized for the current rank, not for the maximum one
+        UTEST_ASSERT(a2.prepare());
+        UTEST_ASSERT(a2.prepared());
+        UTEST_ASSERT(a2.get_allocated_rank() == RANK + 2);
+
+        feed(a1, l, r, samples);
+        feed(a2, l, r, samples);
+        for (size_t i=0; i<2; ++i)
+        {
+            UTEST_ASSERT(a1.get_spectrum(i, s1, idx, POINTS));
+            UTEST_ASSERT(a2.get_spectrum(i, s2, idx, POINTS));
+            for (size_t j=0; j<POINTS; ++j)
+                UTEST_ASSERT_MSG(float_equals_relative(s1[j], s2[j], 1e-3f),
+                    "Channel %d, frequency %.1f: lazy %g, expected %g", int(i), frq[j], s2[j], s1[j]);
+        }
+
+        // Settings that exceed the buffers suspend the analysis until the next prepare()
+        a2.set_rank(RANK + 3);
+        UTEST_ASSERT(!a2.prepared());
+        UTEST_ASSERT(a2.prepare());
+        UTEST_ASSERT(a2.get_allocated_rank() == RANK + 3);
+        a2.set_rate(10.0f);
+        UTEST_ASSERT(!a2.prepared());
+        UTEST_ASSERT(a2.prepare());
+
+        // Smaller settings fit into the allocated buffers
+        a2.set_rank(RANK);
+        a2.set_rate(20.0f);
+        UTEST_ASSERT(a2.prepared());
+        UTEST_ASSERT(a2.get_allocated_rank() == RANK + 3);
+        feed(a2, l, r, samples);
+        a2.get_frequencies(frq, idx, 20.0f, 20000.0f, POINTS);
+        UTEST_ASSERT(a2.get_spectrum(0, s2, idx, POINTS));
+        for (size_t j=0; j<POINTS; ++j)
+            UTEST_ASSERT_MSG(s2[j] > 0.0f, "Empty spectrum at frequency %.1f", frq[j]);
+    }
+
+    UTEST_MAIN
+    {
+        test_spectrogram("8-bit", dspu::SPECTROGRAM_U8, 144.0f / 255.0f);
+        test_spectrogram("16-bit", dspu::SPECTROGRAM_U16, 144.0f / 65535.0f + 1e-3f);
+        test_amortized(true);
+        test_amortized(false);
+        test_ranges();
+        test_lazy();
+    }
+
+UTEST_END
@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/dsp-units/util/BinaryStateDumper.h>
+#include <lsp-plug.in/dsp-units/util/StateSnapshot.h>
+#include <lsp-plug.in/stdlib/string.h>
+
+namespace
+{
+    using namespace lsp;
+
+    // Unit with the state to dump
+    class Unit
+    {
+        public:
+            int32_t     nValue;
+            float       fValue;
+            float       vArray[5];
+            const char *sName;
+
+        public:
+            void dump(dspu::IStateDumper *v) const
+            {
+                v->write("nValue", nValue);
+                v->write("fValue", fValue);
+                v->writev("vArray", vArray, 5);
+                v->writev("vNull", static_cast<const float *>(NULL), 3);
+                v->write("sName", sName);
+                v->begin_array("vItems", vArray, 2);
+                {
+                    v->write(vArray[0]);
+                    v->write(vArray[1]);
+                }
+                v->end_array();
+            }
+    };
+
+    // Dumper that records the decoded state
+    class Recorder: public dspu::IStateDumper
+    {
+        public:
+            size_t      nObjects;
+            size_t      nArrays;
+            size_t      nFields;
+            int32_t     nValue;
+            float       fValue;
+            float       vArray[5];
+            bool        bNull;
+            char        sName[32];
+            float       vItems[2];
+            size_t      nItems;
+
+        public:
+            Recorder()
+            {
+                nObjects    = 0;
+                nArrays     = 0;
+                nFields     = 0;
+                nValue      = 0;
+                fValue      = 0.0f;
+                bNull       = false;
+                sName[0]    = '\0';
+                nItems      = 0;
+                for (size_t i=0; i<5; ++i)
+                    vArray[i]   = 0.0f;
+            }
+
+            virtual void begin_object(const void *ptr, size_t szof)     { ++nObjects;   }
+            virtual void begin_array(const char *name, const void *ptr, size_t count)
+            {
+                if (!strcmp(name, "vItems"))
+                    ++nArrays;
+            }
+
+            virtual void write(float value)
+            {
+                if (nItems < 2)
+                    vItems[nItems++]    = value;
+            }
+
+            virtual void write(const char *name, int32_t value)
+            {
+                if (!strcmp(name, "nValue"))
+                {
+                    nValue      = value;
+                    ++nFields;
+                }
+            }
+
+            virtual void write(const char *name, float value)
+            {
+                if (!strcmp(name, "fValue"))
+                {
+                    fValue      = value;
+                    ++nFields;
+                }
+            }
+
+            virtual void write(const char *name, const char *value)
+            {
+                if ((!strcmp(name, "sName")) && (value != NULL))
+                {
+                    strncpy(sName, value, sizeof(sName) - 1);
+                    sName[sizeof(sName) - 1] = '\0';
+                    ++nFields;
+                }
+            }
+
+            virtual void writev(const char *name, const float *value, size_t count)
+            {
+                if ((!strcmp(name, "vArray")) && (value != NULL) && (count == 5))
+                {
+                    for (size_t i=0; i<count; ++i)
+                        vArray[i]   = value[i];
+                    ++nFields;
+                }
+                else if ((!strcmp(name, "vNull")) && (value == NULL))
+                {
+                    bNull       = true;
+                    ++nFields;
+                }
+            }
+    };
+}
+
+UTEST_BEGIN("dspu.util", binary_state_dumper)
+
+    void init_unit(Unit *u, int32_t seed)
+    {
+        u->nValue   = seed;
+        u->fValue   = seed * 0.5f;
+        for (size_t i=0; i<5; ++i)
+            u->vArray[i]    = seed + i * 0.25f;
+        u->sName    = "test unit";
+    }
+
+    void check_state(const Recorder *r, const Unit *u)
+    {
+        UTEST_ASSERT(r->nObjects == 1);
+        UTEST_ASSERT(r->nArrays == 1);
+        UTEST_ASSERT(r->nFields == 5);
+        UTEST_ASSERT(r->nValue == u->nValue);
+        UTEST_ASSERT(r->fValue == u->fValue);
+        UTEST_ASSERT(r->bNull);
+        UTEST_ASSERT(!strcmp(r->sName, u->sName));
+        for (size_t i=0; i<5; ++i)
+            UTEST_ASSERT(r->vArray[i] == u->vArray[i]);
+        UTEST_ASSERT(r->nItems == 2);
+        UTEST_ASSERT((r->vItems[0] == u->vArray[0]) && (r->vItems[1] == u->vArray[1]));
+    }
+
+    void test_dumper()
+    {
+        printf("Testing binary state dumper\n");
+
+        Unit u;
+        init_unit(&u, 42);
+
+        dspu::BinaryStateDumper v;
+        UTEST_ASSERT(v.init(0x1000, 16));
+        v.write_object(&u);
+        UTEST_ASSERT(!v.overflow());
+        UTEST_ASSERT(v.names() == 6);
+
+        Recorder r;
+        UTEST_ASSERT(v.replay(&r) == STATUS_OK);
+        check_state(&r, &u);
+
+        // The schema is kept after clear, the buffer overflow truncates the state
+        size_t size = v.size();
+        v.clear();
+        v.write_object(&u);
+        UTEST_ASSERT(v.size() == size);
+        UTEST_ASSERT(v.names() == 6);
+
+        dspu::BinaryStateDumper small;
+        UTEST_ASSERT(small.init(64, 16));
+        small.write_object(&u);
+        UTEST_ASSERT(small.overflow());
+        UTEST_ASSERT(small.size() <= 64);
+        Recorder r2;
+        UTEST_ASSERT(small.replay(&r2) == STATUS_OK);
+    }
+
+    void test_snapshot()
+    {
+        printf("Testing state snapshot\n");
+
+        Unit u;
+        dspu::StateSnapshot s;
+        UTEST_ASSERT(s.init(0x1000, 16));
+        s.set_period(100);
+
+        UTEST_ASSERT(!s.fetch());
+
+        // The state is captured not often than once per period
+        init_unit(&u, 1);
+        UTEST_ASSERT(!s.capture(&u, 64));
+        UTEST_ASSERT(s.capture(&u, 64));
+        init_unit(&u, 2);
+        UTEST_ASSERT(!s.capture(&u, 64));
+        UTEST_ASSERT(s.capture(&u, 64));
+
+        // The worker gets the latest state
+        UTEST_ASSERT(s.fetch());
+        UTEST_ASSERT(!s.fetch());
+
+        Recorder r;
+        UTEST_ASSERT(s.replay(&r) == STATUS_OK);
+        check_state(&r, &u);
+    }
+
+    UTEST_MAIN
+    {
+        test_dumper();
+        test_snapshot();
+    }
+
+UTEST_END
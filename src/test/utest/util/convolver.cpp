@@ -23,6 +23,7 @@
 #include <lsp-plug.in/test-fw/FloatBuffer.h>
 #include <lsp-plug.in/dsp-units/util/Convolver.h>
 #include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
 
 #define LCONV_SIZE      0x10000
 #define CONV_SIZE       0x2000
@@ -222,11 +223,212 @@ UTEST_BEGIN("dspu.util", convolver)
         c.destroy();
     }
 
+    void test_background()
+    {
+        dspu::Convolver c;
+
+        FloatBuffer conv(CONV_SIZE);
+        FloatBuffer src(SRC_SIZE + conv.size());
+        FloatBuffer dst1(src.size());
+        FloatBuffer dst2(dst1);
+
+        printf("Testing background tail convolution...\n");
+
+        conv.randomize(-1.0f, 1.0f);
+        src.randomize(-1.0f, 1.0f);
+        dsp::fill_zero(src.data(SRC_SIZE), src.size() - SRC_SIZE);
+        dst1.fill_zero();
+        dst2.fill_zero();
+
+        UTEST_ASSERT(c.init(conv, conv.size(), 10, 0, true));
+        UTEST_ASSERT(c.background());
+        dsp::convolve(dst1, src, conv, conv.size(), SRC_SIZE);
+        convolve(c, dst2, src, src.size(), 61);
+
+        UTEST_ASSERT_MSG(src.valid(), "Source buffer corrupted");
+        UTEST_ASSERT_MSG(conv.valid(), "Convolution buffer corrupted");
+        UTEST_ASSERT_MSG(dst1.valid(), "Destination buffer 1 corrupted");
+        UTEST_ASSERT_MSG(dst2.valid(), "Destination buffer 2 corrupted");
+
+        if (!dst2.equals_absolute(dst1, 1e-3))
+        {
+            size_t index = dst2.last_diff();
+            UTEST_FAIL_MSG("Output of convolver is invalid, started at sample=%d: %.5f vs %.5f",
+                    int(index), dst1[index], dst2[index]);
+        }
+
+        c.destroy();
+        UTEST_ASSERT(!c.background());
+    }
+
+    void test_latency()
+    {
+        dspu::Convolver c;
+
+        FloatBuffer conv(CONV_SIZE);
+        FloatBuffer src(conv.size() * 2);
+        FloatBuffer dst(src.size());
+
+        printf("Testing latency of the convolution...\n");
+
+        conv.randomize(-1.0f, 1.0f);
+        src.fill_zero();
+        dst.fill_zero();
+        src[0]  = 1.0f;
+
+        // Impulse response should be reproduced from the first sample for small block sizes
+        UTEST_ASSERT(c.init(conv, conv.size(), 12, 0));
+        UTEST_ASSERT(c.latency() == 0);
+        convolve(c, dst, src, src.size(), 32);
+
+        UTEST_ASSERT_MSG(dst.valid(), "Destination buffer corrupted");
+        for (size_t i=0; i<conv.size(); ++i)
+        {
+            if (float_equals_absolute(dst[i], conv[i], 1e-4))
+                continue;
+            UTEST_FAIL_MSG("Output of convolver is invalid at sample=%d: %.5f vs %.5f",
+                    int(i), conv[i], dst[i]);
+        }
+
+        c.destroy();
+    }
+
+    void test_shared()
+    {
+        dspu::ConvolverCache cache;
+        dspu::Convolver c1, c2;
+
+        FloatBuffer conv(CONV_SIZE);
+        FloatBuffer src(SRC2_SIZE + conv.size());
+        FloatBuffer dst1(src.size());
+        FloatBuffer dst2(dst1);
+        FloatBuffer dst3(dst1);
+
+        printf("Testing shared spectrum of convolution...\n");
+
+        conv.randomize(-1.0f, 1.0f);
+        src.randomize(-1.0f, 1.0f);
+        dsp::fill_zero(src.data(SRC2_SIZE), src.size() - SRC2_SIZE);
+        dst1.fill_zero();
+        dst2.fill_zero();
+        dst3.fill_zero();
+
+        // Both convolvers should share the same spectrum
+        UTEST_ASSERT(c1.init(conv, conv.size(), 10, 0.0f, false, &cache));
+        UTEST_ASSERT(c2.init(conv, conv.size(), 10, 0.5f, false, &cache));
+        UTEST_ASSERT(cache.size() == 1);
+
+        dsp::convolve(dst1, src, conv, conv.size(), SRC2_SIZE);
+        convolve(c1, dst2, src, src.size(), 31);
+        convolve(c2, dst3, src, src.size(), 47);
+
+        UTEST_ASSERT_MSG(dst2.valid(), "Destination buffer 2 corrupted");
+        UTEST_ASSERT_MSG(dst3.valid(), "Destination buffer 3 corrupted");
+        if ((!dst2.equals_absolute(dst1, 1e-4)) || (!dst3.equals_absolute(dst1, 1e-4)))
+        {
+            size_t index = (dst2.equals_absolute(dst1, 1e-4)) ? dst3.last_diff() : dst2.last_diff();
+            UTEST_FAIL_MSG("Output of convolver is invalid, started at sample=%d: %.5f vs %.5f vs %.5f",
+                    int(index), dst1[index], dst2[index], dst3[index]);
+        }
+
+        // The spectrum should be released by the last convolver
+        c1.destroy();
+        UTEST_ASSERT(cache.size() == 1);
+        c2.destroy();
+        UTEST_ASSERT(cache.size() == 0);
+    }
+
+    void test_sparse(bool background)
+    {
+        dspu::Convolver c;
+
+        FloatBuffer conv(CONV_SIZE * 2);
+        FloatBuffer src(SRC_SIZE + conv.size());
+        FloatBuffer dst1(src.size());
+        FloatBuffer dst2(dst1);
+
+        printf("Testing convolution with silent partitions, background=%s...\n", (background) ? "true" : "false");
+
+        // Pre-delayed impulse response with the gap and silent end
+        conv.fill_zero();
+        for (size_t i=0x1000; i<0x1800; ++i)
+            conv[i] = float(rand()) / RAND_MAX - 0.5f;
+        for (size_t i=0x2a00; i<0x2a40; ++i)
+            conv[i] = float(rand()) / RAND_MAX - 0.5f;
+        src.randomize(-1.0f, 1.0f);
+        dsp::fill_zero(src.data(SRC_SIZE), src.size() - SRC_SIZE);
+        dst1.fill_zero();
+        dst2.fill_zero();
+
+        UTEST_ASSERT(c.init(conv, conv.size(), 10, 0, background));
+        dsp::convolve(dst1, src, conv, conv.size(), SRC_SIZE);
+        convolve(c, dst2, src, src.size(), 61);
+
+        UTEST_ASSERT_MSG(dst1.valid(), "Destination buffer 1 corrupted");
+        UTEST_ASSERT_MSG(dst2.valid(), "Destination buffer 2 corrupted");
+
+        if (!dst2.equals_absolute(dst1, 1e-3))
+        {
+            size_t index = dst2.last_diff();
+            UTEST_FAIL_MSG("Output of convolver is invalid, started at sample=%d: %.5f vs %.5f",
+                    int(index), dst1[index], dst2[index]);
+        }
+
+        c.destroy();
+    }
+
+    void test_precision(const char *label, dspu::convolver_precision_t precision, double snr_min)
+    {
+        dspu::Convolver c1, c2;
+
+        FloatBuffer conv(CONV_SIZE);
+        FloatBuffer src(SRC_SIZE + conv.size());
+        FloatBuffer dst1(src.size());
+        FloatBuffer dst2(dst1);
+
+        printf("Testing %s storage of the spectrum...\n", label);
+
+        conv.randomize(-1.0f, 1.0f);
+        src.randomize(-1.0f, 1.0f);
+        dsp::fill_zero(src.data(SRC_SIZE), src.size() - SRC_SIZE);
+        dst1.fill_zero();
+        dst2.fill_zero();
+
+        UTEST_ASSERT(c1.init(conv, conv.size(), 10, 0, false, NULL, dspu::CONVOLVER_FLOAT32));
+        UTEST_ASSERT(c2.init(conv, conv.size(), 10, 0, true, NULL, precision));
+        convolve(c1, dst1, src, src.size(), 61);
+        convolve(c2, dst2, src, src.size(), 61);
+
+        UTEST_ASSERT_MSG(dst1.valid(), "Destination buffer 1 corrupted");
+        UTEST_ASSERT_MSG(dst2.valid(), "Destination buffer 2 corrupted");
+
+        double sig = 0.0, err = 0.0;
+        for (size_t i=0; i<dst1.size(); ++i)
+        {
+            double d    = dst1[i] - dst2[i];
+            sig        += dst1[i] * dst1[i];
+            err        += d * d;
+        }
+        double snr  = 10.0 * log10(sig / lsp_max(err, 1e-30));
+        printf("  SNR = %.2f dB\n", snr);
+        UTEST_ASSERT_MSG(snr >= snr_min, "SNR of %s storage is too low: %.2f dB", label, snr);
+
+        c1.destroy();
+        c2.destroy();
+    }
+
     UTEST_MAIN
     {
 //        test_collisions();
         test_small();
         test_large();
+        test_background();
+        test_latency();
+        test_shared();
+        test_sparse(false);
+        test_sparse(true);
+        test_precision("float16", dspu::CONVOLVER_FLOAT16, 60.0);
+        test_precision("bfloat16", dspu::CONVOLVER_BFLOAT16, 40.0);
     }
 UTEST_END;
 
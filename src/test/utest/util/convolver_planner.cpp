@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/dsp-units/util/ConvolverPlanner.h>
+#include <lsp-plug.in/io/Path.h>
+
+UTEST_BEGIN("dspu.util", convolver_planner)
+
+    void test_model(const dspu::ConvolverPlanner &p)
+    {
+        // Longer impulse responses should never be cheaper
+        for (size_t rank=CONVOLVER_RANK_MIN; rank<=CONVOLVER_RANK_MAX; ++rank)
+        {
+            float c1 = p.estimate(0x1000, rank, 0x100);
+            float c2 = p.estimate(0x10000, rank, 0x100);
+            UTEST_ASSERT_MSG(c1 <= c2, "Cost decreases with length for rank %d: %f > %f", int(rank), c1, c2);
+            UTEST_ASSERT(p.estimate(0x10000, rank, 0x100, true) <= c2);
+        }
+
+        // The planned rank is within the range and is the cheapest one
+        static const size_t lengths[] = { 0x40, 0x1000, 0x10000, 0x80000 };
+        static const size_t blocks[] = { 0x40, 0x100, 0x1000 };
+        for (size_t i=0; i<sizeof(lengths)/sizeof(size_t); ++i)
+            for (size_t j=0; j<sizeof(blocks)/sizeof(size_t); ++j)
+            {
+                size_t rank = p.plan(lengths[i], blocks[j]);
+                printf("  length=%d, block=%d -> rank=%d\n", int(lengths[i]), int(blocks[j]), int(rank));
+                UTEST_ASSERT((rank >= CONVOLVER_RANK_MIN) && (rank <= CONVOLVER_RANK_MAX));
+
+                float best = p.estimate(lengths[i], rank, blocks[j]);
+                for (size_t k=CONVOLVER_RANK_MIN; k<=CONVOLVER_RANK_MAX; ++k)
+                    UTEST_ASSERT(best <= p.estimate(lengths[i], k, blocks[j]));
+            }
+
+        // Short impulse response does not need the large partitions
+        UTEST_ASSERT(p.plan(0x40, 0x100) == CONVOLVER_RANK_MIN);
+        // Long impulse response does not fit the minimum rank
+        UTEST_ASSERT(p.plan(0x80000, 0x100) > CONVOLVER_RANK_MIN);
+    }
+
+    UTEST_MAIN
+    {
+        dspu::ConvolverPlanner p, p2;
+
+        printf("Testing analytic model\n");
+        UTEST_ASSERT(!p.calibrated());
+        UTEST_ASSERT(p.save("/nonexistent") == STATUS_NO_DATA);
+        test_model(p);
+
+        printf("Testing calibration\n");
+        UTEST_ASSERT(p.calibrate(2) == STATUS_OK);
+        UTEST_ASSERT(p.calibrated());
+        test_model(p);
+
+        printf("Testing save and load\n");
+        io::Path path;
+        UTEST_ASSERT(path.fmt("%s/utest-%s.bin", tempdir(), full_name()) > 0);
+        printf("Saving profile to '%s'\n", path.as_utf8());
+        UTEST_ASSERT(p.save(&path) == STATUS_OK);
+        UTEST_ASSERT(p2.load(&path) == STATUS_OK);
+        UTEST_ASSERT(p2.calibrated());
+        for (size_t rank=CONVOLVER_RANK_MIN; rank<=CONVOLVER_RANK_MAX; ++rank)
+            UTEST_ASSERT(p.estimate(0x10000, rank, 0x100) == p2.estimate(0x10000, rank, 0x100));
+    }
+
+UTEST_END
@@ -23,10 +23,12 @@
 #include <lsp-plug.in/test-fw/helpers.h>
 #include <lsp-plug.in/dsp-units/ctl/Crossfade.h>
 #include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
 
 #define SRATE       64
 #define BUF_SIZE    (SRATE * 3)
 #define BUF_STEP    8
+#define CHANNELS    3
 
 UTEST_BEGIN("dspu.util", crossfade)
 
@@ -54,6 +56,54 @@ UTEST_BEGIN("dspu.util", crossfade)
         }
     }
 
+    void test_multichannel()
+    {
+        float dst[CHANNELS][BUF_SIZE], ref[BUF_SIZE], in[CHANNELS][BUF_SIZE], out[CHANNELS][BUF_SIZE];
+
+        dspu::Crossfade cf;
+        cf.init(SRATE * 2, 0.5);
+
+        // Each channel should match the single-channel processing
+        for (size_t j=0; j<CHANNELS; ++j)
+        {
+            dsp::fill(in[j], 0.25f * (j + 1), BUF_SIZE);
+            dsp::fill(out[j], 1.0f - 0.25f * j, BUF_SIZE);
+        }
+
+        cf.reset();
+        for (size_t i=0; i<BUF_SIZE; i += BUF_STEP)
+        {
+            if (i == SRATE)
+                UTEST_ASSERT(cf.toggle());
+
+            float *vd[CHANNELS];
+            const float *vi[CHANNELS], *vo[CHANNELS];
+            for (size_t j=0; j<CHANNELS; ++j)
+            {
+                vd[j]   = &dst[j][i];
+                vi[j]   = &in[j][i];
+                vo[j]   = &out[j][i];
+            }
+            vi[1]   = NULL;
+            cf.process(vd, vo, vi, CHANNELS, BUF_STEP);
+        }
+
+        for (size_t j=0; j<CHANNELS; ++j)
+        {
+            process(cf, ref, out[j], (j == 1) ? NULL : in[j]);
+            for (size_t i=0; i<BUF_SIZE; ++i)
+                UTEST_ASSERT_MSG(float_equals_absolute(dst[j][i], ref[i]),
+                    "Channel %d differs at sample %d: %f vs %f", int(j), int(i), dst[j][i], ref[i]);
+        }
+
+        // Equal-power curve keeps the sum of powers
+        cf.set_curve(dspu::XFADE_EQUAL_POWER);
+        process(cf, ref, out[0], in[0]);
+        UTEST_ASSERT(float_equals_absolute(ref[0], 1.0f));
+        UTEST_ASSERT(float_equals_absolute(ref[BUF_SIZE - 1], 0.25f));
+        UTEST_ASSERT(float_equals_absolute(ref[BUF_SIZE >> 1], 1.25f * M_SQRT1_2));
+    }
+
     UTEST_MAIN
     {
         float dst[BUF_SIZE], in[BUF_SIZE], out[BUF_SIZE];
@@ -88,6 +138,8 @@ UTEST_BEGIN("dspu.util", crossfade)
         UTEST_ASSERT(float_equals_absolute(dst[0], 0.0f));
         UTEST_ASSERT(float_equals_absolute(dst[BUF_SIZE - 1], 0.0f));
         UTEST_ASSERT(float_equals_absolute(dst[BUF_SIZE >> 1], 0.0f));
+
+        test_multichannel();
     }
 
 UTEST_END
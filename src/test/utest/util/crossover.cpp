@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/util/Crossover.h>
+#include <lsp-plug.in/dsp-units/util/ScratchArena.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+using namespace lsp;
+
+#define SRATE           48000
+#define BUF_SIZE        256
+#define SAMPLES         1000
+#define BANDS           4
+
+UTEST_BEGIN("dspu.util", crossover)
+
+    static void handler(void *object, void *subject, size_t band, const float *data, size_t first, size_t count)
+    {
+        float **dst     = reinterpret_cast<float **>(object);
+        dsp::copy(&dst[band][first], data, count);
+    }
+
+    static void configure(dspu::Crossover *xc)
+    {
+        xc->set_sample_rate(SRATE);
+
+        xc->set_frequency(0, 200.0f);
+        xc->set_slope(0, 2);
+        xc->set_frequency(1, 1000.0f);
+        xc->set_slope(1, 3);
+        xc->set_frequency(2, 5000.0f);
+        xc->set_slope(2, 2);
+
+        xc->set_gain(1, 0.5f);
+        xc->set_gain(3, 2.0f);
+    }
+
+    static void counter(void *object, void *subject, size_t band, float *data, size_t first, size_t count)
+    {
+        size_t *n       = reinterpret_cast<size_t *>(object);
+        n[band]        += count;
+    }
+
+    void test_multirate(const float *src, float * const *ref)
+    {
+        static const size_t blocks[] = { 17, 100, 300, 1, 64, 255 };
+
+        printf("Testing multirate crossover\n");
+
+        dspu::Crossover xc;
+        FloatBuffer *dst[BANDS];
+        float *vdst[BANDS];
+        size_t processed[BANDS];
+
+        UTEST_ASSERT(xc.init(BANDS, BUF_SIZE, NULL, true));
+        UTEST_ASSERT(xc.multirate_supported());
+        configure(&xc);
+        xc.set_multirate(true);
+        for (size_t j=0; j<BANDS; ++j)
+        {
+            dst[j]          = new FloatBuffer(SAMPLES);
+            processed[j]    = 0;
+            if (j < BANDS - 1)
+                xc.set_processor(j, counter, processed, NULL);
+        }
+
+        // Bands below 200 Hz and 1000 Hz are decimated, all bands are delayed to the same latency
+        UTEST_ASSERT(xc.band_decimation(0) == 8);
+        UTEST_ASSERT(xc.band_decimation(1) == 4);
+        UTEST_ASSERT(xc.band_decimation(2) == 1);
+        UTEST_ASSERT(xc.band_decimation(3) == 1);
+        size_t latency  = xc.latency();
+        UTEST_ASSERT(latency == XOVER_DECIM_LATENCY_MAX);
+
+        // Process the input in blocks of odd size
+        for (size_t offset=0, i=0; offset < SAMPLES; ++i)
+        {
+            size_t to_do    = lsp_min(size_t(SAMPLES) - offset, blocks[i % (sizeof(blocks)/sizeof(size_t))]);
+            for (size_t j=0; j<BANDS; ++j)
+                vdst[j]         = &dst[j]->data()[offset];
+            xc.process(vdst, &src[offset], to_do);
+            offset         += to_do;
+        }
+
+        // Processors are called at the rate of the band
+        UTEST_ASSERT(processed[0] == SAMPLES / 8);
+        UTEST_ASSERT(processed[1] == SAMPLES / 4);
+        UTEST_ASSERT(processed[2] == SAMPLES);
+        UTEST_ASSERT(processed[3] == 0);
+
+        // The bands should match the full rate bands delayed by the latency
+        for (size_t j=0; j<BANDS; ++j)
+        {
+            UTEST_ASSERT(dst[j]->valid());
+            float tol       = (xc.band_decimation(j) > 1) ? 5e-3f : 1e-5f;
+            const float *v  = dst[j]->data();
+            for (size_t i=latency; i<SAMPLES; ++i)
+            {
+                if (!float_equals_absolute(v[i], ref[j][i - latency], tol))
+                {
+                    dst[j]->dump("dst");
+                    UTEST_FAIL_MSG("Band %d differs at sample %d: %f vs %f", int(j), int(i), v[i], ref[j][i - latency]);
+                }
+            }
+        }
+
+        for (size_t j=0; j<BANDS; ++j)
+            delete dst[j];
+        xc.destroy();
+    }
+
+    UTEST_MAIN
+    {
+        dspu::Crossover xc1, xc2, xc3;
+        dspu::ScratchArena arena;
+        FloatBuffer src(SAMPLES);
+        FloatBuffer *dst1[BANDS];
+        FloatBuffer *dst2[BANDS];
+        FloatBuffer *dst3[BANDS];
+        float *vdst1[BANDS];
+        float *vdst2[BANDS];
+        float *vdst3[BANDS];
+
+        UTEST_ASSERT(xc1.init(BANDS, BUF_SIZE));
+        UTEST_ASSERT(xc2.init(BANDS, BUF_SIZE));
+        UTEST_ASSERT(xc3.init(BANDS, BUF_SIZE, &arena));
+        UTEST_ASSERT(xc1.latency() == 0);
+        UTEST_ASSERT(arena.capacity() >= BUF_SIZE * 2);
+        configure(&xc1);
+        configure(&xc2);
+        configure(&xc3);
+
+        src.randomize(-1.0f, 1.0f);
+        for (size_t j=0; j<BANDS; ++j)
+        {
+            dst1[j]         = new FloatBuffer(SAMPLES);
+            dst2[j]         = new FloatBuffer(SAMPLES);
+            vdst1[j]        = dst1[j]->data();
+            dst3[j]         = new FloatBuffer(SAMPLES);
+            vdst2[j]        = dst2[j]->data();
+            vdst3[j]        = dst3[j]->data();
+            xc1.set_handler(j, handler, vdst1, NULL);
+            xc3.set_handler(j, handler, vdst3, NULL);
+        }
+
+        // Process data that does not fit into one buffer, with callbacks and directly to buffers
+        xc1.process(src.data(), SAMPLES);
+        xc2.process(vdst2, src.data(), SAMPLES);
+
+        // The crossover with shared temporary buffers returns them after processing
+        xc3.process(src.data(), SAMPLES);
+        UTEST_ASSERT(arena.used() == 0);
+        UTEST_ASSERT(arena.peak() >= BUF_SIZE * 2);
+
+        // Compare results
+        for (size_t j=0; j<BANDS; ++j)
+        {
+            UTEST_ASSERT(dst1[j]->valid());
+            UTEST_ASSERT(dst2[j]->valid());
+            UTEST_ASSERT(dst3[j]->valid());
+            if (!dst1[j]->equals_absolute(*dst2[j], 1e-5f))
+            {
+                dst1[j]->dump("dst1");
+                dst2[j]->dump("dst2");
+                UTEST_FAIL_MSG("Band %d differs", int(j));
+            }
+            if (!dst1[j]->equals_absolute(*dst3[j], 1e-5f))
+            {
+                dst1[j]->dump("dst1");
+                dst3[j]->dump("dst3");
+                UTEST_FAIL_MSG("Band %d processed with arena differs", int(j));
+            }
+        }
+
+        // Frequency charts do not use the arena
+        FloatBuffer f(SAMPLES), c1(SAMPLES * 2), c3(SAMPLES * 2);
+        for (size_t i=0; i<SAMPLES; ++i)
+            f[i]            = 10.0f + i * 20.0f;
+        UTEST_ASSERT(xc1.freq_chart(1, c1, f, SAMPLES));
+        UTEST_ASSERT(xc3.freq_chart(1, c3, f, SAMPLES));
+        UTEST_ASSERT(c1.valid());
+        UTEST_ASSERT(c3.valid());
+        UTEST_ASSERT_MSG(c1.equals_absolute(c3, 1e-5f), "Frequency charts differ");
+
+        test_multirate(src.data(), vdst2);
+
+        for (size_t j=0; j<BANDS; ++j)
+        {
+            delete dst1[j];
+            delete dst2[j];
+            delete dst3[j];
+        }
+        xc1.destroy();
+        xc2.destroy();
+        xc3.destroy();
+        arena.destroy();
+    }
+
+UTEST_END
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/util/Delay.h>
+#include <lsp-plug.in/dsp-units/util/DelayBank.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#define MAX_DELAY   1500
+#define CHANNELS    5
+#define SAMPLES     8000
+#define BLOCK       1234
+
+UTEST_BEGIN("dspu.util", delay_bank)
+
+    static const size_t delays[CHANNELS] = { 0, 1, 17, 900, MAX_DELAY };
+
+    void test_channels()
+    {
+        printf("Testing constant delays\n");
+
+        dspu::Delay d[CHANNELS];
+        dspu::DelayBank db;
+        FloatBuffer *src[CHANNELS], *out1[CHANNELS], *out2[CHANNELS];
+        float *vout[CHANNELS];
+        const float *vin[CHANNELS];
+
+        UTEST_ASSERT(db.init(CHANNELS, MAX_DELAY));
+        UTEST_ASSERT(db.channels() == CHANNELS);
+        UTEST_ASSERT(db.max_delay() == MAX_DELAY);
+        for (size_t i=0; i<CHANNELS; ++i)
+        {
+            UTEST_ASSERT(d[i].init(MAX_DELAY));
+            d[i].set_delay(delays[i]);
+            db.set_delay(i, delays[i], false);
+            UTEST_ASSERT(db.get_delay(i) == delays[i]);
+            src[i]      = new FloatBuffer(SAMPLES);
+            out1[i]     = new FloatBuffer(SAMPLES);
+            out2[i]     = new FloatBuffer(SAMPLES);
+            src[i]->randomize(-1.0f, 1.0f);
+        }
+
+        // Compute the reference with separate delays
+        for (size_t i=0; i<CHANNELS; ++i)
+            d[i].process(out1[i]->data(), src[i]->data(), SAMPLES);
+
+        // Process in place by blocks, the source of the last channel is silence
+        for (size_t i=0; i<CHANNELS; ++i)
+            dsp::copy(out2[i]->data(), src[i]->data(), SAMPLES);
+        for (size_t offset=0; offset < SAMPLES; offset += BLOCK)
+        {
+            size_t to_do    = lsp_min(SAMPLES - offset, size_t(BLOCK));
+            for (size_t i=0; i<CHANNELS; ++i)
+            {
+                vout[i]         = out2[i]->data() + offset;
+                vin[i]          = vout[i];
+            }
+            vin[CHANNELS-1] = NULL;
+            db.process(vout, vin, to_do);
+        }
+
+        out1[CHANNELS-1]->fill_zero();
+        for (size_t i=0; i<CHANNELS; ++i)
+        {
+            UTEST_ASSERT(out2[i]->valid());
+            if (!out1[i]->equals_absolute(*out2[i], 1e-6f))
+                UTEST_FAIL_MSG("Output of channel %d differs", int(i));
+        }
+
+        for (size_t i=0; i<CHANNELS; ++i)
+        {
+            delete src[i];
+            delete out1[i];
+            delete out2[i];
+        }
+    }
+
+    void test_ramping()
+    {
+        printf("Testing delay ramping\n");
+
+        dspu::DelayBank db;
+        FloatBuffer src(SAMPLES), dst(SAMPLES);
+        float *vout[1]          = { dst.data() };
+        const float *vin[1]     = { src.data() };
+
+        UTEST_ASSERT(db.init(1, MAX_DELAY));
+        for (size_t i=0; i<SAMPLES; ++i)
+            src[i]      = i;
+
+        // Ramp the delay from 0 to MAX_DELAY over the call
+        db.set_delay(0, MAX_DELAY);
+        UTEST_ASSERT(db.get_delay(0) == MAX_DELAY);
+        db.process(vout, vin, SAMPLES);
+        UTEST_ASSERT(dst.valid());
+
+        float dd    = float(MAX_DELAY) / float(SAMPLES);
+        for (size_t i=0; i<SAMPLES; ++i)
+        {
+            ssize_t delay   = ssize_t(dd * i);
+            float v         = (ssize_t(i) >= delay) ? float(ssize_t(i) - delay) : 0.0f;
+            UTEST_ASSERT_MSG(float_equals_absolute(dst[i], v, 1e-3f),
+                "Ramped delay differs at %d: %f vs %f", int(i), dst[i], v);
+        }
+
+        // The delay is constant after the ramp
+        for (size_t i=0; i<SAMPLES; ++i)
+            src[i]      = SAMPLES + i;
+        db.process(vout, vin, SAMPLES);
+        for (size_t i=0; i<SAMPLES; ++i)
+        {
+            float v         = float(SAMPLES + i - MAX_DELAY);
+            UTEST_ASSERT_MSG(float_equals_absolute(dst[i], v, 1e-3f),
+                "Delayed sample differs at %d: %f vs %f", int(i), dst[i], v);
+        }
+    }
+
+    UTEST_MAIN
+    {
+        test_channels();
+        test_ramping();
+    }
+
+UTEST_END
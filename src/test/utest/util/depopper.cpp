@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/util/Depopper.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define SRATE       48000
+#define SAMPLES     0x8000
+#define PERIOD      0x2000
+
+UTEST_BEGIN("dspu.util", depopper)
+
+    void setup(dspu::Depopper &dp, dspu::depopper_mode_t mode)
+    {
+        UTEST_ASSERT(dp.init(SRATE, 20.0f, 10.0f));
+        dp.set_fade_in_mode(mode);
+        dp.set_fade_out_mode(mode);
+        dp.set_fade_in_time(5.0f);
+        dp.set_fade_out_time(2.0f);
+        dp.set_fade_in_threshold(0.01f);
+        dp.set_fade_out_threshold(0.005f);
+        dp.set_fade_in_delay(1.0f);
+        dp.set_fade_out_delay(1.0f);
+        dp.set_rms_length(1.0f);
+    }
+
+    void test_blocks(FloatBuffer &src, dspu::depopper_mode_t mode)
+    {
+        static const size_t blocks[] = { 1, 7, 300, 13, 1000, 256, 3, 4096 };
+
+        printf("Testing block processing in mode %d\n", int(mode));
+
+        dspu::Depopper dp1, dp2;
+        setup(dp1, mode);
+        setup(dp2, mode);
+
+        // Sample-by-sample processing is the reference for the block processing
+        FloatBuffer env1(SAMPLES), gain1(SAMPLES);
+        FloatBuffer env2(SAMPLES), gain2(SAMPLES);
+        for (size_t i=0; i<SAMPLES; ++i)
+            dp1.process(&env1[i], &gain1[i], &src[i], 1);
+        for (size_t offset=0, i=0; offset < SAMPLES; ++i)
+        {
+            size_t to_do    = lsp_min(size_t(SAMPLES) - offset, blocks[i % (sizeof(blocks)/sizeof(size_t))]);
+            dp2.process(&env2[offset], &gain2[offset], &src[offset], to_do);
+            offset         += to_do;
+        }
+
+        UTEST_ASSERT(env1.valid() && env2.valid());
+        UTEST_ASSERT(gain1.valid() && gain2.valid());
+        if (!env1.equals_absolute(env2, 1e-5f))
+        {
+            env1.dump("env1");
+            env2.dump("env2");
+            UTEST_FAIL_MSG("Envelope differs");
+        }
+        if (!gain1.equals_absolute(gain2, 1e-5f))
+        {
+            gain1.dump("gain1");
+            gain2.dump("gain2");
+            UTEST_FAIL_MSG("Gain differs");
+        }
+
+        // The gain should open on the bursts and close on the silence
+        UTEST_ASSERT(dsp::max(gain2, SAMPLES) >= 1.0f);
+        UTEST_ASSERT(dsp::min(gain2, SAMPLES) <= 0.0f);
+        UTEST_ASSERT(gain2[SAMPLES - 1] == 0.0f);
+
+        dp1.destroy();
+        dp2.destroy();
+    }
+
+    UTEST_MAIN
+    {
+        // Sine bursts separated by silence
+        FloatBuffer src(SAMPLES);
+        for (size_t i=0; i<SAMPLES; ++i)
+            src[i]      = ((i % PERIOD) < PERIOD/2) ? 0.5f * sinf(0.05f * i) : 0.0f;
+
+        test_blocks(src, dspu::DPM_LINEAR);
+        test_blocks(src, dspu::DPM_CUBIC);
+        test_blocks(src, dspu::DPM_SINE);
+        test_blocks(src, dspu::DPM_GAUSSIAN);
+        test_blocks(src, dspu::DPM_PARABOLIC);
+    }
+
+UTEST_END
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/util/Dither.h>
+#include <lsp-plug.in/dsp-units/util/MultiDither.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define SEED        0x1d17
+#define CHANNELS    11
+#define SAMPLES     0x1003
+#define BITS        12
+
+UTEST_BEGIN("dspu.util", dither)
+
+    void make_signal(float *dst, size_t count, size_t channel)
+    {
+        for (size_t i=0; i<count; ++i)
+            dst[i]      = 0.25f * sinf(i * (0.01f + channel * 0.003f));
+    }
+
+    void test_shape(dspu::dither_shape_t shape)
+    {
+        printf("Testing multi-channel dither with shape %d\n", int(shape));
+
+        FloatBuffer *in[CHANNELS], *out[CHANNELS];
+        float *vin[CHANNELS], *vout[CHANNELS];
+        for (size_t i=0; i<CHANNELS; ++i)
+        {
+            in[i]       = new FloatBuffer(SAMPLES);
+            out[i]      = new FloatBuffer(SAMPLES);
+            make_signal(*in[i], SAMPLES, i);
+            vin[i]      = *in[i];
+            vout[i]     = *out[i];
+        }
+
+        dspu::MultiDither md;
+        UTEST_ASSERT(md.init(CHANNELS, SEED));
+        md.set_bits(BITS);
+        md.set_shape(shape);
+        UTEST_ASSERT(md.shape() == shape);
+
+        // Process by blocks of odd size
+        for (size_t offset=0; offset < SAMPLES; )
+        {
+            size_t to_do    = lsp_min(size_t(SAMPLES) - offset, size_t(0x97));
+            float *po[CHANNELS];
+            const float *pi[CHANNELS];
+            for (size_t i=0; i<CHANNELS; ++i)
+            {
+                po[i]           = &vout[i][offset];
+                pi[i]           = &vin[i][offset];
+            }
+            md.process(po, pi, to_do);
+            offset         += to_do;
+        }
+
+        // Each channel should match the single-channel dither with the same stream
+        const float lsb = 1.0f / float(1 << (BITS - 1));
+        const float gain= 1.0f - lsb;
+        FloatBuffer ref(SAMPLES);
+        for (size_t i=0; i<CHANNELS; ++i)
+        {
+            UTEST_ASSERT(out[i]->valid());
+
+            dspu::Dither d;
+            d.init(SEED, i);
+            d.set_bits(BITS);
+            d.set_shape(shape);
+            d.process(ref, *in[i], SAMPLES);
+
+            size_t errors = 0;
+            for (size_t j=0; j<SAMPLES; ++j)
+            {
+                if (!float_equals_absolute(ref[j], vout[i][j], 1e-6f))
+                    ++errors;
+                if (shape != dspu::DITHER_FLAT)
+                {
+                    // The output is quantized
+                    float q = vout[i][j] / lsb;
+                    UTEST_ASSERT_MSG(fabsf(q - roundf(q)) < 1e-3f, "Sample %d of channel %d is not quantized", int(j), int(i));
+                }
+            }
+            // The rounding of rare samples can differ because of vectorization
+            UTEST_ASSERT_MSG(errors < SAMPLES / 100, "Channel %d differs from the single-channel dither in %d samples", int(i), int(errors));
+        }
+
+        // The noise of the first order shaping is high-pass: the lag-1 autocorrelation of the error is about -0.5
+        if (shape == dspu::DITHER_FIRST_ORDER)
+        {
+            double r0 = 0.0, r1 = 0.0, prev = 0.0;
+            for (size_t j=0; j<SAMPLES; ++j)
+            {
+                double e    = vout[0][j] - vin[0][j] * gain;
+                r0         += e * e;
+                r1         += e * prev;
+                prev        = e;
+            }
+            printf("  lag-1 autocorrelation: %f\n", r1 / r0);
+            UTEST_ASSERT(r1 / r0 < -0.3);
+        }
+
+        // The noise of different channels should be uncorrelated
+        double c01 = 0.0, c00 = 0.0, c11 = 0.0;
+        for (size_t j=0; j<SAMPLES; ++j)
+        {
+            double a    = vout[0][j] - vin[0][j] * gain;
+            double b    = vout[1][j] - vin[1][j] * gain;
+            c00        += a * a;
+            c11        += b * b;
+            c01        += a * b;
+        }
+        UTEST_ASSERT(fabs(c01) < 0.1 * sqrt(c00 * c11));
+
+        for (size_t i=0; i<CHANNELS; ++i)
+        {
+            delete in[i];
+            delete out[i];
+        }
+    }
+
+    UTEST_MAIN
+    {
+        for (size_t i=0; i<dspu::DITHER_SHAPE_TOTAL; ++i)
+            test_shape(dspu::dither_shape_t(i));
+    }
+
+UTEST_END
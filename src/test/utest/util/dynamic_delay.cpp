@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/util/DynamicDelay.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define MAX_DELAY   100
+#define SAMPLES     5000    /* Several times more than the capacity of the buffer */
+
+UTEST_BEGIN("dspu.util", dynamic_delay)
+
+    void test_impulse()
+    {
+        dspu::DynamicDelay dd;
+        FloatBuffer in(SAMPLES), out(SAMPLES), delay(SAMPLES), fgain(SAMPLES), fdelay(SAMPLES);
+        UTEST_ASSERT(dd.init(MAX_DELAY) == STATUS_OK);
+
+        dsp::fill(delay, 10.25f, SAMPLES);
+        dsp::fill_zero(fgain, SAMPLES);
+        dsp::fill_zero(fdelay, SAMPLES);
+        dsp::fill_zero(in, SAMPLES);
+        in[SAMPLES - 100] = 1.0f;      // Put the impulse after several loops of the ring buffer
+
+        // Truncated delay
+        dd.process(out, in, delay, fgain, fdelay, SAMPLES);
+        UTEST_ASSERT(float_equals_absolute(out[SAMPLES - 90], 1.0f));
+        UTEST_ASSERT(float_equals_absolute(out[SAMPLES - 89], 0.0f));
+
+        // Linear interpolation
+        dd.clear();
+        dd.set_interpolation(dspu::DDI_LINEAR);
+        UTEST_ASSERT(dd.get_interpolation() == dspu::DDI_LINEAR);
+        dd.process(out, in, delay, fgain, fdelay, SAMPLES);
+        UTEST_ASSERT(out.valid());
+        UTEST_ASSERT_MSG(float_equals_absolute(out[SAMPLES - 90], 0.75f), "out = %f", out[SAMPLES - 90]);
+        UTEST_ASSERT_MSG(float_equals_absolute(out[SAMPLES - 89], 0.25f), "out = %f", out[SAMPLES - 89]);
+        UTEST_ASSERT(float_equals_absolute(out[SAMPLES - 88], 0.0f));
+
+        // Hermite interpolation should preserve DC gain of the impulse
+        dd.clear();
+        dd.set_interpolation(dspu::DDI_HERMITE);
+        dd.process(out, in, delay, fgain, fdelay, SAMPLES);
+        float sum = 0.0f;
+        for (size_t i=SAMPLES - 100; i<SAMPLES; ++i)
+            sum    += out[i];
+        UTEST_ASSERT_MSG(float_equals_absolute(sum, 1.0f), "sum = %f", sum);
+    }
+
+    void test_sine(dspu::dynamic_delay_interp_t mode, float tolerance, const char *name)
+    {
+        dspu::DynamicDelay dd;
+        FloatBuffer in(SAMPLES), out(SAMPLES), delay(SAMPLES), fgain(SAMPLES), fdelay(SAMPLES);
+        UTEST_ASSERT(dd.init(MAX_DELAY) == STATUS_OK);
+        dd.set_interpolation(mode);
+
+        // Slowly modulated delay of a low-frequency sine
+        const float w = 2.0f * M_PI / 200.0f;
+        for (size_t i=0; i<SAMPLES; ++i)
+        {
+            in[i]       = sinf(w * i);
+            delay[i]    = 40.0f + 20.0f * sinf(2.0f * M_PI * i / SAMPLES);
+        }
+        dsp::fill_zero(fgain, SAMPLES);
+        dsp::fill_zero(fdelay, SAMPLES);
+
+        dd.process(out, in, delay, fgain, fdelay, SAMPLES);
+        UTEST_ASSERT(out.valid());
+
+        for (size_t i=MAX_DELAY; i<SAMPLES; ++i)
+        {
+            float v     = sinf(w * (float(i) - delay[i]));
+            UTEST_ASSERT_MSG(float_equals_absolute(out[i], v, tolerance),
+                "%s: sample %d differs: %f vs %f", name, int(i), out[i], v);
+        }
+    }
+
+    void test_constant(dspu::dynamic_delay_interp_t mode, float delay, float fgain, float fdelay)
+    {
+        static const size_t blocks[] = { 1, 7, 300, 13, 1000, 256, 3 };
+
+        printf("Testing constant parameters: interp=%d, delay=%.2f, fgain=%.2f, fdelay=%.2f\n",
+            int(mode), delay, fgain, fdelay);
+
+        dspu::DynamicDelay d1, d2;
+        FloatBuffer in(SAMPLES), out1(SAMPLES), out2(SAMPLES), out3(SAMPLES);
+        FloatBuffer vdelay(SAMPLES), vfgain(SAMPLES), vfdelay(SAMPLES);
+        UTEST_ASSERT(d1.init(MAX_DELAY) == STATUS_OK);
+        UTEST_ASSERT(d2.init(MAX_DELAY, 2) == STATUS_OK);
+        UTEST_ASSERT(d2.channels() == 2);
+        d1.clear();
+        d2.clear();
+        d1.set_interpolation(mode);
+        d2.set_interpolation(mode);
+
+        in.randomize_sign();
+        dsp::fill(vdelay, delay, SAMPLES);
+        dsp::fill(vfgain, fgain, SAMPLES);
+        dsp::fill(vfdelay, fdelay, SAMPLES);
+
+        // Reference with the per-sample parameters
+        d1.process(out1, in, vdelay, vfgain, vfdelay, SAMPLES);
+
+        // Both channels with the constant parameters by blocks of odd sizes
+        for (size_t offset=0, i=0; offset < SAMPLES; ++i)
+        {
+            size_t to_do        = lsp_min(size_t(SAMPLES) - offset, blocks[i % (sizeof(blocks)/sizeof(size_t))]);
+            float *vout[2]      = { &out2[offset], &out3[offset] };
+            const float *vin[2] = { &in[offset], &in[offset] };
+            d2.process(vout, vin, delay, fgain, fdelay, to_do);
+            offset             += to_do;
+        }
+
+        UTEST_ASSERT(out1.valid());
+        UTEST_ASSERT(out2.valid());
+        UTEST_ASSERT(out3.valid());
+        if (!out1.equals_absolute(out2, 1e-4f))
+        {
+            out1.dump("out1");
+            out2.dump("out2");
+            UTEST_FAIL_MSG("Constant parameter output differs");
+        }
+        UTEST_ASSERT_MSG(out2.equals_absolute(out3, 1e-6f), "Channels differ");
+    }
+
+    UTEST_MAIN
+    {
+        test_impulse();
+        test_sine(dspu::DDI_LINEAR, 1e-3f, "linear");
+        test_sine(dspu::DDI_HERMITE, 1e-4f, "hermite");
+        test_sine(dspu::DDI_ALLPASS, 1e-3f, "allpass");
+
+        test_constant(dspu::DDI_NONE, 0.0f, 0.0f, 0.0f);
+        test_constant(dspu::DDI_NONE, 17.0f, 0.0f, 0.0f);
+        test_constant(dspu::DDI_NONE, 17.0f, 0.5f, 0.0f);
+        test_constant(dspu::DDI_NONE, 17.0f, -0.7f, 1.0f);
+        test_constant(dspu::DDI_NONE, MAX_DELAY, 0.5f, 5.0f);
+        test_constant(dspu::DDI_NONE, 3.0f, 0.5f, 3.0f);
+        test_constant(dspu::DDI_LINEAR, 37.5f, 0.5f, 5.0f);
+        test_constant(dspu::DDI_ALLPASS, 37.5f, 0.5f, 5.0f);
+    }
+
+UTEST_END
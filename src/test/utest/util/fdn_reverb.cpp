@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/util/FDNReverb.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define SRATE           48000
+#define MAX_DELAY       SRATE
+#define SAMPLES         (SRATE * 2)
+#define WINDOW          (SRATE / 10)
+
+UTEST_BEGIN("dspu.util", fdn_reverb)
+
+    void setup(dspu::FDNReverb &r, size_t lines, float depth, float diffusion, dspu::fdn_matrix_t matrix)
+    {
+        UTEST_ASSERT(r.init(lines, MAX_DELAY) == STATUS_OK);
+        r.set_sample_rate(SRATE);
+        r.set_size(60.0f);
+        r.set_decay(1.0f);
+        r.set_damping(1.0f);
+        r.set_modulation(depth, 1.3f);
+        r.set_diffusion(diffusion);
+        r.set_matrix(matrix);
+        r.set_interpolation(dspu::DDI_LINEAR);
+        r.update_settings();
+    }
+
+    double energy(const float *l, const float *r, size_t offset)
+    {
+        double e = 0.0;
+        for (size_t i=offset; i<offset + WINDOW; ++i)
+            e      += l[i]*l[i] + r[i]*r[i];
+        return e;
+    }
+
+    void test_reverb(const char *label, size_t lines, float depth, float diffusion, dspu::fdn_matrix_t matrix)
+    {
+        printf("Testing %s FDN reverb with %d lines\n", label, int(lines));
+
+        dspu::FDNReverb r1, r2;
+        setup(r1, lines, depth, diffusion, matrix);
+        setup(r2, lines, depth, diffusion, matrix);
+        UTEST_ASSERT(r1.lines() == lines);
+
+        // Lines have distinct prime lengths, the absorption matches the decay time
+        for (size_t i=0; i<lines; ++i)
+        {
+            size_t d    = size_t(r1.line_delay(i));
+            UTEST_ASSERT(d < MAX_DELAY);
+            for (size_t k=2; k*k <= d; ++k)
+                UTEST_ASSERT_MSG(d % k, "Delay %d of line %d is not prime", int(d), int(i));
+            for (size_t j=0; j<i; ++j)
+                UTEST_ASSERT(size_t(r1.line_delay(j)) != d);
+
+            float gain  = powf(10.0f, -3.0f * d / SRATE);
+            UTEST_ASSERT_MSG(float_equals_relative(r1.line_gain(i), gain, 1e-4f),
+                "Gain of line %d: %f, expected %f", int(i), r1.line_gain(i), gain);
+        }
+
+        FloatBuffer in(SAMPLES), l1(SAMPLES), rr1(SAMPLES), l2(SAMPLES), rr2(SAMPLES);
+        in.fill_zero();
+        in[0]   = 1.0f;
+
+        // Processing by blocks and by single samples gives the same result
+        r1.process(l1, rr1, in, SAMPLES);
+        for (size_t i=0; i<SAMPLES; ++i)
+            r2.process(&l2[i], &rr2[i], &in[i], 1);
+
+        UTEST_ASSERT(l1.valid() && rr1.valid() && l2.valid() && rr2.valid());
+        float tol = (depth > 0.0f) ? 1e-4f : 1e-6f;
+        if ((!l1.equals_absolute(l2, tol)) || (!rr1.equals_absolute(rr2, tol)))
+        {
+            l1.dump("l1");
+            l2.dump("l2");
+            UTEST_FAIL_MSG("Block and sample processing of %s reverb differ", label);
+        }
+
+        // The energy decays by 60 dB per second, the interpolation of modulated
+        // reads adds the loss at high frequencies
+        double e1   = energy(l1, rr1, SRATE / 5);
+        double e2   = energy(l1, rr1, SRATE / 5 + SRATE / 2);
+        double rate = 20.0 * log10(e2 / e1);
+        double dev  = (depth > 0.0f) ? 8.0 : 2.0;
+        printf("  decay rate: %.2f dB/s\n", rate);
+        UTEST_ASSERT_MSG((rate < -60.0 + dev) && (rate > -60.0 - dev), "Decay rate of %s reverb: %f dB/s", label, rate);
+
+        // Silence after clear
+        r1.clear();
+        r1.process(l1, rr1, NULL, WINDOW);
+        for (size_t i=0; i<WINDOW; ++i)
+            UTEST_ASSERT((l1[i] == 0.0f) && (rr1[i] == 0.0f));
+    }
+
+    UTEST_MAIN
+    {
+        test_reverb("hadamard", 8, 0.0f, 0.0f, dspu::FDN_HADAMARD);
+        test_reverb("householder", 16, 0.0f, 0.0f, dspu::FDN_HOUSEHOLDER);
+        test_reverb("diffused", 16, 0.0f, 30.0f, dspu::FDN_HADAMARD);
+        test_reverb("modulated", 8, 1.5f, 20.0f, dspu::FDN_HOUSEHOLDER);
+    }
+
+UTEST_END
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/util/FFTCrossover.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+using namespace lsp;
+
+#define SRATE           48000
+#define RANK            10
+#define SAMPLES         4096
+#define CHUNK           100
+#define BANDS           8
+
+UTEST_BEGIN("dspu.util", fft_crossover)
+
+    static void handler(void *object, void *subject, size_t band, const float *data, size_t first, size_t count)
+    {
+        float **dst     = reinterpret_cast<float **>(object);
+        dsp::copy(&dst[band][first], data, count);
+    }
+
+    void process(dspu::FFTCrossover &xc, float **dst, const float *src, size_t samples)
+    {
+        float *ptr[BANDS];
+        for (size_t off=0; off < samples; off += CHUNK)
+        {
+            size_t to_do    = lsp_min(samples - off, size_t(CHUNK));
+            for (size_t j=0; j<BANDS; ++j)
+                ptr[j]          = &dst[j][off];
+            for (size_t j=0; j<BANDS; ++j)
+                xc.set_handler(j, handler, ptr, NULL);
+            xc.process(&src[off], to_do);
+        }
+    }
+
+    void test_sum(dspu::FFTCrossover &xc, const float *src, float **dst, FloatBuffer &sum)
+    {
+        // The sum of bands should be the delayed input signal
+        process(xc, dst, src, SAMPLES);
+
+        dsp::fill_zero(sum.data(), SAMPLES);
+        for (size_t j=0; j<BANDS; ++j)
+            dsp::add2(sum.data(), dst[j], SAMPLES);
+        UTEST_ASSERT(sum.valid());
+
+        size_t latency  = xc.latency();
+        for (size_t i=0; i<SAMPLES; ++i)
+        {
+            float v = (i >= latency) ? src[i - latency] : 0.0f;
+            if (!float_equals_absolute(sum[i], v, 1e-4f))
+            {
+                sum.dump("sum");
+                UTEST_FAIL_MSG("Invalid sample %d: %f, expected %f", int(i), sum[i], v);
+            }
+        }
+    }
+
+    void test_band(dspu::FFTCrossover &xc, float **dst)
+    {
+        // Low-frequency sine should be mostly passed by the first band
+        FloatBuffer src(SAMPLES);
+        for (size_t i=0; i<SAMPLES; ++i)
+            src[i]          = sinf(2.0f * M_PI * 50.0f * i / SRATE);
+
+        xc.clear();
+        process(xc, dst, src.data(), SAMPLES);
+
+        float e0 = 0.0f, e1 = 0.0f;
+        for (size_t i=SAMPLES/2; i<SAMPLES; ++i)
+        {
+            e0             += dst[0][i] * dst[0][i];
+            e1             += dst[BANDS-1][i] * dst[BANDS-1][i];
+        }
+
+        UTEST_ASSERT_MSG(e0 > 100.0f, "Energy of band 0 is too low: %f", e0);
+        UTEST_ASSERT_MSG(e1 < 1e-3f, "Energy of band %d is too high: %f", int(BANDS-1), e1);
+    }
+
+    UTEST_MAIN
+    {
+        dspu::FFTCrossover xc;
+        FloatBuffer src(SAMPLES);
+        FloatBuffer sum(SAMPLES);
+        FloatBuffer *out[BANDS];
+        float *dst[BANDS];
+
+        UTEST_ASSERT(xc.init(BANDS, RANK));
+        UTEST_ASSERT(xc.latency() == ((3 << RANK) >> 2));
+        xc.set_sample_rate(SRATE);
+
+        for (size_t j=0; j<BANDS; ++j)
+        {
+            out[j]          = new FloatBuffer(SAMPLES);
+            dst[j]          = out[j]->data();
+        }
+
+        float freq = 100.0f;
+        for (size_t j=0; j<BANDS-1; ++j, freq *= 2.0f)
+        {
+            xc.set_frequency(j, freq);
+            xc.set_slope(j, (j & 1) + 2);
+        }
+        for (size_t j=0; j<BANDS; ++j)
+            UTEST_ASSERT(xc.band_active(j));
+
+        src.randomize(-1.0f, 1.0f);
+        test_sum(xc, src.data(), dst, sum);
+        test_band(xc, dst);
+
+        for (size_t j=0; j<BANDS; ++j)
+            delete out[j];
+        xc.destroy();
+    }
+
+UTEST_END
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/util/LoudnessMeter.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define SAMPLE_RATE     48000
+#define BUF_SIZE        0x800
+#define FREQUENCY       1000.0f
+
+UTEST_BEGIN("dspu.util", loudness_meter)
+
+    // Feed the meter with sine wave of the specified level (dBFS) in the specified channels
+    void feed(dspu::LoudnessMeter &m, size_t &phase, float level, float seconds, size_t channels)
+    {
+        static const size_t blocks[] = { 1, 1000, 17, 2048, 4800, 333 };
+
+        FloatBuffer buf(BUF_SIZE), zero(BUF_SIZE);
+        const float *in[2];
+        zero.fill_zero();
+
+        float amp       = expf(level * M_LN10 / 20.0f);
+        size_t samples  = seconds * SAMPLE_RATE;
+        for (size_t offset=0, i=0; offset < samples; ++i)
+        {
+            size_t to_do    = lsp_min(samples - offset, blocks[i % (sizeof(blocks)/sizeof(size_t))]);
+            for (size_t j=0; j<to_do; ++j, ++phase)
+                buf[j]          = amp * sinf(2.0f * M_PI * FREQUENCY * (phase % SAMPLE_RATE) / SAMPLE_RATE);
+
+            in[0]           = buf.data();
+            in[1]           = (channels > 1) ? buf.data() : zero.data();
+            m.process(in, to_do);
+            offset         += to_do;
+        }
+
+        UTEST_ASSERT(buf.valid());
+        UTEST_ASSERT(zero.valid());
+    }
+
+    void test_level()
+    {
+        printf("Testing loudness of stereo sine wave\n");
+
+        dspu::LoudnessMeter m;
+        size_t phase = 0;
+        UTEST_ASSERT(m.init(2));
+        m.set_sample_rate(SAMPLE_RATE);
+
+        // Silence does not contribute to the integrated loudness
+        UTEST_ASSERT(m.integrated() <= LOUDNESS_MIN);
+        feed(m, phase, -120.0f, 1.0f, 2);
+        UTEST_ASSERT(m.momentary() <= LOUDNESS_MIN);
+        UTEST_ASSERT(m.integrated() <= LOUDNESS_MIN);
+
+        // EBU Tech 3341: stereo 1 kHz sine at -23 dBFS gives -23 LUFS
+        feed(m, phase, -23.0f, 20.0f, 2);
+        printf("  M = %.2f, S = %.2f, I = %.2f LUFS, LRA = %.2f LU\n",
+            m.momentary(), m.short_term(), m.integrated(), m.range());
+        UTEST_ASSERT(float_equals_absolute(m.momentary(), -23.0f, 0.1f));
+        UTEST_ASSERT(float_equals_absolute(m.short_term(), -23.0f, 0.1f));
+        UTEST_ASSERT(float_equals_absolute(m.integrated(), -23.0f, 0.1f));
+        UTEST_ASSERT(m.range() < 0.2f);
+
+        // Excluded channel
+        m.reset();
+        m.set_weight(1, 0.0f);
+        feed(m, phase, -23.0f, 5.0f, 2);
+        UTEST_ASSERT(float_equals_absolute(m.integrated(), -26.01f, 0.1f));
+    }
+
+    void test_range()
+    {
+        printf("Testing loudness range\n");
+
+        dspu::LoudnessMeter m;
+        size_t phase = 0;
+        UTEST_ASSERT(m.init(2));
+        m.set_sample_rate(SAMPLE_RATE);
+
+        // EBU Tech 3342 case 1: 20 s at -20 dBFS followed by 20 s at -30 dBFS gives 10 LU
+        feed(m, phase, -20.0f, 20.0f, 2);
+        feed(m, phase, -30.0f, 20.0f, 2);
+        printf("  I = %.2f LUFS, LRA = %.2f LU\n", m.integrated(), m.range());
+        UTEST_ASSERT(float_equals_absolute(m.range(), 10.0f, 1.0f));
+
+        // Both parts pass the relative gate, the integrated loudness is the mean energy
+        UTEST_ASSERT(float_equals_absolute(m.integrated(), -22.6f, 0.5f));
+
+        // Mono signal in one channel is 3 dB lower
+        m.reset();
+        feed(m, phase, -20.0f, 10.0f, 1);
+        UTEST_ASSERT(float_equals_absolute(m.integrated(), -23.01f, 0.1f));
+    }
+
+    UTEST_MAIN
+    {
+        test_level();
+        test_range();
+    }
+
+UTEST_END
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/util/MeterGraph.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define FRAMES          64
+#define PERIOD          10
+#define LEVELS          5
+#define SAMPLES         (FRAMES * PERIOD * 5 + 7)
+
+UTEST_BEGIN("dspu.util", meter_graph)
+
+    float reduce(const float *s, size_t n, dspu::meter_method_t method)
+    {
+        double v = (method == dspu::MM_MINIMUM) ? fabs(s[0]) : 0.0;
+        for (size_t i=0; i<n; ++i)
+        {
+            double x    = fabs(s[i]);
+            switch (method)
+            {
+                case dspu::MM_MINIMUM:  v = lsp_min(v, x); break;
+                case dspu::MM_RMS:      v += x * x; break;
+                default:                v = lsp_max(v, x); break;
+            }
+        }
+        return (method == dspu::MM_RMS) ? sqrt(v / n) : v;
+    }
+
+    void test_levels(const char *label, dspu::meter_method_t method)
+    {
+        printf("Testing %s history levels\n", label);
+
+        dspu::MeterGraph mg;
+        FloatBuffer in(SAMPLES);
+        in.randomize(-1.0f, 1.0f);
+
+        UTEST_ASSERT(mg.init(FRAMES, PERIOD, LEVELS));
+        UTEST_ASSERT(mg.levels() == LEVELS);
+        UTEST_ASSERT(mg.data(LEVELS) == NULL);
+        mg.set_method(method);
+
+        // Process by chunks of different size
+        for (size_t off=0, step=1; off < SAMPLES; step = step*2 + 1)
+        {
+            size_t to_do = lsp_min(size_t(SAMPLES) - off, step);
+            mg.process(&in[off], to_do);
+            off    += to_do;
+        }
+
+        for (size_t l=0; l<LEVELS; ++l)
+        {
+            size_t frames   = mg.get_frames(l);
+            size_t span     = PERIOD << l;
+            size_t total    = SAMPLES / span;
+            const float *v  = mg.data(l);
+            UTEST_ASSERT(frames == (FRAMES >> l));
+            UTEST_ASSERT(v != NULL);
+
+            // Frames of the level are aligned to the start of the stream
+            for (size_t i=0; i<frames; ++i)
+            {
+                float ref   = reduce(&in[(total - frames + i) * span], span, method);
+                if (!float_equals_relative(v[i], ref, 1e-4f))
+                    UTEST_FAIL_MSG("Frame %d of level %d differs: %f vs %f", int(i), int(l), v[i], ref);
+            }
+        }
+
+        // Zoom selection
+        UTEST_ASSERT(mg.select_level(FRAMES * PERIOD, FRAMES) == 0);
+        UTEST_ASSERT(mg.select_level(FRAMES * PERIOD, FRAMES / 4) == 2);
+        UTEST_ASSERT(mg.select_level(FRAMES * PERIOD, 1) == LEVELS - 1);
+
+        mg.destroy();
+    }
+
+    UTEST_MAIN
+    {
+        test_levels("maximum", dspu::MM_MAXIMUM);
+        test_levels("minimum", dspu::MM_MINIMUM);
+        test_levels("rms", dspu::MM_RMS);
+    }
+
+UTEST_END
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/util/MLSResponseTaker.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define RESPONSE    40
+#define LATENCY     37
+#define PERIODS     3
+#define CHECK       0x80
+
+UTEST_BEGIN("dspu.util", mls_response_taker)
+
+    void test_response(size_t bits)
+    {
+        static const size_t blocks[] = { 1, 7, 300, 13, 1000, 256, 3 };
+
+        printf("Testing MLS response measurement for %d bits\n", int(bits));
+
+        FloatBuffer ir(RESPONSE);
+        for (size_t i=0; i<RESPONSE; ++i)
+            ir[i]           = sinf(i * 0.7f) * expf(-0.1f * i);
+
+        dspu::MLSResponseTaker rt;
+        UTEST_ASSERT(rt.init(16));
+        rt.set_n_bits(bits);
+        rt.set_periods(PERIODS);
+        rt.set_amplitude(0.5f);
+        rt.set_latency_samples(LATENCY);
+        rt.update_settings();
+        UTEST_ASSERT(rt.get_length() == (size_t(1) << bits) - 1);
+        UTEST_ASSERT(rt.deconvolve(ir, RESPONSE) == STATUS_BAD_STATE);
+
+        rt.start_capture();
+
+        // Loop the output to the input through the delayed response
+        size_t total    = rt.get_duration() + LATENCY + 100;
+        FloatBuffer out(total), in(total);
+        for (size_t offset=0, i=0; offset < total; ++i)
+        {
+            size_t to_do    = lsp_min(total - offset, blocks[i % (sizeof(blocks)/sizeof(size_t))]);
+            rt.process_out(&out[offset], NULL, to_do);
+
+            for (size_t j=offset; j<offset + to_do; ++j)
+            {
+                float s         = 0.0f;
+                for (size_t k=0; (k < RESPONSE) && (k + LATENCY <= j); ++k)
+                    s              += ir[k] * out[j - k - LATENCY];
+                in[j]           = s;
+            }
+
+            rt.process_in(&in[offset], &in[offset], to_do);
+            offset         += to_do;
+        }
+        UTEST_ASSERT(out.valid());
+        UTEST_ASSERT(in.valid());
+        UTEST_ASSERT(rt.cycle_complete());
+        UTEST_ASSERT(rt.get_captured() == rt.get_length() * PERIODS);
+
+        // The deconvolved response should match the original one
+        FloatBuffer dst(CHECK);
+        UTEST_ASSERT(rt.deconvolve(dst, CHECK) == STATUS_OK);
+        UTEST_ASSERT(dst.valid());
+        for (size_t i=0; i<CHECK; ++i)
+        {
+            float v         = (i < RESPONSE) ? ir[i] : 0.0f;
+            UTEST_ASSERT_MSG(float_equals_absolute(dst[i], v, 1e-5f),
+                "Invalid response sample %d: %f, expected %f", int(i), dst[i], v);
+        }
+    }
+
+    UTEST_MAIN
+    {
+        test_response(6);
+        test_response(11);
+        test_response(16);
+    }
+
+UTEST_END
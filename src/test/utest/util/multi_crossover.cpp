@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/util/Crossover.h>
+#include <lsp-plug.in/dsp-units/util/MultiCrossover.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+using namespace lsp;
+
+#define SRATE           48000
+#define BUF_SIZE        256
+#define SAMPLES         1024
+#define CHANNELS        2
+#define BANDS           4
+
+UTEST_BEGIN("dspu.util", multi_crossover)
+
+    typedef struct output_t
+    {
+        float      *vData[CHANNELS][BANDS];
+        size_t      nCalls;
+    } output_t;
+
+    static void single_handler(void *object, void *subject, size_t band, const float *data, size_t first, size_t count)
+    {
+        float **dst     = reinterpret_cast<float **>(object);
+        dsp::copy(&dst[band][first], data, count);
+    }
+
+    static void multi_handler(void *object, void *subject, size_t band, const float * const *data, size_t channels, size_t first, size_t count)
+    {
+        output_t *out   = reinterpret_cast<output_t *>(object);
+        for (size_t i=0; i<channels; ++i)
+            dsp::copy(&out->vData[i][band][first], data[i], count);
+        ++out->nCalls;
+    }
+
+    static void configure(dspu::Crossover *xc, dspu::MultiCrossover *mc, size_t sp, float freq, size_t slope, float gain)
+    {
+        if (xc != NULL)
+        {
+            xc->set_frequency(sp, freq);
+            xc->set_slope(sp, slope);
+            xc->set_gain(sp, gain);
+        }
+        if (mc != NULL)
+        {
+            mc->set_frequency(sp, freq);
+            mc->set_slope(sp, slope);
+            mc->set_gain(sp, gain);
+        }
+    }
+
+    UTEST_MAIN
+    {
+        dspu::Crossover xc[CHANNELS];
+        dspu::MultiCrossover mc;
+        FloatBuffer *src[CHANNELS];
+        FloatBuffer *dst1[CHANNELS][BANDS];
+        FloatBuffer *dst2[CHANNELS][BANDS];
+        float *sdst[CHANNELS][BANDS];
+        const float *vin[CHANNELS];
+        output_t mout;
+
+        UTEST_ASSERT(mc.init(CHANNELS, BANDS, BUF_SIZE));
+        UTEST_ASSERT(mc.channels() == CHANNELS);
+        mc.set_sample_rate(SRATE);
+        mout.nCalls     = 0;
+
+        for (size_t i=0; i<CHANNELS; ++i)
+        {
+            UTEST_ASSERT(xc[i].init(BANDS, BUF_SIZE));
+            xc[i].set_sample_rate(SRATE);
+
+            src[i]          = new FloatBuffer(SAMPLES);
+            src[i]->randomize(-1.0f, 1.0f);
+            vin[i]          = src[i]->data();
+
+            for (size_t j=0; j<BANDS; ++j)
+            {
+                dst1[i][j]      = new FloatBuffer(SAMPLES);
+                dst2[i][j]      = new FloatBuffer(SAMPLES);
+                sdst[i][j]      = dst1[i][j]->data();
+                mout.vData[i][j]= dst2[i][j]->data();
+
+                xc[i].set_handler(j, single_handler, sdst[i], NULL);
+                mc.set_handler(j, multi_handler, &mout, NULL);
+            }
+
+            configure(&xc[i], (i == 0) ? &mc : NULL, 0, 200.0f, 2, 1.0f);
+            configure(&xc[i], (i == 0) ? &mc : NULL, 1, 1000.0f, 3, 0.5f);
+            configure(&xc[i], (i == 0) ? &mc : NULL, 2, 5000.0f, 2, 2.0f);
+        }
+
+        // Process data, the single-channel crossover is fed by the chunks
+        // of maximum buffer size
+        for (size_t off=0; off < SAMPLES; off += BUF_SIZE)
+        {
+            for (size_t i=0; i<CHANNELS; ++i)
+            {
+                for (size_t j=0; j<BANDS; ++j)
+                    sdst[i][j]      = &dst1[i][j]->data()[off];
+                xc[i].process(&vin[i][off], BUF_SIZE);
+            }
+        }
+        mc.process(vin, SAMPLES);
+        UTEST_ASSERT(mout.nCalls == BANDS * (SAMPLES / BUF_SIZE));
+
+        // Compare results
+        for (size_t i=0; i<CHANNELS; ++i)
+            for (size_t j=0; j<BANDS; ++j)
+            {
+                UTEST_ASSERT(dst1[i][j]->valid());
+                UTEST_ASSERT(dst2[i][j]->valid());
+                if (!dst1[i][j]->equals_absolute(*dst2[i][j], 1e-4f))
+                {
+                    dst1[i][j]->dump("dst1");
+                    dst2[i][j]->dump("dst2");
+                    UTEST_FAIL_MSG("Band %d of channel %d differs", int(j), int(i));
+                }
+            }
+
+        for (size_t i=0; i<CHANNELS; ++i)
+        {
+            delete src[i];
+            for (size_t j=0; j<BANDS; ++j)
+            {
+                delete dst1[i][j];
+                delete dst2[i][j];
+            }
+            xc[i].destroy();
+        }
+        mc.destroy();
+    }
+
+UTEST_END
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/util/MultiMeterGraph.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define CHANNELS        5
+#define FRAMES          40
+#define PERIOD          37
+#define SAMPLES         (PERIOD * FRAMES * 3 + 11)
+
+UTEST_BEGIN("dspu.util", multi_meter_graph)
+
+    void test_method(const char *label, dspu::meter_method_t method)
+    {
+        printf("Testing %s metering\n", label);
+
+        dspu::MultiMeterGraph mg;
+        dspu::MeterGraph *sg = new dspu::MeterGraph[CHANNELS];
+        FloatBuffer *in[CHANNELS];
+        const float *vin[CHANNELS];
+
+        UTEST_ASSERT(mg.init(CHANNELS, FRAMES, PERIOD));
+        UTEST_ASSERT(mg.channels() == CHANNELS);
+        UTEST_ASSERT(mg.get_frames() == FRAMES);
+        mg.set_method(method);
+
+        for (size_t i=0; i<CHANNELS; ++i)
+        {
+            UTEST_ASSERT(sg[i].init(FRAMES, PERIOD));
+            sg[i].set_method(method);
+            in[i]       = new FloatBuffer(SAMPLES);
+            in[i]->randomize(-1.0f, 1.0f);
+            sg[i].process(in[i]->data(), SAMPLES);
+        }
+
+        // Process by chunks of different size
+        for (size_t off=0, step=1; off < SAMPLES; step = step*2 + 1)
+        {
+            size_t to_do = lsp_min(size_t(SAMPLES) - off, step);
+            for (size_t i=0; i<CHANNELS; ++i)
+                vin[i]      = &in[i]->data()[off];
+            mg.process(vin, to_do);
+            off    += to_do;
+        }
+        UTEST_ASSERT(mg.published() == SAMPLES / PERIOD);
+
+        // Compare with single-channel meter graphs
+        FloatBuffer out(FRAMES);
+        for (size_t i=0; i<CHANNELS; ++i)
+        {
+            UTEST_ASSERT(mg.read(out, i, FRAMES) == SAMPLES / PERIOD);
+            UTEST_ASSERT(out.valid());
+            const float *ref    = sg[i].data();
+            for (size_t j=0; j<FRAMES; ++j)
+            {
+                if (!float_equals_relative(out[j], ref[j], 1e-4f))
+                    UTEST_FAIL_MSG("Frame %d of channel %d differs: %f vs %f", int(j), int(i), out[j], ref[j]);
+            }
+
+            // Reading of the shorter history returns the latest frames
+            UTEST_ASSERT(mg.read(out, i, 3) == SAMPLES / PERIOD);
+            for (size_t j=0; j<3; ++j)
+                UTEST_ASSERT(float_equals_relative(out[j], ref[FRAMES - 3 + j], 1e-4f));
+        }
+
+        // Check RMS value of the last frame directly
+        if (method == dspu::MM_RMS)
+        {
+            size_t first    = (SAMPLES / PERIOD - 1) * PERIOD;
+            for (size_t i=0; i<CHANNELS; ++i)
+            {
+                const float *v  = &in[i]->data()[first];
+                double s        = 0.0;
+                for (size_t j=0; j<PERIOD; ++j)
+                    s              += v[j] * v[j];
+                UTEST_ASSERT(float_equals_relative(sg[i].level(), sqrt(s / PERIOD), 1e-4f));
+            }
+        }
+
+        for (size_t i=0; i<CHANNELS; ++i)
+            delete in[i];
+        delete [] sg;
+        mg.destroy();
+    }
+
+    UTEST_MAIN
+    {
+        test_method("maximum", dspu::MM_MAXIMUM);
+        test_method("minimum", dspu::MM_MINIMUM);
+        test_method("rms", dspu::MM_RMS);
+    }
+
+UTEST_END
@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/util/MultiOversampler.h>
+#include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+using namespace lsp;
+
+#define SRATE           48000
+#define SAMPLES         8192
+#define CHANNELS        2
+
+UTEST_BEGIN("dspu.util", multi_oversampler)
+
+    class Gain: public dspu::IOversamplerCallback
+    {
+        public:
+            float fGain;
+
+        public:
+            explicit Gain(float gain): fGain(gain) {}
+
+            virtual void process(float *out, const float *in, size_t samples)
+            {
+                dsp::mul_k3(out, in, fGain, samples);
+            }
+    };
+
+    class MultiGain: public dspu::IMultiOversamplerCallback
+    {
+        public:
+            size_t nCalls;
+
+        public:
+            explicit MultiGain(): nCalls(0) {}
+
+            virtual void process(float * const *out, const float * const *in, size_t channels, size_t samples)
+            {
+                ++nCalls;
+                for (size_t i=0; i<channels; ++i)
+                    dsp::mul_k3(out[i], in[i], i + 1.0f, samples);
+            }
+    };
+
+    void test_mode(dspu::over_mode_t mode)
+    {
+        FloatBuffer *in[CHANNELS], *out[CHANNELS], *ref[CHANNELS];
+        float *src[CHANNELS], *dst[CHANNELS];
+
+        // Generate input data
+        for (size_t i=0; i<CHANNELS; ++i)
+        {
+            in[i]       = new FloatBuffer(SAMPLES);
+            out[i]      = new FloatBuffer(SAMPLES);
+            ref[i]      = new FloatBuffer(SAMPLES);
+            src[i]      = in[i]->data();
+            dst[i]      = out[i]->data();
+
+            float w     = 2 * M_PI * (440.0f + i * 1000.0f) / SRATE;
+            for (size_t j=0; j<SAMPLES; ++j)
+                src[i][j]   = sinf(w * j);
+            out[i]->fill_zero();
+            ref[i]->fill_zero();
+        }
+
+        // Compute the reference with single-channel oversamplers
+        for (size_t i=0; i<CHANNELS; ++i)
+        {
+            dspu::Oversampler os;
+            Gain gain(i + 1.0f);
+            UTEST_ASSERT(os.init());
+            os.set_sample_rate(SRATE);
+            os.set_mode(mode);
+            if (os.modified())
+                os.update_settings();
+            os.process(ref[i]->data(), src[i], SAMPLES, &gain);
+            os.destroy();
+        }
+
+        // Process with multi-channel oversampler
+        dspu::MultiOversampler mos;
+        MultiGain gain;
+        UTEST_ASSERT(mos.init(CHANNELS));
+        mos.set_sample_rate(SRATE);
+        mos.set_mode(mode);
+        if (mos.modified())
+            mos.update_settings();
+        UTEST_ASSERT(!mos.modified());
+
+        for (size_t i=0; i<SAMPLES; )
+        {
+            size_t to_do = lsp_min(SAMPLES - i, size_t(1024));
+            float *d[CHANNELS];
+            const float *s[CHANNELS];
+            for (size_t j=0; j<CHANNELS; ++j)
+            {
+                d[j]        = &dst[j][i];
+                s[j]        = &src[j][i];
+            }
+            mos.process(d, s, to_do, &gain);
+            i += to_do;
+        }
+        UTEST_ASSERT(gain.nCalls >= SAMPLES / 1024);
+        mos.destroy();
+
+        // Compare results
+        for (size_t i=0; i<CHANNELS; ++i)
+        {
+            UTEST_ASSERT(in[i]->valid());
+            UTEST_ASSERT(out[i]->valid());
+            UTEST_ASSERT(ref[i]->valid());
+            if (!out[i]->equals_absolute(*ref[i], 1e-4f))
+            {
+                out[i]->dump("out");
+                ref[i]->dump("ref");
+                UTEST_FAIL_MSG("Output of channel %d differs from the reference", int(i));
+            }
+
+            delete in[i];
+            delete out[i];
+            delete ref[i];
+        }
+    }
+
+    UTEST_MAIN
+    {
+        test_mode(dspu::OM_LANCZOS_4X3);
+        test_mode(dspu::OM_LANCZOS_8X3);
+        test_mode(dspu::OM_HALFBAND_4X);
+    }
+UTEST_END;
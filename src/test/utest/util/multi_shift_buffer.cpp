@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/util/MultiShiftBuffer.h>
+#include <lsp-plug.in/dsp-units/util/ShiftBuffer.h>
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define CHANNELS    3
+#define GAP         300
+#define SIZE        1000
+#define STEPS       200
+
+UTEST_BEGIN("dspu.util", multi_shift_buffer)
+
+    void compare(dspu::MultiShiftBuffer *mb, dspu::ShiftBuffer *rb, size_t step)
+    {
+        for (size_t c=0; c<CHANNELS; ++c)
+        {
+            UTEST_ASSERT_MSG(mb->size() == rb[c].size(), "step %d: sizes differ: %d vs %d",
+                int(step), int(mb->size()), int(rb[c].size()));
+
+            size_t size = mb->size();
+            const float *h1 = mb->head(c), *h2 = rb[c].head();
+            for (size_t i=0; i<size; ++i)
+            {
+                UTEST_ASSERT_MSG(h1[i] == h2[i], "step %d: channel %d sample %d differs: %f vs %f",
+                    int(step), int(c), int(i), h1[i], h2[i]);
+            }
+
+            if (size > 0)
+            {
+                UTEST_ASSERT(mb->tail(c, size) == mb->head(c));
+                UTEST_ASSERT(mb->last(c, 1) == rb[c].last());
+                UTEST_ASSERT(mb->head(c, size) == NULL);
+            }
+        }
+    }
+
+    UTEST_MAIN
+    {
+        dspu::MultiShiftBuffer mb;
+        dspu::ShiftBuffer rb[CHANNELS];
+        FloatBuffer src(SIZE * CHANNELS), dst1(SIZE), dst2(SIZE * CHANNELS);
+        const float *vin[CHANNELS];
+        float *vout[CHANNELS];
+
+        UTEST_ASSERT(mb.init(CHANNELS, SIZE, GAP));
+        UTEST_ASSERT(mb.channels() == CHANNELS);
+        UTEST_ASSERT(mb.capacity() >= SIZE);
+        for (size_t c=0; c<CHANNELS; ++c)
+        {
+            UTEST_ASSERT(rb[c].init(SIZE, GAP, true));
+            UTEST_ASSERT(ptrdiff_t(mb.head(c)) % DEFAULT_ALIGN == 0);
+            vin[c]      = &src[c * SIZE];
+            vout[c]     = &dst2[c * SIZE];
+        }
+        compare(&mb, rb, 0);
+
+        // Random sequence of appends and shifts, the last channel receives zeros
+        srand(0);
+        float value = 0.0f;
+        for (size_t step=1; step <= STEPS; ++step)
+        {
+            size_t count    = rand() % (SIZE / 2);
+            for (size_t c=0; c<CHANNELS; ++c)
+                for (size_t i=0; i<count; ++i)
+                    src[c * SIZE + i]   = (value += 1.0f);
+            vin[CHANNELS-1] = NULL;
+
+            size_t n1       = mb.append(vin, count);
+            for (size_t c=0; c<CHANNELS; ++c)
+                UTEST_ASSERT(rb[c].append(vin[c], count) == n1);
+            vin[CHANNELS-1] = &src[(CHANNELS-1) * SIZE];
+            compare(&mb, rb, step);
+
+            count           = rand() % (SIZE / 2);
+            n1              = mb.shift(vout, count);
+            for (size_t c=0; c<CHANNELS; ++c)
+            {
+                UTEST_ASSERT(rb[c].shift(dst1, count) == n1);
+                for (size_t i=0; i<n1; ++i)
+                    UTEST_ASSERT(dst1[i] == vout[c][i]);
+            }
+            compare(&mb, rb, step);
+
+            // Skip some samples without copying
+            count           = rand() % 16;
+            n1              = mb.shift(count);
+            for (size_t c=0; c<CHANNELS; ++c)
+                UTEST_ASSERT(rb[c].shift(count) == n1);
+            compare(&mb, rb, step);
+        }
+
+        UTEST_ASSERT(dst2.valid());
+        UTEST_ASSERT(src.valid());
+    }
+
+UTEST_END
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/util/MultiSpectralProcessor.h>
+#include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+using namespace lsp;
+
+#define SRATE           48000.0f
+#define SAMPLES         8192
+#define RANK            8
+
+UTEST_BEGIN("dspu.util", multi_spectral_proc)
+
+    static void swap_spectra(void *object, void *subject, float * const *spectrum, size_t rank)
+    {
+        size_t count = 2 << rank;
+        float *a = spectrum[0], *b = spectrum[1];
+        for (size_t i=0; i<count; ++i)
+        {
+            float t     = a[i];
+            a[i]        = b[i];
+            b[i]        = t;
+        }
+    }
+
+    void test_linked(float overlap)
+    {
+        FloatBuffer in1(SAMPLES), in2(SAMPLES);
+        FloatBuffer out1(SAMPLES), out2(SAMPLES);
+
+        // Generate input data
+        float *src[2] = { in1.data(), in2.data() };
+        float *dst[2] = { out1.data(), out2.data() };
+        for (size_t i=0; i<SAMPLES; ++i)
+        {
+            src[0][i]   = sinf(2 * M_PI * 440.0f * i / SRATE);
+            src[1][i]   = cosf(2 * M_PI * 1000.0f * i / SRATE);
+        }
+        out1.fill_zero();
+        out2.fill_zero();
+
+        // Create processor
+        dspu::MultiSpectralProcessor sp;
+        UTEST_ASSERT(sp.init(2, 12));
+        sp.set_phase(0.0f);
+        sp.set_rank(RANK);
+        sp.set_overlap(overlap);
+        sp.bind(swap_spectra, NULL, NULL);
+
+        printf("Testing overlap=%.3f...\n", overlap);
+
+        // Process data by small chunks
+        for (size_t i=0; i<SAMPLES; )
+        {
+            size_t to_do = lsp_min(SAMPLES - i, size_t(77));
+            float *d[2] = { &dst[0][i], &dst[1][i] };
+            const float *s[2] = { &src[0][i], &src[1][i] };
+            sp.process(d, s, to_do);
+            i += to_do;
+        }
+
+        UTEST_ASSERT(in1.valid());
+        UTEST_ASSERT(in2.valid());
+        UTEST_ASSERT(out1.valid());
+        UTEST_ASSERT(out2.valid());
+
+        // Channels should be swapped
+        size_t latency = sp.latency();
+        for (size_t i=0; i<SAMPLES-latency; ++i)
+        {
+            if (!float_equals_absolute(src[1][i], dst[0][latency+i], 1e-4f))
+                UTEST_FAIL_MSG("Sample mismatch at channel 0, index %d: %f vs %f", int(i), src[1][i], dst[0][latency+i]);
+            if (!float_equals_absolute(src[0][i], dst[1][latency+i], 1e-4f))
+                UTEST_FAIL_MSG("Sample mismatch at channel 1, index %d: %f vs %f", int(i), src[0][i], dst[1][latency+i]);
+        }
+    }
+
+    UTEST_MAIN
+    {
+        test_linked(0.5f);
+        test_linked(0.75f);
+    }
+UTEST_END;
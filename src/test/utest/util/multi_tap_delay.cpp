@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/util/Delay.h>
+#include <lsp-plug.in/dsp-units/util/MultiTapDelay.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#define MAX_DELAY   1500
+#define TAPS        5
+#define SAMPLES     8000
+#define BLOCK       1234
+
+UTEST_BEGIN("dspu.util", multi_tap_delay)
+
+    static const size_t delays[TAPS] = { 0, 1, 17, 900, MAX_DELAY };
+    static const float gains[TAPS] = { 1.0f, -0.5f, 0.25f, 0.75f, 2.0f };
+
+    void test_taps()
+    {
+        dspu::Delay d[TAPS];
+        dspu::MultiTapDelay mtd;
+        FloatBuffer src(SAMPLES), sum1(SAMPLES), sum2(SAMPLES);
+        FloatBuffer *out1[TAPS], *out2[TAPS];
+        float *vout[TAPS];
+
+        UTEST_ASSERT(mtd.init(MAX_DELAY, TAPS));
+        UTEST_ASSERT(mtd.taps() == TAPS);
+        for (size_t i=0; i<TAPS; ++i)
+        {
+            UTEST_ASSERT(d[i].init(MAX_DELAY));
+            d[i].set_delay(delays[i]);
+            mtd.set_delay(i, delays[i]);
+            mtd.set_gain(i, gains[i]);
+            UTEST_ASSERT(mtd.get_delay(i) == delays[i]);
+            out1[i]     = new FloatBuffer(SAMPLES);
+            out2[i]     = new FloatBuffer(SAMPLES);
+        }
+        src.randomize(-1.0f, 1.0f);
+
+        // Compute the reference with separate delays
+        dsp::fill_zero(sum1, SAMPLES);
+        for (size_t i=0; i<TAPS; ++i)
+        {
+            d[i].process(out1[i]->data(), src, gains[i], SAMPLES);
+            dsp::add2(sum1, out1[i]->data(), SAMPLES);
+        }
+
+        // Apply the first call to commit settings, then process by blocks with per-tap outputs
+        for (size_t i=0; i<TAPS; ++i)
+            vout[i]     = out2[i]->data();
+        mtd.process(vout, src, 0);
+        for (size_t offset=0; offset < SAMPLES; offset += BLOCK)
+        {
+            size_t to_do    = lsp_min(SAMPLES - offset, size_t(BLOCK));
+            for (size_t i=0; i<TAPS; ++i)
+                vout[i]         = out2[i]->data() + offset;
+            mtd.process(vout, &src[offset], to_do);
+        }
+
+        for (size_t i=0; i<TAPS; ++i)
+        {
+            UTEST_ASSERT(out2[i]->valid());
+            if (!out1[i]->equals_absolute(*out2[i], 1e-6f))
+                UTEST_FAIL_MSG("Output of tap %d differs", int(i));
+        }
+
+        // Summed output, processed in place
+        mtd.clear();
+        dsp::copy(sum2, src, SAMPLES);
+        for (size_t offset=0; offset < SAMPLES; offset += BLOCK)
+            mtd.process(&sum2[offset], &sum2[offset], lsp_min(SAMPLES - offset, size_t(BLOCK)));
+        UTEST_ASSERT(sum2.valid());
+        if (!sum1.equals_absolute(sum2, 1e-5f))
+            UTEST_FAIL("Summed output differs");
+
+        for (size_t i=0; i<TAPS; ++i)
+        {
+            delete out1[i];
+            delete out2[i];
+        }
+    }
+
+    void test_ramping()
+    {
+        dspu::MultiTapDelay mtd;
+        FloatBuffer src(SAMPLES), dst(SAMPLES);
+        UTEST_ASSERT(mtd.init(MAX_DELAY, 1));
+        mtd.set_delay(0, 10);
+        dsp::fill_one(src, SAMPLES);
+        mtd.process(dst, src, SAMPLES);
+
+        // The gain should change linearly from 1 to 0 over the call
+        mtd.set_gain(0, 0.0f);
+        mtd.process(dst, src, SAMPLES);
+        UTEST_ASSERT(dst.valid());
+        for (size_t i=0; i<SAMPLES; ++i)
+        {
+            float g     = 1.0f - float(i) / SAMPLES;
+            UTEST_ASSERT_MSG(float_equals_absolute(dst[i], g, 1e-4f),
+                "Ramped gain differs at %d: %f vs %f", int(i), dst[i], g);
+        }
+        UTEST_ASSERT(float_equals_absolute(mtd.get_gain(0), 0.0f));
+    }
+
+    UTEST_MAIN
+    {
+        test_taps();
+        test_ramping();
+    }
+
+UTEST_END
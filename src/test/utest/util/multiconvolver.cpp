@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/util/MultiConvolver.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#define CONV_SIZE       0x2000
+#define SRC_SIZE        0x800
+
+static void convolve(float *dst, const float *src, const float *conv, size_t length, size_t count)
+{
+    for (size_t i=0; i<count; ++i)
+    {
+        float k = src[i];
+        for (size_t j=0; j<length; ++j)
+            dst[i+j] += k * conv[j];
+    }
+}
+
+UTEST_BEGIN("dspu.util", multiconvolver)
+
+    void test_true_stereo(size_t conv_size, size_t rank, size_t step)
+    {
+        dspu::MultiConvolver c;
+
+        printf("Testing true stereo convolution size=%d, rank=%d, step=%d...\n",
+                int(conv_size), int(rank), int(step));
+
+        // Impulse responses: LL, LR, RL, RR, the RL response is shorter than others
+        FloatBuffer ll(conv_size), lr(conv_size), rl(conv_size >> 1), rr(conv_size);
+        ll.randomize(-1.0f, 1.0f);
+        lr.randomize(-1.0f, 1.0f);
+        rl.randomize(-1.0f, 1.0f);
+        rr.randomize(-1.0f, 1.0f);
+
+        FloatBuffer src_l(SRC_SIZE + conv_size), src_r(SRC_SIZE + conv_size);
+        src_l.randomize(-1.0f, 1.0f);
+        src_r.randomize(-1.0f, 1.0f);
+        dsp::fill_zero(src_l.data(SRC_SIZE), conv_size);
+        dsp::fill_zero(src_r.data(SRC_SIZE), conv_size);
+
+        FloatBuffer dst1_l(src_l.size() + conv_size), dst1_r(dst1_l);
+        FloatBuffer dst2_l(dst1_l), dst2_r(dst1_l);
+        dst1_l.fill_zero();
+        dst1_r.fill_zero();
+        dst2_l.fill_zero();
+        dst2_r.fill_zero();
+
+        // Reference
+        ::convolve(dst1_l, src_l, ll, ll.size(), SRC_SIZE);
+        ::convolve(dst1_l, src_r, rl, rl.size(), SRC_SIZE);
+        ::convolve(dst1_r, src_l, lr, lr.size(), SRC_SIZE);
+        ::convolve(dst1_r, src_r, rr, rr.size(), SRC_SIZE);
+
+        // Multi-channel convolver
+        const float *irs[4]     = { ll.data(), lr.data(), rl.data(), rr.data() };
+        const size_t counts[4]  = { ll.size(), lr.size(), rl.size(), rr.size() };
+        UTEST_ASSERT(c.init(irs, counts, 2, 2, rank, 0.0f));
+        UTEST_ASSERT(c.inputs() == 2);
+        UTEST_ASSERT(c.outputs() == 2);
+        UTEST_ASSERT(c.data_size() == conv_size);
+
+        for (size_t i=0, n=src_l.size(); i<n; )
+        {
+            size_t todo         = lsp_min(n - i, step);
+            const float *in[2]  = { src_l.data(i), src_r.data(i) };
+            float *out[2]       = { dst2_l.data(i), dst2_r.data(i) };
+            c.process(out, in, todo);
+            i                  += todo;
+        }
+
+        UTEST_ASSERT_MSG(src_l.valid(), "Source buffer L corrupted");
+        UTEST_ASSERT_MSG(src_r.valid(), "Source buffer R corrupted");
+        UTEST_ASSERT_MSG(dst2_l.valid(), "Destination buffer L corrupted");
+        UTEST_ASSERT_MSG(dst2_r.valid(), "Destination buffer R corrupted");
+
+        if (!dst2_l.equals_absolute(dst1_l, 1e-3))
+        {
+            size_t index = dst2_l.last_diff();
+            UTEST_FAIL_MSG("Left output of convolver is invalid, started at sample=%d: %.5f vs %.5f",
+                    int(index), dst1_l[index], dst2_l[index]);
+        }
+        if (!dst2_r.equals_absolute(dst1_r, 1e-3))
+        {
+            size_t index = dst2_r.last_diff();
+            UTEST_FAIL_MSG("Right output of convolver is invalid, started at sample=%d: %.5f vs %.5f",
+                    int(index), dst1_r[index], dst2_r[index]);
+        }
+
+        c.destroy();
+    }
+
+    UTEST_MAIN
+    {
+        test_true_stereo(0x1f, 9, 31);
+        test_true_stereo(CONV_SIZE, 10, 31);
+        test_true_stereo(CONV_SIZE, 12, 256);
+    }
+UTEST_END;
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/util/Oscillator.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define SRATE       48000
+#define PERIOD      64              /* Period of the wave, makes the frequency control word exact */
+#define SAMPLES     0x3000
+
+UTEST_BEGIN("dspu.util", oscillator)
+
+    void test_sinusoid(const char *label, dspu::fg_function_t func, size_t bits)
+    {
+        printf("Testing %s wave for %d-bit phase accumulator\n", label, int(bits));
+
+        dspu::Oscillator osc;
+        UTEST_ASSERT(osc.init());
+        osc.set_sample_rate(SRATE);
+        osc.set_phase_accumulator_bits(bits);
+        osc.set_function(func);
+        osc.set_frequency(float(SRATE) / PERIOD);
+        osc.set_amplitude(0.8f);
+        osc.set_dc_offset(0.1f);
+        osc.set_dc_reference(dspu::DC_WAVEDC);
+        osc.update_settings();
+
+        FloatBuffer dst(SAMPLES);
+        osc.process_overwrite(dst, SAMPLES);
+        UTEST_ASSERT_MSG(dst.valid(), "Destination buffer corrupted");
+
+        // Compare with the double-precision reference
+        for (size_t i=0; i<SAMPLES; ++i)
+        {
+            double x    = (2.0 * M_PI * (i % PERIOD)) / PERIOD;
+            double v    = 0.0;
+            switch (func)
+            {
+                case dspu::FG_SINE:             v = sin(x); break;
+                case dspu::FG_COSINE:           v = cos(x); break;
+                case dspu::FG_SQUARED_SINE:     v = sin(0.5 * x) * sin(0.5 * x); break;
+                case dspu::FG_SQUARED_COSINE:   v = cos(0.5 * x) * cos(0.5 * x); break;
+                default: break;
+            }
+            v           = 0.8 * v + 0.1;
+
+            if (!float_equals_absolute(dst[i], v, 1e-6f))
+                UTEST_FAIL_MSG("Invalid sample %d: %f, expected %f", int(i), dst[i], float(v));
+        }
+
+        osc.destroy();
+    }
+
+    void test_rectangular(size_t bits)
+    {
+        printf("Testing rectangular wave for %d-bit phase accumulator\n", int(bits));
+
+        dspu::Oscillator osc;
+        UTEST_ASSERT(osc.init());
+        osc.set_sample_rate(SRATE);
+        osc.set_phase_accumulator_bits(bits);
+        osc.set_function(dspu::FG_RECTANGULAR);
+        osc.set_frequency(float(SRATE) / PERIOD);
+        osc.set_duty_ratio(0.25f);
+        osc.set_amplitude(0.5f);
+        osc.update_settings();
+
+        FloatBuffer dst(SAMPLES);
+        osc.process_overwrite(dst, SAMPLES);
+        UTEST_ASSERT_MSG(dst.valid(), "Destination buffer corrupted");
+
+        for (size_t i=0; i<SAMPLES; ++i)
+        {
+            float v     = ((i % PERIOD) < (PERIOD / 4)) ? 0.5f : -0.5f;
+            if (!float_equals_absolute(dst[i], v, 1e-6f))
+                UTEST_FAIL_MSG("Invalid sample %d: %f, expected %f", int(i), dst[i], v);
+        }
+
+        osc.destroy();
+    }
+
+    void test_polyblep(const char *label, dspu::fg_function_t func, size_t bits)
+    {
+        printf("Testing polyBLEP %s wave for %d-bit phase accumulator\n", label, int(bits));
+
+        dspu::Oscillator osc;
+        UTEST_ASSERT(osc.init());
+        osc.set_sample_rate(SRATE);
+        osc.set_phase_accumulator_bits(bits);
+        osc.set_function(func);
+        osc.set_band_limit_mode(dspu::BL_POLYBLEP);
+        osc.set_frequency(float(SRATE) / PERIOD);
+        osc.set_duty_ratio(0.25f);
+        osc.set_width(1.0f);
+        osc.set_amplitude(0.5f);
+        osc.update_settings();
+
+        FloatBuffer dst(SAMPLES);
+        osc.process_overwrite(dst, SAMPLES);
+        UTEST_ASSERT_MSG(dst.valid(), "Destination buffer corrupted");
+
+        // The discontinuities fall exactly onto the samples: the samples at the
+        // discontinuities take the middle value of the jump, others remain naive.
+        // The naive sawtooth of full width peaks one phase word before the end of the period
+        for (size_t i=0; i<SAMPLES; ++i)
+        {
+            size_t n    = i % PERIOD;
+            float v     = 0.0f;
+            if (func == dspu::FG_BL_RECTANGULAR)
+                v           = ((n == 0) || (n == PERIOD / 4)) ? 0.0f : (n < (PERIOD / 4)) ? 0.5f : -0.5f;
+            else
+                v           = (n == 0) ? 0.0f : float(n) / PERIOD - 0.5f;
+
+            if (!float_equals_absolute(dst[i], v, 1e-4f))
+                UTEST_FAIL_MSG("Invalid sample %d: %f, expected %f", int(i), dst[i], v);
+        }
+
+        osc.destroy();
+    }
+
+    UTEST_MAIN
+    {
+        static const size_t bits[] = { 32, 24, 16 };
+
+        for (size_t i=0; i<sizeof(bits)/sizeof(bits[0]); ++i)
+        {
+            test_sinusoid("sine", dspu::FG_SINE, bits[i]);
+            test_sinusoid("cosine", dspu::FG_COSINE, bits[i]);
+            test_sinusoid("squared sine", dspu::FG_SQUARED_SINE, bits[i]);
+            test_sinusoid("squared cosine", dspu::FG_SQUARED_COSINE, bits[i]);
+            test_rectangular(bits[i]);
+            test_polyblep("rectangular", dspu::FG_BL_RECTANGULAR, bits[i]);
+            test_polyblep("sawtooth", dspu::FG_BL_SAWTOOTH, bits[i]);
+        }
+    }
+
+UTEST_END;
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/util/OscillatorBank.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define SRATE       48000
+#define PERIOD      256             /* Base period, makes the frequency control words exact */
+#define PARTIALS    13              /* Not a multiple of the lane count to check padding */
+#define SAMPLES     0x1000
+
+UTEST_BEGIN("dspu.util", oscillator_bank)
+
+    void test_partials()
+    {
+        dspu::OscillatorBank bank;
+        UTEST_ASSERT(bank.init(PARTIALS));
+        UTEST_ASSERT(bank.oscillators() == PARTIALS);
+
+        bank.set_sample_rate(SRATE);
+        bank.set_dc_offset(0.25f);
+        for (size_t i=0; i<PARTIALS; ++i)
+        {
+            bank.set_frequency(i, float(SRATE * (i + 1)) / PERIOD);
+            bank.set_amplitude(i, 1.0f / (i + 1));
+            bank.set_phase(i, 0.5f * i);
+        }
+        // Frequency above Nyquist, should be muted
+        bank.set_frequency(PARTIALS - 1, SRATE);
+
+        FloatBuffer dst(SAMPLES);
+        bank.process_overwrite(dst, SAMPLES);
+        UTEST_ASSERT_MSG(dst.valid(), "Destination buffer corrupted");
+
+        // Compare with the double-precision reference
+        for (size_t i=0; i<SAMPLES; ++i)
+        {
+            double v    = 0.25;
+            for (size_t j=0; j<PARTIALS-1; ++j)
+                v          += sin((2.0 * M_PI * (((j + 1) * i) % PERIOD)) / PERIOD + 0.5 * j) / (j + 1);
+
+            if (!float_equals_absolute(dst[i], v, 1e-5f))
+                UTEST_FAIL_MSG("Invalid sample %d: %f, expected %f", int(i), dst[i], v);
+        }
+
+        // The phase continues over the calls
+        FloatBuffer add(SAMPLES);
+        bank.reset_phase();
+        add.fill_zero();
+        for (size_t offset=0; offset < SAMPLES; offset += 100)
+            bank.process_add(&add[offset], &add[offset], lsp_min(SAMPLES - offset, size_t(100)));
+        UTEST_ASSERT(add.valid());
+        if (!dst.equals_absolute(add, 1e-6f))
+            UTEST_FAIL_MSG("Block processing differs");
+
+        bank.destroy();
+    }
+
+    void test_ramping()
+    {
+        dspu::OscillatorBank bank;
+        UTEST_ASSERT(bank.init(1));
+        bank.set_sample_rate(SRATE);
+        bank.set_frequency(0, float(SRATE) / PERIOD);
+        bank.set_phase(0, 0.5f * M_PI);
+
+        // The amplitude should change linearly from 1 to 0 over the call
+        FloatBuffer dst(SAMPLES);
+        bank.process_overwrite(dst, SAMPLES);
+        bank.set_amplitude(0, 0.0f);
+        bank.process_overwrite(dst, SAMPLES);
+        UTEST_ASSERT(dst.valid());
+        for (size_t i=0; i<SAMPLES; ++i)
+        {
+            double v    = cos((2.0 * M_PI * (i % PERIOD)) / PERIOD) * (1.0 - double(i) / SAMPLES);
+            UTEST_ASSERT_MSG(float_equals_absolute(dst[i], v, 1e-4f),
+                "Ramped amplitude differs at %d: %f vs %f", int(i), dst[i], v);
+        }
+
+        bank.process_overwrite(dst, SAMPLES);
+        for (size_t i=0; i<SAMPLES; ++i)
+            UTEST_ASSERT(dst[i] == 0.0f);
+
+        bank.destroy();
+    }
+
+    UTEST_MAIN
+    {
+        test_partials();
+        test_ramping();
+    }
+
+UTEST_END
@@ -0,0 +1,207 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/util/Oversampler.h>
+#include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+using namespace lsp;
+
+#define SRATE           48000
+#define TEST_FREQ       1000.0f
+#define SAMPLES         8192
+
+namespace
+{
+    // Stage that multiplies the oversampled signal by the constant
+    class GainStage: public dspu::IOversamplerCallback
+    {
+        public:
+            float   fGain;
+
+        public:
+            explicit GainStage(float gain)  { fGain = gain; }
+
+            virtual void process(float *out, const float *in, size_t samples)
+            {
+                dsp::mul_k3(out, in, fGain, samples);
+            }
+    };
+}
+
+UTEST_BEGIN("dspu.util", oversampler)
+
+    void test_halfband(dspu::over_mode_t mode, size_t taps)
+    {
+        FloatBuffer in(SAMPLES);
+        FloatBuffer out(SAMPLES);
+
+        // Generate input data
+        float *src  = in.data();
+        float *dst  = out.data();
+        float w     = 2 * M_PI * TEST_FREQ / SRATE;
+        for (size_t i=0; i<SAMPLES; ++i)
+            src[i]      = sinf(w * i);
+        out.fill_zero();
+
+        // Initialize oversampler
+        dspu::Oversampler os;
+        UTEST_ASSERT(os.init());
+        os.set_sample_rate(SRATE);
+        os.set_mode(mode);
+        os.set_halfband_taps(taps);
+        if (os.modified())
+            os.update_settings();
+
+        UTEST_ASSERT(os.get_halfband_taps() == taps);
+        size_t latency = os.latency();
+        UTEST_ASSERT(latency <= os.max_latency());
+        printf("Testing mode=%d, taps=%d, oversampling=%d, latency=%d\n",
+            int(mode), int(taps), int(os.get_oversampling()), int(latency));
+
+        // Process data by chunks
+        for (size_t i=0; i<SAMPLES; )
+        {
+            size_t to_do = lsp_min(SAMPLES - i, size_t(1000));
+            os.process(&dst[i], &src[i], to_do);
+            i += to_do;
+        }
+        os.destroy();
+
+        UTEST_ASSERT(in.valid());
+        UTEST_ASSERT(out.valid());
+
+        // The output should be the delayed input, the latency of cascades
+        // is not integer, so the tolerance is relative to the half-sample shift
+        float tol   = (mode == dspu::OM_HALFBAND_2X) ? 1e-3f : w;
+        for (size_t i=latency*2; i<SAMPLES - latency; ++i)
+        {
+            if (!float_equals_absolute(src[i], dst[i + latency], tol))
+                UTEST_FAIL_MSG("Sample mismatch at index %d: %f vs %f", int(i), src[i], dst[i + latency]);
+        }
+    }
+
+    void test_chain(dspu::over_mode_t mode)
+    {
+        printf("Testing callback chain for mode=%d\n", int(mode));
+
+        FloatBuffer in(SAMPLES), out1(SAMPLES), out2(SAMPLES);
+        in.randomize_sign();
+
+        GainStage s1(2.0f), s2(3.0f), s3(6.0f);
+        dspu::Oversampler os1, os2;
+        dspu::Oversampler *os[2] = { &os1, &os2 };
+        for (size_t i=0; i<2; ++i)
+        {
+            UTEST_ASSERT(os[i]->init());
+            os[i]->set_sample_rate(SRATE);
+            os[i]->set_mode(mode);
+            os[i]->update_settings();
+        }
+
+        // The chain of two stages is equal to the single stage with the product of gains
+        os1.set_callback(&s1);
+        UTEST_ASSERT(os1.add_callback(&s3));
+        UTEST_ASSERT(os1.add_callback(&s2));
+        UTEST_ASSERT(os1.remove_callback(&s3));
+        UTEST_ASSERT(!os1.remove_callback(&s3));
+        UTEST_ASSERT(os1.callbacks() == 1);
+        os2.set_callback(&s3);
+
+        os1.process(out1, in, SAMPLES);
+        os2.process(out2, in, SAMPLES);
+        UTEST_ASSERT(out1.valid());
+        UTEST_ASSERT(out2.valid());
+
+        if (!out1.equals_absolute(out2, 1e-4f))
+        {
+            out1.dump("out1");
+            out2.dump("out2");
+            UTEST_FAIL_MSG("Chained callbacks differ from the single callback");
+        }
+
+        os1.destroy();
+        os2.destroy();
+    }
+
+    void test_transition(dspu::over_mode_t from, dspu::over_mode_t to)
+    {
+        printf("Testing transition from mode=%d to mode=%d\n", int(from), int(to));
+
+        FloatBuffer buf(SAMPLES);
+        float w     = 2 * M_PI * TEST_FREQ / SRATE;
+        for (size_t i=0; i<SAMPLES; ++i)
+            buf[i]      = sinf(w * i);
+
+        dspu::Oversampler os;
+        UTEST_ASSERT(os.init());
+        os.set_sample_rate(SRATE);
+        os.set_mode(from);
+        os.update_settings();
+        UTEST_ASSERT(!os.in_transition());
+
+        size_t half = SAMPLES / 2;
+        os.process(buf, buf, half);
+
+        // Switch the mode in the middle of the stream
+        size_t latency = os.latency();
+        os.set_mode(to);
+        os.update_settings();
+        UTEST_ASSERT(os.in_transition());
+        UTEST_ASSERT(os.transition_latency() == latency);
+        os.process(&buf[half], &buf[half], SAMPLES - half);
+        UTEST_ASSERT(!os.in_transition());
+        UTEST_ASSERT(os.transition_latency() == os.latency());
+        UTEST_ASSERT(buf.valid());
+
+        // There should be no dropouts after the initial latency
+        size_t start = lsp_max(latency, os.latency()) * 2;
+        for (size_t i=start + 1; i<SAMPLES; ++i)
+        {
+            float d     = fabsf(buf[i] - buf[i-1]);
+            UTEST_ASSERT_MSG(d < 2.0f * w, "Discontinuity at sample %d: %f -> %f", int(i), buf[i-1], buf[i]);
+        }
+
+        os.destroy();
+    }
+
+    UTEST_MAIN
+    {
+        test_halfband(dspu::OM_HALFBAND_2X, 31);
+        test_halfband(dspu::OM_HALFBAND_2X, 63);
+        test_halfband(dspu::OM_HALFBAND_4X, 31);
+        test_halfband(dspu::OM_HALFBAND_8X, 47);
+        test_halfband(dspu::OM_IIR_2X, 31);
+        test_halfband(dspu::OM_IIR_4X, 31);
+        test_halfband(dspu::OM_IIR_8X, 31);
+
+        test_chain(dspu::OM_NONE);
+        test_chain(dspu::OM_LANCZOS_4X3);
+        test_chain(dspu::OM_HALFBAND_8X);
+
+        test_transition(dspu::OM_HALFBAND_2X, dspu::OM_LANCZOS_4X3);
+        test_transition(dspu::OM_LANCZOS_2X2, dspu::OM_IIR_4X);
+        test_transition(dspu::OM_NONE, dspu::OM_HALFBAND_8X);
+    }
+UTEST_END;
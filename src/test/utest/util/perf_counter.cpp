@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/dsp-units/util/PerfCounter.h>
+
+UTEST_BEGIN("dspu.util", perf_counter)
+
+    UTEST_MAIN
+    {
+        dspu::PerfCounter pc;
+        dspu::perf_counters_t c;
+
+        pc.read(&c);
+        UTEST_ASSERT((c.nCalls == 0) && (c.nSamples == 0) && (c.nTime == 0) && (c.nReconfigs == 0));
+
+        // Account two calls and one reconfiguration
+        pc.reconfigured();
+        {
+            dspu::PerfScope scope(&pc, 256);
+        }
+        pc.processed(100, 1000);
+
+        pc.read(&c);
+        UTEST_ASSERT(c.nCalls == 2);
+        UTEST_ASSERT(c.nSamples == 356);
+        UTEST_ASSERT(c.nTime >= 1000);
+        UTEST_ASSERT(c.nReconfigs == 1);
+
+        pc.reset();
+        pc.read(&c);
+        UTEST_ASSERT((c.nCalls == 0) && (c.nSamples == 0) && (c.nTime == 0) && (c.nReconfigs == 0));
+    }
+
+UTEST_END
@@ -0,0 +1,218 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/util/ProcessGraph.h>
+#include <lsp-plug.in/dsp-units/util/Delay.h>
+#include <lsp-plug.in/dsp-units/util/WorkerPool.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#define SAMPLES         1000
+#define BUF_SIZE        64
+#define LATENCY         10
+#define CHAIN           8
+
+namespace
+{
+    using namespace lsp;
+
+    static void gain(void *object, void *subject, float * const *out, const float * const *in, size_t samples)
+    {
+        dsp::mul_k3(out[0], in[0], *static_cast<float *>(object), samples);
+    }
+
+    static void sum(void *object, void *subject, float * const *out, const float * const *in, size_t samples)
+    {
+        dsp::add3(out[0], in[0], in[1], samples);
+    }
+}
+
+UTEST_BEGIN("dspu.util", process_graph)
+
+    void test_latency()
+    {
+        printf("Testing latency compensation\n");
+
+        dspu::Delay delay;
+        UTEST_ASSERT(delay.init(LATENCY));
+        delay.set_delay(LATENCY);
+        float k         = 0.5f;
+
+        // in -> delay -> sum[0]
+        // in ----------> sum[1] -> out[0]
+        // in -> gain --------------> out[1]
+        dspu::ProcessGraph g;
+        ssize_t in      = g.add_input();
+        ssize_t o1      = g.add_output();
+        ssize_t o2      = g.add_output();
+        ssize_t nd      = g.add_unit(&delay, LATENCY);
+        ssize_t ns      = g.add_node(2, 1, sum, NULL, NULL);
+        ssize_t ng      = g.add_node(1, 1, gain, &k, NULL);
+        UTEST_ASSERT((in >= 0) && (o1 >= 0) && (o2 >= 0) && (nd >= 0) && (ns >= 0) && (ng >= 0));
+
+        UTEST_ASSERT(g.connect_input(in, nd, 0) == STATUS_OK);
+        UTEST_ASSERT(g.connect_input(in, ns, 1) == STATUS_OK);
+        UTEST_ASSERT(g.connect_input(in, ng, 0) == STATUS_OK);
+        UTEST_ASSERT(g.connect(nd, 0, ns, 0) == STATUS_OK);
+        UTEST_ASSERT(g.connect(nd, 0, ns, 1) == STATUS_ALREADY_BOUND);
+        UTEST_ASSERT(g.connect_output(ns, 0, o1) == STATUS_OK);
+        UTEST_ASSERT(g.connect_output(ng, 0, o2) == STATUS_OK);
+
+        UTEST_ASSERT(g.compile(BUF_SIZE) == STATUS_OK);
+        UTEST_ASSERT(g.latency() == LATENCY);
+
+        FloatBuffer src(SAMPLES), dst1(SAMPLES), dst2(SAMPLES);
+        src.randomize_sign();
+        float *out[2]   = { dst1.data(), dst2.data() };
+        const float *vin[1] = { src.data() };
+        g.process(out, vin, SAMPLES);
+
+        UTEST_ASSERT(dst1.valid());
+        UTEST_ASSERT(dst2.valid());
+        for (size_t i=0; i<SAMPLES; ++i)
+        {
+            float v1    = (i >= LATENCY) ? 2.0f * src[i - LATENCY] : 0.0f;
+            float v2    = (i >= LATENCY) ? k * src[i - LATENCY] : 0.0f;
+            UTEST_ASSERT_MSG(float_equals_absolute(dst1[i], v1), "Invalid sum at sample %d: %f vs %f", int(i), dst1[i], v1);
+            UTEST_ASSERT_MSG(float_equals_absolute(dst2[i], v2), "Invalid gain at sample %d: %f vs %f", int(i), dst2[i], v2);
+        }
+
+        g.destroy();
+        delay.destroy();
+    }
+
+    void test_buffers()
+    {
+        printf("Testing reuse of buffers\n");
+
+        float k[CHAIN];
+        dspu::ProcessGraph g;
+        ssize_t in      = g.add_input();
+        ssize_t out     = g.add_output();
+        ssize_t prev    = -1;
+        for (size_t i=0; i<CHAIN; ++i)
+        {
+            k[i]            = 1.0f + i * 0.125f;
+            ssize_t node    = g.add_node(1, 1, gain, &k[i], NULL);
+            UTEST_ASSERT(node >= 0);
+            if (prev < 0)
+                UTEST_ASSERT(g.connect_input(in, node, 0) == STATUS_OK);
+            else
+                UTEST_ASSERT(g.connect(prev, 0, node, 0) == STATUS_OK);
+            prev            = node;
+        }
+        UTEST_ASSERT(g.connect_output(prev, 0, out) == STATUS_OK);
+
+        // The chain needs only two buffers: the input and the output of the current node
+        UTEST_ASSERT(g.compile(BUF_SIZE) == STATUS_OK);
+        UTEST_ASSERT(g.buffers() == 2);
+        UTEST_ASSERT(g.latency() == 0);
+
+        FloatBuffer src(SAMPLES), dst(SAMPLES);
+        src.randomize_sign();
+        float *vout[1]  = { dst.data() };
+        const float *vin[1] = { src.data() };
+        g.process(vout, vin, SAMPLES);
+
+        float gk        = 1.0f;
+        for (size_t i=0; i<CHAIN; ++i)
+            gk             *= k[i];
+        for (size_t i=0; i<SAMPLES; ++i)
+            UTEST_ASSERT_MSG(float_equals_relative(dst[i], src[i] * gk), "Invalid sample %d: %f vs %f", int(i), dst[i], src[i] * gk);
+
+        // Cycles are not allowed
+        UTEST_ASSERT(g.connect(prev, 0, 0, 0) == STATUS_ALREADY_BOUND);
+        ssize_t a       = g.add_node(1, 1, gain, &k[0], NULL);
+        ssize_t b       = g.add_node(1, 1, gain, &k[0], NULL);
+        UTEST_ASSERT(g.connect(a, 0, b, 0) == STATUS_OK);
+        UTEST_ASSERT(g.connect(b, 0, a, 0) == STATUS_OK);
+        UTEST_ASSERT(!g.compiled());
+        UTEST_ASSERT(g.compile(BUF_SIZE) == STATUS_BAD_STATE);
+
+        g.destroy();
+    }
+
+    void test_parallel()
+    {
+        printf("Testing parallel processing of branches\n");
+
+        dspu::WorkerPool pool;
+        UTEST_ASSERT(pool.init(3) == STATUS_OK);
+        UTEST_ASSERT(pool.workers() == 3);
+
+        // Each branch: in -> gain -> gain -> out[i]
+        float k[CHAIN];
+        dspu::ProcessGraph g;
+        ssize_t in      = g.add_input();
+        for (size_t i=0; i<CHAIN; ++i)
+        {
+            k[i]            = 0.25f * (i + 1);
+            ssize_t out     = g.add_output();
+            ssize_t n1      = g.add_node(1, 1, gain, &k[i], NULL);
+            ssize_t n2      = g.add_node(1, 1, gain, &k[i], NULL);
+            UTEST_ASSERT((out >= 0) && (n1 >= 0) && (n2 >= 0));
+            UTEST_ASSERT(g.connect_input(in, n1, 0) == STATUS_OK);
+            UTEST_ASSERT(g.connect(n1, 0, n2, 0) == STATUS_OK);
+            UTEST_ASSERT(g.connect_output(n2, 0, out) == STATUS_OK);
+        }
+        g.set_workers(&pool);
+        UTEST_ASSERT(g.compile(BUF_SIZE) == STATUS_OK);
+        UTEST_ASSERT(g.levels() == 2);
+
+        FloatBuffer src(SAMPLES);
+        FloatBuffer *dst[CHAIN];
+        float *vout[CHAIN];
+        const float *vin[1] = { src.data() };
+        src.randomize_sign();
+        for (size_t i=0; i<CHAIN; ++i)
+        {
+            dst[i]          = new FloatBuffer(SAMPLES);
+            vout[i]         = dst[i]->data();
+        }
+
+        // Process many blocks to let the workers take part
+        for (size_t pass=0; pass<100; ++pass)
+            g.process(vout, vin, SAMPLES);
+
+        for (size_t i=0; i<CHAIN; ++i)
+        {
+            UTEST_ASSERT(dst[i]->valid());
+            float gk        = k[i] * k[i];
+            for (size_t j=0; j<SAMPLES; ++j)
+                UTEST_ASSERT_MSG(float_equals_relative(dst[i]->get(j), src[j] * gk),
+                    "Invalid sample %d of branch %d: %f vs %f", int(j), int(i), dst[i]->get(j), src[j] * gk);
+            delete dst[i];
+        }
+
+        g.destroy();
+        pool.destroy();
+    }
+
+    UTEST_MAIN
+    {
+        test_latency();
+        test_buffers();
+        test_parallel();
+    }
+
+UTEST_END
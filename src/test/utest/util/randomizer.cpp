@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/util/Randomizer.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define SEED        0x5eed1234
+#define SAMPLES     0x100000
+#define LAMBDA      (M_E * M_SQRT2)
+#define RAND_RANGE  2.32830643654e-10 /* 1 / (1 << 32) */
+
+UTEST_BEGIN("dspu.util", randomizer)
+
+    void test_sequence(const char *label, dspu::random_function_t func, float tol)
+    {
+        static const size_t blocks[] = { 1, 3, 7, 300, 4, 2, 1000, 17 };
+
+        printf("Testing block generation of %s numbers\n", label);
+
+        dspu::Randomizer r1, r2;
+        r1.init(SEED);
+        r2.init(SEED);
+
+        // Blocks of odd sizes check the switch between the scalar and parallel generation
+        FloatBuffer dst(SAMPLES);
+        for (size_t offset=0, i=0; offset < SAMPLES; ++i)
+        {
+            size_t to_do    = lsp_min(size_t(SAMPLES) - offset, blocks[i % (sizeof(blocks)/sizeof(size_t))]);
+            r2.random(&dst[offset], to_do, func);
+            offset         += to_do;
+        }
+        UTEST_ASSERT_MSG(dst.valid(), "Destination buffer corrupted");
+
+        for (size_t i=0; i<SAMPLES; ++i)
+        {
+            float v = r1.random(func);
+            if (!float_equals_absolute(dst[i], v, tol))
+                UTEST_FAIL_MSG("Invalid %s number %d: %f, expected %f", label, int(i), dst[i], v);
+        }
+    }
+
+    void test_moments(const char *label, dspu::random_function_t func, double mean, double var)
+    {
+        printf("Testing statistics of %s numbers\n", label);
+
+        dspu::Randomizer r;
+        r.init(SEED);
+
+        FloatBuffer dst(SAMPLES);
+        r.random(dst, SAMPLES, func);
+
+        double s1 = 0.0, s2 = 0.0;
+        for (size_t i=0; i<SAMPLES; ++i)
+            s1     += dst[i];
+        s1         /= SAMPLES;
+        for (size_t i=0; i<SAMPLES; ++i)
+            s2     += (dst[i] - s1) * (dst[i] - s1);
+        s2         /= SAMPLES - 1;
+
+        printf("  mean = %f (expected %f), variance = %f (expected %f)\n", s1, mean, s2, var);
+
+        // The standard error of the mean is sqrt(var / SAMPLES) ~ 1e-3 * sqrt(var)
+        UTEST_ASSERT_MSG(fabs(s1 - mean) < 5e-3 * sqrt(var), "Mean of %s numbers is out of range", label);
+        UTEST_ASSERT_MSG(fabs(s2 - var) < 1e-2 * var, "Variance of %s numbers is out of range", label);
+    }
+
+    void test_counter(const char *label, dspu::random_function_t func, float tol)
+    {
+        static const size_t parts[] = { 1, 5, 0x1000, 3, 0x3ff3, 17, 0x800 };
+
+        printf("Testing counter-based generation of %s numbers\n", label);
+
+        dspu::Randomizer r1, r2;
+        r1.init_counter(SEED, 1);
+
+        FloatBuffer ref(SAMPLES), dst(SAMPLES);
+        r1.random(ref, SAMPLES, func);
+
+        // Each part is generated by its own generator as if it was computed by a separate thread
+        for (size_t offset=0, i=0; offset < SAMPLES; ++i)
+        {
+            size_t to_do    = lsp_min(size_t(SAMPLES) - offset, parts[i % (sizeof(parts)/sizeof(size_t))]);
+            r2.init_counter(SEED, 1);
+            UTEST_ASSERT(r2.seek(offset, func));
+            r2.random(&dst[offset], to_do, func);
+            offset         += to_do;
+        }
+        UTEST_ASSERT_MSG(dst.valid(), "Destination buffer corrupted");
+
+        // The words are bit-identical, vectorized math may differ slightly at the boundaries of parts
+        for (size_t i=0; i<SAMPLES; ++i)
+            if (!float_equals_absolute(dst[i], ref[i], tol))
+                UTEST_FAIL_MSG("Invalid %s number %d: %f, expected %f", label, int(i), dst[i], ref[i]);
+
+        // Random access by single numbers
+        for (size_t i=0; i<0x100; ++i)
+        {
+            size_t index    = (i * 0x1e3d) % SAMPLES;
+            r2.seek(index, func);
+            float v         = r2.random(func);
+            if (!float_equals_absolute(v, ref[index], 1e-3f))
+                UTEST_FAIL_MSG("Invalid %s number %d: %f, expected %f", label, int(index), v, ref[index]);
+        }
+    }
+
+    void test_streams()
+    {
+        printf("Testing counter-based streams\n");
+
+        // Known answer of Philox4x32-10 for the zero key and the zero counter
+        static const uint32_t kat[] = { 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 };
+
+        dspu::Randomizer r1, r2;
+        r1.init_counter(0, 0);
+        UTEST_ASSERT(r1.counter_based());
+        for (size_t i=0; i<4; ++i)
+            UTEST_ASSERT(r1.random(dspu::RND_LINEAR) == float(kat[i] * RAND_RANGE));
+
+        // Different streams should differ, sequential generator does not seek
+        r1.init_counter(SEED, 0);
+        r2.init_counter(SEED, 1);
+        size_t equal = 0;
+        for (size_t i=0; i<0x100; ++i)
+            if (r1.random(dspu::RND_LINEAR) == r2.random(dspu::RND_LINEAR))
+                ++equal;
+        UTEST_ASSERT(equal < 4);
+
+        r2.init(SEED);
+        UTEST_ASSERT(!r2.counter_based());
+        UTEST_ASSERT(!r2.seek(10));
+    }
+
+    UTEST_MAIN
+    {
+        test_sequence("linear", dspu::RND_LINEAR, 1e-7f);
+        test_sequence("exponential", dspu::RND_EXP, 1e-5f);
+        test_sequence("triangle", dspu::RND_TRIANGLE, 1e-6f);
+        test_sequence("gaussian", dspu::RND_GAUSSIAN, 1e-3f);
+
+        // Exponential: u = (exp(L*x) - 1) / (exp(L) - 1) for uniform x
+        double el   = exp(LAMBDA) - 1.0;
+        double m1   = ((exp(LAMBDA) - 1.0) / LAMBDA - 1.0) / el;
+        double m2   = ((exp(2.0 * LAMBDA) - 1.0) / (2.0 * LAMBDA) - 2.0 * (exp(LAMBDA) - 1.0) / LAMBDA + 1.0) / (el * el);
+
+        test_moments("linear", dspu::RND_LINEAR, 0.5, 1.0 / 12.0);
+        test_moments("exponential", dspu::RND_EXP, m1, m2 - m1*m1);
+        test_moments("triangle", dspu::RND_TRIANGLE, 0.5, 1.0 / 24.0);
+        test_moments("gaussian", dspu::RND_GAUSSIAN, 0.0, 1.0);
+
+        test_counter("linear", dspu::RND_LINEAR, 1e-7f);
+        test_counter("exponential", dspu::RND_EXP, 1e-5f);
+        test_counter("gaussian", dspu::RND_GAUSSIAN, 1e-5f);
+        test_streams();
+    }
+
+UTEST_END
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/util/Resampler.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define SAMPLES     0x5000
+
+UTEST_BEGIN("dspu.util", resampler)
+
+    void test_sine(size_t in_rate, size_t out_rate, size_t quality, double freq, float tol)
+    {
+        static const size_t blocks[] = { 1, 7, 300, 13, 1000, 256, 3, 0 };
+
+        printf("Testing %d -> %d resampling of %.1f Hz sine, quality=%d\n",
+            int(in_rate), int(out_rate), freq, int(quality));
+
+        dspu::Resampler rs;
+        UTEST_ASSERT(rs.init(in_rate, out_rate, quality));
+
+        FloatBuffer src(SAMPLES);
+        for (size_t i=0; i<SAMPLES; ++i)
+            src[i]      = sin(2.0 * M_PI * freq * i / in_rate);
+
+        // Process by blocks of odd sizes, the empty block should be allowed too
+        size_t cap      = rs.max_output(SAMPLES) + 1000;
+        FloatBuffer dst(cap);
+        size_t n        = 0;
+        for (size_t offset=0, i=0; offset < SAMPLES; ++i)
+        {
+            size_t to_do    = lsp_min(size_t(SAMPLES) - offset, blocks[i % (sizeof(blocks)/sizeof(size_t))]);
+            size_t limit    = rs.max_output(to_do);
+            UTEST_ASSERT(n + limit <= cap);
+            size_t count    = rs.process(&dst[n], &src[offset], to_do);
+            UTEST_ASSERT_MSG(count <= limit, "Output count %d exceeds the limit %d", int(count), int(limit));
+            offset         += to_do;
+            n              += count;
+        }
+        UTEST_ASSERT(dst.valid());
+
+        // The number of output samples should follow the ratio
+        double step     = double(in_rate) / double(out_rate);
+        double expected = (SAMPLES - rs.latency()) / step;
+        UTEST_ASSERT_MSG(fabs(n - expected) <= 2.0, "Produced %d samples, expected %f", int(n), expected);
+
+        // Output sample m matches the input signal at the position m * step,
+        // skip the samples affected by the zero history
+        size_t skip     = (2 * rs.latency() * out_rate) / in_rate + 1;
+        for (size_t m = skip; m < n; ++m)
+        {
+            float v = sin(2.0 * M_PI * freq * (m * step) / in_rate);
+            UTEST_ASSERT_MSG(float_equals_absolute(dst[m], v, tol),
+                "Invalid output sample %d: %f, expected %f", int(m), dst[m], v);
+        }
+    }
+
+    void test_drift()
+    {
+        printf("Testing drift compensation\n");
+
+        dspu::Resampler r1, r2;
+        UTEST_ASSERT(r1.init(48000, 48000));
+        UTEST_ASSERT(r2.init(48000, 48000));
+        r2.set_drift(1.01f);
+        UTEST_ASSERT(float_equals_absolute(r2.drift(), 1.01f));
+
+        // The drift is limited
+        r1.set_drift(2.0f);
+        UTEST_ASSERT(r1.drift() <= 1.0f + RESAMPLER_DRIFT_MAX);
+        r1.set_drift(1.0f);
+
+        FloatBuffer src(SAMPLES), dst(SAMPLES * 2);
+        src.randomize_sign();
+        size_t n1       = r1.process(dst, src, SAMPLES);
+        size_t n2       = r2.process(dst, src, SAMPLES);
+        UTEST_ASSERT(dst.valid());
+
+        // The increased ratio produces more samples
+        printf("  unity output = %d, adjusted output = %d\n", int(n1), int(n2));
+        UTEST_ASSERT(n2 > n1);
+        UTEST_ASSERT(fabs(double(n2) / double(n1) - 1.01) < 1e-3);
+
+        // Clear drops the state
+        r1.clear();
+        UTEST_ASSERT(r1.process(dst, src, SAMPLES) == n1);
+    }
+
+    UTEST_MAIN
+    {
+        test_sine(44100, 48000, RESAMPLER_QUALITY_DFL, 1000.0, 2e-3f);
+        test_sine(48000, 44100, RESAMPLER_QUALITY_DFL, 1000.0, 2e-3f);
+        test_sine(48000, 44100, RESAMPLER_QUALITY_DFL, 15000.0, 5e-3f);
+        test_sine(96000, 8000, RESAMPLER_QUALITY_DFL, 500.0, 2e-3f);
+        test_sine(44100, 48000, RESAMPLER_QUALITY_MAX, 10000.0, 1e-3f);
+        test_drift();
+    }
+
+UTEST_END
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/util/SharedDelay.h>
+#include <lsp-plug.in/dsp-units/dynamics/Compressor.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#define SRATE       48000
+#define SAMPLES     0x2000
+#define DELAY       777
+#define MAX_DELAY   1000
+
+UTEST_BEGIN("dspu.util", shared_delay)
+
+    void test_delay()
+    {
+        static const size_t blocks[] = { 1, 7, 300, 13, 1000, 256, 3, 2000 };
+
+        printf("Testing shared delay line\n");
+
+        FloatBuffer src1(SAMPLES), src2(SAMPLES), gain(SAMPLES);
+        FloatBuffer dst1(SAMPLES), dst2(SAMPLES);
+        src1.randomize_sign();
+        src2.randomize_sign();
+        gain.randomize(0.0f, 1.0f);
+
+        dspu::SharedDelay d;
+        UTEST_ASSERT(d.init(2, MAX_DELAY));
+        d.set_delay(MAX_DELAY + 1);
+        UTEST_ASSERT(d.delay() == MAX_DELAY);
+        d.set_delay(DELAY);
+
+        // Process in place by blocks of odd sizes
+        dsp::copy(dst1, src1, SAMPLES);
+        dsp::copy(dst2, src2, SAMPLES);
+        for (size_t offset=0, i=0; offset < SAMPLES; ++i)
+        {
+            size_t to_do        = lsp_min(size_t(SAMPLES) - offset, blocks[i % (sizeof(blocks)/sizeof(size_t))]);
+            float *vdst[2]      = { &dst1[offset], &dst2[offset] };
+            const float *vsrc[2]= { &dst1[offset], &dst2[offset] };
+            d.process(vdst, vsrc, &gain[offset], to_do);
+            offset             += to_do;
+        }
+        UTEST_ASSERT(dst1.valid());
+        UTEST_ASSERT(dst2.valid());
+
+        for (size_t i=0; i<SAMPLES; ++i)
+        {
+            float s1    = (i >= DELAY) ? src1[i - DELAY] * gain[i] : 0.0f;
+            float s2    = (i >= DELAY) ? src2[i - DELAY] * gain[i] : 0.0f;
+            UTEST_ASSERT_MSG(float_equals_absolute(dst1[i], s1) && float_equals_absolute(dst2[i], s2),
+                "Invalid sample %d: %f, %f expected %f, %f", int(i), dst1[i], dst2[i], s1, s2);
+        }
+    }
+
+    void test_compressor()
+    {
+        printf("Testing compressor lookahead\n");
+
+        FloatBuffer src(SAMPLES), sc(SAMPLES), dst(SAMPLES), gain(SAMPLES);
+        src.randomize_sign();
+        dsp::abs2(sc, src, SAMPLES);
+
+        dspu::Compressor c;
+        UTEST_ASSERT(c.init(1, SRATE, 20.0f));
+        c.set_sample_rate(SRATE);
+        c.set_threshold(0.1f, 0.05f);
+        c.set_timings(1.0f, 10.0f);
+        c.set_ratio(4.0f);
+        c.set_knee(0.5f);
+        c.set_lookahead(5.0f);
+        c.update_settings();
+        UTEST_ASSERT(c.latency() == size_t(5.0f * SRATE * 0.001f));
+
+        float *vdst[1]          = { dst };
+        const float *vsrc[1]    = { src };
+        c.process(vdst, gain, NULL, vsrc, sc, SAMPLES);
+        UTEST_ASSERT(dst.valid());
+
+        size_t latency          = c.latency();
+        for (size_t i=0; i<SAMPLES; ++i)
+        {
+            float s     = (i >= latency) ? src[i - latency] * gain[i] : 0.0f;
+            UTEST_ASSERT_MSG(float_equals_absolute(dst[i], s), "Invalid sample %d: %f expected %f", int(i), dst[i], s);
+        }
+    }
+
+    UTEST_MAIN
+    {
+        test_delay();
+        test_compressor();
+    }
+
+UTEST_END
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/util/ShiftBuffer.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define GAP         300
+#define SIZE        1000
+#define STEPS       200
+
+UTEST_BEGIN("dspu.util", shift_buffer)
+
+    void compare(dspu::ShiftBuffer *sb, dspu::ShiftBuffer *rb, size_t step)
+    {
+        UTEST_ASSERT_MSG(sb->size() == rb->size(), "step %d: sizes differ: %d vs %d",
+            int(step), int(sb->size()), int(rb->size()));
+
+        size_t size = sb->size();
+        const float *h1 = sb->head(), *h2 = rb->head();
+        for (size_t i=0; i<size; ++i)
+        {
+            UTEST_ASSERT_MSG(h1[i] == h2[i], "step %d: sample %d differs: %f vs %f",
+                int(step), int(i), h1[i], h2[i]);
+        }
+
+        if (size > 0)
+        {
+            UTEST_ASSERT(sb->first() == rb->first());
+            UTEST_ASSERT(sb->last() == rb->last());
+            UTEST_ASSERT(rb->tail(size) == rb->head());
+            UTEST_ASSERT(sb->last(size) == rb->last(size));
+        }
+    }
+
+    UTEST_MAIN
+    {
+        dspu::ShiftBuffer sb, rb;
+        FloatBuffer src(SIZE), dst1(SIZE), dst2(SIZE);
+
+        UTEST_ASSERT(sb.init(SIZE, GAP));
+        UTEST_ASSERT(rb.init(SIZE, GAP, true));
+        UTEST_ASSERT(rb.ring());
+        UTEST_ASSERT(rb.capacity() >= SIZE);
+        compare(&sb, &rb, 0);
+
+        // Random sequence of appends and shifts
+        srand(0);
+        float value = 0.0f;
+        for (size_t step=1; step <= STEPS; ++step)
+        {
+            size_t count    = rand() % (SIZE / 2);
+            for (size_t i=0; i<count; ++i)
+                src[i]          = (value += 1.0f);
+
+            size_t n1       = sb.append(src, count);
+            size_t n2       = rb.append(src, n1);
+            UTEST_ASSERT(n1 == n2);
+            compare(&sb, &rb, step);
+
+            // Single sample operations
+            if (sb.size() < sb.capacity())
+                UTEST_ASSERT(sb.append(value + 0.5f) == rb.append(value + 0.5f));
+            UTEST_ASSERT(sb.shift() == rb.shift());
+
+            count           = rand() % (SIZE / 2);
+            n1              = sb.shift(dst1, count);
+            n2              = rb.shift(dst2, count);
+            UTEST_ASSERT(n1 == n2);
+            for (size_t i=0; i<n1; ++i)
+                UTEST_ASSERT(dst1[i] == dst2[i]);
+            compare(&sb, &rb, step);
+        }
+
+        // Resize both buffers
+        UTEST_ASSERT(sb.resize(SIZE * 2, GAP * 2));
+        UTEST_ASSERT(rb.resize(SIZE * 2, GAP * 2));
+        compare(&sb, &rb, STEPS + 1);
+        UTEST_ASSERT(sb.resize(SIZE, GAP / 2));
+        UTEST_ASSERT(rb.resize(SIZE, GAP / 2));
+        compare(&sb, &rb, STEPS + 2);
+    }
+
+UTEST_END
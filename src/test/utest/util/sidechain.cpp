@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/util/Sidechain.h>
+
+#define SRATE       48000
+#define SAMPLES     10000
+#define BLOCK       731     /* Not multiple of the batch size */
+
+UTEST_BEGIN("dspu.util", sidechain)
+
+    void test_mode(size_t channels, size_t mode, size_t source, const char *name)
+    {
+        dspu::Sidechain sc1, sc2;
+        FloatBuffer left(SAMPLES), right(SAMPLES), out1(SAMPLES), out2(SAMPLES);
+        left.randomize(-1.0f, 1.0f);
+        right.randomize(-1.0f, 1.0f);
+
+        dspu::Sidechain *sc[2] = { &sc1, &sc2 };
+        for (size_t i=0; i<2; ++i)
+        {
+            UTEST_ASSERT(sc[i]->init(channels, 40.0f));
+            sc[i]->set_sample_rate(SRATE);
+            sc[i]->set_mode(mode);
+            sc[i]->set_source(source);
+            sc[i]->set_reactivity(10.0f);
+            sc[i]->set_gain(2.0f);
+        }
+
+        // Block processing
+        for (size_t offset=0; offset < SAMPLES; offset += BLOCK)
+        {
+            size_t to_do    = lsp_min(SAMPLES - offset, size_t(BLOCK));
+            const float *in[2] = { &left[offset], &right[offset] };
+            sc1.process(&out1[offset], in, to_do);
+        }
+
+        // Sample processing
+        for (size_t i=0; i<SAMPLES; ++i)
+        {
+            float in[2] = { left[i], right[i] };
+            out2[i]         = sc2.process(in);
+        }
+
+        UTEST_ASSERT(out1.valid());
+        if (!out1.equals_absolute(out2, 1e-4f))
+        {
+            out1.dump("out1");
+            out2.dump("out2");
+            UTEST_FAIL_MSG("%s: block and sample processing differ", name);
+        }
+    }
+
+    UTEST_MAIN
+    {
+        test_mode(1, dspu::SCM_RMS, dspu::SCS_MIDDLE, "mono rms");
+        test_mode(1, dspu::SCM_UNIFORM, dspu::SCS_MIDDLE, "mono uniform");
+        test_mode(1, dspu::SCM_LPF, dspu::SCS_MIDDLE, "mono lpf");
+        test_mode(2, dspu::SCM_RMS, dspu::SCS_MIDDLE, "stereo middle rms");
+        test_mode(2, dspu::SCM_RMS, dspu::SCS_SIDE, "stereo side rms");
+        test_mode(2, dspu::SCM_UNIFORM, dspu::SCS_LEFT, "stereo left uniform");
+        test_mode(2, dspu::SCM_UNIFORM, dspu::SCS_RIGHT, "stereo right uniform");
+    }
+
+UTEST_END
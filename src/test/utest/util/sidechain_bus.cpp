@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/util/SidechainBus.h>
+#include <lsp-plug.in/dsp-units/dynamics/Compressor.h>
+#include <lsp-plug.in/dsp-units/dynamics/Gate.h>
+#include <lsp-plug.in/dsp-units/const.h>
+#include <lsp-plug.in/dsp-units/units.h>
+
+#define SRATE       48000
+#define SAMPLES     10000
+#define CAPACITY    512
+#define BLOCK       731     /* Greater than the capacity of the bus */
+
+UTEST_BEGIN("dspu.util", sidechain_bus)
+
+    void setup_sidechain(dspu::Sidechain *sc)
+    {
+        UTEST_ASSERT(sc->init(2, 40.0f));
+        sc->set_sample_rate(SRATE);
+        sc->set_mode(dspu::SCM_RMS);
+        sc->set_source(dspu::SCS_MIDDLE);
+        sc->set_reactivity(10.0f);
+        sc->set_gain(2.0f);
+    }
+
+    void setup_dynamics(dspu::Compressor *c, dspu::Gate *g)
+    {
+        c->set_sample_rate(SRATE);
+        c->set_mode(dspu::CM_DOWNWARD);
+        c->set_threshold(GAIN_AMP_M_24_DB, 0.5f);
+        c->set_timings(5.0f, 50.0f);
+        c->set_knee(GAIN_AMP_M_6_DB);
+        c->set_ratio(4.0f);
+        c->update_settings();
+
+        g->set_sample_rate(SRATE);
+        g->set_threshold(GAIN_AMP_M_24_DB, GAIN_AMP_M_36_DB);
+        g->set_zone(GAIN_AMP_M_12_DB, GAIN_AMP_M_12_DB);
+        g->set_reduction(GAIN_AMP_M_48_DB);
+        g->set_timings(5.0f, 50.0f);
+        g->update_settings();
+    }
+
+    UTEST_MAIN
+    {
+        FloatBuffer left(SAMPLES), right(SAMPLES);
+        FloatBuffer c1(SAMPLES), g1(SAMPLES), c2(SAMPLES), g2(SAMPLES), sc(SAMPLES), env(SAMPLES);
+        left.randomize(-1.0f, 1.0f);
+        right.randomize(-1.0f, 1.0f);
+
+        // Reference: each dynamics processor has its own sidechain
+        dspu::Sidechain sc_c, sc_g;
+        dspu::Compressor comp1, comp2;
+        dspu::Gate gate1, gate2;
+        setup_sidechain(&sc_c);
+        setup_sidechain(&sc_g);
+        setup_dynamics(&comp1, &gate1);
+        setup_dynamics(&comp2, &gate2);
+
+        for (size_t offset=0; offset < SAMPLES; offset += BLOCK)
+        {
+            size_t to_do        = lsp_min(SAMPLES - offset, size_t(BLOCK));
+            const float *in[2]  = { &left[offset], &right[offset] };
+
+            sc_c.process(&sc[offset], in, to_do);
+            comp1.process(&c1[offset], NULL, &sc[offset], to_do);
+            sc_g.process(&sc[offset], in, to_do);
+            gate1.process(&g1[offset], NULL, &sc[offset], to_do);
+        }
+
+        // The bus computes the sidechain once for both processors
+        dspu::SidechainBus bus;
+        UTEST_ASSERT(bus.init(2, 40.0f, CAPACITY));
+        bus.set_sample_rate(SRATE);
+        bus.set_mode(dspu::SCM_RMS);
+        bus.set_source(dspu::SCS_MIDDLE);
+        bus.set_reactivity(10.0f);
+        bus.set_gain(2.0f);
+        UTEST_ASSERT(bus.capacity() == CAPACITY);
+
+        for (size_t offset=0, block=0; offset < SAMPLES; )
+        {
+            size_t to_do        = lsp_min(SAMPLES - offset, size_t(BLOCK));
+            const float *in[2]  = { &left[offset], &right[offset] };
+
+            size_t n            = bus.process(in, to_do);
+            UTEST_ASSERT(n == lsp_min(to_do, size_t(CAPACITY)));
+            UTEST_ASSERT(bus.samples() == n);
+            UTEST_ASSERT(bus.block() == ++block);
+
+            bus.apply(&comp2, &c2[offset], &env[offset]);
+            bus.apply(&gate2, &g2[offset], NULL);
+            offset             += n;
+        }
+
+        UTEST_ASSERT(c1.valid() && g1.valid() && c2.valid() && g2.valid() && env.valid());
+        if (!c1.equals_absolute(c2, 1e-4f))
+        {
+            c1.dump("c1");
+            c2.dump("c2");
+            UTEST_FAIL_MSG("Compressor gain differs");
+        }
+        if (!g1.equals_absolute(g2, 1e-4f))
+        {
+            g1.dump("g1");
+            g2.dump("g2");
+            UTEST_FAIL_MSG("Gate gain differs");
+        }
+    }
+
+UTEST_END
@@ -32,6 +32,25 @@ using namespace lsp;
 #define TEST_FREQ       440.0f
 #define SAMPLES         8192
 
+namespace
+{
+    typedef struct handler_t
+    {
+        float       fGain;          // Gain applied to the spectrum
+        size_t      nCalls;         // Number of calls
+        size_t     *pOrder;         // Order counter shared by handlers
+        size_t      nOrder;         // Order of the last call
+    } handler_t;
+
+    void apply_gain(void *object, void *subject, float *spectrum, size_t rank)
+    {
+        handler_t *h    = static_cast<handler_t *>(object);
+        dsp::mul_k2(spectrum, h->fGain, 2 << rank);
+        ++h->nCalls;
+        h->nOrder       = (*h->pOrder)++;
+    }
+}
+
 UTEST_BEGIN("dspu.util", spectral_proc)
 
     void test_simple()
@@ -66,8 +85,106 @@ UTEST_BEGIN("dspu.util", spectral_proc)
             UTEST_ASSERT(float_equals_absolute(src[i], dst[latency+i], 1e-5f));
     }
 
+    void test_overlap(float overlap)
+    {
+        FloatBuffer in(SAMPLES);
+        FloatBuffer out(SAMPLES);
+
+        // Generate input data
+        float *src  = in.data();
+        float w     = 2 * M_PI * TEST_FREQ / SRATE;
+        for (size_t i=0; i<SAMPLES; ++i)
+            src[i]      = sinf(w * i);
+        out.fill_zero();
+
+        // Create processor
+        dspu::SpectralProcessor sp;
+        sp.init(14);
+        sp.set_phase(0.0f);
+        sp.set_rank(8);
+        sp.set_overlap(overlap);
+
+        printf("Testing overlap=%.3f...\n", overlap);
+
+        // Process data by small chunks
+        float *dst  = out.data();
+        for (size_t i=0; i<SAMPLES; )
+        {
+            size_t to_do = lsp_min(SAMPLES - i, size_t(100));
+            sp.process(&dst[i], &src[i], to_do);
+            i += to_do;
+        }
+
+        UTEST_ASSERT(in.valid());
+        UTEST_ASSERT(out.valid());
+        UTEST_ASSERT(sp.hop() == size_t((1 << 8) * (1.0f - overlap)));
+
+        // Compare data
+        size_t latency = sp.latency();
+        for (size_t i=0; i<SAMPLES-latency; ++i)
+        {
+            if (!float_equals_absolute(src[i], dst[latency+i], 1e-5f))
+                UTEST_FAIL_MSG("Sample mismatch at index %d: %f vs %f", int(i), src[i], dst[latency+i]);
+        }
+    }
+
+    void test_chain()
+    {
+        printf("Testing chain of handlers...\n");
+
+        FloatBuffer in(SAMPLES);
+        FloatBuffer out(SAMPLES);
+
+        float *src  = in.data();
+        float w     = 2 * M_PI * TEST_FREQ / SRATE;
+        for (size_t i=0; i<SAMPLES; ++i)
+            src[i]      = sinf(w * i);
+        out.fill_zero();
+
+        size_t order = 0;
+        handler_t h1 = { 0.5f, 0, &order, 0 };
+        handler_t h2 = { 3.0f, 0, &order, 0 };
+        handler_t h3 = { 10.0f, 0, &order, 0 };
+
+        dspu::SpectralProcessor sp;
+        sp.init(14);
+        sp.set_phase(0.0f);
+        sp.set_rank(8);
+        UTEST_ASSERT(!sp.add(NULL, NULL, NULL));
+        sp.bind(apply_gain, &h3, NULL);
+        UTEST_ASSERT(sp.handlers() == 1);
+        sp.bind(apply_gain, &h1, NULL);
+        UTEST_ASSERT(sp.add(apply_gain, &h3, NULL));
+        UTEST_ASSERT(sp.add(apply_gain, &h2, NULL));
+        UTEST_ASSERT(sp.remove(apply_gain, &h3, NULL));
+        UTEST_ASSERT(!sp.remove(apply_gain, &h3, NULL));
+        UTEST_ASSERT(sp.handlers() == 2);
+
+        float *dst  = out.data();
+        sp.process(dst, src, SAMPLES);
+        UTEST_ASSERT(out.valid());
+
+        // Both handlers process each frame in the order of binding with the latency of one transform
+        UTEST_ASSERT(h1.nCalls > 0);
+        UTEST_ASSERT(h1.nCalls == h2.nCalls);
+        UTEST_ASSERT(h3.nCalls == 0);
+        UTEST_ASSERT(h1.nOrder + 1 == h2.nOrder);
+
+        size_t latency = sp.latency();
+        for (size_t i=0; i<SAMPLES-latency; ++i)
+        {
+            if (!float_equals_absolute(1.5f * src[i], dst[latency+i], 1e-5f))
+                UTEST_FAIL_MSG("Sample mismatch at index %d: %f vs %f", int(i), 1.5f * src[i], dst[latency+i]);
+        }
+    }
+
     UTEST_MAIN
     {
         test_simple();
+        test_overlap(0.25f);
+        test_overlap(0.5f);
+        test_overlap(0.75f);
+        test_overlap(0.875f);
+        test_chain();
     }
 UTEST_END;
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 14 окт. 2021 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/util/SwitchedConvolver.h>
+#include <lsp-plug.in/dsp/dsp.h>
+
+#define SAMPLE_RATE     48000
+#define BUF_SIZE        0x1000
+
+UTEST_BEGIN("dspu.util", switched_convolver)
+
+    void process(dspu::SwitchedConvolver &c, float *dst, const float *src, size_t count, size_t step)
+    {
+        for (size_t i=0; i<count; )
+        {
+            size_t todo = lsp_min(count - i, step);
+            c.process(&dst[i], &src[i], todo);
+            i          += todo;
+        }
+    }
+
+    UTEST_MAIN
+    {
+        dspu::SwitchedConvolver c;
+        FloatBuffer src(BUF_SIZE);
+        FloatBuffer dst(BUF_SIZE);
+        float ir1[1]    = { 1.0f };
+        float ir2[1]    = { 0.5f };
+
+        dsp::fill_one(src, BUF_SIZE);
+        dst.fill_zero();
+
+        UTEST_ASSERT(c.init(SAMPLE_RATE, 0.005f));
+        UTEST_ASSERT(c.idle());
+
+        // Switch to the first impulse response
+        UTEST_ASSERT(c.prepare(ir1, 1, 10, 0.0f));
+        UTEST_ASSERT(c.prepared());
+        UTEST_ASSERT(!c.prepare(ir2, 1, 10, 0.0f));
+        UTEST_ASSERT(c.commit());
+        UTEST_ASSERT(c.idle());
+        UTEST_ASSERT(c.crossfading());
+        process(c, dst, src, BUF_SIZE, 63);
+        UTEST_ASSERT(!c.crossfading());
+        UTEST_ASSERT(float_equals_absolute(dst[BUF_SIZE - 1], 1.0f, 1e-5f));
+
+        // Switch to the second impulse response
+        UTEST_ASSERT(c.prepare(ir2, 1, 10, 0.0f));
+        UTEST_ASSERT(c.commit());
+        UTEST_ASSERT(!c.commit());
+        process(c, dst, src, BUF_SIZE, 63);
+        UTEST_ASSERT_MSG(dst.valid(), "Destination buffer corrupted");
+
+        // The output should smoothly go from 1.0 to 0.5 and stay at 0.5
+        for (size_t i=1; i<BUF_SIZE; ++i)
+        {
+            if ((dst[i] > dst[i-1] + 1e-5f) || (dst[i] < 0.5f - 1e-5f))
+                UTEST_FAIL_MSG("Invalid crossfade at sample=%d: %.5f vs %.5f", int(i), dst[i-1], dst[i]);
+        }
+        UTEST_ASSERT(float_equals_absolute(dst[BUF_SIZE - 1], 0.5f, 1e-5f));
+
+        c.destroy();
+    }
+UTEST_END;
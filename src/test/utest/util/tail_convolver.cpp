@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/util/TailConvolver.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define IR_SIZE         0x3000
+#define SRC_SIZE        0x2000
+#define SPLIT           0x800
+
+UTEST_BEGIN("dspu.util", tail_convolver)
+
+    void process(dspu::TailConvolver &c, float *dst, const float *src, size_t count)
+    {
+        static const size_t blocks[] = { 1, 31, 7, 256, 100, 3, 1000 };
+        for (size_t offset=0, i=0; offset < count; ++i)
+        {
+            size_t to_do    = lsp_min(count - offset, blocks[i % (sizeof(blocks)/sizeof(size_t))]);
+            c.process(&dst[offset], &src[offset], to_do);
+            offset         += to_do;
+        }
+    }
+
+    double snr(const float *ref, const float *out, size_t count)
+    {
+        double sig = 0.0, err = 0.0;
+        for (size_t i=0; i<count; ++i)
+        {
+            double d    = ref[i] - out[i];
+            sig        += ref[i] * ref[i];
+            err        += d * d;
+        }
+        return 10.0 * log10(sig / lsp_max(err, 1e-30));
+    }
+
+    void test_factor(size_t factor, double snr_min)
+    {
+        printf("Testing decimated tail convolution, factor=%d\n", int(factor));
+
+        // Low-frequency decaying impulse response and low-frequency input signal
+        FloatBuffer ir(IR_SIZE);
+        FloatBuffer src(SRC_SIZE + IR_SIZE);
+        FloatBuffer dst1(src.size()), dst2(src.size());
+
+        for (size_t i=0; i<IR_SIZE; ++i)
+            ir[i]   = expf(-3.0f * i / IR_SIZE) * (sinf(2.0f * M_PI * i * 0.004f) + 0.5f * sinf(2.0f * M_PI * i * 0.011f));
+        src.fill_zero();
+        for (size_t i=0; i<SRC_SIZE; ++i)
+            src[i]  = sinf(2.0f * M_PI * i * 0.003f) + 0.3f * sinf(2.0f * M_PI * i * 0.013f + 1.0f);
+
+        dst1.fill_zero();
+        dsp::convolve(dst1, src, ir, IR_SIZE, SRC_SIZE);
+
+        dspu::TailConvolver c;
+        UTEST_ASSERT(c.init(ir, IR_SIZE, SPLIT, factor, 10));
+        UTEST_ASSERT(c.latency() == 0);
+        UTEST_ASSERT(c.data_size() == IR_SIZE);
+        UTEST_ASSERT(c.split() >= SPLIT);
+
+        // In-place processing should be supported
+        dsp::copy(dst2, src, src.size());
+        process(c, dst2, dst2, src.size());
+        UTEST_ASSERT(dst2.valid());
+
+        double v = snr(dst1, dst2, src.size());
+        printf("  factor=%d, split=%d, SNR = %.2f dB\n", int(c.factor()), int(c.split()), v);
+        UTEST_ASSERT_MSG(v >= snr_min, "SNR is too low: %.2f dB", v);
+
+        c.destroy();
+    }
+
+    UTEST_MAIN
+    {
+        test_factor(0, 80.0);
+        test_factor(2, 20.0);
+        test_factor(4, 20.0);
+    }
+
+UTEST_END
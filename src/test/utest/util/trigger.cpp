@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2021 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2021 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-dsp-units
+ * Created on: 15 окт. 2026 г.
+ *
+ * lsp-dsp-units is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-dsp-units is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-dsp-units. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/test-fw/FloatBuffer.h>
+#include <lsp-plug.in/dsp-units/util/Trigger.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#define SAMPLES     0x4000
+#define PERIOD      1000
+#define HOLD        300
+
+UTEST_BEGIN("dspu.util", trigger)
+
+    void setup(dspu::Trigger &t, dspu::trg_mode_t mode, dspu::trg_type_t type, float threshold)
+    {
+        t.set_trigger_mode(mode);
+        t.set_trigger_type(type);
+        t.set_trigger_threshold(threshold);
+        t.set_trigger_hysteresis(0.1f);
+        t.set_trigger_hold_samples(HOLD);
+        if (mode == dspu::TRG_MODE_MANUAL)
+            t.activate_manual_trigger();
+        t.update_settings();
+    }
+
+    void test_block(FloatBuffer &src, dspu::trg_mode_t mode, dspu::trg_type_t type, float threshold, bool crossing)
+    {
+        static const size_t blocks[] = { 1, 7, 300, 13, 1000, 64, 3, 129 };
+
+        printf("Testing block processing mode=%d, type=%d, threshold=%.2f\n", int(mode), int(type), threshold);
+
+        dspu::Trigger t1, t2;
+        setup(t1, mode, type, threshold);
+        setup(t2, mode, type, threshold);
+
+        uint32_t *events    = new uint32_t[SAMPLES];
+        size_t fired        = 0;
+
+        for (size_t offset=0, i=0; offset < SAMPLES; ++i)
+        {
+            size_t to_do    = lsp_min(size_t(SAMPLES) - offset, blocks[i % (sizeof(blocks)/sizeof(size_t))]);
+            size_t n        = t2.process(&events[fired], &src[offset], to_do);
+            for (size_t j=0; j<n; ++j)
+                events[fired + j]  += offset;
+            fired          += n;
+
+            // Compare with the single sample processing
+            size_t expected = 0;
+            for (size_t j=0; j<to_do; ++j)
+            {
+                t1.single_sample_processor(src[offset + j]);
+                if (t1.get_trigger_state() != dspu::TRG_STATE_FIRED)
+                    continue;
+
+                UTEST_ASSERT_MSG(expected < n, "Missed trigger event at sample %d", int(offset + j));
+                UTEST_ASSERT_MSG(events[fired - n + expected] == offset + j,
+                    "Trigger event at sample %d, expected at %d", int(events[fired - n + expected]), int(offset + j));
+                ++expected;
+            }
+
+            UTEST_ASSERT_MSG(expected == n, "Extra trigger events in block at %d", int(offset));
+            UTEST_ASSERT_MSG(t1.get_trigger_state() == t2.get_trigger_state(),
+                "Trigger state differs after block at %d", int(offset));
+
+            offset         += to_do;
+        }
+
+        if ((mode == dspu::TRG_MODE_REPEAT) && (crossing))
+            UTEST_ASSERT_MSG(fired > 0, "Trigger never fired");
+
+        delete [] events;
+    }
+
+    UTEST_MAIN
+    {
+        // Bursts with linear attack and exponential decay separated by noise, the last part is a sustained high level
+        FloatBuffer src(SAMPLES);
+        for (size_t i=0; i<SAMPLES; ++i)
+        {
+            size_t t    = i % PERIOD;
+            float env   = (t < PERIOD/2) ? lsp_min(t / 40.0f, expf((40.0f - t) / 100.0f)) : 0.0f;
+            float v     = env * (0.75f + 0.25f * sinf(0.05f * t)) + 0.01f * sinf(0.1f * i);
+            src[i]      = (i < SAMPLES - PERIOD) ? v : 0.9f + 0.01f * sinf(0.2f * i);
+        }
+
+        static const dspu::trg_mode_t modes[] = { dspu::TRG_MODE_REPEAT, dspu::TRG_MODE_SINGLE, dspu::TRG_MODE_MANUAL };
+        // The second threshold is never crossed by the signal, the trigger stays in the sustain state
+        static const float thresholds[] = { 0.5f, -0.5f };
+
+        for (size_t i=0; i<sizeof(modes)/sizeof(modes[0]); ++i)
+            for (size_t type=dspu::TRG_TYPE_NONE; type<dspu::TRG_TYPE_MAX; ++type)
+                for (size_t j=0; j<sizeof(thresholds)/sizeof(float); ++j)
+                {
+                    // Falling edge triggers are checked on the inverted signal
+                    bool falling    = (type == dspu::TRG_TYPE_SIMPLE_FALLING_EDGE) || (type == dspu::TRG_TYPE_ADVANCED_FALLING_EDGE);
+                    FloatBuffer buf(SAMPLES);
+                    for (size_t k=0; k<SAMPLES; ++k)
+                        buf[k]      = (falling) ? -src[k] : src[k];
+                    test_block(buf, modes[i], dspu::trg_type_t(type), (falling) ? -thresholds[j] : thresholds[j], j == 0);
+                }
+    }
+
+UTEST_END